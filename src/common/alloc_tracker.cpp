@@ -0,0 +1,274 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "common/alloc_tracker.h"
+
+namespace Common {
+
+const char* GetAllocTagName(AllocTag tag) {
+    switch (tag) {
+    case AllocTag::Other:
+        return "Other";
+    case AllocTag::PipelineCache:
+        return "Pipeline cache";
+    case AllocTag::ShaderRecompiler:
+        return "Shader recompiler";
+    case AllocTag::TextureCache:
+        return "Texture cache";
+    case AllocTag::BufferCache:
+        return "Buffer cache";
+    case AllocTag::HleLibraries:
+        return "HLE libraries";
+    case AllocTag::Logging:
+        return "Logging";
+    default:
+        return "Unknown";
+    }
+}
+
+#ifdef ENABLE_ALLOC_TRACKING
+
+namespace {
+
+constexpr size_t NumTags = static_cast<size_t>(AllocTag::Count);
+
+struct TagCounters {
+    std::atomic<u64> num_allocs;
+    std::atomic<u64> num_frees;
+    std::atomic<u64> bytes_allocated;
+    std::atomic<u64> bytes_freed;
+};
+
+/// Counters of one thread, on their own cache line so threads don't contend. Blocks are never
+/// freed, the block of a finished thread is handed to the next new thread and keeps its totals.
+struct alignas(64) ThreadCounters {
+    std::array<TagCounters, NumTags> tags{};
+    ThreadCounters* next{};
+    std::atomic<bool> in_use{};
+};
+
+/// Shared by the threads whose thread locals are already destroyed
+constinit ThreadCounters orphan_counters{};
+constinit std::atomic<ThreadCounters*> thread_counters{&orphan_counters};
+
+constinit thread_local ThreadCounters* current_counters = nullptr;
+constinit thread_local AllocTag current_tag = AllocTag::Other;
+
+/// Gives the counters back when the thread exits
+struct CountersOwner {
+    ~CountersOwner() {
+        current_counters->in_use.store(false, std::memory_order_release);
+        current_counters = &orphan_counters;
+    }
+};
+
+ThreadCounters* AcquireCounters() {
+    ThreadCounters* counters = nullptr;
+    for (ThreadCounters* it = thread_counters.load(std::memory_order_acquire); it;
+         it = it->next) {
+        bool expected = false;
+        if (it != &orphan_counters &&
+            it->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            counters = it;
+            break;
+        }
+    }
+    if (!counters) {
+        // malloc, as it must not recurse into operator new
+        counters = new (std::malloc(sizeof(ThreadCounters))) ThreadCounters{};
+        counters->in_use.store(true, std::memory_order_relaxed);
+        ThreadCounters* head = thread_counters.load(std::memory_order_relaxed);
+        do {
+            counters->next = head;
+        } while (!thread_counters.compare_exchange_weak(head, counters, std::memory_order_release,
+                                                        std::memory_order_relaxed));
+    }
+    current_counters = counters;
+    static thread_local CountersOwner owner;
+    return counters;
+}
+
+TagCounters& GetCounters(AllocTag tag) {
+    ThreadCounters* counters = current_counters;
+    if (!counters) [[unlikely]] {
+        counters = AcquireCounters();
+    }
+    return counters->tags[static_cast<size_t>(tag)];
+}
+
+/// Stored right in front of every block, so delete knows what to give back
+struct AllocHeader {
+    void* base;
+    size_t size;
+    AllocTag tag;
+};
+
+void* Allocate(size_t size, size_t alignment) noexcept {
+    alignment = std::max<size_t>(alignment, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    const size_t offset = (sizeof(AllocHeader) + alignment - 1) & ~(alignment - 1);
+    const size_t padding = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? alignment : 0;
+    void* base = std::malloc(size + offset + padding);
+    if (!base) {
+        return nullptr;
+    }
+    const uintptr_t address =
+        (reinterpret_cast<uintptr_t>(base) + offset + alignment - 1) & ~(alignment - 1);
+    auto* header = reinterpret_cast<AllocHeader*>(address) - 1;
+    header->base = base;
+    header->size = size;
+    header->tag = current_tag;
+
+    TagCounters& counters = GetCounters(current_tag);
+    counters.num_allocs.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes_allocated.fetch_add(size, std::memory_order_relaxed);
+    return reinterpret_cast<void*>(address);
+}
+
+void* AllocateOrThrow(size_t size, size_t alignment) {
+    while (true) {
+        if (void* ptr = Allocate(size, alignment)) {
+            return ptr;
+        }
+        const std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc{};
+        }
+        handler();
+    }
+}
+
+void Deallocate(void* ptr) noexcept {
+    if (!ptr) {
+        return;
+    }
+    const auto* header = static_cast<const AllocHeader*>(ptr) - 1;
+    TagCounters& counters = GetCounters(header->tag);
+    counters.num_frees.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes_freed.fetch_add(header->size, std::memory_order_relaxed);
+    std::free(header->base);
+}
+
+} // Anonymous namespace
+
+AllocStatsArray GetAllocStats() {
+    AllocStatsArray stats{};
+    for (ThreadCounters* it = thread_counters.load(std::memory_order_acquire); it;
+         it = it->next) {
+        for (size_t i = 0; i < NumTags; ++i) {
+            const TagCounters& counters = it->tags[i];
+            stats[i].num_allocs += counters.num_allocs.load(std::memory_order_relaxed);
+            stats[i].num_frees += counters.num_frees.load(std::memory_order_relaxed);
+            stats[i].bytes_allocated += counters.bytes_allocated.load(std::memory_order_relaxed);
+            stats[i].bytes_freed += counters.bytes_freed.load(std::memory_order_relaxed);
+        }
+    }
+    return stats;
+}
+
+ScopedAllocTag::ScopedAllocTag(AllocTag tag) : previous{current_tag} {
+    current_tag = tag;
+}
+
+ScopedAllocTag::~ScopedAllocTag() {
+    current_tag = previous;
+}
+
+#else
+
+AllocStatsArray GetAllocStats() {
+    return {};
+}
+
+#endif
+
+} // namespace Common
+
+#ifdef ENABLE_ALLOC_TRACKING
+
+void* operator new(size_t size) {
+    return Common::AllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size) {
+    return Common::AllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return Common::AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return Common::AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return Common::Allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return Common::Allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return Common::Allocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return Common::Allocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept {
+    Common::Deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    Common::Deallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    Common::Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    Common::Deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    Common::Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    Common::Deallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    Common::Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+    Common::Deallocate(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    Common::Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    Common::Deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    Common::Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    Common::Deallocate(ptr);
+}
+
+#endif
@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "common/types.h"
+
+namespace Common {
+
+/// Subsystems host allocations are attributed to, by the innermost ScopedAllocTag of the thread.
+enum class AllocTag : u32 {
+    Other,
+    PipelineCache,
+    ShaderRecompiler,
+    TextureCache,
+    BufferCache,
+    HleLibraries,
+    Logging,
+    Count,
+};
+
+[[nodiscard]] const char* GetAllocTagName(AllocTag tag);
+
+struct AllocStats {
+    u64 num_allocs;
+    u64 num_frees;
+    u64 bytes_allocated;
+    u64 bytes_freed;
+
+    [[nodiscard]] u64 LiveAllocs() const {
+        return num_allocs - num_frees;
+    }
+
+    [[nodiscard]] u64 LiveBytes() const {
+        return bytes_allocated - bytes_freed;
+    }
+};
+
+using AllocStatsArray = std::array<AllocStats, static_cast<size_t>(AllocTag::Count)>;
+
+/// Host allocations are only counted in builds with ENABLE_ALLOC_TRACKING, which replaces the
+/// global operator new and delete.
+[[nodiscard]] constexpr bool IsAllocTrackingEnabled() {
+#ifdef ENABLE_ALLOC_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+/// Returns the totals of every thread since startup. A block is counted as freed by the tag it
+/// was allocated with, whichever thread frees it.
+[[nodiscard]] AllocStatsArray GetAllocStats();
+
+/// Attributes the allocations of the calling thread to a tag until it goes out of scope.
+class ScopedAllocTag {
+public:
+#ifdef ENABLE_ALLOC_TRACKING
+    explicit ScopedAllocTag(AllocTag tag);
+    ~ScopedAllocTag();
+#else
+    explicit ScopedAllocTag(AllocTag) {}
+#endif
+
+    ScopedAllocTag(const ScopedAllocTag&) = delete;
+    ScopedAllocTag& operator=(const ScopedAllocTag&) = delete;
+
+#ifdef ENABLE_ALLOC_TRACKING
+private:
+    AllocTag previous;
+#endif
+};
+
+} // namespace Common
@@ -196,9 +196,21 @@ public:
     }
 
     inline constexpr bool None() const {
+        size_t i = 0;
+#ifdef BIT_ARRAY_USE_AVX
+        if !consteval {
+            __m256i accumulated = _mm256_setzero_si256();
+            for (; i < AVX_WORD_COUNT * WORDS_PER_AVX; i += WORDS_PER_AVX) {
+                accumulated = _mm256_or_si256(accumulated, LoadAvx(i));
+            }
+            if (!_mm256_testz_si256(accumulated, accumulated)) {
+                return false;
+            }
+        }
+#endif
         u64 result = 0;
-        for (const auto& word : data) {
-            result |= word;
+        for (; i < WORD_COUNT; ++i) {
+            result |= data[i];
         }
         return result == 0;
     }
@@ -207,6 +219,40 @@ public:
         return !None();
     }
 
+    /// Returns true if any bit in [start, end) is set, without building a masked copy.
+    inline bool AnyInRange(size_t start, size_t end) const {
+        if (start >= end || end > N) {
+            return false;
+        }
+        const size_t first_word = start / BITS_PER_WORD;
+        const size_t last_word = (end - 1) / BITS_PER_WORD;
+        const size_t start_bit = start % BITS_PER_WORD;
+        const size_t end_bit = (end - 1) % BITS_PER_WORD;
+        const u64 start_mask = ~((1ULL << start_bit) - 1);
+        const u64 end_mask = end_bit == BITS_PER_WORD - 1 ? ~0ULL : (1ULL << (end_bit + 1)) - 1;
+        if (first_word == last_word) {
+            return (data[first_word] & start_mask & end_mask) != 0;
+        }
+        if ((data[first_word] & start_mask) != 0 || (data[last_word] & end_mask) != 0) {
+            return true;
+        }
+        size_t i = first_word + 1;
+#ifdef BIT_ARRAY_USE_AVX
+        for (; i + WORDS_PER_AVX <= last_word; i += WORDS_PER_AVX) {
+            const __m256i current = LoadAvx(i);
+            if (!_mm256_testz_si256(current, current)) {
+                return true;
+            }
+        }
+#endif
+        for (; i < last_word; ++i) {
+            if (data[i] != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     Range FirstRangeFrom(size_t start) const {
         if (start >= N) {
             return {N, N};
@@ -341,21 +387,45 @@ public:
     }
 
     inline constexpr BitArray& operator|=(const BitArray& other) {
-        for (size_t i = 0; i < WORD_COUNT; ++i) {
+        size_t i = 0;
+#ifdef BIT_ARRAY_USE_AVX
+        if !consteval {
+            for (; i < AVX_WORD_COUNT * WORDS_PER_AVX; i += WORDS_PER_AVX) {
+                StoreAvx(i, _mm256_or_si256(LoadAvx(i), other.LoadAvx(i)));
+            }
+        }
+#endif
+        for (; i < WORD_COUNT; ++i) {
             data[i] |= other.data[i];
         }
         return *this;
     }
 
     inline constexpr BitArray& operator&=(const BitArray& other) {
-        for (size_t i = 0; i < WORD_COUNT; ++i) {
+        size_t i = 0;
+#ifdef BIT_ARRAY_USE_AVX
+        if !consteval {
+            for (; i < AVX_WORD_COUNT * WORDS_PER_AVX; i += WORDS_PER_AVX) {
+                StoreAvx(i, _mm256_and_si256(LoadAvx(i), other.LoadAvx(i)));
+            }
+        }
+#endif
+        for (; i < WORD_COUNT; ++i) {
             data[i] &= other.data[i];
         }
         return *this;
     }
 
     inline constexpr BitArray& operator^=(const BitArray& other) {
-        for (size_t i = 0; i < WORD_COUNT; ++i) {
+        size_t i = 0;
+#ifdef BIT_ARRAY_USE_AVX
+        if !consteval {
+            for (; i < AVX_WORD_COUNT * WORDS_PER_AVX; i += WORDS_PER_AVX) {
+                StoreAvx(i, _mm256_xor_si256(LoadAvx(i), other.LoadAvx(i)));
+            }
+        }
+#endif
+        for (; i < WORD_COUNT; ++i) {
             data[i] ^= other.data[i];
         }
         return *this;
@@ -380,16 +450,38 @@ public:
     }
 
     inline constexpr BitArray operator~() const {
-        BitArray result = *this;
-        for (size_t i = 0; i < WORD_COUNT; ++i) {
-            result.data[i] = ~result.data[i];
+        BitArray result;
+        size_t i = 0;
+#ifdef BIT_ARRAY_USE_AVX
+        if !consteval {
+            const __m256i all_one = _mm256_set1_epi64x(-1);
+            for (; i < AVX_WORD_COUNT * WORDS_PER_AVX; i += WORDS_PER_AVX) {
+                result.StoreAvx(i, _mm256_xor_si256(LoadAvx(i), all_one));
+            }
+        }
+#endif
+        for (; i < WORD_COUNT; ++i) {
+            result.data[i] = ~data[i];
         }
         return result;
     }
 
     inline constexpr bool operator==(const BitArray& other) const {
+        size_t i = 0;
+#ifdef BIT_ARRAY_USE_AVX
+        if !consteval {
+            __m256i difference = _mm256_setzero_si256();
+            for (; i < AVX_WORD_COUNT * WORDS_PER_AVX; i += WORDS_PER_AVX) {
+                difference =
+                    _mm256_or_si256(difference, _mm256_xor_si256(LoadAvx(i), other.LoadAvx(i)));
+            }
+            if (!_mm256_testz_si256(difference, difference)) {
+                return false;
+            }
+        }
+#endif
         u64 result = 0;
-        for (size_t i = 0; i < WORD_COUNT; ++i) {
+        for (; i < WORD_COUNT; ++i) {
             result |= data[i] ^ other.data[i];
         }
         return result == 0;
@@ -400,6 +492,16 @@ public:
     }
 
 private:
+#ifdef BIT_ARRAY_USE_AVX
+    __m256i LoadAvx(size_t word) const {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&data[word]));
+    }
+
+    void StoreAvx(size_t word, __m256i value) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&data[word]), value);
+    }
+#endif
+
     std::array<u64, WORD_COUNT> data{};
 };
 
@@ -3,12 +3,15 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstddef>
 #include <memory>
 #include <mutex>
+#include <span>
 #include "common/polyfill_thread.h"
+#include "common/types.h"
 
 namespace Common {
 
@@ -199,6 +202,104 @@ private:
     std::mutex write_mutex;
 };
 
+/// Multi producer, single consumer queue that doesn't lock. Producers claim a slot by advancing
+/// the write index and publish it through the sequence number of the slot, so they only contend
+/// on a single atomic. The consumer can look at the oldest element before popping it.
+template <typename T, std::size_t Capacity = detail::DefaultCapacity>
+class LockFreeMPSCQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+
+public:
+    LockFreeMPSCQueue() {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order::relaxed);
+        }
+    }
+
+    template <typename... Args>
+    bool TryEmplace(Args&&... args) {
+        std::size_t write_index = m_write_index.load(std::memory_order::relaxed);
+        while (true) {
+            Slot& slot = m_slots[write_index % Capacity];
+            const std::size_t sequence = slot.sequence.load(std::memory_order::acquire);
+            const auto diff =
+                static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(write_index);
+            if (diff == 0) {
+                // The slot is free, try to claim it.
+                if (m_write_index.compare_exchange_weak(write_index, write_index + 1,
+                                                        std::memory_order::relaxed)) {
+                    slot.value = T(std::forward<Args>(args)...);
+                    slot.sequence.store(write_index + 1, std::memory_order::release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // The consumer hasn't popped the element written a lap ago, the queue is full.
+                return false;
+            } else {
+                write_index = m_write_index.load(std::memory_order::relaxed);
+            }
+        }
+    }
+
+    template <typename... Args>
+    void EmplaceWait(Args&&... args) {
+        while (true) {
+            const std::size_t read_index = m_read_index.load(std::memory_order::acquire);
+            if (TryEmplace(std::forward<Args>(args)...)) {
+                return;
+            }
+            m_read_index.wait(read_index, std::memory_order::acquire);
+        }
+    }
+
+    /// Returns the oldest element or nullptr if there is none. Consumer only.
+    T* Front() {
+        const std::size_t read_index = m_read_index.load(std::memory_order::relaxed);
+        Slot& slot = m_slots[read_index % Capacity];
+        if (slot.sequence.load(std::memory_order::acquire) != read_index + 1) {
+            return nullptr;
+        }
+        return &slot.value;
+    }
+
+    /// Removes the element returned by Front. Consumer only.
+    void Pop() {
+        const std::size_t read_index = m_read_index.load(std::memory_order::relaxed);
+        Slot& slot = m_slots[read_index % Capacity];
+        slot.value = T{};
+        slot.sequence.store(read_index + Capacity, std::memory_order::release);
+        m_read_index.store(read_index + 1, std::memory_order::release);
+        m_read_index.notify_all();
+    }
+
+    bool TryPop(T& t) {
+        T* front = Front();
+        if (!front) {
+            return false;
+        }
+        t = std::move(*front);
+        Pop();
+        return true;
+    }
+
+    /// Number of elements, including the ones producers are still writing.
+    [[nodiscard]] std::size_t Size() const {
+        return m_write_index.load(std::memory_order::acquire) -
+               m_read_index.load(std::memory_order::acquire);
+    }
+
+private:
+    struct Slot {
+        std::atomic_size_t sequence;
+        T value{};
+    };
+
+    alignas(128) std::atomic_size_t m_read_index{0};
+    alignas(128) std::atomic_size_t m_write_index{0};
+
+    std::array<Slot, Capacity> m_slots;
+};
+
 template <typename T, std::size_t Capacity = detail::DefaultCapacity>
 class MPMCQueue {
 public:
@@ -245,4 +346,183 @@ private:
     std::mutex read_mutex;
 };
 
+/// Multi producer, multi consumer queue that doesn't lock. Both sides claim slots by advancing
+/// their index and hand them over through the sequence number of the slot. Waiting threads park
+/// on an atomic that is bumped after every push or pop.
+template <typename T, std::size_t Capacity = detail::DefaultCapacity>
+class LockFreeMPMCQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+
+public:
+    LockFreeMPMCQueue() {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order::relaxed);
+        }
+    }
+
+    template <typename... Args>
+    bool TryEmplace(Args&&... args) {
+        if (!Push(std::forward<Args>(args)...)) {
+            return false;
+        }
+        NotifyPushed();
+        return true;
+    }
+
+    template <typename... Args>
+    void EmplaceWait(Args&&... args) {
+        while (true) {
+            const u32 epoch = m_pop_epoch.load(std::memory_order::acquire);
+            if (TryEmplace(std::forward<Args>(args)...)) {
+                return;
+            }
+            m_pop_epoch.wait(epoch, std::memory_order::acquire);
+        }
+    }
+
+    /// Moves as many of items into the queue as fit, returning how many.
+    std::size_t TryEmplaceBatch(std::span<T> items) {
+        std::size_t count = 0;
+        while (count < items.size() && Push(std::move(items[count]))) {
+            ++count;
+        }
+        if (count != 0) {
+            NotifyPushed();
+        }
+        return count;
+    }
+
+    bool TryPop(T& t) {
+        if (!Pop(t)) {
+            return false;
+        }
+        NotifyPopped();
+        return true;
+    }
+
+    /// Pops up to out.size() elements, returning how many.
+    std::size_t TryPopBatch(std::span<T> out) {
+        std::size_t count = 0;
+        while (count < out.size() && Pop(out[count])) {
+            ++count;
+        }
+        if (count != 0) {
+            NotifyPopped();
+        }
+        return count;
+    }
+
+    void PopWait(T& t) {
+        while (true) {
+            const u32 epoch = m_push_epoch.load(std::memory_order::acquire);
+            if (TryPop(t)) {
+                return;
+            }
+            m_push_epoch.wait(epoch, std::memory_order::acquire);
+        }
+    }
+
+    void PopWait(T& t, std::stop_token stop_token) {
+        // Wakes the waiting consumers up, they give up when they see the stop request.
+        std::stop_callback callback{stop_token, [this] { NotifyPushed(); }};
+        while (!stop_token.stop_requested()) {
+            const u32 epoch = m_push_epoch.load(std::memory_order::acquire);
+            if (TryPop(t) || stop_token.stop_requested()) {
+                return;
+            }
+            m_push_epoch.wait(epoch, std::memory_order::acquire);
+        }
+    }
+
+    T PopWait() {
+        T t;
+        PopWait(t);
+        return t;
+    }
+
+    T PopWait(std::stop_token stop_token) {
+        T t;
+        PopWait(t, stop_token);
+        return t;
+    }
+
+    /// Number of elements, including the ones still being pushed or popped.
+    [[nodiscard]] std::size_t Size() const {
+        return m_write_index.load(std::memory_order::acquire) -
+               m_read_index.load(std::memory_order::acquire);
+    }
+
+private:
+    template <typename... Args>
+    bool Push(Args&&... args) {
+        std::size_t write_index = m_write_index.load(std::memory_order::relaxed);
+        while (true) {
+            Slot& slot = m_slots[write_index % Capacity];
+            const std::size_t sequence = slot.sequence.load(std::memory_order::acquire);
+            const auto diff =
+                static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(write_index);
+            if (diff == 0) {
+                // The slot is free, try to claim it.
+                if (m_write_index.compare_exchange_weak(write_index, write_index + 1,
+                                                        std::memory_order::relaxed)) {
+                    slot.value = T(std::forward<Args>(args)...);
+                    slot.sequence.store(write_index + 1, std::memory_order::release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // The element written a lap ago hasn't been popped, the queue is full.
+                return false;
+            } else {
+                write_index = m_write_index.load(std::memory_order::relaxed);
+            }
+        }
+    }
+
+    bool Pop(T& t) {
+        std::size_t read_index = m_read_index.load(std::memory_order::relaxed);
+        while (true) {
+            Slot& slot = m_slots[read_index % Capacity];
+            const std::size_t sequence = slot.sequence.load(std::memory_order::acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) -
+                              static_cast<std::ptrdiff_t>(read_index + 1);
+            if (diff == 0) {
+                // The slot was published, try to claim it.
+                if (m_read_index.compare_exchange_weak(read_index, read_index + 1,
+                                                       std::memory_order::relaxed)) {
+                    t = std::move(slot.value);
+                    slot.sequence.store(read_index + Capacity, std::memory_order::release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // Nothing was published in the slot yet, the queue is empty.
+                return false;
+            } else {
+                read_index = m_read_index.load(std::memory_order::relaxed);
+            }
+        }
+    }
+
+    void NotifyPushed() {
+        m_push_epoch.fetch_add(1, std::memory_order::release);
+        m_push_epoch.notify_all();
+    }
+
+    void NotifyPopped() {
+        m_pop_epoch.fetch_add(1, std::memory_order::release);
+        m_pop_epoch.notify_all();
+    }
+
+    struct Slot {
+        std::atomic_size_t sequence;
+        T value{};
+    };
+
+    alignas(128) std::atomic_size_t m_read_index{0};
+    alignas(128) std::atomic_size_t m_write_index{0};
+    alignas(128) std::atomic<u32> m_push_epoch{0};
+    alignas(128) std::atomic<u32> m_pop_epoch{0};
+
+    std::array<Slot, Capacity> m_slots;
+};
+
 } // namespace Common
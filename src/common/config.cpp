@@ -142,6 +142,15 @@ static ConfigEntry<string> userName("shadPS4");
 static ConfigEntry<bool> isShowSplash(false);
 static ConfigEntry<string> isSideTrophy("right");
 static ConfigEntry<bool> isConnectedToNetwork(false);
+static ConfigEntry<bool> lazyImportBinding(false);
+static ConfigEntry<bool> directMemoryHugePages(false);
+static ConfigEntry<int> prefaultMemoryMbytes(0);
+static ConfigEntry<bool> guestThreadPriorities(false);
+static ConfigEntry<string> guestCores("");
+static ConfigEntry<bool> mappedGameFileReads(false);
+static ConfigEntry<bool> preciseSleep(false);
+static ConfigEntry<int> avPlayerReadAheadMbytes(16);
+static ConfigEntry<bool> playGoPrefetch(true);
 static bool enableDiscordRPC = false;
 static std::filesystem::path sys_modules_path = {};
 
@@ -159,6 +168,8 @@ static ConfigEntry<bool> backgroundControllerInput(false);
 static ConfigEntry<string> micDevice("Default Device");
 static ConfigEntry<string> mainOutputDevice("Default Device");
 static ConfigEntry<string> padSpkOutputDevice("Default Device");
+static ConfigEntry<int> outputLatencyTarget(0);
+static ConfigEntry<bool> mixAudioPorts(false);
 
 // GPU
 static ConfigEntry<u32> windowWidth(1280);
@@ -183,6 +194,26 @@ static ConfigEntry<int> rcasAttenuation(250);
 static ConfigEntry<bool> dlssEnabled(false);
 static ConfigEntry<int> dlssQuality(2); // 0=Performance, 1=Balanced, 2=Quality, 3=Ultra Performance
 static ConfigEntry<bool> dlssFrameGenEnabled(false);
+static ConfigEntry<bool> pipelinedCommandProcessing(false);
+static ConfigEntry<bool> indirectBufferCache(false);
+static ConfigEntry<bool> drawCoalescing(false);
+static ConfigEntry<bool> transferQueueUploads(false);
+static ConfigEntry<bool> hostMemoryImport(false);
+static ConfigEntry<bool> speculativeReadbacks(false);
+static ConfigEntry<bool> hugePagePageTables(false);
+static ConfigEntry<bool> cpuDetiling(true);
+static ConfigEntry<bool> textureDedup(false);
+static ConfigEntry<bool> texturePacks(false);
+static ConfigEntry<int> texturePackBudgetMB(1024);
+static ConfigEntry<bool> sparsePrtImages(false);
+static ConfigEntry<bool> imageDemotion(false);
+static ConfigEntry<bool> descriptorBuffer(false);
+static ConfigEntry<bool> bindlessSamplers(false);
+static ConfigEntry<bool> lowLatencyPresent(false);
+static ConfigEntry<bool> hostVblankSync(true);
+static ConfigEntry<bool> dynamicResolution(false);
+static ConfigEntry<int> dynamicResolutionTargetFps(60);
+static ConfigEntry<string> videoDecoder("auto"); // auto, software or an FFmpeg hwdevice
 
 // Vulkan
 static ConfigEntry<s32> gpuId(-1);
@@ -194,8 +225,21 @@ static ConfigEntry<bool> vkCrashDiagnostic(false);
 static ConfigEntry<bool> vkHostMarkers(false);
 static ConfigEntry<bool> vkGuestMarkers(false);
 static ConfigEntry<bool> rdocEnable(false);
+static ConfigEntry<u32> rdocAutoCaptureCpuMs(0); // 0 disables the CPU frame time trigger
+static ConfigEntry<u32> rdocAutoCaptureGpuMs(0); // 0 disables the GPU frame time trigger
+static ConfigEntry<u32> rdocAutoCaptureCooldown(30);
+static ConfigEntry<u32> rdocAutoCaptureLimit(3);
 static ConfigEntry<bool> pipelineCacheEnable(false);
 static ConfigEntry<bool> pipelineCacheArchive(false);
+static ConfigEntry<int> pipelineCompileWorkers(0);
+static ConfigEntry<bool> pipelineSkipPendingDraws(false);
+static ConfigEntry<bool> pipelineCachePack(false);
+static ConfigEntry<bool> pipelineLibraries(true);
+static ConfigEntry<bool> dynamicInstanceStepRates(false);
+static ConfigEntry<bool> vkGpuTimestamps(false);
+static ConfigEntry<bool> tieredShaderCompilation(false);
+static ConfigEntry<bool> loopInvariantCodeMotion(true);
+static ConfigEntry<string> fp64Mode("auto"); // auto, native, lower or hybrid
 
 // Debug
 static ConfigEntry<bool> isDebugDump(false);
@@ -203,6 +247,11 @@ static ConfigEntry<bool> isShaderDebug(false);
 static ConfigEntry<bool> isSeparateLogFilesEnabled(false);
 static ConfigEntry<bool> showFpsCounter(false);
 static ConfigEntry<bool> logEnabled(true);
+static ConfigEntry<bool> pm4Profiling(false);
+static ConfigEntry<bool> bufferCacheStats(false);
+static ConfigEntry<bool> audioStats(false);
+static ConfigEntry<string> metricsSink("none"); // none, csv, json, socket or shm
+static ConfigEntry<u32> metricsPort(7380);
 
 // GUI
 static std::vector<GameInstallDir> settings_install_dirs = {};
@@ -610,6 +659,38 @@ void setRdocEnabled(bool enable, bool is_game_specific) {
     rdocEnable.set(enable, is_game_specific);
 }
 
+u32 getRdocAutoCaptureCpuMs() {
+    return rdocAutoCaptureCpuMs.get();
+}
+
+void setRdocAutoCaptureCpuMs(u32 ms, bool is_game_specific) {
+    rdocAutoCaptureCpuMs.set(ms, is_game_specific);
+}
+
+u32 getRdocAutoCaptureGpuMs() {
+    return rdocAutoCaptureGpuMs.get();
+}
+
+void setRdocAutoCaptureGpuMs(u32 ms, bool is_game_specific) {
+    rdocAutoCaptureGpuMs.set(ms, is_game_specific);
+}
+
+u32 getRdocAutoCaptureCooldown() {
+    return rdocAutoCaptureCooldown.get();
+}
+
+void setRdocAutoCaptureCooldown(u32 seconds, bool is_game_specific) {
+    rdocAutoCaptureCooldown.set(seconds, is_game_specific);
+}
+
+u32 getRdocAutoCaptureLimit() {
+    return rdocAutoCaptureLimit.get();
+}
+
+void setRdocAutoCaptureLimit(u32 count, bool is_game_specific) {
+    rdocAutoCaptureLimit.set(count, is_game_specific);
+}
+
 void setPipelineCacheEnabled(bool enable, bool is_game_specific) {
     pipelineCacheEnable.set(enable, is_game_specific);
 }
@@ -867,6 +948,366 @@ void setUsbDeviceBackend(int value, bool is_game_specific) {
     usbDeviceBackend.set(value, is_game_specific);
 }
 
+int getPipelineCompileWorkers() {
+    return pipelineCompileWorkers.get();
+}
+
+void setPipelineCompileWorkers(int value, bool is_game_specific) {
+    pipelineCompileWorkers.set(value, is_game_specific);
+}
+
+bool getPipelineSkipPendingDraws() {
+    return pipelineSkipPendingDraws.get();
+}
+
+void setPipelineSkipPendingDraws(bool enable, bool is_game_specific) {
+    pipelineSkipPendingDraws.set(enable, is_game_specific);
+}
+
+bool isPipelineCachePacked() {
+    return pipelineCachePack.get();
+}
+
+void setPipelineCachePacked(bool enable, bool is_game_specific) {
+    pipelineCachePack.set(enable, is_game_specific);
+}
+
+bool isPipelineLibraryEnabled() {
+    return pipelineLibraries.get();
+}
+
+void setPipelineLibraryEnabled(bool enable, bool is_game_specific) {
+    pipelineLibraries.set(enable, is_game_specific);
+}
+
+bool isDynamicInstanceStepRatesEnabled() {
+    return dynamicInstanceStepRates.get();
+}
+
+void setDynamicInstanceStepRatesEnabled(bool enable, bool is_game_specific) {
+    dynamicInstanceStepRates.set(enable, is_game_specific);
+}
+
+bool isPipelinedCommandProcessing() {
+    return pipelinedCommandProcessing.get();
+}
+
+void setPipelinedCommandProcessing(bool enable, bool is_game_specific) {
+    pipelinedCommandProcessing.set(enable, is_game_specific);
+}
+
+bool isIndirectBufferCacheEnabled() {
+    return indirectBufferCache.get();
+}
+
+void setIndirectBufferCacheEnabled(bool enable, bool is_game_specific) {
+    indirectBufferCache.set(enable, is_game_specific);
+}
+
+bool isPM4ProfilingEnabled() {
+    return pm4Profiling.get();
+}
+
+void setPM4ProfilingEnabled(bool enable, bool is_game_specific) {
+    pm4Profiling.set(enable, is_game_specific);
+}
+
+bool isDrawCoalescingEnabled() {
+    return drawCoalescing.get();
+}
+
+void setDrawCoalescingEnabled(bool enable, bool is_game_specific) {
+    drawCoalescing.set(enable, is_game_specific);
+}
+
+bool isTransferQueueUploadsEnabled() {
+    return transferQueueUploads.get();
+}
+
+void setTransferQueueUploadsEnabled(bool enable, bool is_game_specific) {
+    transferQueueUploads.set(enable, is_game_specific);
+}
+
+bool isHostMemoryImportEnabled() {
+    return hostMemoryImport.get();
+}
+
+void setHostMemoryImportEnabled(bool enable, bool is_game_specific) {
+    hostMemoryImport.set(enable, is_game_specific);
+}
+
+bool isSpeculativeReadbacksEnabled() {
+    return speculativeReadbacks.get();
+}
+
+void setSpeculativeReadbacksEnabled(bool enable, bool is_game_specific) {
+    speculativeReadbacks.set(enable, is_game_specific);
+}
+
+bool isHugePagePageTablesEnabled() {
+    return hugePagePageTables.get();
+}
+
+void setHugePagePageTablesEnabled(bool enable, bool is_game_specific) {
+    hugePagePageTables.set(enable, is_game_specific);
+}
+
+bool isBufferCacheStatsEnabled() {
+    return bufferCacheStats.get();
+}
+
+void setBufferCacheStatsEnabled(bool enable, bool is_game_specific) {
+    bufferCacheStats.set(enable, is_game_specific);
+}
+
+bool isCpuDetilingEnabled() {
+    return cpuDetiling.get();
+}
+
+void setCpuDetilingEnabled(bool enable, bool is_game_specific) {
+    cpuDetiling.set(enable, is_game_specific);
+}
+
+bool isTextureDedupEnabled() {
+    return textureDedup.get();
+}
+
+void setTextureDedupEnabled(bool enable, bool is_game_specific) {
+    textureDedup.set(enable, is_game_specific);
+}
+
+bool isTexturePacksEnabled() {
+    return texturePacks.get();
+}
+
+void setTexturePacksEnabled(bool enable, bool is_game_specific) {
+    texturePacks.set(enable, is_game_specific);
+}
+
+int getTexturePackBudgetMB() {
+    return texturePackBudgetMB.get();
+}
+
+void setTexturePackBudgetMB(int value, bool is_game_specific) {
+    texturePackBudgetMB.set(value, is_game_specific);
+}
+
+bool isSparsePrtImagesEnabled() {
+    return sparsePrtImages.get();
+}
+
+void setSparsePrtImagesEnabled(bool enable, bool is_game_specific) {
+    sparsePrtImages.set(enable, is_game_specific);
+}
+
+bool isImageDemotionEnabled() {
+    return imageDemotion.get();
+}
+
+void setImageDemotionEnabled(bool enable, bool is_game_specific) {
+    imageDemotion.set(enable, is_game_specific);
+}
+
+bool isDescriptorBufferEnabled() {
+    return descriptorBuffer.get();
+}
+
+void setDescriptorBufferEnabled(bool enable, bool is_game_specific) {
+    descriptorBuffer.set(enable, is_game_specific);
+}
+
+bool isBindlessSamplersEnabled() {
+    return bindlessSamplers.get();
+}
+
+void setBindlessSamplersEnabled(bool enable, bool is_game_specific) {
+    bindlessSamplers.set(enable, is_game_specific);
+}
+
+bool isLowLatencyPresentEnabled() {
+    return lowLatencyPresent.get();
+}
+
+void setLowLatencyPresentEnabled(bool enable, bool is_game_specific) {
+    lowLatencyPresent.set(enable, is_game_specific);
+}
+
+bool isHostVblankSyncEnabled() {
+    return hostVblankSync.get();
+}
+
+void setHostVblankSyncEnabled(bool enable, bool is_game_specific) {
+    hostVblankSync.set(enable, is_game_specific);
+}
+
+bool getVkGpuTimestampsEnabled() {
+    return vkGpuTimestamps.get();
+}
+
+void setVkGpuTimestampsEnabled(bool enable, bool is_game_specific) {
+    vkGpuTimestamps.set(enable, is_game_specific);
+}
+
+bool isDynamicResolutionEnabled() {
+    return dynamicResolution.get();
+}
+
+void setDynamicResolutionEnabled(bool enable, bool is_game_specific) {
+    dynamicResolution.set(enable, is_game_specific);
+}
+
+int getDynamicResolutionTargetFps() {
+    return dynamicResolutionTargetFps.get();
+}
+
+void setDynamicResolutionTargetFps(int value, bool is_game_specific) {
+    dynamicResolutionTargetFps.set(value, is_game_specific);
+}
+
+bool isTieredShaderCompilationEnabled() {
+    return tieredShaderCompilation.get();
+}
+
+void setTieredShaderCompilationEnabled(bool enable, bool is_game_specific) {
+    tieredShaderCompilation.set(enable, is_game_specific);
+}
+
+bool isLoopInvariantCodeMotionEnabled() {
+    return loopInvariantCodeMotion.get();
+}
+
+void setLoopInvariantCodeMotionEnabled(bool enable, bool is_game_specific) {
+    loopInvariantCodeMotion.set(enable, is_game_specific);
+}
+
+std::string getFp64Mode() {
+    return fp64Mode.get();
+}
+
+void setFp64Mode(const std::string& value, bool is_game_specific) {
+    fp64Mode.set(value, is_game_specific);
+}
+
+bool isLazyImportBindingEnabled() {
+    return lazyImportBinding.get();
+}
+
+void setLazyImportBindingEnabled(bool enable, bool is_game_specific) {
+    lazyImportBinding.set(enable, is_game_specific);
+}
+
+bool isDirectMemoryHugePagesEnabled() {
+    return directMemoryHugePages.get();
+}
+
+void setDirectMemoryHugePagesEnabled(bool enable, bool is_game_specific) {
+    directMemoryHugePages.set(enable, is_game_specific);
+}
+
+int getPrefaultMemoryMbytes() {
+    return prefaultMemoryMbytes.get();
+}
+
+void setPrefaultMemoryMbytes(int value, bool is_game_specific) {
+    prefaultMemoryMbytes.set(value, is_game_specific);
+}
+
+bool isGuestThreadPrioritiesEnabled() {
+    return guestThreadPriorities.get();
+}
+
+void setGuestThreadPrioritiesEnabled(bool enable, bool is_game_specific) {
+    guestThreadPriorities.set(enable, is_game_specific);
+}
+
+std::string getGuestCores() {
+    return guestCores.get();
+}
+
+void setGuestCores(const std::string& value, bool is_game_specific) {
+    guestCores.set(value, is_game_specific);
+}
+
+bool isMappedGameFileReadsEnabled() {
+    return mappedGameFileReads.get();
+}
+
+void setMappedGameFileReadsEnabled(bool enable, bool is_game_specific) {
+    mappedGameFileReads.set(enable, is_game_specific);
+}
+
+bool isPreciseSleepEnabled() {
+    return preciseSleep.get();
+}
+
+void setPreciseSleepEnabled(bool enable, bool is_game_specific) {
+    preciseSleep.set(enable, is_game_specific);
+}
+
+int getOutputLatencyTarget() {
+    return outputLatencyTarget.get();
+}
+
+void setOutputLatencyTarget(int value, bool is_game_specific) {
+    outputLatencyTarget.set(value, is_game_specific);
+}
+
+bool getMixAudioPorts() {
+    return mixAudioPorts.get();
+}
+
+void setMixAudioPorts(bool enable, bool is_game_specific) {
+    mixAudioPorts.set(enable, is_game_specific);
+}
+
+bool isAudioStatsEnabled() {
+    return audioStats.get();
+}
+
+void setAudioStatsEnabled(bool enable, bool is_game_specific) {
+    audioStats.set(enable, is_game_specific);
+}
+
+std::string getMetricsSink() {
+    return metricsSink.get();
+}
+
+void setMetricsSink(const std::string& value, bool is_game_specific) {
+    metricsSink.set(value, is_game_specific);
+}
+
+u32 getMetricsPort() {
+    return metricsPort.get();
+}
+
+void setMetricsPort(u32 port, bool is_game_specific) {
+    metricsPort.set(port, is_game_specific);
+}
+
+std::string getVideoDecoder() {
+    return videoDecoder.get();
+}
+
+void setVideoDecoder(const std::string& value, bool is_game_specific) {
+    videoDecoder.set(value, is_game_specific);
+}
+
+int getAvPlayerReadAheadMbytes() {
+    return avPlayerReadAheadMbytes.get();
+}
+
+void setAvPlayerReadAheadMbytes(int value, bool is_game_specific) {
+    avPlayerReadAheadMbytes.set(value, is_game_specific);
+}
+
+bool isPlayGoPrefetchEnabled() {
+    return playGoPrefetch.get();
+}
+
+void setPlayGoPrefetchEnabled(bool enable, bool is_game_specific) {
+    playGoPrefetch.set(enable, is_game_specific);
+}
+
 void load(const std::filesystem::path& path, bool is_game_specific) {
     // If the configuration file does not exist, create it and return, unless it is game specific
     std::error_code error;
@@ -912,6 +1353,15 @@ void load(const std::filesystem::path& path, bool is_game_specific) {
         isConnectedToNetwork.setFromToml(general, "isConnectedToNetwork", is_game_specific);
         defaultControllerID.setFromToml(general, "defaultControllerID", is_game_specific);
         sys_modules_path = toml::find_fs_path_or(general, "sysModulesPath", sys_modules_path);
+        lazyImportBinding.setFromToml(general, "lazyImportBinding", is_game_specific);
+        directMemoryHugePages.setFromToml(general, "directMemoryHugePages", is_game_specific);
+        prefaultMemoryMbytes.setFromToml(general, "prefaultMemoryMbytes", is_game_specific);
+        guestThreadPriorities.setFromToml(general, "guestThreadPriorities", is_game_specific);
+        guestCores.setFromToml(general, "guestCores", is_game_specific);
+        mappedGameFileReads.setFromToml(general, "mappedGameFileReads", is_game_specific);
+        preciseSleep.setFromToml(general, "preciseSleep", is_game_specific);
+        avPlayerReadAheadMbytes.setFromToml(general, "avPlayerReadAheadMbytes", is_game_specific);
+        playGoPrefetch.setFromToml(general, "playGoPrefetch", is_game_specific);
     }
 
     if (data.contains("Input")) {
@@ -933,6 +1383,8 @@ void load(const std::filesystem::path& path, bool is_game_specific) {
         micDevice.setFromToml(audio, "micDevice", is_game_specific);
         mainOutputDevice.setFromToml(audio, "mainOutputDevice", is_game_specific);
         padSpkOutputDevice.setFromToml(audio, "padSpkOutputDevice", is_game_specific);
+        outputLatencyTarget.setFromToml(audio, "outputLatencyTarget", is_game_specific);
+        mixAudioPorts.setFromToml(audio, "mixAudioPorts", is_game_specific);
     }
 
     if (data.contains("GPU")) {
@@ -960,6 +1412,26 @@ void load(const std::filesystem::path& path, bool is_game_specific) {
         dlssEnabled.setFromToml(gpu, "dlssEnabled", is_game_specific);
         dlssQuality.setFromToml(gpu, "dlssQuality", is_game_specific);
         dlssFrameGenEnabled.setFromToml(gpu, "dlssFrameGenEnabled", is_game_specific);
+        pipelinedCommandProcessing.setFromToml(gpu, "pipelinedCommandProcessing", is_game_specific);
+        indirectBufferCache.setFromToml(gpu, "indirectBufferCache", is_game_specific);
+        drawCoalescing.setFromToml(gpu, "drawCoalescing", is_game_specific);
+        transferQueueUploads.setFromToml(gpu, "transferQueueUploads", is_game_specific);
+        hostMemoryImport.setFromToml(gpu, "hostMemoryImport", is_game_specific);
+        speculativeReadbacks.setFromToml(gpu, "speculativeReadbacks", is_game_specific);
+        hugePagePageTables.setFromToml(gpu, "hugePagePageTables", is_game_specific);
+        cpuDetiling.setFromToml(gpu, "cpuDetiling", is_game_specific);
+        textureDedup.setFromToml(gpu, "textureDedup", is_game_specific);
+        texturePacks.setFromToml(gpu, "texturePacks", is_game_specific);
+        texturePackBudgetMB.setFromToml(gpu, "texturePackBudgetMB", is_game_specific);
+        sparsePrtImages.setFromToml(gpu, "sparsePrtImages", is_game_specific);
+        imageDemotion.setFromToml(gpu, "imageDemotion", is_game_specific);
+        descriptorBuffer.setFromToml(gpu, "descriptorBuffer", is_game_specific);
+        bindlessSamplers.setFromToml(gpu, "bindlessSamplers", is_game_specific);
+        lowLatencyPresent.setFromToml(gpu, "lowLatencyPresent", is_game_specific);
+        hostVblankSync.setFromToml(gpu, "hostVblankSync", is_game_specific);
+        dynamicResolution.setFromToml(gpu, "dynamicResolution", is_game_specific);
+        dynamicResolutionTargetFps.setFromToml(gpu, "dynamicResolutionTargetFps", is_game_specific);
+        videoDecoder.setFromToml(gpu, "videoDecoder", is_game_specific);
     }
 
     if (data.contains("Vulkan")) {
@@ -974,8 +1446,21 @@ void load(const std::filesystem::path& path, bool is_game_specific) {
         vkHostMarkers.setFromToml(vk, "hostMarkers", is_game_specific);
         vkGuestMarkers.setFromToml(vk, "guestMarkers", is_game_specific);
         rdocEnable.setFromToml(vk, "rdocEnable", is_game_specific);
+        rdocAutoCaptureCpuMs.setFromToml(vk, "rdocAutoCaptureCpuMs", is_game_specific);
+        rdocAutoCaptureGpuMs.setFromToml(vk, "rdocAutoCaptureGpuMs", is_game_specific);
+        rdocAutoCaptureCooldown.setFromToml(vk, "rdocAutoCaptureCooldown", is_game_specific);
+        rdocAutoCaptureLimit.setFromToml(vk, "rdocAutoCaptureLimit", is_game_specific);
         pipelineCacheEnable.setFromToml(vk, "pipelineCacheEnable", is_game_specific);
         pipelineCacheArchive.setFromToml(vk, "pipelineCacheArchive", is_game_specific);
+        pipelineCompileWorkers.setFromToml(vk, "pipelineCompileWorkers", is_game_specific);
+        pipelineSkipPendingDraws.setFromToml(vk, "pipelineSkipPendingDraws", is_game_specific);
+        pipelineCachePack.setFromToml(vk, "pipelineCachePack", is_game_specific);
+        pipelineLibraries.setFromToml(vk, "pipelineLibraries", is_game_specific);
+        dynamicInstanceStepRates.setFromToml(vk, "dynamicInstanceStepRates", is_game_specific);
+        vkGpuTimestamps.setFromToml(vk, "gpuTimestamps", is_game_specific);
+        tieredShaderCompilation.setFromToml(vk, "tieredShaderCompilation", is_game_specific);
+        loopInvariantCodeMotion.setFromToml(vk, "loopInvariantCodeMotion", is_game_specific);
+        fp64Mode.setFromToml(vk, "fp64Mode", is_game_specific);
     }
 
     string current_version = {};
@@ -988,6 +1473,11 @@ void load(const std::filesystem::path& path, bool is_game_specific) {
         showFpsCounter.setFromToml(debug, "showFpsCounter", is_game_specific);
         logEnabled.setFromToml(debug, "logEnabled", is_game_specific);
         current_version = toml::find_or<std::string>(debug, "ConfigVersion", current_version);
+        pm4Profiling.setFromToml(debug, "PM4Profiling", is_game_specific);
+        bufferCacheStats.setFromToml(debug, "BufferCacheStats", is_game_specific);
+        audioStats.setFromToml(debug, "AudioStats", is_game_specific);
+        metricsSink.setFromToml(debug, "MetricsSink", is_game_specific);
+        metricsPort.setFromToml(debug, "MetricsPort", is_game_specific);
     }
 
     if (data.contains("GUI")) {
@@ -1105,6 +1595,16 @@ void save(const std::filesystem::path& path, bool is_game_specific) {
     }
     isPSNSignedIn.setTomlValue(data, "General", "isPSNSignedIn", is_game_specific);
     isConnectedToNetwork.setTomlValue(data, "General", "isConnectedToNetwork", is_game_specific);
+    lazyImportBinding.setTomlValue(data, "General", "lazyImportBinding", is_game_specific);
+    directMemoryHugePages.setTomlValue(data, "General", "directMemoryHugePages", is_game_specific);
+    prefaultMemoryMbytes.setTomlValue(data, "General", "prefaultMemoryMbytes", is_game_specific);
+    guestThreadPriorities.setTomlValue(data, "General", "guestThreadPriorities", is_game_specific);
+    guestCores.setTomlValue(data, "General", "guestCores", is_game_specific);
+    mappedGameFileReads.setTomlValue(data, "General", "mappedGameFileReads", is_game_specific);
+    preciseSleep.setTomlValue(data, "General", "preciseSleep", is_game_specific);
+    avPlayerReadAheadMbytes.setTomlValue(data, "General", "avPlayerReadAheadMbytes",
+                                         is_game_specific);
+    playGoPrefetch.setTomlValue(data, "General", "playGoPrefetch", is_game_specific);
 
     cursorState.setTomlValue(data, "Input", "cursorState", is_game_specific);
     cursorHideTimeout.setTomlValue(data, "Input", "cursorHideTimeout", is_game_specific);
@@ -1117,6 +1617,8 @@ void save(const std::filesystem::path& path, bool is_game_specific) {
     micDevice.setTomlValue(data, "Audio", "micDevice", is_game_specific);
     mainOutputDevice.setTomlValue(data, "Audio", "mainOutputDevice", is_game_specific);
     padSpkOutputDevice.setTomlValue(data, "Audio", "padSpkOutputDevice", is_game_specific);
+    outputLatencyTarget.setTomlValue(data, "Audio", "outputLatencyTarget", is_game_specific);
+    mixAudioPorts.setTomlValue(data, "Audio", "mixAudioPorts", is_game_specific);
 
     windowWidth.setTomlValue(data, "GPU", "screenWidth", is_game_specific);
     windowHeight.setTomlValue(data, "GPU", "screenHeight", is_game_specific);
@@ -1137,6 +1639,28 @@ void save(const std::filesystem::path& path, bool is_game_specific) {
     dlssQuality.setTomlValue(data, "GPU", "dlssQuality", is_game_specific);
     dlssFrameGenEnabled.setTomlValue(data, "GPU", "dlssFrameGenEnabled", is_game_specific);
     directMemoryAccessEnabled.setTomlValue(data, "GPU", "directMemoryAccess", is_game_specific);
+    pipelinedCommandProcessing.setTomlValue(data, "GPU", "pipelinedCommandProcessing",
+                                            is_game_specific);
+    indirectBufferCache.setTomlValue(data, "GPU", "indirectBufferCache", is_game_specific);
+    drawCoalescing.setTomlValue(data, "GPU", "drawCoalescing", is_game_specific);
+    transferQueueUploads.setTomlValue(data, "GPU", "transferQueueUploads", is_game_specific);
+    hostMemoryImport.setTomlValue(data, "GPU", "hostMemoryImport", is_game_specific);
+    speculativeReadbacks.setTomlValue(data, "GPU", "speculativeReadbacks", is_game_specific);
+    hugePagePageTables.setTomlValue(data, "GPU", "hugePagePageTables", is_game_specific);
+    cpuDetiling.setTomlValue(data, "GPU", "cpuDetiling", is_game_specific);
+    textureDedup.setTomlValue(data, "GPU", "textureDedup", is_game_specific);
+    texturePacks.setTomlValue(data, "GPU", "texturePacks", is_game_specific);
+    texturePackBudgetMB.setTomlValue(data, "GPU", "texturePackBudgetMB", is_game_specific);
+    sparsePrtImages.setTomlValue(data, "GPU", "sparsePrtImages", is_game_specific);
+    imageDemotion.setTomlValue(data, "GPU", "imageDemotion", is_game_specific);
+    descriptorBuffer.setTomlValue(data, "GPU", "descriptorBuffer", is_game_specific);
+    bindlessSamplers.setTomlValue(data, "GPU", "bindlessSamplers", is_game_specific);
+    lowLatencyPresent.setTomlValue(data, "GPU", "lowLatencyPresent", is_game_specific);
+    hostVblankSync.setTomlValue(data, "GPU", "hostVblankSync", is_game_specific);
+    dynamicResolution.setTomlValue(data, "GPU", "dynamicResolution", is_game_specific);
+    dynamicResolutionTargetFps.setTomlValue(data, "GPU", "dynamicResolutionTargetFps",
+                                            is_game_specific);
+    videoDecoder.setTomlValue(data, "GPU", "videoDecoder", is_game_specific);
 
     gpuId.setTomlValue(data, "Vulkan", "gpuId", is_game_specific);
     vkValidation.setTomlValue(data, "Vulkan", "validation", is_game_specific);
@@ -1147,14 +1671,37 @@ void save(const std::filesystem::path& path, bool is_game_specific) {
     vkHostMarkers.setTomlValue(data, "Vulkan", "hostMarkers", is_game_specific);
     vkGuestMarkers.setTomlValue(data, "Vulkan", "guestMarkers", is_game_specific);
     rdocEnable.setTomlValue(data, "Vulkan", "rdocEnable", is_game_specific);
+    rdocAutoCaptureCpuMs.setTomlValue(data, "Vulkan", "rdocAutoCaptureCpuMs", is_game_specific);
+    rdocAutoCaptureGpuMs.setTomlValue(data, "Vulkan", "rdocAutoCaptureGpuMs", is_game_specific);
+    rdocAutoCaptureCooldown.setTomlValue(data, "Vulkan", "rdocAutoCaptureCooldown",
+                                         is_game_specific);
+    rdocAutoCaptureLimit.setTomlValue(data, "Vulkan", "rdocAutoCaptureLimit", is_game_specific);
     pipelineCacheEnable.setTomlValue(data, "Vulkan", "pipelineCacheEnable", is_game_specific);
     pipelineCacheArchive.setTomlValue(data, "Vulkan", "pipelineCacheArchive", is_game_specific);
+    pipelineCompileWorkers.setTomlValue(data, "Vulkan", "pipelineCompileWorkers", is_game_specific);
+    pipelineSkipPendingDraws.setTomlValue(data, "Vulkan", "pipelineSkipPendingDraws",
+                                          is_game_specific);
+    pipelineCachePack.setTomlValue(data, "Vulkan", "pipelineCachePack", is_game_specific);
+    pipelineLibraries.setTomlValue(data, "Vulkan", "pipelineLibraries", is_game_specific);
+    dynamicInstanceStepRates.setTomlValue(data, "Vulkan", "dynamicInstanceStepRates",
+                                          is_game_specific);
+    vkGpuTimestamps.setTomlValue(data, "Vulkan", "gpuTimestamps", is_game_specific);
+    tieredShaderCompilation.setTomlValue(data, "Vulkan", "tieredShaderCompilation",
+                                         is_game_specific);
+    loopInvariantCodeMotion.setTomlValue(data, "Vulkan", "loopInvariantCodeMotion",
+                                         is_game_specific);
+    fp64Mode.setTomlValue(data, "Vulkan", "fp64Mode", is_game_specific);
 
     isDebugDump.setTomlValue(data, "Debug", "DebugDump", is_game_specific);
     isShaderDebug.setTomlValue(data, "Debug", "CollectShader", is_game_specific);
     isSeparateLogFilesEnabled.setTomlValue(data, "Debug", "isSeparateLogFilesEnabled",
                                            is_game_specific);
     logEnabled.setTomlValue(data, "Debug", "logEnabled", is_game_specific);
+    pm4Profiling.setTomlValue(data, "Debug", "PM4Profiling", is_game_specific);
+    bufferCacheStats.setTomlValue(data, "Debug", "BufferCacheStats", is_game_specific);
+    audioStats.setTomlValue(data, "Debug", "AudioStats", is_game_specific);
+    metricsSink.setTomlValue(data, "Debug", "MetricsSink", is_game_specific);
+    metricsPort.setTomlValue(data, "Debug", "MetricsPort", is_game_specific);
 
     m_language.setTomlValue(data, "Settings", "consoleLanguage", is_game_specific);
 
@@ -1243,6 +1790,15 @@ void setDefaultValues(bool is_game_specific) {
     userName.set("shadPS4", is_game_specific);
     isShowSplash.set(false, is_game_specific);
     isSideTrophy.set("right", is_game_specific);
+    lazyImportBinding.set(false, is_game_specific);
+    directMemoryHugePages.set(false, is_game_specific);
+    prefaultMemoryMbytes.set(0, is_game_specific);
+    guestThreadPriorities.set(false, is_game_specific);
+    guestCores.set("", is_game_specific);
+    mappedGameFileReads.set(false, is_game_specific);
+    preciseSleep.set(false, is_game_specific);
+    avPlayerReadAheadMbytes.set(16, is_game_specific);
+    playGoPrefetch.set(true, is_game_specific);
 
     // GS - Input
     cursorState.set(HideCursorState::Idle, is_game_specific);
@@ -1253,6 +1809,8 @@ void setDefaultValues(bool is_game_specific) {
 
     // GS - Audio
     micDevice.set("Default Device", is_game_specific);
+    outputLatencyTarget.set(0, is_game_specific);
+    mixAudioPorts.set(false, is_game_specific);
 
     // GS - GPU
     windowWidth.set(1280, is_game_specific);
@@ -1271,6 +1829,26 @@ void setDefaultValues(bool is_game_specific) {
     dlssEnabled.set(false, is_game_specific);
     dlssQuality.set(2, is_game_specific);
     dlssFrameGenEnabled.set(false, is_game_specific);
+    pipelinedCommandProcessing.set(false, is_game_specific);
+    indirectBufferCache.set(false, is_game_specific);
+    drawCoalescing.set(false, is_game_specific);
+    transferQueueUploads.set(false, is_game_specific);
+    hostMemoryImport.set(false, is_game_specific);
+    speculativeReadbacks.set(false, is_game_specific);
+    hugePagePageTables.set(false, is_game_specific);
+    cpuDetiling.set(true, is_game_specific);
+    textureDedup.set(false, is_game_specific);
+    texturePacks.set(false, is_game_specific);
+    texturePackBudgetMB.set(1024, is_game_specific);
+    sparsePrtImages.set(false, is_game_specific);
+    imageDemotion.set(false, is_game_specific);
+    descriptorBuffer.set(false, is_game_specific);
+    bindlessSamplers.set(false, is_game_specific);
+    lowLatencyPresent.set(false, is_game_specific);
+    hostVblankSync.set(true, is_game_specific);
+    dynamicResolution.set(false, is_game_specific);
+    dynamicResolutionTargetFps.set(60, is_game_specific);
+    videoDecoder.set("auto", is_game_specific);
 
     // GS - Vulkan
     gpuId.set(-1, is_game_specific);
@@ -1282,14 +1860,32 @@ void setDefaultValues(bool is_game_specific) {
     vkHostMarkers.set(false, is_game_specific);
     vkGuestMarkers.set(false, is_game_specific);
     rdocEnable.set(false, is_game_specific);
+    rdocAutoCaptureCpuMs.set(0, is_game_specific);
+    rdocAutoCaptureGpuMs.set(0, is_game_specific);
+    rdocAutoCaptureCooldown.set(30, is_game_specific);
+    rdocAutoCaptureLimit.set(3, is_game_specific);
     pipelineCacheEnable.set(false, is_game_specific);
     pipelineCacheArchive.set(false, is_game_specific);
+    pipelineCompileWorkers.set(0, is_game_specific);
+    pipelineSkipPendingDraws.set(false, is_game_specific);
+    pipelineCachePack.set(false, is_game_specific);
+    pipelineLibraries.set(true, is_game_specific);
+    dynamicInstanceStepRates.set(false, is_game_specific);
+    vkGpuTimestamps.set(false, is_game_specific);
+    tieredShaderCompilation.set(false, is_game_specific);
+    loopInvariantCodeMotion.set(true, is_game_specific);
+    fp64Mode.set("auto", is_game_specific);
 
     // GS - Debug
     isDebugDump.set(false, is_game_specific);
     isShaderDebug.set(false, is_game_specific);
     isSeparateLogFilesEnabled.set(false, is_game_specific);
     logEnabled.set(true, is_game_specific);
+    pm4Profiling.set(false, is_game_specific);
+    bufferCacheStats.set(false, is_game_specific);
+    audioStats.set(false, is_game_specific);
+    metricsSink.set("none", is_game_specific);
+    metricsPort.set(7380, is_game_specific);
 
     // GS - Settings
     m_language.set(1, is_game_specific);
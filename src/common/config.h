@@ -39,6 +39,8 @@ std::string getFullscreenMode();
 void setFullscreenMode(std::string mode, bool is_game_specific = false);
 std::string getPresentMode();
 void setPresentMode(std::string mode, bool is_game_specific = false);
+std::string getVideoDecoder();
+void setVideoDecoder(const std::string& value, bool is_game_specific = false);
 u32 getWindowWidth();
 u32 getWindowHeight();
 void setWindowWidth(u32 width, bool is_game_specific = false);
@@ -49,6 +51,16 @@ void setInternalScreenWidth(u32 width);
 void setInternalScreenHeight(u32 height);
 bool debugDump();
 void setDebugDump(bool enable, bool is_game_specific = false);
+bool isPM4ProfilingEnabled();
+void setPM4ProfilingEnabled(bool enable, bool is_game_specific = false);
+bool isBufferCacheStatsEnabled();
+void setBufferCacheStatsEnabled(bool enable, bool is_game_specific = false);
+bool isAudioStatsEnabled();
+void setAudioStatsEnabled(bool enable, bool is_game_specific = false);
+std::string getMetricsSink();
+void setMetricsSink(const std::string& value, bool is_game_specific = false);
+u32 getMetricsPort();
+void setMetricsPort(u32 port, bool is_game_specific = false);
 s32 getGpuId();
 void setGpuId(s32 selectedGpuId, bool is_game_specific = false);
 bool allowHDR();
@@ -63,6 +75,44 @@ bool nullGpu();
 void setNullGpu(bool enable, bool is_game_specific = false);
 bool copyGPUCmdBuffers();
 void setCopyGPUCmdBuffers(bool enable, bool is_game_specific = false);
+bool isPipelinedCommandProcessing();
+void setPipelinedCommandProcessing(bool enable, bool is_game_specific = false);
+bool isIndirectBufferCacheEnabled();
+void setIndirectBufferCacheEnabled(bool enable, bool is_game_specific = false);
+bool isDrawCoalescingEnabled();
+void setDrawCoalescingEnabled(bool enable, bool is_game_specific = false);
+bool isTransferQueueUploadsEnabled();
+void setTransferQueueUploadsEnabled(bool enable, bool is_game_specific = false);
+bool isHostMemoryImportEnabled();
+void setHostMemoryImportEnabled(bool enable, bool is_game_specific = false);
+bool isSpeculativeReadbacksEnabled();
+void setSpeculativeReadbacksEnabled(bool enable, bool is_game_specific = false);
+bool isHugePagePageTablesEnabled();
+void setHugePagePageTablesEnabled(bool enable, bool is_game_specific = false);
+bool isCpuDetilingEnabled();
+void setCpuDetilingEnabled(bool enable, bool is_game_specific = false);
+bool isTextureDedupEnabled();
+void setTextureDedupEnabled(bool enable, bool is_game_specific = false);
+bool isTexturePacksEnabled();
+void setTexturePacksEnabled(bool enable, bool is_game_specific = false);
+int getTexturePackBudgetMB();
+void setTexturePackBudgetMB(int value, bool is_game_specific = false);
+bool isSparsePrtImagesEnabled();
+void setSparsePrtImagesEnabled(bool enable, bool is_game_specific = false);
+bool isImageDemotionEnabled();
+void setImageDemotionEnabled(bool enable, bool is_game_specific = false);
+bool isDescriptorBufferEnabled();
+void setDescriptorBufferEnabled(bool enable, bool is_game_specific = false);
+bool isBindlessSamplersEnabled();
+void setBindlessSamplersEnabled(bool enable, bool is_game_specific = false);
+bool isLowLatencyPresentEnabled();
+void setLowLatencyPresentEnabled(bool enable, bool is_game_specific = false);
+bool isHostVblankSyncEnabled();
+void setHostVblankSyncEnabled(bool enable, bool is_game_specific = false);
+bool isDynamicResolutionEnabled();
+void setDynamicResolutionEnabled(bool enable, bool is_game_specific = false);
+int getDynamicResolutionTargetFps();
+void setDynamicResolutionTargetFps(int value, bool is_game_specific = false);
 bool readbacks();
 void setReadbacks(bool enable, bool is_game_specific = false);
 bool readbackLinearImages();
@@ -91,14 +141,40 @@ bool getVkHostMarkersEnabled();
 void setVkHostMarkersEnabled(bool enable, bool is_game_specific = false);
 bool getVkGuestMarkersEnabled();
 void setVkGuestMarkersEnabled(bool enable, bool is_game_specific = false);
+bool getVkGpuTimestampsEnabled();
+void setVkGpuTimestampsEnabled(bool enable, bool is_game_specific = false);
 bool getEnableDiscordRPC();
 void setEnableDiscordRPC(bool enable);
 bool isRdocEnabled();
 bool isPipelineCacheEnabled();
 bool isPipelineCacheArchived();
 void setRdocEnabled(bool enable, bool is_game_specific = false);
+u32 getRdocAutoCaptureCpuMs();
+void setRdocAutoCaptureCpuMs(u32 ms, bool is_game_specific = false);
+u32 getRdocAutoCaptureGpuMs();
+void setRdocAutoCaptureGpuMs(u32 ms, bool is_game_specific = false);
+u32 getRdocAutoCaptureCooldown();
+void setRdocAutoCaptureCooldown(u32 seconds, bool is_game_specific = false);
+u32 getRdocAutoCaptureLimit();
+void setRdocAutoCaptureLimit(u32 count, bool is_game_specific = false);
 void setPipelineCacheEnabled(bool enable, bool is_game_specific = false);
 void setPipelineCacheArchived(bool enable, bool is_game_specific = false);
+bool isPipelineCachePacked();
+void setPipelineCachePacked(bool enable, bool is_game_specific = false);
+int getPipelineCompileWorkers();
+void setPipelineCompileWorkers(int value, bool is_game_specific = false);
+bool getPipelineSkipPendingDraws();
+void setPipelineSkipPendingDraws(bool enable, bool is_game_specific = false);
+bool isPipelineLibraryEnabled();
+void setPipelineLibraryEnabled(bool enable, bool is_game_specific = false);
+bool isDynamicInstanceStepRatesEnabled();
+void setDynamicInstanceStepRatesEnabled(bool enable, bool is_game_specific = false);
+bool isTieredShaderCompilationEnabled();
+void setTieredShaderCompilationEnabled(bool enable, bool is_game_specific = false);
+bool isLoopInvariantCodeMotionEnabled();
+void setLoopInvariantCodeMotionEnabled(bool enable, bool is_game_specific = false);
+std::string getFp64Mode();
+void setFp64Mode(const std::string& value, bool is_game_specific = false);
 std::string getLogType();
 void setLogType(const std::string& type, bool is_game_specific = false);
 std::string getLogFilter();
@@ -111,6 +187,10 @@ std::string getMainOutputDevice();
 void setMainOutputDevice(std::string device, bool is_game_specific = false);
 std::string getPadSpkOutputDevice();
 void setPadSpkOutputDevice(std::string device, bool is_game_specific = false);
+int getOutputLatencyTarget();
+void setOutputLatencyTarget(int value, bool is_game_specific = false);
+bool getMixAudioPorts();
+void setMixAudioPorts(bool enable, bool is_game_specific = false);
 std::string getMicDevice();
 void setCursorHideTimeout(int newcursorHideTimeout, bool is_game_specific = false);
 void setMicDevice(std::string device, bool is_game_specific = false);
@@ -156,6 +236,24 @@ bool getDlssFrameGenEnabled();
 void setDlssFrameGenEnabled(bool enable, bool is_game_specific = false);
 bool getIsConnectedToNetwork();
 void setConnectedToNetwork(bool enable, bool is_game_specific = false);
+bool isLazyImportBindingEnabled();
+void setLazyImportBindingEnabled(bool enable, bool is_game_specific = false);
+bool isDirectMemoryHugePagesEnabled();
+void setDirectMemoryHugePagesEnabled(bool enable, bool is_game_specific = false);
+int getPrefaultMemoryMbytes();
+void setPrefaultMemoryMbytes(int value, bool is_game_specific = false);
+bool isGuestThreadPrioritiesEnabled();
+void setGuestThreadPrioritiesEnabled(bool enable, bool is_game_specific = false);
+std::string getGuestCores();
+void setGuestCores(const std::string& value, bool is_game_specific = false);
+bool isMappedGameFileReadsEnabled();
+void setMappedGameFileReadsEnabled(bool enable, bool is_game_specific = false);
+int getAvPlayerReadAheadMbytes();
+void setAvPlayerReadAheadMbytes(int value, bool is_game_specific = false);
+bool isPlayGoPrefetchEnabled();
+void setPlayGoPrefetchEnabled(bool enable, bool is_game_specific = false);
+bool isPreciseSleepEnabled();
+void setPreciseSleepEnabled(bool enable, bool is_game_specific = false);
 void setUserName(const std::string& name, bool is_game_specific = false);
 std::filesystem::path getSysModulesPath();
 void setSysModulesPath(const std::filesystem::path& path);
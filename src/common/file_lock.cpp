@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "common/error.h"
+#include "common/file_lock.h"
+#include "common/logging/log.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+namespace Common::FS {
+
+FileLock::~FileLock() {
+    Close();
+}
+
+bool FileLock::Open(const std::filesystem::path& path) {
+    Close();
+#ifdef _WIN32
+    const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                    nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_ERROR(Common_Filesystem, "Failed to open lock {}: {}", path.string(),
+                  GetLastErrorMsg());
+        return false;
+    }
+    handle = file;
+#else
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        LOG_ERROR(Common_Filesystem, "Failed to open lock {}: {}", path.string(),
+                  GetLastErrorMsg());
+        return false;
+    }
+#endif
+    return true;
+}
+
+void FileLock::Close() {
+#ifdef _WIN32
+    if (handle) {
+        // Closing the handle releases its locks
+        CloseHandle(handle);
+        handle = nullptr;
+        is_locked = false;
+    }
+#else
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+bool FileLock::TryLockExclusive() {
+    if (!IsOpen()) {
+        return false;
+    }
+#ifdef _WIN32
+    OVERLAPPED overlapped{};
+    if (is_locked) {
+        UnlockFileEx(handle, 0, 1, 0, &overlapped);
+    }
+    is_locked = LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0, 1, 0,
+                           &overlapped);
+    return is_locked;
+#else
+    return flock(fd, LOCK_EX | LOCK_NB) == 0;
+#endif
+}
+
+bool FileLock::LockShared() {
+    if (!IsOpen()) {
+        return false;
+    }
+#ifdef _WIN32
+    // Windows can't convert a lock in place, the exclusive one is dropped first
+    OVERLAPPED overlapped{};
+    if (is_locked) {
+        UnlockFileEx(handle, 0, 1, 0, &overlapped);
+    }
+    is_locked = LockFileEx(handle, 0, 0, 1, 0, &overlapped);
+    return is_locked;
+#else
+    return flock(fd, LOCK_SH) == 0;
+#endif
+}
+
+} // namespace Common::FS
@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+
+namespace Common::FS {
+
+/// Advisory lock on a file shared between processes. The host releases it when the process
+/// exits, so a crashed process never leaves it held.
+class FileLock {
+public:
+    FileLock() = default;
+    ~FileLock();
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+    /// Opens the lock file, creating it when it doesn't exist. No lock is taken yet.
+    bool Open(const std::filesystem::path& path);
+    void Close();
+
+    /// Takes the lock for this process only, fails right away when another process holds it.
+    /// A shared lock of this process may be lost when this fails.
+    bool TryLockExclusive();
+
+    /// Takes the lock along with other processes, waiting for an exclusive holder to release it.
+    /// An exclusive lock of this process is turned into a shared one.
+    bool LockShared();
+
+    [[nodiscard]] bool IsOpen() const noexcept {
+#ifdef _WIN32
+        return handle != nullptr;
+#else
+        return fd >= 0;
+#endif
+    }
+
+private:
+#ifdef _WIN32
+    void* handle{};
+    bool is_locked{};
+#else
+    int fd{-1};
+#endif
+};
+
+} // namespace Common::FS
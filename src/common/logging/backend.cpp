@@ -2,16 +2,26 @@
 // SPDX-FileCopyrightText: Copyright 2026 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <cstring>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <thread>
+#include <vector>
 
+#include <fmt/args.h>
 #include <fmt/format.h>
 
 #ifdef _WIN32
 #include <windows.h> // For OutputDebugStringW
 #endif
 
+#include "common/alignment.h"
+#include "common/alloc_tracker.h"
 #include "common/bounded_threadsafe_queue.h"
 #include "common/config.h"
 #include "common/debug.h"
@@ -28,6 +38,8 @@ namespace Common::Log {
 
 using namespace Common::FS;
 
+std::array<std::atomic<Level>, static_cast<std::size_t>(Class::Count)> enabled_levels{};
+
 namespace {
 
 /**
@@ -120,6 +132,194 @@ public:
 
 bool initialization_in_progress_suppress_logging = true;
 
+/// Set while the logger thread formats the messages of the log rings
+std::atomic_bool deferred_active{false};
+
+constexpr size_t LOG_RING_SIZE = 128_KB;
+constexpr u16 PADDING_RECORD = 0xFFFF;
+
+/// Message in a log ring, followed by its arguments
+struct RecordHeader {
+    u32 size; ///< Size of the record with its arguments, a multiple of 8
+    u16 num_args;
+    Class log_class;
+    Level log_level;
+    u32 line_num;
+    u32 reserved;
+    s64 timestamp; ///< In microseconds since the start of the logger
+    const char* filename;
+    const char* function;
+    const char* format;
+};
+
+/// Argument in a log ring, followed by the bytes of strings padded to 8
+struct ArgHeader {
+    DeferredArg::Type type;
+    u32 length;
+    u64 value;
+};
+
+/**
+ * Ring of messages written by a single thread and read by the logger thread. The messages are
+ * copied with their arguments, formatting them is left to the logger thread.
+ */
+struct LogRing {
+    explicit LogRing(std::string thread_) : thread{std::move(thread_)} {}
+
+    /// Copies a message into the ring, waiting for space while the logger thread runs.
+    bool Write(const RecordHeader& header, std::span<const DeferredArg> args) {
+        const u64 pos = head.load(std::memory_order_relaxed);
+        const u64 offset = pos % LOG_RING_SIZE;
+        const u64 contiguous = LOG_RING_SIZE - offset;
+        // A record that doesn't fit before the end of the ring starts over at the beginning
+        const u64 needed = header.size + (contiguous < header.size ? contiguous : 0);
+        while (LOG_RING_SIZE - (pos - tail.load(std::memory_order_acquire)) < needed) {
+            if (!deferred_active.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+
+        u8* record = Data() + offset;
+        u64 new_head = pos + header.size;
+        if (contiguous < header.size) {
+            const u32 padding_size = static_cast<u32>(contiguous);
+            std::memcpy(record, &padding_size, sizeof(padding_size));
+            std::memcpy(record + offsetof(RecordHeader, num_args), &PADDING_RECORD,
+                        sizeof(PADDING_RECORD));
+            record = Data();
+            new_head += contiguous;
+        }
+
+        std::memcpy(record, &header, sizeof(header));
+        u8* out = record + sizeof(header);
+        for (const DeferredArg& arg : args) {
+            const ArgHeader arg_header = {
+                .type = arg.type,
+                .length = static_cast<u32>(arg.str.size()),
+                .value = arg.value,
+            };
+            std::memcpy(out, &arg_header, sizeof(arg_header));
+            out += sizeof(arg_header);
+            if (!arg.str.empty()) {
+                std::memcpy(out, arg.str.data(), arg.str.size());
+            }
+            out += Common::AlignUp(arg.str.size(), 8);
+        }
+        head.store(new_head, std::memory_order_release);
+        return true;
+    }
+
+    /// Returns the oldest message in the ring, or nullptr when it is empty.
+    const u8* Peek() {
+        while (true) {
+            const u64 pos = tail.load(std::memory_order_relaxed);
+            if (pos == head.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+            const u8* record = Data() + pos % LOG_RING_SIZE;
+            RecordHeader header;
+            std::memcpy(&header, record, offsetof(RecordHeader, log_class));
+            if (header.num_args != PADDING_RECORD) {
+                return record;
+            }
+            tail.store(pos + header.size, std::memory_order_release);
+        }
+    }
+
+    void Pop(u32 size) {
+        tail.store(tail.load(std::memory_order_relaxed) + size, std::memory_order_release);
+    }
+
+    u8* Data() {
+        return reinterpret_cast<u8*>(buffer.get());
+    }
+
+    std::unique_ptr<u64[]> buffer{new u64[LOG_RING_SIZE / sizeof(u64)]};
+    alignas(64) std::atomic<u64> head{}; ///< Advanced by the owning thread
+    alignas(64) std::atomic<u64> tail{}; ///< Advanced by the logger thread
+    std::atomic_bool abandoned{};        ///< Set when the owning thread exits
+    std::string thread;
+};
+
+std::mutex rings_mutex;
+std::vector<std::shared_ptr<LogRing>> rings;
+std::atomic_bool rings_pending{false};
+
+/// Hands the ring of a thread back to the logger thread when the thread exits
+struct LogRingHolder {
+    ~LogRingHolder() {
+        if (ring) {
+            ring->abandoned.store(true, std::memory_order_release);
+        }
+    }
+
+    std::shared_ptr<LogRing> ring;
+};
+
+LogRing& GetThreadRing() {
+    thread_local LogRingHolder holder;
+    if (!holder.ring) {
+        holder.ring = std::make_shared<LogRing>(Common::GetCurrentThreadName());
+        std::scoped_lock lock{rings_mutex};
+        rings.push_back(holder.ring);
+    }
+    return *holder.ring;
+}
+
+u32 RecordSize(std::span<const DeferredArg> args) {
+    size_t size = sizeof(RecordHeader);
+    for (const DeferredArg& arg : args) {
+        size += sizeof(ArgHeader) + Common::AlignUp(arg.str.size(), 8);
+    }
+    return static_cast<u32>(size);
+}
+
+/// Formats a message of a log ring
+std::string FormatRecord(const RecordHeader& header, const u8* args) {
+    using Type = DeferredArg::Type;
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    store.reserve(header.num_args, 0);
+    for (u16 i = 0; i < header.num_args; ++i) {
+        ArgHeader arg;
+        std::memcpy(&arg, args, sizeof(arg));
+        args += sizeof(arg);
+        switch (arg.type) {
+        case Type::Bool:
+            store.push_back(arg.value != 0);
+            break;
+        case Type::Char:
+            store.push_back(static_cast<char>(arg.value));
+            break;
+        case Type::Int:
+            store.push_back(static_cast<s64>(arg.value));
+            break;
+        case Type::UInt:
+            store.push_back(arg.value);
+            break;
+        case Type::Float:
+            store.push_back(std::bit_cast<float>(static_cast<u32>(arg.value)));
+            break;
+        case Type::Double:
+            store.push_back(std::bit_cast<double>(arg.value));
+            break;
+        case Type::Pointer:
+            store.push_back(reinterpret_cast<const void*>(arg.value));
+            break;
+        case Type::String:
+            // The bytes stay in the ring until the message is written
+            store.push_back(std::string_view{reinterpret_cast<const char*>(args), arg.length});
+            args += Common::AlignUp(size_t{arg.length}, 8);
+            break;
+        }
+    }
+    try {
+        return fmt::vformat(header.format, store);
+    } catch (const fmt::format_error& e) {
+        return fmt::format("Could not format \"{}\": {}", header.format, e.what());
+    }
+}
+
 /**
  * Static state as a singleton.
  */
@@ -176,19 +376,37 @@ public:
 
     void SetGlobalFilter(const Filter& f) {
         filter = f;
+        PublishFilter();
     }
 
     void SetColorConsoleBackendEnabled(bool enabled) {
         color_console_backend.SetEnabled(enabled);
     }
 
+    bool DeferEntry(Class log_class, Level log_level, const char* filename, unsigned int line_num,
+                    const char* function, const char* format,
+                    std::span<const DeferredArg> args) {
+        if (!deferred_active.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (!filter.CheckMessage(log_class, log_level) || !Config::getLoggingEnabled()) {
+            return true;
+        }
+        // Messages for the profiler are formatted right away
+        if (log_level >= Level::Warning && IsProfilerConnected()) {
+            return false;
+        }
+        return WriteRecord(log_class, log_level, filename, line_num, function, format, args);
+    }
+
     void PushEntry(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, const char* format, const fmt::format_args& args) {
         if (!filter.CheckMessage(log_class, log_level) || !Config::getLoggingEnabled()) {
             return;
         }
+        Common::ScopedAllocTag alloc_tag{Common::AllocTag::Logging};
 
-        const auto message = fmt::vformat(format, args);
+        auto message = fmt::vformat(format, args);
 
         // Propagate important log messages to the profiler
         if (IsProfilerConnected()) {
@@ -208,6 +426,18 @@ public:
             }
         }
 
+        if (deferred_active.load(std::memory_order_relaxed)) {
+            // Keeps the message in order with the ones formatted on the logger thread
+            constexpr size_t max_size = LOG_RING_SIZE / 4;
+            if (message.size() > max_size) {
+                message.resize(max_size);
+            }
+            const DeferredArg arg = {DeferredArg::Type::String, 0, message};
+            if (WriteRecord(log_class, log_level, filename, line_num, function, "{}", {&arg, 1})) {
+                return;
+            }
+        }
+
         using std::chrono::duration_cast;
         using std::chrono::microseconds;
         using std::chrono::steady_clock;
@@ -232,13 +462,114 @@ public:
 
 private:
     Impl(const std::filesystem::path& file_backend_filename, const Filter& filter_)
-        : filter{filter_}, file_backend{file_backend_filename, should_append} {}
+        : filter{filter_}, file_backend{file_backend_filename, should_append} {
+        PublishFilter();
+    }
+
+    void PublishFilter() {
+        for (size_t i = 0; i < enabled_levels.size(); ++i) {
+            enabled_levels[i].store(filter.GetClassLevel(static_cast<Class>(i)),
+                                    std::memory_order_relaxed);
+        }
+    }
 
     ~Impl() = default;
 
+    bool WriteRecord(Class log_class, Level log_level, const char* filename, unsigned int line_num,
+                     const char* function, const char* format, std::span<const DeferredArg> args) {
+        const u32 size = RecordSize(args);
+        if (size > LOG_RING_SIZE / 2) {
+            return false;
+        }
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        using std::chrono::steady_clock;
+        const RecordHeader header = {
+            .size = size,
+            .num_args = static_cast<u16>(args.size()),
+            .log_class = log_class,
+            .log_level = log_level,
+            .line_num = line_num,
+            .reserved = 0,
+            .timestamp = duration_cast<microseconds>(steady_clock::now() - time_origin).count(),
+            .filename = filename,
+            .function = function,
+            .format = format,
+        };
+        if (!GetThreadRing().Write(header, args)) {
+            return false;
+        }
+        if (!rings_pending.exchange(true, std::memory_order_release)) {
+            rings_pending.notify_one();
+        }
+        return true;
+    }
+
+    /// Formats and writes the messages of all log rings, oldest first.
+    void DrainRings() {
+        std::vector<std::shared_ptr<LogRing>> snapshot;
+        {
+            std::scoped_lock lock{rings_mutex};
+            snapshot = rings;
+        }
+        while (true) {
+            LogRing* oldest_ring = nullptr;
+            RecordHeader oldest;
+            const u8* oldest_record = nullptr;
+            for (const auto& ring : snapshot) {
+                const u8* record = ring->Peek();
+                if (!record) {
+                    continue;
+                }
+                RecordHeader header;
+                std::memcpy(&header, record, sizeof(header));
+                if (!oldest_ring || header.timestamp < oldest.timestamp) {
+                    oldest_ring = ring.get();
+                    oldest = header;
+                    oldest_record = record;
+                }
+            }
+            if (!oldest_ring) {
+                break;
+            }
+            const Entry entry = {
+                .timestamp = std::chrono::microseconds{oldest.timestamp},
+                .log_class = oldest.log_class,
+                .log_level = oldest.log_level,
+                .filename = oldest.filename,
+                .line_num = oldest.line_num,
+                .function = oldest.function,
+                .message = FormatRecord(oldest, oldest_record + sizeof(RecordHeader)),
+                .thread = oldest_ring->thread,
+            };
+            oldest_ring->Pop(oldest.size);
+            ForEachBackend([&entry](auto& backend) { backend.Write(entry); });
+        }
+
+        // Rings of threads that exited are dropped once they are empty
+        std::scoped_lock lock{rings_mutex};
+        std::erase_if(rings, [](const std::shared_ptr<LogRing>& ring) {
+            return ring->abandoned.load(std::memory_order_acquire) && !ring->Peek();
+        });
+    }
+
     void StartBackendThread() {
+        if (Config::getLogType() == "deferred") {
+            deferred_active = true;
+            backend_thread = std::jthread([this](std::stop_token stop_token) {
+                Common::SetCurrentThreadName("shadPS4:Log");
+                Common::ScopedAllocTag alloc_tag{Common::AllocTag::Logging};
+                while (!stop_token.stop_requested()) {
+                    rings_pending.wait(false, std::memory_order_acquire);
+                    rings_pending.store(false, std::memory_order_relaxed);
+                    DrainRings();
+                }
+            });
+            return;
+        }
         backend_thread = std::jthread([this](std::stop_token stop_token) {
             Common::SetCurrentThreadName("shadPS4:Log");
+            Common::ScopedAllocTag alloc_tag{Common::AllocTag::Logging};
             Entry entry;
             const auto write_logs = [this, &entry]() {
                 ForEachBackend([&entry](auto& backend) { backend.Write(entry); });
@@ -259,10 +590,18 @@ private:
     }
 
     void StopBackendThread() {
+        const bool was_deferred = deferred_active.exchange(false);
         backend_thread.request_stop();
+        if (was_deferred) {
+            rings_pending = true;
+            rings_pending.notify_one();
+        }
         if (backend_thread.joinable()) {
             backend_thread.join();
         }
+        if (was_deferred) {
+            DrainRings();
+        }
 
         ForEachBackend([](auto& backend) { backend.Flush(); });
     }
@@ -328,6 +667,16 @@ void SetAppend() {
     Impl::SetAppend();
 }
 
+bool DeferLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
+                     const char* function, const char* format,
+                     std::initializer_list<DeferredArg> args) {
+    if (initialization_in_progress_suppress_logging) [[unlikely]] {
+        return true;
+    }
+    return Impl::Instance().DeferEntry(log_class, log_level, filename, line_num, function, format,
+                                       {args.begin(), args.size()});
+}
+
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args) {
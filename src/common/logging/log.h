@@ -5,7 +5,12 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <initializer_list>
+#include <string>
 #include <string_view>
+#include <type_traits>
 
 #include "common/logging/formatter.h"
 #include "common/logging/types.h"
@@ -20,14 +25,115 @@ constexpr const char* TrimSourcePath(std::string_view source) {
     return source.data() + idx;
 }
 
+// Lowest level compiled in, as the index of a Level. LOG_COMPILED_CLASS_LEVELS can raise it for
+// single classes, as a sequence of LOG_CLASS_LEVEL(<class>, <level>).
+#ifndef LOG_COMPILED_LEVEL
+#ifdef _DEBUG
+#define LOG_COMPILED_LEVEL 0
+#else
+#define LOG_COMPILED_LEVEL 1
+#endif
+#endif
+
+/// Returns the lowest level of log_class that is compiled in
+constexpr Level CompiledLevel([[maybe_unused]] Class log_class) {
+#ifdef LOG_COMPILED_CLASS_LEVELS
+#define LOG_CLASS_LEVEL(cls, level)                                                                \
+    if (log_class == Class::cls) {                                                                 \
+        return Level::level;                                                                       \
+    }
+    LOG_COMPILED_CLASS_LEVELS
+#undef LOG_CLASS_LEVEL
+#endif
+    return static_cast<Level>(LOG_COMPILED_LEVEL);
+}
+
+/// Lowest level of every class that passes the global filter, checked before the arguments of a
+/// message are evaluated
+extern std::array<std::atomic<Level>, static_cast<std::size_t>(Class::Count)> enabled_levels;
+
+template <Class log_class, Level log_level>
+bool IsLevelEnabled() {
+    if constexpr (static_cast<u8>(log_level) < static_cast<u8>(CompiledLevel(log_class))) {
+        return false;
+    } else {
+        return static_cast<u8>(log_level) >=
+               static_cast<u8>(enabled_levels[static_cast<std::size_t>(log_class)].load(
+                   std::memory_order_relaxed));
+    }
+}
+
 /// Logs a message to the global logger, using fmt
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args);
 
+/// Argument of a message that is formatted on the logger thread, see DeferLogMessage
+struct DeferredArg {
+    enum class Type : u8 { Bool, Char, Int, UInt, Float, Double, Pointer, String };
+    Type type;
+    u64 value;            ///< Bits of scalar arguments
+    std::string_view str; ///< Contents of string arguments, copied when the message is queued
+};
+
+template <typename T>
+concept DeferrableString = std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> ||
+                           std::is_same_v<T, const char*> || std::is_same_v<T, char*> ||
+                           (std::is_array_v<T> &&
+                            std::is_same_v<std::remove_cv_t<std::remove_extent_t<T>>, char>);
+
+/// Arguments that can be copied by value. Anything else, e.g. types with their own formatter or
+/// views into the caller's memory, is formatted on the calling thread.
+template <typename T>
+concept DeferrableArg =
+    std::is_same_v<T, bool> || std::is_same_v<T, char> || std::is_same_v<T, float> ||
+    std::is_same_v<T, double> || std::is_same_v<T, void*> || std::is_same_v<T, const void*> ||
+    (std::is_integral_v<T> && sizeof(T) <= sizeof(u64) && !std::is_same_v<T, wchar_t> &&
+     !std::is_same_v<T, char8_t> && !std::is_same_v<T, char16_t> &&
+     !std::is_same_v<T, char32_t>) ||
+    DeferrableString<T>;
+
+template <DeferrableArg T>
+DeferredArg MakeDeferredArg(const T& arg) {
+    using Type = DeferredArg::Type;
+    if constexpr (DeferrableString<T>) {
+        if constexpr (std::is_pointer_v<T>) {
+            return {Type::String, 0, arg ? std::string_view{arg} : std::string_view{"(null)"}};
+        } else {
+            return {Type::String, 0, std::string_view{arg}};
+        }
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return {Type::Bool, arg};
+    } else if constexpr (std::is_same_v<T, char>) {
+        return {Type::Char, static_cast<u8>(arg)};
+    } else if constexpr (std::is_same_v<T, float>) {
+        return {Type::Float, std::bit_cast<u32>(arg)};
+    } else if constexpr (std::is_same_v<T, double>) {
+        return {Type::Double, std::bit_cast<u64>(arg)};
+    } else if constexpr (std::is_pointer_v<T>) {
+        return {Type::Pointer, reinterpret_cast<uintptr_t>(arg)};
+    } else if constexpr (std::is_signed_v<T>) {
+        return {Type::Int, static_cast<u64>(static_cast<s64>(arg))};
+    } else {
+        return {Type::UInt, static_cast<u64>(arg)};
+    }
+}
+
+/// Copies a message into the log ring of the calling thread, to be formatted on the logger
+/// thread. Returns false when the message is not deferred, it must then be formatted here.
+bool DeferLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
+                     const char* function, const char* format,
+                     std::initializer_list<DeferredArg> args);
+
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, const char* format, const Args&... args) {
+    if constexpr ((DeferrableArg<Args> && ...)) {
+        if (DeferLogMessage(log_class, log_level, filename, line_num, function, format,
+                            {MakeDeferredArg(args)...})) {
+            return;
+        }
+    }
     FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
                       fmt::make_format_args(args...));
 }
@@ -39,32 +145,22 @@ void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsig
     Common::Log::FmtLogMessage(log_class, log_level, Common::Log::TrimSourcePath(__FILE__),        \
                                __LINE__, __func__, __VA_ARGS__)
 
-#ifdef _DEBUG
-#define LOG_TRACE(log_class, ...)                                                                  \
-    Common::Log::FmtLogMessage(Common::Log::Class::log_class, Common::Log::Level::Trace,           \
-                               Common::Log::TrimSourcePath(__FILE__), __LINE__, __func__,          \
-                               __VA_ARGS__)
+#define LOG_IF_ENABLED(log_class, log_level, ...)                                                  \
+    (Common::Log::IsLevelEnabled<Common::Log::Class::log_class, Common::Log::Level::log_level>()   \
+         ? Common::Log::FmtLogMessage(Common::Log::Class::log_class,                               \
+                                      Common::Log::Level::log_level,                               \
+                                      Common::Log::TrimSourcePath(__FILE__), __LINE__, __func__,   \
+                                      __VA_ARGS__)                                                 \
+         : void())
+
+#if LOG_COMPILED_LEVEL == 0
+#define LOG_TRACE(log_class, ...) LOG_IF_ENABLED(log_class, Trace, __VA_ARGS__)
 #else
 #define LOG_TRACE(log_class, fmt, ...) (void(0))
 #endif
 
-#define LOG_DEBUG(log_class, ...)                                                                  \
-    Common::Log::FmtLogMessage(Common::Log::Class::log_class, Common::Log::Level::Debug,           \
-                               Common::Log::TrimSourcePath(__FILE__), __LINE__, __func__,          \
-                               __VA_ARGS__)
-#define LOG_INFO(log_class, ...)                                                                   \
-    Common::Log::FmtLogMessage(Common::Log::Class::log_class, Common::Log::Level::Info,            \
-                               Common::Log::TrimSourcePath(__FILE__), __LINE__, __func__,          \
-                               __VA_ARGS__)
-#define LOG_WARNING(log_class, ...)                                                                \
-    Common::Log::FmtLogMessage(Common::Log::Class::log_class, Common::Log::Level::Warning,         \
-                               Common::Log::TrimSourcePath(__FILE__), __LINE__, __func__,          \
-                               __VA_ARGS__)
-#define LOG_ERROR(log_class, ...)                                                                  \
-    Common::Log::FmtLogMessage(Common::Log::Class::log_class, Common::Log::Level::Error,           \
-                               Common::Log::TrimSourcePath(__FILE__), __LINE__, __func__,          \
-                               __VA_ARGS__)
-#define LOG_CRITICAL(log_class, ...)                                                               \
-    Common::Log::FmtLogMessage(Common::Log::Class::log_class, Common::Log::Level::Critical,        \
-                               Common::Log::TrimSourcePath(__FILE__), __LINE__, __func__,          \
-                               __VA_ARGS__)
+#define LOG_DEBUG(log_class, ...) LOG_IF_ENABLED(log_class, Debug, __VA_ARGS__)
+#define LOG_INFO(log_class, ...) LOG_IF_ENABLED(log_class, Info, __VA_ARGS__)
+#define LOG_WARNING(log_class, ...) LOG_IF_ENABLED(log_class, Warning, __VA_ARGS__)
+#define LOG_ERROR(log_class, ...) LOG_IF_ENABLED(log_class, Error, __VA_ARGS__)
+#define LOG_CRITICAL(log_class, ...) LOG_IF_ENABLED(log_class, Critical, __VA_ARGS__)
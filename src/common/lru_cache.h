@@ -5,6 +5,7 @@
 
 #include <deque>
 #include <type_traits>
+#include <vector>
 
 #include "common/types.h"
 
@@ -56,7 +57,7 @@ public:
     template <typename Func>
     void ForEachItemBelow(TickType tick, Func&& func) {
         static constexpr bool RETURNS_BOOL =
-            std::is_same_v<std::invoke_result<Func, ObjectType>, bool>;
+            std::is_same_v<std::invoke_result_t<Func, ObjectType>, bool>;
         Item* iterator = first_item;
         while (iterator) {
             if (static_cast<s64>(tick) - static_cast<s64>(iterator->tick) < 0) {
@@ -132,4 +133,144 @@ private:
     Item* last_item{};
 };
 
+/// Variant of LeastRecentlyUsedCache for caches touched many times per tick. A touch only stores
+/// the tick in the item and, the first time in a tick, appends the item to the bucket of the
+/// tick. Entries left behind in older buckets are skipped when the buckets are scanned.
+template <typename ObjectType, typename TickType>
+class GenerationalLruCache {
+    struct Item {
+        ObjectType obj;
+        TickType tick;
+        u32 version{}; ///< Bumped when the item is freed, invalidating its bucket entries
+        bool live{};
+    };
+
+    struct Entry {
+        size_t id;
+        u32 version;
+    };
+
+    struct Bucket {
+        TickType tick;
+        std::vector<Entry> entries;
+    };
+
+public:
+    size_t Insert(ObjectType obj, TickType tick) {
+        size_t id;
+        if (free_items.empty()) {
+            id = item_pool.size();
+            item_pool.emplace_back();
+        } else {
+            id = free_items.back();
+            free_items.pop_back();
+        }
+        auto& item = item_pool[id];
+        item.obj = obj;
+        item.tick = tick;
+        item.live = true;
+        ++num_live;
+        Append(id, item);
+        return id;
+    }
+
+    void Touch(size_t id, TickType tick) {
+        auto& item = item_pool[id];
+        if (item.tick >= tick) {
+            return;
+        }
+        item.tick = tick;
+        Append(id, item);
+    }
+
+    void Free(size_t id) {
+        auto& item = item_pool[id];
+        ++item.version;
+        item.live = false;
+        --num_live;
+        free_items.push_back(id);
+    }
+
+    template <typename Func>
+    void ForEachItemBelow(TickType tick, Func&& func) {
+        static constexpr bool RETURNS_BOOL =
+            std::is_same_v<std::invoke_result_t<Func, ObjectType>, bool>;
+        // Buckets are only appended while scanning, so references stay valid
+        scanning = true;
+        size_t b = 0;
+        for (; b < buckets.size(); ++b) {
+            Bucket& bucket = buckets[b];
+            if (static_cast<s64>(tick) - static_cast<s64>(bucket.tick) < 0) {
+                break;
+            }
+            for (size_t e = 0; e < bucket.entries.size(); ++e) {
+                const Entry entry = bucket.entries[e];
+                const Item& item = item_pool[entry.id];
+                if (!IsCurrent(entry, item, bucket.tick)) {
+                    continue;
+                }
+                if constexpr (RETURNS_BOOL) {
+                    if (func(item.obj)) {
+                        scanning = false;
+                        Compact(b + 1);
+                        return;
+                    }
+                } else {
+                    func(item.obj);
+                }
+            }
+        }
+        scanning = false;
+        Compact(b);
+    }
+
+private:
+    bool IsCurrent(const Entry& entry, const Item& item, TickType bucket_tick) const {
+        return item.live && item.version == entry.version && item.tick == bucket_tick;
+    }
+
+    void Append(size_t id, const Item& item) {
+        if (buckets.empty() || buckets.back().tick != item.tick) {
+            // Stale entries are dropped once they outnumber the items, keeping touches O(1)
+            if (!scanning && num_entries > 2 * num_live + 1024) {
+                Compact(buckets.size());
+            }
+            buckets.push_back({.tick = item.tick, .entries = {}});
+        }
+        buckets.back().entries.push_back({id, item.version});
+        ++num_entries;
+    }
+
+    /// Drops the stale entries of the oldest num_buckets buckets, and the buckets left empty.
+    void Compact(size_t num_buckets) {
+        size_t out = 0;
+        for (size_t b = 0; b < buckets.size(); ++b) {
+            Bucket& bucket = buckets[b];
+            if (b < num_buckets) {
+                num_entries -= std::erase_if(bucket.entries, [&](const Entry& entry) {
+                    return !IsCurrent(entry, item_pool[entry.id], bucket.tick);
+                });
+                if (bucket.entries.empty()) {
+                    continue;
+                }
+            } else if (out == b) {
+                // Nothing to move past the compacted buckets
+                return;
+            }
+            if (out != b) {
+                buckets[out] = std::move(bucket);
+            }
+            ++out;
+        }
+        buckets.resize(out);
+    }
+
+    std::deque<Item> item_pool;
+    std::vector<size_t> free_items;
+    std::deque<Bucket> buckets;
+    size_t num_entries{};
+    size_t num_live{};
+    bool scanning{};
+};
+
 } // namespace Common
@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+#include "common/types.h"
+
+namespace Common::FS {
+
+/// Read-only memory mapping of a whole file. The view stays valid until the object is
+/// destroyed or Close() is called.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool Open(const std::filesystem::path& path);
+    void Close();
+
+    /// Hints the host to read a range of the file ahead of its first access.
+    void Prefetch(size_t offset, size_t length) const;
+
+    [[nodiscard]] bool IsOpen() const noexcept {
+        return data != nullptr;
+    }
+
+    [[nodiscard]] size_t Size() const noexcept {
+        return size;
+    }
+
+    [[nodiscard]] std::span<const u8> View() const noexcept {
+        return {data, size};
+    }
+
+    [[nodiscard]] std::span<const u8> View(size_t offset, size_t length) const noexcept {
+        if (offset > size || length > size - offset) {
+            return {};
+        }
+        return {data + offset, length};
+    }
+
+private:
+    const u8* data{};
+    size_t size{};
+#ifdef _WIN32
+    void* mapping_handle{};
+#endif
+};
+
+} // namespace Common::FS
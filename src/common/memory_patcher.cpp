@@ -2,14 +2,19 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <charconv>
 #include <codecvt>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <nlohmann/json.hpp>
 #include <pugixml.hpp>
+#include <xxhash.h>
 #include "common/config.h"
 #include "common/elf_info.h"
+#include "common/io_file.h"
 #include "common/logging/log.h"
 #include "common/path_util.h"
 #include "core/emulator_state.h"
@@ -25,6 +30,26 @@ std::string patch_file;
 bool patches_applied = false;
 std::vector<patchInfo> pending_patches;
 
+/// Signature compiled to the bytes it matches and a mask of the ones that aren't wildcards
+struct CompiledPattern {
+    std::vector<u8> bytes;
+    std::vector<u8> mask;
+    size_t anchor = 0; ///< Index of the fixed byte searched for first
+};
+
+/// Offsets the pattern scans of the pending patches found, saved per eboot and patch list. Scans
+/// are keyed by their signature and how many scans with it came before, since applying patches
+/// changes what later scans find.
+struct ScanCache {
+    std::string key;
+    std::unordered_map<std::string, u64> offsets;
+    std::unordered_map<std::string, u32> num_scans;
+    bool dirty = false;
+};
+
+static std::unordered_map<std::string, CompiledPattern> compiled_patterns;
+static ScanCache* scan_cache = nullptr;
+
 std::string toHex(u64 value, size_t byteSize) {
     std::stringstream ss;
     ss << std::hex << std::setfill('0') << std::setw(byteSize * 2) << value;
@@ -225,8 +250,77 @@ void AddPatchToQueue(patchInfo patchToAdd) {
     pending_patches.push_back(patchToAdd);
 }
 
+static std::filesystem::path GetScanCachePath() {
+    return Common::FS::GetUserPath(Common::FS::PathType::MetaDataDir) / g_game_serial /
+           "patch_offsets.txt";
+}
+
+// The first line holds the key, then one line per scan with the offset and the scan key
+// separated by a tab
+static void LoadScanCache(ScanCache& cache) {
+    Common::FS::IOFile file{GetScanCachePath(), Common::FS::FileAccessMode::Read,
+                            Common::FS::FileType::TextFile};
+    if (!file.IsOpen()) {
+        return;
+    }
+    std::string contents(file.GetSize(), '\0');
+    contents.resize(file.ReadRaw<char>(contents.data(), contents.size()));
+    std::string_view view{contents};
+    const size_t key_end = view.find('\n');
+    if (key_end == std::string_view::npos || view.substr(0, key_end) != cache.key) {
+        return;
+    }
+    view.remove_prefix(key_end + 1);
+    while (!view.empty()) {
+        const size_t line_end = std::min(view.find('\n'), view.size());
+        const std::string_view line = view.substr(0, line_end);
+        u64 offset{};
+        const auto [end, ec] = std::from_chars(line.data(), line.data() + line.size(), offset, 16);
+        if (ec == std::errc{} && end < line.data() + line.size() && *end == '\t') {
+            cache.offsets.emplace(std::string{end + 1, line.data() + line.size()}, offset);
+        }
+        view.remove_prefix(std::min(line_end + 1, view.size()));
+    }
+}
+
+static void SaveScanCache(const ScanCache& cache) {
+    std::string contents = cache.key + '\n';
+    for (const auto& [scan_key, offset] : cache.offsets) {
+        contents += fmt::format("{:x}\t{}\n", offset, scan_key);
+    }
+    const auto path = GetScanCachePath();
+    std::filesystem::create_directories(path.parent_path());
+    Common::FS::IOFile file{path, Common::FS::FileAccessMode::Create,
+                            Common::FS::FileType::TextFile};
+    file.WriteString(contents);
+}
+
 void ApplyPendingPatches() {
     patches_applied = true;
+
+    // The offsets found last time hold as long as the eboot and the patches are the same
+    XXH3_state_t* state = XXH3_createState();
+    XXH3_64bits_reset(state);
+    for (const patchInfo& patch : pending_patches) {
+        for (const std::string* str : {&patch.gameSerial, &patch.modNameStr, &patch.offsetStr,
+                                       &patch.valueStr, &patch.targetStr, &patch.sizeStr}) {
+            XXH3_64bits_update(state, str->data(), str->size() + 1);
+        }
+        const std::array<int, 4> values = {patch.isOffset, patch.littleEndian, patch.patchMask,
+                                           patch.maskOffset};
+        XXH3_64bits_update(state, values.data(), sizeof(values));
+    }
+    const u64 patches_hash = XXH3_64bits_digest(state);
+    XXH3_freeState(state);
+    ScanCache cache;
+    if (g_eboot_address != 0) {
+        const u64 eboot_hash =
+            XXH3_64bits(reinterpret_cast<const void*>(g_eboot_address), g_eboot_image_size);
+        cache.key = fmt::format("{:016x} {:016x}", eboot_hash, patches_hash);
+        LoadScanCache(cache);
+        scan_cache = &cache;
+    }
+
     for (size_t i = 0; i < pending_patches.size(); ++i) {
         const patchInfo& currentPatch = pending_patches[i];
 
@@ -238,7 +332,12 @@ void ApplyPendingPatches() {
                     currentPatch.littleEndian, currentPatch.patchMask, currentPatch.maskOffset);
     }
 
+    scan_cache = nullptr;
+    if (cache.dirty) {
+        SaveScanCache(cache);
+    }
     pending_patches.clear();
+    compiled_patterns.clear();
 }
 
 void PatchMemory(std::string modNameStr, std::string offsetStr, std::string valueStr,
@@ -362,49 +461,104 @@ void PatchMemory(std::string modNameStr, std::string offsetStr, std::string valu
              (uintptr_t)cheatAddress, valueStr);
 }
 
-static std::vector<int32_t> PatternToByte(const std::string& pattern) {
-    std::vector<int32_t> bytes;
-    const char* start = pattern.data();
-    const char* end = start + pattern.size();
-
-    for (const char* current = start; current < end; ++current) {
-        if (*current == '?') {
+static const CompiledPattern& CompilePattern(const std::string& signature) {
+    if (const auto it = compiled_patterns.find(signature); it != compiled_patterns.end()) {
+        return it->second;
+    }
+    CompiledPattern pattern;
+    const char* current = signature.data();
+    const char* end = current + signature.size();
+    while (current < end) {
+        if (*current == ' ') {
             ++current;
-            if (*current == '?')
-                ++current;
-            bytes.push_back(-1);
+        } else if (*current == '?') {
+            current += current + 1 < end && current[1] == '?' ? 2 : 1;
+            pattern.bytes.push_back(0);
+            pattern.mask.push_back(0);
         } else {
-            bytes.push_back(strtoul(current, const_cast<char**>(&current), 16));
+            char* next;
+            pattern.bytes.push_back(static_cast<u8>(std::strtoul(current, &next, 16)));
+            pattern.mask.push_back(0xFF);
+            current = next == current ? current + 1 : next;
+        }
+    }
+    // The first fixed byte that isn't a common opcode or padding byte is searched for, so most
+    // of the code is skipped over
+    const auto is_common = [](u8 byte) {
+        return byte == 0x00 || byte == 0xFF || byte == 0xCC || byte == 0x48 || byte == 0x89 ||
+               byte == 0x8B || byte == 0x0F;
+    };
+    size_t anchor = pattern.bytes.size();
+    for (size_t i = 0; i < pattern.bytes.size(); ++i) {
+        if (pattern.mask[i] == 0) {
+            continue;
+        }
+        if (anchor == pattern.bytes.size() ||
+            (is_common(pattern.bytes[anchor]) && !is_common(pattern.bytes[i]))) {
+            anchor = i;
         }
     }
+    pattern.anchor = anchor == pattern.bytes.size() ? 0 : anchor;
+    return compiled_patterns.emplace(signature, std::move(pattern)).first->second;
+}
 
-    return bytes;
+static bool MatchesAt(const CompiledPattern& pattern, const u8* data) {
+    for (size_t i = 0; i < pattern.bytes.size(); ++i) {
+        if ((data[i] & pattern.mask[i]) != pattern.bytes[i]) {
+            return false;
+        }
+    }
+    return true;
 }
 
 uintptr_t PatternScan(const std::string& signature) {
-    std::vector<int32_t> patternBytes = PatternToByte(signature);
-    const auto scanBytes = static_cast<uint8_t*>((void*)g_eboot_address);
-
-    const int32_t* sigPtr = patternBytes.data();
-    const size_t sigSize = patternBytes.size();
-
-    uint32_t foundResults = 0;
-    for (uint32_t i = 0; i < g_eboot_image_size - sigSize; ++i) {
-        bool found = true;
-        for (uint32_t j = 0; j < sigSize; ++j) {
-            if (scanBytes[i + j] != sigPtr[j] && sigPtr[j] != -1) {
-                found = false;
-                break;
-            }
+    const CompiledPattern& pattern = CompilePattern(signature);
+    const auto scan_bytes = reinterpret_cast<const u8*>(g_eboot_address);
+    const size_t size = pattern.bytes.size();
+    if (size == 0 || size > g_eboot_image_size) {
+        return 0;
+    }
+    const size_t num_positions = g_eboot_image_size - size + 1;
+
+    std::string scan_key;
+    if (scan_cache) {
+        scan_key = fmt::format("{}#{}", signature, scan_cache->num_scans[signature]++);
+        const auto it = scan_cache->offsets.find(scan_key);
+        if (it != scan_cache->offsets.end() && it->second < num_positions &&
+            MatchesAt(pattern, scan_bytes + it->second)) {
+            return reinterpret_cast<uintptr_t>(scan_bytes + it->second);
         }
+    }
 
-        if (found) {
-            foundResults++;
-            return reinterpret_cast<uintptr_t>(&scanBytes[i]);
+    uintptr_t result = 0;
+    if (pattern.mask[pattern.anchor] == 0) {
+        // Only wildcards, everything matches
+        result = reinterpret_cast<uintptr_t>(scan_bytes);
+    } else {
+        // memchr finds the anchor byte with vector compares, only its hits are checked in full
+        const u8 anchor_byte = pattern.bytes[pattern.anchor];
+        const u8* search = scan_bytes + pattern.anchor;
+        const u8* search_end = search + num_positions;
+        while (search < search_end) {
+            const auto hit =
+                static_cast<const u8*>(std::memchr(search, anchor_byte, search_end - search));
+            if (!hit) {
+                break;
+            }
+            const u8* candidate = hit - pattern.anchor;
+            if (MatchesAt(pattern, candidate)) {
+                result = reinterpret_cast<uintptr_t>(candidate);
+                break;
+            }
+            search = hit + 1;
         }
     }
 
-    return 0;
+    if (scan_cache && result != 0) {
+        scan_cache->offsets[scan_key] = result - g_eboot_address;
+        scan_cache->dirty = true;
+    }
+    return result;
 }
 
 } // namespace MemoryPatcher
@@ -1,32 +1,130 @@
 // SPDX-FileCopyrightText: Copyright 2020 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <cstdlib>
+#include "common/logging/log.h"
 #include "common/native_clock.h"
 #include "common/rdtsc.h"
+#include "common/thread.h"
 #include "common/uint128.h"
 
 namespace Common {
 
-NativeClock::NativeClock()
-    : rdtsc_frequency{EstimateRDTSCFrequency()},
-      ns_rdtsc_factor{GetFixedPoint64Factor(std::nano::den, rdtsc_frequency)},
-      us_rdtsc_factor{GetFixedPoint64Factor(std::micro::den, rdtsc_frequency)},
-      ms_rdtsc_factor{GetFixedPoint64Factor(std::milli::den, rdtsc_frequency)} {}
+/// The time conversion is nudged towards the host monotonic clock this often, the difference
+/// measured is spread over the following interval so the clock never jumps.
+static constexpr std::chrono::seconds RecalibrationInterval{10};
 
-u64 NativeClock::GetTimeNS(u64 base_ptc /*= 0*/) const {
-    return MultiplyHigh(GetUptime() - base_ptc, ns_rdtsc_factor);
+static u64 GetHostMonotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
 }
 
-u64 NativeClock::GetTimeUS(u64 base_ptc /*= 0*/) const {
-    return MultiplyHigh(GetUptime() - base_ptc, us_rdtsc_factor);
+NativeClock::NativeClock() {
+    invariant_tsc = HasInvariantTSC();
+    if (invariant_tsc) {
+        rdtsc_frequency = EstimateRDTSCFrequency();
+        // The fixed point factors below need a counter faster than nanoseconds
+        invariant_tsc = rdtsc_frequency > std::nano::den;
+    }
+    if (!invariant_tsc) {
+        LOG_WARNING(Core, "No invariant TSC, guest time is read from the host monotonic clock");
+        rdtsc_frequency = std::nano::den;
+    }
+    start_counter = GetUptime();
+    start_monotonic_ns = GetHostMonotonicNs();
+    if (!invariant_tsc) {
+        return;
+    }
+    calibration.anchor_counter.store(start_counter, std::memory_order_relaxed);
+    calibration.anchor_ns.store(0, std::memory_order_relaxed);
+    calibration.ns_factor.store(GetFixedPoint64Factor(std::nano::den, rdtsc_frequency),
+                                std::memory_order_relaxed);
+    LOG_INFO(Core, "Invariant TSC frequency: {} Hz", rdtsc_frequency);
+
+    recalibration_thread = std::jthread([this](std::stop_token stop) {
+        SetCurrentThreadName("shadPS4:ClockCalibration");
+        while (StoppableTimedWait(stop, RecalibrationInterval)) {
+            Recalibrate();
+        }
+    });
+}
+
+NativeClock::~NativeClock() = default;
+
+u64 NativeClock::GetTimeNS() const {
+    if (!invariant_tsc) {
+        return GetHostMonotonicNs() - start_monotonic_ns;
+    }
+    return CounterToNs(FencedRDTSC());
+}
+
+u64 NativeClock::CounterToNs(u64 counter) const {
+    u32 seq;
+    u64 anchor_counter;
+    u64 anchor_ns;
+    u64 ns_factor;
+    do {
+        seq = sequence.load(std::memory_order_acquire);
+        anchor_counter = calibration.anchor_counter.load(std::memory_order_relaxed);
+        anchor_ns = calibration.anchor_ns.load(std::memory_order_relaxed);
+        ns_factor = calibration.ns_factor.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) != 0 || seq != sequence.load(std::memory_order_relaxed));
+
+    if (counter < anchor_counter) {
+        // Read just before a recalibration moved the anchor
+        return anchor_ns - MultiplyHigh(anchor_counter - counter, ns_factor);
+    }
+    return anchor_ns + MultiplyHigh(counter - anchor_counter, ns_factor);
 }
 
-u64 NativeClock::GetTimeMS(u64 base_ptc /*= 0*/) const {
-    return MultiplyHigh(GetUptime() - base_ptc, ms_rdtsc_factor);
+u64 NativeClock::GetTimeUS() const {
+    return GetTimeNS() / 1'000;
+}
+
+u64 NativeClock::GetTimeMS() const {
+    return GetTimeNS() / 1'000'000;
 }
 
 u64 NativeClock::GetUptime() const {
-    return FencedRDTSC();
+    return invariant_tsc ? FencedRDTSC() : GetHostMonotonicNs();
+}
+
+void NativeClock::Recalibrate() {
+    const u64 counter = FencedRDTSC();
+    const u64 host_ns = GetHostMonotonicNs() - start_monotonic_ns;
+    const u64 clock_ns = CounterToNs(counter);
+    if (host_ns == 0) {
+        return;
+    }
+
+    // Counter ticks over the next interval, at the rate measured since the clock was created.
+    // The conversion is chosen so the clock meets the host clock at its end.
+    static constexpr u64 IntervalNs =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(RecalibrationInterval).count();
+    const u64 interval_ticks = MultiplyAndDivide64(counter - start_counter, IntervalNs, host_ns);
+    const s64 error_ns = static_cast<s64>(clock_ns - host_ns);
+    const s64 max_slew = static_cast<s64>(IntervalNs / 2);
+    const u64 target_ns = IntervalNs - std::clamp(error_ns, -max_slew, max_slew);
+    if (target_ns >= interval_ticks) {
+        return;
+    }
+    const u64 ns_factor = GetFixedPoint64Factor(target_ns, interval_ticks);
+
+    const u32 seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    calibration.anchor_counter.store(counter, std::memory_order_relaxed);
+    calibration.anchor_ns.store(clock_ns, std::memory_order_relaxed);
+    calibration.ns_factor.store(ns_factor, std::memory_order_relaxed);
+    sequence.store(seq + 2, std::memory_order_release);
+
+    if (std::abs(error_ns) > 1'000'000) {
+        LOG_WARNING(Core, "Guest clock drifted {} us from the host monotonic clock",
+                    error_ns / 1'000);
+    }
 }
 
 } // namespace Common
@@ -3,29 +3,63 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include "common/polyfill_thread.h"
 #include "common/types.h"
 
 namespace Common {
 
+/// Clock on the invariant TSC, which is read without a syscall. The counter frequency is
+/// estimated once and stays constant, while the conversion to time is periodically recalibrated
+/// against the host monotonic clock. Hosts without an invariant TSC use the host monotonic clock
+/// in nanoseconds as the counter instead.
 class NativeClock final {
 public:
     explicit NativeClock();
+    ~NativeClock();
 
     u64 GetTscFrequency() const {
         return rdtsc_frequency;
     }
 
-    u64 GetTimeNS(u64 base_ptc = 0) const;
-    u64 GetTimeUS(u64 base_ptc = 0) const;
-    u64 GetTimeMS(u64 base_ptc = 0) const;
+    /// Time elapsed since the clock was created.
+    u64 GetTimeNS() const;
+    u64 GetTimeUS() const;
+    u64 GetTimeMS() const;
+
+    /// Time on the timeline of the host monotonic clock, in nanoseconds.
+    u64 GetMonotonicNS() const {
+        return start_monotonic_ns + GetTimeNS();
+    }
+
+    /// Counter value when the clock was created.
+    u64 GetStartCounter() const {
+        return start_counter;
+    }
+
     u64 GetUptime() const;
 
 private:
+    /// Maps the counter to nanoseconds as anchor_ns + (counter - anchor_counter) * factor / 2^64.
+    /// Written with a sequence lock by the recalibration thread.
+    struct Calibration {
+        std::atomic<u64> anchor_counter;
+        std::atomic<u64> anchor_ns;
+        std::atomic<u64> ns_factor;
+    };
+
+    u64 CounterToNs(u64 counter) const;
+
+    void Recalibrate();
+
+    bool invariant_tsc;
     u64 rdtsc_frequency;
-    u64 ns_rdtsc_factor;
-    u64 us_rdtsc_factor;
-    u64 ms_rdtsc_factor;
+    u64 start_counter;
+    u64 start_monotonic_ns;
+    std::atomic<u32> sequence{};
+    Calibration calibration{};
+    std::jthread recalibration_thread;
 };
 
 } // namespace Common
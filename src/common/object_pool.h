@@ -24,6 +24,15 @@ public:
         return std::construct_at(Memory(), std::forward<Args>(args)...);
     }
 
+    /// Number of objects created since the last release.
+    [[nodiscard]] size_t NumUsedObjects() const noexcept {
+        size_t num_used{};
+        for (const Chunk& chunk : chunks) {
+            num_used += chunk.used_objects;
+        }
+        return num_used;
+    }
+
     void ReleaseContents() {
         if (chunks.empty()) {
             return;
@@ -10,21 +10,22 @@
 namespace Common::FS {
 
 enum class PathType {
-    UserDir,        // Where shadPS4 stores its data.
-    LogDir,         // Where log files are stored.
-    ScreenshotsDir, // Where screenshots are stored.
-    ShaderDir,      // Where shaders are stored.
-    TempDataDir,    // Where game temp data is stored.
-    GameDataDir,    // Where game data is stored.
-    SysModuleDir,   // Where system modules are stored.
-    DownloadDir,    // Where downloads/temp files are stored.
-    CapturesDir,    // Where rdoc captures are stored.
-    CheatsDir,      // Where cheats are stored.
-    PatchesDir,     // Where patches are stored.
-    MetaDataDir,    // Where game metadata (e.g. trophies and menu backgrounds) is stored.
-    CustomTrophy,   // Where custom files for trophies are stored.
-    CustomConfigs,  // Where custom files for different games are stored.
-    CacheDir,       // Where pipeline and shader cache is stored.
+    UserDir,         // Where shadPS4 stores its data.
+    LogDir,          // Where log files are stored.
+    ScreenshotsDir,  // Where screenshots are stored.
+    ShaderDir,       // Where shaders are stored.
+    TempDataDir,     // Where game temp data is stored.
+    GameDataDir,     // Where game data is stored.
+    SysModuleDir,    // Where system modules are stored.
+    DownloadDir,     // Where downloads/temp files are stored.
+    CapturesDir,     // Where rdoc captures are stored.
+    CheatsDir,       // Where cheats are stored.
+    PatchesDir,      // Where patches are stored.
+    MetaDataDir,     // Where game metadata (e.g. trophies and menu backgrounds) is stored.
+    CustomTrophy,    // Where custom files for trophies are stored.
+    CustomConfigs,   // Where custom files for different games are stored.
+    CacheDir,        // Where pipeline and shader cache is stored.
+    TexturePacksDir, // Where replacement texture packs are stored.
 };
 
 constexpr auto PORTABLE_DIR = "user";
@@ -44,6 +45,7 @@ constexpr auto METADATA_DIR = "game_data";
 constexpr auto CUSTOM_TROPHY = "custom_trophy";
 constexpr auto CUSTOM_CONFIGS = "custom_configs";
 constexpr auto CACHE_DIR = "cache";
+constexpr auto TEXTURE_PACKS_DIR = "texture_packs";
 
 // Filenames
 constexpr auto LOG_FILE = "shad_log.txt";
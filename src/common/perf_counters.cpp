@@ -0,0 +1,127 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <mutex>
+
+#include "common/perf_counters.h"
+
+namespace Common {
+
+const char* GetPerfCounterName(PerfCounter counter) {
+    switch (counter) {
+    case PerfCounter::Draws:
+        return "Draws";
+    case PerfCounter::Dispatches:
+        return "Dispatches";
+    case PerfCounter::PredicatedDraws:
+        return "Predicated draws";
+    case PerfCounter::PredicatedOutDraws:
+        return "Predicated out draws";
+    case PerfCounter::PipelineBinds:
+        return "Pipeline binds";
+    case PerfCounter::DescriptorWrites:
+        return "Descriptor writes";
+    case PerfCounter::BufferUploadBytes:
+        return "Buffer upload bytes";
+    case PerfCounter::TextureUploadBytes:
+        return "Texture upload bytes";
+    case PerfCounter::Detiles:
+        return "Detiles";
+    case PerfCounter::Readbacks:
+        return "Readbacks";
+    case PerfCounter::PageFaults:
+        return "Page faults";
+    case PerfCounter::PageFaultNs:
+        return "Page fault time ns";
+    case PerfCounter::Pm4Packets:
+        return "PM4 packets";
+    case PerfCounter::ShaderCompiles:
+        return "Shader compiles";
+    case PerfCounter::GuestWaits:
+        return "Guest thread waits";
+    case PerfCounter::MemoryMapBytes:
+        return "Memory mapped bytes";
+    case PerfCounter::MemoryUnmapBytes:
+        return "Memory unmapped bytes";
+    default:
+        return "Unknown";
+    }
+}
+
+namespace Detail {
+
+PerfCounterBlock shared_perf_counters{};
+constinit thread_local PerfCounterBlock* thread_perf_counters = nullptr;
+
+namespace {
+
+/// Blocks are handed out from a fixed pool so that taking one never allocates. Threads past the
+/// size of the pool share one block.
+constexpr size_t NumPerfCounterBlocks = 256;
+std::array<PerfCounterBlock, NumPerfCounterBlocks> perf_counter_blocks{};
+
+/// Gives the block back when the thread exits, the next thread keeps adding to its totals
+struct PerfCountersOwner {
+    ~PerfCountersOwner() {
+        if (thread_perf_counters != &shared_perf_counters) {
+            thread_perf_counters->in_use.store(false, std::memory_order_release);
+        }
+        thread_perf_counters = &shared_perf_counters;
+    }
+};
+
+} // Anonymous namespace
+
+PerfCounterBlock* AcquirePerfCounters() {
+    PerfCounterBlock* block = &shared_perf_counters;
+    for (auto& it : perf_counter_blocks) {
+        bool expected = false;
+        if (it.in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            block = &it;
+            break;
+        }
+    }
+    thread_perf_counters = block;
+    static thread_local PerfCountersOwner owner;
+    return block;
+}
+
+} // namespace Detail
+
+namespace {
+
+std::mutex frame_mutex;
+PerfCounterArray frame_start_totals{};
+PerfCounterArray last_frame{};
+
+} // Anonymous namespace
+
+PerfCounterArray GetPerfCounterTotals() {
+    PerfCounterArray totals{};
+    const auto add = [&](const Detail::PerfCounterBlock& block) {
+        for (size_t i = 0; i < totals.size(); ++i) {
+            totals[i] += block.values[i].load(std::memory_order_relaxed);
+        }
+    };
+    add(Detail::shared_perf_counters);
+    for (const auto& block : Detail::perf_counter_blocks) {
+        add(block);
+    }
+    return totals;
+}
+
+void EndPerfFrame() {
+    const PerfCounterArray totals = GetPerfCounterTotals();
+    std::scoped_lock lock{frame_mutex};
+    for (size_t i = 0; i < totals.size(); ++i) {
+        last_frame[i] = totals[i] - frame_start_totals[i];
+    }
+    frame_start_totals = totals;
+}
+
+PerfCounterArray GetLastFramePerfCounters() {
+    std::scoped_lock lock{frame_mutex};
+    return last_frame;
+}
+
+} // namespace Common
@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include "common/types.h"
+
+namespace Common {
+
+/// Emulator work counted per frame, see GetLastFramePerfCounters.
+enum class PerfCounter : u32 {
+    Draws,
+    Dispatches,
+    PredicatedDraws,    ///< Draws and dispatches recorded under GPU predication
+    PredicatedOutDraws, ///< Those of them the GPU skipped, counted once it is done with them
+    PipelineBinds,
+    DescriptorWrites,
+    BufferUploadBytes,
+    TextureUploadBytes,
+    Detiles,
+    Readbacks,
+    PageFaults,
+    PageFaultNs, ///< Time spent handling the faults of the caches
+    Pm4Packets,
+    ShaderCompiles,
+    GuestWaits,
+    MemoryMapBytes,
+    MemoryUnmapBytes,
+    Count,
+};
+
+[[nodiscard]] const char* GetPerfCounterName(PerfCounter counter);
+
+using PerfCounterArray = std::array<u64, static_cast<size_t>(PerfCounter::Count)>;
+
+namespace Detail {
+
+/// Counters of the threads holding it, on their own cache line. Only the shared block is written
+/// by more than one thread at a time.
+struct alignas(64) PerfCounterBlock {
+    std::array<std::atomic<u64>, static_cast<size_t>(PerfCounter::Count)> values{};
+    std::atomic<bool> in_use{};
+};
+
+extern PerfCounterBlock shared_perf_counters;
+extern constinit thread_local PerfCounterBlock* thread_perf_counters;
+
+PerfCounterBlock* AcquirePerfCounters();
+
+} // namespace Detail
+
+/// Adds to a counter of the calling thread. Only relaxed loads and stores of memory no other
+/// thread writes, cheap enough to stay on.
+inline void CountPerf(PerfCounter counter, u64 value = 1) {
+    Detail::PerfCounterBlock* block = Detail::thread_perf_counters;
+    if (!block) [[unlikely]] {
+        block = Detail::AcquirePerfCounters();
+    }
+    auto& count = block->values[static_cast<size_t>(counter)];
+    if (block == &Detail::shared_perf_counters) [[unlikely]] {
+        count.fetch_add(value, std::memory_order_relaxed);
+    } else {
+        count.store(count.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+}
+
+/// Adds to a counter from a signal handler, where the calling thread may not have its counters
+/// yet and must not allocate them.
+inline void CountPerfInSignal(PerfCounter counter, u64 value = 1) {
+    Detail::shared_perf_counters.values[static_cast<size_t>(counter)].fetch_add(
+        value, std::memory_order_relaxed);
+}
+
+/// Returns the totals of every thread since startup.
+[[nodiscard]] PerfCounterArray GetPerfCounterTotals();
+
+/// Closes the current frame, called once per flip.
+void EndPerfFrame();
+
+/// Returns what was counted between the last two calls of EndPerfFrame.
+[[nodiscard]] PerfCounterArray GetLastFramePerfCounters();
+
+} // namespace Common
@@ -8,6 +8,9 @@
 #ifdef _WIN64
 #include <windows.h>
 #endif
+#if defined(ARCH_X86_64) && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
 
 namespace Common {
 
@@ -57,4 +60,31 @@ u64 EstimateRDTSCFrequency() {
     return RoundToNearest<100'000>(tsc_freq);
 }
 
+bool HasInvariantTSC() {
+#ifdef ARCH_X86_64
+    // CPUID.80000007H:EDX[8] is the invariant TSC bit, hypervisors may clear it.
+    static constexpr u32 PowerManagementLeaf = 0x80000007;
+    static constexpr u32 InvariantTSCBit = 1U << 8;
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0x80000000);
+    if (static_cast<u32>(regs[0]) < PowerManagementLeaf) {
+        return false;
+    }
+    __cpuid(regs, PowerManagementLeaf);
+    return (static_cast<u32>(regs[3]) & InvariantTSCBit) != 0;
+#else
+    u32 eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0x80000000, nullptr) < PowerManagementLeaf) {
+        return false;
+    }
+    __get_cpuid(PowerManagementLeaf, &eax, &ebx, &ecx, &edx);
+    return (edx & InvariantTSCBit) != 0;
+#endif
+#else
+    // The generic timer counter has a fixed frequency
+    return true;
+#endif
+}
+
 } // namespace Common
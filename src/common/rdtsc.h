@@ -51,4 +51,8 @@ static inline u64 FencedRDTSC() {
 
 u64 EstimateRDTSCFrequency();
 
+/// Returns true if the counter read by FencedRDTSC ticks at a constant rate across power states
+/// and cores, so it can serve as a clock.
+bool HasInvariantTSC();
+
 } // namespace Common
@@ -11,6 +11,10 @@ void* GetXmmPointer(void* ctx, u8 index);
 
 void* GetRip(void* ctx);
 
+void* GetRsp(void* ctx);
+
+void* GetRbp(void* ctx);
+
 void IncrementRip(void* ctx, u64 length);
 
 bool IsWriteError(void* ctx);
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <bit>
+#include <memory>
 #include <numeric>
 #include <utility>
 #include <vector>
@@ -26,9 +28,12 @@ struct SlotId {
     u32 index = INVALID_INDEX;
 };
 
+/// Vector of values addressed by stable ids. Values are stored in chunks that never move, so
+/// references stay valid while other values are inserted. The ids of the live values are also
+/// kept packed, for scans that visit all of them.
 template <class T>
 class SlotVector {
-    constexpr static std::size_t InitialCapacity = 2048;
+    constexpr static std::size_t ChunkSize = 2048;
 
 public:
     template <typename ValueType, typename Pointer, typename Reference>
@@ -74,9 +79,16 @@ public:
 
     private:
         void AdvanceToValid() {
-            while (slot < vector.values_capacity && !vector.ReadStorageBit(slot.index)) {
-                ++slot.index;
+            // Skips over whole words of free slots
+            while (slot.index < vector.values_capacity) {
+                const u64 bits = vector.stored_bitset[slot.index / 64] >> (slot.index % 64);
+                if (bits != 0) {
+                    slot.index += std::countr_zero(bits);
+                    return;
+                }
+                slot.index = (slot.index / 64 + 1) * 64;
             }
+            slot.index = static_cast<u32>(vector.values_capacity);
         }
 
         SlotVector& vector;
@@ -89,30 +101,32 @@ public:
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
     SlotVector() {
-        Reserve(InitialCapacity);
+        AddChunk();
     }
 
     ~SlotVector() noexcept {
-        std::size_t index = 0;
-        for (u64 bits : stored_bitset) {
-            for (std::size_t bit = 0; bits; ++bit, bits >>= 1) {
-                if ((bits & 1) != 0) {
-                    values[index + bit].object.~T();
-                }
-            }
-            index += 64;
+        for (const u32 index : live_ids) {
+            EntryAt(index).object.~T();
         }
-        delete[] values;
     }
 
     [[nodiscard]] T& operator[](SlotId id) noexcept {
         ValidateIndex(id);
-        return values[id.index].object;
+        return EntryAt(id.index).object;
     }
 
     [[nodiscard]] const T& operator[](SlotId id) const noexcept {
         ValidateIndex(id);
-        return values[id.index].object;
+        return EntryAt(id.index).object;
+    }
+
+    /// Calls func with the id and the value of every live slot, in no particular order. Slots
+    /// must not be inserted or erased meanwhile.
+    template <typename Func>
+    void ForEach(Func&& func) {
+        for (const u32 index : live_ids) {
+            func(SlotId{index}, EntryAt(index).object);
+        }
     }
 
     bool is_allocated(SlotId id) const {
@@ -122,20 +136,28 @@ public:
     template <typename... Args>
     SlotId insert(Args&&... args) noexcept {
         const u32 index = FreeValueIndex();
-        new (&values[index].object) T(std::forward<Args>(args)...);
+        new (&EntryAt(index).object) T(std::forward<Args>(args)...);
         SetStorageBit(index);
+        dense_index[index] = static_cast<u32>(live_ids.size());
+        live_ids.push_back(index);
 
         return SlotId{index};
     }
 
     void erase(SlotId id) noexcept {
-        values[id.index].object.~T();
+        EntryAt(id.index).object.~T();
         free_list.push_back(id.index);
         ResetStorageBit(id.index);
+        // The last live id takes the place of the erased one
+        const u32 position = dense_index[id.index];
+        const u32 moved = live_ids.back();
+        live_ids[position] = moved;
+        dense_index[moved] = position;
+        live_ids.pop_back();
     }
 
     std::size_t size() const noexcept {
-        return values_capacity - free_list.size();
+        return live_ids.size();
     }
 
     iterator begin() noexcept {
@@ -217,9 +239,17 @@ private:
         DEBUG_ASSERT(((stored_bitset[id.index / 64] >> (id.index % 64)) & 1) != 0);
     }
 
+    Entry& EntryAt(u32 index) noexcept {
+        return chunks[index / ChunkSize][index % ChunkSize];
+    }
+
+    const Entry& EntryAt(u32 index) const noexcept {
+        return chunks[index / ChunkSize][index % ChunkSize];
+    }
+
     [[nodiscard]] u32 FreeValueIndex() noexcept {
         if (free_list.empty()) {
-            Reserve(values_capacity ? (values_capacity << 1) : 1);
+            AddChunk();
         }
 
         const u32 free_index = free_list.back();
@@ -227,40 +257,28 @@ private:
         return free_index;
     }
 
-    void Reserve(std::size_t new_capacity) noexcept {
-        Entry* const new_values = new Entry[new_capacity];
-        std::size_t index = 0;
-        for (u64 bits : stored_bitset) {
-            for (std::size_t bit = 0; bits; ++bit, bits >>= 1) {
-                const std::size_t i = index + bit;
-                if ((bits & 1) == 0) {
-                    continue;
-                }
-                T& old_value = values[i].object;
-                new (&new_values[i].object) T(std::move(old_value));
-                old_value.~T();
-            }
-            index += 64;
-        }
-
-        stored_bitset.resize((new_capacity + 63) / 64);
+    /// Grows by a chunk, the values already stored stay where they are.
+    void AddChunk() noexcept {
+        chunks.push_back(std::make_unique<Entry[]>(ChunkSize));
+        const std::size_t new_capacity = values_capacity + ChunkSize;
+        stored_bitset.resize(new_capacity / 64);
+        dense_index.resize(new_capacity);
 
-        const std::size_t old_free_size = free_list.size();
-        free_list.resize(old_free_size + (new_capacity - values_capacity));
-        const std::size_t new_free_size = free_list.size();
-        std::iota(free_list.rbegin(), free_list.rbegin() + new_free_size - old_free_size,
+        // Lower indices are handed out first
+        free_list.resize(free_list.size() + ChunkSize);
+        std::iota(free_list.rbegin(), free_list.rbegin() + ChunkSize,
                   static_cast<u32>(values_capacity));
 
-        delete[] values;
-        values = new_values;
         values_capacity = new_capacity;
     }
 
-    Entry* values = nullptr;
+    std::vector<std::unique_ptr<Entry[]>> chunks;
     std::size_t values_capacity = 0;
 
     std::vector<u64> stored_bitset;
     std::vector<u32> free_list;
+    std::vector<u32> live_ids;    ///< Ids of the live values, packed
+    std::vector<u32> dense_index; ///< Position of every live id in live_ids
 };
 
 } // namespace Common
@@ -3,6 +3,7 @@
 // SPDX-FileCopyrightText: Copyright 2026 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <ctime>
 #include <string>
 #include <thread>
@@ -108,24 +109,38 @@ void SetCurrentThreadPriority(ThreadPriority new_priority) {
     SetThreadPriority(handle, windows_priority);
 }
 
-bool AccurateSleep(const std::chrono::nanoseconds duration, std::chrono::nanoseconds* remaining,
-                   const bool interruptible) {
-    const auto begin_sleep = std::chrono::high_resolution_clock::now();
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
 
+/// Waitable timer of the calling thread. High resolution timers are not limited to the system
+/// timer tick of up to 15.6 ms, older Windows versions fall back to a normal one.
+static HANDLE GetThreadWaitableTimer() {
+    struct TimerHandle {
+        HANDLE handle;
+        ~TimerHandle() {
+            ::CloseHandle(handle);
+        }
+    };
+    thread_local const TimerHandle timer = [] {
+        HANDLE handle = ::CreateWaitableTimerExW(NULL, NULL,
+                                                 CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                                 TIMER_ALL_ACCESS);
+        if (!handle) {
+            handle = ::CreateWaitableTimerW(NULL, TRUE, NULL);
+        }
+        return TimerHandle{handle};
+    }();
+    return timer.handle;
+}
+
+static bool HostSleep(const std::chrono::nanoseconds duration, const bool interruptible) {
     LARGE_INTEGER interval{
         .QuadPart = -1 * (duration.count() / 100u),
     };
-    HANDLE timer = ::CreateWaitableTimer(NULL, TRUE, NULL);
+    HANDLE timer = GetThreadWaitableTimer();
     SetWaitableTimer(timer, &interval, 0, NULL, NULL, 0);
-    const auto ret = WaitForSingleObjectEx(timer, INFINITE, interruptible);
-    ::CloseHandle(timer);
-
-    if (remaining) {
-        const auto end_sleep = std::chrono::high_resolution_clock::now();
-        const auto sleep_time = end_sleep - begin_sleep;
-        *remaining = duration > sleep_time ? duration - sleep_time : std::chrono::nanoseconds(0);
-    }
-    return ret == WAIT_OBJECT_0;
+    return WaitForSingleObjectEx(timer, INFINITE, interruptible) == WAIT_OBJECT_0;
 }
 
 #else
@@ -148,8 +163,7 @@ void SetCurrentThreadPriority(ThreadPriority new_priority) {
     pthread_setschedparam(this_thread, scheduling_type, &params);
 }
 
-bool AccurateSleep(const std::chrono::nanoseconds duration, std::chrono::nanoseconds* remaining,
-                   const bool interruptible) {
+static bool HostSleep(const std::chrono::nanoseconds duration, const bool interruptible) {
     timespec request = {
         .tv_sec = duration.count() / 1'000'000'000,
         .tv_nsec = duration.count() % 1'000'000'000,
@@ -162,14 +176,36 @@ bool AccurateSleep(const std::chrono::nanoseconds duration, std::chrono::nanosec
         }
         request = remain;
     }
-    if (remaining) {
-        *remaining = std::chrono::nanoseconds(remain.tv_sec * 1'000'000'000 + remain.tv_nsec);
-    }
     return ret == 0 || errno != EINTR;
 }
 
 #endif
 
+bool AccurateSleep(const std::chrono::nanoseconds duration, std::chrono::nanoseconds* remaining,
+                   const bool interruptible, const std::chrono::nanoseconds spin_threshold) {
+    using Clock = std::chrono::steady_clock;
+    const auto begin_sleep = Clock::now();
+    const auto end_sleep = begin_sleep + duration;
+
+    bool uninterrupted = true;
+    if (duration > spin_threshold) {
+        uninterrupted = HostSleep(duration - spin_threshold, interruptible);
+    }
+    if (uninterrupted && spin_threshold.count() > 0) {
+        while (Clock::now() < end_sleep) {
+            std::this_thread::yield();
+        }
+    }
+
+    if (remaining) {
+        const auto now = Clock::now();
+        *remaining = now < end_sleep
+                         ? std::chrono::duration_cast<std::chrono::nanoseconds>(end_sleep - now)
+                         : std::chrono::nanoseconds(0);
+    }
+    return uninterrupted;
+}
+
 #ifdef _MSC_VER
 
 // Sets the debugger-visible name of the current thread.
@@ -222,6 +258,24 @@ void SetThreadName(void* thread, const char* name) {
 
 #endif
 
+void SetCurrentThreadAffinity(u64 mask) {
+#ifdef _WIN32
+    SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(mask));
+#elif defined(__linux__)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (u32 cpu = 0; cpu < 64; ++cpu) {
+        if ((mask & (1ULL << cpu)) != 0) {
+            CPU_SET(cpu, &cpu_set);
+        }
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+#else
+    // Threads can't be pinned to cores on macOS
+    (void)mask;
+#endif
+}
+
 AccurateTimer::AccurateTimer(std::chrono::nanoseconds target_interval)
     : target_interval(target_interval) {}
 
@@ -240,6 +294,10 @@ void AccurateTimer::End() {
         target_interval - std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_time);
 }
 
+void AccurateTimer::LimitDebt(std::chrono::nanoseconds max_debt) {
+    total_wait = std::max(total_wait, -max_debt);
+}
+
 std::string GetCurrentThreadName() {
     using namespace Libraries::Kernel;
     if (g_curthread && !g_curthread->name.empty()) {
@@ -24,10 +24,17 @@ void SetCurrentThreadPriority(ThreadPriority new_priority);
 
 void SetCurrentThreadName(const char* name);
 
+/// Restricts the current thread to the host cores set in mask.
+void SetCurrentThreadAffinity(u64 mask);
+
 void SetThreadName(void* thread, const char* name);
 
+/// Sleeps for the duration. When spin_threshold is set, only all but the last spin_threshold of
+/// it are slept and the rest is busy waited, so the wake up is not late by the granularity of
+/// the host timers.
 bool AccurateSleep(std::chrono::nanoseconds duration, std::chrono::nanoseconds* remaining,
-                   bool interruptible);
+                   bool interruptible,
+                   std::chrono::nanoseconds spin_threshold = std::chrono::nanoseconds{});
 
 class AccurateTimer {
     std::chrono::nanoseconds target_interval{};
@@ -42,6 +49,15 @@ public:
 
     void End();
 
+    /// Forgives the time the intervals ran late by beyond max_debt, so a long interval is not
+    /// made up for with a burst of short ones.
+    void LimitDebt(std::chrono::nanoseconds max_debt);
+
+    /// Changes the interval of the following periods, the wait carried over is kept.
+    void SetInterval(std::chrono::nanoseconds interval) {
+        target_interval = interval;
+    }
+
     std::chrono::nanoseconds GetTotalWait() const {
         return total_wait;
     }
@@ -0,0 +1,219 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+
+#include <fmt/format.h>
+
+#include "common/thread.h"
+#include "common/thread_pool.h"
+
+namespace Common {
+
+struct Job {
+    UniqueFunction<void> func;
+    JobPriority priority;
+    JobGroup* group;
+    std::atomic<u32> remaining_dependencies{1}; ///< Holds one extra count until it is submitted
+    std::mutex mutex;
+    std::vector<JobHandle> dependents; ///< Jobs waiting on this one, guarded by mutex
+    bool done{};                       ///< Guarded by mutex
+    std::atomic<bool> finished{};
+};
+
+namespace {
+/// Pool and index of the worker running on this thread
+thread_local ThreadPool* current_pool = nullptr;
+thread_local size_t current_worker = 0;
+} // Anonymous namespace
+
+void JobGroup::Wait() {
+    for (u32 num = pending.load(std::memory_order_acquire); num != 0;
+         num = pending.load(std::memory_order_acquire)) {
+        pending.wait(num, std::memory_order_acquire);
+    }
+    // The last job may still be notifying, the group can go away once it is done
+    std::scoped_lock lock{mutex};
+}
+
+ThreadPool::ThreadPool(size_t num_workers, std::string name, u64 affinity_mask_)
+    : thread_name{std::move(name)}, affinity_mask{affinity_mask_} {
+    workers.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    // Threads start once every queue exists, since they steal from each other
+    for (size_t i = 0; i < num_workers; ++i) {
+        workers[i]->thread =
+            std::jthread([this, i](std::stop_token stop_token) { WorkerLoop(i, stop_token); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    for (auto& worker : workers) {
+        worker->thread.request_stop();
+    }
+    work_epoch.fetch_add(1, std::memory_order_release);
+    work_epoch.notify_all();
+    for (auto& worker : workers) {
+        worker->thread.join();
+    }
+    // Whatever is still queued is dropped, which releases the groups and dependents waiting on it
+    const auto drop_all = [this](Queue& queue) {
+        while (true) {
+            JobHandle job;
+            {
+                std::scoped_lock lock{queue.mutex};
+                for (auto& lane : queue.lanes) {
+                    if (!lane.empty()) {
+                        job = std::move(lane.front());
+                        lane.pop_front();
+                        break;
+                    }
+                }
+            }
+            if (!job) {
+                return;
+            }
+            job->func = {};
+            Run(job);
+        }
+    };
+    for (auto& worker : workers) {
+        drop_all(worker->queue);
+    }
+    drop_all(shared_queue);
+}
+
+JobHandle ThreadPool::Submit(UniqueFunction<void> func, const JobOptions& options) {
+    auto job = std::make_shared<Job>();
+    job->func = std::move(func);
+    job->priority = options.priority;
+    job->group = options.group;
+    if (job->group) {
+        job->group->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    for (const JobHandle& dependency : options.dependencies) {
+        std::scoped_lock lock{dependency->mutex};
+        if (!dependency->done) {
+            job->remaining_dependencies.fetch_add(1, std::memory_order_relaxed);
+            dependency->dependents.push_back(job);
+        }
+    }
+    if (job->remaining_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        Enqueue(job);
+    }
+    return job;
+}
+
+void ThreadPool::Wait(const JobHandle& job) {
+    if (current_pool == this) {
+        // Helps out instead of blocking a worker, which could be the one the job waits for
+        while (!job->finished.load(std::memory_order_acquire)) {
+            if (JobHandle other = FindJob(current_worker)) {
+                Run(other);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        return;
+    }
+    job->finished.wait(false, std::memory_order_acquire);
+}
+
+void ThreadPool::Enqueue(JobHandle job) {
+    const size_t lane = static_cast<size_t>(job->priority);
+    Queue& queue = current_pool == this ? workers[current_worker]->queue : shared_queue;
+    {
+        std::scoped_lock lock{queue.mutex};
+        queue.lanes[lane].push_back(std::move(job));
+    }
+    work_epoch.fetch_add(1, std::memory_order_release);
+    work_epoch.notify_one();
+}
+
+JobHandle ThreadPool::FindJob(size_t index) {
+    const auto take = [](Queue& queue, size_t lane, bool newest) -> JobHandle {
+        std::scoped_lock lock{queue.mutex};
+        auto& jobs = queue.lanes[lane];
+        if (jobs.empty()) {
+            return nullptr;
+        }
+        JobHandle job;
+        if (newest) {
+            job = std::move(jobs.back());
+            jobs.pop_back();
+        } else {
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        return job;
+    };
+    for (size_t lane = 0; lane < static_cast<size_t>(JobPriority::Count); ++lane) {
+        // The newest job of the own queue is the most likely to still be in the cache
+        if (JobHandle job = take(workers[index]->queue, lane, true)) {
+            return job;
+        }
+        if (JobHandle job = take(shared_queue, lane, false)) {
+            return job;
+        }
+        for (size_t i = 1; i < workers.size(); ++i) {
+            if (JobHandle job = take(workers[(index + i) % workers.size()]->queue, lane, false)) {
+                return job;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void ThreadPool::Run(const JobHandle& job) {
+    if (job->func && !(job->group && job->group->IsCancelled())) {
+        job->func();
+    }
+    job->func = {};
+
+    std::vector<JobHandle> dependents;
+    {
+        std::scoped_lock lock{job->mutex};
+        job->done = true;
+        dependents = std::move(job->dependents);
+    }
+    job->finished.store(true, std::memory_order_release);
+    job->finished.notify_all();
+    for (JobHandle& dependent : dependents) {
+        if (dependent->remaining_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            Enqueue(std::move(dependent));
+        }
+    }
+    if (JobGroup* group = job->group) {
+        std::scoped_lock lock{group->mutex};
+        if (group->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            group->pending.notify_all();
+        }
+    }
+}
+
+void ThreadPool::WorkerLoop(size_t index, std::stop_token stop_token) {
+    const std::string name = fmt::format("{}{}", thread_name, index);
+    SetCurrentThreadName(name.c_str());
+    if (affinity_mask != 0) {
+        SetCurrentThreadAffinity(affinity_mask);
+    }
+    current_pool = this;
+    current_worker = index;
+    while (!stop_token.stop_requested()) {
+        const u32 epoch = work_epoch.load(std::memory_order_acquire);
+        if (JobHandle job = FindJob(index)) {
+            Run(job);
+            continue;
+        }
+        work_epoch.wait(epoch, std::memory_order_acquire);
+    }
+}
+
+ThreadPool& GetThreadPool() {
+    static ThreadPool pool{std::max(std::thread::hardware_concurrency(), 2U), "shadPS4:Pool"};
+    return pool;
+}
+
+} // namespace Common
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/types.h"
+#include "common/unique_function.h"
+
+namespace Common {
+
+/// Lanes of the pool, a worker only takes a job from a lane when the ones before it are empty.
+enum class JobPriority : u32 {
+    High,
+    Normal,
+    Low,
+    Count,
+};
+
+/// Counts the jobs submitted with it, so their owner can wait for them or drop the ones that
+/// didn't start before it goes away.
+class JobGroup {
+public:
+    /// Blocks until every job of the group has finished or was dropped.
+    void Wait();
+
+    /// Jobs of the group that didn't start yet are dropped instead of run.
+    void Cancel() {
+        cancelled.store(true, std::memory_order_release);
+    }
+
+    [[nodiscard]] bool IsCancelled() const {
+        return cancelled.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] u32 NumPending() const {
+        return pending.load(std::memory_order_acquire);
+    }
+
+private:
+    friend class ThreadPool;
+
+    std::atomic<u32> pending{};
+    std::atomic<bool> cancelled{};
+    std::mutex mutex; ///< Held by the job leaving the group, so Wait returns after it let go
+};
+
+struct Job;
+using JobHandle = std::shared_ptr<Job>;
+
+struct JobOptions {
+    JobPriority priority = JobPriority::Normal;
+    JobGroup* group = nullptr;
+    std::span<const JobHandle> dependencies{}; ///< Jobs that have to finish before this one runs
+};
+
+/**
+ * Pool of worker threads shared by several subsystems. Every worker has its own queue per lane,
+ * jobs submitted from a worker go to its queue and idle workers steal from the others. Jobs
+ * submitted from other threads go to a shared queue.
+ */
+class ThreadPool {
+public:
+    /// Starts num_workers threads, pinned to the host cores of affinity_mask unless it is 0.
+    explicit ThreadPool(size_t num_workers, std::string name, u64 affinity_mask = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Queues a job, which runs once all of its dependencies have finished.
+    JobHandle Submit(UniqueFunction<void> func, const JobOptions& options = {});
+
+    /// Blocks until the job has finished. Workers run other jobs in the meantime.
+    void Wait(const JobHandle& job);
+
+    [[nodiscard]] size_t NumWorkers() const {
+        return workers.size();
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::array<std::deque<JobHandle>, static_cast<size_t>(JobPriority::Count)> lanes;
+    };
+
+    struct Worker {
+        Queue queue;
+        std::jthread thread;
+    };
+
+    void WorkerLoop(size_t index, std::stop_token stop_token);
+    void Enqueue(JobHandle job);
+    JobHandle FindJob(size_t index);
+    void Run(const JobHandle& job);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    Queue shared_queue;
+    std::string thread_name;
+    u64 affinity_mask;
+    alignas(128) std::atomic<u32> work_epoch{}; ///< Bumped whenever a job is queued
+};
+
+/// Pool with a worker for every host core, for jobs of subsystems that don't need their own
+/// threads.
+ThreadPool& GetThreadPool();
+
+} // namespace Common
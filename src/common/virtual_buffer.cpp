@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "common/error.h"
+#include "common/logging/log.h"
+#include "common/virtual_buffer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace Common {
+
+void* ReserveMemoryPages(std::size_t size, [[maybe_unused]] bool huge_pages) noexcept {
+    if (size == 0) {
+        return nullptr;
+    }
+#ifdef _WIN32
+    // Large pages can't be committed lazily inside a reservation, so only normal pages are used
+    void* base = VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+    if (!base) {
+        LOG_CRITICAL(Common_Memory, "Failed to reserve {:#x} bytes: {}", size, GetLastErrorMsg());
+        return nullptr;
+    }
+#else
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        LOG_CRITICAL(Common_Memory, "Failed to reserve {:#x} bytes: {}", size, GetLastErrorMsg());
+        return nullptr;
+    }
+#ifdef MADV_HUGEPAGE
+    if (huge_pages) {
+        madvise(base, size, MADV_HUGEPAGE);
+    }
+#endif
+#endif
+    return base;
+}
+
+bool CommitMemoryPages(void* address, std::size_t size) noexcept {
+#ifdef _WIN32
+    return VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+    // Anonymous mappings are backed on first touch
+    return address != nullptr;
+#endif
+}
+
+void FreeMemoryPages(void* base, std::size_t size) noexcept {
+    if (!base) {
+        return;
+    }
+#ifdef _WIN32
+    VirtualFree(base, 0, MEM_RELEASE);
+#else
+    munmap(base, size);
+#endif
+}
+
+} // namespace Common
@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cstddef>
+
+namespace Common {
+
+/// Reserves size bytes of address space. Pages are only backed by memory once they are committed
+/// (Windows) or first touched (elsewhere). With huge_pages the kernel is asked to back the range
+/// with transparent huge pages, where supported.
+void* ReserveMemoryPages(std::size_t size, bool huge_pages) noexcept;
+
+/// Makes a range of a reservation accessible.
+bool CommitMemoryPages(void* address, std::size_t size) noexcept;
+
+/// Releases a reservation and the memory backing it.
+void FreeMemoryPages(void* base, std::size_t size) noexcept;
+
+/// Address space reservation that is committed on demand.
+class VirtualBuffer final {
+public:
+    VirtualBuffer() = default;
+    explicit VirtualBuffer(std::size_t size_, bool huge_pages)
+        : base{ReserveMemoryPages(size_, huge_pages)}, size{base ? size_ : 0} {}
+
+    ~VirtualBuffer() noexcept {
+        FreeMemoryPages(base, size);
+    }
+
+    VirtualBuffer(const VirtualBuffer&) = delete;
+    VirtualBuffer& operator=(const VirtualBuffer&) = delete;
+
+    [[nodiscard]] void* Commit(std::size_t offset, std::size_t length) noexcept {
+        void* address = static_cast<std::byte*>(base) + offset;
+        return CommitMemoryPages(address, length) ? address : nullptr;
+    }
+
+    [[nodiscard]] std::size_t Size() const noexcept {
+        return size;
+    }
+
+private:
+    void* base{};
+    std::size_t size{};
+};
+
+} // namespace Common
@@ -17,6 +17,7 @@
 #include <windows.h>
 #else
 #include <fcntl.h>
+#include <fstream>
 #include <sys/mman.h>
 #endif
 
@@ -202,6 +203,12 @@ struct AddressSpace::Impl {
             MapViewOfFile3(backing_handle, process, backing_base, 0, BackingSize,
                            MEM_REPLACE_PLACEHOLDER, PAGE_EXECUTE_READWRITE, nullptr, 0);
         ASSERT_MSG(ret == backing_base, "{}", Common::GetLastErrorMsg());
+
+        if (Config::isDirectMemoryHugePagesEnabled()) {
+            // Large page sections can only be viewed at large page granularity, while guest
+            // mappings alias the backing at 16KB.
+            LOG_WARNING(Kernel_Vmm, "Huge page backed direct memory is not supported on Windows");
+        }
     }
 
     ~Impl() {
@@ -451,6 +458,7 @@ struct AddressSpace::Impl {
     HANDLE process{};
     HANDLE backing_handle{};
     u8* backing_base{};
+    bool huge_pages{};
     u8* virtual_base{};
     u8* system_managed_base{};
     size_t system_managed_size{};
@@ -503,6 +511,18 @@ enum PosixPageProtection {
     }
 }
 
+#ifndef __APPLE__
+/// Returns true if the kernel gives transparent huge pages to shared memory that asks for them.
+static bool IsShmemHugePageAdviceHonored() {
+    std::ifstream file{"/sys/kernel/mm/transparent_hugepage/shmem_enabled"};
+    std::string modes;
+    if (!std::getline(file, modes)) {
+        return false;
+    }
+    return modes.find("[never]") == std::string::npos && modes.find("[deny]") == std::string::npos;
+}
+#endif
+
 struct AddressSpace::Impl {
     Impl() {
         BackingSize += Config::getExtraDmemInMbytes() * 1_MB;
@@ -599,6 +619,32 @@ struct AddressSpace::Impl {
             LOG_CRITICAL(Kernel_Vmm, "mmap failed: {}", strerror(errno));
             throw std::bad_alloc{};
         }
+
+        if (Config::isDirectMemoryHugePagesEnabled()) {
+            EnableHugePages();
+        }
+    }
+
+    void EnableHugePages() {
+#ifdef __APPLE__
+        LOG_WARNING(Kernel_Vmm, "Huge page backed direct memory is not supported on macOS");
+#else
+        // hugetlbfs can only map at 2MB granularity while guest mappings alias the backing at
+        // 16KB, so use transparent huge pages instead. The kernel keeps small pages wherever a
+        // mapping of the backing isn't 2MB aligned.
+        if (!IsShmemHugePageAdviceHonored()) {
+            LOG_WARNING(Kernel_Vmm, "Transparent huge pages are disabled for shared memory, "
+                                    "direct memory stays on small pages");
+            return;
+        }
+        if (madvise(backing_base, BackingSize, MADV_HUGEPAGE) != 0) {
+            LOG_WARNING(Kernel_Vmm, "Huge pages for direct memory unavailable: {}",
+                        strerror(errno));
+            return;
+        }
+        huge_pages = true;
+        LOG_INFO(Kernel_Vmm, "Direct memory backed by transparent huge pages");
+#endif
     }
 
     void* Map(VAddr virtual_addr, PAddr phys_addr, size_t size, PosixPageProtection prot,
@@ -610,6 +656,12 @@ struct AddressSpace::Impl {
         void* ret = mmap(reinterpret_cast<void*>(virtual_addr), size, prot, MAP_FIXED | flag,
                          handle, host_offset);
         ASSERT_MSG(ret != MAP_FAILED, "mmap failed: {}", strerror(errno));
+#ifndef __APPLE__
+        if (huge_pages && handle == backing_fd) {
+            // The advice belongs to the mapping, a fresh one doesn't inherit it.
+            madvise(ret, size, MADV_HUGEPAGE);
+        }
+#endif
         return ret;
     }
 
@@ -653,6 +705,7 @@ struct AddressSpace::Impl {
 
     int backing_fd;
     u8* backing_base{};
+    bool huge_pages{};
     u8* system_managed_base{};
     size_t system_managed_size{};
     u8* system_reserved_base{};
@@ -665,6 +718,7 @@ struct AddressSpace::Impl {
 
 AddressSpace::AddressSpace() : impl{std::make_unique<Impl>()} {
     backing_base = impl->backing_base;
+    huge_pages = impl->huge_pages;
     system_managed_base = impl->system_managed_base;
     system_managed_size = impl->system_managed_size;
     system_reserved_base = impl->system_reserved_base;
@@ -729,6 +783,30 @@ void AddressSpace::Protect(VAddr virtual_addr, size_t size, MemoryPermission per
     return impl->Protect(virtual_addr, size, read, write, execute);
 }
 
+void AddressSpace::Populate(PAddr phys_addr, size_t size) {
+    u8* const address = backing_base + phys_addr;
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY entry{address, size};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0);
+#elif defined(MADV_POPULATE_WRITE)
+    // Populating writable pages doesn't change their contents.
+    if (madvise(address, size, MADV_POPULATE_WRITE) != 0) {
+        madvise(address, size, MADV_WILLNEED);
+    }
+#else
+    madvise(address, size, MADV_WILLNEED);
+#endif
+}
+
+bool AddressSpace::Discard(PAddr phys_addr, size_t size) {
+#if defined(_WIN32) || defined(__APPLE__)
+    // Neither can drop the pages of a shared section without unmapping every view of it.
+    return false;
+#else
+    return madvise(backing_base + phys_addr, size, MADV_REMOVE) == 0;
+#endif
+}
+
 boost::icl::interval_set<VAddr> AddressSpace::GetUsableRegions() {
 #ifdef _WIN32
     // On Windows, we need to obtain the accessible intervals from the implementation's regions.
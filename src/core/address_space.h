@@ -33,6 +33,11 @@ public:
         return backing_base;
     }
 
+    /// Returns true if the backing of direct memory was set up to use huge host pages.
+    [[nodiscard]] bool HasHugePageBacking() const noexcept {
+        return huge_pages;
+    }
+
     [[nodiscard]] VAddr SystemManagedVirtualBase() noexcept {
         return reinterpret_cast<VAddr>(system_managed_base);
     }
@@ -85,6 +90,13 @@ public:
 
     void Protect(VAddr virtual_addr, size_t size, MemoryPermission perms);
 
+    /// Faults in the host pages backing the physical range ahead of the first guest access.
+    void Populate(PAddr phys_addr, size_t size);
+
+    /// Hands the host pages backing the physical range back to the host. Returns true if
+    /// they were released, in which case the range reads back as zero.
+    bool Discard(PAddr phys_addr, size_t size);
+
     // Returns an interval set containing all usable regions.
     boost::icl::interval_set<VAddr> GetUsableRegions();
 
@@ -92,6 +104,7 @@ private:
     struct Impl;
     std::unique_ptr<Impl> impl;
     u8* backing_base{};
+    bool huge_pages{};
     u8* system_managed_base{};
     size_t system_managed_size{};
     u8* system_reserved_base{};
@@ -0,0 +1,397 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <fmt/format.h>
+
+#include "common/elf_info.h"
+#include "common/io_file.h"
+#include "common/logging/log.h"
+#include "common/path_util.h"
+#include "common/scm_rev.h"
+#include "core/benchmark.h"
+#include "core/debug_state.h"
+#include "video_core/renderer_vulkan/vk_pipeline_cache.h"
+#include "video_core/stall_tracker.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+#include "common/string_util.h"
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <sys/resource.h>
+#else
+#include <filesystem>
+#include <fstream>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace Core::Benchmark {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct ThreadTimes {
+    std::string name;
+    u64 user_us;
+    u64 system_us;
+};
+
+/// CPU time of every live host thread of the process, by host thread id
+using ThreadTimesMap = std::unordered_map<u64, ThreadTimes>;
+
+struct ProcessCounters {
+    u64 minor_faults;
+    u64 major_faults;
+    u64 peak_rss_bytes;
+};
+
+#ifdef _WIN32
+
+u64 FileTimeToUs(const FILETIME& time) {
+    return ((u64(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 10;
+}
+
+ThreadTimesMap GetThreadTimes() {
+    ThreadTimesMap threads;
+    const HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+        return threads;
+    }
+    const DWORD process_id = GetCurrentProcessId();
+    THREADENTRY32 entry{.dwSize = sizeof(THREADENTRY32)};
+    for (BOOL ok = Thread32First(snapshot, &entry); ok; ok = Thread32Next(snapshot, &entry)) {
+        if (entry.th32OwnerProcessID != process_id) {
+            continue;
+        }
+        const HANDLE thread = OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE,
+                                         entry.th32ThreadID);
+        if (!thread) {
+            continue;
+        }
+        FILETIME creation, exit, kernel, user;
+        if (::GetThreadTimes(thread, &creation, &exit, &kernel, &user)) {
+            std::string name;
+            PWSTR description = nullptr;
+            if (SUCCEEDED(GetThreadDescription(thread, &description))) {
+                name = Common::UTF16ToUTF8(description);
+                LocalFree(description);
+            }
+            threads[entry.th32ThreadID] = {std::move(name), FileTimeToUs(user),
+                                           FileTimeToUs(kernel)};
+        }
+        CloseHandle(thread);
+    }
+    CloseHandle(snapshot);
+    return threads;
+}
+
+ProcessCounters GetProcessCounters() {
+    PROCESS_MEMORY_COUNTERS counters{};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    // Windows doesn't tell soft and hard faults apart
+    return {counters.PageFaultCount, 0, counters.PeakWorkingSetSize};
+}
+
+#elif defined(__APPLE__)
+
+ThreadTimesMap GetThreadTimes() {
+    ThreadTimesMap threads;
+    thread_act_array_t list;
+    mach_msg_type_number_t count;
+    if (task_threads(mach_task_self(), &list, &count) != KERN_SUCCESS) {
+        return threads;
+    }
+    for (mach_msg_type_number_t i = 0; i < count; ++i) {
+        thread_extended_info_data_t info;
+        mach_msg_type_number_t info_count = THREAD_EXTENDED_INFO_COUNT;
+        if (thread_info(list[i], THREAD_EXTENDED_INFO, reinterpret_cast<thread_info_t>(&info),
+                        &info_count) == KERN_SUCCESS) {
+            threads[list[i]] = {info.pth_name, info.pth_user_time / 1000,
+                                info.pth_system_time / 1000};
+        }
+        mach_port_deallocate(mach_task_self(), list[i]);
+    }
+    vm_deallocate(mach_task_self(), reinterpret_cast<vm_address_t>(list),
+                  count * sizeof(thread_act_t));
+    return threads;
+}
+
+ProcessCounters GetProcessCounters() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    // Reported in bytes on macOS
+    return {u64(usage.ru_minflt), u64(usage.ru_majflt), u64(usage.ru_maxrss)};
+}
+
+#else
+
+ThreadTimesMap GetThreadTimes() {
+    ThreadTimesMap threads;
+    const u64 us_per_tick = 1'000'000 / sysconf(_SC_CLK_TCK);
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator{"/proc/self/task", ec}) {
+        std::ifstream stat{entry.path() / "stat"};
+        std::string line;
+        if (!std::getline(stat, line)) {
+            continue;
+        }
+        // The name is in parentheses and may contain spaces, the fields after it are fixed
+        const size_t name_begin = line.find('(');
+        const size_t name_end = line.rfind(')');
+        if (name_begin == std::string::npos || name_end == std::string::npos) {
+            continue;
+        }
+        unsigned long utime, stime;
+        if (std::sscanf(line.c_str() + name_end + 1,
+                        " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime,
+                        &stime) != 2) {
+            continue;
+        }
+        threads[std::stoull(entry.path().filename().string())] = {
+            line.substr(name_begin + 1, name_end - name_begin - 1), utime * us_per_tick,
+            stime * us_per_tick};
+    }
+    return threads;
+}
+
+ProcessCounters GetProcessCounters() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    // Reported in kilobytes on Linux
+    return {u64(usage.ru_minflt), u64(usage.ru_majflt), u64(usage.ru_maxrss) * 1_KB};
+}
+
+#endif
+
+struct Run {
+    Options options;
+    Clock::time_point start_time;
+    Clock::time_point first_frame_time;
+    Clock::time_point last_frame_time;
+    std::vector<double> frame_ms;
+    std::vector<double> gpu_ms;
+    u64 last_gpu_frame{};
+
+    ThreadTimesMap start_threads;
+    ProcessCounters start_counters{};
+    u64 start_pipelines_compiled{};
+    u64 start_skipped_draws{};
+    u64 start_vma_block_bytes{};
+    u64 start_pipeline_latency_us{};
+    u64 pipelines_compiled{};
+    u64 skipped_draws{};
+    u64 pipeline_latency_us{};
+    u64 max_pipeline_latency_us{};
+    u64 fault_buffer_pages{};
+    u64 peak_vma_block_bytes{};
+    u64 peak_page_table_bytes{};
+    bool finished{};
+};
+
+std::mutex run_mutex;
+std::optional<Run> run;
+
+double Percentile(const std::vector<double>& sorted, double percentile) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const size_t index = static_cast<size_t>(percentile / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+std::string FormatDistribution(std::vector<double> values) {
+    if (values.empty()) {
+        return "null";
+    }
+    std::ranges::sort(values);
+    const double avg = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+    return fmt::format("{{\"avg\":{:.3f},\"min\":{:.3f},\"max\":{:.3f},\"p50\":{:.3f},"
+                       "\"p90\":{:.3f},\"p95\":{:.3f},\"p99\":{:.3f}}}",
+                       avg, values.front(), values.back(), Percentile(values, 50.0),
+                       Percentile(values, 90.0), Percentile(values, 95.0),
+                       Percentile(values, 99.0));
+}
+
+std::string EscapeJson(std::string_view str) {
+    std::string escaped;
+    for (const char c : str) {
+        if (c == '"' || c == '\\') {
+            escaped.push_back('\\');
+        }
+        if (static_cast<unsigned char>(c) >= 0x20) {
+            escaped.push_back(c);
+        }
+    }
+    return escaped;
+}
+
+/// Sum of the outermost GPU profiler scopes of the last published frame, if it is a new one
+std::optional<double> ReadGpuFrameTime(u64& last_frame) {
+    std::scoped_lock lock{DebugState.gpu_timings_mutex};
+    const auto& timings = DebugState.gpu_timings;
+    if (timings.frame == last_frame || timings.scopes.empty()) {
+        return std::nullopt;
+    }
+    last_frame = timings.frame;
+    return timings.GetBusyMs();
+}
+
+} // Anonymous namespace
+
+void Start(Options options) {
+    std::scoped_lock lock{run_mutex};
+    run.emplace();
+    run->options = std::move(options);
+    run->start_time = Clock::now();
+}
+
+bool IsRunning() {
+    std::scoped_lock lock{run_mutex};
+    return run.has_value() && !run->finished;
+}
+
+bool OnFrame(const Vulkan::PipelineCompileStats& pipeline_stats) {
+    std::scoped_lock lock{run_mutex};
+    if (!run || run->finished) {
+        return false;
+    }
+    const auto now = Clock::now();
+    const u64 compiled = pipeline_stats.num_compiled.load(std::memory_order_relaxed);
+    const u64 skipped = pipeline_stats.num_skipped_draws.load(std::memory_order_relaxed);
+    const u64 vma_block_bytes = DebugState.vma_block_bytes.load(std::memory_order_relaxed);
+    if (run->first_frame_time == Clock::time_point{}) {
+        // The baseline, everything before the first frame is startup
+        run->first_frame_time = run->last_frame_time = now;
+        run->start_threads = GetThreadTimes();
+        run->start_counters = GetProcessCounters();
+        run->start_pipelines_compiled = compiled;
+        run->start_skipped_draws = skipped;
+        run->start_vma_block_bytes = vma_block_bytes;
+        run->start_pipeline_latency_us = pipeline_stats.total_latency_us.load();
+        ReadGpuFrameTime(run->last_gpu_frame);
+        const auto& options = run->options;
+        LOG_INFO(Core, "Benchmark started after {:.2f} s, measuring {}",
+                 std::chrono::duration<double>(now - run->start_time).count(),
+                 options.num_frames != 0 ? fmt::format("{} frames", options.num_frames)
+                                         : fmt::format("{} s", options.num_seconds));
+        return false;
+    }
+
+    run->frame_ms.push_back(
+        std::chrono::duration<double, std::milli>(now - run->last_frame_time).count());
+    run->last_frame_time = now;
+    if (const auto gpu_ms = ReadGpuFrameTime(run->last_gpu_frame)) {
+        run->gpu_ms.push_back(*gpu_ms);
+    }
+    run->pipelines_compiled = compiled - run->start_pipelines_compiled;
+    run->skipped_draws = skipped - run->start_skipped_draws;
+    run->pipeline_latency_us =
+        pipeline_stats.total_latency_us.load() - run->start_pipeline_latency_us;
+    run->max_pipeline_latency_us = pipeline_stats.max_latency_us.load();
+    run->fault_buffer_pages += DebugState.fault_buffer_pages.load(std::memory_order_relaxed);
+    run->peak_vma_block_bytes = std::max(run->peak_vma_block_bytes, vma_block_bytes);
+    run->peak_page_table_bytes = std::max<u64>(run->peak_page_table_bytes,
+                                               DebugState.page_table_resident_bytes.load());
+
+    const auto& options = run->options;
+    run->finished = options.num_frames != 0
+                        ? run->frame_ms.size() >= options.num_frames
+                        : now - run->first_frame_time >= std::chrono::seconds{options.num_seconds};
+    return run->finished;
+}
+
+bool Finish() {
+    std::scoped_lock lock{run_mutex};
+    if (!run) {
+        return false;
+    }
+    const auto end_threads = GetThreadTimes();
+    const auto end_counters = GetProcessCounters();
+    const auto& game_info = Common::ElfInfo::Instance();
+    const std::string serial{game_info.GameSerial()};
+
+    auto path = run->options.report_path;
+    if (path.empty()) {
+        path = Common::FS::GetUserPath(Common::FS::PathType::LogDir) /
+               fmt::format("benchmark_{}.json", serial.empty() ? "unknown" : serial);
+    }
+    Common::FS::IOFile file{path, Common::FS::FileAccessMode::Write,
+                            Common::FS::FileType::TextFile};
+    if (!file.IsOpen()) {
+        LOG_ERROR(Core, "Failed to open {} for writing", path.string());
+        return false;
+    }
+
+    const double measured_s =
+        std::chrono::duration<double>(run->last_frame_time - run->first_frame_time).count();
+    const double startup_s =
+        std::chrono::duration<double>(run->first_frame_time - run->start_time).count();
+    const size_t num_frames = run->frame_ms.size();
+    file.WriteString(fmt::format(
+        "{{\"version\":\"{}\",\"mode\":\"{}\",\"serial\":\"{}\",\"frames\":{},"
+        "\"startup_s\":{:.3f},\"duration_s\":{:.3f},\"avg_fps\":{:.2f},\n",
+        EscapeJson(Common::g_version), run->options.mode, EscapeJson(serial), num_frames,
+        startup_s, measured_s, measured_s > 0.0 ? num_frames / measured_s : 0.0));
+    file.WriteString(fmt::format("\"frame_time_ms\":{},\n\"gpu_time_ms\":{},\n",
+                                 FormatDistribution(run->frame_ms),
+                                 FormatDistribution(run->gpu_ms)));
+    const u64 latency_us = run->pipeline_latency_us / std::max<u64>(run->pipelines_compiled, 1);
+    file.WriteString(fmt::format(
+        "\"pipelines\":{{\"compiled\":{},\"skipped_draws\":{},\"avg_latency_us\":{},"
+        "\"max_latency_us\":{}}},\n",
+        run->pipelines_compiled, run->skipped_draws, latency_us, run->max_pipeline_latency_us));
+    const auto [num_hitches, _] = VideoCore::GetHitchCounts();
+    file.WriteString(fmt::format("\"hitches\":{},\n", num_hitches));
+    file.WriteString(fmt::format(
+        "\"page_faults\":{{\"minor\":{},\"major\":{},\"gpu_fault_buffer_pages\":{}}},\n",
+        end_counters.minor_faults - run->start_counters.minor_faults,
+        end_counters.major_faults - run->start_counters.major_faults, run->fault_buffer_pages));
+    file.WriteString(fmt::format(
+        "\"memory\":{{\"peak_rss_bytes\":{},\"peak_device_bytes\":{},"
+        "\"startup_device_bytes\":{},\"peak_page_table_bytes\":{}}},\n",
+        end_counters.peak_rss_bytes, run->peak_vma_block_bytes, run->start_vma_block_bytes,
+        run->peak_page_table_bytes));
+
+    // Threads that exited during the run are left out, the ones started during it count in full
+    std::vector<std::pair<u64, ThreadTimes>> threads;
+    for (const auto& [id, times] : end_threads) {
+        ThreadTimes delta = times;
+        if (const auto it = run->start_threads.find(id); it != run->start_threads.end()) {
+            delta.user_us -= std::min(delta.user_us, it->second.user_us);
+            delta.system_us -= std::min(delta.system_us, it->second.system_us);
+        }
+        threads.emplace_back(id, std::move(delta));
+    }
+    std::ranges::sort(threads, std::greater{}, [](const auto& thread) {
+        return thread.second.user_us + thread.second.system_us;
+    });
+    file.WriteString(std::string_view{"\"threads\":[\n"});
+    for (size_t i = 0; i < threads.size(); ++i) {
+        const auto& [id, times] = threads[i];
+        file.WriteString(fmt::format(
+            "{{\"id\":{},\"name\":\"{}\",\"user_ms\":{:.1f},\"system_ms\":{:.1f}}}{}\n", id,
+            EscapeJson(times.name), times.user_us / 1000.0, times.system_us / 1000.0,
+            i + 1 == threads.size() ? "" : ","));
+    }
+    file.WriteString(std::string_view{"]}\n"});
+
+    LOG_INFO(Core, "Benchmark measured {} frames in {:.2f} s, wrote the report to {}", num_frames,
+             measured_s, path.string());
+    VideoCore::SaveHitchReport();
+    run->finished = true;
+    return true;
+}
+
+} // namespace Core::Benchmark
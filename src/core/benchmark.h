@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include "common/types.h"
+
+namespace Vulkan {
+struct PipelineCompileStats;
+}
+
+namespace Core::Benchmark {
+
+struct Options {
+    u32 num_frames;   ///< Frames to measure, 0 when the run is limited by time
+    u32 num_seconds;  ///< Seconds to measure, 0 when the run is limited by frames
+    std::string mode; ///< What is measured, "game" or "capture"
+    std::filesystem::path report_path; ///< Empty to write it to the log directory
+};
+
+/// Starts a benchmark run, before the emulator starts up. Frames are measured from the first one
+/// reported with OnFrame, the time until then is reported as startup.
+void Start(Options options);
+
+[[nodiscard]] bool IsRunning();
+
+/**
+ * Records the end of a frame, with the pipeline cache that recorded it. Returns true once the
+ * run has measured all of its frames or seconds, the caller then calls Finish.
+ */
+bool OnFrame(const Vulkan::PipelineCompileStats& pipeline_stats);
+
+/// Writes the JSON report of the run. Returns false when it could not be written.
+bool Finish();
+
+} // namespace Core::Benchmark
@@ -1,18 +1,25 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <array>
+#include <filesystem>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <set>
+#include <span>
 #include <vector>
 #include <Zydis/Zydis.h>
 #include <xbyak/xbyak.h>
 #include <xbyak/xbyak_util.h>
+#include <xxhash.h>
 #include "common/alignment.h"
 #include "common/arch.h"
 #include "common/assert.h"
 #include "common/decoder.h"
+#include "common/io_file.h"
+#include "common/path_util.h"
 #include "common/signal_context.h"
 #include "common/types.h"
 #include "core/signals.h"
@@ -490,6 +497,13 @@ static const std::unordered_map<ZydisMnemonic, std::vector<PatchInfo>> Patches =
 
 static std::once_flag init_flag;
 
+/// Executable segment of a module, with the file its patch sites are cached in.
+struct PatchSegment {
+    u8* start;
+    u8* end;
+    std::filesystem::path cache_path;
+};
+
 struct PatchModule {
     /// Mutex controlling access to module code regions.
     std::mutex mutex{};
@@ -503,6 +517,9 @@ struct PatchModule {
     /// Tracker for patched code locations.
     std::set<u8*> patched;
 
+    /// Executable segments, in the order they were loaded.
+    std::vector<PatchSegment> segments;
+
     /// Code generator for patching the module.
     Xbyak::CodeGenerator patch_gen;
 
@@ -590,6 +607,82 @@ static std::pair<bool, u64> TryPatch(u8* code, PatchModule* module) {
     return std::make_pair(false, instruction.length);
 }
 
+/// Instructions copied at most into a relocated block.
+constexpr u32 MaxRelocatedInstructions = 16;
+
+/// Relocates an instruction that is too short for a jump to the trampoline, together with the
+/// instructions following it in its basic block, so that the jump fits in their bytes. Returns
+/// whether the code was replaced.
+static bool TryRelocateBlock(u8* code, PatchModule* module) {
+    struct Relocated {
+        u8* address;
+        ZydisDecodedInstruction instruction;
+        std::array<ZydisDecodedOperand, ZYDIS_MAX_OPERAND_COUNT> operands;
+        const PatchInfo* patch;
+    };
+    constexpr u64 JumpSize = 5;
+
+    // Only take the instructions needed to fit the jump, branch targets inside the replaced bytes
+    // can't be seen from here and fewer instructions make them less likely.
+    std::vector<Relocated> block;
+    u8* pos = code;
+    while (static_cast<u64>(pos - code) < JumpSize) {
+        if (block.size() == MaxRelocatedInstructions) {
+            return false;
+        }
+        auto& entry = block.emplace_back();
+        entry.address = pos;
+        const auto status = Common::Decoder::Instance()->decodeInstruction(
+            entry.instruction, entry.operands.data(), pos, module->end - pos);
+        if (!ZYAN_SUCCESS(status)) {
+            return false;
+        }
+        entry.patch = nullptr;
+        if (const auto it = Patches.find(entry.instruction.mnemonic); it != Patches.end()) {
+            for (const auto& patch_info : it->second) {
+                if (patch_info.trampoline && patch_info.filter(entry.operands.data())) {
+                    entry.patch = &patch_info;
+                    break;
+                }
+            }
+        }
+        // Copied bytes must run the same at another address and fall through to the next one.
+        if (entry.patch == nullptr &&
+            (entry.instruction.meta.branch_type != ZYDIS_BRANCH_TYPE_NONE ||
+             (entry.instruction.attributes & ZYDIS_ATTRIB_IS_RELATIVE) != 0)) {
+            return false;
+        }
+        pos += entry.instruction.length;
+    }
+    if (block.front().patch == nullptr) {
+        return false;
+    }
+
+    auto& trampoline_gen = module->trampoline_gen;
+    const auto trampoline_ptr = trampoline_gen.getCurr();
+    for (const auto& entry : block) {
+        if (entry.patch != nullptr) {
+            entry.patch->generator(entry.address, entry.operands.data(), trampoline_gen);
+        } else {
+            for (u32 i = 0; i < entry.instruction.length; i++) {
+                trampoline_gen.db(entry.address[i]);
+            }
+        }
+    }
+    trampoline_gen.jmp(pos);
+
+    auto& patch_gen = module->patch_gen;
+    patch_gen.reset();
+    patch_gen.setSize(code - patch_gen.getCode());
+    patch_gen.jmp(trampoline_ptr, Xbyak::CodeGenerator::LabelType::T_NEAR);
+    patch_gen.nop(pos - patch_gen.getCurr());
+
+    module->patched.insert(code);
+    LOG_DEBUG(Core, "Relocated {} instructions starting with '{}' at: {}", block.size(),
+              ZydisMnemonicGetString(block.front().instruction.mnemonic), fmt::ptr(code));
+    return true;
+}
+
 #if defined(ARCH_X86_64)
 
 static bool Is4ByteExtrqOrInsertq(void* code_address) {
@@ -740,7 +833,37 @@ static bool TryExecuteIllegalInstruction(void*, void*) {
 #error "Unsupported architecture"
 #endif
 
-static bool TryPatchJit(void* code_address) {
+// Patch sites are cached per executable segment, keyed by the hash of its code before patching.
+// A cache file holds the offsets of the patched instructions from the start of the segment.
+static std::filesystem::path GetPatchCachePath(const u8* code, u64 code_size) {
+    const u64 hash = XXH3_64bits(code, code_size);
+    return Common::FS::GetUserPath(Common::FS::PathType::CacheDir) / "cpu_patches" /
+           fmt::format("{:016x}.bin", hash);
+}
+
+static std::optional<std::vector<u32>> LoadPatchSites(const std::filesystem::path& path) {
+    if (!std::filesystem::exists(path)) {
+        return std::nullopt;
+    }
+    const Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read};
+    if (!file.IsOpen()) {
+        return std::nullopt;
+    }
+    std::vector<u32> sites(file.GetSize() / sizeof(u32));
+    if (file.Read(sites) != sites.size()) {
+        return std::nullopt;
+    }
+    return sites;
+}
+
+static void SavePatchSites(const std::filesystem::path& path, std::span<const u32> sites,
+                           bool append) {
+    const Common::FS::IOFile file{path, append ? Common::FS::FileAccessMode::Append
+                                               : Common::FS::FileAccessMode::Create};
+    file.WriteSpan(sites);
+}
+
+static bool TryPatchJit(void* code_address, bool relocate = false) {
     auto* code = static_cast<u8*>(code_address);
     auto* module = GetModule(code);
     if (module == nullptr) {
@@ -754,22 +877,32 @@ static bool TryPatchJit(void* code_address) {
         return true;
     }
 
-    return TryPatch(code, module).first;
-}
-
-static void TryPatchAot(void* code_address, u64 code_size) {
-    auto* code = static_cast<u8*>(code_address);
-    auto* module = GetModule(code);
-    if (module == nullptr) {
-        return;
+    if (!TryPatch(code, module).first && !(relocate && TryRelocateBlock(code, module))) {
+        return false;
     }
+    // Later boots can apply the patch before the instruction is first executed.
+    const auto segment = std::ranges::find_if(module->segments, [code](const PatchSegment& s) {
+        return code >= s.start && code < s.end;
+    });
+    if (segment != module->segments.end()) {
+        const u32 site = static_cast<u32>(code - segment->start);
+        SavePatchSites(segment->cache_path, std::span{&site, 1}, true);
+    }
+    return true;
+}
 
-    std::unique_lock lock{module->mutex};
-
+static std::vector<u32> TryPatchAot(u8* code, u64 code_size, PatchModule* module) {
+    std::vector<u32> sites;
+    u8* const start = code;
     const auto* end = code + code_size;
     while (code < end) {
-        code += TryPatch(code, module).second;
+        const auto [patched, length] = TryPatch(code, module);
+        if (patched) {
+            sites.push_back(static_cast<u32>(code - start));
+        }
+        code += length;
     }
+    return sites;
 }
 
 static bool PatchesAccessViolationHandler(void* context, void* /* fault_address */) {
@@ -779,9 +912,10 @@ static bool PatchesAccessViolationHandler(void* context, void* /* fault_address
 static bool PatchesIllegalInstructionHandler(void* context) {
     void* code_address = Common::GetRip(context);
     if (Is4ByteExtrqOrInsertq(code_address)) {
-        // The instruction is not big enough for a relative jump, don't try to patch it and pass it
-        // to our illegal instruction interpreter directly
-        return TryExecuteIllegalInstruction(context, code_address);
+        // The instruction is not big enough for a relative jump, move it to the trampoline with
+        // the instructions after it. Interpret it when they can't be moved.
+        return TryPatchJit(code_address, true) ||
+               TryExecuteIllegalInstruction(context, code_address);
     } else {
         if (!TryPatchJit(code_address)) {
             ZydisDecodedInstruction instruction;
@@ -807,8 +941,10 @@ static void PatchesInit() {
         auto* signals = Signals::Instance();
         // Should be called last.
         constexpr auto priority = std::numeric_limits<u32>::max();
-        signals->RegisterAccessViolationHandler(PatchesAccessViolationHandler, priority);
-        signals->RegisterIllegalInstructionHandler(PatchesIllegalInstructionHandler, priority);
+        signals->RegisterAccessViolationHandler(PatchesAccessViolationHandler, priority,
+                                                "CPU patches");
+        signals->RegisterIllegalInstructionHandler(PatchesIllegalInstructionHandler, priority,
+                                                   "CPU patches");
     }
 }
 
@@ -824,12 +960,35 @@ void RegisterPatchModule(void* module_ptr, u64 module_size, void* trampoline_are
 }
 
 void PrePatchInstructions(u64 segment_addr, u64 segment_size) {
+    auto* code = reinterpret_cast<u8*>(segment_addr);
+    auto* module = GetModule(code);
+    if (Patches.empty() || module == nullptr) {
+        return;
+    }
+
+    std::unique_lock lock{module->mutex};
+    const auto cache_path = GetPatchCachePath(code, segment_size);
+    module->segments.emplace_back(code, code + segment_size, cache_path);
+    if (const auto sites = LoadPatchSites(cache_path)) {
+        for (const u32 site : *sites) {
+            if (site < segment_size && !module->patched.contains(code + site) &&
+                !TryPatch(code + site, module).first) {
+                // The site was seen trapping, so it is code and may be relocated.
+                TryRelocateBlock(code + site, module);
+            }
+        }
+        LOG_INFO(Core, "Applied {} cached patch sites to segment at {}", sites->size(),
+                 fmt::ptr(code));
+        return;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(cache_path.parent_path(), ec);
+
 #if !defined(_WIN32) && !defined(__APPLE__)
     // Linux and others have an FS segment pointing to valid memory, so continue to do full
     // ahead-of-time patching for now until a better solution is worked out.
-    if (!Patches.empty()) {
-        TryPatchAot(reinterpret_cast<void*>(segment_addr), segment_size);
-    }
+    const auto sites = TryPatchAot(code, segment_size, module);
+    SavePatchSites(cache_path, sites, false);
 #endif
 }
 
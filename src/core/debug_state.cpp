@@ -145,6 +145,13 @@ void DebugStateImpl::PushQueueDump(QueueDump dump) {
     frame.queues.push_back(std::move(dump));
 }
 
+void DebugStateImpl::PushInitSequenceDump(std::span<const u32> init_sequence) {
+    ASSERT(DumpingCurrentFrame());
+    std::unique_lock lock{frame_dump_list_mutex};
+    auto& frame = GetFrameDump();
+    frame.init_sequence.assign(init_sequence.begin(), init_sequence.end());
+}
+
 std::optional<RegDump*> DebugStateImpl::GetRegDump(uintptr_t base_addr, uintptr_t header_addr) {
     const auto it = waiting_reg_dumps.find(header_addr);
     if (it == waiting_reg_dumps.end()) {
@@ -209,8 +216,9 @@ void DebugStateImpl::PushRegsDumpCompute(uintptr_t base_addr, uintptr_t header_a
 void DebugStateImpl::CollectShader(const std::string& name, Shader::LogicalStage l_stage,
                                    vk::ShaderModule module, std::span<const u32> spv,
                                    std::span<const u32> raw_code, std::span<const u32> patch_spv,
-                                   bool is_patched) {
+                                   bool is_patched, Shader::CompileStats stats) {
     shader_dump_list.emplace_back(name, l_stage, module, std::vector<u32>{spv.begin(), spv.end()},
                                   std::vector<u32>{raw_code.begin(), raw_code.end()},
-                                  std::vector<u32>{patch_spv.begin(), patch_spv.end()}, is_patched);
+                                  std::vector<u32>{patch_spv.begin(), patch_spv.end()}, is_patched,
+                                  std::move(stats));
 }
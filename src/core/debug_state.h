@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <mutex>
 #include <shared_mutex>
@@ -11,9 +12,13 @@
 #include <queue>
 
 #include "common/types.h"
+#include "shader_recompiler/compile_stats.h"
 #include "shader_recompiler/runtime_info.h"
+#include "video_core/amdgpu/pm4_stats.h"
 #include "video_core/amdgpu/regs.h"
+#include "video_core/buffer_cache/buffer_cache_stats.h"
 #include "video_core/renderer_vulkan/vk_common.h"
+#include "video_core/renderer_vulkan/vk_gpu_profiler.h"
 
 #ifdef _WIN32
 #ifndef WIN32_LEAN_AND_MEAN
@@ -77,6 +82,7 @@ struct RegDump {
 
 struct FrameDump {
     u32 frame_id;
+    std::vector<u32> init_sequence; ///< State reset the driver submits ahead of the frame
     std::vector<QueueDump> queues;
     std::unordered_map<uintptr_t, RegDump> regs; // address -> reg dump
 };
@@ -92,6 +98,8 @@ struct ShaderDump {
     std::vector<u32> patch_spv;
     std::string patch_source{};
 
+    Shader::CompileStats stats{};
+
     bool loaded_data = false;
     bool is_patched = false;
     std::string cache_spv_disasm{};
@@ -100,16 +108,17 @@ struct ShaderDump {
 
     ShaderDump(std::string name, Shader::LogicalStage l_stage, vk::ShaderModule module,
                std::vector<u32> spv, std::vector<u32> isa, std::vector<u32> patch_spv,
-               bool is_patched)
+               bool is_patched, Shader::CompileStats stats)
         : name(std::move(name)), l_stage(l_stage), module(module), spv(std::move(spv)),
-          isa(std::move(isa)), patch_spv(std::move(patch_spv)), is_patched(is_patched) {}
+          isa(std::move(isa)), patch_spv(std::move(patch_spv)), stats(std::move(stats)),
+          is_patched(is_patched) {}
 
     ShaderDump(const ShaderDump& other) = delete;
     ShaderDump(ShaderDump&& other) noexcept
         : name{std::move(other.name)}, l_stage(other.l_stage), module{std::move(other.module)},
           spv{std::move(other.spv)}, isa{std::move(other.isa)},
           patch_spv{std::move(other.patch_spv)}, patch_source{std::move(other.patch_source)},
-          cache_spv_disasm{std::move(other.cache_spv_disasm)},
+          stats{std::move(other.stats)}, cache_spv_disasm{std::move(other.cache_spv_disasm)},
           cache_isa_disasm{std::move(other.cache_isa_disasm)},
           cache_patch_disasm{std::move(other.cache_patch_disasm)} {}
     ShaderDump& operator=(const ShaderDump& other) = delete;
@@ -123,6 +132,7 @@ struct ShaderDump {
         isa = std::move(other.isa);
         patch_spv = std::move(other.patch_spv);
         patch_source = std::move(other.patch_source);
+        stats = std::move(other.stats);
         cache_spv_disasm = std::move(other.cache_spv_disasm);
         cache_isa_disasm = std::move(other.cache_isa_disasm);
         cache_patch_disasm = std::move(other.cache_patch_disasm);
@@ -160,6 +170,92 @@ public:
     float Framerate = 1.0f / 60.0f;
     float FrameDeltaTime;
 
+    // Only updated if Config::isIndirectBufferCacheEnabled()
+    std::atomic<u64> ib_cache_lookups{};
+    std::atomic<u64> ib_cache_hits{};
+    // Command processor coroutine frames created during the last frame
+    std::atomic<u32> task_frames_allocated{};
+    std::atomic<u32> task_frames_recycled{};
+    // Page protection ranges requested by the memory trackers and the syscalls applying them
+    std::atomic<u32> page_protect_requests{};
+    std::atomic<u32> page_protect_syscalls{};
+    // Buffer device address faults processed during the last frame
+    std::atomic<u32> fault_buffer_passes{};
+    std::atomic<u32> fault_buffer_pages{};
+    std::atomic<u32> fault_buffer_ranges{};
+    std::atomic<u32> fault_buffer_buffers{};
+    // Images uploaded from guest memory during the last frame and the barriers around the copies
+    std::atomic<u32> image_uploads{};
+    std::atomic<u32> image_upload_barriers{};
+    // Host memory backing the buffer and texture cache page tables
+    std::atomic<u64> page_table_resident_bytes{};
+    // Vblank period of the present thread, the average deviation of the flip spacing from the
+    // flip rate and the flips since startup shown for a different number of display refreshes
+    // than the flip before
+    std::atomic<u32> vblank_period_us{};
+    std::atomic<u32> flip_jitter_us{};
+    std::atomic<u32> uneven_flips{};
+    // Utility stream buffer events since startup
+    std::atomic<u32> stream_buffer_wraps{};
+    std::atomic<u32> stream_buffer_stalls{};
+    std::atomic<u32> stream_buffer_grows{};
+    // Texture cache overlaps since startup resolved with a view and with a copy
+    std::atomic<u32> image_overlap_views{};
+    std::atomic<u32> image_overlap_copies{};
+    // Collected images kept in host memory, and the ones copied back since startup
+    std::atomic<u32> demoted_images{};
+    std::atomic<u64> demoted_image_bytes{};
+    std::atomic<u32> image_promotions{};
+    // Fast clear eliminations since startup, and the ones folded into the load op of a pass
+    // or recorded as a clear before another access
+    std::atomic<u32> fast_clear_eliminations{};
+    std::atomic<u32> fast_clears_folded{};
+    std::atomic<u32> fast_clears_resolved{};
+    // MSAA resolves since startup done by a resolve attachment and by a transfer command
+    std::atomic<u32> resolves_in_render_pass{};
+    std::atomic<u32> resolves_with_transfer{};
+    // Samplers in the texture cache, and the ones evicted since startup to stay under the limit
+    std::atomic<u32> live_samplers{};
+    std::atomic<u32> sampler_evictions{};
+    // Dispatches replaced by transfer commands since startup, and the ones that were not because
+    // the resources of the shader did not match its signature
+    std::atomic<u32> shader_hle_dispatches{};
+    std::atomic<u32> shader_hle_mismatches{};
+    // Time the last present waited for the previous one to be displayed, in low latency mode
+    std::atomic<u32> present_wait_us{};
+    // Guest sleeps since startup by how late they woke up, see SleepOvershootBoundsUs
+    static constexpr std::array<u32, 5> SleepOvershootBoundsUs = {50, 200, 1000, 4000, 16000};
+    std::array<std::atomic<u32>, SleepOvershootBoundsUs.size() + 1> sleep_overshoots{};
+    // Device memory blocks allocated and freed during the last frame
+    std::atomic<u32> device_memory_allocations{};
+    std::atomic<u32> device_memory_frees{};
+    // Live VMA allocations, the blocks holding them, and the part of it in the custom pools
+    std::atomic<u32> vma_allocations{};
+    std::atomic<u64> vma_allocation_bytes{};
+    std::atomic<u64> vma_block_bytes{};
+    std::atomic<u64> vma_pool_allocation_bytes{};
+    std::atomic<u64> vma_pool_block_bytes{};
+    // Audio buffered ahead of the device by the latency targeting output backend, and the times
+    // the device ran out of audio while a port was playing since startup
+    std::atomic<u32> audio_latency_us{};
+    std::atomic<u32> audio_underruns{};
+    // Movie data read in ahead of the AvPlayer demuxer, and the reads that got ahead of it since
+    // startup
+    std::atomic<u64> avplayer_read_ahead_bytes{};
+    std::atomic<u32> avplayer_read_stalls{};
+    // Output of the sceZlib tasks since startup, and the time the task threads spent on them
+    std::atomic<u64> zlib_inflated_bytes{};
+    std::atomic<u64> zlib_inflate_ns{};
+    // Only updated if Config::isPM4ProfilingEnabled()
+    std::mutex pm4_stats_mutex;
+    AmdGpu::PM4FrameStats pm4_frame_stats{};
+    // Only updated if Config::isBufferCacheStatsEnabled()
+    std::mutex buffer_cache_stats_mutex;
+    VideoCore::BufferCacheStats buffer_cache_stats{};
+    // Only updated if Config::getVkGpuTimestampsEnabled()
+    std::mutex gpu_timings_mutex;
+    Vulkan::GpuFrameTimings gpu_timings{};
+
     std::pair<u32, u32> game_resolution{};
     std::pair<u32, u32> output_resolution{};
     bool is_using_fsr{};
@@ -187,6 +283,15 @@ public:
         return is_guest_threads_paused;
     }
 
+    /// Calls func with every guest thread, which can not exit until it returns.
+    template <typename Func>
+    void ForEachGuestThread(Func&& func) {
+        std::lock_guard lock{guest_threads_mutex};
+        for (const ThreadID id : guest_threads) {
+            func(id);
+        }
+    }
+
     void IncFlipFrameNum() {
         ++flip_frame_count;
     }
@@ -221,6 +326,8 @@ public:
 
     void PushQueueDump(QueueDump dump);
 
+    void PushInitSequenceDump(std::span<const u32> init_sequence);
+
     void PushRegsDump(uintptr_t base_addr, uintptr_t header_addr, const AmdGpu::Regs& regs);
     using CsState = AmdGpu::ComputeProgram;
     void PushRegsDumpCompute(uintptr_t base_addr, uintptr_t header_addr, const CsState& cs_state);
@@ -228,7 +335,7 @@ public:
     void CollectShader(const std::string& name, Shader::LogicalStage l_stage,
                        vk::ShaderModule module, std::span<const u32> spv,
                        std::span<const u32> raw_code, std::span<const u32> patch_spv,
-                       bool is_patched);
+                       bool is_patched, Shader::CompileStats stats);
 
 private:
     std::optional<RegDump*> GetRegDump(uintptr_t base_addr, uintptr_t header_addr);
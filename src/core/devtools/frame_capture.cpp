@@ -0,0 +1,258 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/alignment.h"
+#include "common/elf_info.h"
+#include "common/io_file.h"
+#include "common/logging/log.h"
+#include "core/devtools/frame_capture.h"
+#include "core/memory.h"
+#include "video_core/amdgpu/pm4_cmds.h"
+#include "video_core/renderer_vulkan/vk_rasterizer.h"
+
+namespace Core::Devtools {
+
+namespace {
+
+constexpr u32 CaptureMagic = 0x43464853; // SHFC
+constexpr u32 CaptureVersion = 1;
+
+/// Granularity of the captured memory, the replay maps it back with the guest page size
+constexpr u64 CapturePageSize = 16_KB;
+
+/// Indirect buffers calling other indirect buffers are followed this deep
+constexpr u32 MaxIndirectDepth = 4;
+
+struct FileHeader {
+    u32 magic;
+    u32 version;
+    u32 frame_id;
+    s32 sdk_version;
+    u32 serial_size;
+    u32 init_sequence_size;
+    u32 num_queues;
+    u32 num_ranges;
+};
+
+struct QueueHeader {
+    u32 type;
+    u32 submit_num;
+    u32 num2;
+    u32 num_dwords;
+    u64 base_addr;
+};
+
+struct RangeHeader {
+    u64 address;
+    u64 size;
+};
+
+using RangeList = std::vector<std::pair<VAddr, u64>>;
+
+void AddIndirectBuffers(std::span<const u32> cmds, u32 depth, RangeList& ranges) {
+    auto* memory = Core::Memory::Instance();
+    while (!cmds.empty()) {
+        const auto* header = reinterpret_cast<const AmdGpu::PM4Type3Header*>(cmds.data());
+        if (header->type == 2) {
+            cmds = cmds.subspan(1);
+            continue;
+        }
+        if (header->type != 3) {
+            return;
+        }
+        const u32 num_words = std::min<u32>(header->NumWords() + 1, cmds.size());
+        const auto opcode = header->opcode.Value();
+        if (opcode == AmdGpu::PM4ItOpcode::IndirectBuffer ||
+            opcode == AmdGpu::PM4ItOpcode::IndirectBufferConst) {
+            const auto* ib = reinterpret_cast<const AmdGpu::PM4CmdIndirectBuffer*>(header);
+            const auto* ib_data = ib->Address<const u32>();
+            const u32 ib_dwords = ib->ib_size.Value();
+            const u64 ib_size = ib_dwords * sizeof(u32);
+            const VAddr ib_addr = reinterpret_cast<VAddr>(ib_data);
+            if (ib_size != 0 && memory->IsRangeMapped(ib_addr, ib_size)) {
+                ranges.emplace_back(ib_addr, ib_size);
+                if (depth < MaxIndirectDepth) {
+                    AddIndirectBuffers({ib_data, ib_dwords}, depth + 1, ranges);
+                }
+            }
+        }
+        cmds = cmds.subspan(num_words);
+    }
+}
+
+void AddShader(const AmdGpu::ShaderProgram& program, size_t code_size, RangeList& ranges) {
+    // The binary info the recompiler looks for follows the code
+    const VAddr address = program.Address<VAddr>();
+    if (address != 0 && code_size != 0) {
+        ranges.emplace_back(address, code_size * sizeof(u32) + 2 * sizeof(AmdGpu::BinaryInfo));
+    }
+}
+
+/// Sorts the ranges, rounds them to whole pages and merges the ones that touch.
+RangeList MergeRanges(RangeList ranges) {
+    for (auto& [address, size] : ranges) {
+        const VAddr end = Common::AlignUp(address + size, CapturePageSize);
+        address = Common::AlignDown(address, CapturePageSize);
+        size = end - address;
+    }
+    std::ranges::sort(ranges);
+    RangeList merged;
+    for (const auto& [address, size] : ranges) {
+        if (!merged.empty() && address <= merged.back().first + merged.back().second) {
+            auto& last = merged.back();
+            last.second = std::max(last.first + last.second, address + size) - last.first;
+        } else {
+            merged.emplace_back(address, size);
+        }
+    }
+    return merged;
+}
+
+} // Anonymous namespace
+
+bool SaveFrameCapture(const DebugStateType::FrameDump& dump, Vulkan::Rasterizer& rasterizer,
+                      const std::filesystem::path& path) {
+    RangeList ranges;
+    for (const auto& queue : dump.queues) {
+        AddIndirectBuffers(queue.data, 0, ranges);
+    }
+    for (const auto& [addr, regs] : dump.regs) {
+        if (regs.is_compute) {
+            AddShader(regs.cs_data.cs_program, regs.cs_data.code.size(), ranges);
+            continue;
+        }
+        for (const auto& stage : regs.stages) {
+            AddShader(stage.user_data, stage.code.size(), ranges);
+        }
+    }
+    // The descriptors of the draws aren't decoded here, everything the caches hold stands in for
+    // the buffers and images they read
+    rasterizer.GetBufferCache().ForEachBuffer([&](VideoCore::BufferId, VideoCore::Buffer& buffer) {
+        ranges.emplace_back(buffer.CpuAddr(), buffer.SizeBytes());
+    });
+    rasterizer.GetTextureCache().ForEachImage([&](VideoCore::ImageId, VideoCore::Image& image) {
+        if (image.info.guest_address != 0) {
+            ranges.emplace_back(image.info.guest_address, image.info.guest_size);
+        }
+    });
+
+    // Pages that aren't mapped are left out, which may split a range
+    auto* memory = Core::Memory::Instance();
+    std::vector<CapturedRange> captured;
+    u64 captured_bytes = 0;
+    for (const auto& [address, size] : MergeRanges(std::move(ranges))) {
+        VAddr run_start = address;
+        for (VAddr page = address; page <= address + size; page += CapturePageSize) {
+            const bool at_end = page == address + size;
+            if (!at_end && memory->IsRangeMapped(page, CapturePageSize)) {
+                continue;
+            }
+            if (page != run_start) {
+                const auto* src = reinterpret_cast<const u8*>(run_start);
+                captured.push_back({run_start, std::vector<u8>(src, src + (page - run_start))});
+                captured_bytes += page - run_start;
+            }
+            run_start = page + CapturePageSize;
+        }
+    }
+
+    Common::FS::IOFile file{path, Common::FS::FileAccessMode::Create,
+                            Common::FS::FileType::BinaryFile};
+    if (!file.IsOpen()) {
+        LOG_ERROR(Core, "Could not create frame capture {}", path.string());
+        return false;
+    }
+    const auto& game_info = Common::ElfInfo::Instance();
+    const std::string serial{game_info.GameSerial()};
+    const FileHeader header = {
+        .magic = CaptureMagic,
+        .version = CaptureVersion,
+        .frame_id = dump.frame_id,
+        .sdk_version = static_cast<s32>(game_info.CompiledSdkVer()),
+        .serial_size = static_cast<u32>(serial.size()),
+        .init_sequence_size = static_cast<u32>(dump.init_sequence.size()),
+        .num_queues = static_cast<u32>(dump.queues.size()),
+        .num_ranges = static_cast<u32>(captured.size()),
+    };
+    bool ok = file.WriteObject(header);
+    ok &= file.WriteSpan(std::span{serial}) == serial.size();
+    ok &= file.WriteSpan(std::span{dump.init_sequence}) == dump.init_sequence.size();
+    for (const auto& queue : dump.queues) {
+        const QueueHeader queue_header = {
+            .type = static_cast<u32>(queue.type),
+            .submit_num = queue.submit_num,
+            .num2 = queue.num2,
+            .num_dwords = static_cast<u32>(queue.data.size()),
+            .base_addr = queue.base_addr,
+        };
+        ok &= file.WriteObject(queue_header);
+        ok &= file.WriteSpan(std::span{queue.data}) == queue.data.size();
+    }
+    for (const auto& range : captured) {
+        ok &= file.WriteObject(RangeHeader{range.address, range.data.size()});
+        ok &= file.WriteSpan(std::span{range.data}) == range.data.size();
+    }
+    if (!ok) {
+        LOG_ERROR(Core, "Could not write frame capture {}", path.string());
+        return false;
+    }
+    LOG_INFO(Core, "Saved frame {} to {}: {} command buffers, {} memory ranges, {} MB",
+             dump.frame_id, path.string(), dump.queues.size(), captured.size(),
+             captured_bytes / 1_MB);
+    return true;
+}
+
+std::optional<FrameCapture> LoadFrameCapture(const std::filesystem::path& path) {
+    Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read,
+                            Common::FS::FileType::BinaryFile};
+    FileHeader header{};
+    if (!file.IsOpen() || !file.ReadObject(header) || header.magic != CaptureMagic) {
+        LOG_ERROR(Core, "{} is not a frame capture", path.string());
+        return std::nullopt;
+    }
+    if (header.version != CaptureVersion) {
+        LOG_ERROR(Core, "Frame capture {} has version {}, expected {}", path.string(),
+                  header.version, CaptureVersion);
+        return std::nullopt;
+    }
+
+    FrameCapture capture{
+        .sdk_version = header.sdk_version,
+        .frame_id = header.frame_id,
+    };
+    capture.game_serial.resize(header.serial_size);
+    capture.init_sequence.resize(header.init_sequence_size);
+    bool ok = file.ReadSpan(std::span{capture.game_serial}) == header.serial_size;
+    ok &= file.ReadSpan(std::span{capture.init_sequence}) == header.init_sequence_size;
+    capture.queues.reserve(header.num_queues);
+    for (u32 i = 0; ok && i < header.num_queues; ++i) {
+        QueueHeader queue_header{};
+        ok &= file.ReadObject(queue_header);
+        auto& queue = capture.queues.emplace_back(DebugStateType::QueueDump{
+            .type = static_cast<DebugStateType::QueueType>(queue_header.type),
+            .submit_num = queue_header.submit_num,
+            .num2 = queue_header.num2,
+            .data = std::vector<u32>(queue_header.num_dwords),
+            .base_addr = queue_header.base_addr,
+        });
+        ok &= file.ReadSpan(std::span{queue.data}) == queue.data.size();
+    }
+    capture.memory.reserve(header.num_ranges);
+    for (u32 i = 0; ok && i < header.num_ranges; ++i) {
+        RangeHeader range_header{};
+        ok &= file.ReadObject(range_header);
+        auto& range = capture.memory.emplace_back(
+            CapturedRange{range_header.address, std::vector<u8>(range_header.size)});
+        ok &= file.ReadSpan(std::span{range.data}) == range.data.size();
+    }
+    if (!ok) {
+        LOG_ERROR(Core, "Frame capture {} is truncated", path.string());
+        return std::nullopt;
+    }
+    return capture;
+}
+
+} // namespace Core::Devtools
@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common/types.h"
+#include "core/debug_state.h"
+
+namespace Vulkan {
+class Rasterizer;
+}
+
+namespace Core::Devtools {
+
+/// Guest memory at the address it was read from.
+struct CapturedRange {
+    VAddr address;
+    std::vector<u8> data;
+};
+
+/**
+ * A frame as the GPU received it, with the guest memory it reads, so it can be replayed without
+ * the game. Shader binaries are part of the memory, at the addresses the registers point to.
+ */
+struct FrameCapture {
+    std::string game_serial;
+    s32 sdk_version;
+    u32 frame_id;
+    std::vector<u32> init_sequence;
+    std::vector<DebugStateType::QueueDump> queues;
+    std::vector<CapturedRange> memory;
+};
+
+/**
+ * Writes a frame dump to a capture file, together with the guest memory of its indirect buffers
+ * and shaders and of every buffer and image in the caches of the rasterizer. Must be called
+ * while the guest is paused after the dump, when the GPU is idle.
+ */
+bool SaveFrameCapture(const DebugStateType::FrameDump& dump, Vulkan::Rasterizer& rasterizer,
+                      const std::filesystem::path& path);
+
+std::optional<FrameCapture> LoadFrameCapture(const std::filesystem::path& path);
+
+} // namespace Core::Devtools
@@ -8,6 +8,8 @@
 
 #include "SDL3/SDL_log.h"
 #include "common/config.h"
+#include "common/elf_info.h"
+#include "common/path_util.h"
 #include "common/singleton.h"
 #include "common/types.h"
 #include "core/debug_state.h"
@@ -15,11 +17,16 @@
 #include "imgui/imgui_std.h"
 #include "imgui_internal.h"
 #include "options.h"
+#include "sampling_profiler.h"
 #include "video_core/renderer_vulkan/vk_presenter.h"
+#include "widget/alloc_stats.h"
 #include "widget/frame_dump.h"
 #include "widget/frame_graph.h"
+#include "widget/hitch_report.h"
 #include "widget/memory_map.h"
 #include "widget/module_list.h"
+#include "widget/page_faults.h"
+#include "widget/perf_counters.h"
 #include "widget/shader_list.h"
 
 extern std::unique_ptr<Vulkan::Presenter> presenter;
@@ -34,6 +41,7 @@ static bool show_quit_window = false;
 
 static float fps_scale = 1.0f;
 static int dump_frame_count = 1;
+static int profiler_interval_us = 1000;
 
 static Widget::FrameGraph frame_graph;
 static std::vector<Widget::FrameDumpViewer> frame_viewers;
@@ -45,6 +53,10 @@ static bool just_opened_options = false;
 static Widget::MemoryMapViewer memory_map;
 static Widget::ShaderList shader_list;
 static Widget::ModuleList module_list;
+static Widget::AllocStatsViewer alloc_stats;
+static Widget::PerfCountersViewer perf_counters;
+static Widget::HitchReportViewer hitch_report;
+static Widget::PageFaultViewer page_faults;
 
 // clang-format off
 static std::string help_text =
@@ -126,6 +138,46 @@ void L::DrawMenuBar() {
             if (MenuItem("Module list")) {
                 module_list.open = true;
             }
+            if (MenuItem("Host allocations")) {
+                alloc_stats.open = true;
+            }
+            if (MenuItem("Perf counters")) {
+                perf_counters.open = true;
+            }
+            if (MenuItem("Hitch report")) {
+                hitch_report.open = true;
+            }
+            if (MenuItem("Page faults")) {
+                page_faults.open = true;
+            }
+            if (BeginMenu("CPU profiler")) {
+                const bool profiling = SamplingProfiler::IsRunning();
+                BeginDisabled(profiling);
+                SliderInt("Interval (us)", &profiler_interval_us, 100, 10000);
+                EndDisabled();
+                if (MenuItem(profiling ? "Stop" : "Start")) {
+                    if (profiling) {
+                        SamplingProfiler::Stop();
+                    } else {
+                        SamplingProfiler::Start(profiler_interval_us);
+                    }
+                }
+                Text("%llu samples",
+                     static_cast<unsigned long long>(SamplingProfiler::GetNumSamples()));
+                if (MenuItem("Export folded stacks")) {
+                    const auto path = Common::FS::GetUserPath(Common::FS::PathType::LogDir) /
+                                      fmt::format("{}_cpu_profile.folded",
+                                                  Common::ElfInfo::Instance().GameSerial());
+                    if (SamplingProfiler::Export(path)) {
+                        DebugState.ShowDebugMessage(
+                            fmt::format("Exported profile as {}", path.string()));
+                    } else {
+                        DebugState.ShowDebugMessage(
+                            fmt::format("Failed to save {}", path.string()));
+                    }
+                }
+                ImGui::EndMenu();
+            }
             ImGui::EndMenu();
         }
 
@@ -270,6 +322,18 @@ void L::DrawAdvanced() {
     if (module_list.open) {
         module_list.Draw();
     }
+    if (alloc_stats.open) {
+        alloc_stats.Draw();
+    }
+    if (perf_counters.open) {
+        perf_counters.Draw();
+    }
+    if (hitch_report.open) {
+        hitch_report.Draw();
+    }
+    if (page_faults.open) {
+        page_faults.Draw();
+    }
 }
 
 void L::DrawSimple() {
@@ -0,0 +1,518 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <fmt/format.h>
+
+#include "common/io_file.h"
+#include "common/logging/log.h"
+#include "common/signal_context.h"
+#include "common/singleton.h"
+#include "common/thread.h"
+#include "core/debug_state.h"
+#include "core/devtools/sampling_profiler.h"
+#include "core/linker.h"
+#include "core/loader/dwarf.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+#endif
+
+namespace Core::Devtools::SamplingProfiler {
+
+namespace {
+
+/// Frames past this depth are dropped, the stack is kept from the leaf up
+constexpr u32 MaxFrames = 64;
+
+/// How long a thread has to take the sampling signal before it is skipped for this round
+constexpr auto SampleTimeout = std::chrono::milliseconds{2};
+
+/// Program counters of a stack from the leaf, every one but the first is a return address.
+struct Stack {
+    std::array<u64, MaxFrames> frames;
+    u32 num_frames;
+};
+
+/// Samples are counted by thread name and stack
+using StackKey = std::pair<std::string, std::vector<u64>>;
+
+std::mutex profile_mutex;
+std::map<StackKey, u64> profile_stacks;
+u64 num_samples{};
+
+std::mutex control_mutex;
+std::jthread sampler_thread;
+
+/**
+ * Follows the frame pointer chain from the interrupted registers. Frames must be 8 byte aligned,
+ * above the previous one and within the part of the stack above the stack pointer, which stops
+ * the walk on code that does not keep frame pointers instead of reading outside of the stack.
+ */
+void WalkStack(void* context, u64 stack_begin, u64 stack_end, Stack& stack) {
+    const u64 rsp = reinterpret_cast<u64>(Common::GetRsp(context));
+    stack.frames[0] = reinterpret_cast<u64>(Common::GetRip(context));
+    stack.num_frames = 1;
+    if (rsp < stack_begin || rsp >= stack_end) {
+        // Running on another stack, such as the alternate signal stack
+        return;
+    }
+    u64 frame = reinterpret_cast<u64>(Common::GetRbp(context));
+    while (stack.num_frames < MaxFrames) {
+        if (frame < rsp || frame > stack_end - 2 * sizeof(u64) || (frame & 7) != 0) {
+            break;
+        }
+        const u64* record = reinterpret_cast<const u64*>(frame);
+        const u64 next_frame = record[0];
+        const u64 return_address = record[1];
+        if (return_address == 0) {
+            break;
+        }
+        stack.frames[stack.num_frames++] = return_address;
+        if (next_frame <= frame) {
+            break;
+        }
+        frame = next_frame;
+    }
+}
+
+/// A guest thread as the sampler tracks it between rounds.
+struct SampledThread {
+    std::string name;
+    u64 cpu_time{};
+#ifdef _WIN32
+    HANDLE handle{};
+#endif
+};
+
+std::string SanitizeFrameName(std::string name) {
+    // ';' separates the frames of a folded stack
+    std::ranges::replace(name, ';', ':');
+    return name;
+}
+
+#ifdef _WIN32
+
+SampledThread OpenSampledThread(ThreadID id) {
+    SampledThread thread{};
+    thread.name = fmt::format("Thread {}", id);
+    thread.handle = OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT |
+                                   THREAD_QUERY_INFORMATION,
+                               FALSE, id);
+    return thread;
+}
+
+void CloseSampledThread(SampledThread& thread) {
+    if (thread.handle) {
+        CloseHandle(thread.handle);
+    }
+}
+
+u64 GetThreadCpuTime(ThreadID, const SampledThread& thread) {
+    ULONG64 cycles{};
+    if (!thread.handle || !QueryThreadCycleTime(thread.handle, &cycles)) {
+        return 0;
+    }
+    return cycles;
+}
+
+bool SampleThread(ThreadID, SampledThread& thread, Stack& stack) {
+    if (!thread.handle || SuspendThread(thread.handle) == static_cast<DWORD>(-1)) {
+        return false;
+    }
+    // Nothing in here may allocate, the thread could be holding the heap lock
+    CONTEXT context{};
+    context.ContextFlags = CONTEXT_CONTROL | CONTEXT_INTEGER;
+    const bool sampled = GetThreadContext(thread.handle, &context);
+    if (sampled) {
+        MEMORY_BASIC_INFORMATION info{};
+        u64 stack_begin = 0;
+        u64 stack_end = 0;
+        if (VirtualQuery(reinterpret_cast<void*>(context.Rsp), &info, sizeof(info)) != 0) {
+            stack_begin = reinterpret_cast<u64>(info.BaseAddress);
+            stack_end = stack_begin + info.RegionSize;
+        }
+        EXCEPTION_POINTERS pointers{nullptr, &context};
+        WalkStack(&pointers, stack_begin, stack_end, stack);
+    }
+    ResumeThread(thread.handle);
+    return sampled;
+}
+
+void InstallSignalHandler() {}
+
+#else
+
+constexpr int SampleSignal = SIGPROF;
+
+/// A sample waiting for the thread it was asked from, filled in by the signal handler.
+struct SampleRequest {
+    ThreadID thread;
+    u64 stack_begin;
+    u64 stack_end;
+    Stack stack;
+    std::atomic<bool> done;
+};
+
+std::atomic<SampleRequest*> pending_request{};
+
+void SampleSignalHandler(int, siginfo_t*, void* context) {
+    // Late signals of a request that timed out find nothing, or the request of another thread
+    SampleRequest* request = pending_request.load(std::memory_order_acquire);
+    if (!request || !pthread_equal(request->thread, pthread_self()) ||
+        !pending_request.compare_exchange_strong(request, nullptr, std::memory_order_acquire)) {
+        return;
+    }
+    WalkStack(context, request->stack_begin, request->stack_end, request->stack);
+    request->done.store(true, std::memory_order_release);
+}
+
+void InstallSignalHandler() {
+    // Installed once and left in place, a signal arriving after the profiler stopped must not
+    // take the default action of terminating the process
+    static std::once_flag installed;
+    std::call_once(installed, [] {
+        struct sigaction action{};
+        action.sa_sigaction = SampleSignalHandler;
+        action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SampleSignal, &action, nullptr) != 0) {
+            LOG_ERROR(Debug, "Failed to install the sampling signal handler");
+        }
+    });
+}
+
+SampledThread OpenSampledThread(ThreadID id) {
+    SampledThread thread{};
+    std::array<char, 64> name{};
+    if (pthread_getname_np(id, name.data(), name.size()) == 0 && name[0] != '\0') {
+        thread.name = SanitizeFrameName(name.data());
+    } else {
+        thread.name = "Guest thread";
+    }
+    return thread;
+}
+
+void CloseSampledThread(SampledThread&) {}
+
+u64 GetThreadCpuTime(ThreadID id, const SampledThread&) {
+#ifdef __APPLE__
+    mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+    thread_basic_info_data_t info{};
+    if (thread_info(pthread_mach_thread_np(id), THREAD_BASIC_INFO,
+                    reinterpret_cast<thread_info_t>(&info), &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return (info.user_time.seconds + info.system_time.seconds) * 1000000ULL +
+           info.user_time.microseconds + info.system_time.microseconds;
+#else
+    clockid_t clock;
+    timespec time{};
+    if (pthread_getcpuclockid(id, &clock) != 0 || clock_gettime(clock, &time) != 0) {
+        return 0;
+    }
+    return time.tv_sec * 1000000000ULL + time.tv_nsec;
+#endif
+}
+
+bool GetStackBounds(ThreadID id, u64& stack_begin, u64& stack_end) {
+#ifdef __APPLE__
+    stack_end = reinterpret_cast<u64>(pthread_get_stackaddr_np(id));
+    stack_begin = stack_end - pthread_get_stacksize_np(id);
+    return true;
+#else
+    pthread_attr_t attr;
+    if (pthread_getattr_np(id, &attr) != 0) {
+        return false;
+    }
+    void* addr{};
+    size_t size{};
+    const bool result = pthread_attr_getstack(&attr, &addr, &size) == 0;
+    pthread_attr_destroy(&attr);
+    stack_begin = reinterpret_cast<u64>(addr);
+    stack_end = stack_begin + size;
+    return result;
+#endif
+}
+
+bool SampleThread(ThreadID id, SampledThread&, Stack& stack) {
+    SampleRequest request{};
+    request.thread = id;
+    if (!GetStackBounds(id, request.stack_begin, request.stack_end)) {
+        return false;
+    }
+    pending_request.store(&request, std::memory_order_release);
+    if (pthread_kill(id, SampleSignal) != 0) {
+        pending_request.store(nullptr, std::memory_order_relaxed);
+        return false;
+    }
+    const auto timeout = std::chrono::steady_clock::now() + SampleTimeout;
+    while (!request.done.load(std::memory_order_acquire)) {
+        if (std::chrono::steady_clock::now() > timeout) {
+            SampleRequest* expected = &request;
+            if (pending_request.compare_exchange_strong(expected, nullptr,
+                                                        std::memory_order_acq_rel)) {
+                // Not taken yet, the handler can no longer see the request
+                return false;
+            }
+            // Taken, the handler is walking the stack and finishes shortly
+        }
+        std::this_thread::yield();
+    }
+    stack = request.stack;
+    return true;
+}
+
+#endif
+
+void SamplerLoop(std::stop_token stop_token, std::chrono::microseconds interval) {
+    Common::SetCurrentThreadName("shadPS4:Profiler");
+
+    std::unordered_map<ThreadID, SampledThread> threads;
+    std::vector<std::pair<std::string, Stack>> samples;
+    auto next_round = std::chrono::steady_clock::now();
+    while (!stop_token.stop_requested()) {
+        std::unordered_map<ThreadID, SampledThread> seen;
+        DebugState.ForEachGuestThread([&](ThreadID id) {
+            auto node = threads.extract(id);
+            SampledThread thread = node.empty() ? OpenSampledThread(id) : std::move(node.mapped());
+            // Threads that did not run since the last round are waiting, interrupting them would
+            // only wake them up
+            const u64 cpu_time = GetThreadCpuTime(id, thread);
+            Stack stack;
+            if (cpu_time != thread.cpu_time && SampleThread(id, thread, stack)) {
+                samples.emplace_back(thread.name, stack);
+            }
+            thread.cpu_time = cpu_time;
+            seen.emplace(id, std::move(thread));
+        });
+        for (auto& [id, thread] : threads) {
+            CloseSampledThread(thread);
+        }
+        threads = std::move(seen);
+
+        {
+            std::scoped_lock lock{profile_mutex};
+            for (const auto& [name, stack] : samples) {
+                ++profile_stacks[{name, {stack.frames.begin(),
+                                         stack.frames.begin() + stack.num_frames}}];
+            }
+            num_samples += samples.size();
+        }
+        samples.clear();
+
+        const auto now = std::chrono::steady_clock::now();
+        next_round = std::max(next_round + interval, now);
+        std::this_thread::sleep_until(next_round);
+    }
+    for (auto& [id, thread] : threads) {
+        CloseSampledThread(thread);
+    }
+}
+
+/// Names the program counters of the samples after their function, cached per address.
+class Symbolizer {
+public:
+    std::string Symbolize(u64 pc) {
+        auto [it, inserted] = names.try_emplace(pc);
+        if (inserted) {
+            const Module* module = linker->FindByAddress(pc);
+            it->second =
+                SanitizeFrameName(module ? SymbolizeGuest(*module, pc) : SymbolizeHost(pc));
+        }
+        return it->second;
+    }
+
+private:
+    struct ModuleFunctions {
+        std::vector<std::pair<VAddr, std::string>> exports; ///< Sorted by address
+        Dwarf::EHHeaderInfo eh_info{};
+        uintptr_t eh_hdr_start{};
+        bool has_eh_hdr{};
+    };
+
+    const ModuleFunctions& GetModuleFunctions(const Module& module) {
+        auto [it, inserted] = modules.try_emplace(&module);
+        auto& functions = it->second;
+        if (!inserted) {
+            return functions;
+        }
+        for (const auto& symbol : module.export_sym.GetSymbols()) {
+            if (symbol.virtual_address == 0) {
+                continue;
+            }
+            // Symbols without a known name keep their NID, the part of the name before the
+            // library
+            functions.exports.emplace_back(symbol.virtual_address,
+                                           symbol.nid_name != "UNK"
+                                               ? symbol.nid_name
+                                               : symbol.name.substr(0, symbol.name.find('#')));
+        }
+        std::ranges::sort(functions.exports, {}, &std::pair<VAddr, std::string>::first);
+        if (module.eh_frame_hdr_size != 0) {
+            functions.eh_hdr_start = module.GetBaseAddress() + module.eh_frame_hdr_addr;
+            functions.has_eh_hdr =
+                Dwarf::DecodeEHHdr(functions.eh_hdr_start,
+                                   functions.eh_hdr_start + module.eh_frame_hdr_size,
+                                   functions.eh_info);
+        }
+        return functions;
+    }
+
+    std::string SymbolizeGuest(const Module& module, u64 pc) {
+        const auto& functions = GetModuleFunctions(module);
+        const VAddr base = module.GetBaseAddress();
+        VAddr start = 0;
+        std::string_view name;
+        const auto it = std::ranges::upper_bound(functions.exports, pc, {},
+                                                 &std::pair<VAddr, std::string>::first);
+        if (it != functions.exports.begin()) {
+            start = std::prev(it)->first;
+            name = std::prev(it)->second;
+        }
+        // Most functions are not exported, the unwind table still knows where they start
+        if (functions.has_eh_hdr) {
+            const uintptr_t fde_start =
+                Dwarf::FindFunctionStart(functions.eh_hdr_start, functions.eh_info, pc);
+            if (fde_start > start && fde_start <= pc) {
+                return fmt::format("{}!sub_{:x}", module.name, fde_start - base);
+            }
+        }
+        if (!name.empty()) {
+            return fmt::format("{}!{}", module.name, name);
+        }
+        return fmt::format("{}!{:#x}", module.name, pc - base);
+    }
+
+    static std::string SymbolizeHost(u64 pc) {
+#ifdef _WIN32
+        HMODULE handle{};
+        if (!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+                                    GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                                reinterpret_cast<LPCWSTR>(pc), &handle)) {
+            return fmt::format("{:#x}", pc);
+        }
+        std::array<wchar_t, MAX_PATH> path{};
+        GetModuleFileNameW(handle, path.data(), static_cast<DWORD>(path.size()));
+        return fmt::format("{}!{:#x}", std::filesystem::path{path.data()}.filename().string(),
+                           pc - reinterpret_cast<u64>(handle));
+#else
+        // Only the dynamic symbol table is available, other host functions keep their offset
+        Dl_info info{};
+        if (dladdr(reinterpret_cast<void*>(pc), &info) == 0) {
+            return fmt::format("{:#x}", pc);
+        }
+        const std::string library =
+            info.dli_fname ? std::filesystem::path{info.dli_fname}.filename().string() : "host";
+        if (!info.dli_sname) {
+            return fmt::format("{}!{:#x}", library, pc - reinterpret_cast<u64>(info.dli_fbase));
+        }
+        int status{};
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        std::string name = status == 0 ? demangled : info.dli_sname;
+        std::free(demangled);
+        return fmt::format("{}!{}", library, name);
+#endif
+    }
+
+    Core::Linker* linker = Common::Singleton<Core::Linker>::Instance();
+    std::unordered_map<u64, std::string> names;
+    std::unordered_map<const Module*, ModuleFunctions> modules;
+};
+
+} // Anonymous namespace
+
+void Start(u32 interval_us) {
+    std::scoped_lock lock{control_mutex};
+    if (sampler_thread.joinable()) {
+        sampler_thread.request_stop();
+        sampler_thread.join();
+    }
+    {
+        std::scoped_lock profile_lock{profile_mutex};
+        profile_stacks.clear();
+        num_samples = 0;
+    }
+    InstallSignalHandler();
+    const std::chrono::microseconds interval{std::max(interval_us, 100U)};
+    sampler_thread = std::jthread{
+        [interval](std::stop_token stop_token) { SamplerLoop(stop_token, interval); }};
+    LOG_INFO(Debug, "Sampling guest threads every {} us", interval.count());
+}
+
+void Stop() {
+    std::scoped_lock lock{control_mutex};
+    if (!sampler_thread.joinable()) {
+        return;
+    }
+    sampler_thread.request_stop();
+    sampler_thread.join();
+    LOG_INFO(Debug, "Stopped sampling guest threads, {} samples", GetNumSamples());
+}
+
+bool IsRunning() {
+    std::scoped_lock lock{control_mutex};
+    return sampler_thread.joinable();
+}
+
+u64 GetNumSamples() {
+    std::scoped_lock lock{profile_mutex};
+    return num_samples;
+}
+
+bool Export(const std::filesystem::path& path) {
+    std::map<StackKey, u64> stacks;
+    {
+        std::scoped_lock lock{profile_mutex};
+        stacks = profile_stacks;
+    }
+
+    // Different addresses of a function fold into one stack
+    Symbolizer symbolizer;
+    std::map<std::string, u64> folded;
+    for (const auto& [key, count] : stacks) {
+        const auto& [thread_name, frames] = key;
+        std::string line = thread_name;
+        for (size_t i = frames.size(); i-- > 0;) {
+            // Return addresses point after the call, which may be the start of the next function
+            const u64 pc = i == 0 ? frames[i] : frames[i] - 1;
+            line += ';';
+            line += symbolizer.Symbolize(pc);
+        }
+        folded[std::move(line)] += count;
+    }
+
+    Common::FS::IOFile file{path, Common::FS::FileAccessMode::Write,
+                            Common::FS::FileType::TextFile};
+    if (!file.IsOpen()) {
+        LOG_ERROR(Debug, "Failed to open {} for writing", path.string());
+        return false;
+    }
+    for (const auto& [line, count] : folded) {
+        file.WriteString(fmt::format("{} {}\n", line, count));
+    }
+    LOG_INFO(Debug, "Exported {} stacks to {}", folded.size(), path.string());
+    return true;
+}
+
+} // namespace Core::Devtools::SamplingProfiler
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+
+#include "common/types.h"
+
+/**
+ * Sampling profiler of the guest threads. Threads that ran since the previous sample are
+ * interrupted at a fixed interval, their stack is walked through the frame pointer chain and the
+ * addresses are symbolized through the modules of the linker when the samples are exported.
+ */
+namespace Core::Devtools::SamplingProfiler {
+
+/// Starts sampling every interval_us microseconds, dropping the samples of a previous run.
+void Start(u32 interval_us);
+
+void Stop();
+
+[[nodiscard]] bool IsRunning();
+
+/// Returns the number of stacks recorded since Start.
+[[nodiscard]] u64 GetNumSamples();
+
+/**
+ * Writes the samples as folded stacks, one line per unique stack with its frames from the thread
+ * name to the leaf separated by ';' and the number of samples, as read by flamegraph.pl and
+ * speedscope. Returns false when it could not be written.
+ */
+bool Export(const std::filesystem::path& path);
+
+} // namespace Core::Devtools::SamplingProfiler
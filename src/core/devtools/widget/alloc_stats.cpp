@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <imgui.h>
+
+#include "alloc_stats.h"
+#include "common/logging/log.h"
+
+using namespace ImGui;
+
+namespace Core::Devtools::Widget {
+
+void AllocStatsViewer::UpdateRates() {
+    const auto now = std::chrono::steady_clock::now();
+    stats = Common::GetAllocStats();
+    const double seconds = std::chrono::duration<double>(now - last_sample).count();
+    if (seconds < 1.0) {
+        return;
+    }
+    for (size_t i = 0; i < stats.size(); ++i) {
+        allocs_per_sec[i] = (stats[i].num_allocs - last_stats[i].num_allocs) / seconds;
+        bytes_per_sec[i] = (stats[i].bytes_allocated - last_stats[i].bytes_allocated) / seconds;
+    }
+    last_stats = stats;
+    last_sample = now;
+}
+
+void AllocStatsViewer::LogSnapshot() const {
+    LOG_INFO(Debug, "{:<20} {:>12} {:>12} {:>14} {:>12} {:>12}", "Host allocations",
+             "Live KB", "Live count", "Allocated KB", "Allocs/s", "KB/s");
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const auto& tag = stats[i];
+        LOG_INFO(Debug, "{:<20} {:>12} {:>12} {:>14} {:>12.0f} {:>12.1f}",
+                 Common::GetAllocTagName(static_cast<Common::AllocTag>(i)),
+                 tag.LiveBytes() / 1024, tag.LiveAllocs(), tag.bytes_allocated / 1024,
+                 allocs_per_sec[i], bytes_per_sec[i] / 1024.0);
+    }
+}
+
+void AllocStatsViewer::Draw() {
+    SetNextWindowSize({650.0f, 250.0f}, ImGuiCond_FirstUseEver);
+    if (!Begin("Host allocations", &open)) {
+        End();
+        return;
+    }
+    if (!Common::IsAllocTrackingEnabled()) {
+        TextWrapped("Allocation tracking is not part of this build, configure it with "
+                    "-DENABLE_ALLOC_TRACKING=ON.");
+        End();
+        return;
+    }
+
+    UpdateRates();
+    if (Button("Log snapshot")) {
+        LogSnapshot();
+    }
+    if (BeginTable("AllocTable", 6,
+                   ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg)) {
+        TableSetupColumn("Subsystem", ImGuiTableColumnFlags_WidthStretch);
+        TableSetupColumn("Live KB");
+        TableSetupColumn("Live count");
+        TableSetupColumn("Allocated KB");
+        TableSetupColumn("Allocs/s");
+        TableSetupColumn("KB/s");
+        TableHeadersRow();
+        for (size_t i = 0; i < stats.size(); ++i) {
+            const auto& tag = stats[i];
+            TableNextRow();
+            TableNextColumn();
+            TextUnformatted(Common::GetAllocTagName(static_cast<Common::AllocTag>(i)));
+            TableNextColumn();
+            Text("%llu", static_cast<unsigned long long>(tag.LiveBytes() / 1024));
+            TableNextColumn();
+            Text("%llu", static_cast<unsigned long long>(tag.LiveAllocs()));
+            TableNextColumn();
+            Text("%llu", static_cast<unsigned long long>(tag.bytes_allocated / 1024));
+            TableNextColumn();
+            Text("%.0f", allocs_per_sec[i]);
+            TableNextColumn();
+            Text("%.1f", bytes_per_sec[i] / 1024.0);
+        }
+        EndTable();
+    }
+
+    End();
+}
+
+} // namespace Core::Devtools::Widget
@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+
+#include "common/alloc_tracker.h"
+
+namespace Core::Devtools::Widget {
+
+/// Host allocations per subsystem, with the rates over the last second.
+class AllocStatsViewer {
+public:
+    bool open = false;
+
+    void Draw();
+
+private:
+    void UpdateRates();
+    void LogSnapshot() const;
+
+    Common::AllocStatsArray stats{};
+    Common::AllocStatsArray last_stats{};
+    std::chrono::steady_clock::time_point last_sample{};
+    std::array<double, static_cast<size_t>(Common::AllocTag::Count)> allocs_per_sec{};
+    std::array<double, static_cast<size_t>(Common::AllocTag::Count)> bytes_per_sec{};
+};
+
+} // namespace Core::Devtools::Widget
@@ -3,6 +3,7 @@
 
 // Credits to https://github.com/psucien/tlg-emu-tools/
 
+#include <algorithm>
 #include <cinttypes>
 #include <string>
 #include <gcn/si_ci_vi_merged_offset.h>
@@ -36,6 +37,9 @@ namespace Core::Devtools::Widget {
 static bool group_batches = true;
 static bool show_markers = false;
 
+/// Packets decoded per frame while a command list is drawn.
+static constexpr size_t PacketsPerFrame = 32768;
+
 void CmdListViewer::LoadConfig(const char* line) {
     int i;
     if (sscanf(line, "group_batches=%d", &i) == 1) {
@@ -1082,8 +1086,6 @@ CmdListViewer::CmdListViewer(DebugStateType::FrameDump* _frame_dump,
                              const std::vector<u32>& cmd_list, uintptr_t _base_addr,
                              std::string _name)
     : frame_dump(_frame_dump), base_addr(_base_addr), name(std::move(_name)) {
-    using namespace AmdGpu;
-
     cmdb_addr = (uintptr_t)cmd_list.data();
     cmdb_size = cmd_list.size() * sizeof(u32);
 
@@ -1091,19 +1093,24 @@ CmdListViewer::CmdListViewer(DebugStateType::FrameDump* _frame_dump,
     cmdb_view.Open = false;
     cmdb_view.ReadOnly = true;
 
-    auto const* pm4_hdr = reinterpret_cast<PM4Header const*>(cmdb_addr);
-
-    size_t processed_size = 0;
-    size_t prev_offset = 0;
-    u32 batch_id = 0;
-
-    std::string marker{};
-
     if (cmdb_size > 0) {
         events.emplace_back(BatchBegin{.id = 0});
+    } else {
+        is_decoded = true;
     }
+}
+
+void CmdListViewer::DecodePackets(size_t max_packets) {
+    using namespace AmdGpu;
+
+    size_t processed_size = decoded_size;
+    size_t prev_offset = batch_start;
+    u32 batch_id = num_batches;
+
+    for (size_t n = 0; n < max_packets && processed_size < cmdb_size; ++n) {
+        auto const* pm4_hdr = reinterpret_cast<PM4Header const*>(cmdb_addr + processed_size);
+        packet_offsets.push_back(processed_size);
 
-    while (processed_size < cmdb_size) {
         auto* next_pm4_hdr = GetNext(pm4_hdr, 1);
         auto processed_len =
             reinterpret_cast<uintptr_t>(next_pm4_hdr) - reinterpret_cast<uintptr_t>(pm4_hdr);
@@ -1154,9 +1161,15 @@ CmdListViewer::CmdListViewer(DebugStateType::FrameDump* _frame_dump,
                 events.emplace_back(BatchBegin{.id = batch_id});
             }
         }
+    }
 
-        pm4_hdr = next_pm4_hdr;
+    decoded_size = processed_size;
+    batch_start = prev_offset;
+    num_batches = batch_id;
+    if (processed_size < cmdb_size) {
+        return;
     }
+    is_decoded = true;
 
     // state batch (last)
     if (processed_size - prev_offset > 0) {
@@ -1174,6 +1187,13 @@ CmdListViewer::CmdListViewer(DebugStateType::FrameDump* _frame_dump,
     }
 }
 
+std::pair<size_t, size_t> CmdListViewer::GetPacketRange(const BatchInfo& batch) const {
+    const auto first = std::ranges::lower_bound(packet_offsets, batch.start_addr);
+    const auto last = std::lower_bound(first, packet_offsets.end(), batch.end_addr);
+    return {static_cast<size_t>(first - packet_offsets.begin()),
+            static_cast<size_t>(last - packet_offsets.begin())};
+}
+
 void CmdListViewer::Draw(bool only_batches_view, CmdListFilter& filter) {
     const auto& ctx = *GetCurrentContext();
 
@@ -1192,6 +1212,9 @@ void CmdListViewer::Draw(bool only_batches_view, CmdListFilter& filter) {
     if (only_batches_view) {
         return;
     }
+    if (!is_decoded) {
+        DecodePackets(PacketsPerFrame);
+    }
 
     if (cmdb_view.Open) {
         MemoryEditor::Sizes s;
@@ -1231,6 +1254,11 @@ void CmdListViewer::Draw(bool only_batches_view, CmdListFilter& filter) {
             cmdb_view.Open ^= true;
         }
         Text("size     : %04zX", cmdb_size);
+        Text("packets  : %zu", packet_offsets.size());
+        if (!is_decoded) {
+            ProgressBar(static_cast<float>(decoded_size) / static_cast<float>(cmdb_size),
+                        {-FLT_MIN, 0.0f}, "Decoding");
+        }
         Separator();
 
         {
@@ -1320,9 +1348,6 @@ void CmdListViewer::Draw(bool only_batches_view, CmdListFilter& filter) {
                     }
                 }
 
-                auto const* pm4_hdr =
-                    reinterpret_cast<PM4Header const*>(cmdb_addr + batch.start_addr);
-
                 bool ignore_header = false;
                 char batch_hdr[128];
                 if (batch.type == static_cast<AmdGpu::PM4ItOpcode>(0xFF)) {
@@ -1384,111 +1409,126 @@ void CmdListViewer::Draw(bool only_batches_view, CmdListFilter& filter) {
                 }
 
                 if (show_batch_content) {
-                    size_t processed_size = 0;
                     auto bb = ctx.LastItemData.Rect;
                     if (group_batches && !ignore_header) {
                         Indent();
                     }
-                    auto const batch_sz = batch.end_addr - batch.start_addr;
-
-                    while (processed_size < batch_sz) {
-                        AmdGpu::PM4ItOpcode op{0xFFu};
-
-                        if (pm4_hdr->type == AmdGpu::PM4Type3Header::TYPE) {
-                            auto const* pm4_t3 =
-                                reinterpret_cast<AmdGpu::PM4Type3Header const*>(pm4_hdr);
-                            op = pm4_t3->opcode;
-
-                            char header_name[128];
-                            snprintf(header_name, sizeof(header_name), "%08" PRIXPTR ": %s",
-                                     cmdb_addr + batch.start_addr + processed_size,
-                                     Gcn::GetOpCodeName(static_cast<u32>(op)));
-
-                            bool open_pm4 = TreeNode(header_name);
-                            if (!group_batches) {
-                                if (IsDrawCall(op)) {
-                                    SameLine(GetContentRegionAvail().x - 40.0f);
-                                    const char* text =
-                                        last_selected_batch == static_cast<int>(batch_id) &&
-                                                batch_view.open
-                                            ? "X"
-                                            : "->";
-                                    if (Button(text, {40.0f, 0.0f})) {
-                                        open_batch_view();
-                                    }
-                                }
-                                if (IsItemHovered() && ctx.IO.KeyShift) {
-                                    if (BeginTooltip()) {
-                                        Text("Batch %d", batch_id);
-                                        EndTooltip();
-                                    }
+
+                    const auto draw_packet = [&, this](size_t packet) {
+                        const size_t offset = packet_offsets[packet];
+                        auto const* pm4_hdr =
+                            reinterpret_cast<PM4Header const*>(cmdb_addr + offset);
+                        if (pm4_hdr->type != AmdGpu::PM4Type3Header::TYPE) {
+                            Text("<UNK PACKET>");
+                            return;
+                        }
+                        auto const* pm4_t3 =
+                            reinterpret_cast<AmdGpu::PM4Type3Header const*>(pm4_hdr);
+                        const AmdGpu::PM4ItOpcode op = pm4_t3->opcode;
+
+                        const bool open_pm4 = TreeNodeEx(reinterpret_cast<void*>(offset), 0,
+                                                         "%08" PRIXPTR ": %s", cmdb_addr + offset,
+                                                         Gcn::GetOpCodeName(static_cast<u32>(op)));
+                        const bool toggled_open = IsItemToggledOpen();
+                        if (open_pm4) {
+                            open_packets.insert(packet);
+                        } else {
+                            open_packets.erase(packet);
+                        }
+                        if (!group_batches) {
+                            if (IsDrawCall(op)) {
+                                SameLine(GetContentRegionAvail().x - 40.0f);
+                                const char* text =
+                                    last_selected_batch == static_cast<int>(batch_id) &&
+                                            batch_view.open
+                                        ? "X"
+                                        : "->";
+                                if (Button(text, {40.0f, 0.0f})) {
+                                    open_batch_view();
                                 }
                             }
-                            if (open_pm4) {
-                                if (IsItemToggledOpen()) {
-                                    // Editor
-                                    cmdb_view.GotoAddrAndHighlight(
-                                        reinterpret_cast<size_t>(pm4_hdr) - cmdb_addr,
-                                        reinterpret_cast<size_t>(pm4_hdr) - cmdb_addr +
-                                            (pm4_hdr->count + 2) * 4);
+                            if (IsItemHovered() && ctx.IO.KeyShift) {
+                                if (BeginTooltip()) {
+                                    Text("Batch %d", batch_id);
+                                    EndTooltip();
                                 }
+                            }
+                        }
+                        if (!open_pm4) {
+                            return;
+                        }
+                        if (toggled_open) {
+                            // Editor
+                            cmdb_view.GotoAddrAndHighlight(offset,
+                                                           offset + (pm4_hdr->count + 2) * 4);
+                        }
 
-                                if (BeginTable("split", 1)) {
-                                    TableNextColumn();
-                                    Text("size: %d", pm4_hdr->count + 1);
-
-                                    auto const* it_body =
-                                        reinterpret_cast<uint32_t const*>(pm4_hdr + 1);
+                        if (BeginTable("split", 1)) {
+                            TableNextColumn();
+                            Text("size: %d", pm4_hdr->count + 1);
 
-                                    switch (op) {
-                                    case AmdGpu::PM4ItOpcode::Nop: {
-                                        OnNop(pm4_t3, it_body);
-                                        break;
-                                    }
-                                    case AmdGpu::PM4ItOpcode::SetBase: {
-                                        OnSetBase(pm4_t3, it_body);
-                                        break;
-                                    }
-                                    case AmdGpu::PM4ItOpcode::SetContextReg: {
-                                        OnSetContextReg(pm4_t3, it_body);
-                                        break;
-                                    }
-                                    case AmdGpu::PM4ItOpcode::SetShReg: {
-                                        OnSetShReg(pm4_t3, it_body);
-                                        break;
-                                    }
-                                    case AmdGpu::PM4ItOpcode::DispatchDirect: {
-                                        OnDispatch(pm4_t3, it_body);
-                                        break;
-                                    }
-                                    default: {
-                                        auto const* payload = &it_body[0];
-                                        for (unsigned i = 0; i < pm4_hdr->count + 1; ++i) {
-                                            Text("%02X: %08X", i, payload[i]);
-                                        }
-                                    }
-                                    }
+                            auto const* it_body = reinterpret_cast<uint32_t const*>(pm4_hdr + 1);
 
-                                    EndTable();
+                            switch (op) {
+                            case AmdGpu::PM4ItOpcode::Nop: {
+                                OnNop(pm4_t3, it_body);
+                                break;
+                            }
+                            case AmdGpu::PM4ItOpcode::SetBase: {
+                                OnSetBase(pm4_t3, it_body);
+                                break;
+                            }
+                            case AmdGpu::PM4ItOpcode::SetContextReg: {
+                                OnSetContextReg(pm4_t3, it_body);
+                                break;
+                            }
+                            case AmdGpu::PM4ItOpcode::SetShReg: {
+                                OnSetShReg(pm4_t3, it_body);
+                                break;
+                            }
+                            case AmdGpu::PM4ItOpcode::DispatchDirect: {
+                                OnDispatch(pm4_t3, it_body);
+                                break;
+                            }
+                            default: {
+                                auto const* payload = &it_body[0];
+                                for (unsigned i = 0; i < pm4_hdr->count + 1; ++i) {
+                                    Text("%02X: %08X", i, payload[i]);
                                 }
-                                TreePop();
+                            }
                             }
 
-                        } else {
-                            Text("<UNK PACKET>");
+                            EndTable();
                         }
+                        TreePop();
+                    };
 
-                        auto const* next_pm4_hdr = GetNext(pm4_hdr, 1);
-                        auto const processed_len = reinterpret_cast<uintptr_t>(next_pm4_hdr) -
-                                                   reinterpret_cast<uintptr_t>(pm4_hdr);
-                        pm4_hdr = next_pm4_hdr;
-                        processed_size += processed_len;
+                    // Collapsed packets all have one row, only the visible ones are drawn. The
+                    // expanded ones in between are drawn in full since their height varies.
+                    auto [packet, end_packet] = GetPacketRange(batch);
+                    while (packet < end_packet) {
+                        const auto next_open = open_packets.lower_bound(packet);
+                        const size_t run_end = next_open != open_packets.end()
+                                                   ? std::min(*next_open, end_packet)
+                                                   : end_packet;
+                        if (run_end > packet) {
+                            ImGuiListClipper clipper;
+                            clipper.Begin(static_cast<int>(run_end - packet));
+                            while (clipper.Step()) {
+                                for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                                    draw_packet(packet + i);
+                                }
+                            }
+                            packet = run_end;
+                        } else {
+                            draw_packet(packet++);
+                        }
                     }
 
                     if (group_batches && !ignore_header) {
                         Unindent();
                     };
-                    bb = {{0.0f, bb.Max.y}, ctx.LastItemData.Rect.Max};
+                    bb = {{0.0f, bb.Max.y}, {FLT_MAX, GetCursorScreenPos().y}};
                     if (bb.Contains(ctx.IO.MousePos)) {
                         current_highlight_batch = batch.id;
                     }
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <set>
+#include <utility>
 #include <vector>
 #include <imgui.h>
 
@@ -60,6 +62,21 @@ class CmdListViewer {
 
     std::vector<RegView> extra_batch_view;
 
+    // Packets are decoded a slice per frame, so large captures open without stalling
+    std::vector<size_t> packet_offsets{}; ///< Of every decoded packet, in bytes
+    size_t decoded_size{};
+    size_t batch_start{};
+    u32 num_batches{};
+    std::string marker{};
+    bool is_decoded{};
+
+    std::set<size_t> open_packets{}; ///< Packets expanded in the tree, they are never clipped
+
+    void DecodePackets(size_t max_packets);
+
+    /// Returns the indices of the first packet of a batch and of the one after it.
+    [[nodiscard]] std::pair<size_t, size_t> GetPacketRange(const BatchInfo& batch) const;
+
     static void OnNop(AmdGpu::PM4Type3Header const* header, u32 const* body);
     static void OnSetBase(AmdGpu::PM4Type3Header const* header, u32 const* body);
     static void OnSetContextReg(AmdGpu::PM4Type3Header const* header, u32 const* body);
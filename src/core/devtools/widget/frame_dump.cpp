@@ -7,11 +7,17 @@
 #include <imgui.h>
 #include <magic_enum/magic_enum.hpp>
 
+#include "common/elf_info.h"
 #include "common/io_file.h"
+#include "common/path_util.h"
+#include "core/devtools/frame_capture.h"
 #include "core/devtools/options.h"
 #include "frame_dump.h"
 #include "imgui_internal.h"
 #include "imgui_memory_editor.h"
+#include "video_core/renderer_vulkan/vk_presenter.h"
+
+extern std::unique_ptr<Vulkan::Presenter> presenter;
 
 using namespace ImGui;
 using namespace DebugStateType;
@@ -135,6 +141,22 @@ void FrameDumpViewer::Draw() {
         }
         EndDisabled();
         SameLine();
+        // Guest memory is read as it is now, which only matches the frame while the guest is still
+        // paused after the dump
+        BeginDisabled(!DebugState.IsGuestThreadsPaused());
+        if (SmallButton("Save capture")) {
+            const auto path = Common::FS::GetUserPath(Common::FS::PathType::CapturesDir) /
+                              fmt::format("{}_frame{}.shadcap",
+                                          Common::ElfInfo::Instance().GameSerial(),
+                                          frame_dump->frame_id);
+            if (SaveFrameCapture(*frame_dump, presenter->GetRasterizer(), path)) {
+                DebugState.ShowDebugMessage(fmt::format("Saved capture as {}", path.string()));
+            } else {
+                DebugState.ShowDebugMessage(fmt::format("Failed to save {}", path.string()));
+            }
+        }
+        EndDisabled();
+        SameLine();
         if (BeginMenu("Filter")) {
 
             TextUnformatted("Shader name");
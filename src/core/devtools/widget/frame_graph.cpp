@@ -3,20 +3,41 @@
 
 #include "frame_graph.h"
 
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
 #include "common/config.h"
+#include "common/io_file.h"
+#include "common/logging/log.h"
+#include "common/path_util.h"
 #include "common/singleton.h"
 #include "core/debug_state.h"
+#include "core/libraries/ajm/ajm.h"
+#include "core/libraries/audio/audioout.h"
+#include "core/libraries/kernel/threads/pthread.h"
+#include "core/signals.h"
 #include "imgui.h"
 #include "imgui_internal.h"
 
 using namespace ImGui;
 
+namespace Core::Devtools::Gcn {
+const char* GetOpCodeName(u32 op);
+}
+
 namespace Core::Devtools::Widget {
 
 constexpr float BAR_WIDTH_MULT = 1.4f;
 constexpr float BAR_HEIGHT_MULT = 1.25f;
 constexpr float FRAME_GRAPH_PADDING_Y = 3.0f;
 constexpr static float FRAME_GRAPH_HEIGHT = 50.0f;
+constexpr static size_t PM4_STATS_MAX_ROWS = 16;
+constexpr static float GPU_TIMELINE_ROW_HEIGHT = 14.0f;
+constexpr static u32 GPU_TIMELINE_MAX_DEPTH = 6;
+constexpr static size_t GPU_TIMINGS_MAX_ROWS = 16;
 
 void FrameGraph::DrawFrameGraph() {
     // Frame graph - inspired by
@@ -69,6 +90,312 @@ void FrameGraph::DrawFrameGraph() {
     draw_list.PopClipRect();
 }
 
+void FrameGraph::DrawPM4Stats() {
+    struct Row {
+        const char* queue;
+        u32 opcode;
+        AmdGpu::PM4OpcodeStats stats;
+    };
+    std::vector<Row> rows;
+    u64 frame;
+    double us_per_cycle;
+    {
+        std::scoped_lock lock{DebugState.pm4_stats_mutex};
+        const auto& frame_stats = DebugState.pm4_frame_stats;
+        for (size_t queue = 0; queue < frame_stats.queues.size(); ++queue) {
+            const auto* queue_name =
+                AmdGpu::GetQueueTypeName(static_cast<AmdGpu::PM4QueueType>(queue));
+            for (u32 op = 0; op < AmdGpu::PM4FrameStats::NumOpcodes; ++op) {
+                if (frame_stats.queues[queue][op].count != 0) {
+                    rows.push_back({queue_name, op, frame_stats.queues[queue][op]});
+                }
+            }
+        }
+        frame = frame_stats.frame;
+        us_per_cycle = frame_stats.ToUs(1);
+    }
+    std::ranges::sort(rows, std::greater{}, [](const Row& row) { return row.stats.cycles; });
+    rows.resize(std::min(rows.size(), PM4_STATS_MAX_ROWS));
+
+    SeparatorText("PM4 opcodes");
+    Text("Gnm frame %llu, by parser time", static_cast<unsigned long long>(frame));
+    if (BeginTable("PM4Stats", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        TableSetupColumn("Queue");
+        TableSetupColumn("Opcode");
+        TableSetupColumn("Count");
+        TableSetupColumn("Time (us)");
+        TableHeadersRow();
+        for (const auto& row : rows) {
+            TableNextRow();
+            TableNextColumn();
+            TextUnformatted(row.queue);
+            TableNextColumn();
+            TextUnformatted(Gcn::GetOpCodeName(row.opcode));
+            TableNextColumn();
+            Text("%llu", static_cast<unsigned long long>(row.stats.count));
+            TableNextColumn();
+            Text("%.1f", row.stats.cycles * us_per_cycle);
+        }
+        EndTable();
+    }
+}
+
+void FrameGraph::DrawBufferCacheStats() {
+    VideoCore::BufferCacheStats stats;
+    {
+        std::scoped_lock lock{DebugState.buffer_cache_stats_mutex};
+        stats = DebugState.buffer_cache_stats;
+    }
+    const auto mib = [](u64 bytes) { return bytes / (1024.0 * 1024.0); };
+
+    SeparatorText("Buffer cache");
+    Text("Gnm frame %llu", static_cast<unsigned long long>(stats.frame));
+    Text("Buffers: %llu (%.1f MiB)", static_cast<unsigned long long>(stats.num_buffers),
+         mib(stats.total_bytes));
+    Text("Created: %llu, deleted: %llu", static_cast<unsigned long long>(stats.buffers_created),
+         static_cast<unsigned long long>(stats.buffers_deleted));
+    Text("Overlaps joined: %llu, stream leaps: %llu, max stream score: %llu",
+         static_cast<unsigned long long>(stats.overlaps_joined),
+         static_cast<unsigned long long>(stats.stream_leaps),
+         static_cast<unsigned long long>(stats.max_stream_score));
+    Text("CPU to GPU: %.2f MiB in %llu copies", mib(stats.upload_bytes),
+         static_cast<unsigned long long>(stats.upload_copies));
+    Text("GPU to CPU: %.2f MiB", mib(stats.download_bytes));
+    Text("Texel buffers synced from images: %llu",
+         static_cast<unsigned long long>(stats.image_syncs));
+}
+
+static void ExportGpuTimings(const Vulkan::GpuFrameTimings& timings) {
+    // Chrome trace event format, opens in chrome://tracing and Perfetto
+    using namespace Common::FS;
+    const auto path =
+        GetUserPath(PathType::LogDir) / fmt::format("gpu_timings_{}.json", timings.frame);
+    IOFile file{path, FileAccessMode::Write, FileType::TextFile};
+    if (!file.IsOpen()) {
+        LOG_ERROR(Render_Vulkan, "Failed to open {} for writing", path.string());
+        return;
+    }
+    file.WriteString(std::string_view{"{\"traceEvents\":[\n"});
+    for (size_t i = 0; i < timings.scopes.size(); ++i) {
+        const auto& scope = timings.scopes[i];
+        std::string name;
+        for (const char c : scope.name) {
+            if (c == '"' || c == '\\') {
+                name.push_back('\\');
+            }
+            name.push_back(c);
+        }
+        file.WriteString(fmt::format(
+            "{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":{:.3f},\"dur\":{:.3f}}}{}\n",
+            name, scope.begin_ms * 1000.0, scope.duration_ms * 1000.0,
+            i + 1 == timings.scopes.size() ? "" : ","));
+    }
+    file.WriteString(std::string_view{"]}\n"});
+    LOG_INFO(Render_Vulkan, "Exported GPU timings of frame {} to {}", timings.frame, path.string());
+}
+
+void FrameGraph::DrawGpuTimings() {
+    Vulkan::GpuFrameTimings timings;
+    {
+        std::scoped_lock lock{DebugState.gpu_timings_mutex};
+        timings = DebugState.gpu_timings;
+    }
+
+    SeparatorText("GPU timeline");
+    if (timings.scopes.empty()) {
+        TextUnformatted("No GPU timings read back yet");
+        return;
+    }
+    double frame_ms = 0.0;
+    for (const auto& scope : timings.scopes) {
+        frame_ms = std::max(frame_ms, scope.begin_ms + scope.duration_ms);
+    }
+    Text("Flip frame %llu: %.3f ms in %zu scopes", static_cast<unsigned long long>(timings.frame),
+         frame_ms, timings.scopes.size());
+    SameLine();
+    if (SmallButton("Export")) {
+        ExportGpuTimings(timings);
+    }
+
+    // Share of the frame spent in geometry shader draws, the stage hosts differ the most in
+    size_t num_gs_draws = 0;
+    double gs_ms = 0.0;
+    for (const auto& scope : timings.scopes) {
+        if (scope.name.starts_with("GeometryDraw:")) {
+            ++num_gs_draws;
+            gs_ms += scope.duration_ms;
+        }
+    }
+    if (num_gs_draws != 0) {
+        Text("Geometry shader draws: %zu, %.3f ms (%.1f%% of the GPU time)", num_gs_draws, gs_ms,
+             100.0 * gs_ms / std::max(timings.GetBusyMs(), 1e-6));
+    }
+
+    // One row per nesting depth, scaled to the frame
+    const float full_width = GetContentRegionAvail().x;
+    const auto pos = GetCursorScreenPos();
+    const ImVec2 size{full_width, GPU_TIMELINE_ROW_HEIGHT * GPU_TIMELINE_MAX_DEPTH};
+    ItemSize(size);
+    if (ItemAdd({pos, pos + size}, GetID("GpuTimeline"))) {
+        auto& draw_list = *GetWindowDrawList();
+        draw_list.AddRectFilled(pos, pos + size, IM_COL32(0x33, 0x33, 0x33, 0xFF));
+        const float scale = full_width / static_cast<float>(frame_ms);
+        const auto mouse = GetIO().MousePos;
+        for (const auto& scope : timings.scopes) {
+            if (scope.depth >= GPU_TIMELINE_MAX_DEPTH) {
+                continue;
+            }
+            const ImVec2 min{pos.x + static_cast<float>(scope.begin_ms) * scale,
+                             pos.y + scope.depth * GPU_TIMELINE_ROW_HEIGHT};
+            const ImVec2 max{std::max(min.x + static_cast<float>(scope.duration_ms) * scale,
+                                      min.x + 1.0f),
+                             min.y + GPU_TIMELINE_ROW_HEIGHT - 1.0f};
+            const u32 hue = static_cast<u32>(std::hash<std::string>{}(scope.name));
+            draw_list.AddRectFilled(min, max,
+                                    IM_COL32(0x40 + (hue & 0x7F), 0x40 + ((hue >> 8) & 0x7F),
+                                             0x40 + ((hue >> 16) & 0x7F), 0xFF));
+            if (IsItemHovered() && mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y &&
+                mouse.y < max.y) {
+                SetTooltip("%s\n%.3f ms at %.3f ms", scope.name.c_str(), scope.duration_ms,
+                           scope.begin_ms);
+            }
+        }
+    }
+
+    // Slowest scopes of the innermost level, where the time is spent
+    std::vector<const Vulkan::GpuScopeTiming*> rows;
+    for (size_t i = 0; i < timings.scopes.size(); ++i) {
+        const auto& scope = timings.scopes[i];
+        const bool has_children =
+            i + 1 < timings.scopes.size() && timings.scopes[i + 1].depth > scope.depth;
+        if (!has_children) {
+            rows.push_back(&scope);
+        }
+    }
+    std::ranges::sort(rows, std::greater{}, &Vulkan::GpuScopeTiming::duration_ms);
+    rows.resize(std::min(rows.size(), GPU_TIMINGS_MAX_ROWS));
+    if (BeginTable("GpuTimings", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        TableSetupColumn("Scope");
+        TableSetupColumn("Start (ms)");
+        TableSetupColumn("Time (ms)");
+        TableHeadersRow();
+        for (const auto* scope : rows) {
+            TableNextRow();
+            TableNextColumn();
+            TextUnformatted(scope->name.c_str());
+            TableNextColumn();
+            Text("%.3f", scope->begin_ms);
+            TableNextColumn();
+            Text("%.3f", scope->duration_ms);
+        }
+        EndTable();
+    }
+}
+
+static void ExportAudioStats(const std::vector<Libraries::AudioOut::PortStatsInfo>& ports,
+                             const std::vector<Libraries::Ajm::AjmInstanceStats>& instances) {
+    using namespace Common::FS;
+    static u32 export_index = 0;
+    const auto path =
+        GetUserPath(PathType::LogDir) / fmt::format("audio_stats_{}.json", export_index++);
+    IOFile file{path, FileAccessMode::Write, FileType::TextFile};
+    if (!file.IsOpen()) {
+        LOG_ERROR(Lib_AudioOut, "Failed to open {} for writing", path.string());
+        return;
+    }
+    file.WriteString(std::string_view{"{\"ports\":[\n"});
+    for (size_t i = 0; i < ports.size(); ++i) {
+        const auto& port = ports[i];
+        file.WriteString(fmt::format(
+            "{{\"handle\":{},\"type\":{},\"buffer_frames\":{},\"sample_rate\":{},"
+            "\"submits\":{},\"submit_jitter\":[{}],\"missed_periods\":{},\"drift_us\":{},"
+            "\"queued_us\":{},\"underruns\":{}}}{}\n",
+            port.handle, static_cast<u32>(port.type), port.buffer_frames, port.sample_rate,
+            port.stats.num_submits, fmt::join(port.stats.submit_jitter, ","),
+            port.stats.missed_periods, port.drift_us, port.queued_us, port.underruns,
+            i + 1 == ports.size() ? "" : ","));
+    }
+    file.WriteString(std::string_view{"],\"ajm_instances\":[\n"});
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const auto& instance = instances[i];
+        file.WriteString(fmt::format(
+            "{{\"id\":{},\"jobs\":{},\"decode_ns\":{},\"max_decode_ns\":{},"
+            "\"max_wait_ns\":{},\"queued_batches\":{}}}{}\n",
+            instance.instance_id, instance.num_jobs, instance.decode_ns, instance.max_decode_ns,
+            instance.max_wait_ns, instance.queued_batches, i + 1 == instances.size() ? "" : ","));
+    }
+    file.WriteString(std::string_view{"]}\n"});
+    LOG_INFO(Lib_AudioOut, "Exported audio stats to {}", path.string());
+}
+
+void FrameGraph::DrawAudioStats() {
+    const auto ports = Libraries::AudioOut::GetPortStats();
+    const auto instances = Libraries::Ajm::GetInstanceStats();
+
+    SeparatorText("Audio");
+    Text("%zu ports, %zu AJM instances", ports.size(), instances.size());
+    SameLine();
+    if (SmallButton("Export##Audio")) {
+        ExportAudioStats(ports, instances);
+    }
+    if (!ports.empty() &&
+        BeginTable("AudioPorts", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        TableSetupColumn("Port");
+        TableSetupColumn("Submits");
+        TableSetupColumn("Jitter <0.25/1/2/5/10/more ms");
+        TableSetupColumn("Missed");
+        TableSetupColumn("Drift (ms)");
+        TableSetupColumn("Queued (ms)");
+        TableSetupColumn("Underruns");
+        TableHeadersRow();
+        for (const auto& port : ports) {
+            const auto& jitter = port.stats.submit_jitter;
+            TableNextRow();
+            TableNextColumn();
+            Text("%d (type %u, %u@%u)", port.handle, static_cast<u32>(port.type),
+                 port.buffer_frames, port.sample_rate);
+            TableNextColumn();
+            Text("%llu", static_cast<unsigned long long>(port.stats.num_submits));
+            TableNextColumn();
+            Text("%u/%u/%u/%u/%u/%u", jitter[0], jitter[1], jitter[2], jitter[3], jitter[4],
+                 jitter[5]);
+            TableNextColumn();
+            Text("%u", port.stats.missed_periods);
+            TableNextColumn();
+            Text("%.2f", port.drift_us / 1000.0);
+            TableNextColumn();
+            Text("%.1f", port.queued_us / 1000.0);
+            TableNextColumn();
+            Text("%u", port.underruns);
+        }
+        EndTable();
+    }
+    if (!instances.empty() &&
+        BeginTable("AjmInstances", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        TableSetupColumn("AJM instance");
+        TableSetupColumn("Jobs");
+        TableSetupColumn("Decode avg/max (us)");
+        TableSetupColumn("Max wait (us)");
+        TableSetupColumn("Queued batches");
+        TableHeadersRow();
+        for (const auto& instance : instances) {
+            const u64 avg_ns = instance.num_jobs ? instance.decode_ns / instance.num_jobs : 0;
+            TableNextRow();
+            TableNextColumn();
+            Text("%u", instance.instance_id);
+            TableNextColumn();
+            Text("%llu", static_cast<unsigned long long>(instance.num_jobs));
+            TableNextColumn();
+            Text("%.1f/%.1f", avg_ns / 1000.0, instance.max_decode_ns / 1000.0);
+            TableNextColumn();
+            Text("%.1f", instance.max_wait_ns / 1000.0);
+            TableNextColumn();
+            Text("%u", instance.queued_batches);
+        }
+        EndTable();
+    }
+}
+
 void FrameGraph::Draw() {
     if (!is_open) {
         return;
@@ -101,6 +428,103 @@ void FrameGraph::Draw() {
         Text("Output Res: %dx%d", DebugState.output_resolution.first,
              DebugState.output_resolution.second);
         Text("FSR: %s", DebugState.is_using_fsr ? "on" : "off");
+        if (const u64 lookups = DebugState.ib_cache_lookups.load(); lookups != 0) {
+            const u64 hits = DebugState.ib_cache_hits.load();
+            Text("IB cache: %.1f%% hits (%llu lookups)", 100.0 * hits / lookups,
+                 static_cast<unsigned long long>(lookups));
+        }
+        Text("Task frames: %u allocated, %u recycled", DebugState.task_frames_allocated.load(),
+             DebugState.task_frames_recycled.load());
+        Text("Page protections: %u syscalls for %u ranges", DebugState.page_protect_syscalls.load(),
+             DebugState.page_protect_requests.load());
+        for (const auto& handler : Core::Signals::Instance()->GetAccessViolationStats()) {
+            Text("Faults taken by %.*s: %llu (%.3f ms)", static_cast<int>(handler.name.size()),
+                 handler.name.data(), static_cast<unsigned long long>(handler.num_handled),
+                 handler.handled_ns / 1'000'000.0);
+        }
+        for (const auto& mutex : Libraries::Kernel::GetMutexContentionStats(5)) {
+            Text("Mutex %s: %llu contended locks (%.3f ms)", mutex.name.c_str(),
+                 static_cast<unsigned long long>(mutex.num_contended),
+                 mutex.contended_ns / 1'000'000.0);
+        }
+        Text("Fault buffer: %u passes, %u pages in %u ranges, %u buffers",
+             DebugState.fault_buffer_passes.load(), DebugState.fault_buffer_pages.load(),
+             DebugState.fault_buffer_ranges.load(), DebugState.fault_buffer_buffers.load());
+        Text("Image uploads: %u images, %u barriers", DebugState.image_uploads.load(),
+             DebugState.image_upload_barriers.load());
+        Text("Page tables: %llu KiB resident%s",
+             static_cast<unsigned long long>(DebugState.page_table_resident_bytes.load() / 1024),
+             Config::isHugePagePageTablesEnabled() ? " (huge pages)" : "");
+        Text("Vblank: %.3f ms, flip jitter: %.3f ms, uneven flips: %u",
+             DebugState.vblank_period_us.load() / 1000.0, DebugState.flip_jitter_us.load() / 1000.0,
+             DebugState.uneven_flips.load());
+        Text("Stream buffers: %u wraps, %u stalls, %u grows",
+             DebugState.stream_buffer_wraps.load(), DebugState.stream_buffer_stalls.load(),
+             DebugState.stream_buffer_grows.load());
+        Text("Image overlaps: %u views, %u copies", DebugState.image_overlap_views.load(),
+             DebugState.image_overlap_copies.load());
+        Text("Demoted images: %u (%.1f MiB), %u promoted", DebugState.demoted_images.load(),
+             DebugState.demoted_image_bytes.load() / (1024.0 * 1024.0),
+             DebugState.image_promotions.load());
+        Text("Fast clear eliminations: %u, %u folded, %u resolved",
+             DebugState.fast_clear_eliminations.load(), DebugState.fast_clears_folded.load(),
+             DebugState.fast_clears_resolved.load());
+        Text("MSAA resolves: %u in render pass, %u with transfers",
+             DebugState.resolves_in_render_pass.load(), DebugState.resolves_with_transfer.load());
+        Text("Samplers: %u live, %u evicted", DebugState.live_samplers.load(),
+             DebugState.sampler_evictions.load());
+        Text("Shader HLE: %u dispatches, %u signature mismatches",
+             DebugState.shader_hle_dispatches.load(), DebugState.shader_hle_mismatches.load());
+        {
+            // Fragmentation is the share of the device memory blocks no allocation uses
+            const auto unused = [](u64 used, u64 reserved) {
+                return reserved != 0 ? 100.0 * (reserved - std::min(used, reserved)) / reserved
+                                     : 0.0;
+            };
+            const u64 block_bytes = DebugState.vma_block_bytes.load();
+            const u64 pool_block_bytes = DebugState.vma_pool_block_bytes.load();
+            Text("Device memory: %u blocks allocated, %u freed",
+                 DebugState.device_memory_allocations.load(),
+                 DebugState.device_memory_frees.load());
+            Text("Allocations: %u in %.1f MiB, %.1f%% unused, pools %.1f MiB, %.1f%% unused",
+                 DebugState.vma_allocations.load(), block_bytes / (1024.0 * 1024.0),
+                 unused(DebugState.vma_allocation_bytes.load(), block_bytes),
+                 pool_block_bytes / (1024.0 * 1024.0),
+                 unused(DebugState.vma_pool_allocation_bytes.load(), pool_block_bytes));
+        }
+        if (Config::isLowLatencyPresentEnabled()) {
+            Text("Present wait: %.2f ms", DebugState.present_wait_us.load() / 1000.0);
+        }
+        if (Config::getOutputLatencyTarget() > 0 || Config::getMixAudioPorts()) {
+            Text("Audio latency: %.1f ms, %u underruns",
+                 DebugState.audio_latency_us.load() / 1000.0, DebugState.audio_underruns.load());
+        }
+        if (Config::getAvPlayerReadAheadMbytes() > 0) {
+            Text("Movie read-ahead: %.1f MiB, %u stalls",
+                 DebugState.avplayer_read_ahead_bytes.load() / (1024.0 * 1024.0),
+                 DebugState.avplayer_read_stalls.load());
+        }
+        if (const u64 inflated = DebugState.zlib_inflated_bytes.load(); inflated != 0) {
+            Text("Zlib: %.1f MiB inflated at %.1f MB/s per thread", inflated / (1024.0 * 1024.0),
+                 inflated * 1000.0 / std::max<u64>(DebugState.zlib_inflate_ns.load(), 1));
+        }
+        const auto& overshoots = DebugState.sleep_overshoots;
+        Text("Sleeps late by <50us: %u, <200us: %u, <1ms: %u, <4ms: %u, <16ms: %u, more: %u",
+             overshoots[0].load(), overshoots[1].load(), overshoots[2].load(),
+             overshoots[3].load(), overshoots[4].load(), overshoots[5].load());
+
+        if (Config::isBufferCacheStatsEnabled()) {
+            DrawBufferCacheStats();
+        }
+        if (Config::isPM4ProfilingEnabled()) {
+            DrawPM4Stats();
+        }
+        if (Config::getVkGpuTimestampsEnabled()) {
+            DrawGpuTimings();
+        }
+        if (Config::isAudioStatsEnabled()) {
+            DrawAudioStats();
+        }
     }
     End();
 }
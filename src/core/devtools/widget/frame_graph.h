@@ -20,6 +20,10 @@ class FrameGraph {
     float frameRate{};
 
     void DrawFrameGraph();
+    void DrawPM4Stats();
+    void DrawBufferCacheStats();
+    void DrawGpuTimings();
+    void DrawAudioStats();
 
 public:
     bool is_open = true;
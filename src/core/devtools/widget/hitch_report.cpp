@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <imgui.h>
+
+#include "core/debug_state.h"
+#include "hitch_report.h"
+#include "video_core/stall_tracker.h"
+
+using namespace ImGui;
+
+namespace Core::Devtools::Widget {
+
+void HitchReportViewer::Draw() {
+    SetNextWindowSize({560.0f, 420.0f}, ImGuiCond_FirstUseEver);
+    if (!Begin("Hitch report", &open)) {
+        End();
+        return;
+    }
+
+    const auto [num_hitches, num_frames] = VideoCore::GetHitchCounts();
+    Text("%llu hitches in %llu frames", static_cast<unsigned long long>(num_hitches),
+         static_cast<unsigned long long>(num_frames));
+    SameLine();
+    if (Button("Save")) {
+        if (VideoCore::SaveHitchReport()) {
+            DebugState.ShowDebugMessage("Saved the hitch report to the log directory");
+        } else {
+            DebugState.ShowDebugMessage("Failed to save the hitch report");
+        }
+    }
+
+    if (CollapsingHeader("Worst offenders", ImGuiTreeNodeFlags_DefaultOpen) &&
+        BeginTable("HitchOffenders", 5,
+                   ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg |
+                       ImGuiTableFlags_ScrollY,
+                   {0.0f, 180.0f})) {
+        TableSetupScrollFreeze(0, 1);
+        TableSetupColumn("Cause");
+        TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
+        TableSetupColumn("Count");
+        TableSetupColumn("Total ms");
+        TableSetupColumn("Max ms");
+        TableHeadersRow();
+        for (const auto& offender : VideoCore::GetStallOffenders()) {
+            TableNextRow();
+            TableNextColumn();
+            TextUnformatted(VideoCore::GetStallCauseName(offender.stall.cause));
+            TableNextColumn();
+            TextUnformatted(VideoCore::GetStallName(offender.stall).c_str());
+            TableNextColumn();
+            Text("%llu", static_cast<unsigned long long>(offender.count));
+            TableNextColumn();
+            Text("%.2f", offender.total_us / 1000.0);
+            TableNextColumn();
+            Text("%.2f", offender.max_us / 1000.0);
+        }
+        EndTable();
+    }
+
+    if (CollapsingHeader("Recent hitches", ImGuiTreeNodeFlags_DefaultOpen)) {
+        for (const auto& hitch : VideoCore::GetRecentHitches()) {
+            const bool node_open =
+                TreeNodeEx(reinterpret_cast<void*>(static_cast<uintptr_t>(hitch.frame)),
+                           hitch.stalls.empty() ? ImGuiTreeNodeFlags_Leaf : 0,
+                           "Frame %u: %.2f ms, budget %.2f ms", hitch.frame,
+                           hitch.frame_us / 1000.0, hitch.budget_us / 1000.0);
+            if (!node_open) {
+                continue;
+            }
+            for (const auto& stall : hitch.stalls) {
+                BulletText("%s %s: %.2f ms", VideoCore::GetStallCauseName(stall.cause),
+                           VideoCore::GetStallName(stall).c_str(), stall.duration_us / 1000.0);
+            }
+            TreePop();
+        }
+    }
+
+    End();
+}
+
+} // namespace Core::Devtools::Widget
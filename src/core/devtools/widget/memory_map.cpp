@@ -1,18 +1,103 @@
 //  SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 //  SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <cfloat>
 #include <cinttypes>
+#include <vector>
 #include <imgui.h>
 #include <magic_enum/magic_enum.hpp>
 
+#include "common/perf_counters.h"
 #include "core/debug_state.h"
 #include "core/memory.h"
 #include "memory_map.h"
+#include "video_core/renderer_vulkan/vk_rasterizer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 using namespace ImGui;
 
 namespace Core::Devtools::Widget {
 
+static float ToMiB(u64 bytes) {
+    return static_cast<float>(bytes) / 1_MB;
+}
+
+/// Returns how many bytes of the range are resident in host memory.
+static u64 GetResidentSize(VAddr addr, u64 size) {
+    // Pages are queried in batches to bound the size of the query buffers
+    constexpr u64 PagesPerQuery = 4096;
+    u64 resident = 0;
+#ifdef _WIN32
+    constexpr u64 PageSize = 4_KB;
+    std::vector<PSAPI_WORKING_SET_EX_INFORMATION> pages(PagesPerQuery);
+#else
+    static const u64 PageSize = static_cast<u64>(sysconf(_SC_PAGESIZE));
+    std::vector<unsigned char> pages(PagesPerQuery);
+#endif
+    const VAddr end = addr + size;
+    for (VAddr page = addr & ~(PageSize - 1); page < end;) {
+        const u64 count = std::min(PagesPerQuery, (end - page + PageSize - 1) / PageSize);
+#ifdef _WIN32
+        for (u64 i = 0; i < count; ++i) {
+            pages[i].VirtualAddress = reinterpret_cast<void*>(page + i * PageSize);
+        }
+        if (QueryWorkingSetEx(GetCurrentProcess(), pages.data(),
+                              static_cast<DWORD>(count * sizeof(pages[0])))) {
+            for (u64 i = 0; i < count; ++i) {
+                resident += pages[i].VirtualAttributes.Valid ? PageSize : 0;
+            }
+        }
+#else
+#ifdef __APPLE__
+        auto* vec = reinterpret_cast<char*>(pages.data());
+#else
+        auto* vec = pages.data();
+#endif
+        // Fails on parts of the range with no host mapping, which are not resident
+        if (mincore(reinterpret_cast<void*>(page), count * PageSize, vec) == 0) {
+            for (u64 i = 0; i < count; ++i) {
+                resident += (pages[i] & 1) ? PageSize : 0;
+            }
+        }
+#endif
+        page += count * PageSize;
+    }
+    return std::min(resident, size);
+}
+
+/// Counts the used and free entries of a map, merging free entries that are contiguous.
+template <typename Map, typename Stats, typename IsFree>
+static void CountArea(const Map& map, Stats& stats, IsFree&& is_free) {
+    stats = {};
+    u64 free_run = 0;
+    u64 free_run_end = 0;
+    for (const auto& [base, area] : map) {
+        if (!is_free(area)) {
+            stats.used_size += area.size;
+            ++stats.num_used;
+            free_run = 0;
+            continue;
+        }
+        stats.free_size += area.size;
+        if (free_run != 0 && free_run_end == base) {
+            free_run += area.size;
+        } else {
+            free_run = area.size;
+            ++stats.num_free;
+        }
+        free_run_end = base + area.size;
+        stats.largest_free = std::max(stats.largest_free, free_run);
+    }
+}
+
 bool MemoryMapViewer::Iterator::DrawLine() {
     if (is_vma) {
         if (vma.it == vma.end) {
@@ -37,6 +122,15 @@ bool MemoryMapViewer::Iterator::DrawLine() {
         }
         TableNextColumn();
         Text("%s", m.name.c_str());
+        const auto usage = analysis->vmas.find(m.base);
+        TableNextColumn();
+        if (usage != analysis->vmas.end()) {
+            Text("%.0f%%", 100.0 * std::min(usage->second.resident, m.size) / m.size);
+        }
+        TableNextColumn();
+        if (usage != analysis->vmas.end()) {
+            Text("%.0f%%", 100.0 * std::min(usage->second.gpu_mapped, m.size) / m.size);
+        }
         ++vma.it;
         return true;
     }
@@ -61,6 +155,134 @@ bool MemoryMapViewer::Iterator::DrawLine() {
     return true;
 }
 
+void MemoryMapViewer::Analyze(MemoryManager& mem) {
+    CountArea(mem.vma_map, analysis.vmem, [](const auto& vma) { return vma.IsFree(); });
+    CountArea(mem.dmem_map, analysis.dmem,
+              [](const auto& dmem) { return dmem.dma_type == DMAType::Free; });
+    CountArea(mem.fmem_map, analysis.fmem, [](const auto& fmem) { return fmem.is_free; });
+
+    analysis.resident = 0;
+    analysis.gpu_mapped = 0;
+    analysis.vmas.clear();
+    for (const auto& [base, vma] : mem.vma_map) {
+        if (!vma.IsMapped()) {
+            continue;
+        }
+        VmaUsage usage{GetResidentSize(base, vma.size), 0};
+        if (mem.rasterizer) {
+            mem.rasterizer->ForEachMappedRangeInRange(base, vma.size, [&](const auto& range) {
+                usage.gpu_mapped += range.upper() - range.lower();
+            });
+        }
+        analysis.resident += usage.resident;
+        analysis.gpu_mapped += usage.gpu_mapped;
+        analysis.vmas.emplace(base, usage);
+    }
+    has_analysis = true;
+    last_analysis = std::chrono::steady_clock::now();
+}
+
+void MemoryMapViewer::SampleHistory(MemoryManager& mem) {
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_history_sample < std::chrono::seconds{1}) {
+        return;
+    }
+    // Rates come from the totals of the perf counters, so they also cover the time the window
+    // was closed
+    const auto totals = Common::GetPerfCounterTotals();
+    const u64 map_bytes = totals[static_cast<size_t>(Common::PerfCounter::MemoryMapBytes)];
+    const u64 unmap_bytes = totals[static_cast<size_t>(Common::PerfCounter::MemoryUnmapBytes)];
+    const bool first_sample = last_history_sample == std::chrono::steady_clock::time_point{};
+    const float elapsed_s = std::chrono::duration<float>(now - last_history_sample).count();
+
+    u64 mapped = 0;
+    for (const auto& [base, vma] : mem.vma_map) {
+        mapped += vma.IsMapped() ? vma.size : 0;
+    }
+    u64 dmem_used = 0;
+    for (const auto& [base, dmem] : mem.dmem_map) {
+        dmem_used += dmem.dma_type != DMAType::Free ? dmem.size : 0;
+    }
+
+    size_t index;
+    if (history.count < HistorySize) {
+        index = history.count++;
+    } else {
+        index = history.offset;
+        history.offset = (history.offset + 1) % HistorySize;
+    }
+    history.mapped_mb[index] = ToMiB(mapped);
+    history.dmem_mb[index] = ToMiB(dmem_used);
+    history.map_rate_mb[index] =
+        first_sample ? 0.0f : ToMiB(map_bytes - last_map_bytes) / elapsed_s;
+    history.unmap_rate_mb[index] =
+        first_sample ? 0.0f : ToMiB(unmap_bytes - last_unmap_bytes) / elapsed_s;
+    last_map_bytes = map_bytes;
+    last_unmap_bytes = unmap_bytes;
+    last_history_sample = now;
+}
+
+void MemoryMapViewer::DrawAnalysis(MemoryManager& mem) {
+    if (!CollapsingHeader("Analysis")) {
+        return;
+    }
+    // Residency queries every page of the mapped memory, so it only runs when asked for
+    const bool refresh_due =
+        auto_refresh && std::chrono::steady_clock::now() - last_analysis > std::chrono::seconds{1};
+    if (Button("Refresh") || refresh_due) {
+        Analyze(mem);
+    }
+    SameLine();
+    Checkbox("Auto refresh", &auto_refresh);
+
+    if (has_analysis) {
+        if (BeginTable("memory_analysis_table", 6,
+                       ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg |
+                           ImGuiTableFlags_SizingFixedFit)) {
+            TableSetupColumn("Map");
+            TableSetupColumn("Used (MiB)");
+            TableSetupColumn("Free (MiB)");
+            TableSetupColumn("Largest free (MiB)");
+            TableSetupColumn("Free blocks");
+            TableSetupColumn("Fragmentation");
+            TableHeadersRow();
+            const auto draw_row = [](const char* name, const AreaStats& stats) {
+                TableNextColumn();
+                TextUnformatted(name);
+                TableNextColumn();
+                Text("%.1f", ToMiB(stats.used_size));
+                TableNextColumn();
+                Text("%.1f", ToMiB(stats.free_size));
+                TableNextColumn();
+                Text("%.1f", ToMiB(stats.largest_free));
+                TableNextColumn();
+                Text("%u", stats.num_free);
+                TableNextColumn();
+                Text("%.1f%%", stats.Fragmentation() * 100.0);
+            };
+            draw_row("VMem", analysis.vmem);
+            draw_row("DMem", analysis.dmem);
+            draw_row("FMem", analysis.fmem);
+            EndTable();
+        }
+        Text("Host resident: %.1f MiB, GPU mapped: %.1f MiB", ToMiB(analysis.resident),
+             ToMiB(analysis.gpu_mapped));
+    }
+
+    SampleHistory(mem);
+    const ImVec2 graph_size{0.0f, 50.0f};
+    const auto count = static_cast<int>(history.count);
+    const auto offset = static_cast<int>(history.offset);
+    PlotLines("Mapped (MiB)", history.mapped_mb.data(), count, offset, nullptr, 0.0f, FLT_MAX,
+              graph_size);
+    PlotLines("DMem used (MiB)", history.dmem_mb.data(), count, offset, nullptr, 0.0f, FLT_MAX,
+              graph_size);
+    PlotLines("Map rate (MiB/s)", history.map_rate_mb.data(), count, offset, nullptr, 0.0f,
+              FLT_MAX, graph_size);
+    PlotLines("Unmap rate (MiB/s)", history.unmap_rate_mb.data(), count, offset, nullptr, 0.0f,
+              FLT_MAX, graph_size);
+}
+
 void MemoryMapViewer::Draw() {
     SetNextWindowSize({600.0f, 500.0f}, ImGuiCond_FirstUseEver);
     if (!Begin("Memory map", &open)) {
@@ -94,8 +316,15 @@ void MemoryMapViewer::Draw() {
         }
         showing_vma = next_showing_vma;
     }
+    if (!showing_vma) {
+        SameLine();
+        Text("Host pages: %s", mem->impl.HasHugePageBacking() ? "2MiB (transparent)" : "small");
+    }
+
+    DrawAnalysis(*mem);
 
     Iterator it{};
+    it.analysis = &analysis;
     if (showing_vma) {
         it.is_vma = true;
         it.vma.it = mem->vma_map.begin();
@@ -106,7 +335,7 @@ void MemoryMapViewer::Draw() {
         it.dmem.end = mem->dmem_map.end();
     }
 
-    if (BeginTable("memory_view_table", showing_vma ? 6 : 4,
+    if (BeginTable("memory_view_table", showing_vma ? 8 : 4,
                    ImGuiTableFlags_Resizable | ImGuiTableFlags_Reorderable | ImGuiTableFlags_RowBg |
                        ImGuiTableFlags_SizingFixedFit)) {
         if (showing_vma) {
@@ -116,6 +345,8 @@ void MemoryMapViewer::Draw() {
             TableSetupColumn("Prot");
             TableSetupColumn("Is Exec");
             TableSetupColumn("Name");
+            TableSetupColumn("Resident");
+            TableSetupColumn("GPU");
         } else {
             TableSetupColumn("Address");
             TableSetupColumn("Size");
@@ -3,11 +3,44 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <unordered_map>
+
 #include "core/memory.h"
 
 namespace Core::Devtools::Widget {
 
 class MemoryMapViewer {
+    /// Usage of one map, free entries are counted as blocks of contiguous free space.
+    struct AreaStats {
+        u64 used_size{};
+        u64 free_size{};
+        u64 largest_free{};
+        u32 num_used{};
+        u32 num_free{};
+
+        /// Part of the free space outside of the largest free block.
+        double Fragmentation() const {
+            return free_size == 0 ? 0.0 : 1.0 - static_cast<double>(largest_free) / free_size;
+        }
+    };
+
+    /// Bytes of a mapped VMA resident in host memory and mapped to the GPU.
+    struct VmaUsage {
+        u64 resident;
+        u64 gpu_mapped;
+    };
+
+    struct Analysis {
+        AreaStats vmem;
+        AreaStats dmem;
+        AreaStats fmem;
+        u64 resident{};
+        u64 gpu_mapped{};
+        std::unordered_map<VAddr, VmaUsage> vmas; ///< By base address
+    };
+
     struct Iterator {
         bool is_vma;
         struct {
@@ -18,11 +51,37 @@ class MemoryMapViewer {
             MemoryManager::VMAMap::iterator it;
             MemoryManager::VMAMap::iterator end;
         } vma;
+        const Analysis* analysis;
 
         bool DrawLine();
     };
 
+    /// Seconds of history kept for the graphs, one sample per second.
+    static constexpr size_t HistorySize = 120;
+
+    struct History {
+        std::array<float, HistorySize> mapped_mb{};
+        std::array<float, HistorySize> dmem_mb{};
+        std::array<float, HistorySize> map_rate_mb{};
+        std::array<float, HistorySize> unmap_rate_mb{};
+        size_t offset{};
+        size_t count{};
+    };
+
     bool showing_vma = true;
+    bool auto_refresh = false;
+    Analysis analysis{};
+    bool has_analysis = false;
+    std::chrono::steady_clock::time_point last_analysis{};
+
+    History history{};
+    std::chrono::steady_clock::time_point last_history_sample{};
+    u64 last_map_bytes{};
+    u64 last_unmap_bytes{};
+
+    void Analyze(MemoryManager& mem);
+    void SampleHistory(MemoryManager& mem);
+    void DrawAnalysis(MemoryManager& mem);
 
 public:
     bool open = false;
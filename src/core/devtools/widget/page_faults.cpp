@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <imgui.h>
+
+#include "page_faults.h"
+#include "video_core/renderer_vulkan/vk_presenter.h"
+#include "video_core/renderer_vulkan/vk_rasterizer.h"
+#include "video_core/texture_cache/texture_cache.h"
+
+extern std::unique_ptr<Vulkan::Presenter> presenter;
+
+using namespace ImGui;
+
+namespace Core::Devtools::Widget {
+
+constexpr size_t MaxHotPages = 64;
+constexpr size_t HostPageSize = 4_KB;
+
+void PageFaultViewer::Refresh() {
+    pages = VideoCore::PageManager::GetHotPages(MaxHotPages);
+    last_refresh = std::chrono::steady_clock::now();
+    {
+        std::scoped_lock lock{owners->mutex};
+        if (owners->pending || pages.empty() || !presenter) {
+            return;
+        }
+        owners->pending = true;
+    }
+    std::vector<VAddr> addrs;
+    addrs.reserve(pages.size());
+    for (const auto& page : pages) {
+        addrs.push_back(page.addr);
+    }
+    auto& rasterizer = presenter->GetRasterizer();
+    rasterizer.RunOnGpuThread([&rasterizer, addrs = std::move(addrs), owners = owners] {
+        std::unordered_map<VAddr, std::string> by_page;
+        const auto add_owner = [&](VAddr begin, u64 size, const std::string& name) {
+            for (const VAddr page : addrs) {
+                if (begin < page + HostPageSize && page < begin + size) {
+                    auto& names = by_page[page];
+                    names += names.empty() ? name : ", " + name;
+                }
+            }
+        };
+        rasterizer.GetBufferCache().ForEachBuffer(
+            [&](VideoCore::BufferId, VideoCore::Buffer& buffer) {
+                add_owner(buffer.CpuAddr(), buffer.SizeBytes(),
+                          fmt::format("buffer {:#x}+{:#x}", buffer.CpuAddr(), buffer.SizeBytes()));
+            });
+        rasterizer.GetTextureCache().ForEachImage([&](VideoCore::ImageId, VideoCore::Image& image) {
+            const auto& info = image.info;
+            if (info.guest_address == 0) {
+                return;
+            }
+            add_owner(info.guest_address, info.guest_size,
+                      fmt::format("image {:#x} {}x{} {}", info.guest_address, info.size.width,
+                                  info.size.height, vk::to_string(info.pixel_format)));
+        });
+        std::scoped_lock lock{owners->mutex};
+        owners->by_page = std::move(by_page);
+        owners->pending = false;
+    });
+}
+
+void PageFaultViewer::Draw() {
+    SetNextWindowSize({720.0f, 420.0f}, ImGuiCond_FirstUseEver);
+    if (!Begin("Page faults", &open)) {
+        End();
+        return;
+    }
+
+    bool profiling = VideoCore::PageManager::IsFaultProfiling();
+    if (Checkbox("Record faulting pages", &profiling)) {
+        VideoCore::PageManager::SetFaultProfiling(profiling);
+    }
+    SameLine();
+    if (Button("Reset")) {
+        VideoCore::PageManager::ResetFaultProfile();
+        pages.clear();
+    }
+    if (const u64 unrecorded = VideoCore::PageManager::GetUnrecordedFaults(); unrecorded != 0) {
+        SameLine();
+        Text("%llu faults of other pages not recorded",
+             static_cast<unsigned long long>(unrecorded));
+    }
+    TextWrapped("Pages written by the CPU while the GPU caches hold them fault every time the "
+                "caches track them again. Pages with many write faults are shared between CPU "
+                "writes and GPU reads.");
+
+    if (std::chrono::steady_clock::now() - last_refresh > std::chrono::seconds{1}) {
+        Refresh();
+    }
+
+    std::unordered_map<VAddr, std::string> by_page;
+    {
+        std::scoped_lock lock{owners->mutex};
+        by_page = owners->by_page;
+    }
+    if (BeginTable("HotPages", 6,
+                   ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg |
+                       ImGuiTableFlags_ScrollY)) {
+        TableSetupScrollFreeze(0, 1);
+        TableSetupColumn("Page");
+        TableSetupColumn("Faults");
+        TableSetupColumn("Writes");
+        TableSetupColumn("Total us");
+        TableSetupColumn("Avg us");
+        TableSetupColumn("Buffers and images", ImGuiTableColumnFlags_WidthStretch);
+        TableHeadersRow();
+        for (const auto& page : pages) {
+            TableNextRow();
+            TableNextColumn();
+            Text("%012llx", static_cast<unsigned long long>(page.addr));
+            TableNextColumn();
+            Text("%llu", static_cast<unsigned long long>(page.num_faults));
+            TableNextColumn();
+            Text("%llu", static_cast<unsigned long long>(page.num_write_faults));
+            TableNextColumn();
+            Text("%.1f", page.time_ns / 1000.0);
+            TableNextColumn();
+            Text("%.1f", page.time_ns / 1000.0 / std::max<u64>(page.num_faults, 1));
+            TableNextColumn();
+            const auto it = by_page.find(page.addr);
+            TextUnformatted(it != by_page.end() ? it->second.c_str() : "-");
+        }
+        EndTable();
+    }
+
+    End();
+}
+
+} // namespace Core::Devtools::Widget
@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "video_core/page_manager.h"
+
+namespace Core::Devtools::Widget {
+
+/// Pages of the write tracking that fault the most, with the buffers and images on them.
+class PageFaultViewer {
+    /// Filled on the GPU thread, which owns the caches.
+    struct Owners {
+        std::mutex mutex;
+        std::unordered_map<VAddr, std::string> by_page;
+        bool pending{};
+    };
+
+    std::vector<VideoCore::PageManager::HotPage> pages;
+    std::shared_ptr<Owners> owners = std::make_shared<Owners>();
+    std::chrono::steady_clock::time_point last_refresh{};
+
+    void Refresh();
+
+public:
+    bool open = false;
+
+    void Draw();
+};
+
+} // namespace Core::Devtools::Widget
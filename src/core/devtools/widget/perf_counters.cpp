@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <imgui.h>
+
+#include "core/debug_state.h"
+#include "perf_counters.h"
+
+using namespace ImGui;
+
+namespace Core::Devtools::Widget {
+
+static bool IsByteCounter(Common::PerfCounter counter) {
+    return counter == Common::PerfCounter::BufferUploadBytes ||
+           counter == Common::PerfCounter::TextureUploadBytes ||
+           counter == Common::PerfCounter::MemoryMapBytes ||
+           counter == Common::PerfCounter::MemoryUnmapBytes;
+}
+
+void PerfCountersViewer::UpdateAverages() {
+    last_frame = Common::GetLastFramePerfCounters();
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_sample < std::chrono::seconds{1}) {
+        return;
+    }
+    const auto totals = Common::GetPerfCounterTotals();
+    const u32 frame_num = DebugState.GetFrameNum();
+    const u32 num_frames = std::max(frame_num - last_frame_num, 1U);
+    for (size_t i = 0; i < totals.size(); ++i) {
+        frame_averages[i] = static_cast<double>(totals[i] - last_totals[i]) / num_frames;
+    }
+    last_totals = totals;
+    last_frame_num = frame_num;
+    last_sample = now;
+}
+
+void PerfCountersViewer::Draw() {
+    SetNextWindowSize({380.0f, 330.0f}, ImGuiCond_FirstUseEver);
+    if (!Begin("Perf counters", &open)) {
+        End();
+        return;
+    }
+
+    UpdateAverages();
+    if (BeginTable("PerfCounterTable", 3,
+                   ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg)) {
+        TableSetupColumn("Counter", ImGuiTableColumnFlags_WidthStretch);
+        TableSetupColumn("Last frame");
+        TableSetupColumn("Avg per frame");
+        TableHeadersRow();
+        for (size_t i = 0; i < last_frame.size(); ++i) {
+            const auto counter = static_cast<Common::PerfCounter>(i);
+            TableNextRow();
+            TableNextColumn();
+            TextUnformatted(Common::GetPerfCounterName(counter));
+            TableNextColumn();
+            if (counter == Common::PerfCounter::PageFaultNs) {
+                Text("%.1f us", last_frame[i] / 1000.0);
+                TableNextColumn();
+                Text("%.1f us", frame_averages[i] / 1000.0);
+            } else if (IsByteCounter(counter)) {
+                Text("%.1f KB", last_frame[i] / 1024.0);
+                TableNextColumn();
+                Text("%.1f KB", frame_averages[i] / 1024.0);
+            } else {
+                Text("%llu", static_cast<unsigned long long>(last_frame[i]));
+                TableNextColumn();
+                Text("%.1f", frame_averages[i]);
+            }
+        }
+        EndTable();
+    }
+
+    End();
+}
+
+} // namespace Core::Devtools::Widget
@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+
+#include "common/perf_counters.h"
+
+namespace Core::Devtools::Widget {
+
+/// Emulator work of the last frame, with the averages per frame over the last second.
+class PerfCountersViewer {
+public:
+    bool open = false;
+
+    void Draw();
+
+private:
+    void UpdateAverages();
+
+    Common::PerfCounterArray last_frame{};
+    Common::PerfCounterArray last_totals{};
+    std::array<double, static_cast<size_t>(Common::PerfCounter::Count)> frame_averages{};
+    u32 last_frame_num{};
+    std::chrono::steady_clock::time_point last_sample{};
+};
+
+} // namespace Core::Devtools::Widget
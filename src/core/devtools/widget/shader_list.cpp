@@ -1,7 +1,10 @@
 //  SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 //  SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
+#include <numeric>
 
 #include "shader_list.h"
 
@@ -64,6 +67,41 @@ void ShaderList::Selection::ReloadShader(DebugStateType::ShaderDump& value) {
     }
 }
 
+static void DrawCompileStats(const Shader::CompileStats& stats) {
+    Text("GCN instructions: %u, SPIR-V size: %u bytes", stats.num_gcn_insts, stats.spirv_size);
+    if (stats.num_fp64_insts != 0) {
+        Text("Double precision instructions: %u", stats.num_fp64_insts);
+    }
+    if (stats.num_tess_accesses != 0) {
+        Text("Tessellation ring accesses: %u, %u with dynamic indices", stats.num_tess_accesses,
+             stats.num_dynamic_tess_accesses);
+    }
+    Text("Total: %.3f ms (frontend %.3f ms, passes %.3f ms, emit %.3f ms)",
+         stats.TotalUs() / 1000.0, (stats.decode_us + stats.cfg_us + stats.structurize_us) / 1000.0,
+         stats.PassesUs() / 1000.0, stats.emit_us / 1000.0);
+    if (stats.passes.empty() ||
+        !BeginTable("##passes", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        return;
+    }
+    TableSetupColumn("Pass");
+    TableSetupColumn("Time (us)");
+    TableSetupColumn("Insts before");
+    TableSetupColumn("Insts after");
+    TableHeadersRow();
+    for (const auto& pass : stats.passes) {
+        TableNextRow();
+        TableNextColumn();
+        TextUnformatted(pass.name.data(), pass.name.data() + pass.name.size());
+        TableNextColumn();
+        Text("%llu", static_cast<unsigned long long>(pass.time_us));
+        TableNextColumn();
+        Text("%u", pass.insts_before);
+        TableNextColumn();
+        Text("%u", pass.insts_after);
+    }
+    EndTable();
+}
+
 bool ShaderList::Selection::DrawShader(DebugStateType::ShaderDump& value) {
     if (!value.loaded_data) {
         value.loaded_data = true;
@@ -217,6 +255,10 @@ bool ShaderList::Selection::DrawShader(DebugStateType::ShaderDump& value) {
         }
     }
 
+    if (CollapsingHeader("Compile statistics")) {
+        DrawCompileStats(value.stats);
+    }
+
     if (showing_bin) {
         isa_editor->Render(value.is_patched ? "SPIRV" : "ISA", GetContentRegionAvail());
     } else {
@@ -252,26 +294,37 @@ void ShaderList::Draw() {
 
     InputTextEx("##search_shader", "Search by name", search_box, sizeof(search_box), {},
                 ImGuiInputTextFlags_None);
+    SameLine();
+    Checkbox("Slowest first", &sort_by_compile_time);
+
+    const auto& shaders = DebugState.shader_dump_list;
+    std::vector<int> order(shaders.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (sort_by_compile_time) {
+        std::ranges::stable_sort(order, std::greater{},
+                                 [&](int i) { return shaders[i].stats.TotalUs(); });
+    }
 
     auto width = GetContentRegionAvail().x;
-    int i = 0;
-    for (const auto& shader : DebugState.shader_dump_list) {
+    for (const int i : order) {
+        const auto& shader = shaders[i];
         if (search_box[0] != '\0' && !shader.name.contains(search_box)) {
-            i++;
             continue;
         }
+        const double compile_ms = shader.stats.TotalUs() / 1000.0;
         char name[128];
         if (shader.is_patched) {
-            snprintf(name, sizeof(name), "%s (PATCH ON)", shader.name.c_str());
+            snprintf(name, sizeof(name), "%s [%.2f ms] (PATCH ON)", shader.name.c_str(),
+                     compile_ms);
         } else if (!shader.patch_spv.empty()) {
-            snprintf(name, sizeof(name), "%s (PATCH OFF)", shader.name.c_str());
+            snprintf(name, sizeof(name), "%s [%.2f ms] (PATCH OFF)", shader.name.c_str(),
+                     compile_ms);
         } else {
-            snprintf(name, sizeof(name), "%s", shader.name.c_str());
+            snprintf(name, sizeof(name), "%s [%.2f ms]", shader.name.c_str(), compile_ms);
         }
         if (ButtonEx(name, {width, 20.0f}, ImGuiButtonFlags_NoHoveredOnFocus)) {
             open_shaders.emplace_back(i);
         }
-        i++;
     }
 
     End();
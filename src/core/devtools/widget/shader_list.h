@@ -35,6 +35,7 @@ class ShaderList {
     std::vector<Selection> open_shaders{};
 
     char search_box[128]{};
+    bool sort_by_compile_time = false;
 
 public:
     bool open = false;
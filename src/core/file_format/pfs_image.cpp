@@ -0,0 +1,462 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <xxhash.h>
+#include <zlib.h>
+#include "common/io_file.h"
+#include "common/logging/log.h"
+#include "common/path_util.h"
+#include "core/file_format/pfs_image.h"
+
+namespace {
+
+constexpr u32 PfscMagic = 0x43534650; ///< "PFSC"
+constexpr s64 PfsMagic = 20130315;
+constexpr u64 InodeSize = 0xA8;
+
+/// Decoded blocks kept in memory, 32 MB with the usual 64 KB blocks
+constexpr size_t CacheBlocks = 512;
+
+/// Blocks decoded ahead of a sequential read
+constexpr u64 ReadaheadBlocks = 8;
+
+constexpr u32 MaxDirectoryDepth = 64;
+
+std::mutex open_images_mutex;
+std::vector<std::weak_ptr<PfsImage>> open_images;
+
+void LogOpenImageStats() {
+    std::scoped_lock lock{open_images_mutex};
+    for (const auto& weak_image : open_images) {
+        if (const auto image = weak_image.lock()) {
+            image->LogStats();
+        }
+    }
+}
+
+} // Anonymous namespace
+
+bool PfsImage::IsImage(const std::filesystem::path& path) {
+    const Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read};
+    std::array<s64, 2> start{};
+    if (!file.IsOpen() || !file.ReadObject(start)) {
+        return false;
+    }
+    return static_cast<u32>(start[0]) == PfscMagic || start[1] == PfsMagic;
+}
+
+std::shared_ptr<PfsImage> PfsImage::Open(const std::filesystem::path& path) {
+    auto image = std::make_shared<PfsImage>(path);
+    if (!image->ReadHeader() || !image->LoadTree()) {
+        return nullptr;
+    }
+    LOG_INFO(Core, "Opened {} PFS image {} with {} entries",
+             image->is_pfsc ? "compressed" : "plain", Common::FS::PathToUTF8String(path),
+             image->nodes.size());
+
+    static std::once_flag flag;
+    std::call_once(flag, [] { std::at_quick_exit(LogOpenImageStats); });
+    std::scoped_lock lock{open_images_mutex};
+    std::erase_if(open_images, [](const auto& weak_image) { return weak_image.expired(); });
+    open_images.push_back(image);
+    return image;
+}
+
+PfsImage::PfsImage(const std::filesystem::path& path_) : path{path_} {}
+
+PfsImage::~PfsImage() {
+    // The worker touches the cache and the counters, stop it before they go away.
+    readahead_worker.reset();
+    if (num_reads > 0) {
+        LogStats();
+    }
+}
+
+bool PfsImage::ReadHeader() {
+    const auto path_str = Common::FS::PathToUTF8String(path);
+    if (!file.Open(path)) {
+        LOG_ERROR(Core, "Failed to map PFS image {}", path_str);
+        return false;
+    }
+
+    const auto start = file.View(0, sizeof(PFSCHdr));
+    u32 magic{};
+    if (start.size() == sizeof(PFSCHdr)) {
+        std::memcpy(&magic, start.data(), sizeof(magic));
+    }
+    if (magic == PfscMagic) {
+        PFSCHdr pfsc;
+        std::memcpy(&pfsc, start.data(), sizeof(pfsc));
+        is_pfsc = true;
+        pfsc_block_size = static_cast<u64>(pfsc.block_sz2);
+        if (pfsc_block_size == 0 || pfsc.data_length <= 0) {
+            LOG_ERROR(Core, "Invalid PFSC header in {}", path_str);
+            return false;
+        }
+        const u64 num_sectors = (pfsc.data_length + pfsc_block_size - 1) / pfsc_block_size;
+        const auto table = file.View(pfsc.block_offsets, (num_sectors + 1) * sizeof(u64));
+        if (table.empty()) {
+            LOG_ERROR(Core, "PFSC block table of {} is out of bounds", path_str);
+            return false;
+        }
+        sector_map.resize(num_sectors + 1);
+        std::memcpy(sector_map.data(), table.data(), table.size());
+        block_size = pfsc_block_size;
+        num_blocks = num_sectors;
+        readahead_worker = std::make_unique<Common::ThreadWorker>(1, "PfsReadahead");
+    }
+
+    if (is_pfsc) {
+        const auto first = DecodeBlock(0);
+        if (!first || first->size() < sizeof(header)) {
+            LOG_ERROR(Core, "Failed to decode the first block of {}", path_str);
+            return false;
+        }
+        std::memcpy(&header, first->data(), sizeof(header));
+    } else {
+        const auto view = file.View(0, sizeof(header));
+        if (view.empty()) {
+            LOG_ERROR(Core, "{} is too small for a PFS image", path_str);
+            return false;
+        }
+        std::memcpy(&header, view.data(), sizeof(header));
+    }
+
+    if (header.magic != PfsMagic) {
+        LOG_ERROR(Core, "{} is not a PFS image", path_str);
+        return false;
+    }
+    if ((header.mode & PfsMode::Encrypted) != 0) {
+        LOG_ERROR(Core, "{} is encrypted, only decrypted PFS images can be mounted", path_str);
+        return false;
+    }
+    if (header.block_size <= 0 || (is_pfsc && static_cast<u64>(header.block_size) != block_size)) {
+        LOG_ERROR(Core, "Unsupported block size {:#x} in {}", header.block_size, path_str);
+        return false;
+    }
+    block_size = header.block_size;
+    if (!is_pfsc) {
+        num_blocks = file.Size() / block_size;
+    }
+    id = XXH3_64bits(&header, sizeof(header)) ^ file.Size();
+    return true;
+}
+
+bool PfsImage::ReadInode(u32 ino, Inode& inode) {
+    if (static_cast<s64>(ino) >= header.dinode_count) {
+        return false;
+    }
+    const u64 per_block = block_size / InodeSize;
+    const auto block = GetBlock(1 + ino / per_block);
+    if (!block) {
+        return false;
+    }
+    std::memcpy(&inode, block->data() + (ino % per_block) * InodeSize, sizeof(inode));
+    return true;
+}
+
+bool PfsImage::LoadTree() {
+    Inode super_root;
+    if (!ReadInode(static_cast<u32>(header.superroot_ino), super_root)) {
+        LOG_ERROR(Core, "Failed to read the super root of {}", Common::FS::PathToUTF8String(path));
+        return false;
+    }
+
+    // Games are below uroot, next to the flat path table. Images without it are used as is.
+    Inode root = super_root;
+    const bool valid = ForEachDirent(super_root, [&](const Dirent& dirent, std::string name) {
+        if (dirent.type == PFS_DIR && name == "uroot") {
+            return ReadInode(dirent.ino, root);
+        }
+        return true;
+    });
+    if (!valid) {
+        return false;
+    }
+    nodes.push_back({"", 0, root.loc, root.Time1_sec, true, {}});
+    path_index.emplace("", 0);
+    return LoadDirectory(0, root, "", 0);
+}
+
+bool PfsImage::ForEachDirent(const Inode& inode, const DirentCallback& callback) {
+    const u64 num_dirent_blocks = std::max<u64>(1, (inode.Size + block_size - 1) / block_size);
+    for (u64 i = 0; i < num_dirent_blocks; i++) {
+        const auto block = GetBlock(inode.loc + i);
+        if (!block) {
+            return false;
+        }
+        // Entries don't cross blocks, the rest of a block after its last entry is zeroed.
+        u64 offset = 0;
+        while (offset + offsetof(Dirent, name) <= block->size()) {
+            Dirent dirent;
+            std::memcpy(&dirent, block->data() + offset, offsetof(Dirent, name));
+            if (dirent.ino == 0 || dirent.entsize < static_cast<s32>(offsetof(Dirent, name))) {
+                break;
+            }
+            const u64 name_offset = offset + offsetof(Dirent, name);
+            offset += dirent.entsize;
+            if (dirent.type != PFS_FILE && dirent.type != PFS_DIR) {
+                continue;
+            }
+            const u64 name_len =
+                std::min<u64>(std::max(dirent.namelen, 0), block->size() - name_offset);
+            std::string name(reinterpret_cast<const char*>(block->data() + name_offset), name_len);
+            if (!callback(dirent, std::move(name))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool PfsImage::LoadDirectory(u32 node_index, const Inode& inode, const std::string& dir_path,
+                             u32 depth) {
+    if (depth > MaxDirectoryDepth) {
+        LOG_ERROR(Core, "Directories of {} are nested too deep",
+                  Common::FS::PathToUTF8String(path));
+        return false;
+    }
+    return ForEachDirent(inode, [&](const Dirent& dirent, std::string name) {
+        Inode child;
+        if (!ReadInode(dirent.ino, child)) {
+            LOG_ERROR(Core, "Invalid inode {} of {}", dirent.ino, name);
+            return false;
+        }
+        if ((child.Flags & InodeFlags::compressed) != 0) {
+            LOG_ERROR(Core, "Skipping {}, compressed files are not supported", name);
+            return true;
+        }
+
+        const u32 child_index = static_cast<u32>(nodes.size());
+        const bool is_dir = dirent.type == PFS_DIR;
+        const std::string child_path = dir_path.empty() ? name : dir_path + "/" + name;
+        nodes.push_back({std::move(name), static_cast<u64>(std::max<s64>(child.Size, 0)),
+                         child.loc, child.Time1_sec, is_dir, {}});
+        nodes[node_index].children.push_back(child_index);
+        path_index.emplace(child_path, child_index);
+        return !is_dir || LoadDirectory(child_index, child, child_path, depth + 1);
+    });
+}
+
+const PfsImage::Node* PfsImage::Find(std::string_view rel_path) const {
+    std::vector<std::string_view> components;
+    while (!rel_path.empty()) {
+        const size_t end = std::min(rel_path.find('/'), rel_path.size());
+        const auto component = rel_path.substr(0, end);
+        rel_path.remove_prefix(std::min(end + 1, rel_path.size()));
+        if (component.empty() || component == ".") {
+            continue;
+        }
+        if (component == "..") {
+            if (!components.empty()) {
+                components.pop_back();
+            }
+            continue;
+        }
+        components.push_back(component);
+    }
+    std::string key;
+    for (const auto component : components) {
+        if (!key.empty()) {
+            key += '/';
+        }
+        key += component;
+    }
+    const auto it = path_index.find(key);
+    return it == path_index.end() ? nullptr : &nodes[it->second];
+}
+
+s64 PfsImage::Read(const Node& node, void* buf, u64 size, u64 offset, bool sequential) {
+    if (node.is_dir) {
+        return -1;
+    }
+    if (offset >= node.size || size == 0) {
+        return 0;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    size = std::min(size, node.size - offset);
+    auto* out = static_cast<u8*>(buf);
+    const u64 image_offset = node.first_block * block_size + offset;
+
+    if (!is_pfsc) {
+        const auto view = file.View(image_offset, size);
+        if (view.empty()) {
+            return -1;
+        }
+        std::memcpy(out, view.data(), size);
+        if (sequential) {
+            const u64 end = std::min(node.first_block * block_size + node.size,
+                                     image_offset + size + ReadaheadBlocks * block_size);
+            file.Prefetch(image_offset + size, end - image_offset - size);
+        }
+    } else {
+        u64 done = 0;
+        while (done < size) {
+            const u64 pos = image_offset + done;
+            const u64 in_block = pos % block_size;
+            const u64 count = std::min(block_size - in_block, size - done);
+            const auto block = GetBlock(pos / block_size);
+            if (!block || in_block + count > block->size()) {
+                return -1;
+            }
+            std::memcpy(out + done, block->data() + in_block, count);
+            done += count;
+        }
+        if (sequential) {
+            const u64 next = (image_offset + size + block_size - 1) / block_size;
+            const u64 last = node.first_block + (node.size - 1) / block_size;
+            if (next <= last) {
+                QueueReadahead(next, std::min(last, next + ReadaheadBlocks - 1));
+            }
+        }
+    }
+
+    ++num_reads;
+    bytes_read += size;
+    read_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+    return static_cast<s64>(size);
+}
+
+bool PfsImage::Extract(const Node& node, const std::filesystem::path& host_path) {
+    std::error_code ec;
+    if (node.is_dir) {
+        std::filesystem::create_directories(host_path, ec);
+        for (const u32 child : node.children) {
+            if (!Extract(nodes[child], host_path / nodes[child].name)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (std::filesystem::file_size(host_path, ec) == node.size && !ec) {
+        return true;
+    }
+    const Common::FS::IOFile out{host_path, Common::FS::FileAccessMode::Write};
+    if (!out.IsOpen()) {
+        LOG_ERROR(Core, "Failed to open {} for writing", Common::FS::PathToUTF8String(host_path));
+        return false;
+    }
+    std::vector<u8> buffer(block_size * ReadaheadBlocks);
+    for (u64 offset = 0; offset < node.size; offset += buffer.size()) {
+        const s64 read = Read(node, buffer.data(), buffer.size(), offset, true);
+        if (read <= 0 || out.WriteRaw<u8>(buffer.data(), read) != static_cast<u64>(read)) {
+            LOG_ERROR(Core, "Failed to extract {}", Common::FS::PathToUTF8String(host_path));
+            return false;
+        }
+    }
+    return true;
+}
+
+PfsImage::Stats PfsImage::GetStats() const {
+    return {num_reads, bytes_read, read_ns, num_hits, num_misses, num_readahead};
+}
+
+void PfsImage::LogStats() const {
+    const auto stats = GetStats();
+    const double mbytes = stats.bytes_read / 1048576.0;
+    const double seconds = stats.read_ns / 1e9;
+    const u64 lookups = stats.num_hits + stats.num_misses;
+    LOG_INFO(Core,
+             "PFS image {}: {} reads, {:.1f} MB at {:.1f} MB/s, {:.1f}% block cache hits, {} "
+             "blocks read ahead",
+             Common::FS::PathToUTF8String(path.filename()), stats.num_reads, mbytes,
+             seconds > 0.0 ? mbytes / seconds : 0.0,
+             lookups > 0 ? 100.0 * stats.num_hits / lookups : 0.0, stats.num_readahead);
+}
+
+PfsImage::Block PfsImage::GetBlock(u64 index) {
+    if (!is_pfsc) {
+        const auto view = file.View(index * block_size, block_size);
+        if (view.empty()) {
+            return nullptr;
+        }
+        return std::make_shared<const std::vector<u8>>(view.begin(), view.end());
+    }
+    {
+        std::scoped_lock lock{cache_mutex};
+        if (const auto it = cache_index.find(index); it != cache_index.end()) {
+            auto& slot = cache[it->second];
+            slot.last_use = ++use_tick;
+            ++num_hits;
+            return slot.data;
+        }
+    }
+    ++num_misses;
+    auto data = DecodeBlock(index);
+    if (data) {
+        InsertBlock(index, data);
+    }
+    return data;
+}
+
+PfsImage::Block PfsImage::DecodeBlock(u64 index) const {
+    if (index + 1 >= sector_map.size()) {
+        return nullptr;
+    }
+    const u64 sector_offset = sector_map[index];
+    const u64 sector_size = sector_map[index + 1] - sector_offset;
+    const auto sector = file.View(sector_offset, sector_size);
+    if (sector.empty() || sector_size > pfsc_block_size) {
+        return nullptr;
+    }
+    auto data = std::make_shared<std::vector<u8>>(pfsc_block_size);
+    if (sector_size == pfsc_block_size) {
+        // Blocks that don't compress are stored as they are.
+        std::memcpy(data->data(), sector.data(), sector_size);
+        return data;
+    }
+    uLongf out_size = static_cast<uLongf>(pfsc_block_size);
+    if (uncompress(data->data(), &out_size, sector.data(), static_cast<uLong>(sector_size)) !=
+        Z_OK) {
+        LOG_ERROR(Core, "Failed to decompress block {} of {}", index,
+                  Common::FS::PathToUTF8String(path));
+        return nullptr;
+    }
+    return data;
+}
+
+void PfsImage::InsertBlock(u64 index, Block data) {
+    std::scoped_lock lock{cache_mutex};
+    if (cache_index.contains(index)) {
+        return;
+    }
+    size_t slot_index = cache.size();
+    if (cache.size() < CacheBlocks) {
+        cache.emplace_back();
+    } else {
+        const auto oldest = std::ranges::min_element(cache, {}, &CacheSlot::last_use);
+        slot_index = static_cast<size_t>(oldest - cache.begin());
+        cache_index.erase(oldest->index);
+    }
+    cache[slot_index] = {index, ++use_tick, std::move(data)};
+    cache_index.emplace(index, slot_index);
+}
+
+void PfsImage::QueueReadahead(u64 first, u64 last) {
+    std::vector<u64> blocks;
+    {
+        std::scoped_lock lock{cache_mutex};
+        for (u64 index = first; index <= last; index++) {
+            if (!cache_index.contains(index) && pending_readahead.insert(index).second) {
+                blocks.push_back(index);
+            }
+        }
+    }
+    for (const u64 index : blocks) {
+        readahead_worker->QueueWork([this, index] {
+            if (auto data = DecodeBlock(index)) {
+                InsertBlock(index, std::move(data));
+                ++num_readahead;
+            }
+            std::scoped_lock lock{cache_mutex};
+            pending_readahead.erase(index);
+        });
+    }
+}
@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <tsl/robin_map.h>
+#include "common/mapped_file.h"
+#include "common/thread_worker.h"
+#include "common/types.h"
+#include "core/file_format/pfs.h"
+
+/**
+ * Read-only view of the files of a PFS image, either a plain image or one wrapped in a PFSC
+ * container as in the pfs_image.dat of a package. Blocks are decompressed on demand and kept in
+ * a cache, sequential reads have the blocks after them decompressed ahead on a worker thread.
+ * Encrypted images are not supported, they have to be decrypted first.
+ */
+class PfsImage {
+public:
+    struct Node {
+        std::string name;
+        u64 size;
+        u64 first_block; ///< Block of the image holding the start of the file
+        s64 mtime;
+        bool is_dir;
+        std::vector<u32> children; ///< Indices of the nodes of a directory, without . and ..
+    };
+
+    struct Stats {
+        u64 num_reads;
+        u64 bytes_read;
+        u64 read_ns; ///< Time spent in reads, including the blocks they had to decompress
+        u64 num_hits;
+        u64 num_misses;
+        u64 num_readahead;
+    };
+
+    /// Returns whether the file starts like a plain or PFSC wrapped PFS image.
+    static bool IsImage(const std::filesystem::path& path);
+
+    /// Opens an image and reads its directory tree, returns nullptr when it isn't a valid one.
+    static std::shared_ptr<PfsImage> Open(const std::filesystem::path& path);
+
+    explicit PfsImage(const std::filesystem::path& path);
+    ~PfsImage();
+
+    PfsImage(const PfsImage&) = delete;
+    PfsImage& operator=(const PfsImage&) = delete;
+
+    /// Looks up a path relative to the root of the image, components are separated by slashes.
+    [[nodiscard]] const Node* Find(std::string_view path) const;
+
+    [[nodiscard]] const Node& GetNode(u32 index) const {
+        return nodes[index];
+    }
+
+    /// Reads up to size bytes of a file at the given offset, returns the bytes read or -1 when
+    /// the image is damaged. Sequential readers get the following blocks read ahead.
+    s64 Read(const Node& node, void* buf, u64 size, u64 offset, bool sequential);
+
+    /// Copies a file or directory of the image to the host, files that already exist with the
+    /// same size are kept.
+    bool Extract(const Node& node, const std::filesystem::path& host_path);
+
+    /// Hash of the image header, identifies the image apart from its path.
+    [[nodiscard]] u64 GetId() const {
+        return id;
+    }
+
+    [[nodiscard]] Stats GetStats() const;
+
+    void LogStats() const;
+
+private:
+    using Block = std::shared_ptr<const std::vector<u8>>;
+
+    struct CacheSlot {
+        u64 index;
+        u64 last_use;
+        Block data;
+    };
+
+    using DirentCallback = std::function<bool(const Dirent& dirent, std::string name)>;
+
+    bool ReadHeader();
+    bool LoadTree();
+
+    /// Calls back for every file and directory entry of a directory until the callback fails.
+    bool ForEachDirent(const Inode& inode, const DirentCallback& callback);
+    bool LoadDirectory(u32 node_index, const Inode& inode, const std::string& path, u32 depth);
+    bool ReadInode(u32 ino, Inode& inode);
+
+    /// Returns a block of the image, from the cache or decoded from the file.
+    Block GetBlock(u64 index);
+    Block DecodeBlock(u64 index) const;
+    void InsertBlock(u64 index, Block data);
+    void QueueReadahead(u64 first, u64 last);
+
+    std::filesystem::path path;
+    Common::FS::MappedFile file;
+    bool is_pfsc{};
+    u64 pfsc_block_size{};
+    std::vector<u64> sector_map; ///< Offsets of the compressed blocks of a PFSC image
+    u64 block_size{};
+    u64 num_blocks{};
+    PSFHeader_ header{};
+    u64 id{};
+
+    std::vector<Node> nodes; ///< The root is node 0
+    tsl::robin_map<std::string, u32> path_index;
+
+    std::mutex cache_mutex;
+    std::vector<CacheSlot> cache;
+    tsl::robin_map<u64, size_t> cache_index; ///< Slot of each cached block
+    std::set<u64> pending_readahead;
+    u64 use_tick{};
+    std::unique_ptr<Common::ThreadWorker> readahead_worker;
+
+    std::atomic<u64> num_reads{};
+    std::atomic<u64> bytes_read{};
+    std::atomic<u64> read_ns{};
+    std::atomic<u64> num_hits{};
+    std::atomic<u64> num_misses{};
+    std::atomic<u64> num_readahead{};
+};
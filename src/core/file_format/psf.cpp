@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <cstring>
+#include <mutex>
 
 #include "common/assert.h"
 #include "common/io_file.h"
@@ -20,7 +21,55 @@ static inline u32 get_max_size(std::string_view key, u32 default_value) {
     return default_value;
 }
 
+namespace {
+
+struct CachedPSF {
+    std::filesystem::file_time_type write_time;
+    std::uintmax_t size;
+    std::vector<u8> contents;
+    PSF psf;
+};
+
+// Files that were parsed or written, valid as long as their write time and size are unchanged
+constexpr size_t MaxCachedPSFs = 256;
+std::mutex g_cache_mutex;
+std::unordered_map<std::filesystem::path::string_type, CachedPSF> g_cache;
+
+const CachedPSF* FindCached(const std::filesystem::path& filepath) {
+    std::error_code ec;
+    const auto write_time = std::filesystem::last_write_time(filepath, ec);
+    const auto size = ec ? 0 : std::filesystem::file_size(filepath, ec);
+    const auto it = g_cache.find(filepath.native());
+    if (ec || it == g_cache.end() || it->second.write_time != write_time ||
+        it->second.size != size) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+void AddCached(const std::filesystem::path& filepath, std::vector<u8> contents, const PSF& psf) {
+    std::error_code ec;
+    const auto write_time = std::filesystem::last_write_time(filepath, ec);
+    if (ec) {
+        return;
+    }
+    if (g_cache.size() >= MaxCachedPSFs) {
+        g_cache.clear();
+    }
+    const auto size = contents.size();
+    g_cache.insert_or_assign(filepath.native(),
+                             CachedPSF{write_time, size, std::move(contents), psf});
+}
+
+} // Anonymous namespace
+
 bool PSF::Open(const std::filesystem::path& filepath) {
+    std::scoped_lock lk{g_cache_mutex};
+    if (const auto* cached = FindCached(filepath)) {
+        *this = cached->psf;
+        return true;
+    }
+
     using namespace std::chrono;
     if (std::filesystem::exists(filepath)) {
         const auto t = std::filesystem::last_write_time(filepath);
@@ -41,7 +90,11 @@ bool PSF::Open(const std::filesystem::path& filepath) {
     file.Seek(0);
     file.Read(psf);
     file.Close();
-    return Open(psf);
+    if (!Open(psf)) {
+        return false;
+    }
+    AddCached(filepath, std::move(psf), *this);
+    return true;
 }
 
 bool PSF::Open(const std::vector<u8>& psf_buffer) {
@@ -100,6 +153,14 @@ bool PSF::Open(const std::vector<u8>& psf_buffer) {
 }
 
 bool PSF::Encode(const std::filesystem::path& filepath) const {
+    auto psf_buffer = Encode();
+    std::scoped_lock lk{g_cache_mutex};
+    if (const auto* cached = FindCached(filepath); cached && cached->contents == psf_buffer) {
+        // The file already has these contents, e.g. when saving again without changes
+        last_write = cached->psf.last_write;
+        return true;
+    }
+
     Common::FS::IOFile file(filepath, Common::FS::FileAccessMode::Create);
     if (!file.IsOpen()) {
         return false;
@@ -107,13 +168,15 @@ bool PSF::Encode(const std::filesystem::path& filepath) const {
 
     last_write = std::chrono::system_clock::now();
 
-    const auto psf_buffer = Encode();
     const size_t written = file.Write(psf_buffer);
     if (written != psf_buffer.size()) {
         LOG_ERROR(Core, "Failed to write PSF file. Written {} Expected {}", written,
                   psf_buffer.size());
+        return false;
     }
-    return written == psf_buffer.size();
+    file.Close();
+    AddCached(filepath, std::move(psf_buffer), *this);
+    return true;
 }
 
 std::vector<u8> PSF::Encode() const {
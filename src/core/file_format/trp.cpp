@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2024-2026 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+
 #include "common/aes.h"
 #include "common/key_manager.h"
 #include "common/logging/log.h"
@@ -44,6 +46,55 @@ static void hexToBytes(const char* hex, unsigned char* dst) {
 }
 
 bool TRP::Extract(const std::filesystem::path& trophyPath, const std::string titleId) {
+    if (!Open(trophyPath, titleId)) {
+        return false;
+    }
+
+    bool success = true;
+    try {
+        for (const auto& [folder, pack] : packs) {
+            // Create output directories
+            const auto outputPath = trpFilesPath / folder;
+            if (!std::filesystem::create_directories(outputPath / "Icons") ||
+                !std::filesystem::create_directories(outputPath / "Xml")) {
+                LOG_ERROR(Common_Filesystem, "Failed to create output directories for {}", titleId);
+                success = false;
+                continue;
+            }
+
+            Common::FS::IOFile file(pack.path, Common::FS::FileAccessMode::Read);
+            if (!file.IsOpen()) {
+                LOG_ERROR(Common_Filesystem, "Unable to open trophy file: {}", pack.path.string());
+                success = false;
+                continue;
+            }
+            for (const auto& entry : pack.entries) {
+                if (!ExtractEntry(file, pack, entry, outputPath)) {
+                    success = false;
+                    // Continue with next entry
+                }
+            }
+        }
+    } catch (const std::filesystem::filesystem_error& e) {
+        LOG_CRITICAL(Common_Filesystem, "Filesystem error during trophy extraction: {}", e.what());
+        return false;
+    }
+
+    if (success) {
+        LOG_INFO(Common_Filesystem, "Successfully extracted {} trophy files for {}", packs.size(),
+                 titleId);
+    }
+
+    return success;
+}
+
+bool TRP::Open(const std::filesystem::path& trophyPath, const std::string& titleId) {
+    std::scoped_lock lock{mutex};
+    packs.clear();
+    iconCache.clear();
+    trpFilesPath = Common::FS::GetUserPath(Common::FS::PathType::MetaDataDir) / titleId /
+                   "TrophyFiles";
+
     std::filesystem::path gameSysDir = trophyPath / "sce_sys/trophy/";
     if (!std::filesystem::exists(gameSysDir)) {
         LOG_WARNING(Common_Filesystem, "Game trophy directory doesn't exist");
@@ -57,9 +108,7 @@ bool TRP::Extract(const std::filesystem::path& trophyPath, const std::string tit
         LOG_INFO(Common_Filesystem, "Trophy decryption key is not specified");
         return false;
     }
-
-    std::array<u8, 16> user_key{};
-    std::copy(user_key_vec.begin(), user_key_vec.end(), user_key.begin());
+    std::copy(user_key_vec.begin(), user_key_vec.end(), userKey.begin());
 
     // Load npbind.dat using the new class
     std::filesystem::path npbindPath = trophyPath / "sce_sys/npbind.dat";
@@ -77,22 +126,23 @@ bool TRP::Extract(const std::filesystem::path& trophyPath, const std::string tit
     int trpFileIndex = 0;
 
     try {
-        // Process each TRP file in the trophy directory
+        // Read the entries of each TRP file in the trophy directory
         for (const auto& it : std::filesystem::directory_iterator(gameSysDir)) {
             if (!it.is_regular_file() || it.path().extension() != ".trp") {
                 continue; // Skip non-TRP files
             }
 
+            TrpPack pack{.path = it.path()};
             // Get NPCommID for this TRP file (if available)
-            std::string npCommId;
             if (trpFileIndex < static_cast<int>(npCommIds.size())) {
-                npCommId = npCommIds[trpFileIndex];
-                LOG_DEBUG(Common_Filesystem, "Using NPCommID: {} for {}", npCommId,
+                pack.npCommId = npCommIds[trpFileIndex];
+                LOG_DEBUG(Common_Filesystem, "Using NPCommID: {} for {}", pack.npCommId,
                           it.path().filename().string());
             } else {
                 LOG_WARNING(Common_Filesystem, "No NPCommID found for TRP file index {}",
                             trpFileIndex);
             }
+            trpFileIndex++;
 
             Common::FS::IOFile file(it.path(), Common::FS::FileAccessMode::Read);
             if (!file.IsOpen()) {
@@ -116,19 +166,6 @@ bool TRP::Extract(const std::filesystem::path& trophyPath, const std::string tit
             }
 
             s64 seekPos = sizeof(TrpHeader);
-            std::filesystem::path trpFilesPath(
-                Common::FS::GetUserPath(Common::FS::PathType::MetaDataDir) / titleId /
-                "TrophyFiles" / it.path().stem());
-
-            // Create output directories
-            if (!std::filesystem::create_directories(trpFilesPath / "Icons") ||
-                !std::filesystem::create_directories(trpFilesPath / "Xml")) {
-                LOG_ERROR(Common_Filesystem, "Failed to create output directories for {}", titleId);
-                success = false;
-                continue;
-            }
-
-            // Process each entry in the TRP file
             for (int i = 0; i < header.entry_num; i++) {
                 if (!file.Seek(seekPos)) {
                     LOG_ERROR(Common_Filesystem, "Failed to seek to TRP entry offset");
@@ -143,49 +180,100 @@ bool TRP::Extract(const std::filesystem::path& trophyPath, const std::string tit
                     success = false;
                     break;
                 }
-
-                std::string_view name(entry.entry_name);
-
-                if (entry.flag == ENTRY_FLAG_PNG) {
-                    if (!ProcessPngEntry(file, entry, trpFilesPath, name)) {
-                        success = false;
-                        // Continue with next entry
-                    }
-                } else if (entry.flag == ENTRY_FLAG_ENCRYPTED_XML) {
-                    // Check if we have a valid NPCommID for decryption
-                    if (npCommId.size() >= 12 && npCommId[0] == 'N' && npCommId[1] == 'P') {
-                        if (!ProcessEncryptedXmlEntry(file, entry, trpFilesPath, name, user_key,
-                                                      npCommId)) {
-                            success = false;
-                            // Continue with next entry
-                        }
-                    } else {
-                        LOG_WARNING(Common_Filesystem,
-                                    "Skipping encrypted XML entry - invalid NPCommID");
-                        // Skip this entry but continue
-                    }
-                } else {
-                    LOG_DEBUG(Common_Filesystem, "Unknown entry flag: {} for {}",
-                              static_cast<unsigned int>(entry.flag), name);
-                }
+                entry.entry_name[sizeof(entry.entry_name) - 1] = '\0';
+                pack.entries.push_back(entry);
             }
-
-            trpFileIndex++;
+            packs.emplace(it.path().stem().string(), std::move(pack));
         }
     } catch (const std::filesystem::filesystem_error& e) {
-        LOG_CRITICAL(Common_Filesystem, "Filesystem error during trophy extraction: {}", e.what());
+        LOG_CRITICAL(Common_Filesystem, "Filesystem error while reading trophies: {}", e.what());
         return false;
-    } catch (const std::exception& e) {
-        LOG_CRITICAL(Common_Filesystem, "Error during trophy extraction: {}", e.what());
+    }
+
+    return success;
+}
+
+bool TRP::ExtractEntry(Common::FS::IOFile& file, const TrpPack& pack, const TrpEntry& entry,
+                       const std::filesystem::path& outputPath) {
+    std::string_view name(entry.entry_name);
+    if (entry.flag == ENTRY_FLAG_PNG) {
+        return ProcessPngEntry(file, entry, outputPath, name);
+    }
+    if (entry.flag == ENTRY_FLAG_ENCRYPTED_XML) {
+        // Check if we have a valid NPCommID for decryption
+        const auto& npCommId = pack.npCommId;
+        if (npCommId.size() >= 12 && npCommId[0] == 'N' && npCommId[1] == 'P') {
+            return ProcessEncryptedXmlEntry(file, entry, outputPath, name, userKey, npCommId);
+        }
+        LOG_WARNING(Common_Filesystem, "Skipping encrypted XML entry - invalid NPCommID");
+        return true;
+    }
+    LOG_DEBUG(Common_Filesystem, "Unknown entry flag: {} for {}",
+              static_cast<unsigned int>(entry.flag), name);
+    return true;
+}
+
+bool TRP::ExtractFile(std::string_view trophyFolder, std::string_view dir, std::string_view name) {
+    std::scoped_lock lock{mutex};
+    const auto outputPath = trpFilesPath / trophyFolder;
+    if (std::filesystem::exists(outputPath / dir / name)) {
+        return true;
+    }
+    const auto pack = packs.find(std::string{trophyFolder});
+    if (pack == packs.end()) {
         return false;
     }
 
-    if (success) {
-        LOG_INFO(Common_Filesystem, "Successfully extracted {} trophy files for {}", trpFileIndex,
-                 titleId);
+    // Entries of encrypted XML are named ESFM, as in TROP.ESFM for TROP.XML
+    const bool isXml = dir == "Xml";
+    std::string entryName{name};
+    if (const size_t pos = entryName.find("XML"); isXml && pos != std::string::npos) {
+        entryName.replace(pos, 3, "ESFM");
+    }
+    const auto entry = std::ranges::find_if(pack->second.entries, [&](const TrpEntry& entry) {
+        return entryName == entry.entry_name &&
+               entry.flag == (isXml ? ENTRY_FLAG_ENCRYPTED_XML : ENTRY_FLAG_PNG);
+    });
+    if (entry == pack->second.entries.end()) {
+        return false;
     }
 
-    return success;
+    Common::FS::IOFile file(pack->second.path, Common::FS::FileAccessMode::Read);
+    if (!file.IsOpen()) {
+        LOG_ERROR(Common_Filesystem, "Unable to open trophy file: {}",
+                  pack->second.path.string());
+        return false;
+    }
+    std::filesystem::create_directories(outputPath / dir);
+    LOG_DEBUG(Common_Filesystem, "Extracting {} of {}", name, trophyFolder);
+    return ExtractEntry(file, pack->second, *entry, outputPath);
+}
+
+std::vector<u8> TRP::GetIcon(std::string_view trophyFolder, std::string_view name) {
+    const auto key = fmt::format("{}/{}", trophyFolder, name);
+    {
+        std::scoped_lock lock{mutex};
+        const auto it = std::ranges::find(iconCache, key, &decltype(iconCache)::value_type::first);
+        if (it != iconCache.end()) {
+            return it->second;
+        }
+    }
+    if (!ExtractFile(trophyFolder, "Icons", name)) {
+        return {};
+    }
+
+    std::scoped_lock lock{mutex};
+    Common::FS::IOFile file(trpFilesPath / trophyFolder / "Icons" / name,
+                            Common::FS::FileAccessMode::Read);
+    std::vector<u8> icon(file.IsOpen() ? file.GetSize() : 0);
+    if (!file.Read(icon)) {
+        return {};
+    }
+    if (iconCache.size() == max_cached_icons) {
+        iconCache.erase(iconCache.begin());
+    }
+    iconCache.emplace_back(key, icon);
+    return icon;
 }
 
 bool TRP::ProcessPngEntry(Common::FS::IOFile& file, const TrpEntry& entry,
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include "common/endian.h"
 #include "common/io_file.h"
@@ -38,7 +41,25 @@ public:
     ~TRP();
     bool Extract(const std::filesystem::path& trophyPath, const std::string titleId);
 
+    /// Reads the entry tables of the trophy packs of a game, without extracting any entry.
+    bool Open(const std::filesystem::path& trophyPath, const std::string& titleId);
+
+    /// Extracts a file of a pack opened with Open, unless it already was. The folder is the stem
+    /// of the pack, e.g. trophy00, and the directory Icons or Xml, as in the extracted layout.
+    bool ExtractFile(std::string_view trophyFolder, std::string_view dir, std::string_view name);
+
+    /// Returns the contents of an icon, kept in memory for the next calls.
+    std::vector<u8> GetIcon(std::string_view trophyFolder, std::string_view name);
+
 private:
+    struct TrpPack {
+        std::filesystem::path path;
+        std::string npCommId;
+        std::vector<TrpEntry> entries;
+    };
+
+    bool ExtractEntry(Common::FS::IOFile& file, const TrpPack& pack, const TrpEntry& entry,
+                      const std::filesystem::path& outputPath);
     bool ProcessPngEntry(Common::FS::IOFile& file, const TrpEntry& entry,
                          const std::filesystem::path& outputPath, std::string_view name);
     bool ProcessEncryptedXmlEntry(Common::FS::IOFile& file, const TrpEntry& entry,
@@ -50,4 +71,10 @@ private:
     std::array<u8, 16> esfmIv{};
     std::filesystem::path trpFilesPath;
     static constexpr int iv_len = 16;
+
+    static constexpr size_t max_cached_icons = 8;
+    std::mutex mutex;
+    std::array<u8, 16> userKey{};
+    std::unordered_map<std::string, TrpPack> packs; ///< By the stem of the pack file
+    std::vector<std::pair<std::string, std::vector<u8>>> iconCache;
 };
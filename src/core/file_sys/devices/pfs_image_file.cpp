@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "core/file_sys/devices/pfs_image_file.h"
+#include "core/libraries/kernel/file_system.h"
+
+namespace Core::Devices {
+
+s64 PfsImageFile::ReadAt(void* buf, u64 nbytes, s64 read_offset) {
+    const bool sequential = read_offset == next_offset;
+    const s64 result = image->Read(node, buf, nbytes, read_offset, sequential);
+    if (result < 0) {
+        return ORBIS_KERNEL_ERROR_EIO;
+    }
+    next_offset = read_offset + result;
+    return result;
+}
+
+s64 PfsImageFile::readv(const Libraries::Kernel::OrbisKernelIovec* iov, s32 iovcnt) {
+    s64 bytes_read = 0;
+    for (s32 i = 0; i < iovcnt; i++) {
+        const s64 result = read(iov[i].iov_base, iov[i].iov_len);
+        if (result < 0) {
+            return result;
+        }
+        bytes_read += result;
+        if (static_cast<u64>(result) < iov[i].iov_len) {
+            break;
+        }
+    }
+    return bytes_read;
+}
+
+s64 PfsImageFile::preadv(const Libraries::Kernel::OrbisKernelIovec* iov, s32 iovcnt,
+                         s64 read_offset) {
+    s64 bytes_read = 0;
+    for (s32 i = 0; i < iovcnt; i++) {
+        const s64 result = ReadAt(iov[i].iov_base, iov[i].iov_len, read_offset + bytes_read);
+        if (result < 0) {
+            return result;
+        }
+        bytes_read += result;
+        if (static_cast<u64>(result) < iov[i].iov_len) {
+            break;
+        }
+    }
+    return bytes_read;
+}
+
+s64 PfsImageFile::lseek(s64 new_offset, s32 whence) {
+    switch (whence) {
+    case 0:
+        break;
+    case 1:
+        new_offset += offset;
+        break;
+    case 2:
+        new_offset += static_cast<s64>(node.size);
+        break;
+    default:
+        return ORBIS_KERNEL_ERROR_EINVAL;
+    }
+    if (new_offset < 0) {
+        return ORBIS_KERNEL_ERROR_EINVAL;
+    }
+    offset = new_offset;
+    return offset;
+}
+
+s64 PfsImageFile::read(void* buf, u64 nbytes) {
+    const s64 result = ReadAt(buf, nbytes, offset);
+    if (result > 0) {
+        offset += result;
+    }
+    return result;
+}
+
+s32 PfsImageFile::fstat(Libraries::Kernel::OrbisKernelStat* sb) {
+    sb->st_mode = 0000777u | 0100000u;
+    sb->st_size = static_cast<s64>(node.size);
+    sb->st_blksize = 512;
+    sb->st_blocks = (sb->st_size + 511) / 512;
+    sb->st_mtim.tv_sec = node.mtime;
+    return ORBIS_OK;
+}
+
+} // namespace Core::Devices
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+#include <memory>
+#include "core/file_format/pfs_image.h"
+#include "core/file_sys/devices/base_device.h"
+
+namespace Core::Devices {
+
+/// Read-only file of a mounted PFS image.
+class PfsImageFile final : public BaseDevice {
+    std::shared_ptr<PfsImage> image;
+    const PfsImage::Node& node;
+    s64 offset{};
+    s64 next_offset{-1}; ///< End of the last read, to detect sequential reads
+
+public:
+    explicit PfsImageFile(std::shared_ptr<PfsImage> image, const PfsImage::Node& node)
+        : image(std::move(image)), node(node) {}
+
+    ~PfsImageFile() override = default;
+
+    s64 readv(const Libraries::Kernel::OrbisKernelIovec* iov, s32 iovcnt) override;
+    s64 preadv(const Libraries::Kernel::OrbisKernelIovec* iov, s32 iovcnt, s64 offset) override;
+    s64 lseek(s64 offset, s32 whence) override;
+    s64 read(void* buf, u64 nbytes) override;
+    s32 fstat(Libraries::Kernel::OrbisKernelStat* sb) override;
+
+private:
+    s64 ReadAt(void* buf, u64 nbytes, s64 read_offset);
+};
+
+} // namespace Core::Devices
@@ -1,6 +1,11 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
 #include "common/logging/log.h"
 #include "common/singleton.h"
 #include "core/file_sys/directories/base_directory.h"
@@ -9,6 +14,77 @@
 
 namespace Core::Directories {
 
+namespace {
+
+struct CachedDirents {
+    std::shared_ptr<const DirentSnapshot> snapshot;
+    /// Write time of the host directory, left empty for read-only mounts that can't change
+    std::filesystem::file_time_type write_time;
+};
+
+std::mutex dirent_cache_mutex;
+u64 dirent_cache_generation{}; ///< Bumped by every invalidation
+/// Keyed by guest directory and dirent format
+std::map<std::pair<std::string, u32>, CachedDirents> dirent_cache;
+
+std::string_view RemoveTrailingSlashes(std::string_view path) {
+    while (path.size() > 1 && path.ends_with('/')) {
+        path.remove_suffix(1);
+    }
+    return path;
+}
+
+/// Other HLE libraries write to writable mounts directly, check the host side has not changed.
+std::filesystem::file_time_type GetHostWriteTime(std::string_view guest_directory) {
+    auto* mnt = Common::Singleton<Core::FileSys::MntPoints>::Instance();
+    const auto* mount = mnt->GetMount(std::string{guest_directory});
+    if (!mount || mount->read_only) {
+        return {};
+    }
+    std::error_code ec;
+    const auto write_time =
+        std::filesystem::last_write_time(mnt->GetHostPath(guest_directory, nullptr, true), ec);
+    return ec ? std::filesystem::file_time_type{} : write_time;
+}
+
+} // Anonymous namespace
+
+void InvalidateDirentCache(std::string_view guest_path) {
+    guest_path = RemoveTrailingSlashes(guest_path);
+    const auto parent = guest_path.substr(0, guest_path.rfind('/'));
+    std::scoped_lock lock{dirent_cache_mutex};
+    ++dirent_cache_generation;
+    std::erase_if(dirent_cache, [&](const auto& entry) {
+        const std::string_view path = entry.first.first;
+        return path == parent || path == guest_path ||
+               (path.starts_with(guest_path) && path[guest_path.size()] == '/');
+    });
+}
+
+std::shared_ptr<const DirentSnapshot> BaseDirectory::GetDirentSnapshot(
+    std::string_view guest_directory, u32 format, const std::function<DirentSnapshot()>& build) {
+    guest_directory = RemoveTrailingSlashes(guest_directory);
+    const auto write_time = GetHostWriteTime(guest_directory);
+    auto key = std::make_pair(std::string{guest_directory}, format);
+    u64 generation{};
+    {
+        std::scoped_lock lock{dirent_cache_mutex};
+        const auto it = dirent_cache.find(key);
+        if (it != dirent_cache.end() && it->second.write_time == write_time) {
+            return it->second.snapshot;
+        }
+        generation = dirent_cache_generation;
+    }
+    // Enumerate without the lock, two threads racing on the same directory build it twice
+    auto snapshot = std::make_shared<const DirentSnapshot>(build());
+    std::scoped_lock lock{dirent_cache_mutex};
+    if (generation == dirent_cache_generation) {
+        // Otherwise the directory may have changed while it was enumerated
+        dirent_cache.insert_or_assign(std::move(key), CachedDirents{snapshot, write_time});
+    }
+    return snapshot;
+}
+
 BaseDirectory::BaseDirectory() = default;
 
 BaseDirectory::~BaseDirectory() = default;
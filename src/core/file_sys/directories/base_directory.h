@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <string_view>
 #include <vector>
 #include "common/types.h"
@@ -18,6 +20,16 @@ struct OrbisKernelDirent;
 
 namespace Core::Directories {
 
+/// Encoded dirents of a directory as of its last enumeration, shared by every open of it.
+struct DirentSnapshot {
+    std::vector<u8> dirents;
+    u64 directory_size;
+};
+
+/// Drops the cached enumerations of a guest path, of the directory containing it and of
+/// everything below it. Has to be called after entries are created, removed or renamed.
+void InvalidateDirentCache(std::string_view guest_path);
+
 class BaseDirectory {
 protected:
     static inline u32 fileno_pool{10};
@@ -26,6 +38,12 @@ protected:
         return ++fileno_pool;
     }
 
+    /// Returns the cached dirents of a guest directory in the given format, calling build to
+    /// enumerate the host directory when there are none or they went stale.
+    static std::shared_ptr<const DirentSnapshot> GetDirentSnapshot(
+        std::string_view guest_directory, u32 format,
+        const std::function<DirentSnapshot()>& build);
+
     s64 file_offset = 0;
     u64 directory_size = 0;
     std::vector<u8> dirent_cache_bin{};
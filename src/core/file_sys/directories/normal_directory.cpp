@@ -103,6 +103,17 @@ void NormalDirectory::RebuildDirents() {
         return;
     previous_file_offset = file_offset;
 
+    const auto snapshot = GetDirentSnapshot(guest_directory, DirentFormat, [this] {
+        return EnumerateDirents();
+    });
+    if (snapshot != dirent_snapshot) {
+        dirent_cache_bin = snapshot->dirents;
+        directory_size = snapshot->directory_size;
+        dirent_snapshot = snapshot;
+    }
+}
+
+DirentSnapshot NormalDirectory::EnumerateDirents() const {
     constexpr u32 dirent_meta_size =
         sizeof(NormalDirectoryDirent::d_fileno) + sizeof(NormalDirectoryDirent::d_type) +
         sizeof(NormalDirectoryDirent::d_namlen) + sizeof(NormalDirectoryDirent::d_reclen);
@@ -110,13 +121,13 @@ void NormalDirectory::RebuildDirents() {
     u64 next_ceiling = 0;
     u64 dirent_offset = 0;
     u64 last_reclen_offset = 4;
-    dirent_cache_bin.clear();
-    dirent_cache_bin.reserve(512);
+    std::vector<u8> dirents;
+    dirents.reserve(512);
 
     auto* mnt = Common::Singleton<Core::FileSys::MntPoints>::Instance();
 
     mnt->IterateDirectory(
-        guest_directory, [this, &next_ceiling, &dirent_offset, &last_reclen_offset](
+        guest_directory, [&dirents, &next_ceiling, &dirent_offset, &last_reclen_offset](
                              const std::filesystem::path& ent_path, const bool ent_is_file) {
             NormalDirectoryDirent tmp{};
             std::string leaf(ent_path.filename().string());
@@ -131,29 +142,28 @@ void NormalDirectory::RebuildDirents() {
             // next element may break 512 byte alignment
             if (tmp.d_reclen + dirent_offset > next_ceiling) {
                 // align previous dirent's size to the current ceiling
-                *reinterpret_cast<u16*>(static_cast<u8*>(dirent_cache_bin.data()) +
-                                        last_reclen_offset) += next_ceiling - dirent_offset;
+                *reinterpret_cast<u16*>(static_cast<u8*>(dirents.data()) + last_reclen_offset) +=
+                    next_ceiling - dirent_offset;
                 // set writing pointer to the aligned start position (current ceiling)
                 dirent_offset = next_ceiling;
                 // move the ceiling up and zero-out the buffer
                 next_ceiling += 512;
-                dirent_cache_bin.resize(next_ceiling);
-                std::fill(dirent_cache_bin.begin() + dirent_offset,
-                          dirent_cache_bin.begin() + next_ceiling, 0);
+                dirents.resize(next_ceiling);
+                std::fill(dirents.begin() + dirent_offset, dirents.begin() + next_ceiling, 0);
             }
 
             // current dirent's reclen position
             last_reclen_offset = dirent_offset + 4;
-            memcpy(dirent_cache_bin.data() + dirent_offset, &tmp, tmp.d_reclen);
+            memcpy(dirents.data() + dirent_offset, &tmp, tmp.d_reclen);
             dirent_offset += tmp.d_reclen;
         });
 
     // last reclen, as before
-    *reinterpret_cast<u16*>(static_cast<u8*>(dirent_cache_bin.data()) + last_reclen_offset) +=
+    *reinterpret_cast<u16*>(static_cast<u8*>(dirents.data()) + last_reclen_offset) +=
         next_ceiling - dirent_offset;
 
     // i have no idea if this is the case, but lseek returns size aligned to 512
-    directory_size = next_ceiling;
+    return {std::move(dirents), next_ceiling};
 }
 
 } // namespace Core::Directories
\ No newline at end of file
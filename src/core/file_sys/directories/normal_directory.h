@@ -33,9 +33,13 @@ private:
     };
 #pragma pack(pop)
 
+    static constexpr u32 DirentFormat = 0;
+
     std::string_view guest_directory{};
     s64 previous_file_offset = -1;
+    std::shared_ptr<const DirentSnapshot> dirent_snapshot; ///< What dirent_cache_bin holds
 
     void RebuildDirents(void);
+    DirentSnapshot EnumerateDirents() const;
 };
 } // namespace Core::Directories
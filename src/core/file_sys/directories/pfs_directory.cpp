@@ -15,16 +15,25 @@ std::shared_ptr<BaseDirectory> PfsDirectory::Create(std::string_view guest_direc
 }
 
 PfsDirectory::PfsDirectory(std::string_view guest_directory) {
+    const auto snapshot = GetDirentSnapshot(guest_directory, DirentFormat, [&] {
+        return EnumerateDirents(guest_directory);
+    });
+    dirent_cache_bin = snapshot->dirents;
+    directory_size = snapshot->directory_size;
+}
+
+DirentSnapshot PfsDirectory::EnumerateDirents(std::string_view guest_directory) {
     constexpr u32 dirent_meta_size =
         sizeof(PfsDirectoryDirent::d_fileno) + sizeof(PfsDirectoryDirent::d_type) +
         sizeof(PfsDirectoryDirent::d_namlen) + sizeof(PfsDirectoryDirent::d_reclen);
 
-    dirent_cache_bin.reserve(512);
+    std::vector<u8> dirents;
+    dirents.reserve(512);
 
     auto* mnt = Common::Singleton<Core::FileSys::MntPoints>::Instance();
 
     mnt->IterateDirectory(
-        guest_directory, [this](const std::filesystem::path& ent_path, const bool ent_is_file) {
+        guest_directory, [&dirents](const std::filesystem::path& ent_path, const bool ent_is_file) {
             PfsDirectoryDirent tmp{};
             std::string leaf(ent_path.filename().string());
 
@@ -35,10 +44,11 @@ PfsDirectory::PfsDirectory(std::string_view guest_directory) {
             tmp.d_reclen = Common::AlignUp(dirent_meta_size + tmp.d_namlen + 1, 8);
             auto dirent_ptr = reinterpret_cast<const u8*>(&tmp);
 
-            dirent_cache_bin.insert(dirent_cache_bin.end(), dirent_ptr, dirent_ptr + tmp.d_reclen);
+            dirents.insert(dirents.end(), dirent_ptr, dirent_ptr + tmp.d_reclen);
         });
 
-    directory_size = Common::AlignUp(dirent_cache_bin.size(), 0x10000);
+    const u64 directory_size = Common::AlignUp(dirents.size(), 0x10000);
+    return {std::move(dirents), directory_size};
 }
 
 s64 PfsDirectory::read(void* buf, u64 nbytes) {
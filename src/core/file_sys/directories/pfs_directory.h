@@ -45,5 +45,9 @@ private:
         char d_name[256];
     };
 #pragma pack(pop)
+
+    static constexpr u32 DirentFormat = 1;
+
+    static DirentSnapshot EnumerateDirents(std::string_view guest_directory);
 };
 } // namespace Core::Directories
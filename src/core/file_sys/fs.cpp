@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include "common/assert.h"
 #include "common/config.h"
 #include "common/string_util.h"
 #include "core/file_sys/devices/logger.h"
@@ -22,10 +23,29 @@ std::string RemoveTrailingSlashes(const std::string& path) {
 }
 
 void MntPoints::Mount(const std::filesystem::path& host_folder, const std::string& guest_folder,
-                      bool read_only) {
+                      bool read_only, std::shared_ptr<PfsImage> image) {
     std::scoped_lock lock{m_mutex};
     const auto guest_folder_sanitized = RemoveTrailingSlashes(guest_folder);
-    m_mnt_pairs.emplace_back(host_folder, guest_folder_sanitized, read_only);
+    m_mnt_pairs.emplace_back(host_folder, guest_folder_sanitized, read_only, std::move(image));
+}
+
+MntPoints::ImageNode MntPoints::FindImageNode(std::string_view guest_path) {
+    std::shared_ptr<PfsImage> image;
+    std::string_view rel_path;
+    {
+        std::scoped_lock lock{m_mutex};
+        const auto it = std::ranges::find_if(m_mnt_pairs, [&](const MntPair& mount) {
+            return guest_path == mount.mount ||
+                   (guest_path.starts_with(mount.mount) && guest_path[mount.mount.size()] == '/');
+        });
+        if (it == m_mnt_pairs.end() || !it->image) {
+            return {};
+        }
+        image = it->image;
+        rel_path = guest_path.substr(it->mount.size());
+    }
+    const auto* node = image->Find(rel_path);
+    return {node != nullptr ? std::move(image) : nullptr, node};
 }
 
 void MntPoints::Unmount(const std::filesystem::path& host_folder, const std::string& guest_folder) {
@@ -73,13 +93,13 @@ std::filesystem::path MntPoints::GetHostPath(std::string_view path, bool* is_rea
     // Remove device (e.g /app0) from path to retrieve relative path.
     const auto rel_path = std::string_view{corrected_path}.substr(mount->mount.size() + 1);
     std::filesystem::path host_path = mount->host_path / rel_path;
-    std::filesystem::path patch_path = mount->host_path;
-    patch_path += "-UPDATE";
-    if (!std::filesystem::exists(patch_path)) {
-        patch_path = mount->host_path;
-        patch_path += "-patch";
+    std::filesystem::path patch_root = mount->host_path;
+    patch_root += "-UPDATE";
+    if (!std::filesystem::exists(patch_root)) {
+        patch_root = mount->host_path;
+        patch_root += "-patch";
     }
-    patch_path /= rel_path;
+    const std::filesystem::path patch_path = patch_root / rel_path;
 
     if ((corrected_path.starts_with("/app0") || corrected_path.starts_with("/hostapp")) &&
         !force_base_path && !ignore_game_patches && std::filesystem::exists(patch_path)) {
@@ -90,64 +110,15 @@ std::filesystem::path MntPoints::GetHostPath(std::string_view path, bool* is_rea
         return host_path;
     }
 
-    const auto search = [&](const auto host_path) {
-        // If the path does not exist attempt to verify this.
-        // Retrieve parent path until we find one that exists.
-        std::scoped_lock lk{m_mutex};
-        path_parts.clear();
-        auto current_path = host_path;
-        while (!std::filesystem::exists(current_path)) {
-            // We have probably cached this if it's a folder.
-            if (auto it = path_cache.find(current_path); it != path_cache.end()) {
-                current_path = it->second;
-                break;
-            }
-            path_parts.emplace_back(current_path.filename());
-            current_path = current_path.parent_path();
-        }
-        // We have found an anchor. Traverse parts we recoded and see if they
-        // exist in filesystem but in different case.
-        auto guest_path = current_path;
-        while (!path_parts.empty()) {
-            const auto part = path_parts.back();
-            const auto add_match = [&](const auto& host_part) {
-                current_path /= host_part;
-                guest_path /= part;
-                path_cache[guest_path] = current_path;
-                path_parts.pop_back();
-            };
-            // Can happen when the mismatch is in upper folder.
-            if (std::filesystem::exists(current_path / part)) {
-                add_match(part);
-                continue;
-            }
-            const auto part_low = Common::ToLower(part.string());
-            bool found_match = false;
-            for (const auto& path : std::filesystem::directory_iterator(current_path)) {
-                const auto candidate = path.path().filename();
-                const auto filename = Common::ToLower(candidate.string());
-                // Check if a filename matches in case insensitive manner.
-                if (filename != part_low) {
-                    continue;
-                }
-                // We found a match, record the actual path in the cache.
-                add_match(candidate);
-                found_match = true;
-                break;
-            }
-            if (!found_match) {
-                return std::optional<std::filesystem::path>({});
-            }
-        }
-        return std::optional<std::filesystem::path>(current_path);
-    };
-
     if (!force_base_path && !ignore_game_patches) {
-        if (const auto path = search(patch_path)) {
+        if (const auto path = ResolveCaseInsensitive(patch_root, rel_path)) {
             return *path;
         }
     }
-    if (const auto path = search(host_path)) {
+    if (std::filesystem::exists(host_path)) {
+        return host_path;
+    }
+    if (const auto path = ResolveCaseInsensitive(mount->host_path, rel_path)) {
         return *path;
     }
 
@@ -156,6 +127,73 @@ std::filesystem::path MntPoints::GetHostPath(std::string_view path, bool* is_rea
     return host_path;
 }
 
+std::optional<std::filesystem::path> MntPoints::ResolveCaseInsensitive(
+    const std::filesystem::path& base, std::string_view rel_path) {
+    std::scoped_lock lock{m_mutex};
+    std::filesystem::path current_path = base;
+    for (const auto& part : std::filesystem::path{rel_path}) {
+        if (part.empty() || part == ".") {
+            continue;
+        }
+        if (part == "..") {
+            current_path = current_path.parent_path();
+            continue;
+        }
+        const auto part_low = Common::ToLower(part.string());
+        const CaseIndex* index = &GetCaseIndex(current_path, false);
+        auto it = index->entries.find(part_low);
+        if (it == index->entries.end()) {
+            // The entry may have been created outside of the guest file functions
+            index = &GetCaseIndex(current_path, true);
+            it = index->entries.find(part_low);
+            if (it == index->entries.end()) {
+                return std::nullopt;
+            }
+        }
+        current_path /= it->second;
+    }
+    return current_path;
+}
+
+const MntPoints::CaseIndex& MntPoints::GetCaseIndex(const std::filesystem::path& host_dir,
+                                                    bool on_miss) {
+    auto [it, inserted] = case_index.try_emplace(host_dir);
+    CaseIndex& index = it.value();
+    if (!inserted && !on_miss) {
+        return index;
+    }
+    // A directory that did not change since it was indexed does not need another scan.
+    std::error_code ec;
+    const auto write_time = std::filesystem::last_write_time(host_dir, ec);
+    if (!inserted && !ec && write_time == index.write_time) {
+        return index;
+    }
+    index.write_time = write_time;
+    index.entries.clear();
+    for (const auto& entry : std::filesystem::directory_iterator(host_dir, ec)) {
+        const auto name = entry.path().filename();
+        index.entries.emplace(Common::ToLower(name.string()), name);
+    }
+    return index;
+}
+
+void MntPoints::InvalidateHostPath(const std::filesystem::path& host_path) {
+    if (!NeedsCaseInsensitiveSearch) {
+        return;
+    }
+    std::scoped_lock lock{m_mutex};
+    case_index.erase(host_path.parent_path());
+    // Removed or renamed directories take the indices of everything below them along.
+    const auto sub_dir = host_path.native() + std::filesystem::path::preferred_separator;
+    for (auto it = case_index.begin(); it != case_index.end();) {
+        if (it->first == host_path || it->first.native().starts_with(sub_dir)) {
+            it = case_index.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 // TODO: Does not handle mount points inside mount points.
 void MntPoints::IterateDirectory(std::string_view guest_directory,
                                  const IterateDirectoryCallback& callback) {
@@ -191,6 +229,33 @@ void MntPoints::IterateDirectory(std::string_view guest_directory,
             }
         }
     }
+
+    // Pass 3: Entries of a mounted image that are on neither of them.
+    const auto [image, image_dir] = FindImageNode(guest_directory);
+    if (image_dir == nullptr || !image_dir->is_dir) {
+        return;
+    }
+    for (const u32 child : image_dir->children) {
+        const auto& node = image->GetNode(child);
+        const auto base_entry_path = base_path / node.name;
+        if (!std::filesystem::exists(base_entry_path) &&
+            !(apply_patch && std::filesystem::exists(patch_path / node.name))) {
+            callback(base_entry_path, !node.is_dir);
+        }
+    }
+}
+
+HandleTable::~HandleTable() {
+    for (auto& chunk_ptr : m_chunks) {
+        Chunk* chunk = chunk_ptr.load(std::memory_order_relaxed);
+        if (chunk == nullptr) {
+            continue;
+        }
+        for (auto& slot : *chunk) {
+            delete slot.load(std::memory_order_relaxed);
+        }
+        delete chunk;
+    }
 }
 
 int HandleTable::CreateHandle() {
@@ -199,71 +264,79 @@ int HandleTable::CreateHandle() {
     auto* file = new File{};
     file->is_opened = false;
 
-    int existingFilesNum = m_files.size();
-
-    for (int index = 0; index < existingFilesNum; index++) {
-        if (m_files.at(index) == nullptr) {
-            m_files[index] = file;
+    // Reuse the lowest free descriptor, like the kernel does.
+    const int num_handles = m_num_handles.load(std::memory_order_relaxed);
+    for (int index = 0; index < num_handles; index++) {
+        Chunk* chunk = m_chunks[index / ChunkSize].load(std::memory_order_relaxed);
+        auto& slot = (*chunk)[index % ChunkSize];
+        if (slot.load(std::memory_order_relaxed) == nullptr) {
+            slot.store(file, std::memory_order_release);
             return index;
         }
     }
 
-    m_files.push_back(file);
-    return m_files.size() - 1;
+    const size_t chunk_index = num_handles / ChunkSize;
+    ASSERT_MSG(chunk_index < MaxChunks, "Out of file descriptors");
+    Chunk* chunk = m_chunks[chunk_index].load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+        chunk = new Chunk{};
+        m_chunks[chunk_index].store(chunk, std::memory_order_release);
+    }
+    (*chunk)[num_handles % ChunkSize].store(file, std::memory_order_release);
+    m_num_handles.store(num_handles + 1, std::memory_order_release);
+    return num_handles;
 }
 
 void HandleTable::DeleteHandle(int d) {
     std::scoped_lock lock{m_mutex};
-    delete m_files.at(d);
-    m_files[d] = nullptr;
+    ASSERT_MSG(d >= 0 && d < m_num_handles.load(std::memory_order_relaxed),
+               "Invalid file descriptor {}", d);
+    auto& slot = (*m_chunks[d / ChunkSize].load(std::memory_order_relaxed))[d % ChunkSize];
+    File* file = slot.exchange(nullptr, std::memory_order_acq_rel);
+    m_retired_files[m_next_retired].reset(file);
+    m_next_retired = (m_next_retired + 1) % NumRetiredFiles;
 }
 
-File* HandleTable::GetFile(int d) {
-    std::scoped_lock lock{m_mutex};
-    if (d < 0 || d >= m_files.size()) {
+File* HandleTable::LoadFile(int d) const {
+    if (d < 0 || d >= m_num_handles.load(std::memory_order_acquire)) {
         return nullptr;
     }
-    return m_files.at(d);
+    const Chunk* chunk = m_chunks[d / ChunkSize].load(std::memory_order_acquire);
+    return (*chunk)[d % ChunkSize].load(std::memory_order_acquire);
+}
+
+File* HandleTable::GetFile(int d) {
+    return LoadFile(d);
 }
 
 File* HandleTable::GetSocket(int d) {
-    std::scoped_lock lock{m_mutex};
-    if (d < 0 || d >= m_files.size()) {
-        return nullptr;
-    }
-    auto file = m_files.at(d);
-    if (file->type != Core::FileSys::FileType::Socket) {
+    auto* file = LoadFile(d);
+    if (file == nullptr || file->type != Core::FileSys::FileType::Socket) {
         return nullptr;
     }
     return file;
 }
 
 File* HandleTable::GetEpoll(int d) {
-    std::scoped_lock lock{m_mutex};
-    if (d < 0 || d >= m_files.size()) {
-        return nullptr;
-    }
-    auto file = m_files.at(d);
-    if (file->type != Core::FileSys::FileType::Epoll) {
+    auto* file = LoadFile(d);
+    if (file == nullptr || file->type != Core::FileSys::FileType::Epoll) {
         return nullptr;
     }
     return file;
 }
 
 File* HandleTable::GetResolver(int d) {
-    std::scoped_lock lock{m_mutex};
-    if (d < 0 || d >= m_files.size()) {
-        return nullptr;
-    }
-    auto file = m_files.at(d);
-    if (file->type != Core::FileSys::FileType::Resolver) {
+    auto* file = LoadFile(d);
+    if (file == nullptr || file->type != Core::FileSys::FileType::Resolver) {
         return nullptr;
     }
     return file;
 }
 
 File* HandleTable::GetFile(const std::filesystem::path& host_name) {
-    for (auto* file : m_files) {
+    const int num_handles = m_num_handles.load(std::memory_order_acquire);
+    for (int d = 0; d < num_handles; d++) {
+        auto* file = LoadFile(d);
         if (file != nullptr && file->m_host_name == host_name) {
             return file;
         }
@@ -288,11 +361,11 @@ void HandleTable::CreateStdHandles() {
 }
 
 int HandleTable::GetFileDescriptor(File* file) {
-    std::scoped_lock lock{m_mutex};
-    auto it = std::find(m_files.begin(), m_files.end(), file);
-
-    if (it != m_files.end()) {
-        return std::distance(m_files.begin(), it);
+    const int num_handles = m_num_handles.load(std::memory_order_acquire);
+    for (int d = 0; d < num_handles; d++) {
+        if (LoadFile(d) == file) {
+            return d;
+        }
     }
     return 0;
 }
@@ -3,13 +3,18 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 #include <tsl/robin_map.h>
 #include "common/io_file.h"
+#include "common/mapped_file.h"
 #include "common/logging/formatter.h"
+#include "core/file_format/pfs_image.h"
 #include "core/file_sys/devices/base_device.h"
 #include "core/file_sys/directories/base_directory.h"
 
@@ -33,13 +38,19 @@ public:
         std::filesystem::path host_path;
         std::string mount; // e.g /app0
         bool read_only;
+        std::shared_ptr<PfsImage> image; // serves what is missing from the host folder
+    };
+
+    struct ImageNode {
+        std::shared_ptr<PfsImage> image;
+        const PfsImage::Node* node;
     };
 
     explicit MntPoints() = default;
     ~MntPoints() = default;
 
     void Mount(const std::filesystem::path& host_folder, const std::string& guest_folder,
-               bool read_only = false);
+               bool read_only = false, std::shared_ptr<PfsImage> image = {});
     void Unmount(const std::filesystem::path& host_folder, const std::string& guest_folder);
     void UnmountAll();
 
@@ -50,6 +61,13 @@ public:
     void IterateDirectory(std::string_view guest_directory,
                           const IterateDirectoryCallback& callback);
 
+    /// Looks a guest path up in the image mounted at it, node is null when there is none.
+    ImageNode FindImageNode(std::string_view guest_path);
+
+    /// Drops what the case insensitive index knows about a host path and its parent directory.
+    /// Has to be called after files are created, removed or renamed.
+    void InvalidateHostPath(const std::filesystem::path& host_path);
+
     const MntPair* GetMountFromHostPath(const std::string& host_path) {
         std::scoped_lock lock{m_mutex};
         const auto it = std::ranges::find_if(m_mnt_pairs, [&](const MntPair& mount) {
@@ -69,9 +87,20 @@ public:
     }
 
 private:
+    /// Lowercase names of the entries of a host directory, mapped to their actual names.
+    struct CaseIndex {
+        std::filesystem::file_time_type write_time;
+        tsl::robin_map<std::string, std::filesystem::path> entries;
+    };
+
+    /// Resolves a relative path below base component by component, ignoring the case of every
+    /// component. Directories are scanned once and indexed until they are invalidated.
+    std::optional<std::filesystem::path> ResolveCaseInsensitive(const std::filesystem::path& base,
+                                                                std::string_view rel_path);
+    const CaseIndex& GetCaseIndex(const std::filesystem::path& host_dir, bool on_miss);
+
     std::vector<MntPair> m_mnt_pairs;
-    std::vector<std::filesystem::path> path_parts;
-    tsl::robin_map<std::filesystem::path, std::filesystem::path> path_cache;
+    tsl::robin_map<std::filesystem::path, CaseIndex> case_index; ///< Keyed by host directory
     std::mutex m_mutex;
 };
 
@@ -90,6 +119,10 @@ struct File {
     std::filesystem::path m_host_name;
     std::string m_guest_name;
     Common::FS::IOFile f;
+    Common::FS::MappedFile mapping; // only valid for game files with mapped reads enabled
+    u64 next_mapped_offset{};       // end of the last mapped read, to detect sequential reads
+    u64 num_mapped_reads{};
+    u64 num_mapped_bytes{};
     std::mutex m_mutex;
     std::shared_ptr<Directories::BaseDirectory> directory; // only valid for type == Directory
     std::shared_ptr<Devices::BaseDevice> device;           // only valid for type == Device
@@ -98,10 +131,11 @@ struct File {
     std::shared_ptr<Libraries::Net::Resolver> resolver;    // only valid for type == Resolver
 };
 
+/// Descriptor table. Lookups are lock free, only creating and deleting handles takes the mutex.
 class HandleTable {
 public:
     HandleTable() = default;
-    virtual ~HandleTable() = default;
+    virtual ~HandleTable();
 
     int CreateHandle();
     void DeleteHandle(int d);
@@ -115,7 +149,21 @@ public:
     void CreateStdHandles();
 
 private:
-    std::vector<File*> m_files;
+    static constexpr size_t ChunkSize = 256;
+    static constexpr size_t MaxChunks = 256;
+    /// Closed files are freed only after this many later closes, so a lookup that raced with
+    /// the close still points at a live file.
+    static constexpr size_t NumRetiredFiles = 64;
+
+    using Chunk = std::array<std::atomic<File*>, ChunkSize>;
+
+    File* LoadFile(int d) const;
+
+    /// Chunks are allocated as descriptors grow and never move, so lookups need no lock.
+    std::array<std::atomic<Chunk*>, MaxChunks> m_chunks{};
+    std::atomic<int> m_num_handles{}; ///< One past the highest descriptor ever created
+    std::array<std::unique_ptr<File>, NumRetiredFiles> m_retired_files;
+    size_t m_next_retired{};
     std::mutex m_mutex;
 };
 
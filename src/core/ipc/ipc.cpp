@@ -42,6 +42,8 @@ extern std::unique_ptr<Vulkan::Presenter> presenter;
  *   #IPC_END
  *   In between, it will send the current capabilities and commands before the emulator start
  * - The IPC client(e.g., launcher) will send RUN then START to continue the execution
+ * - Per-frame metrics and binary commands (pause, resume, capture, counter reset) are served
+ *   over shared memory with MetricsSink set to "shm", see core/metrics_sink.h
  **/
 
 /**
@@ -9,6 +9,7 @@
 #include "core/libraries/error_codes.h"
 #include "core/libraries/libs.h"
 
+#include <mutex>
 #include <magic_enum/magic_enum.hpp>
 
 namespace Libraries::Ajm {
@@ -20,6 +21,7 @@ constexpr int ORBIS_AJM_CHANNELMASK_5POINT1 = 0x060F;
 constexpr int ORBIS_AJM_CHANNELMASK_7POINT1 = 0x063F;
 
 static std::unordered_map<u32, std::unique_ptr<AjmContext>> contexts{};
+static std::mutex contexts_mutex; ///< Guards contexts against the stats readers
 
 u32 GetChannelMask(u32 num_channels) {
     switch (num_channels) {
@@ -138,12 +140,22 @@ int PS4_SYSV_ABI sceAjmInitialize(s64 reserved, u32* p_context_id) {
     if (p_context_id == nullptr || reserved != 0) {
         return ORBIS_AJM_ERROR_INVALID_PARAMETER;
     }
+    std::scoped_lock lock{contexts_mutex};
     u32 id = contexts.size() + 1;
     *p_context_id = id;
     contexts.emplace(id, std::make_unique<AjmContext>());
     return ORBIS_OK;
 }
 
+std::vector<AjmInstanceStats> GetInstanceStats() {
+    std::vector<AjmInstanceStats> stats;
+    std::scoped_lock lock{contexts_mutex};
+    for (const auto& [id, context] : contexts) {
+        context->GetInstanceStats(stats);
+    }
+    return stats;
+}
+
 AjmCodecType PS4_SYSV_ABI sceAjmInstanceCodecType(u32 instance_id) {
     return static_cast<AjmCodecType>((instance_id >> 14) & 0x1F);
 }
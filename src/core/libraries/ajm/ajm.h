@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/bit_field.h"
 #include "common/enum.h"
 #include "common/types.h"
@@ -227,5 +229,18 @@ int PS4_SYSV_ABI sceAjmModuleRegister(u32 context, AjmCodecType codec_type, s64
 int PS4_SYSV_ABI sceAjmModuleUnregister();
 int PS4_SYSV_ABI sceAjmStrError();
 
+/// Telemetry of an instance since it was created.
+struct AjmInstanceStats {
+    u32 instance_id;
+    u32 queued_batches; ///< Batches on the instance waiting to run
+    u64 num_jobs;
+    u64 decode_ns; ///< Host time spent in the jobs
+    u64 max_decode_ns;
+    u64 max_wait_ns; ///< Longest a batch on the instance waited for a worker
+};
+
+/// Returns the stats of the instances of every context, for the debug overlay.
+std::vector<AjmInstanceStats> GetInstanceStats();
+
 void RegisterLib(Core::Loader::SymbolsResolver* sym);
 } // namespace Libraries::Ajm
@@ -152,21 +152,31 @@ DecoderResult AjmAt9Decoder::ProcessData(std::span<u8>& in_buf, SparseOutputBuff
         return result;
     }
 
+    // Frames that are written out whole are decoded straight into the guest buffer
+    const u32 frame_pcm = m_codec_info.frameSamples * m_codec_info.channels;
+    const bool is_whole_frame =
+        gapless.current.skip_samples == 0 &&
+        (gapless.init.total_samples == 0 ||
+         gapless.current.total_samples >= m_codec_info.frameSamples);
+    const u8 pcm_size = GetPCMSize(m_format);
+    u8* const direct_output =
+        is_whole_frame ? output.GetContiguous(frame_pcm * pcm_size, pcm_size) : nullptr;
+    u8* const pcm_output = direct_output ? direct_output : m_pcm_buffer.data();
+
     int ret = 0;
     int bytes_used = 0;
     switch (m_format) {
     case AjmFormatEncoding::S16:
-        ret = Atrac9Decode(m_handle, in_buf.data(), reinterpret_cast<s16*>(m_pcm_buffer.data()),
+        ret = Atrac9Decode(m_handle, in_buf.data(), reinterpret_cast<s16*>(pcm_output),
                            &bytes_used, True(m_flags & AjmAt9CodecFlags::NonInterleavedOutput));
         break;
     case AjmFormatEncoding::S32:
-        ret = Atrac9DecodeS32(m_handle, in_buf.data(), reinterpret_cast<s32*>(m_pcm_buffer.data()),
+        ret = Atrac9DecodeS32(m_handle, in_buf.data(), reinterpret_cast<s32*>(pcm_output),
                               &bytes_used, True(m_flags & AjmAt9CodecFlags::NonInterleavedOutput));
         break;
     case AjmFormatEncoding::Float:
-        ret =
-            Atrac9DecodeF32(m_handle, in_buf.data(), reinterpret_cast<float*>(m_pcm_buffer.data()),
-                            &bytes_used, True(m_flags & AjmAt9CodecFlags::NonInterleavedOutput));
+        ret = Atrac9DecodeF32(m_handle, in_buf.data(), reinterpret_cast<float*>(pcm_output),
+                              &bytes_used, True(m_flags & AjmAt9CodecFlags::NonInterleavedOutput));
         break;
     default:
         UNREACHABLE();
@@ -194,18 +204,23 @@ DecoderResult AjmAt9Decoder::ProcessData(std::span<u8>& in_buf, SparseOutputBuff
                              : std::numeric_limits<u32>::max();
 
     size_t pcm_written = 0;
-    switch (m_format) {
-    case AjmFormatEncoding::S16:
-        pcm_written = WriteOutputSamples<s16>(output, skip_samples, max_pcm);
-        break;
-    case AjmFormatEncoding::S32:
-        pcm_written = WriteOutputSamples<s32>(output, skip_samples, max_pcm);
-        break;
-    case AjmFormatEncoding::Float:
-        pcm_written = WriteOutputSamples<float>(output, skip_samples, max_pcm);
-        break;
-    default:
-        UNREACHABLE();
+    if (direct_output) {
+        output.Commit(frame_pcm * pcm_size);
+        pcm_written = frame_pcm;
+    } else {
+        switch (m_format) {
+        case AjmFormatEncoding::S16:
+            pcm_written = WriteOutputSamples<s16>(output, skip_samples, max_pcm);
+            break;
+        case AjmFormatEncoding::S32:
+            pcm_written = WriteOutputSamples<s32>(output, skip_samples, max_pcm);
+            break;
+        case AjmFormatEncoding::Float:
+            pcm_written = WriteOutputSamples<float>(output, skip_samples, max_pcm);
+            break;
+        default:
+            UNREACHABLE();
+        }
     }
 
     result.samples_written = pcm_written / m_codec_info.channels;
@@ -213,7 +213,17 @@ AjmJob AjmJobFromBatchBuffer(u32 instance_id, AjmBatchBuffer batch_buffer) {
         case Identifier::AjmIdentInputRunBuf: {
             auto& buffer = batch_buffer.Consume<AjmChunkBuffer>();
             u8* p_begin = reinterpret_cast<u8*>(buffer.p_address);
-            job.input.buffer.insert(job.input.buffer.end(), p_begin, p_begin + buffer.size);
+            auto& input = job.input;
+            if (input.guest_buffer.empty() && input.buffer.empty()) {
+                // The guest keeps its buffers alive until the batch is done
+                input.guest_buffer = {p_begin, buffer.size};
+                break;
+            }
+            if (input.buffer.empty()) {
+                input.buffer.assign(input.guest_buffer.begin(), input.guest_buffer.end());
+                input.guest_buffer = {};
+            }
+            input.buffer.insert(input.buffer.end(), p_begin, p_begin + buffer.size);
             break;
         }
         case Identifier::AjmIdentInputControlBuf: {
@@ -10,6 +10,7 @@
 #include <boost/container/small_vector.hpp>
 
 #include <atomic>
+#include <chrono>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -26,7 +27,12 @@ struct AjmJob {
         std::optional<AjmSidebandStatisticsEngineParameters> statistics_engine_parameters;
         std::optional<AjmSidebandFormat> format;
         std::optional<AjmSidebandGaplessDecode> gapless_decode;
-        std::vector<u8> buffer;
+        std::span<u8> guest_buffer; ///< Read in place when the input is a single guest buffer
+        std::vector<u8> buffer;     ///< Copy of the input when it is split over several buffers
+
+        std::span<u8> GetData() {
+            return buffer.empty() ? guest_buffer : std::span<u8>{buffer};
+        }
     };
 
     struct Output {
@@ -50,6 +56,9 @@ struct AjmJob {
 
 struct AjmBatch {
     u32 id{};
+    int priority{}; ///< Lower values run first among batches that are ready
+    std::chrono::steady_clock::time_point submit_time;
+    boost::container::small_vector<u32, 4> instance_ids; ///< Distinct instances of the jobs
     std::atomic_bool waiting{};
     std::atomic_bool canceled{};
     std::atomic_bool processed{};
@@ -3,6 +3,7 @@
 
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/polyfill_thread.h"
 #include "common/thread.h"
 #include "core/libraries/ajm/ajm.h"
 #include "core/libraries/ajm/ajm_at9.h"
@@ -12,7 +13,10 @@
 #include "core/libraries/ajm/ajm_instance_statistics.h"
 #include "core/libraries/ajm/ajm_mp3.h"
 #include "core/libraries/error_codes.h"
+#include "core/thread.h"
 
+#include <algorithm>
+#include <chrono>
 #include <span>
 #include <utility>
 
@@ -20,9 +24,15 @@ namespace Libraries::Ajm {
 
 constexpr u32 ORBIS_AJM_WAIT_INFINITE = -1;
 constexpr int INSTANCE_ID_MASK = 0x3FFF;
+constexpr u32 INSTANCE_CODEC_SHIFT = 14;
 
 AjmContext::AjmContext() {
-    worker_thread = std::jthread([this](std::stop_token stop) { this->WorkerThread(stop); });
+    // Batches on different instances run in parallel, many streams can be decoded at once
+    const u32 num_workers = std::clamp(std::thread::hardware_concurrency() / 4, 1U, 4U);
+    workers.reserve(num_workers);
+    for (u32 i = 0; i < num_workers; ++i) {
+        workers.emplace_back([this](std::stop_token stop) { this->WorkerThread(stop); });
+    }
 }
 
 bool AjmContext::IsRegistered(AjmCodecType type) const {
@@ -62,22 +72,71 @@ s32 AjmContext::ModuleRegister(AjmCodecType type) {
 
 void AjmContext::WorkerThread(std::stop_token stop) {
     Common::SetCurrentThreadName("shadPS4:AjmWorker");
+    Core::KeepCurrentThreadOffGuestCores();
     while (!stop.stop_requested()) {
-        auto batch = batch_queue.PopWait(stop);
-        if (batch != nullptr && !batch->canceled) {
+        std::shared_ptr<AjmBatch> batch;
+        {
+            std::unique_lock lock{queue_mutex};
+            Common::CondvarWait(queue_cv, lock, stop,
+                                [&] { return (batch = PopReadyBatch()) != nullptr; });
+            if (batch == nullptr) {
+                break;
+            }
+        }
+        const bool run = !batch->canceled;
+        if (run) {
             bool expected = false;
             batch->processed.compare_exchange_strong(expected, true);
-            ProcessBatch(batch->id, batch->jobs);
+            ProcessBatch(*batch, batch->jobs);
+        }
+        {
+            std::scoped_lock lock{queue_mutex};
+            for (const u32 instance_id : batch->instance_ids) {
+                busy_instances.erase(std::ranges::find(busy_instances, instance_id));
+            }
+        }
+        // Batches waiting on these instances may be ready now
+        queue_cv.notify_all();
+        if (run) {
             batch->finished.release();
         }
     }
 }
 
-void AjmContext::ProcessBatch(u32 id, std::span<AjmJob> jobs) {
+std::shared_ptr<AjmBatch> AjmContext::PopReadyBatch() {
+    boost::container::small_vector<u32, 16> blocked = busy_instances;
+    const auto is_blocked = [&](const AjmBatch& batch) {
+        return std::ranges::any_of(batch.instance_ids, [&](u32 instance_id) {
+            return std::ranges::find(blocked, instance_id) != blocked.end();
+        });
+    };
+    auto best = pending_batches.end();
+    for (auto it = pending_batches.begin(); it != pending_batches.end(); ++it) {
+        const AjmBatch& batch = **it;
+        const bool is_better =
+            best == pending_batches.end() || batch.priority < (*best)->priority;
+        if (is_better && !is_blocked(batch)) {
+            best = it;
+        }
+        // Later batches on the same instances have to wait for this one
+        blocked.insert(blocked.end(), batch.instance_ids.begin(), batch.instance_ids.end());
+    }
+    if (best == pending_batches.end()) {
+        return nullptr;
+    }
+    auto batch = std::move(*best);
+    pending_batches.erase(best);
+    busy_instances.insert(busy_instances.end(), batch->instance_ids.begin(),
+                          batch->instance_ids.end());
+    return batch;
+}
+
+void AjmContext::ProcessBatch(const AjmBatch& batch, std::span<AjmJob> jobs) {
+    const auto wait_time = std::chrono::steady_clock::now() - batch.submit_time;
     // Perform operation requested by control flags.
     for (auto& job : jobs) {
-        LOG_TRACE(Lib_Ajm, "Processing job {} for instance {}. flags = {:#x}", id, job.instance_id,
-                  job.flags.raw);
+        LOG_TRACE(Lib_Ajm, "Processing job {} for instance {}. flags = {:#x}", batch.id,
+                  job.instance_id, job.flags.raw);
 
         if (job.instance_id == AJM_INSTANCE_STATISTICS) {
             AjmInstanceStatistics::Getinstance().ExecuteJob(job);
@@ -90,7 +149,12 @@ void AjmContext::ProcessBatch(u32 id, std::span<AjmJob> jobs) {
                 instance = *p_instance;
             }
 
+            const auto start = std::chrono::steady_clock::now();
             instance->ExecuteJob(job);
+            const auto decode_time = std::chrono::steady_clock::now() - start;
+            AjmInstanceStatistics::Getinstance().RecordJob(
+                static_cast<AjmCodecType>(job.instance_id >> INSTANCE_CODEC_SHIFT), decode_time);
+            instance->RecordJob(decode_time, wait_time);
         }
     }
 }
@@ -148,9 +212,24 @@ int AjmContext::BatchStartBuffer(u8* p_batch, u32 batch_size, const int priority
     }
     *out_batch_id = batch_id.value();
     batch_info->id = *out_batch_id;
+    batch_info->priority = priority;
+    batch_info->submit_time = std::chrono::steady_clock::now();
+    for (const auto& job : batch_info->jobs) {
+        const u32 instance_id = job.instance_id == AJM_INSTANCE_STATISTICS
+                                    ? job.instance_id
+                                    : job.instance_id & INSTANCE_ID_MASK;
+        if (std::ranges::find(batch_info->instance_ids, instance_id) ==
+            batch_info->instance_ids.end()) {
+            batch_info->instance_ids.push_back(instance_id);
+        }
+    }
 
     if (!batch_info->jobs.empty()) {
-        batch_queue.EmplaceWait(batch_info);
+        {
+            std::scoped_lock lock{queue_mutex};
+            pending_batches.push_back(batch_info);
+        }
+        queue_cv.notify_one();
     } else {
         // Empty batches are not submitted to the processor and are marked as finished
         batch_info->finished.release();
@@ -177,7 +256,11 @@ s32 AjmContext::InstanceCreate(AjmCodecType codec_type, AjmInstanceFlags flags,
     if (!opt_index.has_value()) {
         return ORBIS_AJM_ERROR_OUT_OF_RESOURCES;
     }
-    *out_instance = opt_index.value() | (static_cast<u32>(codec_type) << 14);
+    *out_instance = opt_index.value() | (static_cast<u32>(codec_type) << INSTANCE_CODEC_SHIFT);
+    {
+        std::unique_lock lock(instances_mutex);
+        instance_ids.push_back(*out_instance);
+    }
 
     LOG_INFO(Lib_Ajm, "instance = {}", *out_instance);
     return ORBIS_OK;
@@ -188,7 +271,37 @@ s32 AjmContext::InstanceDestroy(u32 instance_id) {
     if (!instances.Destroy(instance_id & INSTANCE_ID_MASK)) {
         return ORBIS_AJM_ERROR_INVALID_INSTANCE;
     }
+    std::erase_if(instance_ids, [&](u32 id) {
+        return (id & INSTANCE_ID_MASK) == (instance_id & INSTANCE_ID_MASK);
+    });
     return ORBIS_OK;
 }
 
+void AjmContext::GetInstanceStats(std::vector<AjmInstanceStats>& out) {
+    const size_t first = out.size();
+    {
+        std::shared_lock lock(instances_mutex);
+        for (const u32 id : instance_ids) {
+            const auto* p_instance = instances.Get(id & INSTANCE_ID_MASK);
+            if (p_instance == nullptr) {
+                continue;
+            }
+            AjmInstanceStats& stats = out.emplace_back();
+            stats.instance_id = id;
+            stats.queued_batches = 0;
+            (*p_instance)->GetStats(stats);
+        }
+    }
+    std::scoped_lock lock{queue_mutex};
+    for (const auto& batch : pending_batches) {
+        for (const u32 instance_id : batch->instance_ids) {
+            for (size_t i = first; i < out.size(); ++i) {
+                if ((out[i].instance_id & INSTANCE_ID_MASK) == instance_id) {
+                    ++out[i].queued_batches;
+                }
+            }
+        }
+    }
+}
+
 } // namespace Libraries::Ajm
@@ -3,7 +3,6 @@
 
 #pragma once
 
-#include "common/bounded_threadsafe_queue.h"
 #include "common/slot_array.h"
 #include "common/types.h"
 #include "core/libraries/ajm/ajm.h"
@@ -11,11 +10,15 @@
 #include "core/libraries/ajm/ajm_instance.h"
 
 #include <array>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <shared_mutex>
 #include <span>
 #include <thread>
 #include <utility>
+#include <vector>
 
 namespace Libraries::Ajm {
 
@@ -33,7 +36,10 @@ public:
                          AjmBatchError* p_batch_error, u32* p_batch_id);
 
     void WorkerThread(std::stop_token stop);
-    void ProcessBatch(u32 id, std::span<AjmJob> jobs);
+    void ProcessBatch(const AjmBatch& batch, std::span<AjmJob> jobs);
+
+    /// Appends the stats of the live instances.
+    void GetInstanceStats(std::vector<AjmInstanceStats>& out);
 
 private:
     static constexpr u32 MaxInstances = 0x2fff;
@@ -42,16 +48,26 @@ private:
 
     [[nodiscard]] bool IsRegistered(AjmCodecType type) const;
 
+    /// Removes the batch to run next from the pending ones and marks its instances busy. Batches
+    /// run in the order of their priority, but never before an earlier batch or while another
+    /// batch on one of their instances is running, so the jobs of each instance keep their order.
+    std::shared_ptr<AjmBatch> PopReadyBatch();
+
     std::array<bool, NumAjmCodecs> registered_codecs{};
 
     std::shared_mutex instances_mutex;
     Common::SlotArray<u32, std::shared_ptr<AjmInstance>, MaxInstances, 1> instances;
+    std::vector<u32> instance_ids; ///< Full ids of the live instances, for the stats
 
     std::shared_mutex batches_mutex;
     Common::SlotArray<u32, std::shared_ptr<AjmBatch>, MaxBatches, 1> batches;
 
-    std::jthread worker_thread{};
-    Common::MPSCQueue<std::shared_ptr<AjmBatch>> batch_queue;
+    std::mutex queue_mutex;
+    std::condition_variable_any queue_cv;
+    std::deque<std::shared_ptr<AjmBatch>> pending_batches;
+    boost::container::small_vector<u32, 16> busy_instances;
+
+    std::vector<std::jthread> workers;
 };
 
 } // namespace Libraries::Ajm
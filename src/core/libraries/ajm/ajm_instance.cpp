@@ -105,13 +105,13 @@ void AjmInstance::ExecuteJob(AjmJob& job) {
         }
     }
 
-    std::span<u8> in_buf(job.input.buffer);
+    std::span<u8> in_buf = job.input.GetData();
     SparseOutputBuffer out_buf(job.output.buffers);
     auto in_size = in_buf.size();
     auto out_size = out_buf.Size();
     u32 frames_decoded = 0;
 
-    if (!job.input.buffer.empty()) {
+    if (!in_buf.empty()) {
         for (;;) {
             if (m_flags.gapless_loop && m_gapless.IsEnd()) {
                 m_gapless.Reset();
@@ -166,6 +166,27 @@ void AjmInstance::ExecuteJob(AjmJob& job) {
     }
 }
 
+void AjmInstance::RecordJob(std::chrono::nanoseconds decode_time,
+                            std::chrono::nanoseconds wait_time) {
+    const u64 decode_ns = decode_time.count();
+    const u64 wait_ns = wait_time.count();
+    m_num_jobs.fetch_add(1, std::memory_order_relaxed);
+    m_decode_ns.fetch_add(decode_ns, std::memory_order_relaxed);
+    if (decode_ns > m_max_decode_ns.load(std::memory_order_relaxed)) {
+        m_max_decode_ns.store(decode_ns, std::memory_order_relaxed);
+    }
+    if (wait_ns > m_max_wait_ns.load(std::memory_order_relaxed)) {
+        m_max_wait_ns.store(wait_ns, std::memory_order_relaxed);
+    }
+}
+
+void AjmInstance::GetStats(AjmInstanceStats& stats) const {
+    stats.num_jobs = m_num_jobs.load(std::memory_order_relaxed);
+    stats.decode_ns = m_decode_ns.load(std::memory_order_relaxed);
+    stats.max_decode_ns = m_max_decode_ns.load(std::memory_order_relaxed);
+    stats.max_wait_ns = m_max_wait_ns.load(std::memory_order_relaxed);
+}
+
 bool AjmInstance::HasEnoughSpace(const SparseOutputBuffer& output) const {
     if (m_gapless.IsEnd()) {
         return true;
@@ -8,6 +8,8 @@
 #include "core/libraries/ajm/ajm.h"
 #include "core/libraries/ajm/ajm_batch.h"
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <optional>
 #include <tuple>
@@ -41,6 +43,23 @@ public:
         return samples_written;
     }
 
+    /// Returns the next size bytes of the output when they are contiguous and aligned, so a
+    /// decoder can write them in place and Commit them instead of going through Write.
+    u8* GetContiguous(size_t size, size_t alignment) const {
+        if (IsEmpty() || m_current->size() < size ||
+            reinterpret_cast<uintptr_t>(m_current->data()) % alignment != 0) {
+            return nullptr;
+        }
+        return m_current->data();
+    }
+
+    void Commit(size_t size) {
+        *m_current = m_current->subspan(size);
+        if (m_current->empty()) {
+            ++m_current;
+        }
+    }
+
     bool IsEmpty() const {
         return m_current == m_chunks.end();
     }
@@ -101,6 +120,11 @@ public:
 
     void ExecuteJob(AjmJob& job);
 
+    /// Adds a job that took decode_time and whose batch waited wait_time before it ran. Jobs of
+    /// an instance never run at the same time, the stats are only read concurrently.
+    void RecordJob(std::chrono::nanoseconds decode_time, std::chrono::nanoseconds wait_time);
+    void GetStats(AjmInstanceStats& stats) const;
+
 private:
     bool HasEnoughSpace(const SparseOutputBuffer& output) const;
     void Reset();
@@ -111,6 +135,11 @@ private:
     AjmSidebandResampleParameters m_resample_parameters{};
     u32 m_total_samples{};
     std::unique_ptr<AjmCodec> m_codec;
+
+    std::atomic<u64> m_num_jobs{};
+    std::atomic<u64> m_decode_ns{};
+    std::atomic<u64> m_max_decode_ns{};
+    std::atomic<u64> m_max_wait_ns{};
 };
 
 } // namespace Libraries::Ajm
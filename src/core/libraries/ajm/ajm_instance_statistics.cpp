@@ -1,6 +1,9 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+
+#include "common/logging/log.h"
 #include "core/libraries/ajm/ajm.h"
 #include "core/libraries/ajm/ajm_instance_statistics.h"
 
@@ -15,9 +18,36 @@ void AjmInstanceStatistics::ExecuteJob(AjmJob& job) {
         }
     }
     if (job.output.p_engine_per_codec) {
-        job.output.p_engine_per_codec->codec_count = 1;
-        job.output.p_engine_per_codec->codec_id[0] = static_cast<u8>(AjmCodecType::At9Dec);
-        job.output.p_engine_per_codec->codec_percentage[0] = 0.01;
+        auto* per_codec = job.output.p_engine_per_codec;
+        std::scoped_lock lock{report_mutex};
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed_ns = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_report).count());
+        last_report = now;
+
+        // Codecs that decoded the longest since the last report, by their share of the time
+        std::array<std::pair<u64, u32>, NumCodecs> busy{};
+        for (u32 codec = 0; codec < NumCodecs; ++codec) {
+            const u64 busy_ns = codec_statistics[codec].busy_ns.load(std::memory_order_relaxed);
+            busy[codec] = {busy_ns - reported_busy_ns[codec], codec};
+            reported_busy_ns[codec] = busy_ns;
+        }
+        std::ranges::sort(busy, std::greater{});
+        per_codec->codec_count = 0;
+        for (const auto& [busy_ns, codec] : busy) {
+            if (busy_ns == 0 || per_codec->codec_count == std::size(per_codec->codec_id)) {
+                break;
+            }
+            const u8 index = per_codec->codec_count++;
+            per_codec->codec_id[index] = static_cast<u8>(codec);
+            per_codec->codec_percentage[index] =
+                elapsed_ns > 0.0 ? std::min(static_cast<float>(busy_ns / elapsed_ns), 1.0f) : 0.0f;
+        }
+        if (per_codec->codec_count == 0) {
+            per_codec->codec_count = 1;
+            per_codec->codec_id[0] = static_cast<u8>(AjmCodecType::At9Dec);
+            per_codec->codec_percentage[0] = 0.01;
+        }
     }
     if (job.output.p_memory) {
         job.output.p_memory->instance_free = 0x400000;
@@ -31,6 +61,21 @@ void AjmInstanceStatistics::ExecuteJob(AjmJob& job) {
 
 void AjmInstanceStatistics::Reset() {}
 
+void AjmInstanceStatistics::RecordJob(AjmCodecType codec, std::chrono::nanoseconds time) {
+    const u32 index = std::to_underlying(codec);
+    if (index >= NumCodecs) {
+        return;
+    }
+    auto& stats = codec_statistics[index];
+    const u64 num_jobs = stats.num_jobs.fetch_add(1, std::memory_order_relaxed) + 1;
+    const u64 busy_ns =
+        stats.busy_ns.fetch_add(time.count(), std::memory_order_relaxed) + time.count();
+    if (num_jobs % 10'000 == 0) {
+        LOG_DEBUG(Lib_Ajm, "Codec {}: {} jobs, {} us per job on average", index, num_jobs,
+                  busy_ns / num_jobs / 1'000);
+    }
+}
+
 AjmInstanceStatistics& AjmInstanceStatistics::Getinstance() {
     static AjmInstanceStatistics instance;
     return instance;
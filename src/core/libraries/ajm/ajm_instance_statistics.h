@@ -3,6 +3,12 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <utility>
+
 #include "core/libraries/ajm/ajm_batch.h"
 
 namespace Libraries::Ajm {
@@ -12,7 +18,25 @@ public:
     void ExecuteJob(AjmJob& job);
     void Reset();
 
+    /// Adds the host time spent on a job of an instance of the codec, from any worker thread.
+    void RecordJob(AjmCodecType codec, std::chrono::nanoseconds time);
+
     static AjmInstanceStatistics& Getinstance();
+
+private:
+    static constexpr u32 NumCodecs = std::to_underlying(AjmCodecType::Max);
+
+    struct CodecStatistics {
+        std::atomic<u64> num_jobs;
+        std::atomic<u64> busy_ns;
+    };
+
+    std::array<CodecStatistics, NumCodecs> codec_statistics{};
+
+    /// Busy time of the codecs as of the last statistics job, which reports the share since then
+    std::mutex report_mutex;
+    std::array<u64, NumCodecs> reported_busy_ns{};
+    std::chrono::steady_clock::time_point last_report{std::chrono::steady_clock::now()};
 };
 
 } // namespace Libraries::Ajm
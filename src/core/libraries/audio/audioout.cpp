@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <cstdlib>
 #include <memory>
 #include <mutex>
 #include <stop_token>
@@ -10,6 +12,7 @@
 #include "common/assert.h"
 #include "common/config.h"
 #include "common/logging/log.h"
+#include "common/polyfill_thread.h"
 #include "common/thread.h"
 #include "core/libraries/audio/audioout.h"
 #include "core/libraries/audio/audioout_backend.h"
@@ -297,20 +300,30 @@ static void AudioOutputThread(PortOut* port, const std::stop_token& stop) {
 
     Common::AccurateTimer timer(
         std::chrono::nanoseconds(1000000000ULL * port->buffer_frames / port->sample_rate));
+    const bool paced_by_device = port->impl && port->impl->BlocksOnOutput();
     while (true) {
         timer.Start();
         {
             std::unique_lock lock{port->mutex};
+            if (paced_by_device) {
+                // Output blocks for the device, only wait for the guest here
+                Common::CondvarWait(port->output_cv, lock, stop,
+                                    [&] { return port->output_ready; });
+            }
             if (port->output_ready) {
                 port->impl->Output(port->output_buffer);
                 port->output_ready = false;
+            } else if (port->stats.num_submits != 0) {
+                ++port->stats.missed_periods;
             }
         }
-        port->output_cv.notify_one();
+        port->output_cv.notify_all();
         if (stop.stop_requested()) {
             break;
         }
-        timer.End();
+        if (!paced_by_device) {
+            timer.End();
+        }
     }
 }
 
@@ -374,6 +387,7 @@ s32 PS4_SYSV_ABI sceAudioOutOpen(UserService::OrbisUserServiceUserId user_id,
         port->sample_rate = sample_rate;
         port->buffer_frames = length;
         port->volume.fill(SCE_AUDIO_OUT_VOLUME_0DB);
+        port->stats = {};
 
         port->impl = audio->Open(*port);
 
@@ -409,13 +423,62 @@ s32 PS4_SYSV_ABI sceAudioOutOutput(s32 handle, void* ptr) {
         if (ptr != nullptr && port.IsOpen()) {
             std::memcpy(port.output_buffer, ptr, port.BufferSize());
             port.output_ready = true;
-            port.last_output_time = Kernel::sceKernelGetProcessTime();
+            const u64 now = Kernel::sceKernelGetProcessTime();
+            port.stats.RecordSubmit(now, port.last_output_time, port.buffer_frames,
+                                    port.sample_rate);
+            port.last_output_time = now;
             samples_sent = port.buffer_frames * port.format_info.num_channels;
         }
     }
+    port.output_cv.notify_all();
     return samples_sent;
 }
 
+void PortStats::RecordSubmit(u64 now, u64 last_output_time, u32 buffer_frames,
+                             u32 sample_rate) {
+    if (num_submits++ == 0) {
+        first_output_time = now;
+    } else {
+        const s64 period_us = s64{buffer_frames} * 1'000'000 / sample_rate;
+        const u64 jitter_us = std::abs(static_cast<s64>(now - last_output_time) - period_us);
+        const auto bucket = std::ranges::upper_bound(JitterBoundsUs, jitter_us);
+        ++submit_jitter[std::distance(JitterBoundsUs.begin(), bucket)];
+    }
+    frames_submitted += buffer_frames;
+}
+
+s64 PortStats::DriftUs(u64 last_output_time, u32 buffer_frames, u32 sample_rate) const {
+    if (num_submits == 0) {
+        return 0;
+    }
+    const u64 frames_before = frames_submitted - buffer_frames;
+    return static_cast<s64>(last_output_time - first_output_time) -
+           static_cast<s64>(frames_before * 1'000'000 / sample_rate);
+}
+
+std::vector<PortStatsInfo> GetPortStats() {
+    std::vector<PortStatsInfo> infos;
+    for (size_t i = 0; i < ports_out.size(); ++i) {
+        auto& port = ports_out[i];
+        std::scoped_lock lock{port.mutex};
+        if (!port.IsOpen()) {
+            continue;
+        }
+        infos.push_back({
+            .handle = static_cast<s32>(i + 1),
+            .type = port.type,
+            .buffer_frames = port.buffer_frames,
+            .sample_rate = port.sample_rate,
+            .stats = port.stats,
+            .drift_us =
+                port.stats.DriftUs(port.last_output_time, port.buffer_frames, port.sample_rate),
+            .queued_us = port.impl->GetQueuedUs(),
+            .underruns = port.impl->GetUnderruns(),
+        });
+    }
+    return infos;
+}
+
 int PS4_SYSV_ABI sceAudioOutOutputs(OrbisAudioOutOutputParam* param, u32 num) {
     int ret = 0;
     for (u32 i = 0; i < num; i++) {
@@ -3,9 +3,11 @@
 
 #pragma once
 
+#include <array>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include "common/bit_field.h"
 #include "core/libraries/kernel/threads.h"
@@ -83,6 +85,36 @@ struct AudioFormatInfo {
     }
 };
 
+/// Telemetry of the submissions of the game to a port since it was opened.
+struct PortStats {
+    /// Bounds of how far the intervals between submissions stray from the buffer period
+    static constexpr std::array<u32, 5> JitterBoundsUs = {250, 1000, 2000, 5000, 10000};
+    std::array<u32, JitterBoundsUs.size() + 1> submit_jitter{};
+    u64 num_submits{};
+    u32 missed_periods{}; ///< Times the output thread had no buffer of the game to play
+    u64 first_output_time{};
+    u64 frames_submitted{};
+
+    /// Adds a submission at the process time now, in microseconds.
+    void RecordSubmit(u64 now, u64 last_output_time, u32 buffer_frames, u32 sample_rate);
+
+    /// Process time between the first and the last submission less the audio submitted before
+    /// the last one. Positive when the game falls behind the nominal rate of the port.
+    [[nodiscard]] s64 DriftUs(u64 last_output_time, u32 buffer_frames, u32 sample_rate) const;
+};
+
+/// Snapshot of the stats of an open port, for the debug overlay.
+struct PortStatsInfo {
+    s32 handle;
+    OrbisAudioOutPort type;
+    u32 buffer_frames;
+    u32 sample_rate;
+    PortStats stats;
+    s64 drift_us;
+    u32 queued_us; ///< Audio the backend holds ahead of the device
+    u32 underruns; ///< Times the device ran out of audio of the port
+};
+
 struct PortOut {
     std::mutex mutex;
     std::unique_ptr<PortBackend> impl{};
@@ -98,6 +130,7 @@ struct PortOut {
     u32 buffer_frames;
     u64 last_output_time;
     std::array<s32, 8> volume;
+    PortStats stats;
 
     [[nodiscard]] bool IsOpen() const {
         return impl != nullptr;
@@ -183,5 +216,8 @@ int PS4_SYSV_ABI sceAudioOutSparkControlSetEqCoef();
 int PS4_SYSV_ABI sceAudioOutSetSystemDebugState();
 
 void AdjustVol();
+/// Returns the stats of the open ports.
+std::vector<PortStatsInfo> GetPortStats();
+
 void RegisterLib(Core::Loader::SymbolsResolver* sym);
 } // namespace Libraries::AudioOut
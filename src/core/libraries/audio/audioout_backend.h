@@ -12,10 +12,26 @@ public:
     virtual ~PortBackend() = default;
 
     /// Guaranteed to be called in intervals of at least port buffer time,
-    /// with size equal to port buffer size.
+    /// with size equal to port buffer size, unless BlocksOnOutput.
     virtual void Output(void* ptr) = 0;
 
+    /// Returns true if Output blocks until the device has room for the buffer, so the device
+    /// paces the port instead of a timer.
+    virtual bool BlocksOnOutput() const {
+        return false;
+    }
+
     virtual void SetVolume(const std::array<int, 8>& ch_volumes) = 0;
+
+    /// Returns the time of audio queued ahead of the device, for the port stats.
+    virtual u32 GetQueuedUs() const {
+        return 0;
+    }
+
+    /// Returns the times the device ran out of audio of the port.
+    virtual u32 GetUnderruns() const {
+        return 0;
+    }
 };
 
 class AudioOutBackend {
@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include "common/arch.h"
+#include "common/assert.h"
+#include "core/libraries/audio/audioout.h"
+#include "core/libraries/audio/audioout_convert.h"
+
+#ifdef ARCH_X86_64
+#include <emmintrin.h>
+#endif
+
+namespace Libraries::AudioOut {
+
+namespace {
+
+constexpr float Surround = 0.70710678f; // -3 dB
+
+/// Downmix coefficients in the order of AudioFormatInfo::channel_layout:
+/// FL, FR, FC, LFE, BL, BR, SL, SR
+constexpr std::array<float, 8> LeftCoefficients = {1.0f,     0.0f, Surround, 0.0f,
+                                                   Surround, 0.0f, Surround, 0.0f};
+constexpr std::array<float, 8> RightCoefficients = {0.0f, 1.0f,     Surround, 0.0f,
+                                                    0.0f, Surround, 0.0f,     Surround};
+
+constexpr float S16Scale = 1.0f / 32768.0f;
+
+void DownmixMono(const float* input, const StereoDownmix& downmix, size_t num_frames,
+                 float* output) {
+    size_t frame = 0;
+#ifdef ARCH_X86_64
+    const __m128 gains = _mm_setr_ps(downmix.left[0], downmix.right[0], downmix.left[0],
+                                     downmix.right[0]);
+    for (; frame + 4 <= num_frames; frame += 4) {
+        const __m128 samples = _mm_loadu_ps(input + frame);
+        _mm_storeu_ps(output + frame * 2, _mm_mul_ps(_mm_unpacklo_ps(samples, samples), gains));
+        _mm_storeu_ps(output + frame * 2 + 4,
+                      _mm_mul_ps(_mm_unpackhi_ps(samples, samples), gains));
+    }
+#endif
+    for (; frame < num_frames; ++frame) {
+        output[frame * 2] = input[frame] * downmix.left[0];
+        output[frame * 2 + 1] = input[frame] * downmix.right[0];
+    }
+}
+
+void DownmixStereo(const float* input, const StereoDownmix& downmix, size_t num_frames,
+                   float* output) {
+    size_t frame = 0;
+#ifdef ARCH_X86_64
+    // Each channel keeps its own side scaled and picks up the crossfeed of the other one
+    const __m128 direct = _mm_setr_ps(downmix.left[0], downmix.right[1], downmix.left[0],
+                                      downmix.right[1]);
+    const __m128 cross = _mm_setr_ps(downmix.left[1], downmix.right[0], downmix.left[1],
+                                     downmix.right[0]);
+    for (; frame + 2 <= num_frames; frame += 2) {
+        const __m128 samples = _mm_loadu_ps(input + frame * 2);
+        const __m128 swapped = _mm_shuffle_ps(samples, samples, _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_ps(output + frame * 2, _mm_add_ps(_mm_mul_ps(samples, direct),
+                                                     _mm_mul_ps(swapped, cross)));
+    }
+#endif
+    for (; frame < num_frames; ++frame) {
+        const float l = input[frame * 2];
+        const float r = input[frame * 2 + 1];
+        output[frame * 2] = l * downmix.left[0] + r * downmix.left[1];
+        output[frame * 2 + 1] = l * downmix.right[0] + r * downmix.right[1];
+    }
+}
+
+void Downmix8Channel(const float* input, const StereoDownmix& downmix, size_t num_frames,
+                     float* output) {
+    size_t frame = 0;
+#ifdef ARCH_X86_64
+    const __m128 left_lo = _mm_loadu_ps(downmix.left.data());
+    const __m128 left_hi = _mm_loadu_ps(downmix.left.data() + 4);
+    const __m128 right_lo = _mm_loadu_ps(downmix.right.data());
+    const __m128 right_hi = _mm_loadu_ps(downmix.right.data() + 4);
+    for (; frame < num_frames; ++frame) {
+        const __m128 lo = _mm_loadu_ps(input + frame * 8);
+        const __m128 hi = _mm_loadu_ps(input + frame * 8 + 4);
+        const __m128 l = _mm_add_ps(_mm_mul_ps(lo, left_lo), _mm_mul_ps(hi, left_hi));
+        const __m128 r = _mm_add_ps(_mm_mul_ps(lo, right_lo), _mm_mul_ps(hi, right_hi));
+        // Horizontal sums of both, the low two lanes end up as l0+l1+l2+l3, r0+r1+r2+r3
+        const __m128 pairs = _mm_add_ps(_mm_unpacklo_ps(l, r), _mm_unpackhi_ps(l, r));
+        const __m128 sums = _mm_add_ps(pairs, _mm_movehl_ps(pairs, pairs));
+        _mm_storel_pi(reinterpret_cast<__m64*>(output + frame * 2), sums);
+    }
+#endif
+    for (; frame < num_frames; ++frame) {
+        float l = 0.0f;
+        float r = 0.0f;
+        for (u32 ch = 0; ch < 8; ++ch) {
+            l += input[frame * 8 + ch] * downmix.left[ch];
+            r += input[frame * 8 + ch] * downmix.right[ch];
+        }
+        output[frame * 2] = l;
+        output[frame * 2 + 1] = r;
+    }
+}
+
+} // Anonymous namespace
+
+StereoDownmix MakeStereoDownmix(const AudioFormatInfo& format,
+                                const std::array<int, 8>& ch_volumes, float master_gain) {
+    StereoDownmix downmix{};
+    const auto gain = [&](u32 ch) {
+        return static_cast<float>(ch_volumes[ch]) / SCE_AUDIO_OUT_VOLUME_0DB * master_gain;
+    };
+    if (format.num_channels == 1) {
+        downmix.left[0] = downmix.right[0] = gain(0);
+        return downmix;
+    }
+    for (u32 position = 0; position < format.num_channels; ++position) {
+        const u32 ch = static_cast<u32>(format.channel_layout[position]);
+        downmix.left[ch] = LeftCoefficients[position] * gain(ch);
+        downmix.right[ch] = RightCoefficients[position] * gain(ch);
+    }
+    return downmix;
+}
+
+void ConvertS16ToF32(const s16* input, float* output, size_t num_samples) {
+    size_t i = 0;
+#ifdef ARCH_X86_64
+    const __m128 scale = _mm_set1_ps(S16Scale);
+    for (; i + 8 <= num_samples; i += 8) {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        // Sign extend by moving each sample to the top half and shifting it back down
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+#endif
+    for (; i < num_samples; ++i) {
+        output[i] = static_cast<float>(input[i]) * S16Scale;
+    }
+}
+
+void DownmixToStereo(const float* input, u32 num_channels, const StereoDownmix& downmix,
+                     size_t num_frames, float* output) {
+    switch (num_channels) {
+    case 1:
+        DownmixMono(input, downmix, num_frames, output);
+        break;
+    case 2:
+        DownmixStereo(input, downmix, num_frames, output);
+        break;
+    case 8:
+        Downmix8Channel(input, downmix, num_frames, output);
+        break;
+    default:
+        UNREACHABLE_MSG("Unsupported channel count {}", num_channels);
+    }
+}
+
+void MixSamples(const float* input, float* mix, size_t num_samples) {
+    size_t i = 0;
+#ifdef ARCH_X86_64
+    for (; i + 4 <= num_samples; i += 4) {
+        _mm_storeu_ps(mix + i, _mm_add_ps(_mm_loadu_ps(mix + i), _mm_loadu_ps(input + i)));
+    }
+#endif
+    for (; i < num_samples; ++i) {
+        mix[i] += input[i];
+    }
+}
+
+void PanTo8Channel(const float* input, const std::array<float, 8>& gains, size_t num_frames,
+                   float* mix) {
+    size_t frame = 0;
+#ifdef ARCH_X86_64
+    const __m128 gains_lo = _mm_loadu_ps(gains.data());
+    const __m128 gains_hi = _mm_loadu_ps(gains.data() + 4);
+    for (; frame < num_frames; ++frame) {
+        const __m128 sample = _mm_set1_ps(input[frame]);
+        float* out = mix + frame * 8;
+        _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_mul_ps(sample, gains_lo)));
+        _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_mul_ps(sample, gains_hi)));
+    }
+#endif
+    for (; frame < num_frames; ++frame) {
+        for (u32 ch = 0; ch < 8; ++ch) {
+            mix[frame * 8 + ch] += input[frame] * gains[ch];
+        }
+    }
+}
+
+void ClampSamples(float* samples, size_t num_samples) {
+    size_t i = 0;
+#ifdef ARCH_X86_64
+    const __m128 min = _mm_set1_ps(-1.0f);
+    const __m128 max = _mm_set1_ps(1.0f);
+    for (; i + 4 <= num_samples; i += 4) {
+        _mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(samples + i), min), max));
+    }
+#endif
+    for (; i < num_samples; ++i) {
+        samples[i] = std::clamp(samples[i], -1.0f, 1.0f);
+    }
+}
+
+} // namespace Libraries::AudioOut
@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/types.h"
+
+namespace Libraries::AudioOut {
+
+struct AudioFormatInfo;
+
+/// Gains folding each channel of a port frame into the left and right channels of a stereo
+/// frame, indexed by the channel order of the port.
+struct StereoDownmix {
+    std::array<float, 8> left{};
+    std::array<float, 8> right{};
+};
+
+/// Builds the downmix of a port format with the port channel volumes and a master gain applied.
+/// Surround channels are folded in at -3 dB and LFE is dropped.
+[[nodiscard]] StereoDownmix MakeStereoDownmix(const AudioFormatInfo& format,
+                                              const std::array<int, 8>& ch_volumes,
+                                              float master_gain);
+
+/// Converts signed 16-bit samples to floats in [-1, 1).
+void ConvertS16ToF32(const s16* input, float* output, size_t num_samples);
+
+/// Downmixes interleaved float frames of 1, 2 or 8 channels to interleaved stereo frames.
+void DownmixToStereo(const float* input, u32 num_channels, const StereoDownmix& downmix,
+                     size_t num_frames, float* output);
+
+/// Adds interleaved samples to a mix.
+void MixSamples(const float* input, float* mix, size_t num_samples);
+
+/// Adds mono samples to interleaved 8 channel frames, scaled by a gain per channel.
+void PanTo8Channel(const float* input, const std::array<float, 8>& gains, size_t num_frames,
+                   float* mix);
+
+/// Clamps mixed samples to [-1, 1].
+void ClampSamples(float* samples, size_t num_samples);
+
+} // namespace Libraries::AudioOut
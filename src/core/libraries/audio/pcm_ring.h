@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "common/types.h"
+
+namespace Libraries::AudioOut {
+
+/// Lock-free ring of PCM bytes between a single writer and a single reader, one of them being
+/// the device callback. Waiting is only ever done by the side that isn't the callback.
+class PcmRing {
+public:
+    explicit PcmRing(size_t min_capacity)
+        : buffer(std::bit_ceil(min_capacity)), mask{buffer.size() - 1} {}
+
+    size_t Available() const {
+        return write_pos.load(std::memory_order_acquire) - read_pos.load(std::memory_order_acquire);
+    }
+
+    void Write(const u8* data, size_t size) {
+        const u64 pos = write_pos.load(std::memory_order_relaxed);
+        const size_t offset = pos & mask;
+        const size_t head = std::min(size, buffer.size() - offset);
+        std::memcpy(buffer.data() + offset, data, head);
+        std::memcpy(buffer.data(), data + head, size - head);
+        write_pos.store(pos + size, std::memory_order_release);
+    }
+
+    size_t Read(u8* data, size_t size) {
+        const u64 pos = read_pos.load(std::memory_order_relaxed);
+        size = std::min<size_t>(size, write_pos.load(std::memory_order_acquire) - pos);
+        const size_t offset = pos & mask;
+        const size_t head = std::min(size, buffer.size() - offset);
+        std::memcpy(data, buffer.data() + offset, head);
+        std::memcpy(data + head, buffer.data(), size - head);
+        read_pos.store(pos + size, std::memory_order_release);
+        return size;
+    }
+
+    /// Waits until size more bytes keep the ring at or below limit. Returns false on timeout.
+    bool WaitForSpace(size_t size, size_t limit, std::chrono::milliseconds timeout) {
+        std::unique_lock lock{wait_mutex};
+        return wait_cv.wait_for(lock, timeout, [&] { return Available() + size <= limit; });
+    }
+
+    /// Wakes up the writer after a read.
+    void NotifySpace() {
+        { std::scoped_lock lock{wait_mutex}; }
+        wait_cv.notify_one();
+    }
+
+    /// Waits until at least size bytes can be read. Returns false on timeout.
+    bool WaitForData(size_t size, std::chrono::microseconds timeout) {
+        std::unique_lock lock{wait_mutex};
+        return wait_cv.wait_for(lock, timeout, [&] { return Available() >= size; });
+    }
+
+    /// Wakes up the reader after a write.
+    void NotifyData() {
+        { std::scoped_lock lock{wait_mutex}; }
+        wait_cv.notify_one();
+    }
+
+    [[nodiscard]] size_t Capacity() const {
+        return buffer.size();
+    }
+
+private:
+    std::vector<u8> buffer;
+    size_t mask;
+    std::mutex wait_mutex;
+    std::condition_variable wait_cv;
+    alignas(64) std::atomic<u64> write_pos{};
+    alignas(64) std::atomic<u64> read_pos{};
+};
+
+} // namespace Libraries::AudioOut
@@ -2,83 +2,114 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 #include <SDL3/SDL_audio.h>
 #include <SDL3/SDL_hints.h>
 
 #include "common/config.h"
 #include "common/logging/log.h"
+#include "core/debug_state.h"
 #include "core/libraries/audio/audioout.h"
 #include "core/libraries/audio/audioout_backend.h"
+#include "core/libraries/audio/audioout_convert.h"
+#include "core/libraries/audio/pcm_ring.h"
 
 #define SDL_INVALID_AUDIODEVICEID 0 // Defined in SDL_audio.h but not made a macro
 namespace Libraries::AudioOut {
 
-class SDLPortBackend : public PortBackend {
-public:
-    explicit SDLPortBackend(const PortOut& port)
-        : frame_size(port.format_info.FrameSize()), guest_buffer_size(port.BufferSize()) {
-        const SDL_AudioSpec fmt = {
-            .format = port.format_info.is_float ? SDL_AUDIO_F32LE : SDL_AUDIO_S16LE,
-            .channels = port.format_info.num_channels,
-            .freq = static_cast<int>(port.sample_rate),
-        };
-
-        // Determine port type
-        std::string port_name = port.type == OrbisAudioOutPort::PadSpk
-                                    ? Config::getPadSpkOutputDevice()
-                                    : Config::getMainOutputDevice();
-        SDL_AudioDeviceID dev_id = SDL_INVALID_AUDIODEVICEID;
-        if (port_name == "None") {
-            stream = nullptr;
-            return;
-        } else if (port_name == "Default Device") {
-            dev_id = SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK;
-        } else {
-            try {
-                SDL_AudioDeviceID* dev_array = SDL_GetAudioPlaybackDevices(nullptr);
-                for (; dev_array != 0;) {
-                    std::string dev_name(SDL_GetAudioDeviceName(*dev_array));
-                    if (dev_name == port_name) {
-                        dev_id = *dev_array;
-                        break;
-                    } else {
-                        dev_array++;
-                    }
-                }
-                if (dev_id == SDL_INVALID_AUDIODEVICEID) {
-                    LOG_WARNING(Lib_AudioOut, "Audio device not found: {}", port_name);
-                    dev_id = SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK;
+/// Opens a stream to the named playback device, or returns nullptr if output is disabled or
+/// fails. With a callback the device pulls the audio, otherwise it is queued.
+static SDL_AudioStream* OpenDeviceStream(const std::string& port_name, const SDL_AudioSpec& fmt,
+                                         const int* channel_map, SDL_AudioStreamCallback callback,
+                                         void* userdata) {
+    SDL_AudioDeviceID dev_id = SDL_INVALID_AUDIODEVICEID;
+    if (port_name == "None") {
+        return nullptr;
+    } else if (port_name == "Default Device") {
+        dev_id = SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK;
+    } else {
+        try {
+            SDL_AudioDeviceID* dev_array = SDL_GetAudioPlaybackDevices(nullptr);
+            for (; dev_array != 0;) {
+                std::string dev_name(SDL_GetAudioDeviceName(*dev_array));
+                if (dev_name == port_name) {
+                    dev_id = *dev_array;
+                    break;
+                } else {
+                    dev_array++;
                 }
-            } catch (const std::exception& e) {
-                LOG_ERROR(Lib_AudioOut, "Invalid audio output device: {}", port_name);
-                stream = nullptr;
-                return;
             }
+            if (dev_id == SDL_INVALID_AUDIODEVICEID) {
+                LOG_WARNING(Lib_AudioOut, "Audio device not found: {}", port_name);
+                dev_id = SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK;
+            }
+        } catch (const std::exception& e) {
+            LOG_ERROR(Lib_AudioOut, "Invalid audio output device: {}", port_name);
+            return nullptr;
         }
+    }
 
-        // Open the audio stream
-        stream = SDL_OpenAudioDeviceStream(dev_id, &fmt, nullptr, nullptr);
-        if (stream == nullptr) {
-            LOG_ERROR(Lib_AudioOut, "Failed to create SDL audio stream: {}", SDL_GetError());
-            return;
-        }
-        CalculateQueueThreshold();
-        if (!SDL_SetAudioStreamInputChannelMap(stream, port.format_info.channel_layout.data(),
-                                               port.format_info.num_channels)) {
-            LOG_ERROR(Lib_AudioOut, "Failed to configure SDL audio stream channel map: {}",
-                      SDL_GetError());
-            SDL_DestroyAudioStream(stream);
-            stream = nullptr;
-            return;
-        }
-        if (!SDL_ResumeAudioStreamDevice(stream)) {
-            LOG_ERROR(Lib_AudioOut, "Failed to resume SDL audio stream: {}", SDL_GetError());
-            SDL_DestroyAudioStream(stream);
-            stream = nullptr;
-            return;
+    // Open the audio stream
+    SDL_AudioStream* stream = SDL_OpenAudioDeviceStream(dev_id, &fmt, callback, userdata);
+    if (stream == nullptr) {
+        LOG_ERROR(Lib_AudioOut, "Failed to create SDL audio stream: {}", SDL_GetError());
+        return nullptr;
+    }
+    if (channel_map && !SDL_SetAudioStreamInputChannelMap(stream, channel_map, fmt.channels)) {
+        LOG_ERROR(Lib_AudioOut, "Failed to configure SDL audio stream channel map: {}",
+                  SDL_GetError());
+        SDL_DestroyAudioStream(stream);
+        return nullptr;
+    }
+    if (!SDL_ResumeAudioStreamDevice(stream)) {
+        LOG_ERROR(Lib_AudioOut, "Failed to resume SDL audio stream: {}", SDL_GetError());
+        SDL_DestroyAudioStream(stream);
+        return nullptr;
+    }
+    SDL_SetAudioStreamGain(stream, Config::getVolumeSlider() / 100.0f);
+    return stream;
+}
+
+static std::string GetPortDeviceName(const PortOut& port) {
+    return port.type == OrbisAudioOutPort::PadSpk ? Config::getPadSpkOutputDevice()
+                                                  : Config::getMainOutputDevice();
+}
+
+/// Opens a stream in the format of the port to the playback device configured for it.
+static SDL_AudioStream* OpenPortStream(const PortOut& port, SDL_AudioStreamCallback callback,
+                                       void* userdata) {
+    const SDL_AudioSpec fmt = {
+        .format = port.format_info.is_float ? SDL_AUDIO_F32LE : SDL_AUDIO_S16LE,
+        .channels = port.format_info.num_channels,
+        .freq = static_cast<int>(port.sample_rate),
+    };
+    return OpenDeviceStream(GetPortDeviceName(port), fmt, port.format_info.channel_layout.data(),
+                            callback, userdata);
+}
+
+static void SetPortStreamVolume(SDL_AudioStream* stream, const std::array<int, 8>& ch_volumes) {
+    // SDL does not have per-channel volumes, for now just take the maximum of the channels.
+    const auto vol = *std::ranges::max_element(ch_volumes);
+    if (!SDL_SetAudioStreamGain(stream, static_cast<float>(vol) / SCE_AUDIO_OUT_VOLUME_0DB *
+                                            Config::getVolumeSlider() / 100.0f)) {
+        LOG_WARNING(Lib_AudioOut, "Failed to change SDL audio stream volume: {}", SDL_GetError());
+    }
+}
+
+class SDLPortBackend : public PortBackend {
+public:
+    explicit SDLPortBackend(const PortOut& port)
+        : frame_size(port.format_info.FrameSize()), guest_buffer_size(port.BufferSize()),
+          bytes_per_second(port.sample_rate * frame_size) {
+        stream = OpenPortStream(port, nullptr, nullptr);
+        if (stream != nullptr) {
+            CalculateQueueThreshold();
         }
-        SDL_SetAudioStreamGain(stream, Config::getVolumeSlider() / 100.0f);
     }
 
     ~SDLPortBackend() override {
@@ -112,13 +143,15 @@ public:
         if (!stream) {
             return;
         }
-        // SDL does not have per-channel volumes, for now just take the maximum of the channels.
-        const auto vol = *std::ranges::max_element(ch_volumes);
-        if (!SDL_SetAudioStreamGain(stream, static_cast<float>(vol) / SCE_AUDIO_OUT_VOLUME_0DB *
-                                                Config::getVolumeSlider() / 100.0f)) {
-            LOG_WARNING(Lib_AudioOut, "Failed to change SDL audio stream volume: {}",
-                        SDL_GetError());
+        SetPortStreamVolume(stream, ch_volumes);
+    }
+
+    u32 GetQueuedUs() const override {
+        if (!stream) {
+            return 0;
         }
+        const int queued = std::max(SDL_GetAudioStreamQueued(stream), 0);
+        return static_cast<u32>(u64(queued) * 1'000'000 / bytes_per_second);
     }
 
 private:
@@ -144,12 +177,309 @@ private:
 
     u32 frame_size;
     u32 guest_buffer_size;
+    u32 bytes_per_second;
     u32 host_buffer_size{};
     u32 queue_threshold{};
     SDL_AudioStream* stream{};
 };
 
+/// Time after which a blocked port gives up on a device that stopped pulling audio.
+constexpr std::chrono::milliseconds StallTimeout{500};
+
+/// Backend the device pulls audio from, through a ring that holds at most the latency target.
+/// Output blocks until the buffer fits, so the port is paced by the device clock and the latency
+/// stays at the target instead of depending on what the SDL stream queues up.
+class SDLRingPortBackend : public PortBackend {
+public:
+    explicit SDLRingPortBackend(const PortOut& port, u32 latency_target_ms)
+        : guest_buffer_size{port.BufferSize()},
+          bytes_per_second{port.sample_rate * port.format_info.FrameSize()},
+          latency_target{std::max<size_t>(u64{bytes_per_second} * latency_target_ms / 1000,
+                                          guest_buffer_size * 2)},
+          ring{latency_target + guest_buffer_size}, scratch(latency_target) {
+        stream = OpenPortStream(port, &DeviceCallback, this);
+        if (stream != nullptr) {
+            LOG_INFO(Lib_AudioOut, "Audio latency target: {} bytes ({} ms)", latency_target,
+                     u64{latency_target} * 1000 / bytes_per_second);
+        }
+    }
+
+    ~SDLRingPortBackend() override {
+        if (!stream) {
+            return;
+        }
+        // Stops the device callback before the ring goes away
+        SDL_DestroyAudioStream(stream);
+        stream = nullptr;
+    }
+
+    void Output(void* ptr) override {
+        if (!stream) {
+            return;
+        }
+        // A stalled device, during a device change for example, drops the buffer instead
+        if (!ring.WaitForSpace(guest_buffer_size, latency_target, StallTimeout)) {
+            LOG_WARNING(Lib_AudioOut, "Audio device stalled, dropping {} bytes", guest_buffer_size);
+            return;
+        }
+        ring.Write(static_cast<const u8*>(ptr), guest_buffer_size);
+    }
+
+    bool BlocksOnOutput() const override {
+        return stream != nullptr;
+    }
+
+    void SetVolume(const std::array<int, 8>& ch_volumes) override {
+        if (!stream) {
+            return;
+        }
+        SetPortStreamVolume(stream, ch_volumes);
+    }
+
+    u32 GetQueuedUs() const override {
+        return static_cast<u32>(u64{ring.Available()} * 1'000'000 / bytes_per_second);
+    }
+
+    u32 GetUnderruns() const override {
+        return underruns.load(std::memory_order_relaxed);
+    }
+
+private:
+    static void SDLCALL DeviceCallback(void* userdata, SDL_AudioStream* stream,
+                                       int additional_amount, int total_amount) {
+        static_cast<SDLRingPortBackend*>(userdata)->Fill(stream, additional_amount);
+    }
+
+    void Fill(SDL_AudioStream* device_stream, int amount) {
+        if (amount <= 0) {
+            return;
+        }
+        const size_t size = static_cast<size_t>(amount);
+        if (scratch.size() < size) {
+            scratch.resize(size);
+        }
+        const size_t read = ring.Read(scratch.data(), size);
+        if (read < size) {
+            // Starving after playing is an underrun, staying silent while the guest sends nothing
+            // is not
+            if (read != 0 || is_playing) {
+                ++DebugState.audio_underruns;
+                underruns.fetch_add(1, std::memory_order_relaxed);
+            }
+            std::memset(scratch.data() + read, 0, size - read);
+        }
+        is_playing = read != 0;
+        SDL_PutAudioStreamData(device_stream, scratch.data(), amount);
+        DebugState.audio_latency_us.store(
+            static_cast<u32>(u64{ring.Available()} * 1'000'000 / bytes_per_second),
+            std::memory_order_relaxed);
+        ring.NotifySpace();
+    }
+
+    u32 guest_buffer_size;
+    u32 bytes_per_second;
+    size_t latency_target;
+    PcmRing ring;
+    std::vector<u8> scratch; ///< Only touched by the device callback
+    bool is_playing{};
+    std::atomic<u32> underruns{};
+    SDL_AudioStream* stream{};
+};
+
+class SDLMixedPortBackend;
+
+/// Stereo float stream of the main output device the mixed ports are summed into. Shared by the
+/// ports while any of them is open, so they cost the host a single stream and device wakeup.
+class SDLPortMixer {
+public:
+    static constexpr u32 SampleRate = 48000;
+    static constexpr u32 FrameSize = sizeof(float) * 2;
+
+    SDLPortMixer() {
+        const SDL_AudioSpec fmt = {
+            .format = SDL_AUDIO_F32LE,
+            .channels = 2,
+            .freq = static_cast<int>(SampleRate),
+        };
+        stream = OpenDeviceStream(Config::getMainOutputDevice(), fmt, nullptr, &DeviceCallback,
+                                  this);
+        if (stream != nullptr) {
+            // Volumes are part of the downmix of every port
+            SDL_SetAudioStreamGain(stream, 1.0f);
+        }
+    }
+
+    ~SDLPortMixer() {
+        if (stream) {
+            SDL_DestroyAudioStream(stream);
+        }
+    }
+
+    SDLPortMixer(const SDLPortMixer&) = delete;
+    SDLPortMixer& operator=(const SDLPortMixer&) = delete;
+
+    /// Returns the mixer of the open ports, opening it for the first one.
+    static std::shared_ptr<SDLPortMixer> Acquire() {
+        static std::mutex mutex;
+        static std::weak_ptr<SDLPortMixer> instance;
+        std::scoped_lock lock{mutex};
+        auto mixer = instance.lock();
+        if (!mixer) {
+            mixer = std::make_shared<SDLPortMixer>();
+            instance = mixer;
+        }
+        return mixer;
+    }
+
+    [[nodiscard]] bool IsOpen() const {
+        return stream != nullptr;
+    }
+
+    void Attach(SDLMixedPortBackend* port) {
+        std::scoped_lock lock{ports_mutex};
+        ports.push_back(port);
+    }
+
+    /// The port is not touched by the device callback anymore once this returns.
+    void Detach(SDLMixedPortBackend* port) {
+        std::scoped_lock lock{ports_mutex};
+        std::erase(ports, port);
+    }
+
+private:
+    static void SDLCALL DeviceCallback(void* userdata, SDL_AudioStream* stream,
+                                       int additional_amount, int total_amount) {
+        static_cast<SDLPortMixer*>(userdata)->Fill(stream, additional_amount);
+    }
+
+    void Fill(SDL_AudioStream* device_stream, int amount);
+
+    std::mutex ports_mutex;
+    std::vector<SDLMixedPortBackend*> ports;
+    std::vector<float> mix; ///< Only touched by the device callback
+    SDL_AudioStream* stream{};
+};
+
+/// Backend of a port that is converted and downmixed to stereo floats here and summed into the
+/// shared mixer stream. Like SDLRingPortBackend, it is paced by the device through a ring.
+class SDLMixedPortBackend : public PortBackend {
+public:
+    explicit SDLMixedPortBackend(const PortOut& port, std::shared_ptr<SDLPortMixer> mixer_,
+                                 u32 latency_target_ms)
+        : format_info{port.format_info}, buffer_frames{port.buffer_frames},
+          buffer_size{buffer_frames * SDLPortMixer::FrameSize},
+          latency_target{std::max<size_t>(u64{SDLPortMixer::SampleRate} * SDLPortMixer::FrameSize *
+                                              latency_target_ms / 1000,
+                                          buffer_size * 2)},
+          ring{latency_target + buffer_size},
+          converted(format_info.is_float ? 0 : buffer_frames * format_info.num_channels),
+          downmixed(buffer_frames * 2), mixer{std::move(mixer_)} {
+        SetVolume(port.volume);
+        mixer->Attach(this);
+    }
+
+    ~SDLMixedPortBackend() override {
+        mixer->Detach(this);
+    }
+
+    void Output(void* ptr) override {
+        const float* samples = static_cast<const float*>(ptr);
+        if (!format_info.is_float) {
+            ConvertS16ToF32(static_cast<const s16*>(ptr), converted.data(), converted.size());
+            samples = converted.data();
+        }
+        DownmixToStereo(samples, format_info.num_channels, downmix, buffer_frames,
+                        downmixed.data());
+        if (!ring.WaitForSpace(buffer_size, latency_target, StallTimeout)) {
+            LOG_WARNING(Lib_AudioOut, "Audio device stalled, dropping {} bytes", buffer_size);
+            return;
+        }
+        ring.Write(reinterpret_cast<const u8*>(downmixed.data()), buffer_size);
+    }
+
+    bool BlocksOnOutput() const override {
+        return true;
+    }
+
+    void SetVolume(const std::array<int, 8>& ch_volumes) override {
+        downmix = MakeStereoDownmix(format_info, ch_volumes, Config::getVolumeSlider() / 100.0f);
+    }
+
+    u32 GetQueuedUs() const override {
+        return static_cast<u32>(u64{ring.Available()} * 1'000'000 /
+                                (SDLPortMixer::SampleRate * SDLPortMixer::FrameSize));
+    }
+
+    u32 GetUnderruns() const override {
+        return underruns.load(std::memory_order_relaxed);
+    }
+
+    /// Adds up to num_frames of the port to the mix from the device callback. Returns the bytes
+    /// left queued.
+    size_t MixInto(float* mix, size_t num_frames) {
+        const size_t size = num_frames * SDLPortMixer::FrameSize;
+        if (scratch.size() < num_frames * 2) {
+            scratch.resize(num_frames * 2);
+        }
+        const size_t read = ring.Read(reinterpret_cast<u8*>(scratch.data()), size);
+        if (read < size && (read != 0 || is_playing)) {
+            ++DebugState.audio_underruns;
+            underruns.fetch_add(1, std::memory_order_relaxed);
+        }
+        is_playing = read != 0;
+        MixSamples(scratch.data(), mix, read / sizeof(float));
+        ring.NotifySpace();
+        return ring.Available();
+    }
+
+private:
+    AudioFormatInfo format_info;
+    u32 buffer_frames;
+    u32 buffer_size; ///< Bytes of a guest buffer after the downmix
+    size_t latency_target;
+    PcmRing ring;
+    std::vector<float> converted;
+    std::vector<float> downmixed;
+    StereoDownmix downmix;
+    std::vector<float> scratch; ///< Only touched by the device callback
+    bool is_playing{};
+    std::atomic<u32> underruns{};
+    std::shared_ptr<SDLPortMixer> mixer;
+};
+
+void SDLPortMixer::Fill(SDL_AudioStream* device_stream, int amount) {
+    if (amount <= 0) {
+        return;
+    }
+    const size_t num_frames = static_cast<size_t>(amount) / FrameSize;
+    mix.assign(num_frames * 2, 0.0f);
+    size_t max_queued = 0;
+    {
+        std::scoped_lock lock{ports_mutex};
+        for (SDLMixedPortBackend* port : ports) {
+            max_queued = std::max(max_queued, port->MixInto(mix.data(), num_frames));
+        }
+    }
+    ClampSamples(mix.data(), mix.size());
+    SDL_PutAudioStreamData(device_stream, mix.data(), static_cast<int>(num_frames * FrameSize));
+    DebugState.audio_latency_us.store(
+        static_cast<u32>(u64{max_queued} * 1'000'000 / (SampleRate * FrameSize)),
+        std::memory_order_relaxed);
+}
+
 std::unique_ptr<PortBackend> SDLAudioOut::Open(PortOut& port) {
+    // The pad speaker goes to its own device
+    if (Config::getMixAudioPorts() && port.type != OrbisAudioOutPort::PadSpk &&
+        port.sample_rate == SDLPortMixer::SampleRate) {
+        if (auto mixer = SDLPortMixer::Acquire(); mixer->IsOpen()) {
+            const int latency_target_ms = std::max(Config::getOutputLatencyTarget(), 0);
+            return std::make_unique<SDLMixedPortBackend>(port, std::move(mixer),
+                                                         static_cast<u32>(latency_target_ms));
+        }
+    }
+    if (const int latency_target_ms = Config::getOutputLatencyTarget(); latency_target_ms > 0) {
+        return std::make_unique<SDLRingPortBackend>(port, static_cast<u32>(latency_target_ms));
+    }
     return std::make_unique<SDLPortBackend>(port);
 }
 
@@ -2,10 +2,97 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <cstring>
+#include <thread>
 #include <common/config.h>
 #include <common/logging/log.h>
+#include "core/libraries/audio/pcm_ring.h"
 #include "sdl_in.h"
 
+/// Capture stream of a port. The device callback pulls the recording out of SDL, which converts
+/// and resamples it to the format of the port on the audio thread, and into a ring the guest
+/// reads from.
+class SDLCaptureStream {
+public:
+    /// Grains the ring holds, the device may deliver a few of them at once.
+    static constexpr size_t RingGrains = 8;
+    /// Grains kept queued at most, older ones are dropped to keep the latency low.
+    static constexpr size_t MaxQueuedGrains = 2;
+
+    explicit SDLCaptureStream(SDL_AudioDeviceID dev_id, const SDL_AudioSpec& fmt,
+                              size_t grain_size_, size_t frame_size_)
+        : grain_size{grain_size_}, frame_size{frame_size_}, ring{grain_size_ * RingGrains},
+          scratch(grain_size_) {
+        stream = SDL_OpenAudioDeviceStream(dev_id, &fmt, &DeviceCallback, this);
+    }
+
+    ~SDLCaptureStream() {
+        // Stops the device callback before the ring goes away
+        if (stream) {
+            SDL_DestroyAudioStream(stream);
+        }
+    }
+
+    SDLCaptureStream(const SDLCaptureStream&) = delete;
+    SDLCaptureStream& operator=(const SDLCaptureStream&) = delete;
+
+    bool IsOpen() const {
+        return stream != nullptr;
+    }
+
+    bool Resume() {
+        return SDL_ResumeAudioStreamDevice(stream);
+    }
+
+    /// Reads a grain, waiting at most timeout for it. Returns the number of bytes read.
+    size_t Read(u8* out, std::chrono::microseconds timeout) {
+        const size_t max_queued = grain_size * MaxQueuedGrains;
+        while (ring.Available() > max_queued) {
+            // The guest fell behind, skip to the most recent grains
+            const size_t excess = ring.Available() - max_queued;
+            ring.Read(out, std::min(excess - excess % frame_size, grain_size));
+            if (excess < frame_size) {
+                break;
+            }
+        }
+        ring.WaitForData(grain_size, timeout);
+        return ring.Read(out, grain_size);
+    }
+
+private:
+    static void SDLCALL DeviceCallback(void* userdata, SDL_AudioStream* stream,
+                                       int additional_amount, int total_amount) {
+        static_cast<SDLCaptureStream*>(userdata)->Fill(stream);
+    }
+
+    void Fill(SDL_AudioStream* stream) {
+        bool written = false;
+        while (SDL_GetAudioStreamAvailable(stream) > 0) {
+            const int size = SDL_GetAudioStreamData(stream, scratch.data(),
+                                                    static_cast<int>(scratch.size()));
+            if (size <= 0) {
+                break;
+            }
+            // Whatever doesn't fit is dropped, the reader only keeps the latest grains anyway
+            size_t space = ring.Capacity() - ring.Available();
+            space -= space % frame_size;
+            const size_t keep = std::min<size_t>(size, space);
+            if (keep != 0) {
+                ring.Write(scratch.data(), keep);
+                written = true;
+            }
+        }
+        if (written) {
+            ring.NotifyData();
+        }
+    }
+
+    const size_t grain_size;
+    const size_t frame_size;
+    SDL_AudioStream* stream{};
+    Libraries::AudioOut::PcmRing ring;
+    std::vector<u8> scratch;
+};
+
 int SDLAudioIn::AudioInit() {
     return SDL_InitSubSystem(SDL_INIT_AUDIO);
 }
@@ -61,18 +148,23 @@ int SDLAudioIn::AudioInOpen(int type, uint32_t samples_num, uint32_t freq, uint3
                 }
             }
 
-            port.stream =
-                nullDevice ? nullptr : SDL_OpenAudioDeviceStream(devId, &fmt, nullptr, nullptr);
+            if (!nullDevice) {
+                const size_t frame_size = port.sample_size * port.channels_num;
+                auto capture = std::make_shared<SDLCaptureStream>(
+                    devId, fmt, size_t{port.samples_num} * frame_size, frame_size);
+                if (capture->IsOpen()) {
+                    port.capture = std::move(capture);
+                }
+            }
 
-            if (!port.stream) {
+            if (!port.capture) {
                 // if stream is null, either due to configuration disabling the input,
                 // or no input devices present in the system, still return a valid id
                 // as some games require that (e.g. L.A. Noire)
                 return id + 1;
             }
 
-            if (SDL_ResumeAudioStreamDevice(port.stream) == false) {
-                SDL_DestroyAudioStream(port.stream);
+            if (port.capture->Resume() == false) {
                 port = {};
                 return ORBIS_AUDIO_IN_ERROR_STREAM_FAIL;
             }
@@ -85,44 +177,46 @@ int SDLAudioIn::AudioInOpen(int type, uint32_t samples_num, uint32_t freq, uint3
 }
 
 int SDLAudioIn::AudioInInput(int handle, void* out_buffer) {
-    std::scoped_lock lock{m_mutex};
-
-    if (handle < 1 || handle > static_cast<int>(portsIn.size()) || !out_buffer)
-        return ORBIS_AUDIO_IN_ERROR_INVALID_PORT;
-
-    auto& port = portsIn[handle - 1];
-    if (!port.isOpen)
-        return ORBIS_AUDIO_IN_ERROR_INVALID_PORT;
-
-    const int bytesToRead = port.samples_num * port.sample_size * port.channels_num;
-
-    if (out_buffer == nullptr) {
-        int attempts = 0;
-        while (SDL_GetAudioStreamAvailable(port.stream) > 0) {
-            SDL_Delay(1);
-            if (++attempts > 1000) {
-                return ORBIS_AUDIO_IN_ERROR_TIMEOUT;
-            }
+    std::shared_ptr<SDLCaptureStream> capture;
+    size_t bytesToRead;
+    std::chrono::microseconds grain;
+    std::chrono::steady_clock::time_point wakeup{};
+    int samples_num;
+    {
+        std::scoped_lock lock{m_mutex};
+
+        if (handle < 1 || handle > static_cast<int>(portsIn.size()) || !out_buffer)
+            return ORBIS_AUDIO_IN_ERROR_INVALID_PORT;
+
+        auto& port = portsIn[handle - 1];
+        if (!port.isOpen)
+            return ORBIS_AUDIO_IN_ERROR_INVALID_PORT;
+
+        capture = port.capture;
+        samples_num = static_cast<int>(port.samples_num);
+        bytesToRead = size_t{port.samples_num} * port.sample_size * port.channels_num;
+        grain = std::chrono::microseconds{u64{port.samples_num} * 1000000 / port.freq};
+        if (!capture) {
+            // Without a device the port still delivers silence at the rate it records
+            const auto now = std::chrono::steady_clock::now();
+            wakeup = std::max(port.next_input, now);
+            port.next_input = wakeup + grain;
         }
-        return 0; // done
     }
 
-    int attempts = 0;
-    while (SDL_GetAudioStreamAvailable(port.stream) < bytesToRead) {
-        SDL_Delay(1);
-        if (++attempts > 1000) {
-            return ORBIS_AUDIO_IN_ERROR_TIMEOUT;
-        }
+    if (!capture) {
+        std::this_thread::sleep_until(wakeup);
+        std::memset(out_buffer, 0, bytesToRead);
+        return samples_num;
     }
 
-    const int bytesRead = SDL_GetAudioStreamData(port.stream, out_buffer, bytesToRead);
-    if (bytesRead < 0) {
-        // SDL_GetAudioStreamData failed
-        LOG_ERROR(Lib_AudioIn, "AudioInInput error: {}", SDL_GetError());
-        return ORBIS_AUDIO_IN_ERROR_STREAM_FAIL;
+    // Wait for the grain at most as long as it takes to record, the rest stays silent
+    auto* out = static_cast<u8*>(out_buffer);
+    const size_t bytesRead = capture->Read(out, grain);
+    if (bytesRead < bytesToRead) {
+        std::memset(out + bytesRead, 0, bytesToRead - bytesRead);
     }
-    const int framesRead = bytesRead / (port.sample_size * port.channels_num);
-    return framesRead;
+    return samples_num;
 }
 
 void SDLAudioIn::AudioInClose(int handle) {
@@ -134,6 +228,5 @@ void SDLAudioIn::AudioInClose(int handle) {
     if (!port.isOpen)
         return;
 
-    SDL_DestroyAudioStream(port.stream);
     port = {};
-}
\ No newline at end of file
+}
@@ -4,6 +4,8 @@
 #pragma once
 
 #include <array>
+#include <chrono>
+#include <memory>
 #include <mutex>
 #include <SDL3/SDL.h>
 
@@ -18,6 +20,8 @@ enum OrbisAudioInParam {
 #define ORBIS_AUDIO_IN_ERROR_TIMEOUT -2
 #define ORBIS_AUDIO_IN_ERROR_STREAM_FAIL -3
 
+class SDLCaptureStream;
+
 class SDLAudioIn {
 public:
     int AudioInit();
@@ -34,7 +38,9 @@ private:
         int channels_num = 0;
         int sample_size = 0;
         uint32_t format = 0;
-        SDL_AudioStream* stream = nullptr;
+        // Shared with inputs in progress, so closing the port doesn't pull it from under them
+        std::shared_ptr<SDLCaptureStream> capture;
+        std::chrono::steady_clock::time_point next_input{};
     };
 
     std::array<AudioInPort, 8> portsIn;
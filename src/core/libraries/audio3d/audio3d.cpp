@@ -1,12 +1,15 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
-#include <SDL3/SDL_audio.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
 #include <magic_enum/magic_enum.hpp>
 
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/libraries/audio/audioout.h"
+#include "core/libraries/audio/audioout_convert.h"
 #include "core/libraries/audio/audioout_error.h"
 #include "core/libraries/audio3d/audio3d.h"
 #include "core/libraries/audio3d/audio3d_error.h"
@@ -17,9 +20,9 @@ namespace Libraries::Audio3d {
 
 static constexpr u32 AUDIO3D_SAMPLE_RATE = 48000;
 
+// The renderer mixes objects into a 7.1 bed, AudioOut downmixes it for the output device
 static constexpr AudioOut::OrbisAudioOutParamFormat AUDIO3D_OUTPUT_FORMAT =
-    AudioOut::OrbisAudioOutParamFormat::S16Stereo;
-static constexpr u32 AUDIO3D_OUTPUT_NUM_CHANNELS = 2;
+    AudioOut::OrbisAudioOutParamFormat::Float_8CH;
 static constexpr u32 AUDIO3D_OUTPUT_BUFFER_FRAMES = 0x100;
 
 static std::unique_ptr<Audio3dState> state;
@@ -79,36 +82,32 @@ s32 PS4_SYSV_ABI sceAudio3dAudioOutOutputs(AudioOut::OrbisAudioOutOutputParam* p
     return AudioOut::sceAudioOutOutputs(param, num);
 }
 
-static s32 PortQueueAudio(Port& port, const OrbisAudio3dPcm& pcm, const u32 num_channels) {
-    // Audio3d output is configured for stereo signed 16-bit PCM. Convert the data to match.
-    const SDL_AudioSpec src_spec = {
-        .format = pcm.format == OrbisAudio3dFormat::ORBIS_AUDIO3D_FORMAT_S16 ? SDL_AUDIO_S16LE
-                                                                             : SDL_AUDIO_F32LE,
-        .channels = static_cast<int>(num_channels),
-        .freq = AUDIO3D_SAMPLE_RATE,
-    };
-    constexpr SDL_AudioSpec dst_spec = {
-        .format = SDL_AUDIO_S16LE,
-        .channels = AUDIO3D_OUTPUT_NUM_CHANNELS,
-        .freq = AUDIO3D_SAMPLE_RATE,
-    };
-    const auto src_size = pcm.num_samples *
-                          (pcm.format == OrbisAudio3dFormat::ORBIS_AUDIO3D_FORMAT_S16 ? 2 : 4) *
-                          num_channels;
-
-    u8* dst_data;
-    int dst_len;
-    if (!SDL_ConvertAudioSamples(&src_spec, static_cast<u8*>(pcm.sample_buffer),
-                                 static_cast<int>(src_size), &dst_spec, &dst_data, &dst_len)) {
-        LOG_ERROR(Lib_Audio3d, "SDL_ConvertAudioSamples failed: {}", SDL_GetError());
-        return ORBIS_AUDIO3D_ERROR_OUT_OF_MEMORY;
+/// Converts PCM samples of the game to floats, at most num_frames frames of them.
+static void ConvertPcm(const OrbisAudio3dPcm& pcm, const u32 num_channels, const u32 num_frames,
+                       std::vector<float>& out) {
+    const size_t num_samples = size_t{std::min(pcm.num_samples, num_frames)} * num_channels;
+    out.resize(num_samples);
+    if (pcm.format == OrbisAudio3dFormat::ORBIS_AUDIO3D_FORMAT_S16) {
+        AudioOut::ConvertS16ToF32(static_cast<const s16*>(pcm.sample_buffer), out.data(),
+                                  num_samples);
+    } else {
+        std::memcpy(out.data(), pcm.sample_buffer, num_samples * sizeof(float));
     }
+}
 
-    port.queue.emplace_back(AudioData{
-        .sample_buffer = dst_data,
-        .num_samples = pcm.num_samples,
-    });
-    return ORBIS_OK;
+static void PortWriteBed(Port& port, const OrbisAudio3dPcm& pcm, const u32 num_channels) {
+    static thread_local std::vector<float> samples;
+    const u32 num_frames = port.parameters.granularity;
+    ConvertPcm(pcm, num_channels, num_frames, samples);
+    if (num_channels == AUDIO3D_BED_NUM_CHANNELS) {
+        AudioOut::MixSamples(samples.data(), port.bed.data(), samples.size());
+        return;
+    }
+    // Stereo beds only feed the front pair
+    for (size_t frame = 0; frame < samples.size() / 2; ++frame) {
+        port.bed[frame * AUDIO3D_BED_NUM_CHANNELS] += samples[frame * 2];
+        port.bed[frame * AUDIO3D_BED_NUM_CHANNELS + 1] += samples[frame * 2 + 1];
+    }
 }
 
 s32 PS4_SYSV_ABI sceAudio3dBedWrite(const OrbisAudio3dPortId port_id, const u32 num_channels,
@@ -167,13 +166,14 @@ s32 PS4_SYSV_ABI sceAudio3dBedWrite2(const OrbisAudio3dPortId port_id, const u32
         }
     }
 
-    return PortQueueAudio(state->ports[port_id],
-                          OrbisAudio3dPcm{
-                              .format = format,
-                              .sample_buffer = buffer,
-                              .num_samples = num_samples,
-                          },
-                          num_channels);
+    PortWriteBed(state->ports[port_id],
+                 OrbisAudio3dPcm{
+                     .format = format,
+                     .sample_buffer = buffer,
+                     .num_samples = num_samples,
+                 },
+                 num_channels);
+    return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceAudio3dCreateSpeakerArray() {
@@ -245,6 +245,8 @@ s32 PS4_SYSV_ABI sceAudio3dInitialize(const s64 reserved) {
     if (state->audio_out_handle < 0) {
         return state->audio_out_handle;
     }
+    state->renderer =
+        std::make_unique<Renderer>(state->audio_out_handle, AUDIO3D_OUTPUT_BUFFER_FRAMES);
 
     return ORBIS_OK;
 }
@@ -266,6 +268,7 @@ s32 PS4_SYSV_ABI sceAudio3dObjectReserve(const OrbisAudio3dPortId port_id,
 
     static int last_id = 0;
     *object_id = ++last_id;
+    state->ports[port_id].objects.try_emplace(*object_id);
 
     return ORBIS_OK;
 }
@@ -284,6 +287,7 @@ s32 PS4_SYSV_ABI sceAudio3dObjectSetAttributes(const OrbisAudio3dPortId port_id,
     }
 
     auto& port = state->ports[port_id];
+    auto& object = port.objects[object_id];
 
     for (u64 i = 0; i < num_attributes; i++) {
         const auto& attribute = attribute_array[i];
@@ -292,11 +296,34 @@ s32 PS4_SYSV_ABI sceAudio3dObjectSetAttributes(const OrbisAudio3dPortId port_id,
         case OrbisAudio3dAttributeId::ORBIS_AUDIO3D_ATTRIBUTE_PCM: {
             const auto pcm = static_cast<OrbisAudio3dPcm*>(attribute.value);
             // Object audio has 1 channel.
-            if (const auto ret = PortQueueAudio(port, *pcm, 1); ret != ORBIS_OK) {
-                return ret;
-            }
+            ConvertPcm(*pcm, 1, port.parameters.granularity, object.pcm);
             break;
         }
+        case OrbisAudio3dAttributeId::ORBIS_AUDIO3D_ATTRIBUTE_POSITION:
+            if (attribute.value_size < sizeof(OrbisAudio3dPosition)) {
+                return ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
+            }
+            object.position = *static_cast<const OrbisAudio3dPosition*>(attribute.value);
+            break;
+        case OrbisAudio3dAttributeId::ORBIS_AUDIO3D_ATTRIBUTE_GAIN:
+            if (attribute.value_size < sizeof(float)) {
+                return ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
+            }
+            object.gain = *static_cast<const float*>(attribute.value);
+            break;
+        case OrbisAudio3dAttributeId::ORBIS_AUDIO3D_ATTRIBUTE_SPREAD:
+            if (attribute.value_size < sizeof(float)) {
+                return ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
+            }
+            object.spread = *static_cast<const float*>(attribute.value);
+            break;
+        case OrbisAudio3dAttributeId::ORBIS_AUDIO3D_ATTRIBUTE_RESET_STATE:
+            object = {};
+            break;
+        case OrbisAudio3dAttributeId::ORBIS_AUDIO3D_ATTRIBUTE_PRIORITY:
+        case OrbisAudio3dAttributeId::ORBIS_AUDIO3D_ATTRIBUTE_PASSTHROUGH:
+            // Every object is rendered, there is no limit to prioritize for
+            break;
         default:
             LOG_ERROR(Lib_Audio3d, "Unsupported attribute ID: {:#x}",
                       static_cast<u32>(attribute.attribute_id));
@@ -326,21 +353,37 @@ s32 PS4_SYSV_ABI sceAudio3dPortAdvance(const OrbisAudio3dPortId port_id) {
         return ORBIS_AUDIO3D_ERROR_NOT_SUPPORTED;
     }
 
+    // Close the granule and start collecting the next one
     auto& port = state->ports[port_id];
-    if (port.current_buffer.has_value()) {
-        // Free existing buffer before replacing.
-        SDL_free(port.current_buffer->sample_buffer);
+    const u32 num_frames = port.parameters.granularity;
+    Granule granule{
+        .num_frames = num_frames,
+        .bed = std::exchange(port.bed,
+                             std::vector<float>(size_t{num_frames} * AUDIO3D_BED_NUM_CHANNELS)),
+    };
+    for (auto& [id, object] : port.objects) {
+        if (object.pcm.empty()) {
+            continue;
+        }
+        granule.objects.push_back(ObjectGranule{
+            .pcm = std::move(object.pcm),
+            .position = object.position,
+            .gain = object.gain,
+            .spread = object.spread,
+        });
+        object.pcm.clear();
+    }
+
+    if (port.parameters.buffer_mode ==
+        OrbisAudio3dBufferMode::ORBIS_AUDIO3D_BUFFER_ADVANCE_NO_PUSH) {
+        state->renderer->Submit(port_id, std::move(granule));
+        return ORBIS_OK;
     }
-
-    if (!port.queue.empty()) {
-        port.current_buffer = port.queue.front();
+    if (port.queue.size() >= port.parameters.queue_depth) {
+        LOG_WARNING(Lib_Audio3d, "Port queue is full, dropping the oldest granule");
         port.queue.pop_front();
-    } else {
-        // Nothing to advance to.
-        LOG_DEBUG(Lib_Audio3d, "Port advance with no buffer queued");
-        port.current_buffer = std::nullopt;
     }
-
+    port.queue.push_back(std::move(granule));
     return ORBIS_OK;
 }
 
@@ -398,8 +441,9 @@ s32 PS4_SYSV_ABI sceAudio3dPortGetQueueLevel(const OrbisAudio3dPortId port_id, u
         return ORBIS_AUDIO3D_ERROR_INVALID_PARAMETER;
     }
 
-    const auto port = state->ports[port_id];
-    const size_t size = port.queue.size();
+    const auto& port = state->ports[port_id];
+    const size_t size = std::min<size_t>(
+        port.queue.size() + state->renderer->NumPending(port_id), port.parameters.queue_depth);
 
     if (queue_level) {
         *queue_level = size;
@@ -446,7 +490,9 @@ s32 PS4_SYSV_ABI sceAudio3dPortOpen(const OrbisUserServiceUserId user_id,
     }
 
     *port_id = id;
-    std::memcpy(&state->ports[id].parameters, parameters, parameters->size_this);
+    auto& port = state->ports[id];
+    std::memcpy(&port.parameters, parameters, parameters->size_this);
+    port.bed.resize(size_t{port.parameters.granularity} * AUDIO3D_BED_NUM_CHANNELS);
 
     return ORBIS_OK;
 }
@@ -461,22 +507,29 @@ s32 PS4_SYSV_ABI sceAudio3dPortPush(const OrbisAudio3dPortId port_id,
         return ORBIS_AUDIO3D_ERROR_INVALID_PORT;
     }
 
-    const auto& port = state->ports[port_id];
+    auto& port = state->ports[port_id];
     if (port.parameters.buffer_mode !=
         OrbisAudio3dBufferMode::ORBIS_AUDIO3D_BUFFER_ADVANCE_AND_PUSH) {
         LOG_ERROR(Lib_Audio3d, "port doesn't have push capability");
         return ORBIS_AUDIO3D_ERROR_NOT_SUPPORTED;
     }
 
-    if (!port.current_buffer.has_value()) {
+    if (port.queue.empty()) {
         // Nothing to push.
         LOG_DEBUG(Lib_Audio3d, "Port push with no buffer ready");
         return ORBIS_OK;
     }
 
-    // TODO: Implement asynchronous blocking mode.
-    const auto& [sample_buffer, num_samples] = port.current_buffer.value();
-    return AudioOut::sceAudioOutOutput(state->audio_out_handle, sample_buffer);
+    while (!port.queue.empty()) {
+        state->renderer->Submit(port_id, std::move(port.queue.front()));
+        port.queue.pop_front();
+    }
+    if (blocking == OrbisAudio3dBlocking::ORBIS_AUDIO3D_BLOCKING_SYNC) {
+        // Return once the queue has room for the next granule again
+        const u32 queue_depth = std::max(port.parameters.queue_depth, 1U);
+        state->renderer->WaitForPort(port_id, queue_depth - 1);
+    }
+    return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceAudio3dPortQueryDebug() {
@@ -532,6 +585,7 @@ s32 PS4_SYSV_ABI sceAudio3dTerminate() {
         return ORBIS_AUDIO3D_ERROR_NOT_READY;
     }
 
+    state->renderer.reset();
     AudioOut::sceAudioOutOutput(state->audio_out_handle, nullptr);
     AudioOut::sceAudioOutClose(state->audio_out_handle);
     state.release();
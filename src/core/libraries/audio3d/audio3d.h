@@ -3,11 +3,13 @@
 
 #pragma once
 
-#include <optional>
-#include <queue>
+#include <deque>
+#include <memory>
+#include <unordered_map>
 
 #include "common/types.h"
 #include "core/libraries/audio/audioout.h"
+#include "core/libraries/audio3d/audio3d_renderer.h"
 
 namespace Core::Loader {
 class SymbolsResolver;
@@ -62,9 +64,14 @@ struct OrbisAudio3dPcm {
 
 enum class OrbisAudio3dAttributeId : u32 {
     ORBIS_AUDIO3D_ATTRIBUTE_PCM = 1,
+    ORBIS_AUDIO3D_ATTRIBUTE_PRIORITY = 2,
+    ORBIS_AUDIO3D_ATTRIBUTE_POSITION = 3,
+    ORBIS_AUDIO3D_ATTRIBUTE_SPREAD = 4,
+    ORBIS_AUDIO3D_ATTRIBUTE_GAIN = 5,
+    ORBIS_AUDIO3D_ATTRIBUTE_PASSTHROUGH = 6,
+    ORBIS_AUDIO3D_ATTRIBUTE_RESET_STATE = 7,
 };
 
-using OrbisAudio3dPortId = u32;
 using OrbisAudio3dObjectId = u32;
 
 struct OrbisAudio3dAttribute {
@@ -74,20 +81,24 @@ struct OrbisAudio3dAttribute {
     u64 value_size;
 };
 
-struct AudioData {
-    u8* sample_buffer;
-    u32 num_samples;
+struct Object {
+    std::vector<float> pcm; ///< Samples of the granule being built
+    OrbisAudio3dPosition position{0.0f, 0.0f, 1.0f};
+    float gain = 1.0f;
+    float spread = 0.0f;
 };
 
 struct Port {
     OrbisAudio3dOpenParameters parameters{};
-    std::deque<AudioData> queue; // Only stores PCM buffers for now
-    std::optional<AudioData> current_buffer{};
+    std::unordered_map<OrbisAudio3dObjectId, Object> objects;
+    std::vector<float> bed;     ///< Bed of the granule being built
+    std::deque<Granule> queue;  ///< Advanced granules waiting for a push
 };
 
 struct Audio3dState {
     std::unordered_map<OrbisAudio3dPortId, Port> ports;
     s32 audio_out_handle;
+    std::unique_ptr<Renderer> renderer;
 };
 
 s32 PS4_SYSV_ABI sceAudio3dAudioOutClose(s32 handle);
@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/libraries/audio/audioout.h"
+#include "core/libraries/audio/audioout_convert.h"
+#include "core/libraries/audio3d/audio3d_renderer.h"
+
+namespace Libraries::Audio3d {
+
+namespace {
+
+struct Speaker {
+    float azimuth; ///< Degrees clockwise from the front
+    u32 channel;
+};
+
+/// Full range speakers of the bed around the listener, in order of azimuth.
+constexpr std::array<Speaker, 7> SpeakerRing = {{
+    {0.0f, 2},   // FC
+    {30.0f, 1},  // FR
+    {90.0f, 7},  // SR
+    {150.0f, 5}, // BR
+    {210.0f, 4}, // BL
+    {270.0f, 6}, // SL
+    {330.0f, 0}, // FL
+}};
+
+} // Anonymous namespace
+
+std::array<float, AUDIO3D_BED_NUM_CHANNELS> ComputePanGains(const OrbisAudio3dPosition& position,
+                                                            float spread) {
+    std::array<float, AUDIO3D_BED_NUM_CHANNELS> gains{};
+    if (std::abs(position.x) < 1e-6f && std::abs(position.z) < 1e-6f) {
+        // Right at the listener or straight above, there is no direction to pan to
+        spread = 1.0f;
+    }
+    spread = std::clamp(spread, 0.0f, 1.0f);
+
+    float azimuth = std::atan2(position.x, position.z) * (180.0f / std::numbers::pi_v<float>);
+    if (azimuth < 0.0f) {
+        azimuth += 360.0f;
+    }
+    for (size_t i = 0; i < SpeakerRing.size(); ++i) {
+        const Speaker& first = SpeakerRing[i];
+        const Speaker& second = SpeakerRing[(i + 1) % SpeakerRing.size()];
+        const float end = second.azimuth > first.azimuth ? second.azimuth : 360.0f;
+        if (azimuth < first.azimuth || azimuth >= end) {
+            continue;
+        }
+        const float t = (azimuth - first.azimuth) / (end - first.azimuth);
+        gains[first.channel] = std::cos(t * std::numbers::pi_v<float> / 2.0f);
+        gains[second.channel] = std::sin(t * std::numbers::pi_v<float> / 2.0f);
+        break;
+    }
+
+    if (spread > 0.0f) {
+        const float even = 1.0f / std::sqrt(static_cast<float>(SpeakerRing.size()));
+        float power = 0.0f;
+        for (const Speaker& speaker : SpeakerRing) {
+            float& gain = gains[speaker.channel];
+            gain = gain * (1.0f - spread) + even * spread;
+            power += gain * gain;
+        }
+        const float normalize = 1.0f / std::sqrt(power);
+        for (const Speaker& speaker : SpeakerRing) {
+            gains[speaker.channel] *= normalize;
+        }
+    }
+    return gains;
+}
+
+Renderer::Renderer(s32 audio_out_handle_, u32 output_frames_)
+    : audio_out_handle{audio_out_handle_}, output_frames{output_frames_} {
+    thread = std::jthread([this](std::stop_token stop) { RenderThread(stop); });
+}
+
+Renderer::~Renderer() = default;
+
+void Renderer::Submit(OrbisAudio3dPortId port_id, Granule&& granule) {
+    {
+        std::scoped_lock lock{mutex};
+        queues[port_id].push_back(std::move(granule));
+    }
+    work_cv.notify_one();
+}
+
+u32 Renderer::NumPending(OrbisAudio3dPortId port_id) {
+    std::scoped_lock lock{mutex};
+    return NumPendingLocked(port_id);
+}
+
+u32 Renderer::NumPendingLocked(OrbisAudio3dPortId port_id) const {
+    const auto it = queues.find(port_id);
+    const u32 queued = it != queues.end() ? static_cast<u32>(it->second.size()) : 0;
+    return queued + static_cast<u32>(std::ranges::count(rendering, port_id));
+}
+
+void Renderer::WaitForPort(OrbisAudio3dPortId port_id, u32 max_pending) {
+    std::unique_lock lock{mutex};
+    done_cv.wait(lock, [&] { return NumPendingLocked(port_id) <= max_pending; });
+}
+
+void Renderer::DiscardPort(OrbisAudio3dPortId port_id) {
+    {
+        std::scoped_lock lock{mutex};
+        queues.erase(port_id);
+    }
+    done_cv.notify_all();
+}
+
+void Renderer::RenderThread(std::stop_token stop) {
+    Common::SetCurrentThreadName("shadPS4:Audio3dRender");
+    std::vector<Granule> batch;
+    while (!stop.stop_requested()) {
+        {
+            // Take the next granule of every port at once, they play at the same time
+            std::unique_lock lock{mutex};
+            const bool has_work = work_cv.wait(lock, stop, [&] {
+                return std::ranges::any_of(queues,
+                                           [](const auto& queue) { return !queue.second.empty(); });
+            });
+            if (!has_work) {
+                break;
+            }
+            for (auto& [port_id, queue] : queues) {
+                if (!queue.empty()) {
+                    batch.push_back(std::move(queue.front()));
+                    queue.pop_front();
+                    rendering.push_back(port_id);
+                }
+            }
+        }
+
+        Mix(batch);
+        // Writing a buffer blocks until AudioOut takes it, which paces the thread
+        size_t frame = 0;
+        const size_t buffer_samples = size_t{output_frames} * AUDIO3D_BED_NUM_CHANNELS;
+        for (; frame + buffer_samples <= output.size(); frame += buffer_samples) {
+            AudioOut::sceAudioOutOutput(audio_out_handle, output.data() + frame);
+        }
+        output.erase(output.begin(), output.begin() + frame);
+
+        batch.clear();
+        {
+            std::scoped_lock lock{mutex};
+            rendering.clear();
+        }
+        done_cv.notify_all();
+    }
+}
+
+void Renderer::Mix(const std::vector<Granule>& granules) {
+    u32 num_frames = 0;
+    for (const Granule& granule : granules) {
+        num_frames = std::max(num_frames, granule.num_frames);
+    }
+    mix.assign(size_t{num_frames} * AUDIO3D_BED_NUM_CHANNELS, 0.0f);
+    for (const Granule& granule : granules) {
+        AudioOut::MixSamples(granule.bed.data(), mix.data(), granule.bed.size());
+        for (const ObjectGranule& object : granule.objects) {
+            auto gains = ComputePanGains(object.position, object.spread);
+            for (float& gain : gains) {
+                gain *= object.gain;
+            }
+            AudioOut::PanTo8Channel(object.pcm.data(), gains,
+                                    std::min<size_t>(object.pcm.size(), num_frames), mix.data());
+        }
+    }
+    output.insert(output.end(), mix.begin(), mix.end());
+}
+
+} // namespace Libraries::Audio3d
@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/types.h"
+
+namespace Libraries::Audio3d {
+
+using OrbisAudio3dPortId = u32;
+
+/// Channels of the bed, in the order of the Float_8CH format of AudioOut:
+/// FL, FR, FC, LFE, BL, BR, SL, SR
+constexpr u32 AUDIO3D_BED_NUM_CHANNELS = 8;
+
+struct OrbisAudio3dPosition {
+    float x; ///< Right of the listener
+    float y; ///< Above the listener
+    float z; ///< In front of the listener
+};
+
+/// Mono samples of an object for one granule with the attributes to spatialize them.
+struct ObjectGranule {
+    std::vector<float> pcm;
+    OrbisAudio3dPosition position;
+    float gain;
+    float spread;
+};
+
+/// Everything a port advanced over one granule, rendered as a whole.
+struct Granule {
+    u32 num_frames{};
+    std::vector<float> bed; ///< Interleaved bed frames
+    std::vector<ObjectGranule> objects;
+};
+
+/// Gains of the bed channels that place a mono source at a position. Sources are panned between
+/// the two closest speakers at constant power, spread blends them towards all speakers.
+[[nodiscard]] std::array<float, AUDIO3D_BED_NUM_CHANNELS> ComputePanGains(
+    const OrbisAudio3dPosition& position, float spread);
+
+/// Spatializes the granules the ports push on its own thread and writes the mix to an AudioOut
+/// port, so the audio thread of the game only has to collect them.
+class Renderer {
+public:
+    explicit Renderer(s32 audio_out_handle, u32 output_frames);
+    ~Renderer();
+
+    Renderer(const Renderer&) = delete;
+    Renderer& operator=(const Renderer&) = delete;
+
+    void Submit(OrbisAudio3dPortId port_id, Granule&& granule);
+
+    /// Returns the number of granules of a port that are queued or rendering.
+    [[nodiscard]] u32 NumPending(OrbisAudio3dPortId port_id);
+
+    /// Blocks until at most max_pending granules of a port are left.
+    void WaitForPort(OrbisAudio3dPortId port_id, u32 max_pending);
+
+    /// Drops the granules of a port that weren't rendered yet.
+    void DiscardPort(OrbisAudio3dPortId port_id);
+
+private:
+    void RenderThread(std::stop_token stop);
+    void Mix(const std::vector<Granule>& granules);
+    u32 NumPendingLocked(OrbisAudio3dPortId port_id) const;
+
+    const s32 audio_out_handle;
+    const u32 output_frames;
+
+    std::mutex mutex;
+    std::condition_variable_any work_cv;
+    std::condition_variable done_cv;
+    std::map<OrbisAudio3dPortId, std::deque<Granule>> queues;
+    std::vector<OrbisAudio3dPortId> rendering; ///< Ports of the granules being rendered
+
+    std::vector<float> mix;
+    std::vector<float> output; ///< Mixed frames not written to AudioOut yet
+    std::jthread thread;
+};
+
+} // namespace Libraries::Audio3d
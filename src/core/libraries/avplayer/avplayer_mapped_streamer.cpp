@@ -0,0 +1,152 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/logging/log.h"
+#include "common/singleton.h"
+#include "common/thread.h"
+#include "core/debug_state.h"
+#include "core/file_sys/fs.h"
+#include "core/libraries/avplayer/avplayer_mapped_streamer.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavformat/avio.h>
+}
+
+constexpr u32 AVPLAYER_MAPPED_AVIO_BUFFER_SIZE = 64_KB;
+/// Pages are read in in chunks of this size, so a seek doesn't wait for a big one to finish.
+constexpr u64 AVPLAYER_PREFETCH_CHUNK_SIZE = 256_KB;
+constexpr u64 AVPLAYER_PREFETCH_PAGE_SIZE = 4_KB;
+
+namespace Libraries::AvPlayer {
+
+AvPlayerMappedStreamer::AvPlayerMappedStreamer(u64 read_ahead) : m_read_ahead(read_ahead) {}
+
+AvPlayerMappedStreamer::~AvPlayerMappedStreamer() {
+    if (m_prefetch_thread.joinable()) {
+        m_prefetch_thread.request_stop();
+        m_prefetch_thread.join();
+    }
+    if (m_avio_context != nullptr) {
+        av_freep(&m_avio_context->buffer);
+        avio_context_free(&m_avio_context);
+    }
+    DebugState.avplayer_read_ahead_bytes.store(0, std::memory_order_relaxed);
+}
+
+bool AvPlayerMappedStreamer::Init(std::string_view path) {
+    const auto mnt = Common::Singleton<Core::FileSys::MntPoints>::Instance();
+    if (!m_file.Open(mnt->GetHostPath(path))) {
+        return false;
+    }
+    const auto avio_buffer = reinterpret_cast<u8*>(av_malloc(AVPLAYER_MAPPED_AVIO_BUFFER_SIZE));
+    m_avio_context = avio_alloc_context(avio_buffer, AVPLAYER_MAPPED_AVIO_BUFFER_SIZE, 0, this,
+                                        &AvPlayerMappedStreamer::ReadPacket, nullptr,
+                                        &AvPlayerMappedStreamer::Seek);
+    m_prefetch_thread = std::jthread([this](std::stop_token stop) { PrefetchThread(stop); });
+    return true;
+}
+
+void AvPlayerMappedStreamer::Reset() {
+    SetPosition(0);
+}
+
+void AvPlayerMappedStreamer::SetPosition(u64 position) {
+    {
+        std::scoped_lock lock{m_mutex};
+        m_position = position;
+        if (position < m_filled_begin || position > m_filled_end) {
+            m_filled_begin = m_filled_end = position;
+            ++m_generation;
+        }
+        DebugState.avplayer_read_ahead_bytes.store(m_filled_end - m_position,
+                                                   std::memory_order_relaxed);
+    }
+    m_cv.notify_one();
+}
+
+s32 AvPlayerMappedStreamer::ReadPacket(void* opaque, u8* buffer, s32 size) {
+    const auto self = reinterpret_cast<AvPlayerMappedStreamer*>(opaque);
+    u64 position;
+    {
+        std::scoped_lock lock{self->m_mutex};
+        position = self->m_position;
+        if (position + size > self->m_filled_end && self->m_filled_end < self->m_file.Size()) {
+            // Ahead of the prefetch thread, the copy waits for the disk
+            ++DebugState.avplayer_read_stalls;
+        }
+    }
+    const u64 file_size = self->m_file.Size();
+    if (position >= file_size) {
+        return AVERROR_EOF;
+    }
+    const u64 num_bytes = std::min<u64>(size, file_size - position);
+    std::memcpy(buffer, self->m_file.View(position, num_bytes).data(), num_bytes);
+    self->SetPosition(position + num_bytes);
+    return static_cast<s32>(num_bytes);
+}
+
+s64 AvPlayerMappedStreamer::Seek(void* opaque, s64 offset, int whence) {
+    const auto self = reinterpret_cast<AvPlayerMappedStreamer*>(opaque);
+    const s64 file_size = self->m_file.Size();
+    if (whence & AVSEEK_SIZE) {
+        return file_size;
+    }
+    s64 base;
+    if (whence == SEEK_SET) {
+        base = 0;
+    } else if (whence == SEEK_CUR) {
+        std::scoped_lock lock{self->m_mutex};
+        base = self->m_position;
+    } else if (whence == SEEK_END) {
+        base = file_size;
+    } else {
+        return -1;
+    }
+    const s64 position = std::clamp<s64>(base + offset, 0, file_size);
+    self->SetPosition(position);
+    return position;
+}
+
+void AvPlayerMappedStreamer::PrefetchThread(std::stop_token stop) {
+    Common::SetCurrentThreadName("shadPS4:AvPlayerPrefetch");
+    const u64 file_size = m_file.Size();
+    while (!stop.stop_requested()) {
+        u64 begin, end;
+        u32 generation;
+        {
+            std::unique_lock lock{m_mutex};
+            const auto wants_data = [&] {
+                return m_filled_end < std::min(m_position + m_read_ahead, file_size);
+            };
+            if (!m_cv.wait(lock, stop, wants_data)) {
+                break;
+            }
+            begin = m_filled_end;
+            end = std::min({begin + AVPLAYER_PREFETCH_CHUNK_SIZE, m_position + m_read_ahead,
+                            file_size});
+            generation = m_generation;
+        }
+
+        // Touching every page reads it in here, instead of on the demuxer thread
+        m_file.Prefetch(begin, end - begin);
+        const auto chunk = m_file.View(begin, end - begin);
+        u8 sum = 0;
+        for (size_t offset = 0; offset < chunk.size(); offset += AVPLAYER_PREFETCH_PAGE_SIZE) {
+            sum += static_cast<const volatile u8&>(chunk[offset]);
+        }
+        (void)sum;
+
+        std::scoped_lock lock{m_mutex};
+        if (generation == m_generation) {
+            m_filled_end = end;
+            DebugState.avplayer_read_ahead_bytes.store(m_filled_end - m_position,
+                                                       std::memory_order_relaxed);
+        }
+    }
+}
+
+} // namespace Libraries::AvPlayer
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+#include "common/mapped_file.h"
+#include "core/libraries/avplayer/avplayer_data_streamer.h"
+
+struct AVIOContext;
+
+namespace Libraries::AvPlayer {
+
+/// Streams a movie on the host from a mapping of the file. A thread reads the pages ahead of the
+/// demuxer in, so demuxing copies from memory instead of waiting for the disk.
+class AvPlayerMappedStreamer : public IDataStreamer {
+public:
+    explicit AvPlayerMappedStreamer(u64 read_ahead);
+    ~AvPlayerMappedStreamer();
+
+    bool Init(std::string_view path) override;
+    void Reset() override;
+
+    AVIOContext* GetContext() override {
+        return m_avio_context;
+    }
+
+private:
+    static s32 ReadPacket(void* opaque, u8* buffer, s32 size);
+    static s64 Seek(void* opaque, s64 offset, int whence);
+
+    /// Moves the position of the demuxer, starting over the read-ahead if it leaves the range
+    /// that was read in.
+    void SetPosition(u64 position);
+    void PrefetchThread(std::stop_token stop);
+
+    const u64 m_read_ahead;
+    Common::FS::MappedFile m_file;
+    AVIOContext* m_avio_context{};
+
+    std::mutex m_mutex;
+    std::condition_variable_any m_cv;
+    u64 m_position{};
+    u64 m_filled_begin{}; ///< Range of the file that was read in around the position
+    u64 m_filled_end{};
+    u32 m_generation{}; ///< Bumped when the read-ahead starts over
+
+    std::jthread m_prefetch_thread;
+};
+
+} // namespace Libraries::AvPlayer
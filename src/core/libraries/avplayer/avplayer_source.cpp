@@ -2,12 +2,15 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "common/alignment.h"
+#include "common/config.h"
 #include "common/singleton.h"
 #include "common/thread.h"
 #include "core/file_sys/fs.h"
 #include "core/libraries/avplayer/avplayer_error.h"
 #include "core/libraries/avplayer/avplayer_file_streamer.h"
+#include "core/libraries/avplayer/avplayer_mapped_streamer.h"
 #include "core/libraries/avplayer/avplayer_source.h"
+#include "core/memory.h"
 
 #include <magic_enum/magic_enum.hpp>
 
@@ -16,7 +19,6 @@ extern "C" {
 #include <libavformat/avformat.h>
 #include <libavformat/avio.h>
 #include <libswresample/swresample.h>
-#include <libswscale/swscale.h>
 }
 
 #include "common/support/avdec.h"
@@ -46,11 +48,27 @@ bool AvPlayerSource::Init(const AvPlayerInitData& init_data, std::string_view pa
             return false;
         }
     } else {
-        const auto mnt = Common::Singleton<Core::FileSys::MntPoints>::Instance();
-        const auto filepath = mnt->GetHostPath(path);
-        if (AVPLAYER_IS_ERROR(
-                avformat_open_input(&context, filepath.string().c_str(), nullptr, nullptr))) {
-            return false;
+        // Only files on the host are read ahead, the guest callbacks above have to be called
+        // from the threads of the player
+        const u64 read_ahead = u64(Config::getAvPlayerReadAheadMbytes()) * 1_MB;
+        if (read_ahead != 0) {
+            auto streamer = std::make_unique<AvPlayerMappedStreamer>(read_ahead);
+            if (streamer->Init(path)) {
+                m_up_data_streamer = std::move(streamer);
+                context->pb = m_up_data_streamer->GetContext();
+            }
+        }
+        if (context->pb != nullptr) {
+            if (AVPLAYER_IS_ERROR(avformat_open_input(&context, nullptr, nullptr, nullptr))) {
+                return false;
+            }
+        } else {
+            const auto mnt = Common::Singleton<Core::FileSys::MntPoints>::Instance();
+            const auto filepath = mnt->GetHostPath(path);
+            if (AVPLAYER_IS_ERROR(avformat_open_input(&context, filepath.string().c_str(),
+                                                      nullptr, nullptr))) {
+                return false;
+            }
         }
     }
     m_avformat_context = AVFormatContextPtr(context, &ReleaseAVFormatContext);
@@ -214,6 +232,7 @@ bool AvPlayerSource::Start() {
                       m_video_stream_index.value());
             return false;
         }
+        m_hwaccel.Attach(m_video_codec_context.get(), decoder);
         if (avcodec_open2(m_video_codec_context.get(), decoder, nullptr) < 0) {
             LOG_ERROR(Lib_AvPlayer, "Could not open avcodec for video stream {}.",
                       m_video_stream_index.value());
@@ -429,12 +448,6 @@ void AvPlayerSource::ReleaseSWRContext(SwrContext* context) {
     }
 }
 
-void AvPlayerSource::ReleaseSWSContext(SwsContext* context) {
-    if (context != nullptr) {
-        sws_freeContext(context);
-    }
-}
-
 void AvPlayerSource::ReleaseAVFormatContext(AVFormatContext* context) {
     if (context != nullptr) {
         avformat_close_input(&context);
@@ -512,66 +525,26 @@ void AvPlayerSource::DemuxerThread(std::stop_token stop) {
     LOG_INFO(Lib_AvPlayer, "Demuxer Thread exited normally");
 }
 
-AvPlayerSource::AVFramePtr AvPlayerSource::ConvertVideoFrame(const AVFrame& frame) {
-    auto nv12_frame = AVFramePtr{av_frame_alloc(), &ReleaseAVFrame};
-    nv12_frame->pts = frame.pts;
-    nv12_frame->pkt_dts = frame.pkt_dts < 0 ? 0 : frame.pkt_dts;
-    nv12_frame->format = AV_PIX_FMT_NV12;
-    nv12_frame->width = frame.width;
-    nv12_frame->height = frame.height;
-    nv12_frame->sample_aspect_ratio = frame.sample_aspect_ratio;
-    nv12_frame->crop_top = frame.crop_top;
-    nv12_frame->crop_bottom = frame.crop_bottom;
-    nv12_frame->crop_left = frame.crop_left;
-    nv12_frame->crop_right = frame.crop_right;
-
-    av_frame_get_buffer(nv12_frame.get(), 0);
-
-    if (m_sws_context == nullptr) {
-        m_sws_context =
-            SWSContextPtr(sws_getContext(frame.width, frame.height, AVPixelFormat(frame.format),
-                                         nv12_frame->width, nv12_frame->height, AV_PIX_FMT_NV12,
-                                         SWS_FAST_BILINEAR, nullptr, nullptr, nullptr),
-                          &ReleaseSWSContext);
-    }
-    const auto res = sws_scale(m_sws_context.get(), frame.data, frame.linesize, 0, frame.height,
-                               nv12_frame->data, nv12_frame->linesize);
-    if (res < 0) {
-        LOG_ERROR(Lib_AvPlayer, "Could not convert to NV12: {}", av_err2str(res));
-        return AVFramePtr{nullptr, &ReleaseAVFrame};
-    }
-    return nv12_frame;
-}
-
-static void CopyNV12Data(u8* dst, const AVFrame& src, bool use_vdec2) {
-    auto width = u32(src.width);
-    auto height = u32(src.height);
-    if (!use_vdec2) {
+Frame AvPlayerSource::PrepareVideoFrame(GuestBuffer buffer, const AVFrame& frame) {
+    auto width = u32(frame.width);
+    auto height = u32(frame.height);
+    if (!m_use_vdec2) {
         width = Common::AlignUp(width, 16);
         height = Common::AlignUp(height, 16);
     }
 
-    if (src.width == width) {
-        std::memcpy(dst, src.data[0], src.width * src.height);
-        std::memcpy(dst + src.width * height, src.data[1], (src.width * src.height) / 2);
-    } else {
-        const auto luma_dst = dst;
-        for (u32 y = 0; y < src.height; ++y) {
-            std::memcpy(luma_dst + y * width, src.data[0] + y * src.width, src.width);
-        }
-        const auto chroma_dst = dst + width * height;
-        for (u32 y = 0; y < src.height / 2; ++y) {
-            std::memcpy(chroma_dst + y * (width / 2), src.data[0] + y * (src.width / 2),
-                        src.width / 2);
+    auto p_buffer = buffer.GetBuffer();
+    // The whole frame is rewritten, so the texture cache drops it once instead of faulting on
+    // every page the copy touches
+    Core::Memory::Instance()->InvalidateMemory(reinterpret_cast<VAddr>(p_buffer),
+                                             size_t(width) * height * 3 / 2);
+    // Decoders output NV12 or planar 4:2:0, which is copied without converting
+    if (!Videodec::CopyToNV12(p_buffer, width, size_t(width) * height, frame)) {
+        const AVFrame* nv12_frame = m_nv12_converter.Convert(frame);
+        if (nv12_frame != nullptr) {
+            Videodec::CopyToNV12(p_buffer, width, size_t(width) * height, *nv12_frame);
         }
     }
-}
-
-Frame AvPlayerSource::PrepareVideoFrame(GuestBuffer buffer, const AVFrame& frame) {
-    ASSERT(frame.format == AV_PIX_FMT_NV12);
-
-    auto p_buffer = buffer.GetBuffer();
-    CopyNV12Data(p_buffer, frame, m_use_vdec2);
 
     const auto pkt_dts = u64(frame.pkt_dts) * 1000;
     const auto stream = m_avformat_context->streams[m_video_stream_index.value()];
@@ -580,13 +553,6 @@ Frame AvPlayerSource::PrepareVideoFrame(GuestBuffer buffer, const AVFrame& frame
     const auto num = time_base.num;
     const auto timestamp = (num != 0 && den > 1) ? (pkt_dts * num) / den : pkt_dts;
 
-    auto width = u32(frame.width);
-    auto height = u32(frame.height);
-    if (!m_use_vdec2) {
-        width = Common::AlignUp(width, 16);
-        height = Common::AlignUp(height, 16);
-    }
-
     return Frame{
         .buffer = std::move(buffer),
         .info =
@@ -605,7 +571,7 @@ Frame AvPlayerSource::PrepareVideoFrame(GuestBuffer buffer, const AVFrame& frame
                                 .crop_top_offset = u32(frame.crop_top),
                                 .crop_bottom_offset =
                                     u32(frame.crop_bottom + (height - frame.height)),
-                                .pitch = u32(frame.linesize[0]),
+                                .pitch = width,
                                 .luma_bit_depth = 8,
                                 .chroma_bit_depth = 8,
                             },
@@ -662,12 +628,12 @@ void AvPlayerSource::VideoDecoderThread(std::stop_token stop) {
                     // Video buffers queue was cleared. This means that player was stopped.
                     break;
                 }
-                if (up_frame->format != AV_PIX_FMT_NV12) {
-                    const auto nv12_frame = ConvertVideoFrame(*up_frame);
-                    m_video_frames.Push(PrepareVideoFrame(std::move(buffer.value()), *nv12_frame));
-                } else {
-                    m_video_frames.Push(PrepareVideoFrame(std::move(buffer.value()), *up_frame));
+                const AVFrame* frame = m_hwaccel.Download(up_frame.get());
+                if (frame == nullptr) {
+                    m_state.OnError();
+                    return;
                 }
+                m_video_frames.Push(PrepareVideoFrame(std::move(buffer.value()), *frame));
                 m_video_frames_cv.Notify();
             }
         }
@@ -15,6 +15,8 @@
 #include "core/libraries/avplayer/avplayer_common.h"
 #include "core/libraries/avplayer/avplayer_data_streamer.h"
 #include "core/libraries/kernel/threads.h"
+#include "core/libraries/videodec/videodec_frame.h"
+#include "core/libraries/videodec/videodec_hwaccel.h"
 
 struct AVCodecContext;
 struct AVFormatContext;
@@ -22,7 +24,6 @@ struct AVFrame;
 struct AVIOContext;
 struct AVPacket;
 struct SwrContext;
-struct SwsContext;
 
 namespace Libraries::AvPlayer {
 
@@ -164,14 +165,12 @@ private:
     static void ReleaseAVFrame(AVFrame* frame);
     static void ReleaseAVCodecContext(AVCodecContext* context);
     static void ReleaseSWRContext(SwrContext* context);
-    static void ReleaseSWSContext(SwsContext* context);
     static void ReleaseAVFormatContext(AVFormatContext* context);
 
     using AVPacketPtr = std::unique_ptr<AVPacket, decltype(&ReleaseAVPacket)>;
     using AVFramePtr = std::unique_ptr<AVFrame, decltype(&ReleaseAVFrame)>;
     using AVCodecContextPtr = std::unique_ptr<AVCodecContext, decltype(&ReleaseAVCodecContext)>;
     using SWRContextPtr = std::unique_ptr<SwrContext, decltype(&ReleaseSWRContext)>;
-    using SWSContextPtr = std::unique_ptr<SwsContext, decltype(&ReleaseSWSContext)>;
     using AVFormatContextPtr = std::unique_ptr<AVFormatContext, decltype(&ReleaseAVFormatContext)>;
 
     void DemuxerThread(std::stop_token stop);
@@ -181,7 +180,6 @@ private:
     bool HasRunningThreads() const;
 
     AVFramePtr ConvertAudioFrame(const AVFrame& frame);
-    AVFramePtr ConvertVideoFrame(const AVFrame& frame);
 
     Frame PrepareAudioFrame(GuestBuffer buffer, const AVFrame& frame);
     Frame PrepareVideoFrame(GuestBuffer buffer, const AVFrame& frame);
@@ -230,7 +228,8 @@ private:
     AVCodecContextPtr m_video_codec_context{nullptr, &ReleaseAVCodecContext};
     AVCodecContextPtr m_audio_codec_context{nullptr, &ReleaseAVCodecContext};
     SWRContextPtr m_swr_context{nullptr, &ReleaseSWRContext};
-    SWSContextPtr m_sws_context{nullptr, &ReleaseSWSContext};
+    Videodec::HwAccel m_hwaccel;
+    Videodec::NV12Converter m_nv12_converter;
 
     std::optional<u64> m_last_audio_ts{};
     std::optional<std::chrono::high_resolution_clock::time_point> m_start_time{};
@@ -25,6 +25,9 @@ OrbisFiberContext* GetFiberContext() {
 
 extern "C" s32 PS4_SYSV_ABI _sceFiberSetJmp(OrbisFiberContext* ctx) asm("_sceFiberSetJmp");
 extern "C" s32 PS4_SYSV_ABI _sceFiberLongJmp(OrbisFiberContext* ctx) asm("_sceFiberLongJmp");
+extern "C" s32 PS4_SYSV_ABI _sceFiberSwitchContext(OrbisFiberContext* save,
+                                                   OrbisFiberContext* resume) asm(
+    "_sceFiberSwitchContext");
 extern "C" void PS4_SYSV_ABI _sceFiberSwitchEntry(OrbisFiberData* data,
                                                   bool set_fpu) asm("_sceFiberSwitchEntry");
 extern "C" void PS4_SYSV_ABI _sceFiberForceQuit(u64 ret) asm("_sceFiberForceQuit");
@@ -192,6 +195,7 @@ s32 PS4_SYSV_ABI sceFiberInitializeImpl(OrbisFiber* fiber, const char* name, Orb
     fiber->size_context = size_context;
     fiber->context = nullptr;
     fiber->flags = user_flags;
+    fiber->num_switches = 0;
 
     /*
         A low stack area is problematic, as we can easily
@@ -254,6 +258,9 @@ s32 PS4_SYSV_ABI sceFiberFinalize(OrbisFiber* fiber) {
         return ORBIS_FIBER_ERROR_STATE;
     }
 
+    LOG_DEBUG(Lib_Fiber, "Fiber {} finalized after running {} times", fiber->name,
+              fiber->num_switches);
+
     return ORBIS_OK;
 }
 
@@ -294,6 +301,7 @@ s32 PS4_SYSV_ABI sceFiberRunImpl(OrbisFiber* fiber, void* addr_context, u64 size
 
     tcb->tcb_fiber = &ctx;
 
+    ++fiber->num_switches;
     s32 jmp = _sceFiberSetJmp(&ctx);
     if (!jmp) {
         if (fiber->addr_context) {
@@ -365,15 +373,23 @@ s32 PS4_SYSV_ABI sceFiberSwitchImpl(OrbisFiber* fiber, void* addr_context, u64 s
 
     OrbisFiber* cur_fiber = g_ctx->current_fiber;
     if (cur_fiber->addr_context == nullptr) {
+        ++fiber->num_switches;
         _sceFiberSwitch(cur_fiber, fiber, arg_on_run_to, g_ctx);
         __builtin_trap();
     }
 
-    OrbisFiberContext ctx{};
-    s32 jmp = _sceFiberSetJmp(&ctx);
-    if (!jmp) {
-        cur_fiber->context = &ctx;
-        _sceFiberCheckStackOverflow(g_ctx);
+    // Only the registers are used, no need to clear the rest
+    OrbisFiberContext ctx;
+    cur_fiber->context = &ctx;
+    _sceFiberCheckStackOverflow(g_ctx);
+    ++fiber->num_switches;
+    if (fiber->context) {
+        // Common case of a fiber that ran before, save and resume in one go
+        g_ctx->prev_fiber = cur_fiber;
+        g_ctx->current_fiber = fiber;
+        g_ctx->arg_on_run_to = arg_on_run_to;
+        _sceFiberSwitchContext(&ctx, fiber->context);
+    } else if (!_sceFiberSetJmp(&ctx)) {
         _sceFiberSwitch(cur_fiber, fiber, arg_on_run_to, g_ctx);
         __builtin_trap();
     }
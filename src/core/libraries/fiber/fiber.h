@@ -69,6 +69,7 @@ struct OrbisFiber {
     u32 flags;
     void* context_start;
     void* context_end;
+    u64 num_switches; ///< Times the fiber was run or switched to, for profiling
     u32 magic_end;
 };
 static_assert(sizeof(OrbisFiber) <= 256);
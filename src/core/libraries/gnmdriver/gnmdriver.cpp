@@ -2200,29 +2200,34 @@ int PS4_SYSV_ABI sceGnmSubmitCommandBuffersForWorkload(u32 workload, u32 count,
     }
 
     if (send_init_packet) {
+        std::span<const u32> init_sequence;
         if (sdk_version < Common::ElfInfo::FW_20) {
-            liverpool->SubmitGfx(InitSequence, {});
+            init_sequence = InitSequence;
         } else if (sdk_version < Common::ElfInfo::FW_40) {
             if (sceKernelIsNeoMode()) {
                 if (!UseNeoCompatSequences) {
-                    liverpool->SubmitGfx(InitSequence200Neo, {});
+                    init_sequence = InitSequence200Neo;
                 } else {
-                    liverpool->SubmitGfx(InitSequence200NeoCompat, {});
+                    init_sequence = InitSequence200NeoCompat;
                 }
             } else {
-                liverpool->SubmitGfx(InitSequence200, {});
+                init_sequence = InitSequence200;
             }
         } else {
             if (sceKernelIsNeoMode()) {
                 if (!UseNeoCompatSequences) {
-                    liverpool->SubmitGfx(InitSequence350Neo, {});
+                    init_sequence = InitSequence350Neo;
                 } else {
-                    liverpool->SubmitGfx(InitSequence350NeoCompat, {});
+                    init_sequence = InitSequence350NeoCompat;
                 }
             } else {
-                liverpool->SubmitGfx(InitSequence350, {});
+                init_sequence = InitSequence350;
             }
         }
+        if (DebugState.DumpingCurrentFrame()) {
+            DebugState.PushInitSequenceDump(init_sequence);
+        }
+        liverpool->SubmitGfx(init_sequence, {});
         send_init_packet = false;
     }
 
@@ -1,16 +1,27 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <cstring>
 #include <magic_enum/magic_enum.hpp>
 
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/scope_exit.h"
 #include "core/libraries/error_codes.h"
 #include "core/libraries/libs.h"
+#include "core/memory.h"
 #include "jpeg_error.h"
 #include "jpegenc.h"
 
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+#include "common/support/avdec.h"
+
 namespace Libraries::JpegEnc {
 
 constexpr s32 ORBIS_JPEG_ENC_MINIMUM_MEMORY_SIZE = 0x800;
@@ -120,6 +131,108 @@ static s32 ValidateJpegEncEncodeParam(const OrbisJpegEncEncodeParam* param) {
     return ORBIS_OK;
 }
 
+static AVPixelFormat MapPixelFormat(OrbisJpegEncEncodeParamPixelFormat format) {
+    switch (format) {
+    case ORBIS_JPEG_ENC_PIXEL_FORMAT_R8G8B8A8:
+        return AV_PIX_FMT_RGBA;
+    case ORBIS_JPEG_ENC_PIXEL_FORMAT_B8G8R8A8:
+        return AV_PIX_FMT_BGRA;
+    case ORBIS_JPEG_ENC_PIXEL_FORMAT_Y8U8Y8V8:
+        return AV_PIX_FMT_YUYV422;
+    case ORBIS_JPEG_ENC_PIXEL_FORMAT_Y8:
+        return AV_PIX_FMT_GRAY8;
+    default:
+        UNREACHABLE_MSG("Unknown pixel format {}", static_cast<u32>(format));
+    }
+}
+
+static AVPixelFormat MapSamplingType(OrbisJpengEncEncodeParamSamplingType type) {
+    switch (type) {
+    case ORBIS_JPEG_ENC_SAMPLING_TYPE_422:
+        return AV_PIX_FMT_YUVJ422P;
+    case ORBIS_JPEG_ENC_SAMPLING_TYPE_420:
+        return AV_PIX_FMT_YUVJ420P;
+    default:
+        // Grayscale images are encoded with flat chroma, the MJPEG encoder has no gray format
+        return AV_PIX_FMT_YUVJ444P;
+    }
+}
+
+/// Returns the size of the JPEG written to param->jpeg, or an error code. The image is converted
+/// by swscale and compressed by the MJPEG encoder of FFmpeg, which uses its SIMD integer DCT on
+/// x86 and splits the image into slices encoded on their own threads.
+static s32 EncodeJpeg(const OrbisJpegEncEncodeParam* param) {
+    const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+    if (!codec) {
+        LOG_ERROR(Lib_Jpeg, "FFmpeg was built without the MJPEG encoder");
+        return ORBIS_JPEG_ENC_ERROR_INVALID_PARAM;
+    }
+    const s32 width = param->image_width;
+    const s32 height = param->image_height;
+    const AVPixelFormat src_format = MapPixelFormat(param->pixel_format);
+    const AVPixelFormat dst_format = MapSamplingType(param->sampling_type);
+
+    AVCodecContext* context = avcodec_alloc_context3(codec);
+    AVFrame* frame = av_frame_alloc();
+    AVPacket* packet = av_packet_alloc();
+    SwsContext* sws_context = sws_getContext(width, height, src_format, width, height, dst_format,
+                                             SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+    SCOPE_EXIT {
+        sws_freeContext(sws_context);
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+        avcodec_free_context(&context);
+    };
+    if (!context || !frame || !packet || !sws_context) {
+        return ORBIS_JPEG_ENC_ERROR_INVALID_PARAM;
+    }
+
+    context->width = width;
+    context->height = height;
+    context->pix_fmt = dst_format;
+    context->time_base = {1, 1};
+    context->thread_count = 0;
+    context->thread_type = FF_THREAD_SLICE;
+    // Map the compression ratio to the quantizer scale, from 2 for the best quality to 31
+    context->flags |= AV_CODEC_FLAG_QSCALE;
+    context->global_quality = FF_QP2LAMBDA * std::clamp(2 + param->compression_ratio * 29 / 255,
+                                                        2, 31);
+    int ret = avcodec_open2(context, codec, nullptr);
+    if (ret >= 0) {
+        frame->format = dst_format;
+        frame->width = width;
+        frame->height = height;
+        ret = av_frame_get_buffer(frame, 0);
+    }
+    if (ret < 0) {
+        LOG_ERROR(Lib_Jpeg, "Could not set up the MJPEG encoder: {}", av_err2str(ret));
+        return ORBIS_JPEG_ENC_ERROR_INVALID_PARAM;
+    }
+
+    const u8* const src_data[4] = {static_cast<const u8*>(param->image)};
+    const int src_linesize[4] = {static_cast<int>(param->image_pitch)};
+    sws_scale(sws_context, src_data, src_linesize, 0, height, frame->data, frame->linesize);
+    frame->pts = 0;
+
+    ret = avcodec_send_frame(context, frame);
+    if (ret >= 0) {
+        ret = avcodec_receive_packet(context, packet);
+    }
+    if (ret < 0) {
+        LOG_ERROR(Lib_Jpeg, "Could not encode the image: {}", av_err2str(ret));
+        return ORBIS_JPEG_ENC_ERROR_INVALID_PARAM;
+    }
+    if (static_cast<u32>(packet->size) > param->jpeg_size) {
+        LOG_ERROR(Lib_Jpeg, "JPEG of {} bytes does not fit the buffer of {} bytes", packet->size,
+                  param->jpeg_size);
+        return ORBIS_JPEG_ENC_ERROR_INVALID_SIZE;
+    }
+    Core::Memory::Instance()->InvalidateMemory(reinterpret_cast<VAddr>(param->jpeg),
+                                               packet->size);
+    std::memcpy(param->jpeg, packet->data, packet->size);
+    return packet->size;
+}
+
 static s32 ValidateJpecEngHandle(OrbisJpegEncHandle handle) {
     if (!handle || !Common::IsAligned(reinterpret_cast<VAddr>(handle), 0x20) ||
         handle->handle != handle) {
@@ -172,8 +285,8 @@ s32 PS4_SYSV_ABI sceJpegEncEncode(OrbisJpegEncHandle handle, const OrbisJpegEncE
         return param_ret;
     }
 
-    LOG_ERROR(Lib_Jpeg,
-              "(STUBBED) image_size = {} , jpeg_size = {} , image_width = {} , image_height = {} , "
+    LOG_TRACE(Lib_Jpeg,
+              "image_size = {} , jpeg_size = {} , image_width = {} , image_height = {} , "
               "image_pitch = {} , pixel_format = {} , encode_mode = {} , color_space = {} , "
               "sampling_type = {} , compression_ratio = {} , restart_interval = {}",
               param->image_size, param->jpeg_size, param->image_width, param->image_height,
@@ -182,8 +295,12 @@ s32 PS4_SYSV_ABI sceJpegEncEncode(OrbisJpegEncHandle handle, const OrbisJpegEncE
               magic_enum::enum_name(param->sampling_type), param->compression_ratio,
               param->restart_interval);
 
+    const s32 size = EncodeJpeg(param);
+    if (size < 0) {
+        return size;
+    }
     if (output_info) {
-        output_info->size = param->jpeg_size;
+        output_info->size = size;
         output_info->height = param->image_height;
     }
     return ORBIS_OK;
@@ -1,23 +1,175 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <queue>
 #include <thread>
 
 #include "aio.h"
 #include "common/assert.h"
 #include "common/debug.h"
 #include "common/logging/log.h"
+#include "common/polyfill_thread.h"
+#include "common/thread.h"
 #include "core/libraries/kernel/equeue.h"
 #include "core/libraries/kernel/orbis_error.h"
 #include "core/libraries/libs.h"
+#include "core/thread.h"
 #include "file_system.h"
 
 namespace Libraries::Kernel {
 
 #define MAX_QUEUE 512
 
-static s32* id_state;
-static s32 id_index;
+namespace {
+
+struct AioCommand {
+    std::vector<OrbisKernelAioRWRequest> requests;
+    OrbisKernelAioSubmitId id;
+    s32 prio;
+    u64 sequence;
+    bool is_write;
+    bool abort_on_error;
+
+    /// Higher priorities first, then in submission order.
+    bool operator<(const AioCommand& other) const {
+        return prio != other.prio ? prio < other.prio : sequence > other.sequence;
+    }
+};
+
+/// Runs submitted commands on worker threads, so the submitting guest thread only blocks
+/// when it waits for them.
+class AioEngine {
+public:
+    static constexpr u32 NumWorkers = 2;
+
+    AioEngine() {
+        for (auto& state : states) {
+            state = 0;
+        }
+        for (u32 i = 0; i < NumWorkers; ++i) {
+            workers.emplace_back([this](std::stop_token stop_token) { WorkerLoop(stop_token); });
+        }
+    }
+
+    OrbisKernelAioSubmitId Submit(const OrbisKernelAioRWRequest* requests, s32 count, s32 prio,
+                                  bool is_write, bool abort_on_error) {
+        AioCommand command{
+            .requests{requests, requests + count},
+            .prio = prio,
+            .is_write = is_write,
+            .abort_on_error = abort_on_error,
+        };
+        std::scoped_lock lock{mutex};
+        const OrbisKernelAioSubmitId id = next_id;
+        // Id 0 is never handed out, sceKernelAioCancelRequest treats it specially
+        next_id = next_id + 1 == MAX_QUEUE ? 1 : next_id + 1;
+        command.id = id;
+        command.sequence = next_sequence++;
+        states[id].store(ORBIS_KERNEL_AIO_STATE_SUBMITTED, std::memory_order_release);
+        for (const auto& request : command.requests) {
+            request.result->state = ORBIS_KERNEL_AIO_STATE_SUBMITTED;
+        }
+        queue.push(std::move(command));
+        work_cv.notify_one();
+        return id;
+    }
+
+    s32 GetState(OrbisKernelAioSubmitId id) const {
+        return states[id].load(std::memory_order_acquire);
+    }
+
+    /// Aborts a command that didn't start yet, returning the state it is in afterwards.
+    s32 Cancel(OrbisKernelAioSubmitId id) {
+        std::scoped_lock lock{mutex};
+        s32 expected = ORBIS_KERNEL_AIO_STATE_SUBMITTED;
+        if (states[id].compare_exchange_strong(expected, ORBIS_KERNEL_AIO_STATE_ABORTED)) {
+            done_cv.notify_all();
+            return ORBIS_KERNEL_AIO_STATE_ABORTED;
+        }
+        return expected;
+    }
+
+    /// Waits until done returns true, or the timeout in microseconds runs out if it isn't 0.
+    /// Returns false on timeout.
+    template <typename Pred>
+    bool Wait(u32 timeout_us, Pred&& done) {
+        std::unique_lock lock{mutex};
+        if (timeout_us == 0) {
+            done_cv.wait(lock, done);
+            return true;
+        }
+        return done_cv.wait_for(lock, std::chrono::microseconds{timeout_us}, done);
+    }
+
+    static bool IsPending(s32 state) {
+        return state == ORBIS_KERNEL_AIO_STATE_SUBMITTED ||
+               state == ORBIS_KERNEL_AIO_STATE_PROCESSING;
+    }
+
+private:
+    void WorkerLoop(std::stop_token stop_token) {
+        Common::SetCurrentThreadName("shadPS4:AioWorker");
+        Core::KeepCurrentThreadOffGuestCores();
+        while (!stop_token.stop_requested()) {
+            AioCommand command;
+            {
+                std::unique_lock lock{mutex};
+                Common::CondvarWait(work_cv, lock, stop_token, [this] { return !queue.empty(); });
+                if (stop_token.stop_requested()) {
+                    break;
+                }
+                command = std::move(const_cast<AioCommand&>(queue.top()));
+                queue.pop();
+            }
+            Execute(command);
+        }
+    }
+
+    void Execute(AioCommand& command) {
+        s32 expected = ORBIS_KERNEL_AIO_STATE_SUBMITTED;
+        if (!states[command.id].compare_exchange_strong(expected,
+                                                        ORBIS_KERNEL_AIO_STATE_PROCESSING)) {
+            // Cancelled before it started
+            return;
+        }
+        s32 state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
+        for (auto& request : command.requests) {
+            request.result->state = ORBIS_KERNEL_AIO_STATE_PROCESSING;
+            const s64 ret = command.is_write ? sceKernelPwrite(request.fd, request.buf,
+                                                               request.nbyte, request.offset)
+                                             : sceKernelPread(request.fd, request.buf,
+                                                              request.nbyte, request.offset);
+            request.result->returnValue = ret;
+            request.result->state =
+                ret < 0 ? ORBIS_KERNEL_AIO_STATE_ABORTED : ORBIS_KERNEL_AIO_STATE_COMPLETED;
+            if (ret < 0 && command.abort_on_error) {
+                state = ORBIS_KERNEL_AIO_STATE_ABORTED;
+            }
+        }
+        {
+            // Taken so a waiter can't miss the notification between its check and its wait
+            std::scoped_lock lock{mutex};
+            states[command.id].store(state, std::memory_order_release);
+        }
+        done_cv.notify_all();
+    }
+
+    std::array<std::atomic<s32>, MAX_QUEUE> states;
+    std::mutex mutex;
+    std::condition_variable_any work_cv;
+    std::condition_variable done_cv;
+    std::priority_queue<AioCommand> queue;
+    OrbisKernelAioSubmitId next_id = 1;
+    u64 next_sequence = 0;
+    std::vector<std::jthread> workers;
+};
+
+std::unique_ptr<AioEngine> aio_engine;
+
+} // Anonymous namespace
 
 s32 PS4_SYSV_ABI sceKernelAioInitializeImpl(void* p, s32 size) {
 
@@ -28,7 +180,7 @@ s32 PS4_SYSV_ABI sceKernelAioDeleteRequest(OrbisKernelAioSubmitId id, s32* ret)
     if (ret == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    id_state[id] = ORBIS_KERNEL_AIO_STATE_ABORTED;
+    aio_engine->Cancel(id);
     *ret = 0;
     return 0;
 }
@@ -38,7 +190,7 @@ s32 PS4_SYSV_ABI sceKernelAioDeleteRequests(OrbisKernelAioSubmitId id[], s32 num
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
     for (s32 i = 0; i < num; i++) {
-        id_state[id[i]] = ORBIS_KERNEL_AIO_STATE_ABORTED;
+        aio_engine->Cancel(id[i]);
         ret[i] = 0;
     }
 
@@ -48,7 +200,7 @@ s32 PS4_SYSV_ABI sceKernelAioPollRequest(OrbisKernelAioSubmitId id, s32* state)
     if (state == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    *state = id_state[id];
+    *state = aio_engine->GetState(id);
     return 0;
 }
 
@@ -57,7 +209,7 @@ s32 PS4_SYSV_ABI sceKernelAioPollRequests(OrbisKernelAioSubmitId id[], s32 num,
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
     for (s32 i = 0; i < num; i++) {
-        state[i] = id_state[id[i]];
+        state[i] = aio_engine->GetState(id[i]);
     }
 
     return 0;
@@ -68,8 +220,7 @@ s32 PS4_SYSV_ABI sceKernelAioCancelRequest(OrbisKernelAioSubmitId id, s32* state
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
     if (id) {
-        id_state[id] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-        *state = ORBIS_KERNEL_AIO_STATE_ABORTED;
+        *state = aio_engine->Cancel(id);
     } else {
         *state = ORBIS_KERNEL_AIO_STATE_PROCESSING;
     }
@@ -82,8 +233,7 @@ s32 PS4_SYSV_ABI sceKernelAioCancelRequests(OrbisKernelAioSubmitId id[], s32 num
     }
     for (s32 i = 0; i < num; i++) {
         if (id[i]) {
-            id_state[id[i]] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            state[i] = ORBIS_KERNEL_AIO_STATE_ABORTED;
+            state[i] = aio_engine->Cancel(id[i]);
         } else {
             state[i] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
         }
@@ -96,27 +246,11 @@ s32 PS4_SYSV_ABI sceKernelAioWaitRequest(OrbisKernelAioSubmitId id, s32* state,
     if (state == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    u32 timer = 0;
-
-    s32 timeout = 0;
-
-    while (id_state[id] == ORBIS_KERNEL_AIO_STATE_PROCESSING) {
-        sceKernelUsleep(10);
-
-        timer += 10;
-        if (*usec) {
-            if (timer > *usec) {
-                timeout = 1;
-                break;
-            }
-        }
-    }
-
-    *state = id_state[id];
-
-    if (timeout)
-        return ORBIS_KERNEL_ERROR_ETIMEDOUT;
-    return 0;
+    const u32 timeout_us = usec != nullptr ? *usec : 0;
+    const bool done = aio_engine->Wait(
+        timeout_us, [id] { return !AioEngine::IsPending(aio_engine->GetState(id)); });
+    *state = aio_engine->GetState(id);
+    return done ? 0 : ORBIS_KERNEL_ERROR_ETIMEDOUT;
 }
 
 s32 PS4_SYSV_ABI sceKernelAioWaitRequests(OrbisKernelAioSubmitId id[], s32 num, s32 state[],
@@ -124,37 +258,25 @@ s32 PS4_SYSV_ABI sceKernelAioWaitRequests(OrbisKernelAioSubmitId id[], s32 num,
     if (state == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    u32 timer = 0;
-    s32 timeout = 0;
-    s32 completion = 0;
-
-    for (s32 i = 0; i < num; i++) {
-        if (!completion && !timeout) {
-            while (id_state[id[i]] == ORBIS_KERNEL_AIO_STATE_PROCESSING) {
-                sceKernelUsleep(10);
-                timer += 10;
-
-                if (*usec) {
-                    if (timer > *usec) {
-                        timeout = 1;
-                        break;
-                    }
-                }
+    // Mode 0x02 waits for any of the requests to be done, otherwise all of them.
+    const bool wait_any = mode == 0x02;
+    const u32 timeout_us = usec != nullptr ? *usec : 0;
+    const bool done = aio_engine->Wait(timeout_us, [&] {
+        for (s32 i = 0; i < num; i++) {
+            const bool pending = AioEngine::IsPending(aio_engine->GetState(id[i]));
+            if (wait_any && !pending) {
+                return true;
+            }
+            if (!wait_any && pending) {
+                return false;
             }
         }
-
-        if (mode == 0x02) {
-            if (id_state[id[i]] == ORBIS_KERNEL_AIO_STATE_COMPLETED)
-                completion = 1;
-        }
-
-        state[i] = id_state[id[i]];
+        return !wait_any;
+    });
+    for (s32 i = 0; i < num; i++) {
+        state[i] = aio_engine->GetState(id[i]);
     }
-
-    if (timeout)
-        return ORBIS_KERNEL_ERROR_ETIMEDOUT;
-
-    return 0;
+    return done ? 0 : ORBIS_KERNEL_ERROR_ETIMEDOUT;
 }
 
 s32 PS4_SYSV_ABI sceKernelAioSubmitReadCommands(OrbisKernelAioRWRequest req[], s32 size, s32 prio,
@@ -165,31 +287,7 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitReadCommands(OrbisKernelAioRWRequest req[], s
     if (id == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-
-    for (s32 i = 0; i < size; i++) {
-
-        s64 ret = sceKernelPread(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-        }
-    }
-
-    id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-
-    *id = id_index;
-
-    id_index = (id_index + 1) % MAX_QUEUE;
-
-    if (!id_index)
-        id_index++;
-
+    *id = aio_engine->Submit(req, size, prio, false, false);
     return 0;
 }
 
@@ -202,29 +300,7 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitReadCommandsMultiple(OrbisKernelAioRWRequest
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
     for (s32 i = 0; i < size; i++) {
-        id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-
-        s64 ret = sceKernelPread(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-        }
-
-        id[i] = id_index;
-
-        id_index = (id_index + 1) % MAX_QUEUE;
-
-        if (!id_index)
-            id_index++;
+        id[i] = aio_engine->Submit(&req[i], 1, prio, false, true);
     }
 
     return 0;
@@ -238,34 +314,7 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitWriteCommands(OrbisKernelAioRWRequest req[],
     if (id == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    for (s32 i = 0; i < size; i++) {
-        id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-
-        s64 ret = sceKernelPwrite(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-        }
-    }
-
-    *id = id_index;
-
-    id_index = (id_index + 1) % MAX_QUEUE;
-
-    // skip id_index equals 0 , because sceKernelAioCancelRequest will submit id
-    // equal to 0
-    if (!id_index)
-        id_index++;
-
+    *id = aio_engine->Submit(req, size, prio, true, true);
     return 0;
 }
 
@@ -278,26 +327,7 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitWriteCommandsMultiple(OrbisKernelAioRWRequest
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
     for (s32 i = 0; i < size; i++) {
-        id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-        s64 ret = sceKernelPwrite(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-        }
-
-        id[i] = id_index;
-        id_index = (id_index + 1) % MAX_QUEUE;
-
-        if (!id_index)
-            id_index++;
+        id[i] = aio_engine->Submit(&req[i], 1, prio, true, true);
     }
     return 0;
 }
@@ -313,9 +343,7 @@ s32 PS4_SYSV_ABI sceKernelAioInitializeParam() {
 }
 
 void RegisterAio(Core::Loader::SymbolsResolver* sym) {
-    id_index = 1;
-    id_state = (int*)malloc(sizeof(int) * MAX_QUEUE);
-    memset(id_state, 0, sizeof(sizeof(int) * MAX_QUEUE));
+    aio_engine = std::make_unique<AioEngine>();
 
     LIB_FUNCTION("fR521KIGgb8", "libkernel", 1, "libkernel", sceKernelAioCancelRequest);
     LIB_FUNCTION("3Lca1XBrQdY", "libkernel", 1, "libkernel", sceKernelAioCancelRequests);
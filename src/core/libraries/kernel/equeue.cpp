@@ -1,11 +1,13 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <thread>
 
 #include "common/assert.h"
 #include "common/debug.h"
 #include "common/logging/log.h"
+#include "common/perf_counters.h"
 #include "core/libraries/kernel/equeue.h"
 #include "core/libraries/kernel/orbis_error.h"
 #include "core/libraries/libs.h"
@@ -17,7 +19,8 @@ extern void KernelSignalRequest();
 
 static constexpr auto HrTimerSpinlockThresholdUs = 1200u;
 
-// Events are uniquely identified by id and filter.
+/// Small timers that are due within this time are spun on instead of waited for.
+static constexpr auto SmallTimerSpinThreshold = std::chrono::microseconds{200};
 
 bool EqueueInternal::AddEvent(EqueueEvent& event) {
     std::scoped_lock lock{m_mutex};
@@ -32,13 +35,12 @@ bool EqueueInternal::AddEvent(EqueueEvent& event) {
         event.timer_interval = std::chrono::microseconds(event.event.data - offset);
     }
 
-    const auto& it = std::ranges::find(m_events, event);
-    if (it != m_events.cend()) {
-        *it = std::move(event);
-    } else {
-        m_events.emplace_back(std::move(event));
+    const EventKey key{event.event.ident, event.event.filter};
+    const bool is_triggered = event.IsTriggered();
+    m_events.insert_or_assign(key, std::move(event));
+    if (is_triggered) {
+        m_triggered.push_back(key);
     }
-
     return true;
 }
 
@@ -46,26 +48,24 @@ bool EqueueInternal::ScheduleEvent(u64 id, s16 filter,
                                    void (*callback)(SceKernelEqueue, const SceKernelEvent&)) {
     std::scoped_lock lock{m_mutex};
 
-    const auto& it = std::ranges::find_if(m_events, [id, filter](auto& ev) {
-        return ev.event.ident == id && ev.event.filter == filter;
-    });
-    if (it == m_events.cend()) {
+    const auto it = m_events.find(EventKey{id, filter});
+    if (it == m_events.end()) {
         return false;
     }
 
-    const auto& event = *it;
+    auto& event = it.value();
     ASSERT(event.event.filter == SceKernelEvent::Filter::Timer ||
            event.event.filter == SceKernelEvent::Filter::HrTimer);
 
-    if (!it->timer) {
-        it->timer = std::make_unique<boost::asio::steady_timer>(io_context, event.timer_interval);
+    if (!event.timer) {
+        event.timer = std::make_unique<boost::asio::steady_timer>(io_context, event.timer_interval);
     } else {
         // If the timer already exists we are scheduling a reoccurrence after the next period.
         // Set the expiration time to the previous occurrence plus the period.
-        it->timer->expires_at(it->timer->expiry() + event.timer_interval);
+        event.timer->expires_at(event.timer->expiry() + event.timer_interval);
     }
 
-    it->timer->async_wait(
+    event.timer->async_wait(
         [this, event_data = event.event, callback](const boost::system::error_code& ec) {
             if (ec) {
                 if (ec != boost::system::errc::operation_canceled) {
@@ -84,17 +84,9 @@ bool EqueueInternal::ScheduleEvent(u64 id, s16 filter,
 }
 
 bool EqueueInternal::RemoveEvent(u64 id, s16 filter) {
-    bool has_found = false;
     std::scoped_lock lock{m_mutex};
-
-    const auto& it = std::ranges::find_if(m_events, [id, filter](auto& ev) {
-        return ev.event.ident == id && ev.event.filter == filter;
-    });
-    if (it != m_events.cend()) {
-        m_events.erase(it);
-        has_found = true;
-    }
-    return has_found;
+    // Its trigger entries are skipped once they come up
+    return m_events.erase(EventKey{id, filter}) > 0;
 }
 
 int EqueueInternal::WaitForEvents(SceKernelEvent* ev, int num, const SceKernelUseconds* timo) {
@@ -110,27 +102,31 @@ int EqueueInternal::WaitForEvents(SceKernelEvent* ev, int num, const SceKernelUs
         return WaitForSmallTimer(ev, num, micros);
     }
 
+    const auto wait_start = std::chrono::steady_clock::now();
     int count = 0;
 
     const auto predicate = [&] {
-        count = GetTriggeredEvents(ev, num);
+        count = GetTriggeredEventsLocked(ev, num);
         return count > 0;
     };
 
-    if (micros == 0) {
-        // Wait indefinitely for events
-        std::unique_lock lock{m_mutex};
-        m_cond.wait(lock, predicate);
-    } else {
-        // Wait up until the timeout value
+    {
         std::unique_lock lock{m_mutex};
-        m_cond.wait_for(lock, std::chrono::microseconds(micros), predicate);
+        ++m_num_waiters;
+        if (micros == 0) {
+            // Wait indefinitely for events
+            m_cond.wait(lock, predicate);
+        } else {
+            // Wait up until the timeout value
+            m_cond.wait_for(lock, std::chrono::microseconds(micros), predicate);
+        }
+        --m_num_waiters;
     }
 
     if (HasSmallTimer()) {
         if (count > 0) {
             const auto time_waited = std::chrono::duration_cast<std::chrono::microseconds>(
-                                         std::chrono::steady_clock::now() - m_events[0].time_added)
+                                         std::chrono::steady_clock::now() - wait_start)
                                          .count();
             count = WaitForSmallTimer(ev, num, std::max(0l, long(micros - time_waited)));
         }
@@ -140,49 +136,57 @@ int EqueueInternal::WaitForEvents(SceKernelEvent* ev, int num, const SceKernelUs
 }
 
 bool EqueueInternal::TriggerEvent(u64 ident, s16 filter, void* trigger_data) {
-    bool has_found = false;
     {
         std::scoped_lock lock{m_mutex};
-        for (auto& event : m_events) {
-            if (event.event.ident == ident && event.event.filter == filter) {
-                if (filter == SceKernelEvent::Filter::VideoOut) {
-                    event.TriggerDisplay(trigger_data);
-                } else if (filter == SceKernelEvent::Filter::User) {
-                    event.TriggerUser(trigger_data);
-                } else {
-                    event.Trigger(trigger_data);
-                }
-                has_found = true;
-            }
+        const auto it = m_events.find(EventKey{ident, filter});
+        if (it == m_events.end()) {
+            return false;
+        }
+        auto& event = it.value();
+        const bool was_triggered = event.IsTriggered();
+        if (filter == SceKernelEvent::Filter::VideoOut) {
+            event.TriggerDisplay(trigger_data);
+        } else if (filter == SceKernelEvent::Filter::User) {
+            event.TriggerUser(trigger_data);
+        } else {
+            event.Trigger(trigger_data);
+        }
+        if (!was_triggered) {
+            m_triggered.push_back(it->first);
         }
     }
-    m_cond.notify_one();
-    return has_found;
+    // A waiter registers under the lock before it checks for events, so it can't be missed
+    if (m_num_waiters.load(std::memory_order_relaxed) != 0) {
+        m_cond.notify_all();
+    }
+    return true;
 }
 
 int EqueueInternal::GetTriggeredEvents(SceKernelEvent* ev, int num) {
+    std::scoped_lock lock{m_mutex};
+    return GetTriggeredEventsLocked(ev, num);
+}
+
+int EqueueInternal::GetTriggeredEventsLocked(SceKernelEvent* ev, int num) {
     int count = 0;
-    for (auto it = m_events.begin(); it != m_events.end();) {
-        if (it->IsTriggered()) {
-            ev[count++] = it->event;
+    while (count < num && !m_triggered.empty()) {
+        const EventKey key = m_triggered.front();
+        m_triggered.pop_front();
+        const auto it = m_events.find(key);
+        if (it == m_events.end() || !it->second.IsTriggered()) {
+            continue;
+        }
+        auto& event = it.value();
+        ev[count++] = event.event;
 
-            // Event should not trigger again
-            it->ResetTriggerState();
+        // Event should not trigger again
+        event.ResetTriggerState();
 
-            if (it->event.flags & SceKernelEvent::Flags::Clear) {
-                it->Clear();
-            }
-            if (it->event.flags & SceKernelEvent::Flags::OneShot) {
-                it = m_events.erase(it);
-            } else {
-                ++it;
-            }
-
-            if (count == num) {
-                break;
-            }
-        } else {
-            ++it;
+        if (event.event.flags & SceKernelEvent::Flags::Clear) {
+            event.Clear();
+        }
+        if (event.event.flags & SceKernelEvent::Flags::OneShot) {
+            m_events.erase(it);
         }
     }
 
@@ -190,56 +194,72 @@ int EqueueInternal::GetTriggeredEvents(SceKernelEvent* ev, int num) {
 }
 
 bool EqueueInternal::AddSmallTimer(EqueueEvent& ev) {
-    SmallTimer st;
-    st.event = ev.event;
-    st.added = std::chrono::steady_clock::now();
-    st.interval = std::chrono::microseconds{ev.event.data};
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::microseconds{ev.event.data};
     {
         std::scoped_lock lock{m_mutex};
-        m_small_timers[st.event.ident] = std::move(st);
+        std::erase_if(m_small_timers,
+                      [&](const auto& timer) { return timer.second.ident == ev.event.ident; });
+        m_small_timers.emplace(deadline, ev.event);
+    }
+    // Waiters may sleep until a later deadline
+    if (m_num_waiters.load(std::memory_order_relaxed) != 0) {
+        m_cond.notify_all();
     }
     return true;
 }
 
+bool EqueueInternal::RemoveSmallTimer(u64 id) {
+    std::scoped_lock lock{m_mutex};
+    return std::erase_if(m_small_timers,
+                         [id](const auto& timer) { return timer.second.ident == id; }) > 0;
+}
+
 int EqueueInternal::WaitForSmallTimer(SceKernelEvent* ev, int num, u32 micros) {
     ASSERT(num >= 1);
 
-    auto curr_clock = std::chrono::steady_clock::now();
-    const auto wait_end_us = (micros == 0) ? std::chrono::steady_clock::time_point::max()
-                                           : curr_clock + std::chrono::microseconds{micros};
-    int count = 0;
-    do {
-        curr_clock = std::chrono::steady_clock::now();
-        {
-            std::scoped_lock lock{m_mutex};
-            for (auto it = m_small_timers.begin(); it != m_small_timers.end() && count < num;) {
-                const SmallTimer& st = it->second;
-
-                if (curr_clock - st.added >= st.interval) {
-                    ev[count++] = st.event;
-                    it = m_small_timers.erase(it);
-                } else {
-                    ++it;
-                }
-            }
-
-            if (count > 0)
-                return count;
+    using Clock = std::chrono::steady_clock;
+    const auto wait_end_us = (micros == 0) ? Clock::time_point::max()
+                                           : Clock::now() + std::chrono::microseconds{micros};
+    std::unique_lock lock{m_mutex};
+    while (true) {
+        const auto curr_clock = Clock::now();
+        int count = 0;
+        while (count < num && !m_small_timers.empty() &&
+               m_small_timers.begin()->first <= curr_clock) {
+            ev[count++] = m_small_timers.begin()->second;
+            m_small_timers.erase(m_small_timers.begin());
+        }
+        if (count > 0) {
+            return count;
+        }
+        if (curr_clock >= wait_end_us) {
+            return 0;
         }
-        std::this_thread::yield();
-    } while (curr_clock < wait_end_us);
 
-    return 0;
+        // Sleep until shortly before the next deadline, then spin for precision
+        const auto next_deadline = std::min(
+            m_small_timers.empty() ? Clock::time_point::max() : m_small_timers.begin()->first,
+            wait_end_us);
+        if (next_deadline - curr_clock <= SmallTimerSpinThreshold) {
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+            continue;
+        }
+        ++m_num_waiters;
+        if (next_deadline == Clock::time_point::max()) {
+            m_cond.wait(lock);
+        } else {
+            m_cond.wait_until(lock, next_deadline - SmallTimerSpinThreshold);
+        }
+        --m_num_waiters;
+    }
 }
 
 bool EqueueInternal::EventExists(u64 id, s16 filter) {
     std::scoped_lock lock{m_mutex};
-
-    const auto& it = std::ranges::find_if(m_events, [id, filter](auto& ev) {
-        return ev.event.ident == id && ev.event.filter == filter;
-    });
-
-    return it != m_events.cend();
+    return m_events.find(EventKey{id, filter}) != m_events.end();
 }
 
 int PS4_SYSV_ABI sceKernelCreateEqueue(SceKernelEqueue* eq, const char* name) {
@@ -279,6 +299,7 @@ int PS4_SYSV_ABI sceKernelWaitEqueue(SceKernelEqueue eq, SceKernelEvent* ev, int
     HLE_TRACE;
     TRACE_HINT(eq->GetName());
     LOG_TRACE(Kernel_Event, "equeue = {} num = {}", eq->GetName(), num);
+    Common::CountPerf(Common::PerfCounter::GuestWaits);
 
     if (eq == nullptr) {
         return ORBIS_KERNEL_ERROR_EBADF;
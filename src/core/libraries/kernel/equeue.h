@@ -3,13 +3,15 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <map>
 #include <mutex>
 #include <string>
-#include <vector>
 #include <boost/asio/steady_timer.hpp>
+#include <tsl/robin_map.h>
 
-#include <unordered_map>
 #include "common/rdtsc.h"
 #include "common/types.h"
 
@@ -136,10 +138,18 @@ private:
 };
 
 class EqueueInternal {
-    struct SmallTimer {
-        SceKernelEvent event;
-        std::chrono::steady_clock::time_point added;
-        std::chrono::microseconds interval;
+    /// Events are uniquely identified by id and filter.
+    struct EventKey {
+        u64 ident;
+        s16 filter;
+
+        bool operator==(const EventKey&) const = default;
+    };
+
+    struct EventKeyHash {
+        size_t operator()(const EventKey& key) const {
+            return std::hash<u64>{}(key.ident * 31 + static_cast<u16>(key.filter));
+        }
     };
 
 public:
@@ -162,24 +172,25 @@ public:
         std::scoped_lock lock{m_mutex};
         return !m_small_timers.empty();
     }
-    bool RemoveSmallTimer(u64 id) {
-        if (HasSmallTimer()) {
-            std::scoped_lock lock{m_mutex};
-            return m_small_timers.erase(id) > 0;
-        }
-        return false;
-    }
+    bool RemoveSmallTimer(u64 id);
 
     int WaitForSmallTimer(SceKernelEvent* ev, int num, u32 micros);
 
     bool EventExists(u64 id, s16 filter);
 
 private:
+    int GetTriggeredEventsLocked(SceKernelEvent* ev, int num);
+
     std::string m_name;
     std::mutex m_mutex;
-    std::vector<EqueueEvent> m_events;
+    tsl::robin_map<EventKey, EqueueEvent, EventKeyHash> m_events;
+    /// Events in the order they triggered. Entries of events that were removed or already
+    /// returned since are skipped.
+    std::deque<EventKey> m_triggered;
     std::condition_variable m_cond;
-    std::unordered_map<u64, SmallTimer> m_small_timers;
+    std::atomic<u32> m_num_waiters{}; ///< Triggers only notify when somebody waits
+    /// Small timers ordered by deadline, at most one per id
+    std::multimap<std::chrono::steady_clock::time_point, SceKernelEvent> m_small_timers;
 };
 
 u64 PS4_SYSV_ABI sceKernelGetEventData(const SceKernelEvent* ev);
@@ -1,11 +1,13 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <cstring>
 #include <map>
 #include <ranges>
 #include <magic_enum/magic_enum.hpp>
 
 #include "common/assert.h"
+#include "common/config.h"
 #include "common/error.h"
 #include "common/logging/log.h"
 #include "common/scope_exit.h"
@@ -14,6 +16,7 @@
 #include "core/file_sys/devices/deci_tty6_device.h"
 #include "core/file_sys/devices/logger.h"
 #include "core/file_sys/devices/nop_device.h"
+#include "core/file_sys/devices/pfs_image_file.h"
 #include "core/file_sys/devices/random_device.h"
 #include "core/file_sys/devices/rng_device.h"
 #include "core/file_sys/devices/srandom_device.h"
@@ -26,6 +29,7 @@
 #include "core/libraries/kernel/posix_error.h"
 #include "core/libraries/libs.h"
 #include "core/libraries/network/sockets.h"
+#include "core/libraries/playgo/playgo_prefetch.h"
 #include "core/memory.h"
 #include "kernel.h"
 
@@ -73,6 +77,9 @@ static std::map<std::string, FactoryDevice> available_device = {
 
 namespace Libraries::Kernel {
 
+/// Reads at least this big are copied from a mapping of the file when mapped reads are enabled.
+constexpr u64 MappedReadThreshold = 64_KB;
+
 s32 PS4_SYSV_ABI open(const char* raw_path, s32 flags, u16 mode) {
     LOG_INFO(Kernel_Fs, "path = {} flags = {:#x} mode = {:#o}", raw_path, flags, mode);
 
@@ -131,6 +138,35 @@ s32 PS4_SYSV_ABI open(const char* raw_path, s32 flags, u16 mode) {
     bool exists = fs::exists(file->m_host_name);
     s32 e = 0;
 
+    if (!exists) {
+        // Mounted images serve the files that aren't on the host.
+        if (const auto [image, node] = mnt->FindImageNode(file->m_guest_name); node != nullptr) {
+            s32 error = 0;
+            if (create && excl) {
+                error = POSIX_EEXIST;
+            } else if (write || rdwr || truncate) {
+                error = node->is_dir ? POSIX_EISDIR : POSIX_EROFS;
+            } else if (directory && !node->is_dir) {
+                error = POSIX_ENOTDIR;
+            }
+            if (error != 0) {
+                h->DeleteHandle(handle);
+                *__Error() = error;
+                return -1;
+            }
+            if (node->is_dir) {
+                file->type = Core::FileSys::FileType::Directory;
+                file->directory = Core::Directories::PfsDirectory::Create(file->m_guest_name);
+            } else {
+                file->type = Core::FileSys::FileType::Device;
+                file->device = std::make_shared<D::PfsImageFile>(image, *node);
+                Libraries::PlayGo::RecordGameFileOpen(file->m_guest_name);
+            }
+            file->is_opened = true;
+            return handle;
+        }
+    }
+
     if (create) {
         if (excl && exists) {
             // Error if file exists
@@ -148,6 +184,8 @@ s32 PS4_SYSV_ABI open(const char* raw_path, s32 flags, u16 mode) {
             }
             // Create a file if it doesn't exist
             Common::FS::IOFile out(file->m_host_name, Common::FS::FileAccessMode::Create);
+            mnt->InvalidateHostPath(file->m_host_name);
+            Core::Directories::InvalidateDirentCache(file->m_guest_name);
         }
     } else if (!exists) {
         // If we're not creating a file, and it doesn't exist, return ENOENT
@@ -214,6 +252,14 @@ s32 PS4_SYSV_ABI open(const char* raw_path, s32 flags, u16 mode) {
         if (read) {
             // Open exclusively for reading
             e = file->f.Open(file->m_host_name, Common::FS::FileAccessMode::Read);
+            if (e == 0 && read_only && Config::isMappedGameFileReadsEnabled() &&
+                file->f.GetSize() >= MappedReadThreshold) {
+                // Game files can't change while they are open, big reads copy from a mapping
+                file->mapping.Open(file->m_host_name);
+            }
+            if (e == 0 && read_only) {
+                Libraries::PlayGo::RecordGameFileOpen(file->m_guest_name);
+            }
         } else if (read_only) {
             // Can't open files with write/read-write access in a read only directory
             h->DeleteHandle(handle);
@@ -275,6 +321,11 @@ s32 PS4_SYSV_ABI close(s32 fd) {
         return -1;
     }
     if (file->type == Core::FileSys::FileType::Regular) {
+        if (file->mapping.IsOpen()) {
+            LOG_DEBUG(Kernel_Fs, "{}: {} reads of {} bytes served from the mapping",
+                      file->m_guest_name, file->num_mapped_reads, file->num_mapped_bytes);
+            file->mapping.Close();
+        }
         file->f.Close();
     } else if (file->type == Core::FileSys::FileType::Socket) {
         file->socket->Close();
@@ -339,13 +390,31 @@ s64 PS4_SYSV_ABI sceKernelWrite(s32 fd, const void* buf, u64 nbytes) {
     return result;
 }
 
-s64 ReadFile(Common::FS::IOFile& file, void* buf, u64 nbytes) {
+s64 ReadFile(Core::FileSys::File& file, void* buf, u64 nbytes) {
     const auto* memory = Core::Memory::Instance();
     // Invalidate up to the actual number of bytes that could be read.
-    const auto remaining = file.GetSize() - file.Tell();
-    memory->InvalidateMemory(reinterpret_cast<VAddr>(buf), std::min<u64>(nbytes, remaining));
-
-    return file.ReadRaw<u8>(buf, nbytes);
+    const u64 offset = file.f.Tell();
+    const auto remaining = file.f.GetSize() - offset;
+    const u64 num_bytes = std::min<u64>(nbytes, remaining);
+    memory->InvalidateMemory(reinterpret_cast<VAddr>(buf), num_bytes);
+
+    if (!file.mapping.IsOpen() || num_bytes < MappedReadThreshold) {
+        return file.f.ReadRaw<u8>(buf, nbytes);
+    }
+    const auto view = file.mapping.View(offset, num_bytes);
+    if (view.empty()) {
+        return file.f.ReadRaw<u8>(buf, nbytes);
+    }
+    std::memcpy(buf, view.data(), view.size());
+    file.f.Seek(offset + view.size());
+    if (offset == file.next_mapped_offset) {
+        // Sequential reads will likely ask for the same amount next
+        file.mapping.Prefetch(offset + view.size(), view.size());
+    }
+    file.next_mapped_offset = offset + view.size();
+    ++file.num_mapped_reads;
+    file.num_mapped_bytes += view.size();
+    return static_cast<s64>(view.size());
 }
 
 s64 PS4_SYSV_ABI readv(s32 fd, const OrbisKernelIovec* iov, s32 iovcnt) {
@@ -380,7 +449,7 @@ s64 PS4_SYSV_ABI readv(s32 fd, const OrbisKernelIovec* iov, s32 iovcnt) {
 
     s64 total_read = 0;
     for (s32 i = 0; i < iovcnt; i++) {
-        total_read += ReadFile(file->f, iov[i].iov_base, iov[i].iov_len);
+        total_read += ReadFile(*file, iov[i].iov_base, iov[i].iov_len);
     }
     return total_read;
 }
@@ -543,7 +612,7 @@ s64 PS4_SYSV_ABI read(s32 fd, void* buf, u64 nbytes) {
         return -1;
     }
 
-    return ReadFile(file->f, buf, nbytes);
+    return ReadFile(*file, buf, nbytes);
 }
 
 s64 PS4_SYSV_ABI posix_read(s32 fd, void* buf, u64 nbytes) {
@@ -590,6 +659,8 @@ s32 PS4_SYSV_ABI posix_mkdir(const char* path, u16 mode) {
         *__Error() = POSIX_EIO;
         return -1;
     }
+    mnt->InvalidateHostPath(dir_name);
+    Core::Directories::InvalidateDirentCache(path);
 
     if (!fs::exists(dir_name)) {
         *__Error() = POSIX_ENOENT;
@@ -634,6 +705,8 @@ s32 PS4_SYSV_ABI posix_rmdir(const char* path) {
 
     std::error_code ec;
     s32 result = fs::remove_all(dir_name, ec);
+    mnt->InvalidateHostPath(dir_name);
+    Core::Directories::InvalidateDirentCache(path);
 
     if (ec) {
         *__Error() = POSIX_EIO;
@@ -663,8 +736,24 @@ s32 PS4_SYSV_ABI posix_stat(const char* path, OrbisKernelStat* sb) {
     const bool is_dir = fs::is_directory(path_name);
     const bool is_file = fs::is_regular_file(path_name);
     if (!is_dir && !is_file) {
-        *__Error() = POSIX_ENOENT;
-        return -1;
+        const auto [image, node] = mnt->FindImageNode(path);
+        if (node == nullptr) {
+            *__Error() = POSIX_ENOENT;
+            return -1;
+        }
+        if (node->is_dir) {
+            sb->st_mode = 0000777u | 0040000u;
+            sb->st_size = 65536;
+            sb->st_blksize = 65536;
+            sb->st_blocks = 128;
+        } else {
+            sb->st_mode = 0000777u | 0100000u;
+            sb->st_size = static_cast<s64>(node->size);
+            sb->st_blksize = 512;
+            sb->st_blocks = (sb->st_size + 511) / 512;
+        }
+        sb->st_mtim.tv_sec = node->mtime;
+        return ORBIS_OK;
     }
 
     // get the difference between file clock and system clock
@@ -717,7 +806,7 @@ s32 PS4_SYSV_ABI sceKernelCheckReachability(const char* path) {
         }
     }
     const auto path_name = mnt->GetHostPath(guest_path);
-    if (!fs::exists(path_name)) {
+    if (!fs::exists(path_name) && mnt->FindImageNode(guest_path).node == nullptr) {
         return ORBIS_KERNEL_ERROR_ENOENT;
     }
     return ORBIS_OK;
@@ -882,6 +971,10 @@ s32 PS4_SYSV_ABI posix_rename(const char* from, const char* to) {
     } else {
         fs::remove_all(src_path);
     }
+    mnt->InvalidateHostPath(src_path);
+    mnt->InvalidateHostPath(dst_path);
+    Core::Directories::InvalidateDirentCache(from);
+    Core::Directories::InvalidateDirentCache(to);
 
     return ORBIS_OK;
 }
@@ -940,7 +1033,7 @@ s64 PS4_SYSV_ABI posix_preadv(s32 fd, OrbisKernelIovec* iov, s32 iovcnt, s64 off
     }
     s64 total_read = 0;
     for (s32 i = 0; i < iovcnt; i++) {
-        total_read += ReadFile(file->f, iov[i].iov_base, iov[i].iov_len);
+        total_read += ReadFile(*file, iov[i].iov_base, iov[i].iov_len);
     }
     return total_read;
 }
@@ -1170,6 +1263,8 @@ s32 PS4_SYSV_ABI posix_unlink(const char* path) {
     } else {
         file->f.Unlink();
     }
+    mnt->InvalidateHostPath(host_path);
+    Core::Directories::InvalidateDirentCache(path);
 
     LOG_INFO(Kernel_Fs, "Unlinked {}", path);
     return ORBIS_OK;
@@ -413,6 +413,9 @@ s32 PS4_SYSV_ABI sceKernelBatchMap2(OrbisKernelBatchMapEntry* entries, s32 numEn
                                     s32* numEntriesOut, s32 flags) {
     s32 result = ORBIS_OK;
     s32 processed = 0;
+    // Streaming maps hundreds of entries at once, make the GPU caches track them in one go.
+    auto* memory = Core::Memory::Instance();
+    memory->BeginGpuMapBatch();
     for (s32 i = 0; i < numEntries; i++, processed++) {
         if (entries == nullptr || entries[i].length == 0 || entries[i].operation > 4) {
             result = ORBIS_KERNEL_ERROR_EINVAL;
@@ -454,6 +457,7 @@ s32 PS4_SYSV_ABI sceKernelBatchMap2(OrbisKernelBatchMapEntry* entries, s32 numEn
             break;
         }
     }
+    memory->EndGpuMapBatch();
     if (numEntriesOut != NULL) { // can be zero. do not return an error code.
         *numEntriesOut = processed;
     }
@@ -1,52 +1,106 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <thread>
+#include <immintrin.h>
+
 #include "mutex.h"
 
-#include "common/assert.h"
+#ifdef _WIN64
+#include <windows.h>
+#elif defined(__linux__)
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace Libraries::Kernel {
 
-TimedMutex::TimedMutex() {
-#ifdef _WIN64
-    mtx = CreateMutex(nullptr, false, nullptr);
-    ASSERT(mtx);
-#endif
-}
+/// Upper bound of the adaptive spin, about a few microseconds.
+static constexpr u32 MaxSpins = 1000;
 
-TimedMutex::~TimedMutex() {
-#ifdef _WIN64
-    CloseHandle(mtx);
-#endif
+bool TimedMutex::LockSlow(const std::chrono::steady_clock::time_point* deadline) {
+    if (Spin()) {
+        return true;
+    }
+    // Mark the lock contended so its owner wakes a parked thread when it unlocks
+    while (state.exchange(Contended, std::memory_order_acquire) != Unlocked) {
+        if (deadline && std::chrono::steady_clock::now() >= *deadline) {
+            return false;
+        }
+        Park(deadline);
+    }
+    return true;
 }
 
-void TimedMutex::lock() {
-#ifdef _WIN64
-    for (;;) {
-        u64 res = WaitForSingleObjectEx(mtx, INFINITE, true);
-        if (res == WAIT_OBJECT_0) {
-            return;
+bool TimedMutex::Spin() {
+    // Spin up to twice as long as the spins that got the lock recently, like glibc's adaptive
+    // mutexes. Nobody is parked on the word while spinning, the owner will not be slowed down.
+    const u32 average = spin_count.load(std::memory_order_relaxed);
+    const u32 max_spins = std::min(MaxSpins, average * 2 + 10);
+    u32 spins = 0;
+    bool locked = false;
+    while (spins < max_spins) {
+        const u32 current = state.load(std::memory_order_relaxed);
+        if (current == Contended) {
+            // Others are parked already, spinning only delays the handoff to them
+            break;
         }
+        if (current == Unlocked && try_lock()) {
+            locked = true;
+            break;
+        }
+        _mm_pause();
+        ++spins;
     }
-#else
-    mtx.lock();
-#endif
+    const s32 delta = (static_cast<s32>(spins) - static_cast<s32>(average)) / 8;
+    spin_count.store(static_cast<u32>(static_cast<s32>(average) + delta),
+                     std::memory_order_relaxed);
+    return locked;
 }
 
-bool TimedMutex::try_lock() {
+void TimedMutex::Park(const std::chrono::steady_clock::time_point* deadline) {
+    using namespace std::chrono;
 #ifdef _WIN64
-    return WaitForSingleObjectEx(mtx, 0, true) == WAIT_OBJECT_0;
+    DWORD timeout_ms = INFINITE;
+    if (deadline) {
+        const auto remaining = ceil<milliseconds>(*deadline - steady_clock::now());
+        timeout_ms = static_cast<DWORD>(std::max<milliseconds::rep>(remaining.count(), 0));
+    }
+    u32 contended = Contended;
+    WaitOnAddress(&state, &contended, sizeof(u32), timeout_ms);
+#elif defined(__linux__)
+    timespec timeout{};
+    if (deadline) {
+        const auto remaining = std::max(*deadline - steady_clock::now(), steady_clock::duration{});
+        const auto secs = duration_cast<seconds>(remaining);
+        timeout.tv_sec = static_cast<time_t>(secs.count());
+        timeout.tv_nsec = static_cast<long>(duration_cast<nanoseconds>(remaining - secs).count());
+    }
+    syscall(SYS_futex, reinterpret_cast<u32*>(&state), FUTEX_WAIT_PRIVATE, Contended,
+            deadline ? &timeout : nullptr, nullptr, 0);
 #else
-    return mtx.try_lock();
+    if (!deadline) {
+        state.wait(Contended, std::memory_order_relaxed);
+    } else {
+        // There is no timed wait on an address, poll until the deadline
+        std::this_thread::sleep_for(std::min<steady_clock::duration>(
+            *deadline - steady_clock::now(), microseconds{100}));
+    }
 #endif
 }
 
-void TimedMutex::unlock() {
+void TimedMutex::WakeOne() {
 #ifdef _WIN64
-    ReleaseMutex(mtx);
+    WakeByAddressSingle(&state);
+#elif defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<u32*>(&state), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr,
+            0);
 #else
-    mtx.unlock();
+    state.notify_one();
 #endif
 }
 
-} // namespace Libraries::Kernel
\ No newline at end of file
+} // namespace Libraries::Kernel
@@ -3,78 +3,74 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 
 #include "common/types.h"
 
-#ifdef _WIN64
-#include <windows.h>
-#else
-#include <mutex>
-#endif
-
 namespace Libraries::Kernel {
 
+/// Mutex on a single lock word. An uncontended lock is one compare-exchange, a contended one
+/// spins for an adaptive number of iterations and then parks directly on the lock word with a
+/// futex (WaitOnAddress on Windows).
 class TimedMutex {
 public:
-    TimedMutex();
-    ~TimedMutex();
+    TimedMutex() = default;
+    ~TimedMutex() = default;
 
-    void lock();
-    bool try_lock();
+    TimedMutex(const TimedMutex&) = delete;
+    TimedMutex& operator=(const TimedMutex&) = delete;
 
-    void unlock();
+    void lock() {
+        if (!try_lock()) [[unlikely]] {
+            LockSlow(nullptr);
+        }
+    }
 
-    template <class Rep, class Period>
-    bool try_lock_for(const std::chrono::duration<Rep, Period>& rel_time) {
-#ifdef _WIN64
-        constexpr auto zero = std::chrono::duration<Rep, Period>::zero();
-        const auto now = std::chrono::steady_clock::now();
+    bool try_lock() {
+        u32 expected = Unlocked;
+        return state.compare_exchange_strong(expected, Locked, std::memory_order_acquire,
+                                             std::memory_order_relaxed);
+    }
 
-        std::chrono::steady_clock::time_point abs_time = now;
-        if (rel_time > zero) {
-            constexpr auto max = (std::chrono::steady_clock::time_point::max)();
-            if (abs_time < max - rel_time) {
-                abs_time += rel_time;
-            } else {
-                abs_time = max;
-            }
+    void unlock() {
+        if (state.exchange(Unlocked, std::memory_order_release) == Contended) [[unlikely]] {
+            WakeOne();
         }
+    }
 
-        return try_lock_until(abs_time);
-#else
-        return mtx.try_lock_for(rel_time);
-#endif
+    template <class Rep, class Period>
+    bool try_lock_for(const std::chrono::duration<Rep, Period>& rel_time) {
+        using Clock = std::chrono::steady_clock;
+        if (try_lock()) {
+            return true;
+        }
+        // Longer timeouts would overflow the deadline, they won't run out anyway.
+        constexpr auto MaxTimeout = std::chrono::hours{24 * 365};
+        const auto timeout = rel_time < MaxTimeout
+                                 ? std::chrono::ceil<Clock::duration>(rel_time)
+                                 : std::chrono::duration_cast<Clock::duration>(MaxTimeout);
+        const auto deadline = Clock::now() + timeout;
+        return LockSlow(&deadline);
     }
 
     template <class Clock, class Duration>
     bool try_lock_until(const std::chrono::time_point<Clock, Duration>& abs_time) {
-#ifdef _WIN64
-        for (;;) {
-            const auto now = Clock::now();
-            if (abs_time <= now) {
-                return false;
-            }
-
-            const auto rel_ms = std::chrono::ceil<std::chrono::milliseconds>(abs_time - now);
-            u64 res = WaitForSingleObjectEx(mtx, static_cast<u64>(rel_ms.count()), true);
-            if (res == WAIT_OBJECT_0) {
-                return true;
-            } else if (res == WAIT_TIMEOUT) {
-                return false;
-            }
-        }
-#else
-        return mtx.try_lock_until(abs_time);
-#endif
+        return try_lock_for(abs_time - Clock::now());
     }
 
 private:
-#ifdef _WIN64
-    HANDLE mtx;
-#else
-    std::timed_mutex mtx;
-#endif
+    static constexpr u32 Unlocked = 0;
+    static constexpr u32 Locked = 1;
+    static constexpr u32 Contended = 2; ///< Locked, and threads may be parked on the word
+
+    bool LockSlow(const std::chrono::steady_clock::time_point* deadline);
+    bool Spin();
+    void Park(const std::chrono::steady_clock::time_point* deadline);
+    void WakeOne();
+
+    std::atomic<u32> state{Unlocked};
+    std::atomic<u32> spin_count{}; ///< Average number of spins that got the lock recently
 };
 
-} // namespace Libraries::Kernel
\ No newline at end of file
+} // namespace Libraries::Kernel
@@ -3,6 +3,7 @@
 
 #include <cstring>
 #include "common/assert.h"
+#include "common/perf_counters.h"
 #include "core/libraries/kernel/kernel.h"
 #include "core/libraries/kernel/posix_error.h"
 #include "core/libraries/kernel/threads/pthread.h"
@@ -93,6 +94,7 @@ int PS4_SYSV_ABI posix_pthread_cond_destroy(PthreadCondT* cond) {
 }
 
 int PthreadCond::Wait(PthreadMutexT* mutex, const OrbisKernelTimespec* abstime, u64 usec) {
+    Common::CountPerf(Common::PerfCounter::GuestWaits);
     PthreadMutex* mp = *mutex;
     if (const int error = mp->IsOwned(g_curthread); error != 0) {
         return error;
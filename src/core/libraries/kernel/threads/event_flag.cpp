@@ -7,6 +7,7 @@
 
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/perf_counters.h"
 #include "core/libraries/kernel/orbis_error.h"
 #include "core/libraries/libs.h"
 
@@ -328,6 +329,7 @@ int PS4_SYSV_ABI sceKernelPollEventFlag(OrbisKernelEventFlag ef, u64 bitPattern,
 int PS4_SYSV_ABI sceKernelWaitEventFlag(OrbisKernelEventFlag ef, u64 bitPattern, u32 waitMode,
                                         u64* pResultPat, OrbisKernelUseconds* pTimeout) {
     LOG_DEBUG(Kernel_Event, "called bitPattern = {:#x} waitMode = {:#x}", bitPattern, waitMode);
+    Common::CountPerf(Common::PerfCounter::GuestWaits);
     if (ef == nullptr) {
         return ORBIS_KERNEL_ERROR_ESRCH;
     }
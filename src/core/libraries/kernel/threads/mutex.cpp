@@ -1,8 +1,12 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include "common/assert.h"
+#include "common/scope_exit.h"
 #include "common/types.h"
 #include "core/libraries/kernel/kernel.h"
 #include "core/libraries/kernel/posix_error.h"
@@ -13,6 +17,9 @@ namespace Libraries::Kernel {
 
 static constexpr u32 MUTEX_ADAPTIVE_SPINS = 2000;
 static std::mutex MutxStaticLock;
+/// Every initialized mutex, for contention reports
+static std::mutex MutexListLock;
+static std::unordered_set<PthreadMutex*> LiveMutexes;
 
 #define THR_MUTEX_INITIALIZER ((PthreadMutex*)NULL)
 #define THR_ADAPTIVE_MUTEX_INITIALIZER ((PthreadMutex*)1)
@@ -75,6 +82,10 @@ static int MutexInit(PthreadMutexT* mutex, const PthreadMutexAttr* mutex_attr, c
         // pmutex->m_yieldloops = _thr_yieldloops;
     }
 
+    {
+        std::scoped_lock lk{MutexListLock};
+        LiveMutexes.insert(pmutex);
+    }
     *mutex = pmutex;
     return 0;
 }
@@ -112,6 +123,10 @@ int PS4_SYSV_ABI posix_pthread_mutex_destroy(PthreadMutexT* mutex) {
         return POSIX_EBUSY;
     }
     *mutex = THR_MUTEX_DESTROYED;
+    {
+        std::scoped_lock lk{MutexListLock};
+        LiveMutexes.erase(m);
+    }
     delete m;
     return 0;
 }
@@ -191,6 +206,18 @@ int PthreadMutex::Lock(const OrbisKernelTimespec* abstime, u64 usec) {
         return SelfLock(abstime, usec);
     }
 
+    if (m_lock.try_lock()) [[likely]] {
+        m_owner = curthread;
+        return 0;
+    }
+    const auto wait_start = std::chrono::steady_clock::now();
+    SCOPE_EXIT {
+        const auto waited = std::chrono::steady_clock::now() - wait_start;
+        num_contended.fetch_add(1, std::memory_order_relaxed);
+        contended_ns.fetch_add(std::chrono::nanoseconds{waited}.count(),
+                               std::memory_order_relaxed);
+    };
+
     /*
      * For adaptive mutexes, spin for a bit in the expectation
      * that if the application requests this mutex type then
@@ -306,6 +333,31 @@ int PS4_SYSV_ABI posix_pthread_mutex_unlock(PthreadMutexT* mutex) {
     return mp->Unlock();
 }
 
+std::vector<MutexContentionStats> GetMutexContentionStats(size_t max_entries) {
+    std::unordered_map<std::string_view, MutexContentionStats> by_name;
+    std::scoped_lock lk{MutexListLock};
+    for (const PthreadMutex* m : LiveMutexes) {
+        const u64 num_contended = m->num_contended.load(std::memory_order_relaxed);
+        if (num_contended == 0) {
+            continue;
+        }
+        auto& stats = by_name[m->name];
+        stats.name = m->name;
+        stats.num_contended += num_contended;
+        stats.contended_ns += m->contended_ns.load(std::memory_order_relaxed);
+    }
+    std::vector<MutexContentionStats> result;
+    result.reserve(by_name.size());
+    for (auto& [name, stats] : by_name) {
+        result.push_back(std::move(stats));
+    }
+    std::ranges::sort(result, std::greater{}, &MutexContentionStats::contended_ns);
+    if (result.size() > max_entries) {
+        result.resize(max_entries);
+    }
+    return result;
+}
+
 int PS4_SYSV_ABI posix_pthread_mutex_getspinloops_np(PthreadMutexT* mutex, int* count) {
     CHECK_AND_INIT_MUTEX
     *count = (*mutex)->m_spinloops;
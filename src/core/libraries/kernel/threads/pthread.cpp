@@ -34,6 +34,12 @@ void PS4_SYSV_ABI _sceKernelSetThreadDtors(ThreadDtor* dtor) {
 static void ExitThread() {
     Pthread* curthread = g_curthread;
 
+    /*
+     * Remove thread from tracking. Threads calling pthread_exit never return to RunThread, and
+     * their stack may be freed by a joiner once the thread is collected.
+     */
+    DebugState.RemoveCurrentThreadFromGuestList();
+
     /* Check if there is thread specific data: */
     if (curthread->specific != nullptr) {
         /* Run the thread-specific data destructors: */
@@ -208,10 +214,8 @@ static void RunThread(void* arg) {
 
     /* Run the current thread's start routine with argument: */
     curthread->native_thr.Initialize();
+    curthread->native_thr.SetGuestPriority(curthread->attr.prio);
     void* ret = Core::ExecuteGuest(curthread->start_routine, curthread->arg);
-
-    /* Remove thread from tracking */
-    DebugState.RemoveCurrentThreadFromGuestList();
     posix_pthread_exit(ret);
 }
 
@@ -295,6 +299,8 @@ int PS4_SYSV_ABI posix_pthread_create_name_np(PthreadT* thread, const PthreadAtt
 
     if (attr != nullptr && *attr != nullptr && (*attr)->cpuset != nullptr) {
         new_thread->SetAffinity((*attr)->cpuset);
+    } else {
+        new_thread->native_thr.SetGuestAffinity(0);
     }
     if (ret) {
         *thread = nullptr;
@@ -464,6 +470,7 @@ int PS4_SYSV_ABI posix_pthread_setschedparam(PthreadT pthread, SchedPolicy polic
     // TODO: _thr_setscheduler
     pthread->attr.sched_policy = policy;
     pthread->attr.prio = param->sched_priority;
+    pthread->native_thr.SetGuestPriority(pthread->attr.prio);
     pthread->lock.unlock();
     return 0;
 }
@@ -494,6 +501,7 @@ int PS4_SYSV_ABI posix_pthread_setprio(PthreadT thread, int prio) {
         // TODO: _thr_setscheduler
         thread->attr.prio = prio;
     }
+    thread->native_thr.SetGuestPriority(prio);
 
     thread->lock.unlock();
     return 0;
@@ -535,10 +543,6 @@ int PS4_SYSV_ABI posix_pthread_setcancelstate(PthreadCancelState state,
 }
 
 int Pthread::SetAffinity(const Cpuset* cpuset) {
-    const auto processor_count = std::thread::hardware_concurrency();
-    if (processor_count < 8) {
-        return 0;
-    }
     if (cpuset == nullptr) {
         return POSIX_EINVAL;
     }
@@ -548,34 +552,10 @@ int Pthread::SetAffinity(const Cpuset* cpuset) {
         return POSIX_ESRCH;
     }
 
-    // We don't use this currently because some games gets performance problems
-    // when applying affinity even on strong hardware
-    /*
-    u64 mask = cpuset->bits;
-    #ifdef _WIN64
-        DWORD_PTR affinity_mask = static_cast<DWORD_PTR>(mask);
-        if (!SetThreadAffinityMask(reinterpret_cast<HANDLE>(handle), affinity_mask)) {
-            return POSIX_EINVAL;
-        }
-
-    #elif defined(__linux__)
-        cpu_set_t cpu_set;
-        CPU_ZERO(&cpu_set);
-
-        u64 mask = cpuset->bits;
-        for (int cpu = 0; cpu < std::min(64, CPU_SETSIZE); ++cpu) {
-            if (mask & (1ULL << cpu)) {
-                CPU_SET(cpu, &cpu_set);
-            }
-        }
-
-        int result =
-            pthread_setaffinity_np(static_cast<pthread_t>(handle), sizeof(cpu_set_t), &cpu_set);
-        if (result != 0) {
-            return POSIX_EINVAL;
-        }
-    #endif
-    */
+    // Guest masks name PS4 cores, applying them to the host cores of the same index gives some
+    // games performance problems even on strong hardware. They are only honored within the guest
+    // cores set in the config.
+    native_thr.SetGuestAffinity(cpuset->bits);
     return 0;
 }
 
@@ -8,6 +8,8 @@
 #include <list>
 #include <mutex>
 #include <shared_mutex>
+#include <string>
+#include <vector>
 
 #include "common/enum.h"
 #include "core/libraries/kernel/sync/mutex.h"
@@ -55,6 +57,8 @@ struct PthreadMutex {
     int m_yieldloops;
     PthreadMutexProt m_protocol;
     std::string name;
+    std::atomic<u64> num_contended{}; ///< Locks that found the mutex owned by another thread
+    std::atomic<u64> contended_ns{};  ///< Time those locks spent waiting
 
     [[nodiscard]] PthreadMutexType Type() const noexcept {
         return static_cast<PthreadMutexType>(m_flags & PthreadMutexFlags::TypeMask);
@@ -93,6 +97,17 @@ struct PthreadMutexAttr {
 };
 using PthreadMutexAttrT = PthreadMutexAttr*;
 
+/// Contention of the guest mutexes sharing a name.
+struct MutexContentionStats {
+    std::string name;
+    u64 num_contended;
+    u64 contended_ns;
+};
+
+/// Returns the live guest mutexes that were contended, grouped by name, the ones waited on the
+/// longest first.
+std::vector<MutexContentionStats> GetMutexContentionStats(size_t max_entries);
+
 enum class PthreadCondFlags : u32 {
     Private = 1,
     Inited = 2,
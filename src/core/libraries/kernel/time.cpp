@@ -5,8 +5,11 @@
 #include <thread>
 
 #include "common/assert.h"
+#include "common/config.h"
 #include "common/native_clock.h"
 #include "common/thread.h"
+#include "common/uint128.h"
+#include "core/debug_state.h"
 #include "core/libraries/kernel/kernel.h"
 #include "core/libraries/kernel/orbis_error.h"
 #include "core/libraries/kernel/posix_error.h"
@@ -37,7 +40,13 @@ u64 PS4_SYSV_ABI sceKernelGetTscFrequency() {
 
 u64 PS4_SYSV_ABI sceKernelGetProcessTime() {
     // TODO: this timer should support suspends, so initial ptc needs to be updated on wake up
-    return clock->GetTimeUS(initial_ptc);
+    const u64 us = clock->GetTimeUS();
+    const u64 paused_ticks = initial_ptc - clock->GetStartCounter();
+    if (paused_ticks == 0) {
+        return us;
+    }
+    // Guest threads were paused by the debugger for that long
+    return us - MultiplyAndDivide64(paused_ticks, 1'000'000, clock->GetTscFrequency());
 }
 
 u64 PS4_SYSV_ABI sceKernelGetProcessTimeCounter() {
@@ -52,6 +61,30 @@ u64 PS4_SYSV_ABI sceKernelReadTsc() {
     return clock->GetUptime();
 }
 
+/// The last part of a guest sleep that is spun for in precise sleep mode, a bit more than the host
+/// timers usually oversleep by.
+static std::chrono::nanoseconds GetSleepSpinThreshold() {
+    if (!Config::isPreciseSleepEnabled()) {
+        return {};
+    }
+#ifdef _WIN64
+    return std::chrono::microseconds{1000};
+#else
+    return std::chrono::microseconds{100};
+#endif
+}
+
+static void RecordSleepOvershoot(std::chrono::steady_clock::duration overshoot) {
+    const auto overshoot_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(overshoot).count();
+    const auto& bounds = DebugState.SleepOvershootBoundsUs;
+    size_t bucket = 0;
+    while (bucket < bounds.size() && overshoot_us >= bounds[bucket]) {
+        ++bucket;
+    }
+    DebugState.sleep_overshoots[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
 static s32 posix_nanosleep_impl(const OrbisKernelTimespec* rqtp, OrbisKernelTimespec* rmtp,
                                 const bool interruptible) {
     if (!rqtp || rqtp->tv_sec < 0 || rqtp->tv_nsec < 0 || rqtp->tv_nsec >= 1'000'000'000) {
@@ -59,8 +92,13 @@ static s32 posix_nanosleep_impl(const OrbisKernelTimespec* rqtp, OrbisKernelTime
         return -1;
     }
     const auto duration = std::chrono::nanoseconds(rqtp->tv_sec * 1'000'000'000 + rqtp->tv_nsec);
+    const auto begin_sleep = std::chrono::steady_clock::now();
     std::chrono::nanoseconds remain;
-    const auto uninterrupted = Common::AccurateSleep(duration, &remain, interruptible);
+    const auto uninterrupted =
+        Common::AccurateSleep(duration, &remain, interruptible, GetSleepSpinThreshold());
+    if (uninterrupted) {
+        RecordSleepOvershoot(std::chrono::steady_clock::now() - begin_sleep - duration);
+    }
     if (rmtp) {
         rmtp->tv_sec = remain.count() / 1'000'000'000;
         rmtp->tv_nsec = remain.count() % 1'000'000'000;
@@ -133,6 +171,23 @@ s32 PS4_SYSV_ABI posix_clock_gettime(u32 clock_id, OrbisKernelTimespec* ts) {
         clock_id = ORBIS_CLOCK_MONOTONIC;
     }
 
+    switch (clock_id) {
+    case ORBIS_CLOCK_UPTIME:
+    case ORBIS_CLOCK_UPTIME_PRECISE:
+    case ORBIS_CLOCK_MONOTONIC:
+    case ORBIS_CLOCK_MONOTONIC_PRECISE:
+    case ORBIS_CLOCK_UPTIME_FAST:
+    case ORBIS_CLOCK_MONOTONIC_FAST: {
+        // Same clock as the process time and the TSC, read without a syscall
+        const u64 ns = clock->GetMonotonicNS();
+        ts->tv_sec = static_cast<s64>(ns / 1'000'000'000);
+        ts->tv_nsec = static_cast<s64>(ns % 1'000'000'000);
+        return 0;
+    }
+    default:
+        break;
+    }
+
 #ifdef _WIN32
     static const auto FileTimeTo100Ns = [](FILETIME& ft) { return *reinterpret_cast<u64*>(&ft); };
     switch (clock_id) {
@@ -156,27 +211,6 @@ s32 PS4_SYSV_ABI posix_clock_gettime(u32 clock_id, OrbisKernelTimespec* ts) {
         ts->tv_nsec = (ns % 10'000'000) * 100;
         return 0;
     }
-    case ORBIS_CLOCK_UPTIME:
-    case ORBIS_CLOCK_UPTIME_PRECISE:
-    case ORBIS_CLOCK_MONOTONIC:
-    case ORBIS_CLOCK_MONOTONIC_PRECISE:
-    case ORBIS_CLOCK_UPTIME_FAST:
-    case ORBIS_CLOCK_MONOTONIC_FAST: {
-        static LARGE_INTEGER pf = [] {
-            LARGE_INTEGER res{};
-            QueryPerformanceFrequency(&res);
-            return res;
-        }();
-
-        LARGE_INTEGER pc{};
-        if (!QueryPerformanceCounter(&pc)) {
-            SetPosixErrno(EFAULT);
-            return -1;
-        }
-        ts->tv_sec = pc.QuadPart / pf.QuadPart;
-        ts->tv_nsec = ((pc.QuadPart % pf.QuadPart) * 1000'000'000) / pf.QuadPart;
-        return 0;
-    }
     case ORBIS_CLOCK_THREAD_CPUTIME_ID: {
         FILETIME ct, et, kt, ut;
         if (!GetThreadTimes(GetCurrentThread(), &ct, &et, &kt, &ut)) {
@@ -227,20 +261,6 @@ s32 PS4_SYSV_ABI posix_clock_gettime(u32 clock_id, OrbisKernelTimespec* ts) {
         pclock_id = CLOCK_REALTIME_COARSE;
 #else
         pclock_id = CLOCK_REALTIME;
-#endif
-        break;
-    case ORBIS_CLOCK_UPTIME:
-    case ORBIS_CLOCK_UPTIME_PRECISE:
-    case ORBIS_CLOCK_MONOTONIC:
-    case ORBIS_CLOCK_MONOTONIC_PRECISE:
-        pclock_id = CLOCK_MONOTONIC;
-        break;
-    case ORBIS_CLOCK_UPTIME_FAST:
-    case ORBIS_CLOCK_MONOTONIC_FAST:
-#ifdef CLOCK_MONOTONIC_COARSE
-        pclock_id = CLOCK_MONOTONIC_COARSE;
-#else
-        pclock_id = CLOCK_MONOTONIC;
 #endif
         break;
     case ORBIS_CLOCK_THREAD_CPUTIME_ID:
@@ -545,7 +565,7 @@ s32 PS4_SYSV_ABI sceKernelSettimeofday(OrbisKernelTimeval* _tv, OrbisKernelTimez
 
 void RegisterTime(Core::Loader::SymbolsResolver* sym) {
     clock = std::make_unique<Common::NativeClock>();
-    initial_ptc = clock->GetUptime();
+    initial_ptc = clock->GetStartCounter();
 
     // POSIX
     LIB_FUNCTION("yS8U2TGCe1A", "libkernel", 1, "libkernel", posix_nanosleep);
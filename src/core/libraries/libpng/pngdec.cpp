@@ -7,6 +7,7 @@
 #include "core/libraries/libpng/pngdec.h"
 #include "core/libraries/libpng/pngdec_error.h"
 #include "core/libraries/libs.h"
+#include "core/memory.h"
 
 namespace Libraries::PngDec {
 
@@ -109,9 +110,23 @@ s32 PS4_SYSV_ABI scePngDecDecode(OrbisPngDecHandle handle, const OrbisPngDecDeco
                         if (len == 0)
                             return;
                         auto pngdata = (PngStruct*)png_get_io_ptr(ps);
+                        if (len > pngdata->size - pngdata->offset) {
+                            png_error(ps, "read past the end of the png");
+                        }
                         ::memcpy(data, pngdata->data + pngdata->offset, len);
                         pngdata->offset += len;
                     });
+    // Errors of libpng jump back here, the default handler would abort
+    if (setjmp(png_jmpbuf(pngh->png_ptr))) {
+        return ORBIS_PNG_DEC_ERROR_INVALID_DATA;
+    }
+
+    // Skip verifying the CRC of every chunk and the Adler-32 of the image data. Besides
+    // inflating, checksums are most of the work, and the data comes from the game.
+    png_set_crc_action(pngh->png_ptr, PNG_CRC_QUIET_USE, PNG_CRC_QUIET_USE);
+#ifdef PNG_IGNORE_ADLER32
+    png_set_option(pngh->png_ptr, PNG_IGNORE_ADLER32, PNG_OPTION_ON);
+#endif
 
     png_read_info(pngh->png_ptr, pngh->info_ptr);
     const u32 width = png_get_image_width(pngh->png_ptr, pngh->info_ptr);
@@ -164,6 +179,15 @@ s32 PS4_SYSV_ABI scePngDecDecode(OrbisPngDecHandle handle, const OrbisPngDecDeco
     const s32 num_channels = png_get_channels(pngh->png_ptr, pngh->info_ptr);
     const s32 horizontal_bytes = num_channels * width;
     const s32 stride = param->image_pitch > 0 ? param->image_pitch : horizontal_bytes;
+    const u64 image_size = u64(stride) * (height - 1) + horizontal_bytes;
+    if (height == 0 || image_size > param->image_mem_size) {
+        LOG_ERROR(Lib_Png, "image of {} bytes does not fit the buffer of {} bytes", image_size,
+                  param->image_mem_size);
+        return ORBIS_PNG_DEC_ERROR_INVALID_SIZE;
+    }
+    // Rows are decoded straight into guest memory
+    Core::Memory::Instance()->InvalidateMemory(reinterpret_cast<VAddr>(param->image_mem_addr),
+                                               image_size);
 
     for (int j = 0; j < pass; j++) {
         auto ptr = reinterpret_cast<png_bytep>(param->image_mem_addr);
@@ -1,7 +1,11 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <array>
+#include <chrono>
+
 #include "common/config.h"
+#include "common/thread_pool.h"
 #include "core/libraries/ajm/ajm.h"
 #include "core/libraries/app_content/app_content.h"
 #include "core/libraries/audio/audioin.h"
@@ -74,77 +78,107 @@
 
 namespace Libraries {
 
+namespace {
+
+using RegisterLibFunc = void (*)(Core::Loader::SymbolsResolver*);
+
+/// Libraries that only fill their export table, so they are registered in parallel. The order
+/// is kept when merging, the first library to export a symbol keeps it.
+constexpr std::array IndependentLibs = std::to_array<RegisterLibFunc>({
+    &Libraries::UserService::RegisterLib,
+    &Libraries::SystemService::RegisterLib,
+    &Libraries::CommonDialog::RegisterLib,
+    &Libraries::MsgDialog::RegisterLib,
+    &Libraries::AudioOut::RegisterLib,
+    &Libraries::Http::RegisterLib,
+    &Libraries::Http2::RegisterLib,
+    &Libraries::Net::RegisterLib,
+    &Libraries::NetCtl::RegisterLib,
+    &Libraries::SaveData::RegisterLib,
+    &Libraries::SaveData::Dialog::RegisterLib,
+    &Libraries::Ssl2::RegisterLib,
+    &Libraries::SysModule::RegisterLib,
+    &Libraries::Posix::RegisterLib,
+    &Libraries::AudioIn::RegisterLib,
+    &Libraries::Np::NpCommerce::RegisterLib,
+    &Libraries::Np::NpCommon::RegisterLib,
+    &Libraries::Np::NpManager::RegisterLib,
+    &Libraries::Np::NpScore::RegisterLib,
+    &Libraries::Np::NpTrophy::RegisterLib,
+    &Libraries::Np::NpWebApi::RegisterLib,
+    &Libraries::Np::NpWebApi2::RegisterLib,
+    &Libraries::Np::NpProfileDialog::RegisterLib,
+    &Libraries::Np::NpSnsFacebookDialog::RegisterLib,
+    &Libraries::Np::NpAuth::RegisterLib,
+    &Libraries::Np::NpParty::RegisterLib,
+    &Libraries::ScreenShot::RegisterLib,
+    &Libraries::AppContent::RegisterLib,
+    &Libraries::PngDec::RegisterLib,
+    &Libraries::PlayGo::RegisterLib,
+    &Libraries::PlayGo::Dialog::RegisterLib,
+    &Libraries::Random::RegisterLib,
+    &Libraries::Usbd::RegisterLib,
+    &Libraries::Pad::RegisterLib,
+    &Libraries::SystemGesture::RegisterLib,
+    &Libraries::Ajm::RegisterLib,
+    &Libraries::ErrorDialog::RegisterLib,
+    &Libraries::ImeDialog::RegisterLib,
+    &Libraries::AvPlayer::RegisterLib,
+    &Libraries::Videodec::RegisterLib,
+    &Libraries::Videodec2::RegisterLib,
+    &Libraries::Audio3d::RegisterLib,
+    &Libraries::Ime::RegisterLib,
+    &Libraries::GameLiveStreaming::RegisterLib,
+    &Libraries::SharePlay::RegisterLib,
+    &Libraries::Remoteplay::RegisterLib,
+    &Libraries::RazorCpu::RegisterLib,
+    &Libraries::Move::RegisterLib,
+    &Libraries::Fiber::RegisterLib,
+    &Libraries::Mouse::RegisterLib,
+    &Libraries::WebBrowserDialog::RegisterLib,
+    &Libraries::Zlib::RegisterLib,
+    &Libraries::Hmd::RegisterLib,
+    &Libraries::HmdSetupDialog::RegisterLib,
+    &Libraries::DiscMap::RegisterLib,
+    &Libraries::Ulobjmgr::RegisterLib,
+    &Libraries::SigninDialog::RegisterLib,
+    &Libraries::Camera::RegisterLib,
+    &Libraries::CompanionHttpd::RegisterLib,
+    &Libraries::CompanionUtil::RegisterLib,
+    &Libraries::Voice::RegisterLib,
+    &Libraries::Rudp::RegisterLib,
+    &Libraries::VrTracker::RegisterLib,
+});
+
+} // Anonymous namespace
+
 void InitHLELibs(Core::Loader::SymbolsResolver* sym) {
     LOG_INFO(Lib_Kernel, "Initializing HLE libraries");
+    const auto start = std::chrono::steady_clock::now();
+
+    std::array<Core::Loader::SymbolsResolver, IndependentLibs.size()> tables;
+    Common::JobGroup jobs;
+    auto& pool = Common::GetThreadPool();
+    for (size_t i = 0; i < IndependentLibs.size(); ++i) {
+        pool.Submit([&tables, i] { IndependentLibs[i](&tables[i]); }, {.group = &jobs});
+    }
+
+    // These start the kernel service thread, the presenter and the video out driver meanwhile
     Libraries::Kernel::RegisterLib(sym);
     Libraries::GnmDriver::RegisterLib(sym);
     Libraries::VideoOut::RegisterLib(sym);
-    Libraries::UserService::RegisterLib(sym);
-    Libraries::SystemService::RegisterLib(sym);
-    Libraries::CommonDialog::RegisterLib(sym);
-    Libraries::MsgDialog::RegisterLib(sym);
-    Libraries::AudioOut::RegisterLib(sym);
-    Libraries::Http::RegisterLib(sym);
-    Libraries::Http2::RegisterLib(sym);
-    Libraries::Net::RegisterLib(sym);
-    Libraries::NetCtl::RegisterLib(sym);
-    Libraries::SaveData::RegisterLib(sym);
-    Libraries::SaveData::Dialog::RegisterLib(sym);
-    Libraries::Ssl2::RegisterLib(sym);
-    Libraries::SysModule::RegisterLib(sym);
-    Libraries::Posix::RegisterLib(sym);
-    Libraries::AudioIn::RegisterLib(sym);
-    Libraries::Np::NpCommerce::RegisterLib(sym);
-    Libraries::Np::NpCommon::RegisterLib(sym);
-    Libraries::Np::NpManager::RegisterLib(sym);
-    Libraries::Np::NpScore::RegisterLib(sym);
-    Libraries::Np::NpTrophy::RegisterLib(sym);
-    Libraries::Np::NpWebApi::RegisterLib(sym);
-    Libraries::Np::NpWebApi2::RegisterLib(sym);
-    Libraries::Np::NpProfileDialog::RegisterLib(sym);
-    Libraries::Np::NpSnsFacebookDialog::RegisterLib(sym);
-    Libraries::Np::NpAuth::RegisterLib(sym);
-    Libraries::Np::NpParty::RegisterLib(sym);
-    Libraries::ScreenShot::RegisterLib(sym);
-    Libraries::AppContent::RegisterLib(sym);
-    Libraries::PngDec::RegisterLib(sym);
-    Libraries::PlayGo::RegisterLib(sym);
-    Libraries::PlayGo::Dialog::RegisterLib(sym);
-    Libraries::Random::RegisterLib(sym);
-    Libraries::Usbd::RegisterLib(sym);
-    Libraries::Pad::RegisterLib(sym);
-    Libraries::SystemGesture::RegisterLib(sym);
-    Libraries::Ajm::RegisterLib(sym);
-    Libraries::ErrorDialog::RegisterLib(sym);
-    Libraries::ImeDialog::RegisterLib(sym);
-    Libraries::AvPlayer::RegisterLib(sym);
-    Libraries::Videodec::RegisterLib(sym);
-    Libraries::Videodec2::RegisterLib(sym);
-    Libraries::Audio3d::RegisterLib(sym);
-    Libraries::Ime::RegisterLib(sym);
-    Libraries::GameLiveStreaming::RegisterLib(sym);
-    Libraries::SharePlay::RegisterLib(sym);
-    Libraries::Remoteplay::RegisterLib(sym);
-    Libraries::RazorCpu::RegisterLib(sym);
-    Libraries::Move::RegisterLib(sym);
-    Libraries::Fiber::RegisterLib(sym);
-    Libraries::Mouse::RegisterLib(sym);
-    Libraries::WebBrowserDialog::RegisterLib(sym);
-    Libraries::Zlib::RegisterLib(sym);
-    Libraries::Hmd::RegisterLib(sym);
-    Libraries::HmdSetupDialog::RegisterLib(sym);
-    Libraries::DiscMap::RegisterLib(sym);
-    Libraries::Ulobjmgr::RegisterLib(sym);
-    Libraries::SigninDialog::RegisterLib(sym);
-    Libraries::Camera::RegisterLib(sym);
-    Libraries::CompanionHttpd::RegisterLib(sym);
-    Libraries::CompanionUtil::RegisterLib(sym);
-    Libraries::Voice::RegisterLib(sym);
-    Libraries::Rudp::RegisterLib(sym);
-    Libraries::VrTracker::RegisterLib(sym);
+
+    jobs.Wait();
+    for (auto& table : tables) {
+        sym->Merge(std::move(table));
+    }
 
     // Loading libSceSsl is locked behind a title workaround that currently applies to nothing.
     // Libraries::Ssl::RegisterLib(sym);
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    LOG_INFO(Lib_Kernel, "Registered {} HLE symbols in {} ms", sym->GetSize(),
+             std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
 }
 
 } // namespace Libraries
@@ -10,6 +10,9 @@
 #include <arpa/inet.h>
 #endif
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
 #include <core/libraries/kernel/kernel.h>
 #include <magic_enum/magic_enum.hpp>
 #include "common/assert.h"
@@ -820,7 +823,9 @@ int PS4_SYSV_ABI sceNetEpollWait(OrbisNetId epollid, OrbisNetEpollEvent* events,
 
     int sockets_waited_on = (epoll->events.size() - epoll->async_resolutions.size()) > 0;
 
-    std::vector<epoll_event> native_events{static_cast<size_t>(maxevents)};
+    // Kept per thread, so polling waits don't allocate each time
+    thread_local std::vector<epoll_event> native_events;
+    native_events.resize(std::max(maxevents, 1));
     int result = ORBIS_OK;
     if (sockets_waited_on) {
 #ifdef __linux__
@@ -832,6 +837,15 @@ int PS4_SYSV_ABI sceNetEpollWait(OrbisNetId epollid, OrbisNetEpollEvent* events,
         result = epoll_wait(epoll->epoll_fd, native_events.data(), maxevents,
                             timeout < 0 ? timeout : timeout / 1000);
 #endif
+    } else if (!epoll->async_resolutions.empty()) {
+        // Resolutions run on the resolver pool, the wait ends when the oldest one is done
+        if (auto file = FDTable::Instance()->GetResolver(epoll->async_resolutions.front())) {
+            file->resolver->WaitResolution(timeout);
+        }
+    } else if (timeout > 0) {
+        // Nothing can become ready, the wait times out like it would on the console instead of
+        // returning at once to a guest that polls it in a loop
+        std::this_thread::sleep_for(std::chrono::microseconds(timeout));
     }
 
     int i = 0;
@@ -873,19 +887,20 @@ int PS4_SYSV_ABI sceNetEpollWait(OrbisNetId epollid, OrbisNetEpollEvent* events,
     }
 
     if (result >= 0) {
-        while (!epoll->async_resolutions.empty()) {
-            if (i == maxevents) {
-                break;
-            }
-            auto rid = epoll->async_resolutions.front();
-            epoll->async_resolutions.pop_front();
+        for (auto rid_it = epoll->async_resolutions.begin();
+             rid_it != epoll->async_resolutions.end() && i < maxevents;) {
+            const auto rid = *rid_it;
             auto file = FDTable::Instance()->GetResolver(rid);
             if (!file) {
                 LOG_ERROR(Lib_Net, "resolver {} does not exist", rid);
+                rid_it = epoll->async_resolutions.erase(rid_it);
                 continue;
             }
-
-            file->resolver->Resolve();
+            if (!file->resolver->WaitResolution(0)) {
+                ++rid_it;
+                continue;
+            }
+            rid_it = epoll->async_resolutions.erase(rid_it);
 
             const auto it =
                 std::ranges::find_if(epoll->events, [&](auto& el) { return el.first == rid; });
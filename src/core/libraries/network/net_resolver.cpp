@@ -1,6 +1,9 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
+#include <string>
+
 #include "common/assert.h"
 #include "common/singleton.h"
 #include "common/types.h"
@@ -11,29 +14,55 @@
 
 namespace Libraries::Net {
 
+/// Lookups block on the host resolver for as long as the network takes, so they get their own
+/// workers instead of holding up the shared pool.
+static Common::ThreadPool& GetResolverPool() {
+    static Common::ThreadPool pool{2, "shadPS4:NetResolver"};
+    return pool;
+}
+
+Resolver::~Resolver() {
+    if (job) {
+        GetResolverPool().Wait(job);
+    }
+}
+
 int Resolver::ResolveAsync(const char* hostname, OrbisNetInAddr* addr, int timeout, int retry,
                            int flags) {
     std::scoped_lock lock{m_mutex};
 
-    if (async_resolution) {
+    if (is_resolving) {
         *sceNetErrnoLoc() = ORBIS_NET_RESOLVER_EBUSY;
         return ORBIS_NET_ERROR_RESOLVER_EBUSY;
     }
 
-    async_resolution = AsyncResolution{hostname, addr, timeout, retry, flags};
+    is_resolving = true;
+    job = GetResolverPool().Submit([this, hostname = std::string{hostname}, addr] {
+        auto* netinfo = Common::Singleton<NetUtil::NetUtilInternal>::Instance();
+        const auto ret = netinfo->ResolveHostname(hostname.c_str(), addr);
+        {
+            std::scoped_lock result_lock{m_mutex};
+            resolution_error = ret;
+            is_resolving = false;
+        }
+        resolved_cv.notify_all();
+    });
 
     return ORBIS_OK;
 }
 
-void Resolver::Resolve() {
-    if (async_resolution) {
-        auto* netinfo = Common::Singleton<NetUtil::NetUtilInternal>::Instance();
-        auto ret = netinfo->ResolveHostname(async_resolution->hostname, async_resolution->addr);
-
-        resolution_error = ret;
-    } else {
+bool Resolver::WaitResolution(int timeout) {
+    std::unique_lock lock{m_mutex};
+    if (!job) {
         LOG_ERROR(Lib_Net, "async resolution has not been set-up");
+        return true;
+    }
+    const auto is_done = [this] { return !is_resolving; };
+    if (timeout < 0) {
+        resolved_cv.wait(lock, is_done);
+        return true;
     }
+    return resolved_cv.wait_for(lock, std::chrono::microseconds{timeout}, is_done);
 }
 
 } // namespace Libraries::Net
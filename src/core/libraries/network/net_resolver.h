@@ -3,9 +3,11 @@
 
 #pragma once
 
+#include "common/thread_pool.h"
 #include "common/types.h"
 #include "core/libraries/network/net.h"
 
+#include <condition_variable>
 #include <mutex>
 #include <vector>
 
@@ -14,25 +16,25 @@ namespace Libraries::Net {
 struct Resolver {
 public:
     Resolver(const char* name, int poolid, int flags) : name(name), poolid(poolid), flags(flags) {}
+    ~Resolver();
 
+    /// Starts resolving the hostname on the resolver pool, the address is written once it is
+    /// done. Fails with EBUSY while an earlier resolution is running.
     int ResolveAsync(const char* hostname, OrbisNetInAddr* addr, int timeout, int retry, int flags);
-    void Resolve();
 
-private:
-    struct AsyncResolution {
-        const char* hostname;
-        OrbisNetInAddr* addr;
-        int timeout;
-        int retry;
-        int flags;
-    };
+    /// Waits up to timeout microseconds, without limit when negative, for the resolution
+    /// started by ResolveAsync. Returns true once it has finished.
+    bool WaitResolution(int timeout);
 
+private:
     std::string name;
     int poolid;
     int flags;
-    std::optional<AsyncResolution> async_resolution{};
+    Common::JobHandle job{};
+    bool is_resolving{};
     int resolution_error = ORBIS_OK;
     std::mutex m_mutex;
+    std::condition_variable resolved_cv;
 };
 
-} // namespace Libraries::Net
\ No newline at end of file
+} // namespace Libraries::Net
@@ -373,6 +373,23 @@ bool NetUtilInternal::RetrieveIp() {
 }
 
 int NetUtilInternal::ResolveHostname(const char* hostname, Libraries::Net::OrbisNetInAddr* addr) {
+    // getaddrinfo doesn't report the TTL of the records, so lookups are kept a fixed time that
+    // is short next to the usual record TTLs
+    constexpr auto ResolvedTtl = std::chrono::seconds{60};
+    constexpr auto FailedTtl = std::chrono::seconds{10};
+
+    const auto now = std::chrono::steady_clock::now();
+    {
+        std::scoped_lock lock{resolve_mutex};
+        const auto it = resolve_cache.find(hostname);
+        if (it != resolve_cache.end() && it->second.expiry > now) {
+            if (it->second.error == ORBIS_OK) {
+                addr->inaddr_addr = it->second.addr;
+            }
+            return it->second.error;
+        }
+    }
+
     const addrinfo hints = {
         .ai_flags = AI_V4MAPPED | AI_ADDRCONFIG,
         .ai_family = AF_INET,
@@ -395,6 +412,12 @@ int NetUtilInternal::ResolveHostname(const char* hostname, Libraries::Net::Orbis
 
     freeaddrinfo(info);
 
+    std::scoped_lock lock{resolve_mutex};
+    resolve_cache[hostname] = {
+        .addr = ret == ORBIS_OK ? addr->inaddr_addr : 0,
+        .error = ret,
+        .expiry = now + (ret == ORBIS_OK ? ResolvedTtl : FailedTtl),
+    };
     return ret;
 }
 
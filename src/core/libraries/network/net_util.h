@@ -3,7 +3,10 @@
 
 #pragma once
 
+#include <chrono>
 #include <mutex>
+#include <string>
+#include <unordered_map>
 #include "common/types.h"
 
 namespace Libraries::Net {
@@ -24,6 +27,15 @@ private:
     std::string ip{};
     std::mutex m_mutex;
 
+    /// Result of an earlier lookup, failed ones are kept for a shorter time.
+    struct CachedResolution {
+        u32 addr;
+        int error;
+        std::chrono::steady_clock::time_point expiry;
+    };
+    std::unordered_map<std::string, CachedResolution> resolve_cache;
+    std::mutex resolve_mutex;
+
 public:
     const std::array<u8, 6>& GetEthernetAddr() const;
     const std::string& GetDefaultGateway() const;
@@ -33,6 +45,8 @@ public:
     bool RetrieveDefaultGateway();
     bool RetrieveNetmask();
     bool RetrieveIp();
+    /// Resolves an IPv4 address through the host resolver. Results are cached for a while, as
+    /// the lookup blocks and games resolve the same hosts over and over.
     int ResolveHostname(const char* hostname, Libraries::Net::OrbisNetInAddr* addr);
 };
 } // namespace NetUtil
\ No newline at end of file
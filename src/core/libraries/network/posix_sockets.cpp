@@ -203,6 +203,7 @@ static int convertOrbisFlagsToPosix(int sock_type, int sce_flags) {
 
 // On Windows, MSG_DONTWAIT is not handled natively by recv/send.
 // This function uses select() with zero timeout to simulate non-blocking behavior.
+// Sockets set to non-blocking with SO_NBIO already fail with EWOULDBLOCK and don't need it.
 static int socket_is_ready(int sock, bool is_read = true) {
     fd_set fds{};
     FD_ZERO(&fds);
@@ -225,7 +226,7 @@ int PosixSocket::SendMessage(const OrbisNetMsghdr* msg, int flags) {
 #ifdef _WIN32
     int totalSent = 0;
     bool waitAll = (flags & ORBIS_NET_MSG_WAITALL) != 0;
-    bool dontWait = (flags & ORBIS_NET_MSG_DONTWAIT) != 0;
+    bool dontWait = (flags & ORBIS_NET_MSG_DONTWAIT) != 0 && sockopt_so_nbio == 0;
 
     // stream socket with multiple buffers
     bool use_wsamsg =
@@ -291,7 +292,7 @@ int PosixSocket::SendPacket(const void* msg, u32 len, int flags, const OrbisNetS
     std::scoped_lock lock{m_mutex};
     int res = 0;
 #ifdef _WIN32
-    if (flags & ORBIS_NET_MSG_DONTWAIT) {
+    if ((flags & ORBIS_NET_MSG_DONTWAIT) && sockopt_so_nbio == 0) {
         res = socket_is_ready(sock, false);
         if (res <= 0)
             return res;
@@ -314,7 +315,7 @@ int PosixSocket::ReceiveMessage(OrbisNetMsghdr* msg, int flags) {
 #ifdef _WIN32
     int totalReceived = 0;
     bool waitAll = (flags & ORBIS_NET_MSG_WAITALL) != 0;
-    bool dontWait = (flags & ORBIS_NET_MSG_DONTWAIT) != 0;
+    bool dontWait = (flags & ORBIS_NET_MSG_DONTWAIT) != 0 && sockopt_so_nbio == 0;
 
     // stream socket with multiple buffers
     bool use_wsarecvmsg =
@@ -384,7 +385,7 @@ int PosixSocket::ReceivePacket(void* buf, u32 len, int flags, OrbisNetSockaddr*
     std::scoped_lock lock{receive_mutex};
     int res = 0;
 #ifdef _WIN32
-    if (flags & ORBIS_NET_MSG_DONTWAIT) {
+    if ((flags & ORBIS_NET_MSG_DONTWAIT) && sockopt_so_nbio == 0) {
         res = socket_is_ready(sock);
         if (res <= 0)
             return res;
@@ -10,10 +10,19 @@
 #include "core/libraries/ngs2/ngs2_geom.h"
 #include "core/libraries/ngs2/ngs2_impl.h"
 #include "core/libraries/ngs2/ngs2_pan.h"
+#include "core/libraries/ngs2/ngs2_rack.h"
 #include "core/libraries/ngs2/ngs2_report.h"
+#include "core/tls.h"
 
 namespace Libraries::Ngs2 {
 
+/// Size of the buffer the guest provides for a rack. Racks live on the host, so it only has to
+/// look plausible.
+static size_t GetRackBufferSize(const OrbisNgs2RackOption* option) {
+    const u32 max_voices = option ? option->maxVoices : 1;
+    return 0x100 + size_t{max_voices} * 0x100;
+}
+
 // Ngs2
 
 s32 PS4_SYSV_ABI sceNgs2CalcWaveformBlock(const OrbisNgs2WaveformFormat* format, u32 samplePos,
@@ -51,67 +60,172 @@ s32 PS4_SYSV_ABI sceNgs2RackCreate(OrbisNgs2Handle systemHandle, u32 rackId,
                                    const OrbisNgs2RackOption* option,
                                    const OrbisNgs2ContextBufferInfo* bufferInfo,
                                    OrbisNgs2Handle* outHandle) {
-    LOG_ERROR(Lib_Ngs2, "rackId = {}", rackId);
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    LOG_INFO(Lib_Ngs2, "rackId = {:#x}", rackId);
+    System* system = GetHandleObject<System>(systemHandle, OrbisNgs2HandleType::System);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
-    return ORBIS_OK;
+    if (!bufferInfo) {
+        LOG_ERROR(Lib_Ngs2, "Invalid rack buffer info {}", (void*)bufferInfo);
+        return ORBIS_NGS2_ERROR_INVALID_BUFFER_INFO;
+    }
+    if (!outHandle) {
+        LOG_ERROR(Lib_Ngs2, "Invalid rack handle address {}", (void*)outHandle);
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    const s32 result = system->CreateRack(rackId, option, outHandle);
+    if (result == ORBIS_OK) {
+        reinterpret_cast<Rack*>(*outHandle)->buffer_info = *bufferInfo;
+    }
+    return result;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackCreateWithAllocator(OrbisNgs2Handle systemHandle, u32 rackId,
                                                 const OrbisNgs2RackOption* option,
                                                 const OrbisNgs2BufferAllocator* allocator,
                                                 OrbisNgs2Handle* outHandle) {
-    LOG_ERROR(Lib_Ngs2, "rackId = {}", rackId);
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    LOG_INFO(Lib_Ngs2, "rackId = {:#x}", rackId);
+    System* system = GetHandleObject<System>(systemHandle, OrbisNgs2HandleType::System);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
+    }
+    if (!allocator || !allocator->allocHandler) {
+        LOG_ERROR(Lib_Ngs2, "Invalid rack buffer allocator {}", (void*)allocator);
+        return ORBIS_NGS2_ERROR_INVALID_BUFFER_ALLOCATOR;
+    }
+    if (!outHandle) {
+        LOG_ERROR(Lib_Ngs2, "Invalid rack handle address {}", (void*)outHandle);
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    OrbisNgs2ContextBufferInfo bufferInfo{
+        .hostBufferSize = GetRackBufferSize(option),
+        .userData = allocator->userData,
+    };
+    s32 result = Core::ExecuteGuest(allocator->allocHandler, &bufferInfo);
+    if (result < 0) {
+        return result;
     }
+    result = system->CreateRack(rackId, option, outHandle);
+    if (result < 0) {
+        if (allocator->freeHandler) {
+            Core::ExecuteGuest(allocator->freeHandler, &bufferInfo);
+        }
+        return result;
+    }
+    Rack* rack = reinterpret_cast<Rack*>(*outHandle);
+    rack->buffer_info = bufferInfo;
+    rack->host_free = allocator->freeHandler;
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackDestroy(OrbisNgs2Handle rackHandle,
                                     OrbisNgs2ContextBufferInfo* outBufferInfo) {
-    LOG_ERROR(Lib_Ngs2, "called");
+    Rack* rack = GetHandleObject<Rack>(rackHandle, OrbisNgs2HandleType::Rack);
+    if (!rack) {
+        return HandleReportInvalid(rackHandle, 2);
+    }
+    OrbisNgs2ContextBufferInfo bufferInfo = rack->buffer_info;
+    const OrbisNgs2BufferFreeHandler hostFree = rack->host_free;
+    rack->system.DestroyRack(rack);
+    if (outBufferInfo) {
+        *outBufferInfo = bufferInfo;
+    }
+    if (hostFree) {
+        Core::ExecuteGuest(hostFree, &bufferInfo);
+    }
+    LOG_INFO(Lib_Ngs2, "called");
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackGetInfo(OrbisNgs2Handle rackHandle, OrbisNgs2RackInfo* outInfo,
                                     size_t infoSize) {
-    LOG_ERROR(Lib_Ngs2, "infoSize = {}", infoSize);
+    Rack* rack = GetHandleObject<Rack>(rackHandle, OrbisNgs2HandleType::Rack);
+    if (!rack) {
+        return HandleReportInvalid(rackHandle, 2);
+    }
+    if (!outInfo) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    if (infoSize < sizeof(OrbisNgs2RackInfo)) {
+        LOG_ERROR(Lib_Ngs2, "Invalid rack info size ({})", infoSize);
+        return ORBIS_NGS2_ERROR_INVALID_OUT_SIZE;
+    }
+    std::scoped_lock lock{rack->system.mutex};
+    rack->GetInfo(outInfo);
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackGetUserData(OrbisNgs2Handle rackHandle, uintptr_t* outUserData) {
-    LOG_ERROR(Lib_Ngs2, "called");
+    Rack* rack = GetHandleObject<Rack>(rackHandle, OrbisNgs2HandleType::Rack);
+    if (!rack) {
+        return HandleReportInvalid(rackHandle, 2);
+    }
+    if (!outUserData) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    *outUserData = rack->user_data;
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackGetVoiceHandle(OrbisNgs2Handle rackHandle, u32 voiceIndex,
                                            OrbisNgs2Handle* outHandle) {
-    LOG_DEBUG(Lib_Ngs2, "(STUBBED) voiceIndex = {}", voiceIndex);
+    Rack* rack = GetHandleObject<Rack>(rackHandle, OrbisNgs2HandleType::Rack);
+    if (!rack) {
+        return HandleReportInvalid(rackHandle, 2);
+    }
+    if (!outHandle) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    const Voice* voice = rack->GetVoice(voiceIndex);
+    if (!voice) {
+        LOG_ERROR(Lib_Ngs2, "Invalid voice index {}", voiceIndex);
+        return ORBIS_NGS2_ERROR_INVALID_VOICE_INDEX;
+    }
+    *outHandle = voice->GetHandle();
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackLock(OrbisNgs2Handle rackHandle) {
-    LOG_ERROR(Lib_Ngs2, "called");
+    Rack* rack = GetHandleObject<Rack>(rackHandle, OrbisNgs2HandleType::Rack);
+    if (!rack) {
+        return HandleReportInvalid(rackHandle, 2);
+    }
+    rack->system.mutex.lock();
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackQueryBufferSize(u32 rackId, const OrbisNgs2RackOption* option,
                                             OrbisNgs2ContextBufferInfo* outBufferInfo) {
-    LOG_ERROR(Lib_Ngs2, "rackId = {}", rackId);
+    LOG_INFO(Lib_Ngs2, "rackId = {:#x}", rackId);
+    if (!outBufferInfo) {
+        LOG_ERROR(Lib_Ngs2, "Invalid rack buffer info {}", (void*)outBufferInfo);
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    const u32 kind = rackId & 0xF000;
+    if (kind != ORBIS_NGS2_RACK_ID_VOICE && kind != ORBIS_NGS2_RACK_ID_CHANNEL) {
+        return ORBIS_NGS2_ERROR_INVALID_RACK_ID;
+    }
+    outBufferInfo->hostBuffer = nullptr;
+    outBufferInfo->hostBufferSize = GetRackBufferSize(option);
+    MemoryClear(&outBufferInfo->reserved, sizeof(outBufferInfo->reserved));
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackSetUserData(OrbisNgs2Handle rackHandle, uintptr_t userData) {
-    LOG_ERROR(Lib_Ngs2, "userData = {}", userData);
+    Rack* rack = GetHandleObject<Rack>(rackHandle, OrbisNgs2HandleType::Rack);
+    if (!rack) {
+        return HandleReportInvalid(rackHandle, 2);
+    }
+    rack->user_data = userData;
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2RackUnlock(OrbisNgs2Handle rackHandle) {
-    LOG_ERROR(Lib_Ngs2, "called");
+    Rack* rack = GetHandleObject<Rack>(rackHandle, OrbisNgs2HandleType::Rack);
+    if (!rack) {
+        return HandleReportInvalid(rackHandle, 2);
+    }
+    rack->system.mutex.unlock();
     return ORBIS_OK;
 }
 
@@ -185,12 +299,8 @@ s32 PS4_SYSV_ABI sceNgs2SystemCreateWithAllocator(const OrbisNgs2SystemOption* o
 
 s32 PS4_SYSV_ABI sceNgs2SystemDestroy(OrbisNgs2Handle systemHandle,
                                       OrbisNgs2ContextBufferInfo* outBufferInfo) {
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
-    }
     LOG_INFO(Lib_Ngs2, "called");
-    return ORBIS_OK;
+    return SystemCleanup(systemHandle, outBufferInfo);
 }
 
 s32 PS4_SYSV_ABI sceNgs2SystemEnumHandles(OrbisNgs2Handle* aOutHandle, u32 maxHandles) {
@@ -200,35 +310,56 @@ s32 PS4_SYSV_ABI sceNgs2SystemEnumHandles(OrbisNgs2Handle* aOutHandle, u32 maxHa
 
 s32 PS4_SYSV_ABI sceNgs2SystemEnumRackHandles(OrbisNgs2Handle systemHandle,
                                               OrbisNgs2Handle* aOutHandle, u32 maxHandles) {
-    LOG_ERROR(Lib_Ngs2, "maxHandles = {}", maxHandles);
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    System* system = GetHandleObject<System>(systemHandle, OrbisNgs2HandleType::System);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
-    return ORBIS_OK;
+    std::scoped_lock lock{system->mutex};
+    const auto& racks = system->Racks();
+    if (aOutHandle) {
+        for (u32 i = 0; i < std::min<size_t>(maxHandles, racks.size()); ++i) {
+            aOutHandle[i] = racks[i]->GetHandle();
+        }
+    }
+    return static_cast<s32>(racks.size());
 }
 
-s32 PS4_SYSV_ABI sceNgs2SystemGetInfo(OrbisNgs2Handle rackHandle, OrbisNgs2SystemInfo* outInfo,
+s32 PS4_SYSV_ABI sceNgs2SystemGetInfo(OrbisNgs2Handle systemHandle, OrbisNgs2SystemInfo* outInfo,
                                       size_t infoSize) {
-    LOG_ERROR(Lib_Ngs2, "infoSize = {}", infoSize);
+    System* system = GetHandleObject<System>(systemHandle, OrbisNgs2HandleType::System);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
+    }
+    if (!outInfo) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    if (infoSize < sizeof(OrbisNgs2SystemInfo)) {
+        LOG_ERROR(Lib_Ngs2, "Invalid system info size ({})", infoSize);
+        return ORBIS_NGS2_ERROR_INVALID_OUT_SIZE;
+    }
+    std::scoped_lock lock{system->mutex};
+    system->GetInfo(outInfo);
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2SystemGetUserData(OrbisNgs2Handle systemHandle, uintptr_t* outUserData) {
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    System* system = GetHandleObject<System>(systemHandle, OrbisNgs2HandleType::System);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
-    LOG_ERROR(Lib_Ngs2, "called");
+    if (!outUserData) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    *outUserData = system->user_data;
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2SystemLock(OrbisNgs2Handle systemHandle) {
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    System* system = GetHandleObject<System>(systemHandle, OrbisNgs2HandleType::System);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
-    LOG_ERROR(Lib_Ngs2, "called");
+    system->mutex.lock();
     return ORBIS_OK;
 }
 
@@ -249,12 +380,12 @@ s32 PS4_SYSV_ABI sceNgs2SystemQueryBufferSize(const OrbisNgs2SystemOption* optio
 s32 PS4_SYSV_ABI sceNgs2SystemRender(OrbisNgs2Handle systemHandle,
                                      const OrbisNgs2RenderBufferInfo* aBufferInfo,
                                      u32 numBufferInfo) {
-    LOG_DEBUG(Lib_Ngs2, "(STUBBED) numBufferInfo = {}", numBufferInfo);
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    LOG_TRACE(Lib_Ngs2, "numBufferInfo = {}", numBufferInfo);
+    System* system = GetHandleObject<System>(systemHandle, OrbisNgs2HandleType::System);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
-    return ORBIS_OK;
+    return system->Render(aBufferInfo, numBufferInfo);
 }
 
 static s32 PS4_SYSV_ABI sceNgs2SystemResetOption(OrbisNgs2SystemOption* outOption) {
@@ -272,73 +403,132 @@ static s32 PS4_SYSV_ABI sceNgs2SystemResetOption(OrbisNgs2SystemOption* outOptio
 }
 
 s32 PS4_SYSV_ABI sceNgs2SystemSetGrainSamples(OrbisNgs2Handle systemHandle, u32 numSamples) {
-    LOG_ERROR(Lib_Ngs2, "numSamples = {}", numSamples);
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    LOG_INFO(Lib_Ngs2, "numSamples = {}", numSamples);
+    System* system = GetHandleObject<System>(systemHandle, OrbisNgs2HandleType::System);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
+    }
+    if (numSamples < 64 || numSamples > system->max_grain_samples || (numSamples & 63) != 0) {
+        LOG_ERROR(Lib_Ngs2, "Invalid grain samples ({},x64)", numSamples);
+        return ORBIS_NGS2_ERROR_INVALID_NUM_GRAIN_SAMPLES;
     }
+    std::scoped_lock lock{system->mutex};
+    system->num_grain_samples = numSamples;
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2SystemSetSampleRate(OrbisNgs2Handle systemHandle, u32 sampleRate) {
-    LOG_ERROR(Lib_Ngs2, "sampleRate = {}", sampleRate);
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    LOG_INFO(Lib_Ngs2, "sampleRate = {}", sampleRate);
+    System* system = GetHandleObject<System>(systemHandle, OrbisNgs2HandleType::System);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
+    if (sampleRate == 0) {
+        return ORBIS_NGS2_ERROR_INVALID_SAMPLE_RATE;
+    }
+    std::scoped_lock lock{system->mutex};
+    system->sample_rate = sampleRate;
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2SystemSetUserData(OrbisNgs2Handle systemHandle, uintptr_t userData) {
-    LOG_ERROR(Lib_Ngs2, "userData = {}", userData);
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    System* system = GetHandleObject<System>(systemHandle, OrbisNgs2HandleType::System);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
+    system->user_data = userData;
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2SystemUnlock(OrbisNgs2Handle systemHandle) {
-    if (!systemHandle) {
-        LOG_ERROR(Lib_Ngs2, "systemHandle is nullptr");
-        return ORBIS_NGS2_ERROR_INVALID_SYSTEM_HANDLE;
+    System* system = GetHandleObject<System>(systemHandle, OrbisNgs2HandleType::System);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
-    LOG_ERROR(Lib_Ngs2, "called");
+    system->mutex.unlock();
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2VoiceControl(OrbisNgs2Handle voiceHandle,
                                      const OrbisNgs2VoiceParamHeader* paramList) {
-    LOG_ERROR(Lib_Ngs2, "called");
-    return ORBIS_OK;
+    Voice* voice = GetHandleObject<Voice>(voiceHandle, OrbisNgs2HandleType::Voice);
+    if (!voice) {
+        return HandleReportInvalid(voiceHandle, 4);
+    }
+    std::scoped_lock lock{voice->rack.system.mutex};
+    return voice->Control(paramList);
 }
 
 s32 PS4_SYSV_ABI sceNgs2VoiceGetMatrixInfo(OrbisNgs2Handle voiceHandle, u32 matrixId,
                                            OrbisNgs2VoiceMatrixInfo* outInfo, size_t outInfoSize) {
-    LOG_ERROR(Lib_Ngs2, "matrixId = {}, outInfoSize = {}", matrixId, outInfoSize);
-    return ORBIS_OK;
+    Voice* voice = GetHandleObject<Voice>(voiceHandle, OrbisNgs2HandleType::Voice);
+    if (!voice) {
+        return HandleReportInvalid(voiceHandle, 4);
+    }
+    if (!outInfo) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    if (outInfoSize < sizeof(OrbisNgs2VoiceMatrixInfo)) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_SIZE;
+    }
+    std::scoped_lock lock{voice->rack.system.mutex};
+    return voice->GetMatrixInfo(matrixId, outInfo);
 }
 
 s32 PS4_SYSV_ABI sceNgs2VoiceGetOwner(OrbisNgs2Handle voiceHandle, OrbisNgs2Handle* outRackHandle,
                                       u32* outVoiceId) {
-    LOG_ERROR(Lib_Ngs2, "called");
+    Voice* voice = GetHandleObject<Voice>(voiceHandle, OrbisNgs2HandleType::Voice);
+    if (!voice) {
+        return HandleReportInvalid(voiceHandle, 4);
+    }
+    if (outRackHandle) {
+        *outRackHandle = voice->rack.GetHandle();
+    }
+    if (outVoiceId) {
+        *outVoiceId = voice->index;
+    }
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceNgs2VoiceGetPortInfo(OrbisNgs2Handle voiceHandle, u32 port,
                                          OrbisNgs2VoicePortInfo* outInfo, size_t outInfoSize) {
-    LOG_ERROR(Lib_Ngs2, "port = {}, outInfoSize = {}", port, outInfoSize);
-    return ORBIS_OK;
+    Voice* voice = GetHandleObject<Voice>(voiceHandle, OrbisNgs2HandleType::Voice);
+    if (!voice) {
+        return HandleReportInvalid(voiceHandle, 4);
+    }
+    if (!outInfo) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    if (outInfoSize < sizeof(OrbisNgs2VoicePortInfo)) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_SIZE;
+    }
+    std::scoped_lock lock{voice->rack.system.mutex};
+    return voice->GetPortInfo(port, outInfo);
 }
 
 s32 PS4_SYSV_ABI sceNgs2VoiceGetState(OrbisNgs2Handle voiceHandle, OrbisNgs2VoiceState* outState,
                                       size_t stateSize) {
-    LOG_ERROR(Lib_Ngs2, "stateSize = {}", stateSize);
-    return ORBIS_OK;
+    Voice* voice = GetHandleObject<Voice>(voiceHandle, OrbisNgs2HandleType::Voice);
+    if (!voice) {
+        return HandleReportInvalid(voiceHandle, 4);
+    }
+    if (!outState) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    std::scoped_lock lock{voice->rack.system.mutex};
+    return voice->GetState(outState, stateSize);
 }
 
 s32 PS4_SYSV_ABI sceNgs2VoiceGetStateFlags(OrbisNgs2Handle voiceHandle, u32* outStateFlags) {
-    LOG_ERROR(Lib_Ngs2, "called");
+    Voice* voice = GetHandleObject<Voice>(voiceHandle, OrbisNgs2HandleType::Voice);
+    if (!voice) {
+        return HandleReportInvalid(voiceHandle, 4);
+    }
+    if (!outStateFlags) {
+        return ORBIS_NGS2_ERROR_INVALID_OUT_ADDRESS;
+    }
+    std::scoped_lock lock{voice->rack.system.mutex};
+    *outStateFlags = voice->GetStateFlags();
     return ORBIS_OK;
 }
 
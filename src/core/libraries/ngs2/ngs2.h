@@ -32,6 +32,48 @@ static const int ORBIS_NGS2_WAVEFORM_INFO_MAX_BLOCKS = 4;
 static const int ORBIS_NGS2_MAX_MATRIX_LEVELS =
     (ORBIS_NGS2_MAX_VOICE_CHANNELS * ORBIS_NGS2_MAX_VOICE_CHANNELS);
 
+// Rack ids, the low bits select the module within a kind of rack
+static const u32 ORBIS_NGS2_RACK_ID_VOICE = 0x1000;
+static const u32 ORBIS_NGS2_RACK_ID_SAMPLER = ORBIS_NGS2_RACK_ID_VOICE + 1;
+static const u32 ORBIS_NGS2_RACK_ID_CHANNEL = 0x2000;
+static const u32 ORBIS_NGS2_RACK_ID_MASTERING = ORBIS_NGS2_RACK_ID_CHANNEL + 1;
+static const u32 ORBIS_NGS2_RACK_ID_SUBMIXER = ORBIS_NGS2_RACK_ID_CHANNEL + 2;
+
+enum class OrbisNgs2WaveformType : u32 {
+    None = 0,
+    PcmI16L = 0x12,
+    PcmI16B = 0x13,
+    PcmF32L = 0x18,
+    PcmF32B = 0x19,
+    Vag = 0x1C,
+    Atrac9 = 0x40,
+};
+
+// Voice params shared by every rack
+static const u32 ORBIS_NGS2_VOICE_PARAM_MATRIX_LEVELS = 1;
+static const u32 ORBIS_NGS2_VOICE_PARAM_PORT_MATRIX = 2;
+static const u32 ORBIS_NGS2_VOICE_PARAM_PORT_VOLUME = 3;
+static const u32 ORBIS_NGS2_VOICE_PARAM_PORT_DELAY = 4;
+static const u32 ORBIS_NGS2_VOICE_PARAM_PATCH = 5;
+static const u32 ORBIS_NGS2_VOICE_PARAM_EVENT = 6;
+static const u32 ORBIS_NGS2_VOICE_PARAM_CALLBACK = 7;
+
+static const u32 ORBIS_NGS2_VOICE_EVENT_PLAY = 0;
+static const u32 ORBIS_NGS2_VOICE_EVENT_STOP = 1;
+static const u32 ORBIS_NGS2_VOICE_EVENT_STOP_IMM = 2;
+static const u32 ORBIS_NGS2_VOICE_EVENT_KILL = 3;
+static const u32 ORBIS_NGS2_VOICE_EVENT_PAUSE = 4;
+static const u32 ORBIS_NGS2_VOICE_EVENT_RESUME = 5;
+
+static const u32 ORBIS_NGS2_VOICE_STATE_FLAG_INUSE = 0x1;
+static const u32 ORBIS_NGS2_VOICE_STATE_FLAG_PLAYING = 0x2;
+static const u32 ORBIS_NGS2_VOICE_STATE_FLAG_PAUSED = 0x4;
+static const u32 ORBIS_NGS2_VOICE_STATE_FLAG_STOPPED = 0x8;
+static const u32 ORBIS_NGS2_VOICE_STATE_FLAG_ERROR = 0x10;
+static const u32 ORBIS_NGS2_VOICE_STATE_FLAG_EMPTY = 0x20;
+
+static const u32 ORBIS_NGS2_VOICE_CALLBACK_FLAG_WAVEFORM_BLOCK_END = 0x1;
+
 struct OrbisNgs2WaveformFormat {
     u32 waveformType;
     u32 numChannels;
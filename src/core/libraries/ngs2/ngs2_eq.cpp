@@ -1,12 +1,131 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "ngs2_eq.h"
 #include "ngs2_error.h"
 #include "ngs2_impl.h"
+#include "ngs2_sampler.h"
+#include "ngs2_submixer.h"
 
 #include "common/logging/log.h"
 #include "core/libraries/error_codes.h"
 
 using namespace Libraries::Kernel;
 
-namespace Libraries::Ngs2 {} // namespace Libraries::Ngs2
+namespace Libraries::Ngs2 {
+
+void Biquad::SetFcq(OrbisNgs2FilterType type, float fc, float q, float level, u32 sample_rate) {
+    const float w0 = 2.0f * std::numbers::pi_v<float> *
+                     std::clamp(fc, 1.0f, sample_rate * 0.49f) / static_cast<float>(sample_rate);
+    const float cos_w0 = std::cos(w0);
+    const float alpha = std::sin(w0) / (2.0f * std::max(q, 0.01f));
+    const float amp = std::sqrt(std::max(level, 0.0f));
+    float n0, n1, n2, d0, d1, d2;
+    switch (type) {
+    case OrbisNgs2FilterType::Lpf:
+        n0 = n2 = (1.0f - cos_w0) / 2.0f;
+        n1 = 1.0f - cos_w0;
+        d0 = 1.0f + alpha, d1 = -2.0f * cos_w0, d2 = 1.0f - alpha;
+        break;
+    case OrbisNgs2FilterType::Hpf:
+        n0 = n2 = (1.0f + cos_w0) / 2.0f;
+        n1 = -(1.0f + cos_w0);
+        d0 = 1.0f + alpha, d1 = -2.0f * cos_w0, d2 = 1.0f - alpha;
+        break;
+    case OrbisNgs2FilterType::Bpf:
+        n0 = alpha, n1 = 0.0f, n2 = -alpha;
+        d0 = 1.0f + alpha, d1 = -2.0f * cos_w0, d2 = 1.0f - alpha;
+        break;
+    case OrbisNgs2FilterType::Bef:
+        n0 = n2 = 1.0f;
+        n1 = -2.0f * cos_w0;
+        d0 = 1.0f + alpha, d1 = -2.0f * cos_w0, d2 = 1.0f - alpha;
+        break;
+    case OrbisNgs2FilterType::Peaking:
+        n0 = 1.0f + alpha * amp, n1 = -2.0f * cos_w0, n2 = 1.0f - alpha * amp;
+        d0 = 1.0f + alpha / amp, d1 = -2.0f * cos_w0, d2 = 1.0f - alpha / amp;
+        break;
+    case OrbisNgs2FilterType::LowShelf:
+    case OrbisNgs2FilterType::HighShelf: {
+        // The high shelf mirrors the low shelf by flipping the sign of cos(w0)
+        const float sign = type == OrbisNgs2FilterType::LowShelf ? 1.0f : -1.0f;
+        const float beta = 2.0f * std::sqrt(amp) * alpha;
+        const float c = sign * cos_w0;
+        n0 = amp * ((amp + 1.0f) - (amp - 1.0f) * c + beta);
+        n1 = sign * 2.0f * amp * ((amp - 1.0f) - (amp + 1.0f) * c);
+        n2 = amp * ((amp + 1.0f) - (amp - 1.0f) * c - beta);
+        d0 = (amp + 1.0f) + (amp - 1.0f) * c + beta;
+        d1 = sign * -2.0f * ((amp - 1.0f) + (amp + 1.0f) * c);
+        d2 = (amp + 1.0f) + (amp - 1.0f) * c - beta;
+        break;
+    }
+    default:
+        return;
+    }
+    // Cookbook filters other than the peaking and shelving ones take the level as output gain
+    const bool scaled = type <= OrbisNgs2FilterType::Bef;
+    const float gain = scaled ? level : 1.0f;
+    SetDirect(gain * n0 / d0, gain * n1 / d0, gain * n2 / d0, d1 / d0, d2 / d0);
+}
+
+void Biquad::SetDirect(float i0, float i1, float i2, float o1, float o2) {
+    if (!enabled) {
+        z1.fill(0.0f);
+        z2.fill(0.0f);
+    }
+    b0 = i0, b1 = i1, b2 = i2, a1 = o1, a2 = o2;
+    enabled = true;
+}
+
+void Biquad::Process(std::array<std::vector<float>, ORBIS_NGS2_MAX_VOICE_CHANNELS>& channels,
+                     u32 num_channels, u32 num_samples) {
+    if (!enabled) {
+        return;
+    }
+    for (u32 ch = 0; ch < num_channels; ++ch) {
+        if (channel_mask != 0 && !(channel_mask & (1U << ch))) {
+            continue;
+        }
+        // Transposed direct form II, the recursion keeps the samples of a channel serial
+        float s1 = z1[ch];
+        float s2 = z2[ch];
+        float* samples = channels[ch].data();
+        for (u32 i = 0; i < num_samples; ++i) {
+            const float x = samples[i];
+            const float y = b0 * x + s1;
+            s1 = b1 * x - a1 * y + s2;
+            s2 = b2 * x - a2 * y;
+            samples[i] = y;
+        }
+        z1[ch] = s1;
+        z2[ch] = s2;
+    }
+}
+
+template <typename FilterParam>
+s32 SetFilterParam(std::vector<Biquad>& filters, const FilterParam& param, u32 sample_rate) {
+    if (param.index >= filters.size()) {
+        LOG_ERROR(Lib_Ngs2, "Invalid filter index {}", param.index);
+        return ORBIS_NGS2_ERROR_INVALID_FILTER_INDEX;
+    }
+    Biquad& filter = filters[param.index];
+    filter.SetChannelMask(param.channelMask);
+    const auto type = static_cast<OrbisNgs2FilterType>(param.type);
+    if (type <= OrbisNgs2FilterType::HighShelf) {
+        filter.SetFcq(type, param.param.fcq.fc, param.param.fcq.q, param.param.fcq.level,
+                      sample_rate);
+    } else {
+        const auto& direct = param.param.direct;
+        filter.SetDirect(direct.i0, direct.i1, direct.i2, direct.o1, direct.o2);
+    }
+    return ORBIS_OK;
+}
+
+template s32 SetFilterParam(std::vector<Biquad>&, const OrbisNgs2SamplerVoiceFilterParam&, u32);
+template s32 SetFilterParam(std::vector<Biquad>&, const OrbisNgs2SubmixerVoiceFilterParam&, u32);
+
+} // namespace Libraries::Ngs2
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <array>
+#include <vector>
 #include "ngs2.h"
 
 namespace Libraries::Ngs2 {
@@ -38,4 +40,57 @@ struct OrbisNgs2EqVoiceState {
     u32 stateFlags;
 };
 
+/// Filters designed from a cutoff, q and level. Other types take the direct coefficients.
+enum class OrbisNgs2FilterType : u32 {
+    Lpf = 0,
+    Hpf = 1,
+    Bpf = 2,
+    Bef = 3,
+    Peaking = 4,
+    LowShelf = 5,
+    HighShelf = 6,
+};
+
+/// Biquad applied to the channels of a voice selected by a mask. The state of the channels is
+/// kept side by side so one filter covers every channel of the voice.
+class Biquad {
+public:
+    /// Designs the filter with the formulas of the RBJ audio EQ cookbook, level is linear.
+    void SetFcq(OrbisNgs2FilterType type, float fc, float q, float level, u32 sample_rate);
+
+    /// Takes the coefficients as y = i0 x[n] + i1 x[n-1] + i2 x[n-2] - o1 y[n-1] - o2 y[n-2].
+    void SetDirect(float i0, float i1, float i2, float o1, float o2);
+
+    void SetChannelMask(u32 mask) {
+        channel_mask = mask;
+    }
+
+    [[nodiscard]] bool IsEnabled() const {
+        return enabled;
+    }
+
+    void Disable() {
+        enabled = false;
+    }
+
+    /// Filters num_samples of every channel in the mask in place.
+    void Process(std::array<std::vector<float>, ORBIS_NGS2_MAX_VOICE_CHANNELS>& channels,
+                 u32 num_channels, u32 num_samples);
+
+private:
+    bool enabled{};
+    u32 channel_mask{};
+    float b0{1.0f};
+    float b1{};
+    float b2{};
+    float a1{};
+    float a2{};
+    std::array<float, ORBIS_NGS2_MAX_VOICE_CHANNELS> z1{};
+    std::array<float, ORBIS_NGS2_MAX_VOICE_CHANNELS> z2{};
+};
+
+/// Applies a sampler or submixer filter param with the layout shared by both to filters.
+template <typename FilterParam>
+s32 SetFilterParam(std::vector<Biquad>& filters, const FilterParam& param, u32 sample_rate);
+
 } // namespace Libraries::Ngs2
@@ -3,10 +3,12 @@
 
 #include "ngs2_error.h"
 #include "ngs2_impl.h"
+#include "ngs2_rack.h"
 
 #include "common/logging/log.h"
 #include "core/libraries/error_codes.h"
 #include "core/libraries/kernel/kernel.h"
+#include "core/tls.h"
 
 using namespace Libraries::Kernel;
 
@@ -62,12 +64,21 @@ s32 StackBufferOpen(StackBuffer* stackBuffer, void* bufferStart, size_t bufferSi
 }
 
 s32 SystemCleanup(OrbisNgs2Handle systemHandle, OrbisNgs2ContextBufferInfo* outInfo) {
-    if (!systemHandle) {
-        return ORBIS_NGS2_ERROR_INVALID_HANDLE;
+    System* system = GetHandleObject<System>(systemHandle, OrbisNgs2HandleType::System);
+    if (!system) {
+        return HandleReportInvalid(systemHandle, 1);
     }
+    const OrbisNgs2ContextBufferInfo buffer_info = system->buffer_info;
+    const OrbisNgs2BufferFreeHandler host_free = system->host_free;
+    delete system;
 
-    // TODO
-
+    if (outInfo) {
+        *outInfo = buffer_info;
+    }
+    if (host_free) {
+        OrbisNgs2ContextBufferInfo free_info = buffer_info;
+        Core::ExecuteGuest(host_free, &free_info);
+    }
     return ORBIS_OK;
 }
 
@@ -101,8 +112,9 @@ s32 SystemSetupCore(StackBuffer* stackBuffer, const OrbisNgs2SystemOption* optio
     }
 
     if (outSystem) {
-        // dummy handle
-        outSystem->systemHandle = 1;
+        outSystem->sampleRate = sampleRate;
+        outSystem->maxGrainSamples = static_cast<u16>(maxGrainSamples);
+        outSystem->numGrainSamples = static_cast<u16>(numGrainSamples);
     }
 
     return ORBIS_OK;
@@ -165,23 +177,13 @@ s32 SystemSetup(const OrbisNgs2SystemOption* option, OrbisNgs2ContextBufferInfo*
 
     StackBufferClose(&stackBuffer, &requiredBufferSize);
 
-    // Copy buffer results
-    setupResult.bufferInfo = *hostBufferInfo;
-    setupResult.hostFree = hostFree;
-    // TODO
-    // setupResult.systemList = systemList;
-
-    OrbisNgs2Handle systemHandle = setupResult.systemHandle;
-    if (hostBufferInfo->hostBufferSize >= requiredBufferSize) {
-        *outHandle = systemHandle;
-        return ORBIS_OK;
-    }
-
-    SystemCleanup(systemHandle, 0);
-
-    LOG_ERROR(Lib_Ngs2, "Invalid system buffer size ({}<{}[byte])", hostBufferInfo->hostBufferSize,
-              requiredBufferSize);
-    return ORBIS_NGS2_ERROR_INVALID_BUFFER_SIZE;
+    // The system lives on the host, the buffer of the guest is handed back when it is destroyed
+    auto* system = new System(setupResult.sampleRate, setupResult.numGrainSamples,
+                              setupResult.maxGrainSamples);
+    system->buffer_info = *hostBufferInfo;
+    system->host_free = hostFree;
+    *outHandle = system->GetHandle();
+    return ORBIS_OK;
 }
 
 } // namespace Libraries::Ngs2
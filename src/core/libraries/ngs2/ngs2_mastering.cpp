@@ -1,12 +1,125 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <cmath>
+
 #include "ngs2_error.h"
 #include "ngs2_impl.h"
+#include "ngs2_mastering.h"
+#include "ngs2_rack.h"
 
 #include "common/logging/log.h"
 #include "core/libraries/error_codes.h"
 
 using namespace Libraries::Kernel;
 
-namespace Libraries::Ngs2 {} // namespace Libraries::Ngs2
+namespace Libraries::Ngs2 {
+
+namespace {
+
+/// Channel of the low frequency effects in the 5.1 and 7.1 layouts
+constexpr u32 LfeChannel = 3;
+
+/// Applies the output gains and the limiter to the sum of its inputs, which the system writes to
+/// the render buffer of the output id.
+class MasteringVoice final : public Voice {
+public:
+    explicit MasteringVoice(Rack& rack, u32 index) : Voice{rack, index} {}
+
+    void Render(u32 num_samples) override {
+        has_output = false;
+        if ((state_flags & (ORBIS_NGS2_VOICE_STATE_FLAG_INUSE |
+                            ORBIS_NGS2_VOICE_STATE_FLAG_PAUSED)) !=
+            ORBIS_NGS2_VOICE_STATE_FLAG_INUSE) {
+            ClearInput();
+            return;
+        }
+        for (u32 ch = 0; ch < num_channels; ++ch) {
+            std::swap(input[ch], output[ch]);
+            const bool is_lfe = num_channels > LfeChannel + 1 && ch == LfeChannel;
+            const float gain = is_lfe ? lfe_level : fbw_level;
+            if (gain != 1.0f) {
+                Scale(output[ch].data(), gain, num_samples);
+            }
+            if (limiter_enabled) {
+                // Hard limit, the guest sees the peak it reached
+                for (u32 s = 0; s < num_samples; ++s) {
+                    float& sample = output[ch][s];
+                    limiter_peak = std::max(limiter_peak, std::abs(sample));
+                    sample = std::clamp(sample, -limiter_threshold, limiter_threshold);
+                }
+            }
+        }
+        ClearInput();
+        has_output = true;
+    }
+
+    s32 OutputId() const override {
+        return static_cast<s32>(output_id);
+    }
+
+    s32 GetState(void* out_state, size_t state_size) const override {
+        if (state_size < sizeof(OrbisNgs2MasteringVoiceState)) {
+            return Voice::GetState(out_state, state_size);
+        }
+        auto* state = static_cast<OrbisNgs2MasteringVoiceState*>(out_state);
+        *state = {
+            .voiceState = {.stateFlags = state_flags},
+            .limiterPeakLevel = limiter_peak,
+            .limiterPressLevel = std::max(limiter_peak - limiter_threshold, 0.0f),
+        };
+        return ORBIS_OK;
+    }
+
+protected:
+    s32 SetParam(const OrbisNgs2VoiceParamHeader& param) override {
+        switch (param.id) {
+        case ORBIS_NGS2_MASTERING_VOICE_PARAM_SETUP: {
+            const auto& setup =
+                reinterpret_cast<const OrbisNgs2MasteringVoiceSetupParam&>(param);
+            if (setup.numInputChannels == 0 ||
+                setup.numInputChannels > ORBIS_NGS2_MAX_VOICE_CHANNELS) {
+                return ORBIS_NGS2_ERROR_INVALID_NUM_CHANNELS;
+            }
+            SetupChannels(setup.numInputChannels);
+            state_flags = ORBIS_NGS2_VOICE_STATE_FLAG_INUSE;
+            return ORBIS_OK;
+        }
+        case ORBIS_NGS2_MASTERING_VOICE_PARAM_LIMITER: {
+            const auto& limiter =
+                reinterpret_cast<const OrbisNgs2MasteringVoiceLimiterParam&>(param);
+            limiter_enabled = limiter.enableFlag != 0;
+            limiter_threshold = std::max(limiter.threshold, 0.0f);
+            return ORBIS_OK;
+        }
+        case ORBIS_NGS2_MASTERING_VOICE_PARAM_GAIN: {
+            const auto& gain = reinterpret_cast<const OrbisNgs2MasteringVoiceGainParam&>(param);
+            fbw_level = gain.fbwLevel;
+            lfe_level = gain.lfeLevel;
+            return ORBIS_OK;
+        }
+        case ORBIS_NGS2_MASTERING_VOICE_PARAM_OUTPUT:
+            output_id = reinterpret_cast<const OrbisNgs2MasteringVoiceOutputParam&>(param).outputId;
+            return ORBIS_OK;
+        default:
+            return Voice::SetParam(param);
+        }
+    }
+
+private:
+    u32 output_id{};
+    float fbw_level{1.0f};
+    float lfe_level{1.0f};
+    bool limiter_enabled{};
+    float limiter_threshold{1.0f};
+    float limiter_peak{};
+};
+
+} // Anonymous namespace
+
+std::unique_ptr<Voice> CreateMasteringVoice(Rack& rack, u32 index) {
+    return std::make_unique<MasteringVoice>(rack, index);
+}
+
+} // namespace Libraries::Ngs2
@@ -9,6 +9,14 @@ namespace Libraries::Ngs2 {
 
 class Ngs2Mastering;
 
+static const u32 ORBIS_NGS2_MASTERING_VOICE_PARAM_SETUP = 0x30000001;
+static const u32 ORBIS_NGS2_MASTERING_VOICE_PARAM_MATRIX = 0x30000002;
+static const u32 ORBIS_NGS2_MASTERING_VOICE_PARAM_LFE = 0x30000003;
+static const u32 ORBIS_NGS2_MASTERING_VOICE_PARAM_LIMITER = 0x30000004;
+static const u32 ORBIS_NGS2_MASTERING_VOICE_PARAM_GAIN = 0x30000005;
+static const u32 ORBIS_NGS2_MASTERING_VOICE_PARAM_OUTPUT = 0x30000006;
+static const u32 ORBIS_NGS2_MASTERING_VOICE_PARAM_PEAK_METER = 0x30000007;
+
 struct OrbisNgs2MasteringRackOption {
     OrbisNgs2RackOption rackOption;
     u32 maxChannels;
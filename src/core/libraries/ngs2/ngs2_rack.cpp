@@ -0,0 +1,580 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+#include <latch>
+#include <thread>
+#include <unordered_map>
+
+#include "common/arch.h"
+#include "common/logging/log.h"
+#include "common/thread_worker.h"
+#include "core/libraries/error_codes.h"
+#include "core/libraries/ngs2/ngs2_error.h"
+#include "core/libraries/ngs2/ngs2_rack.h"
+#include "core/tls.h"
+
+#ifdef ARCH_X86_64
+#include <emmintrin.h>
+#endif
+
+namespace Libraries::Ngs2 {
+
+namespace {
+
+/// Racks with at least this many voices spread their rendering over the workers.
+constexpr size_t ParallelVoices = 64;
+
+/// Bound on the length of a param chain, a longer one is taken for a loop.
+constexpr u32 MaxControlParams = 1024;
+
+std::mutex handles_mutex;
+std::unordered_map<OrbisNgs2Handle, OrbisNgs2HandleType> handles;
+
+Common::ThreadWorker& RenderWorkers() {
+    static Common::ThreadWorker workers{
+        std::clamp<size_t>(std::thread::hardware_concurrency() / 4, 1, 4), "shadPS4:Ngs2Render"};
+    return workers;
+}
+
+RackType GetRackType(u32 rack_id) {
+    if ((rack_id & 0xF000) == ORBIS_NGS2_RACK_ID_VOICE) {
+        return RackType::Sampler;
+    }
+    return rack_id == ORBIS_NGS2_RACK_ID_MASTERING ? RackType::Mastering : RackType::Submixer;
+}
+
+} // Anonymous namespace
+
+void MixScaled(const float* input, float* output, float gain, size_t num_samples) {
+    size_t i = 0;
+#ifdef ARCH_X86_64
+    const __m128 gains = _mm_set1_ps(gain);
+    for (; i + 4 <= num_samples; i += 4) {
+        const __m128 scaled = _mm_mul_ps(_mm_loadu_ps(input + i), gains);
+        _mm_storeu_ps(output + i, _mm_add_ps(_mm_loadu_ps(output + i), scaled));
+    }
+#endif
+    for (; i < num_samples; ++i) {
+        output[i] += input[i] * gain;
+    }
+}
+
+void Scale(float* samples, float gain, size_t num_samples) {
+    size_t i = 0;
+#ifdef ARCH_X86_64
+    const __m128 gains = _mm_set1_ps(gain);
+    for (; i + 4 <= num_samples; i += 4) {
+        _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), gains));
+    }
+#endif
+    for (; i < num_samples; ++i) {
+        samples[i] *= gain;
+    }
+}
+
+void RegisterHandle(OrbisNgs2Handle handle, OrbisNgs2HandleType type) {
+    std::scoped_lock lock{handles_mutex};
+    handles.emplace(handle, type);
+}
+
+void UnregisterHandle(OrbisNgs2Handle handle) {
+    std::scoped_lock lock{handles_mutex};
+    handles.erase(handle);
+}
+
+bool IsValidHandle(OrbisNgs2Handle handle, OrbisNgs2HandleType type) {
+    std::scoped_lock lock{handles_mutex};
+    const auto it = handles.find(handle);
+    return it != handles.end() && it->second == type;
+}
+
+Voice::Voice(Rack& rack_, u32 index_)
+    : rack{rack_}, index{index_}, ports(rack_.max_ports), matrices(rack_.max_matrices) {
+    RegisterHandle(GetHandle(), OrbisNgs2HandleType::Voice);
+}
+
+Voice::~Voice() {
+    UnregisterHandle(GetHandle());
+}
+
+void Voice::SetupChannels(u32 num_channels_) {
+    num_channels = num_channels_;
+    for (u32 ch = 0; ch < ORBIS_NGS2_MAX_VOICE_CHANNELS; ++ch) {
+        const size_t size = ch < num_channels ? rack.max_grain_samples : 0;
+        input[ch].assign(size, 0.0f);
+        output[ch].assign(size, 0.0f);
+    }
+    has_input = false;
+    has_output = false;
+}
+
+s32 Voice::Control(const OrbisNgs2VoiceParamHeader* param_list) {
+    const auto* param = param_list;
+    for (u32 count = 0; param != nullptr; ++count) {
+        if (count == MaxControlParams) {
+            LOG_ERROR(Lib_Ngs2, "Voice param chain does not end");
+            return ORBIS_NGS2_ERROR_DETECTED_CIRCULAR_VOICE_CONTROL;
+        }
+        if (param->size < sizeof(OrbisNgs2VoiceParamHeader)) {
+            LOG_ERROR(Lib_Ngs2, "Invalid voice param size ({}) of param {:#x}", param->size,
+                      param->id);
+            return ORBIS_NGS2_ERROR_INVALID_VOICE_CONTROL_SIZE;
+        }
+        if (const s32 result = SetParam(*param); result < 0) {
+            return result;
+        }
+        if (param->next == 0) {
+            break;
+        }
+        param = reinterpret_cast<const OrbisNgs2VoiceParamHeader*>(
+            reinterpret_cast<const u8*>(param) + param->next);
+    }
+    return ORBIS_OK;
+}
+
+s32 Voice::SetParam(const OrbisNgs2VoiceParamHeader& param) {
+    switch (param.id) {
+    case ORBIS_NGS2_VOICE_PARAM_MATRIX_LEVELS: {
+        const auto& levels = reinterpret_cast<const OrbisNgs2VoiceMatrixLevelsParam&>(param);
+        if (levels.matrixId >= matrices.size()) {
+            return ORBIS_NGS2_ERROR_INVALID_MATRIX_INDEX;
+        }
+        if (levels.numLevels > ORBIS_NGS2_MAX_MATRIX_LEVELS) {
+            return ORBIS_NGS2_ERROR_INVALID_NUM_MATRIX_LEVELS;
+        }
+        if (levels.numLevels != 0 && !levels.aLevel) {
+            return ORBIS_NGS2_ERROR_INVALID_MATRIX_LEVEL_ADDRESS;
+        }
+        matrices[levels.matrixId].assign(levels.aLevel, levels.aLevel + levels.numLevels);
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_VOICE_PARAM_PORT_MATRIX: {
+        const auto& matrix = reinterpret_cast<const OrbisNgs2VoicePortMatrixParam&>(param);
+        if (matrix.port >= ports.size()) {
+            return ORBIS_NGS2_ERROR_INVALID_PORT_INDEX;
+        }
+        if (matrix.matrixId >= static_cast<s32>(matrices.size())) {
+            return ORBIS_NGS2_ERROR_INVALID_MATRIX_INDEX;
+        }
+        ports[matrix.port].matrix_id = matrix.matrixId;
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_VOICE_PARAM_PORT_VOLUME: {
+        const auto& volume = reinterpret_cast<const OrbisNgs2VoicePortVolumeParam&>(param);
+        if (volume.port >= ports.size()) {
+            return ORBIS_NGS2_ERROR_INVALID_PORT_INDEX;
+        }
+        ports[volume.port].volume = volume.level;
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_VOICE_PARAM_PORT_DELAY: {
+        const auto& delay = reinterpret_cast<const OrbisNgs2VoicePortDelayParam&>(param);
+        if (delay.port >= ports.size()) {
+            return ORBIS_NGS2_ERROR_INVALID_PORT_INDEX;
+        }
+        LOG_DEBUG(Lib_Ngs2, "(STUBBED) port {} delay of {} samples", delay.port, delay.numSamples);
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_VOICE_PARAM_PATCH: {
+        const auto& patch = reinterpret_cast<const OrbisNgs2VoicePatchParam&>(param);
+        if (patch.port >= ports.size()) {
+            return ORBIS_NGS2_ERROR_INVALID_PORT_INDEX;
+        }
+        if (!patch.destHandle) {
+            ports[patch.port].dest = nullptr;
+            return ORBIS_OK;
+        }
+        Voice* dest = GetHandleObject<Voice>(patch.destHandle, OrbisNgs2HandleType::Voice);
+        // Only voices of channel racks have inputs, and racks render in order of their type
+        if (!dest || &dest->rack.system != &rack.system || dest->rack.type == RackType::Sampler ||
+            dest->rack.type < rack.type) {
+            LOG_ERROR(Lib_Ngs2, "Invalid patch destination {:#x}", patch.destHandle);
+            return ORBIS_NGS2_ERROR_INVALID_PATCH;
+        }
+        ports[patch.port].dest = dest;
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_VOICE_PARAM_EVENT: {
+        const auto& event = reinterpret_cast<const OrbisNgs2VoiceEventParam&>(param);
+        if (event.eventId > ORBIS_NGS2_VOICE_EVENT_RESUME) {
+            return ORBIS_NGS2_ERROR_INVALID_EVENT_TYPE;
+        }
+        Event(event.eventId);
+        return ORBIS_OK;
+    }
+    case ORBIS_NGS2_VOICE_PARAM_CALLBACK: {
+        const auto& callback = reinterpret_cast<const OrbisNgs2VoiceCallbackParam&>(param);
+        callback_handler = callback.callbackHandler;
+        callback_data = callback.callbackData;
+        callback_flags = callback.flags;
+        return ORBIS_OK;
+    }
+    default:
+        LOG_DEBUG(Lib_Ngs2, "(STUBBED) voice param {:#x}", param.id);
+        return ORBIS_OK;
+    }
+}
+
+void Voice::Event(u32 event_id) {
+    switch (event_id) {
+    case ORBIS_NGS2_VOICE_EVENT_PLAY:
+        state_flags = (state_flags & ~(ORBIS_NGS2_VOICE_STATE_FLAG_STOPPED |
+                                       ORBIS_NGS2_VOICE_STATE_FLAG_PAUSED)) |
+                      ORBIS_NGS2_VOICE_STATE_FLAG_INUSE | ORBIS_NGS2_VOICE_STATE_FLAG_PLAYING;
+        break;
+    case ORBIS_NGS2_VOICE_EVENT_STOP:
+    case ORBIS_NGS2_VOICE_EVENT_STOP_IMM:
+        state_flags = (state_flags & ~ORBIS_NGS2_VOICE_STATE_FLAG_PLAYING) |
+                      ORBIS_NGS2_VOICE_STATE_FLAG_STOPPED;
+        break;
+    case ORBIS_NGS2_VOICE_EVENT_KILL:
+        state_flags = 0;
+        break;
+    case ORBIS_NGS2_VOICE_EVENT_PAUSE:
+        state_flags |= ORBIS_NGS2_VOICE_STATE_FLAG_PAUSED;
+        break;
+    case ORBIS_NGS2_VOICE_EVENT_RESUME:
+        state_flags &= ~ORBIS_NGS2_VOICE_STATE_FLAG_PAUSED;
+        break;
+    default:
+        break;
+    }
+}
+
+void Voice::RaiseCallback(u32 flag, uintptr_t user_data, const void* data, u32 data_size,
+                          u32 repeated_count) {
+    if (!callback_handler || !(callback_flags & flag)) {
+        return;
+    }
+    PendingCallback& pending = callbacks.emplace_back();
+    pending.handler = callback_handler;
+    pending.info = {
+        .callbackData = callback_data,
+        .voiceHandle = GetHandle(),
+        .flag = flag,
+    };
+    pending.info.param.waveformBlock = {
+        .userData = user_data,
+        .data = data,
+        .dataSize = data_size,
+        .repeatedCount = repeated_count,
+    };
+}
+
+void Voice::TakeCallbacks(std::vector<PendingCallback>& out) {
+    out.insert(out.end(), callbacks.begin(), callbacks.end());
+    callbacks.clear();
+}
+
+void Voice::MixToPorts(u32 num_samples) {
+    for (const VoicePort& port : ports) {
+        Voice* dest = port.dest;
+        if (!dest || port.volume == 0.0f) {
+            continue;
+        }
+        const u32 dest_channels = dest->num_channels;
+        const bool has_matrix = port.matrix_id >= 0 && !matrices[port.matrix_id].empty();
+        if (has_matrix) {
+            // One row of levels per input channel
+            const auto& levels = matrices[port.matrix_id];
+            for (u32 in = 0; in < num_channels; ++in) {
+                for (u32 out = 0; out < dest_channels; ++out) {
+                    const size_t level = in * dest_channels + out;
+                    if (level < levels.size() && levels[level] != 0.0f) {
+                        MixScaled(output[in].data(), dest->input[out].data(),
+                                  levels[level] * port.volume, num_samples);
+                    }
+                }
+            }
+        } else if (num_channels == 1) {
+            // Mono goes to the front pair
+            for (u32 out = 0; out < std::min(dest_channels, 2U); ++out) {
+                MixScaled(output[0].data(), dest->input[out].data(), port.volume, num_samples);
+            }
+        } else {
+            for (u32 ch = 0; ch < std::min(num_channels, dest_channels); ++ch) {
+                MixScaled(output[ch].data(), dest->input[ch].data(), port.volume, num_samples);
+            }
+        }
+        dest->has_input = true;
+    }
+}
+
+void Voice::UnpatchRack(const Rack& dest_rack) {
+    for (VoicePort& port : ports) {
+        if (port.dest && &port.dest->rack == &dest_rack) {
+            port.dest = nullptr;
+        }
+    }
+}
+
+s32 Voice::GetMatrixInfo(u32 matrix_id, OrbisNgs2VoiceMatrixInfo* out_info) const {
+    if (matrix_id >= matrices.size()) {
+        return ORBIS_NGS2_ERROR_INVALID_MATRIX_INDEX;
+    }
+    const auto& levels = matrices[matrix_id];
+    out_info->numLevels = static_cast<u32>(levels.size());
+    std::ranges::copy(levels, out_info->aLevel);
+    return ORBIS_OK;
+}
+
+s32 Voice::GetPortInfo(u32 port, OrbisNgs2VoicePortInfo* out_info) const {
+    if (port >= ports.size()) {
+        return ORBIS_NGS2_ERROR_INVALID_PORT_INDEX;
+    }
+    const VoicePort& info = ports[port];
+    *out_info = {
+        .matrixId = info.matrix_id,
+        .volume = info.volume,
+        .numDelaySamples = 0,
+        .destInputId = 0,
+        .destHandle = info.dest ? info.dest->GetHandle() : 0,
+    };
+    return ORBIS_OK;
+}
+
+s32 Voice::GetState(void* out_state, size_t state_size) const {
+    if (state_size < sizeof(OrbisNgs2VoiceState)) {
+        return ORBIS_NGS2_ERROR_INVALID_VOICE_STATE_SIZE;
+    }
+    static_cast<OrbisNgs2VoiceState*>(out_state)->stateFlags = state_flags;
+    return ORBIS_OK;
+}
+
+Rack::Rack(System& system_, u32 rack_id_, RackType type_, const OrbisNgs2RackOption& option)
+    : system{system_}, rack_id{rack_id_}, type{type_}, max_ports{std::max(option.maxPorts, 1U)},
+      max_matrices{std::max(option.maxMatrices, 1U)},
+      max_grain_samples{option.maxGrainSamples ? option.maxGrainSamples
+                                               : system_.max_grain_samples},
+      name{option.name, strnlen(option.name, ORBIS_NGS2_RACK_NAME_LENGTH)} {
+    RegisterHandle(GetHandle(), OrbisNgs2HandleType::Rack);
+    const auto create_voice = [&](u32 index) {
+        switch (type) {
+        case RackType::Sampler:
+            return CreateSamplerVoice(*this, index);
+        case RackType::Submixer:
+            return CreateSubmixerVoice(*this, index);
+        case RackType::Mastering:
+            return CreateMasteringVoice(*this, index);
+        }
+        return std::unique_ptr<Voice>{};
+    };
+    voices.reserve(option.maxVoices);
+    for (u32 index = 0; index < option.maxVoices; ++index) {
+        voices.push_back(create_voice(index));
+    }
+}
+
+Rack::~Rack() {
+    UnregisterHandle(GetHandle());
+}
+
+void Rack::Render(u32 num_samples, std::vector<PendingCallback>& callbacks) {
+    const size_t num_voices = voices.size();
+    const auto render_range = [this, num_samples](size_t begin, size_t end) {
+        for (size_t index = begin; index < end; ++index) {
+            voices[index]->Render(num_samples);
+        }
+    };
+    if (num_voices < ParallelVoices) {
+        render_range(0, num_voices);
+    } else {
+        // Split the voices over the workers and this thread, the voices only touch their own
+        // state while rendering.
+        auto& workers = RenderWorkers();
+        const size_t num_chunks = workers.NumWorkers() + 1;
+        const size_t chunk_size = (num_voices + num_chunks - 1) / num_chunks;
+        std::latch done{static_cast<std::ptrdiff_t>(num_chunks - 1)};
+        for (size_t chunk = 1; chunk < num_chunks; ++chunk) {
+            workers.QueueWork([&, chunk] {
+                render_range(std::min(chunk * chunk_size, num_voices),
+                             std::min((chunk + 1) * chunk_size, num_voices));
+                done.count_down();
+            });
+        }
+        render_range(0, std::min(chunk_size, num_voices));
+        done.wait();
+    }
+
+    // Mixing into the inputs of later racks stays in order, many voices share a destination
+    active_voices = 0;
+    for (const auto& voice : voices) {
+        if (voice->HasOutput()) {
+            voice->MixToPorts(num_samples);
+            ++active_voices;
+        }
+        voice->TakeCallbacks(callbacks);
+    }
+    ++render_count;
+}
+
+void Rack::GetInfo(OrbisNgs2RackInfo* out_info) const {
+    *out_info = {};
+    std::memcpy(out_info->name, name.data(), std::min<size_t>(name.size(), sizeof(out_info->name)));
+    out_info->rackHandle = GetHandle();
+    out_info->bufferInfo = buffer_info;
+    out_info->ownerSystemHandle = system.GetHandle();
+    out_info->type = static_cast<u32>(type);
+    out_info->rackId = rack_id;
+    out_info->minGrainSamples = 64;
+    out_info->maxGrainSamples = max_grain_samples;
+    out_info->maxVoices = static_cast<u32>(voices.size());
+    out_info->maxMatrices = max_matrices;
+    out_info->maxPorts = max_ports;
+    out_info->renderCount = render_count;
+    out_info->activeVoiceCount = active_voices;
+}
+
+System::System(u32 sample_rate_, u32 num_grain_samples_, u32 max_grain_samples_)
+    : sample_rate{sample_rate_}, num_grain_samples{num_grain_samples_},
+      max_grain_samples{max_grain_samples_} {
+    RegisterHandle(GetHandle(), OrbisNgs2HandleType::System);
+}
+
+System::~System() {
+    UnregisterHandle(GetHandle());
+}
+
+s32 System::CreateRack(u32 rack_id, const OrbisNgs2RackOption* option,
+                       OrbisNgs2Handle* out_handle) {
+    OrbisNgs2RackOption rack_option{
+        .size = sizeof(OrbisNgs2RackOption),
+        .maxGrainSamples = max_grain_samples,
+        .maxVoices = 1,
+        .maxMatrices = 1,
+        .maxPorts = 1,
+    };
+    if (option) {
+        if (option->size < sizeof(OrbisNgs2RackOption)) {
+            LOG_ERROR(Lib_Ngs2, "Invalid rack option size ({})", option->size);
+            return ORBIS_NGS2_ERROR_INVALID_OPTION_SIZE;
+        }
+        rack_option = *option;
+    }
+    const u32 kind = rack_id & 0xF000;
+    if (kind != ORBIS_NGS2_RACK_ID_VOICE && kind != ORBIS_NGS2_RACK_ID_CHANNEL) {
+        return ORBIS_NGS2_ERROR_INVALID_RACK_ID;
+    }
+    if (rack_option.maxVoices == 0) {
+        return ORBIS_NGS2_ERROR_INVALID_MAX_VOICES;
+    }
+    if (rack_option.maxGrainSamples > max_grain_samples) {
+        return ORBIS_NGS2_ERROR_INVALID_MAX_GRAIN_SAMPLES;
+    }
+    if (rack_option.maxMatrices > ORBIS_NGS2_MAX_VOICE_CHANNELS * 4) {
+        return ORBIS_NGS2_ERROR_INVALID_MAX_MATRICES;
+    }
+
+    std::scoped_lock lock{mutex};
+    const RackType type = GetRackType(rack_id);
+    auto rack = std::make_unique<Rack>(*this, rack_id, type, rack_option);
+    *out_handle = rack->GetHandle();
+    const auto it = std::ranges::find_if(racks, [type](const auto& r) { return r->type > type; });
+    racks.insert(it, std::move(rack));
+    return ORBIS_OK;
+}
+
+void System::DestroyRack(Rack* rack) {
+    std::scoped_lock lock{mutex};
+    for (const auto& other : racks) {
+        for (const auto& voice : other->Voices()) {
+            voice->UnpatchRack(*rack);
+        }
+    }
+    std::erase_if(racks, [rack](const auto& r) { return r.get() == rack; });
+}
+
+s32 System::Render(const OrbisNgs2RenderBufferInfo* buffer_infos, u32 num_buffer_infos) {
+    if (!buffer_infos || num_buffer_infos == 0) {
+        return ORBIS_NGS2_ERROR_INVALID_BUFFER_INFO;
+    }
+    size_t num_frames = ~size_t{0};
+    for (u32 i = 0; i < num_buffer_infos; ++i) {
+        const auto& info = buffer_infos[i];
+        if (!info.buffer) {
+            return ORBIS_NGS2_ERROR_INVALID_BUFFER_ADDRESS;
+        }
+        if (info.numChannels == 0 || info.numChannels > ORBIS_NGS2_MAX_VOICE_CHANNELS) {
+            return ORBIS_NGS2_ERROR_INVALID_NUM_CHANNELS;
+        }
+        const auto waveform_type = static_cast<OrbisNgs2WaveformType>(info.waveformType);
+        if (waveform_type != OrbisNgs2WaveformType::PcmI16L &&
+            waveform_type != OrbisNgs2WaveformType::PcmF32L) {
+            return ORBIS_NGS2_ERROR_INVALID_WAVEFORM_TYPE;
+        }
+        const size_t sample_size = waveform_type == OrbisNgs2WaveformType::PcmF32L ? 4 : 2;
+        num_frames = std::min(num_frames, info.bufferSize / (sample_size * info.numChannels));
+        std::memset(info.buffer, 0, info.bufferSize);
+    }
+
+    std::scoped_lock lock{mutex};
+    // Racks may have been created with smaller grain buffers than the system
+    u32 grain_samples = num_grain_samples;
+    for (const auto& rack : racks) {
+        grain_samples = std::min(grain_samples, rack->max_grain_samples);
+    }
+    std::vector<PendingCallback> callbacks;
+    for (size_t frame = 0; frame < num_frames; frame += grain_samples) {
+        const u32 num_samples =
+            static_cast<u32>(std::min<size_t>(grain_samples, num_frames - frame));
+        for (const auto& rack : racks) {
+            rack->Render(num_samples, callbacks);
+        }
+
+        for (u32 i = 0; i < num_buffer_infos; ++i) {
+            const auto& info = buffer_infos[i];
+            const u32 num_channels = info.numChannels;
+            mix.assign(size_t{num_samples} * num_channels, 0.0f);
+            for (const auto& rack : racks) {
+                if (rack->type != RackType::Mastering) {
+                    continue;
+                }
+                for (const auto& voice : rack->Voices()) {
+                    if (!voice->HasOutput() || voice->OutputId() != static_cast<s32>(i)) {
+                        continue;
+                    }
+                    const auto& samples = voice->Output();
+                    for (u32 ch = 0; ch < std::min(voice->NumChannels(), num_channels); ++ch) {
+                        for (u32 s = 0; s < num_samples; ++s) {
+                            mix[s * num_channels + ch] += samples[ch][s];
+                        }
+                    }
+                }
+            }
+            if (static_cast<OrbisNgs2WaveformType>(info.waveformType) ==
+                OrbisNgs2WaveformType::PcmF32L) {
+                std::memcpy(static_cast<float*>(info.buffer) + frame * num_channels, mix.data(),
+                            mix.size() * sizeof(float));
+            } else {
+                s16* out = static_cast<s16*>(info.buffer) + frame * num_channels;
+                for (size_t s = 0; s < mix.size(); ++s) {
+                    out[s] = static_cast<s16>(std::clamp(mix[s], -1.0f, 1.0f) * 32767.0f);
+                }
+            }
+        }
+
+        // The guest may queue more waveform blocks from the callbacks, before the next grain
+        for (PendingCallback& callback : callbacks) {
+            Core::ExecuteGuest(callback.handler, &callback.info);
+        }
+        callbacks.clear();
+    }
+    ++render_count;
+    return ORBIS_OK;
+}
+
+void System::GetInfo(OrbisNgs2SystemInfo* out_info) const {
+    *out_info = {};
+    out_info->systemHandle = GetHandle();
+    out_info->bufferInfo = buffer_info;
+    out_info->minGrainSamples = 64;
+    out_info->maxGrainSamples = max_grain_samples;
+    out_info->rackCount = static_cast<u32>(racks.size());
+    out_info->renderCount = static_cast<s64>(render_count);
+    out_info->sampleRate = sample_rate;
+    out_info->numGrainSamples = num_grain_samples;
+}
+
+} // namespace Libraries::Ngs2
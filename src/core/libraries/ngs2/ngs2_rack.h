@@ -0,0 +1,242 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "core/libraries/ngs2/ngs2.h"
+
+namespace Libraries::Ngs2 {
+
+class Rack;
+class System;
+
+enum class RackType : u32 {
+    Sampler,
+    Submixer,
+    Mastering,
+};
+
+/// Planar samples of a grain, one row per channel, so the kernels run over contiguous samples.
+using ChannelBuffers = std::array<std::vector<float>, ORBIS_NGS2_MAX_VOICE_CHANNELS>;
+
+/// Adds input scaled by gain to output.
+void MixScaled(const float* input, float* output, float gain, size_t num_samples);
+
+/// Multiplies samples by gain.
+void Scale(float* samples, float gain, size_t num_samples);
+
+class Voice;
+
+/// Output port of a voice, patched to the input of a voice of a later rack.
+struct VoicePort {
+    s32 matrix_id = -1;
+    float volume = 1.0f;
+    Voice* dest{};
+};
+
+/// Callback of the guest for a voice, invoked from the rendering thread after the grain.
+struct PendingCallback {
+    OrbisNgs2VoiceCallbackHandler handler;
+    OrbisNgs2VoiceCallbackInfo info;
+};
+
+class Voice {
+public:
+    explicit Voice(Rack& rack, u32 index);
+    virtual ~Voice();
+
+    Voice(const Voice&) = delete;
+    Voice& operator=(const Voice&) = delete;
+
+    /// Applies a chain of voice params linked by their next offsets.
+    s32 Control(const OrbisNgs2VoiceParamHeader* param_list);
+
+    /// Renders the next grain of the voice into output. Voices of the same rack may render in
+    /// parallel, so this only touches the voice itself.
+    virtual void Render(u32 num_samples) = 0;
+
+    [[nodiscard]] u32 GetStateFlags() const {
+        return state_flags;
+    }
+
+    [[nodiscard]] OrbisNgs2Handle GetHandle() const {
+        return reinterpret_cast<OrbisNgs2Handle>(this);
+    }
+
+    [[nodiscard]] u32 NumChannels() const {
+        return num_channels;
+    }
+
+    /// Returns true if output holds the grain rendered last.
+    [[nodiscard]] bool HasOutput() const {
+        return has_output;
+    }
+
+    [[nodiscard]] const ChannelBuffers& Output() const {
+        return output;
+    }
+
+    /// Index of the render buffer a mastering voice writes to, or -1 for other voices.
+    [[nodiscard]] virtual s32 OutputId() const {
+        return -1;
+    }
+
+    /// Adds the output of the grain to the inputs of the voices it is patched to.
+    void MixToPorts(u32 num_samples);
+
+    /// Removes the patches to the voices of a rack that goes away.
+    void UnpatchRack(const Rack& dest_rack);
+
+    /// Flushes the callbacks the last grain raised.
+    void TakeCallbacks(std::vector<PendingCallback>& out);
+
+    s32 GetMatrixInfo(u32 matrix_id, OrbisNgs2VoiceMatrixInfo* out_info) const;
+    s32 GetPortInfo(u32 port, OrbisNgs2VoicePortInfo* out_info) const;
+
+    /// Fills the state of the kind of the voice, at least OrbisNgs2VoiceState.
+    virtual s32 GetState(void* out_state, size_t state_size) const;
+
+    Rack& rack;
+    const u32 index;
+
+protected:
+    /// Handles a param of the kind of the voice, the base implementation handles the params
+    /// shared by every rack and ignores unknown ones.
+    virtual s32 SetParam(const OrbisNgs2VoiceParamHeader& param);
+
+    /// Handles an event, the base implementation only tracks the state flags.
+    virtual void Event(u32 event_id);
+
+    void RaiseCallback(u32 flag, uintptr_t user_data, const void* data, u32 data_size,
+                       u32 repeated_count);
+
+    /// Allocates the grain buffers of the channels of the voice.
+    void SetupChannels(u32 num_channels);
+
+    void ClearInput() {
+        for (u32 ch = 0; ch < num_channels; ++ch) {
+            std::fill(input[ch].begin(), input[ch].end(), 0.0f);
+        }
+        has_input = false;
+    }
+
+    u32 state_flags{};
+    u32 num_channels{};
+    bool has_output{};
+    bool has_input{};
+    ChannelBuffers input; ///< Sum of the ports patched to the voice
+    ChannelBuffers output;
+
+private:
+    std::vector<VoicePort> ports;
+    std::vector<std::vector<float>> matrices;
+    OrbisNgs2VoiceCallbackHandler callback_handler{};
+    uintptr_t callback_data{};
+    u32 callback_flags{};
+    std::vector<PendingCallback> callbacks;
+};
+
+class Rack {
+public:
+    explicit Rack(System& system, u32 rack_id, RackType type, const OrbisNgs2RackOption& option);
+    ~Rack();
+
+    Rack(const Rack&) = delete;
+    Rack& operator=(const Rack&) = delete;
+
+    /// Renders every voice of the rack and patches their outputs to the following racks.
+    void Render(u32 num_samples, std::vector<PendingCallback>& callbacks);
+
+    void GetInfo(OrbisNgs2RackInfo* out_info) const;
+
+    [[nodiscard]] OrbisNgs2Handle GetHandle() const {
+        return reinterpret_cast<OrbisNgs2Handle>(this);
+    }
+
+    [[nodiscard]] Voice* GetVoice(u32 voice_index) const {
+        return voice_index < voices.size() ? voices[voice_index].get() : nullptr;
+    }
+
+    [[nodiscard]] const std::vector<std::unique_ptr<Voice>>& Voices() const {
+        return voices;
+    }
+
+    System& system;
+    const u32 rack_id;
+    const RackType type;
+    const u32 max_ports;
+    const u32 max_matrices;
+    const u32 max_grain_samples;
+    uintptr_t user_data{};
+    OrbisNgs2ContextBufferInfo buffer_info{}; ///< Memory of the guest, the rack lives on the host
+    OrbisNgs2BufferFreeHandler host_free{};
+
+private:
+    std::string name;
+    std::vector<std::unique_ptr<Voice>> voices;
+    u64 render_count{};
+    u32 active_voices{};
+};
+
+class System {
+public:
+    explicit System(u32 sample_rate, u32 num_grain_samples, u32 max_grain_samples);
+    ~System();
+
+    System(const System&) = delete;
+    System& operator=(const System&) = delete;
+
+    s32 CreateRack(u32 rack_id, const OrbisNgs2RackOption* option, OrbisNgs2Handle* out_handle);
+    void DestroyRack(Rack* rack);
+
+    /// Renders grains until the buffers are full and writes the output of the mastering voices
+    /// to the buffer of their output id.
+    s32 Render(const OrbisNgs2RenderBufferInfo* buffer_infos, u32 num_buffer_infos);
+
+    void GetInfo(OrbisNgs2SystemInfo* out_info) const;
+
+    [[nodiscard]] OrbisNgs2Handle GetHandle() const {
+        return reinterpret_cast<OrbisNgs2Handle>(this);
+    }
+
+    [[nodiscard]] const std::vector<std::unique_ptr<Rack>>& Racks() const {
+        return racks;
+    }
+
+    /// Held while rendering and by the guest through sceNgs2SystemLock and sceNgs2RackLock.
+    std::recursive_mutex mutex;
+    u32 sample_rate;
+    u32 num_grain_samples;
+    const u32 max_grain_samples;
+    uintptr_t user_data{};
+    OrbisNgs2ContextBufferInfo buffer_info{};
+    OrbisNgs2BufferFreeHandler host_free{};
+
+private:
+    std::vector<std::unique_ptr<Rack>> racks; ///< Sampler, submixer, then mastering racks
+    u64 render_count{};
+    std::vector<float> mix; ///< Interleaved grain of a render buffer
+};
+
+/// Handles are pointers to the objects, registered while they exist so stale or garbage handles
+/// from the guest are rejected.
+void RegisterHandle(OrbisNgs2Handle handle, OrbisNgs2HandleType type);
+void UnregisterHandle(OrbisNgs2Handle handle);
+[[nodiscard]] bool IsValidHandle(OrbisNgs2Handle handle, OrbisNgs2HandleType type);
+
+template <typename T>
+T* GetHandleObject(OrbisNgs2Handle handle, OrbisNgs2HandleType type) {
+    return IsValidHandle(handle, type) ? reinterpret_cast<T*>(handle) : nullptr;
+}
+
+std::unique_ptr<Voice> CreateSamplerVoice(Rack& rack, u32 index);
+std::unique_ptr<Voice> CreateSubmixerVoice(Rack& rack, u32 index);
+std::unique_ptr<Voice> CreateMasteringVoice(Rack& rack, u32 index);
+
+} // namespace Libraries::Ngs2
@@ -1,12 +1,291 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <bit>
+#include <cstring>
+
+#include "ngs2_eq.h"
 #include "ngs2_error.h"
 #include "ngs2_impl.h"
+#include "ngs2_rack.h"
+#include "ngs2_sampler.h"
 
 #include "common/logging/log.h"
 #include "core/libraries/error_codes.h"
 
 using namespace Libraries::Kernel;
 
-namespace Libraries::Ngs2 {} // namespace Libraries::Ngs2
+namespace Libraries::Ngs2 {
+
+namespace {
+
+template <OrbisNgs2WaveformType Type>
+float FetchSample(const u8* data, size_t index) {
+    if constexpr (Type == OrbisNgs2WaveformType::PcmI16L ||
+                  Type == OrbisNgs2WaveformType::PcmI16B) {
+        u16 raw;
+        std::memcpy(&raw, data + index * sizeof(raw), sizeof(raw));
+        if constexpr (Type == OrbisNgs2WaveformType::PcmI16B) {
+            raw = std::byteswap(raw);
+        }
+        return static_cast<float>(static_cast<s16>(raw)) * (1.0f / 32768.0f);
+    } else {
+        u32 raw;
+        std::memcpy(&raw, data + index * sizeof(raw), sizeof(raw));
+        if constexpr (Type == OrbisNgs2WaveformType::PcmF32B) {
+            raw = std::byteswap(raw);
+        }
+        return std::bit_cast<float>(raw);
+    }
+}
+
+u32 GetSampleSize(OrbisNgs2WaveformType type) {
+    switch (type) {
+    case OrbisNgs2WaveformType::PcmI16L:
+    case OrbisNgs2WaveformType::PcmI16B:
+        return 2;
+    case OrbisNgs2WaveformType::PcmF32L:
+    case OrbisNgs2WaveformType::PcmF32B:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+class SamplerVoice final : public Voice {
+public:
+    explicit SamplerVoice(Rack& rack, u32 index)
+        : Voice{rack, index}, filters(ORBIS_NGS2_SAMPLER_MAX_FILTERS) {}
+
+    void Render(u32 num_samples) override {
+        has_output = false;
+        if ((state_flags & (ORBIS_NGS2_VOICE_STATE_FLAG_PLAYING |
+                            ORBIS_NGS2_VOICE_STATE_FLAG_PAUSED)) !=
+                ORBIS_NGS2_VOICE_STATE_FLAG_PLAYING ||
+            !data) {
+            return;
+        }
+        switch (static_cast<OrbisNgs2WaveformType>(format.waveformType)) {
+        case OrbisNgs2WaveformType::PcmI16L:
+            Resample<OrbisNgs2WaveformType::PcmI16L>(num_samples);
+            break;
+        case OrbisNgs2WaveformType::PcmI16B:
+            Resample<OrbisNgs2WaveformType::PcmI16B>(num_samples);
+            break;
+        case OrbisNgs2WaveformType::PcmF32L:
+            Resample<OrbisNgs2WaveformType::PcmF32L>(num_samples);
+            break;
+        case OrbisNgs2WaveformType::PcmF32B:
+            Resample<OrbisNgs2WaveformType::PcmF32B>(num_samples);
+            break;
+        default:
+            return;
+        }
+        for (Biquad& filter : filters) {
+            filter.Process(output, num_channels, num_samples);
+        }
+        has_output = true;
+    }
+
+    s32 GetState(void* out_state, size_t state_size) const override {
+        if (state_size < sizeof(OrbisNgs2SamplerVoiceState)) {
+            return Voice::GetState(out_state, state_size);
+        }
+        auto* state = static_cast<OrbisNgs2SamplerVoiceState*>(out_state);
+        *state = {
+            .voiceState = {.stateFlags = state_flags},
+            .envelopeHeight = 1.0f,
+            .numDecodedSamples = num_decoded_samples,
+            .decodedDataSize = num_decoded_samples * frame_size,
+            .waveformData = data,
+        };
+        if (block_index < blocks.size()) {
+            state->userData = blocks[block_index].userData;
+        }
+        return ORBIS_OK;
+    }
+
+protected:
+    s32 SetParam(const OrbisNgs2VoiceParamHeader& param) override {
+        switch (param.id) {
+        case ORBIS_NGS2_SAMPLER_VOICE_PARAM_SETUP:
+            return Setup(reinterpret_cast<const OrbisNgs2SamplerVoiceSetupParam&>(param));
+        case ORBIS_NGS2_SAMPLER_VOICE_PARAM_WAVEFORM_BLOCKS:
+            return SetBlocks(
+                reinterpret_cast<const OrbisNgs2SamplerVoiceWaveformBlocksParam&>(param));
+        case ORBIS_NGS2_SAMPLER_VOICE_PARAM_WAVEFORM_ADDRESS: {
+            const auto& address =
+                reinterpret_cast<const OrbisNgs2SamplerVoiceWaveformAddressParam&>(param);
+            if (data == address.from) {
+                data = static_cast<const u8*>(address.to);
+            }
+            return ORBIS_OK;
+        }
+        case ORBIS_NGS2_SAMPLER_VOICE_PARAM_EXIT_LOOP:
+            // Finish the repeats of the current block
+            if (block_index < blocks.size()) {
+                repeats_done = blocks[block_index].numRepeats;
+            }
+            return ORBIS_OK;
+        case ORBIS_NGS2_SAMPLER_VOICE_PARAM_PITCH:
+            pitch = reinterpret_cast<const OrbisNgs2SamplerVoicePitchParam&>(param).ratio;
+            return ORBIS_OK;
+        case ORBIS_NGS2_SAMPLER_VOICE_PARAM_FILTER:
+            return SetFilterParam(
+                filters, reinterpret_cast<const OrbisNgs2SamplerVoiceFilterParam&>(param),
+                rack.system.sample_rate);
+        case ORBIS_NGS2_SAMPLER_VOICE_PARAM_NUM_FILTERS: {
+            const u32 count =
+                reinterpret_cast<const OrbisNgs2SamplerVoiceNumFilters&>(param).numFilters;
+            if (count > ORBIS_NGS2_SAMPLER_MAX_FILTERS) {
+                return ORBIS_NGS2_ERROR_INVALID_MAX_FILTERS;
+            }
+            for (u32 i = count; i < filters.size(); ++i) {
+                filters[i].Disable();
+            }
+            return ORBIS_OK;
+        }
+        default:
+            return Voice::SetParam(param);
+        }
+    }
+
+    void Event(u32 event_id) override {
+        Voice::Event(event_id);
+        if (event_id == ORBIS_NGS2_VOICE_EVENT_PLAY) {
+            Rewind();
+        }
+    }
+
+private:
+    s32 Setup(const OrbisNgs2SamplerVoiceSetupParam& setup) {
+        const auto type = static_cast<OrbisNgs2WaveformType>(setup.format.waveformType);
+        if (setup.format.numChannels == 0 ||
+            setup.format.numChannels > ORBIS_NGS2_MAX_VOICE_CHANNELS) {
+            return ORBIS_NGS2_ERROR_INVALID_NUM_CHANNELS;
+        }
+        if (setup.format.sampleRate == 0) {
+            return ORBIS_NGS2_ERROR_INVALID_WAVEFORM_SAMPLE_RATE;
+        }
+        format = setup.format;
+        frame_size = GetSampleSize(type) * format.numChannels;
+        SetupChannels(format.numChannels);
+        state_flags = ORBIS_NGS2_VOICE_STATE_FLAG_INUSE | ORBIS_NGS2_VOICE_STATE_FLAG_EMPTY;
+        if (frame_size == 0) {
+            // Compressed waveforms need a decoder, the voice stays silent
+            LOG_WARNING(Lib_Ngs2, "Unsupported sampler waveform type {:#x}",
+                        setup.format.waveformType);
+            state_flags |= ORBIS_NGS2_VOICE_STATE_FLAG_ERROR;
+        }
+        data = nullptr;
+        blocks.clear();
+        Rewind();
+        return ORBIS_OK;
+    }
+
+    s32 SetBlocks(const OrbisNgs2SamplerVoiceWaveformBlocksParam& param) {
+        if (param.numBlocks != 0 && !param.aBlock) {
+            return ORBIS_NGS2_ERROR_INVALID_WAVEFORM_BLOCK_ADDRESS;
+        }
+        data = static_cast<const u8*>(param.data);
+        blocks.assign(param.aBlock, param.aBlock + param.numBlocks);
+        if (frame_size != 0) {
+            for (OrbisNgs2WaveformBlock& block : blocks) {
+                if (block.numSamples == 0) {
+                    block.numSamples = block.dataSize / frame_size;
+                }
+            }
+        }
+        if (data && !blocks.empty()) {
+            state_flags &= ~ORBIS_NGS2_VOICE_STATE_FLAG_EMPTY;
+        }
+        Rewind();
+        return ORBIS_OK;
+    }
+
+    void Rewind() {
+        block_index = 0;
+        repeats_done = 0;
+        position = blocks.empty() ? 0.0 : blocks[0].numSkipSamples;
+        num_decoded_samples = 0;
+    }
+
+    /// Moves past the end of the current block. Returns false once the last one finished.
+    bool NextBlock() {
+        const OrbisNgs2WaveformBlock& block = blocks[block_index];
+        position -= block.numSamples;
+        if (repeats_done < block.numRepeats && block.numSamples != 0) {
+            ++repeats_done;
+            position += block.numSkipSamples;
+            return true;
+        }
+        RaiseCallback(ORBIS_NGS2_VOICE_CALLBACK_FLAG_WAVEFORM_BLOCK_END, block.userData,
+                      data + block.dataOffset, block.dataSize, repeats_done);
+        repeats_done = 0;
+        if (++block_index == blocks.size()) {
+            return false;
+        }
+        position += blocks[block_index].numSkipSamples;
+        return true;
+    }
+
+    /// Linear interpolation of the waveform at the rate of the system, scaled by the pitch.
+    template <OrbisNgs2WaveformType Type>
+    void Resample(u32 num_samples) {
+        const double step =
+            static_cast<double>(pitch) * format.sampleRate / rack.system.sample_rate;
+        const u32 channels = num_channels;
+        u32 s = 0;
+        while (s < num_samples) {
+            while (block_index < blocks.size() && position >= blocks[block_index].numSamples) {
+                if (!NextBlock()) {
+                    break;
+                }
+            }
+            if (block_index >= blocks.size()) {
+                // Out of waveform
+                state_flags = (state_flags & ~ORBIS_NGS2_VOICE_STATE_FLAG_PLAYING) |
+                              ORBIS_NGS2_VOICE_STATE_FLAG_STOPPED |
+                              ORBIS_NGS2_VOICE_STATE_FLAG_EMPTY;
+                for (u32 ch = 0; ch < channels; ++ch) {
+                    std::fill(output[ch].begin() + s, output[ch].begin() + num_samples, 0.0f);
+                }
+                return;
+            }
+            const OrbisNgs2WaveformBlock& block = blocks[block_index];
+            const u8* block_data = data + block.dataOffset;
+            const size_t last = block.numSamples - 1;
+            // Render up to the end of the block before checking for the next one
+            for (; s < num_samples && position < block.numSamples; ++s, position += step) {
+                const size_t i0 = static_cast<size_t>(position);
+                const size_t i1 = std::min(i0 + 1, last);
+                const float frac = static_cast<float>(position - static_cast<double>(i0));
+                for (u32 ch = 0; ch < channels; ++ch) {
+                    const float a = FetchSample<Type>(block_data, i0 * channels + ch);
+                    const float b = FetchSample<Type>(block_data, i1 * channels + ch);
+                    output[ch][s] = a + (b - a) * frac;
+                }
+                ++num_decoded_samples;
+            }
+        }
+    }
+
+    OrbisNgs2WaveformFormat format{};
+    u32 frame_size{};
+    const u8* data{};
+    std::vector<OrbisNgs2WaveformBlock> blocks;
+    size_t block_index{};
+    u32 repeats_done{};
+    double position{}; ///< In samples of the waveform, from the start of the current block
+    float pitch{1.0f};
+    u64 num_decoded_samples{};
+    std::vector<Biquad> filters;
+};
+
+} // Anonymous namespace
+
+std::unique_ptr<Voice> CreateSamplerVoice(Rack& rack, u32 index) {
+    return std::make_unique<SamplerVoice>(rack, index);
+}
+
+} // namespace Libraries::Ngs2
@@ -9,6 +9,21 @@ namespace Libraries::Ngs2 {
 
 class Ngs2Sampler;
 
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_SETUP = 0x10000001;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_WAVEFORM_BLOCKS = 0x10000002;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_WAVEFORM_ADDRESS = 0x10000003;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_WAVEFORM_FRAME_OFFSET = 0x10000004;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_EXIT_LOOP = 0x10000005;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_PITCH = 0x10000006;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_ENVELOPE = 0x10000007;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_DISTORTION = 0x10000008;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_USER_FX = 0x10000009;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_PEAK_METER = 0x1000000A;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_FILTER = 0x1000000B;
+static const u32 ORBIS_NGS2_SAMPLER_VOICE_PARAM_NUM_FILTERS = 0x1000000C;
+
+static const u32 ORBIS_NGS2_SAMPLER_MAX_FILTERS = 4;
+
 struct OrbisNgs2SamplerRackOption {
     OrbisNgs2RackOption rackOption;
     u32 maxChannelWorks;
@@ -1,12 +1,89 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "ngs2_eq.h"
 #include "ngs2_error.h"
 #include "ngs2_impl.h"
+#include "ngs2_rack.h"
+#include "ngs2_submixer.h"
 
 #include "common/logging/log.h"
 #include "core/libraries/error_codes.h"
 
 using namespace Libraries::Kernel;
 
-namespace Libraries::Ngs2 {} // namespace Libraries::Ngs2
+namespace Libraries::Ngs2 {
+
+namespace {
+
+/// Sums the voices patched to it and filters the sum. Reverb and EQ racks use it as well, they
+/// pass their input through unprocessed.
+class SubmixerVoice final : public Voice {
+public:
+    explicit SubmixerVoice(Rack& rack, u32 index)
+        : Voice{rack, index}, filters(ORBIS_NGS2_SUBMIXER_MAX_FILTERS) {}
+
+    void Render(u32 num_samples) override {
+        has_output = false;
+        if (!has_input) {
+            return;
+        }
+        if ((state_flags & (ORBIS_NGS2_VOICE_STATE_FLAG_INUSE |
+                            ORBIS_NGS2_VOICE_STATE_FLAG_PAUSED)) ==
+            ORBIS_NGS2_VOICE_STATE_FLAG_INUSE) {
+            // The input becomes the output and the old output the next input
+            for (u32 ch = 0; ch < num_channels; ++ch) {
+                std::swap(input[ch], output[ch]);
+            }
+            for (Biquad& filter : filters) {
+                filter.Process(output, num_channels, num_samples);
+            }
+            has_output = true;
+        }
+        ClearInput();
+    }
+
+protected:
+    s32 SetParam(const OrbisNgs2VoiceParamHeader& param) override {
+        switch (param.id) {
+        case ORBIS_NGS2_SUBMIXER_VOICE_PARAM_SETUP: {
+            const auto& setup = reinterpret_cast<const OrbisNgs2SubmixerVoiceSetupParam&>(param);
+            if (setup.numIoChannels == 0 ||
+                setup.numIoChannels > ORBIS_NGS2_MAX_VOICE_CHANNELS) {
+                return ORBIS_NGS2_ERROR_INVALID_NUM_CHANNELS;
+            }
+            SetupChannels(setup.numIoChannels);
+            state_flags = ORBIS_NGS2_VOICE_STATE_FLAG_INUSE;
+            return ORBIS_OK;
+        }
+        case ORBIS_NGS2_SUBMIXER_VOICE_PARAM_FILTER:
+            return SetFilterParam(
+                filters, reinterpret_cast<const OrbisNgs2SubmixerVoiceFilterParam&>(param),
+                rack.system.sample_rate);
+        case ORBIS_NGS2_SUBMIXER_VOICE_PARAM_NUM_FILTERS: {
+            const u32 count =
+                reinterpret_cast<const OrbisNgs2SubmixerVoiceNumFilters&>(param).numFilters;
+            if (count > ORBIS_NGS2_SUBMIXER_MAX_FILTERS) {
+                return ORBIS_NGS2_ERROR_INVALID_MAX_FILTERS;
+            }
+            for (u32 i = count; i < filters.size(); ++i) {
+                filters[i].Disable();
+            }
+            return ORBIS_OK;
+        }
+        default:
+            return Voice::SetParam(param);
+        }
+    }
+
+private:
+    std::vector<Biquad> filters;
+};
+
+} // Anonymous namespace
+
+std::unique_ptr<Voice> CreateSubmixerVoice(Rack& rack, u32 index) {
+    return std::make_unique<SubmixerVoice>(rack, index);
+}
+
+} // namespace Libraries::Ngs2
@@ -9,6 +9,17 @@ namespace Libraries::Ngs2 {
 
 class Ngs2Submixer;
 
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_SETUP = 0x20000001;
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_ENVELOPE = 0x20000002;
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_COMPRESSOR = 0x20000003;
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_DISTORTION = 0x20000004;
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_USER_FX = 0x20000005;
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_PEAK_METER = 0x20000006;
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_FILTER = 0x20000007;
+static const u32 ORBIS_NGS2_SUBMIXER_VOICE_PARAM_NUM_FILTERS = 0x20000008;
+
+static const u32 ORBIS_NGS2_SUBMIXER_MAX_FILTERS = 4;
+
 struct OrbisNgs2SubmixerRackOption {
     OrbisNgs2RackOption rackOption;
     u32 maxChannels;
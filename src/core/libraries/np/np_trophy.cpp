@@ -1,12 +1,20 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include <unordered_map>
 #include <pugixml.hpp>
 
+#include "common/io_file.h"
 #include "common/logging/log.h"
 #include "common/path_util.h"
 #include "common/slot_vector.h"
+#include "common/thread.h"
+#include "core/file_format/trp.h"
 #include "core/libraries/libs.h"
 #include "core/libraries/np/np_error.h"
 #include "core/libraries/np/np_trophy.h"
@@ -18,6 +26,90 @@ namespace Libraries::Np::NpTrophy {
 
 std::string game_serial;
 
+// Files of the packs are only extracted when the game or the trophy UI needs them
+static TRP trophy_packs;
+
+bool OpenTrophyPacks(const std::filesystem::path& game_folder) {
+    return trophy_packs.Open(game_folder, game_serial);
+}
+
+static std::filesystem::path GetTrophyFile(std::string_view trophy_folder, std::string_view dir,
+                                           std::string_view name) {
+    trophy_packs.ExtractFile(trophy_folder, dir, name);
+    return Common::FS::GetUserPath(Common::FS::PathType::MetaDataDir) / game_serial /
+           "TrophyFiles" / trophy_folder / dir / name;
+}
+
+// Trophy files are written in the background, unlocks only serialize the document. Writes that
+// pile up for a file are merged, the latest one is written.
+static std::mutex g_write_mtx;
+static std::condition_variable_any g_write_cv;
+static std::map<std::filesystem::path, std::string> g_pending_writes;
+static std::filesystem::path g_writing_file;
+static std::string g_writing_data;
+static std::jthread g_write_thread;
+
+static void WriteThreadBody(std::stop_token stop) {
+    Common::SetCurrentThreadName("shadPS4:NpTrophy:WriteThread");
+    while (true) {
+        {
+            std::unique_lock lock{g_write_mtx};
+            g_write_cv.wait(lock, stop, [] { return !g_pending_writes.empty(); });
+            if (g_pending_writes.empty()) {
+                break;
+            }
+            auto node = g_pending_writes.extract(g_pending_writes.begin());
+            g_writing_file = std::move(node.key());
+            g_writing_data = std::move(node.mapped());
+        }
+        Common::FS::IOFile file{g_writing_file, Common::FS::FileAccessMode::Write};
+        if (!file.IsOpen() || file.WriteString(g_writing_data) != g_writing_data.size()) {
+            LOG_ERROR(Lib_NpTrophy, "Failed to write trophy file {}",
+                      fmt::UTF(g_writing_file.u8string()));
+        }
+        file.Close();
+        std::scoped_lock lock{g_write_mtx};
+        g_writing_file.clear();
+        g_writing_data.clear();
+    }
+}
+
+static void StopWriteThread() {
+    if (!g_write_thread.joinable()) {
+        return;
+    }
+    g_write_thread.request_stop();
+    g_write_thread.join();
+}
+
+static void QueueTrophyFileWrite(const pugi::xml_document& doc, const std::filesystem::path& path) {
+    std::ostringstream out;
+    doc.save(out);
+    std::scoped_lock lock{g_write_mtx};
+    g_pending_writes[path] = std::move(out).str();
+    if (!g_write_thread.joinable()) {
+        g_write_thread = std::jthread{WriteThreadBody};
+        static std::once_flag flag;
+        std::call_once(flag, [] { std::at_quick_exit(StopWriteThread); });
+    }
+    g_write_cv.notify_one();
+}
+
+// Loads a trophy file, with the contents of a write still in flight if there is one
+static pugi::xml_parse_result LoadTrophyFile(pugi::xml_document& doc,
+                                             const std::filesystem::path& path) {
+    {
+        std::scoped_lock lock{g_write_mtx};
+        if (const auto it = g_pending_writes.find(path); it != g_pending_writes.end()) {
+            return doc.load_buffer(it->second.data(), it->second.size());
+        }
+        if (g_writing_file == path) {
+            return doc.load_buffer(g_writing_data.data(), g_writing_data.size());
+        }
+    }
+    return doc.load_file(path.native().c_str());
+}
+
 static constexpr auto MaxTrophyHandles = 4u;
 static constexpr auto MaxTrophyContexts = 8u;
 
@@ -231,15 +323,6 @@ s32 PS4_SYSV_ABI sceNpTrophyDestroyHandle(OrbisNpTrophyHandle handle) {
     return ORBIS_OK;
 }
 
-u64 ReadFile(Common::FS::IOFile& file, void* buf, u64 nbytes) {
-    const auto* memory = Core::Memory::Instance();
-    // Invalidate up to the actual number of bytes that could be read.
-    const auto remaining = file.GetSize() - file.Tell();
-    memory->InvalidateMemory(reinterpret_cast<VAddr>(buf), std::min<u64>(nbytes, remaining));
-
-    return file.ReadRaw<u8>(buf, nbytes);
-}
-
 int PS4_SYSV_ABI sceNpTrophyGetGameIcon(OrbisNpTrophyContext context, OrbisNpTrophyHandle handle,
                                         void* buffer, u64* size) {
     ASSERT(size != nullptr);
@@ -253,21 +336,18 @@ int PS4_SYSV_ABI sceNpTrophyGetGameIcon(OrbisNpTrophyContext context, OrbisNpTro
     char trophy_folder[9];
     snprintf(trophy_folder, sizeof(trophy_folder), "trophy%02d", contextkey.second);
 
-    const auto trophy_dir =
-        Common::FS::GetUserPath(Common::FS::PathType::MetaDataDir) / game_serial / "TrophyFiles";
-    auto icon_file = trophy_dir / trophy_folder / "Icons" / "ICON0.PNG";
-
-    Common::FS::IOFile icon(icon_file, Common::FS::FileAccessMode::Read);
-    if (!icon.IsOpen()) {
-        LOG_ERROR(Lib_NpTrophy, "Failed to open trophy icon file: {}", icon_file.string());
+    const auto icon = trophy_packs.GetIcon(trophy_folder, "ICON0.PNG");
+    if (icon.empty()) {
+        LOG_ERROR(Lib_NpTrophy, "Failed to load trophy icon of {}", trophy_folder);
         return ORBIS_NP_TROPHY_ERROR_ICON_FILE_NOT_FOUND;
     }
-    u64 icon_size = icon.GetSize();
 
     if (buffer != nullptr) {
-        ReadFile(icon, buffer, *size);
+        const u64 copy_size = std::min<u64>(*size, icon.size());
+        Core::Memory::Instance()->InvalidateMemory(reinterpret_cast<VAddr>(buffer), copy_size);
+        std::memcpy(buffer, icon.data(), copy_size);
     } else {
-        *size = icon_size;
+        *size = icon.size();
     }
     return ORBIS_OK;
 }
@@ -306,12 +386,10 @@ int PS4_SYSV_ABI sceNpTrophyGetGameInfo(OrbisNpTrophyContext context, OrbisNpTro
     char trophy_folder[9];
     snprintf(trophy_folder, sizeof(trophy_folder), "trophy%02d", contextkey.second);
 
-    const auto trophy_dir =
-        Common::FS::GetUserPath(Common::FS::PathType::MetaDataDir) / game_serial / "TrophyFiles";
-    auto trophy_file = trophy_dir / trophy_folder / "Xml" / "TROP.XML";
+    auto trophy_file = GetTrophyFile(trophy_folder, "Xml", "TROP.XML");
 
     pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_file(trophy_file.native().c_str());
+    pugi::xml_parse_result result = LoadTrophyFile(doc, trophy_file);
 
     if (!result) {
         LOG_ERROR(Lib_NpTrophy, "Failed to parse trophy xml : {}", result.description());
@@ -413,12 +491,10 @@ int PS4_SYSV_ABI sceNpTrophyGetGroupInfo(OrbisNpTrophyContext context, OrbisNpTr
     char trophy_folder[9];
     snprintf(trophy_folder, sizeof(trophy_folder), "trophy%02d", contextkey.second);
 
-    const auto trophy_dir =
-        Common::FS::GetUserPath(Common::FS::PathType::MetaDataDir) / game_serial / "TrophyFiles";
-    auto trophy_file = trophy_dir / trophy_folder / "Xml" / "TROP.XML";
+    auto trophy_file = GetTrophyFile(trophy_folder, "Xml", "TROP.XML");
 
     pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_file(trophy_file.native().c_str());
+    pugi::xml_parse_result result = LoadTrophyFile(doc, trophy_file);
 
     if (!result) {
         LOG_ERROR(Lib_NpTrophy, "Failed to open trophy xml : {}", result.description());
@@ -524,12 +600,10 @@ int PS4_SYSV_ABI sceNpTrophyGetTrophyInfo(OrbisNpTrophyContext context, OrbisNpT
     char trophy_folder[9];
     snprintf(trophy_folder, sizeof(trophy_folder), "trophy%02d", contextkey.second);
 
-    const auto trophy_dir =
-        Common::FS::GetUserPath(Common::FS::PathType::MetaDataDir) / game_serial / "TrophyFiles";
-    auto trophy_file = trophy_dir / trophy_folder / "Xml" / "TROP.XML";
+    auto trophy_file = GetTrophyFile(trophy_folder, "Xml", "TROP.XML");
 
     pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_file(trophy_file.native().c_str());
+    pugi::xml_parse_result result = LoadTrophyFile(doc, trophy_file);
 
     if (!result) {
         LOG_ERROR(Lib_NpTrophy, "Failed to open trophy xml : {}", result.description());
@@ -598,12 +672,10 @@ s32 PS4_SYSV_ABI sceNpTrophyGetTrophyUnlockState(OrbisNpTrophyContext context,
     char trophy_folder[9];
     snprintf(trophy_folder, sizeof(trophy_folder), "trophy%02d", contextkey.second);
 
-    const auto trophy_dir =
-        Common::FS::GetUserPath(Common::FS::PathType::MetaDataDir) / game_serial / "TrophyFiles";
-    auto trophy_file = trophy_dir / trophy_folder / "Xml" / "TROP.XML";
+    auto trophy_file = GetTrophyFile(trophy_folder, "Xml", "TROP.XML");
 
     pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_file(trophy_file.native().c_str());
+    pugi::xml_parse_result result = LoadTrophyFile(doc, trophy_file);
 
     if (!result) {
         LOG_ERROR(Lib_NpTrophy, "Failed to open trophy XML: {}", result.description());
@@ -966,12 +1038,10 @@ int PS4_SYSV_ABI sceNpTrophyUnlockTrophy(OrbisNpTrophyContext context, OrbisNpTr
     char trophy_folder[9];
     snprintf(trophy_folder, sizeof(trophy_folder), "trophy%02d", contextkey.second);
 
-    const auto trophy_dir =
-        Common::FS::GetUserPath(Common::FS::PathType::MetaDataDir) / game_serial / "TrophyFiles";
-    auto trophy_file = trophy_dir / trophy_folder / "Xml" / "TROP.XML";
+    auto trophy_file = GetTrophyFile(trophy_folder, "Xml", "TROP.XML");
 
     pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_file(trophy_file.native().c_str());
+    pugi::xml_parse_result result = LoadTrophyFile(doc, trophy_file);
 
     if (!result) {
         LOG_ERROR(Lib_NpTrophy, "Failed to parse trophy xml : {}", result.description());
@@ -1036,7 +1106,7 @@ int PS4_SYSV_ABI sceNpTrophyUnlockTrophy(OrbisNpTrophyContext context, OrbisNpTr
                     trophy_icon_file.append(".PNG");
 
                     std::filesystem::path current_icon_path =
-                        trophy_dir / trophy_folder / "Icons" / trophy_icon_file;
+                        GetTrophyFile(trophy_folder, "Icons", trophy_icon_file);
 
                     AddTrophyToQueue(current_icon_path, current_trophy_name, current_trophy_type);
                 }
@@ -1073,14 +1143,14 @@ int PS4_SYSV_ABI sceNpTrophyUnlockTrophy(OrbisNpTrophyContext context, OrbisNpTr
             platinum_icon_file.append(".PNG");
 
             std::filesystem::path platinum_icon_path =
-                trophy_dir / trophy_folder / "Icons" / platinum_icon_file;
+                GetTrophyFile(trophy_folder, "Icons", platinum_icon_file);
 
             *platinumId = platinum_trophy_id;
             AddTrophyToQueue(platinum_icon_path, platinum_trophy_name, "P");
         }
     }
 
-    doc.save_file((trophy_dir / trophy_folder / "Xml" / "TROP.XML").native().c_str());
+    QueueTrophyFileWrite(doc, trophy_file);
 
     return ORBIS_OK;
 }
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <filesystem>
 #include "common/types.h"
 #include "core/libraries/rtc/rtc.h"
 
@@ -14,6 +15,9 @@ namespace Libraries::Np::NpTrophy {
 
 extern std::string game_serial;
 
+// Reads the trophy packs of the game, after game_serial is set
+bool OpenTrophyPacks(const std::filesystem::path& game_folder);
+
 constexpr int ORBIS_NP_TROPHY_FLAG_SETSIZE = 128;
 constexpr int ORBIS_NP_TROPHY_FLAG_BITS_SHIFT = 5;
 
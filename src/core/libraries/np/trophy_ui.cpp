@@ -91,6 +91,14 @@ TrophyUI::TrophyUI(const std::filesystem::path& trophyIconPath, const std::strin
 
     AddLayer(this);
 
+    // Opening the audio device can take a while, keep it off the thread that unlocked the trophy
+    sound_thread = std::jthread{[this] { PlaySound(); }};
+}
+
+void TrophyUI::PlaySound() {
+    const auto CustomTrophy_Dir = Common::FS::GetUserPath(Common::FS::PathType::CustomTrophy);
+    auto resource = cmrc::res::get_filesystem();
+
     MIX_Init();
     mixer = MIX_CreateMixerDevice(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, NULL);
     if (!mixer) {
@@ -126,6 +134,9 @@ TrophyUI::TrophyUI(const std::filesystem::path& trophyIconPath, const std::strin
 }
 
 TrophyUI::~TrophyUI() {
+    if (sound_thread.joinable()) {
+        sound_thread.join();
+    }
     MIX_DestroyAudio(audio);
     MIX_DestroyMixer(mixer);
     MIX_Quit();
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <string>
+#include <thread>
 #include <variant>
 #include <SDL3_mixer/SDL_mixer.h>
 #include <queue>
@@ -27,13 +28,16 @@ public:
     void Draw() override;
 
 private:
+    void PlaySound();
+
     std::string trophy_name;
     std::string_view trophy_type;
     ImGui::RefCountedTexture trophy_icon;
     ImGui::RefCountedTexture trophy_type_icon;
 
-    MIX_Mixer* mixer;
-    MIX_Audio* audio;
+    MIX_Mixer* mixer{};
+    MIX_Audio* audio{};
+    std::jthread sound_thread;
 };
 
 struct TrophyInfo {
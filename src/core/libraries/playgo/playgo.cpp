@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+
 #include "common/logging/log.h"
 #include "common/singleton.h"
 #include "core/file_format/playgo_chunk.h"
@@ -9,6 +11,7 @@
 #include "core/libraries/libs.h"
 #include "core/libraries/system/systemservice.h"
 #include "playgo.h"
+#include "playgo_prefetch.h"
 
 namespace Libraries::PlayGo {
 
@@ -262,6 +265,7 @@ s32 PS4_SYSV_ABI scePlayGoInitialize(OrbisPlayGoInitParams* param) {
     sceSystemServiceParamGetInt(OrbisSystemServiceParamId::Lang, &system_lang);
     playgo->langMask = scePlayGoConvertLanguage(system_lang);
 
+    StartChunkPrefetch();
     return ORBIS_OK;
 }
 
@@ -310,6 +314,7 @@ s32 PS4_SYSV_ABI scePlayGoPrefetch(OrbisPlayGoHandle handle, const OrbisPlayGoCh
     default:
         return ORBIS_PLAYGO_ERROR_BAD_LOCUS;
     }
+    PrefetchChunks({chunkIds, numberOfEntries});
     return ORBIS_OK;
 }
 
@@ -372,6 +377,11 @@ s32 PS4_SYSV_ABI scePlayGoSetToDoList(OrbisPlayGoHandle handle, const OrbisPlayG
     if (!playgo) {
         return ORBIS_PLAYGO_ERROR_NOT_INITIALIZED;
     }
+
+    std::vector<OrbisPlayGoChunkId> chunk_ids(numberOfEntries);
+    std::ranges::transform(std::span{todoList, numberOfEntries}, chunk_ids.begin(),
+                           &OrbisPlayGoToDo::chunkId);
+    PrefetchChunks(chunk_ids);
     return ORBIS_OK;
 }
 
@@ -381,6 +391,7 @@ s32 PS4_SYSV_ABI scePlayGoTerminate() {
     if (!playgo) {
         return ORBIS_PLAYGO_ERROR_NOT_INITIALIZED;
     }
+    StopChunkPrefetch();
     playgo.reset();
     return ORBIS_OK;
 }
@@ -0,0 +1,187 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "common/config.h"
+#include "common/elf_info.h"
+#include "common/io_file.h"
+#include "common/logging/log.h"
+#include "common/mapped_file.h"
+#include "common/path_util.h"
+#include "common/singleton.h"
+#include "common/thread.h"
+#include "core/file_sys/fs.h"
+#include "core/libraries/playgo/playgo_prefetch.h"
+
+namespace Libraries::PlayGo {
+
+// Files recorded for a chunk, in the order they were first opened
+static constexpr size_t MaxFilesPerChunk = 512;
+static constexpr auto SaveInterval = std::chrono::seconds(10);
+
+static std::mutex g_mutex;
+static std::condition_variable_any g_cv;
+static std::map<OrbisPlayGoChunkId, std::vector<std::string>> g_history;
+static std::vector<OrbisPlayGoChunkId> g_recording_chunks;
+static std::deque<std::string> g_queue;
+static std::unordered_set<std::string> g_prefetched;
+static bool g_history_dirty{};
+static bool g_running{};
+static std::jthread g_thread;
+
+static std::filesystem::path GetHistoryPath() {
+    return Common::FS::GetUserPath(Common::FS::PathType::MetaDataDir) /
+           Common::ElfInfo::Instance().GameSerial() / "playgo_prefetch.txt";
+}
+
+// One line per file, the chunk and the guest path separated by a tab
+static void LoadHistory() {
+    Common::FS::IOFile file{GetHistoryPath(), Common::FS::FileAccessMode::Read,
+                            Common::FS::FileType::TextFile};
+    if (!file.IsOpen()) {
+        return;
+    }
+    std::string contents(file.GetSize(), '\0');
+    contents.resize(file.ReadRaw<char>(contents.data(), contents.size()));
+    size_t line_start = 0;
+    while (line_start < contents.size()) {
+        size_t line_end = contents.find('\n', line_start);
+        if (line_end == std::string::npos) {
+            line_end = contents.size();
+        }
+        const std::string_view line{contents.data() + line_start, line_end - line_start};
+        OrbisPlayGoChunkId chunk_id{};
+        const auto [end, ec] = std::from_chars(line.data(), line.data() + line.size(), chunk_id);
+        if (ec == std::errc{} && end < line.data() + line.size() && *end == '\t') {
+            g_history[chunk_id].emplace_back(end + 1, line.data() + line.size());
+        }
+        line_start = line_end + 1;
+    }
+}
+
+static void SaveHistory() {
+    std::string contents;
+    for (const auto& [chunk_id, files] : g_history) {
+        for (const auto& path : files) {
+            contents += fmt::format("{}\t{}\n", chunk_id, path);
+        }
+    }
+    const auto path = GetHistoryPath();
+    std::filesystem::create_directories(path.parent_path());
+    Common::FS::IOFile file{path, Common::FS::FileAccessMode::Create,
+                            Common::FS::FileType::TextFile};
+    file.WriteString(contents);
+}
+
+static void PrefetchThread(std::stop_token stop) {
+    Common::SetCurrentThreadName("shadPS4:PlayGoPrefetch");
+    auto* mnt = Common::Singleton<Core::FileSys::MntPoints>::Instance();
+    u64 prefetched_bytes = 0;
+    while (!stop.stop_requested()) {
+        std::string guest_path;
+        {
+            std::unique_lock lk{g_mutex};
+            g_cv.wait_for(lk, stop, SaveInterval, [] { return !g_queue.empty(); });
+            if (g_history_dirty) {
+                SaveHistory();
+                g_history_dirty = false;
+            }
+            if (g_queue.empty()) {
+                continue;
+            }
+            guest_path = std::move(g_queue.front());
+            g_queue.pop_front();
+        }
+
+        // Pages stay in the page cache after the mapping is closed
+        Common::FS::MappedFile file;
+        if (file.Open(mnt->GetHostPath(guest_path))) {
+            file.Prefetch(0, file.Size());
+            prefetched_bytes += file.Size();
+            LOG_DEBUG(Lib_PlayGo, "Prefetched {}, {} MB in total", guest_path,
+                      prefetched_bytes >> 20);
+        }
+    }
+}
+
+void StartChunkPrefetch() {
+    if (!Config::isPlayGoPrefetchEnabled()) {
+        return;
+    }
+    std::scoped_lock lk{g_mutex};
+    if (g_running) {
+        return;
+    }
+    LoadHistory();
+    g_running = true;
+    g_thread = std::jthread{PrefetchThread};
+}
+
+void StopChunkPrefetch() {
+    {
+        std::scoped_lock lk{g_mutex};
+        if (!g_running) {
+            return;
+        }
+        g_running = false;
+    }
+    g_thread.request_stop();
+    g_thread.join();
+
+    std::scoped_lock lk{g_mutex};
+    if (g_history_dirty) {
+        SaveHistory();
+        g_history_dirty = false;
+    }
+    g_history.clear();
+    g_recording_chunks.clear();
+    g_queue.clear();
+    g_prefetched.clear();
+}
+
+void PrefetchChunks(std::span<const OrbisPlayGoChunkId> chunk_ids) {
+    std::scoped_lock lk{g_mutex};
+    if (!g_running) {
+        return;
+    }
+    g_recording_chunks.assign(chunk_ids.begin(), chunk_ids.end());
+    for (const auto chunk_id : chunk_ids) {
+        const auto it = g_history.find(chunk_id);
+        if (it == g_history.end()) {
+            continue;
+        }
+        for (const auto& path : it->second) {
+            if (g_prefetched.insert(path).second) {
+                g_queue.push_back(path);
+            }
+        }
+    }
+    g_cv.notify_one();
+}
+
+void RecordGameFileOpen(std::string_view guest_path) {
+    std::scoped_lock lk{g_mutex};
+    if (!g_running || g_recording_chunks.empty()) {
+        return;
+    }
+    for (const auto chunk_id : g_recording_chunks) {
+        auto& files = g_history[chunk_id];
+        if (files.size() < MaxFilesPerChunk &&
+            std::ranges::find(files, guest_path) == files.end()) {
+            files.emplace_back(guest_path);
+            g_history_dirty = true;
+        }
+    }
+}
+
+} // namespace Libraries::PlayGo
@@ -0,0 +1,27 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <span>
+#include <string_view>
+
+#include "core/libraries/playgo/playgo_types.h"
+
+namespace Libraries::PlayGo {
+
+// Extracted games have no mapping of chunks to files, playgo-chunk.dat only places the chunks in
+// the package image. Instead, the files a game reads after asking for chunks are recorded per
+// chunk, and read into the page cache of the host the next time the game asks for them.
+
+void StartChunkPrefetch();
+
+void StopChunkPrefetch();
+
+// The game is interested in these chunks, e.g. for the next level
+void PrefetchChunks(std::span<const OrbisPlayGoChunkId> chunk_ids);
+
+// A file of the game was opened for reading
+void RecordGameFileOpen(std::string_view guest_path);
+
+} // namespace Libraries::PlayGo
@@ -1,16 +1,21 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
 #include <deque>
 #include <mutex>
 #include <semaphore>
+#include <unordered_map>
+#include <vector>
 
 #include <magic_enum/magic_enum.hpp>
+#include <xxhash.h>
 
 #include "save_backup.h"
 #include "save_instance.h"
 
 #include "common/logging/log.h"
+#include "common/io_file.h"
 #include "common/logging/log_entry.h"
 #include "common/polyfill_thread.h"
 #include "common/thread.h"
@@ -36,11 +41,58 @@ static std::deque<BackupRequest> g_result_queue;
 static std::atomic_int g_backup_progress = 0;
 static std::atomic g_backup_status = WorkerStatus::NotStarted;
 
+struct BackedUpFile {
+    std::uintmax_t size;
+    fs::file_time_type write_time;
+    u64 hash;
+};
+
+// State of the save files when they were last backed up, so unchanged files are not read again
+static std::unordered_map<fs::path::string_type, BackedUpFile> g_backed_up_files;
+
+static u64 HashFile(const fs::path& path) {
+    Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read};
+    XXH3_state_t* state = XXH3_createState();
+    XXH3_64bits_reset(state);
+    std::vector<u8> buffer(1_MB);
+    while (true) {
+        const size_t read = file.ReadRaw<u8>(buffer.data(), buffer.size());
+        if (read == 0) {
+            break;
+        }
+        XXH3_64bits_update(state, buffer.data(), read);
+    }
+    const u64 hash = XXH3_64bits_digest(state);
+    XXH3_freeState(state);
+    return hash;
+}
+
+// Whether the file in the last backup has the contents of the save file, which is hashed
+static bool IsBackedUp(const fs::path& file, const fs::path& backup_file, BackedUpFile& state) {
+    if (!fs::exists(backup_file) || fs::file_size(backup_file) != state.size) {
+        state.hash = HashFile(file);
+        return false;
+    }
+    const auto it = g_backed_up_files.find(file.native());
+    if (it != g_backed_up_files.end() && it->second.size == state.size) {
+        if (it->second.write_time == state.write_time) {
+            state.hash = it->second.hash;
+            return true;
+        }
+        state.hash = HashFile(file);
+        return state.hash == it->second.hash;
+    }
+    // Not backed up since the emulator started, compare with the backup itself
+    state.hash = HashFile(file);
+    return state.hash == HashFile(backup_file);
+}
+
 static void backup(const std::filesystem::path& dir_name) {
     std::unique_lock lk{g_backup_running_mutex};
     if (!fs::exists(dir_name)) {
         return;
     }
+    const auto start_time = std::chrono::steady_clock::now();
 
     const auto backup_dir = dir_name / ::backup_dir;
     const auto backup_dir_tmp = dir_name / ::backup_dir_tmp;
@@ -50,21 +102,48 @@ static void backup(const std::filesystem::path& dir_name) {
     fs::remove_all(backup_dir_old);
 
     std::vector<std::filesystem::path> backup_files;
-    for (const auto& entry : fs::directory_iterator(dir_name)) {
-        const auto filename = entry.path().filename();
-        if (filename != ::backup_dir) {
-            backup_files.push_back(entry.path());
+    for (auto it = fs::recursive_directory_iterator(dir_name);
+         it != fs::recursive_directory_iterator(); ++it) {
+        const auto filename = it->path().filename();
+        if (it.depth() == 0 && (filename == ::backup_dir || filename == ::backup_dir_tmp ||
+                                filename == ::backup_dir_old)) {
+            it.disable_recursion_pending();
+            continue;
         }
+        backup_files.push_back(it->path());
     }
 
     g_backup_progress = 0;
 
     int total_count = static_cast<int>(backup_files.size());
     int current_count = 0;
+    int linked_count = 0;
+    std::uintmax_t bytes_written = 0;
 
+    // Unchanged files are hard linked from the last backup, only the others are copied
     fs::create_directory(backup_dir_tmp);
     for (const auto& file : backup_files) {
-        fs::copy(file, backup_dir_tmp / file.filename(), fs::copy_options::recursive);
+        const auto relative_path = fs::relative(file, dir_name);
+        const auto target = backup_dir_tmp / relative_path;
+        if (fs::is_directory(file)) {
+            fs::create_directories(target);
+        } else {
+            fs::create_directories(target.parent_path());
+            BackedUpFile state{fs::file_size(file), fs::last_write_time(file), 0};
+            const auto backup_file = backup_dir / relative_path;
+            std::error_code ec;
+            if (IsBackedUp(file, backup_file, state)) {
+                fs::create_hard_link(backup_file, target, ec);
+                if (!ec) {
+                    linked_count++;
+                }
+            }
+            if (!fs::exists(target)) { // Changed, or hard links are not supported
+                fs::copy_file(file, target);
+                bytes_written += state.size;
+            }
+            g_backed_up_files[file.native()] = state;
+        }
         current_count++;
         g_backup_progress = current_count * 100 / total_count;
     }
@@ -76,6 +155,11 @@ static void backup(const std::filesystem::path& dir_name) {
     if (has_existing_backup) {
         fs::remove_all(backup_dir_old);
     }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time);
+    LOG_INFO(Lib_SaveData, "Backup of {} took {} ms, wrote {} KB, linked {} unchanged files",
+             fmt::UTF(dir_name.u8string()), elapsed.count(), bytes_written / 1024, linked_count);
 }
 
 static void BackupThreadBody() {
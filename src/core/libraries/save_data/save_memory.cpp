@@ -3,6 +3,7 @@
 
 #include "save_memory.h"
 
+#include <algorithm>
 #include <condition_variable>
 #include <filesystem>
 #include <mutex>
@@ -10,7 +11,7 @@
 #include <utility>
 #include <fmt/format.h>
 
-#include "boost/icl/concept/interval.hpp"
+#include "boost/icl/interval_set.hpp"
 #include "common/elf_info.h"
 #include "common/logging/log.h"
 #include "common/path_util.h"
@@ -28,6 +29,8 @@ constexpr std::string_view StandardDirnameSaveDataMemory = "sce_sdmemory";
 constexpr std::string_view FilenameSaveDataMemory = "memory.dat";
 constexpr std::string_view IconName = "icon0.png";
 constexpr std::string_view CorruptFileName = "corrupted";
+// Writes that come in this soon after each other are persisted together
+constexpr auto PersistDelay = std::chrono::milliseconds(500);
 
 namespace Libraries::SaveData::SaveMemory {
 
@@ -40,33 +43,95 @@ struct SlotData {
     PSF sfo;
     std::vector<u8> memory_cache;
     size_t memory_cache_size{};
+    boost::icl::interval_set<size_t> dirty_ranges; // Written by the game, not persisted yet
+};
+
+struct MemoryChunk {
+    size_t offset;
+    std::vector<u8> bytes;
 };
 
 static std::mutex g_slot_mtx;
 static std::unordered_map<u32, SlotData> g_attached_slots;
 
-void PersistMemory(u32 slot_id, bool lock) {
-    std::unique_lock lck{g_slot_mtx, std::defer_lock};
-    if (lock) {
-        lck.lock();
+// Serializes writing the memory files, taken before g_slot_mtx
+static std::mutex g_persist_mtx;
+static std::condition_variable_any g_persist_cv;
+static std::jthread g_persist_thread;
+
+static void LoadMemory(SlotData& data) {
+    auto& memory = data.memory_cache;
+    if (!memory.empty()) {
+        return;
+    }
+    memory.resize(data.memory_cache_size);
+    IOFile f{data.folder_path / FilenameSaveDataMemory, Common::FS::FileAccessMode::Read};
+    if (f.IsOpen()) {
+        f.Seek(0);
+        f.ReadSpan(std::span{memory});
+    }
+}
+
+// Writes the chunks into the file in place, or writes a new file and moves it over the old one
+static void WriteChunks(const fs::path& path, bool replace,
+                        const std::vector<MemoryChunk>& chunks) {
+    const auto write_path = replace ? fs::path{path}.concat(".tmp") : path;
+    IOFile f;
+    const int r = f.Open(write_path, replace ? Common::FS::FileAccessMode::Create
+                                             : Common::FS::FileAccessMode::Write);
+    if (!f.IsOpen()) {
+        const auto err = std::error_code{r, std::iostream_category()};
+        throw std::filesystem::filesystem_error{err.message(), write_path, err};
+    }
+    for (const auto& chunk : chunks) {
+        if (!f.Seek(chunk.offset) ||
+            f.WriteRaw<u8>(chunk.bytes.data(), chunk.bytes.size()) != chunk.bytes.size()) {
+            throw std::filesystem::filesystem_error{"Failed to write save memory", write_path,
+                                                    std::make_error_code(std::errc::io_error)};
+        }
+    }
+    f.Close();
+    if (replace) {
+        fs::rename(write_path, path);
+    }
+}
+
+void PersistMemory(u32 slot_id) {
+    std::scoped_lock persist_lck{g_persist_mtx};
+    fs::path memoryPath;
+    bool replace;
+    std::vector<MemoryChunk> chunks;
+    {
+        std::scoped_lock lck{g_slot_mtx};
+        const auto it = g_attached_slots.find(slot_id);
+        if (it == g_attached_slots.end()) {
+            return;
+        }
+        auto& data = it->second;
+        memoryPath = data.folder_path / FilenameSaveDataMemory;
+        replace = !fs::exists(memoryPath);
+        if (replace) {
+            chunks.push_back({0, data.memory_cache});
+        } else {
+            // Only the ranges written since the last time are copied, into the existing file
+            const auto memory = data.memory_cache.begin();
+            for (const auto& range : data.dirty_ranges) {
+                chunks.push_back({range.lower(), {memory + range.lower(), memory + range.upper()}});
+            }
+        }
+        data.dirty_ranges.clear();
+    }
+    if (chunks.empty()) {
+        return;
     }
-    auto& data = g_attached_slots[slot_id];
-    auto memoryPath = data.folder_path / FilenameSaveDataMemory;
     fs::create_directories(memoryPath.parent_path());
 
     int n = 0;
     std::string errMsg;
     while (n++ < 10) {
         try {
-            IOFile f;
-            int r = f.Open(memoryPath, Common::FS::FileAccessMode::Create);
-            if (f.IsOpen()) {
-                f.WriteRaw<u8>(data.memory_cache.data(), data.memory_cache.size());
-                f.Close();
-                return;
-            }
-            const auto err = std::error_code{r, std::iostream_category()};
-            throw std::filesystem::filesystem_error{err.message(), err};
+            WriteChunks(memoryPath, replace, chunks);
+            return;
         } catch (const std::filesystem::filesystem_error& e) {
             errMsg = std::string{e.what()};
             std::this_thread::sleep_for(std::chrono::seconds(1));
@@ -80,6 +145,58 @@ void PersistMemory(u32 slot_id, bool lock) {
     MsgDialog::ShowMsgDialog(dialog);
 }
 
+static void PersistThreadBody(std::stop_token stop) {
+    Common::SetCurrentThreadName("shadPS4:SaveData:MemoryThread");
+    const auto has_dirty_slot = [] {
+        return std::ranges::any_of(g_attached_slots, [](const auto& slot) {
+            return !slot.second.dirty_ranges.empty();
+        });
+    };
+    while (true) {
+        std::vector<u32> slots;
+        {
+            std::unique_lock lck{g_slot_mtx};
+            g_persist_cv.wait(lck, stop, has_dirty_slot);
+            if (!stop.stop_requested()) {
+                g_persist_cv.wait_for(lck, stop, PersistDelay, [] { return false; });
+            }
+            for (const auto& [slot_id, data] : g_attached_slots) {
+                if (!data.dirty_ranges.empty()) {
+                    slots.push_back(slot_id);
+                }
+            }
+        }
+        if (slots.empty()) {
+            if (stop.stop_requested()) {
+                break;
+            }
+            continue; // Persisted by a sync in the meantime
+        }
+        for (const u32 slot_id : slots) {
+            PersistMemory(slot_id);
+            OrbisUserServiceUserId user_id;
+            std::string game_serial;
+            {
+                std::scoped_lock lck{g_slot_mtx};
+                const auto& data = g_attached_slots[slot_id];
+                user_id = data.user_id;
+                game_serial = data.game_serial;
+            }
+            Backup::NewRequest(user_id, game_serial, GetSaveDir(slot_id),
+                               Backup::OrbisSaveDataEventType::__DO_NOT_SAVE);
+        }
+    }
+}
+
+void StopThread() {
+    if (!g_persist_thread.joinable()) {
+        return;
+    }
+    LOG_DEBUG(Lib_SaveData, "Stopping save memory thread");
+    g_persist_thread.request_stop();
+    g_persist_thread.join();
+}
+
 std::string GetSaveDir(u32 slot_id) {
     std::string dir(StandardDirnameSaveDataMemory);
     if (slot_id > 0) {
@@ -99,6 +216,7 @@ std::filesystem::path GetSavePath(OrbisUserServiceUserId user_id, u32 slot_id,
 
 size_t SetupSaveMemory(OrbisUserServiceUserId user_id, u32 slot_id, std::string_view game_serial,
                        size_t memory_size) {
+    PersistMemory(slot_id); // Before the pending writes of the slot are dropped
     std::lock_guard lck{g_slot_mtx};
 
     const auto save_dir = GetSavePath(user_id, slot_id, game_serial);
@@ -196,15 +314,8 @@ void SaveSFO(u32 slot_id) {
 void ReadMemory(u32 slot_id, void* buf, size_t buf_size, int64_t offset) {
     std::lock_guard lk{g_slot_mtx};
     auto& data = g_attached_slots[slot_id];
-    auto& memory = data.memory_cache;
-    if (memory.empty()) { // Load file
-        memory.resize(data.memory_cache_size);
-        IOFile f{data.folder_path / FilenameSaveDataMemory, Common::FS::FileAccessMode::Read};
-        if (f.IsOpen()) {
-            f.Seek(0);
-            f.ReadSpan(std::span{memory});
-        }
-    }
+    LoadMemory(data);
+    const auto& memory = data.memory_cache;
     s64 read_size = buf_size;
     if (read_size + offset > memory.size()) {
         read_size = memory.size() - offset;
@@ -215,13 +326,22 @@ void ReadMemory(u32 slot_id, void* buf, size_t buf_size, int64_t offset) {
 void WriteMemory(u32 slot_id, void* buf, size_t buf_size, int64_t offset) {
     std::lock_guard lk{g_slot_mtx};
     auto& data = g_attached_slots[slot_id];
+    // The rest of the file is kept, only the written range is persisted
+    LoadMemory(data);
     auto& memory = data.memory_cache;
     if (offset + buf_size > memory.size()) {
         memory.resize(offset + buf_size);
     }
     std::memcpy(memory.data() + offset, buf, buf_size);
-    PersistMemory(slot_id, false);
-    Backup::NewRequest(data.user_id, data.game_serial, GetSaveDir(slot_id),
-                       Backup::OrbisSaveDataEventType::__DO_NOT_SAVE);
+    if (buf_size == 0) {
+        return;
+    }
+    data.dirty_ranges += boost::icl::interval<size_t>::right_open(offset, offset + buf_size);
+    if (!g_persist_thread.joinable()) {
+        g_persist_thread = std::jthread{PersistThreadBody};
+        static std::once_flag flag;
+        std::call_once(flag, [] { std::at_quick_exit(StopThread); });
+    }
+    g_persist_cv.notify_one();
 }
 } // namespace Libraries::SaveData::SaveMemory
\ No newline at end of file
@@ -14,7 +14,11 @@ using OrbisUserServiceUserId = s32;
 
 namespace Libraries::SaveData::SaveMemory {
 
-void PersistMemory(u32 slot_id, bool lock = true);
+// Write the changes to the save memory now, instead of waiting for the background thread
+void PersistMemory(u32 slot_id);
+
+// Persist the pending changes and stop the background thread
+void StopThread();
 
 [[nodiscard]] std::string GetSaveDir(u32 slot_id);
 
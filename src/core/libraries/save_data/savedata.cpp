@@ -1669,6 +1669,7 @@ Error PS4_SYSV_ABI sceSaveDataTerminate() {
         }
     }
     g_initialized = false;
+    SaveMemory::StopThread();
     Backup::StopThread();
     return Error::OK;
 }
@@ -14,25 +14,6 @@ namespace Libraries::Videodec2 {
 std::vector<OrbisVideodec2AvcPictureInfo> gPictureInfos;
 std::vector<OrbisVideodec2LegacyAvcPictureInfo> gLegacyPictureInfos;
 
-static inline void CopyNV12Data(u8* dst, const AVFrame& src) {
-    if (src.width == src.linesize[0]) {
-        std::memcpy(dst, src.data[0], src.width * src.height);
-        std::memcpy(dst + (src.width * src.height), src.data[1], (src.width * src.height) / 2);
-        return;
-    }
-
-    for (u16 row = 0; row < src.height; row++) {
-        u64 dst_offset = row * src.width;
-        std::memcpy(dst + dst_offset, src.data[0] + (row * src.linesize[0]), src.width);
-    }
-
-    u64 dst_base = src.width * src.height;
-    for (u16 row = 0; row < src.height / 2; row++) {
-        u64 dst_offset = row * src.width;
-        std::memcpy(dst + dst_base + dst_offset, src.data[1] + (row * src.linesize[1]), src.width);
-    }
-}
-
 VdecDecoder::VdecDecoder(const OrbisVideodec2DecoderConfigInfo& configInfo,
                          const OrbisVideodec2DecoderMemoryInfo& memoryInfo) {
     ASSERT(configInfo.codecType == 1); /* AVC */
@@ -44,13 +25,19 @@ VdecDecoder::VdecDecoder(const OrbisVideodec2DecoderConfigInfo& configInfo,
     ASSERT(mCodecContext);
     mCodecContext->width = configInfo.maxFrameWidth;
     mCodecContext->height = configInfo.maxFrameHeight;
+    mHwAccel.Attach(mCodecContext, codec);
 
     avcodec_open2(mCodecContext, codec, nullptr);
+
+    mPacket = av_packet_alloc();
+    mFrame = av_frame_alloc();
+    ASSERT(mPacket && mFrame);
 }
 
 VdecDecoder::~VdecDecoder() {
     avcodec_free_context(&mCodecContext);
-    sws_freeContext(mSwsContext);
+    av_packet_free(&mPacket);
+    av_frame_free(&mFrame);
 
     gPictureInfos.clear();
 }
@@ -75,50 +62,34 @@ s32 VdecDecoder::Decode(const OrbisVideodec2InputData& inputData,
         return ORBIS_VIDEODEC2_ERROR_ACCESS_UNIT_SIZE;
     }
 
-    AVPacket* packet = av_packet_alloc();
-    if (!packet) {
-        LOG_ERROR(Lib_Vdec2, "Failed to allocate packet");
-        return ORBIS_VIDEODEC2_ERROR_API_FAIL;
-    }
-
-    packet->data = (u8*)inputData.auData;
-    packet->size = inputData.auSize;
-    packet->pts = inputData.ptsData;
-    packet->dts = inputData.dtsData;
+    // The guest memory is only read while sending, so the packet doesn't need a buffer
+    mPacket->data = (u8*)inputData.auData;
+    mPacket->size = inputData.auSize;
+    mPacket->pts = inputData.ptsData;
+    mPacket->dts = inputData.dtsData;
 
-    int ret = avcodec_send_packet(mCodecContext, packet);
+    int ret = avcodec_send_packet(mCodecContext, mPacket);
+    av_packet_unref(mPacket);
     if (ret < 0) {
         LOG_ERROR(Lib_Vdec2, "Error sending packet to decoder: {}", ret);
-        av_packet_free(&packet);
-        return ORBIS_VIDEODEC2_ERROR_API_FAIL;
-    }
-
-    AVFrame* frame = av_frame_alloc();
-    if (frame == nullptr) {
-        LOG_ERROR(Lib_Vdec2, "Failed to allocate frame");
-        av_packet_free(&packet);
         return ORBIS_VIDEODEC2_ERROR_API_FAIL;
     }
 
     while (true) {
-        ret = avcodec_receive_frame(mCodecContext, frame);
+        ret = avcodec_receive_frame(mCodecContext, mFrame);
         if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
             break;
         } else if (ret < 0) {
             LOG_ERROR(Lib_Vdec2, "Error receiving frame from decoder: {}", ret);
-            av_packet_free(&packet);
-            av_frame_free(&frame);
             return ORBIS_VIDEODEC2_ERROR_API_FAIL;
         }
 
-        if (frame->format != AV_PIX_FMT_NV12) {
-            AVFrame* nv12_frame = ConvertNV12Frame(*frame);
-            ASSERT(nv12_frame);
-            av_frame_free(&frame);
-            frame = nv12_frame;
+        const AVFrame* frame = CopyFrame((u8*)frameBuffer.frameBuffer);
+        if (!frame) {
+            av_frame_unref(mFrame);
+            return ORBIS_VIDEODEC2_ERROR_API_FAIL;
         }
 
-        CopyNV12Data((u8*)frameBuffer.frameBuffer, *frame);
         frameBuffer.isAccepted = true;
 
         outputInfo.codecType = 1; // FIXME: Hardcoded to AVC
@@ -175,8 +146,7 @@ s32 VdecDecoder::Decode(const OrbisVideodec2InputData& inputData,
         }
     }
 
-    av_packet_free(&packet);
-    av_frame_free(&frame);
+    av_frame_unref(mFrame);
     return ORBIS_OK;
 }
 
@@ -192,30 +162,21 @@ s32 VdecDecoder::Flush(OrbisVideodec2FrameBuffer& frameBuffer,
         outputInfo.frameFormat = 0;
     }
 
-    AVFrame* frame = av_frame_alloc();
-    if (!frame) {
-        LOG_ERROR(Lib_Vdec2, "Failed to allocate frame");
-        return ORBIS_VIDEODEC2_ERROR_API_FAIL;
-    }
-
     while (true) {
-        int ret = avcodec_receive_frame(mCodecContext, frame);
+        int ret = avcodec_receive_frame(mCodecContext, mFrame);
         if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
             break;
         } else if (ret < 0) {
             LOG_ERROR(Lib_Vdec2, "Error receiving frame from decoder: {}", ret);
-            av_frame_free(&frame);
             return ORBIS_VIDEODEC2_ERROR_API_FAIL;
         }
 
-        if (frame->format != AV_PIX_FMT_NV12) {
-            AVFrame* nv12_frame = ConvertNV12Frame(*frame);
-            ASSERT(nv12_frame);
-            av_frame_free(&frame);
-            frame = nv12_frame;
+        const AVFrame* frame = CopyFrame((u8*)frameBuffer.frameBuffer);
+        if (!frame) {
+            av_frame_unref(mFrame);
+            return ORBIS_VIDEODEC2_ERROR_API_FAIL;
         }
 
-        CopyNV12Data((u8*)frameBuffer.frameBuffer, *frame);
         frameBuffer.isAccepted = true;
 
         outputInfo.codecType = 1; // FIXME: Hardcoded to AVC
@@ -237,7 +198,7 @@ s32 VdecDecoder::Flush(OrbisVideodec2FrameBuffer& frameBuffer,
         // FIXME: Should we add picture info here too?
     }
 
-    av_frame_free(&frame);
+    av_frame_unref(mFrame);
     return ORBIS_OK;
 }
 
@@ -247,35 +208,21 @@ s32 VdecDecoder::Reset() {
     return ORBIS_OK;
 }
 
-AVFrame* VdecDecoder::ConvertNV12Frame(AVFrame& frame) {
-    AVFrame* nv12_frame = av_frame_alloc();
-    nv12_frame->pts = frame.pts;
-    nv12_frame->pkt_dts = frame.pkt_dts < 0 ? 0 : frame.pkt_dts;
-    nv12_frame->format = AV_PIX_FMT_NV12;
-    nv12_frame->width = frame.width;
-    nv12_frame->height = frame.height;
-    nv12_frame->sample_aspect_ratio = frame.sample_aspect_ratio;
-    nv12_frame->crop_top = frame.crop_top;
-    nv12_frame->crop_bottom = frame.crop_bottom;
-    nv12_frame->crop_left = frame.crop_left;
-    nv12_frame->crop_right = frame.crop_right;
-
-    av_frame_get_buffer(nv12_frame, 0);
-
-    if (mSwsContext == nullptr) {
-        mSwsContext = sws_getContext(frame.width, frame.height, AVPixelFormat(frame.format),
-                                     nv12_frame->width, nv12_frame->height, AV_PIX_FMT_NV12,
-                                     SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
-    }
-
-    const auto res = sws_scale(mSwsContext, frame.data, frame.linesize, 0, frame.height,
-                               nv12_frame->data, nv12_frame->linesize);
-    if (res < 0) {
-        LOG_ERROR(Lib_Vdec2, "Could not convert to NV12: {}", av_err2str(res));
+const AVFrame* VdecDecoder::CopyFrame(u8* dst) {
+    const AVFrame* picture = mHwAccel.Download(mFrame);
+    if (!picture) {
         return nullptr;
     }
-
-    return nv12_frame;
+    // Decoders output NV12 or planar 4:2:0, which is copied without converting
+    const size_t uv_offset = size_t(picture->width) * picture->height;
+    if (!Videodec::CopyToNV12(dst, picture->width, uv_offset, *picture)) {
+        picture = mConverter.Convert(*picture);
+        if (!picture) {
+            return nullptr;
+        }
+        Videodec::CopyToNV12(dst, picture->width, uv_offset, *picture);
+    }
+    return picture;
 }
 
 } // namespace Libraries::Videodec2
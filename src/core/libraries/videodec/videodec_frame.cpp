@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+
+#include "common/arch.h"
+#include "common/logging/log.h"
+#include "core/libraries/videodec/videodec_frame.h"
+
+extern "C" {
+#include <libavutil/opt.h>
+}
+
+#include "common/support/avdec.h"
+
+#ifdef ARCH_X86_64
+#include <emmintrin.h>
+#endif
+
+namespace Libraries::Videodec {
+
+namespace {
+
+void CopyPlane(u8* dst, size_t dst_pitch, const u8* src, size_t src_pitch, size_t row_size,
+               u32 rows) {
+    if (dst_pitch == src_pitch && src_pitch == row_size) {
+        std::memcpy(dst, src, row_size * rows);
+        return;
+    }
+    for (u32 row = 0; row < rows; ++row) {
+        std::memcpy(dst + row * dst_pitch, src + row * src_pitch, row_size);
+    }
+}
+
+/// Interleaves a row of the U and V planes into the UV row of NV12.
+void InterleaveRow(u8* dst, const u8* u, const u8* v, size_t num_samples) {
+    size_t i = 0;
+#ifdef ARCH_X86_64
+    for (; i + 16 <= num_samples; i += 16) {
+        const __m128i u_samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + i));
+        const __m128i v_samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2),
+                         _mm_unpacklo_epi8(u_samples, v_samples));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2 + 16),
+                         _mm_unpackhi_epi8(u_samples, v_samples));
+    }
+#endif
+    for (; i < num_samples; ++i) {
+        dst[i * 2] = u[i];
+        dst[i * 2 + 1] = v[i];
+    }
+}
+
+} // Anonymous namespace
+
+bool CopyToNV12(u8* dst, u32 pitch, size_t uv_offset, const AVFrame& src) {
+    const u32 width = src.width;
+    const u32 height = src.height;
+    switch (src.format) {
+    case AV_PIX_FMT_NV12:
+        CopyPlane(dst, pitch, src.data[0], src.linesize[0], width, height);
+        CopyPlane(dst + uv_offset, pitch, src.data[1], src.linesize[1], width, height / 2);
+        return true;
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+        CopyPlane(dst, pitch, src.data[0], src.linesize[0], width, height);
+        for (u32 row = 0; row < height / 2; ++row) {
+            InterleaveRow(dst + uv_offset + size_t{row} * pitch,
+                          src.data[1] + row * src.linesize[1],
+                          src.data[2] + row * src.linesize[2], width / 2);
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+NV12Converter::NV12Converter() = default;
+
+NV12Converter::~NV12Converter() {
+    sws_freeContext(context);
+    av_frame_free(&nv12_frame);
+}
+
+bool NV12Converter::Setup(const AVFrame& frame) {
+    sws_freeContext(context);
+    av_frame_free(&nv12_frame);
+    src_width = frame.width;
+    src_height = frame.height;
+    src_format = frame.format;
+
+    context = sws_alloc_context();
+    nv12_frame = av_frame_alloc();
+    if (!context || !nv12_frame) {
+        return false;
+    }
+    av_opt_set_int(context, "srcw", frame.width, 0);
+    av_opt_set_int(context, "srch", frame.height, 0);
+    av_opt_set_int(context, "src_format", frame.format, 0);
+    av_opt_set_int(context, "dstw", frame.width, 0);
+    av_opt_set_int(context, "dsth", frame.height, 0);
+    av_opt_set_int(context, "dst_format", AV_PIX_FMT_NV12, 0);
+    av_opt_set_int(context, "sws_flags", SWS_FAST_BILINEAR, 0);
+    // Slices are converted on their own threads, one per core
+    av_opt_set_int(context, "threads", 0, 0);
+    int ret = sws_init_context(context, nullptr, nullptr);
+    if (ret >= 0) {
+        nv12_frame->format = AV_PIX_FMT_NV12;
+        nv12_frame->width = frame.width;
+        nv12_frame->height = frame.height;
+        ret = av_frame_get_buffer(nv12_frame, 0);
+    }
+    if (ret < 0) {
+        LOG_ERROR(Lib_Videodec, "Could not set up NV12 conversion: {}", av_err2str(ret));
+        sws_freeContext(context);
+        context = nullptr;
+        return false;
+    }
+    return true;
+}
+
+const AVFrame* NV12Converter::Convert(const AVFrame& frame) {
+    if (!context || frame.width != src_width || frame.height != src_height ||
+        frame.format != src_format) {
+        if (!Setup(frame)) {
+            return nullptr;
+        }
+    }
+    const int ret = sws_scale_frame(context, nv12_frame, &frame);
+    if (ret < 0) {
+        LOG_ERROR(Lib_Videodec, "Could not convert to NV12: {}", av_err2str(ret));
+        return nullptr;
+    }
+    av_frame_copy_props(nv12_frame, &frame);
+    return nv12_frame;
+}
+
+} // namespace Libraries::Videodec
@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "common/types.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+namespace Libraries::Videodec {
+
+/// Writes the picture of a frame as NV12 with rows of pitch bytes and the chroma plane at
+/// uv_offset. Handles NV12 and planar 4:2:0 frames, which is what H.264 decodes to, and returns
+/// false for other formats.
+bool CopyToNV12(u8* dst, u32 pitch, size_t uv_offset, const AVFrame& src);
+
+/// Converts the frames CopyToNV12 can't handle, on the threads of swscale. The context and the
+/// output frame are kept across frames of the same size and format.
+class NV12Converter {
+public:
+    NV12Converter();
+    ~NV12Converter();
+
+    NV12Converter(const NV12Converter&) = delete;
+    NV12Converter& operator=(const NV12Converter&) = delete;
+
+    /// Returns the frame converted to NV12, valid until the next call, or nullptr on failure.
+    const AVFrame* Convert(const AVFrame& frame);
+
+private:
+    bool Setup(const AVFrame& frame);
+
+    SwsContext* context{};
+    AVFrame* nv12_frame{};
+    int src_width{};
+    int src_height{};
+    int src_format{AV_PIX_FMT_NONE};
+};
+
+} // namespace Libraries::Videodec
@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "videodec_hwaccel.h"
+
+#include "common/config.h"
+#include "common/logging/log.h"
+
+extern "C" {
+#include <libavutil/hwcontext.h>
+#include <libavutil/pixdesc.h>
+}
+
+#include "common/support/avdec.h"
+
+namespace Libraries::Videodec {
+
+HwAccel::~HwAccel() {
+    av_buffer_unref(&device);
+    av_frame_free(&sw_frame);
+}
+
+bool HwAccel::Attach(AVCodecContext* context, const AVCodec* codec) {
+    av_buffer_unref(&device);
+    hw_format = AV_PIX_FMT_NONE;
+    const std::string name = Config::getVideoDecoder();
+    if (name == "software") {
+        return false;
+    }
+    AVHWDeviceType wanted = AV_HWDEVICE_TYPE_NONE;
+    if (name != "auto") {
+        wanted = av_hwdevice_find_type_by_name(name.c_str());
+        if (wanted == AV_HWDEVICE_TYPE_NONE) {
+            LOG_WARNING(Lib_Videodec, "Unknown video decoder {}, decoding in software", name);
+            return false;
+        }
+    }
+
+    // Devices are tried in the order FFmpeg lists them for the codec, the first that opens wins
+    for (int i = 0;; ++i) {
+        const AVCodecHWConfig* config = avcodec_get_hw_config(codec, i);
+        if (!config) {
+            break;
+        }
+        if (!(config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX) ||
+            (wanted != AV_HWDEVICE_TYPE_NONE && config->device_type != wanted)) {
+            continue;
+        }
+        const int ret = av_hwdevice_ctx_create(&device, config->device_type, nullptr, nullptr, 0);
+        if (ret < 0) {
+            LOG_INFO(Lib_Videodec, "Could not open {} device: {}",
+                     av_hwdevice_get_type_name(config->device_type), av_err2str(ret));
+            continue;
+        }
+        hw_format = config->pix_fmt;
+        context->hw_device_ctx = av_buffer_ref(device);
+        context->opaque = this;
+        context->get_format = &GetFormat;
+        LOG_INFO(Lib_Videodec, "Decoding video with {}",
+                 av_hwdevice_get_type_name(config->device_type));
+        return true;
+    }
+    LOG_INFO(Lib_Videodec, "No hardware video decoder available, decoding in software");
+    return false;
+}
+
+AVPixelFormat HwAccel::GetFormat(AVCodecContext* context, const AVPixelFormat* formats) {
+    const auto* hwaccel = static_cast<const HwAccel*>(context->opaque);
+    for (const AVPixelFormat* format = formats; *format != AV_PIX_FMT_NONE; ++format) {
+        if (*format == hwaccel->hw_format) {
+            return *format;
+        }
+    }
+    // FFmpeg leaves the device out when it can't decode the stream, e.g. for its profile
+    LOG_WARNING(Lib_Videodec, "Stream not supported by the {} decoder, decoding in software",
+                av_get_pix_fmt_name(hwaccel->hw_format));
+    return avcodec_default_get_format(context, formats);
+}
+
+const AVFrame* HwAccel::Download(const AVFrame* frame) {
+    if (frame->format != hw_format || hw_format == AV_PIX_FMT_NONE) {
+        return frame;
+    }
+    if (!sw_frame && !(sw_frame = av_frame_alloc())) {
+        return nullptr;
+    }
+    av_frame_unref(sw_frame);
+    int ret = av_hwframe_transfer_data(sw_frame, frame, 0);
+    if (ret >= 0) {
+        ret = av_frame_copy_props(sw_frame, frame);
+    }
+    if (ret < 0) {
+        LOG_ERROR(Lib_Videodec, "Could not copy frame from the device: {}", av_err2str(ret));
+        return nullptr;
+    }
+    return sw_frame;
+}
+
+} // namespace Libraries::Videodec
@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+namespace Libraries::Videodec {
+
+/// Hardware decoding through an FFmpeg hwaccel device (VAAPI, D3D11VA, VideoToolbox...), picked
+/// by the videoDecoder option. Decoded surfaces are copied back to system memory, and decoding
+/// stays in software when no device can be opened or the stream isn't supported by it.
+class HwAccel {
+public:
+    HwAccel() = default;
+    ~HwAccel();
+
+    HwAccel(const HwAccel&) = delete;
+    HwAccel& operator=(const HwAccel&) = delete;
+
+    /// Attaches a device to a codec context before it is opened. Returns false if the context
+    /// decodes in software.
+    bool Attach(AVCodecContext* context, const AVCodec* codec);
+
+    /// Returns a decoded frame in system memory, for frames on the device a copy that is usually
+    /// in NV12 already and stays valid until the next call. Returns nullptr if the copy failed.
+    const AVFrame* Download(const AVFrame* frame);
+
+private:
+    static AVPixelFormat GetFormat(AVCodecContext* context, const AVPixelFormat* formats);
+
+    AVBufferRef* device{};
+    AVFrame* sw_frame{}; ///< Reused for every frame copied back
+    AVPixelFormat hw_format{AV_PIX_FMT_NONE};
+};
+
+} // namespace Libraries::Videodec
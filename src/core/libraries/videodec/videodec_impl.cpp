@@ -12,13 +12,6 @@
 
 namespace Libraries::Videodec {
 
-static inline void CopyNV12Data(u8* dst, const AVFrame& src) {
-    u32 width = Common::AlignUp((u32)src.width, 16);
-    u32 height = Common::AlignUp((u32)src.height, 16);
-    std::memcpy(dst, src.data[0], src.width * src.height);
-    std::memcpy(dst + src.width * height, src.data[1], (src.width * src.height) / 2);
-}
-
 VdecDecoder::VdecDecoder(const OrbisVideodecConfigInfo& pCfgInfoIn,
                          const OrbisVideodecResourceInfo& pRsrcInfoIn) {
 
@@ -29,13 +22,19 @@ VdecDecoder::VdecDecoder(const OrbisVideodecConfigInfo& pCfgInfoIn,
     ASSERT(mCodecContext);
     mCodecContext->width = pCfgInfoIn.maxFrameWidth;
     mCodecContext->height = pCfgInfoIn.maxFrameHeight;
+    mHwAccel.Attach(mCodecContext, codec);
 
     avcodec_open2(mCodecContext, codec, nullptr);
+
+    mPacket = av_packet_alloc();
+    mFrame = av_frame_alloc();
+    ASSERT(mPacket && mFrame);
 }
 
 VdecDecoder::~VdecDecoder() {
     avcodec_free_context(&mCodecContext);
-    sws_freeContext(mSwsContext);
+    av_packet_free(&mPacket);
+    av_frame_free(&mFrame);
 }
 
 s32 VdecDecoder::Decode(const OrbisVideodecInputData& pInputDataIn,
@@ -52,50 +51,34 @@ s32 VdecDecoder::Decode(const OrbisVideodecInputData& pInputDataIn,
         return ORBIS_VIDEODEC_ERROR_AU_SIZE;
     }
 
-    AVPacket* packet = av_packet_alloc();
-    if (!packet) {
-        LOG_ERROR(Lib_Videodec, "Failed to allocate packet");
-        return ORBIS_VIDEODEC_ERROR_API_FAIL;
-    }
-
-    packet->data = (u8*)pInputDataIn.pAuData;
-    packet->size = pInputDataIn.auSize;
-    packet->pts = pInputDataIn.ptsData;
-    packet->dts = pInputDataIn.dtsData;
+    // The guest memory is only read while sending, so the packet doesn't need a buffer
+    mPacket->data = (u8*)pInputDataIn.pAuData;
+    mPacket->size = pInputDataIn.auSize;
+    mPacket->pts = pInputDataIn.ptsData;
+    mPacket->dts = pInputDataIn.dtsData;
 
-    int ret = avcodec_send_packet(mCodecContext, packet);
+    int ret = avcodec_send_packet(mCodecContext, mPacket);
+    av_packet_unref(mPacket);
     if (ret < 0) {
         LOG_ERROR(Lib_Videodec, "Error sending packet to decoder: {}", ret);
-        av_packet_free(&packet);
-        return ORBIS_VIDEODEC_ERROR_API_FAIL;
-    }
-
-    AVFrame* frame = av_frame_alloc();
-    if (frame == nullptr) {
-        LOG_ERROR(Lib_Videodec, "Failed to allocate frame");
-        av_packet_free(&packet);
         return ORBIS_VIDEODEC_ERROR_API_FAIL;
     }
     int frameCount = 0;
     while (true) {
-        ret = avcodec_receive_frame(mCodecContext, frame);
+        ret = avcodec_receive_frame(mCodecContext, mFrame);
         if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
             break;
         } else if (ret < 0) {
             LOG_ERROR(Lib_Videodec, "Error receiving frame from decoder: {}", ret);
-            av_packet_free(&packet);
-            av_frame_free(&frame);
             return ORBIS_VIDEODEC_ERROR_API_FAIL;
         }
 
-        if (frame->format != AV_PIX_FMT_NV12) {
-            AVFrame* nv12_frame = ConvertNV12Frame(*frame);
-            ASSERT(nv12_frame);
-            av_frame_free(&frame);
-            frame = nv12_frame;
+        const AVFrame* frame = CopyFrame((u8*)pFrameBufferInOut.pFrameBuffer);
+        if (!frame) {
+            av_frame_unref(mFrame);
+            return ORBIS_VIDEODEC_ERROR_API_FAIL;
         }
 
-        CopyNV12Data((u8*)pFrameBufferInOut.pFrameBuffer, *frame);
 
         pPictureInfoOut.codecType = 0;
         pPictureInfoOut.frameWidth = Common::AlignUp((u32)frame->width, 16);
@@ -110,8 +93,7 @@ s32 VdecDecoder::Decode(const OrbisVideodecInputData& pInputDataIn,
         }
     }
 
-    av_packet_free(&packet);
-    av_frame_free(&frame);
+    av_frame_unref(mFrame);
     return ORBIS_OK;
 }
 
@@ -121,31 +103,22 @@ s32 VdecDecoder::Flush(OrbisVideodecFrameBuffer& pFrameBufferInOut,
     pPictureInfoOut.isValid = false;
     pPictureInfoOut.isErrorPic = true;
 
-    AVFrame* frame = av_frame_alloc();
-    if (!frame) {
-        LOG_ERROR(Lib_Videodec, "Failed to allocate frame");
-        return ORBIS_VIDEODEC_ERROR_API_FAIL;
-    }
-
     int frameCount = 0;
     while (true) {
-        int ret = avcodec_receive_frame(mCodecContext, frame);
+        int ret = avcodec_receive_frame(mCodecContext, mFrame);
         if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
             break;
         } else if (ret < 0) {
             LOG_ERROR(Lib_Videodec, "Error receiving frame from decoder: {}", ret);
-            av_frame_free(&frame);
             return ORBIS_VIDEODEC_ERROR_API_FAIL;
         }
 
-        if (frame->format != AV_PIX_FMT_NV12) {
-            AVFrame* nv12_frame = ConvertNV12Frame(*frame);
-            ASSERT(nv12_frame);
-            av_frame_free(&frame);
-            frame = nv12_frame;
+        const AVFrame* frame = CopyFrame((u8*)pFrameBufferInOut.pFrameBuffer);
+        if (!frame) {
+            av_frame_unref(mFrame);
+            return ORBIS_VIDEODEC_ERROR_API_FAIL;
         }
 
-        CopyNV12Data((u8*)pFrameBufferInOut.pFrameBuffer, *frame);
 
         pPictureInfoOut.codecType = 0;
         pPictureInfoOut.frameWidth = Common::AlignUp((u32)frame->width, 16);
@@ -170,7 +143,7 @@ s32 VdecDecoder::Flush(OrbisVideodecFrameBuffer& pFrameBufferInOut,
         }
     }
 
-    av_frame_free(&frame);
+    av_frame_unref(mFrame);
     return ORBIS_OK;
 }
 
@@ -179,35 +152,21 @@ s32 VdecDecoder::Reset() {
     return ORBIS_OK;
 }
 
-AVFrame* VdecDecoder::ConvertNV12Frame(AVFrame& frame) {
-    AVFrame* nv12_frame = av_frame_alloc();
-    nv12_frame->pts = frame.pts;
-    nv12_frame->pkt_dts = frame.pkt_dts < 0 ? 0 : frame.pkt_dts;
-    nv12_frame->format = AV_PIX_FMT_NV12;
-    nv12_frame->width = frame.width;
-    nv12_frame->height = frame.height;
-    nv12_frame->sample_aspect_ratio = frame.sample_aspect_ratio;
-    nv12_frame->crop_top = frame.crop_top;
-    nv12_frame->crop_bottom = frame.crop_bottom;
-    nv12_frame->crop_left = frame.crop_left;
-    nv12_frame->crop_right = frame.crop_right;
-
-    av_frame_get_buffer(nv12_frame, 0);
-
-    if (mSwsContext == nullptr) {
-        mSwsContext = sws_getContext(frame.width, frame.height, AVPixelFormat(frame.format),
-                                     nv12_frame->width, nv12_frame->height, AV_PIX_FMT_NV12,
-                                     SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
-    }
-
-    const auto res = sws_scale(mSwsContext, frame.data, frame.linesize, 0, frame.height,
-                               nv12_frame->data, nv12_frame->linesize);
-    if (res < 0) {
-        LOG_ERROR(Lib_Videodec, "Could not convert to NV12: {}", av_err2str(res));
+const AVFrame* VdecDecoder::CopyFrame(u8* dst) {
+    const AVFrame* picture = mHwAccel.Download(mFrame);
+    if (!picture) {
         return nullptr;
     }
-
-    return nv12_frame;
+    // Decoders output NV12 or planar 4:2:0, which is copied without converting
+    const size_t uv_offset = size_t(picture->width) * Common::AlignUp((u32)picture->height, 16);
+    if (!CopyToNV12(dst, picture->width, uv_offset, *picture)) {
+        picture = mConverter.Convert(*picture);
+        if (!picture) {
+            return nullptr;
+        }
+        CopyToNV12(dst, picture->width, uv_offset, *picture);
+    }
+    return picture;
 }
 
 } // namespace Libraries::Videodec
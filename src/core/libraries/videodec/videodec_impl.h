@@ -13,6 +13,9 @@ extern "C" {
 #include <libswscale/swscale.h>
 }
 
+#include "core/libraries/videodec/videodec_frame.h"
+#include "core/libraries/videodec/videodec_hwaccel.h"
+
 namespace Libraries::Videodec {
 
 class VdecDecoder {
@@ -28,11 +31,15 @@ public:
     s32 Reset();
 
 private:
-    AVFrame* ConvertNV12Frame(AVFrame& frame);
+    /// Writes the decoded frame to the guest buffer as NV12 and returns the frame it copied.
+    const AVFrame* CopyFrame(u8* dst);
 
 private:
     AVCodecContext* mCodecContext = nullptr;
-    SwsContext* mSwsContext = nullptr;
+    AVPacket* mPacket = nullptr;
+    AVFrame* mFrame = nullptr;
+    HwAccel mHwAccel;
+    NV12Converter mConverter;
 };
 
 } // namespace Libraries::Videodec
\ No newline at end of file
@@ -1,6 +1,9 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <cmath>
+#include <utility>
+
 #include "common/assert.h"
 #include "common/config.h"
 #include "common/debug.h"
@@ -9,9 +12,11 @@
 #include "core/libraries/kernel/time.h"
 #include "core/libraries/videoout/driver.h"
 #include "core/libraries/videoout/videoout_error.h"
+#include "core/thread.h"
 #include "imgui/renderer/imgui_core.h"
 #include "video_core/amdgpu/liverpool.h"
 #include "video_core/renderer_vulkan/vk_presenter.h"
+#include "video_core/stall_tracker.h"
 
 extern std::unique_ptr<Vulkan::Presenter> presenter;
 extern std::unique_ptr<AmdGpu::Liverpool> liverpool;
@@ -266,13 +271,79 @@ void VideoOutDriver::SubmitFlipInternal(VideoOutPort* port, s32 index, s64 flip_
     });
 }
 
+/**
+ * Stretches the guest vblank period to a whole number of display refreshes when it is within a
+ * percent of one, so every flip is shown for the same number of refreshes instead of the timer
+ * drifting across them. A 60 Hz guest on a 59.94, 119.88 or 120 Hz display is paced by the
+ * display, on 144 Hz there is no such multiple and the guest period is kept.
+ */
+static std::chrono::nanoseconds AlignVblankPeriod(std::chrono::nanoseconds guest_period,
+                                                  float refresh_rate) {
+    if (refresh_rate <= 0.0f) {
+        return guest_period;
+    }
+    const double guest_ns = static_cast<double>(guest_period.count());
+    const double refresh_ns = 1e9 / refresh_rate;
+    const double aligned_ns = std::round(guest_ns / refresh_ns) * refresh_ns;
+    if (aligned_ns < refresh_ns || std::abs(aligned_ns - guest_ns) > guest_ns * 0.01) {
+        return guest_period;
+    }
+    return std::chrono::nanoseconds{static_cast<s64>(aligned_ns)};
+}
+
 void VideoOutDriver::PresentThread(std::stop_token token) {
-    const std::chrono::nanoseconds vblank_period(1000000000 / Config::vblankFreq());
+    const std::chrono::nanoseconds guest_vblank_period(1000000000 / Config::vblankFreq());
+    std::chrono::nanoseconds vblank_period = guest_vblank_period;
 
     Common::SetCurrentThreadName("shadPS4:PresentThread");
+    Core::KeepCurrentThreadOffGuestCores();
     Common::SetCurrentThreadRealtime(vblank_period);
+    VideoCore::MarkRenderThread();
 
     Common::AccurateTimer timer{vblank_period};
+    const bool low_latency = Config::isLowLatencyPresentEnabled();
+    const bool host_vblank_sync = Config::isHostVblankSyncEnabled();
+    DebugState.vblank_period_us = static_cast<u32>(vblank_period.count() / 1000);
+
+    float refresh_rate = 0.0f;
+    const auto update_vblank_period = [&] {
+        const float new_refresh_rate = presenter ? presenter->GetWindow().GetRefreshRate() : 0.0f;
+        if (new_refresh_rate == refresh_rate) {
+            return;
+        }
+        refresh_rate = new_refresh_rate;
+        vblank_period = AlignVblankPeriod(guest_vblank_period, refresh_rate);
+        timer.SetInterval(vblank_period);
+        DebugState.vblank_period_us = static_cast<u32>(vblank_period.count() / 1000);
+        LOG_INFO(Lib_VideoOut, "Vblank period {:.3f} ms for a {:.3f} Hz display",
+                 vblank_period.count() / 1e6, refresh_rate);
+    };
+
+    // Flip spacing against the flip rate, and in display refreshes
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point last_flip{};
+    s64 last_flip_refreshes = 0;
+    double flip_jitter_us = 0.0;
+    const auto track_flip = [&] {
+        const auto now = Clock::now();
+        const auto last = std::exchange(last_flip, now);
+        if (last == Clock::time_point{}) {
+            return;
+        }
+        const double interval_us = std::chrono::duration<double, std::micro>(now - last).count();
+        const double expected_us =
+            std::chrono::duration<double, std::micro>(vblank_period).count() *
+            (main_port.flip_rate + 1);
+        flip_jitter_us += (std::abs(interval_us - expected_us) - flip_jitter_us) / 16.0;
+        DebugState.flip_jitter_us = static_cast<u32>(flip_jitter_us);
+        if (refresh_rate > 0.0f) {
+            const s64 refreshes = std::llround(interval_us * refresh_rate / 1e6);
+            if (last_flip_refreshes != 0 && refreshes != last_flip_refreshes) {
+                ++DebugState.uneven_flips;
+            }
+            last_flip_refreshes = refreshes;
+        }
+    };
 
     const auto receive_request = [this] -> Request {
         std::scoped_lock lk{mutex};
@@ -285,6 +356,9 @@ void VideoOutDriver::PresentThread(std::stop_token token) {
     };
 
     while (!token.stop_requested()) {
+        if (host_vblank_sync) {
+            update_vblank_period();
+        }
         timer.Start();
 
         if (DebugState.IsGuestThreadsPaused()) {
@@ -307,6 +381,7 @@ void VideoOutDriver::PresentThread(std::stop_token token) {
                 }
             } else {
                 Flip(request);
+                track_flip();
                 FRAME_END;
             }
         }
@@ -329,6 +404,11 @@ void VideoOutDriver::PresentThread(std::stop_token token) {
         }
 
         timer.End();
+        if (low_latency) {
+            // Waiting for the display can make a vblank run long. Drop most of the delay instead
+            // of flipping several frames back to back to catch up, so flips stay evenly spaced.
+            timer.LimitDebt(vblank_period / 2);
+        }
     }
 }
 
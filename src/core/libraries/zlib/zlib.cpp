@@ -1,15 +1,20 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <stop_token>
+#include <thread>
 #include <unordered_map>
 #include <queue>
 #include <zlib.h>
 
 #include "common/logging/log.h"
 #include "common/thread.h"
+#include "core/debug_state.h"
 #include "core/libraries/kernel/threads.h"
 #include "core/libraries/libs.h"
 #include "core/libraries/zlib/zlib_error.h"
@@ -30,7 +35,10 @@ struct InflateResult {
     s32 status;
 };
 
-static Kernel::Thread task_thread;
+/// Tasks are independent, so they are inflated by a pool of threads sized from the host cores.
+constexpr u32 MaxTaskThreads = 8;
+static std::array<Kernel::Thread, MaxTaskThreads> task_threads;
+static u32 num_task_threads;
 
 static std::mutex mutex;
 static std::queue<InflateTask> task_queue;
@@ -40,6 +48,10 @@ static std::condition_variable_any done_queue_cv;
 static std::unordered_map<u64, InflateResult> results;
 static u64 next_request_id;
 
+static bool IsInitialized() {
+    return task_threads[0].Joinable();
+}
+
 void ZlibTaskThread(const std::stop_token& stop) {
     Common::SetCurrentThreadName("shadPS4:ZlibTaskThread");
 
@@ -55,9 +67,16 @@ void ZlibTaskThread(const std::stop_token& stop) {
             task_queue.pop();
         }
 
+        const auto start = std::chrono::steady_clock::now();
         uLongf decompressed_length = task.dst_length;
         const auto ret = uncompress(static_cast<Bytef*>(task.dst), &decompressed_length,
                                     static_cast<const Bytef*>(task.src), task.src_length);
+        DebugState.zlib_inflated_bytes.fetch_add(decompressed_length, std::memory_order_relaxed);
+        DebugState.zlib_inflate_ns.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                 start)
+                .count(),
+            std::memory_order_relaxed);
 
         {
             // Lock, insert the new result, and push the finished request ID to the done queue.
@@ -76,7 +95,7 @@ void ZlibTaskThread(const std::stop_token& stop) {
 
 s32 PS4_SYSV_ABI sceZlibInitialize(const void* buffer, u32 length) {
     LOG_INFO(Lib_Zlib, "called");
-    if (task_thread.Joinable()) {
+    if (IsInitialized()) {
         return ORBIS_ZLIB_ERROR_ALREADY_INITIALIZED;
     }
 
@@ -86,14 +105,19 @@ s32 PS4_SYSV_ABI sceZlibInitialize(const void* buffer, u32 length) {
     results.clear();
     next_request_id = 1;
 
-    task_thread.Run([](const std::stop_token& stop) { ZlibTaskThread(stop); });
+    // Leave cores to the game threads that queue the tasks
+    num_task_threads = std::clamp(std::thread::hardware_concurrency() / 2, 1u, MaxTaskThreads);
+    for (u32 i = 0; i < num_task_threads; ++i) {
+        task_threads[i].Run([](const std::stop_token& stop) { ZlibTaskThread(stop); });
+    }
+    LOG_INFO(Lib_Zlib, "Inflating on {} threads", num_task_threads);
     return ORBIS_OK;
 }
 
 s32 PS4_SYSV_ABI sceZlibInflate(const void* src, u32 src_len, void* dst, u32 dst_len,
                                 u64* request_id) {
     LOG_DEBUG(Lib_Zlib, "(STUBBED) called");
-    if (!task_thread.Joinable()) {
+    if (!IsInitialized()) {
         return ORBIS_ZLIB_ERROR_NOT_INITIALIZED;
     }
     if (!src || !src_len || !dst || !dst_len || !request_id || dst_len > 64_KB ||
@@ -118,7 +142,7 @@ s32 PS4_SYSV_ABI sceZlibInflate(const void* src, u32 src_len, void* dst, u32 dst
 
 s32 PS4_SYSV_ABI sceZlibWaitForDone(u64* request_id, const u32* timeout) {
     LOG_DEBUG(Lib_Zlib, "(STUBBED) called");
-    if (!task_thread.Joinable()) {
+    if (!IsInitialized()) {
         return ORBIS_ZLIB_ERROR_NOT_INITIALIZED;
     }
     if (!request_id) {
@@ -144,7 +168,7 @@ s32 PS4_SYSV_ABI sceZlibWaitForDone(u64* request_id, const u32* timeout) {
 
 s32 PS4_SYSV_ABI sceZlibGetResult(const u64 request_id, u32* dst_length, s32* status) {
     LOG_DEBUG(Lib_Zlib, "(STUBBED) called");
-    if (!task_thread.Joinable()) {
+    if (!IsInitialized()) {
         return ORBIS_ZLIB_ERROR_NOT_INITIALIZED;
     }
     if (!dst_length || !status) {
@@ -165,10 +189,18 @@ s32 PS4_SYSV_ABI sceZlibGetResult(const u64 request_id, u32* dst_length, s32* st
 
 s32 PS4_SYSV_ABI sceZlibFinalize() {
     LOG_INFO(Lib_Zlib, "called");
-    if (!task_thread.Joinable()) {
+    if (!IsInitialized()) {
         return ORBIS_ZLIB_ERROR_NOT_INITIALIZED;
     }
-    task_thread.Stop();
+    for (u32 i = 0; i < num_task_threads; ++i) {
+        task_threads[i].Stop();
+    }
+    const u64 inflate_ns = DebugState.zlib_inflate_ns.load();
+    if (inflate_ns != 0) {
+        LOG_INFO(Lib_Zlib, "Inflated {} bytes at {:.1f} MB/s per thread",
+                 DebugState.zlib_inflated_bytes.load(),
+                 DebugState.zlib_inflated_bytes.load() * 1000.0 / inflate_ns);
+    }
     return ORBIS_OK;
 }
 
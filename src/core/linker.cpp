@@ -1,6 +1,12 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <array>
+#include <thread>
+#ifdef ARCH_X86_64
+#include <xbyak/xbyak.h>
+#endif
 #include "common/alignment.h"
 #include "common/arch.h"
 #include "common/assert.h"
@@ -8,8 +14,10 @@
 #include "common/elf_info.h"
 #include "common/logging/log.h"
 #include "common/path_util.h"
+#include "common/singleton.h"
 #include "common/string_util.h"
 #include "common/thread.h"
+#include "common/thread_worker.h"
 #include "core/aerolib/aerolib.h"
 #include "core/aerolib/stubs.h"
 #include "core/devtools/widget/module_list.h"
@@ -18,6 +26,7 @@
 #include "core/libraries/kernel/threads.h"
 #include "core/linker.h"
 #include "core/memory.h"
+#include "core/thread.h"
 #include "core/tls.h"
 #include "ipc/ipc.h"
 
@@ -51,6 +60,28 @@ static PS4_SYSV_ABI void* RunMainEntry [[noreturn]] (EntryParams* params) {
 }
 #endif
 
+#ifdef ARCH_X86_64
+static PS4_SYSV_ABI VAddr LazyBindResolver(Module* module, u64 index) {
+    return Common::Singleton<Linker>::Instance()->BindJumpSlot(module, static_cast<u32>(index));
+}
+#endif
+
+/// Size of the stub of a jump slot, a push of its index and a jump to the resolver.
+static constexpr u64 LazyBindStubSize = 10;
+
+static Loader::SymbolType GetSymbolType(u8 sym_type) {
+    switch (sym_type) {
+    case STT_FUN:
+        return Loader::SymbolType::Function;
+    case STT_OBJECT:
+        return Loader::SymbolType::Object;
+    case STT_NOTYPE:
+        return Loader::SymbolType::NoType;
+    default:
+        UNREACHABLE_MSG("unknown symbol type {}", sym_type);
+    }
+}
+
 Linker::Linker() : memory{Memory::Instance()} {}
 
 Linker::~Linker() = default;
@@ -64,9 +95,18 @@ void Linker::Execute(const std::vector<std::string>& args) {
     Module* module = m_modules[0].get();
     static_tls_size = module->tls.offset = module->tls.image_size;
 
-    // Relocate all modules
-    for (const auto& m : m_modules) {
-        Relocate(m.get());
+    // Patching and relocating a module only writes to its own memory and reads the symbols of
+    // the others, so all of them are done in parallel. Initializers still run in load order.
+    {
+        const u32 num_workers = std::max(1u, std::thread::hardware_concurrency());
+        Common::ThreadWorker workers{num_workers, "ModuleLoader"};
+        for (const auto& m : m_modules) {
+            workers.QueueWork([this, module = m.get()] {
+                module->PatchSegments();
+                Relocate(module);
+            });
+        }
+        workers.WaitForRequests();
     }
 
     // Configure the direct and flexible memory regions.
@@ -106,6 +146,7 @@ void Linker::Execute(const std::vector<std::string>& args) {
 
     main_thread.Run([this, module, &args](std::stop_token) {
         Common::SetCurrentThreadName("GAME_MainThread");
+        Core::PinCurrentThreadToGuestCores();
         if (auto& ipc = IPC::Instance()) {
             ipc.WaitForStart();
         }
@@ -153,6 +194,10 @@ s32 Linker::LoadModule(const std::filesystem::path& elf_name, bool is_dynamic) {
         return -1;
     }
 
+    if (is_dynamic) {
+        // Static modules are patched together when execution starts
+        module->PatchSegments();
+    }
     num_static_modules += !is_dynamic;
     m_modules.emplace_back(std::move(module));
 
@@ -201,6 +246,8 @@ Module* Linker::FindByAddress(VAddr address) {
 }
 
 void Linker::Relocate(Module* module) {
+    const bool lazy_bind = Config::isLazyImportBindingEnabled() &&
+                           (module->lazy_bind_stubs != 0 || GenerateLazyBindStubs(module));
     module->ForEachRelocation([&](elf_relocation* rel, u32 i, bool is_jmp_rel) {
         const u32 num_relocs = module->dynamic_info.relocation_table_size / sizeof(elf_relocation);
         const u32 bit_idx = (is_jmp_rel ? num_relocs : 0) + i;
@@ -215,6 +262,16 @@ void Linker::Relocate(Module* module) {
 
         const VAddr rel_base_virtual_addr = module->GetBaseAddress();
         const VAddr rel_virtual_addr = rel_base_virtual_addr + rel->rel_offset;
+
+        // Imports called through the PLT are resolved by BindJumpSlot on their first call.
+        if (lazy_bind && is_jmp_rel && type == R_X86_64_JUMP_SLOT) {
+            const u8 bind = symbol_table[symbol].GetBind();
+            if (bind == STB_GLOBAL || bind == STB_WEAK) {
+                const VAddr stub = module->lazy_bind_stubs + i * LazyBindStubSize;
+                std::memcpy(reinterpret_cast<void*>(rel_virtual_addr), &stub, sizeof(stub));
+                return;
+            }
+        }
         bool rel_is_resolved = false;
         u64 rel_value = 0;
         Loader::SymbolType rel_sym_type = Loader::SymbolType::Unknown;
@@ -242,19 +299,7 @@ void Linker::Relocate(Module* module) {
             auto sym_visibility = sym.GetVisibility();
             u64 symbol_virtual_addr = 0;
             Loader::SymbolRecord symrec{};
-            switch (sym_type) {
-            case STT_FUN:
-                rel_sym_type = Loader::SymbolType::Function;
-                break;
-            case STT_OBJECT:
-                rel_sym_type = Loader::SymbolType::Object;
-                break;
-            case STT_NOTYPE:
-                rel_sym_type = Loader::SymbolType::NoType;
-                break;
-            default:
-                ASSERT_MSG(0, "unknown symbol type {}", sym_type);
-            }
+            rel_sym_type = GetSymbolType(sym_type);
 
             if (sym_visibility != 0) {
                 LOG_INFO(Core_Linker, "symbol visibility !=0");
@@ -303,6 +348,88 @@ const Module* Linker::FindExportedModule(const ModuleInfo& module, const Library
     return it == m_modules.end() ? nullptr : it->get();
 }
 
+VAddr Linker::BindJumpSlot(Module* module, u32 index) {
+    std::scoped_lock lk{mutex};
+    const auto& dynamic_info = module->dynamic_info;
+    const elf_relocation& rel = dynamic_info.jmp_relocation_table[index];
+    auto* slot = reinterpret_cast<VAddr*>(module->GetBaseAddress() + rel.rel_offset);
+    const u32 num_relocs = dynamic_info.relocation_table_size / sizeof(elf_relocation);
+    if (module->TestRelaBit(num_relocs + index)) {
+        // Another thread called it first
+        return *slot;
+    }
+
+    const auto& sym = dynamic_info.symbol_table[rel.GetSymbol()];
+    Loader::SymbolRecord symrec{};
+    if (Resolve(dynamic_info.str_table + sym.st_name, GetSymbolType(sym.GetType()), module,
+                &symrec)) {
+        module->SetRelaBit(num_relocs + index);
+    }
+    // Stubs for unresolved imports are patched in too, they are replaced when a module exporting
+    // the symbol is loaded later.
+    *slot = symrec.virtual_address;
+    return symrec.virtual_address;
+}
+
+bool Linker::GenerateLazyBindStubs(Module* module) {
+#ifdef ARCH_X86_64
+    using namespace Xbyak::util;
+    const u32 num_slots = module->dynamic_info.jmp_relocation_table_size / sizeof(elf_relocation);
+    if (num_slots == 0 || module->lazy_bind_area_size == 0) {
+        return false;
+    }
+    Xbyak::CodeGenerator c(module->lazy_bind_area_size,
+                           reinterpret_cast<void*>(module->lazy_bind_area));
+
+    // Entered with the index of the slot pushed over the return address of the guest call.
+    // Argument registers are kept, and the index is replaced with the bound address, so the
+    // return jumps to it with the stack the guest called the import with.
+    const std::array<Xbyak::Reg64, 9> saved_regs = {rdi, rsi, rdx, rcx, r8, r9, rax, r10, r11};
+    constexpr u32 NumArgXmms = 8;
+    constexpr u32 XmmFrameSize = NumArgXmms * 16 + 8; // Aligns the stack for the call
+    const u32 index_offset = XmmFrameSize + static_cast<u32>(saved_regs.size()) * 8;
+    const void* resolver = c.getCurr();
+    for (const auto& reg : saved_regs) {
+        c.push(reg);
+    }
+    c.sub(rsp, XmmFrameSize);
+    for (u32 i = 0; i < NumArgXmms; ++i) {
+        c.movdqu(ptr[rsp + i * 16], Xbyak::Xmm(i));
+    }
+    c.mov(rdi, reinterpret_cast<u64>(module));
+    c.mov(rsi, qword[rsp + index_offset]);
+    c.mov(rax, reinterpret_cast<u64>(&LazyBindResolver));
+    c.call(rax);
+    c.mov(qword[rsp + index_offset], rax);
+    for (u32 i = 0; i < NumArgXmms; ++i) {
+        c.movdqu(Xbyak::Xmm(i), ptr[rsp + i * 16]);
+    }
+    c.add(rsp, XmmFrameSize);
+    for (auto it = saved_regs.rbegin(); it != saved_regs.rend(); ++it) {
+        c.pop(*it);
+    }
+    c.ret();
+    c.align(16);
+
+    if (c.getSize() + num_slots * LazyBindStubSize > module->lazy_bind_area_size) {
+        LOG_WARNING(Core_Linker, "Module {} has too many jump slots to bind lazily",
+                    module->name);
+        module->lazy_bind_area_size = 0;
+        return false;
+    }
+    const u8* stubs = c.getCurr();
+    for (u32 i = 0; i < num_slots; ++i) {
+        c.push(dword, i);
+        c.jmp(resolver, Xbyak::CodeGenerator::T_NEAR);
+    }
+    ASSERT(c.getCurr() == stubs + num_slots * LazyBindStubSize);
+    module->lazy_bind_stubs = reinterpret_cast<VAddr>(stubs);
+    return true;
+#else
+    return false;
+#endif
+}
+
 bool Linker::Resolve(const std::string& name, Loader::SymbolType sym_type, Module* m,
                      Loader::SymbolRecord* return_info) {
     const auto ids = Common::SplitString(name, '#');
@@ -355,17 +482,25 @@ bool Linker::Resolve(const std::string& name, Loader::SymbolType sym_type, Modul
 }
 
 void* Linker::TlsGetAddr(u64 module_index, u64 offset) {
-    std::scoped_lock lk{mutex};
-
+    // The DTV is only ever changed by the thread owning it, so once it is current and holds the
+    // block of the module there is nothing to lock.
     DtvEntry* dtv_table = GetTcbBase()->tcb_dtv;
-    if (dtv_table[0].counter != dtv_generation_counter) {
+    if (dtv_table[0].counter == dtv_generation_counter.load(std::memory_order_acquire)) {
+        if (u8* addr = dtv_table[module_index + 1].pointer) [[likely]] {
+            return addr + offset;
+        }
+    }
+
+    std::scoped_lock lk{mutex};
+    const u32 generation = dtv_generation_counter.load(std::memory_order_acquire);
+    if (dtv_table[0].counter != generation) {
         // Generation counter changed, a dynamic module was either loaded or unloaded.
         const u32 old_num_dtvs = dtv_table[1].counter;
         ASSERT_MSG(max_tls_index > old_num_dtvs, "Module unloading unsupported");
         // Module was loaded, increase DTV table size.
         DtvEntry* new_dtv_table = new DtvEntry[max_tls_index + 2]{};
         std::memcpy(new_dtv_table + 2, dtv_table + 2, old_num_dtvs * sizeof(DtvEntry));
-        new_dtv_table[0].counter = dtv_generation_counter;
+        new_dtv_table[0].counter = generation;
         new_dtv_table[1].counter = max_tls_index;
         delete[] dtv_table;
 
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <mutex>
 #include <vector>
 #include "core/libraries/kernel/threads.h"
@@ -103,7 +104,7 @@ public:
     }
 
     u32 GenerationCounter() const {
-        return dtv_generation_counter;
+        return dtv_generation_counter.load(std::memory_order_acquire);
     }
 
     size_t StaticTlsSize() const noexcept {
@@ -138,7 +139,8 @@ public:
     }
 
     void AdvanceGenerationCounter() noexcept {
-        dtv_generation_counter++;
+        // Released so that a thread seeing the new counter also sees the module behind it
+        dtv_generation_counter.fetch_add(1, std::memory_order_release);
     }
 
     void* TlsGetAddr(u64 module_index, u64 offset);
@@ -151,6 +153,9 @@ public:
     Module* FindByAddress(VAddr address);
 
     void Relocate(Module* module);
+    /// Resolves a jump slot of the module left for lazy binding and patches it. Returns the
+    /// address the slot now points to.
+    VAddr BindJumpSlot(Module* module, u32 index);
     bool Resolve(const std::string& name, Loader::SymbolType type, Module* module,
                  Loader::SymbolRecord* return_info);
     void Execute(const std::vector<std::string>& args = {});
@@ -158,11 +163,12 @@ public:
 
 private:
     const Module* FindExportedModule(const ModuleInfo& m, const LibraryInfo& l);
+    bool GenerateLazyBindStubs(Module* module);
 
     MemoryManager* memory;
     Libraries::Kernel::Thread main_thread;
     std::mutex mutex;
-    u32 dtv_generation_counter{1};
+    std::atomic<u32> dtv_generation_counter{1};
     size_t static_tls_size{};
     u32 max_tls_index{};
     u32 num_static_modules{};
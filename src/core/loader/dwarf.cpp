@@ -134,4 +134,46 @@ bool DecodeEHHdr(uintptr_t ehHdrStart, uintptr_t ehHdrEnd, EHHeaderInfo& ehHdrIn
     return true;
 }
 
+uintptr_t FindFunctionStart(uintptr_t ehHdrStart, const EHHeaderInfo& ehHdrInfo, uintptr_t pc) {
+    // The table is sorted by initial location, each entry holds it and the address of the FDE
+    size_t entrySize;
+    switch (ehHdrInfo.table_enc & 0x0F) {
+    case DW_EH_PE_udata2:
+    case DW_EH_PE_sdata2:
+        entrySize = 2 * sizeof(u16);
+        break;
+    case DW_EH_PE_udata4:
+    case DW_EH_PE_sdata4:
+        entrySize = 2 * sizeof(u32);
+        break;
+    case DW_EH_PE_ptr:
+    case DW_EH_PE_udata8:
+    case DW_EH_PE_sdata8:
+        entrySize = 2 * sizeof(u64);
+        break;
+    default:
+        return 0;
+    }
+    const u8 relative = ehHdrInfo.table_enc & 0x70;
+    if (relative != DW_EH_PE_absptr && relative != DW_EH_PE_pcrel && relative != DW_EH_PE_datarel) {
+        return 0;
+    }
+
+    const auto initialLocation = [&](size_t index) {
+        uintptr_t p = ehHdrInfo.table + index * entrySize;
+        return getEncodedP(p, p + entrySize, ehHdrInfo.table_enc, ehHdrStart);
+    };
+    size_t low = 0;
+    size_t high = ehHdrInfo.fde_count;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (initialLocation(mid) <= pc) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low == 0 ? 0 : initialLocation(low - 1);
+}
+
 } // namespace Dwarf
@@ -38,4 +38,8 @@ struct EHHeaderInfo {
 
 bool DecodeEHHdr(uintptr_t ehHdrStart, uintptr_t ehHdrEnd, EHHeaderInfo& ehHdrInfo);
 
+/// Searches the table of the EH frame header for the last function starting at or before pc.
+/// Returns 0 when pc is before the first function or the table has an unsupported encoding.
+uintptr_t FindFunctionStart(uintptr_t ehHdrStart, const EHHeaderInfo& ehHdrInfo, uintptr_t pc);
+
 } // namespace Dwarf
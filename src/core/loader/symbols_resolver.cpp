@@ -10,8 +10,24 @@
 
 namespace Core::Loader {
 
+void SymbolsResolver::Reserve(size_t num_symbols) {
+    m_symbols.reserve(m_symbols.size() + num_symbols);
+    m_index.reserve(m_index.size() + num_symbols);
+}
+
 void SymbolsResolver::AddSymbol(const SymbolResolver& s, u64 virtual_addr) {
-    m_symbols.emplace_back(GenerateName(s), s.nidName, virtual_addr);
+    const auto& record = m_symbols.emplace_back(GenerateName(s), s.nidName, virtual_addr);
+    m_index.try_emplace(record.name, m_symbols.size() - 1);
+}
+
+void SymbolsResolver::Merge(SymbolsResolver&& other) {
+    Reserve(other.m_symbols.size());
+    for (auto& record : other.m_symbols) {
+        const auto& moved = m_symbols.emplace_back(std::move(record));
+        m_index.try_emplace(moved.name, m_symbols.size() - 1);
+    }
+    other.m_symbols.clear();
+    other.m_index.clear();
 }
 
 std::string SymbolsResolver::GenerateName(const SymbolResolver& s) {
@@ -20,11 +36,9 @@ std::string SymbolsResolver::GenerateName(const SymbolResolver& s) {
 }
 
 const SymbolRecord* SymbolsResolver::FindSymbol(const SymbolResolver& s) const {
-    const std::string name = GenerateName(s);
-    for (u32 i = 0; i < m_symbols.size(); i++) {
-        if (m_symbols[i].name == name) {
-            return &m_symbols[i];
-        }
+    const auto it = m_index.find(GenerateName(s));
+    if (it != m_index.end()) {
+        return &m_symbols[it->second];
     }
 
     // LOG_INFO(Core_Linker, "Unresolved! {}", name);
@@ -6,6 +6,7 @@
 #include <filesystem>
 #include <span>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "common/assert.h"
 #include "common/types.h"
@@ -40,7 +41,10 @@ public:
     SymbolsResolver() = default;
     virtual ~SymbolsResolver() = default;
 
+    void Reserve(size_t num_symbols);
     void AddSymbol(const SymbolResolver& s, u64 virtual_addr);
+    /// Appends the symbols of other, names already known keep resolving to the existing ones.
+    void Merge(SymbolsResolver&& other);
     const SymbolRecord* FindSymbol(const SymbolResolver& s) const;
 
     void DebugDump(const std::filesystem::path& file_name);
@@ -74,6 +78,8 @@ public:
 
 private:
     std::vector<SymbolRecord> m_symbols;
+    /// Index into m_symbols of the first symbol with a given name.
+    std::unordered_map<std::string, size_t> m_index;
 };
 
 } // namespace Core::Loader
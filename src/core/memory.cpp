@@ -1,10 +1,12 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/config.h"
 #include "common/debug.h"
+#include "common/perf_counters.h"
 #include "core/file_sys/fs.h"
 #include "core/libraries/kernel/memory.h"
 #include "core/libraries/kernel/orbis_error.h"
@@ -14,7 +16,15 @@
 
 namespace Core {
 
+/// Set while the thread runs a batch of mappings, see BeginGpuMapBatch.
+static thread_local bool is_batching_gpu_maps = false;
+
 MemoryManager::MemoryManager() {
+    if (const int prefault_mbytes = Config::getPrefaultMemoryMbytes(); prefault_mbytes > 0) {
+        prefault_threshold = prefault_mbytes * 1_MB;
+        prefault_worker = std::make_unique<Common::ThreadWorker>(1, "MemoryPrefault");
+    }
+
     LOG_INFO(Kernel_Vmm, "Virtual memory space initialized with regions:");
 
     // Construct vma_map using the regions reserved by the address space
@@ -112,6 +122,16 @@ void MemoryManager::SetPrtArea(u32 id, VAddr address, u64 size) {
     rasterizer->MapMemory(address, size);
 }
 
+void MemoryManager::BeginGpuMapBatch() {
+    is_batching_gpu_maps = true;
+}
+
+void MemoryManager::EndGpuMapBatch() {
+    is_batching_gpu_maps = false;
+    std::scoped_lock lk{mutex};
+    FlushGpuMaps();
+}
+
 void MemoryManager::CopySparseMemory(VAddr virtual_addr, u8* dest, u64 size) {
     ASSERT_MSG(IsValidMapping(virtual_addr), "Attempted to access invalid address {:#x}",
                virtual_addr);
@@ -131,6 +151,23 @@ void MemoryManager::CopySparseMemory(VAddr virtual_addr, u8* dest, u64 size) {
     }
 }
 
+bool MemoryManager::IsRangeMapped(VAddr virtual_addr, u64 size) {
+    if (!IsValidMapping(virtual_addr, size)) {
+        return false;
+    }
+    auto vma = FindVMA(virtual_addr);
+    while (size) {
+        if (!vma->second.IsMapped()) {
+            return false;
+        }
+        const u64 range_size = std::min<u64>(vma->second.size - (virtual_addr - vma->first), size);
+        size -= range_size;
+        virtual_addr += range_size;
+        ++vma;
+    }
+    return true;
+}
+
 bool MemoryManager::TryWriteBacking(void* address, const void* data, u32 num_bytes) {
     const VAddr virtual_addr = std::bit_cast<VAddr>(address);
     ASSERT_MSG(IsValidMapping(virtual_addr, num_bytes), "Attempted to access invalid address {:#x}",
@@ -148,29 +185,10 @@ PAddr MemoryManager::PoolExpand(PAddr search_start, PAddr search_end, u64 size,
     std::scoped_lock lk{mutex};
     alignment = alignment > 0 ? alignment : 64_KB;
 
-    auto dmem_area = FindDmemArea(search_start);
-    auto mapping_start = search_start > dmem_area->second.base
-                             ? Common::AlignUp(search_start, alignment)
-                             : Common::AlignUp(dmem_area->second.base, alignment);
-    auto mapping_end = mapping_start + size;
-
-    // Find the first free, large enough dmem area in the range.
-    while (dmem_area->second.dma_type != DMAType::Free ||
-           dmem_area->second.GetEnd() < mapping_end) {
-        // The current dmem_area isn't suitable, move to the next one.
-        dmem_area++;
-        if (dmem_area == dmem_map.end()) {
-            break;
-        }
-
-        // Update local variables based on the new dmem_area
-        mapping_start = Common::AlignUp(dmem_area->second.base, alignment);
-        mapping_end = mapping_start + size;
-    }
-
+    PAddr mapping_start{};
+    const auto dmem_area =
+        FindFreeDmemArea(search_start, search_end, size, alignment, mapping_start);
     if (dmem_area == dmem_map.end()) {
-        // There are no suitable mappings in this range
-        LOG_ERROR(Kernel_Vmm, "Unable to find free direct memory area: size = {:#x}", size);
         return -1;
     }
 
@@ -190,29 +208,10 @@ PAddr MemoryManager::Allocate(PAddr search_start, PAddr search_end, u64 size, u6
     std::scoped_lock lk{mutex};
     alignment = alignment > 0 ? alignment : 16_KB;
 
-    auto dmem_area = FindDmemArea(search_start);
-    auto mapping_start = search_start > dmem_area->second.base
-                             ? Common::AlignUp(search_start, alignment)
-                             : Common::AlignUp(dmem_area->second.base, alignment);
-    auto mapping_end = mapping_start + size;
-
-    // Find the first free, large enough dmem area in the range.
-    while (dmem_area->second.dma_type != DMAType::Free ||
-           dmem_area->second.GetEnd() < mapping_end) {
-        // The current dmem_area isn't suitable, move to the next one.
-        dmem_area++;
-        if (dmem_area == dmem_map.end()) {
-            break;
-        }
-
-        // Update local variables based on the new dmem_area
-        mapping_start = Common::AlignUp(dmem_area->second.base, alignment);
-        mapping_end = mapping_start + size;
-    }
-
+    PAddr mapping_start{};
+    const auto dmem_area =
+        FindFreeDmemArea(search_start, search_end, size, alignment, mapping_start);
     if (dmem_area == dmem_map.end()) {
-        // There are no suitable mappings in this range
-        LOG_ERROR(Kernel_Vmm, "Unable to find free direct memory area: size = {:#x}", size);
         return -1;
     }
 
@@ -349,15 +348,17 @@ s32 MemoryManager::PoolCommit(VAddr virtual_addr, u64 size, MemoryProt prot, s32
         // Perform the mapping
         void* out_addr = impl.Map(current_addr, size_to_map, alignment, new_vma.phys_base, false);
         TRACK_ALLOC(out_addr, size_to_map, "VMEM");
+        PrefaultBacking(new_vma.phys_base, size_to_map);
 
         current_addr += size_to_map;
         remaining_size -= size_to_map;
         handle++;
     }
     ASSERT_MSG(remaining_size == 0, "Unable to map physical memory");
+    Common::CountPerf(Common::PerfCounter::MemoryMapBytes, size);
 
     if (IsValidGpuMapping(mapped_addr, size)) {
-        rasterizer->MapMemory(mapped_addr, size);
+        NotifyGpuMap(mapped_addr, size);
     }
 
     return ORBIS_OK;
@@ -531,11 +532,15 @@ s32 MemoryManager::MapMemory(void** out_addr, VAddr virtual_addr, u64 size, Memo
     } else {
         // If this is not a reservation, then map to GPU and address space
         if (IsValidGpuMapping(mapped_addr, size)) {
-            rasterizer->MapMemory(mapped_addr, size);
+            NotifyGpuMap(mapped_addr, size);
         }
         *out_addr = impl.Map(mapped_addr, size, alignment, phys_addr, is_exec);
 
         TRACK_ALLOC(*out_addr, size, "VMEM");
+        Common::CountPerf(Common::PerfCounter::MemoryMapBytes, size);
+        if (type == VMAType::Flexible) {
+            PrefaultBacking(phys_addr, size);
+        }
     }
 
     return ORBIS_OK;
@@ -611,6 +616,7 @@ s32 MemoryManager::MapFile(void** out_addr, VAddr virtual_addr, u64 size, Memory
     new_vma.name = "File";
     new_vma.fd = fd;
     new_vma.type = VMAType::File;
+    Common::CountPerf(Common::PerfCounter::MemoryMapBytes, size);
 
     *out_addr = std::bit_cast<void*>(mapped_addr);
     return ORBIS_OK;
@@ -644,6 +650,7 @@ s32 MemoryManager::PoolDecommit(VAddr virtual_addr, u64 size) {
         if (vma_base.type == VMAType::Pooled) {
             // We always map PoolCommitted memory to GPU, so unmap when decomitting.
             if (IsValidGpuMapping(current_addr, size_in_vma)) {
+                FlushGpuMaps();
                 rasterizer->UnmapMemory(current_addr, size_in_vma);
             }
 
@@ -658,6 +665,9 @@ s32 MemoryManager::PoolDecommit(VAddr virtual_addr, u64 size) {
 
             // Coalesce with nearby direct memory areas.
             MergeAdjacent(dmem_map, new_dmem_handle);
+
+            // Nothing is expected of the contents once decommitted, let the host reclaim them.
+            impl.Discard(unmap_phys_base, size_in_vma);
         }
 
         if (vma_base.type != VMAType::PoolReserved) {
@@ -665,6 +675,7 @@ s32 MemoryManager::PoolDecommit(VAddr virtual_addr, u64 size) {
             impl.Unmap(vma_base.base, vma_base.size, start_in_vma, start_in_vma + size_in_vma,
                        vma_base.phys_base, vma_base.is_exec, true, false);
             TRACK_FREE(virtual_addr, "VMEM");
+            Common::CountPerf(Common::PerfCounter::MemoryUnmapBytes, size_in_vma);
         }
 
         // Mark region as pool reserved and attempt to coalesce it with neighbours.
@@ -738,14 +749,17 @@ u64 MemoryManager::UnmapBytesFromEntry(VAddr virtual_addr, VirtualMemoryArea vma
     if (type == VMAType::Flexible) {
         flexible_usage -= adjusted_size;
 
-        // Now that there is a physical backing used for flexible memory,
-        // manually erase the contents before unmapping to prevent possible issues.
-        const auto unmap_hardware_address = impl.BackingBase() + phys_base + start_in_vma;
-        std::memset(unmap_hardware_address, 0, adjusted_size);
-
         // Address space unmap needs the physical_base from the start of the vma,
         // so calculate the phys_base to unmap from here.
         const auto unmap_phys_base = phys_base + start_in_vma;
+
+        // Now that there is a physical backing used for flexible memory, erase the contents
+        // before unmapping to prevent possible issues. Releasing the host pages does that
+        // without touching the ones the game never used.
+        if (!impl.Discard(unmap_phys_base, adjusted_size)) {
+            const auto unmap_hardware_address = impl.BackingBase() + unmap_phys_base;
+            std::memset(unmap_hardware_address, 0, adjusted_size);
+        }
         const auto new_fmem_handle = CarveFmemArea(unmap_phys_base, adjusted_size);
         auto& new_fmem_area = new_fmem_handle->second;
         new_fmem_area.is_free = true;
@@ -765,6 +779,7 @@ u64 MemoryManager::UnmapBytesFromEntry(VAddr virtual_addr, VirtualMemoryArea vma
     if (type != VMAType::Reserved && type != VMAType::PoolReserved) {
         // If this mapping has GPU access, unmap from GPU.
         if (IsValidGpuMapping(virtual_addr, size)) {
+            FlushGpuMaps();
             rasterizer->UnmapMemory(virtual_addr, size);
         }
 
@@ -772,6 +787,7 @@ u64 MemoryManager::UnmapBytesFromEntry(VAddr virtual_addr, VirtualMemoryArea vma
         impl.Unmap(vma_base_addr, vma_base_size, start_in_vma, start_in_vma + adjusted_size,
                    phys_base, is_exec, has_backing, readonly_file);
         TRACK_FREE(virtual_addr, "VMEM");
+        Common::CountPerf(Common::PerfCounter::MemoryUnmapBytes, adjusted_size);
     }
     return adjusted_size;
 }
@@ -792,7 +808,7 @@ s32 MemoryManager::UnmapMemoryImpl(VAddr virtual_addr, u64 size) {
 
 s32 MemoryManager::QueryProtection(VAddr addr, void** start, void** end, u32* prot) {
     ASSERT_MSG(IsValidMapping(addr), "Attempted to access invalid address {:#x}", addr);
-    std::scoped_lock lk{mutex};
+    std::shared_lock lk{mutex};
 
     const auto it = FindVMA(addr);
     const auto& vma = it->second;
@@ -909,7 +925,7 @@ s32 MemoryManager::Protect(VAddr addr, u64 size, MemoryProt prot) {
 
 s32 MemoryManager::VirtualQuery(VAddr addr, s32 flags,
                                 ::Libraries::Kernel::OrbisVirtualQueryInfo* info) {
-    std::scoped_lock lk{mutex};
+    std::shared_lock lk{mutex};
 
     // FindVMA on addresses before the vma_map return garbage data.
     auto query_addr =
@@ -962,7 +978,7 @@ s32 MemoryManager::VirtualQuery(VAddr addr, s32 flags,
 
 s32 MemoryManager::DirectMemoryQuery(PAddr addr, bool find_next,
                                      ::Libraries::Kernel::OrbisQueryInfo* out_info) {
-    std::scoped_lock lk{mutex};
+    std::shared_lock lk{mutex};
 
     if (addr >= total_direct_size) {
         LOG_WARNING(Kernel_Vmm, "Unable to find allocated direct memory region to query!");
@@ -997,7 +1013,7 @@ s32 MemoryManager::DirectMemoryQuery(PAddr addr, bool find_next,
 
 s32 MemoryManager::DirectQueryAvailable(PAddr search_start, PAddr search_end, u64 alignment,
                                         PAddr* phys_addr_out, u64* size_out) {
-    std::scoped_lock lk{mutex};
+    std::shared_lock lk{mutex};
 
     auto dmem_area = FindDmemArea(search_start);
     PAddr paddr{};
@@ -1163,7 +1179,7 @@ s32 MemoryManager::IsStack(VAddr addr, void** start, void** end) {
 }
 
 s32 MemoryManager::GetMemoryPoolStats(::Libraries::Kernel::OrbisKernelMemoryPoolBlockStats* stats) {
-    std::scoped_lock lk{mutex};
+    std::shared_lock lk{mutex};
 
     // Run through dmem_map, determine how much physical memory is currently committed
     constexpr u64 block_size = 64_KB;
@@ -1191,6 +1207,83 @@ void MemoryManager::InvalidateMemory(const VAddr addr, const u64 size) const {
     }
 }
 
+MemoryManager::DMemHandle MemoryManager::FindFreeDmemArea(PAddr search_start, PAddr search_end,
+                                                         u64 size, u64 alignment,
+                                                         PAddr& mapping_start) {
+    auto dmem_area = FindDmemArea(search_start);
+    mapping_start = search_start > dmem_area->second.base
+                        ? Common::AlignUp(search_start, alignment)
+                        : Common::AlignUp(dmem_area->second.base, alignment);
+
+    // Find the first free, large enough dmem area in the range. Areas past the end of the range
+    // can't be used, so the search stops there instead of running through the rest of the map.
+    while (mapping_start + size <= search_end) {
+        if (dmem_area->second.dma_type == DMAType::Free &&
+            dmem_area->second.GetEnd() >= mapping_start + size) {
+            return dmem_area;
+        }
+
+        // The current dmem_area isn't suitable, move to the next one.
+        dmem_area++;
+        if (dmem_area == dmem_map.end()) {
+            break;
+        }
+        mapping_start = Common::AlignUp(dmem_area->second.base, alignment);
+    }
+
+    // There are no suitable areas in this range, report how fragmented free memory is.
+    u64 num_free_areas = 0;
+    u64 free_size = 0;
+    u64 largest_free_size = 0;
+    for (const auto& [base, area] : dmem_map) {
+        if (area.dma_type == DMAType::Free) {
+            ++num_free_areas;
+            free_size += area.size;
+            largest_free_size = std::max(largest_free_size, area.size);
+        }
+    }
+    LOG_ERROR(Kernel_Vmm,
+              "Unable to find free direct memory area: size = {:#x}, range = {:#x}-{:#x}, "
+              "free = {:#x} in {} areas, largest = {:#x}",
+              size, search_start, search_end, free_size, num_free_areas, largest_free_size);
+    return dmem_map.end();
+}
+
+void MemoryManager::PrefaultBacking(PAddr phys_addr, u64 size) {
+    if (!prefault_worker || size < prefault_threshold) {
+        return;
+    }
+    // The backing stays mapped for the lifetime of the address space, so a mapping that is gone
+    // by the time this runs only leaves some host pages committed.
+    prefault_worker->QueueWork([this, phys_addr, size] { impl.Populate(phys_addr, size); });
+}
+
+void MemoryManager::NotifyGpuMap(VAddr virtual_addr, u64 size) {
+    if (!is_batching_gpu_maps) {
+        rasterizer->MapMemory(virtual_addr, size);
+        return;
+    }
+    pending_gpu_maps.emplace_back(virtual_addr, size);
+}
+
+void MemoryManager::FlushGpuMaps() {
+    if (pending_gpu_maps.empty()) {
+        return;
+    }
+    std::ranges::sort(pending_gpu_maps);
+    VAddr start = pending_gpu_maps.front().first;
+    VAddr end = start;
+    for (const auto& [addr, size] : pending_gpu_maps) {
+        if (addr > end) {
+            rasterizer->MapMemory(start, end - start);
+            start = addr;
+        }
+        end = std::max(end, addr + size);
+    }
+    rasterizer->MapMemory(start, end - start);
+    pending_gpu_maps.clear();
+}
+
 VAddr MemoryManager::SearchFree(VAddr virtual_addr, u64 size, u32 alignment) {
     // Calculate the minimum and maximum addresses present in our address space.
     auto min_search_address = impl.SystemManagedVirtualBase();
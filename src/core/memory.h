@@ -5,10 +5,14 @@
 
 #include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 #include "common/enum.h"
 #include "common/singleton.h"
+#include "common/thread_worker.h"
 #include "common/types.h"
 #include "core/address_space.h"
 #include "core/libraries/kernel/memory.h"
@@ -245,6 +249,16 @@ public:
 
     void CopySparseMemory(VAddr source, u8* dest, u64 size);
 
+    /// Defers the GPU map notifications of the mappings made by the calling thread until
+    /// EndGpuMapBatch, which sends them merged into contiguous ranges.
+    void BeginGpuMapBatch();
+
+    void EndGpuMapBatch();
+
+    /// Returns true if the whole range is backed by memory. Does not take the mutex, so it can be
+    /// called from the rasterizer mapping callbacks.
+    bool IsRangeMapped(VAddr virtual_addr, u64 size);
+
     bool TryWriteBacking(void* address, const void* data, u32 num_bytes);
 
     void SetupMemoryRegions(u64 flexible_size, bool use_extended_mem1, bool use_extended_mem2);
@@ -335,6 +349,20 @@ private:
 
     VAddr SearchFree(VAddr virtual_addr, u64 size, u32 alignment);
 
+    /// Faults in the backing of a new mapping on the prefault thread if it is large enough.
+    void PrefaultBacking(PAddr phys_addr, u64 size);
+
+    /// Maps a range to the GPU caches, or defers it while the thread runs a batch.
+    void NotifyGpuMap(VAddr virtual_addr, u64 size);
+
+    /// Sends the deferred GPU maps, before anything is unmapped from the GPU.
+    void FlushGpuMaps();
+
+    /// Returns the first free direct memory area that fits size bytes at the given alignment
+    /// within [search_start, search_end), or dmem_map.end() if none does.
+    DMemHandle FindFreeDmemArea(PAddr search_start, PAddr search_end, u64 size, u64 alignment,
+                                PAddr& mapping_start);
+
     VMAHandle CarveVMA(VAddr virtual_addr, u64 size);
 
     DMemHandle CarveDmemArea(PAddr addr, u64 size);
@@ -356,12 +384,15 @@ private:
     DMemMap dmem_map;
     FMemMap fmem_map;
     VMAMap vma_map;
-    std::mutex mutex;
+    std::shared_mutex mutex; ///< Shared by the queries, exclusive for any change to the maps
     u64 total_direct_size{};
     u64 total_flexible_size{};
     u64 flexible_usage{};
     u64 pool_budget{};
+    u64 prefault_threshold{};
+    std::unique_ptr<Common::ThreadWorker> prefault_worker;
     Vulkan::Rasterizer* rasterizer{};
+    std::vector<std::pair<VAddr, u64>> pending_gpu_maps; ///< Protected by the exclusive mutex
 
     struct PrtArea {
         VAddr start;
@@ -0,0 +1,564 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
+
+#include "common/config.h"
+#include "common/elf_info.h"
+#include "common/io_file.h"
+#include "common/logging/log.h"
+#include "common/path_util.h"
+#include "common/perf_counters.h"
+#include "common/thread.h"
+#include "core/debug_state.h"
+#include "core/metrics_sink.h"
+#include "input/input_handler.h"
+#include "video_core/stall_tracker.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+#endif
+
+namespace Core::MetricsSink {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Files are rotated at this size, the previous one is kept with a .1 suffix
+constexpr u64 MaxFileSize = 64_MB;
+
+/// Rows are buffered by the file, flushed at this interval so a monitor tailing it stays current
+constexpr auto FlushInterval = std::chrono::seconds{1};
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+constexpr SocketHandle InvalidSocket = INVALID_SOCKET;
+
+void CloseSocket(SocketHandle socket) {
+    closesocket(socket);
+}
+#else
+using SocketHandle = int;
+constexpr SocketHandle InvalidSocket = -1;
+
+void CloseSocket(SocketHandle socket) {
+    close(socket);
+}
+#endif
+
+struct FrameMetrics {
+    u32 frame;
+    double time_s;
+    double frame_ms;
+    std::optional<double> gpu_ms;
+    bool hitch;
+    u64 rss_bytes;
+    u64 device_bytes;
+    Common::PerfCounterArray counters;
+};
+
+u64 GetResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.WorkingSetSize;
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info{};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info),
+                  &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+#else
+    // Second field of statm is the resident set in pages, read with fd calls as this runs per
+    // frame
+    const int fd = open("/proc/self/statm", O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    char buffer[128]{};
+    const ssize_t size = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (size <= 0) {
+        return 0;
+    }
+    unsigned long long resident_pages{};
+    if (std::sscanf(buffer, "%*u %llu", &resident_pages) != 1) {
+        return 0;
+    }
+    return u64(resident_pages) * static_cast<u64>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+/// Sum of the outermost GPU profiler scopes of the last published frame, if it is a new one
+std::optional<double> ReadGpuFrameTime(u64& last_frame) {
+    std::scoped_lock lock{DebugState.gpu_timings_mutex};
+    const auto& timings = DebugState.gpu_timings;
+    if (timings.frame == last_frame || timings.scopes.empty()) {
+        return std::nullopt;
+    }
+    last_frame = timings.frame;
+    return timings.GetBusyMs();
+}
+
+/// Counter names as column names, "Pipeline binds" becomes "pipeline_binds"
+std::string GetColumnName(Common::PerfCounter counter) {
+    std::string name{Common::GetPerfCounterName(counter)};
+    for (char& c : name) {
+        c = c == ' ' ? '_' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return name;
+}
+
+std::string FormatCsvHeader() {
+    std::string header{"frame,time_s,frame_ms,gpu_ms,hitch,rss_bytes,device_bytes"};
+    for (size_t i = 0; i < static_cast<size_t>(Common::PerfCounter::Count); ++i) {
+        header += ',';
+        header += GetColumnName(static_cast<Common::PerfCounter>(i));
+    }
+    header += '\n';
+    return header;
+}
+
+std::string FormatCsvRow(const FrameMetrics& metrics) {
+    std::string row = fmt::format(
+        "{},{:.6f},{:.3f},{},{},{},{}", metrics.frame, metrics.time_s, metrics.frame_ms,
+        metrics.gpu_ms ? fmt::format("{:.3f}", *metrics.gpu_ms) : "", metrics.hitch ? 1 : 0,
+        metrics.rss_bytes, metrics.device_bytes);
+    for (const u64 value : metrics.counters) {
+        fmt::format_to(std::back_inserter(row), ",{}", value);
+    }
+    row += '\n';
+    return row;
+}
+
+std::string FormatJsonRow(const FrameMetrics& metrics) {
+    std::string row = fmt::format(
+        "{{\"frame\":{},\"time_s\":{:.6f},\"frame_ms\":{:.3f},\"gpu_ms\":{},\"hitch\":{},"
+        "\"rss_bytes\":{},\"device_bytes\":{},\"counters\":{{",
+        metrics.frame, metrics.time_s, metrics.frame_ms,
+        metrics.gpu_ms ? fmt::format("{:.3f}", *metrics.gpu_ms) : "null", metrics.hitch,
+        metrics.rss_bytes, metrics.device_bytes);
+    for (size_t i = 0; i < metrics.counters.size(); ++i) {
+        fmt::format_to(std::back_inserter(row), "{}\"{}\":{}", i == 0 ? "" : ",",
+                       GetColumnName(static_cast<Common::PerfCounter>(i)), metrics.counters[i]);
+    }
+    row += "}}\n";
+    return row;
+}
+
+/// Rows appended to a file of the log directory, moved aside once it reaches MaxFileSize.
+class FileSink {
+public:
+    explicit FileSink(bool csv_) : csv{csv_} {
+        const std::string serial{Common::ElfInfo::Instance().GameSerial()};
+        path = Common::FS::GetUserPath(Common::FS::PathType::LogDir) /
+               fmt::format("{}_metrics.{}", serial.empty() ? "unknown" : serial,
+                           csv ? "csv" : "jsonl");
+        Open();
+    }
+
+    void Write(const FrameMetrics& metrics) {
+        if (!file.IsOpen()) {
+            return;
+        }
+        const std::string row = csv ? FormatCsvRow(metrics) : FormatJsonRow(metrics);
+        file.WriteString(row);
+        size += row.size();
+        const auto now = Clock::now();
+        if (now - last_flush >= FlushInterval) {
+            file.Flush();
+            last_flush = now;
+        }
+        if (size >= MaxFileSize) {
+            Rotate();
+        }
+    }
+
+private:
+    void Open() {
+        file.Open(path, Common::FS::FileAccessMode::Write, Common::FS::FileType::TextFile);
+        if (!file.IsOpen()) {
+            LOG_ERROR(Core, "Failed to open {} for writing", path.string());
+            return;
+        }
+        size = 0;
+        if (csv) {
+            const std::string header = FormatCsvHeader();
+            file.WriteString(header);
+            size += header.size();
+        }
+        LOG_INFO(Core, "Writing per-frame metrics to {}", path.string());
+    }
+
+    void Rotate() {
+        file.Close();
+        auto old_path = path;
+        old_path += ".1";
+        std::error_code ec;
+        std::filesystem::rename(path, old_path, ec);
+        if (ec) {
+            LOG_WARNING(Core, "Failed to rotate {}: {}", path.string(), ec.message());
+        }
+        Open();
+    }
+
+    Common::FS::IOFile file;
+    std::filesystem::path path;
+    u64 size{};
+    Clock::time_point last_flush{};
+    bool csv;
+};
+
+/**
+ * Streams rows to the clients connected to a loopback port. Clients that can't keep up are
+ * dropped rather than blocking the present thread, a partial row would corrupt the stream anyway.
+ */
+class SocketSink {
+public:
+    explicit SocketSink(u16 port) {
+        listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (listener == InvalidSocket) {
+            LOG_ERROR(Core, "Failed to create the metrics socket");
+            return;
+        }
+        const int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse),
+                   sizeof(reuse));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        if (bind(listener, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            listen(listener, 4) != 0) {
+            LOG_ERROR(Core, "Failed to listen for metrics clients on port {}", port);
+            CloseSocket(listener);
+            listener = InvalidSocket;
+            return;
+        }
+        accept_thread =
+            std::jthread{[this](std::stop_token stop_token) { AcceptLoop(stop_token); }};
+        LOG_INFO(Core, "Streaming per-frame metrics to clients of 127.0.0.1:{}", port);
+    }
+
+    ~SocketSink() {
+        accept_thread = {};
+        if (listener != InvalidSocket) {
+            CloseSocket(listener);
+        }
+        for (const SocketHandle client : clients) {
+            CloseSocket(client);
+        }
+    }
+
+    void Write(const FrameMetrics& metrics) {
+        std::scoped_lock lock{clients_mutex};
+        if (clients.empty()) {
+            return;
+        }
+        const std::string row = FormatJsonRow(metrics);
+        std::erase_if(clients, [&](SocketHandle client) {
+            if (Send(client, row)) {
+                return false;
+            }
+            LOG_INFO(Core, "Metrics client disconnected or fell behind");
+            CloseSocket(client);
+            return true;
+        });
+    }
+
+private:
+    static bool Send(SocketHandle client, const std::string& row) {
+#ifdef _WIN32
+        const int sent = send(client, row.data(), static_cast<int>(row.size()), 0);
+#elif defined(__APPLE__)
+        const ssize_t sent = send(client, row.data(), row.size(), 0);
+#else
+        const ssize_t sent = send(client, row.data(), row.size(), MSG_NOSIGNAL);
+#endif
+        return sent >= 0 && static_cast<size_t>(sent) == row.size();
+    }
+
+    void AcceptLoop(std::stop_token stop_token) {
+        Common::SetCurrentThreadName("shadPS4:MetricsSink");
+        while (!stop_token.stop_requested()) {
+#ifdef _WIN32
+            WSAPOLLFD fd{listener, POLLRDNORM, 0};
+            if (WSAPoll(&fd, 1, 200) <= 0) {
+                continue;
+            }
+#else
+            pollfd fd{listener, POLLIN, 0};
+            if (poll(&fd, 1, 200) <= 0) {
+                continue;
+            }
+#endif
+            const SocketHandle client = accept(listener, nullptr, nullptr);
+            if (client == InvalidSocket) {
+                continue;
+            }
+#ifdef _WIN32
+            u_long non_blocking = 1;
+            ioctlsocket(client, FIONBIO, &non_blocking);
+#else
+            fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+#ifdef __APPLE__
+            const int no_sigpipe = 1;
+            setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+#endif
+            LOG_INFO(Core, "Metrics client connected");
+            std::scoped_lock lock{clients_mutex};
+            clients.push_back(client);
+        }
+    }
+
+    SocketHandle listener{InvalidSocket};
+    std::mutex clients_mutex;
+    std::vector<SocketHandle> clients;
+    std::jthread accept_thread;
+};
+
+/**
+ * Publishes binary records in a shared memory object that tools map, with a ring of commands
+ * going the other way. Records are written under a sequence counter, so readers never stall the
+ * present thread. Commands are polled by a thread of the sink.
+ */
+class SharedMemorySink {
+public:
+    SharedMemorySink() {
+        constexpr size_t size = sizeof(Shm::Layout);
+#ifdef _WIN32
+        name = fmt::format("Local\\shadps4_metrics_{}", GetCurrentProcessId());
+        mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                     static_cast<DWORD>(size), name.c_str());
+        if (mapping == nullptr) {
+            LOG_ERROR(Core, "Failed to create the metrics shared memory {}", name);
+            return;
+        }
+        void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+#else
+        name = fmt::format("/shadps4_metrics_{}", getpid());
+        const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0 || ftruncate(fd, size) != 0) {
+            LOG_ERROR(Core, "Failed to create the metrics shared memory {}", name);
+            if (fd >= 0) {
+                close(fd);
+                shm_unlink(name.c_str());
+            }
+            return;
+        }
+        void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        view = view == MAP_FAILED ? nullptr : view;
+#endif
+        if (view == nullptr) {
+            LOG_ERROR(Core, "Failed to map the metrics shared memory {}", name);
+            return;
+        }
+        // The mapping starts zeroed, which is the state of all the atomics
+        layout = static_cast<Shm::Layout*>(view);
+        auto& header = layout->header;
+        header.record_size = sizeof(Shm::Record);
+        header.num_records = Shm::NumRecords;
+        header.num_counters = Shm::NumCounters;
+        header.num_commands = Shm::NumCommands;
+        header.version = Shm::Version;
+        std::atomic_ref{header.magic}.store(Shm::Magic, std::memory_order_release);
+
+        command_thread =
+            std::jthread{[this](std::stop_token stop_token) { CommandLoop(stop_token); }};
+        LOG_INFO(Core, "Publishing per-frame metrics to shared memory {}", name);
+    }
+
+    ~SharedMemorySink() {
+        command_thread = {};
+        if (!layout) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(layout);
+        CloseHandle(mapping);
+#else
+        munmap(layout, sizeof(Shm::Layout));
+        shm_unlink(name.c_str());
+#endif
+    }
+
+    void Write(const FrameMetrics& metrics) {
+        if (!layout) {
+            return;
+        }
+        auto& header = layout->header;
+        if (reset_requested.exchange(false, std::memory_order_relaxed)) {
+            header.frames_since_reset.store(0, std::memory_order_relaxed);
+            for (auto& total : header.counter_totals) {
+                total.store(0, std::memory_order_relaxed);
+            }
+        }
+        const u64 index = header.records_written.load(std::memory_order_relaxed);
+        auto& record = layout->records[index % Shm::NumRecords];
+        const u64 sequence = record.sequence.load(std::memory_order_relaxed);
+        record.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        record.frame = metrics.frame;
+        record.flags = (metrics.hitch ? Shm::Hitch : 0) | (metrics.gpu_ms ? Shm::HasGpuTime : 0);
+        record.time_s = metrics.time_s;
+        record.frame_ms = metrics.frame_ms;
+        record.gpu_ms = metrics.gpu_ms.value_or(0.0);
+        record.rss_bytes = metrics.rss_bytes;
+        record.device_bytes = metrics.device_bytes;
+        record.counters = metrics.counters;
+        record.sequence.store(sequence + 2, std::memory_order_release);
+
+        header.frames_since_reset.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = 0; i < Shm::NumCounters; ++i) {
+            header.counter_totals[i].fetch_add(metrics.counters[i], std::memory_order_relaxed);
+        }
+        header.records_written.store(index + 1, std::memory_order_release);
+    }
+
+private:
+    void CommandLoop(std::stop_token stop_token) {
+        Common::SetCurrentThreadName("shadPS4:MetricsCommands");
+        auto& header = layout->header;
+        while (!stop_token.stop_requested()) {
+            const u32 write = header.command_write.load(std::memory_order_acquire);
+            u32 read = header.command_read.load(std::memory_order_relaxed);
+            for (; read != write; ++read) {
+                RunCommand(header.commands[read % Shm::NumCommands]);
+            }
+            header.command_read.store(read, std::memory_order_release);
+            std::this_thread::sleep_for(CommandPollInterval);
+        }
+    }
+
+    void RunCommand(Shm::Command command) {
+        const auto push_event = [](u32 type) {
+            SDL_Event event;
+            SDL_memset(&event, 0, sizeof(event));
+            event.type = type;
+            SDL_PushEvent(&event);
+        };
+        switch (command) {
+        case Shm::Command::Pause:
+            DebugState.PauseGuestThreads();
+            break;
+        case Shm::Command::Resume:
+            DebugState.ResumeGuestThreads();
+            break;
+        case Shm::Command::Capture:
+            push_event(SDL_EVENT_RDOC_CAPTURE);
+            break;
+        case Shm::Command::ResetCounters:
+            reset_requested.store(true, std::memory_order_relaxed);
+            break;
+        default:
+            LOG_WARNING(Core, "Unknown metrics command {}", static_cast<u32>(command));
+            break;
+        }
+    }
+
+    static constexpr auto CommandPollInterval = std::chrono::milliseconds{20};
+
+    std::string name;
+#ifdef _WIN32
+    HANDLE mapping{};
+#endif
+    Shm::Layout* layout{};
+    std::atomic<bool> reset_requested{};
+    std::jthread command_thread;
+};
+
+struct State {
+    bool initialized{};
+    std::optional<FileSink> file;
+    std::optional<SocketSink> socket;
+    std::optional<SharedMemorySink> shm;
+    Clock::time_point start_time;
+    Clock::time_point last_frame_time;
+    u64 last_gpu_frame{};
+    u64 last_num_hitches{};
+};
+
+State state;
+
+void Init() {
+    state.initialized = true;
+    const std::string sink = Config::getMetricsSink();
+    if (sink == "csv" || sink == "json") {
+        state.file.emplace(sink == "csv");
+    } else if (sink == "socket") {
+        state.socket.emplace(static_cast<u16>(Config::getMetricsPort()));
+    } else if (sink == "shm") {
+        state.shm.emplace();
+        // Tools look the object up by name, don't leave it behind on exit
+        std::at_quick_exit([] { state.shm.reset(); });
+    } else if (sink != "none" && !sink.empty()) {
+        LOG_WARNING(Core, "Unknown metrics sink {}, expected none, csv, json, socket or shm",
+                    sink);
+    }
+    state.start_time = state.last_frame_time = Clock::now();
+}
+
+} // Anonymous namespace
+
+void OnFrame() {
+    if (!state.initialized) {
+        Init();
+    }
+    if (!state.file && !state.socket && !state.shm) {
+        return;
+    }
+
+    const auto now = Clock::now();
+    const auto [num_hitches, _] = VideoCore::GetHitchCounts();
+    const FrameMetrics metrics{
+        .frame = DebugState.GetFrameNum(),
+        .time_s = std::chrono::duration<double>(now - state.start_time).count(),
+        .frame_ms = std::chrono::duration<double, std::milli>(now - state.last_frame_time).count(),
+        .gpu_ms = ReadGpuFrameTime(state.last_gpu_frame),
+        .hitch = num_hitches != state.last_num_hitches,
+        .rss_bytes = GetResidentBytes(),
+        .device_bytes = DebugState.vma_block_bytes.load(std::memory_order_relaxed),
+        .counters = Common::GetLastFramePerfCounters(),
+    };
+    state.last_frame_time = now;
+    state.last_num_hitches = num_hitches;
+
+    if (state.file) {
+        state.file->Write(metrics);
+    }
+    if (state.socket) {
+        state.socket->Write(metrics);
+    }
+    if (state.shm) {
+        state.shm->Write(metrics);
+    }
+}
+
+} // namespace Core::MetricsSink
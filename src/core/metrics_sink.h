@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "common/perf_counters.h"
+#include "common/types.h"
+
+/**
+ * Per-frame metrics for external monitoring, chosen with the MetricsSink option: "csv" and "json"
+ * write one row per frame to a file in the log directory that is rotated once it grows large,
+ * "socket" streams the JSON rows, one per line, to every client connected to MetricsPort on the
+ * loopback interface. Rows hold the frame and GPU times, whether the frame was a hitch, the
+ * resident and device memory in use and the perf counters of the frame.
+ *
+ * "shm" publishes the rows as binary records in a shared memory object named
+ * shadps4_metrics_<pid>, "Local\shadps4_metrics_<pid>" on Windows and
+ * "/shadps4_metrics_<pid>" on POSIX, with the layout below. Tools also send commands through it.
+ */
+namespace Core::MetricsSink {
+
+namespace Shm {
+
+constexpr u32 Magic = 0x544D3453; ///< "S4MT"
+constexpr u32 Version = 1;
+constexpr u32 NumRecords = 256;
+constexpr u32 NumCommands = 16;
+constexpr size_t NumCounters = static_cast<size_t>(Common::PerfCounter::Count);
+
+static_assert(std::atomic<u64>::is_always_lock_free && std::atomic<u32>::is_always_lock_free);
+
+enum class Command : u32 {
+    None,
+    Pause,         ///< Pauses the guest threads
+    Resume,        ///< Resumes the guest threads
+    Capture,       ///< Triggers a RenderDoc capture
+    ResetCounters, ///< Restarts the counter totals of the header
+};
+
+enum RecordFlags : u32 {
+    Hitch = 1 << 0,
+    HasGpuTime = 1 << 1,
+};
+
+/// One frame, read it again when the sequence changed or was odd while copying it.
+struct Record {
+    std::atomic<u64> sequence;
+    u32 frame;
+    u32 flags;
+    double time_s;
+    double frame_ms;
+    double gpu_ms;
+    u64 rss_bytes;
+    u64 device_bytes;
+    std::array<u64, NumCounters> counters;
+};
+
+struct Header {
+    u32 magic;
+    u32 version;
+    u32 record_size;
+    u32 num_records;
+    u32 num_counters;
+    u32 num_commands;
+    /// Records published so far, record n is at records[n % num_records]
+    std::atomic<u64> records_written;
+    /// Frames and counters summed since startup or the last ResetCounters
+    std::atomic<u64> frames_since_reset;
+    std::array<std::atomic<u64>, NumCounters> counter_totals;
+    /// Commands are written by one tool at commands[command_write % num_commands] before it
+    /// increments command_write, the emulator increments command_read as it runs them
+    std::atomic<u32> command_write;
+    std::atomic<u32> command_read;
+    std::array<Command, NumCommands> commands;
+};
+
+struct Layout {
+    Header header;
+    std::array<Record, NumRecords> records;
+};
+
+} // namespace Shm
+
+/// Emits the metrics of the frame that just ended, called once per flip. The sink is opened on
+/// the first call.
+void OnFrame();
+
+} // namespace Core::MetricsSink
@@ -103,6 +103,7 @@ s32 Module::Start(u64 args, const void* argp, void* param) {
 void Module::LoadModuleToMemory(u32& max_tls_index) {
     static constexpr size_t BlockAlign = 0x1000;
     static constexpr u64 TrampolineSize = 8_MB;
+    static constexpr u64 LazyBindSize = 1_MB;
 
     // Retrieve elf header and program header
     const auto elf_header = elf.GetElfHeader();
@@ -120,7 +121,10 @@ void Module::LoadModuleToMemory(u32& max_tls_index) {
 #ifdef ARCH_X86_64
     // Initialize trampoline generator.
     void* trampoline_addr = std::bit_cast<void*>(base_virtual_addr + aligned_base_size);
-    RegisterPatchModule(*out_addr, aligned_base_size, trampoline_addr, TrampolineSize);
+    RegisterPatchModule(*out_addr, aligned_base_size, trampoline_addr,
+                        TrampolineSize - LazyBindSize);
+    lazy_bind_area = base_virtual_addr + aligned_base_size + TrampolineSize - LazyBindSize;
+    lazy_bind_area_size = LazyBindSize;
 #endif
 
     LOG_INFO(Core_Linker, "======== Load Module to Memory ========");
@@ -166,7 +170,7 @@ void Module::LoadModuleToMemory(u32& max_tls_index) {
             add_segment(elf_pheader[i]);
 #ifdef ARCH_X86_64
             if (elf_pheader[i].p_flags & PF_EXEC) {
-                PrePatchInstructions(segment_addr, segment_file_size);
+                unpatched_segments.emplace_back(segment_addr, segment_file_size);
             }
 #endif
             break;
@@ -235,6 +239,15 @@ void Module::LoadModuleToMemory(u32& max_tls_index) {
     }
 }
 
+void Module::PatchSegments() {
+#ifdef ARCH_X86_64
+    for (const auto& [segment_addr, segment_size] : unpatched_segments) {
+        PrePatchInstructions(segment_addr, segment_size);
+    }
+#endif
+    unpatched_segments.clear();
+}
+
 void Module::LoadDynamicInfo() {
     for (const auto* dyn = reinterpret_cast<elf_dynamic*>(m_dynamic.data()); dyn->d_tag != DT_NULL;
          dyn++) {
@@ -408,6 +421,7 @@ void Module::LoadSymbols() {
             LOG_INFO(Core_Linker, "Symbol table not found!");
             return;
         }
+        symbol.Reserve(dynamic_info.symbol_table_total_size / sizeof(*dynamic_info.symbol_table));
         for (auto* sym = dynamic_info.symbol_table;
              reinterpret_cast<u8*>(sym) < reinterpret_cast<u8*>(dynamic_info.symbol_table) +
                                               dynamic_info.symbol_table_total_size;
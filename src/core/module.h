@@ -206,6 +206,9 @@ public:
     void LoadModuleToMemory(u32& max_tls_index);
     void LoadDynamicInfo();
     void LoadSymbols();
+    /// Applies the ahead of time CPU patches to the executable segments, which can happen on any
+    /// thread once the module is loaded.
+    void PatchSegments();
 
     void* FindByName(std::string_view name);
 
@@ -233,6 +236,10 @@ public:
     ThreadLocalImage tls{};
     OrbisKernelModuleInfo info{};
     std::vector<u8> rela_bits;
+    std::vector<std::pair<VAddr, u64>> unpatched_segments;
+    VAddr lazy_bind_area{}; ///< End of the trampoline area, holds the stubs of lazy jump slots
+    u64 lazy_bind_area_size{};
+    VAddr lazy_bind_stubs{}; ///< Stub of the first jump slot, once they are generated
 };
 
 } // namespace Core
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2024-2026 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
 #include "common/arch.h"
 #include "common/assert.h"
 #include "common/decoder.h"
@@ -138,9 +139,30 @@ SignalDispatch::~SignalDispatch() {
 #endif
 }
 
+template <typename T>
+template <typename... Args>
+bool SignalDispatch::HandlerEntry<T>::Handle(Args... args) const {
+    // steady_clock reads the vDSO clock, which is fine to call from a signal handler.
+    const auto start = std::chrono::steady_clock::now();
+    const bool handled = handler(args...);
+    if (handled) {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        num_handled.fetch_add(1, std::memory_order_relaxed);
+        handled_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                             std::memory_order_relaxed);
+    }
+    return handled;
+}
+
 bool SignalDispatch::DispatchAccessViolation(void* context, void* fault_address) const {
-    for (const auto& [handler, _] : access_violation_handlers) {
-        if (handler(context, fault_address)) {
+    // Handlers that only own faults raised by their own code are skipped for everything else
+    // without calling into them.
+    const void* code = Common::GetRip(context);
+    for (const auto& entry : access_violation_handlers) {
+        if (entry.HasCodeRange() && !entry.InCodeRange(code)) {
+            continue;
+        }
+        if (entry.Handle(context, fault_address)) {
             return true;
         }
     }
@@ -148,12 +170,25 @@ bool SignalDispatch::DispatchAccessViolation(void* context, void* fault_address)
 }
 
 bool SignalDispatch::DispatchIllegalInstruction(void* context) const {
-    for (const auto& [handler, _] : illegal_instruction_handlers) {
-        if (handler(context)) {
+    for (const auto& entry : illegal_instruction_handlers) {
+        if (entry.Handle(context)) {
             return true;
         }
     }
     return false;
 }
 
+std::vector<SignalHandlerStats> SignalDispatch::GetAccessViolationStats() const {
+    std::vector<SignalHandlerStats> stats;
+    stats.reserve(access_violation_handlers.size());
+    for (const auto& entry : access_violation_handlers) {
+        stats.push_back({
+            .name = entry.name,
+            .num_handled = entry.num_handled.load(std::memory_order_relaxed),
+            .handled_ns = entry.handled_ns.load(std::memory_order_relaxed),
+        });
+    }
+    return stats;
+}
+
 } // namespace Core
\ No newline at end of file
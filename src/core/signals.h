@@ -3,7 +3,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <set>
+#include <string_view>
+#include <vector>
 #include "common/singleton.h"
 #include "common/types.h"
 
@@ -12,20 +15,31 @@ namespace Core {
 using AccessViolationHandler = bool (*)(void* context, void* fault_address);
 using IllegalInstructionHandler = bool (*)(void* context);
 
+/// Number of signals a handler took and the time it spent on them.
+struct SignalHandlerStats {
+    std::string_view name;
+    u64 num_handled;
+    u64 handled_ns;
+};
+
 /// Receives OS signals and dispatches to the appropriate handlers.
 class SignalDispatch {
 public:
     SignalDispatch();
     ~SignalDispatch();
 
-    /// Registers a handler for memory access violation signals.
-    void RegisterAccessViolationHandler(const AccessViolationHandler& handler, u32 priority) {
-        access_violation_handlers.emplace(handler, priority);
+    /// Registers a handler for memory access violation signals. A handler that only takes
+    /// faults raised by code in [code_begin, code_end) is skipped for faults raised elsewhere.
+    void RegisterAccessViolationHandler(const AccessViolationHandler& handler, u32 priority,
+                                        std::string_view name, const void* code_begin = nullptr,
+                                        const void* code_end = nullptr) {
+        access_violation_handlers.emplace(handler, priority, name, code_begin, code_end);
     }
 
     /// Registers a handler for illegal instruction signals.
-    void RegisterIllegalInstructionHandler(const IllegalInstructionHandler& handler, u32 priority) {
-        illegal_instruction_handlers.emplace(handler, priority);
+    void RegisterIllegalInstructionHandler(const IllegalInstructionHandler& handler, u32 priority,
+                                           std::string_view name) {
+        illegal_instruction_handlers.emplace(handler, priority, name, nullptr, nullptr);
     }
 
     /// Dispatches an access violation signal, returning whether it was successfully handled.
@@ -34,15 +48,40 @@ public:
     /// Dispatches an illegal instruction signal, returning whether it was successfully handled.
     bool DispatchIllegalInstruction(void* context) const;
 
+    /// Returns the statistics of every access violation handler, in the order they are tried.
+    std::vector<SignalHandlerStats> GetAccessViolationStats() const;
+
 private:
     template <typename T>
     struct HandlerEntry {
-        T handler;
-        u32 priority;
+        HandlerEntry(T handler_, u32 priority_, std::string_view name_, const void* code_begin_,
+                     const void* code_end_)
+            : handler{handler_}, priority{priority_}, name{name_}, code_begin{code_begin_},
+              code_end{code_end_} {}
 
         std::strong_ordering operator<=>(const HandlerEntry& right) const {
             return priority <=> right.priority;
         }
+
+        [[nodiscard]] bool HasCodeRange() const {
+            return code_begin != nullptr;
+        }
+
+        [[nodiscard]] bool InCodeRange(const void* code) const {
+            return code >= code_begin && code < code_end;
+        }
+
+        /// Calls the handler, counting the signals it takes.
+        template <typename... Args>
+        bool Handle(Args... args) const;
+
+        T handler;
+        u32 priority;
+        std::string_view name;
+        const void* code_begin;
+        const void* code_end;
+        mutable std::atomic<u64> num_handled{};
+        mutable std::atomic<u64> handled_ns{};
     };
     std::set<HandlerEntry<AccessViolationHandler>> access_violation_handlers;
     std::set<HandlerEntry<IllegalInstructionHandler>> illegal_instruction_handlers;
@@ -1,7 +1,16 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <vector>
 #include "common/alignment.h"
+#include "common/config.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
 #include "core/libraries/kernel/threads/pthread.h"
 #include "thread.h"
 #ifdef _WIN64
@@ -13,6 +22,11 @@
 #include <unistd.h>
 #include <xmmintrin.h>
 #endif
+#ifdef __linux__
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
 
 namespace Core {
 
@@ -54,6 +68,117 @@ void InitializeContext(CONTEXT* ctx, ThreadFunc func, void* arg,
 }
 #endif
 
+/// Parses a list of host cores like "2-7,10", only keeping the ones the host has.
+static std::vector<u32> ParseCoreList(std::string_view list) {
+    const u32 num_cores = std::min(std::thread::hardware_concurrency(), 64U);
+    std::vector<u32> cores;
+    while (!list.empty()) {
+        const auto comma = list.find(',');
+        const auto token = list.substr(0, comma);
+        list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+        const auto dash = token.find('-');
+        const auto first_str = token.substr(0, dash);
+        const auto last_str = dash == std::string_view::npos ? first_str : token.substr(dash + 1);
+        u32 first{};
+        u32 last{};
+        if (std::from_chars(first_str.data(), first_str.data() + first_str.size(), first).ec !=
+                std::errc{} ||
+            std::from_chars(last_str.data(), last_str.data() + last_str.size(), last).ec !=
+                std::errc{}) {
+            LOG_WARNING(Core, "Ignoring invalid guest core range '{}'", token);
+            continue;
+        }
+        for (u32 core = first; core <= last && core < num_cores; ++core) {
+            cores.push_back(core);
+        }
+    }
+    return cores;
+}
+
+/// Host cores guest threads are pinned to, empty to leave them to the host scheduler.
+static const std::vector<u32>& GetGuestCores() {
+    static const std::vector<u32> cores = ParseCoreList(Config::getGuestCores());
+    return cores;
+}
+
+/// Host core mask for a guest core mask. PS4 games get 7 cores, which are spread over the
+/// configured host cores in order.
+static u64 GetHostGuestMask(u64 guest_mask) {
+    const auto& cores = GetGuestCores();
+    u64 host_mask = 0;
+    for (u32 i = 0; i < cores.size(); ++i) {
+        if (guest_mask == 0 || (guest_mask & (1ULL << (i % 7))) != 0) {
+            host_mask |= 1ULL << cores[i];
+        }
+    }
+    return host_mask;
+}
+
+/// Host core mask for emulator threads, every core the guest threads aren't pinned to.
+static u64 GetHostEmulatorMask() {
+    if (GetGuestCores().empty()) {
+        return 0;
+    }
+    const u32 num_cores = std::min(std::thread::hardware_concurrency(), 64U);
+    const u64 all_cores = num_cores == 64 ? ~0ULL : (1ULL << num_cores) - 1;
+    return all_cores & ~GetHostGuestMask(0);
+}
+
+static Common::ThreadPriority GetGuestPriorityClass(s32 guest_prio) {
+    // Fifo and round robin threads range from 0x100 (highest) to 0x2FF, where 0x2BC is the
+    // default. Other threads come after, from 0x300 to 0x3BF.
+    if (guest_prio == 0 || guest_prio >= 0x300) {
+        return guest_prio == 0 ? Common::ThreadPriority::Normal : Common::ThreadPriority::Low;
+    }
+    if (guest_prio < 0x1C0) {
+        return Common::ThreadPriority::VeryHigh;
+    }
+    if (guest_prio < 0x280) {
+        return Common::ThreadPriority::High;
+    }
+    return Common::ThreadPriority::Normal;
+}
+
+#ifdef _WIN64
+static void SetAffinityMask(void* handle, u64 mask) {
+    SetThreadAffinityMask(handle, static_cast<DWORD_PTR>(mask));
+}
+#else
+static void SetAffinityMask(uintptr_t handle, u64 mask) {
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (u32 cpu = 0; cpu < 64; ++cpu) {
+        if ((mask & (1ULL << cpu)) != 0) {
+            CPU_SET(cpu, &cpu_set);
+        }
+    }
+    pthread_setaffinity_np(static_cast<pthread_t>(handle), sizeof(cpu_set_t), &cpu_set);
+#endif
+}
+#endif
+
+void PinCurrentThreadToGuestCores() {
+    if (const u64 mask = GetHostGuestMask(0); mask != 0) {
+#ifdef _WIN64
+        SetAffinityMask(GetCurrentThread(), mask);
+#else
+        SetAffinityMask(static_cast<uintptr_t>(pthread_self()), mask);
+#endif
+    }
+}
+
+void KeepCurrentThreadOffGuestCores() {
+    if (const u64 mask = GetHostEmulatorMask(); mask != 0) {
+#ifdef _WIN64
+        SetAffinityMask(GetCurrentThread(), mask);
+#else
+        SetAffinityMask(static_cast<uintptr_t>(pthread_self()), mask);
+#endif
+    }
+}
+
 NativeThread::NativeThread() : native_handle{0} {}
 
 NativeThread::~NativeThread() {}
@@ -145,6 +270,40 @@ void NativeThread::Initialize() {
     sig_stack.ss_flags = 0;
     ASSERT_MSG(sigaltstack(&sig_stack, nullptr) == 0, "Failed to set signal stack: {}", errno);
 #endif
+#ifdef __linux__
+    host_tid = static_cast<int>(syscall(SYS_gettid));
+#endif
+}
+
+void NativeThread::SetGuestPriority(s32 guest_prio) {
+    if (!Config::isGuestThreadPrioritiesEnabled() || !native_handle) {
+        return;
+    }
+    const auto priority = GetGuestPriorityClass(guest_prio);
+#ifdef _WIN64
+    static constexpr std::array<int, 5> WindowsPriorities = {
+        THREAD_PRIORITY_BELOW_NORMAL, THREAD_PRIORITY_NORMAL, THREAD_PRIORITY_ABOVE_NORMAL,
+        THREAD_PRIORITY_HIGHEST,      THREAD_PRIORITY_TIME_CRITICAL,
+    };
+    SetThreadPriority(native_handle, WindowsPriorities[static_cast<u32>(priority)]);
+#elif defined(__linux__)
+    // Threads under SCHED_OTHER only differ in their nice value, which is per thread on Linux.
+    // Lowering it needs CAP_SYS_NICE or a raised RLIMIT_NICE, without those it stays put.
+    static constexpr std::array<int, 5> NiceValues = {4, 0, -2, -5, -10};
+    if (host_tid != 0 &&
+        setpriority(PRIO_PROCESS, host_tid, NiceValues[static_cast<u32>(priority)]) != 0) {
+        LOG_DEBUG(Core, "Failed to set nice value of thread {}: {}", host_tid, strerror(errno));
+    }
+#endif
+}
+
+void NativeThread::SetGuestAffinity(u64 guest_mask) {
+    if (!native_handle) {
+        return;
+    }
+    if (const u64 mask = GetHostGuestMask(guest_mask); mask != 0) {
+        SetAffinityMask(native_handle, mask);
+    }
 }
 
 } // namespace Core
@@ -24,6 +24,13 @@ public:
 
     void Initialize();
 
+    /// Maps a guest priority onto the host scheduler, if enabled in the config.
+    void SetGuestPriority(s32 guest_prio);
+
+    /// Pins the thread to the host cores standing in for the guest cores in the mask, if guest
+    /// cores are configured. An empty mask allows all of them.
+    void SetGuestAffinity(u64 guest_mask);
+
     uintptr_t GetHandle() {
         return reinterpret_cast<uintptr_t>(native_handle);
     }
@@ -38,8 +45,17 @@ private:
 #else
     uintptr_t native_handle;
     void* sig_stack_ptr;
+#endif
+#ifdef __linux__
+    int host_tid{};
 #endif
     u64 tid;
 };
 
+/// Pins the calling thread to the host cores configured for guest threads.
+void PinCurrentThreadToGuestCores();
+
+/// Moves the calling emulator thread off the host cores configured for guest threads.
+void KeepCurrentThreadOffGuestCores();
+
 } // namespace Core
\ No newline at end of file
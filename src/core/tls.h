@@ -4,6 +4,7 @@
 #pragma once
 
 #include <cstring>
+#include "common/alloc_tracker.h"
 #include "common/types.h"
 #ifdef _WIN32
 #include <malloc.h>
@@ -71,6 +72,7 @@ struct HostCallWrapperImpl;
 template <class ReturnType, class... Args, PS4_SYSV_ABI ReturnType (*func)(Args...)>
 struct HostCallWrapperImpl<PS4_SYSV_ABI ReturnType (*)(Args...), func> {
     static ReturnType PS4_SYSV_ABI wrap(Args... args) {
+        Common::ScopedAllocTag alloc_tag{Common::AllocTag::HleLibraries};
         return func(args...);
     }
 };
@@ -1,9 +1,14 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <numeric>
 #include <set>
 #include <sstream>
 #include <fmt/core.h>
@@ -15,6 +20,7 @@
 #include "common/logging/backend.h"
 #include "common/logging/log.h"
 #include "common/thread.h"
+#include "common/thread_pool.h"
 #include "core/ipc/ipc.h"
 #include "core/libraries/network/netctl.h"
 #include "core/xiltimer.h"
@@ -22,32 +28,47 @@
 #include "common/discord_rpc_handler.h"
 #endif
 #include "common/elf_info.h"
+#include "common/io_file.h"
 #include "common/memory_patcher.h"
 #include "common/ntapi.h"
 #include "common/path_util.h"
 #include "common/polyfill_thread.h"
 #include "common/scm_rev.h"
 #include "common/singleton.h"
+#include "core/benchmark.h"
 #include "core/debugger.h"
+#include "core/devtools/frame_capture.h"
 #include "core/devtools/widget/module_list.h"
+#include "core/file_format/pfs_image.h"
 #include "core/file_format/psf.h"
-#include "core/file_format/trp.h"
 #include "core/file_sys/fs.h"
 #include "core/libraries/disc_map/disc_map.h"
+#include "core/libraries/error_codes.h"
 #include "core/libraries/font/font.h"
 #include "core/libraries/font/fontft.h"
 #include "core/libraries/jpeg/jpegenc.h"
+#include "core/libraries/kernel/memory.h"
 #include "core/libraries/libc_internal/libc_internal.h"
 #include "core/libraries/libs.h"
 #include "core/libraries/ngs2/ngs2.h"
 #include "core/libraries/np/np_trophy.h"
 #include "core/libraries/rtc/rtc.h"
 #include "core/libraries/save_data/save_backup.h"
+#include "core/libraries/save_data/save_memory.h"
 #include "core/linker.h"
 #include "core/memory.h"
+#include "core/thread.h"
 #include "emulator.h"
+#include "shader_recompiler/backend/spirv/emit_spirv.h"
+#include "shader_recompiler/recompiler.h"
+#include "video_core/amdgpu/liverpool.h"
 #include "video_core/cache_storage.h"
 #include "video_core/renderdoc.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/renderer_vulkan/vk_pipeline_cache.h"
+#include "video_core/renderer_vulkan/vk_pipeline_serialization.h"
+#include "video_core/renderer_vulkan/vk_rasterizer.h"
+#include "video_core/renderer_vulkan/vk_scheduler.h"
 
 #ifdef _WIN32
 #include <WinSock2.h>
@@ -60,6 +81,8 @@
 
 Frontend::WindowSDL* g_window = nullptr;
 
+extern std::unique_ptr<AmdGpu::Liverpool> liverpool;
+
 namespace Core {
 
 Emulator::Emulator() {
@@ -77,6 +100,29 @@ Emulator::Emulator() {
 
 Emulator::~Emulator() {}
 
+/// Logs how long each step of the startup took, from the end of the one before it.
+class StartupTimer {
+public:
+    void EndPhase(std::string_view phase) {
+        const auto now = std::chrono::steady_clock::now();
+        LOG_INFO(Loader, "Startup phase {}: {} ms", phase, ToMilliseconds(now - phase_start));
+        phase_start = now;
+    }
+
+    void End() {
+        LOG_INFO(Loader, "Startup took {} ms",
+                 ToMilliseconds(std::chrono::steady_clock::now() - start));
+    }
+
+private:
+    static s64 ToMilliseconds(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point phase_start = start;
+};
+
 s32 ReadCompiledSdkVersion(const std::filesystem::path& file) {
     Core::Loader::Elf elf;
     elf.Open(file);
@@ -102,11 +148,32 @@ void Emulator::Run(std::filesystem::path file, std::vector<std::string> args,
     if (waitForDebuggerBeforeRun) {
         Debugger::WaitForDebuggerAttach();
     }
+    StartupTimer startup_timer;
 
     if (std::filesystem::is_directory(file)) {
         file /= "eboot.bin";
     }
 
+    // Images are mounted as they are, only the files needed to boot are copied out of them.
+    std::shared_ptr<PfsImage> image;
+    if (std::filesystem::is_regular_file(file) && PfsImage::IsImage(file)) {
+        image = PfsImage::Open(file);
+        if (!image) {
+            LOG_CRITICAL(Loader, "Failed to open PFS image {}", Common::FS::PathToUTF8String(file));
+            std::quick_exit(0);
+        }
+        const auto boot_folder = Common::FS::GetUserPath(Common::FS::PathType::CacheDir) /
+                                 "images" /
+                                 fmt::format("{}_{:016x}", file.stem().string(), image->GetId());
+        for (const auto* name : {"eboot.bin", "sce_sys", "sce_module"}) {
+            if (const auto* node = image->Find(name); node != nullptr) {
+                image->Extract(*node, boot_folder / name);
+            }
+        }
+        file = boot_folder / "eboot.bin";
+        p_game_folder = boot_folder;
+    }
+
     std::filesystem::path game_folder;
     if (p_game_folder.has_value()) {
         game_folder = p_game_folder.value();
@@ -128,9 +195,9 @@ void Emulator::Run(std::filesystem::path file, std::vector<std::string> args,
 
     // Applications expect to be run from /app0 so mount the file's parent path as app0.
     auto* mnt = Common::Singleton<Core::FileSys::MntPoints>::Instance();
-    mnt->Mount(game_folder, "/app0", true);
+    mnt->Mount(game_folder, "/app0", true, image);
     // Certain games may use /hostapp as well such as CUSA001100
-    mnt->Mount(game_folder, "/hostapp", true);
+    mnt->Mount(game_folder, "/hostapp", true, image);
 
     const auto param_sfo_path = mnt->GetHostPath("/app0/sce_sys/param.sfo");
     const auto param_sfo_exists = std::filesystem::exists(param_sfo_path);
@@ -214,6 +281,10 @@ void Emulator::Run(std::filesystem::path file, std::vector<std::string> args,
         Common::Log::Initialize();
     }
     Common::Log::Start();
+    startup_timer.EndPhase("game info and config");
+
+    // Threads started from here on inherit this on Linux, the guest ones are pinned again.
+    Core::KeepCurrentThreadOffGuestCores();
     if (!std::filesystem::exists(file)) {
         LOG_CRITICAL(Loader, "eboot.bin does not exist: {}",
                      std::filesystem::absolute(file).string());
@@ -281,6 +352,8 @@ void Emulator::Run(std::filesystem::path file, std::vector<std::string> args,
         }
     }
 
+    startup_timer.EndPhase("host info");
+
     // Create stdin/stdout/stderr
     Common::Singleton<FileSys::HandleTable>::Instance()->CreateStdHandles();
 
@@ -303,19 +376,16 @@ void Emulator::Run(std::filesystem::path file, std::vector<std::string> args,
     // Load renderdoc module
     VideoCore::LoadRenderDoc();
 
-    // Initialize patcher and trophies
+    // Initialize patcher and trophies, the trophy packs are read while the rest starts up
+    Common::JobHandle trophy_job;
     if (!id.empty()) {
         MemoryPatcher::g_game_serial = id;
         Libraries::Np::NpTrophy::game_serial = id;
-
-        const auto trophyDir =
-            Common::FS::GetUserPath(Common::FS::PathType::MetaDataDir) / id / "TrophyFiles";
-        if (!std::filesystem::exists(trophyDir)) {
-            TRP trp;
-            if (!trp.Extract(game_folder, id)) {
-                LOG_ERROR(Loader, "Couldn't extract trophies");
+        trophy_job = Common::GetThreadPool().Submit([game_folder] {
+            if (!Libraries::Np::NpTrophy::OpenTrophyPacks(game_folder)) {
+                LOG_ERROR(Loader, "Couldn't read trophies");
             }
-        }
+        });
     }
 
     std::string game_title = fmt::format("{} - {} <{}>", id, title, app_version);
@@ -342,6 +412,7 @@ void Emulator::Run(std::filesystem::path file, std::vector<std::string> args,
         Config::getWindowWidth(), Config::getWindowHeight(), controller, window_title);
 
     g_window = window.get();
+    startup_timer.EndPhase("window");
 
     const auto& mount_data_dir = Common::FS::GetUserPath(Common::FS::PathType::GameDataDir) / id;
     if (!std::filesystem::exists(mount_data_dir)) {
@@ -371,9 +442,11 @@ void Emulator::Run(std::filesystem::path file, std::vector<std::string> args,
         std::filesystem::create_directory(mount_captures_dir);
     }
     VideoCore::SetOutputDir(mount_captures_dir, id);
+    startup_timer.EndPhase("mounts");
 
     // Initialize kernel and library facilities.
     Libraries::InitHLELibs(&linker->GetHLESymbols());
+    startup_timer.EndPhase("HLE libraries");
 
     // Load the module with the linker
     if (linker->LoadModule(eboot_path) == -1) {
@@ -381,9 +454,11 @@ void Emulator::Run(std::filesystem::path file, std::vector<std::string> args,
                      Common::FS::PathToUTF8String(std::filesystem::absolute(eboot_path)));
         std::quick_exit(0);
     }
+    startup_timer.EndPhase("eboot");
 
     // check if we have system modules to load
     LoadSystemModules(game_info.game_serial);
+    startup_timer.EndPhase("system modules");
 
     // Load all prx from game's sce_module folder
     mnt->IterateDirectory("/app0/sce_module", [this](const auto& path, const auto is_file) {
@@ -392,6 +467,7 @@ void Emulator::Run(std::filesystem::path file, std::vector<std::string> args,
             linker->LoadModule(path);
         }
     });
+    startup_timer.EndPhase("game modules");
 
 #ifdef ENABLE_DISCORD_RPC
     // Discord RPC
@@ -416,6 +492,12 @@ void Emulator::Run(std::filesystem::path file, std::vector<std::string> args,
         }).detach();
     }
 
+    if (trophy_job) {
+        Common::GetThreadPool().Wait(trophy_job);
+        startup_timer.EndPhase("trophies");
+    }
+    startup_timer.End();
+
     args.insert(args.begin(), eboot_name.generic_string());
     linker->Execute(args);
 
@@ -430,6 +512,332 @@ void Emulator::Run(std::filesystem::path file, std::vector<std::string> args,
     std::quick_exit(0);
 }
 
+bool Emulator::BuildPipelineCache(const std::string& serial) {
+    Common::SetCurrentThreadName("Main Thread");
+
+    auto& game_info = Common::ElfInfo::Instance();
+    game_info.initialized = true;
+    game_info.game_serial = serial;
+
+    Config::load(Common::FS::GetUserPath(Common::FS::PathType::CustomConfigs) / (serial + ".toml"),
+                 true);
+    // The cache is what is being built, so it can't be left disabled by the config.
+    Config::setPipelineCacheEnabled(true);
+
+    Common::Log::Initialize();
+    Common::Log::Start();
+    LOG_INFO(Loader, "Building pipeline cache for {} with shadps4 v{}", serial, Common::g_version);
+
+    const auto start = std::chrono::steady_clock::now();
+    const Vulkan::Instance instance{Frontend::WindowSystemType::Headless, Config::getGpuId(),
+                                    Config::vkValidationEnabled(),
+                                    Config::getVkCrashDiagnosticEnabled()};
+    Vulkan::Scheduler scheduler{instance};
+    // Loading from the storage only needs the device, there is no GPU state to specialize on.
+    // The sampler heap is part of the pipeline layouts and of the profile the cache was made with.
+    const auto sampler_heap = Vulkan::SamplerHeap::Create(instance);
+    Vulkan::PipelineCache pipeline_cache{instance, scheduler, nullptr, sampler_heap.get()};
+    pipeline_cache.Sync();
+
+    const auto& stats = pipeline_cache.GetCompileStats();
+    const u64 num_pipelines = stats.num_compiled.load();
+    if (num_pipelines == 0) {
+        LOG_ERROR(Loader, "No compatible pipelines were found in the cache of {}", serial);
+        return false;
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    LOG_INFO(Loader, "Built {} pipelines in {} ms", num_pipelines, elapsed.count());
+    return true;
+}
+
+bool Emulator::BenchShaders(const std::string& serial, u32 iterations) {
+    Common::SetCurrentThreadName("Main Thread");
+
+    auto& game_info = Common::ElfInfo::Instance();
+    game_info.initialized = true;
+    game_info.game_serial = serial;
+
+    Config::load(Common::FS::GetUserPath(Common::FS::PathType::CustomConfigs) / (serial + ".toml"),
+                 true);
+    // Shaders are read from the storage directly, the pipelines must not be preloaded.
+    Config::setPipelineCacheEnabled(false);
+
+    Common::Log::Initialize();
+    Common::Log::Start();
+    LOG_INFO(Loader, "Benchmarking the shader recompiler on {} with shadps4 v{}", serial,
+             Common::g_version);
+
+    // Only needed for the profile, which decides how the shaders are lowered.
+    const Vulkan::Instance instance{Frontend::WindowSystemType::Headless, Config::getGpuId(),
+                                    Config::vkValidationEnabled(),
+                                    Config::getVkCrashDiagnosticEnabled()};
+    Vulkan::Scheduler scheduler{instance};
+    const auto sampler_heap = Vulkan::SamplerHeap::Create(instance);
+    const Vulkan::PipelineCache pipeline_cache{instance, scheduler, nullptr, sampler_heap.get()};
+    const auto& profile = pipeline_cache.GetProfile();
+
+    struct BenchShader {
+        Shader::Stage stage;
+        Shader::LogicalStage l_stage;
+        u64 pgm_hash;
+        Shader::RuntimeInfo runtime_info;
+        std::array<u32, Shader::ShaderParams::NumShaderUserData> user_data;
+        std::vector<u32> code;
+    };
+    std::vector<BenchShader> shaders;
+    u32 num_skipped{};
+
+    const auto dump_dir = Common::FS::GetUserPath(Common::FS::PathType::ShaderDir) / "dumps";
+    auto& storage = Storage::DataBase::Instance();
+    storage.Open();
+    storage.ForEachBlob(Storage::BlobType::ShaderMeta, [&](std::vector<u8>&& data) {
+        Serialization::Archive ar{std::move(data)};
+        Shader::Info info{};
+        Shader::StageSpecialization spec{};
+        spec.info = &info;
+        std::optional<Shader::Gcn::FetchShaderData> fetch_shader{};
+        size_t perm_idx{};
+        if (!Vulkan::LoadShaderMeta(ar, info, fetch_shader, spec, perm_idx)) {
+            ++num_skipped;
+            return;
+        }
+        // Guest memory is not mapped, so shaders that read more than their own code and user data
+        // while being translated can't be reproduced here.
+        if (info.has_fetch_shader || info.srt_info.walker_func_size != 0 ||
+            info.stage == Shader::Stage::Geometry ||
+            info.l_stage == Shader::LogicalStage::TessellationControl) {
+            ++num_skipped;
+            return;
+        }
+        const auto name = Vulkan::PipelineCache::GetShaderName(info.stage, info.pgm_hash, perm_idx);
+        const auto path = dump_dir / fmt::format("{}.bin", name);
+        if (!std::filesystem::exists(path)) {
+            ++num_skipped;
+            return;
+        }
+        const Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read};
+        BenchShader& shader = shaders.emplace_back(BenchShader{
+            .stage = info.stage,
+            .l_stage = info.l_stage,
+            .pgm_hash = info.pgm_hash,
+            .runtime_info = spec.runtime_info,
+            .user_data = {},
+            .code = std::vector<u32>(file.GetSize() / sizeof(u32)),
+        });
+        file.Read(shader.code);
+        // The user data registers are at the start of the flattened buffer
+        std::memcpy(shader.user_data.data(), info.flattened_ud_buf.data(),
+                    std::min(sizeof(shader.user_data),
+                             info.flattened_ud_buf.size() * sizeof(u32)));
+    });
+    storage.Close();
+
+    if (shaders.empty()) {
+        LOG_ERROR(Loader, "No shaders with dumped GCN code were found in the cache of {}, run "
+                          "the game with dumpShaders enabled first",
+                  serial);
+        return false;
+    }
+    LOG_INFO(Loader, "Translating {} shaders {} times, {} were skipped", shaders.size(),
+             iterations, num_skipped);
+
+    // Totals over every iteration, passes in the order they first ran
+    Shader::CompileStats total{};
+    u64 spirv_size{};
+    u32 num_fp64_shaders{};
+    for (u32 iteration = 0; iteration < iterations; ++iteration) {
+        for (const BenchShader& shader : shaders) {
+            Shader::CompileStats stats{};
+            Shader::DecodedProgram decoded{shader.code, &stats};
+            Shader::Info info{shader.stage, shader.l_stage,
+                              Shader::ShaderParams{
+                                  .user_data = shader.user_data,
+                                  .code = shader.code,
+                                  .hash = shader.pgm_hash,
+                              }};
+            Shader::RuntimeInfo runtime_info = shader.runtime_info;
+            Shader::Backend::Bindings binding{};
+            auto& pools = Shader::Pools::ThreadLocal();
+            const auto program = Shader::TranslateProgram(decoded, pools, info, runtime_info,
+                                                          profile, &stats);
+            const auto emit_start = std::chrono::steady_clock::now();
+            const auto spv =
+                Shader::Backend::SPIRV::EmitSPIRV(profile, runtime_info, program, binding);
+            total.emit_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                                 std::chrono::steady_clock::now() - emit_start)
+                                 .count();
+            if (iteration == 0) {
+                spirv_size += spv.size() * sizeof(u32);
+                total.num_gcn_insts += stats.num_gcn_insts;
+                total.num_fp64_insts += stats.num_fp64_insts;
+                if (stats.num_fp64_insts != 0) {
+                    ++num_fp64_shaders;
+                }
+            }
+            total.decode_us += stats.decode_us;
+            total.cfg_us += stats.cfg_us;
+            total.structurize_us += stats.structurize_us;
+            for (const auto& pass : stats.passes) {
+                const auto it =
+                    std::ranges::find(total.passes, pass.name, &Shader::PassStats::name);
+                if (it == total.passes.end()) {
+                    total.passes.push_back(pass);
+                } else {
+                    it->time_us += pass.time_us;
+                }
+            }
+        }
+    }
+
+    const u64 total_us = std::max<u64>(total.TotalUs(), 1);
+    const auto log_stage = [&](std::string_view stage, u64 time_us) {
+        LOG_INFO(Loader, "{:<32} {:>10} us {:>6.2f}%", stage, time_us / iterations,
+                 time_us * 100.0 / total_us);
+    };
+    LOG_INFO(Loader, "Time per iteration of every stage:");
+    log_stage("Decode", total.decode_us);
+    log_stage("ControlFlowGraph", total.cfg_us);
+    log_stage("Structurize", total.structurize_us);
+    for (const auto& pass : total.passes) {
+        log_stage(pass.name, pass.time_us);
+    }
+    log_stage("EmitSPIRV", total.emit_us);
+    log_stage("Total", total.TotalUs());
+
+    const double seconds = total_us / 1'000'000.0;
+    const double num_translated = static_cast<double>(shaders.size()) * iterations;
+    LOG_INFO(Loader, "Throughput: {:.0f} GCN instructions/s, {:.1f} shaders/s",
+             static_cast<double>(total.num_gcn_insts) * iterations / seconds,
+             num_translated / seconds);
+    const auto pool_usage = Shader::Pools::PeakUsage();
+    LOG_INFO(Loader, "Peak IR memory: {} instructions ({} KB), {} blocks ({} KB)",
+             pool_usage.num_insts, pool_usage.num_insts * sizeof(Shader::IR::Inst) / 1_KB,
+             pool_usage.num_blocks, pool_usage.num_blocks * sizeof(Shader::IR::Block) / 1_KB);
+    LOG_INFO(Loader, "SPIR-V output: {} KB, {:.2f} words per GCN instruction", spirv_size / 1_KB,
+             static_cast<double>(spirv_size) / sizeof(u32) / std::max(total.num_gcn_insts, 1U));
+    if (num_fp64_shaders != 0) {
+        LOG_INFO(Loader, "Double precision: {} instructions in {} shaders",
+                 total.num_fp64_insts, num_fp64_shaders);
+    }
+    return true;
+}
+
+bool Emulator::ReplayFrameCapture(const std::filesystem::path& path, u32 loops) {
+    Common::SetCurrentThreadName("Main Thread");
+
+    auto capture = Devtools::LoadFrameCapture(path);
+    if (!capture) {
+        return false;
+    }
+    auto& game_info = Common::ElfInfo::Instance();
+    game_info.initialized = true;
+    game_info.game_serial = capture->game_serial;
+    game_info.sdk_ver = static_cast<u32>(capture->sdk_version);
+
+    Config::load(Common::FS::GetUserPath(Common::FS::PathType::CustomConfigs) /
+                     (capture->game_serial + ".toml"),
+                 true);
+
+    Common::Log::Initialize();
+    Common::Log::Start();
+    LOG_INFO(Loader, "Replaying frame {} of {} with shadps4 v{}", capture->frame_id,
+             capture->game_serial, Common::g_version);
+
+    auto* memory = Core::Memory::Instance();
+    memory->SetupMemoryRegions(ORBIS_FLEXIBLE_MEMORY_SIZE, true, true);
+
+    const Vulkan::Instance instance{Frontend::WindowSystemType::Headless, Config::getGpuId(),
+                                    Config::vkValidationEnabled(),
+                                    Config::getVkCrashDiagnosticEnabled()};
+    Vulkan::Scheduler scheduler{instance};
+    liverpool = std::make_unique<AmdGpu::Liverpool>();
+    auto rasterizer = std::make_unique<Vulkan::Rasterizer>(instance, scheduler, liverpool.get());
+
+    // Mapped after the rasterizer exists, so it tracks the memory like the mappings of a game
+    for (const auto& range : capture->memory) {
+        const PAddr phys_addr =
+            memory->Allocate(0, memory->GetTotalDirectSize(), range.data.size(), 16_KB, 0);
+        void* address{};
+        const s32 result = memory->MapMemory(
+            &address, range.address, range.data.size(),
+            MemoryProt::CpuReadWrite | MemoryProt::GpuReadWrite, MemoryMapFlags::Fixed,
+            VMAType::Direct, "FrameCapture", false, phys_addr);
+        if (result != ORBIS_OK) {
+            LOG_ERROR(Loader, "Could not map the captured memory at {:#x}", range.address);
+            return false;
+        }
+        std::memcpy(address, range.data.data(), range.data.size());
+    }
+
+    // The compute queues of the frame take the ids the game mapped them with
+    u32 num_asc_queues{};
+    for (const auto& queue : capture->queues) {
+        if (queue.type == DebugStateType::QueueType::acb) {
+            num_asc_queues = std::max(num_asc_queues, queue.num2);
+        }
+    }
+    std::vector<u32> asc_read_ptrs(num_asc_queues);
+    for (u32& read_ptr : asc_read_ptrs) {
+        liverpool->asc_queues.insert(VAddr{0}, &read_ptr, std::numeric_limits<u32>::max(), 0u);
+    }
+
+    LOG_INFO(Loader, "Mapped {} memory ranges, replaying {} command buffers {} times",
+             capture->memory.size(), capture->queues.size(), loops);
+
+    // The first replay compiles the pipelines and uploads the resources, it is only a warmup. A
+    // benchmark run decides itself when to stop.
+    const bool benchmark = Benchmark::IsRunning();
+    std::vector<double> frame_ms;
+    frame_ms.reserve(loops);
+    for (u32 loop = 0; benchmark || loop <= loops; ++loop) {
+        const auto start = std::chrono::steady_clock::now();
+        liverpool->SubmitGfx(capture->init_sequence, {});
+        const auto& queues = capture->queues;
+        for (size_t i = 0; i < queues.size(); ++i) {
+            const auto& queue = queues[i];
+            if (queue.type == DebugStateType::QueueType::acb) {
+                liverpool->SubmitAsc(queue.num2, queue.data);
+                continue;
+            }
+            if (queue.type != DebugStateType::QueueType::dcb) {
+                continue;
+            }
+            // Every dcb is dumped right before the ccb submitted with it
+            std::span<const u32> ccb{};
+            if (i + 1 < queues.size() && queues[i + 1].type == DebugStateType::QueueType::ccb &&
+                queues[i + 1].submit_num == queue.submit_num && queues[i + 1].num2 == queue.num2) {
+                ccb = queues[++i].data;
+            }
+            liverpool->SubmitGfx(queue.data, ccb);
+        }
+        liverpool->SubmitDone();
+        liverpool->WaitGpuIdle();
+        liverpool->SendCommand<true>([&] { rasterizer->Finish(); });
+        const auto elapsed = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start);
+        if (loop == 0) {
+            LOG_INFO(Loader, "Warmup replay took {:.2f} ms", elapsed.count());
+        } else {
+            frame_ms.push_back(elapsed.count());
+        }
+        if (benchmark && Benchmark::OnFrame(rasterizer->GetPipelineCache().GetCompileStats())) {
+            break;
+        }
+    }
+
+    const auto [min_ms, max_ms] = std::ranges::minmax(frame_ms);
+    const double avg_ms = std::accumulate(frame_ms.begin(), frame_ms.end(), 0.0) / frame_ms.size();
+    LOG_INFO(Loader, "Frame time over {} replays: avg {:.2f} ms, min {:.2f} ms, max {:.2f} ms, "
+                     "{:.1f} fps",
+             frame_ms.size(), avg_ms, min_ms, max_ms, 1000.0 / avg_ms);
+    const bool report_written = !benchmark || Benchmark::Finish();
+
+    rasterizer.reset();
+    liverpool.reset();
+    return report_written;
+}
+
 void Emulator::Restart(std::filesystem::path eboot_path,
                        const std::vector<std::string>& guest_args) {
     std::vector<std::string> args;
@@ -468,6 +876,7 @@ void Emulator::Restart(std::filesystem::path eboot_path,
     }
 
     LOG_INFO(Common, "Restarting the emulator with args: {}", fmt::join(args, " "));
+    Libraries::SaveData::SaveMemory::StopThread();
     Libraries::SaveData::Backup::StopThread();
     Common::Log::Denitializer();
 
@@ -31,6 +31,29 @@ public:
              std::optional<std::filesystem::path> game_folder = {});
     void UpdatePlayTime(const std::string& serial);
 
+    /**
+     * Rebuilds every shader module and pipeline stored in the pipeline cache of the given game
+     * without running it, and writes out the driver pipeline cache. Returns false when there was
+     * nothing to build.
+     */
+    bool BuildPipelineCache(const std::string& serial);
+
+    /**
+     * Translates the shaders stored in the pipeline cache of the given game from their dumped
+     * GCN code the given number of times, and logs the time spent in every recompiler stage,
+     * the IR memory and the size of the SPIR-V output. Returns false when no shader was found.
+     */
+    bool BenchShaders(const std::string& serial, u32 iterations);
+
+    /**
+     * Maps the guest memory of a frame capture saved from the frame dump viewer and submits its
+     * command buffers the given number of times on the GPU, without the game. Logs the time of
+     * every replay of the frame. While a benchmark run is active it decides the number of replays
+     * and gets every one of them. Returns false when the capture could not be loaded or the
+     * report of the benchmark could not be written.
+     */
+    bool ReplayFrameCapture(const std::filesystem::path& path, u32 loops);
+
     /**
      * This will kill the current process and launch a new process with the same configuration
      * (using CLI args) but replacing the eboot image and guest arguments
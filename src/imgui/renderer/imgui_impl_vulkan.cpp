@@ -7,6 +7,7 @@
 #include <mutex>
 
 #include <imgui.h>
+#include <xxhash.h>
 
 #include "imgui_impl_vulkan.h"
 
@@ -28,6 +29,7 @@ struct RenderBuffer {
 struct FrameRenderBuffers {
     RenderBuffer vertex;
     RenderBuffer index;
+    uint64_t data_hash{}; // Hash of the draw data uploaded to the buffers
 };
 
 // Each viewport will hold 1 WindowRenderBuffers
@@ -555,6 +557,18 @@ static void SetupRenderState(ImDrawData& draw_data, vk::Pipeline pipeline, vk::C
     }
 }
 
+static uint64_t HashDrawData(const ImDrawData& draw_data) {
+    uint64_t hash = XXH3_64bits(&draw_data.TotalVtxCount, sizeof(draw_data.TotalVtxCount));
+    for (int n = 0; n < draw_data.CmdListsCount; n++) {
+        const ImDrawList* cmd_list = draw_data.CmdLists[n];
+        hash = XXH3_64bits_withSeed(cmd_list->VtxBuffer.Data,
+                                    cmd_list->VtxBuffer.Size * sizeof(ImDrawVert), hash);
+        hash = XXH3_64bits_withSeed(cmd_list->IdxBuffer.Data, cmd_list->IdxBuffer.Size * IDX_SIZE,
+                                    hash);
+    }
+    return hash;
+}
+
 // Render function
 void RenderDrawData(ImDrawData& draw_data, vk::CommandBuffer command_buffer,
                     vk::Pipeline pipeline) {
@@ -573,11 +587,20 @@ void RenderDrawData(ImDrawData& draw_data, vk::CommandBuffer command_buffer,
     }
 
     // Allocate array to store enough vertex/index buffers
+    // When the draw data is the same as last frame, the buffers it was uploaded to are drawn from
+    // again. The GPU only reads them, so frames in flight can share them.
     WindowRenderBuffers& wrb = bd->render_buffers;
-    wrb.index = (wrb.index + 1) % wrb.count;
+    const uint64_t data_hash = draw_data.TotalVtxCount > 0 ? HashDrawData(draw_data) : 0;
+    const FrameRenderBuffers& last_frb = wrb.frame_render_buffers[wrb.index];
+    const bool is_unchanged = draw_data.TotalVtxCount > 0 &&
+                              last_frb.vertex.buffer != VK_NULL_HANDLE &&
+                              last_frb.data_hash == data_hash;
+    if (!is_unchanged) {
+        wrb.index = (wrb.index + 1) % wrb.count;
+    }
     FrameRenderBuffers& frb = wrb.frame_render_buffers[wrb.index];
 
-    if (draw_data.TotalVtxCount > 0) {
+    if (draw_data.TotalVtxCount > 0 && !is_unchanged) {
         // Create or resize the vertex/index buffers
         size_t vertex_size = AlignBufferSize(draw_data.TotalVtxCount * sizeof(ImDrawVert),
                                              bd->buffer_memory_alignment);
@@ -618,6 +641,7 @@ void RenderDrawData(ImDrawData& draw_data, vk::CommandBuffer command_buffer,
         CheckVkErr(v.device.flushMappedMemoryRanges({range}));
         v.device.unmapMemory(frb.vertex.buffer_memory);
         v.device.unmapMemory(frb.index.buffer_memory);
+        frb.data_hash = data_hash;
     }
 
     // Setup desired Vulkan state
@@ -146,25 +146,50 @@ void GameController::Axis(int id, Input::Axis axis, int value) {
     AddState(state);
 }
 
-void GameController::Gyro(int id, const float gyro[3]) {
+void GameController::AddSensorState(const State& state) {
+    // Both sensors of a report share its time, keep them in one state so high rate sensors do
+    // not push the button history out of the ring twice as fast
+    if (m_states_num != 0) {
+        const u32 last = (m_first_state + m_states_num - 1) % MAX_STATES;
+        if (!m_private[last].obtained && m_states[last].time == state.time) {
+            m_states[last] = state;
+            m_last_state = state;
+            return;
+        }
+    }
+    AddState(state);
+}
+
+void GameController::Gyro(int id, const float gyro[3], u64 time) {
     std::scoped_lock lock{m_mutex};
     auto state = GetLastState();
-    state.time = Libraries::Kernel::sceKernelGetProcessTime();
+    state.time = time != 0 ? time : Libraries::Kernel::sceKernelGetProcessTime();
 
     // Update the angular velocity (gyro data)
     state.OnGyro(gyro);
 
-    AddState(state);
+    // Integrate the orientation at the rate of the samples, with the time between them
+    const float delta_time =
+        m_last_gyro_time != 0 && state.time > m_last_gyro_time
+            ? static_cast<float>(state.time - m_last_gyro_time) / 1000000.0f
+            : 0.0f;
+    m_last_gyro_time = state.time;
+    CalculateOrientation(state.acceleration, state.angularVelocity, delta_time, m_orientation,
+                         state.orientation);
+    m_orientation = state.orientation;
+
+    AddSensorState(state);
 }
-void GameController::Acceleration(int id, const float acceleration[3]) {
+
+void GameController::Acceleration(int id, const float acceleration[3], u64 time) {
     std::scoped_lock lock{m_mutex};
     auto state = GetLastState();
-    state.time = Libraries::Kernel::sceKernelGetProcessTime();
+    state.time = time != 0 ? time : Libraries::Kernel::sceKernelGetProcessTime();
 
     // Update the acceleration values
     state.OnAccel(acceleration);
 
-    AddState(state);
+    AddSensorState(state);
 }
 
 void GameController::CalculateOrientation(Libraries::Pad::OrbisFVector3& acceleration,
@@ -283,16 +308,6 @@ Libraries::Pad::OrbisFQuaternion GameController::GetLastOrientation() {
     return m_orientation;
 }
 
-std::chrono::steady_clock::time_point GameController::GetLastUpdate() {
-    std::scoped_lock lock{m_mutex};
-    return m_last_update;
-}
-
-void GameController::SetLastUpdate(std::chrono::steady_clock::time_point lastUpdate) {
-    std::scoped_lock lock{m_mutex};
-    m_last_update = lastUpdate;
-}
-
 void GameController::SetEngine(std::unique_ptr<Engine> engine) {
     std::scoped_lock _{m_mutex};
     m_engine = std::move(engine);
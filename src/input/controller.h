@@ -75,9 +75,12 @@ public:
     State GetLastState() const;
     void CheckButton(int id, Libraries::Pad::OrbisPadButtonDataOffset button, bool isPressed);
     void AddState(const State& state);
+    void AddSensorState(const State& state);
     void Axis(int id, Input::Axis axis, int value);
-    void Gyro(int id, const float gyro[3]);
-    void Acceleration(int id, const float acceleration[3]);
+    /// Sensor samples take the process time of the report, in microseconds, or the current time
+    /// when it is 0. The gyro and accelerometer samples of a report are merged into one state.
+    void Gyro(int id, const float gyro[3], u64 time = 0);
+    void Acceleration(int id, const float acceleration[3], u64 time = 0);
     void SetLightBarRGB(u8 r, u8 g, u8 b);
     void SetVibration(u8 smallMotor, u8 largeMotor);
     void SetTouchpadState(int touchIndex, bool touchDown, float x, float y);
@@ -96,8 +99,6 @@ public:
 
     void SetLastOrientation(Libraries::Pad::OrbisFQuaternion& orientation);
     Libraries::Pad::OrbisFQuaternion GetLastOrientation();
-    std::chrono::steady_clock::time_point GetLastUpdate();
-    void SetLastUpdate(std::chrono::steady_clock::time_point lastUpdate);
     static void CalculateOrientation(Libraries::Pad::OrbisFVector3& acceleration,
                                      Libraries::Pad::OrbisFVector3& angularVelocity,
                                      float deltaTime,
@@ -122,7 +123,7 @@ private:
     bool m_was_secondary_reset = false;
     std::array<State, MAX_STATES> m_states;
     std::array<StateInternal, MAX_STATES> m_private;
-    std::chrono::steady_clock::time_point m_last_update = {};
+    u64 m_last_gyro_time = 0;
     Libraries::Pad::OrbisFQuaternion m_orientation = {0.0f, 0.0f, 0.0f, 1.0f};
 
     std::unique_ptr<Engine> m_engine = nullptr;
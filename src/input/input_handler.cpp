@@ -8,6 +8,7 @@
 #include <list>
 #include <map>
 #include <ranges>
+#include <span>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -60,6 +61,8 @@ std::pair<int, int> leftjoystick_deadzone, rightjoystick_deadzone, lefttrigger_d
 std::list<std::pair<InputEvent, bool>> pressed_keys;
 std::list<InputID> toggled_keys;
 static std::vector<BindingConnection> connections;
+// mask bits of the currently pressed keys, rebuilt for every update
+static u64 pressed_mask = 0;
 
 auto output_array = std::array{
     // Important: these have to be the first, or else they will update in the wrong order
@@ -713,17 +716,22 @@ InputEvent BindingConnection::ProcessBinding() {
         event.input = toggle;
     }
 
+    // Without toggled keys every key of the binding has to be pressed,
+    // so a key missing from the pressed mask rules the binding out right away
+    if (toggled_keys.empty() && (key_mask & ~pressed_mask) != 0) {
+        return event;
+    }
+
     // Extract keys from InputBinding and ignore unused or toggled keys
-    std::list<InputID> input_keys = {binding.keys[0], binding.keys[1], binding.keys[2]};
-    input_keys.remove(InputID());
-    for (auto key = input_keys.begin(); key != input_keys.end();) {
-        if (std::find(toggled_keys.begin(), toggled_keys.end(), *key) != toggled_keys.end()) {
-            key = input_keys.erase(key); // Use the returned iterator
-        } else {
-            ++key; // Increment only if no erase happened
+    std::array<InputID, 3> input_keys;
+    size_t num_input_keys = 0;
+    for (const InputID& key : binding.keys) {
+        if (key.IsValid() &&
+            std::find(toggled_keys.begin(), toggled_keys.end(), key) == toggled_keys.end()) {
+            input_keys[num_input_keys++] = key;
         }
     }
-    if (input_keys.empty()) {
+    if (num_input_keys == 0) {
         LOG_DEBUG(Input, "No actual inputs to check, returning true");
         event.active = true;
         return event;
@@ -733,17 +741,18 @@ InputEvent BindingConnection::ProcessBinding() {
     auto pressed_it = pressed_keys.begin();
 
     // Store pointers to flags in pressed_keys that need to be set if all keys are active
-    std::list<bool*> flags_to_set;
+    std::array<bool*, 3> flags_to_set;
+    size_t num_flags_to_set = 0;
 
     // Check if all keys in input_keys are active
-    for (InputID key : input_keys) {
+    for (const InputID& key : std::span{input_keys.data(), num_input_keys}) {
         bool key_found = false;
 
         while (pressed_it != pressed_keys.end()) {
             if (pressed_it->first.input == key && (pressed_it->second == false)) {
                 key_found = true;
                 if (output->positive_axis) {
-                    flags_to_set.push_back(&pressed_it->second);
+                    flags_to_set[num_flags_to_set++] = &pressed_it->second;
                 }
                 if (pressed_it->first.input.type == InputType::Axis) {
                     event.axis_value = pressed_it->first.axis_value;
@@ -758,7 +767,7 @@ InputEvent BindingConnection::ProcessBinding() {
         }
     }
 
-    for (bool* flag : flags_to_set) {
+    for (bool* flag : std::span{flags_to_set.data(), num_flags_to_set}) {
         *flag = true;
     }
     if (binding.keys[0].type != InputType::Axis) { // the axes spam inputs, making this unreadable
@@ -770,8 +779,10 @@ InputEvent BindingConnection::ProcessBinding() {
 
 void ActivateOutputsFromInputs() {
     // Reset values and flags
+    pressed_mask = 0;
     for (auto& it : pressed_keys) {
         it.second = false;
+        pressed_mask |= it.first.input.MaskBit();
     }
     for (auto& it : output_array) {
         it.ResetUpdate();
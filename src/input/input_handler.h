@@ -88,6 +88,12 @@ public:
     bool IsValid() const {
         return *this != InputID();
     }
+    // bit of the input in the masks used to rule out bindings without walking the pressed keys,
+    // several inputs can share a bit
+    u64 MaskBit() const {
+        const u64 hash = (static_cast<u64>(type) << 32 | sdl_id) * 0x9E3779B97F4A7C15ULL;
+        return u64{1} << (hash >> 58);
+    }
     std::string ToString() {
         return fmt::format("({}: {:x})", input_type_names[static_cast<u8>(type)], sdl_id);
     }
@@ -468,12 +474,20 @@ public:
     ControllerOutput* output;
     u32 axis_param;
     InputID toggle;
+    // mask bits of all keys of the binding, it can only be active if they are all pressed
+    u64 key_mask;
 
     BindingConnection(InputBinding b, ControllerOutput* out, u32 param = 0, InputID t = InputID()) {
         binding = b;
         axis_param = param;
         output = out;
         toggle = t;
+        key_mask = 0;
+        for (const InputID& key : binding.keys) {
+            if (key.IsValid()) {
+                key_mask |= key.MaskBit();
+            }
+        }
     }
     bool operator<(const BindingConnection& other) const {
         // a button is a higher priority than an axis, as buttons can influence axes
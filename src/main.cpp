@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2025-2026 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <cctype>
 #include <SDL3/SDL_messagebox.h>
 #include "functional"
 #include "iostream"
@@ -14,6 +16,7 @@
 #include "common/logging/backend.h"
 #include "common/memory_patcher.h"
 #include "common/path_util.h"
+#include "core/benchmark.h"
 #include "core/debugger.h"
 #include "core/file_sys/fs.h"
 #include "core/ipc/ipc.h"
@@ -53,13 +56,20 @@ int main(int argc, char* argv[]) {
 
     bool waitForDebugger = false;
     std::optional<int> waitPid;
+    std::optional<std::string> build_cache_serial;
+    std::optional<std::string> bench_shaders_serial;
+    u32 bench_iterations = 10;
+    std::optional<std::filesystem::path> replay_capture_path;
+    u32 replay_loops = 100;
+    std::optional<Core::Benchmark::Options> benchmark_options;
+    std::filesystem::path benchmark_report_path;
 
     // Map of argument strings to lambda functions
     std::unordered_map<std::string, std::function<void(int&)>> arg_map = {
         {"-h",
          [&](int&) {
              std::cout
-                 << "Usage: shadps4 [options] <elf or eboot.bin path>\n"
+                 << "Usage: shadps4 [options] <elf, eboot.bin or PFS image path>\n"
                     "Options:\n"
                     "  -g, --game <path|ID>          Specify game path to launch\n"
                     " -- ...                         Parameters passed to the game ELF. "
@@ -82,6 +92,16 @@ int main(int argc, char* argv[]) {
                     "  --config-global               Run the emulator with the base config file "
                     "only, ignores game specific configs.\n"
                     "  --show-fps                    Enable FPS counter display at startup\n"
+                    "  --build-pipeline-cache <ID>   Rebuild the pipeline cache of the game "
+                    "with the given ID without running it, then exit.\n"
+                    "  --bench-shaders <ID> [N]      Translate the dumped shaders of the game "
+                    "with the given ID N times (default 10), log recompiler stats, then exit.\n"
+                    "  --replay-capture <file> [N]   Replay a saved frame capture N times "
+                    "(default 100) without the game, log frame times, then exit.\n"
+                    "  --benchmark <N|Ns>            Measure N frames or N seconds of the game or "
+                    "of --replay-capture after its first frame, write a JSON report, then exit.\n"
+                    "  --benchmark-report <file>     Where to write the benchmark report, "
+                    "defaults to the log folder.\n"
                     "  -h, --help                    Display this help message\n";
              exit(0);
          }},
@@ -197,7 +217,58 @@ int main(int argc, char* argv[]) {
              }
              waitPid = std::stoi(argv[i]);
          }},
-        {"--show-fps", [&](int& i) { Config::setShowFpsCounter(true); }}};
+        {"--show-fps", [&](int& i) { Config::setShowFpsCounter(true); }},
+        {"--build-pipeline-cache",
+         [&](int& i) {
+             if (++i >= argc) {
+                 std::cerr << "Error: Missing argument for --build-pipeline-cache\n";
+                 exit(1);
+             }
+             build_cache_serial = argv[i];
+         }},
+        {"--bench-shaders",
+         [&](int& i) {
+             if (++i >= argc) {
+                 std::cerr << "Error: Missing argument for --bench-shaders\n";
+                 exit(1);
+             }
+             bench_shaders_serial = argv[i];
+             if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                 bench_iterations = std::max(std::stoi(argv[++i]), 1);
+             }
+         }},
+        {"--replay-capture",
+         [&](int& i) {
+             if (++i >= argc) {
+                 std::cerr << "Error: Missing argument for --replay-capture\n";
+                 exit(1);
+             }
+             replay_capture_path = argv[i];
+             if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                 replay_loops = std::max(std::stoi(argv[++i]), 1);
+             }
+         }},
+        {"--benchmark",
+         [&](int& i) {
+             if (++i >= argc || !std::isdigit(static_cast<unsigned char>(argv[i][0]))) {
+                 std::cerr << "Error: Missing frame or second count for --benchmark\n";
+                 exit(1);
+             }
+             const std::string_view limit{argv[i]};
+             const u32 count = std::max(std::stoi(argv[i]), 1);
+             benchmark_options = Core::Benchmark::Options{
+                 .num_frames = limit.ends_with('s') ? 0 : count,
+                 .num_seconds = limit.ends_with('s') ? count : 0,
+             };
+         }},
+        {"--benchmark-report",
+         [&](int& i) {
+             if (++i >= argc) {
+                 std::cerr << "Error: Missing argument for --benchmark-report\n";
+                 exit(1);
+             }
+             benchmark_report_path = argv[i];
+         }}};
 
     if (argc == 1) {
         if (!SDL_ShowSimpleMessageBox(
@@ -240,6 +311,24 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (build_cache_serial.has_value()) {
+        Core::Emulator* emulator = Common::Singleton<Core::Emulator>::Instance();
+        return emulator->BuildPipelineCache(*build_cache_serial) ? 0 : 1;
+    }
+    if (bench_shaders_serial.has_value()) {
+        Core::Emulator* emulator = Common::Singleton<Core::Emulator>::Instance();
+        return emulator->BenchShaders(*bench_shaders_serial, bench_iterations) ? 0 : 1;
+    }
+    if (benchmark_options.has_value()) {
+        benchmark_options->mode = replay_capture_path.has_value() ? "capture" : "game";
+        benchmark_options->report_path = std::move(benchmark_report_path);
+        Core::Benchmark::Start(std::move(*benchmark_options));
+    }
+    if (replay_capture_path.has_value()) {
+        Core::Emulator* emulator = Common::Singleton<Core::Emulator>::Instance();
+        return emulator->ReplayFrameCapture(*replay_capture_path, replay_loops) ? 0 : 1;
+    }
+
     // If no game directory is set and no command line argument, prompt for it
     if (Config::getGameInstallDirs().empty()) {
         std::cerr << "Warning: No game folder set, please set it by calling shadps4"
@@ -280,6 +280,15 @@ static Uint32 SDLCALL PollAllTasks(void* userdata, SDL_TimerID timer_id, Uint32
     return interval; // Continue timer
 }
 
+/// Converts the SDL timestamp of an event to process time, so samples keep the time they were
+/// reported at rather than the time the event loop got to them.
+static u64 GetEventProcessTime(u64 timestamp_ns) {
+    const u64 now = Libraries::Kernel::sceKernelGetProcessTime();
+    const u64 now_ns = SDL_GetTicksNS();
+    const u64 age_us = now_ns > timestamp_ns ? (now_ns - timestamp_ns) / 1000 : 0;
+    return now > age_us ? now - age_us : now;
+}
+
 WindowSDL::WindowSDL(s32 width_, s32 height_, Input::GameController* controller_,
                      std::string_view window_title)
     : width{width_}, height{height_}, controller{controller_} {
@@ -324,6 +333,7 @@ WindowSDL::WindowSDL(s32 width_, s32 height_, Input::GameController* controller_
             window, Config::getFullscreenMode() == "Fullscreen" ? displayMode : NULL);
     }
     SDL_SetWindowFullscreen(window, Config::getIsFullscreen());
+    UpdateRefreshRate();
 
     SDL_InitSubSystem(SDL_INIT_GAMEPAD);
     controller->SetEngine(std::make_unique<Input::SDLInputEngine>());
@@ -385,6 +395,10 @@ void WindowSDL::WaitEvent() {
         is_shown = event.type == SDL_EVENT_WINDOW_EXPOSED;
         OnResize();
         break;
+    case SDL_EVENT_WINDOW_DISPLAY_CHANGED:
+    case SDL_EVENT_DISPLAY_CURRENT_MODE_CHANGED:
+        UpdateRefreshRate();
+        break;
     case SDL_EVENT_MOUSE_BUTTON_DOWN:
     case SDL_EVENT_MOUSE_BUTTON_UP:
     case SDL_EVENT_MOUSE_WHEEL:
@@ -414,10 +428,11 @@ void WindowSDL::WaitEvent() {
     case SDL_EVENT_GAMEPAD_SENSOR_UPDATE:
         switch ((SDL_SensorType)event.gsensor.sensor) {
         case SDL_SENSOR_GYRO:
-            controller->Gyro(0, event.gsensor.data);
+            controller->Gyro(0, event.gsensor.data, GetEventProcessTime(event.gsensor.timestamp));
             break;
         case SDL_SENSOR_ACCEL:
-            controller->Acceleration(0, event.gsensor.data);
+            controller->Acceleration(0, event.gsensor.data,
+                                     GetEventProcessTime(event.gsensor.timestamp));
             break;
         default:
             break;
@@ -506,6 +521,14 @@ void WindowSDL::OnResize() {
     ImGui::Core::OnResize();
 }
 
+void WindowSDL::UpdateRefreshRate() {
+    const SDL_DisplayMode* mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(window));
+    const float rate = mode ? mode->refresh_rate : 0.0f;
+    if (rate != refresh_rate.exchange(rate, std::memory_order_relaxed)) {
+        LOG_INFO(Frontend, "Display refresh rate is {:.3f} Hz", rate);
+    }
+}
+
 Uint32 wheelOffCallback(void* og_event, Uint32 timer_id, Uint32 interval) {
     SDL_Event off_event = *(SDL_Event*)og_event;
     off_event.type = SDL_EVENT_MOUSE_WHEEL_OFF;
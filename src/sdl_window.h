@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <string>
 
 #include "common/types.h"
@@ -86,6 +87,11 @@ public:
         return window_info;
     }
 
+    /// Refresh rate of the display showing the window, 0 when it is unknown.
+    float GetRefreshRate() const {
+        return refresh_rate.load(std::memory_order_relaxed);
+    }
+
     void WaitEvent();
     void InitTimers();
 
@@ -96,6 +102,7 @@ private:
     void OnResize();
     void OnKeyboardMouseInput(const SDL_Event* event);
     void OnGamepadEvent(const SDL_Event* event);
+    void UpdateRefreshRate();
 
 private:
     s32 width;
@@ -105,6 +112,7 @@ private:
     SDL_Window* window{};
     bool is_shown{};
     bool is_open{true};
+    std::atomic<float> refresh_rate{};
 };
 
 } // namespace Frontend
@@ -155,6 +155,14 @@ Id EmitGetAttributeU32(EmitContext& ctx, IR::Attribute attr, u32 comp) {
         return ctx.OpLoad(ctx.U32[1], ctx.vertex_index);
     case IR::Attribute::InstanceId:
         return ctx.OpLoad(ctx.U32[1], ctx.instance_id);
+    case IR::Attribute::InstanceStepRate0:
+    case IR::Attribute::InstanceStepRate1: {
+        const u32 index = attr == IR::Attribute::InstanceStepRate0 ? PushData::StepRate0Index
+                                                                    : PushData::StepRate1Index;
+        const Id ptr{ctx.OpAccessChain(ctx.TypePointer(spv::StorageClass::PushConstant, ctx.U32[1]),
+                                       ctx.push_data_block, ctx.ConstU32(index))};
+        return ctx.OpLoad(ctx.U32[1], ptr);
+    }
     case IR::Attribute::WorkgroupIndex:
         return ctx.workgroup_index_id;
     case IR::Attribute::WorkgroupId:
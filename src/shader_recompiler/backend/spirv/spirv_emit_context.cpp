@@ -700,9 +700,13 @@ void EmitContext::DefineOutputs() {
 
 void EmitContext::DefinePushDataBlock() {
     // Create push constants block for instance steps rates
-    const Id struct_type{Name(TypeStruct(F32[1], F32[1], F32[1], F32[1], U32[4], U32[4], U32[4],
-                                         U32[4], U32[4], U32[4], U32[2]),
-                              "AuxData")};
+    const Id struct_type{Name(
+        profile.bindless_samplers
+            ? TypeStruct(F32[1], F32[1], F32[1], F32[1], U32[4], U32[4], U32[4], U32[4], U32[4],
+                         U32[4], U32[2], U32[1], U32[1], U32[4], U32[4], U32[4], U32[4])
+            : TypeStruct(F32[1], F32[1], F32[1], F32[1], U32[4], U32[4], U32[4], U32[4], U32[4],
+                         U32[4], U32[2], U32[1], U32[1]),
+        "AuxData")};
     Decorate(struct_type, spv::Decoration::Block);
     MemberName(struct_type, PushData::XOffsetIndex, "xoffset");
     MemberName(struct_type, PushData::YOffsetIndex, "yoffset");
@@ -715,6 +719,8 @@ void EmitContext::DefinePushDataBlock() {
     MemberName(struct_type, PushData::BufOffsetIndex + 0, "buf_offsets0");
     MemberName(struct_type, PushData::BufOffsetIndex + 1, "buf_offsets1");
     MemberName(struct_type, PushData::BufOffsetIndex + 2, "buf_offsets2");
+    MemberName(struct_type, PushData::StepRate0Index, "step_rate0");
+    MemberName(struct_type, PushData::StepRate1Index, "step_rate1");
     MemberDecorate(struct_type, PushData::XOffsetIndex, spv::Decoration::Offset, 0U);
     MemberDecorate(struct_type, PushData::YOffsetIndex, spv::Decoration::Offset, 4U);
     MemberDecorate(struct_type, PushData::XScaleIndex, spv::Decoration::Offset, 8U);
@@ -726,6 +732,16 @@ void EmitContext::DefinePushDataBlock() {
     MemberDecorate(struct_type, PushData::BufOffsetIndex + 0, spv::Decoration::Offset, 80U);
     MemberDecorate(struct_type, PushData::BufOffsetIndex + 1, spv::Decoration::Offset, 96U);
     MemberDecorate(struct_type, PushData::BufOffsetIndex + 2, spv::Decoration::Offset, 112U);
+    MemberDecorate(struct_type, PushData::StepRate0Index, spv::Decoration::Offset, 120U);
+    MemberDecorate(struct_type, PushData::StepRate1Index, spv::Decoration::Offset, 124U);
+    if (profile.bindless_samplers) {
+        for (u32 i = 0; i < NUM_BINDLESS_SAMPLERS / 4; ++i) {
+            const u32 member = BindlessPushData::SamplerSlotsIndex + i;
+            MemberName(struct_type, member, fmt::format("sampler_slots{}", i));
+            MemberDecorate(struct_type, member, spv::Decoration::Offset,
+                           BindlessPushData::Offset + i * 16);
+        }
+    }
     push_data_block = DefineVar(struct_type, spv::StorageClass::PushConstant);
     Name(push_data_block, "push_data");
     interfaces.push_back(push_data_block);
@@ -959,8 +975,15 @@ void EmitContext::DefineImagesAndSamplers() {
     sampler_type = TypeSampler();
     sampler_pointer_type = TypePointer(spv::StorageClass::UniformConstant, sampler_type);
     for (const auto& samp_desc : info.samplers) {
+        // Bindless samplers keep their binding number unused, so the others don't move
+        const u32 sampler_index = binding.sampler++;
+        const u32 sampler_binding = binding.unified++;
+        if (profile.bindless_samplers && sampler_index < NUM_BINDLESS_SAMPLERS) {
+            samplers.push_back({DefineSamplerHeap(), sampler_index, true});
+            continue;
+        }
         const Id id{AddGlobalVariable(sampler_pointer_type, spv::StorageClass::UniformConstant)};
-        Decorate(id, spv::Decoration::Binding, binding.unified++);
+        Decorate(id, spv::Decoration::Binding, sampler_binding);
         Decorate(id, spv::Decoration::DescriptorSet, 0U);
         const auto sharp_desc =
             samp_desc.is_inline_sampler
@@ -968,11 +991,39 @@ void EmitContext::DefineImagesAndSamplers() {
                               samp_desc.inline_sampler.raw1)
                 : fmt::format("sgpr:{}", samp_desc.sharp_idx);
         Name(id, fmt::format("{}_{}{}", stage, "samp", sharp_desc));
-        samplers.push_back(id);
+        samplers.push_back({id, 0, false});
         interfaces.push_back(id);
     }
 }
 
+Id EmitContext::DefineSamplerHeap() {
+    if (Sirit::ValidId(sampler_heap)) {
+        return sampler_heap;
+    }
+    const Id heap_type{TypeRuntimeArray(sampler_type)};
+    sampler_heap = AddGlobalVariable(TypePointer(spv::StorageClass::UniformConstant, heap_type),
+                                     spv::StorageClass::UniformConstant);
+    Decorate(sampler_heap, spv::Decoration::Binding, 0U);
+    Decorate(sampler_heap, spv::Decoration::DescriptorSet, 1U);
+    Name(sampler_heap, "sampler_heap");
+    interfaces.push_back(sampler_heap);
+    return sampler_heap;
+}
+
+Id EmitContext::LoadSampler(u32 index) {
+    const auto& sampler = samplers[index];
+    if (!sampler.is_bindless) {
+        return OpLoad(sampler_type, sampler.id);
+    }
+    // The slot is the same for every invocation of the draw, no non uniform access is needed
+    const u32 member = BindlessPushData::SamplerSlotsIndex + (sampler.bindless_index >> 2);
+    const Id slot_ptr{OpAccessChain(TypePointer(spv::StorageClass::PushConstant, U32[1]),
+                                    push_data_block, ConstU32(member),
+                                    ConstU32(sampler.bindless_index & 3))};
+    const Id slot{OpLoad(U32[1], slot_ptr)};
+    return OpLoad(sampler_type, OpAccessChain(sampler_pointer_type, sampler.id, slot));
+}
+
 void EmitContext::DefineSharedMemory() {
     const auto num_types = std::popcount(static_cast<u32>(info.shared_types));
     if (num_types == 0) {
@@ -44,6 +44,9 @@ public:
 
     Id Def(const IR::Value& value);
 
+    /// Loads the sampler with the given index, from the sampler heap when it is bindless.
+    Id LoadSampler(u32 index);
+
     void DefineBufferProperties();
     void DefineAmdPerVertexAttribs();
     void DefineWorkgroupIndex();
@@ -346,11 +349,18 @@ public:
         }
     };
 
+    struct SamplerDefinition {
+        Id id;              ///< Sampler variable, or the sampler heap when bindless
+        u32 bindless_index; ///< Index of its heap slot in the push constants
+        bool is_bindless;
+    };
+
     Bindings& binding;
     boost::container::small_vector<Id, 16> buf_type_ids;
     boost::container::small_vector<BufferDefinition, 16> buffers;
     boost::container::small_vector<TextureDefinition, 8> images;
-    boost::container::small_vector<Id, 4> samplers;
+    boost::container::small_vector<SamplerDefinition, 4> samplers;
+    Id sampler_heap{};
     std::unordered_map<u32, Id> first_to_last_label_map;
 
     size_t flatbuf_index{};
@@ -398,6 +408,7 @@ private:
     void DefinePushDataBlock();
     void DefineBuffers();
     void DefineImagesAndSamplers();
+    Id DefineSamplerHeap();
     void DefineSharedMemory();
     void DefineFunctions();
 
@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "common/types.h"
+
+namespace Shader {
+
+/// Timing and size of a single IR pass.
+struct PassStats {
+    std::string_view name;
+    u64 time_us;
+    u32 insts_before;
+    u32 insts_after;
+};
+
+/// Statistics of one shader translation, from decoding the guest code to SPIR-V emission.
+struct CompileStats {
+    u32 num_gcn_insts{};
+    u64 decode_us{};
+    u64 cfg_us{};
+    u64 structurize_us{};
+    std::vector<PassStats> passes{};
+    u64 emit_us{};
+    u32 spirv_size{};
+    u32 num_fp64_insts{}; ///< Double precision instructions left after the IR passes
+    u32 num_tess_accesses{};         ///< Tessellation ring accesses lowered to attributes
+    u32 num_dynamic_tess_accesses{}; ///< Ring accesses with attribute indices known at runtime
+
+    u64 PassesUs() const {
+        u64 total{};
+        for (const auto& pass : passes) {
+            total += pass.time_us;
+        }
+        return total;
+    }
+
+    u64 TotalUs() const {
+        return decode_us + cfg_us + structurize_us + PassesUs() + emit_us;
+    }
+};
+
+} // namespace Shader
@@ -2,6 +2,8 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <array>
+#include <utility>
 #include "common/assert.h"
 #include "shader_recompiler/frontend/decode.h"
 
@@ -16,74 +18,76 @@ T extract(T value, u32 lst, u32 fst) {
 }
 } // namespace bit
 
-InstEncoding GetInstructionEncoding(u32 token) {
-    auto encoding = static_cast<InstEncoding>(token & (u32)EncodingMask::MASK_9bit);
+namespace {
+
+constexpr u32 EncodingLength(InstEncoding encoding) {
     switch (encoding) {
     case InstEncoding::SOP1:
     case InstEncoding::SOPP:
     case InstEncoding::SOPC:
-        return encoding;
-    default:
-        break;
-    }
-
-    encoding = static_cast<InstEncoding>(token & (u32)EncodingMask::MASK_7bit);
-    switch (encoding) {
+    case InstEncoding::SOPK:
+    case InstEncoding::SOP2:
     case InstEncoding::VOP1:
     case InstEncoding::VOPC:
-        return encoding;
-    default:
-        break;
-    }
-
-    encoding = static_cast<InstEncoding>(token & (u32)EncodingMask::MASK_6bit);
-    switch (encoding) {
-    case InstEncoding::VOP3:
-    case InstEncoding::EXP:
+    case InstEncoding::VOP2:
+    case InstEncoding::SMRD:
     case InstEncoding::VINTRP:
-    case InstEncoding::DS:
+        return sizeof(u32);
+    case InstEncoding::VOP3:
     case InstEncoding::MUBUF:
     case InstEncoding::MTBUF:
     case InstEncoding::MIMG:
-        return encoding;
-    default:
-        break;
-    }
-
-    encoding = static_cast<InstEncoding>(token & (u32)EncodingMask::MASK_5bit);
-    switch (encoding) {
-    case InstEncoding::SMRD:
-        return encoding;
-    default:
-        break;
-    }
-
-    encoding = static_cast<InstEncoding>(token & (u32)EncodingMask::MASK_4bit);
-    switch (encoding) {
-    case InstEncoding::SOPK:
-        return encoding;
+    case InstEncoding::DS:
+    case InstEncoding::EXP:
+        return sizeof(u64);
     default:
-        break;
+        return 0;
     }
+}
 
-    encoding = static_cast<InstEncoding>(token & (u32)EncodingMask::MASK_2bit);
-    switch (encoding) {
-    case InstEncoding::SOP2:
-        return encoding;
-    default:
-        break;
+struct EncodingInfo {
+    InstEncoding encoding = InstEncoding::ILLEGAL;
+    u32 length = 0;
+};
+
+/// Encoding of an instruction indexed by the top 9 bits of its first dword, which hold the
+/// longest encoding mask. Masks are tried from the longest to the shortest.
+constexpr std::array<EncodingInfo, 512> EncodingTable = [] {
+    constexpr std::array<std::pair<EncodingMask, InstEncoding>, 16> encodings = {{
+        {EncodingMask::MASK_9bit, InstEncoding::SOP1},
+        {EncodingMask::MASK_9bit, InstEncoding::SOPP},
+        {EncodingMask::MASK_9bit, InstEncoding::SOPC},
+        {EncodingMask::MASK_7bit, InstEncoding::VOP1},
+        {EncodingMask::MASK_7bit, InstEncoding::VOPC},
+        {EncodingMask::MASK_6bit, InstEncoding::VOP3},
+        {EncodingMask::MASK_6bit, InstEncoding::EXP},
+        {EncodingMask::MASK_6bit, InstEncoding::VINTRP},
+        {EncodingMask::MASK_6bit, InstEncoding::DS},
+        {EncodingMask::MASK_6bit, InstEncoding::MUBUF},
+        {EncodingMask::MASK_6bit, InstEncoding::MTBUF},
+        {EncodingMask::MASK_6bit, InstEncoding::MIMG},
+        {EncodingMask::MASK_5bit, InstEncoding::SMRD},
+        {EncodingMask::MASK_4bit, InstEncoding::SOPK},
+        {EncodingMask::MASK_2bit, InstEncoding::SOP2},
+        {EncodingMask::MASK_1bit, InstEncoding::VOP2},
+    }};
+    std::array<EncodingInfo, 512> table{};
+    for (u32 index = 0; index < table.size(); ++index) {
+        const u32 token = index << 23;
+        for (const auto& [mask, encoding] : encodings) {
+            if ((token & static_cast<u32>(mask)) == static_cast<u32>(encoding)) {
+                table[index] = {encoding, EncodingLength(encoding)};
+                break;
+            }
+        }
     }
+    return table;
+}();
 
-    encoding = static_cast<InstEncoding>(token & (u32)EncodingMask::MASK_1bit);
-    switch (encoding) {
-    case InstEncoding::VOP2:
-        return encoding;
-    default:
-        break;
-    }
+} // Anonymous namespace
 
-    UNREACHABLE();
-    return InstEncoding::ILLEGAL;
+InstEncoding GetInstructionEncoding(u32 token) {
+    return EncodingTable[token >> 23].encoding;
 }
 
 bool HasAdditionalLiteral(InstEncoding encoding, Opcode opcode) {
@@ -110,9 +114,8 @@ bool IsVop3BEncoding(Opcode opcode) {
 GcnInst GcnDecodeContext::decodeInstruction(GcnCodeSlice& code) {
     const uint32_t token = code.at(0);
 
-    InstEncoding encoding = GetInstructionEncoding(token);
+    const auto [encoding, encodingLen] = EncodingTable[token >> 23];
     ASSERT_MSG(encoding != InstEncoding::ILLEGAL, "illegal encoding");
-    uint32_t encodingLen = getEncodingLength(encoding);
 
     // Clear the instruction
     m_instruction = GcnInst();
@@ -138,34 +141,7 @@ GcnInst GcnDecodeContext::decodeInstruction(GcnCodeSlice& code) {
 }
 
 uint32_t GcnDecodeContext::getEncodingLength(InstEncoding encoding) {
-    uint32_t instLength = 0;
-
-    switch (encoding) {
-    case InstEncoding::SOP1:
-    case InstEncoding::SOPP:
-    case InstEncoding::SOPC:
-    case InstEncoding::SOPK:
-    case InstEncoding::SOP2:
-    case InstEncoding::VOP1:
-    case InstEncoding::VOPC:
-    case InstEncoding::VOP2:
-    case InstEncoding::SMRD:
-    case InstEncoding::VINTRP:
-        instLength = sizeof(uint32_t);
-        break;
-
-    case InstEncoding::VOP3:
-    case InstEncoding::MUBUF:
-    case InstEncoding::MTBUF:
-    case InstEncoding::MIMG:
-    case InstEncoding::DS:
-    case InstEncoding::EXP:
-        instLength = sizeof(uint64_t);
-        break;
-    default:
-        break;
-    }
-    return instLength;
+    return EncodingLength(encoding);
 }
 
 uint32_t GcnDecodeContext::getOpMapOffset(InstEncoding encoding) {
@@ -255,7 +231,8 @@ uint32_t GcnDecodeContext::mapEncodingOp(InstEncoding encoding, Opcode opcode) {
 
 void GcnDecodeContext::updateInstructionMeta(InstEncoding encoding) {
     uint32_t encodingOp = mapEncodingOp(encoding, m_instruction.opcode);
-    InstFormat instFormat = InstructionFormat(encoding, encodingOp);
+    m_format = InstructionFormat(encoding, encodingOp);
+    const InstFormat& instFormat = m_format;
 
     ASSERT_MSG(instFormat.src_type != ScalarType::Undefined &&
                    instFormat.dst_type != ScalarType::Undefined,
@@ -403,10 +380,8 @@ void GcnDecodeContext::decodeInstruction64(InstEncoding encoding, GcnCodeSlice&
 
 void GcnDecodeContext::decodeLiteralConstant(InstEncoding encoding, GcnCodeSlice& code) {
     if (HasAdditionalLiteral(encoding, m_instruction.opcode)) {
-        u32 encoding_op = mapEncodingOp(encoding, m_instruction.opcode);
-        InstFormat instFormat = InstructionFormat(encoding, encoding_op);
         m_instruction.src[m_instruction.src_count].field = OperandField::LiteralConst;
-        m_instruction.src[m_instruction.src_count].type = instFormat.src_type;
+        m_instruction.src[m_instruction.src_count].type = m_format.src_type;
         m_instruction.src[m_instruction.src_count].code = code.readu32();
         ++m_instruction.src_count;
         m_instruction.length += sizeof(u32);
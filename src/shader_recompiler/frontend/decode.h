@@ -92,6 +92,7 @@ private:
 
 private:
     GcnInst m_instruction;
+    InstFormat m_format; ///< Format of m_instruction, looked up once its opcode is decoded
 };
 
 } // namespace Shader::Gcn
@@ -68,6 +68,8 @@ void Translator::EmitDataShare(const GcnInst& inst) {
         return DS_CONSUME(inst);
     case Opcode::DS_APPEND:
         return DS_APPEND(inst);
+    case Opcode::DS_ORDERED_COUNT:
+        return DS_ORDERED_COUNT(inst);
     case Opcode::DS_WRITE_B16:
         return DS_WRITE(16, false, false, false, inst);
     case Opcode::DS_WRITE_B64:
@@ -78,6 +80,14 @@ void Translator::EmitDataShare(const GcnInst& inst) {
         return DS_WRITE(64, false, true, true, inst);
     case Opcode::DS_READ_B64:
         return DS_READ(64, false, false, false, inst);
+    case Opcode::DS_WRITE_B96:
+        return DS_WRITE(96, false, false, false, inst);
+    case Opcode::DS_WRITE_B128:
+        return DS_WRITE(128, false, false, false, inst);
+    case Opcode::DS_READ_B96:
+        return DS_READ(96, false, false, false, inst);
+    case Opcode::DS_READ_B128:
+        return DS_READ(128, false, false, false, inst);
     case Opcode::DS_READ2_B64:
         return DS_READ(64, false, true, false, inst);
     case Opcode::DS_READ2ST64_B64:
@@ -183,6 +193,25 @@ void Translator::DS_WRITE(int bit_size, bool is_signed, bool is_pair, bool strid
         ir.SetVectorReg(GetScratchVgpr(offset), ir.GetVectorReg(data0));
         return;
     }
+    if (bit_size > 64) {
+        // Wider accesses are 16 byte aligned, so they are split into a 64-bit access and the
+        // remaining dwords, which keeps them whole where shared memory has a 64-bit view.
+        const IR::U32 addr0 = ir.IAdd(addr, ir.Imm32(offset));
+        ir.WriteShared(64,
+                       ir.PackUint2x32(ir.CompositeConstruct(ir.GetVectorReg(data0),
+                                                             ir.GetVectorReg(data0 + 1))),
+                       addr0, is_gds);
+        const IR::U32 addr1 = ir.IAdd(addr, ir.Imm32(offset + 8));
+        if (bit_size == 128) {
+            ir.WriteShared(64,
+                           ir.PackUint2x32(ir.CompositeConstruct(ir.GetVectorReg(data0 + 2),
+                                                                 ir.GetVectorReg(data0 + 3))),
+                           addr1, is_gds);
+        } else {
+            ir.WriteShared(32, ir.GetVectorReg(data0 + 2), addr1, is_gds);
+        }
+        return;
+    }
     if (is_pair) {
         const u32 adj = (bit_size == 32 ? 4 : 8) * (stride64 ? 64 : 1);
         const IR::U32 addr0 = ir.IAdd(addr, ir.Imm32(u32(inst.control.ds.offset0 * adj)));
@@ -233,6 +262,23 @@ void Translator::DS_READ(int bit_size, bool is_signed, bool is_pair, bool stride
         ir.SetVectorReg(dst_reg, ir.GetVectorReg(GetScratchVgpr(offset)));
         return;
     }
+    if (bit_size > 64) {
+        // Split like DS_WRITE
+        const IR::U32 addr0 = ir.IAdd(addr, ir.Imm32(offset));
+        const auto vector0 = ir.UnpackUint2x32(IR::U64{ir.LoadShared(64, false, addr0, is_gds)});
+        ir.SetVectorReg(dst_reg++, IR::U32{ir.CompositeExtract(vector0, 0)});
+        ir.SetVectorReg(dst_reg++, IR::U32{ir.CompositeExtract(vector0, 1)});
+        const IR::U32 addr1 = ir.IAdd(addr, ir.Imm32(offset + 8));
+        if (bit_size == 128) {
+            const auto vector1 =
+                ir.UnpackUint2x32(IR::U64{ir.LoadShared(64, false, addr1, is_gds)});
+            ir.SetVectorReg(dst_reg++, IR::U32{ir.CompositeExtract(vector1, 0)});
+            ir.SetVectorReg(dst_reg++, IR::U32{ir.CompositeExtract(vector1, 1)});
+        } else {
+            ir.SetVectorReg(dst_reg++, IR::U32{ir.LoadShared(32, false, addr1, is_gds)});
+        }
+        return;
+    }
     if (is_pair) {
         // Pair loads are either 32 or 64-bit
         const u32 adj = (bit_size == 32 ? 4 : 8) * (stride64 ? 64 : 1);
@@ -277,12 +323,28 @@ void Translator::DS_SWIZZLE_B32(const GcnInst& inst) {
     const u8 offset0 = inst.control.ds.offset0;
     const u8 offset1 = inst.control.ds.offset1;
     const IR::U32 src{GetSrc(inst.src[0])};
-    // ASSERT(offset1 & 0x80);
     const IR::U32 lane_id = ir.LaneId();
-    const IR::U32 id_in_group = ir.BitwiseAnd(lane_id, ir.Imm32(0b11));
-    const IR::U32 base = ir.ShiftLeftLogical(id_in_group, ir.Imm32(1));
-    const IR::U32 index = ir.BitFieldExtract(ir.Imm32(offset0), base, ir.Imm32(2));
-    SetDst(inst.dst[0], ir.QuadShuffle(src, index));
+    if (offset1 & 0x80) {
+        // Quad permute mode, every lane reads the lane of its quad selected by offset0.
+        const IR::U32 id_in_group = ir.BitwiseAnd(lane_id, ir.Imm32(0b11));
+        const IR::U32 base = ir.ShiftLeftLogical(id_in_group, ir.Imm32(1));
+        const IR::U32 index = ir.BitFieldExtract(ir.Imm32(offset0), base, ir.Imm32(2));
+        SetDst(inst.dst[0], ir.QuadShuffle(src, index));
+        return;
+    }
+    // Bit mask mode, every lane reads the lane ((lane & and) | or) ^ xor of its group of 32.
+    const u32 offset = (u32(offset1) << 8) | offset0;
+    const u32 and_mask = offset & 0x1F;
+    const u32 or_mask = (offset >> 5) & 0x1F;
+    const u32 xor_mask = (offset >> 10) & 0x1F;
+    IR::U32 index = ir.BitwiseAnd(lane_id, ir.Imm32(~0x1Fu | and_mask));
+    if (or_mask != 0) {
+        index = ir.BitwiseOr(index, ir.Imm32(or_mask));
+    }
+    if (xor_mask != 0) {
+        index = ir.BitwiseXor(index, ir.Imm32(xor_mask));
+    }
+    SetDst(inst.dst[0], ir.Shuffle(src, index));
 }
 
 void Translator::DS_APPEND(const GcnInst& inst) {
@@ -299,4 +361,18 @@ void Translator::DS_CONSUME(const GcnInst& inst) {
     SetDst(inst.dst[0], prev);
 }
 
+void Translator::DS_ORDERED_COUNT(const GcnInst& inst) {
+    // Hardware serializes waves on the counter in dispatch order. Here the first active lane of
+    // each wave adds the wave's value with a GDS atomic, so waves still get disjoint ranges, only
+    // not necessarily in dispatch order. The wave release/done flags in offset1 are ignored.
+    const u32 counter_offset = inst.control.ds.offset0 & 0xFCu;
+    const IR::U32 gds_base = ir.ShiftRightLogical(ir.GetM0(), ir.Imm32(16));
+    const IR::U32 address = ir.IAdd(gds_base, ir.Imm32(counter_offset));
+    const IR::U32 value = ir.ReadFirstLane(GetSrc(inst.src[0]));
+    const IR::U1 is_first_lane = ir.IEqual(ir.LaneId(), ir.BallotFindLsb(ir.Ballot(ir.Imm1(true))));
+    const IR::U32 addend = IR::U32{ir.Select(is_first_lane, value, ir.Imm32(0))};
+    const IR::U32 prev = IR::U32{ir.SharedAtomicIAdd(address, addend, true)};
+    SetDst(inst.dst[0], ir.ReadFirstLane(prev));
+}
+
 } // namespace Shader::Gcn
@@ -101,9 +101,19 @@ void Translator::EmitPrologue(IR::Block* first_block) {
                 ir.SetVectorReg(dst_vreg++, ir.GetAttributeU32(IR::Attribute::InstanceId));
             }
         } else {
+            // Step rates come from push constants, a rate of zero yields zero like on hardware.
+            const auto instance_id_over_step_rate = [&](IR::Attribute step_rate_attr) {
+                const IR::U32 step_rate{ir.GetAttributeU32(step_rate_attr)};
+                const IR::U32 instance_id{ir.GetAttributeU32(IR::Attribute::InstanceId)};
+                return IR::U32{ir.Select(ir.IEqual(step_rate, ir.Imm32(0)), ir.Imm32(0),
+                                         ir.IDiv(instance_id, step_rate))};
+            };
             // v1: instance ID, step rate 0
             if (runtime_info.num_input_vgprs > 0) {
-                if (runtime_info.vs_info.step_rate_0 != 0) {
+                if (profile.dynamic_instance_step_rates) {
+                    ir.SetVectorReg(dst_vreg++,
+                                    instance_id_over_step_rate(IR::Attribute::InstanceStepRate0));
+                } else if (runtime_info.vs_info.step_rate_0 != 0) {
                     ir.SetVectorReg(dst_vreg++,
                                     ir.IDiv(ir.GetAttributeU32(IR::Attribute::InstanceId),
                                             ir.Imm32(runtime_info.vs_info.step_rate_0)));
@@ -113,7 +123,10 @@ void Translator::EmitPrologue(IR::Block* first_block) {
             }
             // v2: instance ID, step rate 1
             if (runtime_info.num_input_vgprs > 1) {
-                if (runtime_info.vs_info.step_rate_1 != 0) {
+                if (profile.dynamic_instance_step_rates) {
+                    ir.SetVectorReg(dst_vreg++,
+                                    instance_id_over_step_rate(IR::Attribute::InstanceStepRate1));
+                } else if (runtime_info.vs_info.step_rate_1 != 0) {
                     ir.SetVectorReg(dst_vreg++,
                                     ir.IDiv(ir.GetAttributeU32(IR::Attribute::InstanceId),
                                             ir.Imm32(runtime_info.vs_info.step_rate_1)));
@@ -137,6 +137,7 @@ struct Info : InfoPersistent {
     bool uses_lane_id{};
     bool uses_group_quad{};
     bool uses_group_ballot{};
+    bool uses_group_shuffle{};
     IR::Type shared_types{};
     bool uses_fp16{};
     bool uses_fp64{};
@@ -185,6 +186,7 @@ struct Info : InfoPersistent {
     void AddBindings(Backend::Bindings& bnd) const {
         bnd.buffer += buffers.size();
         bnd.unified += buffers.size() + images.size() + samplers.size();
+        bnd.sampler += samplers.size();
         bnd.user_data += ud_mask.NumRegs();
     }
 
@@ -166,6 +166,10 @@ std::string NameOf(Attribute attribute) {
         return "SampleMask";
     case Attribute::PackedAncillary:
         return "PackedAncillary";
+    case Attribute::InstanceStepRate0:
+        return "InstanceStepRate0";
+    case Attribute::InstanceStepRate1:
+        return "InstanceStepRate1";
     default:
         break;
     }
@@ -91,6 +91,8 @@ enum class Attribute : u64 {
     StencilRef = 94,
     SampleMask = 95,
     PackedAncillary = 96,
+    InstanceStepRate0 = 97, // Instance step rates read from push constants
+    InstanceStepRate1 = 98,
     Max,
 };
 
@@ -25,7 +25,8 @@
 
 using namespace Xbyak::util;
 
-static Xbyak::CodeGenerator g_srt_codegen(32_MB);
+static constexpr size_t SrtCodeSize = 32_MB;
+static Xbyak::CodeGenerator g_srt_codegen(SrtCodeSize);
 static const u8* g_srt_codegen_start = nullptr;
 
 namespace Shader {
@@ -210,9 +211,11 @@ static void GenerateSrtProgram(Info& info, PassInfo& pass_info) {
     if (g_srt_codegen_start == nullptr) {
         g_srt_codegen_start = c.getCurr();
         auto* signals = Core::Signals::Instance();
-        // Call after the memory invalidation handler
+        // Call after the memory invalidation handler, only for faults in the walker code
         constexpr u32 priority = 1;
-        signals->RegisterAccessViolationHandler(SrtWalkerSignalHandler, priority);
+        const u8* code_begin = g_srt_codegen.getCode();
+        signals->RegisterAccessViolationHandler(SrtWalkerSignalHandler, priority, "SRT walker",
+                                                code_begin, code_begin + SrtCodeSize);
     }
 
     info.srt_info.walker_func = c.getCurr<PFN_SrtWalker>();
@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <boost/container/small_vector.hpp>
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "shader_recompiler/ir/program.h"
+
+namespace Shader::Optimization {
+
+namespace {
+
+struct ValueKey {
+    IR::Opcode opcode;
+    u32 flags;
+    boost::container::small_vector<IR::Value, 4> args;
+
+    bool operator==(const ValueKey&) const = default;
+};
+
+struct HashValueKey {
+    size_t operator()(const ValueKey& key) const {
+        u64 h = HashCombine(u64{static_cast<u32>(key.opcode)}, u64{key.flags});
+        for (const IR::Value& arg : key.args) {
+            h = HashCombine(h, u64{std::hash<IR::Value>{}(arg)});
+        }
+        return static_cast<size_t>(h);
+    }
+};
+
+/// Returns true if the result of the instruction only depends on its arguments, so any later
+/// instruction with the same arguments it dominates computes the same value.
+bool IsNumberable(const IR::Inst& inst) {
+    const IR::Opcode op = inst.GetOpcode();
+    switch (op) {
+    case IR::Opcode::GetUserData:
+    case IR::Opcode::ReadConst:
+    case IR::Opcode::CubeFaceIndex:
+        return true;
+    default:
+        // Vector utility up to conversion operations are pure arithmetic, see opcodes.inc
+        return op >= IR::Opcode::CompositeConstructU32x2 && op <= IR::Opcode::ConvertS32S16;
+    }
+}
+
+bool IsCommutative(IR::Opcode op) {
+    switch (op) {
+    case IR::Opcode::IAdd32:
+    case IR::Opcode::IAdd64:
+    case IR::Opcode::IMul32:
+    case IR::Opcode::IMul64:
+    case IR::Opcode::FPAdd32:
+    case IR::Opcode::FPAdd64:
+    case IR::Opcode::FPMul32:
+    case IR::Opcode::FPMul64:
+    case IR::Opcode::BitwiseAnd32:
+    case IR::Opcode::BitwiseAnd64:
+    case IR::Opcode::BitwiseOr32:
+    case IR::Opcode::BitwiseOr64:
+    case IR::Opcode::BitwiseXor32:
+    case IR::Opcode::SMin32:
+    case IR::Opcode::UMin32:
+    case IR::Opcode::SMax32:
+    case IR::Opcode::UMax32:
+    case IR::Opcode::IEqual32:
+    case IR::Opcode::IEqual64:
+    case IR::Opcode::INotEqual32:
+    case IR::Opcode::INotEqual64:
+    case IR::Opcode::LogicalOr:
+    case IR::Opcode::LogicalAnd:
+    case IR::Opcode::LogicalXor:
+        return true;
+    default:
+        return false;
+    }
+}
+
+ValueKey MakeKey(const IR::Inst& inst) {
+    ValueKey key{
+        .opcode = inst.GetOpcode(),
+        .flags = inst.Flags<u32>(),
+    };
+    const size_t num_args = inst.NumArgs();
+    for (size_t i = 0; i < num_args; ++i) {
+        key.args.push_back(inst.Arg(i).Resolve());
+    }
+    if (IsCommutative(key.opcode)) {
+        // Any stable order works, operands that only differ in order then share a key
+        const std::hash<IR::Value> hash;
+        if (hash(key.args[1]) < hash(key.args[0])) {
+            std::swap(key.args[0], key.args[1]);
+        }
+    }
+    return key;
+}
+
+/// Immediate dominator of every block as an index into the post order, computed with the
+/// iterative algorithm of Cooper, Harvey and Kennedy. The entry block is its own dominator.
+std::vector<u32> ComputeImmediateDominators(
+    const IR::BlockList& post_order, const std::unordered_map<const IR::Block*, u32>& index_of) {
+    constexpr u32 Undefined = ~0U;
+    const u32 entry = static_cast<u32>(post_order.size() - 1);
+    std::vector<u32> idom(post_order.size(), Undefined);
+    idom[entry] = entry;
+
+    const auto intersect = [&](u32 lhs, u32 rhs) {
+        while (lhs != rhs) {
+            while (lhs < rhs) {
+                lhs = idom[lhs];
+            }
+            while (rhs < lhs) {
+                rhs = idom[rhs];
+            }
+        }
+        return lhs;
+    };
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (u32 index = entry; index-- > 0;) {
+            u32 new_idom = Undefined;
+            for (const IR::Block* pred : post_order[index]->ImmPredecessors()) {
+                const auto it = index_of.find(pred);
+                if (it == index_of.end() || idom[it->second] == Undefined) {
+                    continue;
+                }
+                new_idom = new_idom == Undefined ? it->second : intersect(it->second, new_idom);
+            }
+            if (new_idom != idom[index]) {
+                idom[index] = new_idom;
+                changed = true;
+            }
+        }
+    }
+    return idom;
+}
+
+} // Anonymous namespace
+
+void GlobalValueNumberingPass(IR::Program& program) {
+    const IR::BlockList& post_order = program.post_order_blocks;
+    if (post_order.empty()) {
+        return;
+    }
+    std::unordered_map<const IR::Block*, u32> index_of;
+    for (u32 index = 0; index < post_order.size(); ++index) {
+        index_of.emplace(post_order[index], index);
+    }
+    const std::vector<u32> idom = ComputeImmediateDominators(post_order, index_of);
+    const u32 entry = static_cast<u32>(post_order.size() - 1);
+    std::vector<std::vector<u32>> children(post_order.size());
+    for (u32 index = 0; index < entry; ++index) {
+        children[idom[index]].push_back(index);
+    }
+
+    // Walk the dominator tree keeping the values defined by the dominators of the current block.
+    // Leaving a block forgets the values it added.
+    std::unordered_map<ValueKey, IR::Inst*, HashValueKey> values;
+    std::vector<ValueKey> scope_keys;
+    std::vector<size_t> scope_begin(post_order.size());
+    std::vector<std::pair<u32, bool>> stack{{entry, false}};
+    u32 num_removed = 0;
+    while (!stack.empty()) {
+        const auto [index, is_exit] = stack.back();
+        stack.pop_back();
+        if (is_exit) {
+            while (scope_keys.size() > scope_begin[index]) {
+                values.erase(scope_keys.back());
+                scope_keys.pop_back();
+            }
+            continue;
+        }
+        scope_begin[index] = scope_keys.size();
+        IR::Block* const block = post_order[index];
+        for (auto it = block->begin(); it != block->end();) {
+            if (!IsNumberable(*it)) {
+                ++it;
+                continue;
+            }
+            ValueKey key = MakeKey(*it);
+            const auto [existing, inserted] = values.try_emplace(key, &*it);
+            if (inserted) {
+                scope_keys.push_back(std::move(key));
+                ++it;
+                continue;
+            }
+            it->ReplaceUsesWithAndRemove(IR::Value{existing->second});
+            it = block->Instructions().erase(it);
+            ++num_removed;
+        }
+        stack.emplace_back(index, true);
+        for (const u32 child : children[index]) {
+            stack.emplace_back(child, false);
+        }
+    }
+    if (num_removed != 0) {
+        LOG_DEBUG(Render_Recompiler, "Removed {} redundant instructions", num_removed);
+    }
+}
+
+} // namespace Shader::Optimization
@@ -1,7 +1,9 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <optional>
 #include <unordered_map>
+#include <vector>
 #include "common/assert.h"
 #include "shader_recompiler/info.h"
 #include "shader_recompiler/ir/attribute.h"
@@ -348,7 +350,63 @@ static IR::U32 TryOptimizeAddressModulo(IR::U32 addr, u32 stride, IR::IREmitter&
     return addr;
 }
 
-// TODO: can optimize div in control point index similarly to mod
+static void CollectAddends(IR::Value addr, std::vector<IR::Value>& addends) {
+    IR::Value a, b;
+    if (M_IADD32(MatchValue(a), MatchValue(b)).Match(addr)) {
+        CollectAddends(a, addends);
+        CollectAddends(b, addends);
+    } else {
+        addends.push_back(addr);
+    }
+}
+
+// Returns term / stride when the term is a multiple of the stride
+static std::optional<IR::U32> TryGetQuotient(IR::Value term, u32 stride, IR::IREmitter& ir) {
+    IR::Value a, b;
+    term = term.Resolve();
+    if (term.IsImmediate()) {
+        const u32 value = term.U32();
+        return value % stride == 0 ? std::optional{ir.Imm32(value / stride)} : std::nullopt;
+    } else if (M_BITFIELDUEXTRACT(MatchValue(a), MatchU32(0), MatchU32(24)).Match(term) ||
+               M_BITFIELDSEXTRACT(MatchValue(a), MatchU32(0), MatchU32(24)).Match(term)) {
+        return TryGetQuotient(a, stride, ir);
+    } else if (M_IMUL32(MatchValue(a), MatchValue(b)).Match(term)) {
+        if (const auto quotient = TryGetQuotient(b, stride, ir)) {
+            return IR::U32{ir.IMul(IR::U32{a}, *quotient)};
+        }
+        if (const auto quotient = TryGetQuotient(a, stride, ir)) {
+            return IR::U32{ir.IMul(*quotient, IR::U32{b})};
+        }
+    }
+    return std::nullopt;
+}
+
+// In calculation (a * stride + b + ...) / stride
+// Use this fact
+// (a * stride + b) / N = a + b / N
+// The control point index is then usually a plain value, like the vertex of a loop, instead of a
+// division the host has to carry out for every attribute access
+static IR::U32 TryOptimizeAddressDivision(IR::U32 addr, u32 stride, IR::IREmitter& ir) {
+    std::vector<IR::Value> addends;
+    CollectAddends(addr, addends);
+    IR::U32 quotient = ir.Imm32(0);
+    IR::U32 rest = ir.Imm32(0);
+    bool has_quotient = false;
+    bool has_rest = false;
+    for (const auto& addend : addends) {
+        if (const auto addend_quotient = TryGetQuotient(addend, stride, ir)) {
+            quotient = ir.IAdd(quotient, *addend_quotient);
+            has_quotient = true;
+        } else {
+            rest = ir.IAdd(rest, IR::U32{addend});
+            has_rest = true;
+        }
+    }
+    if (!has_quotient) {
+        return ir.IDiv(addr, ir.Imm32(stride));
+    }
+    return has_rest ? ir.IAdd(quotient, ir.IDiv(rest, ir.Imm32(stride))) : quotient;
+}
 
 // Read a TCS input (InputCP region) or TES input (OutputCP region)
 static IR::F32 ReadTessControlPointAttribute(IR::U32 addr, const u32 stride, IR::IREmitter& ir,
@@ -356,7 +414,7 @@ static IR::F32 ReadTessControlPointAttribute(IR::U32 addr, const u32 stride, IR:
     if (off_dw > 0) {
         addr = ir.IAdd(addr, ir.Imm32(off_dw));
     }
-    const IR::U32 control_point_index = ir.IDiv(addr, ir.Imm32(stride));
+    const IR::U32 control_point_index = TryOptimizeAddressDivision(addr, stride, ir);
     const IR::U32 opt_addr = TryOptimizeAddressModulo(addr, stride, ir);
     const IR::U32 offset = ir.IMod(opt_addr, ir.Imm32(stride));
     const IR::U32 attr_index = ir.ShiftRightLogical(offset, ir.Imm32(4u));
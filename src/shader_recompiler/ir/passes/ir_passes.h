@@ -8,6 +8,7 @@
 
 namespace Shader {
 struct Profile;
+enum class Fp64Mode : u8;
 }
 
 namespace Shader::Optimization {
@@ -16,12 +17,14 @@ void SsaRewritePass(IR::BlockList& program);
 void IdentityRemovalPass(IR::BlockList& program);
 void DeadCodeEliminationPass(IR::Program& program);
 void ConstantPropagationPass(IR::BlockList& program);
+void GlobalValueNumberingPass(IR::Program& program);
+void LoopInvariantCodeMotionPass(IR::Program& program);
 void FlattenExtendedUserdataPass(IR::Program& program);
 void ReadLaneEliminationPass(IR::Program& program);
 void ResourceTrackingPass(IR::Program& program);
 void CollectShaderInfoPass(IR::Program& program, const Profile& profile);
 void LowerBufferFormatToRaw(IR::Program& program);
-void LowerFp64ToFp32(IR::Program& program);
+void LowerFp64ToFp32(IR::Program& program, Fp64Mode mode);
 void RingAccessElimination(const IR::Program& program, const RuntimeInfo& runtime_info);
 void TessellationPreprocess(IR::Program& program, RuntimeInfo& runtime_info);
 void HullShaderTransform(IR::Program& program, const RuntimeInfo& runtime_info);
@@ -31,5 +34,6 @@ void SharedMemoryBarrierPass(IR::Program& program, const RuntimeInfo& runtime_in
 void SharedMemorySimplifyPass(IR::Program& program, const Profile& profile);
 void SharedMemoryToStoragePass(IR::Program& program, const RuntimeInfo& runtime_info,
                                const Profile& profile);
+void SharedMemoryVectorizePass(IR::Program& program, const Profile& profile);
 
 } // namespace Shader::Optimization
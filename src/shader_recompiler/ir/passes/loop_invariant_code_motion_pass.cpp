@@ -0,0 +1,147 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <boost/container/small_vector.hpp>
+#include "common/logging/log.h"
+#include "shader_recompiler/ir/program.h"
+
+namespace Shader::Optimization {
+
+namespace {
+
+using LoopBlocks = boost::container::small_vector<IR::Block*, 16>;
+
+/// Returns true if the instruction computes the same value wherever it is executed, given the
+/// same arguments. Constant loads only qualify when nothing in the loop writes memory.
+bool IsHoistable(const IR::Inst& inst, bool loop_writes_memory) {
+    const IR::Opcode op = inst.GetOpcode();
+    switch (op) {
+    case IR::Opcode::GetUserData:
+    case IR::Opcode::CubeFaceIndex:
+        return true;
+    case IR::Opcode::ReadConst:
+    case IR::Opcode::ReadConstBuffer:
+        return !loop_writes_memory;
+    default:
+        // Vector utility up to conversion operations are pure arithmetic, see opcodes.inc
+        return op >= IR::Opcode::CompositeConstructU32x2 && op <= IR::Opcode::ConvertS32S16;
+    }
+}
+
+/// Returns true for instructions with side effects that don't touch memory, which are part of
+/// the structured control flow itself.
+bool IsControlFlowOnly(const IR::Inst& inst) {
+    switch (inst.GetOpcode()) {
+    case IR::Opcode::ConditionRef:
+    case IR::Opcode::Reference:
+    case IR::Opcode::PhiMove:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// Blocks of the loop whose node is at the given index, from its header to its continue block.
+LoopBlocks CollectLoopBlocks(const IR::AbstractSyntaxList& syntax_list, size_t loop_index) {
+    LoopBlocks blocks{syntax_list[loop_index - 1].data.block};
+    u32 depth = 0;
+    for (size_t index = loop_index + 1; index < syntax_list.size(); ++index) {
+        const IR::AbstractSyntaxNode& node = syntax_list[index];
+        if (node.type == IR::AbstractSyntaxNode::Type::Loop) {
+            ++depth;
+        } else if (node.type == IR::AbstractSyntaxNode::Type::Repeat) {
+            if (depth == 0) {
+                break;
+            }
+            --depth;
+        } else if (node.type == IR::AbstractSyntaxNode::Type::Block) {
+            blocks.push_back(node.data.block);
+        }
+    }
+    return blocks;
+}
+
+/// Block that is only followed by the header of the loop, so it runs once before the first
+/// iteration. Loops that start a scope have none.
+IR::Block* GetPreheader(const IR::AbstractSyntaxList& syntax_list, size_t loop_index) {
+    if (loop_index < 2) {
+        return nullptr;
+    }
+    const IR::AbstractSyntaxNode& node = syntax_list[loop_index - 2];
+    if (node.type != IR::AbstractSyntaxNode::Type::Block) {
+        return nullptr;
+    }
+    IR::Block* const header = syntax_list[loop_index - 1].data.block;
+    const auto successors = node.data.block->ImmSuccessors();
+    if (successors.size() != 1 || successors.front() != header) {
+        return nullptr;
+    }
+    return node.data.block;
+}
+
+bool IsLoopInvariant(const IR::Inst& inst, const LoopBlocks& loop_blocks) {
+    const size_t num_args = inst.NumArgs();
+    for (size_t i = 0; i < num_args; ++i) {
+        const IR::Value arg = inst.Arg(i).Resolve();
+        if (arg.IsImmediate()) {
+            continue;
+        }
+        if (std::ranges::contains(loop_blocks, arg.InstRecursive()->GetParent())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // Anonymous namespace
+
+void LoopInvariantCodeMotionPass(IR::Program& program) {
+    const IR::AbstractSyntaxList& syntax_list = program.syntax_list;
+    u32 num_hoisted = 0;
+    u32 num_loops = 0;
+    // Outer loops come first, what they leave behind can still move out of the inner ones.
+    for (size_t index = 0; index < syntax_list.size(); ++index) {
+        if (syntax_list[index].type != IR::AbstractSyntaxNode::Type::Loop) {
+            continue;
+        }
+        IR::Block* const preheader = GetPreheader(syntax_list, index);
+        if (!preheader) {
+            continue;
+        }
+        const LoopBlocks loop_blocks = CollectLoopBlocks(syntax_list, index);
+        const bool writes_memory = std::ranges::any_of(loop_blocks, [](const IR::Block* block) {
+            return std::ranges::any_of(block->Instructions(), [](const IR::Inst& inst) {
+                return inst.MayHaveSideEffects() && !IsControlFlowOnly(inst);
+            });
+        });
+
+        // Blocks are in program order, so the arguments of an instruction that were hoisted
+        // already are known to be invariant when it is visited. Loops run at least once, and
+        // none of the hoisted instructions can fault, so it is fine if the ones coming from
+        // conditional blocks also run when they weren't going to.
+        const u32 num_hoisted_before = num_hoisted;
+        for (IR::Block* const block : loop_blocks) {
+            for (auto it = block->begin(); it != block->end();) {
+                IR::Inst& inst = *it;
+                if (!IsHoistable(inst, writes_memory) || !IsLoopInvariant(inst, loop_blocks)) {
+                    ++it;
+                    continue;
+                }
+                it = block->Instructions().erase(it);
+                preheader->Instructions().push_back(inst);
+                inst.SetParent(preheader);
+                ++num_hoisted;
+            }
+        }
+        if (num_hoisted != num_hoisted_before) {
+            ++num_loops;
+        }
+    }
+    if (num_hoisted != 0) {
+        LOG_DEBUG(Render_Recompiler, "Hoisted {} instructions out of {} loops", num_hoisted,
+                  num_loops);
+    }
+}
+
+} // namespace Shader::Optimization
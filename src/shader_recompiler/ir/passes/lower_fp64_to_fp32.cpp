@@ -5,6 +5,7 @@
 #include "shader_recompiler/ir/basic_block.h"
 #include "shader_recompiler/ir/ir_emitter.h"
 #include "shader_recompiler/ir/program.h"
+#include "shader_recompiler/profile.h"
 
 namespace Shader::Optimization {
 
@@ -149,10 +150,39 @@ static void Lower(IR::Block& block, IR::Inst& inst) {
     }
 }
 
-void LowerFp64ToFp32(IR::Program& program) {
+// Divisions and reciprocals are the slowest double precision instructions on hosts with a
+// reduced fp64 rate. GCN only gives approximate reciprocals, so doing them in single precision
+// rarely changes the result.
+static void LowerReciprocal(IR::Block& block, IR::Inst& inst) {
+    IR::IREmitter ir(block, IR::Block::InstructionList::s_iterator_to(inst));
+    const auto arg = [&](size_t index) {
+        return IR::F32{ir.FPConvert(32, IR::F64{inst.Arg(index)})};
+    };
+    IR::F32 result;
+    switch (inst.GetOpcode()) {
+    case IR::Opcode::FPDiv64:
+        result = ir.FPDiv(arg(0), arg(1));
+        break;
+    case IR::Opcode::FPRecip64:
+        result = ir.FPRecip(arg(0));
+        break;
+    case IR::Opcode::FPRecipSqrt64:
+        result = ir.FPRecipSqrt(arg(0));
+        break;
+    default:
+        return;
+    }
+    inst.ReplaceUsesWithAndRemove(ir.FPConvert(64, result));
+}
+
+void LowerFp64ToFp32(IR::Program& program, Fp64Mode mode) {
     for (IR::Block* const block : program.blocks) {
         for (IR::Inst& inst : block->Instructions()) {
-            Lower(*block, inst);
+            if (mode == Fp64Mode::Hybrid) {
+                LowerReciprocal(*block, inst);
+            } else {
+                Lower(*block, inst);
+            }
         }
     }
 }
@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+#include "common/logging/log.h"
+#include "shader_recompiler/ir/ir_emitter.h"
+#include "shader_recompiler/ir/program.h"
+#include "shader_recompiler/profile.h"
+
+namespace Shader::Optimization {
+
+namespace {
+
+constexpr u32 MaxAlignmentDepth = 8;
+
+/// Lower bound of the number of trailing zero bits of a shared memory address.
+u32 AlignmentBits(const IR::Value& value, u32 depth = 0) {
+    const IR::Value resolved = value.Resolve();
+    if (resolved.IsImmediate()) {
+        return static_cast<u32>(std::countr_zero(resolved.U32()));
+    }
+    if (depth == MaxAlignmentDepth) {
+        return 0;
+    }
+    const IR::Inst* const inst = resolved.InstRecursive();
+    const auto arg_bits = [&](size_t index) { return AlignmentBits(inst->Arg(index), depth + 1); };
+    switch (inst->GetOpcode()) {
+    case IR::Opcode::IAdd32:
+    case IR::Opcode::ISub32:
+    case IR::Opcode::BitwiseOr32:
+        return std::min(arg_bits(0), arg_bits(1));
+    case IR::Opcode::BitwiseAnd32:
+        return std::max(arg_bits(0), arg_bits(1));
+    case IR::Opcode::IMul32:
+        return std::min(arg_bits(0) + arg_bits(1), 32U);
+    case IR::Opcode::ShiftLeftLogical32: {
+        const IR::Value shift = inst->Arg(1).Resolve();
+        return shift.IsImmediate() ? std::min(arg_bits(0) + (shift.U32() & 31), 32U) : 0;
+    }
+    default:
+        return 0;
+    }
+}
+
+/// Splits an address into a base and a constant byte offset.
+std::pair<IR::Value, u32> SplitAddress(const IR::Value& address) {
+    const IR::Value resolved = address.Resolve();
+    if (resolved.IsImmediate()) {
+        return {IR::Value{}, resolved.U32()};
+    }
+    const IR::Inst* const inst = resolved.InstRecursive();
+    if (inst->GetOpcode() == IR::Opcode::IAdd32) {
+        const IR::Value lhs = inst->Arg(0).Resolve();
+        const IR::Value rhs = inst->Arg(1).Resolve();
+        if (rhs.IsImmediate()) {
+            return {lhs, rhs.U32()};
+        }
+        if (lhs.IsImmediate()) {
+            return {rhs, lhs.U32()};
+        }
+    }
+    return {resolved, 0};
+}
+
+/// Returns true if the dword accessed by second directly follows the one accessed by first, and
+/// both together are 8 byte aligned.
+bool IsVectorizable(const IR::Inst& first, const IR::Inst& second) {
+    if (first.GetOpcode() != second.GetOpcode() || first.Flags<u32>() != second.Flags<u32>()) {
+        return false;
+    }
+    const auto [first_base, first_offset] = SplitAddress(first.Arg(0));
+    const auto [second_base, second_offset] = SplitAddress(second.Arg(0));
+    return first_base == second_base && second_offset == first_offset + 4 &&
+           AlignmentBits(first.Arg(0)) >= 3;
+}
+
+bool IsDwordAccess(const IR::Inst& inst) {
+    const IR::Opcode op = inst.GetOpcode();
+    return op == IR::Opcode::LoadSharedU32 || op == IR::Opcode::WriteSharedU32;
+}
+
+bool IsSharedAccess(const IR::Inst& inst) {
+    switch (inst.GetOpcode()) {
+    case IR::Opcode::LoadSharedU16:
+    case IR::Opcode::LoadSharedU32:
+    case IR::Opcode::LoadSharedU64:
+        return true;
+    default:
+        // Writes, atomics and barriers
+        return inst.MayHaveSideEffects();
+    }
+}
+
+} // Anonymous namespace
+
+// Merges pairs of dword shared memory accesses to consecutive, 8 byte aligned addresses into a
+// single 64-bit access, like the ones DS_READ2_B32 and DS_WRITE2_B32 are translated to. Only
+// accesses with nothing that could touch shared memory between them are merged.
+void SharedMemoryVectorizePass(IR::Program& program, const Profile& profile) {
+    const auto stage = program.info.stage;
+    if (stage != Stage::Compute || !profile.supports_workgroup_explicit_memory_layout) {
+        // Without a 64-bit view on shared memory the accesses would be split up again
+        return;
+    }
+
+    u32 num_merged = 0;
+    for (IR::Block* const block : program.blocks) {
+        IR::Inst* pending{};
+        for (IR::Inst& inst : block->Instructions()) {
+            if (!IsDwordAccess(inst)) {
+                if (IsSharedAccess(inst)) {
+                    pending = nullptr;
+                }
+                continue;
+            }
+            if (!pending || !IsVectorizable(*pending, inst)) {
+                pending = &inst;
+                continue;
+            }
+            const IR::U32 address{pending->Arg(0)};
+            const bool is_gds = pending->Flags<u32>() != 0;
+            if (inst.GetOpcode() == IR::Opcode::LoadSharedU32) {
+                // The second load moves up to the first, there is no write in between
+                IR::IREmitter ir{*block, IR::Block::InstructionList::s_iterator_to(*pending)};
+                const IR::Value vector =
+                    ir.UnpackUint2x32(IR::U64{ir.LoadShared(64, false, address, is_gds)});
+                pending->ReplaceUsesWithAndRemove(ir.CompositeExtract(vector, 0));
+                inst.ReplaceUsesWithAndRemove(ir.CompositeExtract(vector, 1));
+            } else {
+                // The first write moves down to the second, there is no read in between
+                IR::IREmitter ir{*block, IR::Block::InstructionList::s_iterator_to(inst)};
+                const IR::Value value{ir.PackUint2x32(
+                    ir.CompositeConstruct(IR::U32{pending->Arg(1)}, IR::U32{inst.Arg(1)}))};
+                ir.WriteShared(64, value, address, is_gds);
+                pending->Invalidate();
+                inst.Invalidate();
+            }
+            pending = nullptr;
+            ++num_merged;
+        }
+    }
+    if (num_merged != 0) {
+        LOG_DEBUG(Render_Recompiler, "Merged {} pairs of shared memory accesses", num_merged);
+    }
+}
+
+} // namespace Shader::Optimization
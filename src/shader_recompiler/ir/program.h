@@ -17,7 +17,6 @@ struct Program {
     AbstractSyntaxList syntax_list;
     BlockList blocks;
     BlockList post_order_blocks;
-    std::vector<Gcn::GcnInst> ins_list;
     Info& info;
 };
 
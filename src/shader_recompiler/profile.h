@@ -7,6 +7,13 @@
 
 namespace Shader {
 
+/// How the double precision arithmetic of the guest is translated.
+enum class Fp64Mode : u8 {
+    Native, ///< Kept as is, needs shaderFloat64
+    Lower,  ///< Lowered to single precision
+    Hybrid, ///< Only divisions and reciprocals are lowered, the rest is kept native
+};
+
 struct Profile {
     u64 max_ubo_size{};
     u32 max_viewport_width{};
@@ -41,7 +48,10 @@ struct Profile {
     bool needs_lds_barriers{};
     bool needs_buffer_offsets{};
     bool needs_unorm_fixup{};
-    bool _pad0{};
+    bool dynamic_instance_step_rates{};
+    bool loop_invariant_code_motion{};
+    bool bindless_samplers{};
+    Fp64Mode fp64_mode{};
 };
 
 } // namespace Shader
@@ -1,7 +1,10 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
-#include "shader_recompiler/frontend/control_flow_graph.h"
+#include <atomic>
+#include <chrono>
+#include <tuple>
+
 #include "shader_recompiler/frontend/decode.h"
 #include "shader_recompiler/frontend/structured_control_flow.h"
 #include "shader_recompiler/ir/passes/ir_passes.h"
@@ -11,6 +14,34 @@
 
 namespace Shader {
 
+static std::atomic<size_t> peak_num_insts{};
+static std::atomic<size_t> peak_num_blocks{};
+
+static void UpdatePeak(std::atomic<size_t>& peak, size_t value) {
+    size_t current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value)) {
+    }
+}
+
+Pools& Pools::ThreadLocal() {
+    thread_local Pools pools;
+    return pools;
+}
+
+PoolUsage Pools::PeakUsage() {
+    return {
+        .num_insts = peak_num_insts.load(std::memory_order_relaxed),
+        .num_blocks = peak_num_blocks.load(std::memory_order_relaxed),
+    };
+}
+
+void Pools::ReleaseContents() {
+    UpdatePeak(peak_num_insts, inst_pool.NumUsedObjects());
+    UpdatePeak(peak_num_blocks, block_pool.NumUsedObjects());
+    inst_pool.ReleaseContents();
+    block_pool.ReleaseContents();
+}
+
 IR::BlockList GenerateBlocks(const IR::AbstractSyntaxList& syntax_list) {
     size_t num_syntax_blocks{};
     for (const auto& node : syntax_list) {
@@ -29,8 +60,60 @@ IR::BlockList GenerateBlocks(const IR::AbstractSyntaxList& syntax_list) {
     return blocks;
 }
 
-IR::Program TranslateProgram(const std::span<const u32>& code, Pools& pools, Info& info,
-                             RuntimeInfo& runtime_info, const Profile& profile) {
+static u32 CountInstructions(const IR::BlockList& blocks) {
+    u32 num_insts{};
+    for (const IR::Block* block : blocks) {
+        num_insts += static_cast<u32>(block->Instructions().size());
+    }
+    return num_insts;
+}
+
+static u32 CountFp64Instructions(const IR::BlockList& blocks) {
+    u32 num_insts{};
+    for (const IR::Block* block : blocks) {
+        for (const IR::Inst& inst : block->Instructions()) {
+            bool is_fp64 = inst.Type() == IR::Type::F64;
+            for (size_t i = 0; i < inst.NumArgs() && !is_fp64; ++i) {
+                is_fp64 = inst.Arg(i).Type() == IR::Type::F64;
+            }
+            num_insts += is_fp64 ? 1 : 0;
+        }
+    }
+    return num_insts;
+}
+
+static std::pair<u32, u32> CountTessAccesses(const IR::BlockList& blocks) {
+    u32 num_accesses{};
+    u32 num_dynamic{};
+    for (const IR::Block* block : blocks) {
+        for (const IR::Inst& inst : block->Instructions()) {
+            switch (inst.GetOpcode()) {
+            case IR::Opcode::GetPatch:
+            case IR::Opcode::SetPatch:
+                ++num_accesses;
+                break;
+            case IR::Opcode::GetTessGenericAttribute:
+            case IR::Opcode::SetTcsGenericAttribute:
+            case IR::Opcode::ReadTcsGenericOuputAttribute:
+                // Dynamic attribute or component indices make the host index the attribute array
+                ++num_accesses;
+                num_dynamic += !inst.Arg(1).IsImmediate() || !inst.Arg(2).IsImmediate() ? 1 : 0;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    return {num_accesses, num_dynamic};
+}
+
+static u64 ElapsedUs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+DecodedProgram::DecodedProgram(std::span<const u32> code, CompileStats* stats) {
     // Ensure first instruction is expected.
     constexpr u32 token_mov_vcchi = 0xBEEB03FF;
     if (code[0] != token_mov_vcchi) {
@@ -41,51 +124,106 @@ IR::Program TranslateProgram(const std::span<const u32>& code, Pools& pools, Inf
     Gcn::GcnDecodeContext decoder;
 
     // Decode and save instructions
-    IR::Program program{info};
-    program.ins_list.reserve(code.size());
+    auto start = std::chrono::steady_clock::now();
+    ins_list.reserve(code.size());
     while (!slice.atEnd()) {
-        program.ins_list.emplace_back(decoder.decodeInstruction(slice));
+        ins_list.emplace_back(decoder.decodeInstruction(slice));
+    }
+    if (stats) {
+        stats->decode_us = ElapsedUs(start);
+        stats->num_gcn_insts = static_cast<u32>(ins_list.size());
+        start = std::chrono::steady_clock::now();
     }
 
+    // Create control flow graph
+    cfg.emplace(block_pool, ins_list);
+    if (stats) {
+        stats->cfg_us = ElapsedUs(start);
+    }
+}
+
+DecodedProgram::~DecodedProgram() = default;
+
+IR::Program TranslateProgram(DecodedProgram& decoded, Pools& pools, Info& info,
+                             RuntimeInfo& runtime_info, const Profile& profile,
+                             CompileStats* stats, bool optimize) {
     // Clear any previous pooled data.
     pools.ReleaseContents();
 
-    // Create control flow graph
-    Common::ObjectPool<Gcn::Block> gcn_block_pool{64};
-    Gcn::CFG cfg{gcn_block_pool, program.ins_list};
+    if (stats) {
+        stats->num_gcn_insts = static_cast<u32>(decoded.ins_list.size());
+    }
+    const auto start = std::chrono::steady_clock::now();
+    IR::Program program{info};
 
     // Structurize control flow graph and create program.
     program.syntax_list =
-        Shader::Gcn::BuildASL(pools.inst_pool, pools.block_pool, cfg, info, runtime_info, profile);
+        Shader::Gcn::BuildASL(pools.inst_pool, pools.block_pool, *decoded.cfg, info, runtime_info,
+                              profile);
     program.blocks = GenerateBlocks(program.syntax_list);
     program.post_order_blocks = Shader::IR::PostOrder(program.syntax_list.front());
+    if (stats) {
+        stats->structurize_us = ElapsedUs(start);
+    }
+
+    // Instruction counting walks the whole program, so passes are only measured on request.
+    const auto run_pass = [&](std::string_view name, auto&& pass) {
+        if (!stats) {
+            pass();
+            return;
+        }
+        const u32 insts_before = CountInstructions(program.blocks);
+        const auto pass_start = std::chrono::steady_clock::now();
+        pass();
+        const u64 time_us = ElapsedUs(pass_start);
+        stats->passes.emplace_back(name, time_us, insts_before,
+                                   CountInstructions(program.blocks));
+    };
 
     // Run optimization passes
-    if (!profile.support_float64) {
-        Shader::Optimization::LowerFp64ToFp32(program);
+    using namespace Shader::Optimization;
+    if (profile.fp64_mode != Fp64Mode::Native) {
+        run_pass("LowerFp64ToFp32", [&] { LowerFp64ToFp32(program, profile.fp64_mode); });
     }
-    Shader::Optimization::SsaRewritePass(program.post_order_blocks);
-    Shader::Optimization::ConstantPropagationPass(program.post_order_blocks);
-    Shader::Optimization::IdentityRemovalPass(program.blocks);
+    run_pass("SsaRewrite", [&] { SsaRewritePass(program.post_order_blocks); });
+    run_pass("ConstantPropagation", [&] { ConstantPropagationPass(program.post_order_blocks); });
+    run_pass("IdentityRemoval", [&] { IdentityRemovalPass(program.blocks); });
     if (info.l_stage == LogicalStage::TessellationControl) {
-        Shader::Optimization::TessellationPreprocess(program, runtime_info);
-        Shader::Optimization::HullShaderTransform(program, runtime_info);
+        run_pass("TessellationPreprocess", [&] { TessellationPreprocess(program, runtime_info); });
+        run_pass("HullShaderTransform", [&] { HullShaderTransform(program, runtime_info); });
     } else if (info.l_stage == LogicalStage::TessellationEval) {
-        Shader::Optimization::TessellationPreprocess(program, runtime_info);
-        Shader::Optimization::DomainShaderTransform(program, runtime_info);
-    }
-    Shader::Optimization::RingAccessElimination(program, runtime_info);
-    Shader::Optimization::ReadLaneEliminationPass(program);
-    Shader::Optimization::FlattenExtendedUserdataPass(program);
-    Shader::Optimization::ResourceTrackingPass(program);
-    Shader::Optimization::LowerBufferFormatToRaw(program);
-    Shader::Optimization::SharedMemorySimplifyPass(program, profile);
-    Shader::Optimization::SharedMemoryToStoragePass(program, runtime_info, profile);
-    Shader::Optimization::SharedMemoryBarrierPass(program, runtime_info, profile);
-    Shader::Optimization::IdentityRemovalPass(program.blocks);
-    Shader::Optimization::DeadCodeEliminationPass(program);
-    Shader::Optimization::ConstantPropagationPass(program.post_order_blocks);
-    Shader::Optimization::CollectShaderInfoPass(program, profile);
+        run_pass("TessellationPreprocess", [&] { TessellationPreprocess(program, runtime_info); });
+        run_pass("DomainShaderTransform", [&] { DomainShaderTransform(program, runtime_info); });
+    }
+    run_pass("RingAccessElimination", [&] { RingAccessElimination(program, runtime_info); });
+    run_pass("ReadLaneElimination", [&] { ReadLaneEliminationPass(program); });
+    run_pass("FlattenExtendedUserdata", [&] { FlattenExtendedUserdataPass(program); });
+    run_pass("ResourceTracking", [&] { ResourceTrackingPass(program); });
+    run_pass("LowerBufferFormatToRaw", [&] { LowerBufferFormatToRaw(program); });
+    run_pass("SharedMemoryVectorize", [&] { SharedMemoryVectorizePass(program, profile); });
+    run_pass("SharedMemorySimplify", [&] { SharedMemorySimplifyPass(program, profile); });
+    run_pass("SharedMemoryToStorage",
+             [&] { SharedMemoryToStoragePass(program, runtime_info, profile); });
+    run_pass("SharedMemoryBarrier",
+             [&] { SharedMemoryBarrierPass(program, runtime_info, profile); });
+    if (optimize) {
+        run_pass("GlobalValueNumbering", [&] { GlobalValueNumberingPass(program); });
+        if (profile.loop_invariant_code_motion) {
+            run_pass("LoopInvariantCodeMotion", [&] { LoopInvariantCodeMotionPass(program); });
+        }
+    }
+    run_pass("IdentityRemoval", [&] { IdentityRemovalPass(program.blocks); });
+    run_pass("DeadCodeElimination", [&] { DeadCodeEliminationPass(program); });
+    run_pass("ConstantPropagation", [&] { ConstantPropagationPass(program.post_order_blocks); });
+    run_pass("CollectShaderInfo", [&] { CollectShaderInfoPass(program, profile); });
+    if (stats) {
+        stats->num_fp64_insts = CountFp64Instructions(program.blocks);
+        if (info.l_stage == LogicalStage::TessellationControl ||
+            info.l_stage == LogicalStage::TessellationEval) {
+            std::tie(stats->num_tess_accesses, stats->num_dynamic_tess_accesses) =
+                CountTessAccesses(program.blocks);
+        }
+    }
 
     Shader::IR::DumpProgram(program, info);
 
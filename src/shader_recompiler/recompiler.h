@@ -3,7 +3,11 @@
 
 #pragma once
 
+#include <optional>
+
 #include "common/object_pool.h"
+#include "shader_recompiler/compile_stats.h"
+#include "shader_recompiler/frontend/control_flow_graph.h"
 #include "shader_recompiler/ir/basic_block.h"
 #include "shader_recompiler/ir/program.h"
 
@@ -12,6 +16,14 @@ namespace Shader {
 struct Profile;
 struct RuntimeInfo;
 
+/// Highest number of IR objects held at once by any of the pools.
+struct PoolUsage {
+    size_t num_insts;
+    size_t num_blocks;
+};
+
+/// Arena for the IR of one translation. It is bulk reset at the start of the next translation,
+/// so every thread that translates shaders uses its own instance.
 struct Pools {
     static constexpr u32 InstPoolSize = 8192;
     static constexpr u32 BlockPoolSize = 32;
@@ -21,14 +33,36 @@ struct Pools {
 
     explicit Pools() : inst_pool{InstPoolSize}, block_pool{BlockPoolSize} {}
 
-    void ReleaseContents() {
-        inst_pool.ReleaseContents();
-        block_pool.ReleaseContents();
-    }
+    /// Returns the pools owned by the calling thread.
+    static Pools& ThreadLocal();
+
+    /// Returns the peak usage over all threads, meant to tune InstPoolSize and BlockPoolSize.
+    static PoolUsage PeakUsage();
+
+    void ReleaseContents();
+};
+
+/// Permutation independent part of the GCN frontend. Decoding and the control flow graph only
+/// depend on the guest code, so they are built once per program and are shared by all of its
+/// permutations. Structurization is not part of it, as it emits IR that depends on the
+/// specialization.
+struct DecodedProgram {
+    explicit DecodedProgram(std::span<const u32> code, CompileStats* stats = nullptr);
+    ~DecodedProgram();
+
+    DecodedProgram(const DecodedProgram&) = delete;
+    DecodedProgram& operator=(const DecodedProgram&) = delete;
+
+    std::vector<Gcn::GcnInst> ins_list;
+    Common::ObjectPool<Gcn::Block> block_pool{64};
+    std::optional<Gcn::CFG> cfg;
 };
 
-[[nodiscard]] IR::Program TranslateProgram(const std::span<const u32>& code, Pools& pools,
-                                           Info& info, RuntimeInfo& runtime_info,
-                                           const Profile& profile);
+/// Translates a decoded program to IR. When stats is provided, structurization and every IR
+/// pass are timed and the program size is recorded around each pass. Without optimize, the
+/// passes that are not needed for correct code are skipped, which leaves the shader info the same.
+[[nodiscard]] IR::Program TranslateProgram(DecodedProgram& decoded, Pools& pools, Info& info,
+                                           RuntimeInfo& runtime_info, const Profile& profile,
+                                           CompileStats* stats = nullptr, bool optimize = true);
 
 } // namespace Shader
@@ -15,6 +15,7 @@ static constexpr u32 NUM_USER_DATA_REGS = 16;
 static constexpr u32 NUM_IMAGES = 64;
 static constexpr u32 NUM_BUFFERS = 40;
 static constexpr u32 NUM_SAMPLERS = 16;
+static constexpr u32 NUM_BINDLESS_SAMPLERS = 16;
 static constexpr u32 NUM_FMASKS = 8;
 
 enum class BufferType : u32 {
@@ -134,6 +135,8 @@ struct PushData {
     static constexpr u32 YScaleIndex = 3;
     static constexpr u32 UdRegsIndex = 4;
     static constexpr u32 BufOffsetIndex = UdRegsIndex + NUM_USER_DATA_REGS / 4;
+    static constexpr u32 StepRate0Index = BufOffsetIndex + 3;
+    static constexpr u32 StepRate1Index = StepRate0Index + 1;
 
     float xoffset;
     float yoffset;
@@ -141,6 +144,8 @@ struct PushData {
     float yscale;
     std::array<u32, NUM_USER_DATA_REGS> ud_regs;
     std::array<u8, NUM_BUFFERS> buf_offsets;
+    u32 step_rate_0;
+    u32 step_rate_1;
 
     void AddOffset(u32 binding, u32 offset) {
         ASSERT(offset < 256 && binding < buf_offsets.size());
@@ -150,4 +155,14 @@ struct PushData {
 static_assert(sizeof(PushData) <= 128,
               "PushData size is greater than minimum size guaranteed by Vulkan spec");
 
+/// Pushed after PushData when samplers are bindless, holds the sampler heap slot of each bindless
+/// sampler of the pipeline. Samplers past the first ones of the pipeline keep their binding.
+struct BindlessPushData {
+    static constexpr u32 Offset = 128;
+    static constexpr u32 SamplerSlotsIndex = PushData::StepRate1Index + 1;
+
+    std::array<u32, NUM_BINDLESS_SAMPLERS> sampler_slots;
+};
+static_assert(sizeof(PushData) <= BindlessPushData::Offset);
+
 } // namespace Shader
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include "common/types.h"
+#include "common/unique_function.h"
+#include "video_core/amdgpu/regs.h"
+
+namespace AmdGpu {
+
+/// Work decoded from PM4 packets that still has to be recorded into Vulkan commands.
+/// Register writes are kept as deltas instead of snapshots of the whole register file; before
+/// running a command, the recording thread applies the deltas preceding it to its own registers.
+class DrawList {
+public:
+    void WriteRegs(u32 offset, const u32* data, u32 count) {
+        reg_deltas.push_back(offset);
+        reg_deltas.push_back(count);
+        reg_deltas.insert(reg_deltas.end(), data, data + count);
+    }
+
+    template <typename Func>
+    void Push(Func&& func) {
+        commands.push_back({static_cast<u32>(reg_deltas.size()), std::forward<Func>(func)});
+    }
+
+    /// Brings regs up to date command by command and runs the commands in between. Sets
+    /// graphics_dirty if any register the graphics pipeline depends on was written.
+    void Replay(Regs& regs, bool& graphics_dirty) {
+        size_t pos = 0;
+        const auto apply_until = [&](size_t end) {
+            while (pos < end) {
+                const u32 offset = reg_deltas[pos];
+                const u32 count = reg_deltas[pos + 1];
+                std::memcpy(&regs.reg_array[offset], &reg_deltas[pos + 2], count * sizeof(u32));
+                graphics_dirty |= Regs::AffectsGraphicsPipeline(offset);
+                pos += count + 2;
+            }
+        };
+        for (const auto& command : commands) {
+            apply_until(command.regs_end);
+            command.func();
+        }
+        apply_until(reg_deltas.size());
+    }
+
+    void Clear() {
+        reg_deltas.clear();
+        commands.clear();
+    }
+
+    [[nodiscard]] bool Empty() const noexcept {
+        return commands.empty() && reg_deltas.empty();
+    }
+
+    [[nodiscard]] size_t NumCommands() const noexcept {
+        return commands.size();
+    }
+
+private:
+    struct Command {
+        u32 regs_end; ///< Register deltas up to this offset precede the command
+        Common::UniqueFunction<void> func;
+    };
+    std::vector<u32> reg_deltas; ///< [word offset, count, values...] for every register write
+    std::vector<Command> commands;
+};
+
+} // namespace AmdGpu
@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <xxhash.h>
+
+#include "video_core/amdgpu/ib_cache.h"
+
+namespace AmdGpu {
+
+const DecodedIndirectBuffer* IndirectBufferCache::Find(std::span<const u32> ib) {
+    const auto it = entries.find(ib.data());
+    if (it == entries.end() || it->second.size != ib.size()) {
+        return nullptr;
+    }
+    auto& entry = it.value();
+    if (!entry.decoded.cacheable && ++entry.num_skipped < UncacheableRetryInterval) {
+        // Avoid hashing buffers every time just to find out they still can't be replayed
+        return &entry.decoded;
+    }
+    if (XXH3_64bits(ib.data(), ib.size_bytes()) != entry.hash) {
+        return nullptr;
+    }
+    entry.num_skipped = 0;
+    return &entry.decoded;
+}
+
+const DecodedIndirectBuffer* IndirectBufferCache::Insert(std::span<const u32> ib,
+                                                         DecodedIndirectBuffer&& decoded) {
+    if (entries.size() >= MaxEntries) {
+        entries.clear();
+    }
+    auto& entry = entries[ib.data()];
+    entry.size = ib.size();
+    entry.hash = XXH3_64bits(ib.data(), ib.size_bytes());
+    entry.num_skipped = 0;
+    entry.decoded = std::move(decoded);
+    return &entry.decoded;
+}
+
+} // namespace AmdGpu
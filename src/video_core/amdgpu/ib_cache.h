@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <span>
+#include <vector>
+#include <tsl/robin_map.h>
+
+#include "common/types.h"
+
+namespace AmdGpu {
+
+union PM4Header;
+
+/// Indirect buffer reduced to the register writes and draws it performs. Only buffers made of
+/// packets without side effects besides those can be decoded, anything else is not cacheable.
+struct DecodedIndirectBuffer {
+    enum class Op : u8 {
+        SetRegs,     ///< Writes count registers from data at offset
+        SetCsRegs,   ///< Writes count dwords of the gfx queue compute state at offset
+        SetCbExtent, ///< Sets the extent hint of color buffer offset to data
+        SetDbExtent, ///< Sets the depth buffer extent hint to data
+        ClearState,
+        Draw,     ///< Draws indexed if count is non-zero, starting at index offset
+        Dispatch, ///< Dispatches with the compute state of the gfx queue
+    };
+
+    struct Command {
+        Op op;
+        u32 offset;
+        u32 count;
+        u32 data;                ///< Start of the values in data, or the immediate value
+        const PM4Header* header; ///< Original packet, for debug markers
+        const char* name;
+    };
+
+    std::vector<Command> commands;
+    std::vector<u32> data;
+    bool cacheable{true};
+};
+
+/// Decoded indirect buffers keyed by address, for titles that submit the same command lists
+/// every frame. Entries are validated against a hash of the buffer contents on every lookup, so
+/// buffers rewritten in place by the guest are decoded again.
+class IndirectBufferCache {
+public:
+    /// Returns the decoding of the buffer if it is unchanged since it was inserted.
+    const DecodedIndirectBuffer* Find(std::span<const u32> ib);
+
+    const DecodedIndirectBuffer* Insert(std::span<const u32> ib, DecodedIndirectBuffer&& decoded);
+
+    [[nodiscard]] size_t NumEntries() const noexcept {
+        return entries.size();
+    }
+
+private:
+    static constexpr size_t MaxEntries = 4096;
+    /// Lookups of a buffer that was not cacheable before it is hashed and decoded again.
+    static constexpr u32 UncacheableRetryInterval = 64;
+
+    struct Entry {
+        size_t size;
+        u64 hash;
+        u32 num_skipped;
+        DecodedIndirectBuffer decoded;
+    };
+    tsl::robin_map<const u32*, Entry> entries;
+};
+
+} // namespace AmdGpu
@@ -6,6 +6,7 @@
 #include "common/assert.h"
 #include "common/config.h"
 #include "common/debug.h"
+#include "common/perf_counters.h"
 #include "common/polyfill_thread.h"
 #include "common/thread.h"
 #include "core/debug_state.h"
@@ -13,10 +14,13 @@
 #include "core/libraries/videoout/driver.h"
 #include "core/memory.h"
 #include "core/platform.h"
+#include "core/thread.h"
 #include "video_core/amdgpu/liverpool.h"
 #include "video_core/amdgpu/pm4_cmds.h"
 #include "video_core/renderdoc.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_rasterizer.h"
+#include "video_core/stall_tracker.h"
 
 namespace AmdGpu {
 
@@ -51,6 +55,42 @@ static const char* acb_task_name[] = NAME_ARRAY(ACB_TASK, MAX_NAMES);
 
 std::array<u8, 48_KB> Liverpool::ConstantEngine::constants_heap;
 
+/// Whether a COND_EXEC block only holds draws and dispatches, which predication skips on the GPU.
+/// Blocks writing registers or memory need the condition on the CPU to be skipped as a whole.
+static bool IsPredicableBlock(std::span<const u32> block) {
+    while (!block.empty()) {
+        const auto* header = reinterpret_cast<const PM4Header*>(block.data());
+        if (header->type == 2) {
+            block = block.subspan(1);
+            continue;
+        }
+        if (header->type != 3) {
+            return false;
+        }
+        switch (header->type3.opcode) {
+        case PM4ItOpcode::Nop:
+        case PM4ItOpcode::DrawIndex2:
+        case PM4ItOpcode::DrawIndexOffset2:
+        case PM4ItOpcode::DrawIndexAuto:
+        case PM4ItOpcode::DrawIndirect:
+        case PM4ItOpcode::DrawIndexIndirect:
+        case PM4ItOpcode::DrawIndexIndirectMulti:
+        case PM4ItOpcode::DrawIndexIndirectCountMulti:
+        case PM4ItOpcode::DispatchDirect:
+        case PM4ItOpcode::DispatchIndirect:
+            break;
+        default:
+            return false;
+        }
+        const size_t size = header->type3.NumWords() + 1;
+        if (size > block.size()) {
+            return false;
+        }
+        block = block.subspan(size);
+    }
+    return true;
+}
+
 static std::span<const u32> NextPacket(std::span<const u32> span, size_t offset) {
     if (offset > span.size()) {
         LOG_ERROR(
@@ -65,70 +105,165 @@ static std::span<const u32> NextPacket(std::span<const u32> span, size_t offset)
     return span.subspan(offset);
 }
 
+// In the case of HW, render target memory has alignment as color block operates on tiles. There is
+// no information of actual resource extents stored in CB context regs, so any deduction of it from
+// slices/pitch will lead to a larger surface created. The same applies to the depth targets.
+// Fortunately, the guest always sends a trailing NOP packet right after the context regs setup, so
+// we can use the heuristic below and extract the hint to determine actual resource dims.
+template <typename CbFunc, typename DbFunc>
+static void ParseExtentHints(u32 reg_addr, const PM4Header* header, const u32* payload,
+                             CbFunc&& set_cb_extent, DbFunc&& set_db_extent) {
+    switch (reg_addr) {
+    case ContextRegs::CbColor0Base:
+    case ContextRegs::CbColor1Base:
+    case ContextRegs::CbColor2Base:
+    case ContextRegs::CbColor3Base:
+    case ContextRegs::CbColor4Base:
+    case ContextRegs::CbColor5Base:
+    case ContextRegs::CbColor6Base:
+    case ContextRegs::CbColor7Base: {
+        const auto col_buf_id = (reg_addr - ContextRegs::CbColor0Base) /
+                                (ContextRegs::CbColor1Base - ContextRegs::CbColor0Base);
+        ASSERT(col_buf_id < NUM_COLOR_BUFFERS);
+
+        const auto nop_offset = header->type3.count;
+        if (nop_offset == 0x0e || nop_offset == 0x0d || nop_offset == 0x0b) {
+            ASSERT_MSG(payload[nop_offset] == 0xc0001000,
+                       "NOP hint is missing in CB setup sequence");
+            set_cb_extent(col_buf_id, payload[nop_offset + 1]);
+        } else {
+            set_cb_extent(col_buf_id, 0);
+        }
+        break;
+    }
+    case ContextRegs::CbColor0Cmask:
+    case ContextRegs::CbColor1Cmask:
+    case ContextRegs::CbColor2Cmask:
+    case ContextRegs::CbColor3Cmask:
+    case ContextRegs::CbColor4Cmask:
+    case ContextRegs::CbColor5Cmask:
+    case ContextRegs::CbColor6Cmask:
+    case ContextRegs::CbColor7Cmask: {
+        const auto col_buf_id = (reg_addr - ContextRegs::CbColor0Cmask) /
+                                (ContextRegs::CbColor1Cmask - ContextRegs::CbColor0Cmask);
+        ASSERT(col_buf_id < NUM_COLOR_BUFFERS);
+
+        const auto nop_offset = header->type3.count;
+        if (nop_offset == 0x04) {
+            ASSERT_MSG(payload[nop_offset] == 0xc0001000,
+                       "NOP hint is missing in CB setup sequence");
+            set_cb_extent(col_buf_id, payload[nop_offset + 1]);
+        }
+        break;
+    }
+    case ContextRegs::DbZInfo: {
+        if (header->type3.count == 8) {
+            ASSERT_MSG(payload[20] == 0xc0001000, "NOP hint is missing in DB setup sequence");
+            set_db_extent(payload[21]);
+        } else {
+            set_db_extent(0);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
 Liverpool::Liverpool() {
     num_counter_pairs = Libraries::Kernel::sceKernelIsNeoMode() ? 16 : 8;
+    pipelined = Config::isPipelinedCommandProcessing();
+    if (pipelined) {
+        pipelined_decode_regs = std::make_unique<Regs>();
+        decode_regs = pipelined_decode_regs.get();
+        draw_list = std::make_unique<DrawList>();
+        record_thread = std::jthread{std::bind_front(&Liverpool::ProcessDrawLists, this)};
+    }
+    if (Config::isIndirectBufferCacheEnabled()) {
+        ib_cache = std::make_unique<IndirectBufferCache>();
+    }
+    if (Config::isPM4ProfilingEnabled()) {
+        pm4_profiler = std::make_unique<PM4Profiler>();
+    }
     process_thread = std::jthread{std::bind_front(&Liverpool::Process, this)};
 }
 
 Liverpool::~Liverpool() {
     process_thread.request_stop();
     process_thread.join();
+    if (record_thread.joinable()) {
+        record_thread.request_stop();
+        record_thread.join();
+    }
+    if (ib_cache) {
+        const u64 lookups = DebugState.ib_cache_lookups;
+        const u64 hits = DebugState.ib_cache_hits;
+        LOG_INFO(Render, "Indirect buffer cache: {} lookups, {} hits ({:.1f}%), {} entries",
+                 lookups, hits, lookups ? 100.0 * hits / lookups : 0.0, ib_cache->NumEntries());
+    }
 }
 
 void Liverpool::ProcessCommands() {
+    if (pipelined && std::this_thread::get_id() != gpu_id) {
+        // Commands are run by the recording thread, in order with the work recorded so far
+        return;
+    }
     // Process incoming commands with high priority
-    while (num_commands) {
-        Common::UniqueFunction<void> callback{};
-        {
-            std::scoped_lock lk{submit_mutex};
-            callback = std::move(command_queue.front());
-            command_queue.pop();
-            --num_commands;
-        }
+    Common::UniqueFunction<void> callback{};
+    while (command_queue.TryPop(callback)) {
         callback();
     }
 }
 
 void Liverpool::Process(std::stop_token stoken) {
     Common::SetCurrentThreadName("shadPS4:GpuCommandProcessor");
-    gpu_id = std::this_thread::get_id();
+    Core::KeepCurrentThreadOffGuestCores();
+    if (!pipelined) {
+        gpu_id = std::this_thread::get_id();
+        VideoCore::MarkRenderThread();
+    }
 
+    const std::stop_callback stop_wakeup{stoken, [this] { WakeProcessor(); }};
+    const auto has_commands = [this] { return !pipelined && command_queue.Size() != 0; };
     while (!stoken.stop_requested()) {
-        {
-            std::unique_lock lk{submit_mutex};
-            Common::CondvarWait(submit_cv, lk, stoken,
-                                [this] { return num_commands || num_submits || submit_done; });
+        // Submitting threads only bump the wakeup counter, they never take a lock to get here
+        while (!stoken.stop_requested()) {
+            const u32 wakeups = processor_wakeups.load(std::memory_order_acquire);
+            if (has_commands() || num_submits || submit_done) {
+                break;
+            }
+            processor_wakeups.wait(wakeups, std::memory_order_acquire);
         }
         if (stoken.stop_requested()) {
             break;
         }
 
-        VideoCore::StartCapture();
+        Record([this] {
+            VideoCore::StartCapture();
+            // Shaders of the same pipeline may read different data from memory in a new submission
+            graphics_state_dirty = true;
+        });
 
         curr_qid = -1;
 
-        while (num_submits || num_commands) {
+        while (num_submits || has_commands()) {
             ProcessCommands();
 
             curr_qid = (curr_qid + 1) % num_mapped_queues;
 
             auto& queue = mapped_queues[curr_qid];
 
-            Task::Handle task{};
-            {
-                std::scoped_lock lock{queue.m_access};
-                if (queue.submits.empty()) {
-                    continue;
-                }
-                task = queue.submits.front();
+            const Task::Handle* front = queue.submits.Front();
+            if (!front) {
+                continue;
             }
+            const Task::Handle task = *front;
             task.resume();
+            FlushDrawList();
 
             if (task.done()) {
                 task.destroy();
-
-                std::scoped_lock lock{queue.m_access};
-                queue.submits.pop();
+                queue.submits.Pop();
 
                 --num_submits;
                 std::scoped_lock lock2{submit_mutex};
@@ -137,15 +272,401 @@ void Liverpool::Process(std::stop_token stoken) {
         }
 
         if (submit_done) {
-            VideoCore::EndCapture();
+            Record([this] {
+                VideoCore::EndCapture();
+                if (rasterizer) {
+                    rasterizer->OnSubmit();
+                    rasterizer->Flush();
+                }
+            });
+            submit_done = false;
+            if (pm4_profiler) {
+                pm4_profiler->EndFrame();
+            }
+            TaskFramePool::Stats frame_stats{};
+            for (auto& queue : mapped_queues) {
+                const auto stats = queue.frame_pool.ConsumeStats();
+                frame_stats.allocated += stats.allocated;
+                frame_stats.recycled += stats.recycled;
+            }
+            DebugState.task_frames_allocated = frame_stats.allocated;
+            DebugState.task_frames_recycled = frame_stats.recycled;
             if (rasterizer) {
-                rasterizer->OnSubmit();
-                rasterizer->Flush();
+                const auto protect_stats = rasterizer->GetPageManager().ConsumeProtectStats();
+                DebugState.page_protect_requests = protect_stats.requests;
+                DebugState.page_protect_syscalls = protect_stats.syscalls;
+                const auto fault_stats = rasterizer->GetBufferCache().ConsumeFaultStats();
+                DebugState.fault_buffer_passes = fault_stats.passes;
+                DebugState.fault_buffer_pages = fault_stats.pages;
+                DebugState.fault_buffer_ranges = fault_stats.ranges;
+                DebugState.fault_buffer_buffers = fault_stats.buffers;
+                const auto upload_stats = rasterizer->GetTextureCache().ConsumeUploadStats();
+                DebugState.image_uploads = upload_stats.images;
+                DebugState.image_upload_barriers = upload_stats.barriers;
+                const auto memory_stats = rasterizer->GetInstance().ConsumeMemoryStats();
+                DebugState.device_memory_allocations = memory_stats.device_allocations;
+                DebugState.device_memory_frees = memory_stats.device_frees;
+                DebugState.vma_allocations = memory_stats.allocations;
+                DebugState.vma_allocation_bytes = memory_stats.allocation_bytes;
+                DebugState.vma_block_bytes = memory_stats.block_bytes;
+                DebugState.vma_pool_allocation_bytes = memory_stats.pool_allocation_bytes;
+                DebugState.vma_pool_block_bytes = memory_stats.pool_block_bytes;
             }
-            submit_done = false;
         }
 
-        Platform::IrqC::Instance()->Signal(Platform::InterruptId::GpuIdle);
+        Record([] { Platform::IrqC::Instance()->Signal(Platform::InterruptId::GpuIdle); });
+        FlushDrawList();
+    }
+}
+
+void Liverpool::ProcessDrawLists(std::stop_token stoken) {
+    Common::SetCurrentThreadName("shadPS4:GpuCommandRecorder");
+    Core::KeepCurrentThreadOffGuestCores();
+    gpu_id = std::this_thread::get_id();
+    VideoCore::MarkRenderThread();
+
+    while (!stoken.stop_requested()) {
+        std::unique_ptr<DrawList> list{};
+        {
+            std::unique_lock lk{submit_mutex};
+            Common::CondvarWait(submit_cv, lk, stoken, [this] {
+                return command_queue.Size() != 0 || !pending_lists.empty();
+            });
+            if (stoken.stop_requested()) {
+                break;
+            }
+            if (!pending_lists.empty()) {
+                list = std::move(pending_lists.front());
+                pending_lists.pop();
+            }
+        }
+
+        ProcessCommands();
+        if (!list) {
+            continue;
+        }
+        list->Replay(regs, graphics_state_dirty);
+        list->Clear();
+
+        std::scoped_lock lk{submit_mutex};
+        free_lists.emplace_back(std::move(list));
+        --num_pending_lists;
+        submit_cv.notify_all();
+    }
+}
+
+void Liverpool::FlushDrawList() {
+    if (!pipelined || draw_list->Empty()) {
+        return;
+    }
+    std::unique_lock lk{submit_mutex};
+    // Don't let the parser run arbitrarily far ahead of the recording thread
+    submit_cv.wait(lk, [this] { return num_pending_lists < MaxPendingDrawLists; });
+    pending_lists.emplace(std::move(draw_list));
+    ++num_pending_lists;
+    if (free_lists.empty()) {
+        draw_list = std::make_unique<DrawList>();
+    } else {
+        draw_list = std::move(free_lists.back());
+        free_lists.pop_back();
+    }
+    submit_cv.notify_all();
+}
+
+void Liverpool::WaitForDrawLists() {
+    if (!pipelined) {
+        return;
+    }
+    FlushDrawList();
+    std::unique_lock lk{submit_mutex};
+    submit_cv.wait(lk, [this] { return num_pending_lists == 0; });
+}
+
+void Liverpool::SignalEndOfPipe(Common::UniqueFunction<void>&& signal) {
+    if (rasterizer && (Config::readbacks() || num_pending_gds_stores.load() > 0)) {
+        // Data read back from the GPU lands in guest memory once the GPU is done with it, the
+        // guest must not see the label before that.
+        rasterizer->SignalOnGpuCompletion(std::move(signal));
+    } else {
+        signal();
+    }
+}
+
+void Liverpool::ProcessDmaData(const PM4DmaData& dma_data) {
+    if (dma_data.src_sel == DmaDataSrc::Data && dma_data.dst_sel == DmaDataDst::Gds) {
+        rasterizer->FillBuffer(dma_data.dst_addr_lo, dma_data.NumBytes(), dma_data.data, true);
+    } else if ((dma_data.src_sel == DmaDataSrc::Memory ||
+                dma_data.src_sel == DmaDataSrc::MemoryUsingL2) &&
+               dma_data.dst_sel == DmaDataDst::Gds) {
+        rasterizer->CopyBuffer(dma_data.dst_addr_lo, dma_data.SrcAddress<VAddr>(),
+                               dma_data.NumBytes(), true, false);
+    } else if (dma_data.src_sel == DmaDataSrc::Data &&
+               (dma_data.dst_sel == DmaDataDst::Memory ||
+                dma_data.dst_sel == DmaDataDst::MemoryUsingL2)) {
+        rasterizer->FillBuffer(dma_data.DstAddress<VAddr>(), dma_data.NumBytes(), dma_data.data,
+                               false);
+    } else if (dma_data.src_sel == DmaDataSrc::Gds &&
+               (dma_data.dst_sel == DmaDataDst::Memory ||
+                dma_data.dst_sel == DmaDataDst::MemoryUsingL2)) {
+        rasterizer->CopyBuffer(dma_data.DstAddress<VAddr>(), dma_data.src_addr_lo,
+                               dma_data.NumBytes(), false, true);
+    } else if ((dma_data.src_sel == DmaDataSrc::Memory ||
+                dma_data.src_sel == DmaDataSrc::MemoryUsingL2) &&
+               (dma_data.dst_sel == DmaDataDst::Memory ||
+                dma_data.dst_sel == DmaDataDst::MemoryUsingL2)) {
+        rasterizer->CopyBuffer(dma_data.DstAddress<VAddr>(), dma_data.SrcAddress<VAddr>(),
+                               dma_data.NumBytes(), false, false);
+    } else {
+        UNREACHABLE_MSG("WriteData src_sel = {}, dst_sel = {}", u32(dma_data.src_sel.Value()),
+                        u32(dma_data.dst_sel.Value()));
+    }
+}
+
+const DecodedIndirectBuffer* Liverpool::LookupIndirectBuffer(std::span<const u32> ib) {
+    ++DebugState.ib_cache_lookups;
+    const auto* decoded = ib_cache->Find(ib);
+    if (!decoded) {
+        decoded = ib_cache->Insert(ib, DecodeIndirectBuffer(ib));
+    } else if (decoded->cacheable) {
+        ++DebugState.ib_cache_hits;
+    }
+    return decoded->cacheable ? decoded : nullptr;
+}
+
+DecodedIndirectBuffer Liverpool::DecodeIndirectBuffer(std::span<const u32> ib) {
+    using Op = DecodedIndirectBuffer::Op;
+    DecodedIndirectBuffer decoded{};
+    const auto push = [&](Op op, u32 offset, u32 count, u32 data, const PM4Header* header = nullptr,
+                          const char* name = nullptr) {
+        decoded.commands.push_back({op, offset, count, data, header, name});
+    };
+    const auto set_regs = [&](Op op, u32 offset, const u32* values, u32 count) {
+        auto& commands = decoded.commands;
+        if (!commands.empty() && commands.back().op == op &&
+            commands.back().offset + commands.back().count == offset) {
+            // Merge writes to consecutive registers
+            commands.back().count += count;
+        } else {
+            push(op, offset, count, static_cast<u32>(decoded.data.size()));
+        }
+        decoded.data.insert(decoded.data.end(), values, values + count);
+    };
+    // The parser registers are only used to locate fields, their contents are left untouched
+    const auto set_field = [&](const auto& field, const auto& value) {
+        static_assert(sizeof(field) == sizeof(value) && sizeof(value) % sizeof(u32) == 0);
+        const auto offset = reinterpret_cast<const u32*>(&field) - decode_regs->reg_array.data();
+        set_regs(Op::SetRegs, static_cast<u32>(offset), reinterpret_cast<const u32*>(&value),
+                 sizeof(value) / sizeof(u32));
+    };
+    const auto uncacheable = [] {
+        DecodedIndirectBuffer result{};
+        result.cacheable = false;
+        return result;
+    };
+
+    while (!ib.empty()) {
+        const auto* header = reinterpret_cast<const PM4Header*>(ib.data());
+        if (header->type == 2) {
+            ib = NextPacket(ib, 1);
+            continue;
+        }
+        if (header->type != 3) {
+            return uncacheable();
+        }
+        const u32 count = header->type3.NumWords();
+        const auto* payload = reinterpret_cast<const u32*>(header + 2);
+        if (header->type3.predicate == PM4Predicate::PredEnable) {
+            return uncacheable();
+        }
+        switch (header->type3.opcode) {
+        case PM4ItOpcode::Nop: {
+            const auto* nop = reinterpret_cast<const PM4CmdNop*>(header);
+            if (nop->header.count.Value() == 0) {
+                break;
+            }
+            switch (nop->data_block[0]) {
+            case PM4CmdNop::PayloadType::PatchedFlip:
+            case PM4CmdNop::PayloadType::DebugMarkerPush:
+            case PM4CmdNop::PayloadType::DebugColorMarkerPush:
+            case PM4CmdNop::PayloadType::DebugMarkerPop:
+                return uncacheable();
+            default:
+                break;
+            }
+            break;
+        }
+        case PM4ItOpcode::ContextControl:
+        case PM4ItOpcode::AcquireMem:
+            break;
+        case PM4ItOpcode::ClearState:
+            push(Op::ClearState, 0, 0, 0);
+            break;
+        case PM4ItOpcode::SetConfigReg: {
+            const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
+            set_regs(Op::SetRegs, Regs::ConfigRegWordOffset + set_data->reg_offset, payload,
+                     count - 1);
+            break;
+        }
+        case PM4ItOpcode::SetContextReg: {
+            const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
+            const auto reg_addr = Regs::ContextRegWordOffset + set_data->reg_offset;
+            set_regs(Op::SetRegs, reg_addr, payload, count - 1);
+            ParseExtentHints(
+                reg_addr, header, payload,
+                [&](u32 col_buf_id, u32 raw) { push(Op::SetCbExtent, col_buf_id, 0, raw); },
+                [&](u32 raw) { push(Op::SetDbExtent, 0, 0, raw); });
+            break;
+        }
+        case PM4ItOpcode::SetShReg: {
+            const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
+            if (set_data->reg_offset >= 0x200 &&
+                set_data->reg_offset <= (0x200 + sizeof(ComputeProgram) / 4)) {
+                ASSERT((count - 1) * sizeof(u32) <= sizeof(ComputeProgram));
+                set_regs(Op::SetCsRegs, set_data->reg_offset - 0x200, payload, count - 1);
+            } else {
+                set_regs(Op::SetRegs, Regs::ShRegWordOffset + set_data->reg_offset, payload,
+                         count - 1);
+            }
+            break;
+        }
+        case PM4ItOpcode::SetUconfigReg: {
+            const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
+            set_regs(Op::SetRegs, Regs::UconfigRegWordOffset + set_data->reg_offset, payload,
+                     count - 1);
+            break;
+        }
+        case PM4ItOpcode::IndexType: {
+            const auto* index_type = reinterpret_cast<const PM4CmdDrawIndexType*>(header);
+            IndexBufferType type = decode_regs->index_buffer_type;
+            type.raw = index_type->raw;
+            set_field(decode_regs->index_buffer_type, type);
+            break;
+        }
+        case PM4ItOpcode::DrawIndex2: {
+            const auto* draw_index = reinterpret_cast<const PM4CmdDrawIndex2*>(header);
+            IndexBufferBase index_base = decode_regs->index_base_address;
+            index_base.base_addr_lo = draw_index->index_base_lo;
+            index_base.base_addr_hi = draw_index->index_base_hi;
+            set_field(decode_regs->max_index_size, draw_index->max_size);
+            set_field(decode_regs->index_base_address, index_base);
+            set_field(decode_regs->num_indices, draw_index->index_count);
+            set_field(decode_regs->draw_initiator, draw_index->draw_initiator);
+            push(Op::Draw, 0, 1, 0, header, "DrawIndex2");
+            break;
+        }
+        case PM4ItOpcode::DrawIndexOffset2: {
+            const auto* draw_index_off = reinterpret_cast<const PM4CmdDrawIndexOffset2*>(header);
+            set_field(decode_regs->max_index_size, draw_index_off->max_size);
+            set_field(decode_regs->num_indices, draw_index_off->index_count);
+            set_field(decode_regs->draw_initiator, draw_index_off->draw_initiator);
+            push(Op::Draw, draw_index_off->index_offset, 1, 0, header, "DrawIndexOffset2");
+            break;
+        }
+        case PM4ItOpcode::DrawIndexAuto: {
+            const auto* draw_index = reinterpret_cast<const PM4CmdDrawIndexAuto*>(header);
+            set_field(decode_regs->num_indices, draw_index->index_count);
+            set_field(decode_regs->draw_initiator, draw_index->draw_initiator);
+            push(Op::Draw, 0, 0, 0, header, "DrawIndexAuto");
+            break;
+        }
+        case PM4ItOpcode::DispatchDirect: {
+            const auto* dispatch_direct = reinterpret_cast<const PM4CmdDispatchDirect*>(header);
+            const std::array<u32, 4> dispatch = {dispatch_direct->dispatch_initiator,
+                                                 dispatch_direct->dim_x, dispatch_direct->dim_y,
+                                                 dispatch_direct->dim_z};
+            static_assert(offsetof(ComputeProgram, dispatch_initiator) == 0 &&
+                          offsetof(ComputeProgram, dim_z) == 3 * sizeof(u32));
+            set_regs(Op::SetCsRegs, 0, dispatch.data(), static_cast<u32>(dispatch.size()));
+            push(Op::Dispatch, 0, 0, 0, header, "DispatchDirect");
+            break;
+        }
+        case PM4ItOpcode::NumInstances: {
+            const auto* num_instances = reinterpret_cast<const PM4CmdDrawNumInstances*>(header);
+            set_field(decode_regs->num_instances, num_instances->num_instances);
+            break;
+        }
+        case PM4ItOpcode::IndexBase: {
+            const auto* index_base_cmd = reinterpret_cast<const PM4CmdDrawIndexBase*>(header);
+            IndexBufferBase index_base = decode_regs->index_base_address;
+            index_base.base_addr_lo = index_base_cmd->addr_lo;
+            index_base.base_addr_hi = index_base_cmd->addr_hi;
+            set_field(decode_regs->index_base_address, index_base);
+            break;
+        }
+        case PM4ItOpcode::IndexBufferSize: {
+            const auto* index_size = reinterpret_cast<const PM4CmdDrawIndexBufferSize*>(header);
+            set_field(decode_regs->num_indices, index_size->num_indices);
+            break;
+        }
+        default:
+            // Anything that touches memory, waits or interacts with the guest is processed as is
+            return uncacheable();
+        }
+        ib = NextPacket(ib, count + 1);
+    }
+    return decoded;
+}
+
+void Liverpool::SetDrawPredicated(bool predicated) {
+    draw_predicated = predicated;
+    if (rasterizer) {
+        Record([this, predicated] { rasterizer->SetDrawPredicated(predicated); });
+    }
+}
+
+void Liverpool::ReplayIndirectBuffer(const DecodedIndirectBuffer& ib) {
+    using Op = DecodedIndirectBuffer::Op;
+    // Same as processing the buffer as a submission of its own
+    cblock.Reset();
+    // Cached buffers have no predicated packets
+    if (draw_predicated) {
+        SetDrawPredicated(false);
+    }
+    for (const auto& cmd : ib.commands) {
+        switch (cmd.op) {
+        case Op::SetRegs:
+            WriteRegs(cmd.offset, &ib.data[cmd.data], cmd.count);
+            break;
+        case Op::SetCsRegs: {
+            auto* addr = reinterpret_cast<u32*>(&mapped_queues[GfxQueueId].cs_state) + cmd.offset;
+            std::memcpy(addr, &ib.data[cmd.data], cmd.count * sizeof(u32));
+            break;
+        }
+        case Op::SetCbExtent:
+            SetCbExtent(cmd.offset, cmd.data);
+            break;
+        case Op::SetDbExtent:
+            SetDbExtent(cmd.data);
+            break;
+        case Op::ClearState:
+            ClearState();
+            break;
+        case Op::Draw:
+            if (rasterizer) {
+                Record([this, cmd_address = reinterpret_cast<const void*>(cmd.header),
+                        name = cmd.name, is_indexed = cmd.count != 0, index_offset = cmd.offset] {
+                    rasterizer->ScopeMarkerBegin(fmt::format("gfx:{}:{}", cmd_address, name));
+                    rasterizer->Draw(is_indexed, index_offset);
+                    rasterizer->ScopeMarkerEnd();
+                });
+            }
+            break;
+        case Op::Dispatch: {
+            const auto& cs_program = mapped_queues[GfxQueueId].cs_state;
+            if (rasterizer && (cs_program.dispatch_initiator & 1)) {
+                Record([this, cmd_address = reinterpret_cast<const void*>(cmd.header), cs_program] {
+                    if (pipelined) {
+                        record_cs_state = cs_program;
+                    }
+                    rasterizer->ScopeMarkerBegin(
+                        fmt::format("gfx:{}:DispatchDirect", cmd_address));
+                    rasterizer->DispatchDirect();
+                    rasterizer->ScopeMarkerEnd();
+                });
+            }
+            break;
+        }
+        }
     }
 }
 
@@ -177,8 +698,16 @@ Liverpool::Task Liverpool::ProcessCeUpdate(std::span<const u32> ccb) {
         }
         case PM4ItOpcode::DumpConstRam: {
             const auto* dump_const = reinterpret_cast<const PM4DumpConstRam*>(header);
-            memcpy(dump_const->Address<void*>(),
-                   cblock.constants_heap.data() + dump_const->Offset(), dump_const->Size());
+            const u8* constants = cblock.constants_heap.data() + dump_const->Offset();
+            if (pipelined) {
+                // Draws recorded later may still read the previous contents of the memory.
+                Record([address = dump_const->Address<void*>(),
+                        data = std::vector<u8>(constants, constants + dump_const->Size())] {
+                    memcpy(address, data.data(), data.size());
+                });
+            } else {
+                memcpy(dump_const->Address<void*>(), constants, dump_const->Size());
+            }
             break;
         }
         case PM4ItOpcode::IncrementCeCounter: {
@@ -231,9 +760,16 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
     }
 
     const auto base_addr = reinterpret_cast<uintptr_t>(dcb.data());
+    // End of the COND_EXEC block whose draws are predicated on the GPU
+    const u32* cond_exec_end{};
     while (!dcb.empty()) {
         ProcessCommands();
 
+        if (cond_exec_end && dcb.data() >= cond_exec_end) {
+            cond_exec_end = nullptr;
+            Record([this] { rasterizer->EndCondExec(); });
+        }
+
         const auto* header = reinterpret_cast<const PM4Header*>(dcb.data());
         const u32 type = header->type;
 
@@ -252,6 +788,13 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
         case 3:
             const u32 count = header->type3.NumWords();
             const PM4ItOpcode opcode = header->type3.opcode;
+            const PM4Profiler::Scope profile{pm4_profiler.get(), PM4QueueType::Graphics, opcode};
+            Common::CountPerf(Common::PerfCounter::Pm4Packets);
+            if (const bool predicated =
+                    header->type3.predicate == PM4Predicate::PredEnable || cond_exec_end != nullptr;
+                predicated != draw_predicated) {
+                SetDrawPredicated(predicated);
+            }
             switch (opcode) {
             case PM4ItOpcode::Nop: {
                 const auto* nop = reinterpret_cast<const PM4CmdNop*>(header);
@@ -263,7 +806,9 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 case PM4CmdNop::PayloadType::PatchedFlip: {
                     // There is no evidence that GPU CP drives flip events by parsing
                     // special NOP packets. For convenience lets assume that it does.
-                    Platform::IrqC::Instance()->Signal(Platform::InterruptId::GfxFlip);
+                    Record([] {
+                        Platform::IrqC::Instance()->Signal(Platform::InterruptId::GfxFlip);
+                    });
                     break;
                 }
                 case PM4CmdNop::PayloadType::DebugMarkerPush: {
@@ -271,7 +816,9 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                     const std::string_view label{reinterpret_cast<const char*>(&nop->data_block[1]),
                                                  marker_sz};
                     if (rasterizer) {
-                        rasterizer->ScopeMarkerBegin(label, true);
+                        Record([this, label = std::string{label}] {
+                            rasterizer->ScopeMarkerBegin(label, true);
+                        });
                     }
                     break;
                 }
@@ -282,13 +829,15 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                     const u32 color = *reinterpret_cast<const u32*>(
                         reinterpret_cast<const u8*>(&nop->data_block[1]) + marker_sz);
                     if (rasterizer) {
-                        rasterizer->ScopedMarkerInsertColor(label, color, true);
+                        Record([this, label = std::string{label}, color] {
+                            rasterizer->ScopedMarkerInsertColor(label, color, true);
+                        });
                     }
                     break;
                 }
                 case PM4CmdNop::PayloadType::DebugMarkerPop: {
                     if (rasterizer) {
-                        rasterizer->ScopeMarkerEnd(true);
+                        Record([this] { rasterizer->ScopeMarkerEnd(true); });
                     }
                     break;
                 }
@@ -301,14 +850,14 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 break;
             }
             case PM4ItOpcode::ClearState: {
-                regs.SetDefaults();
+                ClearState();
                 break;
             }
             case PM4ItOpcode::SetConfigReg: {
                 const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
                 const auto reg_addr = Regs::ConfigRegWordOffset + set_data->reg_offset;
                 const auto* payload = reinterpret_cast<const u32*>(header + 2);
-                std::memcpy(&regs.reg_array[reg_addr], payload, (count - 1) * sizeof(u32));
+                WriteRegs(reg_addr, payload, count - 1);
                 break;
             }
             case PM4ItOpcode::SetContextReg: {
@@ -316,72 +865,11 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 const auto reg_addr = Regs::ContextRegWordOffset + set_data->reg_offset;
                 const auto* payload = reinterpret_cast<const u32*>(header + 2);
 
-                std::memcpy(&regs.reg_array[reg_addr], payload, (count - 1) * sizeof(u32));
-
-                // In the case of HW, render target memory has alignment as color block operates on
-                // tiles. There is no information of actual resource extents stored in CB context
-                // regs, so any deduction of it from slices/pitch will lead to a larger surface
-                // created. The same applies to the depth targets. Fortunately, the guest always
-                // sends a trailing NOP packet right after the context regs setup, so we can use the
-                // heuristic below and extract the hint to determine actual resource dims.
-
-                switch (reg_addr) {
-                case ContextRegs::CbColor0Base:
-                case ContextRegs::CbColor1Base:
-                case ContextRegs::CbColor2Base:
-                case ContextRegs::CbColor3Base:
-                case ContextRegs::CbColor4Base:
-                case ContextRegs::CbColor5Base:
-                case ContextRegs::CbColor6Base:
-                case ContextRegs::CbColor7Base: {
-                    const auto col_buf_id = (reg_addr - ContextRegs::CbColor0Base) /
-                                            (ContextRegs::CbColor1Base - ContextRegs::CbColor0Base);
-                    ASSERT(col_buf_id < NUM_COLOR_BUFFERS);
-
-                    const auto nop_offset = header->type3.count;
-                    if (nop_offset == 0x0e || nop_offset == 0x0d || nop_offset == 0x0b) {
-                        ASSERT_MSG(payload[nop_offset] == 0xc0001000,
-                                   "NOP hint is missing in CB setup sequence");
-                        last_cb_extent[col_buf_id].raw = payload[nop_offset + 1];
-                    } else {
-                        last_cb_extent[col_buf_id].raw = 0;
-                    }
-                    break;
-                }
-                case ContextRegs::CbColor0Cmask:
-                case ContextRegs::CbColor1Cmask:
-                case ContextRegs::CbColor2Cmask:
-                case ContextRegs::CbColor3Cmask:
-                case ContextRegs::CbColor4Cmask:
-                case ContextRegs::CbColor5Cmask:
-                case ContextRegs::CbColor6Cmask:
-                case ContextRegs::CbColor7Cmask: {
-                    const auto col_buf_id =
-                        (reg_addr - ContextRegs::CbColor0Cmask) /
-                        (ContextRegs::CbColor1Cmask - ContextRegs::CbColor0Cmask);
-                    ASSERT(col_buf_id < NUM_COLOR_BUFFERS);
-
-                    const auto nop_offset = header->type3.count;
-                    if (nop_offset == 0x04) {
-                        ASSERT_MSG(payload[nop_offset] == 0xc0001000,
-                                   "NOP hint is missing in CB setup sequence");
-                        last_cb_extent[col_buf_id].raw = payload[nop_offset + 1];
-                    }
-                    break;
-                }
-                case ContextRegs::DbZInfo: {
-                    if (header->type3.count == 8) {
-                        ASSERT_MSG(payload[20] == 0xc0001000,
-                                   "NOP hint is missing in DB setup sequence");
-                        last_db_extent.raw = payload[21];
-                    } else {
-                        last_db_extent.raw = 0;
-                    }
-                    break;
-                }
-                default:
-                    break;
-                }
+                WriteRegs(reg_addr, payload, count - 1);
+
+                ParseExtentHints(reg_addr, header, payload,
+                                 [this](u32 col_buf_id, u32 raw) { SetCbExtent(col_buf_id, raw); },
+                                 [this](u32 raw) { SetDbExtent(raw); });
                 break;
             }
             case PM4ItOpcode::SetShReg: {
@@ -395,74 +883,114 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                                  (set_data->reg_offset - 0x200);
                     std::memcpy(addr, header + 2, set_size);
                 } else {
-                    std::memcpy(&regs.reg_array[Regs::ShRegWordOffset + set_data->reg_offset],
-                                header + 2, set_size);
+                    WriteRegs(Regs::ShRegWordOffset + set_data->reg_offset,
+                              reinterpret_cast<const u32*>(header + 2), count - 1);
                 }
                 break;
             }
             case PM4ItOpcode::SetUconfigReg: {
                 const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
-                std::memcpy(&regs.reg_array[Regs::UconfigRegWordOffset + set_data->reg_offset],
-                            header + 2, (count - 1) * sizeof(u32));
+                WriteRegs(Regs::UconfigRegWordOffset + set_data->reg_offset,
+                          reinterpret_cast<const u32*>(header + 2), count - 1);
                 break;
             }
             case PM4ItOpcode::SetPredication: {
-                LOG_WARNING(Render, "Unimplemented IT_SET_PREDICATION");
+                const auto* predication = reinterpret_cast<const PM4CmdSetPredication*>(header);
+                const auto op = predication->op.Value();
+                // Predicates that can't be tested on the GPU keep the draws, like a failed test
+                // of a query that isn't done would with the no wait hint
+                VAddr address = 0;
+                const bool is_memory = op == PredicationOp::Bool64;
+                if ((op == PredicationOp::Zpass || is_memory) && !predication->continue_bit) {
+                    address = predication->Address();
+                } else if (op != PredicationOp::Clear) {
+                    LOG_WARNING(Render, "Unsupported predication op {}, continue {}",
+                                magic_enum::enum_name(op), predication->continue_bit.Value());
+                }
+                if (rasterizer) {
+                    Record([this, address, is_memory,
+                            draw_if_visible = predication->draw_if_visible != 0] {
+                        if (is_memory) {
+                            rasterizer->SetMemoryPredication(address, draw_if_visible);
+                        } else {
+                            rasterizer->SetPredication(address, draw_if_visible);
+                        }
+                    });
+                }
                 break;
             }
             case PM4ItOpcode::IndexType: {
                 const auto* index_type = reinterpret_cast<const PM4CmdDrawIndexType*>(header);
-                regs.index_buffer_type.raw = index_type->raw;
+                decode_regs->index_buffer_type.raw = index_type->raw;
+                RecordRegs(decode_regs->index_buffer_type);
                 break;
             }
             case PM4ItOpcode::DrawIndex2: {
                 const auto* draw_index = reinterpret_cast<const PM4CmdDrawIndex2*>(header);
-                regs.max_index_size = draw_index->max_size;
-                regs.index_base_address.base_addr_lo = draw_index->index_base_lo;
-                regs.index_base_address.base_addr_hi = draw_index->index_base_hi;
-                regs.num_indices = draw_index->index_count;
-                regs.draw_initiator = draw_index->draw_initiator;
+                decode_regs->max_index_size = draw_index->max_size;
+                decode_regs->index_base_address.base_addr_lo = draw_index->index_base_lo;
+                decode_regs->index_base_address.base_addr_hi = draw_index->index_base_hi;
+                decode_regs->num_indices = draw_index->index_count;
+                decode_regs->draw_initiator = draw_index->draw_initiator;
+                RecordRegs(decode_regs->max_index_size);
+                RecordRegs(decode_regs->index_base_address);
+                RecordRegs(decode_regs->num_indices);
+                RecordRegs(decode_regs->draw_initiator);
                 if (DebugState.DumpingCurrentReg()) {
-                    DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header), regs);
+                    DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header),
+                                            *decode_regs);
                 }
                 if (rasterizer) {
-                    const auto cmd_address = reinterpret_cast<const void*>(header);
-                    rasterizer->ScopeMarkerBegin(fmt::format("gfx:{}:DrawIndex2", cmd_address));
-                    rasterizer->Draw(true);
-                    rasterizer->ScopeMarkerEnd();
+                    Record([this, cmd_address = reinterpret_cast<const void*>(header)] {
+                        rasterizer->ScopeMarkerBegin(
+                            fmt::format("gfx:{}:DrawIndex2", cmd_address));
+                        rasterizer->Draw(true);
+                        rasterizer->ScopeMarkerEnd();
+                    });
                 }
                 break;
             }
             case PM4ItOpcode::DrawIndexOffset2: {
                 const auto* draw_index_off =
                     reinterpret_cast<const PM4CmdDrawIndexOffset2*>(header);
-                regs.max_index_size = draw_index_off->max_size;
-                regs.num_indices = draw_index_off->index_count;
-                regs.draw_initiator = draw_index_off->draw_initiator;
+                decode_regs->max_index_size = draw_index_off->max_size;
+                decode_regs->num_indices = draw_index_off->index_count;
+                decode_regs->draw_initiator = draw_index_off->draw_initiator;
+                RecordRegs(decode_regs->max_index_size);
+                RecordRegs(decode_regs->num_indices);
+                RecordRegs(decode_regs->draw_initiator);
                 if (DebugState.DumpingCurrentReg()) {
-                    DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header), regs);
+                    DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header),
+                                            *decode_regs);
                 }
                 if (rasterizer) {
-                    const auto cmd_address = reinterpret_cast<const void*>(header);
-                    rasterizer->ScopeMarkerBegin(
-                        fmt::format("gfx:{}:DrawIndexOffset2", cmd_address));
-                    rasterizer->Draw(true, draw_index_off->index_offset);
-                    rasterizer->ScopeMarkerEnd();
+                    Record([this, cmd_address = reinterpret_cast<const void*>(header),
+                            index_offset = draw_index_off->index_offset] {
+                        rasterizer->ScopeMarkerBegin(
+                            fmt::format("gfx:{}:DrawIndexOffset2", cmd_address));
+                        rasterizer->Draw(true, index_offset);
+                        rasterizer->ScopeMarkerEnd();
+                    });
                 }
                 break;
             }
             case PM4ItOpcode::DrawIndexAuto: {
                 const auto* draw_index = reinterpret_cast<const PM4CmdDrawIndexAuto*>(header);
-                regs.num_indices = draw_index->index_count;
-                regs.draw_initiator = draw_index->draw_initiator;
+                decode_regs->num_indices = draw_index->index_count;
+                decode_regs->draw_initiator = draw_index->draw_initiator;
+                RecordRegs(decode_regs->num_indices);
+                RecordRegs(decode_regs->draw_initiator);
                 if (DebugState.DumpingCurrentReg()) {
-                    DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header), regs);
+                    DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header),
+                                            *decode_regs);
                 }
                 if (rasterizer) {
-                    const auto cmd_address = reinterpret_cast<const void*>(header);
-                    rasterizer->ScopeMarkerBegin(fmt::format("gfx:{}:DrawIndexAuto", cmd_address));
-                    rasterizer->Draw(false);
-                    rasterizer->ScopeMarkerEnd();
+                    Record([this, cmd_address = reinterpret_cast<const void*>(header)] {
+                        rasterizer->ScopeMarkerBegin(
+                            fmt::format("gfx:{}:DrawIndexAuto", cmd_address));
+                        rasterizer->Draw(false);
+                        rasterizer->ScopeMarkerEnd();
+                    });
                 }
                 break;
             }
@@ -471,13 +999,17 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 const auto offset = draw_indirect->data_offset;
                 const auto stride = sizeof(DrawIndirectArgs);
                 if (DebugState.DumpingCurrentReg()) {
-                    DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header), regs);
+                    DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header),
+                                            *decode_regs);
                 }
                 if (rasterizer) {
-                    const auto cmd_address = reinterpret_cast<const void*>(header);
-                    rasterizer->ScopeMarkerBegin(fmt::format("gfx:{}:DrawIndirect", cmd_address));
-                    rasterizer->DrawIndirect(false, indirect_args_addr, offset, stride, 1, 0);
-                    rasterizer->ScopeMarkerEnd();
+                    Record([this, cmd_address = reinterpret_cast<const void*>(header),
+                            args_addr = indirect_args_addr, offset, stride] {
+                        rasterizer->ScopeMarkerBegin(
+                            fmt::format("gfx:{}:DrawIndirect", cmd_address));
+                        rasterizer->DrawIndirect(false, args_addr, offset, stride, 1, 0);
+                        rasterizer->ScopeMarkerEnd();
+                    });
                 }
                 break;
             }
@@ -487,14 +1019,17 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 const auto offset = draw_index_indirect->data_offset;
                 const auto stride = sizeof(DrawIndexedIndirectArgs);
                 if (DebugState.DumpingCurrentReg()) {
-                    DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header), regs);
+                    DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header),
+                                            *decode_regs);
                 }
                 if (rasterizer) {
-                    const auto cmd_address = reinterpret_cast<const void*>(header);
-                    rasterizer->ScopeMarkerBegin(
-                        fmt::format("gfx:{}:DrawIndexIndirect", cmd_address));
-                    rasterizer->DrawIndirect(true, indirect_args_addr, offset, stride, 1, 0);
-                    rasterizer->ScopeMarkerEnd();
+                    Record([this, cmd_address = reinterpret_cast<const void*>(header),
+                            args_addr = indirect_args_addr, offset, stride] {
+                        rasterizer->ScopeMarkerBegin(
+                            fmt::format("gfx:{}:DrawIndexIndirect", cmd_address));
+                        rasterizer->DrawIndirect(true, args_addr, offset, stride, 1, 0);
+                        rasterizer->ScopeMarkerEnd();
+                    });
                 }
                 break;
             }
@@ -503,16 +1038,19 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                     reinterpret_cast<const PM4CmdDrawIndexIndirectMulti*>(header);
                 const auto offset = draw_index_indirect->data_offset;
                 if (DebugState.DumpingCurrentReg()) {
-                    DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header), regs);
+                    DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header),
+                                            *decode_regs);
                 }
                 if (rasterizer) {
-                    const auto cmd_address = reinterpret_cast<const void*>(header);
-                    rasterizer->ScopeMarkerBegin(
-                        fmt::format("gfx:{}:DrawIndexIndirectMulti", cmd_address));
-                    rasterizer->DrawIndirect(true, indirect_args_addr, offset,
-                                             draw_index_indirect->stride,
-                                             draw_index_indirect->count, 0);
-                    rasterizer->ScopeMarkerEnd();
+                    Record([this, cmd_address = reinterpret_cast<const void*>(header),
+                            args_addr = indirect_args_addr, offset,
+                            stride = draw_index_indirect->stride,
+                            draw_count = draw_index_indirect->count] {
+                        rasterizer->ScopeMarkerBegin(
+                            fmt::format("gfx:{}:DrawIndexIndirectMulti", cmd_address));
+                        rasterizer->DrawIndirect(true, args_addr, offset, stride, draw_count, 0);
+                        rasterizer->ScopeMarkerEnd();
+                    });
                 }
                 break;
             }
@@ -521,25 +1059,29 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                     reinterpret_cast<const PM4CmdDrawIndexIndirectCountMulti*>(header);
                 const auto offset = draw_index_indirect->data_offset;
                 if (DebugState.DumpingCurrentReg()) {
-                    DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header), regs);
+                    DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header),
+                                            *decode_regs);
                 }
                 if (rasterizer) {
-                    const auto cmd_address = reinterpret_cast<const void*>(header);
-                    rasterizer->ScopeMarkerBegin(
-                        fmt::format("gfx:{}:DrawIndexIndirectCountMulti", cmd_address));
-                    rasterizer->DrawIndirect(true, indirect_args_addr, offset,
-                                             draw_index_indirect->stride,
-                                             draw_index_indirect->count,
-                                             draw_index_indirect->count_indirect_enable.Value()
-                                                 ? draw_index_indirect->count_addr
-                                                 : 0);
-                    rasterizer->ScopeMarkerEnd();
+                    Record([this, cmd_address = reinterpret_cast<const void*>(header),
+                            args_addr = indirect_args_addr, offset,
+                            stride = draw_index_indirect->stride,
+                            draw_count = draw_index_indirect->count,
+                            count_addr = draw_index_indirect->count_indirect_enable.Value()
+                                             ? draw_index_indirect->count_addr
+                                             : 0] {
+                        rasterizer->ScopeMarkerBegin(
+                            fmt::format("gfx:{}:DrawIndexIndirectCountMulti", cmd_address));
+                        rasterizer->DrawIndirect(true, args_addr, offset, stride, draw_count,
+                                                 count_addr);
+                        rasterizer->ScopeMarkerEnd();
+                    });
                 }
                 break;
             }
             case PM4ItOpcode::DispatchDirect: {
                 const auto* dispatch_direct = reinterpret_cast<const PM4CmdDispatchDirect*>(header);
-                auto& cs_program = GetCsRegs();
+                auto& cs_program = mapped_queues[curr_qid].cs_state;
                 cs_program.dim_x = dispatch_direct->dim_x;
                 cs_program.dim_y = dispatch_direct->dim_y;
                 cs_program.dim_z = dispatch_direct->dim_z;
@@ -549,17 +1091,23 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                                                    cs_program);
                 }
                 if (rasterizer && (cs_program.dispatch_initiator & 1)) {
-                    const auto cmd_address = reinterpret_cast<const void*>(header);
-                    rasterizer->ScopeMarkerBegin(fmt::format("gfx:{}:DispatchDirect", cmd_address));
-                    rasterizer->DispatchDirect();
-                    rasterizer->ScopeMarkerEnd();
+                    Record([this, cmd_address = reinterpret_cast<const void*>(header),
+                            cs_program, predicated = draw_predicated] {
+                        if (pipelined) {
+                            record_cs_state = cs_program;
+                        }
+                        rasterizer->ScopeMarkerBegin(
+                            fmt::format("gfx:{}:DispatchDirect", cmd_address));
+                        rasterizer->DispatchDirect(predicated);
+                        rasterizer->ScopeMarkerEnd();
+                    });
                 }
                 break;
             }
             case PM4ItOpcode::DispatchIndirect: {
                 const auto* dispatch_indirect =
                     reinterpret_cast<const PM4CmdDispatchIndirect*>(header);
-                auto& cs_program = GetCsRegs();
+                auto& cs_program = mapped_queues[curr_qid].cs_state;
                 const auto offset = dispatch_indirect->data_offset;
                 const auto size = sizeof(PM4CmdDispatchIndirect::GroupDimensions);
                 if (DebugState.DumpingCurrentReg()) {
@@ -567,28 +1115,37 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                                                    cs_program);
                 }
                 if (rasterizer && (cs_program.dispatch_initiator & 1)) {
-                    const auto cmd_address = reinterpret_cast<const void*>(header);
-                    rasterizer->ScopeMarkerBegin(
-                        fmt::format("gfx:{}:DispatchIndirect", cmd_address));
-                    rasterizer->DispatchIndirect(indirect_args_addr, offset, size);
-                    rasterizer->ScopeMarkerEnd();
+                    Record([this, cmd_address = reinterpret_cast<const void*>(header), cs_program,
+                            args_addr = indirect_args_addr, offset, size,
+                            predicated = draw_predicated] {
+                        if (pipelined) {
+                            record_cs_state = cs_program;
+                        }
+                        rasterizer->ScopeMarkerBegin(
+                            fmt::format("gfx:{}:DispatchIndirect", cmd_address));
+                        rasterizer->DispatchIndirect(args_addr, offset, size, predicated);
+                        rasterizer->ScopeMarkerEnd();
+                    });
                 }
                 break;
             }
             case PM4ItOpcode::NumInstances: {
                 const auto* num_instances = reinterpret_cast<const PM4CmdDrawNumInstances*>(header);
-                regs.num_instances.num_instances = num_instances->num_instances;
+                decode_regs->num_instances.num_instances = num_instances->num_instances;
+                RecordRegs(decode_regs->num_instances);
                 break;
             }
             case PM4ItOpcode::IndexBase: {
                 const auto* index_base = reinterpret_cast<const PM4CmdDrawIndexBase*>(header);
-                regs.index_base_address.base_addr_lo = index_base->addr_lo;
-                regs.index_base_address.base_addr_hi = index_base->addr_hi;
+                decode_regs->index_base_address.base_addr_lo = index_base->addr_lo;
+                decode_regs->index_base_address.base_addr_hi = index_base->addr_hi;
+                RecordRegs(decode_regs->index_base_address);
                 break;
             }
             case PM4ItOpcode::IndexBufferSize: {
                 const auto* index_size = reinterpret_cast<const PM4CmdDrawIndexBufferSize*>(header);
-                regs.num_indices = index_size->num_indices;
+                decode_regs->num_indices = index_size->num_indices;
+                RecordRegs(decode_regs->num_indices);
                 break;
             }
             case PM4ItOpcode::SetBase: {
@@ -605,15 +1162,23 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 if (event->event_type.Value() == EventType::SoVgtStreamoutFlush) {
                     // TODO: handle proper synchronization, for now signal that update is done
                     // immediately
-                    regs.cp_strmout_cntl.offset_update_done = 1;
+                    decode_regs->cp_strmout_cntl.offset_update_done = 1;
+                    RecordRegs(decode_regs->cp_strmout_cntl);
                 } else if (event->event_index.Value() == EventIndex::ZpassDone) {
-                    if (event->event_type.Value() == EventType::PixelPipeStatDump) {
+                    if (event->event_type.Value() == EventType::PixelPipeStatDump && rasterizer) {
+                        Record([this, address = event->Address<VAddr>(),
+                                num_pairs = num_counter_pairs] {
+                            rasterizer->ZpassDone(address, num_pairs);
+                        });
+                    } else if (event->event_type.Value() == EventType::PixelPipeStatDump) {
                         static constexpr u64 OcclusionCounterValidMask = 0x8000000000000000ULL;
                         static constexpr u64 OcclusionCounterStep = 0x2FFFFFFULL;
-                        u64* results = event->Address<u64*>();
-                        for (s32 i = 0; i < num_counter_pairs; ++i, results += 2) {
-                            *results = pixel_counter | OcclusionCounterValidMask;
-                        }
+                        Record([results = event->Address<u64*>(), num_pairs = num_counter_pairs,
+                                value = pixel_counter | OcclusionCounterValidMask]() mutable {
+                            for (s32 i = 0; i < num_pairs; ++i, results += 2) {
+                                *results = value;
+                            }
+                        });
                         pixel_counter += OcclusionCounterStep;
                     }
                 }
@@ -621,32 +1186,45 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
             }
             case PM4ItOpcode::EventWriteEos: {
                 const auto* event_eos = reinterpret_cast<const PM4CmdEventWriteEos*>(header);
-                event_eos->SignalFence([](void* address, u64 data, u32 num_bytes) {
-                    auto* memory = Core::Memory::Instance();
-                    if (!memory->TryWriteBacking(address, &data, num_bytes)) {
-                        memcpy(address, &data, num_bytes);
+                Record([this, event_eos = *event_eos] {
+                    event_eos.SignalFence([](void* address, u64 data, u32 num_bytes) {
+                        auto* memory = Core::Memory::Instance();
+                        if (!memory->TryWriteBacking(address, &data, num_bytes)) {
+                            memcpy(address, &data, num_bytes);
+                        }
+                    });
+                    if (event_eos.command == PM4CmdEventWriteEos::Command::GdsStore) {
+                        ASSERT(event_eos.size == 1);
+                        if (rasterizer) {
+                            // GDS is host visible, read it once the GPU is past the shaders that
+                            // write it instead of waiting for the whole queue here.
+                            ++num_pending_gds_stores;
+                            rasterizer->SignalOnGpuCompletion([this, event_eos] {
+                                const u32 value = rasterizer->ReadDataFromGds(event_eos.gds_index);
+                                *event_eos.Address() = value;
+                                --num_pending_gds_stores;
+                            });
+                        }
                     }
                 });
-                if (event_eos->command == PM4CmdEventWriteEos::Command::GdsStore) {
-                    ASSERT(event_eos->size == 1);
-                    if (rasterizer) {
-                        rasterizer->Finish();
-                        const u32 value = rasterizer->ReadDataFromGds(event_eos->gds_index);
-                        *event_eos->Address() = value;
-                    }
-                }
                 break;
             }
             case PM4ItOpcode::EventWriteEop: {
                 const auto* event_eop = reinterpret_cast<const PM4CmdEventWriteEop*>(header);
-                event_eop->SignalFence(
-                    [](void* address, u64 data, u32 num_bytes) {
-                        auto* memory = Core::Memory::Instance();
-                        if (!memory->TryWriteBacking(address, &data, num_bytes)) {
-                            memcpy(address, &data, num_bytes);
-                        }
-                    },
-                    [] { Platform::IrqC::Instance()->Signal(Platform::InterruptId::GfxEop); });
+                Record([this, event_eop = *event_eop] {
+                    SignalEndOfPipe([event_eop] {
+                        event_eop.SignalFence(
+                            [](void* address, u64 data, u32 num_bytes) {
+                                auto* memory = Core::Memory::Instance();
+                                if (!memory->TryWriteBacking(address, &data, num_bytes)) {
+                                    memcpy(address, &data, num_bytes);
+                                }
+                            },
+                            [] {
+                                Platform::IrqC::Instance()->Signal(Platform::InterruptId::GfxEop);
+                            });
+                    });
+                });
                 break;
             }
             case PM4ItOpcode::DmaData: {
@@ -654,35 +1232,7 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 if (dma_data->dst_addr_lo == 0x3022C || !rasterizer) {
                     break;
                 }
-                if (dma_data->src_sel == DmaDataSrc::Data && dma_data->dst_sel == DmaDataDst::Gds) {
-                    rasterizer->FillBuffer(dma_data->dst_addr_lo, dma_data->NumBytes(),
-                                           dma_data->data, true);
-                } else if ((dma_data->src_sel == DmaDataSrc::Memory ||
-                            dma_data->src_sel == DmaDataSrc::MemoryUsingL2) &&
-                           dma_data->dst_sel == DmaDataDst::Gds) {
-                    rasterizer->CopyBuffer(dma_data->dst_addr_lo, dma_data->SrcAddress<VAddr>(),
-                                           dma_data->NumBytes(), true, false);
-                } else if (dma_data->src_sel == DmaDataSrc::Data &&
-                           (dma_data->dst_sel == DmaDataDst::Memory ||
-                            dma_data->dst_sel == DmaDataDst::MemoryUsingL2)) {
-                    rasterizer->FillBuffer(dma_data->DstAddress<VAddr>(), dma_data->NumBytes(),
-                                           dma_data->data, false);
-                } else if (dma_data->src_sel == DmaDataSrc::Gds &&
-                           (dma_data->dst_sel == DmaDataDst::Memory ||
-                            dma_data->dst_sel == DmaDataDst::MemoryUsingL2)) {
-                    rasterizer->CopyBuffer(dma_data->DstAddress<VAddr>(), dma_data->src_addr_lo,
-                                           dma_data->NumBytes(), false, true);
-                } else if ((dma_data->src_sel == DmaDataSrc::Memory ||
-                            dma_data->src_sel == DmaDataSrc::MemoryUsingL2) &&
-                           (dma_data->dst_sel == DmaDataDst::Memory ||
-                            dma_data->dst_sel == DmaDataDst::MemoryUsingL2)) {
-                    rasterizer->CopyBuffer(dma_data->DstAddress<VAddr>(),
-                                           dma_data->SrcAddress<VAddr>(), dma_data->NumBytes(),
-                                           false, false);
-                } else {
-                    UNREACHABLE_MSG("WriteData src_sel = {}, dst_sel = {}",
-                                    u32(dma_data->src_sel.Value()), u32(dma_data->dst_sel.Value()));
-                }
+                Record([this, dma_data = *dma_data] { ProcessDmaData(dma_data); });
                 break;
             }
             case PM4ItOpcode::WriteData: {
@@ -690,10 +1240,15 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 ASSERT(write_data->dst_sel.Value() == 2 || write_data->dst_sel.Value() == 5);
                 const u32 data_size = (header->type3.count.Value() - 2) * 4;
                 u64* address = write_data->Address<u64*>();
-                if (!write_data->wr_one_addr.Value()) {
-                    std::memcpy(address, write_data->data, data_size);
-                } else {
+                if (write_data->wr_one_addr.Value()) {
                     UNREACHABLE();
+                } else if (pipelined) {
+                    Record([address, data = std::vector<u32>(write_data->data,
+                                                             write_data->data + data_size / 4)] {
+                        std::memcpy(address, data.data(), data.size() * sizeof(u32));
+                    });
+                } else {
+                    std::memcpy(address, write_data->data, data_size);
                 }
                 break;
             }
@@ -710,7 +1265,7 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
             case PM4ItOpcode::MemSemaphore: {
                 const auto* mem_semaphore = reinterpret_cast<const PM4CmdMemSemaphore*>(header);
                 if (mem_semaphore->IsSignaling()) {
-                    mem_semaphore->Signal();
+                    Record([mem_semaphore = *mem_semaphore] { mem_semaphore.Signal(); });
                 } else {
                     while (!mem_semaphore->Signaled()) {
                         YIELD_GFX();
@@ -741,20 +1296,30 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 // there are no other submits to yield to we can sleep the thread
                 // instead and allow other tasks to run.
                 const u64* wait_addr = wait_reg_mem->Address<u64*>();
-                if (vo_port->IsVoLabel(wait_addr) &&
-                    num_submits == mapped_queues[GfxQueueId].submits.size()) {
-                    vo_port->WaitVoLabel([&] { return wait_reg_mem->Test(regs.reg_array); });
+                if (vo_port && vo_port->IsVoLabel(wait_addr) &&
+                    num_submits == mapped_queues[GfxQueueId].submits.Size()) {
+                    // The flip that writes the label may still be waiting to be recorded
+                    FlushDrawList();
+                    vo_port->WaitVoLabel(
+                        [&] { return wait_reg_mem->Test(decode_regs->reg_array); });
                     break;
                 }
-                while (!wait_reg_mem->Test(regs.reg_array)) {
+                while (!wait_reg_mem->Test(decode_regs->reg_array)) {
                     YIELD_GFX();
                 }
                 break;
             }
             case PM4ItOpcode::IndirectBuffer: {
                 const auto* indirect_buffer = reinterpret_cast<const PM4CmdIndirectBuffer*>(header);
-                auto task = ProcessGraphics(
-                    {indirect_buffer->Address<const u32>(), indirect_buffer->ib_size}, {});
+                const std::span<const u32> ib{indirect_buffer->Address<const u32>(),
+                                              indirect_buffer->ib_size};
+                if (ib_cache && !DebugState.DumpingCurrentReg()) {
+                    if (const auto* decoded = LookupIndirectBuffer(ib)) {
+                        ReplayIndirectBuffer(*decoded);
+                        break;
+                    }
+                }
+                auto task = ProcessGraphics(ib, {});
                 RESUME_GFX(task);
 
                 while (!task.handle.done()) {
@@ -775,7 +1340,7 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
             }
             case PM4ItOpcode::PfpSyncMe: {
                 if (rasterizer) {
-                    rasterizer->CpSync();
+                    Record([this] { rasterizer->CpSync(); });
                 }
                 break;
             }
@@ -798,10 +1363,23 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 if (cond_exec->command.Value() != 0) {
                     LOG_WARNING(Render, "IT_COND_EXEC used a reserved command");
                 }
+                const u32 exec_count = cond_exec->exec_count.Value();
+                const auto rest = NextPacket(dcb, header->type3.NumWords() + 1);
+                const auto block = rest.first(std::min<size_t>(exec_count, rest.size()));
+                if (rasterizer && !cond_exec_end && IsPredicableBlock(block) &&
+                    rasterizer->GetInstance().IsConditionalRenderingSupported()) {
+                    // The draws of the block are skipped on the GPU instead
+                    cond_exec_end = block.data() + block.size();
+                    Record([this, address = reinterpret_cast<VAddr>(cond_exec->Address())] {
+                        rasterizer->BeginCondExec(address);
+                    });
+                    break;
+                }
+                // The condition may be written by work that is not recorded yet
+                WaitForDrawLists();
                 const auto skip = *cond_exec->Address() == false;
                 if (skip) {
-                    dcb = NextPacket(dcb,
-                                     header->type3.NumWords() + 1 + cond_exec->exec_count.Value());
+                    dcb = NextPacket(dcb, header->type3.NumWords() + 1 + exec_count);
                     continue;
                 }
                 break;
@@ -814,6 +1392,9 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
             break;
         }
     }
+    if (cond_exec_end) {
+        Record([this] { rasterizer->EndCondExec(); });
+    }
 
     if (ce_task.handle) {
         while (!ce_task.handle.done()) {
@@ -874,6 +1455,8 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
         }
 
         const PM4ItOpcode opcode = header->type3.opcode;
+        const PM4Profiler::Scope profile{pm4_profiler.get(), PM4QueueType::Compute, opcode};
+        Common::CountPerf(Common::PerfCounter::Pm4Packets);
         const auto* it_body = reinterpret_cast<const u32*>(header) + 1;
         switch (opcode) {
         case PM4ItOpcode::Nop: {
@@ -897,34 +1480,7 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
             if (dma_data->dst_addr_lo == 0x3022C || !rasterizer) {
                 break;
             }
-            if (dma_data->src_sel == DmaDataSrc::Data && dma_data->dst_sel == DmaDataDst::Gds) {
-                rasterizer->FillBuffer(dma_data->dst_addr_lo, dma_data->NumBytes(), dma_data->data,
-                                       true);
-            } else if ((dma_data->src_sel == DmaDataSrc::Memory ||
-                        dma_data->src_sel == DmaDataSrc::MemoryUsingL2) &&
-                       dma_data->dst_sel == DmaDataDst::Gds) {
-                rasterizer->CopyBuffer(dma_data->dst_addr_lo, dma_data->SrcAddress<VAddr>(),
-                                       dma_data->NumBytes(), true, false);
-            } else if (dma_data->src_sel == DmaDataSrc::Data &&
-                       (dma_data->dst_sel == DmaDataDst::Memory ||
-                        dma_data->dst_sel == DmaDataDst::MemoryUsingL2)) {
-                rasterizer->FillBuffer(dma_data->DstAddress<VAddr>(), dma_data->NumBytes(),
-                                       dma_data->data, false);
-            } else if (dma_data->src_sel == DmaDataSrc::Gds &&
-                       (dma_data->dst_sel == DmaDataDst::Memory ||
-                        dma_data->dst_sel == DmaDataDst::MemoryUsingL2)) {
-                rasterizer->CopyBuffer(dma_data->DstAddress<VAddr>(), dma_data->src_addr_lo,
-                                       dma_data->NumBytes(), false, true);
-            } else if ((dma_data->src_sel == DmaDataSrc::Memory ||
-                        dma_data->src_sel == DmaDataSrc::MemoryUsingL2) &&
-                       (dma_data->dst_sel == DmaDataDst::Memory ||
-                        dma_data->dst_sel == DmaDataDst::MemoryUsingL2)) {
-                rasterizer->CopyBuffer(dma_data->DstAddress<VAddr>(), dma_data->SrcAddress<VAddr>(),
-                                       dma_data->NumBytes(), false, false);
-            } else {
-                UNREACHABLE_MSG("WriteData src_sel = {}, dst_sel = {}",
-                                u32(dma_data->src_sel.Value()), u32(dma_data->dst_sel.Value()));
-            }
+            Record([this, dma_data = *dma_data] { ProcessDmaData(dma_data); });
             break;
         }
         case PM4ItOpcode::AcquireMem: {
@@ -951,8 +1507,8 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
                              (set_data->reg_offset - 0x200);
                 std::memcpy(addr, header + 2, set_size);
             } else {
-                std::memcpy(&regs.reg_array[Regs::ShRegWordOffset + set_data->reg_offset],
-                            header + 2, set_size);
+                WriteRegs(Regs::ShRegWordOffset + set_data->reg_offset,
+                          reinterpret_cast<const u32*>(header + 2), header->type3.NumWords() - 1);
             }
             break;
         }
@@ -964,7 +1520,7 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
         }
         case PM4ItOpcode::DispatchDirect: {
             const auto* dispatch_direct = reinterpret_cast<const PM4CmdDispatchDirect*>(header);
-            auto& cs_program = GetCsRegs();
+            auto& cs_program = mapped_queues[curr_qid].cs_state;
             cs_program.dim_x = dispatch_direct->dim_x;
             cs_program.dim_y = dispatch_direct->dim_y;
             cs_program.dim_z = dispatch_direct->dim_z;
@@ -974,18 +1530,23 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
                                                cs_program);
             }
             if (rasterizer && (cs_program.dispatch_initiator & 1)) {
-                const auto cmd_address = reinterpret_cast<const void*>(header);
-                rasterizer->ScopeMarkerBegin(
-                    fmt::format("asc[{}]:{}:DispatchDirect", vqid, cmd_address));
-                rasterizer->DispatchDirect();
-                rasterizer->ScopeMarkerEnd();
+                Record([this, cmd_address = reinterpret_cast<const void*>(header), cs_program,
+                        vqid] {
+                    if (pipelined) {
+                        record_cs_state = cs_program;
+                    }
+                    rasterizer->ScopeMarkerBegin(
+                        fmt::format("asc[{}]:{}:DispatchDirect", vqid, cmd_address));
+                    rasterizer->DispatchDirect();
+                    rasterizer->ScopeMarkerEnd();
+                });
             }
             break;
         }
         case PM4ItOpcode::DispatchIndirect: {
             const auto* dispatch_indirect =
                 reinterpret_cast<const PM4CmdDispatchIndirectMec*>(header);
-            auto& cs_program = GetCsRegs();
+            auto& cs_program = mapped_queues[curr_qid].cs_state;
             const auto ib_address = dispatch_indirect->Address<VAddr>();
             const auto size = sizeof(PM4CmdDispatchIndirect::GroupDimensions);
             if (DebugState.DumpingCurrentReg()) {
@@ -993,11 +1554,16 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
                                                cs_program);
             }
             if (rasterizer && (cs_program.dispatch_initiator & 1)) {
-                const auto cmd_address = reinterpret_cast<const void*>(header);
-                rasterizer->ScopeMarkerBegin(
-                    fmt::format("asc[{}]:{}:DispatchIndirect", vqid, cmd_address));
-                rasterizer->DispatchIndirect(ib_address, 0, size);
-                rasterizer->ScopeMarkerEnd();
+                Record([this, cmd_address = reinterpret_cast<const void*>(header), cs_program,
+                        vqid, ib_address, size] {
+                    if (pipelined) {
+                        record_cs_state = cs_program;
+                    }
+                    rasterizer->ScopeMarkerBegin(
+                        fmt::format("asc[{}]:{}:DispatchIndirect", vqid, cmd_address));
+                    rasterizer->DispatchIndirect(ib_address, 0, size);
+                    rasterizer->ScopeMarkerEnd();
+                });
             }
             break;
         }
@@ -1005,17 +1571,23 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
             const auto* write_data = reinterpret_cast<const PM4CmdWriteData*>(header);
             ASSERT(write_data->dst_sel.Value() == 2 || write_data->dst_sel.Value() == 5);
             const u32 data_size = (header->type3.count.Value() - 2) * 4;
-            if (!write_data->wr_one_addr.Value()) {
-                std::memcpy(write_data->Address<void*>(), write_data->data, data_size);
-            } else {
+            if (write_data->wr_one_addr.Value()) {
                 UNREACHABLE();
+            } else if (pipelined) {
+                Record([address = write_data->Address<void*>(),
+                        data = std::vector<u32>(write_data->data,
+                                                write_data->data + data_size / 4)] {
+                    std::memcpy(address, data.data(), data.size() * sizeof(u32));
+                });
+            } else {
+                std::memcpy(write_data->Address<void*>(), write_data->data, data_size);
             }
             break;
         }
         case PM4ItOpcode::MemSemaphore: {
             const auto* mem_semaphore = reinterpret_cast<const PM4CmdMemSemaphore*>(header);
             if (mem_semaphore->IsSignaling()) {
-                mem_semaphore->Signal();
+                Record([mem_semaphore = *mem_semaphore] { mem_semaphore.Signal(); });
             } else {
                 while (!mem_semaphore->Signaled()) {
                     YIELD_ASC(vqid);
@@ -1027,15 +1599,20 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
         case PM4ItOpcode::WaitRegMem: {
             const auto* wait_reg_mem = reinterpret_cast<const PM4CmdWaitRegMem*>(header);
             ASSERT(wait_reg_mem->engine.Value() == PM4CmdWaitRegMem::Engine::Me);
-            while (!wait_reg_mem->Test(regs.reg_array)) {
+            while (!wait_reg_mem->Test(decode_regs->reg_array)) {
                 YIELD_ASC(vqid);
             }
             break;
         }
         case PM4ItOpcode::ReleaseMem: {
             const auto* release_mem = reinterpret_cast<const PM4CmdReleaseMem*>(header);
-            release_mem->SignalFence([pipe_id = queue.pipe_id] {
-                Platform::IrqC::Instance()->Signal(static_cast<Platform::InterruptId>(pipe_id));
+            Record([this, release_mem = *release_mem, pipe_id = queue.pipe_id] {
+                SignalEndOfPipe([release_mem, pipe_id] {
+                    release_mem.SignalFence([pipe_id] {
+                        Platform::IrqC::Instance()->Signal(
+                            static_cast<Platform::InterruptId>(pipe_id));
+                    });
+                });
             });
             break;
         }
@@ -1100,14 +1677,10 @@ void Liverpool::SubmitGfx(std::span<const u32> dcb, std::span<const u32> ccb) {
     }
 
     auto task = ProcessGraphics(dcb, ccb);
-    {
-        std::scoped_lock lock{queue.m_access};
-        queue.submits.emplace(task.handle);
-    }
-
-    std::scoped_lock lk{submit_mutex};
+    // Counted before it is queued, so the GPU is never seen idle with the submission pending
     ++num_submits;
-    submit_cv.notify_one();
+    queue.submits.EmplaceWait(task.handle);
+    WakeProcessor();
 }
 
 void Liverpool::SubmitAsc(u32 gnm_vqid, std::span<const u32> acb) {
@@ -1116,15 +1689,13 @@ void Liverpool::SubmitAsc(u32 gnm_vqid, std::span<const u32> acb) {
 
     const auto vqid = gnm_vqid - 1;
     const auto& task = ProcessCompute(acb, vqid);
-    {
-        std::scoped_lock lock{queue.m_access};
-        queue.submits.emplace(task.handle);
+    u32 num_queues = num_mapped_queues.load(std::memory_order_relaxed);
+    while (num_queues <= gnm_vqid &&
+           !num_mapped_queues.compare_exchange_weak(num_queues, gnm_vqid + 1)) {
     }
-
-    std::scoped_lock lk{submit_mutex};
-    num_mapped_queues = std::max(num_mapped_queues, gnm_vqid + 1);
     ++num_submits;
-    submit_cv.notify_one();
+    queue.submits.EmplaceWait(task.handle);
+    WakeProcessor();
 }
 
 } // namespace AmdGpu
@@ -6,19 +6,26 @@
 #include <condition_variable>
 #include <coroutine>
 #include <exception>
+#include <memory>
 #include <mutex>
 #include <semaphore>
 #include <span>
 #include <thread>
+#include <utility>
 #include <vector>
 #include <queue>
 
 #include "common/assert.h"
+#include "common/bounded_threadsafe_queue.h"
 #include "common/slot_vector.h"
 #include "common/types.h"
 #include "common/unique_function.h"
 #include "video_core/amdgpu/cb_db_extent.h"
+#include "video_core/amdgpu/draw_list.h"
+#include "video_core/amdgpu/ib_cache.h"
+#include "video_core/amdgpu/pm4_stats.h"
 #include "video_core/amdgpu/regs.h"
+#include "video_core/amdgpu/task_frame_pool.h"
 
 namespace Vulkan {
 class Rasterizer;
@@ -30,6 +37,8 @@ struct VideoOutPort;
 
 namespace AmdGpu {
 
+struct PM4DmaData;
+
 struct Liverpool {
     static constexpr u32 GfxQueueId = 0u;
     static constexpr u32 NumGfxRings = 1u;     // actually 2, but HP is reserved by system software
@@ -59,6 +68,8 @@ struct Liverpool {
         CbColor7Cmask = 0xA388,
     };
 
+    /// Registers as seen by the rasterizer. When command processing is pipelined, these trail
+    /// behind the registers of the PM4 parser until the recording thread catches up.
     Regs regs{};
     std::array<CbDbExtent, NUM_COLOR_BUFFERS> last_cb_extent{};
     CbDbExtent last_db_extent{};
@@ -71,20 +82,19 @@ public:
     void SubmitAsc(u32 gnm_vqid, std::span<const u32> acb);
 
     void SubmitDone() noexcept {
-        std::scoped_lock lk{submit_mutex};
         mapped_queues[GfxQueueId].ccb_buffer_offset = 0;
         mapped_queues[GfxQueueId].dcb_buffer_offset = 0;
         submit_done = true;
-        submit_cv.notify_one();
+        WakeProcessor();
     }
 
     void WaitGpuIdle() noexcept {
         std::unique_lock lk{submit_mutex};
-        submit_cv.wait(lk, [this] { return num_submits == 0; });
+        submit_cv.wait(lk, [this] { return num_submits == 0 && num_pending_lists == 0; });
     }
 
     bool IsGpuIdle() const {
-        return num_submits == 0;
+        return num_submits == 0 && num_pending_lists == 0;
     }
 
     void SetVoPort(Libraries::VideoOut::VideoOutPort* port) {
@@ -102,21 +112,15 @@ public:
         }
         if constexpr (wait_done) {
             std::binary_semaphore sem{0};
-            {
-                std::scoped_lock lk{submit_mutex};
-                command_queue.emplace([&sem, &func] {
-                    func();
-                    sem.release();
-                });
-                ++num_commands;
-                submit_cv.notify_one();
-            }
+            command_queue.EmplaceWait([&sem, &func] {
+                func();
+                sem.release();
+            });
+            WakeCommandConsumer();
             sem.acquire();
         } else {
-            std::scoped_lock lk{submit_mutex};
-            command_queue.emplace(std::move(func));
-            ++num_commands;
-            submit_cv.notify_one();
+            command_queue.EmplaceWait(std::move(func));
+            WakeCommandConsumer();
         }
     }
 
@@ -129,7 +133,17 @@ public:
     }
 
     inline ComputeProgram& GetCsRegs() {
-        return mapped_queues[curr_qid].cs_state;
+        return pipelined ? record_cs_state : mapped_queues[curr_qid].cs_state;
+    }
+
+    /// Returns true if registers the graphics pipeline depends on were written with new values
+    /// since the last call. Must be called from the thread recording the draws.
+    bool ConsumeGraphicsStateDirty() noexcept {
+        return std::exchange(graphics_state_dirty, false);
+    }
+
+    [[nodiscard]] bool IsGraphicsStateDirty() const noexcept {
+        return graphics_state_dirty;
     }
 
     struct AscQueueInfo {
@@ -146,6 +160,22 @@ public:
 private:
     struct Task {
         struct promise_type {
+            // Frames come from the pool of the queue the task runs on
+            static void* operator new(size_t size, Liverpool& liverpool, std::span<const u32>,
+                                      std::span<const u32>) {
+                return liverpool.mapped_queues[GfxQueueId].frame_pool.Allocate(size);
+            }
+            static void* operator new(size_t size, Liverpool& liverpool, std::span<const u32>) {
+                return liverpool.mapped_queues[GfxQueueId].frame_pool.Allocate(size);
+            }
+            static void* operator new(size_t size, Liverpool& liverpool, std::span<const u32>,
+                                      u32 vqid) {
+                return liverpool.mapped_queues[vqid + 1].frame_pool.Allocate(size);
+            }
+            static void operator delete(void* frame, size_t size) noexcept {
+                TaskFramePool::Free(frame, size);
+            }
+
             auto get_return_object() {
                 Task task{};
                 task.handle = std::coroutine_handle<promise_type>::from_promise(*this);
@@ -185,6 +215,100 @@ private:
 
     void ProcessCommands();
     void Process(std::stop_token stoken);
+    void ProcessDrawLists(std::stop_token stoken);
+    void ProcessDmaData(const PM4DmaData& dma_data);
+
+    /// Runs func once everything decoded before it was recorded. That is right away, unless
+    /// command processing is pipelined, in which case the recording thread runs it.
+    template <typename Func>
+    void Record(Func&& func) {
+        if (!pipelined) {
+            func();
+            return;
+        }
+        draw_list->Push(std::forward<Func>(func));
+        if (draw_list->NumCommands() >= MaxDrawListCommands) {
+            FlushDrawList();
+        }
+    }
+
+    /// Writes registers decoded from a packet. Rewrites of the current values are dropped.
+    void WriteRegs(u32 offset, const u32* data, u32 count) {
+        auto* dst = &decode_regs->reg_array[offset];
+        if (std::memcmp(dst, data, count * sizeof(u32)) == 0) {
+            return;
+        }
+        std::memcpy(dst, data, count * sizeof(u32));
+        if (pipelined) {
+            draw_list->WriteRegs(offset, data, count);
+        } else {
+            graphics_state_dirty |= Regs::AffectsGraphicsPipeline(offset);
+        }
+    }
+
+    /// Forwards a register field the parser has written directly to the recording thread.
+    template <typename T>
+    void RecordRegs(const T& field) {
+        static_assert(sizeof(T) % sizeof(u32) == 0);
+        if (pipelined) {
+            const auto* data = reinterpret_cast<const u32*>(&field);
+            const auto offset = static_cast<u32>(data - decode_regs->reg_array.data());
+            draw_list->WriteRegs(offset, data, sizeof(T) / sizeof(u32));
+        }
+    }
+
+    void ClearState() {
+        decode_regs->SetDefaults();
+        Record([this] {
+            if (pipelined) {
+                regs.SetDefaults();
+            }
+            graphics_state_dirty = true;
+        });
+    }
+
+    void SetCbExtent(u32 col_buf_id, u32 raw) {
+        Record([this, col_buf_id, raw] { last_cb_extent[col_buf_id].raw = raw; });
+    }
+
+    void SetDbExtent(u32 raw) {
+        Record([this, raw] { last_db_extent.raw = raw; });
+    }
+
+    /// Forwards whether the packets that follow are predicated to the rasterizer.
+    void SetDrawPredicated(bool predicated);
+
+    /// Returns the cached decoding of an indirect buffer, or nullptr if it has to be processed.
+    const DecodedIndirectBuffer* LookupIndirectBuffer(std::span<const u32> ib);
+    DecodedIndirectBuffer DecodeIndirectBuffer(std::span<const u32> ib);
+    void ReplayIndirectBuffer(const DecodedIndirectBuffer& ib);
+
+    /// Writes an end of pipe label and raises its interrupt, which may have to wait for the GPU.
+    void SignalEndOfPipe(Common::UniqueFunction<void>&& signal);
+
+    /// Hands the decoded work over to the recording thread.
+    void FlushDrawList();
+    /// Blocks until the recording thread has caught up with the parser.
+    void WaitForDrawLists();
+
+    void WakeProcessor() noexcept {
+        processor_wakeups.fetch_add(1, std::memory_order_release);
+        processor_wakeups.notify_one();
+    }
+
+    /// Wakes the thread running the commands sent from other threads.
+    void WakeCommandConsumer() {
+        if (pipelined) {
+            std::scoped_lock lk{submit_mutex};
+            submit_cv.notify_all();
+        } else {
+            WakeProcessor();
+        }
+    }
+
+    // Submitting threads block once this many submissions to a queue are pending
+    static constexpr size_t MaxQueuedSubmits = 256;
+    static constexpr size_t MaxQueuedCommands = 1024;
 
     struct GpuQueue {
         std::mutex m_access{};
@@ -192,15 +316,17 @@ private:
         std::atomic<u32> ccb_buffer_offset;
         std::vector<u32> dcb_buffer;
         std::vector<u32> ccb_buffer;
-        std::queue<Task::Handle> submits{};
+        Common::LockFreeMPSCQueue<Task::Handle, MaxQueuedSubmits> submits{};
         ComputeProgram cs_state{};
+        TaskFramePool frame_pool{};
     };
     std::array<GpuQueue, NumTotalQueues> mapped_queues{};
-    u32 num_mapped_queues{1u}; // GFX is always available
+    std::atomic<u32> num_mapped_queues{1u}; // GFX is always available
 
     VAddr indirect_args_addr{};
     u32 num_counter_pairs{};
     u64 pixel_counter{};
+    bool draw_predicated{}; ///< Of the last packet the parser processed
 
     struct ConstantEngine {
         void Reset() {
@@ -220,15 +346,35 @@ private:
         static std::array<u8, 48_KB> constants_heap;
     } cblock{};
 
+    bool graphics_state_dirty{true}; ///< Owned by the thread recording the draws
+
+    // Only used when PM4 parsing and command recording run on separate threads
+    static constexpr size_t MaxDrawListCommands = 256;
+    static constexpr u32 MaxPendingDrawLists = 16;
+    bool pipelined{};
+    Regs* decode_regs{&regs}; ///< Registers the PM4 parser reads and writes
+    std::unique_ptr<Regs> pipelined_decode_regs{};
+    ComputeProgram record_cs_state{};
+    std::unique_ptr<DrawList> draw_list{};
+    std::queue<std::unique_ptr<DrawList>> pending_lists{};
+    std::vector<std::unique_ptr<DrawList>> free_lists{};
+    std::atomic<u32> num_pending_lists{};
+    std::atomic<u32> num_pending_gds_stores{}; ///< GDS values still to be written to memory
+    std::jthread record_thread{};
+
+    std::unique_ptr<IndirectBufferCache> ib_cache{};
+    std::unique_ptr<PM4Profiler> pm4_profiler{};
+
     Vulkan::Rasterizer* rasterizer{};
     Libraries::VideoOut::VideoOutPort* vo_port{};
     std::jthread process_thread{};
     std::atomic<u32> num_submits{};
-    std::atomic<u32> num_commands{};
     std::atomic<bool> submit_done{};
+    /// Bumped whenever the processor thread has new work, which waits on it while idle.
+    std::atomic<u32> processor_wakeups{};
     std::mutex submit_mutex;
     std::condition_variable_any submit_cv;
-    std::queue<Common::UniqueFunction<void>> command_queue{};
+    Common::LockFreeMPSCQueue<Common::UniqueFunction<void>, MaxQueuedCommands> command_queue{};
     std::thread::id gpu_id;
     s32 curr_qid{-1};
 };
@@ -434,6 +434,30 @@ struct PM4CmdEventWrite {
     }
 };
 
+enum class PredicationOp : u32 {
+    Clear = 0,     ///< Disables predication
+    Zpass = 1,     ///< Tests the occlusion query results at the address
+    PrimCount = 2, ///< Tests the streamout overflow results at the address
+    Bool64 = 3,    ///< Tests a 64-bit value at the address
+};
+
+struct PM4CmdSetPredication {
+    PM4Type3Header header;
+    u32 start_address_lo; ///< Low bits of the results, 16 byte aligned
+    union {
+        u32 raw;
+        BitField<0, 8, u32> start_address_hi;
+        BitField<8, 1, u32> draw_if_visible; ///< Draws when the samples passed, else when none
+        BitField<12, 1, u32> no_wait;        ///< Draws when the results aren't ready yet
+        BitField<16, 3, PredicationOp> op;
+        BitField<31, 1, u32> continue_bit; ///< Combines the results with the previous ones
+    };
+
+    VAddr Address() const {
+        return (u64(start_address_hi.Value()) << 32u) | (start_address_lo & ~0xFu);
+    }
+};
+
 struct PM4CmdEventWriteEop {
     PM4Type3Header header;
     union {
@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <fmt/format.h>
+
+#include "common/native_clock.h"
+#include "common/path_util.h"
+#include "core/debug_state.h"
+#include "core/libraries/kernel/time.h"
+#include "video_core/amdgpu/pm4_stats.h"
+
+namespace Core::Devtools::Gcn {
+const char* GetOpCodeName(u32 op);
+}
+
+namespace AmdGpu {
+
+PM4Profiler::PM4Profiler() {
+    current.tsc_frequency = Libraries::Kernel::Dev::GetClock()->GetTscFrequency();
+
+    using namespace Common::FS;
+    csv_file.Open(GetUserPath(PathType::LogDir) / "pm4_stats.csv", FileAccessMode::Write,
+                  FileType::TextFile);
+    csv_file.WriteString(std::string_view{"frame,queue,opcode,name,count,time_us\n"});
+}
+
+PM4Profiler::~PM4Profiler() = default;
+
+void PM4Profiler::EndFrame() {
+    {
+        std::scoped_lock lock{DebugState.pm4_stats_mutex};
+        DebugState.pm4_frame_stats = current;
+    }
+
+    // One row per opcode seen in the frame, so regressions can be diffed between builds
+    std::string rows;
+    for (size_t queue = 0; queue < current.queues.size(); ++queue) {
+        const auto* queue_name = GetQueueTypeName(static_cast<PM4QueueType>(queue));
+        for (u32 op = 0; op < PM4FrameStats::NumOpcodes; ++op) {
+            const auto& stats = current.queues[queue][op];
+            if (stats.count == 0) {
+                continue;
+            }
+            rows += fmt::format("{},{},{:#04x},{},{},{:.3f}\n", current.frame, queue_name, op,
+                                Core::Devtools::Gcn::GetOpCodeName(op), stats.count,
+                                current.ToUs(stats.cycles));
+        }
+    }
+    csv_file.WriteString(rows);
+
+    ++current.frame;
+    current.queues = {};
+}
+
+} // namespace AmdGpu
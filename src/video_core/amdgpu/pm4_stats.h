@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+
+#include "common/io_file.h"
+#include "common/rdtsc.h"
+#include "common/types.h"
+#include "video_core/amdgpu/pm4_opcodes.h"
+
+namespace AmdGpu {
+
+enum class PM4QueueType : u32 {
+    Graphics,
+    Compute,
+    Count,
+};
+
+constexpr const char* GetQueueTypeName(PM4QueueType type) {
+    return type == PM4QueueType::Graphics ? "gfx" : "asc";
+}
+
+struct PM4OpcodeStats {
+    u64 count;
+    u64 cycles;
+};
+
+/// Packets processed during one Gnm frame, indexed by queue type and opcode.
+struct PM4FrameStats {
+    static constexpr size_t NumOpcodes = 256;
+    using Table = std::array<PM4OpcodeStats, NumOpcodes>;
+
+    u64 frame{};
+    u64 tsc_frequency{};
+    std::array<Table, static_cast<size_t>(PM4QueueType::Count)> queues{};
+
+    [[nodiscard]] double ToUs(u64 cycles) const noexcept {
+        return tsc_frequency ? cycles * 1000000.0 / tsc_frequency : 0.0;
+    }
+};
+
+/// Counts the PM4 packets handled by the parser and the TSC cycles spent on each of them. Time
+/// is inclusive: packets that run nested command buffers also account for the nested packets,
+/// and packets that wait also account for the time other queues were processed meanwhile.
+class PM4Profiler {
+public:
+    class Scope {
+    public:
+        explicit Scope(PM4Profiler* profiler_, PM4QueueType queue_, PM4ItOpcode opcode_)
+            : profiler{profiler_}, queue{queue_}, opcode{opcode_},
+              start{profiler ? Common::FencedRDTSC() : 0} {}
+
+        ~Scope() {
+            if (profiler) {
+                profiler->Add(queue, opcode, Common::FencedRDTSC() - start);
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        PM4Profiler* profiler;
+        PM4QueueType queue;
+        PM4ItOpcode opcode;
+        u64 start;
+    };
+
+    PM4Profiler();
+    ~PM4Profiler();
+
+    void Add(PM4QueueType queue, PM4ItOpcode opcode, u64 cycles) noexcept {
+        auto& stats = current.queues[static_cast<size_t>(queue)][static_cast<u32>(opcode) & 0xFF];
+        ++stats.count;
+        stats.cycles += cycles;
+    }
+
+    /// Publishes the counters of the frame to the debug state and appends them to the CSV log.
+    void EndFrame();
+
+private:
+    PM4FrameStats current{};
+    Common::FS::IOFile csv_file;
+};
+
+} // namespace AmdGpu
@@ -123,6 +123,17 @@ static_assert(GFX6_3D_REG_INDEX(primitive_type) == 0xC242);
 static_assert(GFX6_3D_REG_INDEX(num_instances) == 0xC24D);
 static_assert(GFX6_3D_REG_INDEX(vgt_tf_memory_base) == 0xc250);
 
+bool Regs::AffectsGraphicsPipeline(u32 offset) {
+    const auto is_field = [offset](u32 begin, size_t size) {
+        return offset >= begin && offset < begin + size / sizeof(u32);
+    };
+#define IS_FIELD(field) is_field(GFX6_3D_REG_INDEX(field), sizeof(Regs::field))
+    return !(IS_FIELD(cs_program) || IS_FIELD(index_base_address) || IS_FIELD(draw_initiator) ||
+             IS_FIELD(max_index_size) || IS_FIELD(index_buffer_type) || IS_FIELD(num_indices) ||
+             IS_FIELD(num_instances));
+#undef IS_FIELD
+}
+
 #undef GFX6_3D_REG_INDEX
 
 } // namespace AmdGpu
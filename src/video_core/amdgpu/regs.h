@@ -180,6 +180,10 @@ union Regs {
     }
 
     void SetDefaults();
+
+    /// Returns false for registers holding the parameters of a draw, like index counts and
+    /// addresses, and for compute state, which the graphics pipeline doesn't depend on.
+    static bool AffectsGraphicsPipeline(u32 offset);
 };
 
 #undef DO_CONCAT2
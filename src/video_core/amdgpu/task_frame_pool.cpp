@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <mutex>
+#include <new>
+
+#include "video_core/amdgpu/task_frame_pool.h"
+
+namespace AmdGpu {
+
+TaskFramePool::~TaskFramePool() {
+    for (FreeBlock* block : free_lists) {
+        while (block) {
+            FreeBlock* next = block->next;
+            ::operator delete(block);
+            block = next;
+        }
+    }
+}
+
+void* TaskFramePool::Allocate(size_t size) {
+    const size_t size_class = (size + sizeof(Header) - 1) / Granularity;
+    if (size_class < NumSizeClasses) {
+        std::scoped_lock lk{lock};
+        if (FreeBlock* block = free_lists[size_class]) {
+            free_lists[size_class] = block->next;
+            num_recycled.fetch_add(1, std::memory_order_relaxed);
+            auto* header = reinterpret_cast<Header*>(block);
+            header->pool = this;
+            return header + 1;
+        }
+    }
+    num_allocated.fetch_add(1, std::memory_order_relaxed);
+    auto* header = static_cast<Header*>(
+        ::operator new(size_class < NumSizeClasses ? (size_class + 1) * Granularity
+                                                   : size + sizeof(Header)));
+    header->pool = size_class < NumSizeClasses ? this : nullptr;
+    return header + 1;
+}
+
+void TaskFramePool::Free(void* frame, size_t size) noexcept {
+    auto* header = static_cast<Header*>(frame) - 1;
+    TaskFramePool* pool = header->pool;
+    if (!pool) {
+        ::operator delete(header);
+        return;
+    }
+    const size_t size_class = (size + sizeof(Header) - 1) / Granularity;
+    auto* block = reinterpret_cast<FreeBlock*>(header);
+    std::scoped_lock lk{pool->lock};
+    block->next = pool->free_lists[size_class];
+    pool->free_lists[size_class] = block;
+}
+
+} // namespace AmdGpu
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include "common/spin_lock.h"
+#include "common/types.h"
+
+namespace AmdGpu {
+
+/// Recycles the coroutine frames of the command processor tasks of a queue, which are created
+/// for every submitted command buffer and every indirect buffer it calls. Frames may be freed
+/// on another thread than the one that allocated them.
+class TaskFramePool {
+public:
+    struct Stats {
+        u32 allocated; ///< Frames that had to be allocated from the heap
+        u32 recycled;  ///< Frames served from the pool
+    };
+
+    TaskFramePool() = default;
+    ~TaskFramePool();
+
+    TaskFramePool(const TaskFramePool&) = delete;
+    TaskFramePool& operator=(const TaskFramePool&) = delete;
+
+    void* Allocate(size_t size);
+
+    /// Returns a frame to the pool it was allocated from.
+    static void Free(void* frame, size_t size) noexcept;
+
+    /// Returns the counters accumulated since the previous call and resets them.
+    Stats ConsumeStats() noexcept {
+        return {num_allocated.exchange(0, std::memory_order_relaxed),
+                num_recycled.exchange(0, std::memory_order_relaxed)};
+    }
+
+private:
+    static constexpr size_t Granularity = 64;
+    static constexpr size_t NumSizeClasses = 128; ///< Larger frames bypass the pool
+
+    struct alignas(std::max_align_t) Header {
+        TaskFramePool* pool;
+    };
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    Common::SpinLock lock;
+    std::array<FreeBlock*, NumSizeClasses> free_lists{};
+    std::atomic<u32> num_allocated{};
+    std::atomic<u32> num_recycled{};
+};
+
+} // namespace AmdGpu
@@ -1,13 +1,18 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <bit>
+
 #include "common/alignment.h"
 #include "common/assert.h"
+#include "common/logging/log.h"
 #include "video_core/buffer_cache/buffer.h"
 #include "video_core/renderer_vulkan/liverpool_to_vk.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_platform.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/stall_tracker.h"
 
 #include <vk_mem_alloc.h>
 
@@ -23,6 +28,8 @@ std::string_view BufferTypeName(MemoryUsage type) {
         return "Stream";
     case MemoryUsage::DeviceLocal:
         return "DeviceLocal";
+    case MemoryUsage::HostImport:
+        return "HostImport";
     default:
         return "Invalid";
     }
@@ -42,6 +49,7 @@ std::string_view BufferTypeName(MemoryUsage type) {
     case MemoryUsage::Download:
         return VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
     case MemoryUsage::DeviceLocal:
+    case MemoryUsage::HostImport:
         return {};
     }
     return {};
@@ -54,11 +62,23 @@ std::string_view BufferTypeName(MemoryUsage type) {
         return VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
     case MemoryUsage::Upload:
     case MemoryUsage::Download:
+    case MemoryUsage::HostImport:
         return VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
     }
     return VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
 }
 
+[[nodiscard]] std::optional<Vulkan::MemoryPool> MemoryUsagePool(MemoryUsage usage) {
+    switch (usage) {
+    case MemoryUsage::Upload:
+        return Vulkan::MemoryPool::Upload;
+    case MemoryUsage::Download:
+        return Vulkan::MemoryPool::Download;
+    default:
+        return std::nullopt;
+    }
+}
+
 UniqueBuffer::UniqueBuffer(vk::Device device_, VmaAllocator allocator_)
     : device{device_}, allocator{allocator_} {}
 
@@ -66,14 +86,17 @@ UniqueBuffer::~UniqueBuffer() {
     if (buffer) {
         vmaDestroyBuffer(allocator, buffer, allocation);
     }
+    if (imported_memory) {
+        device.freeMemory(imported_memory);
+    }
 }
 
 void UniqueBuffer::Create(const vk::BufferCreateInfo& buffer_ci, MemoryUsage usage,
-                          VmaAllocationInfo* out_alloc_info) {
+                          VmaAllocationInfo* out_alloc_info, VmaPool pool) {
     const bool with_bda = bool(buffer_ci.usage & vk::BufferUsageFlagBits::eShaderDeviceAddress);
     const VmaAllocationCreateFlags bda_flag =
         with_bda ? VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT : 0;
-    const VmaAllocationCreateInfo alloc_ci = {
+    VmaAllocationCreateInfo alloc_ci = {
         .flags = VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT | bda_flag | MemoryUsageVmaFlags(usage),
         .usage = MemoryUsageVma(usage),
         .requiredFlags = 0,
@@ -81,11 +104,20 @@ void UniqueBuffer::Create(const vk::BufferCreateInfo& buffer_ci, MemoryUsage usa
         .pool = VK_NULL_HANDLE,
         .pUserData = nullptr,
     };
+    if (!with_bda) {
+        alloc_ci.pool = pool;
+    }
 
     const VkBufferCreateInfo buffer_ci_unsafe = static_cast<VkBufferCreateInfo>(buffer_ci);
     VkBuffer unsafe_buffer{};
     VkResult result = vmaCreateBuffer(allocator, &buffer_ci_unsafe, &alloc_ci, &unsafe_buffer,
                                       &allocation, out_alloc_info);
+    if (result != VK_SUCCESS && alloc_ci.pool) {
+        // The pool is full or its memory type doesn't suit the buffer
+        alloc_ci.pool = VK_NULL_HANDLE;
+        result = vmaCreateBuffer(allocator, &buffer_ci_unsafe, &alloc_ci, &unsafe_buffer,
+                                 &allocation, out_alloc_info);
+    }
     ASSERT_MSG(result == VK_SUCCESS, "Failed allocating buffer with error {}",
                vk::to_string(vk::Result{result}));
     buffer = vk::Buffer{unsafe_buffer};
@@ -100,17 +132,80 @@ void UniqueBuffer::Create(const vk::BufferCreateInfo& buffer_ci, MemoryUsage usa
     }
 }
 
+void UniqueBuffer::Import(const vk::BufferCreateInfo& buffer_ci, void* host_pointer) {
+    static constexpr auto HandleType = vk::ExternalMemoryHandleTypeFlagBits::eHostAllocationEXT;
+    const vk::ExternalMemoryBufferCreateInfo external_ci = {
+        .handleTypes = HandleType,
+    };
+    vk::BufferCreateInfo import_ci = buffer_ci;
+    import_ci.pNext = &external_ci;
+    auto [buffer_result, new_buffer] = device.createBuffer(import_ci);
+    if (buffer_result != vk::Result::eSuccess) {
+        return;
+    }
+    const auto [props_result, host_props] =
+        device.getMemoryHostPointerPropertiesEXT(HandleType, host_pointer);
+    const auto requirements = device.getBufferMemoryRequirements(new_buffer);
+    const u32 type_bits = host_props.memoryTypeBits & requirements.memoryTypeBits;
+    if (props_result != vk::Result::eSuccess || type_bits == 0) {
+        device.destroyBuffer(new_buffer);
+        return;
+    }
+    const bool with_bda = bool(buffer_ci.usage & vk::BufferUsageFlagBits::eShaderDeviceAddress);
+    const vk::MemoryAllocateFlagsInfo allocate_flags = {
+        .flags = vk::MemoryAllocateFlagBits::eDeviceAddress,
+    };
+    const vk::ImportMemoryHostPointerInfoEXT import_info = {
+        .pNext = with_bda ? &allocate_flags : nullptr,
+        .handleType = HandleType,
+        .pHostPointer = host_pointer,
+    };
+    auto [memory_result, memory] = device.allocateMemory(vk::MemoryAllocateInfo{
+        .pNext = &import_info,
+        .allocationSize = buffer_ci.size,
+        .memoryTypeIndex = static_cast<u32>(std::countr_zero(type_bits)),
+    });
+    if (memory_result != vk::Result::eSuccess) {
+        device.destroyBuffer(new_buffer);
+        return;
+    }
+    if (device.bindBufferMemory(new_buffer, memory, 0) != vk::Result::eSuccess) {
+        device.destroyBuffer(new_buffer);
+        device.freeMemory(memory);
+        return;
+    }
+    buffer = new_buffer;
+    imported_memory = memory;
+    if (with_bda) {
+        bda_addr = device.getBufferAddress({.buffer = buffer});
+    }
+}
+
 Buffer::Buffer(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_, MemoryUsage usage_,
                VAddr cpu_addr_, vk::BufferUsageFlags flags, u64 size_bytes_)
     : cpu_addr{cpu_addr_}, size_bytes{size_bytes_}, instance{&instance_}, scheduler{&scheduler_},
       usage{usage_}, buffer{instance->GetDevice(), instance->GetAllocator()} {
+    // Descriptors of buffers bound to shaders are written from their device address.
+    if (instance->IsDescriptorBufferSupported() &&
+        (flags & (vk::BufferUsageFlagBits::eUniformBuffer |
+                  vk::BufferUsageFlagBits::eStorageBuffer))) {
+        flags |= vk::BufferUsageFlagBits::eShaderDeviceAddress;
+    }
+
     // Create buffer object.
     const vk::BufferCreateInfo buffer_ci = {
         .size = size_bytes,
         .usage = flags,
     };
+    if (usage == MemoryUsage::HostImport) {
+        buffer.Import(buffer_ci, std::bit_cast<void*>(cpu_addr));
+        is_coherent = true;
+        return;
+    }
     VmaAllocationInfo alloc_info{};
-    buffer.Create(buffer_ci, usage, &alloc_info);
+    const auto pool = MemoryUsagePool(usage);
+    buffer.Create(buffer_ci, usage, &alloc_info,
+                  pool ? instance->GetMemoryPool(*pool) : VK_NULL_HANDLE);
 
     const auto device = instance->GetDevice();
     Vulkan::SetObjectName(device, Handle(), "Buffer {:#x}:{:#x}", cpu_addr, size_bytes);
@@ -164,8 +259,9 @@ constexpr u64 WATCHES_INITIAL_RESERVE = 0x4000;
 constexpr u64 WATCHES_RESERVE_CHUNK = 0x1000;
 
 StreamBuffer::StreamBuffer(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler,
-                           MemoryUsage usage, u64 size_bytes)
-    : Buffer{instance, scheduler, usage, 0, AllFlags, size_bytes} {
+                           MemoryUsage usage, u64 size_bytes, vk::BufferUsageFlags flags_)
+    : Buffer{instance, scheduler, usage, 0, flags_, size_bytes}, flags{flags_},
+      max_size_bytes{std::max(size_bytes, std::min(size_bytes * MaxGrowFactor, MaxGrowSize))} {
     ReserveWatches(current_watches, WATCHES_INITIAL_RESERVE);
     ReserveWatches(previous_watches, WATCHES_INITIAL_RESERVE);
     const auto device = instance.GetDevice();
@@ -198,16 +294,46 @@ std::pair<u8*, u64> StreamBuffer::Map(u64 size, u64 alignment, bool allow_wait)
         std::swap(previous_watches, current_watches);
         wait_cursor = 0;
         wait_bound = 0;
+        ++stats.wraps;
     }
 
     const u64 mapped_upper_bound = offset + size;
-    if (!WaitPendingOperations(mapped_upper_bound, allow_wait)) {
-        return {nullptr, 0};
+    if (!WaitPendingOperations(mapped_upper_bound, false)) {
+        if (!allow_wait) {
+            return {nullptr, 0};
+        }
+        ++stats.stalls;
+        stalled = true;
+        VideoCore::ScopedStall stall{VideoCore::StallCause::StreamBufferWait};
+        WaitPendingOperations(mapped_upper_bound, true);
     }
 
     return {mapped_data.data() + offset, offset};
 }
 
+void StreamBuffer::GrowIfStalled() {
+    if (!std::exchange(stalled, false) || size_bytes >= max_size_bytes) {
+        return;
+    }
+    const u64 new_size = std::min(size_bytes * 2, max_size_bytes);
+    LOG_INFO(Render_Vulkan, "Growing {} stream buffer to {:#x} bytes", BufferTypeName(usage),
+             new_size);
+    // Commands recorded so far keep referencing the old allocation until they complete
+    Buffer new_buffer{*instance, *scheduler, usage, 0, flags, new_size};
+    Buffer old_buffer = std::exchange(static_cast<Buffer&>(*this), std::move(new_buffer));
+    scheduler->DeferOperation([buffer = std::move(old_buffer)]() mutable {});
+    Vulkan::SetObjectName(instance->GetDevice(), Handle(), "StreamBuffer({}):{:#x}",
+                          BufferTypeName(usage), new_size);
+
+    // Nothing in flight uses the new allocation
+    offset = 0;
+    current_watch_cursor = 0;
+    invalidation_mark.reset();
+    wait_cursor = 0;
+    wait_bound = 0;
+    ++stats.grows;
+}
+
 void StreamBuffer::Commit() {
     if (!is_coherent) {
         if (usage == MemoryUsage::Download) {
@@ -18,6 +18,7 @@ class Scheduler;
 
 VK_DEFINE_HANDLE(VmaAllocation)
 VK_DEFINE_HANDLE(VmaAllocator)
+VK_DEFINE_HANDLE(VmaPool)
 
 struct VmaAllocationInfo;
 
@@ -29,6 +30,7 @@ enum class MemoryUsage {
     Upload,      ///< Requires a host visible memory type optimized for CPU to GPU uploads
     Download,    ///< Requires a host visible memory type optimized for GPU to CPU readbacks
     Stream,      ///< Requests device local host visible buffer, falling back host memory.
+    HostImport,  ///< Aliases the guest memory at cpu_addr through VK_EXT_external_memory_host
 };
 
 constexpr vk::BufferUsageFlags ReadFlags =
@@ -47,18 +49,28 @@ struct UniqueBuffer {
     UniqueBuffer& operator=(const UniqueBuffer&) = delete;
 
     UniqueBuffer(UniqueBuffer&& other)
-        : allocator{std::exchange(other.allocator, VK_NULL_HANDLE)},
+        : device{other.device}, allocator{std::exchange(other.allocator, VK_NULL_HANDLE)},
           allocation{std::exchange(other.allocation, VK_NULL_HANDLE)},
-          buffer{std::exchange(other.buffer, VK_NULL_HANDLE)} {}
+          imported_memory{std::exchange(other.imported_memory, VK_NULL_HANDLE)},
+          buffer{std::exchange(other.buffer, VK_NULL_HANDLE)},
+          bda_addr{std::exchange(other.bda_addr, 0)} {}
     UniqueBuffer& operator=(UniqueBuffer&& other) {
+        device = other.device;
         buffer = std::exchange(other.buffer, VK_NULL_HANDLE);
         allocator = std::exchange(other.allocator, VK_NULL_HANDLE);
         allocation = std::exchange(other.allocation, VK_NULL_HANDLE);
+        imported_memory = std::exchange(other.imported_memory, VK_NULL_HANDLE);
+        bda_addr = std::exchange(other.bda_addr, 0);
         return *this;
     }
 
+    /// Allocates from pool when given, falling back to the default pools if that fails.
     void Create(const vk::BufferCreateInfo& image_ci, MemoryUsage usage,
-                VmaAllocationInfo* out_alloc_info);
+                VmaAllocationInfo* out_alloc_info, VmaPool pool = VK_NULL_HANDLE);
+
+    /// Binds the buffer to host memory imported from host_pointer. Leaves the buffer null if
+    /// the driver can't import it.
+    void Import(const vk::BufferCreateInfo& buffer_ci, void* host_pointer);
 
     operator vk::Buffer() const {
         return buffer;
@@ -67,6 +79,7 @@ struct UniqueBuffer {
     vk::Device device;
     VmaAllocator allocator;
     VmaAllocation allocation;
+    vk::DeviceMemory imported_memory{};
     vk::Buffer buffer{};
     vk::DeviceAddress bda_addr = 0;
 };
@@ -154,6 +167,7 @@ public:
     bool is_picked{};
     bool is_coherent{};
     bool is_deleted{};
+    bool is_fresh{}; ///< Not referenced by any GPU command yet
     int stream_score = 0;
     size_t size_bytes = 0;
     u64 lru_id = 0;
@@ -170,8 +184,15 @@ public:
 
 class StreamBuffer : public Buffer {
 public:
+    struct Stats {
+        u32 wraps;  ///< Times the ring restarted from the beginning
+        u32 grows;  ///< Times the ring was replaced by a larger one
+        u32 stalls; ///< Times a Map had to wait for the GPU
+    };
+
     explicit StreamBuffer(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler,
-                          MemoryUsage usage, u64 size_bytes_);
+                          MemoryUsage usage, u64 size_bytes_,
+                          vk::BufferUsageFlags flags = AllFlags);
 
     /// Reserves a region of memory from the stream buffer.
     std::pair<u8*, u64> Map(u64 size, u64 alignment = 0, bool allow_wait = true);
@@ -187,7 +208,20 @@ public:
         return offset;
     }
 
+    /// Replaces the ring with a larger one if a Map had to wait for the GPU since the last call.
+    /// Must only be called between submissions, when no handle of the buffer is held.
+    void GrowIfStalled();
+
+    /// Returns the events since the last call and resets them.
+    [[nodiscard]] Stats ConsumeStats() noexcept {
+        return std::exchange(stats, Stats{});
+    }
+
 private:
+    /// Growth is bounded so a runaway producer ends up waiting instead of exhausting memory.
+    static constexpr u64 MaxGrowFactor = 4;
+    static constexpr u64 MaxGrowSize = 1_GB;
+
     struct Watch {
         u64 tick{};
         u64 upper_bound{};
@@ -200,6 +234,10 @@ private:
     bool WaitPendingOperations(u64 requested_upper_bound, bool allow_wait);
 
 private:
+    vk::BufferUsageFlags flags;
+    u64 max_size_bytes{};
+    Stats stats{};
+    bool stalled{};
     u64 offset{};
     u64 mapped_size{};
     std::vector<Watch> current_watches;
@@ -3,8 +3,14 @@
 
 #include <algorithm>
 #include "common/alignment.h"
+#include "common/alloc_tracker.h"
+#include "common/config.h"
 #include "common/debug.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/perf_counters.h"
 #include "common/scope_exit.h"
+#include "core/debug_state.h"
 #include "core/memory.h"
 #include "video_core/amdgpu/liverpool.h"
 #include "video_core/buffer_cache/buffer_cache.h"
@@ -12,12 +18,16 @@
 #include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/stall_tracker.h"
 #include "video_core/texture_cache/texture_cache.h"
 
 namespace VideoCore {
 
 static constexpr size_t DataShareBufferSize = 64_KB;
 static constexpr size_t StagingBufferSize = 512_MB;
+static constexpr size_t TransferQueueMinUploadSize = 1_MB;
+static constexpr u64 HostImportChunkBits = 21;
+static constexpr u64 HostImportChunkSize = u64{1} << HostImportChunkBits;
 static constexpr size_t DownloadBufferSize = 32_MB;
 static constexpr size_t UboStreamBufferSize = 64_MB;
 static constexpr size_t DeviceBufferSize = 128_MB;
@@ -34,13 +44,22 @@ BufferCache::BufferCache(const Vulkan::Instance& instance_, Vulkan::Scheduler& s
       device_buffer{instance, scheduler, MemoryUsage::DeviceLocal, DeviceBufferSize},
       gds_buffer{instance, scheduler, MemoryUsage::Stream, 0, AllFlags, DataShareBufferSize},
       bda_pagetable_buffer{instance, scheduler, MemoryUsage::DeviceLocal,
-                           0,        AllFlags,  BDA_PAGETABLE_SIZE} {
+                           0,        AllFlags,  BDA_PAGETABLE_SIZE},
+      page_table{Config::isHugePagePageTablesEnabled()} {
+    if (Config::isBufferCacheStatsEnabled()) {
+        stats_log = std::make_unique<BufferCacheStatsLog>();
+    }
     Vulkan::SetObjectName(instance.GetDevice(), gds_buffer.Handle(), "GDS Buffer");
     Vulkan::SetObjectName(instance.GetDevice(), bda_pagetable_buffer.Handle(),
                           "BDA Page Table Buffer");
 
     memory_tracker = std::make_unique<MemoryTracker>(tracker);
 
+    if (Config::isTransferQueueUploadsEnabled() && instance.HasTransferQueue()) {
+        transfer_scheduler = std::make_unique<Vulkan::Scheduler>(
+            instance, instance.GetTransferQueue(), instance.GetTransferQueueFamilyIndex());
+    }
+
     std::memset(gds_buffer.mapped_data.data(), 0, DataShareBufferSize);
 
     // Ensure the first slot is used for the null buffer
@@ -57,18 +76,7 @@ BufferCache::BufferCache(const Vulkan::Instance& instance_, Vulkan::Scheduler& s
         return;
     }
 
-    const s64 device_local_memory = static_cast<s64>(instance.GetTotalMemoryBudget());
-    const s64 min_spacing_expected = device_local_memory - 1_GB;
-    const s64 min_spacing_critical = device_local_memory - 512_MB;
-    const s64 mem_threshold = std::min<s64>(device_local_memory, TARGET_GC_THRESHOLD);
-    const s64 min_vacancy_expected = (6 * mem_threshold) / 10;
-    const s64 min_vacancy_critical = (2 * mem_threshold) / 10;
-    trigger_gc_memory = static_cast<u64>(
-        std::max<u64>(std::min(device_local_memory - min_vacancy_expected, min_spacing_expected),
-                      DEFAULT_TRIGGER_GC_MEMORY));
-    critical_gc_memory = static_cast<u64>(
-        std::max<u64>(std::min(device_local_memory - min_vacancy_critical, min_spacing_critical),
-                      DEFAULT_CRITICAL_GC_MEMORY));
+    UpdateGcThresholds(static_cast<s64>(instance.GetTotalMemoryBudget()));
 }
 
 BufferCache::~BufferCache() = default;
@@ -83,11 +91,98 @@ void BufferCache::InvalidateMemory(VAddr device_addr, u64 size) {
 
 void BufferCache::ReadMemory(VAddr device_addr, u64 size, bool is_write) {
     liverpool->SendCommand<true>([this, device_addr, size, is_write] {
+        if (Config::isSpeculativeReadbacksEnabled()) {
+            const u64 page_end = Common::DivCeil(device_addr + size, CACHING_PAGESIZE);
+            for (u64 page = device_addr >> CACHING_PAGEBITS; page < page_end; ++page) {
+                readback_pages.insert(page);
+            }
+            if (speculative_readback_tick != 0) {
+                // The copy was submitted earlier and only its write back to guest memory is left
+                scheduler.Wait(speculative_readback_tick);
+                scheduler.PopPendingOperations();
+            }
+        }
         Buffer& buffer = slot_buffers[FindBuffer(device_addr, size)];
         DownloadBufferMemory<false>(buffer, device_addr, size, is_write);
     });
 }
 
+void BufferCache::EndFrame() {
+    if (stats_log) {
+        stats_log->EndFrame(stats);
+    }
+}
+
+void BufferCache::ResizeStreamBuffers() {
+    for (auto* buffer : {&staging_buffer, &stream_buffer, &download_buffer, &device_buffer}) {
+        buffer->GrowIfStalled();
+        const auto stats = buffer->ConsumeStats();
+        DebugState.stream_buffer_wraps.fetch_add(stats.wraps, std::memory_order_relaxed);
+        DebugState.stream_buffer_stalls.fetch_add(stats.stalls, std::memory_order_relaxed);
+        DebugState.stream_buffer_grows.fetch_add(stats.grows, std::memory_order_relaxed);
+    }
+}
+
+void BufferCache::PrefetchReadbacks() {
+    if (!Config::readbacks() || !Config::isSpeculativeReadbacksEnabled() ||
+        speculative_readback_tick != 0) {
+        return;
+    }
+    // Pages are predicted from the accesses of the previous submission. Pages that are prefetched
+    // don't fault anymore, so they stay predicted for as long as the GPU keeps writing them.
+    predicted_readback_pages.swap(readback_pages);
+    readback_pages.clear();
+    bool prefetched = false;
+    for (const u64 page : predicted_readback_pages) {
+        const VAddr page_addr = page << CACHING_PAGEBITS;
+        if (!memory_tracker->IsRegionGpuModified(page_addr, CACHING_PAGESIZE)) {
+            continue;
+        }
+        readback_pages.insert(page);
+        ForEachBufferInRange(page_addr, CACHING_PAGESIZE, [&](BufferId, Buffer& buffer) {
+            const VAddr start = std::max(buffer.CpuAddr(), page_addr);
+            const VAddr end = std::min(buffer.CpuAddr() + buffer.SizeBytes(),
+                                       page_addr + CACHING_PAGESIZE);
+            DownloadBufferMemory<true>(buffer, start, end - start, false);
+        });
+        prefetched = true;
+    }
+    if (!prefetched) {
+        return;
+    }
+    speculative_readback_tick = scheduler.CurrentTick();
+    // The downloads unmark their pages once they complete, GPU writes recorded in between have to
+    // keep them modified.
+    scheduler.DeferOperation([this] {
+        for (const auto& [device_addr, size] : prefetch_overwrites) {
+            memory_tracker->MarkRegionAsGpuModified(device_addr, size);
+        }
+        prefetch_overwrites.clear();
+        speculative_readback_tick = 0;
+    });
+}
+
+void BufferCache::UnmapMemory(VAddr device_addr, u64 size) {
+    if (!Config::isHostMemoryImportEnabled()) {
+        return;
+    }
+    // Imported pages stay pinned until the memory is freed, so dropping them later is safe
+    liverpool->SendCommand([this, device_addr, size] {
+        const u64 chunk_end = Common::DivCeil(device_addr + size, HostImportChunkSize);
+        for (u64 chunk = device_addr >> HostImportChunkBits; chunk < chunk_end; ++chunk) {
+            const auto it = host_buffers.find(chunk);
+            if (it == host_buffers.end()) {
+                continue;
+            }
+            if (it->second) {
+                scheduler.DeferOperation(
+                    [buffer = std::move(it.value())]() mutable { buffer.reset(); });
+            }
+            host_buffers.erase(it);
+        }
+    });
+}
+
 template <bool async>
 void BufferCache::DownloadBufferMemory(Buffer& buffer, VAddr device_addr, u64 size, bool is_write) {
     boost::container::small_vector<vk::BufferCopy, 1> copies;
@@ -114,6 +209,8 @@ void BufferCache::DownloadBufferMemory(Buffer& buffer, VAddr device_addr, u64 si
     if (total_size_bytes == 0) {
         return;
     }
+    stats.download_bytes += total_size_bytes;
+    Common::CountPerf(Common::PerfCounter::Readbacks);
     const auto [download, offset] = download_buffer.Map(total_size_bytes);
     for (auto& copy : copies) {
         // Modify copies to have the staging offset in mind
@@ -139,6 +236,7 @@ void BufferCache::DownloadBufferMemory(Buffer& buffer, VAddr device_addr, u64 si
     if constexpr (async) {
         scheduler.DeferOperation(write_data);
     } else {
+        VideoCore::ScopedStall stall{VideoCore::StallCause::Readback};
         scheduler.Finish();
         write_data();
     }
@@ -154,9 +252,22 @@ void BufferCache::BindVertexBuffers(const Vulkan::GraphicsPipeline& pipeline) {
                              regs.vgt_instance_step_rate_0, regs.vgt_instance_step_rate_1);
 
     if (instance.IsVertexInputDynamicState()) {
-        // Update current vertex inputs.
-        const auto cmdbuf = scheduler.CommandBuffer();
-        cmdbuf.setVertexInputEXT(bindings, attributes);
+        // Consecutive draws mostly share the vertex layout, it is only set again when it changes.
+        u64 hash = bindings.size();
+        for (const auto& binding : bindings) {
+            hash = HashCombine(hash, (u64{binding.binding} << 32) | binding.stride);
+            hash = HashCombine(hash, (u64{static_cast<u32>(binding.inputRate)} << 32) |
+                                         binding.divisor);
+        }
+        for (const auto& attribute : attributes) {
+            hash = HashCombine(hash, (u64{attribute.location} << 32) | attribute.binding);
+            hash = HashCombine(hash, (u64{static_cast<u32>(attribute.format)} << 32) |
+                                         attribute.offset);
+        }
+        if (scheduler.GetDynamicState().TakeVertexInput(hash)) {
+            const auto cmdbuf = scheduler.CommandBuffer();
+            cmdbuf.setVertexInputEXT(bindings, attributes);
+        }
     }
 
     if (bindings.empty()) {
@@ -244,7 +355,7 @@ void BufferCache::BindVertexBuffers(const Vulkan::GraphicsPipeline& pipeline) {
     }
 }
 
-void BufferCache::BindIndexBuffer(u32 index_offset) {
+Buffer* BufferCache::BindIndexBuffer(u32 index_offset) {
     const auto& regs = liverpool->regs;
 
     // Figure out index type and size.
@@ -259,6 +370,7 @@ void BufferCache::BindIndexBuffer(u32 index_offset) {
     const auto [vk_buffer, offset] = ObtainBuffer(index_address, index_buffer_size, false);
     const auto cmdbuf = scheduler.CommandBuffer();
     cmdbuf.bindIndexBuffer(vk_buffer->Handle(), offset, index_type);
+    return vk_buffer;
 }
 
 void BufferCache::FillBuffer(VAddr address, u32 num_bytes, u32 value, bool is_gds) {
@@ -310,6 +422,9 @@ void BufferCache::CopyBuffer(VAddr dst, VAddr src, u32 num_bytes, bool dst_gds,
         auto& buffer = slot_buffers[buffer_id];
         SynchronizeBuffer(buffer, dst, num_bytes, true, true);
         gpu_modified_ranges.Add(dst, num_bytes);
+        if (speculative_readback_tick != 0) {
+            prefetch_overwrites.emplace_back(dst, num_bytes);
+        }
         return buffer;
     }();
     const vk::BufferCopy region = {
@@ -374,11 +489,17 @@ void BufferCache::CopyBuffer(VAddr dst, VAddr src, u32 num_bytes, bool dst_gds,
 
 std::pair<Buffer*, u32> BufferCache::ObtainBuffer(VAddr device_addr, u32 size, bool is_written,
                                                   bool is_texel_buffer, BufferId buffer_id) {
+    Common::ScopedAllocTag alloc_tag{Common::AllocTag::BufferCache};
     // For read-only buffers use device local stream buffer to reduce renderpass breaks.
     if (!is_written && size <= CACHING_PAGESIZE && !IsRegionGpuModified(device_addr, size)) {
         const u64 offset = stream_buffer.Copy(device_addr, size, instance.UniformMinAlignment());
         return {&stream_buffer, offset};
     }
+    if (!is_written && !is_texel_buffer && IsBufferInvalid(buffer_id)) {
+        if (Buffer* host_buffer = ObtainHostBuffer(device_addr, size)) {
+            return {host_buffer, host_buffer->Offset(device_addr)};
+        }
+    }
     if (IsBufferInvalid(buffer_id)) {
         buffer_id = FindBuffer(device_addr, size);
     }
@@ -386,6 +507,9 @@ std::pair<Buffer*, u32> BufferCache::ObtainBuffer(VAddr device_addr, u32 size, b
     SynchronizeBuffer(buffer, device_addr, size, is_written, is_texel_buffer);
     if (is_written) {
         gpu_modified_ranges.Add(device_addr, size);
+        if (speculative_readback_tick != 0) {
+            prefetch_overwrites.emplace_back(device_addr, size);
+        }
     }
     return {&buffer, buffer.Offset(device_addr)};
 }
@@ -499,6 +623,7 @@ BufferCache::OverlapResult BufferCache::ResolveOverlaps(VAddr device_addr, u32 w
             // When this memory region has been joined a bunch of times, we assume it's being used
             // as a stream buffer. Increase the size to skip constantly recreating buffers.
             has_stream_leap = true;
+            ++stats.stream_leaps;
             if (expands_right) {
                 expand_begin(CACHING_PAGESIZE * 128);
             }
@@ -521,7 +646,10 @@ void BufferCache::JoinOverlap(BufferId new_buffer_id, BufferId overlap_id,
     Buffer& overlap = slot_buffers[overlap_id];
     if (accumulate_stream_score) {
         new_buffer.IncreaseStreamScore(overlap.StreamScore() + 1);
+        stats.max_stream_score =
+            std::max<u64>(stats.max_stream_score, static_cast<u64>(new_buffer.StreamScore()));
     }
+    ++stats.overlaps_joined;
     const size_t dst_base_offset = overlap.CpuAddr() - new_buffer.CpuAddr();
     const vk::BufferCopy copy = {
         .srcOffset = 0,
@@ -578,6 +706,8 @@ BufferId BufferCache::CreateBuffer(VAddr device_addr, u32 wanted_size) {
         slot_buffers.insert(instance, scheduler, MemoryUsage::DeviceLocal, overlap.begin,
                             AllFlags | vk::BufferUsageFlagBits::eShaderDeviceAddress, size);
     auto& new_buffer = slot_buffers[new_buffer_id];
+    new_buffer.is_fresh = overlap.ids.empty();
+    ++stats.buffers_created;
     for (const BufferId overlap_id : overlap.ids) {
         JoinOverlap(new_buffer_id, overlap_id, !overlap.has_stream_leap);
     }
@@ -614,6 +744,8 @@ void BufferCache::ChangeRegister(BufferId buffer_id) {
         }
     }
     if constexpr (insert) {
+        ++stats.num_buffers;
+        stats.total_bytes += Common::AlignUp(size, CACHING_PAGESIZE);
         total_used_memory += Common::AlignUp(size, CACHING_PAGESIZE);
         buffer.SetLRUId(lru_cache.Insert(buffer_id, gc_tick));
         boost::container::small_vector<vk::DeviceAddress, 128> bda_addrs;
@@ -626,6 +758,8 @@ void BufferCache::ChangeRegister(BufferId buffer_id) {
                         bda_addrs.data(), bda_addrs.size() * sizeof(vk::DeviceAddress));
         buffer_ranges.Add(buffer.CpuAddr(), buffer.SizeBytes(), buffer_id);
     } else {
+        --stats.num_buffers;
+        stats.total_bytes -= Common::AlignUp(size, CACHING_PAGESIZE);
         total_used_memory -= Common::AlignUp(size, CACHING_PAGESIZE);
         lru_cache.Free(buffer.LRUId());
         const u64 offset = bda_pagetable_buffer.Offset(page_begin * sizeof(vk::DeviceAddress));
@@ -640,13 +774,25 @@ bool BufferCache::SynchronizeBuffer(Buffer& buffer, VAddr device_addr, u32 size,
     size_t total_size_bytes = 0;
     VAddr buffer_start = buffer.CpuAddr();
     vk::Buffer src_buffer = VK_NULL_HANDLE;
+    const bool is_fresh = std::exchange(buffer.is_fresh, false);
     memory_tracker->ForEachUploadRange(
         device_addr, size, is_written,
         [&](u64 device_addr_out, u64 range_size) {
             copies.emplace_back(total_size_bytes, device_addr_out - buffer_start, range_size);
             total_size_bytes += range_size;
         },
-        [&] { src_buffer = UploadCopies(buffer, copies, total_size_bytes); });
+        [&] {
+            stats.upload_copies += copies.size();
+            stats.upload_bytes += total_size_bytes;
+            Common::CountPerf(Common::PerfCounter::BufferUploadBytes, total_size_bytes);
+            // The transfer queue can't be ordered against graphics commands already recorded,
+            // so only buffers none of them can reference take that path.
+            if (transfer_scheduler && is_fresh && total_size_bytes >= TransferQueueMinUploadSize) {
+                UploadOnTransferQueue(buffer, copies, total_size_bytes);
+                return;
+            }
+            src_buffer = UploadCopies(buffer, copies, total_size_bytes);
+        });
 
     if (src_buffer) {
         scheduler.EndRendering();
@@ -685,7 +831,9 @@ bool BufferCache::SynchronizeBuffer(Buffer& buffer, VAddr device_addr, u32 size,
         TouchBuffer(buffer);
     }
     if (is_texel_buffer && !is_written) {
-        return SynchronizeBufferFromImage(buffer, device_addr, size);
+        const bool synced = SynchronizeBufferFromImage(buffer, device_addr, size);
+        stats.image_syncs += synced;
+        return synced;
     }
     return false;
 }
@@ -723,6 +871,58 @@ vk::Buffer BufferCache::UploadCopies(Buffer& buffer, std::span<vk::BufferCopy> c
     }
 }
 
+void BufferCache::UploadOnTransferQueue(Buffer& buffer, std::span<vk::BufferCopy> copies,
+                                        size_t total_size_bytes) {
+    auto temp_buffer =
+        std::make_unique<Buffer>(instance, scheduler, MemoryUsage::Upload, 0,
+                                 vk::BufferUsageFlagBits::eTransferSrc, total_size_bytes);
+    u8* const staging = temp_buffer->mapped_data.data();
+    for (const auto& copy : copies) {
+        const VAddr device_addr = buffer.CpuAddr() + copy.dstOffset;
+        memory->CopySparseMemory(device_addr, staging + copy.srcOffset, copy.size);
+    }
+
+    // The buffer is exclusive to one queue family at a time, the transfer queue hands it over
+    // to the graphics queue with a release and acquire barrier pair.
+    const u32 transfer_family = instance.GetTransferQueueFamilyIndex();
+    const u32 graphics_family = instance.GetGraphicsQueueFamilyIndex();
+    const vk::BufferMemoryBarrier2 release_barrier = {
+        .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .srcQueueFamilyIndex = transfer_family,
+        .dstQueueFamilyIndex = graphics_family,
+        .buffer = buffer.Handle(),
+        .offset = 0,
+        .size = buffer.SizeBytes(),
+    };
+    const auto transfer_cmdbuf = transfer_scheduler->CommandBuffer();
+    transfer_cmdbuf.copyBuffer(temp_buffer->Handle(), buffer.Handle(), copies);
+    transfer_cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .bufferMemoryBarrierCount = 1,
+        .pBufferMemoryBarriers = &release_barrier,
+    });
+    scheduler.WaitOn(*transfer_scheduler, transfer_scheduler->CurrentTick());
+
+    const vk::BufferMemoryBarrier2 acquire_barrier = {
+        .dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+        .dstAccessMask = vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite,
+        .srcQueueFamilyIndex = transfer_family,
+        .dstQueueFamilyIndex = graphics_family,
+        .buffer = buffer.Handle(),
+        .offset = 0,
+        .size = buffer.SizeBytes(),
+    };
+    scheduler.EndRendering();
+    const auto cmdbuf = scheduler.CommandBuffer();
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .bufferMemoryBarrierCount = 1,
+        .pBufferMemoryBarriers = &acquire_barrier,
+    });
+    // Graphics work completing after the wait implies the copy is done with the staging memory
+    scheduler.DeferOperation([buffer = std::move(temp_buffer)]() mutable { buffer.reset(); });
+    TouchBuffer(buffer);
+}
+
 bool BufferCache::SynchronizeBufferFromImage(Buffer& buffer, VAddr device_addr, u32 size) {
     const ImageId image_id = texture_cache.FindImageFromRange(device_addr, size);
     if (!image_id) {
@@ -838,6 +1038,9 @@ void BufferCache::RunGarbageCollector() {
         ++gc_tick;
     };
     if (instance.CanReportMemoryUsage()) {
+        if (gc_tick % GC_BUDGET_REFRESH_TICKS == 0) {
+            UpdateGcThresholds(static_cast<s64>(instance.GetCurrentMemoryBudget()));
+        }
         total_used_memory = instance.GetDeviceMemoryUsage();
     }
     if (total_used_memory < trigger_gc_memory) {
@@ -846,16 +1049,67 @@ void BufferCache::RunGarbageCollector() {
     const bool aggressive = total_used_memory >= critical_gc_memory;
     const u64 ticks_to_destroy = std::min<u64>(aggressive ? 80 : 160, gc_tick);
     int max_deletions = aggressive ? 64 : 32;
+    // Also bound the bytes downloaded and freed per run, so large buffers are evicted over
+    // several frames rather than in one spike.
+    s64 max_deleted_bytes = aggressive ? 512_MB : 128_MB;
     const auto clean_up = [&](BufferId buffer_id) {
-        if (max_deletions == 0) {
-            return;
+        if (max_deletions == 0 || max_deleted_bytes <= 0) {
+            return true;
         }
         --max_deletions;
         Buffer& buffer = slot_buffers[buffer_id];
+        max_deleted_bytes -= static_cast<s64>(buffer.SizeBytes());
         // InvalidateMemory(buffer.CpuAddr(), buffer.SizeBytes());
         DownloadBufferMemory<true>(buffer, buffer.CpuAddr(), buffer.SizeBytes(), true);
         DeleteBuffer(buffer_id);
+        return false;
     };
+    lru_cache.ForEachItemBelow(gc_tick - ticks_to_destroy, clean_up);
+}
+
+Buffer* BufferCache::ObtainHostBuffer(VAddr device_addr, u32 size) {
+    if (!Config::isHostMemoryImportEnabled() || !instance.IsExternalMemoryHostSupported()) {
+        return nullptr;
+    }
+    const u64 chunk = device_addr >> HostImportChunkBits;
+    if (chunk != (device_addr + size - 1) >> HostImportChunkBits) {
+        return nullptr;
+    }
+    // Data the GPU wrote is only up to date in device buffers, and data the CPU did not touch
+    // since the last upload is better read from device local memory.
+    if (memory_tracker->IsRegionGpuModified(device_addr, size) ||
+        !memory_tracker->IsRegionCpuModified(device_addr, size)) {
+        return nullptr;
+    }
+    auto [it, is_new] = host_buffers.try_emplace(chunk);
+    if (is_new) {
+        static_assert(HostImportChunkSize % CACHING_PAGESIZE == 0);
+        ASSERT(HostImportChunkSize % instance.GetMinImportedHostPointerAlignment() == 0);
+        auto buffer = std::make_unique<Buffer>(
+            instance, scheduler, MemoryUsage::HostImport, chunk << HostImportChunkBits,
+            ReadFlags | vk::BufferUsageFlagBits::eStorageBuffer, HostImportChunkSize);
+        if (buffer->Handle()) {
+            it.value() = std::move(buffer);
+        } else {
+            LOG_WARNING(Render_Vulkan, "Unable to import guest memory at {:#x}",
+                        chunk << HostImportChunkBits);
+        }
+    }
+    return it->second.get();
+}
+
+void BufferCache::UpdateGcThresholds(s64 device_local_memory) {
+    const s64 min_spacing_expected = device_local_memory - 1_GB;
+    const s64 min_spacing_critical = device_local_memory - 512_MB;
+    const s64 mem_threshold = std::min<s64>(device_local_memory, TARGET_GC_THRESHOLD);
+    const s64 min_vacancy_expected = (6 * mem_threshold) / 10;
+    const s64 min_vacancy_critical = (2 * mem_threshold) / 10;
+    trigger_gc_memory = static_cast<u64>(
+        std::max<u64>(std::min(device_local_memory - min_vacancy_expected, min_spacing_expected),
+                      DEFAULT_TRIGGER_GC_MEMORY));
+    critical_gc_memory = static_cast<u64>(
+        std::max<u64>(std::min(device_local_memory - min_vacancy_critical, min_spacing_critical),
+                      DEFAULT_CRITICAL_GC_MEMORY));
 }
 
 void BufferCache::TouchBuffer(const Buffer& buffer) {
@@ -865,6 +1119,7 @@ void BufferCache::TouchBuffer(const Buffer& buffer) {
 void BufferCache::DeleteBuffer(BufferId buffer_id) {
     Buffer& buffer = slot_buffers[buffer_id];
     Unregister(buffer_id);
+    ++stats.buffers_deleted;
     scheduler.DeferOperation([this, buffer_id] { slot_buffers.erase(buffer_id); });
     buffer.is_deleted = true;
 }
@@ -4,10 +4,13 @@
 #pragma once
 
 #include <boost/container/small_vector.hpp>
+#include <tsl/robin_map.h>
+#include <tsl/robin_set.h>
 #include "common/lru_cache.h"
 #include "common/slot_vector.h"
 #include "common/types.h"
 #include "video_core/buffer_cache/buffer.h"
+#include "video_core/buffer_cache/buffer_cache_stats.h"
 #include "video_core/buffer_cache/fault_manager.h"
 #include "video_core/buffer_cache/range_set.h"
 #include "video_core/multi_level_page_table.h"
@@ -46,6 +49,8 @@ public:
     static constexpr s64 DEFAULT_TRIGGER_GC_MEMORY = 1_GB;
     static constexpr s64 DEFAULT_CRITICAL_GC_MEMORY = 2_GB;
     static constexpr s64 TARGET_GC_THRESHOLD = 8_GB;
+    /// Collections between two queries of the device memory budget
+    static constexpr u64 GC_BUDGET_REFRESH_TICKS = 64;
 
     struct PageData {
         BufferId buffer_id{};
@@ -111,11 +116,30 @@ public:
     /// Flushes any GPU modified buffer in the logical page range back to CPU memory.
     void ReadMemory(VAddr device_addr, u64 size, bool is_write = false);
 
+    /// Drops the imports of guest memory in the region.
+    void UnmapMemory(VAddr device_addr, u64 size);
+
+    /// Returns the fault buffer counters accumulated since the last call.
+    [[nodiscard]] FaultManager::Stats ConsumeFaultStats() const {
+        return fault_manager.ConsumeStats();
+    }
+
+    /// Reports the counters of the frame when buffer cache statistics are enabled.
+    void EndFrame();
+
+    /// Grows the utility stream buffers that made the recording thread wait since the previous
+    /// submission, and reports their events to the debug state.
+    void ResizeStreamBuffers();
+
+    /// Downloads the GPU modified pages the CPU read back since the previous submission, so that
+    /// the next access to them is served without flushing the GPU.
+    void PrefetchReadbacks();
+
     /// Binds host vertex buffers for the current draw.
     void BindVertexBuffers(const Vulkan::GraphicsPipeline& pipeline);
 
-    /// Bind host index buffer for the current draw.
-    void BindIndexBuffer(u32 index_offset);
+    /// Bind host index buffer for the current draw, returns the buffer that was bound.
+    Buffer* BindIndexBuffer(u32 index_offset);
 
     /// Writes a value to GPU buffer. (uses command buffer to temporarily store the data)
     void FillBuffer(VAddr address, u32 num_bytes, u32 value, bool is_gds);
@@ -140,6 +164,11 @@ public:
     /// Return true when a CPU region is modified from the GPU
     [[nodiscard]] bool IsRegionGpuModified(VAddr addr, size_t size);
 
+    /// Returns the host memory used by the buffer page table.
+    [[nodiscard]] size_t PageTableResidentBytes() const noexcept {
+        return page_table.ResidentBytes();
+    }
+
     /// Return buffer id for the specified region
     BufferId FindBuffer(VAddr device_addr, u32 size);
 
@@ -155,6 +184,16 @@ public:
     /// Runs the garbage collector.
     void RunGarbageCollector();
 
+    /// Calls func with every buffer in the cache.
+    template <typename Func>
+    void ForEachBuffer(Func&& func) {
+        slot_buffers.ForEach([&](BufferId id, Buffer& buffer) {
+            if (!IsBufferInvalid(id)) {
+                func(id, buffer);
+            }
+        });
+    }
+
 private:
     template <typename Func>
     void ForEachBufferInRange(VAddr device_addr, u64 size, Func&& func) {
@@ -191,16 +230,29 @@ private:
     vk::Buffer UploadCopies(Buffer& buffer, std::span<vk::BufferCopy> copies,
                             size_t total_size_bytes);
 
+    /// Uploads to a buffer no GPU command has used yet on the transfer queue. The next graphics
+    /// submission waits for the copy, work submitted before runs concurrently with it.
+    void UploadOnTransferQueue(Buffer& buffer, std::span<vk::BufferCopy> copies,
+                               size_t total_size_bytes);
+
     bool SynchronizeBufferFromImage(Buffer& buffer, VAddr device_addr, u32 size);
 
     void WriteDataBuffer(Buffer& buffer, VAddr address, const void* value, u32 num_bytes);
 
     void TouchBuffer(const Buffer& buffer);
 
+    /// Derives the eviction thresholds from the memory the device can use.
+    void UpdateGcThresholds(s64 device_local_memory);
+
+    /// Returns a buffer aliasing the guest memory of the region, if the region is not written by
+    /// the GPU and an upload would be needed otherwise.
+    Buffer* ObtainHostBuffer(VAddr device_addr, u32 size);
+
     void DeleteBuffer(BufferId buffer_id);
 
     const Vulkan::Instance& instance;
     Vulkan::Scheduler& scheduler;
+    std::unique_ptr<Vulkan::Scheduler> transfer_scheduler;
     AmdGpu::Liverpool* liverpool;
     Core::MemoryManager* memory;
     TextureCache& texture_cache;
@@ -213,14 +265,21 @@ private:
     Buffer gds_buffer;
     Buffer bda_pagetable_buffer;
     Common::SlotVector<Buffer> slot_buffers;
+    tsl::robin_map<u64, std::unique_ptr<Buffer>> host_buffers; ///< Null if the import failed
     u64 total_used_memory = 0;
     u64 trigger_gc_memory = 0;
     u64 critical_gc_memory = 0;
     u64 gc_tick = 0;
-    Common::LeastRecentlyUsedCache<BufferId, u64> lru_cache;
+    Common::GenerationalLruCache<BufferId, u64> lru_cache;
     RangeSet gpu_modified_ranges;
+    tsl::robin_set<u64> readback_pages; ///< Pages read by the CPU since the previous submission
+    tsl::robin_set<u64> predicted_readback_pages;
+    u64 speculative_readback_tick = 0; ///< Tick of the pending prefetch, zero if there is none
+    std::vector<std::pair<VAddr, u64>> prefetch_overwrites; ///< GPU writes after the prefetch
     SplitRangeMap<BufferId> buffer_ranges;
     PageTable page_table;
+    BufferCacheStats stats{};
+    std::unique_ptr<BufferCacheStatsLog> stats_log;
 };
 
 } // namespace VideoCore
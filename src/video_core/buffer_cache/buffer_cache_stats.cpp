@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <fmt/format.h>
+
+#include "common/path_util.h"
+#include "core/debug_state.h"
+#include "video_core/buffer_cache/buffer_cache_stats.h"
+
+namespace VideoCore {
+
+BufferCacheStatsLog::BufferCacheStatsLog() {
+    using namespace Common::FS;
+    csv_file.Open(GetUserPath(PathType::LogDir) / "buffer_cache_stats.csv", FileAccessMode::Write,
+                  FileType::TextFile);
+    csv_file.WriteString(std::string_view{
+        "frame,buffers,total_bytes,created,deleted,joins,stream_leaps,max_stream_score,"
+        "upload_copies,upload_bytes,image_syncs,download_bytes\n"});
+}
+
+BufferCacheStatsLog::~BufferCacheStatsLog() = default;
+
+void BufferCacheStatsLog::EndFrame(BufferCacheStats& stats) {
+    {
+        std::scoped_lock lock{DebugState.buffer_cache_stats_mutex};
+        DebugState.buffer_cache_stats = stats;
+    }
+    csv_file.WriteString(fmt::format("{},{},{},{},{},{},{},{},{},{},{},{}\n", stats.frame,
+                                     stats.num_buffers, stats.total_bytes, stats.buffers_created,
+                                     stats.buffers_deleted, stats.overlaps_joined,
+                                     stats.stream_leaps, stats.max_stream_score,
+                                     stats.upload_copies, stats.upload_bytes, stats.image_syncs,
+                                     stats.download_bytes));
+
+    // Buffer count and size describe the cache state and carry over to the next frame
+    stats = {
+        .frame = stats.frame + 1,
+        .num_buffers = stats.num_buffers,
+        .total_bytes = stats.total_bytes,
+    };
+}
+
+} // namespace VideoCore
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "common/io_file.h"
+#include "common/types.h"
+
+namespace VideoCore {
+
+/// Buffer cache activity during one Gnm frame. The buffer cache is only used by the GPU thread,
+/// so the counters are plain integers that are copied out once per frame.
+struct BufferCacheStats {
+    u64 frame{};
+    u64 num_buffers{}; ///< Buffers registered at the end of the frame
+    u64 total_bytes{}; ///< Page aligned size of the registered buffers
+    u64 buffers_created{};
+    u64 buffers_deleted{};
+    u64 overlaps_joined{};
+    u64 stream_leaps{}; ///< Buffers enlarged because their region is used as a stream buffer
+    u64 max_stream_score{};
+    u64 upload_copies{};
+    u64 upload_bytes{}; ///< CPU modified bytes synchronized to the GPU
+    u64 image_syncs{};  ///< Texel buffers filled from the image aliasing them
+    u64 download_bytes{};
+};
+
+/// Publishes the buffer cache counters of every frame to the debug state and appends them to the
+/// CSV log, so that builds and thresholds can be compared per title.
+class BufferCacheStatsLog {
+public:
+    BufferCacheStatsLog();
+    ~BufferCacheStatsLog();
+
+    /// Reports the frame and resets the per-frame counters of stats.
+    void EndFrame(BufferCacheStats& stats);
+
+private:
+    Common::FS::IOFile csv_file;
+};
+
+} // namespace VideoCore
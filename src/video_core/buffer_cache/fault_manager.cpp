@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+
 #include "common/div_ceil.h"
 #include "video_core/buffer_cache/buffer_cache.h"
 #include "video_core/buffer_cache/fault_manager.h"
@@ -24,6 +26,8 @@ FaultManager::FaultManager(const Vulkan::Instance& instance, Vulkan::Scheduler&
       fault_buffer{instance, scheduler, MemoryUsage::DeviceLocal, 0, AllFlags, fault_buffer_size},
       download_buffer{instance, scheduler, MemoryUsage::Download,
                       0,        AllFlags,  MaxPendingFaults * PageFaultAreaSize} {
+    // Run lengths of up to 32 pages are packed in the low bits of the faulting page addresses
+    ASSERT(caching_pagesize > 32);
     const auto device = instance.GetDevice();
     Vulkan::SetObjectName(device, fault_buffer.Handle(), "Fault Buffer");
 
@@ -157,16 +161,29 @@ void FaultManager::ProcessFaultBuffer() {
     scheduler.DeferOperation([this, mapped, area = current_area] {
         fault_ranges.Clear();
         const u64* fault_buf = std::bit_cast<const u64*>(mapped);
-        const u32 fault_count = fault_buf[0];
+        // The counter keeps going past the entries the shader could store
+        const u32 fault_count =
+            std::min<u32>(static_cast<u32>(fault_buf[0]), static_cast<u32>(MaxPageFaults - 1));
+        u32 fault_pages = 0;
         for (u32 i = 1; i <= fault_count; ++i) {
-            fault_ranges.Add(fault_buf[i], caching_pagesize);
-            LOG_INFO(Render_Vulkan, "Accessed non-GPU cached memory at {:#x}", fault_buf[i]);
+            const VAddr start = fault_buf[i] & ~(caching_pagesize - 1);
+            const u32 run = static_cast<u32>(fault_buf[i] & (caching_pagesize - 1));
+            fault_ranges.Add(start, run * caching_pagesize);
+            fault_pages += run;
+            LOG_INFO(Render_Vulkan, "Accessed non-GPU cached memory at {:#x} ({} pages)", start,
+                     run);
         }
+        u32 num_found = 0;
         fault_ranges.ForEach([&](VAddr start, VAddr end) {
             ASSERT_MSG((end - start) <= std::numeric_limits<u32>::max(),
                        "Buffer size is too large");
             buffer_cache.FindBuffer(start, static_cast<u32>(end - start));
+            ++num_found;
         });
+        num_passes.fetch_add(1, std::memory_order_relaxed);
+        num_ranges.fetch_add(fault_count, std::memory_order_relaxed);
+        num_pages.fetch_add(fault_pages, std::memory_order_relaxed);
+        num_buffers.fetch_add(num_found, std::memory_order_relaxed);
         fault_areas[area] = 0;
     });
 
@@ -174,4 +191,13 @@ void FaultManager::ProcessFaultBuffer() {
     current_area %= MaxPendingFaults;
 }
 
+FaultManager::Stats FaultManager::ConsumeStats() const {
+    return {
+        .passes = num_passes.exchange(0, std::memory_order_relaxed),
+        .ranges = num_ranges.exchange(0, std::memory_order_relaxed),
+        .pages = num_pages.exchange(0, std::memory_order_relaxed),
+        .buffers = num_buffers.exchange(0, std::memory_order_relaxed),
+    };
+}
+
 } // namespace VideoCore
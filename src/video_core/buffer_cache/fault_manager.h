@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "video_core/buffer_cache/buffer.h"
 #include "video_core/buffer_cache/range_set.h"
 
@@ -14,6 +16,13 @@ class FaultManager {
     static constexpr size_t MaxPendingFaults = 8;
 
 public:
+    struct Stats {
+        u32 passes;  ///< Fault buffers processed
+        u32 ranges;  ///< Runs of adjacent faulting pages read back
+        u32 pages;   ///< Faulting pages
+        u32 buffers; ///< Buffers looked up or created for the faulting ranges
+    };
+
     explicit FaultManager(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler,
                           BufferCache& buffer_cache, u32 caching_pagebits, u64 caching_num_pages);
 
@@ -23,6 +32,9 @@ public:
 
     void ProcessFaultBuffer();
 
+    /// Returns the counters accumulated since the last call and resets them.
+    Stats ConsumeStats() const;
+
 private:
     Vulkan::Scheduler& scheduler;
     BufferCache& buffer_cache;
@@ -37,6 +49,10 @@ private:
     vk::UniqueDescriptorSetLayout fault_process_desc_layout;
     vk::UniquePipeline fault_process_pipeline;
     vk::UniquePipelineLayout fault_process_pipeline_layout;
+    mutable std::atomic<u32> num_passes{};
+    mutable std::atomic<u32> num_ranges{};
+    mutable std::atomic<u32> num_pages{};
+    mutable std::atomic<u32> num_buffers{};
 };
 
 } // namespace VideoCore
@@ -43,6 +43,7 @@ public:
 
     /// Mark region as CPU modified, notifying the device_tracker about this change
     void MarkRegionAsCpuModified(VAddr dirty_cpu_addr, u64 query_size) {
+        const PageManager::ProtectBatch batch{*tracker};
         IteratePages<false>(dirty_cpu_addr, query_size,
                             [](RegionManager* manager, u64 offset, size_t size) {
                                 std::scoped_lock lk{manager->lock};
@@ -51,8 +52,20 @@ public:
                             });
     }
 
+    /// Mark region as modified from the host GPU
+    void MarkRegionAsGpuModified(VAddr dirty_cpu_addr, u64 query_size) noexcept {
+        const PageManager::ProtectBatch batch{*tracker};
+        IteratePages<false>(dirty_cpu_addr, query_size,
+                            [](RegionManager* manager, u64 offset, size_t size) {
+                                std::scoped_lock lk{manager->lock};
+                                manager->template ChangeRegionState<Type::GPU, true>(
+                                    manager->GetCpuAddr() + offset, size);
+                            });
+    }
+
     /// Unmark region as modified from the host GPU
     void UnmarkRegionAsGpuModified(VAddr dirty_cpu_addr, u64 query_size) noexcept {
+        const PageManager::ProtectBatch batch{*tracker};
         IteratePages<false>(dirty_cpu_addr, query_size,
                             [](RegionManager* manager, u64 offset, size_t size) {
                                 std::scoped_lock lk{manager->lock};
@@ -63,44 +76,44 @@ public:
 
     /// Removes all protection from a page and ensures GPU data has been flushed if requested
     void InvalidateRegion(VAddr cpu_addr, u64 size, auto&& on_flush) noexcept {
-        IteratePages<false>(
-            cpu_addr, size, [&on_flush](RegionManager* manager, u64 offset, size_t size) {
-                const bool should_flush = [&] {
-                    // Perform both the GPU modification check and CPU state change with the lock
-                    // in case we are racing with GPU thread trying to mark the page as GPU
-                    // modified. If we need to flush the flush function is going to perform CPU
-                    // state change.
-                    std::scoped_lock lk{manager->lock};
-                    if (Config::readbacks() &&
-                        manager->template IsRegionModified<Type::GPU>(offset, size)) {
-                        return true;
+        bool needs_flush = false;
+        {
+            // Unprotect the pages before flushing, the flush writes back into them
+            const PageManager::ProtectBatch batch{*tracker};
+            IteratePages<false>(
+                cpu_addr, size, [&needs_flush](RegionManager* manager, u64 offset, size_t size) {
+                    if (ShouldFlushRegion(manager, offset, size)) {
+                        needs_flush = true;
                     }
-                    manager->template ChangeRegionState<Type::CPU, true>(
-                        manager->GetCpuAddr() + offset, size);
-                    return false;
-                }();
-                if (should_flush) {
-                    on_flush();
-                }
-            });
+                });
+        }
+        if (needs_flush) {
+            on_flush();
+        }
     }
 
     /// Call 'func' for each CPU modified range and unmark those pages as CPU modified
     void ForEachUploadRange(VAddr query_cpu_range, u64 query_size, bool is_written, auto&& func,
                             auto&& on_upload) {
-        IteratePages<true>(query_cpu_range, query_size,
-                           [&func, is_written](RegionManager* manager, u64 offset, size_t size) {
-                               manager->lock.lock();
-                               manager->template ForEachModifiedRange<Type::CPU, true>(
-                                   manager->GetCpuAddr() + offset, size, func);
-                               if (!is_written) {
-                                   manager->lock.unlock();
-                               }
-                           });
+        {
+            // Pages must be protected again before on_upload reads them
+            const PageManager::ProtectBatch batch{*tracker};
+            IteratePages<true>(query_cpu_range, query_size,
+                               [&func, is_written](RegionManager* manager, u64 offset,
+                                                   size_t size) {
+                                   manager->lock.lock();
+                                   manager->template ForEachModifiedRange<Type::CPU, true>(
+                                       manager->GetCpuAddr() + offset, size, func);
+                                   if (!is_written) {
+                                       manager->lock.unlock();
+                                   }
+                               });
+        }
         on_upload();
         if (!is_written) {
             return;
         }
+        const PageManager::ProtectBatch batch{*tracker};
         IteratePages<false>(query_cpu_range, query_size,
                             [&func, is_written](RegionManager* manager, u64 offset, size_t size) {
                                 manager->template ChangeRegionState<Type::GPU, true>(
@@ -112,6 +125,7 @@ public:
     /// Call 'func' for each GPU modified range and unmark those pages as GPU modified
     template <bool clear>
     void ForEachDownloadRange(VAddr query_cpu_range, u64 query_size, auto&& func) {
+        const PageManager::ProtectBatch batch{*tracker};
         IteratePages<false>(query_cpu_range, query_size,
                             [&func](RegionManager* manager, u64 offset, size_t size) {
                                 std::scoped_lock lk{manager->lock};
@@ -121,6 +135,20 @@ public:
     }
 
 private:
+    /// Marks the region as CPU modified unless it holds GPU data that has to be flushed first
+    static bool ShouldFlushRegion(RegionManager* manager, u64 offset, size_t size) {
+        // Perform both the GPU modification check and CPU state change with the lock in case we
+        // are racing with GPU thread trying to mark the page as GPU modified. If we need to
+        // flush the flush function is going to perform CPU state change.
+        std::scoped_lock lk{manager->lock};
+        if (Config::readbacks() && manager->template IsRegionModified<Type::GPU>(offset, size)) {
+            return true;
+        }
+        manager->template ChangeRegionState<Type::CPU, true>(manager->GetCpuAddr() + offset,
+                                                             size);
+        return false;
+    }
+
     /**
      * @brief IteratePages Iterates L2 word manager page table.
      * @param cpu_address Start byte cpu address
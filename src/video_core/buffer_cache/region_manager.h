@@ -119,8 +119,14 @@ public:
             return;
         }
 
+        // Walk the runs in place before clearing them instead of scanning a masked copy
         RegionBits& bits = GetRegionBits<type>();
-        RegionBits mask(bits, start_page, end_page);
+        for (auto range = bits.FirstRangeFrom(start_page); range.first < end_page;
+             range = bits.FirstRangeFrom(range.second)) {
+            const size_t end = std::min<size_t>(range.second, end_page);
+            func(cpu_addr + range.first * TRACKER_BYTES_PER_PAGE,
+                 (end - range.first) * TRACKER_BYTES_PER_PAGE);
+        }
 
         if constexpr (clear) {
             bits.UnsetRange(start_page, end_page);
@@ -130,10 +136,6 @@ public:
                 UpdateProtection<false, true>();
             }
         }
-
-        for (const auto& [start, end] : mask) {
-            func(cpu_addr + start * TRACKER_BYTES_PER_PAGE, (end - start) * TRACKER_BYTES_PER_PAGE);
-        }
     }
 
     /**
@@ -152,9 +154,7 @@ public:
             return false;
         }
 
-        const RegionBits& bits = GetRegionBits<type>();
-        RegionBits test(bits, start_page, end_page);
-        return test.Any();
+        return GetRegionBits<type>().AnyInRange(start_page, end_page);
     }
 
     LockType lock;
@@ -1,23 +1,31 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "common/alignment.h"
 #include "common/config.h"
 #include "common/elf_info.h"
+#include "common/file_lock.h"
 #include "common/io_file.h"
+#include "common/mapped_file.h"
 #include "common/polyfill_thread.h"
 #include "common/thread.h"
+#include "core/thread.h"
 
 #include "video_core/cache_storage.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_pipeline_cache.h"
 
 #include <miniz.h>
+#include <tsl/robin_map.h>
+#include <xxhash.h>
 
 #include <condition_variable>
+#include <cstring>
 #include <functional>
 #include <future>
 #include <mutex>
 #include <queue>
+#include <random>
 
 namespace {
 
@@ -30,12 +38,210 @@ std::mutex m_request{};
 mz_zip_archive zip_ar{};
 bool ar_is_read_only{true};
 
+// Pack file layout: a FileHeader followed by records. Each record is a RecordHeader, the blob name
+// and the blob data, with name and data padded to RecordAlignment so data can be read in place as
+// an array of words. Records are only ever appended; when the same blob is stored again the last
+// record wins, and stale records are dropped by compaction when the cache is opened.
+//
+// Instances running the same game share the pack: each one maps it read-only and appends its
+// new records to a delta pack of its own, named <serial>.<id>.delta. Every instance holds the
+// lock file shared while it runs, the one that gets it exclusively is alone and is the only
+// one to compact the pack or merge the deltas into it.
+constexpr u32 PackMagic = 0x4B435053; // SPCK
+constexpr u32 PackVersion = 1;
+constexpr u32 RecordMagic = 0x424F4C42; // BLOB
+constexpr size_t RecordAlignment = 8;
+// Compact the pack on open once more than this share of it is taken by stale records.
+constexpr size_t CompactionThresholdPercent = 50;
+
+struct PackFileHeader {
+    u32 magic;
+    u32 version;
+};
+
+struct PackRecordHeader {
+    u32 magic;
+    Storage::BlobType type;
+    u64 name_hash;
+    u32 name_size;
+    u32 data_size;
+};
+static_assert(sizeof(PackRecordHeader) % RecordAlignment == 0);
+
+struct PackEntry {
+    size_t record_offset;
+    size_t record_size;
+};
+
+constexpr size_t NumBlobTypes = static_cast<size_t>(Storage::BlobType::Count);
+using PackIndex = std::array<tsl::robin_map<u64, PackEntry>, NumBlobTypes>;
+
+Common::FS::MappedFile pack_file{};
+Common::FS::IOFile pack_writer{};
+Common::FS::FileLock pack_lock{};
+std::filesystem::path delta_path{};
+PackIndex pack_index{};
+
+u64 HashBlobName(std::string_view name) {
+    return XXH3_64bits(name.data(), name.size());
+}
+
+const PackRecordHeader& GetRecordHeader(const PackEntry& entry) {
+    return *reinterpret_cast<const PackRecordHeader*>(pack_file.View().data() +
+                                                      entry.record_offset);
+}
+
+std::string_view GetRecordName(const PackEntry& entry) {
+    const auto& header = GetRecordHeader(entry);
+    const auto name = pack_file.View(entry.record_offset + sizeof(PackRecordHeader),
+                                     header.name_size);
+    return {reinterpret_cast<const char*>(name.data()), name.size()};
+}
+
+std::span<const u8> GetRecordData(const PackEntry& entry) {
+    const auto& header = GetRecordHeader(entry);
+    const size_t data_offset = entry.record_offset + sizeof(PackRecordHeader) +
+                               Common::AlignUp(size_t{header.name_size}, RecordAlignment);
+    return pack_file.View(data_offset, header.data_size);
+}
+
+/// Walks the records of a mapped pack, filling the index. Returns the size of the valid part of
+/// the file, anything after it is a partially written record.
+size_t ScanPack(std::span<const u8> view, PackIndex& index, size_t& live_size) {
+    for (auto& map : index) {
+        map.clear();
+    }
+    live_size = sizeof(PackFileHeader);
+
+    size_t offset = sizeof(PackFileHeader);
+    while (offset + sizeof(PackRecordHeader) <= view.size()) {
+        PackRecordHeader header;
+        std::memcpy(&header, view.data() + offset, sizeof(header));
+        if (header.magic != RecordMagic || header.type >= Storage::BlobType::Count) {
+            break;
+        }
+        const size_t record_size = sizeof(PackRecordHeader) +
+                                   Common::AlignUp(size_t{header.name_size}, RecordAlignment) +
+                                   Common::AlignUp(size_t{header.data_size}, RecordAlignment);
+        if (record_size > view.size() - offset) {
+            break;
+        }
+
+        auto& map = index[static_cast<size_t>(header.type)];
+        const auto [it, is_new] = map.try_emplace(header.name_hash, PackEntry{offset, record_size});
+        if (!is_new) {
+            live_size -= it->second.record_size;
+            it.value() = PackEntry{offset, record_size};
+        }
+        live_size += record_size;
+        offset += record_size;
+    }
+    return offset;
+}
+
+/// Rewrites the pack keeping only the latest record of every blob.
+bool CompactPack(const std::filesystem::path& path, const PackIndex& index) {
+    using namespace Common::FS;
+    auto tmp_path = path;
+    tmp_path.replace_extension(".pack.tmp");
+    {
+        const auto out = IOFile{tmp_path, FileAccessMode::Create};
+        if (!out.IsOpen()) {
+            return false;
+        }
+        out.WriteObject(PackFileHeader{PackMagic, PackVersion});
+        for (const auto& map : index) {
+            for (const auto& [_, entry] : map) {
+                const auto record = pack_file.View(entry.record_offset, entry.record_size);
+                out.WriteSpan(record);
+            }
+        }
+    }
+    pack_file.Close();
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        LOG_ERROR(Render, "Failed to replace pipeline cache pack: {}", ec.message());
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+/// Appends the records of the deltas left by other instances to the pack and removes them.
+/// Returns whether any record was added. Only called while no other instance is running.
+bool MergePackDeltas(const std::filesystem::path& path) {
+    using namespace Common::FS;
+    const auto prefix = path.stem().string() + ".";
+    std::vector<std::filesystem::path> deltas;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator{path.parent_path(), ec}) {
+        const auto& delta = entry.path();
+        if (delta.extension() == ".delta" && delta.filename().string().starts_with(prefix)) {
+            deltas.push_back(delta);
+        }
+    }
+    if (deltas.empty()) {
+        return false;
+    }
+
+    const auto out = IOFile{path, FileAccessMode::Append};
+    if (!out.IsOpen()) {
+        return false;
+    }
+    size_t num_records{};
+    for (const auto& delta : deltas) {
+        {
+            // The mapping is released before the delta is removed
+            const MappedFile file{delta};
+            const auto view = file.View();
+            PackFileHeader header{};
+            if (view.size() >= sizeof(header)) {
+                std::memcpy(&header, view.data(), sizeof(header));
+            }
+            if (header.magic == PackMagic && header.version == PackVersion) {
+                PackIndex index{};
+                size_t live_size{};
+                const size_t valid_size = ScanPack(view, index, live_size);
+                out.WriteSpan(view.subspan(sizeof(header), valid_size - sizeof(header)));
+                for (const auto& map : index) {
+                    num_records += map.size();
+                }
+            }
+        }
+        std::filesystem::remove(delta, ec);
+    }
+    LOG_INFO(Render, "Merged {} records from {} pipeline cache deltas", num_records,
+             deltas.size());
+    return num_records != 0;
+}
+
+void WritePackRecord(const Storage::BlobType type, const std::string& name,
+                     std::span<const u8> data) {
+    static constexpr std::array<u8, RecordAlignment> Padding{};
+    const PackRecordHeader header = {
+        .magic = RecordMagic,
+        .type = type,
+        .name_hash = HashBlobName(name),
+        .name_size = static_cast<u32>(name.size()),
+        .data_size = static_cast<u32>(data.size()),
+    };
+    pack_writer.WriteObject(header);
+    pack_writer.WriteString(name);
+    pack_writer.WriteRaw(Padding.data(), Common::AlignUp(name.size(), RecordAlignment) -
+                                             name.size());
+    pack_writer.WriteSpan(data);
+    pack_writer.WriteRaw(Padding.data(), Common::AlignUp(data.size(), RecordAlignment) -
+                                             data.size());
+}
+
 } // namespace
 
 namespace Storage {
 
 void ProcessIO(const std::stop_token& stoken) {
     Common::SetCurrentThreadName("shadPS4:PipelineCacheIO");
+    Core::KeepCurrentThreadOffGuestCores();
 
     while (!stoken.stop_requested()) {
         {
@@ -87,6 +293,119 @@ constexpr std::string GetBlobFileExtension(BlobType type) {
     }
 }
 
+void DataBase::OpenPack() {
+    using namespace Common::FS;
+    const auto& game_info = Common::ElfInfo::Instance();
+    const auto cache_dir = GetUserPath(PathType::CacheDir);
+    if (!std::filesystem::exists(cache_dir)) {
+        std::filesystem::create_directories(cache_dir);
+    }
+    cache_path =
+        cache_dir / std::filesystem::path{game_info.GameSerial()}.replace_extension(".pack");
+
+    auto lock_path = cache_path;
+    lock_path += ".lock";
+    // Without a lock file the pack is owned, as when instances didn't share it
+    const bool is_alone = !pack_lock.Open(lock_path) || pack_lock.TryLockExclusive();
+    if (!is_alone) {
+        OpenSharedPack();
+    } else {
+        OpenOwnedPack();
+        if (MergePackDeltas(cache_path) && pack_file.Open(cache_path)) {
+            size_t live_size{};
+            ScanPack(pack_file.View(), pack_index, live_size);
+        }
+    }
+    // Other instances wait for this before they look at the pack
+    pack_lock.LockShared();
+
+    std::random_device rd;
+    const u64 instance_id = (u64{rd()} << 32) | rd();
+    delta_path = cache_path;
+    delta_path.replace_extension(fmt::format("{:016x}.delta", instance_id));
+    IOFile{delta_path, FileAccessMode::Create}.WriteObject(PackFileHeader{PackMagic, PackVersion});
+    pack_writer.Open(delta_path, FileAccessMode::Append);
+    LOG_INFO(Render, "Opened pipeline cache pack {} with {} pipelines{}", cache_path.string(),
+             pack_index[static_cast<size_t>(BlobType::PipelineKey)].size(),
+             is_alone ? "" : ", shared with running instances");
+}
+
+void DataBase::OpenSharedPack() {
+    pack_file.Close();
+    for (auto& map : pack_index) {
+        map.clear();
+    }
+    if (!pack_file.Open(cache_path)) {
+        return;
+    }
+    // The instance that owns the pack may be appending merged records, they are ignored
+    const auto view = pack_file.View();
+    PackFileHeader header{};
+    if (view.size() >= sizeof(header)) {
+        std::memcpy(&header, view.data(), sizeof(header));
+    }
+    if (header.magic != PackMagic || header.version != PackVersion) {
+        LOG_WARNING(Render, "Shared pipeline cache pack {} has an unknown format, ignoring it",
+                    cache_path.string());
+        pack_file.Close();
+        return;
+    }
+    size_t live_size{};
+    ScanPack(view, pack_index, live_size);
+}
+
+void DataBase::OpenOwnedPack() {
+    using namespace Common::FS;
+    size_t valid_size{};
+    if (pack_file.Open(cache_path)) {
+        const auto view = pack_file.View();
+        PackFileHeader header{};
+        if (view.size() >= sizeof(header)) {
+            std::memcpy(&header, view.data(), sizeof(header));
+        }
+        if (header.magic == PackMagic && header.version == PackVersion) {
+            size_t live_size{};
+            valid_size = ScanPack(view, pack_index, live_size);
+            if ((valid_size - live_size) * 100 > valid_size * CompactionThresholdPercent) {
+                LOG_INFO(Render, "Compacting pipeline cache pack, {} of {} bytes are stale",
+                         valid_size - live_size, valid_size);
+                if (CompactPack(cache_path, pack_index) && pack_file.Open(cache_path)) {
+                    valid_size = ScanPack(pack_file.View(), pack_index, live_size);
+                } else {
+                    valid_size = 0;
+                }
+            }
+        } else {
+            LOG_WARNING(Render, "Pipeline cache pack {} has an unknown format, recreating it",
+                        cache_path.string());
+        }
+    }
+
+    if (valid_size == 0) {
+        pack_file.Close();
+        for (auto& map : pack_index) {
+            map.clear();
+        }
+        const auto file = IOFile{cache_path, FileAccessMode::Create};
+        file.WriteObject(PackFileHeader{PackMagic, PackVersion});
+    } else if (valid_size < pack_file.Size()) {
+        // Drop a record that was cut short, so new records are appended right after the valid
+        // ones. The mapping has to be released first so the file can be truncated on Windows.
+        LOG_WARNING(Render, "Pipeline cache pack has a truncated record, discarding it");
+        pack_file.Close();
+        std::error_code ec;
+        std::filesystem::resize_file(cache_path, valid_size, ec);
+        size_t live_size{};
+        if (!pack_file.Open(cache_path) ||
+            ScanPack(pack_file.View(), pack_index, live_size) != valid_size) {
+            pack_file.Close();
+            for (auto& map : pack_index) {
+                map.clear();
+            }
+        }
+    }
+}
+
 void DataBase::Open() {
     if (opened) {
         return;
@@ -94,8 +413,18 @@ void DataBase::Open() {
 
     const auto& game_info = Common::ElfInfo::Instance();
 
+    if (Config::isPipelineCachePacked()) {
+        backend = StorageBackend::Pack;
+    } else if (Config::isPipelineCacheArchived()) {
+        backend = StorageBackend::Archive;
+    } else {
+        backend = StorageBackend::Directory;
+    }
+
     using namespace Common::FS;
-    if (Config::isPipelineCacheArchived()) {
+    if (backend == StorageBackend::Pack) {
+        OpenPack();
+    } else if (backend == StorageBackend::Archive) {
         mz_zip_zero_struct(&zip_ar);
 
         cache_path = GetUserPath(PathType::CacheDir) /
@@ -128,21 +457,44 @@ void DataBase::Close() {
     io_worker.request_stop();
     io_worker.join();
 
-    if (Config::isPipelineCacheArchived()) {
+    if (backend == StorageBackend::Archive) {
         mz_zip_writer_finalize_archive(&zip_ar);
         mz_zip_writer_end(&zip_ar);
+    } else if (backend == StorageBackend::Pack) {
+        pack_writer.Close();
+        pack_file.Close();
+        for (auto& map : pack_index) {
+            map.clear();
+        }
+        std::error_code ec;
+        if (std::filesystem::file_size(delta_path, ec) <= sizeof(PackFileHeader)) {
+            std::filesystem::remove(delta_path, ec);
+        }
+        // The last instance to close merges right away, otherwise the next one to start does
+        if (pack_lock.TryLockExclusive()) {
+            MergePackDeltas(cache_path);
+        }
+        pack_lock.Close();
     }
+    opened = false;
 
     LOG_INFO(Render, "Cache dumped");
 }
 
 template <typename T>
-bool WriteVector(const BlobType type, std::filesystem::path&& path_, std::vector<T>&& v) {
+bool WriteVector(const StorageBackend backend, const BlobType type, std::filesystem::path&& path_,
+                 std::vector<T>&& v) {
     {
         auto request = std::packaged_task<void()>{[=]() {
+            if (backend == StorageBackend::Pack) {
+                const auto bytes =
+                    std::span{reinterpret_cast<const u8*>(v.data()), v.size() * sizeof(T)};
+                WritePackRecord(type, path_.string(), bytes);
+                return;
+            }
             auto path{path_};
             path.replace_extension(GetBlobFileExtension(type));
-            if (Config::isPipelineCacheArchived()) {
+            if (backend == StorageBackend::Archive) {
                 ASSERT_MSG(!ar_is_read_only,
                            "The archive is read-only. Did you forget to call `FinishPreload`?");
                 if (!mz_zip_writer_add_mem(&zip_ar, path.string().c_str(), v.data(),
@@ -165,11 +517,27 @@ bool WriteVector(const BlobType type, std::filesystem::path&& path_, std::vector
     return true;
 }
 
+std::span<const u8> LoadPackView(BlobType type, const std::string& name) {
+    const auto& map = pack_index[static_cast<size_t>(type)];
+    const auto it = map.find(HashBlobName(name));
+    if (it == map.end() || GetRecordName(it->second) != name) {
+        return {};
+    }
+    return GetRecordData(it->second);
+}
+
 template <typename T>
-void LoadVector(BlobType type, std::filesystem::path& path, std::vector<T>& v) {
+void LoadVector(const StorageBackend backend, BlobType type, std::filesystem::path& path,
+                std::vector<T>& v) {
     using namespace Common::FS;
+    if (backend == StorageBackend::Pack) {
+        const auto data = LoadPackView(type, path.string());
+        v.resize(data.size() / sizeof(T));
+        std::memcpy(v.data(), data.data(), v.size() * sizeof(T));
+        return;
+    }
     path.replace_extension(GetBlobFileExtension(type));
-    if (Config::isPipelineCacheArchived()) {
+    if (backend == StorageBackend::Archive) {
         int index{-1};
         index = mz_zip_reader_locate_file(&zip_ar, path.string().c_str(), nullptr, 0);
         if (index < 0) {
@@ -192,8 +560,9 @@ bool DataBase::Save(BlobType type, const std::string& name, std::vector<u8>&& da
         return false;
     }
 
-    auto path = Config::isPipelineCacheArchived() ? std::filesystem::path{name} : cache_path / name;
-    return WriteVector(type, std::move(path), std::move(data));
+    auto path =
+        backend != StorageBackend::Directory ? std::filesystem::path{name} : cache_path / name;
+    return WriteVector(backend, type, std::move(path), std::move(data));
 }
 
 bool DataBase::Save(BlobType type, const std::string& name, std::vector<u32>&& data) {
@@ -201,8 +570,9 @@ bool DataBase::Save(BlobType type, const std::string& name, std::vector<u32>&& d
         return false;
     }
 
-    auto path = Config::isPipelineCacheArchived() ? std::filesystem::path{name} : cache_path / name;
-    return WriteVector(type, std::move(path), std::move(data));
+    auto path =
+        backend != StorageBackend::Directory ? std::filesystem::path{name} : cache_path / name;
+    return WriteVector(backend, type, std::move(path), std::move(data));
 }
 
 void DataBase::Load(BlobType type, const std::string& name, std::vector<u8>& data) {
@@ -210,8 +580,9 @@ void DataBase::Load(BlobType type, const std::string& name, std::vector<u8>& dat
         return;
     }
 
-    auto path = Config::isPipelineCacheArchived() ? std::filesystem::path{name} : cache_path / name;
-    return LoadVector(type, path, data);
+    auto path =
+        backend != StorageBackend::Directory ? std::filesystem::path{name} : cache_path / name;
+    return LoadVector(backend, type, path, data);
 }
 
 void DataBase::Load(BlobType type, const std::string& name, std::vector<u32>& data) {
@@ -219,13 +590,28 @@ void DataBase::Load(BlobType type, const std::string& name, std::vector<u32>& da
         return;
     }
 
-    auto path = Config::isPipelineCacheArchived() ? std::filesystem::path{name} : cache_path / name;
-    return LoadVector(type, path, data);
+    auto path =
+        backend != StorageBackend::Directory ? std::filesystem::path{name} : cache_path / name;
+    return LoadVector(backend, type, path, data);
+}
+
+std::span<const u8> DataBase::LoadView(BlobType type, const std::string& name) {
+    if (!opened || backend != StorageBackend::Pack) {
+        return {};
+    }
+    return LoadPackView(type, name);
 }
 
 void DataBase::ForEachBlob(BlobType type, const std::function<void(std::vector<u8>&& data)>& func) {
+    if (backend == StorageBackend::Pack) {
+        for (const auto& [_, entry] : pack_index[static_cast<size_t>(type)]) {
+            const auto view = GetRecordData(entry);
+            func(std::vector<u8>{view.begin(), view.end()});
+        }
+        return;
+    }
     const auto& ext = GetBlobFileExtension(type);
-    if (Config::isPipelineCacheArchived()) {
+    if (backend == StorageBackend::Archive) {
         const auto num_files = mz_zip_reader_get_num_files(&zip_ar);
         for (int index = 0; index < num_files; ++index) {
             std::array<char, MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE> file_name{};
@@ -255,7 +641,7 @@ void DataBase::ForEachBlob(BlobType type, const std::function<void(std::vector<u
 }
 
 void DataBase::FinishPreload() {
-    if (Config::isPipelineCacheArchived()) {
+    if (backend == StorageBackend::Archive) {
         mz_zip_writer_init_from_reader(&zip_ar, cache_path.string().c_str());
         ar_is_read_only = false;
     }
@@ -8,6 +8,7 @@
 #include "common/types.h"
 
 #include <functional>
+#include <span>
 #include <thread>
 #include <vector>
 
@@ -18,6 +19,14 @@ enum class BlobType : u32 {
     ShaderBinary,
     PipelineKey,
     ShaderProfile,
+
+    Count,
+};
+
+enum class StorageBackend : u32 {
+    Directory, ///< One file per blob in the cache directory
+    Archive,   ///< Compressed zip archive
+    Pack,      ///< Append-only pack file, memory mapped and indexed on open, shared by instances
 };
 
 class DataBase {
@@ -39,11 +48,24 @@ public:
     void Load(BlobType type, const std::string& name, std::vector<u8>& data);
     void Load(BlobType type, const std::string& name, std::vector<u32>& data);
 
+    /// Returns a view of the blob without copying it. Only the pack backend supports it, other
+    /// backends return an empty span. The view stays valid until the database is closed.
+    std::span<const u8> LoadView(BlobType type, const std::string& name);
+
     void ForEachBlob(BlobType type, const std::function<void(std::vector<u8>&& data)>& func);
 
+    [[nodiscard]] StorageBackend GetBackend() const {
+        return backend;
+    }
+
 private:
+    void OpenPack();
+    void OpenOwnedPack();
+    void OpenSharedPack();
+
     std::jthread io_worker{};
     std::filesystem::path cache_path{};
+    StorageBackend backend{};
     bool opened{};
 };
 
@@ -3,15 +3,20 @@
 
 #pragma once
 
+#include <array>
+#include <memory>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
-#include "common/object_pool.h"
+#include "common/assert.h"
 #include "common/types.h"
+#include "common/virtual_buffer.h"
 
 namespace VideoCore {
 
+/// Second level pages live at fixed offsets of a single reservation, so pages covering nearby
+/// addresses are adjacent in host memory and can share huge pages.
 template <class Traits>
 class MultiLevelPageTable final {
     using Entry = typename Traits::Entry;
@@ -22,13 +27,26 @@ class MultiLevelPageTable final {
     static constexpr size_t FirstLevelShift = AddressSpaceBits - FirstLevelBits;
     static constexpr size_t SecondLevelBits = FirstLevelShift - PageBits;
     static constexpr size_t NumEntriesPerL1Page = 1ULL << SecondLevelBits;
+    static constexpr size_t NumL1Pages = 1ULL << FirstLevelBits;
 
     using L1Page = std::array<Entry, NumEntriesPerL1Page>;
 
 public:
-    explicit MultiLevelPageTable() : first_level_map{1ULL << FirstLevelBits, nullptr} {}
+    explicit MultiLevelPageTable(bool huge_pages = false)
+        : storage{NumL1Pages * sizeof(L1Page), huge_pages}, first_level_map(NumL1Pages, nullptr) {
+        ASSERT_MSG(storage.Size() != 0, "Failed to reserve page table memory");
+    }
+
+    ~MultiLevelPageTable() noexcept {
+        for (L1Page* page : first_level_map) {
+            if (page) {
+                std::destroy_at(page);
+            }
+        }
+    }
 
-    ~MultiLevelPageTable() noexcept = default;
+    MultiLevelPageTable(const MultiLevelPageTable&) = delete;
+    MultiLevelPageTable& operator=(const MultiLevelPageTable&) = delete;
 
     [[nodiscard]] Entry* find(size_t page) {
         const size_t l1_page = page >> SecondLevelBits;
@@ -52,7 +70,7 @@ public:
         const size_t l1_page = page >> SecondLevelBits;
         const size_t l2_page = page & (NumEntriesPerL1Page - 1);
         if (!first_level_map[l1_page]) {
-            first_level_map[l1_page] = page_alloc.Create();
+            CreatePage(l1_page);
         }
         return (*first_level_map[l1_page])[l2_page];
     }
@@ -61,14 +79,27 @@ public:
         const size_t l1_page = page >> SecondLevelBits;
         const size_t l2_page = page & (NumEntriesPerL1Page - 1);
         if (!first_level_map[l1_page]) {
-            first_level_map[l1_page] = page_alloc.Create();
+            CreatePage(l1_page);
         }
         return (*first_level_map[l1_page])[l2_page];
     }
 
+    /// Returns the bytes of second level pages created so far.
+    [[nodiscard]] size_t ResidentBytes() const noexcept {
+        return num_resident_pages * sizeof(L1Page);
+    }
+
 private:
-    std::vector<L1Page*> first_level_map{};
-    Common::ObjectPool<L1Page> page_alloc;
+    void CreatePage(size_t l1_page) const {
+        void* memory = storage.Commit(l1_page * sizeof(L1Page), sizeof(L1Page));
+        ASSERT_MSG(memory, "Failed to commit page table memory");
+        first_level_map[l1_page] = std::construct_at(static_cast<L1Page*>(memory));
+        ++num_resident_pages;
+    }
+
+    mutable Common::VirtualBuffer storage;
+    mutable std::vector<L1Page*> first_level_map;
+    mutable size_t num_resident_pages{};
 };
 
 } // namespace VideoCore
@@ -1,10 +1,16 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <vector>
 #include <boost/container/small_vector.hpp>
 #include "common/assert.h"
 #include "common/debug.h"
 #include "common/div_ceil.h"
+#include "common/perf_counters.h"
 #include "common/range_lock.h"
 #include "common/signal_context.h"
 #include "core/memory.h"
@@ -39,6 +45,65 @@ namespace VideoCore {
 constexpr size_t PAGE_SIZE = 4_KB;
 constexpr size_t PAGE_BITS = 12;
 
+namespace {
+
+/**
+ * Faults per page, filled from the fault handlers. Entries are claimed with a compare exchange of
+ * their page and never move, so recording takes no locks and allocates nothing.
+ */
+struct FaultProfile {
+    struct Entry {
+        std::atomic<u64> page; ///< Page number plus one, zero when the entry is free
+        std::atomic<u64> num_faults;
+        std::atomic<u64> num_write_faults;
+        std::atomic<u64> time_ns;
+    };
+    static constexpr size_t NumEntries = 4096;
+    static constexpr size_t MaxProbes = 16;
+
+    std::array<Entry, NumEntries> entries{};
+    std::atomic<u64> num_unrecorded{};
+    std::atomic<bool> enabled{};
+
+    void Record(VAddr addr, bool is_write, u64 time_ns) {
+        const u64 key = (addr >> PAGE_BITS) + 1;
+        // Fibonacci hashing spreads the neighbouring pages of a buffer over the table
+        const size_t index = (key * 0x9E3779B97F4A7C15ULL) >> (64 - 12);
+        static_assert(NumEntries == 1ULL << 12);
+        for (size_t probe = 0; probe < MaxProbes; ++probe) {
+            Entry& entry = entries[(index + probe) % NumEntries];
+            u64 page = entry.page.load(std::memory_order_relaxed);
+            if (page == 0 && entry.page.compare_exchange_strong(page, key)) {
+                page = key;
+            }
+            if (page != key) {
+                continue;
+            }
+            entry.num_faults.fetch_add(1, std::memory_order_relaxed);
+            entry.num_write_faults.fetch_add(is_write ? 1 : 0, std::memory_order_relaxed);
+            entry.time_ns.fetch_add(time_ns, std::memory_order_relaxed);
+            return;
+        }
+        num_unrecorded.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+FaultProfile fault_profile;
+
+/// Accounts the handling of a fault of the caches, in the signal handler or the uffd thread.
+void OnFaultHandled(VAddr addr, bool is_write, std::chrono::steady_clock::time_point start) {
+    const u64 time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+    Common::CountPerfInSignal(Common::PerfCounter::PageFaults);
+    Common::CountPerfInSignal(Common::PerfCounter::PageFaultNs, time_ns);
+    if (fault_profile.enabled.load(std::memory_order_relaxed)) {
+        fault_profile.Record(addr, is_write, time_ns);
+    }
+}
+
+} // Anonymous namespace
+
 struct PageManager::Impl {
     struct PageState {
         u8 num_write_watchers : 7;
@@ -174,7 +239,10 @@ struct PageManager::Impl {
 
             // Notify rasterizer about the fault.
             const VAddr addr = msg.arg.pagefault.address;
-            rasterizer->InvalidateMemory(addr, 1);
+            const auto start = std::chrono::steady_clock::now();
+            if (rasterizer->InvalidateMemory(addr, 1)) {
+                OnFaultHandled(addr, true, start);
+            }
         }
     }
 
@@ -187,7 +255,7 @@ struct PageManager::Impl {
         // Should be called first.
         constexpr auto priority = std::numeric_limits<u32>::min();
         Core::Signals::Instance()->RegisterAccessViolationHandler(GuestFaultSignalHandler,
-                                                                  priority);
+                                                                  priority, "Memory tracking");
     }
 
     void OnMap(VAddr address, size_t size) {
@@ -209,15 +277,70 @@ struct PageManager::Impl {
 
     static bool GuestFaultSignalHandler(void* context, void* fault_address) {
         const auto addr = reinterpret_cast<VAddr>(fault_address);
-        if (Common::IsWriteError(context)) {
-            return rasterizer->InvalidateMemory(addr, 8);
-        } else {
-            return rasterizer->ReadMemory(addr, 8);
+        const auto start = std::chrono::steady_clock::now();
+        const bool is_write = Common::IsWriteError(context);
+        const bool handled =
+            is_write ? rasterizer->InvalidateMemory(addr, 8) : rasterizer->ReadMemory(addr, 8);
+        if (handled) {
+            OnFaultHandled(addr, is_write, start);
         }
-        return false;
+        return handled;
     }
 #endif
 
+    void RequestProtect(VAddr address, size_t size, Core::MemoryPermission perms) {
+        num_protect_requests.fetch_add(1, std::memory_order_relaxed);
+        if (batch_depth == 0) {
+            num_protect_syscalls.fetch_add(1, std::memory_order_relaxed);
+            Protect(address, size, perms);
+            return;
+        }
+        const u64 page_begin = address >> PAGE_BITS;
+        const u64 page_end = Common::DivCeil(address + size, PAGE_SIZE);
+        if (!pending_protects.empty()) {
+            // Watchers walk pages in ascending order, so touching ranges are usually adjacent
+            auto& last = pending_protects.back();
+            if (page_begin <= last.page_end && page_end >= last.page_begin) {
+                last.page_begin = std::min(last.page_begin, page_begin);
+                last.page_end = std::max(last.page_end, page_end);
+                return;
+            }
+        }
+        pending_protects.push_back({page_begin, page_end});
+    }
+
+    void BeginProtectBatch() {
+        ++batch_depth;
+    }
+
+    void EndProtectBatch() {
+        if (--batch_depth != 0) {
+            return;
+        }
+        for (const auto& range : pending_protects) {
+            const auto lock_start = locks.begin() + (range.page_begin / PAGES_PER_LOCK);
+            const auto lock_end = locks.begin() + Common::DivCeil(range.page_end, PAGES_PER_LOCK);
+            Common::RangeLockGuard lk(lock_start, lock_end);
+
+            // Apply the current page states rather than the requested ones, other threads may
+            // have changed them and protected the pages themselves since the request.
+            u64 run_begin = range.page_begin;
+            auto perms = cached_pages[run_begin].Perms();
+            for (u64 page = run_begin + 1; page <= range.page_end; ++page) {
+                if (page != range.page_end && cached_pages[page].Perms() == perms) {
+                    continue;
+                }
+                num_protect_syscalls.fetch_add(1, std::memory_order_relaxed);
+                Protect(run_begin << PAGE_BITS, (page - run_begin) << PAGE_BITS, perms);
+                if (page != range.page_end) {
+                    run_begin = page;
+                    perms = cached_pages[page].Perms();
+                }
+            }
+        }
+        pending_protects.clear();
+    }
+
     template <bool track, bool is_read>
     void UpdatePageWatchers(VAddr addr, u64 size) {
         RENDERER_TRACE;
@@ -239,7 +362,7 @@ struct PageManager::Impl {
             if (range_bytes > 0) {
                 RENDERER_TRACE;
                 // Perform pending (un)protect action
-                Protect(range_begin << PAGE_BITS, range_bytes, perms);
+                RequestProtect(range_begin << PAGE_BITS, range_bytes, perms);
                 range_bytes = 0;
                 potential_range_bytes = 0;
             }
@@ -310,7 +433,7 @@ struct PageManager::Impl {
             if (range_bytes > 0) {
                 RENDERER_TRACE;
                 // Perform pending (un)protect action
-                Protect((range_begin << PAGE_BITS), range_bytes, perms);
+                RequestProtect(range_begin << PAGE_BITS, range_bytes, perms);
                 range_bytes = 0;
                 potential_range_bytes = 0;
             }
@@ -362,8 +485,25 @@ struct PageManager::Impl {
     using LockType = Common::SpinLock;
 #endif
     std::array<LockType, NUM_ADDRESS_LOCKS> locks{};
+
+    struct PendingProtect {
+        u64 page_begin;
+        u64 page_end;
+    };
+    inline static thread_local std::vector<PendingProtect> pending_protects;
+    inline static thread_local u32 batch_depth{};
+    std::atomic<u32> num_protect_requests{};
+    std::atomic<u32> num_protect_syscalls{};
 };
 
+PageManager::ProtectBatch::ProtectBatch(const PageManager& manager_) : manager{manager_} {
+    manager.impl->BeginProtectBatch();
+}
+
+PageManager::ProtectBatch::~ProtectBatch() {
+    manager.impl->EndProtectBatch();
+}
+
 PageManager::PageManager(Vulkan::Rasterizer* rasterizer_)
     : impl{std::make_unique<Impl>(rasterizer_)} {}
 
@@ -377,6 +517,56 @@ void PageManager::OnGpuUnmap(VAddr address, size_t size) {
     impl->OnUnmap(address, size);
 }
 
+PageManager::ProtectStats PageManager::ConsumeProtectStats() const {
+    return {
+        .requests = impl->num_protect_requests.exchange(0, std::memory_order_relaxed),
+        .syscalls = impl->num_protect_syscalls.exchange(0, std::memory_order_relaxed),
+    };
+}
+
+void PageManager::SetFaultProfiling(bool enable) {
+    fault_profile.enabled.store(enable, std::memory_order_relaxed);
+}
+
+bool PageManager::IsFaultProfiling() {
+    return fault_profile.enabled.load(std::memory_order_relaxed);
+}
+
+void PageManager::ResetFaultProfile() {
+    // Faults handled meanwhile may land in a cleared entry, which only skews the next profile
+    for (auto& entry : fault_profile.entries) {
+        entry.page.store(0, std::memory_order_relaxed);
+        entry.num_faults.store(0, std::memory_order_relaxed);
+        entry.num_write_faults.store(0, std::memory_order_relaxed);
+        entry.time_ns.store(0, std::memory_order_relaxed);
+    }
+    fault_profile.num_unrecorded.store(0, std::memory_order_relaxed);
+}
+
+std::vector<PageManager::HotPage> PageManager::GetHotPages(size_t max_pages) {
+    std::vector<HotPage> pages;
+    for (const auto& entry : fault_profile.entries) {
+        const u64 page = entry.page.load(std::memory_order_relaxed);
+        if (page == 0) {
+            continue;
+        }
+        pages.push_back({
+            .addr = (page - 1) << PAGE_BITS,
+            .num_faults = entry.num_faults.load(std::memory_order_relaxed),
+            .num_write_faults = entry.num_write_faults.load(std::memory_order_relaxed),
+            .time_ns = entry.time_ns.load(std::memory_order_relaxed),
+        });
+    }
+    const size_t count = std::min(max_pages, pages.size());
+    std::ranges::partial_sort(pages, pages.begin() + count, std::greater{}, &HotPage::time_ns);
+    pages.resize(count);
+    return pages;
+}
+
+u64 PageManager::GetUnrecordedFaults() {
+    return fault_profile.num_unrecorded.load(std::memory_order_relaxed);
+}
+
 template <bool track>
 void PageManager::UpdatePageWatchers(VAddr addr, u64 size) const {
     impl->UpdatePageWatchers<track, false>(addr, size);
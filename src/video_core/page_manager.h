@@ -4,6 +4,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include "common/alignment.h"
 #include "common/types.h"
 #include "video_core/buffer_cache//region_definitions.h"
@@ -24,6 +25,33 @@ class PageManager {
     static constexpr size_t PAGES_PER_LOCK = NUM_PAGES_PER_REGION;
 
 public:
+    struct ProtectStats {
+        u32 requests; ///< Ranges the watchers asked to (un)protect
+        u32 syscalls; ///< Protection calls made to the OS
+    };
+
+    /// Faults of a host page while fault profiling was on.
+    struct HotPage {
+        VAddr addr;
+        u64 num_faults;
+        u64 num_write_faults;
+        u64 time_ns; ///< Spent invalidating or reading back the caches
+    };
+
+    /// Defers the protection changes made by the calling thread while the batch is alive. They
+    /// are merged into as few ranges as possible and applied when the outermost batch ends.
+    class ProtectBatch {
+    public:
+        explicit ProtectBatch(const PageManager& manager);
+        ~ProtectBatch();
+
+        ProtectBatch(const ProtectBatch&) = delete;
+        ProtectBatch& operator=(const ProtectBatch&) = delete;
+
+    private:
+        const PageManager& manager;
+    };
+
     explicit PageManager(Vulkan::Rasterizer* rasterizer);
     ~PageManager();
 
@@ -41,6 +69,22 @@ public:
     template <bool track, bool is_read = false>
     void UpdatePageWatchersForRegion(VAddr base_addr, RegionBits& mask) const;
 
+    /// Returns the protection counters accumulated since the last call.
+    ProtectStats ConsumeProtectStats() const;
+
+    /// Starts or stops recording the faults of each tracked page, see GetHotPages.
+    static void SetFaultProfiling(bool enable);
+    [[nodiscard]] static bool IsFaultProfiling();
+
+    /// Clears the recorded pages.
+    static void ResetFaultProfile();
+
+    /// Returns up to max_pages of the pages that took the most time to handle, the worst first.
+    [[nodiscard]] static std::vector<HotPage> GetHotPages(size_t max_pages);
+
+    /// Returns the faults that weren't recorded as too many distinct pages faulted.
+    [[nodiscard]] static u64 GetUnrecordedFaults();
+
     /// Returns page aligned address.
     static constexpr VAddr GetPageAddr(VAddr addr) {
         return Common::AlignDown(addr, PAGE_SIZE);
@@ -3,6 +3,7 @@
 
 #include "common/assert.h"
 #include "common/config.h"
+#include "core/debug_state.h"
 #include "video_core/renderdoc.h"
 
 #include <renderdoc_app.h>
@@ -13,7 +14,12 @@
 #include <dlfcn.h>
 #endif
 
+#include <atomic>
+#include <chrono>
 #include <filesystem>
+#include <mutex>
+#include <optional>
+#include <utility>
 
 namespace VideoCore {
 
@@ -22,7 +28,15 @@ enum class CaptureState {
     Triggered,
     InProgress,
 };
-static CaptureState capture_state{CaptureState::Idle};
+static std::atomic<CaptureState> capture_state{CaptureState::Idle};
+
+struct AutoCaptureState {
+    std::chrono::steady_clock::time_point last_frame{};
+    std::chrono::steady_clock::time_point last_capture{};
+    u64 last_gpu_frame{};
+    u32 num_captures{};
+};
+static AutoCaptureState auto_capture;
 
 RENDERDOC_API_1_6_0* rdoc_api{};
 
@@ -94,9 +108,9 @@ void StartCapture() {
         return;
     }
 
-    if (capture_state == CaptureState::Triggered) {
+    auto expected = CaptureState::Triggered;
+    if (capture_state.compare_exchange_strong(expected, CaptureState::InProgress)) {
         rdoc_api->StartFrameCapture(nullptr, nullptr);
-        capture_state = CaptureState::InProgress;
     }
 }
 
@@ -105,16 +119,63 @@ void EndCapture() {
         return;
     }
 
-    if (capture_state == CaptureState::InProgress) {
+    if (capture_state.load() == CaptureState::InProgress) {
         rdoc_api->EndFrameCapture(nullptr, nullptr);
         capture_state = CaptureState::Idle;
     }
 }
 
 void TriggerCapture() {
-    if (capture_state == CaptureState::Idle) {
-        capture_state = CaptureState::Triggered;
+    auto expected = CaptureState::Idle;
+    capture_state.compare_exchange_strong(expected, CaptureState::Triggered);
+}
+
+void CheckAutoCapture() {
+    const auto now = std::chrono::steady_clock::now();
+    const auto last_frame = std::exchange(auto_capture.last_frame, now);
+    const u32 cpu_threshold_ms = Config::getRdocAutoCaptureCpuMs();
+    const u32 gpu_threshold_ms = Config::getRdocAutoCaptureGpuMs();
+    if (!rdoc_api || (cpu_threshold_ms == 0 && gpu_threshold_ms == 0)) {
+        return;
+    }
+
+    // GPU times are read back a few frames late, the capture is still of the work that follows
+    std::optional<double> gpu_ms;
+    if (gpu_threshold_ms != 0) {
+        std::scoped_lock lock{DebugState.gpu_timings_mutex};
+        const auto& timings = DebugState.gpu_timings;
+        if (timings.frame != auto_capture.last_gpu_frame && !timings.scopes.empty()) {
+            auto_capture.last_gpu_frame = timings.frame;
+            gpu_ms = timings.GetBusyMs();
+        }
+    }
+    // Startup until the first flip isn't a frame
+    const double cpu_ms =
+        last_frame == std::chrono::steady_clock::time_point{}
+            ? 0.0
+            : std::chrono::duration<double, std::milli>(now - last_frame).count();
+
+    const bool cpu_slow = cpu_threshold_ms != 0 && cpu_ms > cpu_threshold_ms;
+    const bool gpu_slow = gpu_ms && *gpu_ms > gpu_threshold_ms;
+    if (!cpu_slow && !gpu_slow) {
+        return;
+    }
+    if (auto_capture.num_captures >= Config::getRdocAutoCaptureLimit()) {
+        return;
+    }
+    const auto cooldown = std::chrono::seconds{Config::getRdocAutoCaptureCooldown()};
+    if (auto_capture.num_captures != 0 && now - auto_capture.last_capture < cooldown) {
+        return;
+    }
+    if (capture_state.load() != CaptureState::Idle) {
+        return;
     }
+    TriggerCapture();
+    auto_capture.last_capture = now;
+    ++auto_capture.num_captures;
+    LOG_INFO(Render, "Triggering RenderDoc capture {}/{}: CPU frame {:.2f} ms, GPU frame {}",
+             auto_capture.num_captures, Config::getRdocAutoCaptureLimit(), cpu_ms,
+             gpu_ms ? fmt::format("{:.2f} ms", *gpu_ms) : "not read back");
 }
 
 void SetOutputDir(const std::filesystem::path& path, const std::string& prefix) {
@@ -19,6 +19,13 @@ void EndCapture();
 /// Triggers capturing process.
 void TriggerCapture();
 
+/**
+ * Triggers a capture of the next submission when the frame that just ended took longer than the
+ * CPU or GPU frame time of the auto capture options, at most once per cooldown and up to the
+ * capture limit. Called once per flip.
+ */
+void CheckAutoCapture();
+
 /// Sets output directory for captures
 void SetOutputDir(const std::filesystem::path& path, const std::string& prefix);
 
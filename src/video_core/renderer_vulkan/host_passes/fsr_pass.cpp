@@ -1,11 +1,14 @@
 //  SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 //  SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <bit>
+
 #include "common/assert.h"
 #include "common/config.h"
 #include "video_core/host_shaders/fsr_comp.h"
 #include "video_core/renderer_vulkan/host_passes/fsr_pass.h"
 #include "video_core/renderer_vulkan/vk_platform.h"
+#include "video_core/renderer_vulkan/vk_presenter.h"
 #include "video_core/renderer_vulkan/vk_shader_util.h"
 
 #define A_CPU
@@ -76,22 +79,6 @@ void FsrPass::Create(vk::Device device, VmaAllocator allocator, u32 num_images)
         .size = sizeof(FSRConstants),
     };
 
-    const auto& cs_easu_module =
-        Compile(HostShaders::FSR_COMP, vk::ShaderStageFlagBits::eCompute, device,
-                {
-                    "SAMPLE_EASU=1",
-                });
-    ASSERT(cs_easu_module);
-    SetObjectName(device, cs_easu_module, "fsr.comp [EASU]");
-
-    const auto& cs_rcas_module =
-        Compile(HostShaders::FSR_COMP, vk::ShaderStageFlagBits::eCompute, device,
-                {
-                    "SAMPLE_RCAS=1",
-                });
-    ASSERT(cs_rcas_module);
-    SetObjectName(device, cs_rcas_module, "fsr.comp [RCAS]");
-
     pipeline_layout = Check<"fsp pipeline layout">(device.createPipelineLayoutUnique({
         .setLayoutCount = 1,
         .pSetLayouts = &descriptor_set_layout.get(),
@@ -100,32 +87,31 @@ void FsrPass::Create(vk::Device device, VmaAllocator allocator, u32 num_images)
     }));
     SetObjectName(device, pipeline_layout.get(), "fsr pipeline layout");
 
-    const vk::ComputePipelineCreateInfo easu_pinfo{
-        .stage{
-            .stage = vk::ShaderStageFlagBits::eCompute,
-            .module = cs_easu_module,
-            .pName = "main",
-        },
-        .layout = pipeline_layout.get(),
-    };
-    easu_pipeline =
-        Check<"fsp easu compute pipelines">(device.createComputePipelineUnique({}, easu_pinfo));
-    SetObjectName(device, easu_pipeline.get(), "fsr easu pipeline");
-
-    const vk::ComputePipelineCreateInfo rcas_pinfo{
-        .stage{
-            .stage = vk::ShaderStageFlagBits::eCompute,
-            .module = cs_rcas_module,
-            .pName = "main",
-        },
-        .layout = pipeline_layout.get(),
+    const auto create_pipeline = [&](std::vector<std::string> defines, std::string_view name) {
+        const auto& cs_module =
+            Compile(HostShaders::FSR_COMP, vk::ShaderStageFlagBits::eCompute, device, defines);
+        ASSERT(cs_module);
+        SetObjectName(device, cs_module, "fsr.comp [{}]", name);
+
+        const vk::ComputePipelineCreateInfo pinfo{
+            .stage{
+                .stage = vk::ShaderStageFlagBits::eCompute,
+                .module = cs_module,
+                .pName = "main",
+            },
+            .layout = pipeline_layout.get(),
+        };
+        auto pipeline =
+            Check<"fsr compute pipelines">(device.createComputePipelineUnique({}, pinfo));
+        SetObjectName(device, pipeline.get(), "fsr {} pipeline", name);
+        device.destroyShaderModule(cs_module);
+        return pipeline;
     };
-    rcas_pipeline =
-        Check<"fsp rcas compute pipelines">(device.createComputePipelineUnique({}, rcas_pinfo));
-    SetObjectName(device, rcas_pipeline.get(), "fsr rcas pipeline");
-
-    device.destroyShaderModule(cs_easu_module);
-    device.destroyShaderModule(cs_rcas_module);
+    easu_pipeline = create_pipeline({"SAMPLE_EASU=1"}, "EASU");
+    rcas_pipeline = create_pipeline({"SAMPLE_RCAS=1"}, "RCAS");
+    // Variants applying the post processing and writing straight to the frame
+    easu_fused_pipeline = create_pipeline({"SAMPLE_EASU=1", "FUSED_OUTPUT=1"}, "EASU fused");
+    rcas_fused_pipeline = create_pipeline({"SAMPLE_RCAS=1", "FUSED_OUTPUT=1"}, "RCAS fused");
 
     available_imgs.resize(num_images);
     for (int i = 0; i < num_images; ++i) {
@@ -139,201 +125,85 @@ void FsrPass::Create(vk::Device device, VmaAllocator allocator, u32 num_images)
 vk::ImageView FsrPass::Render(vk::CommandBuffer cmdbuf, vk::ImageView input,
                               vk::Extent2D input_size, vk::Extent2D output_size, Settings settings,
                               bool hdr) {
-    if (!settings.enable) {
-        DebugState.is_using_fsr = false;
+    if (!IsUpscaling(input_size, output_size, settings)) {
         return input;
     }
-    if (input_size.width >= output_size.width && input_size.height >= output_size.height) {
-        DebugState.is_using_fsr = false;
-        return input;
+    const Img& img = NextImage(output_size);
+    const Output output = {
+        .image = img.output_image,
+        .view = img.output_image_view.get(),
+        .final_layout = vk::ImageLayout::eShaderReadOnlyOptimal,
+        .dst_stage = vk::PipelineStageFlagBits2::eAllCommands,
+    };
+    Upscale(cmdbuf, input, input_size, settings, hdr, img, output, nullptr);
+    return img.output_image_view.get();
+}
+
+bool FsrPass::RenderToFrame(vk::CommandBuffer cmdbuf, vk::ImageView input,
+                            vk::Extent2D input_size, Frame& frame, Settings settings,
+                            const PostProcessingPass::Settings& pp_settings) {
+    if (!frame.supports_storage ||
+        !IsUpscaling(input_size, {frame.width, frame.height}, settings)) {
+        return false;
     }
+    const Img& img = NextImage({frame.width, frame.height});
+    // Left in the same state as the post processing pass leaves it
+    const Output output = {
+        .image = frame.image,
+        .view = frame.image_view,
+        .final_layout = vk::ImageLayout::eGeneral,
+        .dst_stage = vk::PipelineStageFlagBits2::eFragmentShader,
+    };
+    Upscale(cmdbuf, input, input_size, settings, frame.is_hdr, img, output, &pp_settings);
+    return true;
+}
 
-    DebugState.is_using_fsr = true;
+bool FsrPass::IsUpscaling(vk::Extent2D input_size, vk::Extent2D output_size,
+                          const Settings& settings) {
+    DebugState.is_using_fsr = settings.enable && (input_size.width < output_size.width ||
+                                                  input_size.height < output_size.height);
+    return DebugState.is_using_fsr;
+}
 
+const FsrPass::Img& FsrPass::NextImage(vk::Extent2D output_size) {
     if (output_size != cur_size) {
         ResizeAndInvalidate(output_size.width, output_size.height);
     }
-    auto [width, height] = cur_size;
-
     auto& img = available_imgs[cur_image];
     if (++cur_image >= available_imgs.size()) {
         cur_image = 0;
     }
-
     if (img.dirty) {
         CreateImages(img);
     }
+    return img;
+}
 
+void FsrPass::Upscale(vk::CommandBuffer cmdbuf, vk::ImageView input, vk::Extent2D input_size,
+                      const Settings& settings, bool hdr, const Img& img, const Output& output,
+                      const PostProcessingPass::Settings* pp_settings) {
     if (Config::getVkHostMarkersEnabled()) {
         cmdbuf.beginDebugUtilsLabelEXT(vk::DebugUtilsLabelEXT{
-            .pLabelName = "Host/FSR",
+            .pLabelName = pp_settings ? "Host/FSR + Post processing" : "Host/FSR",
         });
     }
 
+    const auto [width, height] = cur_size;
     static const int thread_group_work_region_dim = 16;
-    int dispatch_x = (width + (thread_group_work_region_dim - 1)) / thread_group_work_region_dim;
-    int dispatch_y = (height + (thread_group_work_region_dim - 1)) / thread_group_work_region_dim;
-
-    constexpr vk::ImageSubresourceRange simple_subresource = {
-        .aspectMask = vk::ImageAspectFlagBits::eColor,
-        .levelCount = 1,
-        .layerCount = 1,
-    };
-    const std::array enter_barrier{
-        vk::ImageMemoryBarrier2{
-            .srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
-            .srcAccessMask = vk::AccessFlagBits2::eShaderRead,
-            .dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
-            .dstAccessMask = vk::AccessFlagBits2::eShaderWrite,
-            .oldLayout = vk::ImageLayout::eUndefined,
-            .newLayout = vk::ImageLayout::eGeneral,
-            .image = img.intermediary_image,
-            .subresourceRange = simple_subresource,
-        },
-    };
-    cmdbuf.pipelineBarrier2({
-        .imageMemoryBarrierCount = enter_barrier.size(),
-        .pImageMemoryBarriers = enter_barrier.data(),
-    });
-
-    FSRConstants consts{};
-    FsrEasuCon(reinterpret_cast<AU1*>(&consts.Const0), reinterpret_cast<AU1*>(&consts.Const1),
-               reinterpret_cast<AU1*>(&consts.Const2), reinterpret_cast<AU1*>(&consts.Const3),
-               static_cast<AF1>(input_size.width), static_cast<AF1>(input_size.height),
-               static_cast<AF1>(input_size.width), static_cast<AF1>(input_size.height), (AF1)width,
-               (AF1)height);
-    consts.Sample[0] = hdr && !settings.use_rcas ? 1 : 0;
-
-    if (settings.use_rcas) {
-
-        { // easu
-            std::array<vk::DescriptorImageInfo, 3> img_info{{
-                {
-                    .imageView = input,
-                    .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
-                },
-                {
-                    .imageView = img.intermediary_image_view.get(),
-                    .imageLayout = vk::ImageLayout::eGeneral,
-                },
-                {
-                    .sampler = sampler.get(),
-                },
-            }};
-
-            std::array<vk::WriteDescriptorSet, 3> set_writes{{
-                {
-                    .dstBinding = 0,
-                    .descriptorCount = 1,
-                    .descriptorType = vk::DescriptorType::eSampledImage,
-                    .pImageInfo = &img_info[0],
-                },
-                {
-                    .dstBinding = 1,
-                    .descriptorCount = 1,
-                    .descriptorType = vk::DescriptorType::eStorageImage,
-                    .pImageInfo = &img_info[1],
-                },
-                {
-                    .dstBinding = 2,
-                    .descriptorCount = 1,
-                    .descriptorType = vk::DescriptorType::eSampler,
-                    .pImageInfo = &img_info[2],
-                },
-            }};
-
-            cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, easu_pipeline.get());
-            cmdbuf.pushDescriptorSetKHR(vk::PipelineBindPoint::eCompute, pipeline_layout.get(), 0,
-                                        set_writes);
-            cmdbuf.pushConstants(pipeline_layout.get(), vk::ShaderStageFlagBits::eCompute, 0,
-                                 sizeof(FSRConstants), &consts);
-            cmdbuf.dispatch(dispatch_x, dispatch_y, 1);
-        }
-
-        std::array img_barrier{
-            vk::ImageMemoryBarrier2{
-                .srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
-                .srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
-                .dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
-                .dstAccessMask = vk::AccessFlagBits2::eShaderRead,
-                .oldLayout = vk::ImageLayout::eGeneral,
-                .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
-                .image = img.intermediary_image,
-                .subresourceRange = simple_subresource,
-            },
-            vk::ImageMemoryBarrier2{
-                .srcStageMask = vk::PipelineStageFlagBits2::eTopOfPipe,
-                .srcAccessMask = vk::AccessFlagBits2::eNone,
-                .dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
-                .dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
-                .oldLayout = vk::ImageLayout::eUndefined,
-                .newLayout = vk::ImageLayout::eGeneral,
-                .image = img.output_image,
-                .subresourceRange = simple_subresource,
-            },
-        };
-        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
-            .imageMemoryBarrierCount = img_barrier.size(),
-            .pImageMemoryBarriers = img_barrier.data(),
-        });
-
-        { // rcas
-            consts = {};
-            FsrRcasCon(reinterpret_cast<AU1*>(&consts.Const0), settings.rcas_attenuation);
-            consts.Sample[0] = hdr ? 1 : 0;
-
-            std::array<vk::DescriptorImageInfo, 3> img_info{{
-                {
-                    .imageView = img.intermediary_image_view.get(),
-                    .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
-                },
-                {
-                    .imageView = img.output_image_view.get(),
-                    .imageLayout = vk::ImageLayout::eGeneral,
-                },
-                {
-                    .sampler = sampler.get(),
-                },
-            }};
-
-            std::array<vk::WriteDescriptorSet, 3> set_writes{{
-                {
-                    .dstBinding = 0,
-                    .descriptorCount = 1,
-                    .descriptorType = vk::DescriptorType::eSampledImage,
-                    .pImageInfo = &img_info[0],
-                },
-                {
-                    .dstBinding = 1,
-                    .descriptorCount = 1,
-                    .descriptorType = vk::DescriptorType::eStorageImage,
-                    .pImageInfo = &img_info[1],
-                },
-                {
-                    .dstBinding = 2,
-                    .descriptorCount = 1,
-                    .descriptorType = vk::DescriptorType::eSampler,
-                    .pImageInfo = &img_info[2],
-                },
-            }};
-
-            cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, rcas_pipeline.get());
-            cmdbuf.pushDescriptorSetKHR(vk::PipelineBindPoint::eCompute, pipeline_layout.get(), 0,
-                                        set_writes);
-            cmdbuf.pushConstants(pipeline_layout.get(), vk::ShaderStageFlagBits::eCompute, 0,
-                                 sizeof(FSRConstants), &consts);
-            cmdbuf.dispatch(dispatch_x, dispatch_y, 1);
-        }
-
-    } else {
-        // only easu
-        std::array<vk::DescriptorImageInfo, 3> img_info{{
+    const int dispatch_x =
+        (width + (thread_group_work_region_dim - 1)) / thread_group_work_region_dim;
+    const int dispatch_y =
+        (height + (thread_group_work_region_dim - 1)) / thread_group_work_region_dim;
+
+    const auto dispatch = [&](vk::Pipeline pipeline, vk::ImageView src, vk::ImageView dst,
+                              const FSRConstants& consts) {
+        const std::array<vk::DescriptorImageInfo, 3> img_info{{
             {
-                .imageView = input,
+                .imageView = src,
                 .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
             },
             {
-                .imageView = img.output_image_view.get(),
+                .imageView = dst,
                 .imageLayout = vk::ImageLayout::eGeneral,
             },
             {
@@ -341,7 +211,7 @@ vk::ImageView FsrPass::Render(vk::CommandBuffer cmdbuf, vk::ImageView input,
             },
         }};
 
-        std::array<vk::WriteDescriptorSet, 3> set_writes{{
+        const std::array<vk::WriteDescriptorSet, 3> set_writes{{
             {
                 .dstBinding = 0,
                 .descriptorCount = 1,
@@ -362,36 +232,116 @@ vk::ImageView FsrPass::Render(vk::CommandBuffer cmdbuf, vk::ImageView input,
             },
         }};
 
-        cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, easu_pipeline.get());
+        cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
         cmdbuf.pushDescriptorSetKHR(vk::PipelineBindPoint::eCompute, pipeline_layout.get(), 0,
                                     set_writes);
         cmdbuf.pushConstants(pipeline_layout.get(), vk::ShaderStageFlagBits::eCompute, 0,
                              sizeof(FSRConstants), &consts);
         cmdbuf.dispatch(dispatch_x, dispatch_y, 1);
-    }
+    };
+
+    constexpr vk::ImageSubresourceRange simple_subresource = {
+        .aspectMask = vk::ImageAspectFlagBits::eColor,
+        .levelCount = 1,
+        .layerCount = 1,
+    };
+    // The final pass overwrites the whole output, its previous contents are discarded
+    const vk::ImageMemoryBarrier2 output_barrier{
+        .srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+        .srcAccessMask = vk::AccessFlagBits2::eNone,
+        .dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+        .dstAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+        .oldLayout = vk::ImageLayout::eUndefined,
+        .newLayout = vk::ImageLayout::eGeneral,
+        .image = output.image,
+        .subresourceRange = simple_subresource,
+    };
+
+    FSRConstants consts{};
+    FsrEasuCon(reinterpret_cast<AU1*>(&consts.Const0), reinterpret_cast<AU1*>(&consts.Const1),
+               reinterpret_cast<AU1*>(&consts.Const2), reinterpret_cast<AU1*>(&consts.Const3),
+               static_cast<AF1>(input_size.width), static_cast<AF1>(input_size.height),
+               static_cast<AF1>(input_size.width), static_cast<AF1>(input_size.height), (AF1)width,
+               (AF1)height);
+
+    const auto set_output_consts = [&] {
+        consts.Sample[0] = hdr ? 1 : 0;
+        if (pp_settings) {
+            consts.Sample[1] = pp_settings->hdr;
+            consts.Sample[2] = std::bit_cast<u32>(pp_settings->gamma);
+        }
+    };
 
-    const std::array return_barrier{
-        vk::ImageMemoryBarrier2{
+    if (settings.use_rcas) {
+        const vk::ImageMemoryBarrier2 enter_barrier{
             .srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
-            .srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
-            .dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
-            .dstAccessMask = vk::AccessFlagBits2::eShaderRead,
-            .oldLayout = vk::ImageLayout::eGeneral,
-            .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
-            .image = img.output_image,
+            .srcAccessMask = vk::AccessFlagBits2::eShaderRead,
+            .dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+            .dstAccessMask = vk::AccessFlagBits2::eShaderWrite,
+            .oldLayout = vk::ImageLayout::eUndefined,
+            .newLayout = vk::ImageLayout::eGeneral,
+            .image = img.intermediary_image,
             .subresourceRange = simple_subresource,
-        },
+        };
+        cmdbuf.pipelineBarrier2({
+            .imageMemoryBarrierCount = 1,
+            .pImageMemoryBarriers = &enter_barrier,
+        });
+
+        dispatch(easu_pipeline.get(), input, img.intermediary_image_view.get(), consts);
+
+        const std::array img_barrier{
+            vk::ImageMemoryBarrier2{
+                .srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+                .srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+                .dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+                .dstAccessMask = vk::AccessFlagBits2::eShaderRead,
+                .oldLayout = vk::ImageLayout::eGeneral,
+                .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+                .image = img.intermediary_image,
+                .subresourceRange = simple_subresource,
+            },
+            output_barrier,
+        };
+        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+            .imageMemoryBarrierCount = img_barrier.size(),
+            .pImageMemoryBarriers = img_barrier.data(),
+        });
+
+        consts = {};
+        FsrRcasCon(reinterpret_cast<AU1*>(&consts.Const0), settings.rcas_attenuation);
+        set_output_consts();
+        dispatch(pp_settings ? rcas_fused_pipeline.get() : rcas_pipeline.get(),
+                 img.intermediary_image_view.get(), output.view, consts);
+    } else {
+        cmdbuf.pipelineBarrier2({
+            .imageMemoryBarrierCount = 1,
+            .pImageMemoryBarriers = &output_barrier,
+        });
+
+        set_output_consts();
+        dispatch(pp_settings ? easu_fused_pipeline.get() : easu_pipeline.get(), input,
+                 output.view, consts);
+    }
+
+    const vk::ImageMemoryBarrier2 return_barrier{
+        .srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+        .srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite,
+        .dstStageMask = output.dst_stage,
+        .dstAccessMask = vk::AccessFlagBits2::eShaderRead,
+        .oldLayout = vk::ImageLayout::eGeneral,
+        .newLayout = output.final_layout,
+        .image = output.image,
+        .subresourceRange = simple_subresource,
     };
     cmdbuf.pipelineBarrier2({
-        .imageMemoryBarrierCount = return_barrier.size(),
-        .pImageMemoryBarriers = return_barrier.data(),
+        .imageMemoryBarrierCount = 1,
+        .pImageMemoryBarriers = &return_barrier,
     });
 
     if (Config::getVkHostMarkersEnabled()) {
         cmdbuf.endDebugUtilsLabelEXT();
     }
-
-    return img.output_image_view.get();
 }
 
 void FsrPass::ResizeAndInvalidate(u32 width, u32 height) {
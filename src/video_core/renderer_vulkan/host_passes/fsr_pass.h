@@ -4,6 +4,7 @@
 #pragma once
 
 #include "common/types.h"
+#include "video_core/renderer_vulkan/host_passes/pp_pass.h"
 #include "video_core/renderer_vulkan/vk_common.h"
 #include "video_core/texture_cache/image.h"
 
@@ -22,6 +23,13 @@ public:
     vk::ImageView Render(vk::CommandBuffer cmdbuf, vk::ImageView input, vk::Extent2D input_size,
                          vk::Extent2D output_size, Settings settings, bool hdr);
 
+    /// Upscales to the frame with the post processing applied by the last FSR dispatch, instead
+    /// of writing an output image for PostProcessingPass to read back. Returns false when FSR
+    /// is not used or the frame can't be written from shaders, nothing is recorded then.
+    bool RenderToFrame(vk::CommandBuffer cmdbuf, vk::ImageView input, vk::Extent2D input_size,
+                       Frame& frame, Settings settings,
+                       const PostProcessingPass::Settings& pp_settings);
+
 private:
     struct Img {
         u8 id{};
@@ -34,6 +42,20 @@ private:
         vk::UniqueImageView output_image_view;
     };
 
+    struct Output {
+        vk::Image image;
+        vk::ImageView view;
+        vk::ImageLayout final_layout;
+        vk::PipelineStageFlags2 dst_stage; ///< Stage reading the output after the pass
+    };
+
+    static bool IsUpscaling(vk::Extent2D input_size, vk::Extent2D output_size,
+                            const Settings& settings);
+    const Img& NextImage(vk::Extent2D output_size);
+    void Upscale(vk::CommandBuffer cmdbuf, vk::ImageView input, vk::Extent2D input_size,
+                 const Settings& settings, bool hdr, const Img& img, const Output& output,
+                 const PostProcessingPass::Settings* pp_settings);
+
     void ResizeAndInvalidate(u32 width, u32 height);
     void CreateImages(Img& img) const;
 
@@ -47,6 +69,8 @@ private:
     vk::UniquePipelineLayout pipeline_layout{};
     vk::UniquePipeline easu_pipeline{};
     vk::UniquePipeline rcas_pipeline{};
+    vk::UniquePipeline easu_fused_pipeline{};
+    vk::UniquePipeline rcas_fused_pipeline{};
 
     vk::Extent2D cur_size{};
     u32 cur_image{};
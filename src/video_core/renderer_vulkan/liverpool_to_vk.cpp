@@ -245,6 +245,41 @@ vk::BlendOp BlendOp(AmdGpu::BlendControl::BlendFunc func) {
     }
 }
 
+vk::ColorBlendEquationEXT BlendEquation(const AmdGpu::BlendControl& control,
+                                        bool alpha_masked_out) {
+    const auto src_color = BlendFactor(control.color_src_factor);
+    const auto dst_color = BlendFactor(control.color_dst_factor);
+    const auto color_blend = BlendOp(control.color_func);
+    vk::ColorBlendEquationEXT equation = {
+        .srcColorBlendFactor = src_color,
+        .dstColorBlendFactor = dst_color,
+        .colorBlendOp = color_blend,
+        .srcAlphaBlendFactor =
+            control.separate_alpha_blend ? BlendFactor(control.alpha_src_factor) : src_color,
+        .dstAlphaBlendFactor =
+            control.separate_alpha_blend ? BlendFactor(control.alpha_dst_factor) : dst_color,
+        .alphaBlendOp = control.separate_alpha_blend ? BlendOp(control.alpha_func) : color_blend,
+    };
+    // On GCN GPU there is an additional mask which allows to control color components exported
+    // from a pixel shader. A situation possible, when the game may mask out the alpha channel,
+    // while it is still need to be used in blending ops. For such cases, HW will default alpha
+    // to 1 and perform the blending, while shader normally outputs 0 in the last component.
+    // Unfortunatelly, Vulkan doesn't provide any control on blend inputs, so below we detecting
+    // such cases and override alpha value in order to emulate HW behaviour.
+    if (alpha_masked_out) {
+        const auto override_alpha = [](vk::BlendFactor& factor) {
+            if (factor == vk::BlendFactor::eSrcAlpha) {
+                factor = vk::BlendFactor::eOne;
+            } else if (factor == vk::BlendFactor::eOneMinusSrcAlpha) {
+                factor = vk::BlendFactor::eZero; // 1-A
+            }
+        };
+        override_alpha(equation.srcColorBlendFactor);
+        override_alpha(equation.dstColorBlendFactor);
+    }
+    return equation;
+}
+
 vk::LogicOp LogicOp(AmdGpu::ColorControl::LogicOp logic_op) {
     using LogicOp = AmdGpu::ColorControl::LogicOp;
     switch (logic_op) {
@@ -529,227 +564,230 @@ static constexpr SurfaceFormatInfo CreateSurfaceFormatInfo(const AmdGpu::DataFor
     };
 }
 
+// Uscaled, Sscaled, and Ubnorm formats are automatically remapped and handled in shader.
+static constexpr std::array surface_formats{
+    // Invalid
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eUndefined),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Snorm,
+                            vk::Format::eUndefined),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Uscaled,
+                            vk::Format::eUndefined),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Sscaled,
+                            vk::Format::eUndefined),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Uint,
+                            vk::Format::eUndefined),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Sint,
+                            vk::Format::eUndefined),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::SnormNz,
+                            vk::Format::eUndefined),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Float,
+                            vk::Format::eUndefined),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Srgb,
+                            vk::Format::eUndefined),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Ubnorm,
+                            vk::Format::eUndefined),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::UbnormNz,
+                            vk::Format::eUndefined),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Ubint,
+                            vk::Format::eUndefined),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Ubscaled,
+                            vk::Format::eUndefined),
+    // 8
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eR8Unorm),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8, AmdGpu::NumberFormat::Snorm,
+                            vk::Format::eR8Snorm),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8, AmdGpu::NumberFormat::Uint,
+                            vk::Format::eR8Uint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8, AmdGpu::NumberFormat::Sint,
+                            vk::Format::eR8Sint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8, AmdGpu::NumberFormat::Srgb,
+                            vk::Format::eR8Srgb),
+    // 16
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eR16Unorm),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16, AmdGpu::NumberFormat::Snorm,
+                            vk::Format::eR16Snorm),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16, AmdGpu::NumberFormat::Uint,
+                            vk::Format::eR16Uint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16, AmdGpu::NumberFormat::Sint,
+                            vk::Format::eR16Sint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16, AmdGpu::NumberFormat::Float,
+                            vk::Format::eR16Sfloat),
+    // 8_8
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eR8G8Unorm),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8, AmdGpu::NumberFormat::Snorm,
+                            vk::Format::eR8G8Snorm),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8, AmdGpu::NumberFormat::Uint,
+                            vk::Format::eR8G8Uint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8, AmdGpu::NumberFormat::Sint,
+                            vk::Format::eR8G8Sint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8, AmdGpu::NumberFormat::Srgb,
+                            vk::Format::eR8G8Srgb),
+    // 32
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32, AmdGpu::NumberFormat::Uint,
+                            vk::Format::eR32Uint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32, AmdGpu::NumberFormat::Sint,
+                            vk::Format::eR32Sint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32, AmdGpu::NumberFormat::Float,
+                            vk::Format::eR32Sfloat),
+    // 16_16
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eR16G16Unorm),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16, AmdGpu::NumberFormat::Snorm,
+                            vk::Format::eR16G16Snorm),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16, AmdGpu::NumberFormat::Uint,
+                            vk::Format::eR16G16Uint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16, AmdGpu::NumberFormat::Sint,
+                            vk::Format::eR16G16Sint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16, AmdGpu::NumberFormat::Float,
+                            vk::Format::eR16G16Sfloat),
+    // 10_11_11
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format10_11_11, AmdGpu::NumberFormat::Float,
+                            vk::Format::eB10G11R11UfloatPack32),
+    // 11_11_10 - Remapped to 10_11_11.
+    // 10_10_10_2 - Remapped to 2_10_10_10.
+    // 2_10_10_10
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format2_10_10_10, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eA2B10G10R10UnormPack32),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format2_10_10_10, AmdGpu::NumberFormat::Snorm,
+                            vk::Format::eA2B10G10R10SnormPack32),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format2_10_10_10, AmdGpu::NumberFormat::Uint,
+                            vk::Format::eA2B10G10R10UintPack32),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format2_10_10_10, AmdGpu::NumberFormat::Sint,
+                            vk::Format::eA2B10G10R10SintPack32),
+    // 8_8_8_8
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8_8_8, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eR8G8B8A8Unorm),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8_8_8, AmdGpu::NumberFormat::Snorm,
+                            vk::Format::eR8G8B8A8Snorm),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8_8_8, AmdGpu::NumberFormat::Uint,
+                            vk::Format::eR8G8B8A8Uint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8_8_8, AmdGpu::NumberFormat::Sint,
+                            vk::Format::eR8G8B8A8Sint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8_8_8, AmdGpu::NumberFormat::Srgb,
+                            vk::Format::eR8G8B8A8Srgb),
+    // 32_32
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32, AmdGpu::NumberFormat::Uint,
+                            vk::Format::eR32G32Uint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32, AmdGpu::NumberFormat::Sint,
+                            vk::Format::eR32G32Sint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32, AmdGpu::NumberFormat::Float,
+                            vk::Format::eR32G32Sfloat),
+    // 16_16_16_16
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16_16_16, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eR16G16B16A16Unorm),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16_16_16, AmdGpu::NumberFormat::Snorm,
+                            vk::Format::eR16G16B16A16Snorm),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16_16_16, AmdGpu::NumberFormat::Uint,
+                            vk::Format::eR16G16B16A16Uint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16_16_16, AmdGpu::NumberFormat::Sint,
+                            vk::Format::eR16G16B16A16Sint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16_16_16,
+                            AmdGpu::NumberFormat::SnormNz, vk::Format::eR16G16B16A16Snorm),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16_16_16, AmdGpu::NumberFormat::Float,
+                            vk::Format::eR16G16B16A16Sfloat),
+    // 32_32_32
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32_32, AmdGpu::NumberFormat::Uint,
+                            vk::Format::eR32G32B32Uint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32_32, AmdGpu::NumberFormat::Sint,
+                            vk::Format::eR32G32B32Sint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32_32, AmdGpu::NumberFormat::Float,
+                            vk::Format::eR32G32B32Sfloat),
+    // 32_32_32_32
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32_32_32, AmdGpu::NumberFormat::Uint,
+                            vk::Format::eR32G32B32A32Uint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32_32_32, AmdGpu::NumberFormat::Sint,
+                            vk::Format::eR32G32B32A32Sint),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32_32_32, AmdGpu::NumberFormat::Float,
+                            vk::Format::eR32G32B32A32Sfloat),
+    // 5_6_5
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format5_6_5, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eR5G6B5UnormPack16),
+    // 1_5_5_5
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format1_5_5_5, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eA1R5G5B5UnormPack16),
+    // 5_5_5_1
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format5_5_5_1, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eR5G5B5A1UnormPack16),
+    // 4_4_4_4
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format4_4_4_4, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eB4G4R4A4UnormPack16),
+    // 8_24
+    // 24_8
+    // X24_8_32
+    // GB_GR
+    // BG_RG
+    // 5_9_9_9
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format5_9_9_9, AmdGpu::NumberFormat::Float,
+                            vk::Format::eE5B9G9R9UfloatPack32),
+    // BC1
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc1, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eBc1RgbaUnormBlock),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc1, AmdGpu::NumberFormat::Srgb,
+                            vk::Format::eBc1RgbaSrgbBlock),
+    // BC2
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc2, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eBc2UnormBlock),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc2, AmdGpu::NumberFormat::Srgb,
+                            vk::Format::eBc2SrgbBlock),
+    // BC3
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc3, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eBc3UnormBlock),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc3, AmdGpu::NumberFormat::Srgb,
+                            vk::Format::eBc3SrgbBlock),
+    // BC4
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc4, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eBc4UnormBlock),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc4, AmdGpu::NumberFormat::Snorm,
+                            vk::Format::eBc4SnormBlock),
+    // BC5
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc5, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eBc5UnormBlock),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc5, AmdGpu::NumberFormat::Snorm,
+                            vk::Format::eBc5SnormBlock),
+    // BC6
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc6, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eBc6HUfloatBlock),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc6, AmdGpu::NumberFormat::Snorm,
+                            vk::Format::eBc6HSfloatBlock),
+    // BC7
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc7, AmdGpu::NumberFormat::Unorm,
+                            vk::Format::eBc7UnormBlock),
+    CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc7, AmdGpu::NumberFormat::Srgb,
+                            vk::Format::eBc7SrgbBlock),
+};
+
 std::span<const SurfaceFormatInfo> SurfaceFormats() {
-    // Uscaled, Sscaled, and Ubnorm formats are automatically remapped and handled in shader.
-    static constexpr std::array formats{
-        // Invalid
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eUndefined),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Snorm,
-                                vk::Format::eUndefined),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Uscaled,
-                                vk::Format::eUndefined),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Sscaled,
-                                vk::Format::eUndefined),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Uint,
-                                vk::Format::eUndefined),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Sint,
-                                vk::Format::eUndefined),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::SnormNz,
-                                vk::Format::eUndefined),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Float,
-                                vk::Format::eUndefined),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Srgb,
-                                vk::Format::eUndefined),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Ubnorm,
-                                vk::Format::eUndefined),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::UbnormNz,
-                                vk::Format::eUndefined),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Ubint,
-                                vk::Format::eUndefined),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatInvalid, AmdGpu::NumberFormat::Ubscaled,
-                                vk::Format::eUndefined),
-        // 8
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eR8Unorm),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8, AmdGpu::NumberFormat::Snorm,
-                                vk::Format::eR8Snorm),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8, AmdGpu::NumberFormat::Uint,
-                                vk::Format::eR8Uint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8, AmdGpu::NumberFormat::Sint,
-                                vk::Format::eR8Sint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8, AmdGpu::NumberFormat::Srgb,
-                                vk::Format::eR8Srgb),
-        // 16
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eR16Unorm),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16, AmdGpu::NumberFormat::Snorm,
-                                vk::Format::eR16Snorm),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16, AmdGpu::NumberFormat::Uint,
-                                vk::Format::eR16Uint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16, AmdGpu::NumberFormat::Sint,
-                                vk::Format::eR16Sint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16, AmdGpu::NumberFormat::Float,
-                                vk::Format::eR16Sfloat),
-        // 8_8
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eR8G8Unorm),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8, AmdGpu::NumberFormat::Snorm,
-                                vk::Format::eR8G8Snorm),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8, AmdGpu::NumberFormat::Uint,
-                                vk::Format::eR8G8Uint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8, AmdGpu::NumberFormat::Sint,
-                                vk::Format::eR8G8Sint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8, AmdGpu::NumberFormat::Srgb,
-                                vk::Format::eR8G8Srgb),
-        // 32
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32, AmdGpu::NumberFormat::Uint,
-                                vk::Format::eR32Uint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32, AmdGpu::NumberFormat::Sint,
-                                vk::Format::eR32Sint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32, AmdGpu::NumberFormat::Float,
-                                vk::Format::eR32Sfloat),
-        // 16_16
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eR16G16Unorm),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16, AmdGpu::NumberFormat::Snorm,
-                                vk::Format::eR16G16Snorm),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16, AmdGpu::NumberFormat::Uint,
-                                vk::Format::eR16G16Uint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16, AmdGpu::NumberFormat::Sint,
-                                vk::Format::eR16G16Sint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16, AmdGpu::NumberFormat::Float,
-                                vk::Format::eR16G16Sfloat),
-        // 10_11_11
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format10_11_11, AmdGpu::NumberFormat::Float,
-                                vk::Format::eB10G11R11UfloatPack32),
-        // 11_11_10 - Remapped to 10_11_11.
-        // 10_10_10_2 - Remapped to 2_10_10_10.
-        // 2_10_10_10
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format2_10_10_10, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eA2B10G10R10UnormPack32),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format2_10_10_10, AmdGpu::NumberFormat::Snorm,
-                                vk::Format::eA2B10G10R10SnormPack32),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format2_10_10_10, AmdGpu::NumberFormat::Uint,
-                                vk::Format::eA2B10G10R10UintPack32),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format2_10_10_10, AmdGpu::NumberFormat::Sint,
-                                vk::Format::eA2B10G10R10SintPack32),
-        // 8_8_8_8
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8_8_8, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eR8G8B8A8Unorm),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8_8_8, AmdGpu::NumberFormat::Snorm,
-                                vk::Format::eR8G8B8A8Snorm),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8_8_8, AmdGpu::NumberFormat::Uint,
-                                vk::Format::eR8G8B8A8Uint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8_8_8, AmdGpu::NumberFormat::Sint,
-                                vk::Format::eR8G8B8A8Sint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format8_8_8_8, AmdGpu::NumberFormat::Srgb,
-                                vk::Format::eR8G8B8A8Srgb),
-        // 32_32
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32, AmdGpu::NumberFormat::Uint,
-                                vk::Format::eR32G32Uint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32, AmdGpu::NumberFormat::Sint,
-                                vk::Format::eR32G32Sint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32, AmdGpu::NumberFormat::Float,
-                                vk::Format::eR32G32Sfloat),
-        // 16_16_16_16
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16_16_16, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eR16G16B16A16Unorm),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16_16_16, AmdGpu::NumberFormat::Snorm,
-                                vk::Format::eR16G16B16A16Snorm),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16_16_16, AmdGpu::NumberFormat::Uint,
-                                vk::Format::eR16G16B16A16Uint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16_16_16, AmdGpu::NumberFormat::Sint,
-                                vk::Format::eR16G16B16A16Sint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16_16_16,
-                                AmdGpu::NumberFormat::SnormNz, vk::Format::eR16G16B16A16Snorm),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format16_16_16_16, AmdGpu::NumberFormat::Float,
-                                vk::Format::eR16G16B16A16Sfloat),
-        // 32_32_32
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32_32, AmdGpu::NumberFormat::Uint,
-                                vk::Format::eR32G32B32Uint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32_32, AmdGpu::NumberFormat::Sint,
-                                vk::Format::eR32G32B32Sint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32_32, AmdGpu::NumberFormat::Float,
-                                vk::Format::eR32G32B32Sfloat),
-        // 32_32_32_32
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32_32_32, AmdGpu::NumberFormat::Uint,
-                                vk::Format::eR32G32B32A32Uint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32_32_32, AmdGpu::NumberFormat::Sint,
-                                vk::Format::eR32G32B32A32Sint),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format32_32_32_32, AmdGpu::NumberFormat::Float,
-                                vk::Format::eR32G32B32A32Sfloat),
-        // 5_6_5
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format5_6_5, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eR5G6B5UnormPack16),
-        // 1_5_5_5
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format1_5_5_5, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eA1R5G5B5UnormPack16),
-        // 5_5_5_1
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format5_5_5_1, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eR5G5B5A1UnormPack16),
-        // 4_4_4_4
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format4_4_4_4, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eB4G4R4A4UnormPack16),
-        // 8_24
-        // 24_8
-        // X24_8_32
-        // GB_GR
-        // BG_RG
-        // 5_9_9_9
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::Format5_9_9_9, AmdGpu::NumberFormat::Float,
-                                vk::Format::eE5B9G9R9UfloatPack32),
-        // BC1
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc1, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eBc1RgbaUnormBlock),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc1, AmdGpu::NumberFormat::Srgb,
-                                vk::Format::eBc1RgbaSrgbBlock),
-        // BC2
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc2, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eBc2UnormBlock),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc2, AmdGpu::NumberFormat::Srgb,
-                                vk::Format::eBc2SrgbBlock),
-        // BC3
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc3, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eBc3UnormBlock),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc3, AmdGpu::NumberFormat::Srgb,
-                                vk::Format::eBc3SrgbBlock),
-        // BC4
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc4, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eBc4UnormBlock),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc4, AmdGpu::NumberFormat::Snorm,
-                                vk::Format::eBc4SnormBlock),
-        // BC5
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc5, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eBc5UnormBlock),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc5, AmdGpu::NumberFormat::Snorm,
-                                vk::Format::eBc5SnormBlock),
-        // BC6
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc6, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eBc6HUfloatBlock),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc6, AmdGpu::NumberFormat::Snorm,
-                                vk::Format::eBc6HSfloatBlock),
-        // BC7
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc7, AmdGpu::NumberFormat::Unorm,
-                                vk::Format::eBc7UnormBlock),
-        CreateSurfaceFormatInfo(AmdGpu::DataFormat::FormatBc7, AmdGpu::NumberFormat::Srgb,
-                                vk::Format::eBc7SrgbBlock),
-    };
-    return formats;
+    return surface_formats;
 }
 
 // Table 8.13 Data and Image Formats [Sea Islands Series Instruction Set Architecture]
-static const size_t amd_gpu_data_format_bit_size = 6;   // All values are under 64
-static const size_t amd_gpu_number_format_bit_size = 4; // All values are under 16
+static constexpr size_t amd_gpu_data_format_bit_size = 6;   // All values are under 64
+static constexpr size_t amd_gpu_number_format_bit_size = 4; // All values are under 16
+
+static constexpr size_t SurfaceFormatTableIndex(AmdGpu::DataFormat data_format,
+                                                AmdGpu::NumberFormat num_format) {
+    return static_cast<size_t>(num_format) |
+           (static_cast<size_t>(data_format) << amd_gpu_number_format_bit_size);
+}
 
 static size_t GetSurfaceFormatTableIndex(AmdGpu::DataFormat data_format,
                                          AmdGpu::NumberFormat num_format) {
     DEBUG_ASSERT(u32(data_format) < 1 << amd_gpu_data_format_bit_size);
     DEBUG_ASSERT(u32(num_format) < 1 << amd_gpu_number_format_bit_size);
-    size_t result = static_cast<size_t>(num_format) |
-                    (static_cast<size_t>(data_format) << amd_gpu_number_format_bit_size);
-    return result;
+    return SurfaceFormatTableIndex(data_format, num_format);
 }
 
-static auto surface_format_table = []() constexpr {
-    std::array<vk::Format, 1 << amd_gpu_data_format_bit_size * 1 << amd_gpu_number_format_bit_size>
-        result;
-    for (auto& entry : result) {
-        entry = vk::Format::eUndefined;
-    }
-    for (const auto& supported_format : SurfaceFormats()) {
-        result[GetSurfaceFormatTableIndex(supported_format.data_format,
-                                          supported_format.number_format)] =
+// Built at compile time, translating a format is a single load
+static constexpr auto surface_format_table = [] {
+    std::array<vk::Format, 1 << (amd_gpu_data_format_bit_size + amd_gpu_number_format_bit_size)>
+        result{};
+    for (const auto& supported_format : surface_formats) {
+        result[SurfaceFormatTableIndex(supported_format.data_format,
+                                       supported_format.number_format)] =
             supported_format.vk_format;
     }
     return result;
@@ -775,34 +813,48 @@ static constexpr DepthFormatInfo CreateDepthFormatInfo(
     };
 }
 
+static constexpr std::array depth_formats{
+    // Invalid
+    CreateDepthFormatInfo(DepthBuffer::ZFormat::Invalid, DepthBuffer::StencilFormat::Invalid,
+                          vk::Format::eUndefined),
+    CreateDepthFormatInfo(DepthBuffer::ZFormat::Invalid, DepthBuffer::StencilFormat::Stencil8,
+                          vk::Format::eD32SfloatS8Uint),
+    // 16
+    CreateDepthFormatInfo(DepthBuffer::ZFormat::Z16, DepthBuffer::StencilFormat::Invalid,
+                          vk::Format::eD16Unorm),
+    CreateDepthFormatInfo(DepthBuffer::ZFormat::Z16, DepthBuffer::StencilFormat::Stencil8,
+                          vk::Format::eD16UnormS8Uint),
+    // 32_Float
+    CreateDepthFormatInfo(DepthBuffer::ZFormat::Z32Float, DepthBuffer::StencilFormat::Invalid,
+                          vk::Format::eD32Sfloat),
+    CreateDepthFormatInfo(DepthBuffer::ZFormat::Z32Float, DepthBuffer::StencilFormat::Stencil8,
+                          vk::Format::eD32SfloatS8Uint),
+};
+
 std::span<const DepthFormatInfo> DepthFormats() {
-    using ZFormat = DepthBuffer::ZFormat;
-    using StencilFormat = DepthBuffer::StencilFormat;
-    static constexpr std::array formats{
-        // Invalid
-        CreateDepthFormatInfo(ZFormat::Invalid, StencilFormat::Invalid, vk::Format::eUndefined),
-        CreateDepthFormatInfo(ZFormat::Invalid, StencilFormat::Stencil8,
-                              vk::Format::eD32SfloatS8Uint),
-        // 16
-        CreateDepthFormatInfo(ZFormat::Z16, StencilFormat::Invalid, vk::Format::eD16Unorm),
-        CreateDepthFormatInfo(ZFormat::Z16, StencilFormat::Stencil8, vk::Format::eD16UnormS8Uint),
-        // 32_Float
-        CreateDepthFormatInfo(ZFormat::Z32Float, StencilFormat::Invalid, vk::Format::eD32Sfloat),
-        CreateDepthFormatInfo(ZFormat::Z32Float, StencilFormat::Stencil8,
-                              vk::Format::eD32SfloatS8Uint),
-    };
-    return formats;
+    return depth_formats;
 }
 
+// Indexed by the 2-bit depth format and the 1-bit stencil format, unknown pairs are undefined
+static constexpr auto depth_format_table = [] {
+    std::array<vk::Format, 4 * 2> result{};
+    for (const auto& format_info : depth_formats) {
+        result[static_cast<u32>(format_info.z_format) * 2 +
+               static_cast<u32>(format_info.stencil_format)] = format_info.vk_format;
+    }
+    return result;
+}();
+
 vk::Format DepthFormat(DepthBuffer::ZFormat z_format, DepthBuffer::StencilFormat stencil_format) {
-    const auto& formats = DepthFormats();
-    const auto format =
-        std::find_if(formats.begin(), formats.end(), [&](const DepthFormatInfo& format_info) {
-            return format_info.z_format == z_format && format_info.stencil_format == stencil_format;
-        });
-    ASSERT_MSG(format != formats.end(), "Unknown z_format={} and stencil_format={}",
-               static_cast<u32>(z_format), static_cast<u32>(stencil_format));
-    return format->vk_format;
+    const u32 index = static_cast<u32>(z_format) * 2 + static_cast<u32>(stencil_format);
+    const vk::Format format =
+        index < depth_format_table.size() ? depth_format_table[index] : vk::Format::eUndefined;
+    const bool found = format != vk::Format::eUndefined ||
+                       (z_format == DepthBuffer::ZFormat::Invalid &&
+                        stencil_format == DepthBuffer::StencilFormat::Invalid);
+    ASSERT_MSG(found, "Unknown z_format={} and stencil_format={}", static_cast<u32>(z_format),
+               static_cast<u32>(stencil_format));
+    return format;
 }
 
 vk::ClearValue ColorBufferClearValue(const AmdGpu::ColorBuffer& color_buffer) {
@@ -35,6 +35,11 @@ bool IsDualSourceBlendFactor(AmdGpu::BlendControl::BlendFactor factor);
 
 vk::BlendOp BlendOp(AmdGpu::BlendControl::BlendFunc func);
 
+/// Blend equation of a color buffer. The alpha output of the pixel shader reads as one when
+/// alpha_masked_out is set, like the hardware does when the shader mask drops it.
+vk::ColorBlendEquationEXT BlendEquation(const AmdGpu::BlendControl& control,
+                                        bool alpha_masked_out);
+
 vk::LogicOp LogicOp(AmdGpu::ColorControl::LogicOp logic_op);
 
 vk::SamplerAddressMode ClampMode(AmdGpu::ClampMode mode);
@@ -11,22 +11,19 @@
 namespace Vulkan {
 
 ComputePipeline::ComputePipeline(const Instance& instance, Scheduler& scheduler,
-                                 DescriptorHeap& desc_heap, const Shader::Profile& profile,
+                                 DescriptorHeap& desc_heap, DescriptorBuffer* desc_buffer,
+                                 const SamplerHeap* sampler_heap, const Shader::Profile& profile,
                                  vk::PipelineCache pipeline_cache, ComputePipelineKey compute_key_,
                                  const Shader::Info& info_, vk::ShaderModule module,
-                                 SerializationSupport& sdata, bool preloading /*=false*/)
-    : Pipeline{instance, scheduler, desc_heap, profile, pipeline_cache, true},
+                                 SerializationSupport& sdata, bool preloading /*=false*/,
+                                 bool deferred /*=false*/)
+    : Pipeline{instance, scheduler, desc_heap, desc_buffer, sampler_heap, profile, pipeline_cache,
+               true},
       compute_key{compute_key_} {
     auto& info = stages[int(Shader::LogicalStage::Compute)];
     info = &info_;
     const auto debug_str = GetDebugString();
 
-    const vk::PipelineShaderStageCreateInfo shader_ci = {
-        .stage = vk::ShaderStageFlagBits::eCompute,
-        .module = module,
-        .pName = "main",
-    };
-
     u32 binding{};
     boost::container::small_vector<vk::DescriptorSetLayoutBinding, 32> bindings;
     for (const auto& buffer : info->buffers) {
@@ -52,7 +49,12 @@ ComputePipeline::ComputePipeline(const Instance& instance, Scheduler& scheduler,
             .stageFlags = vk::ShaderStageFlagBits::eCompute,
         });
     }
+    u32 sampler_index{};
     for (const auto& sampler : info->samplers) {
+        if (IsBindlessSampler(sampler_index++)) {
+            ++binding;
+            continue;
+        }
         bindings.push_back({
             .binding = binding++,
             .descriptorType = vk::DescriptorType::eSampler,
@@ -64,13 +66,10 @@ ComputePipeline::ComputePipeline(const Instance& instance, Scheduler& scheduler,
     const vk::PushConstantRange push_constants = {
         .stageFlags = vk::ShaderStageFlagBits::eCompute,
         .offset = 0,
-        .size = sizeof(Shader::PushData),
+        .size = GetPushConstantsSize(),
     };
 
-    uses_push_descriptors = binding < instance.MaxPushDescriptors();
-    const auto flags = uses_push_descriptors
-                           ? vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR
-                           : vk::DescriptorSetLayoutCreateFlagBits{};
+    const auto flags = GetSetLayoutFlags(binding);
     const vk::DescriptorSetLayoutCreateInfo desc_layout_ci = {
         .flags = flags,
         .bindingCount = static_cast<u32>(bindings.size()),
@@ -83,11 +82,12 @@ ComputePipeline::ComputePipeline(const Instance& instance, Scheduler& scheduler,
                "Failed to create compute descriptor set layout: {}",
                vk::to_string(descriptor_set_result));
     desc_layout = std::move(descriptor_set);
+    InitDescriptorBufferLayout(binding);
 
-    const vk::DescriptorSetLayout set_layout = *desc_layout;
+    const auto set_layouts = GetSetLayouts();
     const vk::PipelineLayoutCreateInfo layout_info = {
-        .setLayoutCount = 1U,
-        .pSetLayouts = &set_layout,
+        .setLayoutCount = static_cast<u32>(set_layouts.size()),
+        .pSetLayouts = set_layouts.data(),
         .pushConstantRangeCount = 1U,
         .pPushConstantRanges = &push_constants,
     };
@@ -97,7 +97,31 @@ ComputePipeline::ComputePipeline(const Instance& instance, Scheduler& scheduler,
     pipeline_layout = std::move(layout);
     SetObjectName(device, *pipeline_layout, "Compute PipelineLayout {}", debug_str);
 
+    if (deferred) {
+        is_ready.store(false, std::memory_order_relaxed);
+        return;
+    }
+    Build(pipeline_cache, module);
+}
+
+void ComputePipeline::Build(vk::PipelineCache pipeline_cache, vk::ShaderModule module) {
+    const auto device = instance.GetDevice();
+    const auto debug_str = GetDebugString();
+
+    // Lane ids, ballots and swizzles of the guest code assume 64 lanes per subgroup
+    const vk::PipelineShaderStageRequiredSubgroupSizeCreateInfo subgroup_size_ci = {
+        .requiredSubgroupSize = Instance::GuestWaveSize,
+    };
+    const bool set_subgroup_size = instance.IsGuestWaveSizeSupported() &&
+                                   instance.SubgroupSize() != Instance::GuestWaveSize;
+    const vk::PipelineShaderStageCreateInfo shader_ci = {
+        .pNext = set_subgroup_size ? &subgroup_size_ci : nullptr,
+        .stage = vk::ShaderStageFlagBits::eCompute,
+        .module = module,
+        .pName = "main",
+    };
     const vk::ComputePipelineCreateInfo compute_pipeline_ci = {
+        .flags = GetPipelineFlags(),
         .stage = shader_ci,
         .layout = *pipeline_layout,
     };
@@ -107,6 +131,9 @@ ComputePipeline::ComputePipeline(const Instance& instance, Scheduler& scheduler,
                vk::to_string(pipeline_result));
     pipeline = std::move(pipe);
     SetObjectName(device, *pipeline, "Compute Pipeline {}", debug_str);
+
+    is_ready.store(true, std::memory_order_release);
+    is_ready.notify_all();
 }
 
 ComputePipeline::~ComputePipeline() = default;
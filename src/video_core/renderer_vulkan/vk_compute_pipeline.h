@@ -19,6 +19,7 @@ namespace Vulkan {
 
 class Instance;
 class Scheduler;
+class DescriptorBuffer;
 class DescriptorHeap;
 
 struct ComputePipelineKey {
@@ -45,11 +46,20 @@ public:
     };
 
     ComputePipeline(const Instance& instance, Scheduler& scheduler, DescriptorHeap& desc_heap,
+                    DescriptorBuffer* desc_buffer, const SamplerHeap* sampler_heap,
                     const Shader::Profile& profile, vk::PipelineCache pipeline_cache,
-                    ComputePipelineKey compute_key, const Shader::Info& info,
-                    vk::ShaderModule module, SerializationSupport& sdata, bool preloading);
+                    ComputePipelineKey compute_key,
+                    const Shader::Info& info, vk::ShaderModule module, SerializationSupport& sdata,
+                    bool preloading, bool deferred = false);
     ~ComputePipeline();
 
+    /// Creates the pipeline object, see GraphicsPipeline::Build.
+    void Build(vk::PipelineCache pipeline_cache, vk::ShaderModule module);
+
+    const ComputePipelineKey& GetComputeKey() const {
+        return compute_key;
+    }
+
 private:
     ComputePipelineKey compute_key;
 };
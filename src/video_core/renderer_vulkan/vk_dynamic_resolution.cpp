@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <mutex>
+
+#include "common/config.h"
+#include "common/logging/log.h"
+#include "core/debug_state.h"
+#include "video_core/renderer_vulkan/vk_dynamic_resolution.h"
+
+namespace Vulkan {
+
+// Frames the scale is held for after a change, frame recreation and the time average settle.
+constexpr u32 MinFramesBetweenChanges = 30;
+constexpr float ScaleStep = 0.05f;
+// The scale goes down when above the first fraction of the target and up when below the second.
+constexpr double DecreaseThreshold = 0.95;
+constexpr double IncreaseThreshold = 0.75;
+
+void DynamicResolution::Update() {
+    if (!Config::isDynamicResolutionEnabled()) {
+        scale = 1.0f;
+        return;
+    }
+    double busy_ms = 0.0;
+    {
+        std::scoped_lock lock{DebugState.gpu_timings_mutex};
+        const auto& timings = DebugState.gpu_timings;
+        if (timings.frame == last_frame || timings.scopes.empty()) {
+            return;
+        }
+        last_frame = timings.frame;
+        busy_ms = timings.GetBusyMs();
+    }
+    average_ms = average_ms == 0.0 ? busy_ms : average_ms * 0.9 + busy_ms * 0.1;
+
+    if (++frames_since_change < MinFramesBetweenChanges) {
+        return;
+    }
+    const double target_ms = 1000.0 / std::max(Config::getDynamicResolutionTargetFps(), 1);
+    float new_scale = scale;
+    if (average_ms > target_ms * DecreaseThreshold) {
+        new_scale = std::max(scale - ScaleStep, MinScale);
+    } else if (average_ms < target_ms * IncreaseThreshold) {
+        new_scale = std::min(scale + ScaleStep, 1.0f);
+    }
+    if (new_scale != scale) {
+        LOG_DEBUG(Render_Vulkan, "Output scale {:.2f} -> {:.2f}, GPU time {:.2f} ms", scale,
+                  new_scale, average_ms);
+        scale = new_scale;
+        frames_since_change = 0;
+    }
+}
+
+} // namespace Vulkan
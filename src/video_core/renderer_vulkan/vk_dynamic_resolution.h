@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "common/types.h"
+
+namespace Vulkan {
+
+/// Scales the size the presenter upscales frames to, so the GPU time of a frame stays under the
+/// target. The GPU time is the busy time of the profiler scopes of the newest frame read back.
+class DynamicResolution {
+public:
+    static constexpr float MinScale = 0.5f;
+
+    /// Takes the newest frame read back by the GPU profiler into account.
+    void Update();
+
+    /// Returns the factor to apply to the output size.
+    [[nodiscard]] float Scale() const noexcept {
+        return scale;
+    }
+
+private:
+    u64 last_frame{};
+    double average_ms{};
+    u32 frames_since_change{};
+    float scale{1.0f};
+};
+
+} // namespace Vulkan
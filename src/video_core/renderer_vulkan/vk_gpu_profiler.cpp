@@ -0,0 +1,181 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <mutex>
+
+#include "common/assert.h"
+#include "core/debug_state.h"
+#include "video_core/renderer_vulkan/vk_gpu_profiler.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/renderer_vulkan/vk_master_semaphore.h"
+
+namespace Vulkan {
+
+namespace {
+
+struct ReadScope {
+    std::string name;
+    u32 depth;
+    double begin_ns;
+    double end_ns;
+};
+
+/// Scopes read back for the newest frame, shared by the profilers of every scheduler. A frame is
+/// published once the first scope of a later one is read back.
+struct PendingFrame {
+    std::mutex mutex;
+    u64 frame{};
+    std::vector<ReadScope> scopes;
+};
+
+PendingFrame pending_frame;
+
+void PublishFrame(u64 frame, std::vector<ReadScope>& scopes) {
+    std::ranges::sort(scopes, {}, &ReadScope::begin_ns);
+    GpuFrameTimings timings{.frame = frame};
+    timings.scopes.reserve(scopes.size());
+    const double frame_begin_ns = scopes.front().begin_ns;
+    for (auto& scope : scopes) {
+        timings.scopes.push_back({
+            .name = std::move(scope.name),
+            .depth = scope.depth,
+            .begin_ms = (scope.begin_ns - frame_begin_ns) / 1'000'000.0,
+            .duration_ms = std::max(scope.end_ns - scope.begin_ns, 0.0) / 1'000'000.0,
+        });
+    }
+    std::scoped_lock lock{DebugState.gpu_timings_mutex};
+    DebugState.gpu_timings = std::move(timings);
+}
+
+void AddReadScope(u64 frame, ReadScope&& scope) {
+    std::scoped_lock lock{pending_frame.mutex};
+    if (frame < pending_frame.frame) {
+        // Read back after its frame was published
+        return;
+    }
+    if (frame > pending_frame.frame) {
+        if (!pending_frame.scopes.empty()) {
+            PublishFrame(pending_frame.frame, pending_frame.scopes);
+        }
+        pending_frame.frame = frame;
+        pending_frame.scopes.clear();
+    }
+    pending_frame.scopes.push_back(std::move(scope));
+}
+
+} // Anonymous namespace
+
+GpuProfiler::GpuProfiler(const Instance& instance, MasterSemaphore* master_semaphore_)
+    : device{instance.GetDevice()}, master_semaphore{master_semaphore_} {
+    const auto physical_device = instance.GetPhysicalDevice();
+    timestamp_period = physical_device.getProperties().limits.timestampPeriod;
+    const u32 valid_bits = physical_device.getQueueFamilyProperties()
+                               .at(instance.GetGraphicsQueueFamilyIndex())
+                               .timestampValidBits;
+    timestamp_mask = valid_bits >= 64 ? ~0ULL : (1ULL << valid_bits) - 1;
+
+    const vk::QueryPoolCreateInfo pool_info = {
+        .queryType = vk::QueryType::eTimestamp,
+        .queryCount = NumQueries,
+    };
+    auto [pool_result, pool] = device.createQueryPoolUnique(pool_info);
+    ASSERT_MSG(pool_result == vk::Result::eSuccess, "Failed to create timestamp query pool: {}",
+               vk::to_string(pool_result));
+    query_pool = std::move(pool);
+    device.resetQueryPool(*query_pool, 0, NumQueries);
+}
+
+GpuProfiler::~GpuProfiler() = default;
+
+bool GpuProfiler::IsSupported(const Instance& instance) {
+    const auto physical_device = instance.GetPhysicalDevice();
+    const auto family_properties = physical_device.getQueueFamilyProperties();
+    return instance.IsHostQueryResetSupported() &&
+           family_properties.at(instance.GetGraphicsQueueFamilyIndex()).timestampValidBits != 0;
+}
+
+u64 GpuProfiler::BeginScope(vk::CommandBuffer cmdbuf, std::string_view name) {
+    // Keep a query for the end of every open scope
+    if (write_query - read_query + open_scopes + 2 > NumQueries) {
+        return InvalidScope;
+    }
+    const u64 query = write_query++;
+    // Bottom of pipe on both ends, so the scope covers the work recorded between them once the
+    // work before it is done.
+    cmdbuf.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *query_pool,
+                          static_cast<u32>(query % NumQueries));
+    scopes.push_back({
+        .name = std::string{name},
+        .frame = DebugState.GetFrameNum(),
+        .begin_query = query,
+        .end_query = InvalidQuery,
+        .end_tick = 0,
+        .depth = open_scopes++,
+    });
+    return first_scope + scopes.size() - 1;
+}
+
+void GpuProfiler::EndScope(vk::CommandBuffer cmdbuf, u64 scope_id) {
+    if (scope_id == InvalidScope) {
+        return;
+    }
+    Scope& scope = scopes[scope_id - first_scope];
+    scope.end_query = write_query++;
+    scope.end_tick = master_semaphore->CurrentTick();
+    cmdbuf.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *query_pool,
+                          static_cast<u32>(scope.end_query % NumQueries));
+    --open_scopes;
+}
+
+void GpuProfiler::Collect() {
+    while (!scopes.empty()) {
+        Scope& scope = scopes.front();
+        if (scope.end_query == InvalidQuery || !master_semaphore->IsFree(scope.end_tick)) {
+            break;
+        }
+        u64 begin{};
+        u64 end{};
+        if (!ReadTimestamp(scope.begin_query, begin) || !ReadTimestamp(scope.end_query, end)) {
+            break;
+        }
+        ReadScope read_scope{
+            .name = std::move(scope.name),
+            .depth = scope.depth,
+            .begin_ns = static_cast<double>(begin) * timestamp_period,
+            .end_ns = static_cast<double>(end) * timestamp_period,
+        };
+        AddReadScope(scope.frame, std::move(read_scope));
+        scopes.pop_front();
+        ++first_scope;
+
+        // Queries before the begin of the next scope all belong to scopes that were read back.
+        const u64 next_read = scopes.empty() ? write_query : scopes.front().begin_query;
+        ResetQueries(read_query, next_read);
+        read_query = next_read;
+    }
+}
+
+bool GpuProfiler::ReadTimestamp(u64 query, u64& timestamp) const {
+    const auto result =
+        device.getQueryPoolResults(*query_pool, static_cast<u32>(query % NumQueries), 1,
+                                   sizeof(u64), &timestamp, sizeof(u64),
+                                   vk::QueryResultFlagBits::e64);
+    timestamp &= timestamp_mask;
+    return result == vk::Result::eSuccess;
+}
+
+void GpuProfiler::ResetQueries(u64 begin, u64 end) const {
+    if (begin == end) {
+        return;
+    }
+    const u32 first = static_cast<u32>(begin % NumQueries);
+    const u32 count = static_cast<u32>(end - begin);
+    const u32 head = std::min(count, NumQueries - first);
+    device.resetQueryPool(*query_pool, first, head);
+    if (head != count) {
+        device.resetQueryPool(*query_pool, 0, count - head);
+    }
+}
+
+} // namespace Vulkan
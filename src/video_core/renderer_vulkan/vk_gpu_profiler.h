@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/types.h"
+#include "video_core/renderer_vulkan/vk_common.h"
+
+namespace Vulkan {
+
+class Instance;
+class MasterSemaphore;
+
+/// GPU time spent in a profiler scope, relative to the first scope of its frame.
+struct GpuScopeTiming {
+    std::string name;
+    u32 depth; ///< Number of scopes the scope is nested in
+    double begin_ms;
+    double duration_ms;
+};
+
+/// Profiler scopes of one flip frame, ordered by the time they started on the GPU.
+struct GpuFrameTimings {
+    u64 frame{};
+    std::vector<GpuScopeTiming> scopes;
+
+    /// GPU time of the frame, the sum of the outermost scopes as nested ones are part of them.
+    [[nodiscard]] double GetBusyMs() const {
+        double busy_ms = 0.0;
+        for (const auto& scope : scopes) {
+            if (scope.depth == 0) {
+                busy_ms += scope.duration_ms;
+            }
+        }
+        return busy_ms;
+    }
+};
+
+/// Brackets regions of the command buffers of a scheduler with timestamp queries. Results are
+/// read back without waiting once the submission that wrote them is done, a few frames late, and
+/// the scopes of every scheduler are published to the debug state per flip frame.
+class GpuProfiler {
+public:
+    static constexpr u64 InvalidScope = ~0ULL;
+
+    explicit GpuProfiler(const Instance& instance, MasterSemaphore* master_semaphore);
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    /// Returns true if the graphics queue can write timestamps that are reset from the host.
+    [[nodiscard]] static bool IsSupported(const Instance& instance);
+
+    /// Writes the starting timestamp of a scope. Returns InvalidScope when the queries are
+    /// exhausted by results that are not read back yet.
+    u64 BeginScope(vk::CommandBuffer cmdbuf, std::string_view name);
+
+    /// Writes the ending timestamp of a scope returned by BeginScope.
+    void EndScope(vk::CommandBuffer cmdbuf, u64 scope);
+
+    /// Reads back the scopes whose submissions are done and releases their queries.
+    void Collect();
+
+private:
+    static constexpr u32 NumQueries = 8192;
+    static constexpr u64 InvalidQuery = ~0ULL;
+
+    struct Scope {
+        std::string name;
+        u64 frame;
+        u64 begin_query;
+        u64 end_query;
+        u64 end_tick;
+        u32 depth;
+    };
+
+    [[nodiscard]] bool ReadTimestamp(u64 query, u64& timestamp) const;
+
+    void ResetQueries(u64 begin, u64 end) const;
+
+private:
+    vk::Device device;
+    MasterSemaphore* master_semaphore;
+    vk::UniqueQueryPool query_pool;
+    double timestamp_period{}; ///< Nanoseconds per timestamp tick
+    u64 timestamp_mask{};
+    std::deque<Scope> scopes; ///< In the order they began, until they are read back
+    u64 first_scope{};        ///< Id of the front of scopes
+    u64 write_query{};        ///< Queries are used as a ring, indices wrap at NumQueries
+    u64 read_query{};
+    u32 open_scopes{};
+};
+
+} // namespace Vulkan
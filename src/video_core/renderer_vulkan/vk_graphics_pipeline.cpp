@@ -10,6 +10,7 @@
 #include "video_core/renderer_vulkan/liverpool_to_vk.h"
 #include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/renderer_vulkan/vk_pipeline_library.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 #include "video_core/renderer_vulkan/vk_shader_util.h"
 
@@ -35,15 +36,29 @@ static bool IsPrimitiveTopologyList(const vk::PrimitiveTopology topology) {
            topology == vk::PrimitiveTopology::ePatchList;
 }
 
+template <typename T>
+static u64 HashValue(u64 seed, const T& value) {
+    return XXH3_64bits_withSeed(&value, sizeof(value), seed);
+}
+
+template <typename T>
+static u64 HashRange(u64 seed, const T* values, size_t count) {
+    return XXH3_64bits_withSeed(values, count * sizeof(T), seed);
+}
+
 GraphicsPipeline::GraphicsPipeline(
     const Instance& instance, Scheduler& scheduler, DescriptorHeap& desc_heap,
-    const Shader::Profile& profile, const GraphicsPipelineKey& key_,
-    vk::PipelineCache pipeline_cache, std::span<const Shader::Info*, MaxShaderStages> infos,
+    DescriptorBuffer* desc_buffer, const SamplerHeap* sampler_heap, const Shader::Profile& profile,
+    const GraphicsPipelineKey& key_, vk::PipelineCache pipeline_cache,
+    PipelineLibraryCache* library_cache_,
+    std::span<const Shader::Info*, MaxShaderStages> infos,
     std::span<const Shader::RuntimeInfo, MaxShaderStages> runtime_infos,
     std::optional<const Shader::Gcn::FetchShaderData> fetch_shader_,
-    std::span<const vk::ShaderModule> modules, SerializationSupport& sdata, bool preloading)
-    : Pipeline{instance, scheduler, desc_heap, profile, pipeline_cache}, key{key_},
-      fetch_shader{std::move(fetch_shader_)} {
+    std::span<const vk::ShaderModule> modules, SerializationSupport& sdata, bool preloading,
+    bool deferred)
+    : Pipeline{instance, scheduler, desc_heap, desc_buffer, sampler_heap, profile, pipeline_cache},
+      key{key_},
+      fetch_shader{std::move(fetch_shader_)}, library_cache{library_cache_} {
     const vk::Device device = instance.GetDevice();
     std::ranges::copy(infos, stages.begin());
     BuildDescSetLayout(preloading);
@@ -52,13 +67,13 @@ GraphicsPipeline::GraphicsPipeline(
     const vk::PushConstantRange push_constants = {
         .stageFlags = AllGraphicsStageBits,
         .offset = 0,
-        .size = sizeof(Shader::PushData),
+        .size = GetPushConstantsSize(),
     };
 
-    const vk::DescriptorSetLayout set_layout = *desc_layout;
+    const auto set_layouts = GetSetLayouts();
     const vk::PipelineLayoutCreateInfo layout_info = {
-        .setLayoutCount = 1U,
-        .pSetLayouts = &set_layout,
+        .setLayoutCount = static_cast<u32>(set_layouts.size()),
+        .pSetLayouts = set_layouts.data(),
         .pushConstantRangeCount = 1,
         .pPushConstantRanges = &push_constants,
     };
@@ -68,6 +83,11 @@ GraphicsPipeline::GraphicsPipeline(
     pipeline_layout = std::move(layout);
     SetObjectName(device, *pipeline_layout, "Graphics PipelineLayout {}", debug_str);
 
+    const bool is_rect_list = key.prim_type == AmdGpu::PrimitiveType::RectList;
+    const bool is_quad_list = key.prim_type == AmdGpu::PrimitiveType::QuadList;
+
+    // Everything that depends on guest state or on the shared runtime infos has to be gathered
+    // here, the remaining pipeline creation only relies on the key and serialization data.
     if (!preloading) {
         VertexInputs<AmdGpu::Buffer> guest_buffers;
         if (!instance.IsVertexInputDynamicState()) {
@@ -75,8 +95,41 @@ GraphicsPipeline::GraphicsPipeline(
             GetVertexInputs(sdata.vertex_attributes, sdata.vertex_bindings, sdata.divisors,
                             guest_buffers, vs_info.step_rate_0, vs_info.step_rate_1);
         }
+
+        const auto& fs_info = runtime_infos[u32(Shader::LogicalStage::Fragment)].fs_info;
+        sdata.multisampling = {
+            .rasterizationSamples = LiverpoolToVK::NumSamples(
+                key.num_samples, instance.GetColorSampleCounts() & instance.GetDepthSampleCounts()),
+            .sampleShadingEnable =
+                fs_info.addr_flags.persp_sample_ena || fs_info.addr_flags.linear_sample_ena,
+        };
+
+        if (!infos[u32(Shader::LogicalStage::TessellationControl)] &&
+            (is_rect_list || is_quad_list)) {
+            const auto type =
+                is_quad_list ? AuxShaderType::QuadListTCS : AuxShaderType::RectListTCS;
+            sdata.tcs = Shader::Backend::SPIRV::EmitAuxilaryTessShader(type, fs_info);
+        }
+        if (!infos[u32(Shader::LogicalStage::TessellationEval)] &&
+            (is_rect_list || is_quad_list)) {
+            sdata.tes = Shader::Backend::SPIRV::EmitAuxilaryTessShader(
+                AuxShaderType::PassthroughTES, fs_info);
+        }
     }
 
+    if (deferred) {
+        is_ready.store(false, std::memory_order_relaxed);
+        return;
+    }
+    Build(pipeline_cache, modules, sdata);
+}
+
+void GraphicsPipeline::Build(vk::PipelineCache pipeline_cache,
+                             std::span<const vk::ShaderModule> modules,
+                             const SerializationSupport& sdata) {
+    const vk::Device device = instance.GetDevice();
+    const auto debug_str = GetDebugString();
+
     const vk::PipelineVertexInputDivisorStateCreateInfo divisor_state = {
         .vertexBindingDivisorCount = static_cast<u32>(sdata.divisors.size()),
         .pVertexBindingDivisors = sdata.divisors.data(),
@@ -126,16 +179,6 @@ GraphicsPipeline::GraphicsPipeline(
         raster_chain.unlink<vk::PipelineRasterizationDepthClipStateCreateInfoEXT>();
     }
 
-    if (!preloading) {
-        const auto& fs_info = runtime_infos[u32(Shader::LogicalStage::Fragment)].fs_info;
-        sdata.multisampling = {
-            .rasterizationSamples = LiverpoolToVK::NumSamples(
-                key.num_samples, instance.GetColorSampleCounts() & instance.GetDepthSampleCounts()),
-            .sampleShadingEnable =
-                fs_info.addr_flags.persp_sample_ena || fs_info.addr_flags.linear_sample_ena,
-        };
-    }
-
     const vk::PipelineViewportDepthClipControlCreateInfoEXT clip_control = {
         .negativeOneToOne = key.clip_space == AmdGpu::ClipSpace::MinusWToW,
     };
@@ -163,6 +206,27 @@ GraphicsPipeline::GraphicsPipeline(
     if (instance.IsDynamicColorWriteMaskSupported()) {
         dynamic_states.push_back(vk::DynamicState::eColorWriteMaskEXT);
     }
+    // Pipeline keys leave out the state set dynamically, see PipelineCache::RefreshGraphicsKey
+    if (instance.IsDynamicPolygonModeSupported()) {
+        dynamic_states.push_back(vk::DynamicState::ePolygonModeEXT);
+    }
+    if (instance.IsDynamicDepthClampSupported()) {
+        dynamic_states.push_back(vk::DynamicState::eDepthClampEnableEXT);
+        if (instance.IsDepthClipEnableSupported()) {
+            dynamic_states.push_back(vk::DynamicState::eDepthClipEnableEXT);
+        }
+    }
+    if (instance.IsDynamicColorBlendSupported()) {
+        dynamic_states.push_back(vk::DynamicState::eColorBlendEnableEXT);
+        dynamic_states.push_back(vk::DynamicState::eColorBlendEquationEXT);
+    }
+    if (instance.IsDynamicLogicOpSupported()) {
+        dynamic_states.push_back(vk::DynamicState::eLogicOpEnableEXT);
+        dynamic_states.push_back(vk::DynamicState::eLogicOpEXT);
+    }
+    if (instance.IsDynamicProvokingVertexSupported()) {
+        dynamic_states.push_back(vk::DynamicState::eProvokingVertexModeEXT);
+    }
     if (instance.IsVertexInputDynamicState()) {
         dynamic_states.push_back(vk::DynamicState::eVertexInputEXT);
     } else if (!sdata.vertex_bindings.empty()) {
@@ -177,7 +241,7 @@ GraphicsPipeline::GraphicsPipeline(
     boost::container::static_vector<vk::PipelineShaderStageCreateInfo, MaxShaderStages>
         shader_stages;
     auto stage = u32(Shader::LogicalStage::Vertex);
-    if (infos[stage]) {
+    if (stages[stage]) {
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eVertex,
             .module = modules[stage],
@@ -185,7 +249,7 @@ GraphicsPipeline::GraphicsPipeline(
         });
     }
     stage = u32(Shader::LogicalStage::Geometry);
-    if (infos[stage]) {
+    if (stages[stage]) {
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eGeometry,
             .module = modules[stage],
@@ -193,18 +257,13 @@ GraphicsPipeline::GraphicsPipeline(
         });
     }
     stage = u32(Shader::LogicalStage::TessellationControl);
-    if (infos[stage]) {
+    if (stages[stage]) {
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eTessellationControl,
             .module = modules[stage],
             .pName = "main",
         });
     } else if (is_rect_list || is_quad_list) {
-        const auto type = is_quad_list ? AuxShaderType::QuadListTCS : AuxShaderType::RectListTCS;
-        if (!preloading) {
-            const auto& fs_info = runtime_infos[u32(Shader::LogicalStage::Fragment)].fs_info;
-            sdata.tcs = Shader::Backend::SPIRV::EmitAuxilaryTessShader(type, fs_info);
-        }
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eTessellationControl,
             .module = CompileSPV(sdata.tcs, instance.GetDevice()),
@@ -212,18 +271,13 @@ GraphicsPipeline::GraphicsPipeline(
         });
     }
     stage = u32(Shader::LogicalStage::TessellationEval);
-    if (infos[stage]) {
+    if (stages[stage]) {
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eTessellationEvaluation,
             .module = modules[stage],
             .pName = "main",
         });
     } else if (is_rect_list || is_quad_list) {
-        if (!preloading) {
-            const auto& fs_info = runtime_infos[u32(Shader::LogicalStage::Fragment)].fs_info;
-            sdata.tes = Shader::Backend::SPIRV::EmitAuxilaryTessShader(
-                AuxShaderType::PassthroughTES, fs_info);
-        }
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eTessellationEvaluation,
             .module = CompileSPV(sdata.tes, instance.GetDevice()),
@@ -231,7 +285,7 @@ GraphicsPipeline::GraphicsPipeline(
         });
     }
     stage = u32(Shader::LogicalStage::Fragment);
-    if (infos[stage]) {
+    if (stages[stage]) {
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eFragment,
             .module = modules[stage],
@@ -284,27 +338,19 @@ GraphicsPipeline::GraphicsPipeline(
     std::array<vk::PipelineColorBlendAttachmentState, AmdGpu::NUM_COLOR_BUFFERS> attachments;
     for (u32 i = 0; i < key.num_color_attachments; i++) {
         const auto& control = key.blend_controls[i];
+        const bool alpha_masked_out =
+            (key.cb_shader_mask.GetMask(i) & AmdGpu::ColorBufferMask::ComponentA) == 0;
+        const auto equation = LiverpoolToVK::BlendEquation(control, alpha_masked_out);
 
-        const auto src_color = LiverpoolToVK::BlendFactor(control.color_src_factor);
-        const auto dst_color = LiverpoolToVK::BlendFactor(control.color_dst_factor);
-        const auto color_blend = LiverpoolToVK::BlendOp(control.color_func);
-
-        const auto src_alpha = control.separate_alpha_blend
-                                   ? LiverpoolToVK::BlendFactor(control.alpha_src_factor)
-                                   : src_color;
-        const auto dst_alpha = control.separate_alpha_blend
-                                   ? LiverpoolToVK::BlendFactor(control.alpha_dst_factor)
-                                   : dst_color;
-        const auto alpha_blend =
-            control.separate_alpha_blend ? LiverpoolToVK::BlendOp(control.alpha_func) : color_blend;
-
-        const auto color_scaled_min_max =
-            (color_blend == vk::BlendOp::eMin || color_blend == vk::BlendOp::eMax) &&
-            (src_color != vk::BlendFactor::eOne || dst_color != vk::BlendFactor::eOne);
-        const auto alpha_scaled_min_max =
-            (alpha_blend == vk::BlendOp::eMin || alpha_blend == vk::BlendOp::eMax) &&
-            (src_alpha != vk::BlendFactor::eOne || dst_alpha != vk::BlendFactor::eOne);
-        if (color_scaled_min_max || alpha_scaled_min_max) {
+        const auto is_scaled_min_max = [](vk::BlendOp op, vk::BlendFactor src,
+                                          vk::BlendFactor dst) {
+            return (op == vk::BlendOp::eMin || op == vk::BlendOp::eMax) &&
+                   (src != vk::BlendFactor::eOne || dst != vk::BlendFactor::eOne);
+        };
+        if (is_scaled_min_max(equation.colorBlendOp, equation.srcColorBlendFactor,
+                              equation.dstColorBlendFactor) ||
+            is_scaled_min_max(equation.alphaBlendOp, equation.srcAlphaBlendFactor,
+                              equation.dstAlphaBlendFactor)) {
             LOG_WARNING(
                 Render_Vulkan,
                 "Unimplemented use of min/max blend op with blend factor not equal to one.");
@@ -312,41 +358,18 @@ GraphicsPipeline::GraphicsPipeline(
 
         attachments[i] = vk::PipelineColorBlendAttachmentState{
             .blendEnable = control.enable,
-            .srcColorBlendFactor = src_color,
-            .dstColorBlendFactor = dst_color,
-            .colorBlendOp = color_blend,
-            .srcAlphaBlendFactor = src_alpha,
-            .dstAlphaBlendFactor = dst_alpha,
-            .alphaBlendOp = alpha_blend,
+            .srcColorBlendFactor = equation.srcColorBlendFactor,
+            .dstColorBlendFactor = equation.dstColorBlendFactor,
+            .colorBlendOp = equation.colorBlendOp,
+            .srcAlphaBlendFactor = equation.srcAlphaBlendFactor,
+            .dstAlphaBlendFactor = equation.dstAlphaBlendFactor,
+            .alphaBlendOp = equation.alphaBlendOp,
             .colorWriteMask =
                 instance.IsDynamicColorWriteMaskSupported()
                     ? vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
                           vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA
                     : key.write_masks[i],
         };
-
-        // On GCN GPU there is an additional mask which allows to control color components exported
-        // from a pixel shader. A situation possible, when the game may mask out the alpha channel,
-        // while it is still need to be used in blending ops. For such cases, HW will default alpha
-        // to 1 and perform the blending, while shader normally outputs 0 in the last component.
-        // Unfortunatelly, Vulkan doesn't provide any control on blend inputs, so below we detecting
-        // such cases and override alpha value in order to emulate HW behaviour.
-        const auto has_alpha_masked_out =
-            (key.cb_shader_mask.GetMask(i) & AmdGpu::ColorBufferMask::ComponentA) == 0;
-        const auto has_src_alpha_in_src_blend = src_color == vk::BlendFactor::eSrcAlpha ||
-                                                src_color == vk::BlendFactor::eOneMinusSrcAlpha;
-        const auto has_src_alpha_in_dst_blend = dst_color == vk::BlendFactor::eSrcAlpha ||
-                                                dst_color == vk::BlendFactor::eOneMinusSrcAlpha;
-        if (has_alpha_masked_out && has_src_alpha_in_src_blend) {
-            attachments[i].srcColorBlendFactor = src_color == vk::BlendFactor::eSrcAlpha
-                                                     ? vk::BlendFactor::eOne
-                                                     : vk::BlendFactor::eZero; // 1-A
-        }
-        if (has_alpha_masked_out && has_src_alpha_in_dst_blend) {
-            attachments[i].dstColorBlendFactor = dst_color == vk::BlendFactor::eSrcAlpha
-                                                     ? vk::BlendFactor::eOne
-                                                     : vk::BlendFactor::eZero; // 1-A
-        }
     }
 
     const vk::PipelineColorBlendStateCreateInfo color_blending = {
@@ -358,27 +381,130 @@ GraphicsPipeline::GraphicsPipeline(
         .blendConstants = std::array{1.0f, 1.0f, 1.0f, 1.0f},
     };
 
-    const vk::GraphicsPipelineCreateInfo pipeline_info = {
-        .pNext = &pipeline_rendering_ci,
-        .stageCount = static_cast<u32>(shader_stages.size()),
-        .pStages = shader_stages.data(),
-        .pVertexInputState = !instance.IsVertexInputDynamicState() ? &vertex_input_info : nullptr,
-        .pInputAssemblyState = &input_assembly,
-        .pTessellationState = &tessellation_state,
-        .pViewportState = &viewport_info,
-        .pRasterizationState = &raster_chain.get(),
-        .pMultisampleState = &sdata.multisampling,
-        .pColorBlendState = &color_blending,
-        .pDynamicState = &dynamic_info,
-        .layout = *pipeline_layout,
-    };
+    if (library_cache) {
+        // Every state subset is cached on its own, so pipelines that only differ in e.g. blend
+        // state or render target formats reuse the already compiled shader libraries and only
+        // pay for a fast link.
+        using enum PipelineLibraryType;
+        std::array<vk::Pipeline, size_t(Count)> libraries;
+
+        u64 hash = HashValue(0, topology);
+        if (!instance.IsVertexInputDynamicState()) {
+            hash = HashRange(hash, sdata.vertex_attributes.data(), sdata.vertex_attributes.size());
+            hash = HashRange(hash, sdata.vertex_bindings.data(), sdata.vertex_bindings.size());
+            hash = HashRange(hash, sdata.divisors.data(), sdata.divisors.size());
+        }
+        libraries[u32(VertexInput)] = library_cache->Get(
+            VertexInput, hash, pipeline_cache,
+            {
+                .pVertexInputState =
+                    !instance.IsVertexInputDynamicState() ? &vertex_input_info : nullptr,
+                .pInputAssemblyState = &input_assembly,
+                .pDynamicState = &dynamic_info,
+            });
+
+        // The fragment stage is always emitted last, anything before it is pre-rasterization.
+        const bool has_fs = stages[u32(Shader::LogicalStage::Fragment)] != nullptr;
+        const u32 num_pre_raster_stages = static_cast<u32>(shader_stages.size()) - has_fs;
+        hash = layout_hash;
+        for (const auto l_stage :
+             {Shader::LogicalStage::Vertex, Shader::LogicalStage::Geometry,
+              Shader::LogicalStage::TessellationControl, Shader::LogicalStage::TessellationEval}) {
+            if (stages[u32(l_stage)]) {
+                hash = HashValue(hash, key.stage_hashes[u32(l_stage)]);
+                hash = HashValue(hash, modules[u32(l_stage)]);
+            }
+        }
+        hash = HashRange(hash, sdata.tcs.data(), sdata.tcs.size());
+        hash = HashRange(hash, sdata.tes.data(), sdata.tes.size());
+        hash = HashValue(hash, tessellation_state.patchControlPoints);
+        hash = HashValue(hash, raster_chain.get().depthClampEnable);
+        hash = HashValue(hash, raster_chain.get().polygonMode);
+        hash = HashValue(hash, key.provoking_vtx_last);
+        hash = HashValue(hash, key.depth_clip_enable);
+        hash = HashValue(hash, key.clip_space);
+        libraries[u32(PreRasterization)] =
+            library_cache->Get(PreRasterization, hash, pipeline_cache,
+                               {
+                                   .pNext = &pipeline_rendering_ci,
+                                   .stageCount = num_pre_raster_stages,
+                                   .pStages = shader_stages.data(),
+                                   .pTessellationState = &tessellation_state,
+                                   .pViewportState = &viewport_info,
+                                   .pRasterizationState = &raster_chain.get(),
+                                   .pDynamicState = &dynamic_info,
+                                   .layout = *pipeline_layout,
+                               });
+
+        hash = layout_hash;
+        if (has_fs) {
+            hash = HashValue(hash, key.stage_hashes[u32(Shader::LogicalStage::Fragment)]);
+            hash = HashValue(hash, modules[u32(Shader::LogicalStage::Fragment)]);
+        }
+        hash = HashValue(hash, sdata.multisampling.rasterizationSamples);
+        hash = HashValue(hash, sdata.multisampling.sampleShadingEnable);
+        libraries[u32(FragmentShader)] =
+            library_cache->Get(FragmentShader, hash, pipeline_cache,
+                               {
+                                   .pNext = &pipeline_rendering_ci,
+                                   .stageCount = has_fs ? 1U : 0U,
+                                   .pStages = has_fs ? &shader_stages.back() : nullptr,
+                                   .pMultisampleState = &sdata.multisampling,
+                                   .pDynamicState = &dynamic_info,
+                                   .layout = *pipeline_layout,
+                               });
+
+        const auto num_attachments = size_t(key.num_color_attachments);
+        hash = HashValue(0, sdata.multisampling.rasterizationSamples);
+        hash = HashValue(hash, sdata.multisampling.sampleShadingEnable);
+        hash = HashRange(hash, color_formats.data(), num_attachments);
+        hash = HashRange(hash, attachments.data(), num_attachments);
+        hash = HashValue(hash, pipeline_rendering_ci.depthAttachmentFormat);
+        hash = HashValue(hash, pipeline_rendering_ci.stencilAttachmentFormat);
+        if (instance.IsMixedDepthSamplesSupported()) {
+            hash = HashRange(hash, color_samples.data(), num_attachments);
+            hash = HashValue(hash, mixed_samples.depthStencilAttachmentSamples);
+        }
+        hash = HashValue(hash, color_blending.logicOpEnable);
+        hash = HashValue(hash, color_blending.logicOp);
+        libraries[u32(FragmentOutput)] =
+            library_cache->Get(FragmentOutput, hash, pipeline_cache,
+                               {
+                                   .pNext = &pipeline_rendering_ci,
+                                   .pMultisampleState = &sdata.multisampling,
+                                   .pColorBlendState = &color_blending,
+                                   .pDynamicState = &dynamic_info,
+                               });
+
+        pipeline = library_cache->Link(libraries, *pipeline_layout, pipeline_cache);
+    } else {
+        const vk::GraphicsPipelineCreateInfo pipeline_info = {
+            .pNext = &pipeline_rendering_ci,
+            .flags = GetPipelineFlags(),
+            .stageCount = static_cast<u32>(shader_stages.size()),
+            .pStages = shader_stages.data(),
+            .pVertexInputState =
+                !instance.IsVertexInputDynamicState() ? &vertex_input_info : nullptr,
+            .pInputAssemblyState = &input_assembly,
+            .pTessellationState = &tessellation_state,
+            .pViewportState = &viewport_info,
+            .pRasterizationState = &raster_chain.get(),
+            .pMultisampleState = &sdata.multisampling,
+            .pColorBlendState = &color_blending,
+            .pDynamicState = &dynamic_info,
+            .layout = *pipeline_layout,
+        };
 
-    auto [pipeline_result, pipe] =
-        device.createGraphicsPipelineUnique(pipeline_cache, pipeline_info);
-    ASSERT_MSG(pipeline_result == vk::Result::eSuccess, "Failed to create graphics pipeline: {}",
-               vk::to_string(pipeline_result));
-    pipeline = std::move(pipe);
+        auto [pipeline_result, pipe] =
+            device.createGraphicsPipelineUnique(pipeline_cache, pipeline_info);
+        ASSERT_MSG(pipeline_result == vk::Result::eSuccess,
+                   "Failed to create graphics pipeline: {}", vk::to_string(pipeline_result));
+        pipeline = std::move(pipe);
+    }
     SetObjectName(device, *pipeline, "Graphics Pipeline {}", debug_str);
+
+    is_ready.store(true, std::memory_order_release);
+    is_ready.notify_all();
 }
 
 GraphicsPipeline::~GraphicsPipeline() = default;
@@ -438,6 +564,7 @@ template void GraphicsPipeline::GetVertexInputs(
 void GraphicsPipeline::BuildDescSetLayout(bool preloading) {
     boost::container::small_vector<vk::DescriptorSetLayoutBinding, 32> bindings;
     u32 binding{};
+    u32 sampler_index{};
 
     for (const auto* stage : stages) {
         if (!stage) {
@@ -466,6 +593,10 @@ void GraphicsPipeline::BuildDescSetLayout(bool preloading) {
             });
         }
         for (const auto& sampler : stage->samplers) {
+            if (IsBindlessSampler(sampler_index++)) {
+                ++binding;
+                continue;
+            }
             bindings.push_back({
                 .binding = binding++,
                 .descriptorType = vk::DescriptorType::eSampler,
@@ -474,10 +605,8 @@ void GraphicsPipeline::BuildDescSetLayout(bool preloading) {
             });
         }
     }
-    uses_push_descriptors = binding < instance.MaxPushDescriptors();
-    const auto flags = uses_push_descriptors
-                           ? vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR
-                           : vk::DescriptorSetLayoutCreateFlagBits{};
+    const auto flags = GetSetLayoutFlags(binding);
+    layout_hash = HashRange(HashValue(0, uses_push_descriptors), bindings.data(), bindings.size());
     const vk::DescriptorSetLayoutCreateInfo desc_layout_ci = {
         .flags = flags,
         .bindingCount = static_cast<u32>(bindings.size()),
@@ -488,6 +617,7 @@ void GraphicsPipeline::BuildDescSetLayout(bool preloading) {
     ASSERT_MSG(layout_result == vk::Result::eSuccess,
                "Failed to create graphics descriptor set layout: {}", vk::to_string(layout_result));
     desc_layout = std::move(layout);
+    InitDescriptorBufferLayout(binding);
 }
 
 } // namespace Vulkan
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <type_traits>
 #include <boost/container/static_vector.hpp>
 #include <xxhash.h>
 
@@ -24,11 +26,17 @@ static constexpr u32 MaxVertexBufferCount = 32;
 
 class Instance;
 class Scheduler;
+class DescriptorBuffer;
 class DescriptorHeap;
+class PipelineLibraryCache;
 
 template <typename T>
 using VertexInputs = boost::container::static_vector<T, MaxVertexBufferCount>;
 
+/**
+ * Graphics state a pipeline is specialized on. The key is zeroed before it is filled so padding
+ * compares equal, it is hashed in one pass over its bytes, up to the hash that caches the result.
+ */
 struct GraphicsPipelineKey {
     std::array<size_t, MaxShaderStages> stage_hashes;
     std::array<vk::Format, MaxVertexBufferCount> vertex_buffer_formats;
@@ -55,19 +63,31 @@ struct GraphicsPipelineKey {
         AmdGpu::ProvokingVtxLast provoking_vtx_last : 1;
         u32 depth_clip_enable : 1;
     };
+    u64 hash; ///< Of the bytes before it, set by UpdateHash once the key is filled
 
     GraphicsPipelineKey() {
         std::memset(this, 0, sizeof(*this));
     }
 
+    void UpdateHash() noexcept;
+
     bool operator==(const GraphicsPipelineKey& key) const noexcept {
-        return std::memcmp(this, &key, sizeof(key)) == 0;
+        // Most mismatching keys are told apart by the hash
+        return hash == key.hash && std::memcmp(this, &key, sizeof(key)) == 0;
     }
 
     void Serialize(Serialization::Archive& ar) const;
     bool Deserialize(Serialization::Archive& ar);
 };
 
+static_assert(std::is_trivially_copyable_v<GraphicsPipelineKey>);
+static_assert(offsetof(GraphicsPipelineKey, hash) + sizeof(u64) == sizeof(GraphicsPipelineKey),
+              "The key must end with its hash, without padding after it");
+
+inline void GraphicsPipelineKey::UpdateHash() noexcept {
+    hash = XXH3_64bits(this, offsetof(GraphicsPipelineKey, hash));
+}
+
 class GraphicsPipeline : public Pipeline {
 public:
     struct SerializationSupport {
@@ -83,15 +103,23 @@ public:
     };
 
     GraphicsPipeline(const Instance& instance, Scheduler& scheduler, DescriptorHeap& desc_heap,
+                     DescriptorBuffer* desc_buffer, const SamplerHeap* sampler_heap,
                      const Shader::Profile& profile, const GraphicsPipelineKey& key,
                      vk::PipelineCache pipeline_cache,
+                     PipelineLibraryCache* library_cache,
                      std::span<const Shader::Info*, MaxShaderStages> stages,
                      std::span<const Shader::RuntimeInfo, MaxShaderStages> runtime_infos,
                      std::optional<const Shader::Gcn::FetchShaderData> fetch_shader,
                      std::span<const vk::ShaderModule> modules, SerializationSupport& sdata,
-                     bool preloading);
+                     bool preloading, bool deferred = false);
     ~GraphicsPipeline();
 
+    /// Creates the pipeline object. Done by the constructor, unless creation was deferred to a
+    /// compile worker, in which case the pipeline stays not ready until this has returned.
+    /// With a library cache the pipeline is linked from separately cached state subsets.
+    void Build(vk::PipelineCache pipeline_cache, std::span<const vk::ShaderModule> modules,
+               const SerializationSupport& sdata);
+
     const std::optional<const Shader::Gcn::FetchShaderData>& GetFetchShader() const noexcept {
         return fetch_shader;
     }
@@ -100,6 +128,10 @@ public:
         return key;
     }
 
+    bool HasGeometryStage() const noexcept {
+        return stages[u32(Shader::LogicalStage::Geometry)] != nullptr;
+    }
+
     /// Gets the attributes and bindings for vertex inputs.
     template <typename Attribute, typename Binding>
     void GetVertexInputs(VertexInputs<Attribute>& attributes, VertexInputs<Binding>& bindings,
@@ -113,6 +145,8 @@ private:
 private:
     GraphicsPipelineKey key;
     std::optional<const Shader::Gcn::FetchShaderData> fetch_shader{};
+    PipelineLibraryCache* library_cache{};
+    u64 layout_hash{};
 };
 
 } // namespace Vulkan
@@ -120,6 +154,6 @@ private:
 template <>
 struct std::hash<Vulkan::GraphicsPipelineKey> {
     std::size_t operator()(const Vulkan::GraphicsPipelineKey& key) const noexcept {
-        return XXH3_64bits(&key, sizeof(key));
+        return key.hash;
     }
 };
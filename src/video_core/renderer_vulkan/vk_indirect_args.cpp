@@ -0,0 +1,182 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <utility>
+
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/div_ceil.h"
+#include "video_core/renderer_vulkan/vk_indirect_args.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/renderer_vulkan/vk_platform.h"
+#include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/renderer_vulkan/vk_shader_util.h"
+
+#include "video_core/host_shaders/indirect_args_repack_comp.h"
+
+namespace Vulkan {
+
+namespace {
+
+struct RepackParams {
+    u32 src_offset;
+    u32 src_stride;
+    u32 num_dwords;
+    u32 max_count;
+    u32 count_offset;
+    u32 has_count;
+};
+
+} // Anonymous namespace
+
+IndirectArgsRepacker::IndirectArgsRepacker(const Instance& instance_, Scheduler& scheduler_)
+    : instance{instance_}, scheduler{scheduler_},
+      repack_buffer{instance, scheduler, VideoCore::MemoryUsage::DeviceLocal, 0,
+                    vk::BufferUsageFlagBits::eStorageBuffer |
+                        vk::BufferUsageFlagBits::eIndirectBuffer,
+                    RepackBufferSize} {
+    const auto device = instance.GetDevice();
+    Vulkan::SetObjectName(device, repack_buffer.Handle(), "Indirect Args Repack Buffer");
+
+    std::array<vk::DescriptorSetLayoutBinding, 3> bindings{};
+    for (u32 i = 0; i < bindings.size(); ++i) {
+        bindings[i] = {
+            .binding = i,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .descriptorCount = 1,
+            .stageFlags = vk::ShaderStageFlagBits::eCompute,
+        };
+    }
+    const vk::DescriptorSetLayoutCreateInfo desc_layout_ci = {
+        .flags = vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR,
+        .bindingCount = static_cast<u32>(bindings.size()),
+        .pBindings = bindings.data(),
+    };
+    desc_layout = Check(device.createDescriptorSetLayoutUnique(desc_layout_ci));
+
+    const auto module = Compile(HostShaders::INDIRECT_ARGS_REPACK_COMP,
+                                vk::ShaderStageFlagBits::eCompute, device);
+    SetObjectName(device, module, "Indirect Args Repack");
+
+    const vk::PushConstantRange push_range = {
+        .stageFlags = vk::ShaderStageFlagBits::eCompute,
+        .offset = 0,
+        .size = sizeof(RepackParams),
+    };
+    const vk::PipelineLayoutCreateInfo layout_info = {
+        .setLayoutCount = 1U,
+        .pSetLayouts = &(*desc_layout),
+        .pushConstantRangeCount = 1U,
+        .pPushConstantRanges = &push_range,
+    };
+    pipeline_layout = Check(device.createPipelineLayoutUnique(layout_info));
+
+    const vk::ComputePipelineCreateInfo pipeline_info = {
+        .stage =
+            {
+                .stage = vk::ShaderStageFlagBits::eCompute,
+                .module = module,
+                .pName = "main",
+            },
+        .layout = *pipeline_layout,
+    };
+    pipeline = Check(device.createComputePipelineUnique({}, pipeline_info));
+    SetObjectName(device, *pipeline, "Indirect Args Repack Pipeline");
+
+    device.destroyShaderModule(module);
+}
+
+IndirectArgsRepacker::~IndirectArgsRepacker() = default;
+
+std::optional<IndirectArgsRepacker::Args> IndirectArgsRepacker::Repack(
+    const VideoCore::Buffer& args_buffer, u32 args_offset, u32 stride, u32 num_dwords,
+    u32 max_count, const VideoCore::Buffer* count_buffer, u32 count_offset) {
+    ASSERT(args_offset % 4 == 0 && stride % 4 == 0 && count_offset % 4 == 0);
+    const u32 size = max_count * num_dwords * sizeof(u32);
+    if (max_count == 0 || size > RepackBufferSize) {
+        return std::nullopt;
+    }
+    const u32 alignment = static_cast<u32>(instance.StorageMinAlignment());
+    if (write_offset + size > RepackBufferSize) {
+        write_offset = 0;
+    }
+    const u32 dst_offset = write_offset;
+    write_offset = Common::AlignUp(write_offset + size, alignment);
+
+    // Storage buffers are bound at aligned offsets, the shader skips to the data
+    const auto bind = [&](const VideoCore::Buffer& buffer, u32 offset, u32 range) {
+        const u32 aligned = Common::AlignDown(offset, alignment);
+        const vk::DescriptorBufferInfo info = {
+            .buffer = buffer.Handle(),
+            .offset = aligned,
+            .range = offset - aligned + range,
+        };
+        return std::make_pair(info, (offset - aligned) / 4);
+    };
+    const auto [src_info, src_offset] =
+        bind(args_buffer, args_offset, (max_count - 1) * stride + num_dwords * sizeof(u32));
+    const auto [count_info, count_dword] = count_buffer
+                                               ? bind(*count_buffer, count_offset, sizeof(u32))
+                                               : bind(args_buffer, args_offset, sizeof(u32));
+    const vk::DescriptorBufferInfo dst_info = {
+        .buffer = repack_buffer.Handle(),
+        .offset = dst_offset,
+        .range = size,
+    };
+    const std::array<vk::DescriptorBufferInfo, 3> infos = {src_info, count_info, dst_info};
+    std::array<vk::WriteDescriptorSet, 3> writes{};
+    for (u32 i = 0; i < writes.size(); ++i) {
+        writes[i] = {
+            .dstSet = VK_NULL_HANDLE,
+            .dstBinding = i,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .pBufferInfo = &infos[i],
+        };
+    }
+    const RepackParams params = {
+        .src_offset = src_offset,
+        .src_stride = stride / 4,
+        .num_dwords = num_dwords,
+        .max_count = max_count,
+        .count_offset = count_dword,
+        .has_count = count_buffer != nullptr,
+    };
+
+    // The arguments may have just been written by the GPU, and the ring by earlier draws read
+    const vk::MemoryBarrier2 pre_barrier = {
+        .srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+        .srcAccessMask = vk::AccessFlagBits2::eMemoryWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+        .dstAccessMask = vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eShaderWrite,
+    };
+    const vk::BufferMemoryBarrier2 post_barrier = {
+        .srcStageMask = vk::PipelineStageFlagBits2::eComputeShader,
+        .srcAccessMask = vk::AccessFlagBits2::eShaderWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eDrawIndirect,
+        .dstAccessMask = vk::AccessFlagBits2::eIndirectCommandRead,
+        .buffer = repack_buffer.Handle(),
+        .offset = dst_offset,
+        .size = size,
+    };
+    scheduler.EndRendering();
+    const auto cmdbuf = scheduler.CommandBuffer();
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &pre_barrier,
+    });
+    cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+    cmdbuf.pushDescriptorSetKHR(vk::PipelineBindPoint::eCompute, *pipeline_layout, 0, writes);
+    cmdbuf.pushConstants(*pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(params),
+                         &params);
+    cmdbuf.dispatch(Common::DivCeil(max_count, 64u), 1, 1);
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .bufferMemoryBarrierCount = 1,
+        .pBufferMemoryBarriers = &post_barrier,
+    });
+    return Args{repack_buffer.Handle(), dst_offset};
+}
+
+} // namespace Vulkan
@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <optional>
+
+#include "common/types.h"
+#include "video_core/buffer_cache/buffer.h"
+#include "video_core/renderer_vulkan/vk_common.h"
+
+namespace Vulkan {
+
+class Instance;
+class Scheduler;
+
+/**
+ * Rewrites indirect draw arguments Vulkan can't draw from as they are, such as strides it
+ * doesn't allow or counts the device can't read, into tightly packed arguments on the GPU.
+ */
+class IndirectArgsRepacker {
+public:
+    explicit IndirectArgsRepacker(const Instance& instance, Scheduler& scheduler);
+    ~IndirectArgsRepacker();
+
+    IndirectArgsRepacker(const IndirectArgsRepacker&) = delete;
+    IndirectArgsRepacker& operator=(const IndirectArgsRepacker&) = delete;
+
+    struct Args {
+        vk::Buffer buffer;
+        vk::DeviceSize offset;
+    };
+
+    /**
+     * Copies max_count draws of num_dwords arguments, stride bytes apart, to a packed buffer.
+     * Draws from the count read at count_offset of count_buffer on are given no instances. Must
+     * be called outside of a render pass. Returns nothing when the draws don't fit.
+     */
+    std::optional<Args> Repack(const VideoCore::Buffer& args_buffer, u32 args_offset, u32 stride,
+                               u32 num_dwords, u32 max_count,
+                               const VideoCore::Buffer* count_buffer, u32 count_offset);
+
+private:
+    static constexpr u32 RepackBufferSize = 4_MB;
+
+    const Instance& instance;
+    Scheduler& scheduler;
+    VideoCore::Buffer repack_buffer; ///< Used as a ring
+    u32 write_offset{};
+    vk::UniqueDescriptorSetLayout desc_layout;
+    vk::UniquePipelineLayout pipeline_layout;
+    vk::UniquePipeline pipeline;
+};
+
+} // namespace Vulkan
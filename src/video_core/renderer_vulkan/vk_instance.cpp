@@ -6,6 +6,7 @@
 #include <fmt/ranges.h>
 
 #include "common/assert.h"
+#include "common/config.h"
 #include "common/debug.h"
 #include "common/types.h"
 #include "sdl_window.h"
@@ -94,8 +95,12 @@ Instance::Instance(bool enable_validation, bool enable_crash_diagnostic)
 
 Instance::Instance(Frontend::WindowSDL& window, s32 physical_device_index,
                    bool enable_validation /*= false*/, bool enable_crash_diagnostic /*= false*/)
-    : instance{CreateInstance(window.GetWindowInfo().type, enable_validation,
-                              enable_crash_diagnostic)},
+    : Instance(window.GetWindowInfo().type, physical_device_index, enable_validation,
+               enable_crash_diagnostic) {}
+
+Instance::Instance(Frontend::WindowSystemType window_type, s32 physical_device_index,
+                   bool enable_validation /*= false*/, bool enable_crash_diagnostic /*= false*/)
+    : instance{CreateInstance(window_type, enable_validation, enable_crash_diagnostic)},
       physical_devices{EnumeratePhysicalDevices(instance)} {
     if (enable_validation) {
         debug_callback = CreateDebugCallback(*instance);
@@ -183,6 +188,11 @@ Instance::Instance(Frontend::WindowSDL& window, s32 physical_device_index,
 }
 
 Instance::~Instance() {
+    for (const VmaPool pool : memory_pools) {
+        if (pool) {
+            vmaDestroyPool(allocator, pool);
+        }
+    }
     vmaDestroyAllocator(allocator);
 }
 
@@ -211,27 +221,48 @@ bool Instance::CreateDevice() {
             .getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan11Features,
                           vk::PhysicalDeviceVulkan12Features, vk::PhysicalDeviceVulkan13Features,
                           vk::PhysicalDeviceRobustness2FeaturesEXT,
+                          vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT,
                           vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT,
                           vk::PhysicalDevicePrimitiveTopologyListRestartFeaturesEXT,
                           vk::PhysicalDevicePortabilitySubsetFeaturesKHR,
                           vk::PhysicalDeviceShaderAtomicFloat2FeaturesEXT,
-                          vk::PhysicalDeviceWorkgroupMemoryExplicitLayoutFeaturesKHR>();
+                          vk::PhysicalDeviceWorkgroupMemoryExplicitLayoutFeaturesKHR,
+                          vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT,
+                          vk::PhysicalDeviceMultiDrawFeaturesEXT,
+                          vk::PhysicalDeviceConditionalRenderingFeaturesEXT,
+                          vk::PhysicalDeviceDescriptorBufferFeaturesEXT,
+                          vk::PhysicalDevicePresentIdFeaturesKHR,
+                          vk::PhysicalDevicePresentWaitFeaturesKHR>();
     features = feature_chain.get().features;
 
     const vk::StructureChain properties_chain = physical_device.getProperties2<
         vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan11Properties,
-        vk::PhysicalDeviceVulkan12Properties, vk::PhysicalDevicePushDescriptorPropertiesKHR>();
+        vk::PhysicalDeviceVulkan12Properties, vk::PhysicalDeviceVulkan13Properties,
+        vk::PhysicalDevicePushDescriptorPropertiesKHR,
+        vk::PhysicalDeviceGraphicsPipelineLibraryPropertiesEXT,
+        vk::PhysicalDeviceMultiDrawPropertiesEXT,
+        vk::PhysicalDeviceExternalMemoryHostPropertiesEXT,
+        vk::PhysicalDeviceDescriptorBufferPropertiesEXT>();
     vk11_props = properties_chain.get<vk::PhysicalDeviceVulkan11Properties>();
     vk12_props = properties_chain.get<vk::PhysicalDeviceVulkan12Properties>();
+    vk13_props = properties_chain.get<vk::PhysicalDeviceVulkan13Properties>();
     push_descriptor_props = properties_chain.get<vk::PhysicalDevicePushDescriptorPropertiesKHR>();
-    LOG_INFO(Render_Vulkan, "Physical device subgroup size {}", vk11_props.subgroupSize);
+    graphics_pipeline_library_props =
+        properties_chain.get<vk::PhysicalDeviceGraphicsPipelineLibraryPropertiesEXT>();
+    multi_draw_props = properties_chain.get<vk::PhysicalDeviceMultiDrawPropertiesEXT>();
+    external_memory_host_props =
+        properties_chain.get<vk::PhysicalDeviceExternalMemoryHostPropertiesEXT>();
+    descriptor_buffer_props =
+        properties_chain.get<vk::PhysicalDeviceDescriptorBufferPropertiesEXT>();
+    LOG_INFO(Render_Vulkan, "Physical device subgroup size {}, compute supports {} to {}",
+             vk11_props.subgroupSize, vk13_props.minSubgroupSize, vk13_props.maxSubgroupSize);
 
     if (available_extensions.empty()) {
         LOG_CRITICAL(Render_Vulkan, "No extensions supported by device.");
         return false;
     }
 
-    boost::container::static_vector<const char*, 32> enabled_extensions;
+    boost::container::static_vector<const char*, 48> enabled_extensions;
     const auto add_extension = [&](std::string_view extension) -> bool {
         const auto result =
             std::find_if(available_extensions.begin(), available_extensions.end(),
@@ -264,12 +295,34 @@ bool Instance::CreateDevice() {
         }
     }
     depth_range_unrestricted = add_extension(VK_EXT_DEPTH_RANGE_UNRESTRICTED_EXTENSION_NAME);
+    // Only the logic op of it is used, the rest is core in Vulkan 1.3
+    dynamic_state_2 = add_extension(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+    if (dynamic_state_2) {
+        dynamic_state_2_features =
+            feature_chain.get<vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT>();
+        LOG_INFO(Render_Vulkan, "- extendedDynamicState2LogicOp: {}",
+                 dynamic_state_2_features.extendedDynamicState2LogicOp);
+    }
     dynamic_state_3 = add_extension(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
     if (dynamic_state_3) {
         dynamic_state_3_features =
             feature_chain.get<vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT>();
         LOG_INFO(Render_Vulkan, "- extendedDynamicState3ColorWriteMask: {}",
                  dynamic_state_3_features.extendedDynamicState3ColorWriteMask);
+        LOG_INFO(Render_Vulkan, "- extendedDynamicState3PolygonMode: {}",
+                 dynamic_state_3_features.extendedDynamicState3PolygonMode);
+        LOG_INFO(Render_Vulkan, "- extendedDynamicState3DepthClampEnable: {}",
+                 dynamic_state_3_features.extendedDynamicState3DepthClampEnable);
+        LOG_INFO(Render_Vulkan, "- extendedDynamicState3DepthClipEnable: {}",
+                 dynamic_state_3_features.extendedDynamicState3DepthClipEnable);
+        LOG_INFO(Render_Vulkan, "- extendedDynamicState3ColorBlendEnable: {}",
+                 dynamic_state_3_features.extendedDynamicState3ColorBlendEnable);
+        LOG_INFO(Render_Vulkan, "- extendedDynamicState3ColorBlendEquation: {}",
+                 dynamic_state_3_features.extendedDynamicState3ColorBlendEquation);
+        LOG_INFO(Render_Vulkan, "- extendedDynamicState3LogicOpEnable: {}",
+                 dynamic_state_3_features.extendedDynamicState3LogicOpEnable);
+        LOG_INFO(Render_Vulkan, "- extendedDynamicState3ProvokingVertexMode: {}",
+                 dynamic_state_3_features.extendedDynamicState3ProvokingVertexMode);
     }
     robustness2 = add_extension(VK_EXT_ROBUSTNESS_2_EXTENSION_NAME);
     if (robustness2) {
@@ -323,6 +376,73 @@ bool Instance::CreateDevice() {
             Render_Vulkan, "- workgroupMemoryExplicitLayout16BitAccess: {}",
             workgroup_memory_explicit_layout_features.workgroupMemoryExplicitLayout16BitAccess);
     }
+    graphics_pipeline_library = add_extension(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+    if (graphics_pipeline_library) {
+        graphics_pipeline_library = add_extension(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+        if (!graphics_pipeline_library) {
+            // We want both extensions so remove the first if the second isn't available
+            enabled_extensions.pop_back();
+        }
+    }
+    if (graphics_pipeline_library) {
+        graphics_pipeline_library_features =
+            feature_chain.get<vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>();
+        LOG_INFO(Render_Vulkan, "- graphicsPipelineLibrary: {}",
+                 graphics_pipeline_library_features.graphicsPipelineLibrary);
+        LOG_INFO(Render_Vulkan, "- graphicsPipelineLibraryFastLinking: {}",
+                 graphics_pipeline_library_props.graphicsPipelineLibraryFastLinking);
+    }
+    multi_draw = add_extension(VK_EXT_MULTI_DRAW_EXTENSION_NAME);
+    if (multi_draw) {
+        multi_draw = feature_chain.get<vk::PhysicalDeviceMultiDrawFeaturesEXT>().multiDraw;
+        LOG_INFO(Render_Vulkan, "- maxMultiDrawCount: {}", multi_draw_props.maxMultiDrawCount);
+    }
+    conditional_rendering = add_extension(VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME);
+    if (conditional_rendering) {
+        conditional_rendering =
+            feature_chain.get<vk::PhysicalDeviceConditionalRenderingFeaturesEXT>()
+                .conditionalRendering;
+    }
+    external_memory_host = add_extension(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+    if (external_memory_host) {
+        LOG_INFO(Render_Vulkan, "- minImportedHostPointerAlignment: {:#x}",
+                 external_memory_host_props.minImportedHostPointerAlignment);
+    }
+    if (Config::isDescriptorBufferEnabled()) {
+        descriptor_buffer = add_extension(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+        if (descriptor_buffer) {
+            // Buffer descriptors are written from device addresses
+            descriptor_buffer =
+                feature_chain.get<vk::PhysicalDeviceDescriptorBufferFeaturesEXT>()
+                    .descriptorBuffer &&
+                feature_chain.get<vk::PhysicalDeviceVulkan12Features>().bufferDeviceAddress;
+            if (!descriptor_buffer) {
+                enabled_extensions.pop_back();
+            }
+        }
+        if (descriptor_buffer) {
+            LOG_INFO(Render_Vulkan, "- descriptorBufferOffsetAlignment: {}",
+                     descriptor_buffer_props.descriptorBufferOffsetAlignment);
+        }
+    }
+    if (Config::isLowLatencyPresentEnabled()) {
+        present_wait = add_extension(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+        if (present_wait) {
+            present_wait = add_extension(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+            if (!present_wait) {
+                enabled_extensions.pop_back();
+            }
+        }
+        if (present_wait) {
+            present_wait =
+                feature_chain.get<vk::PhysicalDevicePresentIdFeaturesKHR>().presentId &&
+                feature_chain.get<vk::PhysicalDevicePresentWaitFeaturesKHR>().presentWait;
+            if (!present_wait) {
+                enabled_extensions.pop_back();
+                enabled_extensions.pop_back();
+            }
+        }
+    }
     const bool calibrated_timestamps =
         TRACY_GPU_ENABLED ? add_extension(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME) : false;
 
@@ -345,9 +465,11 @@ bool Instance::CreateDevice() {
     bool graphics_queue_found = false;
     for (std::size_t i = 0; i < family_properties.size(); i++) {
         const u32 index = static_cast<u32>(i);
-        if (family_properties[i].queueFlags & vk::QueueFlagBits::eGraphics) {
+        const auto flags = family_properties[i].queueFlags;
+        if (flags & vk::QueueFlagBits::eGraphics) {
             queue_family_index = index;
             graphics_queue_found = true;
+            sparse_binding_queue = static_cast<bool>(flags & vk::QueueFlagBits::eSparseBinding);
         }
     }
 
@@ -356,22 +478,62 @@ bool Instance::CreateDevice() {
         return false;
     }
 
+    // A family without graphics support is backed by the dedicated compute rings of the GPU
+    for (std::size_t i = 0; i < family_properties.size(); i++) {
+        const auto flags = family_properties[i].queueFlags;
+        if ((flags & vk::QueueFlagBits::eCompute) && !(flags & vk::QueueFlagBits::eGraphics)) {
+            compute_queue_family_index = static_cast<u32>(i);
+            has_async_compute_queue = true;
+            break;
+        }
+    }
+    LOG_INFO(Render_Vulkan, "Async compute queue family: {}",
+             has_async_compute_queue ? std::to_string(compute_queue_family_index) : "none");
+
+    for (std::size_t i = 0; i < family_properties.size(); i++) {
+        const auto flags = family_properties[i].queueFlags;
+        if ((flags & vk::QueueFlagBits::eTransfer) &&
+            !(flags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute))) {
+            transfer_queue_family_index = static_cast<u32>(i);
+            has_transfer_queue = true;
+            break;
+        }
+    }
+    LOG_INFO(Render_Vulkan, "Transfer queue family: {}",
+             has_transfer_queue ? std::to_string(transfer_queue_family_index) : "none");
+
     static constexpr std::array queue_priorities = {1.0f};
-    const vk::DeviceQueueCreateInfo queue_info = {
+    boost::container::static_vector<vk::DeviceQueueCreateInfo, 3> queue_infos;
+    queue_infos.push_back({
         .queueFamilyIndex = queue_family_index,
         .queueCount = static_cast<u32>(queue_priorities.size()),
         .pQueuePriorities = queue_priorities.data(),
-    };
+    });
+    if (has_async_compute_queue) {
+        queue_infos.push_back({
+            .queueFamilyIndex = compute_queue_family_index,
+            .queueCount = static_cast<u32>(queue_priorities.size()),
+            .pQueuePriorities = queue_priorities.data(),
+        });
+    }
+    if (has_transfer_queue) {
+        queue_infos.push_back({
+            .queueFamilyIndex = transfer_queue_family_index,
+            .queueCount = static_cast<u32>(queue_priorities.size()),
+            .pQueuePriorities = queue_priorities.data(),
+        });
+    }
 
     const auto topology_list_restart_features =
         feature_chain.get<vk::PhysicalDevicePrimitiveTopologyListRestartFeaturesEXT>();
     const auto vk11_features = feature_chain.get<vk::PhysicalDeviceVulkan11Features>();
     vk12_features = feature_chain.get<vk::PhysicalDeviceVulkan12Features>();
     const auto vk13_features = feature_chain.get<vk::PhysicalDeviceVulkan13Features>();
+    subgroup_size_control = vk13_features.subgroupSizeControl;
     vk::StructureChain device_chain = {
         vk::DeviceCreateInfo{
-            .queueCreateInfoCount = 1u,
-            .pQueueCreateInfos = &queue_info,
+            .queueCreateInfoCount = static_cast<u32>(queue_infos.size()),
+            .pQueueCreateInfos = queue_infos.data(),
             .enabledExtensionCount = static_cast<u32>(enabled_extensions.size()),
             .ppEnabledExtensionNames = enabled_extensions.data(),
         },
@@ -386,6 +548,7 @@ bool Instance::CreateDevice() {
                 .dualSrcBlend = features.dualSrcBlend,
                 .logicOp = features.logicOp,
                 .multiDrawIndirect = features.multiDrawIndirect,
+                .drawIndirectFirstInstance = features.drawIndirectFirstInstance,
                 .depthClamp = features.depthClamp,
                 .depthBiasClamp = features.depthBiasClamp,
                 .fillModeNonSolid = features.fillModeNonSolid,
@@ -393,6 +556,7 @@ bool Instance::CreateDevice() {
                 .wideLines = features.wideLines,
                 .multiViewport = features.multiViewport,
                 .samplerAnisotropy = features.samplerAnisotropy,
+                .occlusionQueryPrecise = features.occlusionQueryPrecise,
                 .vertexPipelineStoresAndAtomics = features.vertexPipelineStoresAndAtomics,
                 .fragmentStoresAndAtomics = features.fragmentStoresAndAtomics,
                 .shaderImageGatherExtended = features.shaderImageGatherExtended,
@@ -402,6 +566,8 @@ bool Instance::CreateDevice() {
                 .shaderFloat64 = features.shaderFloat64,
                 .shaderInt64 = features.shaderInt64,
                 .shaderInt16 = features.shaderInt16,
+                .sparseBinding = features.sparseBinding && sparse_binding_queue,
+                .sparseResidencyImage2D = features.sparseResidencyImage2D && sparse_binding_queue,
             },
         },
         vk::PhysicalDeviceVulkan11Features{
@@ -418,6 +584,12 @@ bool Instance::CreateDevice() {
             .shaderSharedInt64Atomics = vk12_features.shaderSharedInt64Atomics,
             .shaderFloat16 = vk12_features.shaderFloat16,
             .shaderInt8 = vk12_features.shaderInt8,
+            .descriptorBindingSampledImageUpdateAfterBind =
+                vk12_features.descriptorBindingSampledImageUpdateAfterBind,
+            .descriptorBindingUpdateUnusedWhilePending =
+                vk12_features.descriptorBindingUpdateUnusedWhilePending,
+            .descriptorBindingPartiallyBound = vk12_features.descriptorBindingPartiallyBound,
+            .runtimeDescriptorArray = vk12_features.runtimeDescriptorArray,
             .scalarBlockLayout = vk12_features.scalarBlockLayout,
             .uniformBufferStandardLayout = vk12_features.uniformBufferStandardLayout,
             .separateDepthStencilLayouts = vk12_features.separateDepthStencilLayouts,
@@ -429,6 +601,7 @@ bool Instance::CreateDevice() {
         vk::PhysicalDeviceVulkan13Features{
             .robustImageAccess = vk13_features.robustImageAccess,
             .shaderDemoteToHelperInvocation = vk13_features.shaderDemoteToHelperInvocation,
+            .subgroupSizeControl = vk13_features.subgroupSizeControl,
             .synchronization2 = vk13_features.synchronization2,
             .dynamicRendering = vk13_features.dynamicRendering,
             .maintenance4 = vk13_features.maintenance4,
@@ -438,9 +611,26 @@ bool Instance::CreateDevice() {
             .customBorderColors = true,
             .customBorderColorWithoutFormat = true,
         },
+        vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT{
+            .extendedDynamicState2LogicOp = dynamic_state_2_features.extendedDynamicState2LogicOp,
+        },
         vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT{
+            .extendedDynamicState3DepthClampEnable =
+                dynamic_state_3_features.extendedDynamicState3DepthClampEnable,
+            .extendedDynamicState3PolygonMode =
+                dynamic_state_3_features.extendedDynamicState3PolygonMode,
+            .extendedDynamicState3LogicOpEnable =
+                dynamic_state_3_features.extendedDynamicState3LogicOpEnable,
+            .extendedDynamicState3ColorBlendEnable =
+                dynamic_state_3_features.extendedDynamicState3ColorBlendEnable,
+            .extendedDynamicState3ColorBlendEquation =
+                dynamic_state_3_features.extendedDynamicState3ColorBlendEquation,
             .extendedDynamicState3ColorWriteMask =
                 dynamic_state_3_features.extendedDynamicState3ColorWriteMask,
+            .extendedDynamicState3DepthClipEnable =
+                dynamic_state_3_features.extendedDynamicState3DepthClipEnable,
+            .extendedDynamicState3ProvokingVertexMode =
+                dynamic_state_3_features.extendedDynamicState3ProvokingVertexMode,
         },
         vk::PhysicalDeviceDepthClipControlFeaturesEXT{
             .depthClipControl = true,
@@ -497,6 +687,24 @@ bool Instance::CreateDevice() {
             .workgroupMemoryExplicitLayout16BitAccess =
                 workgroup_memory_explicit_layout_features.workgroupMemoryExplicitLayout16BitAccess,
         },
+        vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT{
+            .graphicsPipelineLibrary = graphics_pipeline_library_features.graphicsPipelineLibrary,
+        },
+        vk::PhysicalDeviceMultiDrawFeaturesEXT{
+            .multiDraw = true,
+        },
+        vk::PhysicalDeviceConditionalRenderingFeaturesEXT{
+            .conditionalRendering = true,
+        },
+        vk::PhysicalDeviceDescriptorBufferFeaturesEXT{
+            .descriptorBuffer = true,
+        },
+        vk::PhysicalDevicePresentIdFeaturesKHR{
+            .presentId = true,
+        },
+        vk::PhysicalDevicePresentWaitFeaturesKHR{
+            .presentWait = true,
+        },
 #ifdef __APPLE__
         vk::PhysicalDevicePortabilitySubsetFeaturesKHR{
             .constantAlphaColorBlendFactors = portability_features.constantAlphaColorBlendFactors,
@@ -523,6 +731,9 @@ bool Instance::CreateDevice() {
     if (!custom_border_color) {
         device_chain.unlink<vk::PhysicalDeviceCustomBorderColorFeaturesEXT>();
     }
+    if (!dynamic_state_2) {
+        device_chain.unlink<vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT>();
+    }
     if (!dynamic_state_3) {
         device_chain.unlink<vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT>();
     }
@@ -563,6 +774,22 @@ bool Instance::CreateDevice() {
     if (!workgroup_memory_explicit_layout) {
         device_chain.unlink<vk::PhysicalDeviceWorkgroupMemoryExplicitLayoutFeaturesKHR>();
     }
+    if (!graphics_pipeline_library) {
+        device_chain.unlink<vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>();
+    }
+    if (!multi_draw) {
+        device_chain.unlink<vk::PhysicalDeviceMultiDrawFeaturesEXT>();
+    }
+    if (!conditional_rendering) {
+        device_chain.unlink<vk::PhysicalDeviceConditionalRenderingFeaturesEXT>();
+    }
+    if (!descriptor_buffer) {
+        device_chain.unlink<vk::PhysicalDeviceDescriptorBufferFeaturesEXT>();
+    }
+    if (!present_wait) {
+        device_chain.unlink<vk::PhysicalDevicePresentIdFeaturesKHR>();
+        device_chain.unlink<vk::PhysicalDevicePresentWaitFeaturesKHR>();
+    }
 
     auto [device_result, dev] = physical_device.createDeviceUnique(device_chain.get());
     if (device_result != vk::Result::eSuccess) {
@@ -575,6 +802,12 @@ bool Instance::CreateDevice() {
 
     graphics_queue = device->getQueue(queue_family_index, 0);
     present_queue = device->getQueue(queue_family_index, 0);
+    if (has_async_compute_queue) {
+        compute_queue = device->getQueue(compute_queue_family_index, 0);
+    }
+    if (has_transfer_queue) {
+        transfer_queue = device->getQueue(transfer_queue_family_index, 0);
+    }
 
     if (calibrated_timestamps) {
         const auto [time_domains_result, time_domains] =
@@ -617,10 +850,24 @@ void Instance::CreateAllocator() {
         .vkGetDeviceProcAddr = VULKAN_HPP_DEFAULT_DISPATCHER.vkGetDeviceProcAddr,
     };
 
+    // Counts the device memory calls, which are what the pools save
+    const VmaDeviceMemoryCallbacks memory_callbacks = {
+        .pfnAllocate = [](VmaAllocator, u32, VkDeviceMemory, VkDeviceSize, void* user_data) {
+            static_cast<Instance*>(user_data)->device_allocations.fetch_add(
+                1, std::memory_order_relaxed);
+        },
+        .pfnFree = [](VmaAllocator, u32, VkDeviceMemory, VkDeviceSize, void* user_data) {
+            static_cast<Instance*>(user_data)->device_frees.fetch_add(1,
+                                                                      std::memory_order_relaxed);
+        },
+        .pUserData = this,
+    };
+
     const VmaAllocatorCreateInfo allocator_info = {
         .flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT,
         .physicalDevice = physical_device,
         .device = *device,
+        .pDeviceMemoryCallbacks = &memory_callbacks,
         .pVulkanFunctions = &functions,
         .instance = *instance,
         .vulkanApiVersion = TargetVulkanApiVersion,
@@ -631,6 +878,81 @@ void Instance::CreateAllocator() {
         UNREACHABLE_MSG("Failed to initialize VMA with error {}",
                         vk::to_string(vk::Result{result}));
     }
+    CreateMemoryPools();
+}
+
+void Instance::CreateMemoryPools() {
+    struct PoolInfo {
+        MemoryPool pool;
+        VmaMemoryUsage usage;
+        VmaAllocationCreateFlags flags;
+        VmaPoolCreateFlags pool_flags;
+        VkDeviceSize block_size;
+        size_t max_blocks;
+    };
+    // Staging buffers come and go in any order and get blocks of their own. Scratch buffers are
+    // freed in the order their submissions finish, so a single linear block works as a ring.
+    static constexpr std::array<PoolInfo, static_cast<u32>(MemoryPool::Count)> pool_infos = {{
+        {MemoryPool::Upload, VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+         VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT, 0, 64_MB, 0},
+        {MemoryPool::Download, VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+         VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT, 0, 64_MB, 0},
+        {MemoryPool::Scratch, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, 0,
+         VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT, 128_MB, 1},
+    }};
+    // Covers the usages of the pooled buffers, a memory type for it suits each of them
+    const VkBufferCreateInfo example_buffer_ci = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = 64_KB,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+    };
+    for (const auto& info : pool_infos) {
+        const VmaAllocationCreateInfo alloc_ci = {
+            .flags = info.flags,
+            .usage = info.usage,
+        };
+        u32 memory_type{};
+        if (vmaFindMemoryTypeIndexForBufferInfo(allocator, &example_buffer_ci, &alloc_ci,
+                                                &memory_type) != VK_SUCCESS) {
+            continue;
+        }
+        const VmaPoolCreateInfo pool_ci = {
+            .memoryTypeIndex = memory_type,
+            .flags = info.pool_flags,
+            .blockSize = info.block_size,
+            .maxBlockCount = info.max_blocks,
+        };
+        auto& pool = memory_pools[static_cast<u32>(info.pool)];
+        if (vmaCreatePool(allocator, &pool_ci, &pool) != VK_SUCCESS) {
+            LOG_WARNING(Render_Vulkan, "Failed to create memory pool {}",
+                        static_cast<u32>(info.pool));
+            pool = VK_NULL_HANDLE;
+        }
+    }
+}
+
+MemoryStats Instance::ConsumeMemoryStats() const {
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+    vmaGetHeapBudgets(allocator, budgets.data());
+    MemoryStats stats = {
+        .device_allocations = device_allocations.exchange(0, std::memory_order_relaxed),
+        .device_frees = device_frees.exchange(0, std::memory_order_relaxed),
+    };
+    for (u32 heap = 0; heap < memory_properties.memoryHeapCount; ++heap) {
+        stats.allocations += budgets[heap].statistics.allocationCount;
+        stats.allocation_bytes += budgets[heap].statistics.allocationBytes;
+        stats.block_bytes += budgets[heap].statistics.blockBytes;
+    }
+    for (const VmaPool pool : memory_pools) {
+        if (pool) {
+            VmaStatistics pool_stats{};
+            vmaGetPoolStatistics(allocator, pool, &pool_stats);
+            stats.pool_allocation_bytes += pool_stats.allocationBytes;
+            stats.pool_block_bytes += pool_stats.blockBytes;
+        }
+    }
+    return stats;
 }
 
 void Instance::CollectDeviceParameters() {
@@ -733,6 +1055,25 @@ u64 Instance::GetDeviceMemoryUsage() const {
     return total_usage;
 }
 
+u64 Instance::GetCurrentMemoryBudget() const {
+    if (!supports_memory_budget || IsIntegrated()) {
+        // The integrated budget is derived from the system memory left at startup
+        return total_memory_budget;
+    }
+    vk::PhysicalDeviceMemoryBudgetPropertiesEXT memory_budget_props{};
+    vk::PhysicalDeviceMemoryProperties2 props = {
+        .pNext = &memory_budget_props,
+    };
+    physical_device.getMemoryProperties2(&props);
+
+    u64 budget = 0;
+    for (const size_t heap : valid_heaps) {
+        budget += memory_budget_props.heapBudget[heap];
+    }
+    // Keep the same reserve for the system as the initial budget.
+    return budget - std::min<u64>(budget / 8, 1_GB);
+}
+
 vk::FormatFeatureFlags2 Instance::GetFormatFeatureFlags(vk::Format format) const {
     const auto it = format_properties.find(format);
     if (it == format_properties.end()) {
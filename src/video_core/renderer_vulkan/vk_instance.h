@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <span>
 #include <unordered_map>
 
@@ -16,14 +19,40 @@ class WindowSDL;
 }
 
 VK_DEFINE_HANDLE(VmaAllocator)
+VK_DEFINE_HANDLE(VmaPool)
 
 namespace Vulkan {
 
+/// Custom VMA pools for resources that are created and destroyed all the time, kept apart from
+/// the blocks of the long lived ones so they don't fragment them.
+enum class MemoryPool : u32 {
+    Upload,   ///< Host visible temporary buffers for CPU to GPU copies
+    Download, ///< Host visible cached buffers for GPU to CPU readbacks
+    Scratch,  ///< Device local temporary buffers, released in submission order
+    Count,
+};
+
+struct MemoryStats {
+    u32 device_allocations; ///< Device memory blocks allocated since the last call
+    u32 device_frees;       ///< Device memory blocks freed since the last call
+    u32 allocations;        ///< Live VMA allocations
+    u64 allocation_bytes;   ///< Bytes of the live allocations
+    u64 block_bytes;        ///< Bytes of the device memory blocks holding them
+    u64 pool_allocation_bytes;
+    u64 pool_block_bytes;
+};
+
 class Instance {
 public:
+    /// Number of lanes of a GCN wave.
+    static constexpr u32 GuestWaveSize = 64;
+
     explicit Instance(bool validation = false, bool crash_diagnostic = false);
     explicit Instance(Frontend::WindowSDL& window, s32 physical_device_index,
                       bool enable_validation = false, bool enable_crash_diagnostic = false);
+    /// Creates a logical device without presentation support, used by the offline tools.
+    explicit Instance(Frontend::WindowSystemType window_type, s32 physical_device_index,
+                      bool enable_validation = false, bool enable_crash_diagnostic = false);
     ~Instance();
 
     /// Returns a formatted string for the driver version
@@ -53,6 +82,14 @@ public:
         return allocator;
     }
 
+    /// Returns the custom pool for a kind of resource, or null to use the default pools.
+    VmaPool GetMemoryPool(MemoryPool pool) const {
+        return memory_pools[static_cast<u32>(pool)];
+    }
+
+    /// Returns the allocator statistics and the device memory calls made since the last call.
+    [[nodiscard]] MemoryStats ConsumeMemoryStats() const;
+
     /// Returns a list of the available physical devices
     std::span<const vk::PhysicalDevice> GetPhysicalDevices() const {
         return physical_devices;
@@ -75,6 +112,34 @@ public:
         return present_queue;
     }
 
+    /// Returns true when the device has a compute queue family separate from graphics, which
+    /// can run work concurrently with the graphics queue.
+    bool HasAsyncComputeQueue() const {
+        return has_async_compute_queue;
+    }
+
+    u32 GetComputeQueueFamilyIndex() const {
+        return compute_queue_family_index;
+    }
+
+    vk::Queue GetComputeQueue() const {
+        return compute_queue;
+    }
+
+    /// Returns true when the device has a transfer-only queue family, usually backed by a DMA
+    /// engine that copies concurrently with the graphics queue.
+    bool HasTransferQueue() const {
+        return has_transfer_queue;
+    }
+
+    u32 GetTransferQueueFamilyIndex() const {
+        return transfer_queue_family_index;
+    }
+
+    vk::Queue GetTransferQueue() const {
+        return transfer_queue;
+    }
+
     TracyVkCtx GetProfilerContext() const {
         return profiler_context;
     }
@@ -84,6 +149,16 @@ public:
         return features.samplerAnisotropy;
     }
 
+    /// Returns true if partially resident 2D images can be created and bound on the graphics queue
+    bool IsSparseResidencySupported() const {
+        return features.sparseBinding && features.sparseResidencyImage2D && sparse_binding_queue;
+    }
+
+    /// Returns true if occlusion queries can count the exact number of passing samples
+    bool IsOcclusionQueryPreciseSupported() const {
+        return features.occlusionQueryPrecise;
+    }
+
     /// Returns true if depth bounds testing is supported
     bool IsDepthBoundsSupported() const {
         return features.depthBounds;
@@ -155,6 +230,38 @@ public:
         return dynamic_state_3 && dynamic_state_3_features.extendedDynamicState3ColorWriteMask;
     }
 
+    /// Returns true when the polygon mode can be set dynamically.
+    bool IsDynamicPolygonModeSupported() const {
+        return dynamic_state_3 && dynamic_state_3_features.extendedDynamicState3PolygonMode;
+    }
+
+    /// Returns true when depth clamping, and depth clipping if VK_EXT_depth_clip_enable is
+    /// supported, can be set dynamically.
+    bool IsDynamicDepthClampSupported() const {
+        const auto& ds3_features = dynamic_state_3_features;
+        return dynamic_state_3 && ds3_features.extendedDynamicState3DepthClampEnable &&
+               (!depth_clip_enable || ds3_features.extendedDynamicState3DepthClipEnable);
+    }
+
+    /// Returns true when the blend enables and equations can be set dynamically.
+    bool IsDynamicColorBlendSupported() const {
+        return dynamic_state_3 && dynamic_state_3_features.extendedDynamicState3ColorBlendEnable &&
+               dynamic_state_3_features.extendedDynamicState3ColorBlendEquation;
+    }
+
+    /// Returns true when logic ops and their enable can be set dynamically.
+    bool IsDynamicLogicOpSupported() const {
+        return features.logicOp && dynamic_state_2 &&
+               dynamic_state_2_features.extendedDynamicState2LogicOp && dynamic_state_3 &&
+               dynamic_state_3_features.extendedDynamicState3LogicOpEnable;
+    }
+
+    /// Returns true when the provoking vertex mode can be set dynamically.
+    bool IsDynamicProvokingVertexSupported() const {
+        return provoking_vertex && dynamic_state_3 &&
+               dynamic_state_3_features.extendedDynamicState3ProvokingVertexMode;
+    }
+
     /// Returns true when VK_EXT_vertex_input_dynamic_state is supported.
     bool IsVertexInputDynamicState() const {
         return vertex_input_dynamic_state;
@@ -185,6 +292,85 @@ public:
         return list_restart;
     }
 
+    /// Returns true when VK_EXT_graphics_pipeline_library is supported and libraries can be
+    /// linked without a full recompilation.
+    bool IsGraphicsPipelineLibrarySupported() const {
+        return graphics_pipeline_library &&
+               graphics_pipeline_library_features.graphicsPipelineLibrary &&
+               graphics_pipeline_library_props.graphicsPipelineLibraryFastLinking;
+    }
+
+    /// Returns true when VK_EXT_multi_draw is supported.
+    bool IsMultiDrawSupported() const {
+        return multi_draw;
+    }
+
+    /// Returns the maximum number of draws recorded by a single multi draw command.
+    u32 GetMaxMultiDrawCount() const {
+        return multi_draw_props.maxMultiDrawCount;
+    }
+
+    /// Returns true when VK_EXT_conditional_rendering is supported.
+    bool IsConditionalRenderingSupported() const {
+        return conditional_rendering;
+    }
+
+    /// Returns true when VK_EXT_external_memory_host is supported.
+    bool IsExternalMemoryHostSupported() const {
+        return external_memory_host;
+    }
+
+    /// Returns the alignment of host pointers and sizes imported as device memory.
+    u64 GetMinImportedHostPointerAlignment() const {
+        return external_memory_host_props.minImportedHostPointerAlignment;
+    }
+
+    /// Returns true when guest descriptors are written to descriptor buffers through
+    /// VK_EXT_descriptor_buffer instead of descriptor sets.
+    bool IsDescriptorBufferSupported() const {
+        return descriptor_buffer;
+    }
+
+    /// Returns true when samplers can be kept in one descriptor array that shaders index at
+    /// runtime, with slots written while the array is bound.
+    bool IsBindlessSamplersSupported() const {
+        return vk12_features.runtimeDescriptorArray &&
+               vk12_features.descriptorBindingPartiallyBound &&
+               vk12_features.descriptorBindingSampledImageUpdateAfterBind &&
+               vk12_features.descriptorBindingUpdateUnusedWhilePending;
+    }
+
+    /// Returns true when the number of indirect draws can be read from a buffer.
+    bool IsDrawIndirectCountSupported() const {
+        return vk12_features.drawIndirectCount;
+    }
+
+    /// Returns the maximum number of draws recorded by a single indirect draw command.
+    u32 GetMaxDrawIndirectCount() const {
+        return properties.limits.maxDrawIndirectCount;
+    }
+
+    /// Returns true when queries can be reset from the host.
+    bool IsHostQueryResetSupported() const {
+        return vk12_features.hostQueryReset;
+    }
+
+    /// Returns true when presents are tagged with ids that can be waited on for display, through
+    /// VK_KHR_present_id and VK_KHR_present_wait.
+    bool IsPresentWaitSupported() const {
+        return present_wait;
+    }
+
+    /// Returns the descriptor sizes and alignments of VK_EXT_descriptor_buffer.
+    const vk::PhysicalDeviceDescriptorBufferPropertiesEXT& GetDescriptorBufferProperties() const {
+        return descriptor_buffer_props;
+    }
+
+    /// Returns true when the robustBufferAccess feature is enabled.
+    bool IsRobustBufferAccessEnabled() const {
+        return features.robustBufferAccess;
+    }
+
     /// Returns true when VK_EXT_legacy_vertex_attributes is supported.
     bool IsLegacyVertexAttributesSupported() const {
         return legacy_vertex_attributes;
@@ -350,11 +536,23 @@ public:
         return vk11_props.subgroupSize;
     }
 
+    /// Returns true if compute shaders can be made to run with the 64 lane waves of the guest.
+    bool IsGuestWaveSizeSupported() const {
+        return subgroup_size_control && vk13_props.minSubgroupSize <= GuestWaveSize &&
+               vk13_props.maxSubgroupSize >= GuestWaveSize &&
+               (vk13_props.requiredSubgroupSizeStages & vk::ShaderStageFlagBits::eCompute);
+    }
+
     /// Returns the maximum size of compute shared memory.
     u32 MaxComputeSharedMemorySize() const {
         return properties.limits.maxComputeSharedMemorySize;
     }
 
+    /// Returns the maximum number of samplers that can exist at once.
+    u32 MaxSamplerAllocationCount() const {
+        return properties.limits.maxSamplerAllocationCount;
+    }
+
     /// Returns the maximum sampler LOD bias.
     float MaxSamplerLodBias() const {
         return properties.limits.maxSamplerLodBias;
@@ -365,6 +563,17 @@ public:
         return properties.limits.maxSamplerAnisotropy;
     }
 
+    /// Returns the maximum size of the push constants of a pipeline layout.
+    u32 MaxPushConstantsSize() const {
+        return properties.limits.maxPushConstantsSize;
+    }
+
+    /// Returns the maximum number of samplers in a descriptor set that can be updated after bind.
+    u32 MaxUpdateAfterBindSamplers() const {
+        return std::min(vk12_props.maxDescriptorSetUpdateAfterBindSamplers,
+                        vk12_props.maxPerStageDescriptorUpdateAfterBindSamplers);
+    }
+
     /// Returns the maximum number of push descriptors.
     u32 MaxPushDescriptors() const {
         return push_descriptor_props.maxPushDescriptors;
@@ -434,6 +643,9 @@ public:
         return total_memory_budget;
     }
 
+    /// Queries the budget again, it changes as other processes allocate device memory.
+    [[nodiscard]] u64 GetCurrentMemoryBudget() const;
+
     /// Determines if a format is supported for a set of feature flags.
     [[nodiscard]] bool IsFormatSupported(vk::Format format, vk::FormatFeatureFlags2 flags) const;
 
@@ -444,6 +656,9 @@ private:
     /// Creates the VMA allocator handle
     void CreateAllocator();
 
+    /// Creates the custom VMA pools, leaving the ones without a suitable memory type null
+    void CreateMemoryPools();
+
     /// Collects various information from the device.
     void CollectDeviceParameters();
     void CollectPhysicalMemoryInfo();
@@ -460,31 +675,49 @@ private:
     vk::PhysicalDeviceMemoryProperties memory_properties;
     vk::PhysicalDeviceVulkan11Properties vk11_props;
     vk::PhysicalDeviceVulkan12Properties vk12_props;
+    vk::PhysicalDeviceVulkan13Properties vk13_props;
     vk::PhysicalDevicePushDescriptorPropertiesKHR push_descriptor_props;
+    vk::PhysicalDeviceGraphicsPipelineLibraryPropertiesEXT graphics_pipeline_library_props;
+    vk::PhysicalDeviceMultiDrawPropertiesEXT multi_draw_props;
+    vk::PhysicalDeviceExternalMemoryHostPropertiesEXT external_memory_host_props;
+    vk::PhysicalDeviceDescriptorBufferPropertiesEXT descriptor_buffer_props;
     vk::PhysicalDeviceFeatures features;
     vk::PhysicalDeviceVulkan12Features vk12_features;
     vk::PhysicalDevicePortabilitySubsetFeaturesKHR portability_features;
+    vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT dynamic_state_2_features;
     vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT dynamic_state_3_features;
     vk::PhysicalDeviceRobustness2FeaturesEXT robustness2_features;
     vk::PhysicalDeviceShaderAtomicFloat2FeaturesEXT shader_atomic_float2_features;
     vk::PhysicalDeviceWorkgroupMemoryExplicitLayoutFeaturesKHR
         workgroup_memory_explicit_layout_features;
+    vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphics_pipeline_library_features;
     vk::DriverIdKHR driver_id;
     vk::UniqueDebugUtilsMessengerEXT debug_callback{};
     std::string vendor_name;
     VmaAllocator allocator{};
+    std::array<VmaPool, static_cast<u32>(MemoryPool::Count)> memory_pools{};
+    mutable std::atomic<u32> device_allocations{};
+    mutable std::atomic<u32> device_frees{};
     vk::Queue present_queue;
     vk::Queue graphics_queue;
+    vk::Queue compute_queue;
+    vk::Queue transfer_queue;
     std::vector<vk::PhysicalDevice> physical_devices;
     std::vector<std::string> available_extensions;
     std::unordered_map<vk::Format, vk::FormatProperties3> format_properties;
     TracyVkCtx profiler_context{};
     u32 queue_family_index{0};
+    u32 compute_queue_family_index{0};
+    bool has_async_compute_queue{};
+    u32 transfer_queue_family_index{0};
+    bool has_transfer_queue{};
+    bool sparse_binding_queue{};
     bool custom_border_color{};
     bool fragment_shader_barycentric{};
     bool amd_shader_explicit_vertex_parameter{};
     bool depth_clip_control{};
     bool depth_clip_enable{};
+    bool dynamic_state_2{};
     bool dynamic_state_3{};
     bool depth_range_unrestricted{};
     bool vertex_input_dynamic_state{};
@@ -501,9 +734,16 @@ private:
     bool shader_atomic_float{};
     bool shader_atomic_float2{};
     bool workgroup_memory_explicit_layout{};
+    bool graphics_pipeline_library{};
+    bool multi_draw{};
+    bool conditional_rendering{};
+    bool external_memory_host{};
+    bool descriptor_buffer{};
+    bool present_wait{};
     bool portability_subset{};
     bool maintenance_8{};
     bool attachment_feedback_loop{};
+    bool subgroup_size_control{};
     bool supports_memory_budget{};
     u64 total_memory_budget{};
     std::vector<size_t> valid_heaps;
@@ -0,0 +1,288 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/perf_counters.h"
+#include "core/memory.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/renderer_vulkan/vk_occlusion_queries.h"
+#include "video_core/renderer_vulkan/vk_scheduler.h"
+
+namespace Vulkan {
+
+namespace {
+
+constexpr u64 CounterValidMask = 0x8000000000000000ULL;
+constexpr u32 MaxCounterPairs = 16;
+
+vk::BufferUsageFlags ResultsBufferFlags(const Instance& instance) {
+    vk::BufferUsageFlags flags = vk::BufferUsageFlagBits::eTransferDst;
+    if (instance.IsConditionalRenderingSupported()) {
+        flags |= vk::BufferUsageFlagBits::eConditionalRenderingEXT;
+    }
+    return flags;
+}
+
+} // Anonymous namespace
+
+OcclusionQueries::OcclusionQueries(const Instance& instance_, Scheduler& scheduler_)
+    : instance{instance_}, scheduler{scheduler_},
+      results{instance, scheduler, VideoCore::MemoryUsage::Download, 0,
+              ResultsBufferFlags(instance), (NumQueries + NumCopySlots) * sizeof(u64)} {
+    const vk::QueryPoolCreateInfo pool_info = {
+        .queryType = vk::QueryType::eOcclusion,
+        .queryCount = NumQueries,
+    };
+    auto [pool_result, pool] = instance.GetDevice().createQueryPoolUnique(pool_info);
+    ASSERT_MSG(pool_result == vk::Result::eSuccess, "Failed to create occlusion query pool: {}",
+               vk::to_string(pool_result));
+    query_pool = std::move(pool);
+    std::memset(results.mapped_data.data(), 0, results.mapped_data.size());
+}
+
+OcclusionQueries::~OcclusionQueries() = default;
+
+void OcclusionQueries::ZpassDone(VAddr address, u32 num_pairs) {
+    EndSegment();
+    if ((address & 0xF) == 0) {
+        // A query restarted before its end counts from the restart, like the counters would
+        std::erase_if(active_queries, [&](const auto& query) { return query.address == address; });
+        if (active_queries.size() == MaxActiveQueries) {
+            LOG_WARNING(Render_Vulkan, "Too many occlusion queries without end, dropping {:#x}",
+                        active_queries.front().address);
+            active_queries.erase(active_queries.begin());
+        }
+        active_queries.push_back({.address = address});
+        return;
+    }
+    const VAddr begin = address - sizeof(u64);
+    const auto it = std::ranges::find(active_queries, begin, &GuestQuery::address);
+    if (it == active_queries.end()) {
+        LOG_DEBUG(Render_Vulkan, "Occlusion query at {:#x} ended without begin", begin);
+        PublishResults(begin, num_pairs, {});
+        return;
+    }
+    auto segments = std::move(it->segments);
+    active_queries.erase(it);
+    PublishResults(begin, num_pairs, std::move(segments));
+}
+
+void OcclusionQueries::SetPredication(VAddr address, bool draw_if_visible) {
+    ReportPredicated();
+    predicate = {};
+    if (address == 0 || !instance.IsConditionalRenderingSupported()) {
+        return;
+    }
+    // Queries spanning several segments have no single result to test, their draws are kept
+    const auto it = predicate_slots.find(address);
+    if (it == predicate_slots.end()) {
+        return;
+    }
+    predicate = {
+        .enabled = true,
+        .slot = it->second,
+        .inverted = !draw_if_visible,
+    };
+}
+
+void OcclusionQueries::SetMemoryPredication(const VideoCore::Buffer& buffer, u32 offset,
+                                            bool inverted) {
+    ReportPredicated();
+    predicate = {};
+    if (!instance.IsConditionalRenderingSupported()) {
+        return;
+    }
+    predicate = {
+        .enabled = true,
+        .slot = CopyPredicate(buffer, offset),
+        .inverted = inverted,
+    };
+}
+
+void OcclusionQueries::BeginCondExec(const VideoCore::Buffer& buffer, u32 offset) {
+    const Predicate outer = predicate;
+    SetMemoryPredication(buffer, offset, false);
+    saved_predicate = outer;
+}
+
+void OcclusionQueries::EndCondExec() {
+    ReportPredicated();
+    predicate = std::exchange(saved_predicate, {});
+}
+
+void OcclusionQueries::CountPredicated() {
+    if (predicate.enabled) {
+        ++num_predicated;
+    }
+}
+
+void OcclusionQueries::PrepareDraw() {
+    if (active_queries.empty() || open_query != 0) {
+        return;
+    }
+    scheduler.EndRendering();
+    // Queries are used as a ring, a result is long consumed once its query comes around again
+    open_query = next_query;
+    next_query = next_query + 1 == NumQueries ? 1 : next_query + 1;
+    const auto cmdbuf = scheduler.CommandBuffer();
+    cmdbuf.resetQueryPool(*query_pool, open_query, 1);
+    // Guests may compare sample counts, not only whether any passed
+    const vk::QueryControlFlags flags = instance.IsOcclusionQueryPreciseSupported()
+                                            ? vk::QueryControlFlagBits::ePrecise
+                                            : vk::QueryControlFlags{};
+    cmdbuf.beginQuery(*query_pool, open_query, flags);
+}
+
+void OcclusionQueries::ApplyPredication(bool predicated) {
+    const bool enable = predicated && predicate.enabled;
+    if (enable == conditional_rendering && (!enable || applied_predicate == predicate)) {
+        return;
+    }
+    EndConditionalRendering();
+    if (!enable) {
+        return;
+    }
+    const vk::ConditionalRenderingBeginInfoEXT begin_info = {
+        .buffer = results.Handle(),
+        .offset = predicate.slot * sizeof(u64),
+        .flags = predicate.inverted ? vk::ConditionalRenderingFlagBitsEXT::eInverted
+                                    : vk::ConditionalRenderingFlagsEXT{},
+    };
+    scheduler.CommandBuffer().beginConditionalRenderingEXT(begin_info);
+    conditional_rendering = true;
+    applied_predicate = predicate;
+}
+
+void OcclusionQueries::EndConditionalRendering() {
+    if (!conditional_rendering) {
+        return;
+    }
+    scheduler.CommandBuffer().endConditionalRenderingEXT();
+    conditional_rendering = false;
+}
+
+void OcclusionQueries::EndSegment() {
+    ReportPredicated();
+    if (open_query == 0) {
+        return;
+    }
+    const u32 query = std::exchange(open_query, 0);
+    scheduler.EndRendering();
+    const auto cmdbuf = scheduler.CommandBuffer();
+    cmdbuf.endQuery(*query_pool, query);
+    cmdbuf.copyQueryPoolResults(*query_pool, query, 1, results.Handle(), query * sizeof(u64),
+                                sizeof(u64),
+                                vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait);
+    MakeResultVisible(cmdbuf, query);
+    for (auto& guest_query : active_queries) {
+        guest_query.segments.push_back(query);
+    }
+}
+
+u32 OcclusionQueries::CopyPredicate(const VideoCore::Buffer& buffer, u32 offset) {
+    // Copies are used as a ring like the queries, after them in the results buffer
+    const u32 slot = NumQueries + next_copy;
+    next_copy = (next_copy + 1) % NumCopySlots;
+    scheduler.EndRendering();
+    const auto cmdbuf = scheduler.CommandBuffer();
+    const vk::BufferMemoryBarrier2 pre_barrier = {
+        .srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+        .srcAccessMask = vk::AccessFlagBits2::eMemoryWrite,
+        .dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .dstAccessMask = vk::AccessFlagBits2::eTransferRead,
+        .buffer = buffer.Handle(),
+        .offset = offset,
+        .size = sizeof(u32),
+    };
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .bufferMemoryBarrierCount = 1,
+        .pBufferMemoryBarriers = &pre_barrier,
+    });
+    const vk::BufferCopy copy = {
+        .srcOffset = offset,
+        .dstOffset = slot * sizeof(u64),
+        .size = sizeof(u32),
+    };
+    cmdbuf.copyBuffer(buffer.Handle(), results.Handle(), copy);
+    MakeResultVisible(cmdbuf, slot);
+    return slot;
+}
+
+void OcclusionQueries::MakeResultVisible(vk::CommandBuffer cmdbuf, u32 slot) {
+    vk::PipelineStageFlags2 dst_stages = vk::PipelineStageFlagBits2::eHost;
+    vk::AccessFlags2 dst_access = vk::AccessFlagBits2::eHostRead;
+    if (instance.IsConditionalRenderingSupported()) {
+        dst_stages |= vk::PipelineStageFlagBits2::eConditionalRenderingEXT;
+        dst_access |= vk::AccessFlagBits2::eConditionalRenderingReadEXT;
+    }
+    const vk::BufferMemoryBarrier2 barrier = {
+        .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+        .dstStageMask = dst_stages,
+        .dstAccessMask = dst_access,
+        .buffer = results.Handle(),
+        .offset = slot * sizeof(u64),
+        .size = sizeof(u64),
+    };
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .bufferMemoryBarrierCount = 1,
+        .pBufferMemoryBarriers = &barrier,
+    });
+}
+
+void OcclusionQueries::ReportPredicated() {
+    if (num_predicated == 0) {
+        return;
+    }
+    const u32 count = std::exchange(num_predicated, 0);
+    Common::CountPerf(Common::PerfCounter::PredicatedDraws, count);
+    // Conditional rendering tests the low 32 bits of the slot, skipped work is counted once the
+    // GPU is done with it, in the frame it completes in
+    scheduler.DeferPriorityOperation([this, count, slot = predicate.slot,
+                                      inverted = predicate.inverted] {
+        u32 value;
+        std::memcpy(&value, results.mapped_data.data() + slot * sizeof(u64), sizeof(u32));
+        if ((value == 0) != inverted) {
+            Common::CountPerf(Common::PerfCounter::PredicatedOutDraws, count);
+        }
+    });
+}
+
+void OcclusionQueries::PublishResults(VAddr address, u32 num_pairs,
+                                      boost::container::small_vector<u32, 4>&& segments) {
+    if (segments.size() <= 1) {
+        if (predicate_slots.size() >= MaxPredicateQueries) {
+            predicate_slots.clear();
+        }
+        predicate_slots[address] = segments.empty() ? ZeroSlot : segments.front();
+    } else {
+        predicate_slots.erase(address);
+    }
+    // The guest polls the results on the CPU, so they are summed up and written by the host once
+    // the GPU is done with the segments, without waiting for it here.
+    scheduler.DeferPriorityOperation([this, address, num_pairs, segments = std::move(segments)] {
+        u64 count = 0;
+        for (const u32 query : segments) {
+            u64 result;
+            std::memcpy(&result, results.mapped_data.data() + query * sizeof(u64), sizeof(u64));
+            count += result;
+        }
+        // All samples are reported by the first render backend, the others count none
+        std::array<u64, MaxCounterPairs * 2> counters;
+        counters.fill(CounterValidMask);
+        counters[1] = count | CounterValidMask;
+        const u32 num_bytes = std::min(num_pairs, MaxCounterPairs) * 2 * sizeof(u64);
+        auto* dst = reinterpret_cast<void*>(address);
+        if (!Core::Memory::Instance()->TryWriteBacking(dst, counters.data(), num_bytes)) {
+            std::memcpy(dst, counters.data(), num_bytes);
+        }
+    });
+}
+
+} // namespace Vulkan
@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <boost/container/small_vector.hpp>
+
+#include "common/types.h"
+#include "video_core/buffer_cache/buffer.h"
+#include "video_core/renderer_vulkan/vk_common.h"
+
+namespace Vulkan {
+
+class Instance;
+class Scheduler;
+
+/**
+ * Occlusion queries of the guest, counted by Vulkan occlusion queries. Guest queries are bounded
+ * by ZPASS_DONE events at the start of their results, where the begin counters of every render
+ * backend are, and 8 bytes after it for the end counters. Host queries can't span command
+ * buffers nor nest, so they count segments of draws that end at every event and submission, and
+ * the segments a guest query spans are summed up once the GPU is done with them.
+ *
+ * Predicated draws and dispatches are recorded under conditional rendering, testing either the
+ * result of a query or a guest value copied on the GPU next to the results, so they are skipped
+ * without waiting for their predicate on the CPU.
+ */
+class OcclusionQueries {
+public:
+    explicit OcclusionQueries(const Instance& instance, Scheduler& scheduler);
+    ~OcclusionQueries();
+
+    OcclusionQueries(const OcclusionQueries&) = delete;
+    OcclusionQueries& operator=(const OcclusionQueries&) = delete;
+
+    /// Handles a ZPASS_DONE event writing num_pairs counter pairs at address.
+    void ZpassDone(VAddr address, u32 num_pairs);
+
+    /// Makes predicated draws depend on the query with results at address, or disables
+    /// predication when address is zero.
+    void SetPredication(VAddr address, bool draw_if_visible);
+
+    /// Makes predicated draws depend on the 32-bit value at offset of buffer, drawing when it is
+    /// not zero or, if inverted, when it is. Must be called outside of a render pass.
+    void SetMemoryPredication(const VideoCore::Buffer& buffer, u32 offset, bool inverted);
+
+    /// Makes the draws of a COND_EXEC block depend on the value at offset of buffer, until
+    /// EndCondExec restores the predicate set before. Must be called outside of a render pass.
+    void BeginCondExec(const VideoCore::Buffer& buffer, u32 offset);
+    void EndCondExec();
+
+    /// Counts a predicated draw or dispatch about to be recorded.
+    void CountPredicated();
+
+    /// Starts counting for the draw about to be recorded when guest queries are active. Must be
+    /// called outside of the render pass the draw is recorded in.
+    void PrepareDraw();
+
+    /// Begins or ends conditional rendering for the draw about to be recorded, inside of its
+    /// render pass.
+    void ApplyPredication(bool predicated);
+
+    /// Ends conditional rendering before the render pass ends.
+    void EndConditionalRendering();
+
+    /// Ends the counting segment before the command buffer is submitted.
+    void EndSegment();
+
+private:
+    static constexpr u32 NumQueries = 4096;
+    /// Slot of the results buffer that stays zero, the result of guest queries without draws
+    static constexpr u32 ZeroSlot = 0;
+    /// Slots after the query results holding guest predicates copied by the GPU
+    static constexpr u32 NumCopySlots = 1024;
+    static constexpr size_t MaxActiveQueries = 64;
+    static constexpr size_t MaxPredicateQueries = 4096;
+
+    struct GuestQuery {
+        VAddr address;
+        boost::container::small_vector<u32, 4> segments;
+    };
+
+    struct Predicate {
+        bool enabled;
+        u32 slot;
+        bool inverted;
+
+        bool operator==(const Predicate&) const = default;
+    };
+
+    u32 CopyPredicate(const VideoCore::Buffer& buffer, u32 offset);
+    void MakeResultVisible(vk::CommandBuffer cmdbuf, u32 slot);
+    void ReportPredicated();
+    void PublishResults(VAddr address, u32 num_pairs,
+                        boost::container::small_vector<u32, 4>&& segments);
+
+    const Instance& instance;
+    Scheduler& scheduler;
+    vk::UniqueQueryPool query_pool;
+    VideoCore::Buffer results; ///< One 64-bit result per query, then the copied predicates
+    std::vector<GuestQuery> active_queries;
+    /// Results of finished guest queries counted by a single segment, for predication
+    std::unordered_map<VAddr, u32> predicate_slots;
+    u32 open_query{};
+    u32 next_query{1};
+    u32 next_copy{};
+    Predicate predicate{};
+    Predicate saved_predicate{}; ///< Predicate of SET_PREDICATION during COND_EXEC blocks
+    u32 num_predicated{};        ///< Predicated draws recorded under the current predicate
+    Predicate applied_predicate{};
+    bool conditional_rendering{};
+};
+
+} // namespace Vulkan
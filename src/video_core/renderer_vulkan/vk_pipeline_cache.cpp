@@ -1,12 +1,17 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <chrono>
 #include <ranges>
+#include <xxhash.h>
 
+#include "common/alloc_tracker.h"
 #include "common/config.h"
 #include "common/hash.h"
 #include "common/io_file.h"
 #include "common/path_util.h"
+#include "common/perf_counters.h"
 #include "core/debug_state.h"
 #include "shader_recompiler/backend/spirv/emit_spirv.h"
 #include "shader_recompiler/info.h"
@@ -19,6 +24,7 @@
 #include "video_core/renderer_vulkan/vk_pipeline_serialization.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 #include "video_core/renderer_vulkan/vk_shader_util.h"
+#include "video_core/stall_tracker.h"
 
 namespace Vulkan {
 
@@ -36,6 +42,20 @@ constexpr static std::array DescriptorHeapSizes = {
     vk::DescriptorPoolSize{vk::DescriptorType::eSampler, 1024},
 };
 
+static Shader::Fp64Mode GetFp64Mode(const Instance& instance) {
+    const std::string mode = Config::getFp64Mode();
+    if (!instance.IsShaderFloat64Supported() || mode == "lower") {
+        return Shader::Fp64Mode::Lower;
+    }
+    if (mode == "hybrid") {
+        return Shader::Fp64Mode::Hybrid;
+    }
+    if (mode != "auto" && mode != "native") {
+        LOG_WARNING(Render_Vulkan, "Unknown fp64 mode {}, using native fp64", mode);
+    }
+    return Shader::Fp64Mode::Native;
+}
+
 static u32 MapOutputs(std::span<Shader::OutputMap, 3> outputs, const AmdGpu::VsOutputControl& ctl) {
     u32 num_outputs = 0;
 
@@ -124,8 +144,10 @@ const Shader::RuntimeInfo& PipelineCache::BuildRuntimeInfo(Stage stage, LogicalS
     }
     case Stage::Vertex: {
         BuildCommon(regs.vs_program);
-        info.vs_info.step_rate_0 = regs.vgt_instance_step_rate_0;
-        info.vs_info.step_rate_1 = regs.vgt_instance_step_rate_1;
+        if (!profile.dynamic_instance_step_rates) {
+            info.vs_info.step_rate_0 = regs.vgt_instance_step_rate_0;
+            info.vs_info.step_rate_1 = regs.vgt_instance_step_rate_1;
+        }
         info.vs_info.num_outputs = MapOutputs(info.vs_info.outputs, regs.vs_output_control);
         info.vs_info.emulate_depth_negative_one_to_one =
             !instance.IsDepthClipControlSupported() &&
@@ -219,9 +241,13 @@ const Shader::RuntimeInfo& PipelineCache::BuildRuntimeInfo(Stage stage, LogicalS
 }
 
 PipelineCache::PipelineCache(const Instance& instance_, Scheduler& scheduler_,
-                             AmdGpu::Liverpool* liverpool_)
+                             AmdGpu::Liverpool* liverpool_, const SamplerHeap* sampler_heap_)
     : instance{instance_}, scheduler{scheduler_}, liverpool{liverpool_},
-      desc_heap{instance, scheduler.GetMasterSemaphore(), DescriptorHeapSizes} {
+      desc_heap{instance, scheduler.GetMasterSemaphore(), DescriptorHeapSizes},
+      sampler_heap{sampler_heap_} {
+    if (instance.IsDescriptorBufferSupported()) {
+        desc_buffer = std::make_unique<DescriptorBuffer>(instance, scheduler);
+    }
     const auto& vk12_props = instance.GetVk12Properties();
     profile = Shader::Profile{
         // When binding a UBO, we calculate its size considering the offset in the larger buffer
@@ -266,19 +292,72 @@ PipelineCache::PipelineCache(const Instance& instance_, Scheduler& scheduler_,
                               instance.GetDriverID() == vk::DriverId::eMoltenvk,
         .needs_buffer_offsets = instance.StorageMinAlignment() > 4,
         .needs_unorm_fixup = instance.GetDriverID() == vk::DriverId::eMoltenvk,
+        // Divisors of instanced attributes are only left out of the pipeline with dynamic
+        // vertex input, otherwise the step rates still need to be part of the permutation.
+        .dynamic_instance_step_rates =
+            Config::isDynamicInstanceStepRatesEnabled() && instance.IsVertexInputDynamicState(),
+        .loop_invariant_code_motion = Config::isLoopInvariantCodeMotionEnabled(),
+        .bindless_samplers = sampler_heap != nullptr,
+        .fp64_mode = GetFp64Mode(instance),
     };
 
-    WarmUp();
-
-    auto [cache_result, cache] = instance.GetDevice().createPipelineCacheUnique({});
+    // Driver data written by an earlier run or the offline cache builder.
+    const auto driver_cache_data = LoadDriverCache();
+    const vk::PipelineCacheCreateInfo cache_ci = {
+        .initialDataSize = driver_cache_data.size(),
+        .pInitialData = driver_cache_data.data(),
+    };
+    auto [cache_result, cache] = instance.GetDevice().createPipelineCacheUnique(cache_ci);
     ASSERT_MSG(cache_result == vk::Result::eSuccess, "Failed to create pipeline cache: {}",
                vk::to_string(cache_result));
     pipeline_cache = std::move(cache);
+
+    if (instance.IsGraphicsPipelineLibrarySupported() && Config::isPipelineLibraryEnabled()) {
+        library_cache = std::make_unique<PipelineLibraryCache>(instance);
+        LOG_INFO(Render_Vulkan, "Linking graphics pipelines from pipeline libraries");
+    }
+
+    WarmUp();
+
+    if (const s32 num_workers = Config::getPipelineCompileWorkers(); num_workers > 0) {
+        compile_workers = std::make_unique<Common::ThreadWorker>(num_workers, "PipelineCompiler");
+        skip_pending_draws = Config::getPipelineSkipPendingDraws();
+        LOG_INFO(Render_Vulkan, "Using {} pipeline compile workers, pending draws are {}",
+                 num_workers, skip_pending_draws ? "skipped" : "waited for");
+    }
+    // Shader debugging keeps the handles of the modules it collects, so they are never swapped.
+    if (Config::isTieredShaderCompilationEnabled() && !Config::collectShadersForDebug()) {
+        tiered_compilation = true;
+        LOG_INFO(Render_Vulkan, "Optimizing shaders in the background after their first use");
+    }
 }
 
-PipelineCache::~PipelineCache() = default;
+PipelineCache::~PipelineCache() {
+    // Optimizations that didn't start are pointless once the modules go away
+    optimize_jobs.Cancel();
+    optimize_jobs.Wait();
+    const auto usage = Shader::Pools::PeakUsage();
+    LOG_INFO(Render_Vulkan,
+             "Shader IR pool peak usage: {} instructions (chunk size {}), {} blocks (chunk size {})",
+             usage.num_insts, Shader::Pools::InstPoolSize, usage.num_blocks,
+             Shader::Pools::BlockPoolSize);
+}
 
 const GraphicsPipeline* PipelineCache::GetGraphicsPipeline() {
+    Common::ScopedAllocTag alloc_tag{Common::AllocTag::PipelineCache};
+    SwapOptimizedModules();
+    if (!liverpool->ConsumeGraphicsStateDirty() && last_graphics_pipeline) {
+        graphics_state_changed = false;
+        // Same state as the previous draw, only refresh what shaders read through user data
+        for (auto* info : graphics_infos) {
+            if (info) {
+                info->RefreshFlatBuf();
+            }
+        }
+        return last_graphics_pipeline;
+    }
+    last_graphics_pipeline = nullptr;
+    graphics_state_changed = true;
     if (!RefreshGraphicsKey()) {
         return nullptr;
     }
@@ -288,14 +367,30 @@ const GraphicsPipeline* PipelineCache::GetGraphicsPipeline() {
         LOG_INFO(Render_Vulkan, "Compiling graphics pipeline {:#x}", pipeline_hash);
 
         GraphicsPipeline::SerializationSupport sdata{};
+        const bool deferred = compile_workers != nullptr;
+        std::optional<VideoCore::ScopedStall> stall;
+        if (!deferred) {
+            stall.emplace(VideoCore::StallCause::PipelineCreate, pipeline_hash);
+        }
         it.value() = std::make_unique<GraphicsPipeline>(
-            instance, scheduler, desc_heap, profile, graphics_key, *pipeline_cache, infos,
-            runtime_infos, fetch_shader, modules, sdata, false);
+            instance, scheduler, desc_heap, desc_buffer.get(), sampler_heap, profile, graphics_key,
+            *pipeline_cache, library_cache.get(), infos, runtime_infos, fetch_shader, modules,
+            sdata, false, deferred);
+        if (deferred) {
+            QueueBuild(*compile_workers, [this, pipeline = it.value().get(), sdata,
+                                          modules = modules] {
+                pipeline->Build(*pipeline_cache, modules, sdata);
+            });
+        }
 
         RegisterPipelineData(graphics_key, pipeline_hash, sdata);
         ++num_new_pipelines;
+        driver_cache_dirty = true;
+        if (!deferred) {
+            MergeDriverCache();
+        }
 
-        if (Config::collectShadersForDebug()) {
+        if (Config::collectShadersForDebug() || tiered_compilation) {
             for (auto stage = 0; stage < MaxShaderStages; ++stage) {
                 if (infos[stage]) {
                     auto& m = modules[stage];
@@ -305,10 +400,28 @@ const GraphicsPipeline* PipelineCache::GetGraphicsPipeline() {
         }
         fetch_shader.reset();
     }
-    return it->second.get();
+    last_graphics_pipeline = it->second.get();
+    return last_graphics_pipeline;
+}
+
+const GraphicsPipeline* PipelineCache::GetUnchangedGraphicsPipeline() {
+    if (liverpool->IsGraphicsStateDirty() || !last_graphics_pipeline) {
+        return nullptr;
+    }
+    bool unchanged = true;
+    for (auto* info : graphics_infos) {
+        if (info) {
+            prev_flat_buf = info->flattened_ud_buf;
+            info->RefreshFlatBuf();
+            unchanged &= info->flattened_ud_buf == prev_flat_buf;
+        }
+    }
+    return unchanged ? last_graphics_pipeline : nullptr;
 }
 
 const ComputePipeline* PipelineCache::GetComputePipeline() {
+    Common::ScopedAllocTag alloc_tag{Common::AllocTag::PipelineCache};
+    SwapOptimizedModules();
     if (!RefreshComputeKey()) {
         return nullptr;
     }
@@ -318,13 +431,18 @@ const ComputePipeline* PipelineCache::GetComputePipeline() {
         LOG_INFO(Render_Vulkan, "Compiling compute pipeline {:#x}", pipeline_hash);
 
         ComputePipeline::SerializationSupport sdata{};
-        it.value() = std::make_unique<ComputePipeline>(instance, scheduler, desc_heap, profile,
-                                                       *pipeline_cache, compute_key, *infos[0],
-                                                       modules[0], sdata, false);
+        VideoCore::ScopedStall stall{VideoCore::StallCause::PipelineCreate, compute_key.value, 1};
+        it.value() = std::make_unique<ComputePipeline>(
+            instance, scheduler, desc_heap, desc_buffer.get(), sampler_heap, profile,
+            *pipeline_cache, compute_key, *infos[0], modules[0], sdata, false);
         RegisterPipelineData(compute_key, sdata);
         ++num_new_pipelines;
+        driver_cache_dirty = true;
+        if (!compile_workers) {
+            MergeDriverCache();
+        }
 
-        if (Config::collectShadersForDebug()) {
+        if (Config::collectShadersForDebug() || tiered_compilation) {
             auto& m = modules[0];
             module_related_pipelines[m].emplace_back(compute_key);
         }
@@ -332,6 +450,51 @@ const ComputePipeline* PipelineCache::GetComputePipeline() {
     return it->second.get();
 }
 
+bool PipelineCache::EnsureReady(const Pipeline& pipeline) {
+    if (pipeline.IsReady()) {
+        return true;
+    }
+    if (skip_pending_draws && !pipeline.IsCompute()) {
+        compile_stats.num_skipped_draws.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    const u64 key = pipeline.IsCompute()
+                        ? static_cast<const ComputePipeline&>(pipeline).GetComputeKey().value
+                        : std::hash<GraphicsPipelineKey>{}(
+                              static_cast<const GraphicsPipeline&>(pipeline).GetGraphicsKey());
+    VideoCore::ScopedStall stall{VideoCore::StallCause::PipelineWait, key,
+                                 pipeline.IsCompute() ? 1U : 0U};
+    pipeline.WaitReady();
+    return true;
+}
+
+void PipelineCache::QueueBuild(Common::ThreadWorker& workers,
+                               Common::UniqueFunction<void> build) {
+    compile_stats.num_queued.fetch_add(1, std::memory_order_relaxed);
+    workers.QueueWork([this, build = std::move(build),
+                       queued_time = std::chrono::steady_clock::now()] {
+        build();
+
+        const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                                 std::chrono::steady_clock::now() - queued_time)
+                                 .count();
+        compile_stats.total_latency_us.fetch_add(latency, std::memory_order_relaxed);
+        u64 max_latency = compile_stats.max_latency_us.load(std::memory_order_relaxed);
+        while (u64(latency) > max_latency &&
+               !compile_stats.max_latency_us.compare_exchange_weak(max_latency, latency,
+                                                                   std::memory_order_relaxed)) {
+        }
+        compile_stats.num_compiled.fetch_add(1, std::memory_order_relaxed);
+        LOG_DEBUG(Render_Vulkan, "Built pipeline in {} us, {} pipelines pending", latency,
+                  compile_stats.QueueDepth());
+
+        driver_cache_dirty = true;
+        if (compile_stats.QueueDepth() == 0) {
+            MergeDriverCache();
+        }
+    });
+}
+
 bool PipelineCache::RefreshGraphicsKey() {
     std::memset(&graphics_key, 0, sizeof(GraphicsPipelineKey));
     const auto& regs = liverpool->regs;
@@ -344,15 +507,24 @@ bool PipelineCache::RefreshGraphicsKey() {
     key.stencil_format = regs.depth_buffer.StencilValid()
                              ? regs.depth_buffer.stencil_info.format
                              : AmdGpu::DepthBuffer::StencilFormat::Invalid;
-    key.depth_clamp_enable = !regs.depth_render_override.disable_viewport_clamp;
-    key.depth_clip_enable = regs.clipper_control.ZclipEnable();
+    // State the device sets dynamically stays out of the key, so it doesn't multiply pipelines
+    if (!instance.IsDynamicDepthClampSupported()) {
+        key.depth_clamp_enable = !regs.depth_render_override.disable_viewport_clamp;
+        key.depth_clip_enable = regs.clipper_control.ZclipEnable();
+    }
     key.clip_space = regs.clipper_control.clip_space;
-    key.provoking_vtx_last = regs.polygon_control.provoking_vtx_last;
+    if (!instance.IsDynamicProvokingVertexSupported()) {
+        key.provoking_vtx_last = regs.polygon_control.provoking_vtx_last;
+    }
     key.prim_type = regs.primitive_type;
-    key.polygon_mode = regs.polygon_control.PolyMode();
+    if (!instance.IsDynamicPolygonModeSupported()) {
+        key.polygon_mode = regs.polygon_control.PolyMode();
+    }
     key.patch_control_points =
         regs.stage_enable.hs_en ? regs.ls_hs_config.hs_input_control_points : 0;
-    key.logic_op = regs.color_control.rop3;
+    if (!instance.IsDynamicLogicOpSupported()) {
+        key.logic_op = regs.color_control.rop3;
+    }
     key.depth_samples = db_enabled ? regs.depth_buffer.NumSamples() : 1;
     key.num_samples = key.depth_samples;
     key.cb_shader_mask = regs.color_shader_mask;
@@ -383,6 +555,8 @@ bool PipelineCache::RefreshGraphicsKey() {
     }
 
     // Second pass to mask out render targets not written by shader and fill remaining info
+    blend_controls = {};
+    write_masks = {};
     u8 color_samples = 0;
     bool all_color_samples_same = true;
     for (s32 cb = 0; cb < key.num_color_attachments && !skip_cb_binding; ++cb) {
@@ -398,11 +572,11 @@ bool PipelineCache::RefreshGraphicsKey() {
 
         // Fill color blending information
         if (regs.blend_control[cb].enable && !col_buf.info.blend_bypass) {
-            key.blend_controls[cb] = regs.blend_control[cb];
+            blend_controls[cb] = regs.blend_control[cb];
         }
 
         // Apply swizzle to target mask
-        key.write_masks[cb] =
+        write_masks[cb] =
             vk::ColorComponentFlags{key.color_buffers[cb].swizzle.ApplyMask(target_mask)};
 
         // Fill color samples
@@ -412,6 +586,13 @@ bool PipelineCache::RefreshGraphicsKey() {
         key.num_samples = std::max(key.num_samples, color_samples);
     }
 
+    if (!instance.IsDynamicColorBlendSupported()) {
+        key.blend_controls = blend_controls;
+    }
+    if (!instance.IsDynamicColorWriteMaskSupported()) {
+        key.write_masks = write_masks;
+    }
+
     // Force all color samples to match depth samples to avoid unsupported MSAA configuration
     if (color_samples != 0) {
         const bool depth_mismatch = db_enabled && color_samples != key.depth_samples;
@@ -422,6 +603,7 @@ bool PipelineCache::RefreshGraphicsKey() {
         }
     }
 
+    key.UpdateHash();
     return true;
 }
 
@@ -449,9 +631,10 @@ bool PipelineCache::RefreshGraphicsStages() {
 
         const auto params = AmdGpu::GetParams(*pgm);
         std::optional<Shader::Gcn::FetchShaderData> fetch_shader_;
-        std::tie(infos[stage_out_idx], modules[stage_out_idx], fetch_shader_,
+        std::tie(graphics_infos[stage_out_idx], modules[stage_out_idx], fetch_shader_,
                  key.stage_hashes[stage_out_idx]) =
             GetProgram(stage_in, stage_out, params, binding);
+        infos[stage_out_idx] = graphics_infos[stage_out_idx];
         if (fetch_shader_) {
             fetch_shader = fetch_shader_;
         }
@@ -459,6 +642,7 @@ bool PipelineCache::RefreshGraphicsStages() {
     };
 
     infos.fill(nullptr);
+    graphics_infos.fill(nullptr);
     modules.fill(nullptr);
     bind_stage(Stage::Fragment, LogicalStage::Fragment);
 
@@ -530,17 +714,41 @@ bool PipelineCache::RefreshComputeKey() {
 }
 
 vk::ShaderModule PipelineCache::CompileModule(Shader::Info& info, Shader::RuntimeInfo& runtime_info,
-                                              const std::span<const u32>& code, size_t perm_idx,
-                                              Shader::Backend::Bindings& binding) {
+                                              const std::span<const u32>& code,
+                                              std::unique_ptr<Shader::DecodedProgram>& decoded,
+                                              size_t perm_idx, Shader::Backend::Bindings& binding) {
+    Common::ScopedAllocTag alloc_tag{Common::AllocTag::ShaderRecompiler};
+    Common::CountPerf(Common::PerfCounter::ShaderCompiles);
+    VideoCore::ScopedStall stall{VideoCore::StallCause::ShaderCompile, info.pgm_hash,
+                                 static_cast<u32>(info.stage)};
     LOG_INFO(Render_Vulkan, "Compiling {} shader {:#x} {}", info.stage, info.pgm_hash,
              perm_idx != 0 ? "(permutation)" : "");
     DumpShader(code, info.pgm_hash, info.stage, perm_idx, "bin");
 
-    const auto ir_program = Shader::TranslateProgram(code, pools, info, runtime_info, profile);
+    // The optimized translation starts from the same state, so it ends up with the same bindings
+    const bool tiered = tiered_compilation;
+    auto source_info = tiered ? std::optional{info} : std::nullopt;
+    const auto source_runtime_info = tiered ? std::optional{runtime_info} : std::nullopt;
+    const auto source_binding = binding;
+
+    const bool collect_stats = Config::collectShadersForDebug() || Config::dumpShaders();
+    Shader::CompileStats stats{};
+    if (!decoded) {
+        decoded = std::make_unique<Shader::DecodedProgram>(code, collect_stats ? &stats : nullptr);
+    }
+    auto& pools = Shader::Pools::ThreadLocal();
+    const auto ir_program = Shader::TranslateProgram(*decoded, pools, info, runtime_info, profile,
+                                                     collect_stats ? &stats : nullptr, !tiered);
+    const auto emit_start = std::chrono::steady_clock::now();
     auto spv = Shader::Backend::SPIRV::EmitSPIRV(profile, runtime_info, ir_program, binding);
+    stats.emit_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - emit_start)
+                        .count();
+    stats.spirv_size = static_cast<u32>(spv.size() * sizeof(u32));
     DumpShader(spv, info.pgm_hash, info.stage, perm_idx, "spv");
 
     vk::ShaderModule module;
+    bool is_new_module = true;
 
     auto patch = GetShaderPatch(info.pgm_hash, info.stage, perm_idx, "spv");
     const bool is_patched = patch && Config::patchShaders();
@@ -548,20 +756,133 @@ vk::ShaderModule PipelineCache::CompileModule(Shader::Info& info, Shader::Runtim
         LOG_INFO(Loader, "Loaded patch for {} shader {:#x}", info.stage, info.pgm_hash);
         module = CompileSPV(*patch, instance.GetDevice());
     } else {
-        module = CompileSPV(spv, instance.GetDevice());
+        module = GetSharedModule(spv, is_new_module);
+        if (!is_new_module) {
+            // Its optimization was queued by the program that created the module
+            LOG_INFO(Render_Vulkan, "{} shader {:#x} translated to the code of an earlier one, {} "
+                     "modules shared", info.stage, info.pgm_hash,
+                     compile_stats.num_shared_modules.load());
+        } else if (tiered) {
+            QueueOptimization(std::move(*source_info), *source_runtime_info, code,
+                              source_binding, perm_idx, module);
+        }
     }
 
     RegisterShaderBinary(std::move(spv), info.pgm_hash, perm_idx);
 
     const auto name = GetShaderName(info.stage, info.pgm_hash, perm_idx);
-    Vulkan::SetObjectName(instance.GetDevice(), module, name);
+    if (is_new_module) {
+        Vulkan::SetObjectName(instance.GetDevice(), module, name);
+    }
+    DumpCompileStats(name, stats);
     if (Config::collectShadersForDebug()) {
         DebugState.CollectShader(name, info.l_stage, module, spv, code,
-                                 patch ? *patch : std::span<const u32>{}, is_patched);
+                                 patch ? *patch : std::span<const u32>{}, is_patched,
+                                 std::move(stats));
     }
     return module;
 }
 
+vk::ShaderModule PipelineCache::GetSharedModule(std::span<const u32> spv, bool& is_new) {
+    const u64 hash = XXH3_64bits(spv.data(), spv.size_bytes());
+    const auto [it, inserted] = shared_modules.try_emplace(hash);
+    is_new = inserted;
+    if (inserted) {
+        it.value() = CompileSPV(spv, instance.GetDevice());
+    } else {
+        ++compile_stats.num_shared_modules;
+        compile_stats.shared_module_bytes += spv.size_bytes();
+    }
+    return it->second;
+}
+
+void PipelineCache::ReplaceModuleReferences(vk::ShaderModule old_module,
+                                            vk::ShaderModule new_module) {
+    for (const auto& [_, program] : program_cache) {
+        for (auto& m : program->modules) {
+            if (m.module == old_module) {
+                m.module = new_module;
+            }
+        }
+    }
+    // Later translations to the old code get the replacement right away
+    for (auto it = shared_modules.begin(); it != shared_modules.end(); ++it) {
+        if (it->second == old_module) {
+            it.value() = new_module;
+        }
+    }
+}
+
+void PipelineCache::QueueOptimization(Shader::Info info, Shader::RuntimeInfo runtime_info,
+                                      std::span<const u32> code,
+                                      Shader::Backend::Bindings binding, size_t perm_idx,
+                                      vk::ShaderModule module) {
+    // The guest code and user data may be overwritten before the worker gets to them
+    std::vector<u32> code_copy(code.begin(), code.end());
+    std::vector<u32> user_data(info.user_data.begin(), info.user_data.end());
+    auto optimize = [this, info = std::move(info), runtime_info, binding, perm_idx, module,
+                     code = std::move(code_copy), user_data = std::move(user_data)]() mutable {
+        Common::ScopedAllocTag alloc_tag{Common::AllocTag::ShaderRecompiler};
+        info.user_data = user_data;
+        Shader::DecodedProgram decoded{code};
+        auto& pools = Shader::Pools::ThreadLocal();
+        const auto ir_program =
+            Shader::TranslateProgram(decoded, pools, info, runtime_info, profile);
+        auto spv = Shader::Backend::SPIRV::EmitSPIRV(profile, runtime_info, ir_program, binding);
+        std::scoped_lock lock{optimized_mutex};
+        optimized_modules.push_back({
+            .pgm_hash = info.pgm_hash,
+            .perm_idx = perm_idx,
+            .module = module,
+            .spv = std::move(spv),
+        });
+        has_optimized_modules.store(true, std::memory_order_release);
+    };
+    // Runs behind the jobs of other subsystems, the unoptimized module is in use meanwhile
+    const Common::JobOptions options = {
+        .priority = Common::JobPriority::Low,
+        .group = &optimize_jobs,
+    };
+    Common::GetThreadPool().Submit(std::move(optimize), options);
+}
+
+void PipelineCache::SwapOptimizedModules() {
+    if (!has_optimized_modules.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::vector<OptimizedModule> optimized;
+    {
+        std::scoped_lock lock{optimized_mutex};
+        optimized = std::exchange(optimized_modules, {});
+        has_optimized_modules.store(false, std::memory_order_relaxed);
+    }
+    const auto device = instance.GetDevice();
+    for (auto& optimized_module : optimized) {
+        const auto it = program_cache.find(optimized_module.pgm_hash);
+        if (it == program_cache.end() ||
+            optimized_module.perm_idx >= it->second->modules.size()) {
+            continue;
+        }
+        auto& program = it.value();
+        auto& module = program->modules[optimized_module.perm_idx].module;
+        if (module != optimized_module.module) {
+            continue;
+        }
+        RemoveModulePipelines(module);
+        // Pipelines recorded with the old module may still be executing
+        const auto old_module = module;
+        scheduler.DeferOperation([device, old_module] { device.destroyShaderModule(old_module); });
+        module = CompileSPV(optimized_module.spv, device);
+        ReplaceModuleReferences(old_module, module);
+        const auto name = GetShaderName(program->info.stage, optimized_module.pgm_hash,
+                                        optimized_module.perm_idx);
+        Vulkan::SetObjectName(device, module, name);
+        LOG_DEBUG(Render_Vulkan, "Swapped in optimized shader {}", name);
+        RegisterShaderBinary(std::move(optimized_module.spv), optimized_module.pgm_hash,
+                             optimized_module.perm_idx);
+    }
+}
+
 PipelineCache::Result PipelineCache::GetProgram(Stage stage, LogicalStage l_stage,
                                                 const Shader::ShaderParams& params,
                                                 Shader::Backend::Bindings& binding) {
@@ -571,12 +892,14 @@ PipelineCache::Result PipelineCache::GetProgram(Stage stage, LogicalStage l_stag
         it_pgm.value() = std::make_unique<Program>(stage, l_stage, params);
         auto& program = it_pgm.value();
         auto start = binding;
-        const auto module = CompileModule(program->info, runtime_info, params.code, 0, binding);
+        const auto module =
+            CompileModule(program->info, runtime_info, params.code, program->decoded, 0, binding);
         auto spec = Shader::StageSpecialization(program->info, runtime_info, profile, start);
         const auto perm_hash = HashCombine(params.hash, 0);
 
         RegisterShaderMeta(program->info, spec.fetch_shader_data, spec, perm_hash, 0);
         program->AddPermut(module, std::move(spec));
+        TrackDynamicState(program->modules.back(), stage);
         return std::make_tuple(&program->info, module, program->modules[0].spec.fetch_shader_data,
                                perm_hash);
     }
@@ -596,13 +919,20 @@ PipelineCache::Result PipelineCache::GetProgram(Stage stage, LogicalStage l_stag
     const auto it = std::ranges::find(program->modules, spec, &Program::Module::spec);
     if (it == program->modules.end()) {
         auto new_info = Shader::Info(stage, l_stage, params);
-        module = CompileModule(new_info, runtime_info, params.code, perm_idx, binding);
+        module = CompileModule(new_info, runtime_info, params.code, program->decoded, perm_idx,
+                               binding);
 
         RegisterShaderMeta(info, spec.fetch_shader_data, spec, perm_hash, perm_idx);
         program->AddPermut(module, std::move(spec));
+        TrackDynamicState(program->modules.back(), stage);
     } else {
         info.AddBindings(binding);
         module = it->module;
+        if (TrackDynamicState(*it, stage)) {
+            const u64 num_saved = ++compile_stats.num_saved_permutations;
+            LOG_INFO(Render_Vulkan, "Reused {} shader {:#x} for new dynamic state, {} saved",
+                     stage, params.hash, num_saved);
+        }
         perm_idx = std::distance(program->modules.begin(), it);
         perm_hash = HashCombine(params.hash, perm_idx);
     }
@@ -610,32 +940,67 @@ PipelineCache::Result PipelineCache::GetProgram(Stage stage, LogicalStage l_stag
                            program->modules[perm_idx].spec.fetch_shader_data, perm_hash);
 }
 
+bool PipelineCache::TrackDynamicState(Program::Module& module, Shader::Stage stage) {
+    if (!profile.dynamic_instance_step_rates || stage != Shader::Stage::Vertex) {
+        return false;
+    }
+    const auto& regs = liverpool->regs;
+    const u64 step_rates = u64(regs.vgt_instance_step_rate_1) << 32 | regs.vgt_instance_step_rate_0;
+    if (std::ranges::find(module.dynamic_states, step_rates) != module.dynamic_states.end()) {
+        return false;
+    }
+    module.dynamic_states.push_back(step_rates);
+    return module.dynamic_states.size() > 1;
+}
+
 std::optional<vk::ShaderModule> PipelineCache::ReplaceShader(vk::ShaderModule module,
                                                              std::span<const u32> spv_code) {
     std::optional<vk::ShaderModule> new_module{};
-    for (const auto& [_, program] : program_cache) {
-        for (auto& m : program->modules) {
-            if (m.module == module) {
-                const auto& d = instance.GetDevice();
-                d.destroyShaderModule(m.module);
-                m.module = CompileSPV(spv_code, d);
-                new_module = m.module;
-            }
-        }
+    const bool in_use = std::ranges::any_of(program_cache, [module](const auto& entry) {
+        return std::ranges::contains(entry.second->modules, module, &Program::Module::module);
+    });
+    if (in_use) {
+        // Programs translated to the same code share the module, they all get the new code
+        const auto& d = instance.GetDevice();
+        new_module = CompileSPV(spv_code, d);
+        ReplaceModuleReferences(module, *new_module);
+        d.destroyShaderModule(module);
     }
-    if (module_related_pipelines.contains(module)) {
-        auto& pipeline_keys = module_related_pipelines[module];
-        for (auto& key : pipeline_keys) {
+    RemoveModulePipelines(module);
+    return new_module;
+}
+
+void PipelineCache::RemoveModulePipelines(vk::ShaderModule module) {
+    last_graphics_pipeline = nullptr;
+    const auto remove = [&](auto& pipelines, const auto& key) {
+        const auto it = pipelines.find(key);
+        if (it == pipelines.end()) {
+            return;
+        }
+        it->second->WaitReady();
+        // Keep the pipeline alive until the commands recorded with it are done
+        scheduler.DeferOperation(
+            [pipeline = std::move(it.value())]() mutable { pipeline.reset(); });
+        pipelines.erase(it);
+    };
+    if (const auto it = module_related_pipelines.find(module);
+        it != module_related_pipelines.end()) {
+        for (const auto& key : it->second) {
             if (std::holds_alternative<GraphicsPipelineKey>(key)) {
-                auto& graphics_key = std::get<GraphicsPipelineKey>(key);
-                graphics_pipelines.erase(graphics_key);
+                remove(graphics_pipelines, std::get<GraphicsPipelineKey>(key));
             } else if (std::holds_alternative<ComputePipelineKey>(key)) {
-                auto& compute_key = std::get<ComputePipelineKey>(key);
-                compute_pipelines.erase(compute_key);
+                remove(compute_pipelines, std::get<ComputePipelineKey>(key));
             }
         }
+        module_related_pipelines.erase(it);
+    }
+    if (library_cache) {
+        // Libraries are keyed by module handles, which may be reused by the replacement.
+        if (compile_workers) {
+            compile_workers->WaitForRequests();
+        }
+        library_cache->Clear();
     }
-    return new_module;
 }
 
 std::string PipelineCache::GetShaderName(Shader::Stage stage, u64 hash,
@@ -662,6 +1027,37 @@ void PipelineCache::DumpShader(std::span<const u32> code, u64 hash, Shader::Stag
     file.WriteSpan(code);
 }
 
+void PipelineCache::DumpCompileStats(std::string_view name, const Shader::CompileStats& stats) {
+    if (!Config::dumpShaders()) {
+        return;
+    }
+
+    using namespace Common::FS;
+    const auto dump_dir = GetUserPath(PathType::ShaderDir) / "dumps";
+    if (!std::filesystem::exists(dump_dir)) {
+        std::filesystem::create_directories(dump_dir);
+    }
+    // One row per stage of every translated shader, so the file can be sorted by any column to
+    // find the shaders behind compile stalls.
+    const auto file = IOFile{dump_dir / "compile_stats.csv", FileAccessMode::Append};
+    std::string rows =
+        file.GetSize() == 0 ? "shader,stage,time_us,insts_before,insts_after\n" : "";
+    const auto add_row = [&](std::string_view stage, u64 time_us, u32 before, u32 after) {
+        rows += fmt::format("{},{},{},{},{}\n", name, stage, time_us, before, after);
+    };
+    add_row("Decode", stats.decode_us, stats.num_gcn_insts, stats.num_gcn_insts);
+    add_row("ControlFlowGraph", stats.cfg_us, stats.num_gcn_insts, stats.num_gcn_insts);
+    add_row("Structurize", stats.structurize_us, stats.num_gcn_insts,
+            stats.passes.empty() ? 0 : stats.passes.front().insts_before);
+    for (const auto& pass : stats.passes) {
+        add_row(pass.name, pass.time_us, pass.insts_before, pass.insts_after);
+    }
+    add_row("EmitSPIRV", stats.emit_us, stats.passes.empty() ? 0 : stats.passes.back().insts_after,
+            stats.spirv_size / sizeof(u32));
+    add_row("Total", stats.TotalUs(), stats.num_gcn_insts, stats.spirv_size / sizeof(u32));
+    file.WriteString(rows);
+}
+
 std::optional<std::vector<u32>> PipelineCache::GetShaderPatch(u64 hash, Shader::Stage stage,
                                                               size_t perm_idx,
                                                               std::string_view ext) {
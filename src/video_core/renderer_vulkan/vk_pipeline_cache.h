@@ -3,13 +3,21 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_set>
 #include <variant>
 #include <tsl/robin_map.h>
+#include "common/thread_pool.h"
+#include "common/thread_worker.h"
 #include "shader_recompiler/profile.h"
 #include "shader_recompiler/recompiler.h"
 #include "shader_recompiler/specialization.h"
 #include "video_core/renderer_vulkan/vk_compute_pipeline.h"
 #include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
+#include "video_core/renderer_vulkan/vk_pipeline_library.h"
 #include "video_core/renderer_vulkan/vk_resource_pool.h"
 
 template <>
@@ -41,12 +49,15 @@ struct Program {
     struct Module {
         vk::ShaderModule module;
         Shader::StageSpecialization spec;
+        /// Distinct values of state that is read at runtime instead of being specialized on.
+        boost::container::small_vector<u64, 2> dynamic_states{};
     };
     static constexpr size_t MaxPermutations = 8;
     using ModuleList = boost::container::small_vector<Module, MaxPermutations>;
 
     Shader::Info info;
     ModuleList modules{};
+    std::unique_ptr<Shader::DecodedProgram> decoded{}; ///< Shared by all permutations
 
     Program() = default;
     Program(Shader::Stage stage, Shader::LogicalStage l_stage, Shader::ShaderParams params)
@@ -63,24 +74,81 @@ struct Program {
     }
 };
 
+/// Counters of the background pipeline compilation, updated from the compile workers.
+struct PipelineCompileStats {
+    std::atomic<u64> num_queued{};
+    std::atomic<u64> num_compiled{};
+    std::atomic<u64> num_skipped_draws{};
+    std::atomic<u64> num_saved_permutations{};
+    std::atomic<u64> num_shared_modules{}; ///< Translations that matched an existing module
+    std::atomic<u64> shared_module_bytes{};
+    std::atomic<u64> total_latency_us{};
+    std::atomic<u64> max_latency_us{};
+    std::atomic<u32> warmup_total{};
+    std::atomic<u32> warmup_done{};
+
+    u64 QueueDepth() const noexcept {
+        return num_queued.load(std::memory_order_relaxed) -
+               num_compiled.load(std::memory_order_relaxed);
+    }
+
+    u64 AverageLatencyUs() const noexcept {
+        const u64 compiled = num_compiled.load(std::memory_order_relaxed);
+        return compiled ? total_latency_us.load(std::memory_order_relaxed) / compiled : 0;
+    }
+};
+
 class PipelineCache {
 public:
     explicit PipelineCache(const Instance& instance, Scheduler& scheduler,
-                           AmdGpu::Liverpool* liverpool);
+                           AmdGpu::Liverpool* liverpool, const SamplerHeap* sampler_heap);
     ~PipelineCache();
 
     void WarmUp();
     void Sync();
 
+    /// Blocks until every pipeline preloaded from the cache storage has been built.
+    void WaitForWarmUp();
+
     bool LoadComputePipeline(Serialization::Archive& ar);
     bool LoadGraphicsPipeline(Serialization::Archive& ar);
     bool LoadPipelineStage(Serialization::Archive& ar, size_t stage);
 
     const GraphicsPipeline* GetGraphicsPipeline();
 
+    /// Returns the pipeline of the previous draw if neither the registers nor the user data
+    /// its shaders read changed since, so its bound resources are still valid.
+    const GraphicsPipeline* GetUnchangedGraphicsPipeline();
+
+    /// Returns false if the last GetGraphicsPipeline call reused the previous pipeline because
+    /// no register was written since, so state derived from the registers is still current.
+    [[nodiscard]] bool IsGraphicsStateChanged() const noexcept {
+        return graphics_state_changed;
+    }
+
+    /// Blend controls of the color buffers of the last graphics pipeline, also when they are
+    /// set dynamically instead of being part of its key.
+    [[nodiscard]] const auto& GetBlendControls() const noexcept {
+        return blend_controls;
+    }
+
+    /// Color write masks of the last graphics pipeline, like GetBlendControls.
+    [[nodiscard]] const auto& GetWriteMasks() const noexcept {
+        return write_masks;
+    }
+
     const ComputePipeline* GetComputePipeline();
 
-    using Result = std::tuple<const Shader::Info*, vk::ShaderModule,
+    /// Makes sure the pipeline can be bound. Returns false when the pipeline is still being
+    /// compiled in the background and pending draws are configured to be skipped, otherwise
+    /// waits for the compile worker to finish.
+    bool EnsureReady(const Pipeline& pipeline);
+
+    const PipelineCompileStats& GetCompileStats() const {
+        return compile_stats;
+    }
+
+    using Result = std::tuple<Shader::Info*, vk::ShaderModule,
                               std::optional<Shader::Gcn::FetchShaderData>, u64>;
     Result GetProgram(Shader::Stage stage, Shader::LogicalStage l_stage,
                       const Shader::ShaderParams& params, Shader::Backend::Bindings& binding);
@@ -100,13 +168,52 @@ private:
     bool RefreshGraphicsStages();
     bool RefreshComputeKey();
 
+    /// Records the dynamic state a module is used with. Returns true when the module serves a
+    /// state it would otherwise have needed a separate permutation for.
+    bool TrackDynamicState(Program::Module& module, Shader::Stage stage);
+
+    void QueueBuild(Common::ThreadWorker& workers, Common::UniqueFunction<void> build);
+
+    /// Translates a module compiled with the fast pass set again with every optimization on the
+    /// optimize worker. Takes copies of the state the translation reads, as it runs later.
+    void QueueOptimization(Shader::Info info, Shader::RuntimeInfo runtime_info,
+                           std::span<const u32> code, Shader::Backend::Bindings binding,
+                           size_t perm_idx, vk::ShaderModule module);
+
+    /// Replaces the modules whose optimized code is ready, the pipelines using them are rebuilt
+    /// on their next use.
+    void SwapOptimizedModules();
+
+    /// Removes the pipelines built with a module, waiting for the ones still being compiled.
+    void RemoveModulePipelines(vk::ShaderModule module);
+    void ReportWarmUpProgress();
+
+    /// Queues the build of a preloaded pipeline. Pipelines that caused hitches in an earlier run
+    /// are built right away, the others once all of them were queued.
+    void QueueWarmUpBuild(const std::string& name, Common::UniqueFunction<void> build);
+
+    std::vector<u8> LoadDriverCache() const;
+    void SaveDriverCache() const;
+    /// Writes the driver cache back if pipelines were built since it was last saved. Saves are
+    /// spaced by DriverCacheSaveInterval, and skipped if another thread is already saving.
+    void MergeDriverCache();
+
     void DumpShader(std::span<const u32> code, u64 hash, Shader::Stage stage, size_t perm_idx,
                     std::string_view ext);
+    void DumpCompileStats(std::string_view name, const Shader::CompileStats& stats);
     std::optional<std::vector<u32>> GetShaderPatch(u64 hash, Shader::Stage stage, size_t perm_idx,
                                                    std::string_view ext);
+    /// Returns the module of a SPIR-V binary, shared by every program and permutation that was
+    /// translated to the same code. is_new is set when the module was created for this call.
+    vk::ShaderModule GetSharedModule(std::span<const u32> spv, bool& is_new);
+
+    /// Points the programs and shared binaries that use a module at its replacement.
+    void ReplaceModuleReferences(vk::ShaderModule old_module, vk::ShaderModule new_module);
+
     vk::ShaderModule CompileModule(Shader::Info& info, Shader::RuntimeInfo& runtime_info,
-                                   const std::span<const u32>& code, size_t perm_idx,
-                                   Shader::Backend::Bindings& binding);
+                                   const std::span<const u32>& code,
+                                   std::unique_ptr<Shader::DecodedProgram>& decoded,
+                                   size_t perm_idx, Shader::Backend::Bindings& binding);
     const Shader::RuntimeInfo& BuildRuntimeInfo(Shader::Stage stage, Shader::LogicalStage l_stage);
 
     [[nodiscard]] bool IsPipelineCacheDirty() const {
@@ -118,25 +225,62 @@ private:
     Scheduler& scheduler;
     AmdGpu::Liverpool* liverpool;
     DescriptorHeap desc_heap;
+    std::unique_ptr<DescriptorBuffer> desc_buffer; ///< Null when descriptor sets are used
+    const SamplerHeap* sampler_heap;               ///< Null unless samplers are bindless
     vk::UniquePipelineCache pipeline_cache;
+    std::unique_ptr<PipelineLibraryCache> library_cache;
     vk::UniquePipelineLayout pipeline_layout;
     Shader::Profile profile{};
-    Shader::Pools pools;
     tsl::robin_map<size_t, std::unique_ptr<Program>> program_cache;
+    tsl::robin_map<u64, vk::ShaderModule> shared_modules; ///< By the hash of their SPIR-V
     tsl::robin_map<ComputePipelineKey, std::unique_ptr<ComputePipeline>> compute_pipelines;
     tsl::robin_map<GraphicsPipelineKey, std::unique_ptr<GraphicsPipeline>> graphics_pipelines;
     std::array<Shader::RuntimeInfo, MaxShaderStages> runtime_infos{};
     std::array<const Shader::Info*, MaxShaderStages> infos{};
+    /// Stages of last_graphics_pipeline, refreshed when it is reused for consecutive draws.
+    std::array<Shader::Info*, MaxShaderStages> graphics_infos{};
+    const GraphicsPipeline* last_graphics_pipeline{};
+    bool graphics_state_changed{true};
+    std::array<AmdGpu::BlendControl, AmdGpu::NUM_COLOR_BUFFERS> blend_controls{};
+    std::array<vk::ColorComponentFlags, AmdGpu::NUM_COLOR_BUFFERS> write_masks{};
+    std::vector<u32> prev_flat_buf;
     std::array<vk::ShaderModule, MaxShaderStages> modules{};
     std::optional<Shader::Gcn::FetchShaderData> fetch_shader{};
     GraphicsPipelineKey graphics_key{};
     ComputePipelineKey compute_key{};
     u32 num_new_pipelines{}; // new pipelines added to the cache since the game start
 
-    // Only if Config::collectShadersForDebug()
+    // Only if Config::collectShadersForDebug() or Config::isTieredShaderCompilationEnabled()
     tsl::robin_map<vk::ShaderModule,
                    std::vector<std::variant<GraphicsPipelineKey, ComputePipelineKey>>>
         module_related_pipelines;
+
+    PipelineCompileStats compile_stats{};
+    std::chrono::steady_clock::time_point warmup_start{};
+    std::unordered_set<std::string> hitch_pipelines; ///< Storage names, only during the warm-up
+    std::vector<Common::UniqueFunction<void>> deferred_warmup_builds;
+    u32 num_hitch_pipelines{};
+    bool skip_pending_draws{};
+    static constexpr auto DriverCacheSaveInterval = std::chrono::seconds{30};
+    std::mutex driver_cache_mutex;
+    std::chrono::steady_clock::time_point last_driver_cache_save{};
+    std::atomic<bool> driver_cache_dirty{};
+
+    /// Optimized code of a module compiled with the fast pass set.
+    struct OptimizedModule {
+        u64 pgm_hash;
+        size_t perm_idx;
+        vk::ShaderModule module; ///< Module the code replaces
+        std::vector<u32> spv;
+    };
+    std::mutex optimized_mutex;
+    std::vector<OptimizedModule> optimized_modules;
+    std::atomic<bool> has_optimized_modules{};
+    // Declared last so workers are joined before the pipelines they are building are destroyed.
+    std::unique_ptr<Common::ThreadWorker> compile_workers;
+    std::unique_ptr<Common::ThreadWorker> warmup_workers;
+    bool tiered_compilation{};
+    Common::JobGroup optimize_jobs; ///< Optimizations running on the shared thread pool
 };
 
 } // namespace Vulkan
@@ -3,6 +3,7 @@
 
 #include <boost/container/static_vector.hpp>
 
+#include "common/perf_counters.h"
 #include "shader_recompiler/resource.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_pipeline_cache.h"
@@ -12,15 +13,17 @@
 namespace Vulkan {
 
 Pipeline::Pipeline(const Instance& instance_, Scheduler& scheduler_, DescriptorHeap& desc_heap_,
+                   DescriptorBuffer* desc_buffer_, const SamplerHeap* sampler_heap_,
                    const Shader::Profile& profile_, vk::PipelineCache pipeline_cache,
                    bool is_compute_ /*= false*/)
-    : instance{instance_}, scheduler{scheduler_}, desc_heap{desc_heap_}, profile{profile_},
-      is_compute{is_compute_} {}
+    : instance{instance_}, scheduler{scheduler_}, desc_heap{desc_heap_}, desc_buffer{desc_buffer_},
+      sampler_heap{sampler_heap_}, profile{profile_}, is_compute{is_compute_} {}
 
 Pipeline::~Pipeline() = default;
 
 void Pipeline::BindResources(DescriptorWrites& set_writes, const BufferBarriers& buffer_barriers,
-                             const Shader::PushData& push_data) const {
+                             const Shader::PushData& push_data,
+                             const Shader::BindlessPushData& bindless_data) const {
     const auto cmdbuf = scheduler.CommandBuffer();
     const auto bind_point =
         IsCompute() ? vk::PipelineBindPoint::eCompute : vk::PipelineBindPoint::eGraphics;
@@ -38,10 +41,23 @@ void Pipeline::BindResources(DescriptorWrites& set_writes, const BufferBarriers&
     const auto stage_flags = IsCompute() ? vk::ShaderStageFlagBits::eCompute : AllGraphicsStageBits;
     cmdbuf.pushConstants(*pipeline_layout, stage_flags, 0u, sizeof(push_data), &push_data);
 
+    // Pipelines with another set 0 layout disturb the heap binding, so it is bound for each one
+    if (sampler_heap) {
+        cmdbuf.pushConstants(*pipeline_layout, stage_flags, Shader::BindlessPushData::Offset,
+                             sizeof(bindless_data), &bindless_data);
+        cmdbuf.bindDescriptorSets(bind_point, *pipeline_layout, 1, sampler_heap->Set(), {});
+    }
+
     // Bind descriptor set.
     if (set_writes.empty()) {
         return;
     }
+    Common::CountPerf(Common::PerfCounter::DescriptorWrites, set_writes.size());
+
+    if (desc_buffer) {
+        desc_buffer->Bind(bind_point, *pipeline_layout, desc_buffer_layout, set_writes);
+        return;
+    }
 
     if (uses_push_descriptors) {
         cmdbuf.pushDescriptorSetKHR(bind_point, *pipeline_layout, 0, set_writes);
@@ -56,6 +72,43 @@ void Pipeline::BindResources(DescriptorWrites& set_writes, const BufferBarriers&
     cmdbuf.bindDescriptorSets(bind_point, *pipeline_layout, 0, desc_set, {});
 }
 
+vk::DescriptorSetLayoutCreateFlags Pipeline::GetSetLayoutFlags(u32 num_bindings) {
+    if (desc_buffer) {
+        return vk::DescriptorSetLayoutCreateFlagBits::eDescriptorBufferEXT;
+    }
+    uses_push_descriptors = num_bindings < instance.MaxPushDescriptors();
+    return uses_push_descriptors ? vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR
+                                 : vk::DescriptorSetLayoutCreateFlags{};
+}
+
+vk::PipelineCreateFlags Pipeline::GetPipelineFlags() const {
+    return desc_buffer ? vk::PipelineCreateFlagBits::eDescriptorBufferEXT
+                       : vk::PipelineCreateFlags{};
+}
+
+void Pipeline::InitDescriptorBufferLayout(u32 num_bindings) {
+    if (desc_buffer) {
+        desc_buffer_layout = DescriptorBuffer::GetLayout(instance, *desc_layout, num_bindings);
+    }
+}
+
+bool Pipeline::IsBindlessSampler(u32 index) const {
+    return sampler_heap && index < Shader::NUM_BINDLESS_SAMPLERS;
+}
+
+boost::container::static_vector<vk::DescriptorSetLayout, 2> Pipeline::GetSetLayouts() const {
+    boost::container::static_vector<vk::DescriptorSetLayout, 2> set_layouts{*desc_layout};
+    if (sampler_heap) {
+        set_layouts.push_back(sampler_heap->Layout());
+    }
+    return set_layouts;
+}
+
+u32 Pipeline::GetPushConstantsSize() const {
+    return sampler_heap ? Shader::BindlessPushData::Offset + sizeof(Shader::BindlessPushData)
+                        : sizeof(Shader::PushData);
+}
+
 std::string Pipeline::GetDebugString() const {
     std::string stage_desc;
     for (const auto& stage : stages) {
@@ -3,15 +3,20 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "shader_recompiler/profile.h"
 #include "shader_recompiler/runtime_info.h"
 #include "video_core/renderer_vulkan/vk_common.h"
+#include "video_core/renderer_vulkan/vk_resource_pool.h"
 
 #include <boost/container/small_vector.hpp>
+#include <boost/container/static_vector.hpp>
 
 namespace Shader {
 struct Info;
 struct PushData;
+struct BindlessPushData;
 } // namespace Shader
 
 namespace Vulkan {
@@ -28,6 +33,7 @@ class DescriptorHeap;
 class Pipeline {
 public:
     Pipeline(const Instance& instance, Scheduler& scheduler, DescriptorHeap& desc_heap,
+             DescriptorBuffer* desc_buffer, const SamplerHeap* sampler_heap,
              const Shader::Profile& profile, vk::PipelineCache pipeline_cache,
              bool is_compute = false);
     virtual ~Pipeline();
@@ -57,25 +63,61 @@ public:
         return is_compute;
     }
 
+    /// Returns true once the pipeline handle has been created. Pipelines built by the background
+    /// compile workers stay not ready until their worker finishes.
+    bool IsReady() const noexcept {
+        return is_ready.load(std::memory_order_acquire);
+    }
+
+    /// Blocks the calling thread until the pipeline handle has been created.
+    void WaitReady() const noexcept {
+        is_ready.wait(false, std::memory_order_acquire);
+    }
+
     using DescriptorWrites = boost::container::small_vector<vk::WriteDescriptorSet, 16>;
     using BufferBarriers = boost::container::small_vector<vk::BufferMemoryBarrier2, 16>;
 
     void BindResources(DescriptorWrites& set_writes, const BufferBarriers& buffer_barriers,
-                       const Shader::PushData& push_data) const;
+                       const Shader::PushData& push_data,
+                       const Shader::BindlessPushData& bindless_data) const;
+
+    /// Returns true when the sampler with the given index among the samplers of all stages is
+    /// read from the sampler heap instead of having a binding.
+    [[nodiscard]] bool IsBindlessSampler(u32 index) const;
 
 protected:
     [[nodiscard]] std::string GetDebugString() const;
 
+    /// Returns the flags of the descriptor set layout of a pipeline with the given number of
+    /// bindings, picking descriptor buffers, then push descriptors, then the descriptor heap.
+    [[nodiscard]] vk::DescriptorSetLayoutCreateFlags GetSetLayoutFlags(u32 num_bindings);
+
+    /// Returns the flags to create the pipeline or its libraries with.
+    [[nodiscard]] vk::PipelineCreateFlags GetPipelineFlags() const;
+
+    /// Queries where the bindings of the created layout live in a descriptor buffer set.
+    void InitDescriptorBufferLayout(u32 num_bindings);
+
+    /// Returns the set layouts of the pipeline layout, the sampler heap follows the bindings.
+    [[nodiscard]] boost::container::static_vector<vk::DescriptorSetLayout, 2> GetSetLayouts() const;
+
+    /// Returns the size of the push constants of the pipeline layout.
+    [[nodiscard]] u32 GetPushConstantsSize() const;
+
     const Instance& instance;
     Scheduler& scheduler;
     DescriptorHeap& desc_heap;
+    DescriptorBuffer* desc_buffer;
+    const SamplerHeap* sampler_heap; ///< Null unless samplers are bindless
     const Shader::Profile& profile;
     vk::UniquePipeline pipeline;
     vk::UniquePipelineLayout pipeline_layout;
     vk::UniqueDescriptorSetLayout desc_layout;
     std::array<const Shader::Info*, Shader::MaxStageTypes> stages{};
+    DescriptorBufferLayout desc_buffer_layout;
     bool uses_push_descriptors{};
     bool is_compute;
+    std::atomic<bool> is_ready{true};
 };
 
 } // namespace Vulkan
@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "common/assert.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/renderer_vulkan/vk_pipeline_library.h"
+#include "video_core/renderer_vulkan/vk_platform.h"
+
+namespace Vulkan {
+
+static constexpr std::array LibraryTypeToFlags = {
+    vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface,
+    vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders,
+    vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader,
+    vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentOutputInterface,
+};
+
+static constexpr std::array LibraryTypeToName = {
+    "VertexInput",
+    "PreRasterization",
+    "FragmentShader",
+    "FragmentOutput",
+};
+
+PipelineLibraryCache::PipelineLibraryCache(const Instance& instance_) : instance{instance_} {}
+
+PipelineLibraryCache::~PipelineLibraryCache() = default;
+
+vk::Pipeline PipelineLibraryCache::Get(PipelineLibraryType type, u64 hash,
+                                       vk::PipelineCache pipeline_cache,
+                                       vk::GraphicsPipelineCreateInfo info) {
+    auto& map = libraries[u32(type)];
+    {
+        std::scoped_lock lk{mutex};
+        if (const auto it = map.find(hash); it != map.end()) {
+            return *it->second;
+        }
+    }
+
+    // Build outside of the lock, so that workers creating different libraries don't serialize.
+    // If another worker raced us to the same library, ours is simply dropped.
+    const vk::GraphicsPipelineLibraryCreateInfoEXT library_info = {
+        .pNext = info.pNext,
+        .flags = LibraryTypeToFlags[u32(type)],
+    };
+    info.pNext = &library_info;
+    info.flags |= vk::PipelineCreateFlagBits::eLibraryKHR;
+    // All libraries and the linked pipeline have to agree on how descriptors are bound.
+    if (instance.IsDescriptorBufferSupported()) {
+        info.flags |= vk::PipelineCreateFlagBits::eDescriptorBufferEXT;
+    }
+
+    const vk::Device device = instance.GetDevice();
+    auto [result, library] = device.createGraphicsPipelineUnique(pipeline_cache, info);
+    ASSERT_MSG(result == vk::Result::eSuccess, "Failed to create {} pipeline library: {}",
+               LibraryTypeToName[u32(type)], vk::to_string(result));
+    SetObjectName(device, *library, "{} Pipeline Library {:#x}", LibraryTypeToName[u32(type)],
+                  hash);
+
+    std::scoped_lock lk{mutex};
+    const auto [it, _] = map.try_emplace(hash, std::move(library));
+    return *it->second;
+}
+
+vk::UniquePipeline PipelineLibraryCache::Link(std::span<const vk::Pipeline> parts,
+                                              vk::PipelineLayout layout,
+                                              vk::PipelineCache pipeline_cache) const {
+    const vk::PipelineLibraryCreateInfoKHR link_info = {
+        .libraryCount = static_cast<u32>(parts.size()),
+        .pLibraries = parts.data(),
+    };
+    // No link time optimization is requested, which keeps linking as cheap as the driver's
+    // fast linking path allows.
+    const vk::GraphicsPipelineCreateInfo pipeline_info = {
+        .pNext = &link_info,
+        .flags = instance.IsDescriptorBufferSupported()
+                     ? vk::PipelineCreateFlagBits::eDescriptorBufferEXT
+                     : vk::PipelineCreateFlags{},
+        .layout = layout,
+    };
+    auto [result, pipeline] =
+        instance.GetDevice().createGraphicsPipelineUnique(pipeline_cache, pipeline_info);
+    ASSERT_MSG(result == vk::Result::eSuccess, "Failed to link graphics pipeline: {}",
+               vk::to_string(result));
+    return std::move(pipeline);
+}
+
+void PipelineLibraryCache::Clear() {
+    std::scoped_lock lk{mutex};
+    for (auto& map : libraries) {
+        map.clear();
+    }
+}
+
+size_t PipelineLibraryCache::NumLibraries(PipelineLibraryType type) {
+    std::scoped_lock lk{mutex};
+    return libraries[u32(type)].size();
+}
+
+} // namespace Vulkan
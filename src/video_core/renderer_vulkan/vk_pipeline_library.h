@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <span>
+#include <tsl/robin_map.h>
+
+#include "common/types.h"
+#include "video_core/renderer_vulkan/vk_common.h"
+
+namespace Vulkan {
+
+class Instance;
+
+/// The four state subsets a graphics pipeline is split into by VK_EXT_graphics_pipeline_library.
+enum class PipelineLibraryType : u32 {
+    VertexInput,
+    PreRasterization,
+    FragmentShader,
+    FragmentOutput,
+    Count,
+};
+
+/// Stores graphics pipeline libraries by the hash of the state they were built from, so that
+/// pipelines sharing a state subset only compile it once and get linked from cached parts.
+class PipelineLibraryCache {
+public:
+    explicit PipelineLibraryCache(const Instance& instance);
+    ~PipelineLibraryCache();
+
+    /// Returns the library of the given type stored under hash, creating it from the provided
+    /// create info on a miss. Safe to call from the compile workers.
+    vk::Pipeline Get(PipelineLibraryType type, u64 hash, vk::PipelineCache pipeline_cache,
+                     vk::GraphicsPipelineCreateInfo info);
+
+    /// Links previously created libraries into a complete pipeline.
+    vk::UniquePipeline Link(std::span<const vk::Pipeline> libraries, vk::PipelineLayout layout,
+                            vk::PipelineCache pipeline_cache) const;
+
+    /// Drops all libraries. Only safe while no pipeline is being built.
+    void Clear();
+
+    size_t NumLibraries(PipelineLibraryType type);
+
+private:
+    const Instance& instance;
+    std::mutex mutex;
+    std::array<tsl::robin_map<u64, vk::UniquePipeline>, size_t(PipelineLibraryType::Count)>
+        libraries;
+};
+
+} // namespace Vulkan
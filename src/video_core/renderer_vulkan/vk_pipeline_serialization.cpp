@@ -1,7 +1,15 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <fmt/ranges.h>
+
 #include "common/config.h"
+#include "common/elf_info.h"
+#include "common/io_file.h"
+#include "common/path_util.h"
 #include "common/serdes.h"
 #include "shader_recompiler/frontend/fetch_shader.h"
 #include "shader_recompiler/info.h"
@@ -9,11 +17,12 @@
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_pipeline_cache.h"
 #include "video_core/renderer_vulkan/vk_shader_util.h"
+#include "video_core/stall_tracker.h"
 
 namespace Serialization {
 /* You should increment versions below once corresponding serialization scheme is changed. */
 static constexpr u32 ShaderBinaryVersion = 1u;
-static constexpr u32 ShaderMetaVersion = 1u;
+static constexpr u32 ShaderMetaVersion = 2u;
 static constexpr u32 PipelineKeyVersion = 1u;
 } // namespace Serialization
 
@@ -162,9 +171,14 @@ bool PipelineCache::LoadComputePipeline(Serialization::Archive& ar) {
     const auto [it, is_new] = compute_pipelines.try_emplace(compute_key);
     ASSERT(is_new);
 
-    it.value() =
-        std::make_unique<ComputePipeline>(instance, scheduler, desc_heap, profile, *pipeline_cache,
-                                          compute_key, *infos[0], modules[0], sdata, true);
+    it.value() = std::make_unique<ComputePipeline>(
+        instance, scheduler, desc_heap, desc_buffer.get(), sampler_heap, profile, *pipeline_cache,
+        compute_key, *infos[0], modules[0], sdata, true, true);
+    QueueWarmUpBuild(fmt::format("c_{:#018x}", compute_key.value),
+                     [this, pipeline = it.value().get(), module = modules[0]] {
+                         pipeline->Build(*pipeline_cache, module);
+                         ReportWarmUpProgress();
+                     });
 
     infos.fill(nullptr);
     modules.fill(nullptr);
@@ -175,13 +189,14 @@ bool PipelineCache::LoadComputePipeline(Serialization::Archive& ar) {
 void GraphicsPipelineKey::Serialize(Serialization::Archive& ar) const {
     Serialization::Writer key{ar};
 
-    key.Write(this, sizeof(*this));
+    key.Write(this, offsetof(GraphicsPipelineKey, hash));
 }
 
 bool GraphicsPipelineKey::Deserialize(Serialization::Archive& ar) {
     Serialization::Reader key{ar};
 
-    key.Read(this, sizeof(*this));
+    key.Read(this, offsetof(GraphicsPipelineKey, hash));
+    UpdateHash();
     return true;
 }
 
@@ -238,8 +253,15 @@ bool PipelineCache::LoadGraphicsPipeline(Serialization::Archive& ar) {
     ASSERT(is_new);
 
     it.value() = std::make_unique<GraphicsPipeline>(
-        instance, scheduler, desc_heap, profile, graphics_key, *pipeline_cache, infos,
-        runtime_infos, fetch_shader, modules, sdata, true);
+        instance, scheduler, desc_heap, desc_buffer.get(), sampler_heap, profile, graphics_key,
+        *pipeline_cache, library_cache.get(), infos, runtime_infos, fetch_shader, modules, sdata,
+        true, true);
+    QueueWarmUpBuild(fmt::format("g_{:#018x}", std::hash<GraphicsPipelineKey>{}(graphics_key)),
+                     [this, pipeline = it.value().get(), sdata = std::move(sdata),
+                      modules = modules] {
+                         pipeline->Build(*pipeline_cache, modules, sdata);
+                         ReportWarmUpProgress();
+                     });
 
     infos.fill(nullptr);
     modules.fill(nullptr);
@@ -257,10 +279,18 @@ bool PipelineCache::LoadPipelineStage(Serialization::Archive& ar, size_t stage)
         return false;
     }
 
-    std::vector<u32> spv{};
-    Storage::DataBase::Instance().Load(Storage::BlobType::ShaderBinary,
-                                       fmt::format("{:#018x}_{}", program->info.pgm_hash, perm_idx),
-                                       spv);
+    // The pack backend hands out binaries in place, others need a copy.
+    auto& storage = Storage::DataBase::Instance();
+    const auto binary_name = fmt::format("{:#018x}_{}", program->info.pgm_hash, perm_idx);
+    std::vector<u32> spv_data{};
+    std::span<const u32> spv{};
+    if (const auto view = storage.LoadView(Storage::BlobType::ShaderBinary, binary_name);
+        !view.empty()) {
+        spv = {reinterpret_cast<const u32*>(view.data()), view.size() / sizeof(u32)};
+    } else {
+        storage.Load(Storage::BlobType::ShaderBinary, binary_name, spv_data);
+        spv = spv_data;
+    }
     if (spv.empty()) {
         return false;
     }
@@ -271,8 +301,9 @@ bool PipelineCache::LoadPipelineStage(Serialization::Archive& ar, size_t stage)
     vk::ShaderModule module{};
 
     auto [it_pgm, new_program] = program_cache.try_emplace(program->info.pgm_hash);
+    bool is_new_module{};
     if (new_program) {
-        module = CompileSPV(spv, instance.GetDevice());
+        module = GetSharedModule(spv, is_new_module);
         it_pgm.value() = std::move(program);
     } else {
         const auto& it = std::ranges::find(it_pgm.value()->modules, spec, &Program::Module::spec);
@@ -283,7 +314,7 @@ bool PipelineCache::LoadPipelineStage(Serialization::Archive& ar, size_t stage)
                        perm_idx, idx, program->info.stage, program->info.pgm_hash);
             module = it->module;
         } else {
-            module = CompileSPV(spv, instance.GetDevice());
+            module = GetSharedModule(spv, is_new_module);
         }
     }
     it_pgm.value()->InsertPermut(module, std::move(spec), perm_idx);
@@ -319,38 +350,65 @@ void PipelineCache::WarmUp() {
         return;
     }
 
-    u32 num_pipelines{};
-    u32 num_total_pipelines{};
-
+    std::vector<std::vector<u8>> pipeline_blobs;
     Storage::DataBase::Instance().ForEachBlob(
-        Storage::BlobType::PipelineKey, [&](std::vector<u8>&& data) {
-            ++num_total_pipelines;
+        Storage::BlobType::PipelineKey,
+        [&](std::vector<u8>&& data) { pipeline_blobs.emplace_back(std::move(data)); });
+
+    // Shader modules and the program cache are filled in order on this thread, since permutation
+    // indices of the stored pipelines depend on it. Creating the pipelines themselves is what takes
+    // the most time, so that is spread over all cores and left running once the game has started.
+    // Draws that need a pipeline which wasn't built yet will wait for it.
+    const u32 num_workers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    warmup_workers = std::make_unique<Common::ThreadWorker>(num_workers, "PipelineWarmUp");
+    compile_stats.warmup_total = static_cast<u32>(pipeline_blobs.size());
+    warmup_start = std::chrono::steady_clock::now();
 
-            Serialization::Archive ar{std::move(data)};
-            Serialization::Reader pldata{ar};
+    u32 num_pipelines{};
+    const u32 num_total_pipelines = static_cast<u32>(pipeline_blobs.size());
 
-            u32 version{};
-            pldata.Read(version);
-            if (version != Serialization::PipelineKeyVersion) {
-                return;
-            }
+    // Loading has to keep the stored order, only the builds are reordered
+    for (auto& name : VideoCore::LoadHitchPipelines()) {
+        hitch_pipelines.emplace(std::move(name));
+    }
+
+    for (auto& data : pipeline_blobs) {
+        Serialization::Archive ar{std::move(data)};
+        Serialization::Reader pldata{ar};
 
+        bool result{};
+        u32 version{};
+        pldata.Read(version);
+        if (version == Serialization::PipelineKeyVersion) {
             u32 is_compute{};
             pldata.Read(is_compute);
 
-            bool result{};
             if (is_compute) {
                 result = LoadComputePipeline(ar);
             } else {
                 result = LoadGraphicsPipeline(ar);
             }
+        }
 
-            if (result) {
-                ++num_pipelines;
-            }
-        });
-
-    LOG_INFO(Render, "Preloaded {} pipelines", num_pipelines);
+        if (result) {
+            ++num_pipelines;
+        } else {
+            ReportWarmUpProgress();
+        }
+    }
+    for (auto& build : deferred_warmup_builds) {
+        QueueBuild(*warmup_workers, std::move(build));
+    }
+    deferred_warmup_builds.clear();
+    deferred_warmup_builds.shrink_to_fit();
+
+    LOG_INFO(Render, "Preloaded {} pipelines, building them on {} threads", num_pipelines,
+             num_workers);
+    if (!hitch_pipelines.empty()) {
+        LOG_INFO(Render, "Building {} of {} pipelines that caused hitches first",
+                 num_hitch_pipelines, hitch_pipelines.size());
+        hitch_pipelines.clear();
+    }
     if (num_total_pipelines > num_pipelines) {
         LOG_WARNING(Render, "{} stale pipelines were found. Consider re-generating the cache",
                     num_total_pipelines - num_pipelines);
@@ -359,7 +417,157 @@ void PipelineCache::WarmUp() {
     Storage::DataBase::Instance().FinishPreload();
 }
 
+void PipelineCache::ReportWarmUpProgress() {
+    const u32 total = compile_stats.warmup_total.load(std::memory_order_relaxed);
+    const u32 done = compile_stats.warmup_done.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (done == total) {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - warmup_start);
+        LOG_INFO(Render, "Pipeline cache warm-up finished in {} ms", elapsed.count());
+    } else if (done * 10 / total != (done - 1) * 10 / total) {
+        LOG_INFO(Render, "Pipeline cache warm-up: {}/{} pipelines", done, total);
+    }
+}
+
+void PipelineCache::QueueWarmUpBuild(const std::string& name,
+                                     Common::UniqueFunction<void> build) {
+    if (hitch_pipelines.empty()) {
+        QueueBuild(*warmup_workers, std::move(build));
+        return;
+    }
+    if (hitch_pipelines.contains(name)) {
+        ++num_hitch_pipelines;
+        QueueBuild(*warmup_workers, std::move(build));
+        return;
+    }
+    deferred_warmup_builds.emplace_back(std::move(build));
+}
+
+void PipelineCache::WaitForWarmUp() {
+    if (warmup_workers) {
+        warmup_workers->WaitForRequests();
+    }
+}
+
+// Driver caches are only usable on the device and driver build that produced them, which the
+// pipeline cache UUID identifies. Blobs are named after it, so the data of different GPUs is kept
+// side by side while a driver update replaces the data of the previous driver.
+static std::string GetDriverCachePrefix(const Instance& instance) {
+    const auto& game_info = Common::ElfInfo::Instance();
+    return fmt::format("{}_{:04x}_{:04x}_", game_info.GameSerial(), instance.GetVendorID(),
+                       instance.GetDeviceID());
+}
+
+static std::filesystem::path GetDriverCachePath(const Instance& instance) {
+    const auto& uuid = instance.GetPipelineCacheUUID();
+    return Common::FS::GetUserPath(Common::FS::PathType::CacheDir) /
+           fmt::format("{}{:02x}.vkcache", GetDriverCachePrefix(instance), fmt::join(uuid, ""));
+}
+
+static bool IsDriverCacheCompatible(const Instance& instance, std::span<const u8> data) {
+    VkPipelineCacheHeaderVersionOne header{};
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    const auto& uuid = instance.GetPipelineCacheUUID();
+    return header.headerSize >= sizeof(header) &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == instance.GetVendorID() &&
+           header.deviceID == instance.GetDeviceID() &&
+           std::memcmp(header.pipelineCacheUUID, uuid.data(), VK_UUID_SIZE) == 0;
+}
+
+std::vector<u8> PipelineCache::LoadDriverCache() const {
+    if (!Config::isPipelineCacheEnabled()) {
+        return {};
+    }
+    const auto path = GetDriverCachePath(instance);
+
+    // Data of an older driver for the same device will never be valid again.
+    std::error_code ec;
+    const auto prefix = GetDriverCachePrefix(instance);
+    for (const auto& entry : std::filesystem::directory_iterator{path.parent_path(), ec}) {
+        const auto name = entry.path().filename().string();
+        if (entry.path() != path && entry.path().extension() == ".vkcache" &&
+            name.starts_with(prefix)) {
+            LOG_INFO(Render_Vulkan, "Removing stale driver pipeline cache {}", name);
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
+
+    if (!std::filesystem::exists(path, ec)) {
+        return {};
+    }
+    auto file = Common::FS::IOFile{path, Common::FS::FileAccessMode::Read};
+    std::vector<u8> data(file.GetSize());
+    if (file.Read(data) != data.size() || !IsDriverCacheCompatible(instance, data)) {
+        LOG_WARNING(Render_Vulkan, "Driver pipeline cache {} is invalid, dropping it",
+                    path.string());
+        file.Close();
+        std::filesystem::remove(path, ec);
+        return {};
+    }
+    LOG_INFO(Render_Vulkan, "Loaded {} KB of driver pipeline cache data", data.size() / 1024);
+    return data;
+}
+
+void PipelineCache::SaveDriverCache() const {
+    if (!Config::isPipelineCacheEnabled()) {
+        return;
+    }
+    const auto [result, data] = instance.GetDevice().getPipelineCacheData(*pipeline_cache);
+    if (result != vk::Result::eSuccess || data.empty()) {
+        LOG_WARNING(Render_Vulkan, "Failed to get driver pipeline cache data: {}",
+                    vk::to_string(result));
+        return;
+    }
+    // Written aside and renamed, so an interrupted save never leaves a truncated cache behind.
+    const auto path = GetDriverCachePath(instance);
+    auto temp_path = path;
+    temp_path.replace_extension(".vkcache.tmp");
+    {
+        const auto file = Common::FS::IOFile{temp_path, Common::FS::FileAccessMode::Create};
+        if (file.Write(data) != data.size()) {
+            LOG_WARNING(Render_Vulkan, "Failed to write driver pipeline cache {}",
+                        temp_path.string());
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        LOG_WARNING(Render_Vulkan, "Failed to replace driver pipeline cache {}: {}",
+                    path.string(), ec.message());
+        return;
+    }
+    LOG_INFO(Render_Vulkan, "Saved {} KB of driver pipeline cache data", data.size() / 1024);
+}
+
+void PipelineCache::MergeDriverCache() {
+    std::unique_lock lock{driver_cache_mutex, std::try_to_lock};
+    if (!lock.owns_lock() || !driver_cache_dirty) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_driver_cache_save < DriverCacheSaveInterval) {
+        return;
+    }
+    last_driver_cache_save = now;
+    driver_cache_dirty = false;
+    SaveDriverCache();
+}
+
 void PipelineCache::Sync() {
+    WaitForWarmUp();
+    if (compile_workers) {
+        compile_workers->WaitForRequests();
+    }
+    {
+        std::scoped_lock lock{driver_cache_mutex};
+        driver_cache_dirty = false;
+        SaveDriverCache();
+    }
     Storage::DataBase::Instance().Close();
 }
 
@@ -1,19 +1,27 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
+#include <cstdlib>
+
 #include "common/config.h"
 #include "common/debug.h"
 #include "common/elf_info.h"
+#include "common/perf_counters.h"
 #include "common/singleton.h"
+#include "core/benchmark.h"
 #include "core/debug_state.h"
 #include "core/devtools/layer.h"
 #include "core/libraries/system/systemservice.h"
+#include "core/metrics_sink.h"
 #include "imgui/renderer/imgui_core.h"
 #include "imgui/renderer/imgui_impl_vulkan.h"
 #include "sdl_window.h"
+#include "video_core/renderdoc.h"
 #include "video_core/renderer_vulkan/vk_platform.h"
 #include "video_core/renderer_vulkan/vk_presenter.h"
 #include "video_core/renderer_vulkan/vk_rasterizer.h"
+#include "video_core/stall_tracker.h"
 #include "video_core/texture_cache/image.h"
 
 #include <imgui.h>
@@ -21,6 +29,9 @@
 
 namespace Vulkan {
 
+// Bounds the present wait when the window is hidden and the compositor stops displaying frames.
+constexpr u64 PresentWaitTimeout = 100'000'000;
+
 bool CanBlitToSwapchain(const vk::PhysicalDevice physical_device, vk::Format format) {
     const vk::FormatProperties props{physical_device.getFormatProperties(format)};
     return static_cast<bool>(props.optimalTilingFeatures & vk::FormatFeatureFlagBits::eBlitDst);
@@ -144,12 +155,16 @@ Presenter::Presenter(Frontend::WindowSDL& window_, AmdGpu::Liverpool* liverpool_
 Presenter::~Presenter() {
     ImGui::Layer::RemoveLayer(Common::Singleton<Core::Devtools::Layer>::Instance());
     draw_scheduler.Finish();
+    Scheduler::WaitForSubmits();
     const vk::Device device = instance.GetDevice();
     for (auto& frame : present_frames) {
         vmaDestroyImage(instance.GetAllocator(), frame.image, frame.allocation);
         device.destroyImageView(frame.image_view);
         device.destroyFence(frame.present_done);
     }
+    for (const auto& image : spare_images) {
+        DestroyFrameImage(image);
+    }
     ImGui::Core::Shutdown(device);
 }
 
@@ -157,19 +172,58 @@ bool Presenter::IsVideoOutSurface(const AmdGpu::ColorBuffer& color_buffer) const
     return std::ranges::find(vo_buffers_addr, color_buffer.Address()) != vo_buffers_addr.cend();
 }
 
+void Presenter::DestroyFrameImage(const Frame& image) {
+    if (image.imgui_texture) {
+        ImGui::Vulkan::RemoveTexture(image.imgui_texture);
+    }
+    if (image.image_view) {
+        instance.GetDevice().destroyImageView(image.image_view);
+    }
+    if (image.image) {
+        vmaDestroyImage(instance.GetAllocator(), image.image, image.allocation);
+    }
+}
+
 void Presenter::RecreateFrame(Frame* frame, u32 width, u32 height) {
     const vk::Device device = instance.GetDevice();
-    if (frame->imgui_texture) {
-        ImGui::Vulkan::RemoveTexture(frame->imgui_texture);
+    const vk::Format format = swapchain.GetSurfaceFormat().format;
+
+    // The GPU is done with the frame, its image is kept for when the game size changes back, as
+    // dynamic resolution and window resizes switch between a few sizes
+    if (frame->image) {
+        spare_images.push_back(*frame);
     }
-    if (frame->image_view) {
-        device.destroyImageView(frame->image_view);
+    const auto it = std::ranges::find_if(spare_images, [&](const Frame& image) {
+        return image.width == width && image.height == height && image.format == format;
+    });
+    if (it != spare_images.end()) {
+        frame->width = width;
+        frame->height = height;
+        frame->allocation = it->allocation;
+        frame->image = it->image;
+        frame->image_view = it->image_view;
+        frame->format = format;
+        frame->supports_storage = it->supports_storage;
+        frame->imgui_texture = it->imgui_texture;
+        frame->is_hdr = swapchain.GetHDR();
+        spare_images.erase(it);
+        return;
     }
-    if (frame->image) {
-        vmaDestroyImage(instance.GetAllocator(), frame->image, frame->allocation);
+    while (spare_images.size() > present_frames.size()) {
+        DestroyFrameImage(spare_images.front());
+        spare_images.erase(spare_images.begin());
     }
 
-    const vk::Format format = swapchain.GetSurfaceFormat().format;
+    // Lets FSR write the post processed frame from its last dispatch
+    const bool supports_storage = instance.IsFormatSupported(
+        format, vk::FormatFeatureFlagBits2::eStorageImage |
+                    vk::FormatFeatureFlagBits2::eStorageWriteWithoutFormat);
+    vk::ImageUsageFlags usage =
+        vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferDst |
+        vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eSampled;
+    if (supports_storage) {
+        usage |= vk::ImageUsageFlagBits::eStorage;
+    }
     const vk::ImageCreateInfo image_info = {
         .flags = vk::ImageCreateFlagBits::eMutableFormat,
         .imageType = vk::ImageType::e2D,
@@ -178,8 +232,7 @@ void Presenter::RecreateFrame(Frame* frame, u32 width, u32 height) {
         .mipLevels = 1,
         .arrayLayers = 1,
         .samples = vk::SampleCountFlagBits::e1,
-        .usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferDst |
-                 vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eSampled,
+        .usage = usage,
     };
 
     const VmaAllocationCreateInfo alloc_info = {
@@ -220,9 +273,11 @@ void Presenter::RecreateFrame(Frame* frame, u32 width, u32 height) {
     frame->image_view = view;
     frame->width = width;
     frame->height = height;
+    frame->format = format;
 
     frame->imgui_texture = ImGui::Vulkan::AddTexture(view, vk::ImageLayout::eShaderReadOnlyOptimal);
     frame->is_hdr = swapchain.GetHDR();
+    frame->supports_storage = supports_storage;
 }
 
 Frame* Presenter::PrepareLastFrame() {
@@ -342,9 +397,11 @@ Frame* Presenter::PrepareFrame(const Libraries::VideoOut::BufferAttributeGroup&
     image.Transit(vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits2::eShaderRead, {});
 
     const vk::Extent2D image_size = {image.info.size.width, image.info.size.height};
+    dynamic_resolution.Update();
     expected_ratio = static_cast<float>(image_size.width) / static_cast<float>(image_size.height);
 
     // Try DLSS first if enabled and available, otherwise use FSR
+    bool needs_post_process = true;
     if (dlss_settings.enable && dlss_pass.IsAvailable()) {
         // Motion vectors and depth buffer are optional for DLSS.
         // Streamline SDK can use internal motion estimation when these are not provided.
@@ -364,12 +421,27 @@ Frame* Presenter::PrepareFrame(const Libraries::VideoOut::BufferAttributeGroup&
         dlss_inputs.sharpness = 0.5f;          // Default sharpness
         dlss_inputs.reset = false;
         
+        const u64 scope = draw_scheduler.BeginProfilerScope("DlssPass");
         image_view = dlss_pass.Render(cmdbuf, dlss_inputs, dlss_settings);
+        draw_scheduler.EndProfilerScope(scope);
     } else {
-        image_view = fsr_pass.Render(cmdbuf, image_view, image_size, {frame->width, frame->height},
-                                     fsr_settings, frame->is_hdr);
+        const u64 scope = draw_scheduler.BeginProfilerScope("FsrPass");
+        // Upscaling to the frame also does the post processing, in the same dispatch
+        needs_post_process =
+            !fsr_pass.RenderToFrame(cmdbuf, image_view, image_size, *frame, fsr_settings,
+                                    pp_settings);
+        if (needs_post_process) {
+            image_view = fsr_pass.Render(cmdbuf, image_view, image_size,
+                                         {frame->width, frame->height}, fsr_settings,
+                                         frame->is_hdr);
+        }
+        draw_scheduler.EndProfilerScope(scope);
+    }
+    if (needs_post_process) {
+        const u64 pp_scope = draw_scheduler.BeginProfilerScope("PostProcessingPass");
+        pp_pass.Render(cmdbuf, image_view, image_size, *frame, pp_settings);
+        draw_scheduler.EndProfilerScope(pp_scope);
     }
-    pp_pass.Render(cmdbuf, image_view, image_size, *frame, pp_settings);
 
     DebugState.game_resolution = {image_size.width, image_size.height};
     DebugState.output_resolution = {frame->width, frame->height};
@@ -466,8 +538,24 @@ void Presenter::Present(Frame* frame, bool is_reusing_frame) {
         }
     };
 
-    // Recreate the swapchain if the window was resized.
-    if (window.GetWidth() != swapchain.GetWidth() || window.GetHeight() != swapchain.GetHeight()) {
+    // The previous present runs on the submit thread and has to be done with the swapchain.
+    Scheduler::WaitForSubmits();
+
+    // With present wait at most one present is queued for display, so the frame is not
+    // rendered ahead of the display and shows up with the least latency.
+    if (instance.IsPresentWaitSupported()) {
+        const auto wait_begin = std::chrono::steady_clock::now();
+        if (!swapchain.WaitForPresent(PresentWaitTimeout)) {
+            LOG_DEBUG(Render_Vulkan, "Timed out waiting for the last present");
+        }
+        const auto wait_time = std::chrono::steady_clock::now() - wait_begin;
+        DebugState.present_wait_us =
+            std::chrono::duration_cast<std::chrono::microseconds>(wait_time).count();
+    }
+
+    // Recreate the swapchain if the window was resized or the last present found it out of date.
+    if (window.GetWidth() != swapchain.GetWidth() || window.GetHeight() != swapchain.GetHeight() ||
+        swapchain.NeedsRecreation()) {
         swapchain.Recreate(window.GetWidth(), window.GetHeight());
     }
 
@@ -634,20 +722,25 @@ void Presenter::Present(Frame* frame, bool is_reusing_frame) {
     // Flush vulkan commands.
     SubmitInfo info{};
     info.AddWait(swapchain.GetImageAcquiredSemaphore());
-    info.AddWait(frame->ready_semaphore, frame->ready_tick);
+    info.AddWait(frame->ready_semaphore, frame->ready_tick,
+                 vk::PipelineStageFlagBits::eColorAttachmentOutput);
     info.AddSignal(swapchain.GetPresentReadySemaphore());
     info.AddSignal(frame->present_done);
     scheduler.Flush(info);
 
-    // Present to swapchain.
-    std::scoped_lock submit_lock{Scheduler::submit_mutex};
-    if (!swapchain.Present()) {
-        swapchain.Recreate(window.GetWidth(), window.GetHeight());
-    }
+    // Present to swapchain after the submission signalling it, recreation waits for the next frame.
+    Scheduler::QueueSubmitOperation([this] { swapchain.Present(); });
 
     free_frame();
     if (!is_reusing_frame) {
         DebugState.IncFlipFrameNum();
+        Common::EndPerfFrame();
+        VideoCore::EndStallFrame();
+        Core::MetricsSink::OnFrame();
+        VideoCore::CheckAutoCapture();
+        if (Core::Benchmark::OnFrame(rasterizer->GetPipelineCache().GetCompileStats())) {
+            std::quick_exit(Core::Benchmark::Finish() ? 0 : 1);
+        }
     }
 }
 
@@ -700,6 +793,11 @@ void Presenter::SetExpectedGameSize(s32 width, s32 height) {
     } else {
         expected_frame_height = static_cast<s32>(width / expected_ratio);
     }
+
+    // The frame is stretched to the window when it is drawn
+    const float scale = dynamic_resolution.Scale();
+    expected_frame_width = std::max(static_cast<u32>(expected_frame_width * scale), 1U);
+    expected_frame_height = std::max(static_cast<u32>(expected_frame_height * scale), 1U);
 }
 
 } // namespace Vulkan
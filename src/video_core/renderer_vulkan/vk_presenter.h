@@ -10,6 +10,7 @@
 #include "video_core/renderer_vulkan/host_passes/dlss_pass.h"
 #include "video_core/renderer_vulkan/host_passes/fsr_pass.h"
 #include "video_core/renderer_vulkan/host_passes/pp_pass.h"
+#include "video_core/renderer_vulkan/vk_dynamic_resolution.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 #include "video_core/renderer_vulkan/vk_swapchain.h"
@@ -31,10 +32,12 @@ struct Frame {
     VmaAllocation allocation;
     vk::Image image;
     vk::ImageView image_view;
+    vk::Format format{};
     vk::Fence present_done;
     vk::Semaphore ready_semaphore;
     u64 ready_tick;
     bool is_hdr{false};
+    bool supports_storage{false}; ///< The image can be written by compute shaders
     u8 id{};
 
     ImTextureID imgui_texture;
@@ -81,6 +84,7 @@ public:
         if (!IsHDRSupported()) {
             return;
         }
+        Scheduler::WaitForSubmits();
         swapchain.SetHDR(enable);
         pp_settings.hdr = enable ? 1 : 0;
     }
@@ -110,9 +114,12 @@ private:
 
     void RecreateFrame(Frame* frame, u32 width, u32 height);
 
+    void DestroyFrameImage(const Frame& image);
+
     void SetExpectedGameSize(s32 width, s32 height);
 
 private:
+    DynamicResolution dynamic_resolution;
     float expected_ratio{1920.0 / 1080.0f};
     u32 expected_frame_width{1920};
     u32 expected_frame_height{1080};
@@ -134,6 +141,7 @@ private:
     VideoCore::TextureCache& texture_cache;
     vk::UniqueCommandPool command_pool;
     std::vector<Frame> present_frames;
+    std::vector<Frame> spare_images; ///< Frame images of earlier sizes, to be taken again
     std::queue<Frame*> free_queue;
     Frame* last_submit_frame;
     std::mutex free_mutex;
@@ -3,6 +3,8 @@
 
 #include "common/config.h"
 #include "common/debug.h"
+#include "common/perf_counters.h"
+#include "core/debug_state.h"
 #include "core/memory.h"
 #include "shader_recompiler/runtime_info.h"
 #include "video_core/amdgpu/liverpool.h"
@@ -28,6 +30,8 @@ static Shader::PushData MakeUserData(const AmdGpu::Regs& regs) {
     push_data.xscale = regs.viewport_control.xscale_enable ? regs.viewports[0].xscale : 1.f;
     push_data.yoffset = regs.viewport_control.yoffset_enable ? regs.viewports[0].yoffset : 0.f;
     push_data.yscale = regs.viewport_control.yscale_enable ? regs.viewports[0].yscale : 1.f;
+    push_data.step_rate_0 = regs.vgt_instance_step_rate_0;
+    push_data.step_rate_1 = regs.vgt_instance_step_rate_1;
     return push_data;
 }
 
@@ -37,11 +41,19 @@ Rasterizer::Rasterizer(const Instance& instance_, Scheduler& scheduler_,
       buffer_cache{instance, scheduler, liverpool_, texture_cache, page_manager},
       texture_cache{instance, scheduler, liverpool_, buffer_cache, page_manager},
       liverpool{liverpool_}, memory{Core::Memory::Instance()},
-      pipeline_cache{instance, scheduler, liverpool} {
+      pipeline_cache{instance, scheduler, liverpool, texture_cache.GetSamplerHeap()},
+      occlusion_queries{instance, scheduler},
+      indirect_args{instance, scheduler},
+      draw_coalescing{Config::isDrawCoalescingEnabled()} {
     if (!Config::nullGpu()) {
         liverpool->BindRasterizer(this);
     }
     memory->SetRasterizer(this);
+    scheduler.SetEndRenderingCallback([this] {
+        FlushDrawBatch();
+        occlusion_queries.EndConditionalRendering();
+    });
+    scheduler.SetSubmitCallback([this] { occlusion_queries.EndSegment(); });
 }
 
 Rasterizer::~Rasterizer() = default;
@@ -179,14 +191,31 @@ void Rasterizer::EliminateFastClear() {
     auto& image = texture_cache.GetImage(image_id);
     const auto clear_value = LiverpoolToVK::ColorBufferClearValue(col_buf);
 
-    ScopeMarkerBegin(fmt::format("EliminateFastClear:MRT={:#x}:M={:#x}", col_buf.Address(),
-                                 col_buf.CmaskAddress()));
-    image.Clear(clear_value, desc.view_info.range);
-    ScopeMarkerEnd();
+    ScopedMarkerInsert(fmt::format("EliminateFastClear:MRT={:#x}:M={:#x}", col_buf.Address(),
+                                   col_buf.CmaskAddress()));
+    DebugState.fast_clear_eliminations.fetch_add(1, std::memory_order_relaxed);
+    // Defer the clear, the next pass on the image can usually do it with its load op
+    if (image.pending_clear && image.pending_clear->range != desc.view_info.range) {
+        image.ResolvePendingClear();
+    }
+    image.pending_clear = {clear_value, desc.view_info.range};
 }
 
 void Rasterizer::Draw(bool is_indexed, u32 index_offset) {
     RENDERER_TRACE;
+    Common::CountPerf(Common::PerfCounter::Draws);
+    if (draw_predicated) {
+        occlusion_queries.CountPredicated();
+    }
+
+    if (draw_batch.pipeline) {
+        if (BatchDraw(is_indexed, index_offset)) {
+            return;
+        }
+        FlushDrawBatch();
+    }
+    // Written before binding, so writes racing with it keep the next draw out of the batch
+    batch_memory_invalidated.store(false, std::memory_order_relaxed);
 
     scheduler.PopPendingOperations();
 
@@ -196,7 +225,7 @@ void Rasterizer::Draw(bool is_indexed, u32 index_offset) {
 
     const auto& regs = liverpool->regs;
     const GraphicsPipeline* pipeline = pipeline_cache.GetGraphicsPipeline();
-    if (!pipeline) {
+    if (!pipeline || !pipeline_cache.EnsureReady(*pipeline)) {
         return;
     }
 
@@ -207,35 +236,178 @@ void Rasterizer::Draw(bool is_indexed, u32 index_offset) {
     const auto state = BeginRendering(pipeline);
 
     buffer_cache.BindVertexBuffers(*pipeline);
+    const VideoCore::Buffer* index_buffer{};
     if (is_indexed) {
-        buffer_cache.BindIndexBuffer(index_offset);
+        index_buffer = buffer_cache.BindIndexBuffer(index_offset);
     }
 
-    pipeline->BindResources(set_writes, buffer_barriers, push_data);
+    pipeline->BindResources(set_writes, buffer_barriers, push_data, bindless_data);
     UpdateDynamicState(pipeline, is_indexed);
+    occlusion_queries.PrepareDraw();
     scheduler.BeginRendering(state);
+    occlusion_queries.ApplyPredication(draw_predicated);
 
     const auto& vs_info = pipeline->GetStage(Shader::LogicalStage::Vertex);
     const auto& fetch_shader = pipeline->GetFetchShader();
     const auto [vertex_offset, instance_offset] = GetDrawOffsets(regs, vs_info, fetch_shader);
 
     const auto cmdbuf = scheduler.CommandBuffer();
+    Common::CountPerf(Common::PerfCounter::PipelineBinds);
     cmdbuf.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->Handle());
 
-    if (is_indexed) {
+    const u64 gs_scope = BeginGeometryStageScope(*pipeline);
+    if (draw_coalescing && CanBatchDraws(*pipeline)) {
+        // Keep the draw around, following ones with the same state can be recorded with it
+        draw_batch.pipeline = pipeline;
+        draw_batch.is_indexed = is_indexed;
+        draw_batch.index_buffer = index_buffer;
+        draw_batch.index_address = regs.index_base_address.Address<VAddr>();
+        draw_batch.index_size =
+            regs.index_buffer_type.index_type == AmdGpu::IndexType::Index16 ? 2 : 4;
+        draw_batch.first_index = index_offset;
+        draw_batch.num_instances = regs.num_instances.NumInstances();
+        draw_batch.vertex_offset = vertex_offset;
+        draw_batch.instance_offset = instance_offset;
+        if (is_indexed) {
+            draw_batch.indexed_draws.push_back({0, regs.num_indices, s32(vertex_offset)});
+        } else {
+            draw_batch.draws.push_back({vertex_offset, regs.num_indices});
+        }
+    } else if (is_indexed) {
         cmdbuf.drawIndexed(regs.num_indices, regs.num_instances.NumInstances(), 0,
                            s32(vertex_offset), instance_offset);
     } else {
         cmdbuf.draw(regs.num_indices, regs.num_instances.NumInstances(), vertex_offset,
                     instance_offset);
     }
+    scheduler.EndProfilerScope(gs_scope);
 
     ResetBindings();
 }
 
+u64 Rasterizer::BeginGeometryStageScope(const GraphicsPipeline& pipeline) {
+    if (!scheduler.IsGpuProfiling() || !pipeline.HasGeometryStage()) {
+        return GpuProfiler::InvalidScope;
+    }
+    return scheduler.BeginProfilerScope(
+        "GeometryDraw:{:#x}", pipeline.GetStage(Shader::LogicalStage::Geometry).pgm_hash);
+}
+
+bool Rasterizer::CanBatchDraws(const GraphicsPipeline& pipeline) const {
+    // Draws are recorded without binding resources again, which is only valid if they can't
+    // observe each other through memory.
+    if (scheduler.IsGpuProfiling() && pipeline.HasGeometryStage()) {
+        // Draws through the geometry stage are timed one by one
+        return false;
+    }
+    for (const auto* stage : pipeline.GetStages()) {
+        if (!stage) {
+            continue;
+        }
+        if (stage->uses_dma || stage->l_stage == Shader::LogicalStage::TessellationControl) {
+            return false;
+        }
+        const auto is_written = [](const auto& desc) { return desc.is_written; };
+        if (std::ranges::any_of(stage->buffers, is_written) ||
+            std::ranges::any_of(stage->images, is_written)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Rasterizer::BatchDraw(bool is_indexed, u32 index_offset) {
+    const auto& regs = liverpool->regs;
+    if (batch_memory_invalidated.load(std::memory_order_relaxed) ||
+        draw_batch.is_indexed != is_indexed ||
+        draw_batch.num_instances != regs.num_instances.NumInstances() ||
+        pipeline_cache.GetUnchangedGraphicsPipeline() != draw_batch.pipeline) {
+        return false;
+    }
+    if (!is_indexed) {
+        draw_batch.draws.push_back({
+            .firstVertex = draw_batch.vertex_offset,
+            .vertexCount = regs.num_indices,
+        });
+        return true;
+    }
+
+    // Indices must be within the buffer bound for the first draw and already uploaded
+    const u32 index_size =
+        regs.index_buffer_type.index_type == AmdGpu::IndexType::Index16 ? 2 : 4;
+    const VAddr index_address = regs.index_base_address.Address<VAddr>();
+    const VAddr first_address = index_address + index_offset * index_size;
+    const u32 size = regs.num_indices * index_size;
+    if (index_address != draw_batch.index_address || index_size != draw_batch.index_size ||
+        index_offset < draw_batch.first_index ||
+        !draw_batch.index_buffer->IsInBounds(first_address, size) ||
+        buffer_cache.IsRegionCpuModified(first_address, size)) {
+        return false;
+    }
+    draw_batch.indexed_draws.push_back({
+        .firstIndex = index_offset - draw_batch.first_index,
+        .indexCount = regs.num_indices,
+        .vertexOffset = s32(draw_batch.vertex_offset),
+    });
+    return true;
+}
+
+void Rasterizer::FlushDrawBatch() {
+    if (!draw_batch.pipeline) {
+        return;
+    }
+    draw_batch.pipeline = nullptr;
+
+    const auto cmdbuf = scheduler.CommandBuffer();
+    const u32 num_instances = draw_batch.num_instances;
+    const u32 first_instance = draw_batch.instance_offset;
+    if (draw_batch.is_indexed) {
+        const auto& draws = draw_batch.indexed_draws;
+        if (instance.IsMultiDrawSupported() && draws.size() > 1) {
+            const s32 vertex_offset = s32(draw_batch.vertex_offset);
+            const u32 max_count = instance.GetMaxMultiDrawCount();
+            for (size_t i = 0; i < draws.size(); i += max_count) {
+                const u32 count = static_cast<u32>(std::min<size_t>(max_count, draws.size() - i));
+                cmdbuf.drawMultiIndexedEXT(count, &draws[i], num_instances, first_instance,
+                                           sizeof(vk::MultiDrawIndexedInfoEXT), &vertex_offset);
+            }
+        } else {
+            for (const auto& draw : draws) {
+                cmdbuf.drawIndexed(draw.indexCount, num_instances, draw.firstIndex,
+                                   draw.vertexOffset, first_instance);
+            }
+        }
+    } else {
+        const auto& draws = draw_batch.draws;
+        if (instance.IsMultiDrawSupported() && draws.size() > 1) {
+            const u32 max_count = instance.GetMaxMultiDrawCount();
+            for (size_t i = 0; i < draws.size(); i += max_count) {
+                const u32 count = static_cast<u32>(std::min<size_t>(max_count, draws.size() - i));
+                cmdbuf.drawMultiEXT(count, &draws[i], num_instances, first_instance,
+                                    sizeof(vk::MultiDrawInfoEXT));
+            }
+        } else {
+            for (const auto& draw : draws) {
+                cmdbuf.draw(draw.vertexCount, num_instances, draw.firstVertex, first_instance);
+            }
+        }
+    }
+    draw_batch.draws.clear();
+    draw_batch.indexed_draws.clear();
+}
+
 void Rasterizer::DrawIndirect(bool is_indexed, VAddr arg_address, u32 offset, u32 stride,
                               u32 max_count, VAddr count_address) {
     RENDERER_TRACE;
+    Common::CountPerf(Common::PerfCounter::Draws);
+    if (draw_predicated) {
+        occlusion_queries.CountPredicated();
+    }
+
+    FlushDrawBatch();
+    if (max_count == 0) {
+        return;
+    }
 
     scheduler.PopPendingOperations();
 
@@ -244,7 +416,7 @@ void Rasterizer::DrawIndirect(bool is_indexed, VAddr arg_address, u32 offset, u3
     }
 
     const GraphicsPipeline* pipeline = pipeline_cache.GetGraphicsPipeline();
-    if (!pipeline) {
+    if (!pipeline || !pipeline_cache.EnsureReady(*pipeline)) {
         return;
     }
 
@@ -259,8 +431,10 @@ void Rasterizer::DrawIndirect(bool is_indexed, VAddr arg_address, u32 offset, u3
         buffer_cache.BindIndexBuffer(0);
     }
 
-    const auto& [buffer, base] =
-        buffer_cache.ObtainBuffer(arg_address + offset, stride * max_count, false);
+    const u32 args_size =
+        is_indexed ? sizeof(VkDrawIndexedIndirectCommand) : sizeof(VkDrawIndirectCommand);
+    const auto [buffer, base] = buffer_cache.ObtainBuffer(
+        arg_address + offset, (max_count - 1) * stride + args_size, false);
 
     VideoCore::Buffer* count_buffer{};
     u32 count_base{};
@@ -268,47 +442,80 @@ void Rasterizer::DrawIndirect(bool is_indexed, VAddr arg_address, u32 offset, u3
         std::tie(count_buffer, count_base) = buffer_cache.ObtainBuffer(count_address, 4, false);
     }
 
-    pipeline->BindResources(set_writes, buffer_barriers, push_data);
+    // Guest arguments have the layout of Vulkan's. Strides Vulkan doesn't take and counts the
+    // device can't read are repacked on the GPU, so the count is never read on the CPU.
+    const u32 max_draws = instance.GetMaxDrawIndirectCount();
+    vk::Buffer args_buffer = buffer->Handle();
+    vk::DeviceSize args_offset = base;
+    u32 args_stride = max_count == 1 ? args_size : stride;
+    bool use_count = count_buffer != nullptr;
+    const bool native_stride = args_stride % 4 == 0 && args_stride >= args_size;
+    const bool native_count =
+        !use_count || (instance.IsDrawIndirectCountSupported() && max_count <= max_draws);
+    if (!native_stride || !native_count) {
+        const auto repacked = indirect_args.Repack(*buffer, base, args_stride, args_size / 4,
+                                                   max_count, count_buffer, count_base);
+        if (!repacked) {
+            LOG_WARNING(Render_Vulkan, "Skipping {} indirect draws with stride {}", max_count,
+                        stride);
+            ResetBindings();
+            return;
+        }
+        args_buffer = repacked->buffer;
+        args_offset = repacked->offset;
+        args_stride = args_size;
+        use_count = false;
+    }
+
+    pipeline->BindResources(set_writes, buffer_barriers, push_data, bindless_data);
     UpdateDynamicState(pipeline, is_indexed);
+    occlusion_queries.PrepareDraw();
     scheduler.BeginRendering(state);
+    occlusion_queries.ApplyPredication(draw_predicated);
 
     // We can safely ignore both SGPR UD indices and results of fetch shader parsing, as vertex and
     // instance offsets will be automatically applied by Vulkan from indirect args buffer.
 
     const auto cmdbuf = scheduler.CommandBuffer();
+    Common::CountPerf(Common::PerfCounter::PipelineBinds);
     cmdbuf.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->Handle());
 
-    if (is_indexed) {
-        ASSERT(sizeof(VkDrawIndexedIndirectCommand) == stride);
-
-        if (count_address != 0) {
-            cmdbuf.drawIndexedIndirectCount(buffer->Handle(), base, count_buffer->Handle(),
-                                            count_base, max_count, stride);
+    const u64 gs_scope = BeginGeometryStageScope(*pipeline);
+    if (use_count) {
+        if (is_indexed) {
+            cmdbuf.drawIndexedIndirectCount(args_buffer, args_offset, count_buffer->Handle(),
+                                            count_base, max_count, args_stride);
         } else {
-            cmdbuf.drawIndexedIndirect(buffer->Handle(), base, max_count, stride);
+            cmdbuf.drawIndirectCount(args_buffer, args_offset, count_buffer->Handle(), count_base,
+                                     max_count, args_stride);
         }
     } else {
-        ASSERT(sizeof(VkDrawIndirectCommand) == stride);
-
-        if (count_address != 0) {
-            cmdbuf.drawIndirectCount(buffer->Handle(), base, count_buffer->Handle(), count_base,
-                                     max_count, stride);
-        } else {
-            cmdbuf.drawIndirect(buffer->Handle(), base, max_count, stride);
+        // Devices without multi draw indirect take one draw at a time
+        for (u32 first = 0; first < max_count; first += max_draws) {
+            const u32 count = std::min(max_draws, max_count - first);
+            const vk::DeviceSize draw_offset = args_offset + vk::DeviceSize{first} * args_stride;
+            if (is_indexed) {
+                cmdbuf.drawIndexedIndirect(args_buffer, draw_offset, count, args_stride);
+            } else {
+                cmdbuf.drawIndirect(args_buffer, draw_offset, count, args_stride);
+            }
         }
     }
+    scheduler.EndProfilerScope(gs_scope);
 
     ResetBindings();
 }
 
-void Rasterizer::DispatchDirect() {
+void Rasterizer::DispatchDirect(bool predicated) {
     RENDERER_TRACE;
+    Common::CountPerf(Common::PerfCounter::Dispatches);
 
+    FlushDrawBatch();
     scheduler.PopPendingOperations();
 
     const auto& cs_program = liverpool->GetCsRegs();
     const ComputePipeline* pipeline = pipeline_cache.GetComputePipeline();
-    if (!pipeline) {
+    if (!pipeline || !pipeline_cache.EnsureReady(*pipeline)) {
         return;
     }
 
@@ -322,23 +529,33 @@ void Rasterizer::DispatchDirect() {
     }
 
     scheduler.EndRendering();
-    pipeline->BindResources(set_writes, buffer_barriers, push_data);
+    pipeline->BindResources(set_writes, buffer_barriers, push_data, bindless_data);
 
+    const u64 scope = scheduler.BeginProfilerScope("Dispatch:{:#x}", cs.pgm_hash);
     const auto cmdbuf = scheduler.CommandBuffer();
+    Common::CountPerf(Common::PerfCounter::PipelineBinds);
     cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline->Handle());
+    if (predicated) {
+        occlusion_queries.CountPredicated();
+    }
+    occlusion_queries.ApplyPredication(predicated);
     cmdbuf.dispatch(cs_program.dim_x, cs_program.dim_y, cs_program.dim_z);
+    occlusion_queries.EndConditionalRendering();
+    scheduler.EndProfilerScope(scope);
 
     ResetBindings();
 }
 
-void Rasterizer::DispatchIndirect(VAddr address, u32 offset, u32 size) {
+void Rasterizer::DispatchIndirect(VAddr address, u32 offset, u32 size, bool predicated) {
     RENDERER_TRACE;
+    Common::CountPerf(Common::PerfCounter::Dispatches);
 
+    FlushDrawBatch();
     scheduler.PopPendingOperations();
 
     const auto& cs_program = liverpool->GetCsRegs();
     const ComputePipeline* pipeline = pipeline_cache.GetComputePipeline();
-    if (!pipeline) {
+    if (!pipeline || !pipeline_cache.EnsureReady(*pipeline)) {
         return;
     }
 
@@ -349,11 +566,20 @@ void Rasterizer::DispatchIndirect(VAddr address, u32 offset, u32 size) {
     const auto [buffer, base] = buffer_cache.ObtainBuffer(address + offset, size, false);
 
     scheduler.EndRendering();
-    pipeline->BindResources(set_writes, buffer_barriers, push_data);
+    pipeline->BindResources(set_writes, buffer_barriers, push_data, bindless_data);
 
+    const u64 scope = scheduler.BeginProfilerScope(
+        "DispatchIndirect:{:#x}", pipeline->GetStage(Shader::LogicalStage::Compute).pgm_hash);
     const auto cmdbuf = scheduler.CommandBuffer();
+    Common::CountPerf(Common::PerfCounter::PipelineBinds);
     cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline->Handle());
+    if (predicated) {
+        occlusion_queries.CountPredicated();
+    }
+    occlusion_queries.ApplyPredication(predicated);
     cmdbuf.dispatchIndirect(buffer->Handle(), base);
+    occlusion_queries.EndConditionalRendering();
+    scheduler.EndProfilerScope(scope);
 
     ResetBindings();
 }
@@ -365,18 +591,33 @@ u64 Rasterizer::Flush() {
     return current_tick;
 }
 
+void Rasterizer::SignalOnGpuCompletion(Common::UniqueFunction<void>&& signal) {
+    scheduler.DeferPriorityOperation(std::move(signal));
+    Flush();
+}
+
 void Rasterizer::Finish() {
     scheduler.Finish();
 }
 
+void Rasterizer::RunOnGpuThread(Common::UniqueFunction<void>&& func) {
+    liverpool->SendCommand<false>(std::move(func));
+}
+
 void Rasterizer::OnSubmit() {
     if (fault_process_pending) {
         fault_process_pending = false;
         buffer_cache.ProcessFaultBuffer();
     }
+    buffer_cache.PrefetchReadbacks();
     texture_cache.ProcessDownloadImages();
+    texture_cache.ProcessReplacements();
     texture_cache.RunGarbageCollector();
     buffer_cache.RunGarbageCollector();
+    buffer_cache.ResizeStreamBuffers();
+    buffer_cache.EndFrame();
+    DebugState.page_table_resident_bytes =
+        buffer_cache.PageTableResidentBytes() + texture_cache.PageTableResidentBytes();
 }
 
 bool Rasterizer::BindResources(const Pipeline* pipeline) {
@@ -626,7 +867,7 @@ void Rasterizer::BindBuffers(const Shader::Info& stage, Shader::Backend::Binding
                 buffer_infos.emplace_back(VK_NULL_HANDLE, 0, VK_WHOLE_SIZE);
             } else {
                 auto& null_buffer = buffer_cache.GetBuffer(VideoCore::NULL_BUFFER_ID);
-                buffer_infos.emplace_back(null_buffer.Handle(), 0, VK_WHOLE_SIZE);
+                buffer_infos.emplace_back(null_buffer.Handle(), 0, null_buffer.SizeBytes());
             }
         } else {
             const auto [vk_buffer, offset] = buffer_cache.ObtainBuffer(
@@ -692,6 +933,15 @@ void Rasterizer::BindTextures(const Shader::Info& stage, Shader::Backend::Bindin
         image->binding.is_bound = 1u;
     }
 
+    // Upload the dirty images of the stage together, so they share the barriers of one batch
+    boost::container::small_vector<VideoCore::ImageId, 16> update_ids;
+    for (const auto& [image_id, desc] : image_bindings) {
+        if (image_id && !texture_cache.GetImage(image_id).binding.needs_rebind) {
+            update_ids.push_back(image_id);
+        }
+    }
+    texture_cache.UpdateImages(update_ids);
+
     // Second pass to re-bind images that were updated after binding
     for (auto& [image_id, desc] : image_bindings) {
         bool is_storage = desc.type == VideoCore::TextureCache::BindingType::Storage;
@@ -713,41 +963,48 @@ void Rasterizer::BindTextures(const Shader::Info& stage, Shader::Backend::Bindin
             bound_images.emplace_back(image_id);
 
             auto& image = texture_cache.GetImage(image_id);
-            auto& image_view = texture_cache.FindTexture(image_id, desc);
-
-            // The image is either bound as storage in a separate descriptor or bound as render
-            // target in feedback loop. Depth images are excluded because they can't be bound as
-            // storage and feedback loop doesn't make sense for them
-            if ((image.binding.force_general || image.binding.is_target) &&
-                !image.info.props.is_depth) {
-                image.Transit(instance.IsAttachmentFeedbackLoopLayoutSupported() &&
-                                      image.binding.is_target
-                                  ? vk::ImageLayout::eAttachmentFeedbackLoopOptimalEXT
-                                  : vk::ImageLayout::eGeneral,
-                              vk::AccessFlagBits2::eShaderRead |
-                                  (image.info.props.is_depth
-                                       ? vk::AccessFlagBits2::eDepthStencilAttachmentWrite
-                                       : vk::AccessFlagBits2::eColorAttachmentWrite),
-                              {});
+            // Replacement textures are read only and stay in the shader read layout
+            if (const auto* replacement = texture_cache.FindReplacementView(image_id, desc)) {
+                image.usage.texture |= 1u;
+                image_infos.emplace_back(VK_NULL_HANDLE, *replacement->image_view,
+                                         vk::ImageLayout::eShaderReadOnlyOptimal);
             } else {
-                if (is_storage) {
-                    image.Transit(vk::ImageLayout::eGeneral,
+                auto& image_view = texture_cache.FindTexture(image_id, desc);
+
+                // The image is either bound as storage in a separate descriptor or bound as render
+                // target in feedback loop. Depth images are excluded because they can't be bound as
+                // storage and feedback loop doesn't make sense for them
+                if ((image.binding.force_general || image.binding.is_target) &&
+                    !image.info.props.is_depth) {
+                    image.Transit(instance.IsAttachmentFeedbackLoopLayoutSupported() &&
+                                          image.binding.is_target
+                                      ? vk::ImageLayout::eAttachmentFeedbackLoopOptimalEXT
+                                      : vk::ImageLayout::eGeneral,
                                   vk::AccessFlagBits2::eShaderRead |
-                                      vk::AccessFlagBits2::eShaderWrite,
-                                  desc.view_info.range);
+                                      (image.info.props.is_depth
+                                           ? vk::AccessFlagBits2::eDepthStencilAttachmentWrite
+                                           : vk::AccessFlagBits2::eColorAttachmentWrite),
+                                  {});
                 } else {
-                    const auto new_layout = image.info.props.is_depth
-                                                ? vk::ImageLayout::eDepthStencilReadOnlyOptimal
-                                                : vk::ImageLayout::eShaderReadOnlyOptimal;
-                    image.Transit(new_layout, vk::AccessFlagBits2::eShaderRead,
-                                  desc.view_info.range);
+                    if (is_storage) {
+                        image.Transit(vk::ImageLayout::eGeneral,
+                                      vk::AccessFlagBits2::eShaderRead |
+                                          vk::AccessFlagBits2::eShaderWrite,
+                                      desc.view_info.range);
+                    } else {
+                        const auto new_layout = image.info.props.is_depth
+                                                    ? vk::ImageLayout::eDepthStencilReadOnlyOptimal
+                                                    : vk::ImageLayout::eShaderReadOnlyOptimal;
+                        image.Transit(new_layout, vk::AccessFlagBits2::eShaderRead,
+                                      desc.view_info.range);
+                    }
                 }
-            }
-            image.usage.storage |= is_storage;
-            image.usage.texture |= !is_storage;
+                image.usage.storage |= is_storage;
+                image.usage.texture |= !is_storage;
 
-            image_infos.emplace_back(VK_NULL_HANDLE, *image_view.image_view,
-                                     image.backing->state.layout);
+                image_infos.emplace_back(VK_NULL_HANDLE, *image_view.image_view,
+                                         image.backing->state.layout);
+            }
         }
 
         set_writes.push_back({
@@ -761,6 +1018,7 @@ void Rasterizer::BindTextures(const Shader::Info& stage, Shader::Backend::Bindin
         });
     }
 
+    const bool bindless_samplers = texture_cache.GetSamplerHeap() != nullptr;
     for (const auto& sampler : stage.samplers) {
         auto ssharp = sampler.GetSharp(stage);
         if (sampler.disable_aniso) {
@@ -769,6 +1027,14 @@ void Rasterizer::BindTextures(const Shader::Info& stage, Shader::Backend::Bindin
                 ssharp.max_aniso.Assign(AmdGpu::AnisoRatio::One);
             }
         }
+        // Bindless samplers only need their heap slot, their binding stays unused
+        const u32 sampler_index = binding.sampler++;
+        if (bindless_samplers && sampler_index < Shader::NUM_BINDLESS_SAMPLERS) {
+            bindless_data.sampler_slots[sampler_index] =
+                texture_cache.GetSamplerSlot(ssharp, liverpool->regs.ta_bc_base);
+            ++binding.unified;
+            continue;
+        }
         const auto vk_sampler = texture_cache.GetSampler(ssharp, liverpool->regs.ta_bc_base);
         image_infos.emplace_back(vk_sampler, VK_NULL_HANDLE, vk::ImageLayout::eGeneral);
         set_writes.push_back({
@@ -791,6 +1057,23 @@ RenderState Rasterizer::BeginRendering(const GraphicsPipeline* pipeline) {
     state.height = instance.GetMaxFramebufferHeight();
     state.num_layers = std::numeric_limits<u32>::max();
     state.num_color_attachments = std::bit_width(key.mrt_mask);
+    std::array<std::optional<vk::ClearValue>, AmdGpu::NUM_COLOR_BUFFERS> folded_clears{};
+    const auto transit_target = [&](VideoCore::Image& image, const auto& desc) {
+        if (image.binding.is_bound) {
+            ASSERT_MSG(!image.binding.force_general,
+                       "Having image both as storage and render target is unsupported");
+            image.Transit(instance.IsAttachmentFeedbackLoopLayoutSupported()
+                              ? vk::ImageLayout::eAttachmentFeedbackLoopOptimalEXT
+                              : vk::ImageLayout::eGeneral,
+                          vk::AccessFlagBits2::eColorAttachmentWrite, {});
+            attachment_feedback_loop = true;
+        } else {
+            image.Transit(vk::ImageLayout::eColorAttachmentOptimal,
+                          vk::AccessFlagBits2::eColorAttachmentWrite |
+                              vk::AccessFlagBits2::eColorAttachmentRead,
+                          desc.view_info.range);
+        }
+    };
     for (auto cb = 0u; cb < state.num_color_attachments; ++cb) {
         auto& [image_id, desc] = cb_descs[cb];
         if (!image_id) {
@@ -811,20 +1094,15 @@ RenderState Rasterizer::BeginRendering(const GraphicsPipeline* pipeline) {
         const bool is_clear = texture_cache.IsMetaCleared(col_buf.CmaskAddress(), slice);
         texture_cache.TouchMeta(col_buf.CmaskAddress(), slice, false);
 
-        if (image->binding.is_bound) {
-            ASSERT_MSG(!image->binding.force_general,
-                       "Having image both as storage and render target is unsupported");
-            image->Transit(instance.IsAttachmentFeedbackLoopLayoutSupported()
-                               ? vk::ImageLayout::eAttachmentFeedbackLoopOptimalEXT
-                               : vk::ImageLayout::eGeneral,
-                           vk::AccessFlagBits2::eColorAttachmentWrite, {});
-            attachment_feedback_loop = true;
-        } else {
-            image->Transit(vk::ImageLayout::eColorAttachmentOptimal,
-                           vk::AccessFlagBits2::eColorAttachmentWrite |
-                               vk::AccessFlagBits2::eColorAttachmentRead,
-                           desc.view_info.range);
+        // An eliminated fast clear of the attachment can become the load op of the pass. Take it
+        // before the transition, which would record it otherwise. A newer clear replaces it.
+        if (image->pending_clear && image->pending_clear->range == desc.view_info.range) {
+            const auto pending = std::exchange(image->pending_clear, std::nullopt);
+            if (!is_clear) {
+                folded_clears[cb] = pending->value;
+            }
         }
+        transit_target(*image, desc);
 
         state.width = std::min<u32>(state.width, std::max(image->info.size.width >> mip, 1u));
         state.height = std::min<u32>(state.height, std::max(image->info.size.height >> mip, 1u));
@@ -893,6 +1171,28 @@ RenderState Rasterizer::BeginRendering(const GraphicsPipeline* pipeline) {
         image.usage.depth_target = true;
     }
 
+    for (auto cb = 0u; cb < state.num_color_attachments; ++cb) {
+        if (!folded_clears[cb]) {
+            continue;
+        }
+        const auto& [image_id, desc] = cb_descs[cb];
+        auto& image = texture_cache.GetImage(image_id);
+        const auto& range = desc.view_info.range;
+        const u32 mip = range.base.level;
+        if (state.width == std::max(image.info.size.width >> mip, 1u) &&
+            state.height == std::max(image.info.size.height >> mip, 1u) &&
+            state.num_layers >= range.extent.layers) {
+            state.color_attachments[cb].loadOp = vk::AttachmentLoadOp::eClear;
+            state.color_attachments[cb].clearValue = *folded_clears[cb];
+            DebugState.fast_clears_folded.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        // The render area does not cover the whole attachment, clear it ahead of the pass
+        image.Clear(*folded_clears[cb], range);
+        transit_target(image, desc);
+        DebugState.fast_clears_resolved.fetch_add(1, std::memory_order_relaxed);
+    }
+
     if (state.num_layers == std::numeric_limits<u32>::max()) {
         state.num_layers = 1;
     }
@@ -905,16 +1205,78 @@ void Rasterizer::Resolve() {
     const auto& mrt1_hint = liverpool->last_cb_extent[1];
     VideoCore::TextureCache::ImageDesc mrt0_desc{liverpool->regs.color_buffers[0], mrt0_hint};
     VideoCore::TextureCache::ImageDesc mrt1_desc{liverpool->regs.color_buffers[1], mrt1_hint};
-    auto& mrt0_image = texture_cache.GetImage(texture_cache.FindImage(mrt0_desc, true));
-    auto& mrt1_image = texture_cache.GetImage(texture_cache.FindImage(mrt1_desc, true));
+    const auto mrt0_id = texture_cache.FindImage(mrt0_desc, true);
+    const auto mrt1_id = texture_cache.FindImage(mrt1_desc, true);
 
     ScopeMarkerBegin(fmt::format("Resolve:MRT0={:#x}:MRT1={:#x}",
                                  liverpool->regs.color_buffers[0].Address(),
                                  liverpool->regs.color_buffers[1].Address()));
-    mrt1_image.Resolve(mrt0_image, mrt0_desc.view_info.range, mrt1_desc.view_info.range);
+    if (ResolveInRenderPass(mrt0_id, mrt0_desc, mrt1_id, mrt1_desc)) {
+        DebugState.resolves_in_render_pass.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        auto& mrt0_image = texture_cache.GetImage(mrt0_id);
+        auto& mrt1_image = texture_cache.GetImage(mrt1_id);
+        mrt1_image.Resolve(mrt0_image, mrt0_desc.view_info.range, mrt1_desc.view_info.range);
+        DebugState.resolves_with_transfer.fetch_add(1, std::memory_order_relaxed);
+    }
     ScopeMarkerEnd();
 }
 
+bool Rasterizer::ResolveInRenderPass(VideoCore::ImageId src_id,
+                                     const VideoCore::TextureCache::ImageDesc& src_desc,
+                                     VideoCore::ImageId dst_id,
+                                     const VideoCore::TextureCache::ImageDesc& dst_desc) {
+    auto& src_image = texture_cache.GetImage(src_id);
+    auto& dst_image = texture_cache.GetImage(dst_id);
+    const auto& src_range = src_desc.view_info.range;
+    const auto& dst_range = dst_desc.view_info.range;
+    // Attachment resolves take whole attachments of the same format and size
+    if (src_image.backing->num_samples == 1 ||
+        src_desc.view_info.format != dst_desc.view_info.format ||
+        src_image.info.size.width != dst_image.info.size.width ||
+        src_image.info.size.height != dst_image.info.size.height ||
+        src_range.base.level != 0 || dst_range.base.level != 0 ||
+        src_range.extent.layers != dst_range.extent.layers ||
+        !(dst_image.usage_flags & vk::ImageUsageFlagBits::eColorAttachment)) {
+        return false;
+    }
+    dst_image.SetBackingSamples(1, false);
+    const auto& src_view = texture_cache.FindRenderTarget(src_id, src_desc);
+    const auto& dst_view = texture_cache.FindRenderTarget(dst_id, dst_desc);
+
+    // The multisampled image stays in the attachment layout of the pass that rendered it, no
+    // transfer layout that would need it decompressed.
+    constexpr auto access =
+        vk::AccessFlagBits2::eColorAttachmentRead | vk::AccessFlagBits2::eColorAttachmentWrite;
+    src_image.Transit(vk::ImageLayout::eColorAttachmentOptimal, access, src_range);
+    dst_image.Transit(vk::ImageLayout::eColorAttachmentOptimal,
+                      vk::AccessFlagBits2::eColorAttachmentWrite, dst_range);
+
+    const bool is_integer = AmdGpu::IsInteger(liverpool->regs.color_buffers[0].GetNumberFmt());
+    RenderState state{};
+    state.width = dst_image.info.size.width;
+    state.height = dst_image.info.size.height;
+    state.num_layers = dst_range.extent.layers;
+    state.num_color_attachments = 1;
+    state.color_attachments[0] = {
+        .imageView = *src_view.image_view,
+        .imageLayout = src_image.backing->state.layout,
+        .resolveMode = is_integer ? vk::ResolveModeFlagBits::eSampleZero
+                                  : vk::ResolveModeFlagBits::eAverage,
+        .resolveImageView = *dst_view.image_view,
+        .resolveImageLayout = dst_image.backing->state.layout,
+        .loadOp = vk::AttachmentLoadOp::eLoad,
+        .storeOp = vk::AttachmentStoreOp::eStore,
+    };
+    // The resolve is done when the pass ends
+    scheduler.BeginRendering(state);
+    scheduler.EndRendering();
+
+    dst_image.flags |= VideoCore::ImageFlagBits::GpuModified;
+    dst_image.flags &= ~VideoCore::ImageFlagBits::Dirty;
+    return true;
+}
+
 void Rasterizer::DepthStencilCopy(bool is_depth, bool is_stencil) {
     auto& regs = liverpool->regs;
 
@@ -937,6 +1299,9 @@ void Rasterizer::DepthStencilCopy(bool is_depth, bool is_stencil) {
         regs.depth_buffer.StencilAddress(), regs.depth_buffer.DepthWriteAddress(),
         regs.depth_buffer.StencilWriteAddress()));
 
+    // Transitions are skipped when the images are already in the transfer layouts, the copy
+    // must not land in the pass that is open either way
+    scheduler.EndRendering();
     read_image.Transit(vk::ImageLayout::eTransferSrcOptimal, vk::AccessFlagBits2::eTransferRead,
                        sub_range);
     write_image.Transit(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite,
@@ -977,10 +1342,12 @@ void Rasterizer::DepthStencilCopy(bool is_depth, bool is_stencil) {
 }
 
 void Rasterizer::FillBuffer(VAddr address, u32 num_bytes, u32 value, bool is_gds) {
+    FlushDrawBatch();
     buffer_cache.FillBuffer(address, num_bytes, value, is_gds);
 }
 
 void Rasterizer::CopyBuffer(VAddr dst, VAddr src, u32 num_bytes, bool dst_gds, bool src_gds) {
+    FlushDrawBatch();
     buffer_cache.CopyBuffer(dst, src, num_bytes, dst_gds, src_gds);
 }
 
@@ -991,11 +1358,51 @@ u32 Rasterizer::ReadDataFromGds(u32 gds_offset) {
     return value;
 }
 
+void Rasterizer::ZpassDone(VAddr address, u32 num_pairs) {
+    FlushDrawBatch();
+    occlusion_queries.ZpassDone(address, num_pairs);
+}
+
+void Rasterizer::SetPredication(VAddr address, bool draw_if_visible) {
+    FlushDrawBatch();
+    occlusion_queries.SetPredication(address, draw_if_visible);
+}
+
+void Rasterizer::SetMemoryPredication(VAddr address, bool draw_if_true) {
+    FlushDrawBatch();
+    if (address == 0) {
+        occlusion_queries.SetPredication(0, false);
+        return;
+    }
+    // Only the low 32 bits of the 64-bit predicate are tested, guests write booleans to it
+    const auto [buffer, offset] = buffer_cache.ObtainBuffer(address, sizeof(u64), false);
+    occlusion_queries.SetMemoryPredication(*buffer, offset, !draw_if_true);
+}
+
+void Rasterizer::BeginCondExec(VAddr address) {
+    FlushDrawBatch();
+    const auto [buffer, offset] = buffer_cache.ObtainBuffer(address, sizeof(u32), false);
+    occlusion_queries.BeginCondExec(*buffer, offset);
+}
+
+void Rasterizer::EndCondExec() {
+    FlushDrawBatch();
+    occlusion_queries.EndCondExec();
+}
+
+void Rasterizer::SetDrawPredicated(bool predicated) {
+    if (draw_predicated != predicated) {
+        FlushDrawBatch();
+        draw_predicated = predicated;
+    }
+}
+
 bool Rasterizer::InvalidateMemory(VAddr addr, u64 size) {
     if (!IsMapped(addr, size)) {
         // Not GPU mapped memory, can skip invalidation logic entirely.
         return false;
     }
+    batch_memory_invalidated.store(true, std::memory_order_relaxed);
     buffer_cache.InvalidateMemory(addr, size);
     texture_cache.InvalidateMemory(addr, size);
     return true;
@@ -1027,10 +1434,12 @@ void Rasterizer::MapMemory(VAddr addr, u64 size) {
         mapped_ranges += decltype(mapped_ranges)::interval_type::right_open(addr, addr + size);
     }
     page_manager.OnGpuMap(addr, size);
+    texture_cache.MapMemory(addr, size);
 }
 
 void Rasterizer::UnmapMemory(VAddr addr, u64 size) {
     buffer_cache.InvalidateMemory(addr, size);
+    buffer_cache.UnmapMemory(addr, size);
     texture_cache.UnmapMemory(addr, size);
     page_manager.OnGpuUnmap(addr, size);
     {
@@ -1039,14 +1448,20 @@ void Rasterizer::UnmapMemory(VAddr addr, u64 size) {
     }
 }
 
-void Rasterizer::UpdateDynamicState(const GraphicsPipeline* pipeline, const bool is_indexed) const {
-    UpdateViewportScissorState();
-    UpdateDepthStencilState();
-    UpdatePrimitiveState(is_indexed);
-    UpdateRasterizationState();
-    UpdateColorBlendingState(pipeline);
+void Rasterizer::UpdateDynamicState(const GraphicsPipeline* pipeline, const bool is_indexed) {
+    // The dynamic state is derived from the registers and the pipeline key only, so it is
+    // unchanged when the previous draw used the same pipeline and no register was written since.
+    if (pipeline_cache.IsGraphicsStateChanged() || pipeline != dynamic_state_pipeline) {
+        dynamic_state_pipeline = pipeline;
+        UpdateViewportScissorState();
+        UpdateDepthStencilState();
+        UpdatePrimitiveState(is_indexed);
+        UpdateRasterizationState();
+        UpdateColorBlendingState(pipeline);
+    }
 
     auto& dynamic_state = scheduler.GetDynamicState();
+    dynamic_state.SetAttachmentFeedbackLoopEnabled(attachment_feedback_loop);
     dynamic_state.Commit(instance, scheduler.CommandBuffer());
 }
 
@@ -1263,34 +1678,87 @@ void Rasterizer::UpdateRasterizationState() const {
     const auto& regs = liverpool->regs;
     auto& dynamic_state = scheduler.GetDynamicState();
     dynamic_state.SetLineWidth(regs.line_control.Width());
+    if (instance.IsDynamicPolygonModeSupported()) {
+        dynamic_state.SetPolygonMode(LiverpoolToVK::PolygonMode(regs.polygon_control.PolyMode()));
+    }
+    if (instance.IsDynamicDepthClampSupported()) {
+        const bool depth_clip_enable = regs.clipper_control.ZclipEnable();
+        dynamic_state.SetDepthClampEnabled(
+            !regs.depth_render_override.disable_viewport_clamp &&
+            (!depth_clip_enable || instance.IsDepthClipEnableSupported()));
+        dynamic_state.SetDepthClipEnabled(depth_clip_enable);
+    }
+    if (instance.IsDynamicProvokingVertexSupported()) {
+        dynamic_state.SetProvokingVertexMode(
+            regs.polygon_control.provoking_vtx_last == AmdGpu::ProvokingVtxLast::First
+                ? vk::ProvokingVertexModeEXT::eFirstVertex
+                : vk::ProvokingVertexModeEXT::eLastVertex);
+    }
 }
 
 void Rasterizer::UpdateColorBlendingState(const GraphicsPipeline* pipeline) const {
     const auto& regs = liverpool->regs;
     auto& dynamic_state = scheduler.GetDynamicState();
     dynamic_state.SetBlendConstants(regs.blend_constants);
-    dynamic_state.SetColorWriteMasks(pipeline->GetGraphicsKey().write_masks);
-    dynamic_state.SetAttachmentFeedbackLoopEnabled(attachment_feedback_loop);
+    const auto& key = pipeline->GetGraphicsKey();
+    dynamic_state.SetColorWriteMasks(pipeline_cache.GetWriteMasks());
+    if (instance.IsDynamicColorBlendSupported()) {
+        const auto& blend_controls = pipeline_cache.GetBlendControls();
+        BlendEnables blend_enables{};
+        BlendEquations blend_equations{};
+        for (u32 cb = 0; cb < key.num_color_attachments; ++cb) {
+            const auto& control = blend_controls[cb];
+            if (!control.enable) {
+                continue;
+            }
+            const bool alpha_masked_out =
+                (key.cb_shader_mask.GetMask(cb) & AmdGpu::ColorBufferMask::ComponentA) == 0;
+            blend_enables[cb] = VK_TRUE;
+            blend_equations[cb] = LiverpoolToVK::BlendEquation(control, alpha_masked_out);
+        }
+        dynamic_state.SetBlendEnables(blend_enables);
+        dynamic_state.SetBlendEquations(blend_equations);
+    }
+    if (instance.IsDynamicLogicOpSupported()) {
+        const auto logic_op = regs.color_control.rop3;
+        dynamic_state.SetLogicOpEnabled(logic_op != AmdGpu::ColorControl::LogicOp::Copy);
+        dynamic_state.SetLogicOp(LiverpoolToVK::LogicOp(logic_op));
+    }
 }
 
 void Rasterizer::ScopeMarkerBegin(const std::string_view& str, bool from_guest) {
-    if ((from_guest && !Config::getVkGuestMarkersEnabled()) ||
-        (!from_guest && !Config::getVkHostMarkersEnabled())) {
+    const bool insert_label = from_guest ? Config::getVkGuestMarkersEnabled()
+                                         : Config::getVkHostMarkersEnabled();
+    if (!insert_label && !scheduler.IsGpuProfiling()) {
         return;
     }
-    const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.beginDebugUtilsLabelEXT(vk::DebugUtilsLabelEXT{
-        .pLabelName = str.data(),
-    });
+    FlushDrawBatch();
+    if (scheduler.IsGpuProfiling()) {
+        profiler_scopes.push_back(scheduler.BeginProfilerScope("{}", str));
+    }
+    if (insert_label) {
+        const auto cmdbuf = scheduler.CommandBuffer();
+        cmdbuf.beginDebugUtilsLabelEXT(vk::DebugUtilsLabelEXT{
+            .pLabelName = str.data(),
+        });
+    }
 }
 
 void Rasterizer::ScopeMarkerEnd(bool from_guest) {
-    if ((from_guest && !Config::getVkGuestMarkersEnabled()) ||
-        (!from_guest && !Config::getVkHostMarkersEnabled())) {
+    const bool insert_label = from_guest ? Config::getVkGuestMarkersEnabled()
+                                         : Config::getVkHostMarkersEnabled();
+    if (!insert_label && !scheduler.IsGpuProfiling()) {
         return;
     }
-    const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.endDebugUtilsLabelEXT();
+    FlushDrawBatch();
+    if (insert_label) {
+        const auto cmdbuf = scheduler.CommandBuffer();
+        cmdbuf.endDebugUtilsLabelEXT();
+    }
+    if (scheduler.IsGpuProfiling() && !profiler_scopes.empty()) {
+        scheduler.EndProfilerScope(profiler_scopes.back());
+        profiler_scopes.pop_back();
+    }
 }
 
 void Rasterizer::ScopedMarkerInsert(const std::string_view& str, bool from_guest) {
@@ -1298,6 +1766,7 @@ void Rasterizer::ScopedMarkerInsert(const std::string_view& str, bool from_guest
         (!from_guest && !Config::getVkHostMarkersEnabled())) {
         return;
     }
+    FlushDrawBatch();
     const auto cmdbuf = scheduler.CommandBuffer();
     cmdbuf.insertDebugUtilsLabelEXT(vk::DebugUtilsLabelEXT{
         .pLabelName = str.data(),
@@ -1310,6 +1779,7 @@ void Rasterizer::ScopedMarkerInsertColor(const std::string_view& str, const u32
         (!from_guest && !Config::getVkHostMarkersEnabled())) {
         return;
     }
+    FlushDrawBatch();
     const auto cmdbuf = scheduler.CommandBuffer();
     cmdbuf.insertDebugUtilsLabelEXT(vk::DebugUtilsLabelEXT{
         .pLabelName = str.data(),
@@ -3,10 +3,15 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "common/recursive_lock.h"
 #include "common/shared_first_mutex.h"
+#include "common/unique_function.h"
 #include "video_core/buffer_cache/buffer_cache.h"
 #include "video_core/page_manager.h"
+#include "video_core/renderer_vulkan/vk_indirect_args.h"
+#include "video_core/renderer_vulkan/vk_occlusion_queries.h"
 #include "video_core/renderer_vulkan/vk_pipeline_cache.h"
 #include "video_core/texture_cache/texture_cache.h"
 
@@ -42,12 +47,16 @@ public:
         return texture_cache;
     }
 
+    [[nodiscard]] const Instance& GetInstance() const noexcept {
+        return instance;
+    }
+
     void Draw(bool is_indexed, u32 index_offset = 0);
     void DrawIndirect(bool is_indexed, VAddr arg_address, u32 offset, u32 size, u32 max_count,
                       VAddr count_address);
 
-    void DispatchDirect();
-    void DispatchIndirect(VAddr address, u32 offset, u32 size);
+    void DispatchDirect(bool predicated = false);
+    void DispatchIndirect(VAddr address, u32 offset, u32 size, bool predicated = false);
 
     void ScopeMarkerBegin(const std::string_view& str, bool from_guest = false);
     void ScopeMarkerEnd(bool from_guest = false);
@@ -58,6 +67,12 @@ public:
     void FillBuffer(VAddr address, u32 num_bytes, u32 value, bool is_gds);
     void CopyBuffer(VAddr dst, VAddr src, u32 num_bytes, bool dst_gds, bool src_gds);
     u32 ReadDataFromGds(u32 gsd_offset);
+    void ZpassDone(VAddr address, u32 num_pairs);
+    void SetPredication(VAddr address, bool draw_if_visible);
+    void SetMemoryPredication(VAddr address, bool draw_if_true);
+    void SetDrawPredicated(bool predicated);
+    void BeginCondExec(VAddr address);
+    void EndCondExec();
     bool InvalidateMemory(VAddr addr, u64 size);
     bool ReadMemory(VAddr addr, u64 size);
     bool IsMapped(VAddr addr, u64 size);
@@ -69,10 +84,25 @@ public:
     void Finish();
     void OnSubmit();
 
+    /// Submits the work recorded so far and runs signal on the scheduler's waiter thread once the
+    /// GPU has executed it, after any readback queued before.
+    void SignalOnGpuCompletion(Common::UniqueFunction<void>&& signal);
+
+    /// Runs func on the GPU thread, where the caches can be inspected, without waiting for it.
+    void RunOnGpuThread(Common::UniqueFunction<void>&& func);
+
     PipelineCache& GetPipelineCache() {
         return pipeline_cache;
     }
 
+    const VideoCore::PageManager& GetPageManager() const {
+        return page_manager;
+    }
+
+    const VideoCore::BufferCache& GetBufferCache() const {
+        return buffer_cache;
+    }
+
     template <typename Func>
     void ForEachMappedRangeInRange(VAddr addr, u64 size, Func&& func) {
         const auto range = decltype(mapped_ranges)::interval_type::right_open(addr, addr + size);
@@ -86,10 +116,14 @@ private:
     void PrepareRenderState(const GraphicsPipeline* pipeline);
     RenderState BeginRendering(const GraphicsPipeline* pipeline);
     void Resolve();
+    bool ResolveInRenderPass(VideoCore::ImageId src_id,
+                             const VideoCore::TextureCache::ImageDesc& src_desc,
+                             VideoCore::ImageId dst_id,
+                             const VideoCore::TextureCache::ImageDesc& dst_desc);
     void DepthStencilCopy(bool is_depth, bool is_stencil);
     void EliminateFastClear();
 
-    void UpdateDynamicState(const GraphicsPipeline* pipeline, bool is_indexed) const;
+    void UpdateDynamicState(const GraphicsPipeline* pipeline, bool is_indexed);
     void UpdateViewportScissorState() const;
     void UpdateDepthStencilState() const;
     void UpdatePrimitiveState(bool is_indexed) const;
@@ -103,6 +137,14 @@ private:
     void BindTextures(const Shader::Info& stage, Shader::Backend::Bindings& binding);
     bool BindResources(const Pipeline* pipeline);
 
+    /// Begins a GPU profiler scope for draws through the geometry shader stage, which host GPUs
+    /// run at very different speeds. Returns an invalid scope for other pipelines.
+    u64 BeginGeometryStageScope(const GraphicsPipeline& pipeline);
+
+    bool CanBatchDraws(const GraphicsPipeline& pipeline) const;
+    bool BatchDraw(bool is_indexed, u32 index_offset);
+    void FlushDrawBatch();
+
     void ResetBindings() {
         for (auto& image_id : bound_images) {
             texture_cache.GetImage(image_id).binding = {};
@@ -127,6 +169,8 @@ private:
     boost::icl::interval_set<VAddr> mapped_ranges;
     Common::SharedFirstMutex mapped_ranges_mutex;
     PipelineCache pipeline_cache;
+    OcclusionQueries occlusion_queries;
+    IndirectArgsRepacker indirect_args;
 
     using RenderTargetInfo = std::pair<VideoCore::ImageId, VideoCore::TextureCache::ImageDesc>;
     std::array<RenderTargetInfo, AmdGpu::NUM_COLOR_BUFFERS> cb_descs;
@@ -138,6 +182,7 @@ private:
     Pipeline::DescriptorWrites set_writes;
     Pipeline::BufferBarriers buffer_barriers;
     Shader::PushData push_data;
+    Shader::BindlessPushData bindless_data;
 
     using BufferBindingInfo = std::tuple<VideoCore::BufferId, AmdGpu::Buffer, u64>;
     boost::container::static_vector<BufferBindingInfo, Shader::NUM_BUFFERS> buffer_bindings;
@@ -145,6 +190,27 @@ private:
     boost::container::static_vector<ImageBindingInfo, Shader::NUM_IMAGES> image_bindings;
     bool fault_process_pending{};
     bool attachment_feedback_loop{};
+    bool draw_predicated{}; ///< Draws are skipped when the guest predicate fails
+    const GraphicsPipeline* dynamic_state_pipeline{}; ///< Pipeline the dynamic state was set for
+    std::vector<u64> profiler_scopes; ///< GPU profiler scopes of the open scope markers
+
+    /// Consecutive draws with the same state and bindings, recorded together once rendering
+    /// ends or a draw that can't join them comes in.
+    struct DrawBatch {
+        const GraphicsPipeline* pipeline{};
+        bool is_indexed{};
+        const VideoCore::Buffer* index_buffer{};
+        VAddr index_address{};
+        u32 index_size{};
+        u32 first_index{}; ///< Index offset the index buffer was bound at
+        u32 num_instances{};
+        u32 vertex_offset{};
+        u32 instance_offset{};
+        std::vector<vk::MultiDrawInfoEXT> draws;
+        std::vector<vk::MultiDrawIndexedInfoEXT> indexed_draws;
+    } draw_batch;
+    bool draw_coalescing{};
+    std::atomic_bool batch_memory_invalidated{};
 };
 
 } // namespace Vulkan
@@ -1,12 +1,17 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <cstddef>
 #include <optional>
 #include "common/assert.h"
+#include "common/config.h"
+#include "shader_recompiler/resource.h"
+#include "video_core/buffer_cache/buffer.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_master_semaphore.h"
 #include "video_core/renderer_vulkan/vk_resource_pool.h"
+#include "video_core/renderer_vulkan/vk_scheduler.h"
 
 namespace Vulkan {
 
@@ -60,12 +65,13 @@ std::size_t ResourcePool::ManageOverflow() {
 
 constexpr std::size_t COMMAND_BUFFER_POOL_SIZE = 4;
 
-CommandPool::CommandPool(const Instance& instance, MasterSemaphore* master_semaphore)
-    : ResourcePool{master_semaphore, COMMAND_BUFFER_POOL_SIZE}, instance{instance} {
+CommandPool::CommandPool(const Instance& instance, MasterSemaphore* master_semaphore,
+                         u32 queue_family_index, vk::CommandBufferLevel level)
+    : ResourcePool{master_semaphore, COMMAND_BUFFER_POOL_SIZE}, instance{instance}, level{level} {
     const vk::CommandPoolCreateInfo pool_create_info = {
         .flags = vk::CommandPoolCreateFlagBits::eTransient |
                  vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
-        .queueFamilyIndex = instance.GetGraphicsQueueFamilyIndex(),
+        .queueFamilyIndex = queue_family_index,
     };
     const vk::Device device = instance.GetDevice();
     auto [pool_result, pool] = device.createCommandPoolUnique(pool_create_info);
@@ -82,7 +88,7 @@ void CommandPool::Allocate(std::size_t begin, std::size_t end) {
 
     const vk::CommandBufferAllocateInfo buffer_alloc_info = {
         .commandPool = *cmd_pool,
-        .level = vk::CommandBufferLevel::ePrimary,
+        .level = level,
         .commandBufferCount = COMMAND_BUFFER_POOL_SIZE,
     };
 
@@ -190,4 +196,214 @@ void DescriptorHeap::CreateDescriptorPool() {
     curr_pool = pool;
 }
 
+SamplerHeap::SamplerHeap(const Instance& instance, u32 capacity_)
+    : device{instance.GetDevice()}, capacity{capacity_} {
+    const vk::DescriptorBindingFlags binding_flags =
+        vk::DescriptorBindingFlagBits::eUpdateAfterBind |
+        vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending |
+        vk::DescriptorBindingFlagBits::ePartiallyBound;
+    const vk::DescriptorSetLayoutBindingFlagsCreateInfo binding_flags_ci = {
+        .bindingCount = 1U,
+        .pBindingFlags = &binding_flags,
+    };
+    const vk::DescriptorSetLayoutBinding binding = {
+        .binding = 0U,
+        .descriptorType = vk::DescriptorType::eSampler,
+        .descriptorCount = capacity,
+        .stageFlags = vk::ShaderStageFlagBits::eAll,
+    };
+    auto [layout_result, layout] = device.createDescriptorSetLayoutUnique({
+        .pNext = &binding_flags_ci,
+        .flags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool,
+        .bindingCount = 1U,
+        .pBindings = &binding,
+    });
+    ASSERT_MSG(layout_result == vk::Result::eSuccess,
+               "Failed to create sampler heap layout: {}", vk::to_string(layout_result));
+    set_layout = std::move(layout);
+
+    const vk::DescriptorPoolSize pool_size = {
+        .type = vk::DescriptorType::eSampler,
+        .descriptorCount = capacity,
+    };
+    auto [pool_result, heap_pool] = device.createDescriptorPoolUnique({
+        .flags = vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind,
+        .maxSets = 1U,
+        .poolSizeCount = 1U,
+        .pPoolSizes = &pool_size,
+    });
+    ASSERT_MSG(pool_result == vk::Result::eSuccess, "Failed to create sampler heap pool: {}",
+               vk::to_string(pool_result));
+    pool = std::move(heap_pool);
+
+    const vk::DescriptorSetLayout layout_handle = *set_layout;
+    const vk::DescriptorSetAllocateInfo alloc_info = {
+        .descriptorPool = *pool,
+        .descriptorSetCount = 1U,
+        .pSetLayouts = &layout_handle,
+    };
+    const auto set_result = device.allocateDescriptorSets(&alloc_info, &set);
+    ASSERT_MSG(set_result == vk::Result::eSuccess, "Failed to allocate sampler heap: {}",
+               vk::to_string(set_result));
+
+    // Lowest slots are handed out first
+    free_slots.resize(capacity);
+    for (u32 slot = 0; slot < capacity; ++slot) {
+        free_slots[slot] = capacity - slot - 1;
+    }
+}
+
+SamplerHeap::~SamplerHeap() = default;
+
+std::unique_ptr<SamplerHeap> SamplerHeap::Create(const Instance& instance) {
+    if (!Config::isBindlessSamplersEnabled()) {
+        return nullptr;
+    }
+    // Descriptor buffers can't be bound along with descriptor sets, and the heap slots are
+    // pushed after the regular push data.
+    constexpr u32 push_size = Shader::BindlessPushData::Offset + sizeof(Shader::BindlessPushData);
+    if (!instance.IsBindlessSamplersSupported() || instance.IsDescriptorBufferSupported() ||
+        instance.MaxPushConstantsSize() < push_size) {
+        LOG_WARNING(Render_Vulkan, "Bindless samplers are not supported, using descriptor sets");
+        return nullptr;
+    }
+    const u32 capacity = std::min(instance.MaxUpdateAfterBindSamplers(), MaxCapacity);
+    LOG_INFO(Render_Vulkan, "Using bindless samplers with a heap of {} samplers", capacity);
+    return std::make_unique<SamplerHeap>(instance, capacity);
+}
+
+u32 SamplerHeap::Allocate(vk::Sampler sampler) {
+    ASSERT_MSG(!free_slots.empty(), "Sampler heap is full");
+    const u32 slot = free_slots.back();
+    free_slots.pop_back();
+    const vk::DescriptorImageInfo image_info = {
+        .sampler = sampler,
+    };
+    device.updateDescriptorSets(
+        vk::WriteDescriptorSet{
+            .dstSet = set,
+            .dstBinding = 0U,
+            .dstArrayElement = slot,
+            .descriptorCount = 1U,
+            .descriptorType = vk::DescriptorType::eSampler,
+            .pImageInfo = &image_info,
+        },
+        {});
+    return slot;
+}
+
+void SamplerHeap::Free(u32 slot) {
+    free_slots.push_back(slot);
+}
+
+DescriptorBuffer::DescriptorBuffer(const Instance& instance_, Scheduler& scheduler_)
+    : instance{instance_}, scheduler{scheduler_} {
+    const auto& props = instance.GetDescriptorBufferProperties();
+    // Sets holding samplers have to be addressable within the sampler range as well.
+    const u64 size = std::min({RingSize, u64{props.maxResourceDescriptorBufferRange},
+                               u64{props.maxSamplerDescriptorBufferRange}});
+    ring = std::make_unique<VideoCore::StreamBuffer>(
+        instance, scheduler, VideoCore::MemoryUsage::Stream, size,
+        vk::BufferUsageFlagBits::eResourceDescriptorBufferEXT |
+            vk::BufferUsageFlagBits::eSamplerDescriptorBufferEXT |
+            vk::BufferUsageFlagBits::eShaderDeviceAddress);
+}
+
+DescriptorBuffer::~DescriptorBuffer() = default;
+
+DescriptorBufferLayout DescriptorBuffer::GetLayout(const Instance& instance,
+                                                   vk::DescriptorSetLayout set_layout,
+                                                   u32 num_bindings) {
+    const vk::Device device = instance.GetDevice();
+    DescriptorBufferLayout layout{
+        .size = device.getDescriptorSetLayoutSizeEXT(set_layout),
+    };
+    layout.binding_offsets.reserve(num_bindings);
+    for (u32 binding = 0; binding < num_bindings; ++binding) {
+        layout.binding_offsets.push_back(
+            device.getDescriptorSetLayoutBindingOffsetEXT(set_layout, binding));
+    }
+    return layout;
+}
+
+void DescriptorBuffer::Bind(vk::PipelineBindPoint bind_point, vk::PipelineLayout pipeline_layout,
+                            const DescriptorBufferLayout& layout,
+                            std::span<const vk::WriteDescriptorSet> writes) {
+    const vk::Device device = instance.GetDevice();
+    const auto& props = instance.GetDescriptorBufferProperties();
+    const auto [data, offset] = ring->Map(layout.size, props.descriptorBufferOffsetAlignment);
+    for (const auto& write : writes) {
+        vk::DescriptorGetInfoEXT get_info = {
+            .type = write.descriptorType,
+        };
+        vk::DescriptorAddressInfoEXT address_info{};
+        switch (write.descriptorType) {
+        case vk::DescriptorType::eUniformBuffer:
+        case vk::DescriptorType::eStorageBuffer: {
+            const auto& buffer_info = *write.pBufferInfo;
+            const vk::DescriptorAddressInfoEXT* address = nullptr;
+            if (buffer_info.buffer) {
+                address_info = {
+                    .address = device.getBufferAddress({.buffer = buffer_info.buffer}) +
+                               buffer_info.offset,
+                    .range = buffer_info.range,
+                };
+                address = &address_info;
+            }
+            if (write.descriptorType == vk::DescriptorType::eUniformBuffer) {
+                get_info.data.pUniformBuffer = address;
+            } else {
+                get_info.data.pStorageBuffer = address;
+            }
+            break;
+        }
+        case vk::DescriptorType::eSampledImage:
+            get_info.data.pSampledImage = write.pImageInfo->imageView ? write.pImageInfo : nullptr;
+            break;
+        case vk::DescriptorType::eStorageImage:
+            get_info.data.pStorageImage = write.pImageInfo->imageView ? write.pImageInfo : nullptr;
+            break;
+        case vk::DescriptorType::eSampler:
+            get_info.data.pSampler = &write.pImageInfo->sampler;
+            break;
+        default:
+            UNREACHABLE_MSG("Unexpected descriptor type {}", vk::to_string(write.descriptorType));
+        }
+        device.getDescriptorEXT(get_info, DescriptorSize(write.descriptorType),
+                                data + layout.binding_offsets[write.dstBinding]);
+    }
+    ring->Commit();
+
+    const auto cmdbuf = scheduler.CommandBuffer();
+    if (scheduler.GetDynamicState().TakeDescriptorBufferBinding()) {
+        const vk::DescriptorBufferBindingInfoEXT binding_info = {
+            .address = ring->BufferDeviceAddress(),
+            .usage = vk::BufferUsageFlagBits::eResourceDescriptorBufferEXT |
+                     vk::BufferUsageFlagBits::eSamplerDescriptorBufferEXT,
+        };
+        cmdbuf.bindDescriptorBuffersEXT(binding_info);
+    }
+    const u32 buffer_index = 0;
+    cmdbuf.setDescriptorBufferOffsetsEXT(bind_point, pipeline_layout, 0, buffer_index, offset);
+}
+
+size_t DescriptorBuffer::DescriptorSize(vk::DescriptorType type) const {
+    const auto& props = instance.GetDescriptorBufferProperties();
+    const bool robust = instance.IsRobustBufferAccessEnabled();
+    switch (type) {
+    case vk::DescriptorType::eUniformBuffer:
+        return robust ? props.robustUniformBufferDescriptorSize : props.uniformBufferDescriptorSize;
+    case vk::DescriptorType::eStorageBuffer:
+        return robust ? props.robustStorageBufferDescriptorSize : props.storageBufferDescriptorSize;
+    case vk::DescriptorType::eSampledImage:
+        return props.sampledImageDescriptorSize;
+    case vk::DescriptorType::eStorageImage:
+        return props.storageImageDescriptorSize;
+    case vk::DescriptorType::eSampler:
+        return props.samplerDescriptorSize;
+    default:
+        UNREACHABLE();
+    }
+}
+
 } // namespace Vulkan
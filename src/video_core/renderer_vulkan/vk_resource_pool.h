@@ -4,17 +4,25 @@
 #pragma once
 
 #include <deque>
+#include <memory>
+#include <span>
 #include <vector>
+#include <boost/container/small_vector.hpp>
 #include <boost/container/static_vector.hpp>
 #include <tsl/robin_map.h>
 
 #include "common/types.h"
 #include "video_core/renderer_vulkan/vk_common.h"
 
+namespace VideoCore {
+class StreamBuffer;
+}
+
 namespace Vulkan {
 
 class Instance;
 class MasterSemaphore;
+class Scheduler;
 
 /**
  * Handles a pool of resources protected by fences. Manages resource overflow allocating more
@@ -51,7 +59,9 @@ protected:
 
 class CommandPool final : public ResourcePool {
 public:
-    explicit CommandPool(const Instance& instance, MasterSemaphore* master_semaphore);
+    explicit CommandPool(const Instance& instance, MasterSemaphore* master_semaphore,
+                         u32 queue_family_index,
+                         vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary);
     ~CommandPool() override;
 
     void Allocate(std::size_t begin, std::size_t end) override;
@@ -60,6 +70,7 @@ public:
 
 private:
     const Instance& instance;
+    vk::CommandBufferLevel level;
     vk::UniqueCommandPool cmd_pool;
     std::vector<vk::CommandBuffer> cmd_buffers;
 };
@@ -89,4 +100,77 @@ private:
     tsl::robin_map<u64, DescSetBatch> descriptor_sets;
 };
 
+/// Descriptor set holding all samplers of the texture cache in one array, which shaders index
+/// with the slots pushed as constants when samplers are bindless. A slot is written once when its
+/// sampler is created and the set stays bound while new slots are written.
+class SamplerHeap final {
+    static constexpr u32 MaxCapacity = 8192;
+
+public:
+    explicit SamplerHeap(const Instance& instance, u32 capacity);
+    ~SamplerHeap();
+
+    /// Creates the heap when bindless samplers are enabled and the device supports them.
+    [[nodiscard]] static std::unique_ptr<SamplerHeap> Create(const Instance& instance);
+
+    /// Writes the sampler to a free slot and returns the slot.
+    [[nodiscard]] u32 Allocate(vk::Sampler sampler);
+
+    /// Returns the slot to the heap, the GPU must be done with its sampler.
+    void Free(u32 slot);
+
+    [[nodiscard]] u32 Capacity() const noexcept {
+        return capacity;
+    }
+
+    [[nodiscard]] vk::DescriptorSetLayout Layout() const noexcept {
+        return *set_layout;
+    }
+
+    [[nodiscard]] vk::DescriptorSet Set() const noexcept {
+        return set;
+    }
+
+private:
+    vk::Device device;
+    u32 capacity;
+    vk::UniqueDescriptorSetLayout set_layout;
+    vk::UniqueDescriptorPool pool;
+    vk::DescriptorSet set;
+    std::vector<u32> free_slots;
+};
+
+/// Placement of the bindings of a descriptor set layout created for descriptor buffers.
+struct DescriptorBufferLayout {
+    vk::DeviceSize size{};
+    boost::container::small_vector<vk::DeviceSize, 32> binding_offsets;
+};
+
+/// Ring of descriptor sets written straight into host visible memory with VK_EXT_descriptor_buffer,
+/// which replaces allocating and updating a descriptor set per draw with copying the descriptors.
+class DescriptorBuffer final {
+    static constexpr u64 RingSize = 16_MB;
+
+public:
+    explicit DescriptorBuffer(const Instance& instance, Scheduler& scheduler);
+    ~DescriptorBuffer();
+
+    /// Queries the placement of the first num_bindings bindings of the layout.
+    [[nodiscard]] static DescriptorBufferLayout GetLayout(const Instance& instance,
+                                                          vk::DescriptorSetLayout set_layout,
+                                                          u32 num_bindings);
+
+    /// Writes the descriptors of a set and binds it as set 0 of the pipeline layout.
+    void Bind(vk::PipelineBindPoint bind_point, vk::PipelineLayout pipeline_layout,
+              const DescriptorBufferLayout& layout, std::span<const vk::WriteDescriptorSet> writes);
+
+private:
+    [[nodiscard]] size_t DescriptorSize(vk::DescriptorType type) const;
+
+private:
+    const Instance& instance;
+    Scheduler& scheduler;
+    std::unique_ptr<VideoCore::StreamBuffer> ring;
+};
+
 } // namespace Vulkan
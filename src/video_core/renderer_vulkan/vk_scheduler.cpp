@@ -1,28 +1,57 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <boost/container/small_vector.hpp>
+
 #include "common/assert.h"
+#include "common/config.h"
 #include "common/debug.h"
 #include "common/thread.h"
+#include "core/thread.h"
 #include "imgui/renderer/texture_manager.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/stall_tracker.h"
 
 namespace Vulkan {
 
 std::mutex Scheduler::submit_mutex;
 
+constexpr size_t NUM_PARALLEL_WORKERS = 4;
+
+/// Queue calls can take milliseconds on some drivers, they are made on this thread so recording
+/// goes on meanwhile. It is shared by all schedulers to keep the order they submitted in.
+static Common::ThreadWorker& SubmitWorker() {
+    static Common::ThreadWorker worker{1, "GpuSubmit"};
+    return worker;
+}
+
 Scheduler::Scheduler(const Instance& instance)
-    : instance{instance}, master_semaphore{instance}, command_pool{instance, &master_semaphore} {
+    : Scheduler{instance, instance.GetGraphicsQueue(), instance.GetGraphicsQueueFamilyIndex()} {}
+
+Scheduler::Scheduler(const Instance& instance, vk::Queue queue, u32 queue_family_index)
+    : instance{instance}, queue{queue}, queue_family_index{queue_family_index},
+      is_graphics{queue_family_index == instance.GetGraphicsQueueFamilyIndex()},
+      master_semaphore{instance}, command_pool{instance, &master_semaphore, queue_family_index},
+      sparse_semaphore{instance} {
 #if TRACY_GPU_ENABLED
     profiler_scope = reinterpret_cast<tracy::VkCtxScope*>(std::malloc(sizeof(tracy::VkCtxScope)));
 #endif
+    // Dynamic resolution and GPU triggered captures are driven by the GPU time of the profiler
+    // scopes
+    const bool needs_profiler = Config::getVkGpuTimestampsEnabled() ||
+                                Config::isDynamicResolutionEnabled() ||
+                                Config::getRdocAutoCaptureGpuMs() != 0;
+    if (is_graphics && needs_profiler && GpuProfiler::IsSupported(instance)) {
+        gpu_profiler = std::make_unique<GpuProfiler>(instance, &master_semaphore);
+    }
     AllocateWorkerCommandBuffers();
     priority_pending_ops_thread =
         std::jthread(std::bind_front(&Scheduler::PriorityPendingOpsThread, this));
 }
 
 Scheduler::~Scheduler() {
+    WaitForSubmits();
 #if TRACY_GPU_ENABLED
     std::free(profiler_scope);
 #endif
@@ -33,8 +62,14 @@ void Scheduler::BeginRendering(const RenderState& new_state) {
         return;
     }
     EndRendering();
+    if (!parallel_cmdbufs.empty()) {
+        ExecuteParallelCommands();
+    }
     is_rendering = true;
     render_state = new_state;
+    rendering_scope = BeginProfilerScope("Rendering:{}x{}:{} color{}", render_state.width,
+                                         render_state.height, render_state.num_color_attachments,
+                                         render_state.has_depth ? ":depth" : "");
 
     const vk::RenderingInfo rendering_info = {
         .renderArea =
@@ -58,8 +93,47 @@ void Scheduler::EndRendering() {
     if (!is_rendering) {
         return;
     }
+    if (end_rendering_callback) {
+        end_rendering_callback();
+    }
     is_rendering = false;
     current_cmdbuf.endRendering();
+    EndProfilerScope(std::exchange(rendering_scope, GpuProfiler::InvalidScope));
+}
+
+void Scheduler::RecordParallel(Common::UniqueFunction<void, vk::CommandBuffer>&& func) {
+    EndRendering();
+    if (!parallel_workers) {
+        // Every worker records from its own pool, command pools are externally synchronized
+        parallel_workers.emplace(NUM_PARALLEL_WORKERS, "ParallelRecord", [this] {
+            return std::make_unique<CommandPool>(instance, &master_semaphore, queue_family_index,
+                                                 vk::CommandBufferLevel::eSecondary);
+        });
+    }
+    vk::CommandBuffer* cmdbuf = &parallel_cmdbufs.emplace_back();
+    parallel_workers->QueueWork([cmdbuf, func = std::move(func)](auto* pool) mutable {
+        // The primary can't be submitted before the recording is done, so the buffer is tagged
+        // with the tick it is executed in.
+        *cmdbuf = (*pool)->Commit();
+        const vk::CommandBufferInheritanceInfo inheritance_info{};
+        const vk::CommandBufferBeginInfo begin_info = {
+            .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+            .pInheritanceInfo = &inheritance_info,
+        };
+        Check(cmdbuf->begin(begin_info));
+        func(*cmdbuf);
+        Check(cmdbuf->end());
+    });
+}
+
+void Scheduler::ExecuteParallelCommands() {
+    parallel_workers->WaitForRequests();
+    boost::container::small_vector<vk::CommandBuffer, 16> cmdbufs{parallel_cmdbufs.begin(),
+                                                                  parallel_cmdbufs.end()};
+    parallel_cmdbufs.clear();
+    current_cmdbuf.executeCommands(cmdbufs);
+    // Secondary command buffers leave the dynamic state of the primary undefined.
+    dynamic_state.Invalidate();
 }
 
 void Scheduler::Flush(SubmitInfo& info) {
@@ -75,6 +149,7 @@ void Scheduler::Flush() {
 void Scheduler::Finish() {
     // When finishing, we need to wait for the submission to have executed on the device.
     const u64 presubmit_tick = CurrentTick();
+    VideoCore::ScopedStall stall{VideoCore::StallCause::SchedulerFinish};
     SubmitInfo info{};
     SubmitExecution(info);
     Wait(presubmit_tick);
@@ -86,9 +161,24 @@ void Scheduler::Wait(u64 tick) {
         SubmitInfo info{};
         Flush(info);
     }
+    if (master_semaphore.IsFree(tick)) {
+        return;
+    }
+    VideoCore::ScopedStall stall{VideoCore::StallCause::SchedulerWait};
     master_semaphore.Wait(tick);
 }
 
+void Scheduler::WaitOn(Scheduler& other, u64 tick) {
+    if (tick >= other.CurrentTick()) {
+        // The other queue has to submit the work before it can be waited on
+        other.Flush();
+    }
+    ASSERT_MSG(!queue_wait.semaphore || queue_wait.semaphore == other.master_semaphore.Handle(),
+               "Only one other queue can be waited on per submission");
+    queue_wait.semaphore = other.master_semaphore.Handle();
+    queue_wait.tick = std::max(queue_wait.tick, tick);
+}
+
 void Scheduler::PopPendingOperations() {
     master_semaphore.Refresh();
     while (!pending_ops.empty() && master_semaphore.IsFree(pending_ops.front().gpu_tick)) {
@@ -109,7 +199,7 @@ void Scheduler::AllocateWorkerCommandBuffers() {
     dynamic_state.Invalidate();
 
 #if TRACY_GPU_ENABLED
-    auto* profiler_ctx = instance.GetProfilerContext();
+    auto* profiler_ctx = is_graphics ? instance.GetProfilerContext() : nullptr;
     if (profiler_ctx) {
         static const auto scope_loc =
             GPU_SCOPE_LOCATION("Guest Frame", MarkersPalette::GpuMarkerColor);
@@ -123,7 +213,7 @@ void Scheduler::SubmitExecution(SubmitInfo& info) {
     const u64 signal_value = master_semaphore.NextTick();
 
 #if TRACY_GPU_ENABLED
-    auto* profiler_ctx = instance.GetProfilerContext();
+    auto* profiler_ctx = is_graphics ? instance.GetProfilerContext() : nullptr;
     if (profiler_ctx) {
         profiler_scope->~VkCtxScope();
         TracyVkCollect(profiler_ctx, current_cmdbuf);
@@ -131,47 +221,140 @@ void Scheduler::SubmitExecution(SubmitInfo& info) {
 #endif
 
     EndRendering();
+    if (submit_callback) {
+        submit_callback();
+    }
+    if (!parallel_cmdbufs.empty()) {
+        ExecuteParallelCommands();
+    }
     Check(current_cmdbuf.end());
 
     const vk::Semaphore timeline = master_semaphore.Handle();
     info.AddSignal(timeline, signal_value);
+    if (queue_wait.semaphore) {
+        info.AddWait(queue_wait.semaphore, queue_wait.tick);
+        queue_wait = {};
+    }
+    std::vector<PendingSparseBind> sparse_binds;
+    {
+        std::scoped_lock sparse_lk{sparse_binds_mutex};
+        sparse_binds.swap(pending_sparse_binds);
+    }
 
-    static constexpr std::array<vk::PipelineStageFlags, 2> wait_stage_masks = {
-        vk::PipelineStageFlagBits::eAllCommands,
-        vk::PipelineStageFlagBits::eColorAttachmentOutput,
-    };
-
-    const vk::TimelineSemaphoreSubmitInfo timeline_si = {
-        .waitSemaphoreValueCount = info.num_wait_semas,
-        .pWaitSemaphoreValues = info.wait_ticks.data(),
-        .signalSemaphoreValueCount = info.num_signal_semas,
-        .pSignalSemaphoreValues = info.signal_ticks.data(),
-    };
-
-    const vk::SubmitInfo submit_info = {
-        .pNext = &timeline_si,
-        .waitSemaphoreCount = info.num_wait_semas,
-        .pWaitSemaphores = info.wait_semas.data(),
-        .pWaitDstStageMask = wait_stage_masks.data(),
-        .commandBufferCount = 1U,
-        .pCommandBuffers = &current_cmdbuf,
-        .signalSemaphoreCount = info.num_signal_semas,
-        .pSignalSemaphores = info.signal_semas.data(),
-    };
-
-    ImGui::Core::TextureManager::Submit();
-    auto submit_result = instance.GetGraphicsQueue().submit(submit_info, info.fence);
-    ASSERT_MSG(submit_result != vk::Result::eErrorDeviceLost, "Device lost during submit");
+    // The tick is already taken, timeline waits on it work before the driver gets the submission.
+    SubmitWorker().QueueWork([this, info, signal_value, cmdbuf = current_cmdbuf,
+                              sparse_binds = std::move(sparse_binds)] mutable {
+        std::scoped_lock queue_lk{submit_mutex};
+        SubmitSparseBinds(info, sparse_binds, signal_value - 1);
+
+        const vk::TimelineSemaphoreSubmitInfo timeline_si = {
+            .waitSemaphoreValueCount = info.num_wait_semas,
+            .pWaitSemaphoreValues = info.wait_ticks.data(),
+            .signalSemaphoreValueCount = info.num_signal_semas,
+            .pSignalSemaphoreValues = info.signal_ticks.data(),
+        };
+
+        const vk::SubmitInfo submit_info = {
+            .pNext = &timeline_si,
+            .waitSemaphoreCount = info.num_wait_semas,
+            .pWaitSemaphores = info.wait_semas.data(),
+            .pWaitDstStageMask = info.wait_stages.data(),
+            .commandBufferCount = 1U,
+            .pCommandBuffers = &cmdbuf,
+            .signalSemaphoreCount = info.num_signal_semas,
+            .pSignalSemaphores = info.signal_semas.data(),
+        };
+
+        if (is_graphics) {
+            ImGui::Core::TextureManager::Submit();
+        }
+        auto submit_result = queue.submit(submit_info, info.fence);
+        ASSERT_MSG(submit_result != vk::Result::eErrorDeviceLost, "Device lost during submit");
+    });
 
     master_semaphore.Refresh();
+    if (gpu_profiler) {
+        gpu_profiler->Collect();
+    }
     AllocateWorkerCommandBuffers();
 
     // Apply pending operations
     PopPendingOperations();
 }
 
+void Scheduler::BindSparse(vk::Image image, std::vector<vk::SparseImageMemoryBind>&& binds,
+                           std::vector<vk::SparseMemoryBind>&& opaque_binds) {
+    if (binds.empty() && opaque_binds.empty()) {
+        return;
+    }
+    std::scoped_lock lk{sparse_binds_mutex};
+    pending_sparse_binds.push_back({image, std::move(binds), std::move(opaque_binds)});
+}
+
+void Scheduler::QueueSubmitOperation(Common::UniqueFunction<void>&& func) {
+    SubmitWorker().QueueWork([func = std::move(func)] {
+        std::scoped_lock lk{submit_mutex};
+        func();
+    });
+}
+
+void Scheduler::WaitForSubmits() {
+    SubmitWorker().WaitForRequests();
+}
+
+void Scheduler::SubmitSparseBinds(SubmitInfo& info, std::span<const PendingSparseBind> binds,
+                                  u64 last_tick) {
+    if (binds.empty()) {
+        return;
+    }
+    boost::container::small_vector<vk::SparseImageMemoryBindInfo, 8> image_binds;
+    boost::container::small_vector<vk::SparseImageOpaqueMemoryBindInfo, 8> opaque_binds;
+    for (const auto& bind : binds) {
+        if (!bind.binds.empty()) {
+            image_binds.push_back({
+                .image = bind.image,
+                .bindCount = static_cast<u32>(bind.binds.size()),
+                .pBinds = bind.binds.data(),
+            });
+        }
+        if (!bind.opaque_binds.empty()) {
+            opaque_binds.push_back({
+                .image = bind.image,
+                .bindCount = static_cast<u32>(bind.opaque_binds.size()),
+                .pBinds = bind.opaque_binds.data(),
+            });
+        }
+    }
+
+    // Memory being unbound may still be in use by the previous submission.
+    const vk::Semaphore timeline = master_semaphore.Handle();
+    const vk::Semaphore sparse_timeline = sparse_semaphore.Handle();
+    const u64 sparse_tick = sparse_semaphore.NextTick();
+    const vk::TimelineSemaphoreSubmitInfo timeline_si = {
+        .waitSemaphoreValueCount = 1U,
+        .pWaitSemaphoreValues = &last_tick,
+        .signalSemaphoreValueCount = 1U,
+        .pSignalSemaphoreValues = &sparse_tick,
+    };
+    const vk::BindSparseInfo bind_info = {
+        .pNext = &timeline_si,
+        .waitSemaphoreCount = 1U,
+        .pWaitSemaphores = &timeline,
+        .imageOpaqueBindCount = static_cast<u32>(opaque_binds.size()),
+        .pImageOpaqueBinds = opaque_binds.data(),
+        .imageBindCount = static_cast<u32>(image_binds.size()),
+        .pImageBinds = image_binds.data(),
+        .signalSemaphoreCount = 1U,
+        .pSignalSemaphores = &sparse_timeline,
+    };
+    const auto bind_result = queue.bindSparse(bind_info, {});
+    ASSERT_MSG(bind_result != vk::Result::eErrorDeviceLost, "Device lost during sparse bind");
+    info.AddWait(sparse_timeline, sparse_tick);
+}
+
 void Scheduler::PriorityPendingOpsThread(std::stop_token stoken) {
     Common::SetCurrentThreadName("shadPS4:GpuSchedPriorityPendingOpsRunner");
+    Core::KeepCurrentThreadOffGuestCores();
 
     while (!stoken.stop_requested()) {
         PendingOp op;
@@ -353,6 +536,42 @@ void DynamicState::Commit(const Instance& instance, const vk::CommandBuffer& cmd
                                                       ? vk::ImageAspectFlagBits::eColor
                                                       : vk::ImageAspectFlagBits::eNone);
     }
+    if (dirty_state.polygon_mode && instance.IsDynamicPolygonModeSupported()) {
+        dirty_state.polygon_mode = false;
+        cmdbuf.setPolygonModeEXT(polygon_mode);
+    }
+    if (dirty_state.depth_clamp_enabled && instance.IsDynamicDepthClampSupported()) {
+        dirty_state.depth_clamp_enabled = false;
+        cmdbuf.setDepthClampEnableEXT(depth_clamp_enabled);
+    }
+    if (dirty_state.depth_clip_enabled && instance.IsDynamicDepthClampSupported()) {
+        dirty_state.depth_clip_enabled = false;
+        if (instance.IsDepthClipEnableSupported()) {
+            cmdbuf.setDepthClipEnableEXT(depth_clip_enabled);
+        }
+    }
+    if (dirty_state.blend_enables && instance.IsDynamicColorBlendSupported()) {
+        dirty_state.blend_enables = false;
+        cmdbuf.setColorBlendEnableEXT(0, blend_enables);
+    }
+    if (dirty_state.blend_equations && instance.IsDynamicColorBlendSupported()) {
+        dirty_state.blend_equations = false;
+        cmdbuf.setColorBlendEquationEXT(0, blend_equations);
+    }
+    if (instance.IsDynamicLogicOpSupported()) {
+        if (dirty_state.logic_op_enabled) {
+            dirty_state.logic_op_enabled = false;
+            cmdbuf.setLogicOpEnableEXT(logic_op_enabled);
+        }
+        if (logic_op_enabled && dirty_state.logic_op) {
+            dirty_state.logic_op = false;
+            cmdbuf.setLogicOpEXT(logic_op);
+        }
+    }
+    if (dirty_state.provoking_vertex_mode && instance.IsDynamicProvokingVertexSupported()) {
+        dirty_state.provoking_vertex_mode = false;
+        cmdbuf.setProvokingVertexModeEXT(provoking_vertex_mode);
+    }
 }
 
 } // namespace Vulkan
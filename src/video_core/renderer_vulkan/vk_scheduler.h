@@ -4,13 +4,21 @@
 #pragma once
 
 #include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <span>
 #include <thread>
 #include <queue>
+#include <vector>
+#include <fmt/format.h>
 
+#include "common/thread_worker.h"
 #include "common/unique_function.h"
 #include "video_core/amdgpu/regs_color.h"
 #include "video_core/amdgpu/regs_primitive.h"
+#include "video_core/renderer_vulkan/vk_gpu_profiler.h"
 #include "video_core/renderer_vulkan/vk_master_semaphore.h"
 #include "video_core/renderer_vulkan/vk_resource_pool.h"
 
@@ -49,14 +57,17 @@ struct RenderState {
 struct SubmitInfo {
     std::array<vk::Semaphore, 3> wait_semas;
     std::array<u64, 3> wait_ticks;
+    std::array<vk::PipelineStageFlags, 3> wait_stages;
     std::array<vk::Semaphore, 3> signal_semas;
     std::array<u64, 3> signal_ticks;
     vk::Fence fence;
     u32 num_wait_semas;
     u32 num_signal_semas;
 
-    void AddWait(vk::Semaphore semaphore, u64 tick = 1) {
+    void AddWait(vk::Semaphore semaphore, u64 tick = 1,
+                 vk::PipelineStageFlags stage = vk::PipelineStageFlagBits::eAllCommands) {
         wait_semas[num_wait_semas] = semaphore;
+        wait_stages[num_wait_semas] = stage;
         wait_ticks[num_wait_semas++] = tick;
     }
 
@@ -73,6 +84,8 @@ struct SubmitInfo {
 using Viewports = boost::container::static_vector<vk::Viewport, AmdGpu::NUM_VIEWPORTS>;
 using Scissors = boost::container::static_vector<vk::Rect2D, AmdGpu::NUM_VIEWPORTS>;
 using ColorWriteMasks = std::array<vk::ColorComponentFlags, AmdGpu::NUM_COLOR_BUFFERS>;
+using BlendEnables = std::array<vk::Bool32, AmdGpu::NUM_COLOR_BUFFERS>;
+using BlendEquations = std::array<vk::ColorBlendEquationEXT, AmdGpu::NUM_COLOR_BUFFERS>;
 struct StencilOps {
     vk::StencilOp fail_op{};
     vk::StencilOp pass_op{};
@@ -118,6 +131,18 @@ struct DynamicState {
         bool color_write_masks : 1;
         bool line_width : 1;
         bool feedback_loop_enabled : 1;
+
+        bool polygon_mode : 1;
+        bool depth_clamp_enabled : 1;
+        bool depth_clip_enabled : 1;
+        bool blend_enables : 1;
+        bool blend_equations : 1;
+        bool logic_op_enabled : 1;
+        bool logic_op : 1;
+        bool provoking_vertex_mode : 1;
+
+        bool descriptor_buffer : 1; ///< Not part of Commit, the descriptor buffer binds it
+        bool vertex_input : 1;      ///< Not part of Commit, the buffer cache sets it
     } dirty_state{};
 
     Viewports viewports{};
@@ -156,9 +181,35 @@ struct DynamicState {
     float line_width{};
     bool feedback_loop_enabled{};
 
+    vk::PolygonMode polygon_mode{};
+    bool depth_clamp_enabled{};
+    bool depth_clip_enabled{};
+    BlendEnables blend_enables{};
+    BlendEquations blend_equations{};
+    bool logic_op_enabled{};
+    vk::LogicOp logic_op{};
+    vk::ProvokingVertexModeEXT provoking_vertex_mode{};
+    u64 vertex_input_hash{};
+
     /// Commits the dynamic state to the provided command buffer.
     void Commit(const Instance& instance, const vk::CommandBuffer& cmdbuf);
 
+    /// Returns true once per command buffer, when the descriptor buffer has to be bound again.
+    bool TakeDescriptorBufferBinding() {
+        const bool needs_binding = dirty_state.descriptor_buffer;
+        dirty_state.descriptor_buffer = false;
+        return needs_binding;
+    }
+
+    /// Returns true when the vertex input has to be set, because its hash differs from the last
+    /// one set or this is the first draw of the command buffer.
+    bool TakeVertexInput(u64 hash) {
+        const bool needs_update = dirty_state.vertex_input || vertex_input_hash != hash;
+        dirty_state.vertex_input = false;
+        vertex_input_hash = hash;
+        return needs_update;
+    }
+
     /// Invalidates all dynamic state to be flushed into the next command buffer.
     void Invalidate() {
         std::memset(&dirty_state, 0xFF, sizeof(dirty_state));
@@ -337,11 +388,69 @@ struct DynamicState {
             dirty_state.feedback_loop_enabled = true;
         }
     }
+
+    void SetPolygonMode(const vk::PolygonMode mode) {
+        if (polygon_mode != mode) {
+            polygon_mode = mode;
+            dirty_state.polygon_mode = true;
+        }
+    }
+
+    void SetDepthClampEnabled(const bool enabled) {
+        if (depth_clamp_enabled != enabled) {
+            depth_clamp_enabled = enabled;
+            dirty_state.depth_clamp_enabled = true;
+        }
+    }
+
+    void SetDepthClipEnabled(const bool enabled) {
+        if (depth_clip_enabled != enabled) {
+            depth_clip_enabled = enabled;
+            dirty_state.depth_clip_enabled = true;
+        }
+    }
+
+    void SetBlendEnables(const BlendEnables& blend_enables_) {
+        if (blend_enables != blend_enables_) {
+            blend_enables = blend_enables_;
+            dirty_state.blend_enables = true;
+        }
+    }
+
+    void SetBlendEquations(const BlendEquations& blend_equations_) {
+        if (blend_equations != blend_equations_) {
+            blend_equations = blend_equations_;
+            dirty_state.blend_equations = true;
+        }
+    }
+
+    void SetLogicOpEnabled(const bool enabled) {
+        if (logic_op_enabled != enabled) {
+            logic_op_enabled = enabled;
+            dirty_state.logic_op_enabled = true;
+        }
+    }
+
+    void SetLogicOp(const vk::LogicOp logic_op_) {
+        if (logic_op != logic_op_) {
+            logic_op = logic_op_;
+            dirty_state.logic_op = true;
+        }
+    }
+
+    void SetProvokingVertexMode(const vk::ProvokingVertexModeEXT mode) {
+        if (provoking_vertex_mode != mode) {
+            provoking_vertex_mode = mode;
+            dirty_state.provoking_vertex_mode = true;
+        }
+    }
 };
 
 class Scheduler {
 public:
+    /// Creates a scheduler submitting to the graphics queue.
     explicit Scheduler(const Instance& instance);
+    explicit Scheduler(const Instance& instance, vk::Queue queue, u32 queue_family_index);
     ~Scheduler();
 
     /// Sends the current execution context to the GPU
@@ -358,15 +467,35 @@ public:
     /// Waits for the given tick to trigger on the GPU.
     void Wait(u64 tick);
 
+    /// Makes the next submission wait on the GPU for a tick of a scheduler on another queue.
+    void WaitOn(Scheduler& other, u64 tick);
+
     /// Attempts to execute operations whose tick the GPU has caught up with.
     void PopPendingOperations();
 
+    /// Queues memory binds of a sparse image. They are executed once the work submitted so far
+    /// is done and before the next submission, which waits for them. Thread safe.
+    void BindSparse(vk::Image image, std::vector<vk::SparseImageMemoryBind>&& binds,
+                    std::vector<vk::SparseMemoryBind>&& opaque_binds);
+
     /// Starts a new rendering scope with provided state.
     void BeginRendering(const RenderState& new_state);
 
     /// Ends current rendering scope.
     void EndRendering();
 
+    /// Sets a function run before the rendering scope ends, to record work deferred by the
+    /// caller while it is still inside it.
+    void SetEndRenderingCallback(Common::UniqueFunction<void>&& func) {
+        end_rendering_callback = std::move(func);
+    }
+
+    /// Sets a function run before the command buffer is submitted, to end the work recorded by
+    /// the caller that can't span command buffers.
+    void SetSubmitCallback(Common::UniqueFunction<void>&& func) {
+        submit_callback = std::move(func);
+    }
+
     /// Returns the current render state.
     const RenderState& GetRenderState() const {
         return render_state;
@@ -378,10 +507,42 @@ public:
     }
 
     /// Returns the current command buffer.
-    vk::CommandBuffer CommandBuffer() const {
+    vk::CommandBuffer CommandBuffer() {
+        if (!parallel_cmdbufs.empty()) {
+            ExecuteParallelCommands();
+        }
         return current_cmdbuf;
     }
 
+    /// Records commands into a secondary command buffer on a worker thread, to be executed at
+    /// this point of the current command buffer. The function receives a command buffer outside
+    /// of any render pass, must not use the scheduler and must set all of the dynamic state it
+    /// relies on. Independent render passes recorded this way are built concurrently.
+    void RecordParallel(Common::UniqueFunction<void, vk::CommandBuffer>&& func);
+
+    /// Returns true when GPU timestamps are written for profiler scopes.
+    [[nodiscard]] bool IsGpuProfiling() const noexcept {
+        return gpu_profiler != nullptr;
+    }
+
+    /// Begins a GPU profiler scope in the current command buffer. The name is only formatted
+    /// while profiling.
+    template <typename... Args>
+    u64 BeginProfilerScope(fmt::format_string<Args...> format, Args&&... args) {
+        if (!gpu_profiler) {
+            return GpuProfiler::InvalidScope;
+        }
+        return gpu_profiler->BeginScope(CommandBuffer(),
+                                        fmt::format(format, std::forward<Args>(args)...));
+    }
+
+    /// Ends a GPU profiler scope returned by BeginProfilerScope.
+    void EndProfilerScope(u64 scope) {
+        if (gpu_profiler) {
+            gpu_profiler->EndScope(CommandBuffer(), scope);
+        }
+    }
+
     /// Returns the current command buffer tick.
     [[nodiscard]] u64 CurrentTick() const noexcept {
         return master_semaphore.CurrentTick();
@@ -417,17 +578,39 @@ public:
         priority_pending_ops_cv.notify_one();
     }
 
+    /// Runs a function on the submit thread once the submissions made so far have been handed to
+    /// the driver, such as presenting an image their semaphores signal.
+    static void QueueSubmitOperation(Common::UniqueFunction<void>&& func);
+
+    /// Waits until the submissions made so far have been handed to the driver.
+    static void WaitForSubmits();
+
     static std::mutex submit_mutex;
 
 private:
     void AllocateWorkerCommandBuffers();
 
+    /// Waits for the parallel recordings and executes them in the order they were requested.
+    void ExecuteParallelCommands();
+
     void SubmitExecution(SubmitInfo& info);
 
+    struct PendingSparseBind {
+        vk::Image image;
+        std::vector<vk::SparseImageMemoryBind> binds;
+        std::vector<vk::SparseMemoryBind> opaque_binds;
+    };
+
+    void SubmitSparseBinds(SubmitInfo& info, std::span<const PendingSparseBind> binds,
+                           u64 last_tick);
+
     void PriorityPendingOpsThread(std::stop_token stoken);
 
 private:
     const Instance& instance;
+    vk::Queue queue;
+    u32 queue_family_index;
+    bool is_graphics;
     MasterSemaphore master_semaphore;
     CommandPool command_pool;
     DynamicState dynamic_state;
@@ -442,8 +625,21 @@ private:
     std::mutex priority_pending_ops_mutex;
     std::condition_variable_any priority_pending_ops_cv;
     std::jthread priority_pending_ops_thread;
+    struct {
+        vk::Semaphore semaphore;
+        u64 tick;
+    } queue_wait{};
+    std::mutex sparse_binds_mutex;
+    std::vector<PendingSparseBind> pending_sparse_binds;
+    MasterSemaphore sparse_semaphore;
+    std::optional<Common::StatefulThreadWorker<std::unique_ptr<CommandPool>>> parallel_workers;
+    std::deque<vk::CommandBuffer> parallel_cmdbufs; ///< Filled in by the workers
     RenderState render_state;
     bool is_rendering = false;
+    std::unique_ptr<GpuProfiler> gpu_profiler;
+    u64 rendering_scope = GpuProfiler::InvalidScope;
+    Common::UniqueFunction<void> end_rendering_callback;
+    Common::UniqueFunction<void> submit_callback;
     tracy::VkCtxScope* profiler_scope{};
 };
 
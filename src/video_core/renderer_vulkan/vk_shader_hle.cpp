@@ -1,6 +1,11 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+#include "core/debug_state.h"
 #include "shader_recompiler/info.h"
 #include "video_core/renderer_vulkan/vk_rasterizer.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
@@ -10,8 +15,6 @@ extern std::unique_ptr<AmdGpu::Liverpool> liverpool;
 
 namespace Vulkan {
 
-static constexpr u64 COPY_SHADER_HASH = 0xfefebf9f;
-
 static bool ExecuteCopyShaderHLE(const Shader::Info& info, const AmdGpu::ComputeProgram& cs_program,
                                  Rasterizer& rasterizer) {
     auto& scheduler = rasterizer.GetScheduler();
@@ -120,14 +123,61 @@ static bool ExecuteCopyShaderHLE(const Shader::Info& info, const AmdGpu::Compute
     return true;
 }
 
+/// Resources a shader with a known hash must use, so the handler can rely on their layout.
+struct ShaderLayout {
+    u32 min_buffers;
+    u32 num_images;
+    u32 written_buffer; ///< Index of the only buffer that is written
+};
+
+/// A well known compute kernel that is replaced by transfer commands.
+struct ShaderSignature {
+    std::string_view name;
+    u64 hash;
+    ShaderLayout layout;
+    bool (*execute)(const Shader::Info& info, const AmdGpu::ComputeProgram& cs_program,
+                    Rasterizer& rasterizer);
+};
+
+static constexpr std::array ShaderSignatures = {
+    ShaderSignature{
+        .name = "BufferCopy",
+        .hash = 0xfefebf9f,
+        .layout = {.min_buffers = 3, .num_images = 0, .written_buffer = 2},
+        .execute = ExecuteCopyShaderHLE,
+    },
+};
+
+static bool MatchesLayout(const Shader::Info& info, const ShaderLayout& layout) {
+    if (info.buffers.size() < layout.min_buffers || info.images.size() != layout.num_images) {
+        return false;
+    }
+    for (u32 i = 0; i < layout.min_buffers; ++i) {
+        if (info.buffers[i].is_written != (i == layout.written_buffer)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool ExecuteShaderHLE(const Shader::Info& info, const AmdGpu::Regs& regs,
                       const AmdGpu::ComputeProgram& cs_program, Rasterizer& rasterizer) {
-    switch (info.pgm_hash) {
-    case COPY_SHADER_HASH:
-        return ExecuteCopyShaderHLE(info, cs_program, rasterizer);
-    default:
+    const auto it = std::ranges::find(ShaderSignatures, info.pgm_hash, &ShaderSignature::hash);
+    if (it == ShaderSignatures.end()) {
+        return false;
+    }
+    // Hashes only cover the code, a different shader with the same hash is run as is
+    if (!MatchesLayout(info, it->layout)) {
+        LOG_DEBUG(Render_Vulkan, "Shader {:#x} has the hash of {} but not its resources",
+                  info.pgm_hash, it->name);
+        DebugState.shader_hle_mismatches.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
+    if (!it->execute(info, cs_program, rasterizer)) {
+        return false;
+    }
+    DebugState.shader_hle_dispatches.fetch_add(1, std::memory_order_relaxed);
+    return true;
 }
 
 } // namespace Vulkan
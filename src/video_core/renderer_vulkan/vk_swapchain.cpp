@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <utility>
 #include "common/assert.h"
 #include "common/config.h"
 #include "common/logging/log.h"
@@ -10,6 +11,7 @@
 #include "sdl_window.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_swapchain.h"
+#include "video_core/stall_tracker.h"
 
 namespace Vulkan {
 
@@ -36,8 +38,7 @@ void Swapchain::Create(u32 width_, u32 height_) {
     width = width_;
     height = height_;
     needs_recreation = false;
-
-    Destroy();
+    present_id = 0;
 
     SetSurfaceProperties();
 
@@ -67,12 +68,15 @@ void Swapchain::Create(u32 width_, u32 height_) {
         .compositeAlpha = composite_alpha,
         .presentMode = present_mode,
         .clipped = true,
-        .oldSwapchain = nullptr,
+        .oldSwapchain = swapchain,
     };
 
+    // The old swapchain is handed over instead of waiting for the device to be idle, it is
+    // retired and destroyed once the new one has taken over the presents
     auto [swapchain_result, chain] = instance.GetDevice().createSwapchainKHR(swapchain_info);
     ASSERT_MSG(swapchain_result == vk::Result::eSuccess, "Failed to create swapchain: {}",
                vk::to_string(swapchain_result));
+    Retire();
     swapchain = chain;
 
     SetupImages();
@@ -90,6 +94,7 @@ void Swapchain::SetHDR(bool hdr) {
         return;
     }
 
+    VideoCore::ScopedStall stall{VideoCore::StallCause::GpuIdle};
     auto result = instance.GetDevice().waitIdle();
     if (result != vk::Result::eSuccess) {
         LOG_WARNING(ImGui, "Failed to wait for Vulkan device idle on mode change: {}",
@@ -128,8 +133,14 @@ bool Swapchain::AcquireNextImage() {
 }
 
 bool Swapchain::Present() {
-
+    const bool tag_present = instance.IsPresentWaitSupported();
+    const u64 next_present_id = present_id + 1;
+    const vk::PresentIdKHR present_id_info = {
+        .swapchainCount = 1,
+        .pPresentIds = &next_present_id,
+    };
     const vk::PresentInfoKHR present_info = {
+        .pNext = tag_present ? &present_id_info : nullptr,
         .waitSemaphoreCount = 1,
         .pWaitSemaphores = &present_ready[image_index],
         .swapchainCount = 1,
@@ -145,11 +156,38 @@ bool Swapchain::Present() {
                    vk::to_string(result));
     }
 
+    if (tag_present) {
+        present_id = next_present_id;
+    }
     frame_index = (frame_index + 1) % image_count;
+    ReleaseRetired();
 
     return !needs_recreation;
 }
 
+bool Swapchain::WaitForPresent(u64 timeout_ns) {
+    if (present_id == 0 || needs_recreation) {
+        return true;
+    }
+    const auto result = instance.GetDevice().waitForPresentKHR(swapchain, present_id, timeout_ns);
+    switch (result) {
+    case vk::Result::eSuccess:
+        return true;
+    case vk::Result::eTimeout:
+        return false;
+    case vk::Result::eSuboptimalKHR:
+    case vk::Result::eErrorSurfaceLostKHR:
+    case vk::Result::eErrorOutOfDateKHR:
+        needs_recreation = true;
+        return true;
+    default:
+        LOG_CRITICAL(Render_Vulkan, "Swapchain present wait returned unknown result {}",
+                     vk::to_string(result));
+        UNREACHABLE();
+        return true;
+    }
+}
+
 void Swapchain::FindPresentFormat() {
     const auto [formats_result, formats] =
         instance.GetPhysicalDevice().getSurfaceFormatsKHR(surface);
@@ -256,26 +294,53 @@ void Swapchain::SetSurfaceProperties() {
 
 void Swapchain::Destroy() {
     vk::Device device = instance.GetDevice();
+    VideoCore::ScopedStall stall{VideoCore::StallCause::GpuIdle};
     const auto wait_result = device.waitIdle();
     if (wait_result != vk::Result::eSuccess) {
         LOG_WARNING(Render_Vulkan, "Failed to wait for device to become idle: {}",
                     vk::to_string(wait_result));
     }
-    if (swapchain) {
-        device.destroySwapchainKHR(swapchain);
+    Retire();
+    for (auto& old : retired) {
+        old.presents_left = 0;
     }
+    ReleaseRetired();
+}
 
-    for (const auto& sem : image_acquired) {
-        device.destroySemaphore(sem);
-    }
-    for (const auto& sem : present_ready) {
-        device.destroySemaphore(sem);
+void Swapchain::Retire() {
+    if (!swapchain) {
+        return;
     }
-
+    RetiredSwapchain old{
+        .swapchain = std::exchange(swapchain, nullptr),
+        .images_view = std::move(images_view),
+        .semaphores = std::move(image_acquired),
+        .presents_left = image_count,
+    };
+    old.semaphores.insert(old.semaphores.end(), present_ready.begin(), present_ready.end());
+    retired.push_back(std::move(old));
+    images_view.clear();
     image_acquired.clear();
     present_ready.clear();
 }
 
+void Swapchain::ReleaseRetired() {
+    const vk::Device device = instance.GetDevice();
+    for (auto& old : retired) {
+        if (old.presents_left > 0 && --old.presents_left > 0) {
+            continue;
+        }
+        for (const auto& view : old.images_view) {
+            device.destroyImageView(view);
+        }
+        for (const auto& sem : old.semaphores) {
+            device.destroySemaphore(sem);
+        }
+        device.destroySwapchainKHR(old.swapchain);
+    }
+    std::erase_if(retired, [](const RetiredSwapchain& old) { return old.presents_left == 0; });
+}
+
 void Swapchain::RefreshSemaphores() {
     const vk::Device device = instance.GetDevice();
     image_acquired.resize(image_count);
@@ -34,6 +34,10 @@ public:
     /// Presents the current image and move to the next one
     bool Present();
 
+    /// Waits until the last present is displayed, or the timeout is reached. Returns true when
+    /// there is no present left in the display queue.
+    bool WaitForPresent(u64 timeout_ns);
+
     vk::SurfaceKHR GetSurface() const {
         return surface;
     }
@@ -74,6 +78,10 @@ public:
         return extent;
     }
 
+    [[nodiscard]] bool NeedsRecreation() const {
+        return needs_recreation;
+    }
+
     [[nodiscard]] vk::Semaphore GetImageAcquiredSemaphore() const {
         return image_acquired[frame_index];
     }
@@ -105,6 +113,13 @@ private:
     /// Destroys current swapchain resources
     void Destroy();
 
+    /// Moves the current swapchain resources to the retired ones, to be destroyed once the
+    /// presents queued to them are done.
+    void Retire();
+
+    /// Destroys the retired swapchains that are no longer used, called after every present.
+    void ReleaseRetired();
+
     /// Performs creation of image views and framebuffers from the swapchain images
     void SetupImages();
 
@@ -112,6 +127,15 @@ private:
     void RefreshSemaphores();
 
 private:
+    /// Swapchain replaced by a newer one. Presents queued to it can still be running, so its
+    /// resources stay alive for as many presents as the new swapchain has images.
+    struct RetiredSwapchain {
+        vk::SwapchainKHR swapchain;
+        std::vector<vk::ImageView> images_view;
+        std::vector<vk::Semaphore> semaphores;
+        u32 presents_left;
+    };
+
     const Instance& instance;
     const Frontend::WindowSDL& window;
     vk::SwapchainKHR swapchain{};
@@ -126,11 +150,13 @@ private:
     std::vector<vk::ImageView> images_view;
     std::vector<vk::Semaphore> image_acquired;
     std::vector<vk::Semaphore> present_ready;
+    std::vector<RetiredSwapchain> retired;
     u32 width = 0;
     u32 height = 0;
     u32 image_count = 0;
     u32 image_index = 0;
     u32 frame_index = 0;
+    u64 present_id = 0; ///< Id of the last present, zero when presents are not tagged
     bool needs_recreation = true;
     bool needs_hdr = false;    // The game requested HDR swapchain
     bool supports_hdr = false; // SC supports HDR output
@@ -0,0 +1,279 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <fmt/format.h>
+
+#include "common/elf_info.h"
+#include "common/io_file.h"
+#include "common/logging/log.h"
+#include "common/path_util.h"
+#include "shader_recompiler/runtime_info.h"
+#include "video_core/stall_tracker.h"
+
+namespace VideoCore {
+
+namespace {
+
+/// Shorter stalls are not worth reporting and would only bury the ones that are
+constexpr u64 MinStallUs = 100;
+
+/// A frame is a hitch when it takes this much longer than the average frame
+constexpr double HitchFactor = 1.5;
+
+constexpr size_t MaxRecentHitches = 64;
+
+/// Stalls kept per frame, a frame stalling more often than this is a hitch either way
+constexpr size_t MaxFrameStalls = 256;
+
+thread_local bool is_render_thread = false;
+thread_local u32 stall_depth = 0;
+
+using OffenderKey = std::tuple<StallCause, u32, u64>;
+
+struct StallState {
+    std::mutex mutex;
+    std::vector<StallEvent> frame_stalls;
+    std::deque<HitchFrame> recent_hitches;
+    std::map<OffenderKey, StallOffender> offenders;
+    std::chrono::steady_clock::time_point last_frame{};
+    double average_frame_us{};
+    u32 frame_num{};
+    u64 num_hitches{};
+};
+
+StallState state;
+
+std::filesystem::path GetHitchPipelinesPath() {
+    const std::string serial{Common::ElfInfo::Instance().GameSerial()};
+    return Common::FS::GetUserPath(Common::FS::PathType::CacheDir) / (serial + ".hitches");
+}
+
+bool IsPipelineStall(StallCause cause) {
+    return cause == StallCause::PipelineCreate || cause == StallCause::PipelineWait;
+}
+
+} // Anonymous namespace
+
+const char* GetStallCauseName(StallCause cause) {
+    switch (cause) {
+    case StallCause::ShaderCompile:
+        return "Shader compile";
+    case StallCause::PipelineCreate:
+        return "Pipeline create";
+    case StallCause::PipelineWait:
+        return "Pipeline wait";
+    case StallCause::SchedulerFinish:
+        return "Scheduler finish";
+    case StallCause::SchedulerWait:
+        return "Scheduler wait";
+    case StallCause::StreamBufferWait:
+        return "Stream buffer wait";
+    case StallCause::Readback:
+        return "Readback";
+    case StallCause::GpuIdle:
+        return "GPU idle wait";
+    default:
+        return "Unknown";
+    }
+}
+
+std::string GetStallName(const StallEvent& stall) {
+    if (stall.cause == StallCause::ShaderCompile) {
+        return fmt::format("{}_{:#018x}", static_cast<Shader::Stage>(stall.stage), stall.key);
+    }
+    if (IsPipelineStall(stall.cause)) {
+        // Same names as the pipeline keys in the cache storage
+        return fmt::format("{}_{:#018x}", stall.stage != 0 ? 'c' : 'g', stall.key);
+    }
+    return GetStallCauseName(stall.cause);
+}
+
+void MarkRenderThread() {
+    is_render_thread = true;
+}
+
+ScopedStall::ScopedStall(StallCause cause_, u64 key_, u32 stage_)
+    : cause{cause_}, stage{stage_}, key{key_}, is_render_thread{VideoCore::is_render_thread} {
+    if (!is_render_thread) {
+        return;
+    }
+    is_outermost = stall_depth++ == 0;
+    if (is_outermost) {
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+ScopedStall::~ScopedStall() {
+    if (!is_render_thread) {
+        return;
+    }
+    --stall_depth;
+    if (!is_outermost) {
+        return;
+    }
+    const u64 duration_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                std::chrono::steady_clock::now() - start)
+                                .count();
+    if (duration_us < MinStallUs) {
+        return;
+    }
+    std::scoped_lock lock{state.mutex};
+    if (state.frame_stalls.size() < MaxFrameStalls) {
+        state.frame_stalls.push_back({cause, stage, key, duration_us});
+    }
+}
+
+void EndStallFrame() {
+    const auto now = std::chrono::steady_clock::now();
+    std::scoped_lock lock{state.mutex};
+    const u32 frame = state.frame_num++;
+    if (state.last_frame == std::chrono::steady_clock::time_point{}) {
+        state.last_frame = now;
+        state.frame_stalls.clear();
+        return;
+    }
+    const u64 frame_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(now - state.last_frame).count();
+    state.last_frame = now;
+
+    // The budget follows the frame rate the game settles on
+    const double average_us =
+        state.average_frame_us == 0.0 ? static_cast<double>(frame_us) : state.average_frame_us;
+    const u64 budget_us = static_cast<u64>(average_us * HitchFactor);
+    state.average_frame_us = average_us + (static_cast<double>(frame_us) - average_us) / 16.0;
+
+    if (frame_us > budget_us) {
+        ++state.num_hitches;
+        for (const auto& stall : state.frame_stalls) {
+            auto& offender = state.offenders[{stall.cause, stall.stage, stall.key}];
+            offender.stall = stall;
+            ++offender.count;
+            offender.total_us += stall.duration_us;
+            offender.max_us = std::max(offender.max_us, stall.duration_us);
+        }
+        state.recent_hitches.push_front({frame, frame_us, budget_us, state.frame_stalls});
+        if (state.recent_hitches.size() > MaxRecentHitches) {
+            state.recent_hitches.pop_back();
+        }
+    }
+    state.frame_stalls.clear();
+}
+
+std::vector<HitchFrame> GetRecentHitches() {
+    std::scoped_lock lock{state.mutex};
+    return {state.recent_hitches.begin(), state.recent_hitches.end()};
+}
+
+std::vector<StallOffender> GetStallOffenders() {
+    std::vector<StallOffender> offenders;
+    {
+        std::scoped_lock lock{state.mutex};
+        offenders.reserve(state.offenders.size());
+        for (const auto& [_, offender] : state.offenders) {
+            offenders.push_back(offender);
+        }
+    }
+    std::ranges::sort(offenders, std::greater{}, &StallOffender::total_us);
+    return offenders;
+}
+
+std::pair<u64, u64> GetHitchCounts() {
+    std::scoped_lock lock{state.mutex};
+    return {state.num_hitches, state.frame_num};
+}
+
+bool SaveHitchReport() {
+    using namespace Common::FS;
+    const auto offenders = GetStallOffenders();
+    const auto hitches = GetRecentHitches();
+    const auto [num_hitches, num_frames] = GetHitchCounts();
+    const std::string serial{Common::ElfInfo::Instance().GameSerial()};
+
+    const auto report_path = GetUserPath(PathType::LogDir) / fmt::format("{}_hitches.txt", serial);
+    IOFile report{report_path, FileAccessMode::Write, FileType::TextFile};
+    if (!report.IsOpen()) {
+        LOG_ERROR(Render, "Failed to open {} for writing", report_path.string());
+        return false;
+    }
+    report.WriteString(
+        fmt::format("Hitch report of {}, {} hitches in {} frames\n\n", serial, num_hitches,
+                    num_frames));
+    report.WriteString(fmt::format("{:<20} {:<22} {:>8} {:>12} {:>10}\n", "Cause", "Name",
+                                   "Count", "Total ms", "Max ms"));
+    for (const auto& offender : offenders) {
+        report.WriteString(fmt::format("{:<20} {:<22} {:>8} {:>12.2f} {:>10.2f}\n",
+                                       GetStallCauseName(offender.stall.cause),
+                                       GetStallName(offender.stall), offender.count,
+                                       offender.total_us / 1000.0, offender.max_us / 1000.0));
+    }
+    report.WriteString(std::string_view{"\nRecent hitches\n"});
+    for (const auto& hitch : hitches) {
+        report.WriteString(fmt::format("Frame {}: {:.2f} ms, budget {:.2f} ms{}\n", hitch.frame,
+                                       hitch.frame_us / 1000.0, hitch.budget_us / 1000.0,
+                                       hitch.stalls.empty() ? ", no render stalls" : ""));
+        for (const auto& stall : hitch.stalls) {
+            report.WriteString(fmt::format("    {:<20} {:<22} {:.2f} ms\n",
+                                           GetStallCauseName(stall.cause), GetStallName(stall),
+                                           stall.duration_us / 1000.0));
+        }
+    }
+
+    // Pipelines already listed by earlier runs stay in the list, after the ones of this run
+    std::vector<std::string> pipelines;
+    for (const auto& offender : offenders) {
+        if (IsPipelineStall(offender.stall.cause)) {
+            pipelines.push_back(GetStallName(offender.stall));
+        }
+    }
+    for (auto& name : LoadHitchPipelines()) {
+        if (std::ranges::find(pipelines, name) == pipelines.end()) {
+            pipelines.push_back(std::move(name));
+        }
+    }
+    const auto pipelines_path = GetHitchPipelinesPath();
+    IOFile list{pipelines_path, FileAccessMode::Write, FileType::TextFile};
+    if (!list.IsOpen()) {
+        LOG_ERROR(Render, "Failed to open {} for writing", pipelines_path.string());
+        return false;
+    }
+    for (const auto& name : pipelines) {
+        list.WriteString(fmt::format("{}\n", name));
+    }
+    LOG_INFO(Render, "Saved hitch report to {}, {} pipelines to build first to {}",
+             report_path.string(), pipelines.size(), pipelines_path.string());
+    return true;
+}
+
+std::vector<std::string> LoadHitchPipelines() {
+    using namespace Common::FS;
+    std::vector<std::string> pipelines;
+    const IOFile file{GetHitchPipelinesPath(), FileAccessMode::Read, FileType::TextFile};
+    if (!file.IsOpen()) {
+        return pipelines;
+    }
+    std::string data(file.GetSize(), '\0');
+    if (file.ReadRaw<char>(data.data(), data.size()) != data.size()) {
+        return pipelines;
+    }
+    size_t begin = 0;
+    while (begin < data.size()) {
+        size_t end = data.find('\n', begin);
+        end = end == std::string::npos ? data.size() : end;
+        std::string_view line{data.data() + begin, end - begin};
+        if (line.ends_with('\r')) {
+            line.remove_suffix(1);
+        }
+        if (!line.empty()) {
+            pipelines.emplace_back(line);
+        }
+        begin = end + 1;
+    }
+    return pipelines;
+}
+
+} // namespace VideoCore
@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/types.h"
+
+namespace VideoCore {
+
+/// Why the render path blocked.
+enum class StallCause : u32 {
+    ShaderCompile,
+    PipelineCreate,
+    PipelineWait,
+    SchedulerFinish,
+    SchedulerWait,
+    StreamBufferWait,
+    Readback,
+    GpuIdle,
+    Count,
+};
+
+[[nodiscard]] const char* GetStallCauseName(StallCause cause);
+
+struct StallEvent {
+    StallCause cause;
+    u32 stage; ///< Shader stage of compiles, non zero for compute pipelines
+    u64 key;   ///< Hash of the shader or pipeline, 0 when the stall is not caused by one
+    u64 duration_us;
+};
+
+/// Returns the shader name or the pipeline cache storage name of the stall, or the cause.
+[[nodiscard]] std::string GetStallName(const StallEvent& stall);
+
+/// A frame that took longer than its budget, with the stalls of the render path during it.
+struct HitchFrame {
+    u32 frame;
+    u64 frame_us;
+    u64 budget_us;
+    std::vector<StallEvent> stalls;
+};
+
+/// Stalls of one shader or pipeline during hitches, summed up.
+struct StallOffender {
+    StallEvent stall; ///< Duration is unused
+    u64 count;
+    u64 total_us;
+    u64 max_us;
+};
+
+/// Marks the calling thread as part of the render path. Stalls of other threads are not recorded.
+void MarkRenderThread();
+
+/**
+ * Records the time spent in its scope as a stall of the current frame when it is long enough.
+ * Scopes nested in another stall are part of the outer one.
+ */
+class ScopedStall {
+public:
+    explicit ScopedStall(StallCause cause, u64 key = 0, u32 stage = 0);
+    ~ScopedStall();
+
+    ScopedStall(const ScopedStall&) = delete;
+    ScopedStall& operator=(const ScopedStall&) = delete;
+
+private:
+    std::chrono::steady_clock::time_point start;
+    StallCause cause;
+    u32 stage;
+    u64 key;
+    bool is_render_thread;
+    bool is_outermost{};
+};
+
+/// Closes the current frame, called once per flip. Frames over budget are kept as hitches.
+void EndStallFrame();
+
+/// Returns the latest hitches, the most recent first.
+[[nodiscard]] std::vector<HitchFrame> GetRecentHitches();
+
+/// Returns what stalled during hitches since startup, the largest total first.
+[[nodiscard]] std::vector<StallOffender> GetStallOffenders();
+
+/// Returns the number of hitches and of frames since startup.
+[[nodiscard]] std::pair<u64, u64> GetHitchCounts();
+
+/**
+ * Writes the hitch report of the game to the log directory. The pipelines that stalled are also
+ * written next to the pipeline cache, where the warm-up of later runs builds them first.
+ */
+bool SaveHitchReport();
+
+/// Returns the storage names of the pipelines that stalled in an earlier run, the worst first.
+[[nodiscard]] std::vector<std::string> LoadHitchPipelines();
+
+} // namespace VideoCore
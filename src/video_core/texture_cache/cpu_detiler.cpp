@@ -0,0 +1,318 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#include "common/assert.h"
+#include "video_core/texture_cache/cpu_detiler.h"
+#include "video_core/texture_cache/image_info.h"
+
+namespace VideoCore {
+
+using AmdGpu::ArrayMode;
+using AmdGpu::MicroTileMode;
+using AmdGpu::PipeConfig;
+
+static constexpr u32 MicroTileWidth = 8;
+static constexpr u32 MicroTileHeight = 8;
+static constexpr u32 NumPipeInterleaveBits = 8;
+
+static constexpr u32 Bit(u32 value, u32 bit) {
+    return (value >> bit) & 1;
+}
+
+CpuDetiler::CpuDetiler(const ImageInfo& info_)
+    : info{info_}, array_mode{info.array_mode},
+      micro_tile_mode{AmdGpu::GetMicroTileMode(info.tile_mode)}, bpp{info.num_bits / 8},
+      thickness{AmdGpu::GetMicroTileThickness(array_mode)},
+      micro_tile_bytes{MicroTileWidth * MicroTileHeight * thickness * bpp} {
+    ASSERT(IsSupported(info));
+    if (AmdGpu::IsMacroTiled(array_mode)) {
+        const auto macro_tile_mode =
+            AmdGpu::CalculateMacrotileMode(info.tile_mode, info.num_bits, info.num_samples);
+        pipe_config = AmdGpu::GetPipeConfig(info.tile_mode);
+        num_pipes = pipe_config == PipeConfig::P2 ? 2 : 8;
+        num_pipe_bits = pipe_config == PipeConfig::P2 ? 1 : 3;
+        bank_width = AmdGpu::GetBankWidth(macro_tile_mode);
+        bank_height = AmdGpu::GetBankHeight(macro_tile_mode);
+        num_banks = AmdGpu::GetNumBanks(macro_tile_mode);
+        num_bank_bits = std::bit_width(num_banks) - 1;
+        tile_split_bytes = AmdGpu::CalculateTileSplit(info.tile_mode, array_mode, micro_tile_mode,
+                                                      info.num_bits);
+        macro_tile_aspect = AmdGpu::GetMacrotileAspect(macro_tile_mode);
+    }
+    // The low bits of the pixel index are x bits for a few texels of a row in every micro tile
+    // mode, those texels are next to each other in both layouts.
+    while (run_texels < MicroTileWidth && PixelIndex(run_texels, 0, 0) == run_texels) {
+        run_texels *= 2;
+    }
+}
+
+bool CpuDetiler::IsSupported(const ImageInfo& info) {
+    if (!info.props.is_tiled || info.num_samples != 1) {
+        return false;
+    }
+    if (info.num_bits != 8 && info.num_bits != 16 && info.num_bits != 32 && info.num_bits != 64 &&
+        info.num_bits != 128) {
+        return false;
+    }
+    // Partially resident surfaces may have unmapped pages that are not safe to read directly.
+    return info.array_mode != ArrayMode::ArrayLinearGeneral &&
+           info.array_mode != ArrayMode::ArrayLinearAligned && !AmdGpu::IsPrt(info.array_mode);
+}
+
+u32 CpuDetiler::PixelIndex(u32 x, u32 y, u32 z) const {
+    const u32 x0 = Bit(x, 0), x1 = Bit(x, 1), x2 = Bit(x, 2);
+    const u32 y0 = Bit(y, 0), y1 = Bit(y, 1), y2 = Bit(y, 2);
+    const u32 z0 = Bit(z, 0), z1 = Bit(z, 1), z2 = Bit(z, 2);
+    std::array<u32, 9> p{};
+
+    switch (micro_tile_mode) {
+    case MicroTileMode::Display:
+        switch (bpp) {
+        case 1:
+            p = {x0, x1, x2, y1, y0, y2};
+            break;
+        case 2:
+            p = {x0, x1, x2, y0, y1, y2};
+            break;
+        case 4:
+            p = {x0, x1, y0, x2, y1, y2};
+            break;
+        case 8:
+            p = {x0, y0, x1, x2, y1, y2};
+            break;
+        default:
+            p = {y0, x0, x1, x2, y1, y2};
+            break;
+        }
+        break;
+    case MicroTileMode::Thin:
+    case MicroTileMode::Depth:
+        p = {x0, y0, x1, y1, x2, y2};
+        break;
+    default:
+        if (bpp <= 2) {
+            p = {x0, y0, x1, y1, z0, z1};
+        } else if (bpp == 4) {
+            p = {x0, y0, x1, z0, y1, z1};
+        } else {
+            p = {x0, y0, z0, x1, y1, z1};
+        }
+        p[6] = x2;
+        p[7] = y2;
+        p[8] = thickness == 8 ? z2 : 0;
+        break;
+    }
+
+    u32 pixel_number = 0;
+    for (u32 i = 0; i < p.size(); ++i) {
+        pixel_number |= p[i] << i;
+    }
+    return pixel_number;
+}
+
+u32 CpuDetiler::MicroTiledOffset(u32 x, u32 y, u32 slice, u32 pitch, u32 height) const {
+    const u32 slice_bytes = pitch * height * thickness * bpp;
+    const u32 micro_tiles_per_row = pitch / MicroTileWidth;
+    const u32 micro_tile_index_x = x / MicroTileWidth;
+    const u32 micro_tile_index_y = y / MicroTileHeight;
+    const u32 micro_tile_index_z = slice / thickness;
+
+    const u32 slice_offset = micro_tile_index_z * slice_bytes;
+    const u32 micro_tile_offset =
+        (micro_tile_index_y * micro_tiles_per_row + micro_tile_index_x) * micro_tile_bytes;
+    return slice_offset + micro_tile_offset + PixelIndex(x, y, slice) * bpp;
+}
+
+u32 CpuDetiler::PipeFromCoord(u32 x, u32 y, u32 slice) const {
+    const u32 tx = x / MicroTileWidth;
+    const u32 ty = y / MicroTileHeight;
+    const u32 x3 = Bit(tx, 0), x4 = Bit(tx, 1), x5 = Bit(tx, 2);
+    const u32 y3 = Bit(ty, 0), y4 = Bit(ty, 1), y5 = Bit(ty, 2);
+
+    u32 pipe = 0;
+    switch (pipe_config) {
+    case PipeConfig::P2:
+        pipe = x3 ^ y3;
+        break;
+    case PipeConfig::P8_32x32_8x16:
+        pipe = (x4 ^ y3 ^ x5) | ((x3 ^ y4) << 1) | ((x5 ^ y5) << 2);
+        break;
+    case PipeConfig::P8_32x32_16x16:
+        pipe = (x3 ^ y3 ^ x4) | ((x4 ^ y4) << 1) | ((x5 ^ y5) << 2);
+        break;
+    default:
+        break;
+    }
+
+    u32 pipe_swizzle = 0;
+    if (array_mode == ArrayMode::Array3DTiledThin1 || array_mode == ArrayMode::Array3DTiledThick ||
+        array_mode == ArrayMode::Array3DTiledXThick) {
+        pipe_swizzle += std::max(1U, num_pipes / 2 - 1) * (slice / thickness);
+    }
+    pipe_swizzle &= num_pipes - 1;
+    return pipe ^ pipe_swizzle;
+}
+
+u32 CpuDetiler::BankFromCoord(u32 x, u32 y, u32 slice, u32 tile_split_slice) const {
+    const u32 tx = x / MicroTileWidth / (bank_width * num_pipes);
+    const u32 ty = y / MicroTileHeight / bank_height;
+    const u32 x3 = Bit(tx, 0), x4 = Bit(tx, 1), x5 = Bit(tx, 2), x6 = Bit(tx, 3);
+    const u32 y3 = Bit(ty, 0), y4 = Bit(ty, 1), y5 = Bit(ty, 2), y6 = Bit(ty, 3);
+
+    u32 bank = 0;
+    switch (num_banks) {
+    case 16:
+        bank = (x3 ^ y6) | ((x4 ^ y5 ^ y6) << 1) | ((x5 ^ y4) << 2) | ((x6 ^ y3) << 3);
+        break;
+    case 8:
+        bank = (x3 ^ y5) | ((x4 ^ y4 ^ y5) << 1) | ((x5 ^ y3) << 2);
+        break;
+    case 4:
+        bank = (x3 ^ y4) | ((x4 ^ y3) << 1);
+        break;
+    case 2:
+        bank = x3 ^ y3;
+        break;
+    default:
+        break;
+    }
+
+    u32 slice_rotation = 0;
+    u32 tile_split_rotation = 0;
+    switch (array_mode) {
+    case ArrayMode::Array2DTiledThin1:
+    case ArrayMode::Array2DTiledThick:
+    case ArrayMode::Array2DTiledXThick:
+        slice_rotation = (num_banks / 2 - 1) * (slice / thickness);
+        break;
+    case ArrayMode::Array3DTiledThin1:
+    case ArrayMode::Array3DTiledThick:
+    case ArrayMode::Array3DTiledXThick:
+        slice_rotation = std::max(1U, num_pipes / 2 - 1) * (slice / thickness) / num_pipes;
+        break;
+    default:
+        break;
+    }
+    if (array_mode == ArrayMode::Array2DTiledThin1 || array_mode == ArrayMode::Array3DTiledThin1) {
+        tile_split_rotation = (num_banks / 2 + 1) * tile_split_slice;
+    }
+
+    bank ^= info.bank_swizzle + slice_rotation;
+    bank ^= tile_split_rotation;
+    return bank & (num_banks - 1);
+}
+
+u32 CpuDetiler::MacroTiledOffset(u32 x, u32 y, u32 slice, u32 pitch, u32 height) const {
+    u32 element_offset = PixelIndex(x, y, slice) * bpp;
+    u32 tile_bytes = micro_tile_bytes;
+    u32 slices_per_tile = 1;
+    u32 tile_split_slice = 0;
+    if (tile_bytes > tile_split_bytes && thickness == 1) {
+        slices_per_tile = tile_bytes / tile_split_bytes;
+        tile_split_slice = element_offset / tile_split_bytes;
+        element_offset %= tile_split_bytes;
+        tile_bytes = tile_split_bytes;
+    }
+
+    const u32 macro_tile_pitch = MicroTileWidth * bank_width * num_pipes * macro_tile_aspect;
+    const u32 macro_tile_height = MicroTileHeight * bank_height * num_banks / macro_tile_aspect;
+    const u32 macro_tile_bytes = tile_bytes * (macro_tile_pitch / MicroTileWidth) *
+                                 (macro_tile_height / MicroTileHeight) / (num_pipes * num_banks);
+
+    const u32 macro_tiles_per_row = pitch / macro_tile_pitch;
+    const u32 macro_tile_index_x = x / macro_tile_pitch;
+    const u32 macro_tile_index_y = y / macro_tile_height;
+    const u32 macro_tile_offset =
+        (macro_tile_index_y * macro_tiles_per_row + macro_tile_index_x) * macro_tile_bytes;
+    const u32 macro_tiles_per_slice = macro_tiles_per_row * (height / macro_tile_height);
+
+    const u32 slice_bytes = macro_tiles_per_slice * macro_tile_bytes;
+    const u32 slice_offset =
+        slice_bytes * (tile_split_slice + slices_per_tile * (slice / thickness));
+
+    const u32 tile_row_index = (y / MicroTileHeight) % bank_height;
+    const u32 tile_column_index = (x / MicroTileWidth / num_pipes) % bank_width;
+    const u32 tile_offset = (tile_row_index * bank_width + tile_column_index) * tile_bytes;
+
+    const u32 total_offset = slice_offset + macro_tile_offset + element_offset + tile_offset;
+    const u32 pipe = PipeFromCoord(x, y, slice);
+    const u32 bank = BankFromCoord(x, y, slice, tile_split_slice);
+
+    const u32 pipe_interleave_offset = total_offset & ((1U << NumPipeInterleaveBits) - 1);
+    const u32 offset = total_offset >> NumPipeInterleaveBits;
+    return pipe_interleave_offset | (pipe << NumPipeInterleaveBits) |
+           (bank << (NumPipeInterleaveBits + num_pipe_bits)) |
+           (offset << (NumPipeInterleaveBits + num_pipe_bits + num_bank_bits));
+}
+
+template <u32 RunBytes>
+void CpuDetiler::DetileMip(const u8* tiled, u32 size, u8* linear, u32 mip) const {
+    const auto& mip_info = info.mips_layout[mip];
+    u32 pitch = mip_info.pitch;
+    u32 height = mip_info.height;
+    if (info.props.is_block) {
+        pitch = std::max((pitch + 3) / 4, 1U);
+        height = std::max((height + 3) / 4, 1U);
+    }
+    const bool is_macro_tiled = AmdGpu::IsMacroTiled(array_mode);
+    const u32 num_texels = mip_info.size / bpp;
+    if (pitch == 0 || height == 0) {
+        return;
+    }
+
+    for (u32 texel = 0, slice = 0; texel < num_texels; ++slice) {
+        for (u32 y = 0; y < height && texel < num_texels; ++y) {
+            for (u32 x = 0; x < pitch && texel < num_texels;) {
+                const u32 tiled_offset =
+                    mip_info.offset + (is_macro_tiled
+                                           ? MacroTiledOffset(x, y, slice, pitch, height)
+                                           : MicroTiledOffset(x, y, slice, pitch, height));
+                const u32 count = std::min({run_texels, pitch - x, num_texels - texel});
+                if (count == run_texels && tiled_offset + RunBytes <= size) {
+                    // Constant size so the copy is a single vector move
+                    std::memcpy(linear, tiled + tiled_offset, RunBytes);
+                } else if (const u32 bytes = count * bpp; tiled_offset + bytes <= size) {
+                    std::memcpy(linear, tiled + tiled_offset, bytes);
+                } else {
+                    std::memset(linear, 0, bytes);
+                }
+                linear += count * bpp;
+                texel += count;
+                x += count;
+            }
+        }
+    }
+}
+
+void CpuDetiler::Detile(const u8* tiled, u32 size, u8* linear) const {
+    const u32 run_bytes = run_texels * bpp;
+    for (u32 mip = 0; mip < info.resources.levels; ++mip) {
+        switch (run_bytes) {
+        case 2:
+            DetileMip<2>(tiled, size, linear, mip);
+            break;
+        case 4:
+            DetileMip<4>(tiled, size, linear, mip);
+            break;
+        case 8:
+            DetileMip<8>(tiled, size, linear, mip);
+            break;
+        case 16:
+            DetileMip<16>(tiled, size, linear, mip);
+            break;
+        case 32:
+            DetileMip<32>(tiled, size, linear, mip);
+            break;
+        default:
+            UNREACHABLE_MSG("Unexpected detiling run of {} bytes", run_bytes);
+        }
+        linear += info.mips_layout[mip].size / bpp * bpp;
+    }
+}
+
+} // namespace VideoCore
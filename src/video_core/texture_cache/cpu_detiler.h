@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "common/types.h"
+#include "video_core/amdgpu/tiling.h"
+
+namespace VideoCore {
+
+struct ImageInfo;
+
+/// Host port of the address math of the tiling compute shader. The guest surface is walked in
+/// linear order and every run of texels that is contiguous in the tiled layout is moved with a
+/// single fixed size copy, so the inner loop compiles down to plain vector loads and stores.
+class CpuDetiler {
+public:
+    explicit CpuDetiler(const ImageInfo& info);
+
+    /// Returns true if the layout of the image is handled by the detiler.
+    [[nodiscard]] static bool IsSupported(const ImageInfo& info);
+
+    /// Writes the linear texels of tiled, which holds size bytes, in the layout the compute
+    /// detiler produces. Texels outside of tiled are zeroed.
+    void Detile(const u8* tiled, u32 size, u8* linear) const;
+
+private:
+    template <u32 RunBytes>
+    void DetileMip(const u8* tiled, u32 size, u8* linear, u32 mip) const;
+
+    u32 PixelIndex(u32 x, u32 y, u32 z) const;
+    u32 MicroTiledOffset(u32 x, u32 y, u32 slice, u32 pitch, u32 height) const;
+    u32 MacroTiledOffset(u32 x, u32 y, u32 slice, u32 pitch, u32 height) const;
+    u32 PipeFromCoord(u32 x, u32 y, u32 slice) const;
+    u32 BankFromCoord(u32 x, u32 y, u32 slice, u32 tile_split_slice) const;
+
+private:
+    const ImageInfo& info;
+    AmdGpu::ArrayMode array_mode;
+    AmdGpu::MicroTileMode micro_tile_mode;
+    AmdGpu::PipeConfig pipe_config{};
+    u32 bpp;
+    u32 thickness;
+    u32 micro_tile_bytes;
+    u32 run_texels{1};
+    u32 num_pipes{};
+    u32 num_pipe_bits{};
+    u32 bank_width{};
+    u32 bank_height{};
+    u32 num_banks{};
+    u32 num_bank_bits{};
+    u32 tile_split_bytes{};
+    u32 macro_tile_aspect{};
+};
+
+} // namespace VideoCore
@@ -5,6 +5,7 @@
 // Copyright © 2015-2023 LunarG, Inc.
 
 #include <unordered_map>
+#include <vector>
 #include "common/enum.h"
 #include "video_core/texture_cache/host_compatibility.h"
 
@@ -217,4 +218,24 @@ bool IsVulkanFormatCompatible(vk::Format base, vk::Format view) {
     return (base_comp & view_comp) == view_comp;
 }
 
+std::span<const vk::Format> GetCompatibleViewFormats(vk::Format base) {
+    static const auto view_formats = [] {
+        std::unordered_map<vk::Format, std::vector<vk::Format>> formats;
+        for (const auto& [base_format, base_comp] : FORMAT_TABLE) {
+            if (base_comp == CompatibilityClass::NONE) {
+                continue;
+            }
+            auto& list = formats[base_format];
+            for (const auto& [view_format, view_comp] : FORMAT_TABLE) {
+                if (view_comp != CompatibilityClass::NONE && (base_comp & view_comp) == view_comp) {
+                    list.push_back(view_format);
+                }
+            }
+        }
+        return formats;
+    }();
+    const auto it = view_formats.find(base);
+    return it != view_formats.end() ? std::span{it->second} : std::span<const vk::Format>{};
+}
+
 } // namespace VideoCore
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <span>
 #include "video_core/renderer_vulkan/vk_common.h"
 
 namespace VideoCore {
@@ -13,4 +14,8 @@ namespace VideoCore {
 /// Returns true if the two formats are compatible according to Vulkan's format compatibility rules
 bool IsVulkanFormatCompatible(vk::Format base, vk::Format view);
 
+/// Returns every format an image of the base format can be viewed with, including the base itself.
+/// The span is empty for formats missing from the compatibility table and stays valid forever.
+std::span<const vk::Format> GetCompatibleViewFormats(vk::Format base);
+
 } // namespace VideoCore
@@ -1,12 +1,16 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <mutex>
 #include <ranges>
+#include <unordered_map>
 #include "common/assert.h"
+#include "core/debug_state.h"
 #include "video_core/renderer_vulkan/liverpool_to_vk.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 #include "video_core/texture_cache/blit_helper.h"
+#include "video_core/texture_cache/host_compatibility.h"
 #include "video_core/texture_cache/image.h"
 
 #include <vk_mem_alloc.h>
@@ -76,9 +80,27 @@ static vk::FormatFeatureFlags2 FormatFeatureFlags(const vk::ImageUsageFlags usag
     return feature_flags;
 }
 
+/// Returns the list of formats a mutable image of the format may be viewed with, so the driver can
+/// keep compression that a bare eMutableFormat disables, or nullptr if there is nothing to list.
+/// Lists are never freed, because the create info kept in UniqueImage points to them.
+static const vk::ImageFormatListCreateInfo* ViewFormatList(vk::Format format) {
+    static std::mutex mutex;
+    static std::unordered_map<vk::Format, vk::ImageFormatListCreateInfo> lists;
+    std::scoped_lock lock{mutex};
+    const auto [it, is_new] = lists.try_emplace(format);
+    if (is_new) {
+        const auto view_formats = GetCompatibleViewFormats(format);
+        it->second.viewFormatCount = static_cast<u32>(view_formats.size());
+        it->second.pViewFormats = view_formats.data();
+    }
+    return it->second.viewFormatCount > 1 ? &it->second : nullptr;
+}
+
 UniqueImage::~UniqueImage() {
-    if (image) {
+    if (image && allocation) {
         vmaDestroyImage(allocator, image, allocation);
+    } else if (image) {
+        device.destroyImage(image);
     }
 }
 
@@ -103,6 +125,15 @@ void UniqueImage::Create(const vk::ImageCreateInfo& image_ci) {
     image = vk::Image{unsafe_image};
 }
 
+void UniqueImage::CreateSparse(const vk::ImageCreateInfo& image_ci) {
+    this->image_ci = image_ci;
+    ASSERT(!image);
+    auto [result, sparse_image] = device.createImage(image_ci);
+    ASSERT_MSG(result == vk::Result::eSuccess, "Failed creating sparse image with error {}",
+               vk::to_string(result));
+    image = sparse_image;
+}
+
 Image::Image(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
              BlitHelper& blit_helper_, Common::SlotVector<ImageView>& slot_image_views_,
              const ImageInfo& info_)
@@ -111,7 +142,6 @@ Image::Image(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
     if (info.pixel_format == vk::Format::eUndefined) {
         return;
     }
-    mip_hashes.resize(info.resources.levels);
     // Here we force `eExtendedUsage` as don't know all image usage cases beforehand. In normal case
     // the texture cache should re-create the resource with the usage requested
     vk::ImageCreateFlags flags{vk::ImageCreateFlagBits::eMutableFormat |
@@ -134,7 +164,15 @@ Image::Image(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
 
     constexpr auto tiling = vk::ImageTiling::eOptimal;
     const auto supported_format = instance->GetSupportedFormat(info.pixel_format, format_features);
+    const bool is_sparse =
+        SparseResidency::IsSupported(*instance, info, supported_format, usage_flags, flags);
+    if (is_sparse) {
+        flags |= vk::ImageCreateFlagBits::eSparseBinding |
+                 vk::ImageCreateFlagBits::eSparseResidency;
+    }
+    const auto* view_format_list = ViewFormatList(supported_format);
     const vk::PhysicalDeviceImageFormatInfo2 format_info{
+        .pNext = view_format_list,
         .format = supported_format,
         .type = ConvertImageType(info.type),
         .tiling = tiling,
@@ -153,6 +191,7 @@ Image::Image(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
                             : vk::SampleCountFlagBits::e1;
 
     const vk::ImageCreateInfo image_ci = {
+        .pNext = view_format_list,
         .flags = flags,
         .imageType = ConvertImageType(info.type),
         .format = supported_format,
@@ -172,7 +211,13 @@ Image::Image(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
     backing = &backing_images.emplace_back();
     backing->num_samples = info.num_samples;
     backing->image = UniqueImage{instance->GetDevice(), instance->GetAllocator()};
-    backing->image.Create(image_ci);
+    if (is_sparse) {
+        backing->image.CreateSparse(image_ci);
+        sparse = std::make_unique<SparseResidency>(*instance, *scheduler, info, GetImage());
+        sparse->Update(info.guest_address, info.guest_size);
+    } else {
+        backing->image.Create(image_ci);
+    }
 
     Vulkan::SetObjectName(instance->GetDevice(), GetImage(),
                           "Image {}x{}x{} {} {} {:#x}:{:#x} L:{} M:{} S:{}", info.size.width,
@@ -202,6 +247,9 @@ ImageView& Image::FindView(const ImageViewInfo& view_info, bool ensure_guest_sam
 Image::Barriers Image::GetBarriers(vk::ImageLayout dst_layout, vk::AccessFlags2 dst_mask,
                                    vk::PipelineStageFlags2 dst_stage,
                                    std::optional<SubresourceRange> subres_range) {
+    if (pending_clear) {
+        ResolvePendingClear();
+    }
     auto& last_state = backing->state;
     auto& subresource_states = backing->subresource_states;
 
@@ -327,46 +375,65 @@ void Image::Transit(vk::ImageLayout dst_layout, vk::AccessFlags2 dst_mask,
 
 void Image::Upload(std::span<const vk::BufferImageCopy> upload_copies, vk::Buffer buffer,
                    u64 offset) {
-    SetBackingSamples(info.num_samples, false);
-    scheduler->EndRendering();
-
-    const vk::BufferMemoryBarrier2 pre_barrier{
-        .srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
-        .srcAccessMask = vk::AccessFlagBits2::eMemoryWrite,
-        .dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
-        .dstAccessMask = vk::AccessFlagBits2::eTransferRead,
+    const ImageUpload upload = {
+        .image = this,
+        .copies = upload_copies,
         .buffer = buffer,
         .offset = offset,
-        .size = info.guest_size,
     };
-    const vk::BufferMemoryBarrier2 post_barrier{
-        .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
-        .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
-        .dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
-        .dstAccessMask = vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite,
-        .buffer = buffer,
-        .offset = offset,
-        .size = info.guest_size,
-    };
-    const auto image_barriers =
-        GetBarriers(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite,
-                    vk::PipelineStageFlagBits2::eCopy, {});
-    const auto cmdbuf = scheduler->CommandBuffer();
+    Upload(*scheduler, {&upload, 1});
+}
+
+void Image::Upload(Vulkan::Scheduler& scheduler, std::span<const ImageUpload> uploads) {
+    scheduler.EndRendering();
+
+    boost::container::small_vector<vk::BufferMemoryBarrier2, 16> pre_barriers;
+    boost::container::small_vector<vk::BufferMemoryBarrier2, 16> post_barriers;
+    Barriers image_barriers;
+    for (const auto& upload : uploads) {
+        Image& image = *upload.image;
+        image.SetBackingSamples(image.info.num_samples, false);
+        pre_barriers.push_back({
+            .srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+            .srcAccessMask = vk::AccessFlagBits2::eMemoryWrite,
+            .dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
+            .dstAccessMask = vk::AccessFlagBits2::eTransferRead,
+            .buffer = upload.buffer,
+            .offset = upload.offset,
+            .size = image.info.guest_size,
+        });
+        post_barriers.push_back({
+            .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+            .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+            .dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+            .dstAccessMask = vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite,
+            .buffer = upload.buffer,
+            .offset = upload.offset,
+            .size = image.info.guest_size,
+        });
+        const auto barriers = image.GetBarriers(vk::ImageLayout::eTransferDstOptimal,
+                                                vk::AccessFlagBits2::eTransferWrite,
+                                                vk::PipelineStageFlagBits2::eCopy, {});
+        image_barriers.insert(image_barriers.end(), barriers.begin(), barriers.end());
+    }
+    const auto cmdbuf = scheduler.CommandBuffer();
     cmdbuf.pipelineBarrier2(vk::DependencyInfo{
         .dependencyFlags = vk::DependencyFlagBits::eByRegion,
-        .bufferMemoryBarrierCount = 1,
-        .pBufferMemoryBarriers = &pre_barrier,
+        .bufferMemoryBarrierCount = static_cast<u32>(pre_barriers.size()),
+        .pBufferMemoryBarriers = pre_barriers.data(),
         .imageMemoryBarrierCount = static_cast<u32>(image_barriers.size()),
         .pImageMemoryBarriers = image_barriers.data(),
     });
-    cmdbuf.copyBufferToImage(buffer, GetImage(), vk::ImageLayout::eTransferDstOptimal,
-                             upload_copies);
+    for (const auto& upload : uploads) {
+        cmdbuf.copyBufferToImage(upload.buffer, upload.image->GetImage(),
+                                 vk::ImageLayout::eTransferDstOptimal, upload.copies);
+        upload.image->flags &= ~ImageFlagBits::Dirty;
+    }
     cmdbuf.pipelineBarrier2(vk::DependencyInfo{
         .dependencyFlags = vk::DependencyFlagBits::eByRegion,
-        .bufferMemoryBarrierCount = 1,
-        .pBufferMemoryBarriers = &post_barrier,
+        .bufferMemoryBarrierCount = static_cast<u32>(post_barriers.size()),
+        .pBufferMemoryBarriers = post_barriers.data(),
     });
-    flags &= ~ImageFlagBits::Dirty;
 }
 
 void Image::Download(std::span<const vk::BufferImageCopy> download_copies, vk::Buffer buffer,
@@ -698,6 +765,12 @@ void Image::Clear(const vk::ClearValue& clear_value, const VideoCore::Subresourc
                            vk_range);
 }
 
+void Image::ResolvePendingClear() {
+    const auto clear = *std::exchange(pending_clear, std::nullopt);
+    Clear(clear.value, clear.range);
+    DebugState.fast_clears_resolved.fetch_add(1, std::memory_order_relaxed);
+}
+
 void Image::SetBackingSamples(u32 num_samples, bool copy_backing) {
     if (!backing || backing->num_samples == num_samples) {
         return;
@@ -708,6 +781,9 @@ void Image::SetBackingSamples(u32 num_samples, bool copy_backing) {
     if (it == backing_images.end()) {
         auto new_image_ci = backing->image.image_ci;
         new_image_ci.samples = LiverpoolToVK::NumSamples(num_samples, supported_samples);
+        // Multisampled backings of partially resident images are fully resident.
+        new_image_ci.flags &= ~(vk::ImageCreateFlagBits::eSparseBinding |
+                                vk::ImageCreateFlagBits::eSparseResidency);
 
         new_backing = &backing_images.emplace_back();
         new_backing->num_samples = num_samples;
@@ -8,9 +8,12 @@
 #include "video_core/renderer_vulkan/vk_common.h"
 #include "video_core/texture_cache/image_info.h"
 #include "video_core/texture_cache/image_view.h"
+#include "video_core/texture_cache/sparse_residency.h"
 
 #include <deque>
+#include <memory>
 #include <optional>
+#include <span>
 #include <boost/container/small_vector.hpp>
 #include <boost/container/static_vector.hpp>
 
@@ -46,11 +49,12 @@ struct UniqueImage {
     UniqueImage& operator=(const UniqueImage&) = delete;
 
     UniqueImage(UniqueImage&& other)
-        : allocator{std::exchange(other.allocator, VK_NULL_HANDLE)},
+        : device{other.device}, allocator{std::exchange(other.allocator, VK_NULL_HANDLE)},
           allocation{std::exchange(other.allocation, VK_NULL_HANDLE)},
           image{std::exchange(other.image, VK_NULL_HANDLE)}, image_ci{std::move(other.image_ci)} {}
     UniqueImage& operator=(UniqueImage&& other) {
         image = std::exchange(other.image, VK_NULL_HANDLE);
+        device = other.device;
         allocator = std::exchange(other.allocator, VK_NULL_HANDLE);
         allocation = std::exchange(other.allocation, VK_NULL_HANDLE);
         image_ci = std::move(other.image_ci);
@@ -59,6 +63,9 @@ struct UniqueImage {
 
     void Create(const vk::ImageCreateInfo& image_ci);
 
+    /// Creates a sparse image, its memory is bound by SparseResidency.
+    void CreateSparse(const vk::ImageCreateInfo& image_ci);
+
     operator vk::Image() const {
         return image;
     }
@@ -78,6 +85,15 @@ public:
 constexpr Common::SlotId NULL_IMAGE_ID{0};
 
 class BlitHelper;
+struct Image;
+
+/// Copy of buffer data to an image, one of the uploads recorded together by Image::Upload.
+struct ImageUpload {
+    Image* image;
+    std::span<const vk::BufferImageCopy> copies;
+    vk::Buffer buffer;
+    u64 offset;
+};
 
 struct Image {
     Image(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler, BlitHelper& blit_helper,
@@ -122,6 +138,8 @@ struct Image {
     void Transit(vk::ImageLayout dst_layout, vk::AccessFlags2 dst_mask,
                  std::optional<SubresourceRange> range, vk::CommandBuffer cmdbuf = {});
     void Upload(std::span<const vk::BufferImageCopy> upload_copies, vk::Buffer buffer, u64 offset);
+    /// Records the uploads with a single barrier before and a single barrier after all copies.
+    static void Upload(Vulkan::Scheduler& scheduler, std::span<const ImageUpload> uploads);
     void Download(std::span<const vk::BufferImageCopy> download_copies, vk::Buffer buffer,
                   u64 offset, u64 download_size);
 
@@ -133,6 +151,9 @@ struct Image {
                  const VideoCore::SubresourceRange& mrt1_range);
     void Clear(const vk::ClearValue& clear_value, const VideoCore::SubresourceRange& range);
 
+    /// Records the clear that was deferred to the next render pass on the image.
+    void ResolvePendingClear();
+
     void SetBackingSamples(u32 num_samples, bool copy_backing = true);
 
 public:
@@ -166,10 +187,21 @@ public:
     };
     std::deque<BackingImage> backing_images;
     BackingImage* backing{};
-    boost::container::static_vector<u64, 16> mip_hashes{};
+    std::unique_ptr<SparseResidency> sparse; ///< Set for partially resident images
+    std::vector<u64> page_hashes; ///< Hash of every 4KB of the guest data, for partial reuploads
     u64 lru_id{};
     u64 tick_accessed_last{};
     u64 hash{};
+    u64 content_hash{};
+    u64 replacement_hash{}; ///< Content hash a replacement was last looked up for
+    ImageId replacement_id{};
+    struct PendingClear {
+        vk::ClearValue value;
+        SubresourceRange range;
+    };
+    /// Eliminated fast clear, folded into the load op of the next render pass on the image
+    /// or recorded before any other access
+    std::optional<PendingClear> pending_clear;
 
     struct {
         u32 texture : 1;
@@ -1,6 +1,9 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <cstring>
+#include <xxhash.h>
+
 #include "common/assert.h"
 #include "core/libraries/kernel/process.h"
 #include "core/libraries/videoout/buffer.h"
@@ -117,6 +120,27 @@ ImageInfo::ImageInfo(const AmdGpu::DepthBuffer& buffer, u32 num_slices, VAddr ht
 }
 
 ImageInfo::ImageInfo(const AmdGpu::Image& image, const Shader::ImageResource& desc) noexcept {
+    // Draws mostly bind the textures of the draws before them, their infos are kept by the raw
+    // descriptor to skip translating the format and laying out the mips again.
+    struct CachedInfo {
+        std::array<u64, 4> image;
+        bool is_depth;
+        bool valid;
+        ImageInfo info;
+    };
+    static constexpr size_t NumCachedInfos = 64;
+    static thread_local std::array<CachedInfo, NumCachedInfos> cached_infos{};
+    std::array<u64, 4> raw_image;
+    static_assert(sizeof(raw_image) == sizeof(image));
+    std::memcpy(raw_image.data(), &image, sizeof(image));
+    auto& cached = cached_infos[(XXH3_64bits(raw_image.data(), sizeof(raw_image)) ^
+                                 static_cast<u64>(desc.is_depth)) %
+                                NumCachedInfos];
+    if (cached.valid && cached.image == raw_image && cached.is_depth == desc.is_depth) {
+        *this = cached.info;
+        return;
+    }
+
     tile_mode = image.GetTileMode();
     array_mode = AmdGpu::GetArrayMode(tile_mode);
     pixel_format = LiverpoolToVK::SurfaceFormat(image.GetDataFmt(), image.GetNumberFmt());
@@ -143,6 +167,13 @@ ImageInfo::ImageInfo(const AmdGpu::Image& image, const Shader::ImageResource& de
 
     alt_tile = Libraries::Kernel::sceKernelIsNeoMode() && image.alt_tile_mode;
     UpdateSize();
+
+    cached = {
+        .image = raw_image,
+        .is_depth = desc.is_depth,
+        .valid = true,
+        .info = *this,
+    };
 }
 
 bool ImageInfo::IsCompatible(const ImageInfo& info) const {
@@ -187,10 +218,14 @@ void ImageInfo::UpdateSize() {
             break;
         }
         case AmdGpu::ArrayMode::Array2DTiledThick:
+        case AmdGpu::ArrayMode::ArrayPrtTiledThick:
+        case AmdGpu::ArrayMode::ArrayPrt2DTiledThick:
             thickness = 4;
             mip_d += (-mip_d) & (thickness - 1);
             [[fallthrough]];
-        case AmdGpu::ArrayMode::Array2DTiledThin1: {
+        case AmdGpu::ArrayMode::Array2DTiledThin1:
+        case AmdGpu::ArrayMode::ArrayPrtTiledThin1:
+        case AmdGpu::ArrayMode::ArrayPrt2DTiledThin1: {
             ASSERT(!props.is_block);
             std::tie(mip_info.pitch, mip_info.height, mip_info.size) = ImageSizeMacroTiled(
                 mip_w, mip_h, thickness, num_bits, num_samples, tile_mode, mip, alt_tile);
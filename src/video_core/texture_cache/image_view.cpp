@@ -31,6 +31,11 @@ vk::ImageViewType ConvertImageViewType(AmdGpu::ImageType type) {
     }
 }
 
+static bool IsBlockFormat(vk::Format format) {
+    return (format >= vk::Format::eBc1RgbUnormBlock && format <= vk::Format::eBc7SrgbBlock) ||
+           (format >= vk::Format::eAstc4x4UnormBlock && format <= vk::Format::eAstc12x12SrgbBlock);
+}
+
 bool IsViewTypeCompatible(AmdGpu::ImageType view_type, AmdGpu::ImageType image_type) {
     switch (view_type) {
     case AmdGpu::ImageType::Color1D:
@@ -109,6 +114,9 @@ ImageView::ImageView(const Vulkan::Instance& instance, const ImageViewInfo& info
         format = image.info.pixel_format;
         aspect = vk::ImageAspectFlagBits::eStencil;
     }
+    // Uncompressed views of a compressed image address a single mip level in blocks.
+    const bool is_block_view = image.info.props.is_block && !IsBlockFormat(format);
+    const u32 level_count = is_block_view ? 1U : info.range.extent.levels;
 
     const vk::ImageViewCreateInfo image_view_ci = {
         .pNext = &usage_ci,
@@ -119,7 +127,7 @@ ImageView::ImageView(const Vulkan::Instance& instance, const ImageViewInfo& info
         .subresourceRange{
             .aspectMask = aspect,
             .baseMipLevel = info.range.base.level,
-            .levelCount = info.range.extent.levels,
+            .levelCount = level_count,
             .baseArrayLayer = info.range.base.layer,
             .layerCount = info.range.extent.layers,
         },
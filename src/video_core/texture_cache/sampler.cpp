@@ -8,57 +8,67 @@
 
 namespace VideoCore {
 
-Sampler::Sampler(const Vulkan::Instance& instance, const AmdGpu::Sampler& sampler,
-                 const AmdGpu::BorderColorBuffer border_color_base) {
+SamplerKey::SamplerKey(const Vulkan::Instance& instance, const AmdGpu::Sampler& sampler,
+                       const AmdGpu::BorderColorBuffer border_color_base) {
     using namespace Vulkan;
-    const bool anisotropy_enable = instance.IsAnisotropicFilteringSupported() &&
-                                   (AmdGpu::IsAnisoFilter(sampler.xy_mag_filter) ||
-                                    AmdGpu::IsAnisoFilter(sampler.xy_min_filter));
-    const float max_anisotropy =
-        anisotropy_enable ? std::clamp(sampler.MaxAniso(), 1.0f, instance.MaxSamplerAnisotropy())
-                          : 1.0f;
-    auto border_color = LiverpoolToVK::BorderColor(sampler.border_color_type);
+    const bool anisotropy = instance.IsAnisotropicFilteringSupported() &&
+                            (AmdGpu::IsAnisoFilter(sampler.xy_mag_filter) ||
+                             AmdGpu::IsAnisoFilter(sampler.xy_min_filter));
+    border_color = LiverpoolToVK::BorderColor(sampler.border_color_type);
     if (border_color == vk::BorderColor::eFloatCustomEXT &&
         !instance.IsCustomBorderColorSupported()) {
         LOG_WARNING(Render_Vulkan, "Custom border color is not supported, falling back to black");
         border_color = vk::BorderColor::eFloatOpaqueBlack;
     }
+    custom_border_color = {};
+    if (border_color == vk::BorderColor::eFloatCustomEXT) {
+        const auto border_color_index = sampler.border_color_ptr.Value();
+        const auto border_color_buffer = border_color_base.Address<std::array<float, 4>*>();
+        custom_border_color = border_color_buffer[border_color_index];
+    }
+    mag_filter = LiverpoolToVK::Filter(sampler.xy_mag_filter);
+    min_filter = LiverpoolToVK::Filter(sampler.xy_min_filter);
+    mipmap_mode = LiverpoolToVK::MipFilter(sampler.mip_filter);
+    address_u = LiverpoolToVK::ClampMode(sampler.clamp_x);
+    address_v = LiverpoolToVK::ClampMode(sampler.clamp_y);
+    address_w = LiverpoolToVK::ClampMode(sampler.clamp_z);
+    compare_enable = sampler.depth_compare_func != AmdGpu::DepthCompare::Never;
+    // The compare op is ignored without compare, keep it out of the key
+    compare_op = compare_enable ? LiverpoolToVK::DepthCompare(sampler.depth_compare_func)
+                                : vk::CompareOp::eNever;
+    anisotropy_enable = anisotropy;
+    lod_bias = std::min(sampler.LodBias(), instance.MaxSamplerLodBias());
+    max_anisotropy =
+        anisotropy ? std::clamp(sampler.MaxAniso(), 1.0f, instance.MaxSamplerAnisotropy()) : 1.0f;
+    min_lod = sampler.MinLod();
+    max_lod = sampler.MaxLod();
+}
 
-    const auto custom_color = [&]() -> std::optional<vk::SamplerCustomBorderColorCreateInfoEXT> {
-        if (border_color == vk::BorderColor::eFloatCustomEXT) {
-            const auto border_color_index = sampler.border_color_ptr.Value();
-            const auto border_color_buffer = border_color_base.Address<std::array<float, 4>*>();
-            const auto custom_border_color_array = border_color_buffer[border_color_index];
-
-            const vk::SamplerCustomBorderColorCreateInfoEXT ret{
-                .customBorderColor =
-                    vk::ClearColorValue{
-                        .float32 = custom_border_color_array,
-                    },
-                .format = vk::Format::eR32G32B32A32Sfloat,
-            };
-            return ret;
-        } else {
-            return std::nullopt;
-        }
-    }();
-
+Sampler::Sampler(const Vulkan::Instance& instance, const SamplerKey& key) {
+    const vk::SamplerCustomBorderColorCreateInfoEXT custom_color = {
+        .customBorderColor =
+            vk::ClearColorValue{
+                .float32 = key.custom_border_color,
+            },
+        .format = vk::Format::eR32G32B32A32Sfloat,
+    };
+    const bool is_custom = key.border_color == vk::BorderColor::eFloatCustomEXT;
     const vk::SamplerCreateInfo sampler_ci = {
-        .pNext = custom_color ? &*custom_color : nullptr,
-        .magFilter = LiverpoolToVK::Filter(sampler.xy_mag_filter),
-        .minFilter = LiverpoolToVK::Filter(sampler.xy_min_filter),
-        .mipmapMode = LiverpoolToVK::MipFilter(sampler.mip_filter),
-        .addressModeU = LiverpoolToVK::ClampMode(sampler.clamp_x),
-        .addressModeV = LiverpoolToVK::ClampMode(sampler.clamp_y),
-        .addressModeW = LiverpoolToVK::ClampMode(sampler.clamp_z),
-        .mipLodBias = std::min(sampler.LodBias(), instance.MaxSamplerLodBias()),
-        .anisotropyEnable = anisotropy_enable,
-        .maxAnisotropy = max_anisotropy,
-        .compareEnable = sampler.depth_compare_func != AmdGpu::DepthCompare::Never,
-        .compareOp = LiverpoolToVK::DepthCompare(sampler.depth_compare_func),
-        .minLod = sampler.MinLod(),
-        .maxLod = sampler.MaxLod(),
-        .borderColor = border_color,
+        .pNext = is_custom ? &custom_color : nullptr,
+        .magFilter = key.mag_filter,
+        .minFilter = key.min_filter,
+        .mipmapMode = key.mipmap_mode,
+        .addressModeU = key.address_u,
+        .addressModeV = key.address_v,
+        .addressModeW = key.address_w,
+        .mipLodBias = key.lod_bias,
+        .anisotropyEnable = key.anisotropy_enable,
+        .maxAnisotropy = key.max_anisotropy,
+        .compareEnable = key.compare_enable,
+        .compareOp = key.compare_op,
+        .minLod = key.min_lod,
+        .maxLod = key.max_lod,
+        .borderColor = key.border_color,
         .unnormalizedCoordinates = false, // Handled in shader due to Vulkan limitations.
     };
     auto [sampler_result, smplr] = instance.GetDevice().createSamplerUnique(sampler_ci);
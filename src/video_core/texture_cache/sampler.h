@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <array>
+#include <xxhash.h>
+
 #include "video_core/amdgpu/regs_texture.h"
 #include "video_core/amdgpu/resource.h"
 #include "video_core/renderer_vulkan/vk_common.h"
@@ -13,10 +16,39 @@ class Instance;
 
 namespace VideoCore {
 
+/// Host state of a guest sampler. Register states that only differ in fields the host sampler
+/// ignores, or in values clamped to the device limits, produce the same key.
+struct SamplerKey {
+    vk::Filter mag_filter;
+    vk::Filter min_filter;
+    vk::SamplerMipmapMode mipmap_mode;
+    vk::SamplerAddressMode address_u;
+    vk::SamplerAddressMode address_v;
+    vk::SamplerAddressMode address_w;
+    vk::CompareOp compare_op;
+    vk::BorderColor border_color;
+    u32 anisotropy_enable;
+    u32 compare_enable;
+    float lod_bias;
+    float max_anisotropy;
+    float min_lod;
+    float max_lod;
+    std::array<float, 4> custom_border_color; ///< Zero unless border_color is custom
+
+    explicit SamplerKey(const Vulkan::Instance& instance, const AmdGpu::Sampler& sampler,
+                        const AmdGpu::BorderColorBuffer border_color_base);
+
+    [[nodiscard]] u64 Hash() const noexcept {
+        return XXH3_64bits(this, sizeof(*this));
+    }
+
+    bool operator==(const SamplerKey&) const = default;
+};
+static_assert(sizeof(SamplerKey) == 18 * sizeof(u32), "SamplerKey is hashed bytewise");
+
 class Sampler {
 public:
-    explicit Sampler(const Vulkan::Instance& instance, const AmdGpu::Sampler& sampler,
-                     const AmdGpu::BorderColorBuffer border_color_base);
+    explicit Sampler(const Vulkan::Instance& instance, const SamplerKey& key);
     ~Sampler();
 
     Sampler(const Sampler&) = delete;
@@ -29,6 +61,9 @@ public:
         return *handle;
     }
 
+    size_t lru_id{};
+    u32 heap_slot{}; ///< Slot in the sampler heap when samplers are bindless
+
 private:
     vk::UniqueSampler handle;
 };
@@ -0,0 +1,258 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <utility>
+
+#include "common/assert.h"
+#include "common/config.h"
+#include "common/div_ceil.h"
+#include "core/memory.h"
+#include "video_core/amdgpu/tiling.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/texture_cache/sparse_residency.h"
+
+#include <vk_mem_alloc.h>
+
+namespace VideoCore {
+
+SparseResidency::SparseResidency(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
+                                 const ImageInfo& info_, vk::Image image_)
+    : instance{&instance_}, scheduler{&scheduler_}, info{info_}, image{image_} {
+    const auto device = instance->GetDevice();
+    memory_requirements = device.getImageMemoryRequirements(image);
+    const auto sparse_requirements = device.getImageSparseMemoryRequirements(image);
+    const auto color_requirements =
+        std::ranges::find_if(sparse_requirements, [](const auto& requirements) {
+            return static_cast<bool>(requirements.formatProperties.aspectMask &
+                                     vk::ImageAspectFlagBits::eColor);
+        });
+    ASSERT_MSG(color_requirements != sparse_requirements.end(),
+               "Sparse image without color memory requirements");
+    granularity = color_requirements->formatProperties.imageGranularity;
+    num_tracked_levels = std::min(color_requirements->imageMipTailFirstLod, info.resources.levels);
+
+    std::vector<vk::SparseImageMemoryBind> binds;
+    std::vector<vk::SparseMemoryBind> opaque_binds;
+    const u32 num_layers = info.resources.layers;
+    u32 num_tiles = 0;
+    for (u32 level = 0; level < num_tracked_levels; ++level) {
+        const auto& mip = info.mips_layout[level];
+        Level& tiled_level = levels.emplace_back(Level{
+            .first_tile = num_tiles,
+            .tiles_x = Common::DivCeil(std::max(info.size.width >> level, 1U), granularity.width),
+            .tiles_y = Common::DivCeil(std::max(info.size.height >> level, 1U), granularity.height),
+            .guest_tiles_x = Common::DivCeil(mip.pitch, granularity.width),
+        });
+        const u32 guest_tiles_y = Common::DivCeil(mip.height, granularity.height);
+        tiled_level.tracked =
+            memory_requirements.alignment == TileSize &&
+            tiled_level.guest_tiles_x >= tiled_level.tiles_x &&
+            guest_tiles_y >= tiled_level.tiles_y &&
+            u64{tiled_level.guest_tiles_x} * guest_tiles_y * TileSize == mip.size / num_layers;
+        if (tiled_level.tracked) {
+            num_tiles += tiled_level.tiles_x * tiled_level.tiles_y * num_layers;
+            continue;
+        }
+        // Keep the whole level resident when its tiles do not line up with the guest memory.
+        for (u32 layer = 0; layer < num_layers; ++layer) {
+            for (u32 y = 0; y < tiled_level.tiles_y; ++y) {
+                for (u32 x = 0; x < tiled_level.tiles_x; ++x) {
+                    const VmaAllocation allocation = Allocate(memory_requirements.alignment);
+                    resident_memory.push_back(allocation);
+                    AddBind(binds, level, layer, x, y, allocation);
+                }
+            }
+        }
+    }
+    tiles.resize(num_tiles);
+    for (const auto& requirements : sparse_requirements) {
+        BindMipTail(opaque_binds, requirements);
+    }
+    scheduler->BindSparse(image, std::move(binds), std::move(opaque_binds));
+}
+
+SparseResidency::~SparseResidency() {
+    const auto allocator = instance->GetAllocator();
+    for (const VmaAllocation allocation : tiles) {
+        if (allocation) {
+            vmaFreeMemory(allocator, allocation);
+        }
+    }
+    for (const VmaAllocation allocation : resident_memory) {
+        vmaFreeMemory(allocator, allocation);
+    }
+}
+
+bool SparseResidency::IsSupported(const Vulkan::Instance& instance, const ImageInfo& info,
+                                  vk::Format format, vk::ImageUsageFlags usage,
+                                  vk::ImageCreateFlags flags) {
+    if (!Config::isSparsePrtImagesEnabled() || !instance.IsSparseResidencySupported()) {
+        return false;
+    }
+    if (!AmdGpu::IsPrt(info.array_mode) || info.type != AmdGpu::ImageType::Color2D ||
+        info.num_samples != 1 || info.props.is_depth) {
+        return false;
+    }
+    const auto physical_device = instance.GetPhysicalDevice();
+    const auto properties = physical_device.getImageFormatProperties(
+        format, vk::ImageType::e2D, vk::ImageTiling::eOptimal, usage,
+        flags | vk::ImageCreateFlagBits::eSparseBinding |
+            vk::ImageCreateFlagBits::eSparseResidency);
+    if (properties.result != vk::Result::eSuccess) {
+        return false;
+    }
+    const auto sparse_properties = physical_device.getSparseImageFormatProperties(
+        format, vk::ImageType::e2D, vk::SampleCountFlagBits::e1, usage, vk::ImageTiling::eOptimal);
+    return std::ranges::any_of(sparse_properties, [](const auto& sparse) {
+        return (sparse.aspectMask & vk::ImageAspectFlagBits::eColor) &&
+               !(sparse.flags & vk::SparseImageFormatFlagBits::eNonstandardBlockSize);
+    });
+}
+
+void SparseResidency::Update(VAddr address, u64 size) {
+    auto* memory = Core::Memory::Instance();
+    const VAddr end = address + size;
+    std::vector<vk::SparseImageMemoryBind> binds;
+    std::vector<VmaAllocation> released;
+    for (u32 level = 0; level < num_tracked_levels; ++level) {
+        const Level& tiled_level = levels[level];
+        if (!tiled_level.tracked) {
+            continue;
+        }
+        const auto& mip = info.mips_layout[level];
+        const u32 slice_size = mip.size / info.resources.layers;
+        const u32 num_guest_tiles = slice_size / TileSize;
+        for (u32 layer = 0; layer < info.resources.layers; ++layer) {
+            const VAddr slice_addr = info.guest_address + mip.offset + u64{layer} * slice_size;
+            if (slice_addr >= end || slice_addr + slice_size <= address) {
+                continue;
+            }
+            const u32 first_tile =
+                address > slice_addr ? static_cast<u32>((address - slice_addr) / TileSize) : 0;
+            const u32 last_tile =
+                std::min(static_cast<u32>(Common::DivCeil(end - slice_addr, u64{TileSize})),
+                         num_guest_tiles);
+            for (u32 guest_tile = first_tile; guest_tile < last_tile; ++guest_tile) {
+                const u32 x = guest_tile % tiled_level.guest_tiles_x;
+                const u32 y = guest_tile / tiled_level.guest_tiles_x;
+                if (x >= tiled_level.tiles_x || y >= tiled_level.tiles_y) {
+                    // Padding of the guest layout past the edge of the image
+                    continue;
+                }
+                VmaAllocation& tile =
+                    tiles[tiled_level.first_tile +
+                          (layer * tiled_level.tiles_y + y) * tiled_level.tiles_x + x];
+                const bool is_mapped =
+                    memory->IsRangeMapped(slice_addr + u64{guest_tile} * TileSize, TileSize);
+                if (is_mapped == (tile != VK_NULL_HANDLE)) {
+                    continue;
+                }
+                if (is_mapped) {
+                    tile = Allocate(TileSize);
+                } else {
+                    released.push_back(std::exchange(tile, VK_NULL_HANDLE));
+                    resident_bytes -= TileSize;
+                }
+                AddBind(binds, level, layer, x, y, tile);
+            }
+        }
+    }
+    if (binds.empty()) {
+        return;
+    }
+    scheduler->BindSparse(image, std::move(binds), {});
+    if (!released.empty()) {
+        // The next submission waits for the unbind, the memory is free once it is done.
+        scheduler->DeferPriorityOperation(
+            [allocator = instance->GetAllocator(), released = std::move(released)] {
+                for (const VmaAllocation allocation : released) {
+                    vmaFreeMemory(allocator, allocation);
+                }
+            });
+    }
+}
+
+VmaAllocation SparseResidency::Allocate(u64 size) {
+    const VkMemoryRequirements requirements = {
+        .size = size,
+        .alignment = memory_requirements.alignment,
+        .memoryTypeBits = memory_requirements.memoryTypeBits,
+    };
+    const VmaAllocationCreateInfo alloc_info = {
+        .flags = 0,
+        .usage = VMA_MEMORY_USAGE_UNKNOWN,
+        .requiredFlags = 0,
+        .preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        .pool = VK_NULL_HANDLE,
+        .pUserData = nullptr,
+    };
+    VmaAllocation allocation{};
+    const VkResult result = vmaAllocateMemory(instance->GetAllocator(), &requirements,
+                                              &alloc_info, &allocation, nullptr);
+    ASSERT_MSG(result == VK_SUCCESS, "Failed allocating sparse image memory with error {}",
+               vk::to_string(vk::Result{result}));
+    resident_bytes += size;
+    return allocation;
+}
+
+void SparseResidency::AddBind(std::vector<vk::SparseImageMemoryBind>& binds, u32 level, u32 layer,
+                              u32 x, u32 y, VmaAllocation allocation) const {
+    VmaAllocationInfo alloc_info{};
+    if (allocation) {
+        vmaGetAllocationInfo(instance->GetAllocator(), allocation, &alloc_info);
+    }
+    const u32 width = std::max(info.size.width >> level, 1U);
+    const u32 height = std::max(info.size.height >> level, 1U);
+    const u32 offset_x = x * granularity.width;
+    const u32 offset_y = y * granularity.height;
+    binds.push_back({
+        .subresource =
+            {
+                .aspectMask = vk::ImageAspectFlagBits::eColor,
+                .mipLevel = level,
+                .arrayLayer = layer,
+            },
+        .offset = {static_cast<s32>(offset_x), static_cast<s32>(offset_y), 0},
+        .extent =
+            {
+                std::min(granularity.width, width - offset_x),
+                std::min(granularity.height, height - offset_y),
+                1,
+            },
+        .memory = alloc_info.deviceMemory,
+        .memoryOffset = alloc_info.offset,
+    });
+}
+
+void SparseResidency::BindMipTail(std::vector<vk::SparseMemoryBind>& opaque_binds,
+                                  const vk::SparseImageMemoryRequirements& requirements) {
+    const bool is_metadata = static_cast<bool>(requirements.formatProperties.aspectMask &
+                                               vk::ImageAspectFlagBits::eMetadata);
+    if (requirements.imageMipTailSize == 0 ||
+        (!is_metadata && requirements.imageMipTailFirstLod >= info.resources.levels)) {
+        return;
+    }
+    const bool single_tail =
+        is_metadata || static_cast<bool>(requirements.formatProperties.flags &
+                                         vk::SparseImageFormatFlagBits::eSingleMiptail);
+    const u32 num_tails = single_tail ? 1 : info.resources.layers;
+    for (u32 tail = 0; tail < num_tails; ++tail) {
+        const VmaAllocation allocation = Allocate(requirements.imageMipTailSize);
+        resident_memory.push_back(allocation);
+        VmaAllocationInfo alloc_info{};
+        vmaGetAllocationInfo(instance->GetAllocator(), allocation, &alloc_info);
+        opaque_binds.push_back({
+            .resourceOffset =
+                requirements.imageMipTailOffset + tail * requirements.imageMipTailStride,
+            .size = requirements.imageMipTailSize,
+            .memory = alloc_info.deviceMemory,
+            .memoryOffset = alloc_info.offset,
+            .flags = is_metadata ? vk::SparseMemoryBindFlagBits::eMetadata
+                                 : vk::SparseMemoryBindFlags{},
+        });
+    }
+}
+
+} // namespace VideoCore
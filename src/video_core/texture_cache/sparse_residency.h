@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <vector>
+
+#include "common/types.h"
+#include "video_core/renderer_vulkan/vk_common.h"
+#include "video_core/texture_cache/image_info.h"
+
+VK_DEFINE_HANDLE(VmaAllocation)
+
+namespace Vulkan {
+class Instance;
+class Scheduler;
+} // namespace Vulkan
+
+namespace VideoCore {
+
+/// Device memory of a partially resident image. Only the tiles whose guest memory is mapped are
+/// backed, the mip tail always is. Tiles are the 64KB blocks of the standard sparse block shapes,
+/// which match the macro tiles of the guest PRT tiling modes, so every tile covers one contiguous
+/// range of guest memory.
+class SparseResidency {
+public:
+    static constexpr u32 TileSize = 64_KB;
+
+    explicit SparseResidency(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler,
+                             const ImageInfo& info, vk::Image image);
+    ~SparseResidency();
+
+    SparseResidency(const SparseResidency&) = delete;
+    SparseResidency& operator=(const SparseResidency&) = delete;
+
+    /// Returns true if an image with the given parameters can be created partially resident.
+    [[nodiscard]] static bool IsSupported(const Vulkan::Instance& instance, const ImageInfo& info,
+                                          vk::Format format, vk::ImageUsageFlags usage,
+                                          vk::ImageCreateFlags flags);
+
+    /// Binds memory to the tiles overlapping the range whose guest memory is mapped, and unbinds
+    /// the ones whose guest memory is no longer.
+    void Update(VAddr address, u64 size);
+
+    [[nodiscard]] u64 ResidentBytes() const noexcept {
+        return resident_bytes;
+    }
+
+private:
+    struct Level {
+        u32 first_tile; ///< Index of the first tile of the level in tiles
+        u32 tiles_x;
+        u32 tiles_y;
+        u32 guest_tiles_x; ///< Tiles per row of the guest layout, which is padded to the pitch
+        bool tracked;      ///< False when the guest layout does not match, the level stays bound
+    };
+
+    VmaAllocation Allocate(u64 size);
+
+    void AddBind(std::vector<vk::SparseImageMemoryBind>& binds, u32 level, u32 layer, u32 x,
+                 u32 y, VmaAllocation allocation) const;
+
+    void BindMipTail(std::vector<vk::SparseMemoryBind>& opaque_binds,
+                     const vk::SparseImageMemoryRequirements& requirements);
+
+private:
+    const Vulkan::Instance* instance;
+    Vulkan::Scheduler* scheduler;
+    ImageInfo info;
+    vk::Image image;
+    vk::Extent3D granularity;
+    vk::MemoryRequirements memory_requirements;
+    u32 num_tracked_levels{};
+    std::vector<Level> levels;
+    std::vector<VmaAllocation> tiles;           ///< Null for tiles without memory
+    std::vector<VmaAllocation> resident_memory; ///< Mip tails and untracked levels
+    u64 resident_bytes{};
+};
+
+} // namespace VideoCore
@@ -1,17 +1,24 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <numeric>
 #include <xxhash.h>
 
+#include "common/alloc_tracker.h"
 #include "common/assert.h"
 #include "common/config.h"
 #include "common/debug.h"
+#include "common/div_ceil.h"
+#include "common/perf_counters.h"
 #include "common/scope_exit.h"
+#include "core/debug_state.h"
 #include "core/memory.h"
 #include "video_core/buffer_cache/buffer_cache.h"
 #include "video_core/page_manager.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/renderer_vulkan/vk_resource_pool.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/stall_tracker.h"
 #include "video_core/texture_cache/host_compatibility.h"
 #include "video_core/texture_cache/texture_cache.h"
 #include "video_core/texture_cache/tile_manager.h"
@@ -26,11 +33,23 @@ TextureCache::TextureCache(const Vulkan::Instance& instance_, Vulkan::Scheduler&
                            PageManager& tracker_)
     : instance{instance_}, scheduler{scheduler_}, liverpool{liverpool_},
       buffer_cache{buffer_cache_}, tracker{tracker_}, blit_helper{instance, scheduler},
-      tile_manager{instance, scheduler, buffer_cache.GetUtilityBuffer(MemoryUsage::Stream)} {
+      tile_manager{instance, scheduler, buffer_cache.GetUtilityBuffer(MemoryUsage::Stream)},
+      page_table{Config::isHugePagePageTablesEnabled()},
+      download_workers{NUM_DOWNLOAD_WORKERS, "ImageDownload"} {
     // Create basic null image at fixed image ID.
     const auto null_id = GetNullImage(vk::Format::eR8G8B8A8Unorm);
     ASSERT(null_id.index == NULL_IMAGE_ID.index);
 
+    const u32 sampler_limit = instance.MaxSamplerAllocationCount();
+    max_samplers = std::min(sampler_limit > SAMPLER_RESERVE * 2 ? sampler_limit - SAMPLER_RESERVE
+                                                                : sampler_limit / 2,
+                            MAX_CACHED_SAMPLERS);
+    sampler_heap = Vulkan::SamplerHeap::Create(instance);
+    if (sampler_heap) {
+        // Evicted samplers keep their slot until the GPU is done with them, leave room for them
+        max_samplers = std::min(max_samplers, sampler_heap->Capacity() / 2);
+    }
+
     // Set up garbage collection parameters.
     if (!instance.CanReportMemoryUsage()) {
         trigger_gc_memory = 0;
@@ -39,7 +58,10 @@ TextureCache::TextureCache(const Vulkan::Instance& instance_, Vulkan::Scheduler&
         return;
     }
 
-    const s64 device_local_memory = static_cast<s64>(instance.GetTotalMemoryBudget());
+    UpdateGcThresholds(static_cast<s64>(instance.GetTotalMemoryBudget()));
+}
+
+void TextureCache::UpdateGcThresholds(s64 device_local_memory) {
     const s64 min_spacing_expected = device_local_memory - 1_GB;
     const s64 min_spacing_critical = device_local_memory - 512_MB;
     const s64 mem_threshold = std::min<s64>(device_local_memory, TARGET_GC_THRESHOLD);
@@ -84,49 +106,113 @@ ImageId TextureCache::GetNullImage(const vk::Format format) {
 }
 
 void TextureCache::ProcessDownloadImages() {
-    for (const ImageId image_id : download_images) {
-        DownloadImageMemory(image_id);
+    if (download_images.empty()) {
+        return;
     }
+    const std::vector<ImageId> image_ids(download_images.begin(), download_images.end());
     download_images.clear();
+    DownloadImages(image_ids);
 }
 
-void TextureCache::DownloadImageMemory(ImageId image_id) {
-    Image& image = slot_images[image_id];
-    if (False(image.flags & ImageFlagBits::GpuModified)) {
-        return;
-    }
-    auto& download_buffer = buffer_cache.GetUtilityBuffer(MemoryUsage::Download);
-    const u32 download_size = image.info.pitch * image.info.size.height *
-                              image.info.resources.layers * (image.info.num_bits / 8);
-    ASSERT(download_size <= image.info.guest_size);
-    const auto [download, offset] = download_buffer.Map(download_size);
-    download_buffer.Commit();
-    const vk::BufferImageCopy image_download = {
-        .bufferOffset = offset,
-        .bufferRowLength = image.info.pitch,
-        .bufferImageHeight = image.info.size.height,
-        .imageSubresource =
-            {
-                .aspectMask = image.info.props.is_depth ? vk::ImageAspectFlagBits::eDepth
-                                                        : vk::ImageAspectFlagBits::eColor,
-                .mipLevel = 0,
-                .baseArrayLayer = 0,
-                .layerCount = image.info.resources.layers,
-            },
-        .imageOffset = {0, 0, 0},
-        .imageExtent = {image.info.size.width, image.info.size.height, 1},
+void TextureCache::DownloadImages(std::span<const ImageId> image_ids) {
+    struct Readback {
+        VAddr device_addr;
+        u64 offset; ///< From the start of the batch
+        u32 size;
     };
-    scheduler.EndRendering();
-    const auto cmdbuf = scheduler.CommandBuffer();
-    image.Transit(vk::ImageLayout::eTransferSrcOptimal, vk::AccessFlagBits2::eTransferRead, {});
-    cmdbuf.copyImageToBuffer(image.GetImage(), vk::ImageLayout::eTransferSrcOptimal,
-                             download_buffer.Handle(), image_download);
-
-    scheduler.DeferPriorityOperation(
-        [this, device_addr = image.info.guest_address, download, download_size] {
-            Core::Memory::Instance()->TryWriteBacking(std::bit_cast<u8*>(device_addr), download,
-                                                      download_size);
+    auto& download_buffer = buffer_cache.GetUtilityBuffer(MemoryUsage::Download);
+    boost::container::small_vector<std::pair<vk::Image, vk::BufferImageCopy>, 16> copies;
+    Image::Barriers barriers;
+    std::vector<Readback> readbacks;
+    u64 batch_size = 0;
+
+    const auto flush_batch = [&] {
+        if (copies.empty()) {
+            return;
+        }
+        // Waits for the readback that last used this part of the ring
+        const auto [download, offset] = [&] {
+            VideoCore::ScopedStall stall{VideoCore::StallCause::Readback};
+            return download_buffer.Map(batch_size, DOWNLOAD_ALIGNMENT);
+        }();
+        download_buffer.Commit();
+        scheduler.EndRendering();
+        const auto cmdbuf = scheduler.CommandBuffer();
+        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+            .imageMemoryBarrierCount = static_cast<u32>(barriers.size()),
+            .pImageMemoryBarriers = barriers.data(),
         });
+        for (auto& [image, copy] : copies) {
+            copy.bufferOffset += offset;
+            cmdbuf.copyImageToBuffer(image, vk::ImageLayout::eTransferSrcOptimal,
+                                     download_buffer.Handle(), copy);
+        }
+        scheduler.DeferPriorityOperation([this, download, readbacks = std::move(readbacks)] {
+            for (const auto& readback : readbacks) {
+                for (u32 done = 0; done < readback.size; done += DOWNLOAD_WORKER_CHUNK) {
+                    const u32 size = std::min(readback.size - done, DOWNLOAD_WORKER_CHUNK);
+                    download_workers.QueueWork([download, readback, done, size] {
+                        Core::Memory::Instance()->TryWriteBacking(
+                            std::bit_cast<u8*>(readback.device_addr + done),
+                            download + readback.offset + done, size);
+                    });
+                }
+            }
+            // The ring may hand the batch out again as soon as this operation returns.
+            download_workers.WaitForRequests();
+        });
+        copies.clear();
+        barriers.clear();
+        readbacks.clear();
+        batch_size = 0;
+    };
+
+    for (const ImageId image_id : image_ids) {
+        Image& image = slot_images[image_id];
+        if (False(image.flags & ImageFlagBits::GpuModified)) {
+            continue;
+        }
+        const u32 texel_size = image.info.num_bits / 8;
+        const u32 download_size =
+            image.info.pitch * image.info.size.height * image.info.resources.layers * texel_size;
+        ASSERT(download_size <= image.info.guest_size);
+        if (download_size > download_buffer.SizeBytes()) {
+            LOG_WARNING(Render_Vulkan, "Image {:#x} of {:#x} bytes is too large to download",
+                        image.info.guest_address, download_size);
+            continue;
+        }
+        // Copy offsets must be a multiple of the texel size.
+        u64 offset = Common::AlignUp(batch_size, std::lcm(16U, texel_size));
+        if (offset + download_size > download_buffer.SizeBytes()) {
+            flush_batch();
+            offset = 0;
+        }
+        const auto image_barriers =
+            image.GetBarriers(vk::ImageLayout::eTransferSrcOptimal,
+                              vk::AccessFlagBits2::eTransferRead, vk::PipelineStageFlagBits2::eCopy,
+                              {});
+        barriers.insert(barriers.end(), image_barriers.begin(), image_barriers.end());
+        copies.emplace_back(image.GetImage(),
+                            vk::BufferImageCopy{
+                                .bufferOffset = offset,
+                                .bufferRowLength = image.info.pitch,
+                                .bufferImageHeight = image.info.size.height,
+                                .imageSubresource =
+                                    {
+                                        .aspectMask = image.info.props.is_depth
+                                                          ? vk::ImageAspectFlagBits::eDepth
+                                                          : vk::ImageAspectFlagBits::eColor,
+                                        .mipLevel = 0,
+                                        .baseArrayLayer = 0,
+                                        .layerCount = image.info.resources.layers,
+                                    },
+                                .imageOffset = {0, 0, 0},
+                                .imageExtent = {image.info.size.width, image.info.size.height, 1},
+                            });
+        readbacks.push_back({image.info.guest_address, offset, download_size});
+        batch_size = offset + download_size;
+    }
+    flush_batch();
 }
 
 void TextureCache::MarkAsMaybeDirty(ImageId image_id, Image& image) {
@@ -183,11 +269,30 @@ void TextureCache::InvalidateMemoryFromGPU(VAddr address, size_t max_size) {
     });
 }
 
+void TextureCache::MapMemory(VAddr cpu_addr, size_t size) {
+    std::scoped_lock lk{mutex};
+    ForEachImageInRegion(cpu_addr, size, [&](ImageId, Image& image) {
+        if (image.sparse) {
+            image.sparse->Update(cpu_addr, size);
+            // The tiles have new contents.
+            image.flags |= ImageFlagBits::CpuDirty;
+        }
+    });
+}
+
 void TextureCache::UnmapMemory(VAddr cpu_addr, size_t size) {
     std::scoped_lock lk{mutex};
 
     ImageIds deleted_images;
-    ForEachImageInRegion(cpu_addr, size, [&](ImageId id, Image&) { deleted_images.push_back(id); });
+    ForEachImageInRegion(cpu_addr, size, [&](ImageId id, Image& image) {
+        const bool is_covered = image.info.guest_address >= cpu_addr &&
+                                image.info.guest_address + image.info.guest_size <= cpu_addr + size;
+        if (image.sparse && !is_covered) {
+            image.sparse->Update(cpu_addr, size);
+            return;
+        }
+        deleted_images.push_back(id);
+    });
     for (const ImageId id : deleted_images) {
         // TODO: Download image data back to host.
         FreeImage(id);
@@ -275,6 +380,7 @@ ImageId TextureCache::ResolveDepthOverlap(const ImageInfo& requested_info, Bindi
         } else {
             LOG_WARNING(Render_Vulkan, "Unimplemented depth overlap copy");
         }
+        DebugState.image_overlap_copies.fetch_add(1, std::memory_order_relaxed);
 
         // Free the cache image.
         FreeImage(cache_image_id);
@@ -328,6 +434,9 @@ std::tuple<ImageId, int, int> TextureCache::ResolveOverlap(const ImageInfo& imag
             const auto& result_image = slot_images[result_id];
             const bool is_compatible =
                 IsVulkanFormatCompatible(result_image.info.pixel_format, image_info.pixel_format);
+            if (is_compatible) {
+                DebugState.image_overlap_views.fetch_add(1, std::memory_order_relaxed);
+            }
             return {is_compatible ? result_id : ImageId{}, -1, -1};
         }
 
@@ -353,6 +462,7 @@ std::tuple<ImageId, int, int> TextureCache::ResolveOverlap(const ImageInfo& imag
     if (image_info.guest_address > cache_image.info.guest_address) {
         if (auto mip = image_info.MipOf(cache_image.info); mip >= 0) {
             if (auto slice = image_info.SliceOf(cache_image.info, mip); slice >= 0) {
+                DebugState.image_overlap_views.fetch_add(1, std::memory_order_relaxed);
                 return {cache_image_id, mip, slice};
             }
         }
@@ -383,6 +493,7 @@ std::tuple<ImageId, int, int> TextureCache::ResolveOverlap(const ImageInfo& imag
                 if (merged_image_id) {
                     auto& merged_image = slot_images[merged_image_id];
                     merged_image.CopyMip(cache_image, mip, slice);
+                    DebugState.image_overlap_copies.fetch_add(1, std::memory_order_relaxed);
                     FreeImage(cache_image_id);
                 }
             }
@@ -400,8 +511,9 @@ ImageId TextureCache::ExpandImage(const ImageInfo& info, ImageId image_id) {
     auto& src_image = slot_images[image_id];
     auto& new_image = slot_images[new_image_id];
 
-    RefreshImage(new_image);
+    RefreshImage(new_image_id);
     new_image.CopyImage(src_image);
+    DebugState.image_overlap_copies.fetch_add(1, std::memory_order_relaxed);
 
     if (src_image.binding.is_bound || src_image.binding.is_target) {
         src_image.binding.needs_rebind = 1u;
@@ -415,6 +527,7 @@ ImageId TextureCache::ExpandImage(const ImageInfo& info, ImageId image_id) {
 }
 
 ImageId TextureCache::FindImage(ImageDesc& desc, bool exact_fmt) {
+    Common::ScopedAllocTag alloc_tag{Common::AllocTag::TextureCache};
     const auto& info = desc.info;
 
     if (info.guest_address == 0) [[unlikely]] {
@@ -545,6 +658,130 @@ ImageView& TextureCache::FindTexture(ImageId image_id, const ImageDesc& desc) {
     return image.FindView(desc.view_info);
 }
 
+ImageView* TextureCache::FindReplacementView(ImageId image_id, const ImageDesc& desc) {
+    if (texture_packs.Empty() || desc.type != BindingType::Texture) {
+        return nullptr;
+    }
+    UpdateImage(image_id);
+    Image& image = slot_images[image_id];
+    if (True(image.flags & ImageFlagBits::GpuModified) || image.content_hash == 0) {
+        // Render targets and such no longer hold the texture that was replaced
+        FreeReplacement(image);
+        return nullptr;
+    }
+    if (image.replacement_id) {
+        Image& replacement = slot_images[image.replacement_id];
+        ImageViewInfo view_info = desc.view_info;
+        view_info.format = replacement.info.pixel_format;
+        view_info.range = {.extent = replacement.info.resources};
+        return &replacement.FindView(view_info);
+    }
+    if (image.replacement_hash == image.content_hash) {
+        // Already loading, or there is no replacement for these contents
+        return nullptr;
+    }
+    image.replacement_hash = image.content_hash;
+    if (image.info.type != AmdGpu::ImageType::Color2D || image.info.resources.layers != 1 ||
+        desc.view_info.type != AmdGpu::ImageType::Color2D) {
+        return nullptr;
+    }
+    if (const auto* entry = texture_packs.Find(image.content_hash)) {
+        texture_packs.Load(image_id, entry);
+    }
+    return nullptr;
+}
+
+void TextureCache::ProcessReplacements() {
+    if (texture_packs.Empty()) {
+        return;
+    }
+    for (auto& texture : texture_packs.TakeLoaded()) {
+        pending_replacements.emplace_back(std::move(texture));
+    }
+    const u64 budget = static_cast<u64>(Config::getTexturePackBudgetMB()) * 1_MB;
+    u64 uploaded_bytes = 0;
+    while (!pending_replacements.empty() && uploaded_bytes < MAX_REPLACEMENT_UPLOAD_BYTES) {
+        const auto texture = std::move(pending_replacements.front());
+        pending_replacements.pop_front();
+        if (!slot_images.is_allocated(texture.image_id)) {
+            continue;
+        }
+        const Image& image = slot_images[texture.image_id];
+        if (False(image.flags & ImageFlagBits::Registered) || image.replacement_id ||
+            image.replacement_hash != texture.hash ||
+            True(image.flags & ImageFlagBits::GpuModified)) {
+            continue;
+        }
+        const u64 size = texture.data.size();
+        if (replacement_memory + size > budget) {
+            LOG_WARNING(Render_Vulkan, "Replacement {:#x} exceeds the texture pack budget",
+                        texture.hash);
+            continue;
+        }
+
+        const auto* entry = texture.entry;
+        ImageInfo info{};
+        info.props.is_block = 1;
+        info.pixel_format = static_cast<vk::Format>(entry->format);
+        info.type = AmdGpu::ImageType::Color2D;
+        info.size = {entry->width, entry->height, 1};
+        info.resources = {entry->num_levels, 1};
+        info.guest_size = static_cast<u32>(size);
+        constexpr auto features =
+            vk::FormatFeatureFlagBits2::eSampledImage | vk::FormatFeatureFlagBits2::eTransferDst;
+        if (!instance.IsFormatSupported(info.pixel_format, features)) {
+            LOG_WARNING(Render_Vulkan, "Replacement {:#x} has unsupported format {}",
+                        texture.hash, vk::to_string(info.pixel_format));
+            continue;
+        }
+
+        auto& staging = buffer_cache.GetUtilityBuffer(MemoryUsage::Upload);
+        const auto [data, offset] = staging.Map(size, 16);
+        std::memcpy(data, texture.data.data(), size);
+        staging.Commit();
+
+        boost::container::small_vector<vk::BufferImageCopy, TexturePackMaxLevels> copies;
+        u64 mip_offset = offset;
+        for (u32 level = 0; level < entry->num_levels; ++level) {
+            copies.push_back({
+                .bufferOffset = mip_offset,
+                .bufferRowLength = 0,
+                .bufferImageHeight = 0,
+                .imageSubresource{
+                    .aspectMask = vk::ImageAspectFlagBits::eColor,
+                    .mipLevel = level,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+                .imageOffset = {0, 0, 0},
+                .imageExtent = {std::max(entry->width >> level, 1U),
+                                std::max(entry->height >> level, 1U), 1},
+            });
+            mip_offset += entry->mips[level].size;
+        }
+
+        const ImageId replacement_id =
+            slot_images.insert(instance, scheduler, blit_helper, slot_image_views, info);
+        Image& replacement = slot_images[replacement_id];
+        replacement.Upload(copies, staging.Handle(), offset);
+        // Replacements are never written again, so they stay in the layout they are sampled in
+        replacement.Transit(vk::ImageLayout::eShaderReadOnlyOptimal,
+                            vk::AccessFlagBits2::eShaderRead, {});
+        slot_images[texture.image_id].replacement_id = replacement_id;
+        replacement_memory += size;
+        uploaded_bytes += size;
+    }
+}
+
+void TextureCache::FreeReplacement(Image& image) {
+    if (!image.replacement_id) {
+        return;
+    }
+    replacement_memory -= slot_images[image.replacement_id].info.guest_size;
+    DeleteImage(image.replacement_id);
+    image.replacement_id = {};
+}
+
 ImageView& TextureCache::FindRenderTarget(ImageId image_id, const ImageDesc& desc) {
     Image& image = slot_images[image_id];
     image.flags |= ImageFlagBits::GpuModified;
@@ -610,7 +847,86 @@ ImageView& TextureCache::FindDepthTarget(ImageId image_id, const ImageDesc& desc
     return image.FindView(desc.view_info, false);
 }
 
-void TextureCache::RefreshImage(Image& image) {
+/// Granularity at which the guest data of GPU modified images is compared for changes.
+constexpr u64 ImageHashPageSize = 4_KB;
+
+/// Hashes the guest data of the image page by page. Returns the range of bytes covering the pages
+/// whose hash changed since the last call, relative to the guest address.
+static std::pair<u64, u64> HashImagePages(Image& image) {
+    const u8* addr = std::bit_cast<const u8*>(image.info.guest_address);
+    const u64 size = image.info.guest_size;
+    const size_t num_pages = Common::DivCeil(size, ImageHashPageSize);
+    const bool first_hash = image.page_hashes.size() != num_pages;
+    if (first_hash) {
+        image.page_hashes.assign(num_pages, 0);
+    }
+    u64 changed_begin = size;
+    u64 changed_end = 0;
+    for (size_t page = 0; page < num_pages; ++page) {
+        const u64 offset = page * ImageHashPageSize;
+        const u64 hash = XXH3_64bits(addr + offset, std::min(ImageHashPageSize, size - offset));
+        if (!first_hash && image.page_hashes[page] == hash) {
+            continue;
+        }
+        image.page_hashes[page] = hash;
+        changed_begin = std::min(changed_begin, offset);
+        changed_end = std::min(offset + ImageHashPageSize, size);
+    }
+    return {changed_begin, changed_end};
+}
+
+/// Copy of a mip level between the image and its linear guest layout.
+static vk::BufferImageCopy MipCopy(const Image& image, u32 level) {
+    const u32 width = std::max(image.info.size.width >> level, 1u);
+    const u32 height = std::max(image.info.size.height >> level, 1u);
+    const u32 depth =
+        image.info.props.is_volume ? std::max(image.info.size.depth >> level, 1u) : 1u;
+    const auto [mip_size, mip_pitch, mip_height, mip_offset] = image.info.mips_layout[level];
+    const u32 extent_width = mip_pitch ? std::min(mip_pitch, width) : width;
+    const u32 extent_height = mip_height ? std::min(mip_height, height) : height;
+    return {
+        .bufferOffset = mip_offset,
+        .bufferRowLength = mip_pitch,
+        .bufferImageHeight = mip_height,
+        .imageSubresource{
+            .aspectMask = image.aspect_mask & ~vk::ImageAspectFlagBits::eStencil,
+            .mipLevel = level,
+            .baseArrayLayer = 0,
+            .layerCount = image.info.resources.layers,
+        },
+        .imageOffset = {0, 0, 0},
+        .imageExtent = {extent_width, extent_height, depth},
+    };
+}
+
+/// Copy of the rows of a mip level covering a range of its guest data. Only linear images with a
+/// single layer can be copied in part, others get the whole mip.
+static vk::BufferImageCopy MipRowsCopy(const Image& image, u32 level, u64 begin, u64 end) {
+    auto copy = MipCopy(image, level);
+    const auto& info = image.info;
+    if (info.IsTiled() || info.props.is_block || info.props.is_volume ||
+        info.resources.layers != 1) {
+        return copy;
+    }
+    const u32 row_length = copy.bufferRowLength ? copy.bufferRowLength : copy.imageExtent.width;
+    const u64 row_size = u64{row_length} * info.num_bits / 8;
+    if (row_size == 0) {
+        return copy;
+    }
+    const u32 first_row = static_cast<u32>(begin / row_size);
+    const u32 end_row =
+        std::min(static_cast<u32>(Common::DivCeil(end, row_size)), copy.imageExtent.height);
+    if (first_row >= end_row) {
+        return copy;
+    }
+    copy.bufferOffset += first_row * row_size;
+    copy.imageOffset.y = static_cast<s32>(first_row);
+    copy.imageExtent.height = end_row - first_row;
+    return copy;
+}
+
+void TextureCache::RefreshImage(ImageId image_id) {
+    Image& image = slot_images[image_id];
     if (False(image.flags & ImageFlagBits::Dirty) || image.info.num_samples > 1) {
         return;
     }
@@ -635,44 +951,28 @@ void TextureCache::RefreshImage(Image& image) {
         image.hash = hash;
     }
 
-    const u32 num_layers = image.info.resources.layers;
     const u32 num_mips = image.info.resources.levels;
     const bool is_gpu_modified = True(image.flags & ImageFlagBits::GpuModified);
     const bool is_gpu_dirty = True(image.flags & ImageFlagBits::GpuDirty);
 
     boost::container::small_vector<vk::BufferImageCopy, 14> image_copies;
-    for (u32 m = 0; m < num_mips; m++) {
-        const u32 width = std::max(image.info.size.width >> m, 1u);
-        const u32 height = std::max(image.info.size.height >> m, 1u);
-        const u32 depth =
-            image.info.props.is_volume ? std::max(image.info.size.depth >> m, 1u) : 1u;
-        const auto [mip_size, mip_pitch, mip_height, mip_offset] = image.info.mips_layout[m];
-
-        // Protect GPU modified resources from accidental CPU reuploads.
-        if (is_gpu_modified && !is_gpu_dirty) {
-            const u8* addr = std::bit_cast<u8*>(image.info.guest_address);
-            const u64 hash = XXH3_64bits(addr + mip_offset, mip_size);
-            if (image.mip_hashes[m] == hash) {
-                continue;
+    if (is_gpu_modified && !is_gpu_dirty) {
+        // Protect GPU modified resources from accidental CPU reuploads, only the part of each mip
+        // the CPU changed is copied again.
+        const auto [changed_begin, changed_end] = HashImagePages(image);
+        for (u32 m = 0; m < num_mips; m++) {
+            const auto& mip = image.info.mips_layout[m];
+            const u64 begin = std::max<u64>(changed_begin, mip.offset);
+            const u64 end = std::min<u64>(changed_end, mip.offset + mip.size);
+            if (begin < end) {
+                image_copies.push_back(
+                    MipRowsCopy(image, m, begin - mip.offset, end - mip.offset));
             }
-            image.mip_hashes[m] = hash;
-        }
-
-        const u32 extent_width = mip_pitch ? std::min(mip_pitch, width) : width;
-        const u32 extent_height = mip_height ? std::min(mip_height, height) : height;
-        image_copies.push_back({
-            .bufferOffset = mip_offset,
-            .bufferRowLength = mip_pitch,
-            .bufferImageHeight = mip_height,
-            .imageSubresource{
-                .aspectMask = image.aspect_mask & ~vk::ImageAspectFlagBits::eStencil,
-                .mipLevel = m,
-                .baseArrayLayer = 0,
-                .layerCount = num_layers,
-            },
-            .imageOffset = {0, 0, 0},
-            .imageExtent = {extent_width, extent_height, depth},
-        });
+        }
+    } else {
+        for (u32 m = 0; m < num_mips; m++) {
+            image_copies.push_back(MipCopy(image, m));
+        }
     }
 
     if (image_copies.empty()) {
@@ -680,7 +980,43 @@ void TextureCache::RefreshImage(Image& image) {
         return;
     }
 
+    // Full uploads of guest data that is not newer on the GPU can be looked up by content.
+    const bool is_dedup_enabled = Config::isTextureDedupEnabled();
+    if ((is_dedup_enabled || !texture_packs.Empty() || !demoted_images.empty()) &&
+        !is_gpu_modified && !is_gpu_dirty &&
+        !buffer_cache.IsRegionGpuModified(image.info.guest_address, image.info.guest_size)) {
+        const u64 content_hash = XXH3_64bits(std::bit_cast<const u8*>(image.info.guest_address),
+                                             image.info.guest_size);
+        if (image.replacement_hash != content_hash) {
+            FreeReplacement(image);
+        }
+        if (is_dedup_enabled && CopyFromIdenticalImage(image, content_hash)) {
+            return;
+        }
+        image.content_hash = content_hash;
+        if (is_dedup_enabled) {
+            content_images[content_hash] = image_id;
+        }
+        if (PromoteImage(image_id, content_hash)) {
+            return;
+        }
+    }
+
     scheduler.EndRendering();
+    Common::CountPerf(Common::PerfCounter::TextureUploadBytes, image.info.guest_size);
+
+    // Small images that the GPU has not written can be detiled straight from guest memory,
+    // which saves the round trip through a scratch buffer and a compute dispatch.
+    if (tile_manager.CanDetileOnCpu(image.info) &&
+        !buffer_cache.IsRegionGpuModified(image.info.guest_address, image.info.guest_size)) {
+        const auto [buffer, offset] = tile_manager.DetileImageCpu(
+            std::bit_cast<const u8*>(image.info.guest_address), image.info);
+        for (auto& copy : image_copies) {
+            copy.bufferOffset += offset;
+        }
+        QueueUpload(image_id, image_copies, buffer, offset);
+        return;
+    }
 
     const auto [in_buffer, in_offset] =
         buffer_cache.ObtainBufferForImage(image.info.guest_address, image.info.guest_size);
@@ -699,14 +1035,203 @@ void TextureCache::RefreshImage(Image& image) {
         copy.bufferOffset += offset;
     }
 
-    image.Upload(image_copies, buffer, offset);
+    QueueUpload(image_id, image_copies, buffer, offset);
+}
+
+void TextureCache::UpdateImages(std::span<const ImageId> image_ids) {
+    std::scoped_lock lock{mutex};
+    batch_uploads = true;
+    for (const ImageId image_id : image_ids) {
+        TrackImage(image_id);
+        TouchImage(slot_images[image_id]);
+        RefreshImage(image_id);
+    }
+    batch_uploads = false;
+    FlushUploads();
+}
+
+TextureCache::UploadStats TextureCache::ConsumeUploadStats() {
+    std::scoped_lock lock{mutex};
+    return std::exchange(upload_stats, {});
+}
+
+void TextureCache::QueueUpload(ImageId image_id, std::span<const vk::BufferImageCopy> copies,
+                               vk::Buffer buffer, u64 offset) {
+    // Clear the dirty flag now so the image is not queued twice
+    slot_images[image_id].flags &= ~ImageFlagBits::Dirty;
+    pending_uploads.push_back({
+        .image_id = image_id,
+        .buffer = buffer,
+        .offset = offset,
+        .copies{copies.begin(), copies.end()},
+    });
+    if (!batch_uploads) {
+        FlushUploads();
+    }
 }
 
-vk::Sampler TextureCache::GetSampler(const AmdGpu::Sampler& sampler,
-                                     AmdGpu::BorderColorBuffer border_color_base) {
-    const u64 hash = XXH3_64bits(&sampler, sizeof(sampler));
-    const auto [it, new_sampler] = samplers.try_emplace(hash, instance, sampler, border_color_base);
-    return it->second.Handle();
+void TextureCache::FlushUploads() {
+    if (pending_uploads.empty()) {
+        return;
+    }
+    boost::container::small_vector<ImageUpload, 16> uploads;
+    for (const auto& pending : pending_uploads) {
+        uploads.push_back({
+            .image = &slot_images[pending.image_id],
+            .copies = pending.copies,
+            .buffer = pending.buffer,
+            .offset = pending.offset,
+        });
+    }
+    Image::Upload(scheduler, uploads);
+    upload_stats.images += static_cast<u32>(uploads.size());
+    upload_stats.barriers += 2;
+    pending_uploads.clear();
+}
+
+bool TextureCache::CopyFromIdenticalImage(Image& image, u64 content_hash) {
+    const auto it = content_images.find(content_hash);
+    if (it == content_images.end()) {
+        return false;
+    }
+    // The source may be waiting on its upload in the current batch
+    FlushUploads();
+    Image& src_image = slot_images[it->second];
+    const auto& src_info = src_image.info;
+    const auto& info = image.info;
+    // The source must still hold exactly the guest data it was uploaded from.
+    if (&src_image == &image || src_image.content_hash != content_hash ||
+        True(src_image.flags & (ImageFlagBits::Dirty | ImageFlagBits::GpuModified)) ||
+        src_info.pixel_format != info.pixel_format || src_info.type != info.type ||
+        src_info.size != info.size || src_info.resources != info.resources ||
+        src_info.num_samples != info.num_samples || src_info.tile_mode != info.tile_mode ||
+        src_info.guest_size != info.guest_size) {
+        return false;
+    }
+    image.CopyImage(src_image);
+    image.content_hash = content_hash;
+    image.flags &= ~ImageFlagBits::Dirty;
+    return true;
+}
+
+void TextureCache::DemoteImage(ImageId image_id) {
+    Image& image = slot_images[image_id];
+    const auto& info = image.info;
+    constexpr auto stale_flags = ImageFlagBits::Dirty | ImageFlagBits::GpuModified;
+    // Only images holding exactly their guest data can be found again by its hash
+    if (!Config::isImageDemotionEnabled() || True(image.flags & stale_flags) ||
+        info.num_samples > 1 || info.props.is_depth || image.sparse || info.guest_address == 0 ||
+        info.guest_size > MAX_DEMOTED_MEMORY) {
+        return;
+    }
+    const u64 content_hash =
+        image.content_hash != 0
+            ? image.content_hash
+            : XXH3_64bits(std::bit_cast<const u8*>(info.guest_address), info.guest_size);
+    if (demoted_images.contains(content_hash)) {
+        return;
+    }
+    while (demoted_memory + info.guest_size > MAX_DEMOTED_MEMORY) {
+        EvictDemotedImage();
+    }
+
+    DemotedImage demoted{
+        .info = info,
+        .buffer = Buffer{instance, scheduler, MemoryUsage::Download, 0,
+                         vk::BufferUsageFlagBits::eTransferSrc |
+                             vk::BufferUsageFlagBits::eTransferDst,
+                         info.guest_size},
+    };
+    for (u32 m = 0; m < info.resources.levels; ++m) {
+        demoted.copies.push_back(MipCopy(image, m));
+    }
+    image.Download(demoted.copies, demoted.buffer.Handle(), 0, info.guest_size);
+    demoted_memory += info.guest_size;
+    demoted_order.push_back(content_hash);
+    demoted_images.emplace(content_hash, std::move(demoted));
+    DebugState.demoted_images.store(static_cast<u32>(demoted_images.size()),
+                                    std::memory_order_relaxed);
+    DebugState.demoted_image_bytes.store(demoted_memory, std::memory_order_relaxed);
+}
+
+bool TextureCache::PromoteImage(ImageId image_id, u64 content_hash) {
+    const auto it = demoted_images.find(content_hash);
+    if (it == demoted_images.end()) {
+        return false;
+    }
+    const auto& src_info = it->second.info;
+    const auto& info = slot_images[image_id].info;
+    if (src_info.pixel_format != info.pixel_format || src_info.type != info.type ||
+        src_info.size != info.size || src_info.resources != info.resources ||
+        src_info.num_samples != info.num_samples || src_info.tile_mode != info.tile_mode ||
+        src_info.guest_size != info.guest_size) {
+        return false;
+    }
+    // Record the copy right away, the buffer is released with the current tick
+    QueueUpload(image_id, it->second.copies, it->second.buffer.Handle(), 0);
+    FlushUploads();
+    ReleaseDemotedImage(it);
+    DebugState.image_promotions.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void TextureCache::EvictDemotedImage() {
+    const u64 content_hash = demoted_order.front();
+    demoted_order.pop_front();
+    // Promoted images leave their hash behind in the order
+    if (const auto it = demoted_images.find(content_hash); it != demoted_images.end()) {
+        ReleaseDemotedImage(it);
+    }
+}
+
+void TextureCache::ReleaseDemotedImage(tsl::robin_map<u64, DemotedImage>::iterator it) {
+    demoted_memory -= it->second.info.guest_size;
+    // The GPU may still be copying from or to the buffer
+    scheduler.DeferOperation([buffer = std::move(it.value().buffer)] {});
+    demoted_images.erase(it);
+    DebugState.demoted_images.store(static_cast<u32>(demoted_images.size()),
+                                    std::memory_order_relaxed);
+    DebugState.demoted_image_bytes.store(demoted_memory, std::memory_order_relaxed);
+}
+
+Sampler& TextureCache::FindSampler(const AmdGpu::Sampler& sampler,
+                                   AmdGpu::BorderColorBuffer border_color_base) {
+    const SamplerKey key{instance, sampler, border_color_base};
+    const u64 hash = key.Hash();
+    if (const auto it = samplers.find(hash); it != samplers.end()) {
+        sampler_lru_cache.Touch(it->second.lru_id, gc_tick);
+        return it.value();
+    }
+    if (samplers.size() >= max_samplers) {
+        EvictSampler();
+    }
+    const auto it = samplers.try_emplace(hash, instance, key).first;
+    it.value().lru_id = sampler_lru_cache.Insert(hash, gc_tick);
+    if (sampler_heap) {
+        it.value().heap_slot = sampler_heap->Allocate(it->second.Handle());
+    }
+    DebugState.live_samplers.store(static_cast<u32>(samplers.size()), std::memory_order_relaxed);
+    return it.value();
+}
+
+void TextureCache::EvictSampler() {
+    // Samplers of the command buffer being recorded are still needed, only evict older ones.
+    if (gc_tick == 0) {
+        return;
+    }
+    sampler_lru_cache.ForEachItemBelow(gc_tick - 1, [this](u64 hash) {
+        const auto it = samplers.find(hash);
+        sampler_lru_cache.Free(it->second.lru_id);
+        // Descriptors of pending submissions may still reference the sampler
+        scheduler.DeferOperation([this, sampler = std::move(it.value())] {
+            if (sampler_heap) {
+                sampler_heap->Free(sampler.heap_slot);
+            }
+        });
+        samplers.erase(it);
+        DebugState.sampler_evictions.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    });
 }
 
 void TextureCache::RegisterImage(ImageId image_id) {
@@ -726,6 +1251,10 @@ void TextureCache::UnregisterImage(ImageId image_id) {
                "Trying to unregister an already unregistered image");
     image.flags &= ~ImageFlagBits::Registered;
     lru_cache.Free(image.lru_id);
+    if (const auto it = content_images.find(image.content_hash);
+        it != content_images.end() && it->second == image_id) {
+        content_images.erase(it);
+    }
     total_used_memory -= Common::AlignUp(image.info.guest_size, 1024);
     ForEachPage(image.info.guest_address, image.info.guest_size, [this, image_id](u64 page) {
         const auto page_it = page_table.find(page);
@@ -856,6 +1385,9 @@ void TextureCache::RunGarbageCollector() {
         ++gc_tick;
     };
     if (instance.CanReportMemoryUsage()) {
+        if (gc_tick % GC_BUDGET_REFRESH_TICKS == 0) {
+            UpdateGcThresholds(static_cast<s64>(instance.GetCurrentMemoryBudget()));
+        }
         total_used_memory = instance.GetDeviceMemoryUsage();
     }
     if (total_used_memory < trigger_gc_memory) {
@@ -890,7 +1422,9 @@ void TextureCache::RunGarbageCollector() {
             return false;
         }
         if (download) {
-            DownloadImageMemory(image_id);
+            DownloadImages({&image_id, 1});
+        } else {
+            DemoteImage(image_id);
         }
         FreeImage(image_id);
         if (total_used_memory < critical_gc_memory) {
@@ -926,6 +1460,7 @@ void TextureCache::DeleteImage(ImageId image_id) {
     Image& image = slot_images[image_id];
     ASSERT_MSG(!image.IsTracked(), "Image was not untracked");
     ASSERT_MSG(False(image.flags & ImageFlagBits::Registered), "Image was not unregistered");
+    FreeReplacement(image);
 
     // Remove any registered meta areas.
     const auto& meta_info = image.info.meta_info;
@@ -4,7 +4,9 @@
 #pragma once
 
 #include <condition_variable>
+#include <deque>
 #include <mutex>
+#include <span>
 #include <thread>
 #include <unordered_set>
 #include <boost/container/small_vector.hpp>
@@ -13,18 +15,24 @@
 
 #include "common/lru_cache.h"
 #include "common/slot_vector.h"
+#include "common/thread_worker.h"
 #include "shader_recompiler/resource.h"
 #include "video_core/multi_level_page_table.h"
 #include "video_core/texture_cache/blit_helper.h"
 #include "video_core/texture_cache/image.h"
 #include "video_core/texture_cache/image_view.h"
 #include "video_core/texture_cache/sampler.h"
+#include "video_core/texture_cache/texture_pack.h"
 #include "video_core/texture_cache/tile_manager.h"
 
 namespace AmdGpu {
 struct Liverpool;
 }
 
+namespace Vulkan {
+class SamplerHeap;
+}
+
 namespace VideoCore {
 
 class BufferCache;
@@ -35,6 +43,20 @@ class TextureCache {
     static constexpr s64 DEFAULT_PRESSURE_GC_MEMORY = 1_GB + 512_MB;
     static constexpr s64 DEFAULT_CRITICAL_GC_MEMORY = 3_GB;
     static constexpr s64 TARGET_GC_THRESHOLD = 8_GB;
+    /// Collections between two queries of the device memory budget
+    static constexpr u64 GC_BUDGET_REFRESH_TICKS = 64;
+    /// Replacement texture data uploaded per submission, larger textures go alone
+    static constexpr u64 MAX_REPLACEMENT_UPLOAD_BYTES = 64_MB;
+    /// Base alignment of a download batch, a multiple of every texel size
+    static constexpr u64 DOWNLOAD_ALIGNMENT = 48;
+    /// Guest memory written by one download worker task
+    static constexpr u32 DOWNLOAD_WORKER_CHUNK = 4_MB;
+    static constexpr size_t NUM_DOWNLOAD_WORKERS = 4;
+    /// Samplers left to the other users of the device, such as the blitter and the overlay
+    static constexpr u32 SAMPLER_RESERVE = 64;
+    static constexpr u32 MAX_CACHED_SAMPLERS = 4096;
+    /// Host memory holding the contents of collected images until they are needed again
+    static constexpr u64 MAX_DEMOTED_MEMORY = 1_GB;
 
     using ImageIds = boost::container::small_vector<ImageId, 16>;
 
@@ -75,6 +97,11 @@ public:
             : info{group, cpu_address}, type{BindingType::VideoOut} {}
     };
 
+    struct UploadStats {
+        u32 images;   ///< Images uploaded from guest memory
+        u32 barriers; ///< Pipeline barriers recorded around their copies
+    };
+
 public:
     TextureCache(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler,
                  AmdGpu::Liverpool* liverpool, BufferCache& buffer_cache, PageManager& tracker);
@@ -84,13 +111,22 @@ public:
         return tile_manager;
     }
 
+    /// Returns the heap holding every cached sampler, null unless samplers are bindless.
+    Vulkan::SamplerHeap* GetSamplerHeap() noexcept {
+        return sampler_heap.get();
+    }
+
     /// Invalidates any image in the logical page range.
     void InvalidateMemory(VAddr addr, size_t size);
 
     /// Marks an image as dirty if it exists at the provided address.
     void InvalidateMemoryFromGPU(VAddr address, size_t max_size);
 
-    /// Evicts any images that overlap the unmapped range.
+    /// Backs the tiles of partially resident images that the newly mapped range covers.
+    void MapMemory(VAddr cpu_addr, size_t size);
+
+    /// Evicts any images that overlap the unmapped range. Partially resident images that are
+    /// not completely unmapped lose the memory of the covered tiles instead.
     void UnmapMemory(VAddr cpu_addr, size_t size);
 
     /// Schedules a copy of pending images for download back to CPU memory.
@@ -105,6 +141,13 @@ public:
     /// Retrieves an image view with the properties of the specified image id.
     [[nodiscard]] ImageView& FindTexture(ImageId image_id, const ImageDesc& desc);
 
+    /// Returns the view of the replacement texture of the image if it is loaded. The first lookup
+    /// of an image requests its replacement, which becomes available on a later submission.
+    [[nodiscard]] ImageView* FindReplacementView(ImageId image_id, const ImageDesc& desc);
+
+    /// Uploads the replacement textures that finished loading.
+    void ProcessReplacements();
+
     /// Retrieves the render target with specified properties
     [[nodiscard]] ImageView& FindRenderTarget(ImageId image_id, const ImageDesc& desc);
 
@@ -117,9 +160,15 @@ public:
         Image& image = slot_images[image_id];
         TrackImage(image_id);
         TouchImage(image);
-        RefreshImage(image);
+        RefreshImage(image_id);
     }
 
+    /// Updates the contents of the images, recording all of their uploads together.
+    void UpdateImages(std::span<const ImageId> image_ids);
+
+    /// Returns the upload counters accumulated since the last call.
+    [[nodiscard]] UploadStats ConsumeUploadStats();
+
     /// Resolves overlap between existing cache image and pending merged image
     [[nodiscard]] std::tuple<ImageId, int, int> ResolveOverlap(const ImageInfo& info,
                                                                BindingType binding,
@@ -134,11 +183,19 @@ public:
     [[nodiscard]] ImageId ExpandImage(const ImageInfo& info, ImageId image_id);
 
     /// Reuploads image contents.
-    void RefreshImage(Image& image);
+    void RefreshImage(ImageId image_id);
 
     /// Retrieves the sampler that matches the provided S# descriptor.
     [[nodiscard]] vk::Sampler GetSampler(const AmdGpu::Sampler& sampler,
-                                         AmdGpu::BorderColorBuffer border_color_base);
+                                         AmdGpu::BorderColorBuffer border_color_base) {
+        return FindSampler(sampler, border_color_base).Handle();
+    }
+
+    /// Retrieves the sampler heap slot of the sampler that matches the provided S# descriptor.
+    [[nodiscard]] u32 GetSamplerSlot(const AmdGpu::Sampler& sampler,
+                                     AmdGpu::BorderColorBuffer border_color_base) {
+        return FindSampler(sampler, border_color_base).heap_slot;
+    }
 
     /// Retrieves the image with the specified id.
     [[nodiscard]] Image& GetImage(ImageId id) {
@@ -152,6 +209,22 @@ public:
         return slot_image_views[id];
     }
 
+    /// Calls func with every image in the cache.
+    template <typename Func>
+    void ForEachImage(Func&& func) {
+        std::scoped_lock lock{mutex};
+        slot_images.ForEach([&](ImageId id, Image& image) {
+            if (id != NULL_IMAGE_ID) {
+                func(id, image);
+            }
+        });
+    }
+
+    /// Returns the host memory used by the image page table.
+    [[nodiscard]] size_t PageTableResidentBytes() const noexcept {
+        return page_table.ResidentBytes();
+    }
+
     /// Returns true if the specified address is a metadata surface.
     bool IsMeta(VAddr address) const {
         return surface_metas.contains(address);
@@ -254,11 +327,9 @@ private:
     /// Gets or creates a null image for a particular format.
     ImageId GetNullImage(vk::Format format);
 
-    /// Copies image memory back to CPU.
-    void DownloadImageMemory(ImageId image_id);
-
-    /// Thread function for copying downloaded images out to CPU memory.
-    void DownloadedImagesThread(const std::stop_token& token);
+    /// Copies image memory back to CPU. The images are copied in batches into the download ring,
+    /// and once the GPU is done the batches are written to guest memory by the download workers.
+    void DownloadImages(std::span<const ImageId> image_ids);
 
     /// Create an image from the given parameters
     [[nodiscard]] ImageId InsertImage(const ImageInfo& info, VAddr cpu_addr);
@@ -284,9 +355,49 @@ private:
     /// Removes the image and any views/surface metas that reference it.
     void DeleteImage(ImageId image_id);
 
+    /// Uploads guest data to the image, right away unless a batch of uploads is being gathered.
+    void QueueUpload(ImageId image_id, std::span<const vk::BufferImageCopy> copies,
+                     vk::Buffer buffer, u64 offset);
+
+    /// Records the queued uploads.
+    void FlushUploads();
+
+    struct DemotedImage {
+        ImageInfo info;
+        Buffer buffer;
+        boost::container::small_vector<vk::BufferImageCopy, 14> copies;
+    };
+
+    /// Keeps a copy of an unmodified image that is about to be collected in host memory.
+    void DemoteImage(ImageId image_id);
+
+    /// Copies the contents of a demoted image with the same layout and guest data, if any.
+    bool PromoteImage(ImageId image_id, u64 content_hash);
+
+    /// Releases the oldest demoted image.
+    void EvictDemotedImage();
+
+    void ReleaseDemotedImage(tsl::robin_map<u64, DemotedImage>::iterator it);
+
+    /// Copies the contents of an unmodified image with the same layout and guest data, if any.
+    bool CopyFromIdenticalImage(Image& image, u64 content_hash);
+
+    /// Releases the replacement texture of the image.
+    void FreeReplacement(Image& image);
+
     /// Touch the image in the LRU cache.
     void TouchImage(const Image& image);
 
+    /// Returns the cached sampler of the S# descriptor, creating it if needed.
+    Sampler& FindSampler(const AmdGpu::Sampler& sampler,
+                         AmdGpu::BorderColorBuffer border_color_base);
+
+    /// Destroys the least recently used sampler not needed by the current submission.
+    void EvictSampler();
+
+    /// Derives the eviction thresholds from the memory the device can use.
+    void UpdateGcThresholds(s64 device_local_memory);
+
     void FreeImage(ImageId image_id) {
         UntrackImage(image_id);
         UnregisterImage(image_id);
@@ -304,14 +415,33 @@ private:
     Common::SlotVector<Image> slot_images;
     Common::SlotVector<ImageView> slot_image_views;
     tsl::robin_map<u64, Sampler> samplers;
+    Common::LeastRecentlyUsedCache<u64, u64> sampler_lru_cache;
+    std::unique_ptr<Vulkan::SamplerHeap> sampler_heap;
+    u32 max_samplers = 0;
     tsl::robin_map<vk::Format, ImageId> null_images;
     std::unordered_set<ImageId> download_images;
+    tsl::robin_map<u64, ImageId> content_images;
+    TexturePacks texture_packs;
+    std::deque<TexturePacks::LoadedTexture> pending_replacements;
+    u64 replacement_memory = 0;
+    struct PendingUpload {
+        ImageId image_id;
+        vk::Buffer buffer;
+        u64 offset;
+        boost::container::small_vector<vk::BufferImageCopy, 14> copies;
+    };
+    std::vector<PendingUpload> pending_uploads;
+    tsl::robin_map<u64, DemotedImage> demoted_images;
+    std::deque<u64> demoted_order;
+    u64 demoted_memory = 0;
+    bool batch_uploads = false;
+    UploadStats upload_stats{};
     u64 total_used_memory = 0;
     u64 trigger_gc_memory = 0;
     u64 pressure_gc_memory = 0;
     u64 critical_gc_memory = 0;
     u64 gc_tick = 0;
-    Common::LeastRecentlyUsedCache<ImageId, u64> lru_cache;
+    Common::GenerationalLruCache<ImageId, u64> lru_cache;
     PageTable page_table;
     std::mutex mutex;
     struct MetaDataInfo {
@@ -324,6 +454,7 @@ private:
         s32 clear_mask = -1;
     };
     tsl::robin_map<VAddr, MetaDataInfo> surface_metas;
+    Common::ThreadWorker download_workers;
 };
 
 } // namespace VideoCore
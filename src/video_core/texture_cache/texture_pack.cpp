@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "common/config.h"
+#include "common/elf_info.h"
+#include "common/logging/log.h"
+#include "common/path_util.h"
+#include "video_core/renderer_vulkan/vk_common.h"
+#include "video_core/texture_cache/texture_pack.h"
+
+namespace VideoCore {
+
+static bool IsCompressedFormat(u32 format) {
+    const auto vk_format = static_cast<vk::Format>(format);
+    const bool is_bcn =
+        vk_format >= vk::Format::eBc1RgbUnormBlock && vk_format <= vk::Format::eBc7SrgbBlock;
+    const bool is_astc = vk_format >= vk::Format::eAstc4x4UnormBlock &&
+                         vk_format <= vk::Format::eAstc12x12SrgbBlock;
+    return is_bcn || is_astc;
+}
+
+TexturePacks::TexturePacks() {
+    if (!Config::isTexturePacksEnabled()) {
+        return;
+    }
+    const auto dir = Common::FS::GetUserPath(Common::FS::PathType::TexturePacksDir) /
+                     Common::ElfInfo::Instance().GameSerial();
+    std::error_code ec;
+    if (!std::filesystem::is_directory(dir, ec)) {
+        return;
+    }
+    std::vector<std::filesystem::path> paths;
+    for (const auto& file : std::filesystem::directory_iterator{dir, ec}) {
+        if (file.is_regular_file(ec) && file.path().extension() == ".stp") {
+            paths.emplace_back(file.path());
+        }
+    }
+    // Packs later in name order override the entries of earlier ones.
+    std::ranges::sort(paths);
+    for (const auto& path : paths) {
+        if (!OpenPack(path)) {
+            LOG_WARNING(Render_Vulkan, "Skipping invalid texture pack {}", path.string());
+        }
+    }
+    if (entries.empty()) {
+        return;
+    }
+    LOG_INFO(Render_Vulkan, "Loaded {} replacement textures from {} packs", entries.size(),
+             packs.size());
+    loader.emplace(1, "TexturePackLoader");
+}
+
+TexturePacks::~TexturePacks() = default;
+
+bool TexturePacks::OpenPack(const std::filesystem::path& path) {
+    Common::FS::MappedFile pack{path};
+    if (!pack.IsOpen() || pack.Size() < sizeof(TexturePackHeader)) {
+        return false;
+    }
+    TexturePackHeader header;
+    std::memcpy(&header, pack.View().data(), sizeof(header));
+    if (header.magic != TexturePackMagic || header.version != TexturePackVersion) {
+        return false;
+    }
+    const auto records =
+        pack.View(sizeof(TexturePackHeader), size_t{header.num_entries} * sizeof(TexturePackEntry));
+    if (records.empty() && header.num_entries != 0) {
+        return false;
+    }
+
+    const u32 pack_index = static_cast<u32>(packs.size());
+    const auto* pack_entries = reinterpret_cast<const TexturePackEntry*>(records.data());
+    for (u32 i = 0; i < header.num_entries; ++i) {
+        const TexturePackEntry& entry = pack_entries[i];
+        const bool is_valid =
+            IsCompressedFormat(entry.format) && entry.width != 0 && entry.height != 0 &&
+            entry.num_levels != 0 && entry.num_levels <= TexturePackMaxLevels &&
+            std::all_of(entry.mips.begin(), entry.mips.begin() + entry.num_levels,
+                        [&](const auto& mip) { return !pack.View(mip.offset, mip.size).empty(); });
+        if (!is_valid) {
+            LOG_WARNING(Render_Vulkan, "Skipping invalid replacement {:#x} in {}", entry.hash,
+                        path.string());
+            continue;
+        }
+        entries.insert_or_assign(entry.hash, Location{&entry, pack_index});
+    }
+    packs.emplace_back(std::move(pack));
+    return true;
+}
+
+const TexturePackEntry* TexturePacks::Find(u64 hash) const {
+    const auto it = entries.find(hash);
+    return it != entries.end() ? it->second.entry : nullptr;
+}
+
+void TexturePacks::Load(ImageId image_id, const TexturePackEntry* entry) {
+    const u32 pack_index = entries.at(entry->hash).pack_index;
+    loader->QueueWork([this, image_id, entry, pack_index] {
+        const auto& pack = packs[pack_index];
+        LoadedTexture texture{
+            .image_id = image_id,
+            .hash = entry->hash,
+            .entry = entry,
+        };
+        for (u32 level = 0; level < entry->num_levels; ++level) {
+            // Faulting the mapped pages in happens here instead of on the render thread
+            const auto mip = pack.View(entry->mips[level].offset, entry->mips[level].size);
+            texture.data.insert(texture.data.end(), mip.begin(), mip.end());
+        }
+        std::scoped_lock lock{loaded_mutex};
+        loaded.emplace_back(std::move(texture));
+    });
+}
+
+std::vector<TexturePacks::LoadedTexture> TexturePacks::TakeLoaded() {
+    std::scoped_lock lock{loaded_mutex};
+    return std::exchange(loaded, {});
+}
+
+} // namespace VideoCore
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <tsl/robin_map.h>
+
+#include "common/mapped_file.h"
+#include "common/thread_worker.h"
+#include "common/types.h"
+#include "video_core/texture_cache/types.h"
+
+namespace VideoCore {
+
+// Pack file layout: a TexturePackHeader, num_entries TexturePackEntry records and the data they
+// point to. Every entry replaces the guest texture whose data hashes to the entry hash with a 2D
+// BCn or ASTC texture, stored tightly packed one mip level after the other.
+constexpr u32 TexturePackMagic = 0x50545053; // SPTP
+constexpr u32 TexturePackVersion = 1;
+constexpr u32 TexturePackMaxLevels = 16;
+
+struct TexturePackHeader {
+    u32 magic;
+    u32 version;
+    u32 num_entries;
+    u32 reserved;
+};
+
+struct TexturePackMip {
+    u64 offset; ///< From the start of the file
+    u64 size;
+};
+
+struct TexturePackEntry {
+    u64 hash; ///< XXH3 of the guest texture data
+    u32 format;
+    u32 width;
+    u32 height;
+    u32 num_levels;
+    std::array<TexturePackMip, TexturePackMaxLevels> mips;
+};
+static_assert(sizeof(TexturePackEntry) % alignof(u64) == 0);
+
+/// Replacement textures of the running game, read from the memory mapped packs in its folder.
+/// Mip data is paged in on a loader thread, so the render thread only copies it to the GPU.
+class TexturePacks {
+public:
+    struct LoadedTexture {
+        ImageId image_id;
+        u64 hash;
+        const TexturePackEntry* entry;
+        std::vector<u8> data; ///< Mip levels one after the other
+    };
+
+    TexturePacks();
+    ~TexturePacks();
+
+    [[nodiscard]] bool Empty() const noexcept {
+        return entries.empty();
+    }
+
+    [[nodiscard]] const TexturePackEntry* Find(u64 hash) const;
+
+    /// Reads the mips of the entry on the loader thread, to be picked up with TakeLoaded.
+    void Load(ImageId image_id, const TexturePackEntry* entry);
+
+    /// Returns the textures that finished loading since the last call.
+    [[nodiscard]] std::vector<LoadedTexture> TakeLoaded();
+
+private:
+    bool OpenPack(const std::filesystem::path& path);
+
+    struct Location {
+        const TexturePackEntry* entry;
+        u32 pack_index;
+    };
+    std::vector<Common::FS::MappedFile> packs;
+    tsl::robin_map<u64, Location> entries;
+    std::mutex loaded_mutex;
+    std::vector<LoadedTexture> loaded;
+    std::optional<Common::ThreadWorker> loader;
+};
+
+} // namespace VideoCore
@@ -1,10 +1,13 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "common/config.h"
+#include "common/perf_counters.h"
 #include "video_core/buffer_cache/buffer.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 #include "video_core/renderer_vulkan/vk_shader_util.h"
+#include "video_core/texture_cache/cpu_detiler.h"
 #include "video_core/texture_cache/image.h"
 #include "video_core/texture_cache/image_info.h"
 #include "video_core/texture_cache/image_view.h"
@@ -85,15 +88,23 @@ TileManager::ScratchBuffer TileManager::GetScratchBuffer(u32 size) {
         .usage = usage,
     };
 
-    const VmaAllocationCreateInfo alloc_info{
+    // Scratch buffers are destroyed once the submission using them is done
+    VmaAllocationCreateInfo alloc_info{
         .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+        .pool = instance.GetMemoryPool(Vulkan::MemoryPool::Scratch),
     };
 
     VkBuffer buffer;
     VmaAllocation allocation;
     const auto buffer_ci_unsafe = static_cast<VkBufferCreateInfo>(buffer_ci);
-    const auto result = vmaCreateBuffer(instance.GetAllocator(), &buffer_ci_unsafe, &alloc_info,
-                                        &buffer, &allocation, nullptr);
+    auto result = vmaCreateBuffer(instance.GetAllocator(), &buffer_ci_unsafe, &alloc_info,
+                                  &buffer, &allocation, nullptr);
+    if (result != VK_SUCCESS && alloc_info.pool) {
+        // The ring is full of buffers still in flight
+        alloc_info.pool = VK_NULL_HANDLE;
+        result = vmaCreateBuffer(instance.GetAllocator(), &buffer_ci_unsafe, &alloc_info, &buffer,
+                                 &allocation, nullptr);
+    }
     ASSERT(result == VK_SUCCESS);
     return {buffer, allocation};
 }
@@ -166,6 +177,7 @@ TileManager::Result TileManager::DetileImage(vk::Buffer in_buffer, u32 in_offset
     if (!info.props.is_tiled) {
         return {in_buffer, in_offset};
     }
+    Common::CountPerf(Common::PerfCounter::Detiles);
 
     TilingInfo params{};
     params.bank_swizzle = info.bank_swizzle;
@@ -241,6 +253,19 @@ TileManager::Result TileManager::DetileImage(vk::Buffer in_buffer, u32 in_offset
     return {out_buffer, 0};
 }
 
+bool TileManager::CanDetileOnCpu(const ImageInfo& info) const {
+    return Config::isCpuDetilingEnabled() && info.guest_size <= CPU_DETILE_MAX_SIZE &&
+           CpuDetiler::IsSupported(info);
+}
+
+TileManager::Result TileManager::DetileImageCpu(const u8* tiled_data, const ImageInfo& info) {
+    Common::CountPerf(Common::PerfCounter::Detiles);
+    const auto [data, offset] = stream_buffer.Map(info.guest_size, 16);
+    CpuDetiler{info}.Detile(tiled_data, info.guest_size, data);
+    stream_buffer.Commit();
+    return {stream_buffer.Handle(), static_cast<u32>(offset)};
+}
+
 void TileManager::TileImage(Image& in_image, std::span<vk::BufferImageCopy> buffer_copies,
                             vk::Buffer out_buffer, u32 out_offset, u32 copy_size) {
     const auto& info = in_image.info;
@@ -15,6 +15,8 @@ class StreamBuffer;
 
 class TileManager {
     static constexpr size_t NUM_BPPS = 5;
+    /// Largest guest image that is detiled on the CPU instead of with a compute dispatch.
+    static constexpr u32 CPU_DETILE_MAX_SIZE = 256_KB;
 
 public:
     using ScratchBuffer = std::pair<vk::Buffer, VmaAllocation>;
@@ -29,6 +31,12 @@ public:
 
     Result DetileImage(vk::Buffer in_buffer, u32 in_offset, const ImageInfo& info);
 
+    /// Returns true if the image is small enough and has a layout the CPU detiler supports.
+    [[nodiscard]] bool CanDetileOnCpu(const ImageInfo& info) const;
+
+    /// Detiles the tiled guest data while copying it into the stream buffer.
+    Result DetileImageCpu(const u8* tiled_data, const ImageInfo& info);
+
 private:
     vk::Pipeline GetTilingPipeline(const ImageInfo& info, bool is_tiler);
     ScratchBuffer GetScratchBuffer(u32 size);